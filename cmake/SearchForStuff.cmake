@@ -10,6 +10,53 @@ message(STATUS "Building for arch: ${ARCH}")
 list(INSERT CMAKE_MODULE_PATH 0 "${CMAKE_CURRENT_SOURCE_DIR}/cmake/Modules")
 find_package(TinyXML2 REQUIRED)
 
+#################################################
+# Find the platform thread library, used for parallel DOM loading.
+find_package(Threads REQUIRED)
+
+#################################################
+# Find zlib and zstd, for reading compressed documents.
+find_package(ZLIB QUIET)
+if (ZLIB_FOUND)
+  set(HAVE_ZLIB TRUE)
+else()
+  BUILD_WARNING("zlib not found. Reading gzip compressed files will be disabled")
+endif()
+
+if (PKG_CONFIG_FOUND)
+  pkg_check_modules(ZSTD QUIET IMPORTED_TARGET libzstd)
+endif()
+if (ZSTD_FOUND)
+  set(HAVE_ZSTD TRUE)
+else()
+  BUILD_WARNING("libzstd not found. Reading zstd compressed files will be disabled")
+endif()
+
+#################################################
+# Find the optional tracing backend of the parser scopes.
+set(SDFORMAT_TRACING "NONE" CACHE STRING
+  "Tracing backend of the parser scopes: NONE, TRACY or PERFETTO")
+set_property(CACHE SDFORMAT_TRACING PROPERTY STRINGS NONE TRACY PERFETTO)
+string(TOUPPER "${SDFORMAT_TRACING}" SDFORMAT_TRACING_UPPERCASE)
+if ("${SDFORMAT_TRACING_UPPERCASE}" STREQUAL "TRACY")
+  find_package(Tracy CONFIG QUIET)
+  if (Tracy_FOUND)
+    set(SDFORMAT_TRACING_TRACY TRUE)
+  else()
+    BUILD_ERROR("Tracy not found, but SDFORMAT_TRACING is TRACY")
+  endif()
+elseif ("${SDFORMAT_TRACING_UPPERCASE}" STREQUAL "PERFETTO")
+  find_path(PERFETTO_INCLUDE_DIR perfetto.h)
+  find_library(PERFETTO_LIBRARY perfetto)
+  if (PERFETTO_INCLUDE_DIR AND PERFETTO_LIBRARY)
+    set(SDFORMAT_TRACING_PERFETTO TRUE)
+  else()
+    BUILD_ERROR("Perfetto SDK not found, but SDFORMAT_TRACING is PERFETTO")
+  endif()
+elseif (NOT "${SDFORMAT_TRACING_UPPERCASE}" STREQUAL "NONE")
+  BUILD_ERROR("SDFORMAT_TRACING ${SDFORMAT_TRACING} unknown. Valid options are: NONE TRACY PERFETTO")
+endif()
+
 ################################################
 # Find urdfdom parser. Logic:
 #
@@ -67,6 +114,13 @@ if(NOT PY_PSUTIL)
   BUILD_WARNING("Python psutil package not found. Memory leak tests will be skipped")
 endif()
 
+################################################
+# Find Google Benchmark for the optional benchmark suite
+find_package(benchmark QUIET)
+if (NOT benchmark_FOUND)
+  BUILD_WARNING("Google Benchmark not found. Benchmarks will not be built")
+endif()
+
 ################################################
 # Find Valgrind for checking memory leaks in the
 # tests
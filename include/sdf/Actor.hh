@@ -19,6 +19,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <ignition/math/Pose3.hh>
 
@@ -264,6 +265,40 @@ namespace sdf
     /// \param[in] _waypoint Waypoint to be added.
     public: void AddWaypoint(const Waypoint &_waypoint);
 
+    /// \brief Get the pose of the trajectory at a time. Positions follow a
+    /// cubic Hermite spline through the waypoints, sorted by time, with
+    /// tangents scaled by 1 - Tension(), so that a tension of 0 gives a
+    /// Catmull-Rom spline and a tension of 1 stops at every waypoint.
+    /// Rotations are interpolated with a spherical linear interpolation.
+    /// This finds the segment of _time with a binary search.
+    /// \param[in] _time Time of the pose, in seconds.
+    /// \return Pose at _time, the pose of the first or last waypoint if
+    /// _time is outside of the trajectory, or a zero pose if the trajectory
+    /// has no waypoint.
+    public: ignition::math::Pose3d Sample(double _time) const;
+
+    /// \brief Get the pose of the trajectory at a time, starting the search
+    /// of its segment at a hint. When the time increases monotonically
+    /// between calls, passing the same hint each time makes the search
+    /// amortized constant time.
+    /// \param[in] _time Time of the pose, in seconds.
+    /// \param[in,out] _segment Index of the segment found by the previous
+    /// call, or 0. It is set to the index of the segment of _time.
+    /// \return Pose at _time, as with Sample(double).
+    /// \sa ignition::math::Pose3d Sample(double) const
+    public: ignition::math::Pose3d Sample(double _time,
+                uint64_t &_segment) const;
+
+    /// \brief Get the poses of the trajectory at a list of times. Times
+    /// that increase monotonically are sampled in amortized constant time
+    /// each.
+    /// \param[in] _times Times of the poses, in seconds.
+    /// \param[out] _poses Pose at each of _times, resized to the number of
+    /// times.
+    /// \sa ignition::math::Pose3d Sample(double) const
+    public: void SampleAll(const std::vector<double> &_times,
+                std::vector<ignition::math::Pose3d> &_poses) const;
+
     /// \brief Copy trajectory from a trajectory instance.
     /// \param[in] _trajectory The trajectory to set values from.
     public: void CopyFrom(const Trajectory &_trajectory);
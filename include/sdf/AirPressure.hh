@@ -43,7 +43,7 @@ namespace sdf
 
     /// \brief Move constructor
     /// \param[in] _airPressure AirPressure to move.
-    public: AirPressure(AirPressure &&_sensor);
+    public: AirPressure(AirPressure &&_sensor) noexcept;
 
     /// \brief Destructor
     public: ~AirPressure();
@@ -0,0 +1,158 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_ASSET_MANIFEST_HH_
+#define SDF_ASSET_MANIFEST_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "sdf/Error.hh"
+#include "sdf/Types.hh"
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  // Forward declarations.
+  class AssetManifestPrivate;
+  class ParserConfig;
+  class Root;
+
+  /// \enum AssetType
+  /// \brief Kind of an external resource referenced by a document.
+  enum class AssetType : std::uint8_t
+  {
+    /// \brief A mesh of a visual or collision geometry.
+    MESH = 0,
+
+    /// \brief A texture, such as a normal map or a PBR map of a material,
+    /// or a texture of a heightmap.
+    TEXTURE = 1,
+
+    /// \brief A material script.
+    MATERIAL_SCRIPT = 2,
+
+    /// \brief The skin of an actor.
+    SKIN = 3,
+
+    /// \brief An animation of an actor.
+    ANIMATION = 4,
+
+    /// \brief The height image of a heightmap geometry.
+    HEIGHTMAP = 5,
+  };
+
+  /// \brief An external resource of an AssetManifest.
+  struct Asset
+  {
+    /// \brief Kind of the resource, from its first reference.
+    AssetType type = AssetType::MESH;
+
+    /// \brief URI of the first reference, as written in the document.
+    std::string uri;
+
+    /// \brief Absolute path of the resource, or an empty string if it is
+    /// not a local file or could not be found.
+    std::string path;
+
+    /// \brief Number of references to the resource in the document.
+    std::size_t references = 0;
+  };
+
+  /// \brief The external resources referenced by a loaded document, such
+  /// as meshes, textures, material scripts, actor skins and animations,
+  /// and heightmaps, so that an application can fetch them in parallel as
+  /// soon as parsing finishes.
+  ///
+  /// Each resource is resolved once, relative to the file it is referenced
+  /// from, or with findFile for URIs such as "model://", and listed once
+  /// with the number of references to it. Resources are listed in the order
+  /// of their first reference. References with a remote scheme, such as
+  /// "https://", are listed with an empty path.
+  class SDFORMAT_VISIBLE AssetManifest
+  {
+    /// \brief Default constructor
+    public: AssetManifest();
+
+    /// \brief Copy constructor
+    /// \param[in] _manifest AssetManifest to copy.
+    public: AssetManifest(const AssetManifest &_manifest);
+
+    /// \brief Move constructor
+    /// \param[in] _manifest AssetManifest to move.
+    public: AssetManifest(AssetManifest &&_manifest) noexcept;
+
+    /// \brief Move assignment operator.
+    /// \param[in] _manifest AssetManifest to move.
+    /// \return Reference to this.
+    public: AssetManifest &operator=(AssetManifest &&_manifest) noexcept;
+
+    /// \brief Copy assignment operator.
+    /// \param[in] _manifest AssetManifest to copy.
+    /// \return Reference to this.
+    public: AssetManifest &operator=(const AssetManifest &_manifest);
+
+    /// \brief Destructor
+    public: ~AssetManifest();
+
+    /// \brief List the resources of the worlds, models and actors of a
+    /// loaded document. The previous content is replaced.
+    /// \param[in] _root The loaded document.
+    /// \return An URI_LOOKUP error for each local resource that could not
+    /// be found. Those resources are still listed, with an empty path.
+    public: Errors Build(const Root &_root);
+
+    /// \brief List the resources of a loaded document, finding them with
+    /// the URI paths and find callback of a parser configuration.
+    /// \param[in] _root The loaded document.
+    /// \param[in] _config Parser configuration the document was loaded
+    /// with.
+    /// \return An URI_LOOKUP error for each local resource that could not
+    /// be found.
+    public: Errors Build(const Root &_root, const ParserConfig &_config);
+
+    /// \brief Get the number of distinct resources.
+    /// \return Number of resources.
+    public: std::size_t AssetCount() const;
+
+    /// \brief Get a resource by its index.
+    /// \param[in] _index Index of the resource, less than AssetCount().
+    /// \return Pointer to the resource, or nullptr if _index is out of
+    /// range.
+    public: const Asset *AssetByIndex(std::size_t _index) const;
+
+    /// \brief Get a resource by its resolved path.
+    /// \param[in] _path Absolute path of the resource.
+    /// \return Pointer to the resource, or nullptr if no resource has this
+    /// path.
+    public: const Asset *AssetByPath(const std::string &_path) const;
+
+    /// \brief Get the number of references to all resources.
+    /// \return Sum of the references of the resources.
+    public: std::size_t ReferenceCount() const;
+
+    /// \brief Private data pointer.
+    private: AssetManifestPrivate *dataPtr = nullptr;
+  };
+  }
+}
+#endif
@@ -17,6 +17,7 @@
 #ifndef SDF_BOX_HH_
 #define SDF_BOX_HH_
 
+#include <ignition/math/AxisAlignedBox.hh>
 #include <ignition/math/Box.hh>
 #include <ignition/math/Vector3.hh>
 #include <sdf/Error.hh>
@@ -89,6 +90,16 @@ namespace sdf
     /// \return A reference to an ignition::math::Boxd object.
     public: ignition::math::Boxd &Shape();
 
+    /// \brief Get the axis aligned bounding box of the box, relative to
+    /// its frame.
+    /// \return The smallest box that contains the box.
+    public: ignition::math::AxisAlignedBox AxisAlignedBox() const;
+
+    /// \brief Get the radius of the smallest sphere centered on the origin
+    /// of the box frame that contains the box.
+    /// \return The radius in meters.
+    public: double BoundingRadius() const;
+
     /// \brief Private data pointer.
     private: BoxPrivate *dataPtr;
   };
@@ -18,7 +18,10 @@
 #define SDF_CAMERA_HH_
 
 #include <string>
+#include <ignition/math/Matrix3.hh>
+#include <ignition/math/Matrix4.hh>
 #include <ignition/math/Pose3.hh>
+#include <ignition/math/Vector2.hh>
 
 #include <sdf/Error.hh>
 #include <sdf/Element.hh>
@@ -440,6 +443,41 @@ namespace sdf
     /// \param[in] _s The lens XY axis skew.
     public: void SetLensIntrinsicsSkew(double _s);
 
+    /// \brief Get the intrinsic matrix of the camera, [fx s cx; 0 fy cy;
+    /// 0 0 1] in pixels. The lens intrinsics are used once they are loaded
+    /// from <lens><intrinsics> or set. Otherwise both focal lengths are
+    /// derived from the horizontal field of view and the image width, with
+    /// the principal point at the center of the image and no skew. The
+    /// matrix is computed once, and again after the properties it depends on
+    /// are set.
+    /// \return The intrinsic matrix.
+    public: ignition::math::Matrix3d IntrinsicMatrix() const;
+
+    /// \brief Get the OpenGL projection matrix of the camera, from its
+    /// intrinsic matrix, image size and clip distances, for eye coordinates
+    /// that look down -Z with +Y up and images whose rows go down. It is
+    /// cached with the intrinsic matrix.
+    /// \return The projection matrix.
+    public: ignition::math::Matrix4d ProjectionMatrix() const;
+
+    /// \brief Get the lookup table of the lens distortion, which gives for
+    /// each pixel of the undistorted image its position in the distorted
+    /// image, in pixels. The position follows the Brown-Conrady model with
+    /// the radial coefficients k1, k2 and k3 and the tangential coefficients
+    /// p1 and p2, around the distortion center, scaled by the focal lengths
+    /// of IntrinsicMatrix. Positions are continuous, with the image spanning
+    /// [0, width] x [0, height], and the entry of pixel (u, v) is for its
+    /// center (u + 0.5, v + 0.5).
+    ///
+    /// The table is built the first time it is requested, and cameras with
+    /// the same image size, focal lengths and distortion share one table,
+    /// which is freed with the last of them.
+    /// \return Array of ImageWidth() * ImageHeight() positions, pixel (u, v)
+    /// at index v * ImageWidth() + u, or nullptr if the image is empty. It
+    /// is valid until the properties it depends on are set, or the camera is
+    /// destroyed.
+    public: const ignition::math::Vector2f *DistortionMap() const;
+
     /// \brief Convert a string to a PixelFormatType.
     /// \param[in] _format String equivalent of a pixel format type to convert.
     /// \return The matching PixelFormatType.
@@ -0,0 +1,83 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_CANCELLATION_TOKEN_HH_
+#define SDF_CANCELLATION_TOKEN_HH_
+
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  // Forward declarations.
+  class CancellationTokenPrivate;
+
+  /// \brief Flag that stops the loads that use it, set with
+  /// ParserConfig::SetCancellation. Cancel can be called from any thread
+  /// while the loads run, e.g. when the user closes the world being loaded.
+  /// The loads check the flag before each element they read, each
+  /// <include> they resolve, each document they convert and each frame
+  /// graph they build, so they return soon after it is set, with an
+  /// ErrorCode::LOAD_CANCELLED error.
+  class SDFORMAT_VISIBLE CancellationToken
+  {
+    /// \brief Default constructor
+    public: CancellationToken();
+
+    /// \brief Copy constructor
+    /// \param[in] _token CancellationToken to copy.
+    public: CancellationToken(const CancellationToken &_token);
+
+    /// \brief Move constructor
+    /// \param[in] _token CancellationToken to move.
+    public: CancellationToken(CancellationToken &&_token) noexcept;
+
+    /// \brief Move assignment operator.
+    /// \param[in] _token CancellationToken to move.
+    /// \return Reference to this.
+    public: CancellationToken &operator=(CancellationToken &&_token) noexcept;
+
+    /// \brief Copy assignment operator.
+    /// \param[in] _token CancellationToken to copy.
+    /// \return Reference to this.
+    public: CancellationToken &operator=(const CancellationToken &_token);
+
+    /// \brief Destructor
+    public: ~CancellationToken();
+
+    /// \brief Stop the loads that use this token. It can be called from
+    /// any thread.
+    public: void Cancel();
+
+    /// \brief Get whether Cancel was called since the token was created or
+    /// reset.
+    /// \return True if the token is cancelled.
+    public: bool Cancelled() const;
+
+    /// \brief Clear the flag, so that the token can be used by new loads.
+    /// It must not be called while a load uses the token.
+    public: void Reset();
+
+    /// \brief Private data pointer.
+    private: CancellationTokenPrivate *dataPtr = nullptr;
+  };
+  }
+}
+#endif
@@ -17,6 +17,7 @@
 #ifndef SDF_CAPSULE_HH_
 #define SDF_CAPSULE_HH_
 
+#include <ignition/math/AxisAlignedBox.hh>
 #include <ignition/math/Capsule.hh>
 #include <sdf/Error.hh>
 #include <sdf/Element.hh>
@@ -97,6 +98,16 @@ namespace sdf
     /// \return A reference to an ignition::math::Capsuled object.
     public: ignition::math::Capsuled &Shape();
 
+    /// \brief Get the axis aligned bounding box of the capsule, relative to
+    /// its frame.
+    /// \return The smallest box that contains the capsule.
+    public: ignition::math::AxisAlignedBox AxisAlignedBox() const;
+
+    /// \brief Get the radius of the smallest sphere centered on the origin
+    /// of the capsule frame that contains the capsule.
+    /// \return The radius in meters.
+    public: double BoundingRadius() const;
+
     /// \brief Private data pointer.
     private: CapsulePrivate *dataPtr;
   };
@@ -34,6 +34,7 @@ namespace sdf
   // Forward declaration.
   class CollisionPrivate;
   class Geometry;
+  class MeshRegistry;
   class Surface;
   struct PoseRelativeToGraph;
   template <typename T> class ScopedGraph;
@@ -149,9 +150,16 @@ namespace sdf
     private: void SetPoseRelativeToGraph(
         sdf::ScopedGraph<PoseRelativeToGraph> _graph);
 
+    /// \brief Share the mesh of the geometry through the mesh registry of
+    /// the Root. This is private and is intended to be called by
+    /// Link::ShareMeshes.
+    /// \param[in,out] _registry Mesh registry of the Root.
+    private: void ShareMesh(MeshRegistry &_registry);
+
     /// \brief Allow Link::SetPoseRelativeToGraph to call SetXmlParentName
-    /// and SetPoseRelativeToGraph, but Link::SetPoseRelativeToGraph is
-    /// a private function, so we need to befriend the entire class.
+    /// and SetPoseRelativeToGraph, and Link::ShareMeshes to call ShareMesh,
+    /// but these are private functions, so we need to befriend the entire
+    /// class.
     friend class Link;
 
     /// \brief Private data pointer.
@@ -43,19 +43,24 @@ namespace sdf
   /// \{
 
   /// \brief Output a debug message
-  #define sdfdbg (sdf::Console::Instance()->Log("Dbg", __FILE__, __LINE__))
+  #define sdfdbg !sdf::Console::Enabled(4) ? (void)0 : \
+      sdf::Console::MessageEnd() & \
+      sdf::Console::Instance()->Log("Dbg", __FILE__, __LINE__)
 
   /// \brief Output a message
-  #define sdfmsg (sdf::Console::Instance()->ColorMsg("Msg", \
-                                                     __FILE__, __LINE__, 32))
+  #define sdfmsg !sdf::Console::Enabled(3) ? (void)0 : \
+      sdf::Console::MessageEnd() & \
+      sdf::Console::Instance()->ColorMsg("Msg", __FILE__, __LINE__, 32)
 
   /// \brief Output a warning message
-  #define sdfwarn (sdf::Console::Instance()->ColorMsg("Warning", \
-                                                      __FILE__, __LINE__, 33))
+  #define sdfwarn !sdf::Console::Enabled(2) ? (void)0 : \
+      sdf::Console::MessageEnd() & \
+      sdf::Console::Instance()->ColorMsg("Warning", __FILE__, __LINE__, 33)
 
   /// \brief Output an error message
-  #define sdferr (sdf::Console::Instance()->ColorMsg("Error", \
-                                                     __FILE__, __LINE__, 31))
+  #define sdferr !sdf::Console::Enabled(1) ? (void)0 : \
+      sdf::Console::MessageEnd() & \
+      sdf::Console::Instance()->ColorMsg("Error", __FILE__, __LINE__, 31)
 
   class ConsolePrivate;
   class Console;
@@ -65,6 +70,14 @@ namespace sdf
   typedef std::shared_ptr<Console> ConsolePtr;
 
   /// \brief Message, error, warning, and logging functionality
+  ///
+  /// The parts of a message are collected in a buffer of the calling
+  /// thread, and the message is written at once when it ends, so that
+  /// messages of different threads are not interleaved. The message ends
+  /// with the statement for sdferr, sdfwarn, sdfmsg and sdfdbg, and else
+  /// with ConsoleStream::End, when the next message of the thread starts, or
+  /// on Flush. Messages are written to the terminal right away, and to the
+  /// log file by a background thread.
   class SDFORMAT_VISIBLE Console
   {
     /// \brief An ostream-like class that we'll use for logging.
@@ -76,14 +89,16 @@ namespace sdf
       public: ConsoleStream(std::ostream *_stream) :
               stream(_stream) {}
 
-      /// \brief Redirect whatever is passed in to both our ostream
-      ///        (if non-NULL) and the log file (if open).
+      /// \brief Add whatever is passed in to the current message, which is
+      /// written to both our ostream (if non-NULL) and the log file (if
+      /// open). Nothing is formatted if the message goes nowhere.
       /// \param[in] _rhs Content to be logged.
       /// \return Reference to myself.
       public: template <class T>
         ConsoleStream &operator<<(const T &_rhs);
 
-      /// \brief Print a prefix to both terminal and log file.
+      /// \brief Start a message with a prefix for both terminal and log
+      /// file. This ends the previous message of the calling thread.
       /// \param[in] _lbl Text label
       /// \param[in] _file File containing the error
       /// \param[in] _line Line containing the error
@@ -92,14 +107,31 @@ namespace sdf
                           const std::string &_file,
                           unsigned int _line, int _color);
 
+      /// \brief End the current message of the calling thread and write it.
+      public: void End();
+
+      /// \brief Get the buffer of the current message of the calling
+      /// thread.
+      /// \return The buffer, or nullptr if the message is written nowhere.
+      private: std::ostream *Buffer();
+
       /// \brief The ostream to log to; can be NULL/nullptr.
       private: std::ostream *stream;
     };
 
+    /// \brief Ends the message of the expression it is applied to, see
+    /// sdferr.
+    public: class SDFORMAT_VISIBLE MessageEnd
+    {
+      /// \brief End the message of a stream.
+      /// \param[in] _stream The stream.
+      public: void operator&(ConsoleStream &_stream) const;
+    };
+
     /// \brief Default constructor
     private: Console();
 
-    /// \brief Destructor
+    /// \brief Destructor. Writes the pending messages.
     public: virtual ~Console();
 
     /// \brief Return an instance to this class.
@@ -112,6 +144,39 @@ namespace sdf
     /// \param[in] q True to prevent warning
     public: void SetQuiet(bool _q);
 
+    /// \brief Set which messages are output, for all instances. Messages
+    /// above the verbosity are discarded before they are formatted.
+    /// \param[in] _verbosity 0 for no messages, 1 for errors, 2 to add
+    /// warnings, 3 to add messages and 4, which is the default, to add debug
+    /// messages.
+    public: static void SetVerbosity(int _verbosity);
+
+    /// \brief Get which messages are output.
+    /// \return The verbosity.
+    /// \sa SetVerbosity
+    public: static int Verbosity();
+
+    /// \brief Check if messages of a level are output.
+    /// \param[in] _level 1 for errors, 2 for warnings, 3 for messages and 4
+    /// for debug messages.
+    /// \return True if the level is at most the verbosity.
+    public: static bool Enabled(int _level);
+
+    /// \brief Set how many times an identical warning, from the same file
+    /// and line, is output. Further repetitions are counted, and reported
+    /// by Flush. The default is 0, which outputs every repetition.
+    /// \param[in] _limit Maximum number of repetitions, or 0 for no limit.
+    public: void SetRepeatLimit(unsigned int _limit);
+
+    /// \brief Get how many times an identical warning is output.
+    /// \return The maximum number of repetitions, 0 for no limit.
+    public: unsigned int RepeatLimit() const;
+
+    /// \brief Write the pending message of the calling thread, report the
+    /// number of suppressed repetitions of warnings, and wait until the log
+    /// file is written.
+    public: void Flush();
+
     /// \brief Use this to output a colored message to the terminal
     /// \param[in] _lbl Text label
     /// \param[in] _file File containing the error
@@ -131,38 +196,18 @@ namespace sdf
     /// \internal
     /// \brief Pointer to private data.
     private: std::unique_ptr<ConsolePrivate> dataPtr;
-  };
 
-  /// \internal
-  /// \brief Private data for Console
-  class ConsolePrivate
-  {
-    /// \brief Constructor
-    public: ConsolePrivate() : msgStream(&std::cerr), logStream(nullptr) {}
-
-    /// \brief message stream
-    public: Console::ConsoleStream msgStream;
-
-    /// \brief log stream
-    public: Console::ConsoleStream logStream;
-
-    /// \brief logfile stream
-    public: std::ofstream logFileStream;
+    /// \brief Writes the messages collected by ConsoleStream.
+    friend class ConsoleStream;
   };
 
   ///////////////////////////////////////////////
   template <class T>
   Console::ConsoleStream &Console::ConsoleStream::operator<<(const T &_rhs)
   {
-    if (this->stream)
-    {
-      *this->stream << _rhs;
-    }
-
-    if (Console::Instance()->dataPtr->logFileStream.is_open())
+    if (std::ostream *buffer = this->Buffer())
     {
-      Console::Instance()->dataPtr->logFileStream << _rhs;
-      Console::Instance()->dataPtr->logFileStream.flush();
+      *buffer << _rhs;
     }
 
     return *this;
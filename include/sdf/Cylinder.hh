@@ -17,6 +17,7 @@
 #ifndef SDF_CYLINDER_HH_
 #define SDF_CYLINDER_HH_
 
+#include <ignition/math/AxisAlignedBox.hh>
 #include <ignition/math/Cylinder.hh>
 #include <sdf/Error.hh>
 #include <sdf/Element.hh>
@@ -97,6 +98,16 @@ namespace sdf
     /// \return A reference to an ignition::math::Cylinderd object.
     public: ignition::math::Cylinderd &Shape();
 
+    /// \brief Get the axis aligned bounding box of the cylinder, relative to
+    /// its frame.
+    /// \return The smallest box that contains the cylinder.
+    public: ignition::math::AxisAlignedBox AxisAlignedBox() const;
+
+    /// \brief Get the radius of the smallest sphere centered on the origin
+    /// of the cylinder frame that contains the cylinder.
+    /// \return The radius in meters.
+    public: double BoundingRadius() const;
+
     /// \brief Private data pointer.
     private: CylinderPrivate *dataPtr;
   };
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_DIAGNOSTIC_SINK_HH_
+#define SDF_DIAGNOSTIC_SINK_HH_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  // Forward declarations.
+  class DiagnosticBufferPrivate;
+
+  /// \enum DiagnosticLevel
+  /// \brief Level of a diagnostic message, which matches the verbosity of
+  /// Console::SetVerbosity that outputs it.
+  enum class DiagnosticLevel
+  {
+    /// \brief An error, written with sdferr.
+    ERROR = 1,
+
+    /// \brief A warning, written with sdfwarn.
+    WARNING = 2,
+
+    /// \brief A message, written with sdfmsg.
+    MESSAGE = 3,
+
+    /// \brief A debug message, written with sdfdbg.
+    DEBUG = 4,
+  };
+
+  /// \brief A message written to the console while loading a document.
+  struct SDFORMAT_VISIBLE Diagnostic
+  {
+    /// \brief Level of the message.
+    DiagnosticLevel level = DiagnosticLevel::MESSAGE;
+
+    /// \brief Text of the message, without the final line break.
+    std::string message;
+
+    /// \brief Name of the source file of the library that wrote the
+    /// message, without its directory.
+    std::string file;
+
+    /// \brief Line of the source file that wrote the message.
+    unsigned int line = 0;
+  };
+
+  /// \brief Receives the messages that the loads using it write with
+  /// sdferr, sdfwarn, sdfmsg and sdfdbg, instead of the Console.
+  /// ParserConfig::SetDiagnostics sets the sink of a load.
+  ///
+  /// Messages are given whole, on the thread that wrote them, which can be
+  /// any of the threads of a parallel load, so Write has to be thread safe.
+  /// Messages above the verbosity of the Console are still discarded before
+  /// they are formatted.
+  class SDFORMAT_VISIBLE DiagnosticSink
+  {
+    /// \brief Destructor
+    public: virtual ~DiagnosticSink();
+
+    /// \brief Called with each message of a load.
+    /// \param[in] _diagnostic The message.
+    public: virtual void Write(const Diagnostic &_diagnostic) = 0;
+  };
+
+  /// \brief A sink that collects the messages of the loads using it, in the
+  /// order they are written.
+  class SDFORMAT_VISIBLE DiagnosticBuffer : public DiagnosticSink
+  {
+    /// \brief Constructor
+    /// \param[in] _level Messages above this level are dropped. The default
+    /// keeps errors and warnings.
+    public: explicit DiagnosticBuffer(
+                DiagnosticLevel _level = DiagnosticLevel::WARNING);
+
+    /// \brief Copy constructor is deleted, since other threads may write
+    /// to the buffer.
+    public: DiagnosticBuffer(const DiagnosticBuffer &_buffer) = delete;
+
+    /// \brief Copy assignment operator is deleted, see the copy
+    /// constructor.
+    public: DiagnosticBuffer &operator=(
+                const DiagnosticBuffer &_buffer) = delete;
+
+    /// \brief Destructor
+    public: ~DiagnosticBuffer() override;
+
+    // Documentation inherited.
+    public: void Write(const Diagnostic &_diagnostic) override;
+
+    /// \brief Get the collected messages.
+    /// \return Copy of the messages.
+    public: std::vector<Diagnostic> Diagnostics() const;
+
+    /// \brief Get the number of collected messages of a level.
+    /// \param[in] _level The level.
+    /// \return Number of messages.
+    public: std::size_t Count(DiagnosticLevel _level) const;
+
+    /// \brief Remove the collected messages.
+    public: void Clear();
+
+    /// \brief Private data pointer.
+    private: DiagnosticBufferPrivate *dataPtr = nullptr;
+  };
+  }
+}
+#endif
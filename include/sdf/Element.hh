@@ -18,16 +18,24 @@
 #define SDF_ELEMENT_HH_
 
 #include <any>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <map>
 #include <memory>
+#include <ostream>
 #include <set>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "sdf/MemoryFootprint.hh"
 #include "sdf/Param.hh"
 #include "sdf/sdf_config.h"
 #include "sdf/system_util.hh"
+#include "sdf/TextRange.hh"
 #include "sdf/Types.hh"
 
 #ifdef _WIN32
@@ -45,13 +53,23 @@ namespace sdf
   inline namespace SDF_VERSION_NAMESPACE {
   //
 
+  class ElementEditPrivate;
+  class ElementPatchPrivate;
   class ElementPrivate;
+  class ElementSnapshotPrivate;
+  class ElementTagIndex;
+  class LazyChildren;
+  class LazyDescriptions;
   class SDFORMAT_VISIBLE Element;
 
   /// \def ElementPtr
   /// \brief Shared pointer to an SDF Element
   typedef std::shared_ptr<Element> ElementPtr;
 
+  /// \def ElementConstPtr
+  /// \brief Shared pointer to a const SDF Element
+  typedef std::shared_ptr<const Element> ElementConstPtr;
+
   /// \def ElementWeakPtr
   /// \brief Weak pointer to an SDF Element
   typedef std::weak_ptr<Element> ElementWeakPtr;
@@ -63,6 +81,115 @@ namespace sdf
   /// \addtogroup sdf
   /// \{
 
+  /// \brief Range of the child elements of an element, or of its child
+  /// elements of one name, that are visited as references without copying
+  /// smart pointers or locking the parent of each child. The range refers
+  /// to the children of the element, so it must not be used once children
+  /// are added to or removed from the element.
+  /// \sa Element::Children
+  class ElementChildren
+  {
+    /// \brief Iterator over the children of the range.
+    public: class Iterator
+    {
+      /// \brief Constructor.
+      /// \param[in] _pos Position of a child.
+      /// \param[in] _end End of the children.
+      /// \param[in] _name Name of the visited children, or nullptr to
+      /// visit every child.
+      public: Iterator(const ElementPtr *_pos, const ElementPtr *_end,
+                  const std::string *_name)
+              : pos(_pos), end(_end), name(_name)
+      {
+      }
+
+      /// \brief Get the current child.
+      /// \return The current child.
+      public: const Element &operator*() const
+      {
+        return **this->pos;
+      }
+
+      /// \brief Get the current child.
+      /// \return Pointer to the current child.
+      public: const Element *operator->() const
+      {
+        return this->pos->get();
+      }
+
+      /// \brief Move to the next child of the range.
+      /// \return Reference to this.
+      public: inline Iterator &operator++();
+
+      /// \brief Compare the positions of two iterators.
+      /// \param[in] _other Iterator of the same range.
+      /// \return True if the iterators are at different positions.
+      public: bool operator!=(const Iterator &_other) const
+      {
+        return this->pos != _other.pos;
+      }
+
+      /// \brief Compare the positions of two iterators.
+      /// \param[in] _other Iterator of the same range.
+      /// \return True if the iterators are at the same position.
+      public: bool operator==(const Iterator &_other) const
+      {
+        return this->pos == _other.pos;
+      }
+
+      /// \brief Position of the current child.
+      private: const ElementPtr *pos;
+
+      /// \brief End of the children.
+      private: const ElementPtr *end;
+
+      /// \brief Interned name of the visited children, or nullptr to
+      /// visit every child.
+      private: const std::string *name;
+    };
+
+    /// \brief Constructor.
+    /// \param[in] _begin First visited child.
+    /// \param[in] _end End of the children.
+    /// \param[in] _name Interned name of the visited children, or nullptr
+    /// to visit every child.
+    public: ElementChildren(const ElementPtr *_begin, const ElementPtr *_end,
+                const std::string *_name)
+            : first(_begin), last(_end), name(_name)
+    {
+    }
+
+    /// \brief Get an iterator at the first child of the range.
+    /// \return Iterator at the first child.
+    public: Iterator begin() const
+    {
+      return Iterator(this->first, this->last, this->name);
+    }
+
+    /// \brief Get an iterator past the last child of the range.
+    /// \return Iterator past the last child.
+    public: Iterator end() const
+    {
+      return Iterator(this->last, this->last, this->name);
+    }
+
+    /// \brief Get whether the range has no children.
+    /// \return True if there are no children in the range.
+    public: bool empty() const
+    {
+      return this->first == this->last;
+    }
+
+    /// \brief First visited child.
+    private: const ElementPtr *first;
+
+    /// \brief End of the children.
+    private: const ElementPtr *last;
+
+    /// \brief Interned name of the visited children, or nullptr.
+    private: const std::string *name;
+  };
+
   /// \class Element Element.hh sdf/sdf.hh
   /// \brief SDF Element class
   class SDFORMAT_VISIBLE Element :
@@ -78,6 +205,27 @@ namespace sdf
     /// \return A copy of this Element.
     public: ElementPtr Clone() const;
 
+    /// \brief Create a copy of this Element, cloning large subtrees on
+    /// several threads. The top of the tree is cloned first, until there
+    /// are enough subtrees to share between the threads, and the subtrees
+    /// are then cloned concurrently. The result is the same as Clone().
+    /// \param[in] _threadCount Maximum number of threads to use. A value of
+    /// 0 uses one thread per hardware thread, and a value of 1 is the same
+    /// as Clone().
+    /// \return A copy of this Element.
+    public: ElementPtr Clone(unsigned int _threadCount) const;
+
+    /// \brief Wait until the elements released in the background so far
+    /// are destroyed. \sa ParserConfig::SetReleaseElementsInBackground
+    public: static void WaitForBackgroundRelease();
+
+    /// \brief Create an element from this element description: a copy of
+    /// this element without its children, which shares the child
+    /// descriptions instead of copying them. This is how the parser and
+    /// AddElement create elements.
+    /// \return The new element, without a parent.
+    public: ElementPtr Instantiate() const;
+
     /// \brief Copy values from an Element.
     /// \param[in] _elem Element to copy value from.
     public: void Copy(const ElementPtr _elem);
@@ -160,6 +308,116 @@ namespace sdf
     /// \return The string representation.
     public: std::string ToString(const std::string &_prefix) const;
 
+    /// \brief Write the element values as XML directly to a stream,
+    /// without building the string representation in memory first. The
+    /// output matches ToString, with children indented by two more spaces
+    /// per level.
+    /// \param[out] _out Stream to write to.
+    /// \param[in] _indent Number of spaces to indent this element by.
+    /// \param[in] _compact True to write the XML without indentation and
+    /// line breaks.
+    public: void ToStream(std::ostream &_out, std::size_t _indent = 0,
+                          bool _compact = false) const;
+
+    /// \brief Write the element values as XML into separate buffers,
+    /// serializing large subtrees on several threads. The tree is split at
+    /// the first element, from this one down, with more than one child,
+    /// e.g. at the world of an sdf element, and each of its children is
+    /// written to its own buffer concurrently. In order, the buffers hold
+    /// the same XML as ToStream.
+    /// \param[in] _indent Number of spaces to indent this element by.
+    /// \param[in] _compact True to write the XML without indentation and
+    /// line breaks.
+    /// \param[in] _threadCount Maximum number of threads to use. A value of
+    /// 0 uses one thread per hardware thread, and a value of 1 writes a
+    /// single buffer on the calling thread.
+    /// \return The buffers, to be written one after the other.
+    public: std::vector<std::string> ToBuffers(std::size_t _indent,
+                bool _compact, unsigned int _threadCount) const;
+
+    /// \brief Write the element values as XML to a stream, serializing
+    /// large subtrees on several threads first, see ToBuffers.
+    /// \param[out] _out Stream to write to.
+    /// \param[in] _indent Number of spaces to indent this element by.
+    /// \param[in] _compact True to write the XML without indentation and
+    /// line breaks.
+    /// \param[in] _threadCount Maximum number of threads to use.
+    public: void ToStream(std::ostream &_out, std::size_t _indent,
+                          bool _compact, unsigned int _threadCount) const;
+
+    /// \brief Get a structural hash of this element and its descendants.
+    /// The hash covers the element name, the include file, the attributes
+    /// that ToString writes, the value and, in order, the hashes of the
+    /// children, so two elements with equal hashes have the same content
+    /// with overwhelming probability. The hash of every element in the
+    /// tree is cached, and adding, removing or renaming elements
+    /// recomputes only the hashes of their ancestors, so repeated calls on
+    /// an unchanged tree cost O(1). Changing a Param value invalidates the
+    /// cached hashes of all elements. Hashes don't depend on the platform
+    /// or process, so they can be stored and compared later. Like other
+    /// accessors that read deferred children, this isn't safe to call
+    /// concurrently on the same tree.
+    /// \return The content hash.
+    public: std::uint64_t ContentHash() const;
+
+    /// \brief Get the memory used by this element and its descendants.
+    /// Deferred children are counted as the text they will be read from.
+    /// Descriptions are counted once each, without the descriptions of
+    /// their child elements. Only the elements, params, descriptions and
+    /// strings categories are set.
+    /// \return Estimated footprint of the subtree.
+    public: MemoryFootprint MemoryUsage() const;
+
+    /// \brief Get whether a parameter of this element or of one of its
+    /// descendants changed since ClearDirty was called. Elements that were
+    /// just read are dirty, since reading sets their parameters, so
+    /// ClearDirty is typically called once the whole tree has been
+    /// written. Clones have the dirty flags of the original. Only
+    /// parameter values are tracked; adding or removing elements doesn't
+    /// make them dirty. \sa ElementPatch
+    /// \return True if a parameter changed.
+    public: bool Dirty() const;
+
+    /// \brief Mark the parameters of this element and of its descendants
+    /// as unchanged. Only dirty subtrees are visited.
+    public: void ClearDirty();
+
+    /// \brief Write only what changed since ClearDirty, as an SDF fragment
+    /// with the structure of this element. Dirty elements are written with
+    /// their name attribute, so that they can be identified, and the
+    /// attributes and value that changed. Elements that didn't change are
+    /// left out.
+    /// \param[out] _out Stream to write to.
+    /// \param[in] _indent Number of spaces to indent this element by.
+    /// \param[in] _compact True to write the XML without indentation and
+    /// line breaks.
+    /// \sa Dirty
+    public: void DirtyToStream(std::ostream &_out, std::size_t _indent = 0,
+                               bool _compact = false) const;
+
+    /// \brief Write only what changed since ClearDirty to a string.
+    /// \param[in] _prefix String value to prefix to the output.
+    /// \return The changes, as DirtyToStream writes them, or an empty
+    /// string if nothing changed.
+    public: std::string DirtyToString(const std::string &_prefix) const;
+
+    /// \brief Index the elements of this tree by name, so that
+    /// ElementQuery finds them without walking the tree. Elements inserted
+    /// into the tree afterwards are indexed as well, and removed elements
+    /// are skipped by queries. Indexed elements are matched through their
+    /// parents, so elements inserted without SetParent are only found by
+    /// queries on trees without an index. The index is built on the root of
+    /// the document, is not cloned, and nested indices are not supported.
+    /// Building the index reads deferred children. \sa ElementQuery
+    public: void BuildTagIndex();
+
+    /// \brief Drop the index built by BuildTagIndex.
+    public: void ClearTagIndex();
+
+    /// \brief Get whether BuildTagIndex was called on this element.
+    /// \return True if this element holds a tag index.
+    public: bool HasTagIndex() const;
+
     /// \brief Add an attribute value.
     /// \param[in] _key Key value.
     /// \param[in] _type Type of data the attribute will hold.
@@ -201,7 +459,19 @@ namespace sdf
     /// \brief Get the param of an attribute.
     /// \param[in] _key the name of the attribute.
     /// \return The parameter attribute value. NULL if the key is invalid.
-    public: ParamPtr GetAttribute(const std::string &_key) const;
+    public: ParamPtr GetAttribute(std::string_view _key) const;
+
+    /// \brief Get the param of an attribute without copying a smart
+    /// pointer, for read-only walks.
+    /// \param[in] _key the name of the attribute.
+    /// \return The attribute, valid while the element keeps it, or nullptr
+    /// if the key is invalid.
+    public: const Param *FindAttribute(std::string_view _key) const;
+
+    /// \brief Get the attributes of this element, for read-only walks that
+    /// don't copy their smart pointers.
+    /// \return The attributes, in the order of GetAttribute(unsigned int).
+    public: const Param_V &Attributes() const;
 
     /// \brief Get the number of attributes.
     /// \return The number of attributes.
@@ -245,6 +515,23 @@ namespace sdf
     /// return A Param pointer to the value of this element.
     public: ParamPtr GetValue() const;
 
+    /// \brief Get the param of the value of this element without copying
+    /// a smart pointer, for read-only walks.
+    /// \return The value of this element, or nullptr if it has none.
+    public: const Param *FindValue() const;
+
+    /// \brief Call a function for the value and every attribute of this
+    /// element and of all its descendants, depth first, with each value as
+    /// the type that its parameter holds. The values are neither copied nor
+    /// boxed as with GetAny, so generic tools can read every value of a
+    /// document without allocating. Children that are read lazily are read
+    /// first.
+    /// \param[in] _visitor Function, usually a generic lambda, called as
+    /// _visitor(const Element &, const Param &, const T &) with the element,
+    /// the parameter, and its value of type T.
+    public: template<typename F>
+            void VisitAttributes(F &&_visitor) const;
+
     /// \brief Get the element value/attribute as a std::any.
     /// \param[in] _key The key of the attribute. If empty, get the value of
     /// the element. Defaults to empty.
@@ -255,10 +542,10 @@ namespace sdf
     /// exists.
     /// \param[in] _key the name of a child attribute or element.
     /// \return The value of the _key.
-    /// \sa std::pair<T, bool> Get(const std::string &_key,
+    /// \sa std::pair<T, bool> Get(std::string_view _key,
     /// const T &_defaultValue)
     public: template<typename T>
-            T Get(const std::string &_key = "") const;
+            T Get(std::string_view _key = "") const;
 
     /// \brief Get the value of a key.
     /// \param[in] _key the name of a child attribute or element.
@@ -267,7 +554,7 @@ namespace sdf
     /// \return A pair where the first element is the value of _key, and the
     /// second element is true when the _key was found and false otherwise.
     public: template<typename T>
-            std::pair<T, bool> Get(const std::string &_key,
+            std::pair<T, bool> Get(std::string_view _key,
                                    const T &_defaultValue) const;
 
     /// \brief Get the value of a key.
@@ -277,7 +564,7 @@ namespace sdf
     /// found.
     /// \return True when the _key was found and false otherwise.
     public: template<typename T>
-            bool Get(const std::string &_key,
+            bool Get(std::string_view _key,
                      T &_param,
                      const T &_defaultValue) const;
 
@@ -292,6 +579,14 @@ namespace sdf
     /// \return True if the named element was found, false otherwise.
     public: bool HasElement(const std::string &_name) const;
 
+    /// \brief Get the number of child elements with a name, such as the
+    /// number of <link> elements of a <model>. This is a constant time
+    /// lookup, which loaders use to reserve their containers before
+    /// walking the children with GetNextElement.
+    /// \param[in] _name Name of the child elements to count.
+    /// \return Number of child elements named _name.
+    public: std::size_t CountChildren(const std::string &_name) const;
+
     /// \brief Get the first child element.
     /// \return A smart pointer to the first child of this element, or
     ///          sdf::ElementPtr(nullptr) if there are no children.
@@ -310,6 +605,27 @@ namespace sdf
     /// child = child->GetNextElement() to iterate through the children.
     public: ElementPtr GetNextElement(const std::string &_name = "") const;
 
+    /// \brief Get the child elements, or the child elements of one name,
+    /// as a range of references. Unlike GetFirstElement and GetNextElement,
+    /// the walk neither copies smart pointers nor locks the parent of each
+    /// child, so read-only walks of large documents should prefer it:
+    /// \code
+    /// for (const sdf::Element &link : model->Children("link"))
+    ///   std::cout << link.Get<std::string>("name") << "\n";
+    /// \endcode
+    /// \param[in] _name If not empty, only the children of this name are
+    /// visited, starting at the first of them without a search.
+    /// \return The range of children, which must not be used once children
+    /// are added to or removed from this element.
+    public: ElementChildren Children(const std::string &_name = "") const;
+
+    /// \brief Get the first child element with the provided name without
+    /// copying a smart pointer or adding it.
+    /// \param[in] _name Name of the child element to find.
+    /// \return The first child element named _name, valid while this
+    /// element keeps it, or nullptr if there is none.
+    public: const Element *FindElement(const std::string &_name) const;
+
     /// \brief Get set of child element type names.
     /// \return A set of the names of the child elements.
     public: std::set<std::string> GetElementTypeNames() const;
@@ -321,6 +637,10 @@ namespace sdf
     /// \return True if all child elements with name attributes of the
     /// specified type have unique names, return false if there are duplicated
     /// names. Also return true if no elements of the specified type are found.
+    /// The result for all child elements is computed when the element is
+    /// read, and kept until its children or their names change, so checks
+    /// of the same element, and of any type when the names are unique, don't
+    /// compare the names again.
     public: bool HasUniqueChildNames(const std::string &_type = "") const;
 
     /// \brief Count the number of child elements of the specified element type
@@ -344,6 +664,17 @@ namespace sdf
     /// element if an existing child element did not exist.
     public: ElementPtr GetElement(const std::string &_name);
 
+    /// \brief Get the child element with the provided name without adding
+    /// it. Unlike GetElement, a missing child is not created from its
+    /// description: the description itself is returned, so that optional
+    /// elements can be read for their default values without growing the
+    /// tree.
+    /// \param[in] _name Name of the child element to retrieve.
+    /// \return The first child element named _name, or else the description
+    /// of such a child, or nullptr if there is neither.
+    public: ElementConstPtr GetElementOrDefault(
+                const std::string &_name) const;
+
     /// \brief Add a named element.
     /// \param[in] _name the name of the element to add.
     /// \return A pointer to the newly created Element object.
@@ -353,6 +684,12 @@ namespace sdf
     /// \param[in] _elem the element object to add.
     public: void InsertElement(ElementPtr _elem);
 
+    /// \brief Add an element object at a position among the children.
+    /// \param[in] _elem the element object to add.
+    /// \param[in] _index Position of the element. The element is appended
+    /// if _index is not less than the number of children.
+    public: void InsertElement(ElementPtr _elem, std::size_t _index);
+
     /// \brief Remove this element from its parent.
     public: void RemoveFromParent();
 
@@ -400,6 +737,18 @@ namespace sdf
     /// \return Spec version string.
     public: const std::string &OriginalVersion() const;
 
+    /// \brief Set the range of the text this element was read from.
+    /// \param[in] _range Range in the text of the document.
+    /// \sa ParserConfig::SetRecordSourceRanges
+    public: void SetSourceRange(const TextRange &_range);
+
+    /// \brief Get the range of the text this element was read from, which
+    /// is recorded for documents read from a string with
+    /// ParserConfig::SetRecordSourceRanges.
+    /// \return Range in the text of the document, with a beginLine of 0 if
+    /// the element wasn't read from the text.
+    public: const TextRange &SourceRange() const;
+
     /// \brief Get a text description of the element.
     /// \return The text description of the element.
     public: std::string GetDescription() const;
@@ -417,17 +766,40 @@ namespace sdf
     /// \return A pointer to the named element if found, nullptr otherwise.
     public: ElementPtr GetElementImpl(const std::string &_name) const;
 
-    /// \brief Generate a string (XML) representation of this object.
-    /// \param[in] _prefix arbitrary prefix to put on the string.
-    /// \param[out] _out the std::ostreamstream to write output to.
-    private: void ToString(const std::string &_prefix,
-                           std::ostringstream &_out) const;
+    /// \brief Generate a string (XML) representation of this object, or
+    /// an include element if it was included from another file.
+    /// \param[in] _prefix arbitrary prefix to put on every line.
+    /// \param[in] _indent Number of spaces to indent by after the prefix.
+    /// \param[in] _compact True to omit indentation and line breaks.
+    /// \param[out] _out the std::ostream to write output to.
+    private: void ToString(const std::string &_prefix, std::size_t _indent,
+                           bool _compact, std::ostream &_out) const;
 
     /// \brief Generate a string (XML) representation of this object.
-    /// \param[in] _prefix arbitrary prefix to put on the string.
-    /// \param[out] _out the std::ostreamstream to write output to.
+    /// \param[in] _prefix arbitrary prefix to put on every line.
+    /// \param[in] _indent Number of spaces to indent by after the prefix.
+    /// \param[in] _compact True to omit indentation and line breaks.
+    /// \param[out] _out the std::ostream to write output to.
+    /// \param[in] _split Descendant whose children are left out, or
+    /// nullptr to write every element. \sa ToBuffers
+    /// \param[out] _splitOffset Offset in _out where the children of _split
+    /// would have been written.
     private: void PrintValuesImpl(const std::string &_prefix,
-                                  std::ostringstream &_out) const;
+                                  std::size_t _indent, bool _compact,
+                                  std::ostream &_out,
+                                  const Element *_split = nullptr,
+                                  std::size_t *_splitOffset = nullptr) const;
+
+    /// \brief Generate a string (XML) representation of what changed in
+    /// this object since ClearDirty.
+    /// \param[in] _prefix arbitrary prefix to put on every line.
+    /// \param[in] _indent Number of spaces to indent by after the prefix.
+    /// \param[in] _compact True to omit indentation and line breaks.
+    /// \param[out] _out the std::ostream to write output to.
+    /// \sa DirtyToStream
+    private: void PrintDirtyImpl(const std::string &_prefix,
+                                 std::size_t _indent, bool _compact,
+                                 std::ostream &_out) const;
 
     /// \brief Create a new Param object and return it.
     /// \param[in] _key Key for the parameter.
@@ -443,23 +815,126 @@ namespace sdf
                                   bool _required,
                                   const std::string &_description="");
 
+    /// \brief Find what a key passed to Get refers to, with one lookup in
+    /// each of the attributes, the child elements and the element
+    /// descriptions, and without copying the key.
+    /// \param[in] _key Name of an attribute or child element.
+    /// \param[out] _attribute The attribute named _key, or nullptr if there
+    /// is none.
+    /// \return nullptr if _key is an attribute. Otherwise the first child
+    /// element named _key, else the description of such an element, else
+    /// nullptr.
+    private: const Element *FindKey(std::string_view _key,
+                                    const Param *&_attribute) const;
+
+    /// \brief Read the child elements of this element, if reading them was
+    /// deferred when the element was parsed.
+    /// \sa ParserConfig::SetLazyElements
+    private: void ReadLazyChildren() const;
+
+    /// \brief Drop the cached content hashes of this element and of its
+    /// ancestors, after the content of this element changed.
+    /// \sa ContentHash
+    private: void InvalidateContentHash();
+
+    /// \brief Drop the cached content hashes of this element and of its
+    /// ancestors, after a value of this element changed.
+    /// \sa ContentHash
+    private: void ClearContentHash();
+
+    /// \brief Mark this element and its ancestors as dirty, after one of
+    /// its parameters changed.
+    /// \sa Dirty
+    private: void MarkDirty();
+
+    /// \brief Record a change of this element for ElementSnapshot, by
+    /// stamping it and its ancestors with the current change epoch.
+    /// \sa ElementChangeEpoch
+    private: void MarkChanged();
+
+    /// \brief Compare the content of this element without its children
+    /// with the content of another one, in the terms of ContentHash.
+    /// \param[in] _elem Element to compare with.
+    /// \return True if the names, include files, written attributes and
+    /// values are equal.
+    private: bool SameOwnContent(const Element &_elem) const;
+
+    /// \brief Drop the result of the check of the names of the siblings of
+    /// this element, after its name attribute changed.
+    /// \sa HasUniqueChildNames
+    private: void InvalidateSiblingNames();
+
+    /// \brief Replace the children of this element by the result of an
+    /// edit, and update the name index, the content hashes and the tag
+    /// index once.
+    /// \param[in,out] _elements New children, swapped with the old ones.
+    /// \param[in] _inserted New children that were not children before.
+    /// \sa ElementEdit
+    private: void SetEditedChildren(ElementPtr_V &_elements,
+                 const std::vector<Element *> &_inserted);
+
+    /// \brief Parameters mark their element as dirty.
+    private: friend class Param;
+
+    /// \brief Lazy children are created and read by the parser.
+    private: friend class LazyChildren;
+
+    /// \brief Lazy descriptions are deferred by the parser.
+    private: friend class LazyDescriptions;
+
+    /// \brief Edits read and replace the children of elements.
+    private: friend class ElementEditPrivate;
+
+    /// \brief Patches read and modify elements.
+    private: friend class ElementPatchPrivate;
+
+    /// \brief Snapshots read the elements and their change epochs.
+    private: friend class ElementSnapshotPrivate;
+
+    /// \brief Tag indices mark the elements they hold.
+    private: friend class ElementTagIndex;
 
     /// \brief Private data pointer
     private: std::unique_ptr<ElementPrivate> dataPtr;
   };
 
+  /// \internal
+  /// \brief Schema data of an element description. The data is shared,
+  /// without copying, by a description and every element instantiated from
+  /// it through Instantiate, Clone, Copy or AddElement, and is copied
+  /// before it is modified while shared. The child descriptions are shared
+  /// as well, and must not be modified once elements have been
+  /// instantiated from them.
+  class ElementDescriptionData
+  {
+    /// \brief Element description
+    public: std::string description;
+
+    /// \brief The possible child elements
+    public: ElementPtr_V elementDescriptions;
+
+    /// \brief Index from an element description name to its position in
+    /// `elementDescriptions`. \sa ElementPrivate::elementIndex
+    public: std::unordered_map<std::string, std::size_t>
+            elementDescriptionIndex;
+
+    /// \brief Creates and holds the child descriptions, the first time
+    /// they are needed, in place of the vector and index above, or nullptr
+    /// if they are not created on demand.
+    public: std::shared_ptr<LazyDescriptions> lazyDescriptions;
+  };
+
   /// \internal
   /// \brief Private data for Element
   class ElementPrivate
   {
-    /// \brief Element name
-    public: std::string name;
+    /// \brief Element name, interned in the process-wide table of
+    /// identifiers, so that elements with the same name share one copy and
+    /// can be compared by address.
+    public: const std::string *name = nullptr;
 
-    /// \brief True if element is required
-    public: std::string required;
-
-    /// \brief Element description
-    public: std::string description;
+    /// \brief True if element is required, interned like name.
+    public: const std::string *required = nullptr;
 
     /// \brief True if element's children should be copied.
     public: bool copyChildren;
@@ -476,8 +951,13 @@ namespace sdf
     // The existing child elements
     public: ElementPtr_V elements;
 
-    // The possible child elements
-    public: ElementPtr_V elementDescriptions;
+    /// \brief Unparsed XML of the child elements, set while reading them is
+    /// deferred until they are first accessed. Shared with clones.
+    public: std::shared_ptr<const LazyChildren> lazyChildren;
+
+    /// \brief Description and possible child elements, shared with the
+    /// description this element was instantiated from.
+    public: std::shared_ptr<ElementDescriptionData> descriptionData;
 
     /// name of the include file that was used to create this element
     public: std::string includeFilename;
@@ -490,11 +970,89 @@ namespace sdf
 
     /// \brief Spec version that this was originally parsed from.
     public: std::string originalVersion;
+
+    /// \brief Range of the text this element was read from.
+    public: TextRange sourceRange;
+
+    /// \brief Position of this element in the `elements` vector of its
+    /// parent, used to find siblings without searching the parent.
+    public: std::size_t indexInParent = 0;
+
+    /// \brief Index from a child element name to the position in `elements`
+    /// of the first child with that name. The index is only kept once the
+    /// number of children is large enough for it to beat a linear scan.
+    public: std::unordered_map<std::string, std::size_t> elementIndex;
+
+    /// \brief Number of child elements with each name, kept together with
+    /// elementIndex. \sa Element::CountChildren
+    public: std::unordered_map<std::string, std::size_t> elementCounts;
+
+    /// \brief Index from an attribute key to its position in `attributes`.
+    /// \sa elementIndex
+    public: std::unordered_map<std::string, std::size_t> attributeIndex;
+
+    /// \brief Content hash cached by Element::ContentHash.
+    public: std::uint64_t hash = 0;
+
+    /// \brief True if `hash` is up to date. The hashes of the element and
+    /// of its ancestors are dropped when its content changes.
+    public: bool hashCached = false;
+
+    /// \brief True if a parameter of this element or of a descendant
+    /// changed since Element::ClearDirty.
+    public: bool dirty = false;
+
+    /// \brief Change epoch in which this element was created, or in which
+    /// it or a descendant last changed. \sa ElementChangeEpoch
+    public: std::uint64_t changeEpoch = 0;
+
+    /// \brief Whether the name attributes of the children are unique:
+    /// kNamesUnknown until they are checked, then kNamesUnique or
+    /// kNamesDuplicate until the children or their names change.
+    /// \sa Element::HasUniqueChildNames
+    public: std::atomic<std::uint8_t> childNames{kNamesUnknown};
+
+    /// \brief Value of childNames before the names are checked.
+    public: static constexpr std::uint8_t kNamesUnknown = 0;
+
+    /// \brief Value of childNames when the names are unique.
+    public: static constexpr std::uint8_t kNamesUnique = 1;
+
+    /// \brief Value of childNames when two children have the same name.
+    public: static constexpr std::uint8_t kNamesDuplicate = 2;
+
+    /// \brief True to hand the children to the reclaimer thread when this
+    /// element is destroyed. \sa ParserConfig::ReleaseElementsInBackground
+    public: bool releaseInBackground = false;
+
+    /// \brief Index of the elements of this tree, if it was built on this
+    /// element. \sa Element::BuildTagIndex
+    public: std::shared_ptr<ElementTagIndex> tagIndex;
+
+    /// \brief Identifier of the tag index that holds this element, or
+    /// zero if none does.
+    public: std::uint64_t tagIndexId = 0;
+
+    /// \brief Serial number of the entry of this element in that index.
+    public: std::uint64_t tagIndexEntry = 0;
   };
 
+  ///////////////////////////////////////////////
+  ElementChildren::Iterator &ElementChildren::Iterator::operator++()
+  {
+    // Element names are interned, so the names are compared as pointers.
+    ++this->pos;
+    if (this->name)
+    {
+      while (this->pos != this->end && &(*this->pos)->GetName() != this->name)
+        ++this->pos;
+    }
+    return *this;
+  }
+
   ///////////////////////////////////////////////
   template<typename T>
-  T Element::Get(const std::string &_key) const
+  T Element::Get(std::string_view _key) const
   {
     T result = T();
 
@@ -505,7 +1063,7 @@ namespace sdf
 
   ///////////////////////////////////////////////
   template<typename T>
-  bool Element::Get(const std::string &_key,
+  bool Element::Get(std::string_view _key,
                     T &_param,
                     const T &_defaultValue) const
   {
@@ -516,7 +1074,7 @@ namespace sdf
 
   ///////////////////////////////////////////////
   template<typename T>
-  std::pair<T, bool> Element::Get(const std::string &_key,
+  std::pair<T, bool> Element::Get(std::string_view _key,
                                   const T &_defaultValue) const
   {
     std::pair<T, bool> result(_defaultValue, true);
@@ -527,18 +1085,15 @@ namespace sdf
     }
     else if (!_key.empty())
     {
-      ParamPtr param = this->GetAttribute(_key);
+      const Param *param = nullptr;
+      const Element *elem = this->FindKey(_key, param);
       if (param)
       {
         param->Get(result.first);
       }
-      else if (this->HasElement(_key))
-      {
-        result.first = this->GetElementImpl(_key)->Get<T>();
-      }
-      else if (this->HasElementDescription(_key))
+      else if (elem)
       {
-        result.first = this->GetElementDescription(_key)->Get<T>();
+        result.first = elem->Get<T>();
       }
       else
       {
@@ -553,6 +1108,44 @@ namespace sdf
     return result;
   }
 
+  ///////////////////////////////////////////////
+  template<typename F>
+  void Element::VisitAttributes(F &&_visitor) const
+  {
+    auto visitParam = [&_visitor](const Element &_elem, const Param &_param)
+    {
+      _param.Visit([&](const auto &_value)
+          {
+            _visitor(_elem, _param, _value);
+          });
+    };
+
+    // Depth first traversal through the first child, next sibling and
+    // parent links, so that deep documents don't need a stack.
+    ElementPtr holder;
+    const Element *elem = this;
+    while (elem)
+    {
+      if (elem->dataPtr->value)
+        visitParam(*elem, *elem->dataPtr->value);
+      for (const ParamPtr &attribute : elem->dataPtr->attributes)
+        visitParam(*elem, *attribute);
+
+      ElementPtr next = elem->GetFirstElement();
+      while (!next && elem != this)
+      {
+        next = elem->GetNextElement();
+        if (!next)
+        {
+          holder = elem->GetParent();
+          elem = holder.get();
+        }
+      }
+      holder = std::move(next);
+      elem = holder.get();
+    }
+  }
+
   ///////////////////////////////////////////////
   template<typename T>
   bool Element::Set(const T &_value)
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_ELEMENT_EDIT_HH_
+#define SDF_ELEMENT_EDIT_HH_
+
+#include <cstddef>
+
+#include "sdf/Element.hh"
+#include "sdf/Error.hh"
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  // Forward declarations.
+  class ElementEditPrivate;
+
+  /// \brief A batch of changes to the children of an element, which are
+  /// queued and then applied together by Commit. Each InsertElement or
+  /// RemoveChild moves the children after the changed position and
+  /// rebuilds the name index of the element, so building or pruning a
+  /// large tree one child at a time is quadratic. An edit builds the new
+  /// list of children in one pass, and updates the name index, the content
+  /// hashes and the tag index once.
+  ///
+  /// Positions refer to the children the element has when the edit is
+  /// committed, before any change of the edit, so they don't shift as
+  /// changes are queued. The element must not be modified otherwise
+  /// between queuing changes and committing them.
+  /// \code
+  /// sdf::ElementEdit edit(world);
+  /// for (const sdf::ElementPtr &model : unusedModels)
+  ///   edit.Remove(model);
+  /// edit.Move(sun, 0);
+  /// sdf::Errors errors = edit.Commit();
+  /// \endcode
+  class SDFORMAT_VISIBLE ElementEdit
+  {
+    /// \brief Constructor.
+    /// \param[in] _elem Element whose children are edited.
+    public: explicit ElementEdit(ElementPtr _elem);
+
+    /// \brief Copy constructor is deleted, since an edit applies once.
+    public: ElementEdit(const ElementEdit &_edit) = delete;
+
+    /// \brief Copy assignment operator is deleted, see the copy
+    /// constructor.
+    public: ElementEdit &operator=(const ElementEdit &_edit) = delete;
+
+    /// \brief Destructor. Changes that are not committed are discarded.
+    public: ~ElementEdit();
+
+    /// \brief Queue the insertion of a child after the other children.
+    /// \param[in] _child Element to insert, which becomes a child of the
+    /// edited element when the edit is committed.
+    public: void Insert(ElementPtr _child);
+
+    /// \brief Queue the insertion of a child before the child at a
+    /// position. Children inserted at the same position keep the order
+    /// they were queued in.
+    /// \param[in] _child Element to insert, which becomes a child of the
+    /// edited element when the edit is committed.
+    /// \param[in] _index Position of the child to insert _child before.
+    /// Positions past the last child insert after the other children.
+    public: void Insert(ElementPtr _child, std::size_t _index);
+
+    /// \brief Queue the removal of a child.
+    /// \param[in] _child Child to remove.
+    public: void Remove(ElementPtr _child);
+
+    /// \brief Queue the move of a child, which is like its removal and its
+    /// insertion before the child at a position.
+    /// \param[in] _child Child to move.
+    /// \param[in] _index Position of the child to move _child before.
+    /// Positions past the last child move it after the other children.
+    public: void Move(ElementPtr _child, std::size_t _index);
+
+    /// \brief Queue the replacement of a child by another element, which
+    /// takes its position.
+    /// \param[in] _child Child to remove.
+    /// \param[in] _replacement Element to insert in place of _child.
+    public: void Replace(ElementPtr _child, ElementPtr _replacement);
+
+    /// \brief Get the number of queued changes.
+    /// \return Number of changes that are not committed.
+    public: std::size_t ChangeCount() const;
+
+    /// \brief Apply the queued changes to the edited element. Changes that
+    /// refer to an element that is not a child, or that insert an element
+    /// that is already a child or is inserted by another change, are
+    /// skipped, and the others are applied. Removed children have no
+    /// parent afterwards, and inserted elements have the edited element as
+    /// their parent.
+    /// \return An ELEMENT_MISSING error for each change that refers to a
+    /// null element or to an element that is not a child, and an
+    /// ELEMENT_INVALID error for each change that inserts an element twice.
+    public: Errors Commit();
+
+    /// \brief Discard the queued changes.
+    public: void Discard();
+
+    /// \brief Private data pointer.
+    private: ElementEditPrivate *dataPtr = nullptr;
+  };
+  }
+}
+#endif
@@ -0,0 +1,152 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_ELEMENT_PATCH_HH_
+#define SDF_ELEMENT_PATCH_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "sdf/Element.hh"
+#include "sdf/Error.hh"
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  // Forward declarations.
+  class ElementPatchPrivate;
+
+  /// \enum ElementPatchOpType
+  /// \brief Kind of an operation of an ElementPatch.
+  enum class ElementPatchOpType : std::uint8_t
+  {
+    /// \brief Insert a copy of an element as a child.
+    ADD = 0,
+
+    /// \brief Remove a child element.
+    REMOVE = 1,
+
+    /// \brief Replace the name, include file, attributes and value of an
+    /// element, keeping its children.
+    MODIFY = 2,
+  };
+
+  /// \brief An operation of an ElementPatch.
+  struct ElementPatchOp
+  {
+    /// \brief Kind of the operation.
+    ElementPatchOpType type = ElementPatchOpType::MODIFY;
+
+    /// \brief Indices of the children to follow from the patched element
+    /// to the element the operation applies to, which is the patched
+    /// element itself if the path is empty. For ADD, the last index is the
+    /// position the element is inserted at. Indices refer to the tree as
+    /// modified by the previous operations.
+    std::vector<std::size_t> path;
+
+    /// \brief For ADD, the element to insert a copy of. For MODIFY, an
+    /// element without children holding the new name, include file,
+    /// attributes and value. Unused for REMOVE.
+    ElementPtr element;
+  };
+
+  /// \brief The differences between two element trees, as a list of
+  /// operations that turn the first tree into the second one. A patch is
+  /// typically computed between two versions of a document and applied to
+  /// other copies of the first version, so that edits are propagated
+  /// without sending or parsing the whole document again.
+  ///
+  /// Subtrees with the same Element::ContentHash are skipped, so diffing
+  /// two large trees that differ in a few places only visits the paths to
+  /// those places once the hashes are cached. Children are matched in
+  /// order by their element name and "name" attribute; children that
+  /// can't be matched are removed and added.
+  class SDFORMAT_VISIBLE ElementPatch
+  {
+    /// \brief Default constructor, for an empty patch.
+    public: ElementPatch();
+
+    /// \brief Copy constructor
+    /// \param[in] _patch ElementPatch to copy.
+    public: ElementPatch(const ElementPatch &_patch);
+
+    /// \brief Move constructor
+    /// \param[in] _patch ElementPatch to move.
+    public: ElementPatch(ElementPatch &&_patch) noexcept;
+
+    /// \brief Move assignment operator.
+    /// \param[in] _patch ElementPatch to move.
+    /// \return Reference to this.
+    public: ElementPatch &operator=(ElementPatch &&_patch) noexcept;
+
+    /// \brief Copy assignment operator.
+    /// \param[in] _patch ElementPatch to copy.
+    /// \return Reference to this.
+    public: ElementPatch &operator=(const ElementPatch &_patch);
+
+    /// \brief Destructor
+    public: ~ElementPatch();
+
+    /// \brief Compute the operations that turn one element tree into
+    /// another. The previous operations are replaced.
+    /// \param[in] _from The original tree.
+    /// \param[in] _to The modified tree. The elements of the patch are
+    /// copies, so _to can be modified or released afterwards.
+    /// \return An ELEMENT_MISSING error if either tree is null.
+    public: Errors Diff(const ElementPtr &_from, const ElementPtr &_to);
+
+    /// \brief Apply the operations to a tree that has the content of the
+    /// original tree of Diff. Operations are applied in order, and
+    /// applying stops at the first one whose path doesn't exist, which
+    /// leaves the tree partially patched.
+    /// \param[in] _elem Root of the tree to patch.
+    /// \return An ELEMENT_MISSING error if _elem is null or an operation
+    /// refers to a missing element.
+    public: Errors Apply(const ElementPtr &_elem) const;
+
+    /// \brief Check whether the patch has no operations, which is the case
+    /// when the two trees given to Diff have the same content.
+    /// \return True if there are no operations.
+    public: bool Empty() const;
+
+    /// \brief Get the number of operations.
+    /// \return Number of operations.
+    public: std::size_t OpCount() const;
+
+    /// \brief Get an operation by its index.
+    /// \param[in] _index Index of the operation, less than OpCount().
+    /// \return Pointer to the operation, or nullptr if _index is out of
+    /// range.
+    public: const ElementPatchOp *OpByIndex(std::size_t _index) const;
+
+    /// \brief Add an operation after the others, to build a patch from
+    /// operations computed elsewhere, such as by ElementSnapshot::Diff.
+    /// \param[in] _op The operation. Its path refers to the tree as
+    /// modified by the previous operations.
+    public: void AddOp(ElementPatchOp _op);
+
+    /// \brief Private data pointer.
+    private: ElementPatchPrivate *dataPtr = nullptr;
+  };
+  }
+}
+#endif
@@ -0,0 +1,108 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_ELEMENT_QUERY_HH_
+#define SDF_ELEMENT_QUERY_HH_
+
+#include <string>
+
+#include "sdf/Element.hh"
+#include "sdf/Error.hh"
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  // Forward declarations.
+  class ElementQueryPrivate;
+
+  /// \brief A compiled path query over an element tree, using a small
+  /// subset of XPath, for example `//model/link/sensor[@type='camera']`.
+  ///
+  /// A path is a list of steps separated by `/`, for a child of the
+  /// element matched by the previous step, or `//`, for any descendant of
+  /// it. A step is an element name, or `*` for any name, followed by any
+  /// number of predicates: `[@key]` requires the attribute to be written
+  /// in the document and `[@key='value']` also requires its value. A path
+  /// that starts with `/` matches the queried element with its first step,
+  /// a path that starts with `//` matches the queried element or any of
+  /// its descendants, and other paths start with the children of the
+  /// queried element.
+  ///
+  /// When the last step has a name and the tree was indexed with
+  /// Element::BuildTagIndex, only the elements with that name are visited
+  /// and the rest of the path is matched through their ancestors, so a
+  /// query on a large tree costs about the number of elements with the
+  /// last name. Otherwise the subtree of the queried element is walked.
+  class SDFORMAT_VISIBLE ElementQuery
+  {
+    /// \brief Default constructor, for a query that matches nothing.
+    public: ElementQuery();
+
+    /// \brief Copy constructor
+    /// \param[in] _query ElementQuery to copy.
+    public: ElementQuery(const ElementQuery &_query);
+
+    /// \brief Move constructor
+    /// \param[in] _query ElementQuery to move.
+    public: ElementQuery(ElementQuery &&_query) noexcept;
+
+    /// \brief Move assignment operator.
+    /// \param[in] _query ElementQuery to move.
+    /// \return Reference to this.
+    public: ElementQuery &operator=(ElementQuery &&_query) noexcept;
+
+    /// \brief Copy assignment operator.
+    /// \param[in] _query ElementQuery to copy.
+    /// \return Reference to this.
+    public: ElementQuery &operator=(const ElementQuery &_query);
+
+    /// \brief Destructor
+    public: ~ElementQuery();
+
+    /// \brief Compile a path, replacing the previous one.
+    /// \param[in] _path The path.
+    /// \return An ELEMENT_INVALID error if the path can't be parsed, in
+    /// which case the query matches nothing.
+    public: Errors Compile(const std::string &_path);
+
+    /// \brief Get the path that was compiled.
+    /// \return The path given to Compile, or an empty string if it failed.
+    public: const std::string &Path() const;
+
+    /// \brief Find the elements that match the path.
+    /// \param[in] _elem Element to query.
+    /// \return The matching elements. Without a tag index they are in
+    /// document order; with one they are in the order they were indexed,
+    /// which is document order for the elements that were in the tree when
+    /// the index was built.
+    public: ElementPtr_V Evaluate(const ElementPtr &_elem) const;
+
+    /// \brief Find the first element that matches the path.
+    /// \param[in] _elem Element to query.
+    /// \return The first element Evaluate would return, or nullptr.
+    public: ElementPtr EvaluateFirst(const ElementPtr &_elem) const;
+
+    /// \brief Private data pointer.
+    private: ElementQueryPrivate *dataPtr = nullptr;
+  };
+  }
+}
+#endif
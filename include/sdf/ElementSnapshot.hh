@@ -0,0 +1,151 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_ELEMENT_SNAPSHOT_HH_
+#define SDF_ELEMENT_SNAPSHOT_HH_
+
+#include <cstddef>
+
+#include "sdf/Element.hh"
+#include "sdf/ElementPatch.hh"
+#include "sdf/Error.hh"
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  // Forward declarations.
+  class ElementSnapshotPrivate;
+
+  /// \brief An immutable copy of an element tree that shares the subtrees
+  /// which didn't change with the previous snapshot of the same tree, for
+  /// the undo history or the versions of an editor.
+  ///
+  /// The first snapshot of a tree copies every element without its
+  /// children. A later snapshot given the previous one only copies the
+  /// elements that changed since, with the path from each of them to the
+  /// root, so taking a snapshot of a tree that didn't change costs O(1)
+  /// and copying a snapshot always does. Elements record their changes in
+  /// a process-wide epoch once the first snapshot is taken, at the cost
+  /// of a walk to the first ancestor already changed since the last
+  /// snapshot.
+  ///
+  /// Diff and Restore compare the snapshots of the same tree by the
+  /// subtrees they share, so that they only visit the parts that differ.
+  /// Elements are matched by identity, not by name: an element that was
+  /// removed and added again is a different element.
+  ///
+  /// The DOM objects of a tree, such as sdf::Model, are not part of its
+  /// snapshots. Load them again from the restored elements, e.g. with
+  /// sdf::Root::Load for a whole document.
+  class SDFORMAT_VISIBLE ElementSnapshot
+  {
+    /// \brief Default constructor, for an empty snapshot.
+    public: ElementSnapshot();
+
+    /// \brief Copy constructor, which shares the snapshot.
+    /// \param[in] _snapshot ElementSnapshot to copy.
+    public: ElementSnapshot(const ElementSnapshot &_snapshot);
+
+    /// \brief Move constructor
+    /// \param[in] _snapshot ElementSnapshot to move.
+    public: ElementSnapshot(ElementSnapshot &&_snapshot) noexcept;
+
+    /// \brief Move assignment operator.
+    /// \param[in] _snapshot ElementSnapshot to move.
+    /// \return Reference to this.
+    public: ElementSnapshot &operator=(ElementSnapshot &&_snapshot) noexcept;
+
+    /// \brief Copy assignment operator, which shares the snapshot.
+    /// \param[in] _snapshot ElementSnapshot to copy.
+    /// \return Reference to this.
+    public: ElementSnapshot &operator=(const ElementSnapshot &_snapshot);
+
+    /// \brief Destructor
+    public: ~ElementSnapshot();
+
+    /// \brief Take a snapshot of an element tree. Deferred children are
+    /// read first.
+    /// \param[in] _elem Root of the tree.
+    /// \param[in] _previous A previous snapshot of the same tree, whose
+    /// unchanged subtrees are shared, or an empty snapshot to copy the
+    /// whole tree.
+    /// \return The snapshot, which is empty if _elem is null.
+    public: static ElementSnapshot Take(const ElementPtr &_elem,
+                const ElementSnapshot &_previous = ElementSnapshot());
+
+    /// \brief Get whether the snapshot is empty.
+    /// \return True for a default constructed snapshot.
+    public: bool Empty() const;
+
+    /// \brief Get the content of the root of the snapshot without its
+    /// children: its name, include file, attributes and value. The element
+    /// is shared by the snapshots and must not be modified.
+    /// \return The element, or nullptr if the snapshot is empty.
+    public: ElementConstPtr Content() const;
+
+    /// \brief Get the number of children of the root of the snapshot.
+    /// \return Number of children.
+    public: std::size_t ChildCount() const;
+
+    /// \brief Get the snapshot of a child.
+    /// \param[in] _index Index of the child, less than ChildCount().
+    /// \return The snapshot of the subtree of the child, which can be
+    /// given to Take for that child, or an empty snapshot if _index is out
+    /// of range.
+    public: ElementSnapshot Child(std::size_t _index) const;
+
+    /// \brief Check whether two snapshots share their root, which means
+    /// that their trees are equal. Snapshots that don't share their root
+    /// can still be equal, e.g. after Restore.
+    /// \param[in] _snapshot Snapshot to compare with.
+    /// \return True if the roots are shared, or both snapshots are empty.
+    public: bool SameAs(const ElementSnapshot &_snapshot) const;
+
+    /// \brief Create a new element tree with the content of the snapshot.
+    /// \return Root of the new tree, or nullptr if the snapshot is empty.
+    public: ElementPtr ToElement() const;
+
+    /// \brief Compute the patch that turns the tree of one snapshot into
+    /// the tree of another snapshot of the same tree, like
+    /// ElementPatch::Diff does for element trees. Shared subtrees are
+    /// skipped, and children are matched by identity, so that the cost is
+    /// in proportion to the changes between the snapshots.
+    /// \param[in] _from The earlier snapshot.
+    /// \param[in] _to The later snapshot.
+    /// \return The patch, which is empty if either snapshot is.
+    public: static ElementPatch Diff(const ElementSnapshot &_from,
+                const ElementSnapshot &_to);
+
+    /// \brief Give an element tree the content of this snapshot of it, e.g.
+    /// to undo or redo edits. The tree is compared with this snapshot by
+    /// taking a new snapshot of it from this one, and only the elements
+    /// that differ are modified, removed or added.
+    /// \param[in] _elem Root of the tree this snapshot was taken of.
+    /// \return An ELEMENT_MISSING error if _elem is null or this snapshot
+    /// is empty.
+    public: Errors Restore(const ElementPtr &_elem) const;
+
+    /// \brief Private data pointer.
+    private: ElementSnapshotPrivate *dataPtr = nullptr;
+  };
+  }
+}
+#endif
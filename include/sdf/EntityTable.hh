@@ -0,0 +1,253 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_ENTITY_TABLE_HH_
+#define SDF_ENTITY_TABLE_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+
+#include "sdf/Span.hh"
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  // Forward declarations.
+  class Collision;
+  class EntityTablePrivate;
+  class Frame;
+  class Joint;
+  class Light;
+  class Link;
+  class Model;
+  class Sensor;
+  class Visual;
+
+  /// \enum EntityType
+  /// \brief Type of an entity of an EntityTable.
+  enum class EntityType : std::uint8_t
+  {
+    /// \brief A model, or a nested model.
+    MODEL = 0,
+
+    /// \brief A link of a model.
+    LINK = 1,
+
+    /// \brief A visual of a link.
+    VISUAL = 2,
+
+    /// \brief A collision of a link.
+    COLLISION = 3,
+
+    /// \brief A sensor of a link.
+    SENSOR = 4,
+
+    /// \brief A light of a link or of the world.
+    LIGHT = 5,
+
+    /// \brief A joint of a model.
+    JOINT = 6,
+
+    /// \brief An explicit frame of a model or of the world.
+    FRAME = 7,
+  };
+
+  /// \brief Dense integer IDs of the entities of a world, with the frame
+  /// names that the entities refer to resolved to IDs, so that systems can
+  /// keep their data about entities in arrays instead of maps by name.
+  ///
+  /// IDs are given in the order of World::ResolvePoses: each model before
+  /// its links, each link followed by its visuals, collisions, sensors and
+  /// lights, then the joints, frames and nested models of the model, then
+  /// the frames and lights of the world. The IDs only depend on the
+  /// content of the world, so they are the same every time it is loaded.
+  ///
+  /// Each reference of an entity, such as the relative_to of a pose, the
+  /// attached_to of a frame or the parent of a joint, is resolved in the
+  /// scope that the DOM resolves it in, with an empty reference resolved to
+  /// its default frame. References to the world frame resolve to kWorldId,
+  /// and references to frames that don't exist to kInvalidId. The entries
+  /// point into the DOM objects the table was built from, so they are valid
+  /// as long as those objects are not modified or destroyed. World keeps
+  /// its table up to date, see World::Entities().
+  class SDFORMAT_VISIBLE EntityTable
+  {
+    /// \brief ID used when there is no entity.
+    public: static constexpr std::size_t kInvalidId =
+                std::numeric_limits<std::size_t>::max();
+
+    /// \brief ID of the world frame in references.
+    public: static constexpr std::size_t kWorldId = kInvalidId - 1u;
+
+    /// \brief Default constructor, for an empty table.
+    public: EntityTable();
+
+    /// \brief Copy constructor. The copy points to the same objects.
+    /// \param[in] _table EntityTable to copy.
+    public: EntityTable(const EntityTable &_table);
+
+    /// \brief Move constructor
+    /// \param[in] _table EntityTable to move.
+    public: EntityTable(EntityTable &&_table) noexcept;
+
+    /// \brief Move assignment operator.
+    /// \param[in] _table EntityTable to move.
+    /// \return Reference to this.
+    public: EntityTable &operator=(EntityTable &&_table) noexcept;
+
+    /// \brief Copy assignment operator.
+    /// \param[in] _table EntityTable to copy.
+    /// \return Reference to this.
+    public: EntityTable &operator=(const EntityTable &_table);
+
+    /// \brief Destructor
+    public: ~EntityTable();
+
+    /// \brief Give IDs to the entities of models and of the frames and
+    /// lights of their world, replacing the previous content.
+    /// \param[in] _models The models, such as World::Models(). Their names
+    /// start the scoped names.
+    /// \param[in] _frames The frames of the world of the models.
+    /// \param[in] _lights The lights of the world of the models.
+    public: void Build(Span<const Model> _models,
+                Span<const Frame> _frames = Span<const Frame>(),
+                Span<const Light> _lights = Span<const Light>());
+
+    /// \brief Get the number of entities, which is one more than the
+    /// largest ID.
+    /// \return Number of entities.
+    public: std::size_t EntityCount() const;
+
+    /// \brief Get the type of each entity.
+    /// \return Array of EntityCount() types, indexed by ID.
+    public: const EntityType *EntityTypes() const;
+
+    /// \brief Get the ID of the parent of each entity: the model of a
+    /// link, joint, frame or nested model, and the link of a visual,
+    /// collision, sensor or light.
+    /// \return Array of EntityCount() IDs, with kInvalidId for top level
+    /// models and the frames and lights of the world.
+    public: const std::size_t *EntityParents() const;
+
+    /// \brief Get the scoped name of an entity, such as
+    /// "model::link::visual".
+    /// \param[in] _id ID of the entity.
+    /// \return Name of the entity, or an empty string if _id is not the ID
+    /// of an entity.
+    public: const std::string &EntityName(std::size_t _id) const;
+
+    /// \brief Find an entity by type and scoped name.
+    /// \param[in] _type Type of the entity.
+    /// \param[in] _name Scoped name, such as "model::link".
+    /// \return ID of the entity, or kInvalidId if there is none.
+    public: std::size_t EntityByScopedName(EntityType _type,
+                const std::string &_name) const;
+
+    /// \brief Get the ID of a model of the table.
+    /// \param[in] _model Model the table was built from.
+    /// \return ID of the model, or kInvalidId if it is not in the table.
+    public: std::size_t Id(const Model *_model) const;
+
+    /// \brief Get the ID of a link of the table.
+    /// \param[in] _link Link the table was built from.
+    /// \return ID of the link, or kInvalidId if it is not in the table.
+    public: std::size_t Id(const Link *_link) const;
+
+    /// \brief Get the ID of a visual of the table.
+    /// \param[in] _visual Visual the table was built from.
+    /// \return ID of the visual, or kInvalidId if it is not in the table.
+    public: std::size_t Id(const Visual *_visual) const;
+
+    /// \brief Get the ID of a collision of the table.
+    /// \param[in] _collision Collision the table was built from.
+    /// \return ID of the collision, or kInvalidId if it is not in the
+    /// table.
+    public: std::size_t Id(const Collision *_collision) const;
+
+    /// \brief Get the ID of a sensor of the table.
+    /// \param[in] _sensor Sensor the table was built from.
+    /// \return ID of the sensor, or kInvalidId if it is not in the table.
+    public: std::size_t Id(const Sensor *_sensor) const;
+
+    /// \brief Get the ID of a light of the table.
+    /// \param[in] _light Light the table was built from.
+    /// \return ID of the light, or kInvalidId if it is not in the table.
+    public: std::size_t Id(const Light *_light) const;
+
+    /// \brief Get the ID of a joint of the table.
+    /// \param[in] _joint Joint the table was built from.
+    /// \return ID of the joint, or kInvalidId if it is not in the table.
+    public: std::size_t Id(const Joint *_joint) const;
+
+    /// \brief Get the ID of a frame of the table.
+    /// \param[in] _frame Frame the table was built from.
+    /// \return ID of the frame, or kInvalidId if it is not in the table.
+    public: std::size_t Id(const Frame *_frame) const;
+
+    /// \brief Get the frame that the pose of each entity is relative to,
+    /// resolved from its PoseRelativeTo(), or from its default frame when
+    /// that is empty.
+    /// \return Array of EntityCount() IDs of models, links, joints or
+    /// frames, or kWorldId.
+    public: const std::size_t *PoseRelativeTo() const;
+
+    /// \brief Get the frame that each frame is attached to, resolved from
+    /// Frame::AttachedTo(), or its model or the world when that is empty.
+    /// \return Array of EntityCount() IDs, with kInvalidId for entities
+    /// that are not frames.
+    public: const std::size_t *FrameAttachedTo() const;
+
+    /// \brief Get the parent frame of each joint, resolved from
+    /// Joint::ParentLinkName().
+    /// \return Array of EntityCount() IDs, with kInvalidId for entities
+    /// that are not joints.
+    public: const std::size_t *JointParent() const;
+
+    /// \brief Get the child frame of each joint, resolved from
+    /// Joint::ChildLinkName().
+    /// \return Array of EntityCount() IDs, with kInvalidId for entities
+    /// that are not joints.
+    public: const std::size_t *JointChild() const;
+
+    /// \brief Get the frame that the xyz vector of an axis of each joint
+    /// is expressed in, resolved from JointAxis::XyzExpressedIn(), or the
+    /// joint when that is empty.
+    /// \param[in] _index Index of the axis, 0 or 1.
+    /// \return Array of EntityCount() IDs, with kInvalidId for entities
+    /// that are not joints and joints without that axis, or nullptr if
+    /// _index is greater than 1.
+    public: const std::size_t *JointAxisExpressedIn(
+                unsigned int _index) const;
+
+    /// \brief Get the canonical link of each model, as given by
+    /// Model::CanonicalLink().
+    /// \return Array of EntityCount() IDs of links, with kInvalidId for
+    /// entities that are not models and models without a canonical link.
+    public: const std::size_t *ModelCanonicalLink() const;
+
+    /// \brief Private data pointer.
+    private: EntityTablePrivate *dataPtr = nullptr;
+  };
+  }
+}
+#endif
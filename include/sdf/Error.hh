@@ -134,6 +134,14 @@ namespace sdf
 
     /// \brief The specified placement frame is invalid
     MODEL_PLACEMENT_FRAME_INVALID,
+
+    /// \brief The load was stopped through the CancellationToken of its
+    /// ParserConfig.
+    LOAD_CANCELLED,
+
+    /// \brief The load didn't finish before the deadline of its
+    /// ParserConfig.
+    LOAD_DEADLINE_EXCEEDED,
   };
 
   class SDFORMAT_VISIBLE Error
@@ -147,6 +155,13 @@ namespace sdf
     /// \sa ErrorCode.
     public: Error(const ErrorCode _code, const std::string &_message);
 
+    /// \brief Constructor that takes ownership of a message, such as one
+    /// formatted in place, without copying it.
+    /// \param[in] _code The error code.
+    /// \param[in] _message A description of the error.
+    /// \sa ErrorCode.
+    public: Error(const ErrorCode _code, std::string &&_message);
+
     /// \brief Get the error code.
     /// \return An error code.
     /// \sa ErrorCode.
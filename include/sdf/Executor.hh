@@ -0,0 +1,72 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_EXECUTOR_HH_
+#define SDF_EXECUTOR_HH_
+
+#include <functional>
+#include <memory>
+
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief Threads that run the parallel work of the parser: the <include>
+  /// elements resolved in parallel, the DOM objects loaded in parallel, the
+  /// validation of frame graphs and the models of pipelined loads. Every
+  /// parallel feature submits its tasks to the same executor instead of
+  /// starting threads of its own, so nested work, such as the includes of
+  /// included models, shares the threads of the load.
+  ///
+  /// The parser never waits for a task that didn't start: the thread that
+  /// submits the tasks of a parallel loop does the work of the tasks that
+  /// are still queued once it runs out of work. An executor can therefore
+  /// have any number of threads, and run tasks in any order.
+  ///
+  /// ParserConfig::SetLoadExecutor sets the executor of a load, e.g. to run
+  /// the parser on the thread pool of an application. Otherwise the
+  /// executor returned by Default is used.
+  class SDFORMAT_VISIBLE Executor
+  {
+    /// \brief Destructor
+    public: virtual ~Executor();
+
+    /// \brief Run a task on one of the threads of the executor. The
+    /// function can be called from several threads at once, including from
+    /// tasks of the executor.
+    /// \param[in] _task Task to run. It doesn't throw.
+    public: virtual void Submit(std::function<void()> _task) = 0;
+
+    /// \brief Get the number of threads of the executor.
+    /// \return Number of threads that can run tasks at the same time.
+    public: virtual unsigned int Concurrency() const = 0;
+
+    /// \brief Get the executor shared by the loads that don't set one. It
+    /// is a work-stealing pool with one thread per hardware thread, which
+    /// are started by the first task: each thread keeps the tasks it
+    /// submits in a queue of its own, runs the newest of them first, and
+    /// takes the oldest task of another thread when its queue is empty.
+    /// \return The default executor.
+    public: static std::shared_ptr<Executor> Default();
+  };
+  }
+}
+#endif
@@ -50,7 +50,7 @@ namespace sdf
 
     /// \brief Move constructor
     /// \param[in] _frame Frame to move.
-    public: Frame(Frame &&_frame);
+    public: Frame(Frame &&_frame) noexcept;
 
     /// \brief Destructor
     public: ~Frame();
@@ -17,8 +17,11 @@
 #ifndef SDF_GEOMETRY_HH_
 #define SDF_GEOMETRY_HH_
 
+#include <optional>
+#include <ignition/math/AxisAlignedBox.hh>
 #include <sdf/Error.hh>
 #include <sdf/Element.hh>
+#include <sdf/Mesh.hh>
 #include <sdf/sdf_config.h>
 
 namespace sdf
@@ -32,7 +35,8 @@ namespace sdf
   class Box;
   class Capsule;
   class Cylinder;
-  class Mesh;
+  class Heightmap;
+  class MeshRegistry;
   class Plane;
   class Sphere;
 
@@ -58,6 +62,9 @@ namespace sdf
     /// \brief A mesh geometry.
     MESH = 5,
 
+    /// \brief A heightmap geometry.
+    HEIGHTMAP = 6,
+
     /// \brief A capsule geometry.
     CAPSULE = 7,
   };
@@ -166,7 +173,9 @@ namespace sdf
     /// \brief Get the mesh geometry, or nullptr if the contained geometry is
     /// not a mesh.
     /// \return Pointer to the visual's mesh geometry, or nullptr if the
-    /// geometry is not a mesh.
+    /// geometry is not a mesh. When the Root was loaded with
+    /// ParserConfig::ShareMeshes enabled, geometries with equal meshes
+    /// return the same pointer, which is an entry of Root::MeshByIndex.
     /// \sa GeometryType Type() const
     public: const Mesh *MeshShape() const;
 
@@ -174,12 +183,58 @@ namespace sdf
     /// \param[in] _mesh The mesh shape.
     public: void SetMeshShape(const Mesh &_mesh);
 
+    /// \brief Get the heightmap geometry, or nullptr if the contained
+    /// geometry is not a heightmap.
+    /// \return Pointer to the heightmap geometry, or nullptr if the geometry
+    /// is not a heightmap.
+    /// \sa GeometryType Type() const
+    public: const Heightmap *HeightmapShape() const;
+
+    /// \brief Set the heightmap shape.
+    /// \param[in] _heightmap The heightmap shape.
+    public: void SetHeightmapShape(const Heightmap &_heightmap);
+
     /// \brief Get a pointer to the SDF element that was used during
     /// load.
     /// \return SDF element pointer. The value will be nullptr if Load has
     /// not been called.
     public: sdf::ElementPtr Element() const;
 
+    /// \brief Get the axis aligned bounding box of the shape, relative to
+    /// the geometry frame.
+    /// \param[in] _meshCalculator Function that gives the bounds of the data
+    /// of a mesh, which are needed only for mesh shapes.
+    /// \return The box, or nothing for an empty geometry or a mesh that
+    /// _meshCalculator can't bound.
+    /// \sa Box::AxisAlignedBox
+    public: std::optional<ignition::math::AxisAlignedBox> AxisAlignedBox(
+        const Mesh::AxisAlignedBoxCalculator &_meshCalculator = nullptr)
+        const;
+
+    /// \brief Get the radius of a sphere centered on the origin of the
+    /// geometry frame that contains the shape. It is the smallest such
+    /// sphere for every shape but meshes and heightmaps, which are bounded
+    /// by the sphere that contains their box.
+    /// \param[in] _meshCalculator Function that gives the bounds of the data
+    /// of a mesh, which are needed only for mesh shapes.
+    /// \return The radius in meters, or nothing for an empty geometry or a
+    /// mesh that _meshCalculator can't bound.
+    /// \sa Box::BoundingRadius
+    public: std::optional<double> BoundingRadius(
+        const Mesh::AxisAlignedBoxCalculator &_meshCalculator = nullptr)
+        const;
+
+    /// \brief Replace the mesh of the geometry with the equal entry of a
+    /// mesh registry, adding it to the registry if it has no equal entry.
+    /// This is private and is intended to be called by Collision and
+    /// Visual when the meshes of a Root are shared.
+    /// \param[in,out] _registry Mesh registry of the Root.
+    private: void ShareMesh(MeshRegistry &_registry);
+
+    /// \brief Allow Collision and Visual to call ShareMesh.
+    friend class Collision;
+    friend class Visual;
+
     /// \brief Private data pointer.
     private: GeometryPrivate *dataPtr;
   };
@@ -0,0 +1,398 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_HEIGHTMAP_HH_
+#define SDF_HEIGHTMAP_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+
+#include <ignition/math/AxisAlignedBox.hh>
+#include <ignition/math/Vector3.hh>
+
+#include "sdf/Element.hh"
+#include "sdf/Error.hh"
+#include "sdf/Executor.hh"
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  // Forward declarations.
+  class HeightmapBlendPrivate;
+  class HeightmapDataPrivate;
+  class HeightmapPrivate;
+  class HeightmapTexturePrivate;
+
+  /// \brief Content of the height file of a heightmap, such as the bytes of
+  /// a grayscale image or of a DEM. Data loaded by Heightmap::Data is
+  /// memory-mapped where available, and read otherwise.
+  class SDFORMAT_VISIBLE HeightmapData
+  {
+    /// \brief Default constructor, for data without content.
+    public: HeightmapData();
+
+    /// \brief Constructor from content held in memory, such as data that
+    /// a Heightmap::DataLoader decoded.
+    /// \param[in] _content Content of the data.
+    public: explicit HeightmapData(std::string _content);
+
+    /// \brief Copy constructor is deleted, because the data can own a
+    /// mapping.
+    /// \param[in] _data HeightmapData to copy.
+    public: HeightmapData(const HeightmapData &_data) = delete;
+
+    /// \brief Copy assignment operator is deleted.
+    /// \param[in] _data HeightmapData to copy.
+    /// \return Reference to this.
+    public: HeightmapData &operator=(const HeightmapData &_data) = delete;
+
+    /// \brief Destructor. Unmaps the file.
+    public: ~HeightmapData();
+
+    /// \brief Map or read a file, replacing the previous content.
+    /// \param[in] _filename Name of the file.
+    /// \return True if the content of the file is available.
+    public: bool Open(const std::string &_filename);
+
+    /// \brief Get the content. It is not null terminated.
+    /// \return Pointer to the first byte, or nullptr if there is no
+    /// content.
+    public: const char *Data() const;
+
+    /// \brief Get the size of the content.
+    /// \return Size in bytes.
+    public: std::size_t Size() const;
+
+    /// \brief Check whether the content is a memory-mapped file.
+    /// \return True if the content is mapped.
+    public: bool Mapped() const;
+
+    /// \brief Private data pointer.
+    private: HeightmapDataPrivate *dataPtr = nullptr;
+  };
+
+  /// \brief A texture of a heightmap.
+  class SDFORMAT_VISIBLE HeightmapTexture
+  {
+    /// \brief Default constructor
+    public: HeightmapTexture();
+
+    /// \brief Copy constructor
+    /// \param[in] _texture HeightmapTexture to copy.
+    public: HeightmapTexture(const HeightmapTexture &_texture);
+
+    /// \brief Move constructor
+    /// \param[in] _texture HeightmapTexture to move.
+    public: HeightmapTexture(HeightmapTexture &&_texture) noexcept;
+
+    /// \brief Copy assignment operator.
+    /// \param[in] _texture HeightmapTexture to copy.
+    /// \return Reference to this.
+    public: HeightmapTexture &operator=(const HeightmapTexture &_texture);
+
+    /// \brief Move assignment operator.
+    /// \param[in] _texture HeightmapTexture to move.
+    /// \return Reference to this.
+    public: HeightmapTexture &operator=(HeightmapTexture &&_texture) noexcept;
+
+    /// \brief Destructor
+    public: ~HeightmapTexture();
+
+    /// \brief Load the texture based on an element pointer. This is *not*
+    /// the usual entry point. Typical usage of the SDF DOM is through the
+    /// Root object.
+    /// \param[in] _sdf The SDF Element pointer
+    /// \return Errors, which is a vector of Error objects. Each Error includes
+    /// an error code and message. An empty vector indicates no error.
+    public: Errors Load(ElementPtr _sdf);
+
+    /// \brief Get the size of the applied texture.
+    /// \return Size in meters.
+    public: double Size() const;
+
+    /// \brief Set the size of the applied texture.
+    /// \param[in] _size Size in meters.
+    public: void SetSize(double _size);
+
+    /// \brief Get the filename of the diffuse texture.
+    /// \return Filename of the diffuse texture.
+    public: const std::string &Diffuse() const;
+
+    /// \brief Set the filename of the diffuse texture.
+    /// \param[in] _diffuse Filename of the diffuse texture.
+    public: void SetDiffuse(const std::string &_diffuse);
+
+    /// \brief Get the filename of the normal map.
+    /// \return Filename of the normal map.
+    public: const std::string &Normal() const;
+
+    /// \brief Set the filename of the normal map.
+    /// \param[in] _normal Filename of the normal map.
+    public: void SetNormal(const std::string &_normal);
+
+    /// \brief Get a pointer to the SDF element that was used during load.
+    /// \return SDF element pointer. The value will be nullptr if Load has
+    /// not been called.
+    public: sdf::ElementPtr Element() const;
+
+    /// \brief Private data pointer.
+    private: HeightmapTexturePrivate *dataPtr = nullptr;
+  };
+
+  /// \brief A blend between two adjacent textures of a heightmap.
+  class SDFORMAT_VISIBLE HeightmapBlend
+  {
+    /// \brief Default constructor
+    public: HeightmapBlend();
+
+    /// \brief Copy constructor
+    /// \param[in] _blend HeightmapBlend to copy.
+    public: HeightmapBlend(const HeightmapBlend &_blend);
+
+    /// \brief Move constructor
+    /// \param[in] _blend HeightmapBlend to move.
+    public: HeightmapBlend(HeightmapBlend &&_blend) noexcept;
+
+    /// \brief Copy assignment operator.
+    /// \param[in] _blend HeightmapBlend to copy.
+    /// \return Reference to this.
+    public: HeightmapBlend &operator=(const HeightmapBlend &_blend);
+
+    /// \brief Move assignment operator.
+    /// \param[in] _blend HeightmapBlend to move.
+    /// \return Reference to this.
+    public: HeightmapBlend &operator=(HeightmapBlend &&_blend) noexcept;
+
+    /// \brief Destructor
+    public: ~HeightmapBlend();
+
+    /// \brief Load the blend based on an element pointer. This is *not*
+    /// the usual entry point. Typical usage of the SDF DOM is through the
+    /// Root object.
+    /// \param[in] _sdf The SDF Element pointer
+    /// \return Errors, which is a vector of Error objects. Each Error includes
+    /// an error code and message. An empty vector indicates no error.
+    public: Errors Load(ElementPtr _sdf);
+
+    /// \brief Get the minimum height of the blend layer.
+    /// \return Minimum height in meters.
+    public: double MinHeight() const;
+
+    /// \brief Set the minimum height of the blend layer.
+    /// \param[in] _minHeight Minimum height in meters.
+    public: void SetMinHeight(double _minHeight);
+
+    /// \brief Get the distance over which the blend occurs.
+    /// \return Distance in meters.
+    public: double FadeDistance() const;
+
+    /// \brief Set the distance over which the blend occurs.
+    /// \param[in] _fadeDistance Distance in meters.
+    public: void SetFadeDistance(double _fadeDistance);
+
+    /// \brief Get a pointer to the SDF element that was used during load.
+    /// \return SDF element pointer. The value will be nullptr if Load has
+    /// not been called.
+    public: sdf::ElementPtr Element() const;
+
+    /// \brief Private data pointer.
+    private: HeightmapBlendPrivate *dataPtr = nullptr;
+  };
+
+  /// \brief Heightmap represents a shape defined by a 2D grayscale image
+  /// or a DEM, usually contained in a Geometry.
+  ///
+  /// Loading a heightmap only reads its description. The height file is
+  /// found and read when a consumer asks for its data, with Data or
+  /// DataAsync, and the data is then kept and shared by the copies of the
+  /// heightmap until ReleaseData.
+  class SDFORMAT_VISIBLE Heightmap
+  {
+    /// \brief Function that loads the data of a heightmap, for example by
+    /// decoding its image. It can be called on a thread of an Executor, and
+    /// returns nullptr if the data can't be loaded.
+    public: using DataLoader = std::function<
+        std::shared_ptr<const HeightmapData>(const Heightmap &)>;
+
+    /// \brief Default constructor
+    public: Heightmap();
+
+    /// \brief Copy constructor
+    /// \param[in] _heightmap Heightmap to copy.
+    public: Heightmap(const Heightmap &_heightmap);
+
+    /// \brief Move constructor
+    /// \param[in] _heightmap Heightmap to move.
+    public: Heightmap(Heightmap &&_heightmap) noexcept;
+
+    /// \brief Copy assignment operator.
+    /// \param[in] _heightmap Heightmap to copy.
+    /// \return Reference to this.
+    public: Heightmap &operator=(const Heightmap &_heightmap);
+
+    /// \brief Move assignment operator.
+    /// \param[in] _heightmap Heightmap to move.
+    /// \return Reference to this.
+    public: Heightmap &operator=(Heightmap &&_heightmap) noexcept;
+
+    /// \brief Destructor
+    public: ~Heightmap();
+
+    /// \brief Load the heightmap geometry based on an element pointer.
+    /// This is *not* the usual entry point. Typical usage of the SDF DOM is
+    /// through the Root object.
+    /// \param[in] _sdf The SDF Element pointer
+    /// \return Errors, which is a vector of Error objects. Each Error includes
+    /// an error code and message. An empty vector indicates no error.
+    public: Errors Load(ElementPtr _sdf);
+
+    /// \brief Get the URI of the height file.
+    /// \return The URI of the height file.
+    public: const std::string &Uri() const;
+
+    /// \brief Set the URI of the height file. The data loaded from the
+    /// previous URI is released.
+    /// \param[in] _uri The URI of the height file.
+    public: void SetUri(const std::string &_uri);
+
+    /// \brief The path to the file where this element was loaded from,
+    /// which relative URIs are resolved against.
+    /// \return Full path to the file on disk.
+    public: const std::string &FilePath() const;
+
+    /// \brief Set the path to the file where this element was loaded from.
+    /// The data loaded from the previous file path is released.
+    /// \param[in] _filePath Full path to the file on disk.
+    public: void SetFilePath(const std::string &_filePath);
+
+    /// \brief Find the absolute path of the height file. The URI is looked
+    /// up the first time, like an included model, and the path is then
+    /// kept and shared by the copies of the heightmap.
+    /// \return Absolute path, or an empty string if the file isn't found.
+    public: std::string ResolvedPath() const;
+
+    /// \brief Get the size of the heightmap.
+    /// \return Size in meters.
+    public: ignition::math::Vector3d Size() const;
+
+    /// \brief Set the size of the heightmap.
+    /// \param[in] _size Size in meters.
+    public: void SetSize(const ignition::math::Vector3d &_size);
+
+    /// \brief Get the position offset of the heightmap.
+    /// \return Position offset in meters.
+    public: ignition::math::Vector3d Position() const;
+
+    /// \brief Set the position offset of the heightmap.
+    /// \param[in] _position Position offset in meters.
+    public: void SetPosition(const ignition::math::Vector3d &_position);
+
+    /// \brief Get whether the heightmap uses terrain paging.
+    /// \return True if terrain paging is enabled.
+    public: bool UseTerrainPaging() const;
+
+    /// \brief Set whether the heightmap uses terrain paging.
+    /// \param[in] _use True to enable terrain paging.
+    public: void SetUseTerrainPaging(bool _use);
+
+    /// \brief Get the number of samples per heightmap datum.
+    /// \return Number of samples.
+    public: unsigned int Sampling() const;
+
+    /// \brief Set the number of samples per heightmap datum.
+    /// \param[in] _sampling Number of samples.
+    public: void SetSampling(unsigned int _sampling);
+
+    /// \brief Get the number of textures.
+    /// \return Number of textures.
+    public: uint64_t TextureCount() const;
+
+    /// \brief Get a texture based on an index.
+    /// \param[in] _index Index of the texture. The index should be in the
+    /// range [0..TextureCount()).
+    /// \return Pointer to the texture. Nullptr if the index does not exist.
+    /// \sa uint64_t TextureCount() const
+    public: const HeightmapTexture *TextureByIndex(uint64_t _index) const;
+
+    /// \brief Add a texture, above the existing ones.
+    /// \param[in] _texture Texture to add.
+    public: void AddTexture(const HeightmapTexture &_texture);
+
+    /// \brief Get the number of blends.
+    /// \return Number of blends.
+    public: uint64_t BlendCount() const;
+
+    /// \brief Get a blend based on an index.
+    /// \param[in] _index Index of the blend. The index should be in the
+    /// range [0..BlendCount()).
+    /// \return Pointer to the blend. Nullptr if the index does not exist.
+    /// \sa uint64_t BlendCount() const
+    public: const HeightmapBlend *BlendByIndex(uint64_t _index) const;
+
+    /// \brief Add a blend, between the next two textures.
+    /// \param[in] _blend Blend to add.
+    public: void AddBlend(const HeightmapBlend &_blend);
+
+    /// \brief Get the axis aligned bounding box of the heightmap, relative
+    /// to its frame. The heightmap is centered on its position offset, with
+    /// heights from the offset up to the height of its size.
+    /// \return The box that contains any height data of the heightmap.
+    public: ignition::math::AxisAlignedBox AxisAlignedBox() const;
+
+    /// \brief Get the data of the height file, loading it on the calling
+    /// thread if no request loaded it yet. By default the file at
+    /// ResolvedPath is memory-mapped.
+    /// \param[in] _loader Function that loads the data instead, used by
+    /// the request that loads it. Later requests get the same data.
+    /// \return The data, or nullptr if it can't be loaded.
+    public: std::shared_ptr<const HeightmapData> Data(
+                const DataLoader &_loader = nullptr) const;
+
+    /// \brief Get the data of the height file, loading it on a thread of an
+    /// executor if no request loaded it yet, as Data does.
+    /// \param[in] _loader Function that loads the data instead, used by
+    /// the request that loads it.
+    /// \param[in] _executor Executor that loads the data, or nullptr for
+    /// Executor::Default.
+    /// \return Future data, which is nullptr if it can't be loaded.
+    public: std::shared_future<std::shared_ptr<const HeightmapData>>
+                DataAsync(const DataLoader &_loader = nullptr,
+                    std::shared_ptr<Executor> _executor = nullptr) const;
+
+    /// \brief Drop the data that was loaded, so that the next request loads
+    /// it again. Holders of the data keep it until they release it.
+    public: void ReleaseData() const;
+
+    /// \brief Get a pointer to the SDF element that was used during load.
+    /// \return SDF element pointer. The value will be nullptr if Load has
+    /// not been called.
+    public: sdf::ElementPtr Element() const;
+
+    /// \brief Private data pointer.
+    private: HeightmapPrivate *dataPtr = nullptr;
+  };
+  }
+}
+#endif
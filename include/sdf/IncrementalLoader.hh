@@ -0,0 +1,173 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_INCREMENTAL_LOADER_HH_
+#define SDF_INCREMENTAL_LOADER_HH_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "sdf/Error.hh"
+#include "sdf/ParserConfig.hh"
+#include "sdf/Types.hh"
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  // Forward declarations.
+  class IncrementalLoaderPrivate;
+  class Root;
+
+  /// \brief Amount of work that one IncrementalLoader::Step may do. A step
+  /// stops at the first limit it reaches, and always does at least one
+  /// unit of work.
+  struct IncrementalLoadBudget
+  {
+    /// \brief Maximum number of XML elements to read into the element
+    /// tree. An included file counts as one element.
+    std::size_t elements = 1000u;
+
+    /// \brief Maximum number of models whose contents are loaded.
+    std::size_t models = 10u;
+
+    /// \brief Maximum number of worlds and top level models whose frame
+    /// graphs are built.
+    std::size_t graphScopes = 1u;
+
+    /// \brief Maximum wall time of the step, checked between units of
+    /// work, so a step can go past it by the time of one unit. Zero for no
+    /// limit.
+    std::chrono::microseconds time{0};
+  };
+
+  /// \enum IncrementalLoadPhase
+  /// \brief Phases of an IncrementalLoader, in order.
+  enum class IncrementalLoadPhase : std::uint8_t
+  {
+    /// \brief Reading the file into the element tree.
+    READ = 0,
+
+    /// \brief Loading the worlds and top level objects, without the
+    /// contents of their models. This is done by one step.
+    LOAD = 1,
+
+    /// \brief Loading the contents of the models.
+    MODELS = 2,
+
+    /// \brief Building the frame graphs of the worlds and top level models.
+    GRAPHS = 3,
+
+    /// \brief The load is finished.
+    DONE = 4,
+  };
+
+  /// \brief Progress of an IncrementalLoader.
+  struct IncrementalLoadProgress
+  {
+    /// \brief Phase of the next step.
+    IncrementalLoadPhase phase = IncrementalLoadPhase::READ;
+
+    /// \brief Number of XML elements read so far.
+    std::size_t elementsRead = 0u;
+
+    /// \brief Number of models whose contents are loaded.
+    std::size_t modelsLoaded = 0u;
+
+    /// \brief Number of models to load, known once LOAD is done.
+    std::size_t modelCount = 0u;
+
+    /// \brief Number of scopes whose frame graphs are built.
+    std::size_t graphScopesBuilt = 0u;
+
+    /// \brief Number of scopes to build, known once LOAD is done.
+    std::size_t graphScopeCount = 0u;
+  };
+
+  /// \brief Loads a file into a Root over several calls to Step, each doing
+  /// a bounded amount of work, so that a caller such as the frame loop of
+  /// an editor can load a large world without blocking for the whole load.
+  /// The steps read the file into the element tree, load the DOM with
+  /// ParserConfig::LazyModels, then load the contents of each model and
+  /// build the frame graphs of each world and top level model.
+  ///
+  /// Once Done() is true, the Root holds the same document as Root::Load
+  /// with the same configuration would give, and LoadErrors() has the same
+  /// errors, although the errors of the models and graphs come after the
+  /// other errors of the document. Since the models are loaded as lazy
+  /// models, the caveats of ParserConfig::LazyModels apply: the elements
+  /// are kept, and materials and meshes are not shared. The includes are
+  /// not recorded for ParserConfig::TrackIncludes, and the load cache and
+  /// ParserConfig::PipelinedLoad are not used. When the configuration has
+  /// ParserConfig::LazyModels enabled already, the models are left to load
+  /// on first access, and the load is done after LOAD.
+  ///
+  /// URDF files, and files read with ParserConfig::StreamingRead or
+  /// ParserConfig::ChunkedXmlParse, are read by the first step as a whole.
+  ///
+  /// The Root must not be used until Done() is true, and must outlive the
+  /// loader. The steps may run on any thread, one at a time.
+  class SDFORMAT_VISIBLE IncrementalLoader
+  {
+    /// \brief Constructor. No work is done until the first step.
+    /// \param[in,out] _root Root to load the file into. Its previous
+    /// document is replaced by the LOAD phase.
+    /// \param[in] _filename Name of the file to load.
+    /// \param[in] _config Parser configuration, which is copied.
+    public: IncrementalLoader(Root &_root, const std::string &_filename,
+                const ParserConfig &_config = ParserConfig());
+
+    /// \brief No copy constructor, the loader holds the state of the read.
+    public: IncrementalLoader(const IncrementalLoader &) = delete;
+
+    /// \brief No copy assignment operator.
+    public: IncrementalLoader &operator=(const IncrementalLoader &) = delete;
+
+    /// \brief Destructor. A load that is not done is abandoned, which
+    /// leaves the Root with the part of the document loaded so far.
+    public: ~IncrementalLoader();
+
+    /// \brief Do the next part of the load.
+    /// \param[in] _budget Amount of work to do.
+    /// \return True once the load is done, including when it failed.
+    public: bool Step(const IncrementalLoadBudget &_budget =
+                IncrementalLoadBudget());
+
+    /// \brief Get whether the load is done.
+    /// \return True once the load is done.
+    public: bool Done() const;
+
+    /// \brief Get the progress of the load.
+    /// \return The progress.
+    public: IncrementalLoadProgress Progress() const;
+
+    /// \brief Get the errors of the load so far, which are complete once
+    /// Done() is true.
+    /// \return The errors.
+    public: const Errors &LoadErrors() const;
+
+    /// \brief Private data pointer.
+    private: IncrementalLoaderPrivate *dataPtr = nullptr;
+  };
+  }
+}
+#endif
@@ -22,7 +22,10 @@
 #include <sdf/Noise.hh>
 #include <sdf/sdf_config.h>
 
+#include <cstddef>
+
 #include <ignition/math/Angle.hh>
+#include <ignition/math/Vector3.hh>
 
 namespace sdf
 {
@@ -241,6 +244,29 @@ namespace sdf
     /// \param[in] _noise Noise values for the lidar sensor.
     public: void SetLidarNoise(const Noise &_noise);
 
+    /// \brief Get the number of rays of a scan, which is the number of
+    /// horizontal samples times the number of vertical samples.
+    /// \return Number of rays.
+    public: std::size_t RayCount() const;
+
+    /// \brief Get the unit direction of each ray of a scan, relative to the
+    /// sensor frame, with the horizontal angle about the Z axis and the
+    /// vertical angle up from the XY plane. The samples of each scan are
+    /// evenly spaced from its minimum angle to its maximum angle, and a
+    /// single sample is at the middle of the two. Rays are ordered by
+    /// vertical sample, then horizontal sample, so ray v * H + h has
+    /// vertical sample v and horizontal sample h, where H is the number of
+    /// horizontal samples. The resolutions scale the number of range values
+    /// interpolated from the rays, not the rays.
+    ///
+    /// The directions are computed on Load, and again on the first call
+    /// after the samples or angles of a scan are set, and are shared by the
+    /// consumers of the lidar instead of being computed by each of them.
+    /// \return Array of RayCount() directions, aligned to 64 bytes for SIMD
+    /// loads, or nullptr if there are no rays. It is valid until the samples
+    /// or angles are set, or the lidar is destroyed.
+    public: const ignition::math::Vector3d *RayDirections() const;
+
     /// \brief Return true if both Lidar objects contain the same values.
     /// \param[_in] _lidar Lidar value to compare.
     /// \return True if 'this' == _lidar.
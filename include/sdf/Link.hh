@@ -22,6 +22,7 @@
 #include <ignition/math/Pose3.hh>
 #include "sdf/Element.hh"
 #include "sdf/SemanticPose.hh"
+#include "sdf/Span.hh"
 #include "sdf/Types.hh"
 #include "sdf/sdf_config.h"
 #include "sdf/system_util.hh"
@@ -36,6 +37,8 @@ namespace sdf
   class Collision;
   class Light;
   class LinkPrivate;
+  class MaterialTable;
+  class MeshRegistry;
   class Sensor;
   class Visual;
   class LinkPrivate;
@@ -97,6 +100,11 @@ namespace sdf
     /// \sa uint64_t VisualCount() const
     public: const Visual *VisualByIndex(const uint64_t _index) const;
 
+    /// \brief Get the visuals.
+    /// \return View of the visuals, in the order of VisualByIndex. It
+    /// is invalidated when visuals are added or removed.
+    public: Span<const Visual> Visuals() const;
+
     /// \brief Get whether a visual name exists.
     /// \param[in] _name Name of the visual to check.
     /// \return True if there exists a visual with the given name.
@@ -118,6 +126,11 @@ namespace sdf
     /// \sa uint64_t CollisionCount() const
     public: const Collision *CollisionByIndex(const uint64_t _index) const;
 
+    /// \brief Get the collisions.
+    /// \return View of the collisions, in the order of CollisionByIndex. It
+    /// is invalidated when collisions are added or removed.
+    public: Span<const Collision> Collisions() const;
+
     /// \brief Get whether a collision name exists.
     /// \param[in] _name Name of the collision to check.
     /// \return True if there exists a collision with the given name.
@@ -139,6 +152,11 @@ namespace sdf
     /// \sa uint64_t LightCount() const
     public: const Light *LightByIndex(const uint64_t _index) const;
 
+    /// \brief Get the lights.
+    /// \return View of the lights, in the order of LightByIndex. It
+    /// is invalidated when lights are added or removed.
+    public: Span<const Light> Lights() const;
+
     /// \brief Get whether a light name exists.
     /// \param[in] _name Name of the light to check.
     /// \return True if there exists a light with the given name.
@@ -160,6 +178,11 @@ namespace sdf
     /// \sa uint64_t SensorCount() const
     public: const Sensor *SensorByIndex(const uint64_t _index) const;
 
+    /// \brief Get the sensors.
+    /// \return View of the sensors, in the order of SensorByIndex. It
+    /// is invalidated when sensors are added or removed.
+    public: Span<const Sensor> Sensors() const;
+
     /// \brief Get whether a sensor name exists.
     /// \param[in] _name Name of the sensor to check.
     /// \return True if there exists a sensor with the given name.
@@ -232,7 +255,28 @@ namespace sdf
     private: void SetPoseRelativeToGraph(
         sdf::ScopedGraph<PoseRelativeToGraph> _graph);
 
-    /// \brief Allow Model::Load to call SetPoseRelativeToGraph.
+    /// \brief Share the materials of the visuals through the material table
+    /// of the world. This is private and is intended to be called by
+    /// Model::ShareMaterials.
+    /// \param[in,out] _table Material table of the world.
+    private: void ShareMaterials(MaterialTable &_table);
+
+    /// \brief Give the visuals the entries of a copy of the material table
+    /// of the world. This is private and is intended to be called by
+    /// Model::UseMaterialCopies.
+    /// \param[in] _table Copy of the material table of the world.
+    private: void UseMaterialCopies(const MaterialTable &_table);
+
+    /// \brief Share the meshes of the visuals and collisions through the
+    /// mesh registry of the Root. This is private and is intended to be
+    /// called by Model::ShareMeshes.
+    /// \param[in,out] _registry Mesh registry of the Root.
+    private: void ShareMeshes(MeshRegistry &_registry);
+
+    /// \brief Allow Model::Load to call SetPoseRelativeToGraph, and
+    /// Model::ShareMaterials, Model::UseMaterialCopies and
+    /// Model::ShareMeshes to call ShareMaterials, UseMaterialCopies and
+    /// ShareMeshes.
     friend class Model;
 
     /// \brief Check if this link should be subject to wind.
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_LOAD_OBSERVER_HH_
+#define SDF_LOAD_OBSERVER_HH_
+
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  // Forward declarations.
+  class Actor;
+  class Light;
+  class Model;
+  class World;
+
+  /// \brief Receives the top level models, lights and actors of a document
+  /// while Root::Load is still loading the rest of it, so that an
+  /// application can start creating its own objects for them, e.g. by
+  /// handing them to other threads. ParserConfig::SetLoadObserver sets the
+  /// observer of a load.
+  ///
+  /// The frame graphs of a world need all of its models and frames, so the
+  /// models, lights and actors of a world are given once the graphs of the
+  /// world are built, before the next world is loaded, and their poses can
+  /// then be resolved. The models at the root of the document have graphs
+  /// of their own, and are given once these are built, followed by the
+  /// lights and actors at the root. Entities are given in document order,
+  /// on the thread that calls Root::Load. The objects stay valid until the
+  /// Root is modified or destroyed, and must not be modified.
+  ///
+  /// The functions do nothing by default.
+  class SDFORMAT_VISIBLE LoadObserver
+  {
+    /// \brief Destructor
+    public: virtual ~LoadObserver();
+
+    /// \brief Called with each top level model that is loaded.
+    /// \param[in] _world World of the model, which is only valid during the
+    /// call, or nullptr for a model at the root of the document.
+    /// \param[in] _model The model.
+    public: virtual void ModelLoaded(const World *_world,
+                const Model &_model);
+
+    /// \brief Called with each top level light that is loaded.
+    /// \param[in] _world World of the light, which is only valid during the
+    /// call, or nullptr for a light at the root of the document.
+    /// \param[in] _light The light.
+    public: virtual void LightLoaded(const World *_world,
+                const Light &_light);
+
+    /// \brief Called with each top level actor that is loaded.
+    /// \param[in] _world World of the actor, which is only valid during the
+    /// call, or nullptr for an actor at the root of the document.
+    /// \param[in] _actor The actor.
+    public: virtual void ActorLoaded(const World *_world,
+                const Actor &_actor);
+  };
+  }
+}
+#endif
@@ -0,0 +1,209 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_LOAD_STATS_HH_
+#define SDF_LOAD_STATS_HH_
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  // Forward declare private data class.
+  class LoadStatsPrivate;
+
+  /// \enum LoadPhase
+  /// \brief Phases of loading an SDF document that are measured by
+  /// LoadStats.
+  enum class LoadPhase
+  {
+    /// \brief Parsing XML text into a tinyxml2 document.
+    XML_PARSE = 0,
+
+    /// \brief Converting a document to the latest SDFormat version.
+    CONVERSION,
+
+    /// \brief Converting a URDF document to SDFormat.
+    URDF_CONVERSION,
+
+    /// \brief Resolving and reading <include> elements.
+    INCLUDE,
+
+    /// \brief Reading XML elements into the sdf::Element tree.
+    READ_XML,
+
+    /// \brief Loading DOM objects in Root::Load.
+    DOM_LOAD,
+
+    /// \brief Building frame attached-to and pose relative-to graphs.
+    FRAME_GRAPH_BUILD,
+
+    /// \brief Validating frame attached-to and pose relative-to graphs.
+    FRAME_GRAPH_VALIDATE,
+
+    /// \brief Parsing a URDF document with urdfdom, within URDF_CONVERSION.
+    URDF_PARSE,
+
+    /// \brief Lumping links connected by fixed joints, within
+    /// URDF_CONVERSION.
+    URDF_REDUCE_FIXED_JOINTS,
+
+    /// \brief Writing the SDFormat links and joints of a URDF document,
+    /// within URDF_CONVERSION.
+    URDF_CREATE_SDF,
+
+    /// \brief Number of phases. Not a phase.
+    PHASE_COUNT
+  };
+
+  /// \brief Load cost of one DOM class, such as "Link", collected by
+  /// LoadStats when DOM profiling is enabled.
+  struct DomLoadProfile
+  {
+    /// \brief Name of the DOM class.
+    std::string className;
+
+    /// \brief Number of calls to the Load function of the class.
+    std::uint64_t count = 0u;
+
+    /// \brief Wall time spent in the Load function, including the DOM
+    /// objects it loads. Recursive classes, such as nested models, count
+    /// the time of the inner calls again.
+    std::chrono::nanoseconds total{0};
+
+    /// \brief Wall time spent in the Load function, excluding the DOM
+    /// objects it loads on the same thread.
+    std::chrono::nanoseconds self{0};
+  };
+
+  /// \brief Wall time and call counts for each LoadPhase, collected while
+  /// loading SDF documents. Set a LoadStats object on a ParserConfig with
+  /// ParserConfig::SetStats to collect statistics for the functions that
+  /// take the ParserConfig, such as readFile and Root::Load.
+  ///
+  /// Phases can nest, e.g. READ_XML contains INCLUDE, so the durations of
+  /// different phases overlap. Recursive entries of the same phase are
+  /// counted, but their time is only measured once. When more than one
+  /// load thread is used, durations are summed over all threads.
+  ///
+  /// When DOM profiling is enabled with SetDomProfiling, the Load function
+  /// of every DOM class also reports its calls and time, see DomProfile.
+  /// It is disabled by default, because it reads the clock twice for every
+  /// DOM object.
+  ///
+  /// A LoadStats object can be updated from several threads at the same
+  /// time.
+  class SDFORMAT_VISIBLE LoadStats
+  {
+    /// \brief Default constructor
+    public: LoadStats();
+
+    /// \brief Copy constructor
+    /// \param[in] _stats LoadStats to copy.
+    public: LoadStats(const LoadStats &_stats);
+
+    /// \brief Move constructor
+    /// \param[in] _stats LoadStats to move.
+    public: LoadStats(LoadStats &&_stats) noexcept;
+
+    /// \brief Move assignment operator.
+    /// \param[in] _stats LoadStats to move.
+    /// \return Reference to this.
+    public: LoadStats &operator=(LoadStats &&_stats) noexcept;
+
+    /// \brief Copy assignment operator.
+    /// \param[in] _stats LoadStats to copy.
+    /// \return Reference to this.
+    public: LoadStats &operator=(const LoadStats &_stats);
+
+    /// \brief Destructor
+    public: ~LoadStats();
+
+    /// \brief Get the total wall time spent in a phase.
+    /// \param[in] _phase The phase.
+    /// \return Time spent in the phase.
+    public: std::chrono::nanoseconds Duration(LoadPhase _phase) const;
+
+    /// \brief Get the number of times a phase was entered.
+    /// \param[in] _phase The phase.
+    /// \return Number of times the phase was entered.
+    public: std::uint64_t Count(LoadPhase _phase) const;
+
+    /// \brief Add time and calls to a phase.
+    /// \param[in] _phase The phase.
+    /// \param[in] _duration Time to add.
+    /// \param[in] _count Number of calls to add.
+    public: void Add(LoadPhase _phase, std::chrono::nanoseconds _duration,
+                     std::uint64_t _count = 1u);
+
+    /// \brief Set all durations and counts to zero, and clear the DOM
+    /// profile. DOM profiling stays enabled or disabled.
+    public: void Reset();
+
+    /// \brief Enable or disable the collection of the DOM profile.
+    /// \param[in] _enabled True to collect the DOM profile.
+    public: void SetDomProfiling(bool _enabled);
+
+    /// \brief Get whether the DOM profile is collected.
+    /// \return True if the DOM profile is collected.
+    public: bool DomProfiling() const;
+
+    /// \brief Add calls and time to the DOM profile of a class. This
+    /// doesn't check DomProfiling.
+    /// \param[in] _className Name of the DOM class.
+    /// \param[in] _total Time to add, including the objects it loads.
+    /// \param[in] _self Time to add, excluding the objects it loads.
+    /// \param[in] _count Number of calls to add.
+    public: void AddDomLoad(const std::string &_className,
+                std::chrono::nanoseconds _total,
+                std::chrono::nanoseconds _self,
+                std::uint64_t _count = 1u);
+
+    /// \brief Get the DOM profile.
+    /// \return One entry per DOM class that was loaded, by decreasing self
+    /// time.
+    public: std::vector<DomLoadProfile> DomProfile() const;
+
+    /// \brief Get the name of a phase, e.g. "xml_parse".
+    /// \param[in] _phase The phase.
+    /// \return Name of the phase.
+    public: static std::string PhaseName(LoadPhase _phase);
+
+    /// \brief Output operator for LoadStats. Writes one line per phase
+    /// with its name, duration in milliseconds and count, followed by one
+    /// line per class of the DOM profile.
+    /// \param[in,out] _out The output stream.
+    /// \param[in] _stats The statistics to output.
+    /// \return Reference to the given output stream
+    public: friend SDFORMAT_VISIBLE std::ostream &operator<<(
+                std::ostream &_out, const LoadStats &_stats);
+
+    /// \brief Private data pointer.
+    private: LoadStatsPrivate *dataPtr = nullptr;
+  };
+  }
+}
+#endif
@@ -0,0 +1,158 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_MEMORY_FOOTPRINT_HH_
+#define SDF_MEMORY_FOOTPRINT_HH_
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  // Forward declarations.
+  class MemoryFootprintReportPrivate;
+
+  /// \brief Bytes of memory used by a loaded document, by category. The
+  /// bytes are estimated from the sizes of the objects and of the storage
+  /// of their containers and strings, without the overhead of the
+  /// allocator.
+  struct SDFORMAT_VISIBLE MemoryFootprint
+  {
+    /// \brief Element objects, with their child vectors and name indices.
+    std::size_t elements = 0;
+
+    /// \brief Param objects of the attributes and values of elements.
+    std::size_t params = 0;
+
+    /// \brief Descriptions of elements and params from the specification,
+    /// which are shared by all the elements made from them. Each one is
+    /// counted once per call.
+    std::size_t descriptions = 0;
+
+    /// \brief Heap storage of the strings of elements and params, such as
+    /// paths and string values, and of the names of DOM objects. Element
+    /// names, attribute keys and type names are shared by the whole
+    /// process, so they are not counted.
+    std::size_t strings = 0;
+
+    /// \brief DOM objects such as sdf::World, sdf::Model and sdf::Link,
+    /// with their private data but not nested value types such as
+    /// sdf::Geometry.
+    std::size_t domObjects = 0;
+
+    /// \brief Frame attached-to and pose relative-to graphs, with their
+    /// name maps and caches.
+    std::size_t frameGraphs = 0;
+
+    /// \brief Get the sum of all categories.
+    /// \return Total number of bytes.
+    std::size_t Total() const;
+
+    /// \brief Add the bytes of another footprint to this one.
+    /// \param[in] _footprint Footprint to add.
+    /// \return Reference to this.
+    MemoryFootprint &operator+=(const MemoryFootprint &_footprint);
+  };
+
+  /// \brief Memory used by a document loaded with sdf::Root, in total and
+  /// for each top level model, made by Root::MemoryReport.
+  ///
+  /// The models are those of each world, named "world::model", followed
+  /// by the model of the root. The frame graphs of a world are shared with
+  /// its models, so they are only in the total. Descriptions are shared by
+  /// the whole document, so each model counts those it uses, and they are
+  /// counted once in the total.
+  class SDFORMAT_VISIBLE MemoryFootprintReport
+  {
+    /// \brief Default constructor, for an empty report.
+    public: MemoryFootprintReport();
+
+    /// \brief Copy constructor
+    /// \param[in] _report MemoryFootprintReport to copy.
+    public: MemoryFootprintReport(const MemoryFootprintReport &_report);
+
+    /// \brief Move constructor
+    /// \param[in] _report MemoryFootprintReport to move.
+    public: MemoryFootprintReport(MemoryFootprintReport &&_report) noexcept;
+
+    /// \brief Move assignment operator.
+    /// \param[in] _report MemoryFootprintReport to move.
+    /// \return Reference to this.
+    public: MemoryFootprintReport &operator=(
+                MemoryFootprintReport &&_report) noexcept;
+
+    /// \brief Copy assignment operator.
+    /// \param[in] _report MemoryFootprintReport to copy.
+    /// \return Reference to this.
+    public: MemoryFootprintReport &operator=(
+                const MemoryFootprintReport &_report);
+
+    /// \brief Destructor
+    public: ~MemoryFootprintReport();
+
+    /// \brief Get the memory used by the whole document.
+    /// \return Footprint of the document.
+    public: const MemoryFootprint &Total() const;
+
+    /// \brief Set the memory used by the whole document.
+    /// \param[in] _total Footprint of the document.
+    public: void SetTotal(const MemoryFootprint &_total);
+
+    /// \brief Get the number of top level models.
+    /// \return Number of models.
+    public: std::size_t ModelCount() const;
+
+    /// \brief Get the name of a top level model.
+    /// \param[in] _index Index of the model, less than ModelCount().
+    /// \return Name of the model, or an empty string if _index is out of
+    /// range.
+    public: const std::string &ModelName(std::size_t _index) const;
+
+    /// \brief Get the memory used by a top level model.
+    /// \param[in] _index Index of the model, less than ModelCount().
+    /// \return Footprint of the model, or an empty footprint if _index is
+    /// out of range.
+    public: const MemoryFootprint &ModelFootprint(std::size_t _index) const;
+
+    /// \brief Add a top level model.
+    /// \param[in] _name Name of the model.
+    /// \param[in] _footprint Footprint of the model.
+    public: void AddModel(const std::string &_name,
+                const MemoryFootprint &_footprint);
+
+    /// \brief Output operator for MemoryFootprintReport. Writes the bytes
+    /// of each category of the total, then one line per model with its
+    /// name and total bytes.
+    /// \param[in,out] _out The output stream.
+    /// \param[in] _report The report to output.
+    /// \return Reference to the given output stream
+    public: friend SDFORMAT_VISIBLE std::ostream &operator<<(
+                std::ostream &_out, const MemoryFootprintReport &_report);
+
+    /// \brief Private data pointer.
+    private: MemoryFootprintReportPrivate *dataPtr = nullptr;
+  };
+  }
+}
+#endif
@@ -17,7 +17,10 @@
 #ifndef SDF_MESH_HH_
 #define SDF_MESH_HH_
 
+#include <functional>
+#include <optional>
 #include <string>
+#include <ignition/math/AxisAlignedBox.hh>
 #include <ignition/math/Vector3.hh>
 #include <sdf/Element.hh>
 #include <sdf/Error.hh>
@@ -36,6 +39,14 @@ namespace sdf
   /// Geometry.
   class SDFORMAT_VISIBLE Mesh
   {
+    /// \brief Function that gives the axis aligned bounding box of the data
+    /// of a mesh, or of its submesh if it has one, before the scale of the
+    /// mesh is applied. It returns nothing if the data can't be read. SDF
+    /// doesn't read meshes, so their bounds come from the application.
+    public: using AxisAlignedBoxCalculator =
+        std::function<std::optional<ignition::math::AxisAlignedBox>(
+            const Mesh &_mesh)>;
+
     /// \brief Constructor
     public: Mesh();
 
@@ -120,6 +131,14 @@ namespace sdf
     /// not been called.
     public: sdf::ElementPtr Element() const;
 
+    /// \brief Get the axis aligned bounding box of the mesh, relative to its
+    /// frame, with its scale applied.
+    /// \param[in] _calculator Function that gives the bounds of the mesh
+    /// data.
+    /// \return The box, or nothing if _calculator is empty or gives nothing.
+    public: std::optional<ignition::math::AxisAlignedBox> AxisAlignedBox(
+        const AxisAlignedBoxCalculator &_calculator) const;
+
     /// \brief Private data pointer.
     private: MeshPrivate *dataPtr;
   };
@@ -17,12 +17,18 @@
 #ifndef SDF_MODEL_HH_
 #define SDF_MODEL_HH_
 
+#include <cstddef>
+#include <limits>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
+#include <ignition/math/Inertial.hh>
 #include <ignition/math/Pose3.hh>
 #include "sdf/Element.hh"
+#include "sdf/PoseGraphSnapshot.hh"
 #include "sdf/SemanticPose.hh"
+#include "sdf/Span.hh"
 #include "sdf/Types.hh"
 #include "sdf/sdf_config.h"
 #include "sdf/system_util.hh"
@@ -34,14 +40,72 @@ namespace sdf
   //
 
   // Forward declarations.
+  class DeferredGraphs;
   class Frame;
   class Joint;
   class Link;
+  class MaterialTable;
+  class MeshRegistry;
   class ModelPrivate;
   struct PoseRelativeToGraph;
   struct FrameAttachedToGraph;
   template <typename T> class ScopedGraph;
 
+  /// \brief Kinematic tree formed by the links and joints of a model, with
+  /// links and joints identified by their index in the model, as given to
+  /// Model::LinkByIndex and Model::JointByIndex. Only the links of the
+  /// model itself are part of the tree; joints to the world or to links of
+  /// nested models don't connect two links of the tree.
+  ///
+  /// The tree is stored in flat arrays. The children of link `i` are the
+  /// child links of the joints in `childJoints`, from
+  /// `childJoints[childOffsets[i]]` up to, but not including,
+  /// `childJoints[childOffsets[i + 1]]`.
+  struct SDFORMAT_VISIBLE KinematicTopology
+  {
+    /// \brief Index used for a missing link or joint.
+    static constexpr std::size_t kInvalidIndex =
+        std::numeric_limits<std::size_t>::max();
+
+    /// \brief Parent link of each joint, or kInvalidIndex if the parent is
+    /// the world or not a link of the model.
+    std::vector<std::size_t> jointParentLink;
+
+    /// \brief Child link of each joint, or kInvalidIndex if the child is
+    /// not a link of the model.
+    std::vector<std::size_t> jointChildLink;
+
+    /// \brief Joint of each link to its parent in the tree, or to the
+    /// world, else kInvalidIndex.
+    std::vector<std::size_t> parentJoint;
+
+    /// \brief Parent link of each link in the tree, or kInvalidIndex for a
+    /// root link.
+    std::vector<std::size_t> parentLink;
+
+    /// \brief Offsets in childJoints of the joints to the children of each
+    /// link, with one more entry than there are links.
+    std::vector<std::size_t> childOffsets;
+
+    /// \brief Joints from each link to its children, grouped by parent
+    /// link, in the order of the joints in the model.
+    std::vector<std::size_t> childJoints;
+
+    /// \brief The links, depth first, so that each link comes after its
+    /// parent and the links of a subtree are contiguous.
+    std::vector<std::size_t> order;
+
+    /// \brief Links without a parent link, in the order of the links in
+    /// the model. Their parent joint, if any, attaches them to the world or
+    /// to a link of a nested model.
+    std::vector<std::size_t> rootLinks;
+
+    /// \brief Joints left out of the tree because they close a kinematic
+    /// loop, either by giving a link a second parent or by connecting a
+    /// link to one of its descendants.
+    std::vector<std::size_t> loopJoints;
+  };
+
   class SDFORMAT_VISIBLE Model
   {
     /// \brief Default constructor
@@ -76,6 +140,23 @@ namespace sdf
     /// an error code and message. An empty vector indicates no error.
     public: Errors Load(ElementPtr _sdf);
 
+    /// \brief Get whether the links, joints, frames and nested models of
+    /// this model are loaded. They are loaded by Load, unless the model was
+    /// loaded with ParserConfig::LazyModels enabled, in which case they are
+    /// loaded the first time any of them is accessed, or by LoadContents.
+    /// \return True if the contents of this model are loaded.
+    public: bool ContentsLoaded() const;
+
+    /// \brief Load the links, joints, frames and nested models of a model
+    /// loaded with ParserConfig::LazyModels enabled, if they are not loaded
+    /// yet, and build the frame graphs of its world or root model. This is
+    /// thread-safe, and is what any access to the contents does first.
+    /// \return Errors found while loading the contents, followed by errors
+    /// of the frame graphs of the world or root model of this model. They
+    /// are empty for a model whose contents were loaded by Load, which
+    /// returned them, or for a copy of a model.
+    public: Errors LoadContents() const;
+
     /// \brief Get the name of the model.
     /// The name of the model should be unique within the scope of a World.
     /// \return Name of the model.
@@ -148,6 +229,11 @@ namespace sdf
     /// \sa uint64_t LinkCount() const
     public: const Link *LinkByIndex(const uint64_t _index) const;
 
+    /// \brief Get the immediate (not nested) child links.
+    /// \return View of the links, in the order of LinkByIndex. It
+    /// is invalidated when links are added or removed.
+    public: Span<const Link> Links() const;
+
     /// \brief Get a link based on a name.
     /// \param[in] _name Name of the link.
     /// To get a link in a nested model, prefix the link name with the
@@ -176,6 +262,11 @@ namespace sdf
     /// \sa uint64_t JointCount() const
     public: const Joint *JointByIndex(const uint64_t _index) const;
 
+    /// \brief Get the immediate (not nested) child joints.
+    /// \return View of the joints, in the order of JointByIndex. It
+    /// is invalidated when joints are added or removed.
+    public: Span<const Joint> Joints() const;
+
     /// \brief Get whether a joint name exists.
     /// \param[in] _name Name of the joint to check.
     /// To check for a joint in a nested model, prefix the joint name with
@@ -208,6 +299,11 @@ namespace sdf
     /// \sa uint64_t FrameCount() const
     public: const Frame *FrameByIndex(const uint64_t _index) const;
 
+    /// \brief Get the immediate (not nested) explicit frames.
+    /// \return View of the frames, in the order of FrameByIndex. It
+    /// is invalidated when frames are added or removed.
+    public: Span<const Frame> Frames() const;
+
     /// \brief Get an explicit frame based on a name.
     /// \param[in] _name Name of the explicit frame.
     /// To get a frame in a nested model, prefix the frame name with the
@@ -238,6 +334,11 @@ namespace sdf
     /// \sa uint64_t ModelCount() const
     public: const Model *ModelByIndex(const uint64_t _index) const;
 
+    /// \brief Get the immediate (not nested) child models.
+    /// \return View of the models, in the order of ModelByIndex. It
+    /// is invalidated when models are added or removed.
+    public: Span<const Model> Models() const;
+
     /// \brief Get whether a nested model name exists.
     /// \param[in] _name Name of the nested model to check.
     /// To check for a model nested in other models, prefix the model name
@@ -321,6 +422,83 @@ namespace sdf
     public: std::pair<const Link *, std::string> CanonicalLinkAndRelativeName()
         const;
 
+    /// \brief Resolve the poses of all the links, visuals, collisions,
+    /// sensors, joints, frames and nested models of this model relative to
+    /// the model frame, with a single sweep of the pose graph. This is
+    /// equivalent to, and much cheaper than, calling SemanticPose().Resolve()
+    /// on each of them.
+    ///
+    /// The entities are listed depth first in the order of the DOM: each
+    /// link followed by its visuals, collisions and sensors, then joints,
+    /// frames and each nested model followed by its own entities. The order
+    /// only depends on the model, so _names can be read once and reused.
+    /// \param[out] _poses Pose of each entity. The vector is replaced.
+    /// \param[out] _names Name of each entity, scoped relative to this
+    /// model, such as "link::visual" or "nested::link". The vector is
+    /// replaced.
+    /// \return Errors. Entities whose pose could not be resolved are still
+    /// listed, with a zero pose.
+    public: Errors ResolvePoses(std::vector<ignition::math::Pose3d> &_poses,
+                std::vector<std::string> &_names) const;
+
+    /// \brief Take an immutable snapshot of the resolved poses of the frames
+    /// of this model, including the frames of its nested models, that
+    /// threads can resolve poses from without locks, with
+    /// PoseGraphSnapshot::Resolve or SemanticPose::Resolve. The DOM must not
+    /// be modified while the snapshot is taken.
+    /// \return The snapshot, without frames if the model was not loaded
+    /// through sdf::Root.
+    public: sdf::PoseGraphSnapshot PoseSnapshot() const;
+
+    /// \brief Get the kinematic tree of the links and joints of this model.
+    /// The tree is built when the model is loaded, from the link names of
+    /// the joints, and rebuilt when the frame graphs are built so that
+    /// joints attached to frames are resolved to the links of the frames.
+    /// \return The kinematic tree.
+    public: const KinematicTopology &Topology() const;
+
+    /// \brief Compute the poses of the links of this model relative to the
+    /// model frame for a batch of joint configurations. Revolute and
+    /// continuous joints rotate their child link about the first axis of
+    /// the joint by the joint position, and prismatic joints translate it
+    /// along that axis, with the joint frames and the poses of the links at
+    /// zero positions taken from the pose graph. Links move with their
+    /// parent in the Topology, and joints that close loops are ignored.
+    ///
+    /// The data is laid out by joint and by link, with the configurations
+    /// contiguous, so that the computation runs over arrays of
+    /// configurations. The joint frames are resolved by the first call and
+    /// cached until the graphs change.
+    /// \param[in] _positions Position of joint `j` in configuration `k` at
+    /// `_positions[j * _count + k]`, with JointCount() * _count entries.
+    /// Positions of fixed joints are ignored.
+    /// \param[in] _count Number of configurations.
+    /// \param[out] _poses Pose of link `i` in configuration `k` at
+    /// `_poses[i * _count + k]`. The vector is replaced.
+    /// \return Errors if _positions doesn't have the expected size, if the
+    /// pose graph can't resolve the links and joints, or if a joint has a
+    /// type other than revolute, continuous, prismatic or fixed, in which
+    /// case it is treated as fixed.
+    public: Errors ForwardKinematics(const std::vector<double> &_positions,
+                std::size_t _count,
+                std::vector<ignition::math::Pose3d> &_poses) const;
+
+    /// \brief Get the total mass, center of mass and inertia of the links of
+    /// this model, summed as ignition::math::Inertiald. The poses of the
+    /// links are resolved with ResolvePoses by the first call, and the sums
+    /// are cached until the graphs change.
+    /// \param[out] _inertial The composite inertial, with a pose relative
+    /// to _frame. Its mass is zero if the model has no link with a mass.
+    /// \param[in] _frame Name of the frame to express the inertial in, such
+    /// as a link, a frame or "nested::link", as scoped by ResolvePoses. An
+    /// empty name or "__model__" is the model frame.
+    /// \param[in] _nested True to include the links of nested models.
+    /// \return Errors if the pose graph can't resolve the links, or if
+    /// _frame is not in this model, in which case _inertial is relative to
+    /// the model frame.
+    public: Errors CompositeInertial(ignition::math::Inertiald &_inertial,
+                const std::string &_frame = "", bool _nested = true) const;
+
     /// \brief Give the scoped PoseRelativeToGraph to be used for resolving
     /// poses. This is private and is intended to be called by Root::Load or
     /// World::SetPoseRelativeToGraph if this is a standalone model and
@@ -337,9 +515,79 @@ namespace sdf
     private: void SetFrameAttachedToGraph(
         sdf::ScopedGraph<FrameAttachedToGraph> _graph);
 
+    /// \brief Load a model whose links, joints, frames and nested models
+    /// are identical to those of another model, which are then shared
+    /// instead of loaded again. Only the name, pose and other properties of
+    /// the model itself are read from the element. This is private and is
+    /// intended to be called by World::Load when
+    /// ParserConfig::ShareIncludedModels is enabled.
+    /// \param[in] _sdf The SDF Element pointer.
+    /// \param[in] _template Model loaded from an element with identical
+    /// children.
+    /// \return Errors, which is a vector of Error objects. Each Error includes
+    /// an error code and message. An empty vector indicates no error.
+    private: Errors LoadInstance(ElementPtr _sdf, const Model &_template);
+
+    /// \brief Drop the element of this model and of its nested models, so
+    /// that Element returns nullptr. This is private and is intended to be
+    /// called by Root::Load, World::ReleaseElement and Population::Load
+    /// when ParserConfig::ReleaseElements is enabled, once the frame graphs
+    /// that are built from the element exist.
+    private: void ReleaseElement();
+
+    /// \brief Discard the data that this model and its nested models
+    /// resolved from the pose graph, such as the data of
+    /// ForwardKinematics and CompositeInertial, when poses of the graph are
+    /// changed in place. This is private and is intended to be called by
+    /// World::ApplyState.
+    private: void ResetPoseCaches();
+
+    /// \brief Share the materials of the visuals of this model and of its
+    /// nested models through the material table of the world. This is
+    /// private and is intended to be called by World::Load,
+    /// World::ReplaceModel and World::Merge when ParserConfig::ShareMaterials
+    /// is enabled.
+    /// \param[in,out] _table Material table of the world.
+    private: void ShareMaterials(MaterialTable &_table);
+
+    /// \brief Give the visuals of this model and of its nested models the
+    /// entries of a copy of the material table of the world. This is
+    /// private and is intended to be called by the World copy constructor.
+    /// \param[in] _table Copy of the material table of the world.
+    private: void UseMaterialCopies(const MaterialTable &_table);
+
+    /// \brief Share the meshes of the visuals and collisions of this model
+    /// and of its nested models through the mesh registry of the Root. This
+    /// is private and is intended to be called by Root::Load when
+    /// ParserConfig::ShareMeshes is enabled.
+    /// \param[in,out] _registry Mesh registry of the Root.
+    private: void ShareMeshes(MeshRegistry &_registry);
+
+    /// \brief Give the frame graphs of the world or root model of this
+    /// model, to be built the first time the contents of the model are
+    /// accessed. This is private and is intended to be called by
+    /// Root::Load and World when ParserConfig::LazyModels is enabled.
+    /// \param[in] _graphs Graphs of the scope of this model.
+    private: void SetDeferredGraphs(
+        const std::shared_ptr<DeferredGraphs> &_graphs);
+
+    /// \brief Load the links, joints, frames and nested models of a model
+    /// loaded with ParserConfig::LazyModels, if they are not loaded yet,
+    /// without building the frame graphs of its world or root model. This
+    /// is private and is intended to be called by IncrementalLoader, which
+    /// builds the graphs in later steps.
+    /// \return Errors found while loading the contents.
+    private: Errors LoadOwnContents() const;
+
     /// \brief Allow Root::Load, World::SetPoseRelativeToGraph, or
     /// World::SetFrameAttachedToGraph to call SetPoseRelativeToGraph and
-    /// SetFrameAttachedToGraph
+    /// SetFrameAttachedToGraph, World::Load to call LoadInstance,
+    /// World::ApplyState to call ResetPoseCaches, World to call
+    /// ShareMaterials, Root and World to call ShareMeshes and
+    /// SetDeferredGraphs, Root, World and Population to call
+    /// ReleaseElement, and IncrementalLoader to call LoadOwnContents.
+    friend class IncrementalLoaderPrivate;
+    friend class Population;
     friend class Root;
     friend class World;
 
@@ -0,0 +1,133 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_NOISE_SAMPLER_HH_
+#define SDF_NOISE_SAMPLER_HH_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "sdf/Noise.hh"
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  // Forward declarations.
+  class NoiseSamplerPrivate;
+
+  /// \brief Applies the noise model of a Noise object to buffers of
+  /// readings, such as the ranges of a lidar scan or a stream of IMU
+  /// samples.
+  ///
+  /// Each reading gets `mean + bias + dynamic bias + stddev * n` added,
+  /// where n is a standard normal value, and is rounded to a multiple of
+  /// the precision for GAUSSIAN_QUANTIZED noise with a positive precision.
+  /// Buffers with NONE noise are left unchanged.
+  ///
+  /// The normal values come from a counter-based generator: the value of
+  /// a reading only depends on the seed and on its counter, which is the
+  /// number of readings the sampler processed before it. Splitting a buffer
+  /// into several calls, or between samplers with the same seed whose
+  /// counters are set to the offsets of the parts, gives the same result
+  /// as a single call. The additions and the rounding are done with SIMD
+  /// instructions when they are available.
+  ///
+  /// The bias is drawn once, when the sampler is made, from the normal
+  /// distribution of BiasMean and BiasStdDev, with a random sign. The
+  /// dynamic bias starts at zero and changes with UpdateDynamicBias.
+  class SDFORMAT_VISIBLE NoiseSampler
+  {
+    /// \brief Default constructor, for a sampler without noise.
+    public: NoiseSampler();
+
+    /// \brief Constructor.
+    /// \param[in] _noise Noise model to apply.
+    /// \param[in] _seed Seed of the generator.
+    public: explicit NoiseSampler(const Noise &_noise,
+                std::uint64_t _seed = 0);
+
+    /// \brief Copy constructor
+    /// \param[in] _sampler NoiseSampler to copy.
+    public: NoiseSampler(const NoiseSampler &_sampler);
+
+    /// \brief Move constructor
+    /// \param[in] _sampler NoiseSampler to move.
+    public: NoiseSampler(NoiseSampler &&_sampler) noexcept;
+
+    /// \brief Move assignment operator.
+    /// \param[in] _sampler NoiseSampler to move.
+    /// \return Reference to this.
+    public: NoiseSampler &operator=(NoiseSampler &&_sampler) noexcept;
+
+    /// \brief Copy assignment operator.
+    /// \param[in] _sampler NoiseSampler to copy.
+    /// \return Reference to this.
+    public: NoiseSampler &operator=(const NoiseSampler &_sampler);
+
+    /// \brief Destructor
+    public: ~NoiseSampler();
+
+    /// \brief Add noise to readings, and advance the counter by their
+    /// number.
+    /// \param[in,out] _data Readings.
+    /// \param[in] _count Number of readings.
+    public: void Apply(double *_data, std::size_t _count);
+
+    /// \brief Add noise to readings, and advance the counter by their
+    /// number. The noise is computed in double precision and added in
+    /// single precision.
+    /// \param[in,out] _data Readings.
+    /// \param[in] _count Number of readings.
+    public: void Apply(float *_data, std::size_t _count);
+
+    /// \brief Get the counter of the next reading.
+    /// \return Number of readings processed since the sampler was made or
+    /// the counter was set.
+    public: std::uint64_t Counter() const;
+
+    /// \brief Set the counter of the next reading.
+    /// \param[in] _counter Counter of the next reading.
+    public: void SetCounter(std::uint64_t _counter);
+
+    /// \brief Get the constant bias added to the readings.
+    /// \return The bias.
+    public: double Bias() const;
+
+    /// \brief Get the current dynamic bias added to the readings.
+    /// \return The dynamic bias.
+    public: double DynamicBias() const;
+
+    /// \brief Advance the dynamic bias, as a first order Gauss-Markov
+    /// process of DynamicBiasStdDev and DynamicBiasCorrelationTime. Nothing
+    /// changes if either of them is not positive.
+    /// \param[in] _dt Time since the previous update, in seconds.
+    public: void UpdateDynamicBias(double _dt);
+
+    /// \brief Get the name of the SIMD instructions used by Apply.
+    /// \return "AVX", "SSE2", "NEON" or "scalar".
+    public: static const char *InstructionSet();
+
+    /// \brief Private data pointer.
+    private: NoiseSamplerPrivate *dataPtr = nullptr;
+  };
+  }
+}
+#endif
@@ -21,19 +21,24 @@
 #include <any>
 #include <algorithm>
 #include <cctype>
+#include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <optional>
 #include <sstream>
 #include <string>
+#include <type_traits>
 #include <typeinfo>
+#include <utility>
 #include <variant>
 #include <vector>
 
 #include <ignition/math.hh>
 
 #include "sdf/Console.hh"
+#include "sdf/Span.hh"
 #include "sdf/sdf_config.h"
 #include "sdf/system_util.hh"
 #include "sdf/Types.hh"
@@ -64,6 +69,13 @@ namespace sdf
   /// \internal
   class ParamPrivate;
 
+  /// \internal
+  class BinarySnapshot;
+
+  class ParamUpdateBatch;
+
+  class Element;
+
   template<class T>
   struct ParamStreamer
   {
@@ -79,6 +91,40 @@ namespace sdf
     return os;
   }
 
+  /// \brief Write a numeric array as its numbers separated by spaces.
+  inline std::ostream& operator<<(std::ostream &os,
+                                  ParamStreamer<std::vector<double>> s)
+  {
+    for (std::size_t i = 0; i < s.val.size(); ++i)
+    {
+      if (i > 0)
+        os << ' ';
+      os << s.val[i];
+    }
+    return os;
+  }
+
+  /// \internal
+  /// \brief Read a value from a stream, as the stream extraction operator
+  /// does, and a numeric array as all the numbers that remain.
+  /// \param[in,out] _in Stream to read.
+  /// \param[out] _value Value read.
+  template<class T>
+  void ParamReadStream(std::istream &_in, T &_value)
+  {
+    if constexpr (std::is_same_v<T, std::vector<double>>)
+    {
+      _value.clear();
+      double number;
+      while (_in >> number)
+        _value.push_back(number);
+    }
+    else
+    {
+      _in >> _value;
+    }
+  }
+
   template<class... Ts>
   std::ostream& operator<<(std::ostream& os,
                            ParamStreamer<std::variant<Ts...>> sv)
@@ -193,6 +239,19 @@ namespace sdf
     /// \return True if the parameter has been set.
     public: bool GetSet() const;
 
+    /// \brief Get whether the value changed since the parameter was
+    /// created or ClearDirty was called. Setting a value equal to the
+    /// current one, as compared by its type, doesn't make the parameter
+    /// dirty. Changes also mark the element the parameter belongs to, and
+    /// its ancestors, as dirty. \sa Element::Dirty
+    /// \return True if the value changed.
+    public: bool Dirty() const;
+
+    /// \brief Mark the value as unchanged. This doesn't clear the dirty
+    /// flag of the element the parameter belongs to.
+    /// \sa Element::ClearDirty
+    public: void ClearDirty();
+
     /// \brief Clone the parameter.
     /// \return A new parameter that is the clone of this.
     public: ParamPtr Clone() const;
@@ -227,6 +286,25 @@ namespace sdf
     public: template<typename T>
             bool Get(T &_value) const;
 
+    /// \brief Get the numbers of a parameter of type "double_array", a
+    /// white space separated list of numbers of any length, parsed into a
+    /// contiguous buffer. Unlike Get<std::vector<double>>, the numbers are
+    /// not copied.
+    /// \return The numbers, which are valid until the value of the
+    /// parameter changes, or an empty span if the parameter is of another
+    /// type.
+    public: Span<const double> NumericArray() const;
+
+    /// \brief Call a function with the value of the parameter, as the type
+    /// that it holds, such as double or ignition::math::Pose3d. Unlike
+    /// GetAny, the value is neither copied nor boxed, which is cheaper for
+    /// tools that read every value of a document generically.
+    /// \param[in] _visitor Function, usually a generic lambda, that can be
+    /// called with a const reference to each type of parameter.
+    /// \return The result of _visitor.
+    public: template<typename F>
+            decltype(auto) Visit(F &&_visitor) const;
+
     /// \brief Get the default value of the parameter.
     /// \param[out] _value The default value of the parameter.
     /// \return True if parameter was successfully cast to the value type
@@ -257,6 +335,32 @@ namespace sdf
       return _out;
     }
 
+    /// \brief The binary snapshot reads and writes values natively.
+    private: friend class BinarySnapshot;
+
+    /// \brief Elements set themselves as the parent of their parameters.
+    private: friend class Element;
+
+    /// \brief Batches update values in place.
+    private: friend class ParamUpdateBatch;
+
+    /// \brief Set the element this parameter belongs to, which changes of
+    /// the value mark as dirty.
+    /// \param[in] _parent The element.
+    private: void SetParentElement(const std::weak_ptr<Element> &_parent);
+
+    /// \brief Mark the value, and the element it belongs to, as dirty.
+    private: void MarkDirty();
+
+    /// \brief Record that the value may have changed: the content hashes
+    /// cached by the parent element and its ancestors are dropped, and
+    /// NameChanged is called.
+    private: void ValueChanged() const;
+
+    /// \brief Drop the check of the names of the siblings of the element
+    /// of a name attribute, after its value may have changed.
+    private: void NameChanged() const;
+
     /// \brief Private method to set the Element from a passed-in string.
     /// \param[in] _value Value to set the parameter to.
     private: bool ValueFromString(const std::string &_value);
@@ -269,24 +373,6 @@ namespace sdf
   /// \brief Private data for the param class
   class ParamPrivate
   {
-    /// \brief Key value
-    public: std::string key;
-
-    /// \brief True if the parameter is required.
-    public: bool required;
-
-    /// \brief True if the parameter is set.
-    public: bool set;
-
-    //// \brief Name of the type.
-    public: std::string typeName;
-
-    /// \brief Description of the parameter.
-    public: std::string description;
-
-    /// \brief Update function pointer.
-    public: std::function<std::any ()> updateFunc;
-
     /// \def ParamVariant
     /// \brief Variant type def.
     public: typedef std::variant<bool, char, std::string, int, std::uint64_t,
@@ -297,26 +383,237 @@ namespace sdf
                                    ignition::math::Vector2d,
                                    ignition::math::Vector3d,
                                    ignition::math::Quaterniond,
-                                   ignition::math::Pose3d> ParamVariant;
+                                   ignition::math::Pose3d,
+                                   std::vector<double>> ParamVariant;
+
+    /// \brief Type of a parameter, resolved once from its type name. The
+    /// value of each type is the index of the matching alternative in
+    /// ParamVariant.
+    public: enum class ValueType : std::size_t
+    {
+      BOOL = 0,
+      CHAR,
+      STRING,
+      INT,
+      UINT64,
+      UNSIGNED_INT,
+      DOUBLE,
+      FLOAT,
+      TIME,
+      ANGLE,
+      COLOR,
+      VECTOR2I,
+      VECTOR2D,
+      VECTOR3D,
+      QUATERNION,
+      POSE,
+      DOUBLE_ARRAY,
+
+      /// \brief The type name is not supported.
+      UNKNOWN
+    };
+
+    /// \brief Parts of a parameter that are fixed by its SDFormat
+    /// description, i.e. the specification of the parameter. They are
+    /// immutable once the parameter is constructed, and shared without
+    /// copying by a parameter and its copies.
+    public: class DescriptionData
+    {
+      /// \brief Key value, interned in the process-wide table of
+      /// identifiers, so that params with the same key share one copy.
+      public: const std::string *key = nullptr;
+
+      /// \brief True if the parameter is required.
+      public: bool required;
+
+      //// \brief Name of the type, interned like key.
+      public: const std::string *typeName = nullptr;
+
+      /// \brief Type resolved from typeName.
+      public: ValueType type = ValueType::UNKNOWN;
+
+      /// \brief Description of the parameter.
+      public: std::string description;
+
+      /// \brief This parameter's default value
+      public: ParamVariant defaultValue;
+
+      /// \brief This parameter's minimum allowed value
+      public: std::optional<ParamVariant> minValue;
+
+      /// \brief This parameter's maximum allowed value
+      public: std::optional<ParamVariant> maxValue;
+    };
 
     /// \brief This parameter's value
     public: ParamVariant value;
 
-    /// \brief This parameter's default value
-    public: ParamVariant defaultValue;
+    /// \brief Key, type, description, default and limits of the parameter.
+    public: std::shared_ptr<const DescriptionData> descriptionData;
+
+    /// \brief Update function, which is only allocated for the few
+    /// parameters that have one.
+    public: std::unique_ptr<std::function<std::any ()>> updateFunc;
+
+    /// \brief True if the parameter is set.
+    public: bool set;
 
-    /// \brief This parameter's minimum allowed value
-    public: std::optional<ParamVariant> minValue;
+    /// \brief True if the value changed since ClearDirty.
+    public: bool dirty = false;
 
-    /// \brief This parameter's maximum allowed value
-    public: std::optional<ParamVariant> maxValue;
+    /// \brief Element this parameter belongs to.
+    public: std::weak_ptr<Element> parentElement;
   };
 
+  /// \internal
+  /// \brief Whether a ParamVariant alternative is a number that is
+  /// converted directly to the other numbers. char is not one, since it is
+  /// written and read as a character.
+  template<class T>
+  inline constexpr bool ParamIsNumber =
+      std::is_same_v<T, bool> || std::is_same_v<T, int> ||
+      std::is_same_v<T, std::uint64_t> || std::is_same_v<T, unsigned int> ||
+      std::is_same_v<T, double> || std::is_same_v<T, float>;
+
+  /// \internal
+  /// \brief Check whether a number is in the range of another number type.
+  /// \param[in] _from Number to check.
+  /// \return True if converting _from to To is defined and, for integers,
+  /// exact.
+  template<class To, class From>
+  constexpr bool ParamInRange(const From _from)
+  {
+    if constexpr (std::is_floating_point_v<From>)
+    {
+      if constexpr (std::is_integral_v<To>)
+      {
+        // The bounds are powers of two, which are exact in From.
+        const From upper = From(2) *
+            From(std::numeric_limits<To>::max() / 2 + 1);
+        const From lower = std::is_signed_v<To> ? -upper : From(0);
+        return _from >= lower && _from < upper;
+      }
+      else
+      {
+        return !(_from > std::numeric_limits<To>::max() ||
+                 _from < std::numeric_limits<To>::lowest());
+      }
+    }
+    else if constexpr (std::is_integral_v<To> && !std::is_same_v<From, bool>)
+    {
+      if constexpr (std::numeric_limits<From>::digits >
+                    std::numeric_limits<To>::digits)
+      {
+        if (_from > static_cast<From>(std::numeric_limits<To>::max()))
+          return false;
+        if constexpr (std::is_signed_v<From> && std::is_signed_v<To>)
+        {
+          if (_from < static_cast<From>(std::numeric_limits<To>::min()))
+            return false;
+        }
+      }
+      if constexpr (std::is_signed_v<From> && !std::is_signed_v<To>)
+      {
+        if (_from < 0)
+          return false;
+      }
+      return true;
+    }
+    else
+    {
+      return true;
+    }
+  }
+
+  /// \internal
+  /// \brief Convert a value between the numbers of ParamVariant, and
+  /// between numbers and ignition::math::Angle, which is written and read
+  /// as radians, without formatting it as text. The matrix of conversions
+  /// is resolved at compile time.
+  /// \param[in] _from Value to convert.
+  /// \param[out] _to Converted value.
+  /// \return False if there is no direct conversion between the types, or
+  /// the value is out of the range of To. The value is then converted
+  /// through a stream.
+  template<class To, class From>
+  bool ParamConvert(const From &_from, To &_to)
+  {
+    if constexpr (std::is_same_v<From, ignition::math::Angle>)
+    {
+      if constexpr (ParamIsNumber<To> && !std::is_same_v<To, bool>)
+        return ParamConvert(_from.Radian(), _to);
+      else
+        return false;
+    }
+    else if constexpr (!ParamIsNumber<From>)
+    {
+      return false;
+    }
+    else if constexpr (std::is_same_v<To, ignition::math::Angle>)
+    {
+      if constexpr (std::is_same_v<From, bool>)
+      {
+        return false;
+      }
+      else
+      {
+        _to = ignition::math::Angle(static_cast<double>(_from));
+        return true;
+      }
+    }
+    else if constexpr (!ParamIsNumber<To>)
+    {
+      return false;
+    }
+    else if constexpr (std::is_same_v<To, bool>)
+    {
+      _to = _from != From(0);
+      return true;
+    }
+    else
+    {
+      if (!ParamInRange<To>(_from))
+        return false;
+      _to = static_cast<To>(_from);
+      return true;
+    }
+  }
+
+  /// \internal
+  /// \brief Read a ParamVariant as another type without a stream, when it
+  /// holds that type, or when ParamConvert converts between the types.
+  /// \param[in] _value Value to read.
+  /// \param[out] _to Value read.
+  /// \return False if the value must be converted through a stream.
+  template<class T>
+  bool ParamGetDirect(const ParamPrivate::ParamVariant &_value, T &_to)
+  {
+    if (const T *value = std::get_if<T>(&_value))
+    {
+      _to = *value;
+      return true;
+    }
+
+    if constexpr (ParamIsNumber<T> ||
+                  std::is_same_v<T, ignition::math::Angle>)
+    {
+      return std::visit([&_to](const auto &_from)
+          {
+            return ParamConvert(_from, _to);
+          }, _value);
+    }
+    else
+    {
+      return false;
+    }
+  }
+
   ///////////////////////////////////////////////
   template<typename T>
   void Param::SetUpdateFunc(T _updateFunc)
   {
-    this->dataPtr->updateFunc = _updateFunc;
+    this->dataPtr->updateFunc =
+        std::make_unique<std::function<std::any ()>>(_updateFunc);
   }
 
   ///////////////////////////////////////////////
@@ -326,13 +623,16 @@ namespace sdf
     try
     {
       std::stringstream ss;
-      ss << _value;
+      if constexpr (std::is_same_v<T, std::vector<double>>)
+        ss << ParamStreamer{_value};
+      else
+        ss << _value;
       return this->SetFromString(ss.str());
     }
     catch(...)
     {
       sdferr << "Unable to set parameter["
-             << this->dataPtr->key << "]."
+             << *this->dataPtr->descriptionData->key << "]."
              << "Type used must have a stream input and output operator,"
              << "which allows proper functioning of Param.\n";
       return false;
@@ -343,9 +643,10 @@ namespace sdf
   template<typename T>
   bool Param::Get(T &_value) const
   {
-    try
+    if constexpr (std::is_same_v<T, bool>)
     {
-      if (typeid(T) == typeid(bool) && this->dataPtr->typeName == "string")
+      if (this->dataPtr->descriptionData->type ==
+          ParamPrivate::ValueType::STRING)
       {
         std::string strValue = std::get<std::string>(this->dataPtr->value);
         std::transform(strValue.begin(), strValue.end(), strValue.begin(),
@@ -354,36 +655,26 @@ namespace sdf
               return static_cast<unsigned char>(std::tolower(c));
             });
 
-        std::stringstream tmp;
-        if (strValue == "true" || strValue  == "1")
-        {
-          tmp << "1";
-        }
-        else
-        {
-          tmp << "0";
-        }
-        tmp >> _value;
-      }
-      else
-      {
-        T *value = std::get_if<T>(&this->dataPtr->value);
-        if (value)
-          _value = *value;
-        else
-        {
-          std::stringstream ss;
-          ss << ParamStreamer{this->dataPtr->value};
-          ss >> _value;
-        }
+        _value = strValue == "true" || strValue == "1";
+        return true;
       }
     }
+
+    if (ParamGetDirect(this->dataPtr->value, _value))
+      return true;
+
+    try
+    {
+      std::stringstream ss;
+      ss << ParamStreamer{this->dataPtr->value};
+      ParamReadStream(ss, _value);
+    }
     catch(...)
     {
       sdferr << "Unable to convert parameter["
-             << this->dataPtr->key << "] "
+             << *this->dataPtr->descriptionData->key << "] "
              << "whose type is["
-             << this->dataPtr->typeName << "], to "
+             << *this->dataPtr->descriptionData->typeName << "], to "
              << "type[" << typeid(T).name() << "]\n";
       return false;
     }
@@ -394,19 +685,22 @@ namespace sdf
   template<typename T>
   bool Param::GetDefault(T &_value) const
   {
+    if (ParamGetDirect(this->dataPtr->descriptionData->defaultValue, _value))
+      return true;
+
     std::stringstream ss;
 
     try
     {
-      ss << ParamStreamer{this->dataPtr->defaultValue};
-      ss >> _value;
+      ss << ParamStreamer{this->dataPtr->descriptionData->defaultValue};
+      ParamReadStream(ss, _value);
     }
     catch(...)
     {
       sdferr << "Unable to convert parameter["
-             << this->dataPtr->key << "] "
+             << *this->dataPtr->descriptionData->key << "] "
              << "whose type is["
-             << this->dataPtr->typeName << "], to "
+             << *this->dataPtr->descriptionData->typeName << "], to "
              << "type[" << typeid(T).name() << "]\n";
       return false;
     }
@@ -414,6 +708,13 @@ namespace sdf
     return true;
   }
 
+  ///////////////////////////////////////////////
+  template<typename F>
+  decltype(auto) Param::Visit(F &&_visitor) const
+  {
+    return std::visit(std::forward<F>(_visitor), this->dataPtr->value);
+  }
+
   ///////////////////////////////////////////////
   template<typename Type>
   bool Param::IsType() const
@@ -0,0 +1,141 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_PARAM_UPDATE_BATCH_HH_
+#define SDF_PARAM_UPDATE_BATCH_HH_
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <variant>
+
+#include "sdf/Param.hh"
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  // Forward declarations.
+  class ParamUpdateBatchPrivate;
+
+  /// \brief A set of parameters bound to live data, updated together.
+  ///
+  /// Element::Update visits every parameter of a tree and calls the update
+  /// function of each one that has it, boxing the new value in a std::any.
+  /// A batch only visits the parameters bound to it, and its update
+  /// callbacks write the value in place with its own type, so they can
+  /// leave it untouched when the data didn't change. Parameters whose
+  /// value changed are marked as dirty, see Param::Dirty, so that
+  /// Element::DirtyToStream writes only those.
+  class SDFORMAT_VISIBLE ParamUpdateBatch
+  {
+    /// \brief Default constructor, for a batch without bindings.
+    public: ParamUpdateBatch();
+
+    /// \brief Copy constructor
+    /// \param[in] _batch ParamUpdateBatch to copy.
+    public: ParamUpdateBatch(const ParamUpdateBatch &_batch);
+
+    /// \brief Move constructor
+    /// \param[in] _batch ParamUpdateBatch to move.
+    public: ParamUpdateBatch(ParamUpdateBatch &&_batch) noexcept;
+
+    /// \brief Move assignment operator.
+    /// \param[in] _batch ParamUpdateBatch to move.
+    /// \return Reference to this.
+    public: ParamUpdateBatch &operator=(ParamUpdateBatch &&_batch) noexcept;
+
+    /// \brief Copy assignment operator.
+    /// \param[in] _batch ParamUpdateBatch to copy.
+    /// \return Reference to this.
+    public: ParamUpdateBatch &operator=(const ParamUpdateBatch &_batch);
+
+    /// \brief Destructor
+    public: ~ParamUpdateBatch();
+
+    /// \brief Bind a parameter to a callback that updates its value. A
+    /// parameter that is already bound gets the new callback.
+    /// \param[in] _param The parameter. The batch keeps it alive.
+    /// \param[in] _update Callback called by Update with a reference to the
+    /// value. It returns true if it changed the value, and false if it left
+    /// it as it was. Values are not checked against the minimum and
+    /// maximum of the parameter.
+    /// \tparam T Type of the value, which must be the type the parameter
+    /// holds, such as double for a double parameter or
+    /// ignition::math::Pose3d for a pose.
+    /// \return False if _param or _update is empty, or the parameter
+    /// doesn't hold a T.
+    public: template<typename T>
+            bool Bind(const ParamPtr &_param,
+                      std::function<bool(T &_value)> _update);
+
+    /// \brief Remove the binding of a parameter.
+    /// \param[in] _param The parameter.
+    /// \return True if the parameter was bound.
+    public: bool Unbind(const ParamPtr &_param);
+
+    /// \brief Remove all bindings.
+    public: void Clear();
+
+    /// \brief Get the number of bound parameters.
+    /// \return Number of bindings.
+    public: std::size_t BindingCount() const;
+
+    /// \brief Call the callbacks of all bound parameters. The parameters
+    /// that changed are marked as set and dirty once all callbacks have
+    /// returned, on the calling thread.
+    /// \param[in] _threadCount Maximum number of threads to call the
+    /// callbacks on, as for ParserConfig::SetLoadThreadCount. With more
+    /// than one thread, the callbacks must be safe to call concurrently.
+    /// \return Number of parameters whose value changed.
+    public: std::size_t Update(unsigned int _threadCount = 1);
+
+    /// \brief Add a binding.
+    /// \param[in] _param The parameter.
+    /// \param[in] _apply Function that updates the value of the parameter
+    /// and returns true if it changed.
+    private: void AddBinding(const ParamPtr &_param,
+                             std::function<bool(ParamPrivate &)> _apply);
+
+    /// \brief Private data pointer.
+    private: ParamUpdateBatchPrivate *dataPtr = nullptr;
+  };
+
+  ///////////////////////////////////////////////
+  template<typename T>
+  bool ParamUpdateBatch::Bind(const ParamPtr &_param,
+                              std::function<bool(T &_value)> _update)
+  {
+    if (!_param || !_update ||
+        !std::holds_alternative<T>(_param->dataPtr->value))
+    {
+      return false;
+    }
+
+    this->AddBinding(_param,
+        [update = std::move(_update)](ParamPrivate &_data)
+        {
+          return update(std::get<T>(_data.value));
+        });
+    return true;
+  }
+  }
+}
+#endif
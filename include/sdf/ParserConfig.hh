@@ -0,0 +1,682 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_PARSER_CONFIG_HH_
+#define SDF_PARSER_CONFIG_HH_
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <ignition/math/AxisAlignedBox.hh>
+#include <ignition/math/Pose3.hh>
+
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  // Forward declare private data class.
+  class ParserConfigPrivate;
+  class CancellationToken;
+  class DiagnosticSink;
+  class Executor;
+  class FindFileSettings;
+  class LoadObserver;
+  class LoadStats;
+  class VirtualFilesystem;
+
+  /// \brief This class contains configuration options that control how
+  /// SDF documents are loaded into the DOM, e.g. by Root::Load.
+  ///
+  /// The default configuration reproduces the behavior of the overloads
+  /// that do not take a ParserConfig.
+  class SDFORMAT_VISIBLE ParserConfig
+  {
+    /// \brief Default constructor
+    public: ParserConfig();
+
+    /// \brief Copy constructor
+    /// \param[in] _config ParserConfig to copy.
+    public: ParserConfig(const ParserConfig &_config);
+
+    /// \brief Move constructor
+    /// \param[in] _config ParserConfig to move.
+    public: ParserConfig(ParserConfig &&_config) noexcept;
+
+    /// \brief Move assignment operator.
+    /// \param[in] _config ParserConfig to move.
+    /// \return Reference to this.
+    public: ParserConfig &operator=(ParserConfig &&_config) noexcept;
+
+    /// \brief Copy assignment operator.
+    /// \param[in] _config ParserConfig to copy.
+    /// \return Reference to this.
+    public: ParserConfig &operator=(const ParserConfig &_config);
+
+    /// \brief Destructor
+    public: ~ParserConfig();
+
+    /// \brief Set the number of threads used to load sibling DOM objects,
+    /// such as the models, lights and actors of a world, and to resolve and
+    /// read sibling <include> elements. A value of 1,
+    /// which is the default, loads everything on the calling thread. A
+    /// value of 0 uses the number of hardware threads reported by the
+    /// system.
+    ///
+    /// Errors are always reported in document order, regardless of the
+    /// number of threads. Console output produced while loading may be
+    /// interleaved when more than one thread is used.
+    /// \param[in] _count Number of load threads.
+    /// \sa unsigned int LoadThreadCount() const
+    public: void SetLoadThreadCount(unsigned int _count);
+
+    /// \brief Get the number of threads used to load sibling DOM objects.
+    /// \return The number of load threads, where 0 means one thread per
+    /// hardware thread.
+    /// \sa void SetLoadThreadCount(unsigned int _count)
+    public: unsigned int LoadThreadCount() const;
+
+    /// \brief Set the executor that runs the parallel work of the loads
+    /// that use this configuration: the includes, DOM objects and frame
+    /// graphs handled by the LoadThreadCount threads, and the models of
+    /// pipelined loads. Loads started from tasks of the executor, such as
+    /// the includes of included models, share its threads. The number of
+    /// threads of a parallel step is the smaller of LoadThreadCount, or the
+    /// concurrency of the executor when it is 0, and the number of sibling
+    /// objects, and the calling thread is always one of them.
+    /// \param[in] _executor The executor, or nullptr to use
+    /// Executor::Default, which is the default.
+    /// \sa std::shared_ptr<Executor> LoadExecutor() const
+    public: void SetLoadExecutor(std::shared_ptr<Executor> _executor);
+
+    /// \brief Get the executor set with SetLoadExecutor.
+    /// \return The executor, or nullptr if the default one is used.
+    /// \sa void SetLoadExecutor(std::shared_ptr<Executor> _executor)
+    public: std::shared_ptr<Executor> LoadExecutor() const;
+
+    /// \brief Set the object that collects per-phase timing and counts while
+    /// loading with this configuration. The object is not owned by the
+    /// ParserConfig and has to outlive every load that uses it. Collection
+    /// is disabled by default, and costs almost nothing while disabled.
+    /// \param[in] _stats Statistics to update, or nullptr to disable
+    /// collection.
+    /// \sa LoadStats *Stats() const
+    public: void SetStats(LoadStats *_stats);
+
+    /// \brief Get the object that collects load statistics.
+    /// \return The statistics, or nullptr if collection is disabled.
+    /// \sa void SetStats(LoadStats *_stats)
+    public: LoadStats *Stats() const;
+
+    /// \brief Set the object that Root::Load gives the top level models,
+    /// lights and actors to as soon as each is loaded with the frame graphs
+    /// of its scope, so that they can be used while the rest of the
+    /// document loads. The object is not owned by the ParserConfig and has
+    /// to outlive every load that uses it. No observer is set by default.
+    /// \param[in] _observer Observer to notify, or nullptr for none.
+    /// \sa LoadObserver *Observer() const
+    public: void SetObserver(LoadObserver *_observer);
+
+    /// \brief Get the object that Root::Load notifies of loaded entities.
+    /// \return The observer, or nullptr if there is none.
+    /// \sa void SetObserver(LoadObserver *_observer)
+    public: LoadObserver *Observer() const;
+
+    /// \brief Set the sink that receives the messages written while loading
+    /// with this configuration, such as the warnings of readXml, of the
+    /// conversion of older versions and of URDF files, instead of the
+    /// Console. Identical deprecation warnings are written once per load,
+    /// with or without a sink. The sink is not owned by the ParserConfig and
+    /// has to outlive every load that uses it. No sink is set by default.
+    /// \param[in] _sink Sink of the messages, or nullptr to write them to
+    /// the Console.
+    /// \sa DiagnosticSink *Diagnostics() const
+    public: void SetDiagnostics(DiagnosticSink *_sink);
+
+    /// \brief Get the sink of the messages of the loads.
+    /// \return The sink, or nullptr if messages go to the Console.
+    /// \sa void SetDiagnostics(DiagnosticSink *_sink)
+    public: DiagnosticSink *Diagnostics() const;
+
+    /// \brief Set the token that cancels the loads that use this
+    /// configuration. Once it is cancelled, the loads stop reading elements,
+    /// resolving <include> elements, converting documents and building
+    /// frame graphs, and return the errors they found so far followed by an
+    /// ErrorCode::LOAD_CANCELLED error, with the documents and DOM objects
+    /// they loaded so far. The token is not owned by the ParserConfig and
+    /// has to outlive every load that uses it. No token is set by default.
+    /// \param[in] _token Token to check, or nullptr for none.
+    /// \sa CancellationToken *Cancellation() const
+    public: void SetCancellation(CancellationToken *_token);
+
+    /// \brief Get the token that cancels the loads.
+    /// \return The token, or nullptr if there is none.
+    /// \sa void SetCancellation(CancellationToken *_token)
+    public: CancellationToken *Cancellation() const;
+
+    /// \brief Set the time by which the loads that use this configuration
+    /// have to finish. The loads check it where they check the token set
+    /// with SetCancellation, and the loads that are still running at the
+    /// deadline stop like cancelled loads, with an
+    /// ErrorCode::LOAD_DEADLINE_EXCEEDED error. There is no deadline by
+    /// default, which is std::chrono::steady_clock::time_point::max().
+    /// \param[in] _deadline Time by which the loads have to finish.
+    /// \sa std::chrono::steady_clock::time_point Deadline() const
+    public: void SetDeadline(std::chrono::steady_clock::time_point _deadline);
+
+    /// \brief Get the time by which the loads have to finish.
+    /// \return The deadline, or std::chrono::steady_clock::time_point::max()
+    /// if there is none.
+    /// \sa void SetDeadline(std::chrono::steady_clock::time_point _deadline)
+    public: std::chrono::steady_clock::time_point Deadline() const;
+
+    /// \brief Set whether the Element and Param objects of a loaded
+    /// document are allocated from a monotonic arena that belongs to the
+    /// document, instead of individually from the heap. The arena is
+    /// released in one step once the last object of the document is
+    /// destroyed, which makes loading and destroying large documents
+    /// cheaper. Memory of elements that are removed from the document is
+    /// only reclaimed with the rest of the arena. Disabled by default.
+    /// \param[in] _use True to allocate documents from an arena.
+    /// \sa bool UseElementArena() const
+    public: void SetUseElementArena(bool _use);
+
+    /// \brief Get whether loaded documents are allocated from an arena.
+    /// \return True if documents are allocated from an arena.
+    /// \sa void SetUseElementArena(bool _use)
+    public: bool UseElementArena() const;
+
+    /// \brief Set a memory resource that the arenas of loaded documents
+    /// take their memory from, such as a buffer provided by the caller.
+    /// Loads with a memory resource allocate their Element and Param
+    /// objects from an arena whether or not UseElementArena is enabled,
+    /// and the arena itself is allocated from the resource too. The
+    /// resource is only used by one arena at a time, but it can be called
+    /// from the thread that releases the last element of a document, and
+    /// it must outlive every element loaded with it. Strings and other
+    /// containers inside the elements, the DOM objects, and the spec
+    /// descriptions and included files cached across loads still use the
+    /// heap. By default there is no memory resource.
+    /// \param[in] _resource The memory resource, or nullptr to take arena
+    /// memory from the heap.
+    /// \sa std::pmr::memory_resource *MemoryResource() const
+    public: void SetMemoryResource(std::pmr::memory_resource *_resource);
+
+    /// \brief Get the memory resource of the arenas of loaded documents.
+    /// \return The memory resource, or nullptr if there is none.
+    /// \sa void SetMemoryResource(std::pmr::memory_resource *_resource)
+    public: std::pmr::memory_resource *MemoryResource() const;
+
+    /// \brief Set whether the elements of loaded documents are destroyed on
+    /// a background thread. When the last reference to such an element is
+    /// dropped, its children are handed to a reclaimer thread, so that
+    /// releasing a large tree, e.g. by destroying its Root, returns at once.
+    /// Elements created by Element::Clone of these elements are released in
+    /// the background as well. Element::WaitForBackgroundRelease waits for
+    /// the reclaimer. Disabled by default.
+    /// \param[in] _background True to release elements in the background.
+    /// \sa bool ReleaseElementsInBackground() const
+    public: void SetReleaseElementsInBackground(bool _background);
+
+    /// \brief Get whether the elements of loaded documents are destroyed
+    /// on a background thread.
+    /// \return True if elements are released in the background.
+    /// \sa void SetReleaseElementsInBackground(bool _background)
+    public: bool ReleaseElementsInBackground() const;
+
+    /// \brief Set whether the Root load functions load the DOM of the
+    /// models of the worlds while the rest of the document and its includes
+    /// are still read. Each model of a world is handed to a worker task of the
+    /// LoadExecutor once its element is read, and the parser loads the
+    /// oldest queued model itself when LoadThreadCount workers, or at least
+    /// one, have twice as many models queued. The result is the
+    /// same as without pipelining. Models are not pipelined when included
+    /// models are shared or the load cache is used. Disabled by default.
+    /// \param[in] _pipelined True to pipeline loads.
+    /// \sa bool PipelinedLoad() const
+    public: void SetPipelinedLoad(bool _pipelined);
+
+    /// \brief Get whether Root loads models while the document is read.
+    /// \return True if loads are pipelined.
+    /// \sa void SetPipelinedLoad(bool _pipelined)
+    public: bool PipelinedLoad() const;
+
+    /// \brief Set the directory of the on-disk load cache. When set,
+    /// reading a file stores the converted and include-expanded document
+    /// in this directory, and later reads of the same file reuse it
+    /// instead of parsing the file again. An entry is only reused while
+    /// the library version, the SDFormat version and the content of the
+    /// file and of every file it includes are unchanged. The directory is
+    /// created if needed, and may be shared by several processes. When
+    /// empty, which is the default, the SDF_LOAD_CACHE_PATH environment
+    /// variable is used instead, and the cache is disabled if it is not
+    /// set either.
+    ///
+    /// Entries do not record how the uris of <include> elements were
+    /// resolved, so the cache must not be shared between environments
+    /// where the same uri resolves to different files.
+    /// \param[in] _path Cache directory, or an empty string.
+    /// \sa const std::string &LoadCachePath() const
+    public: void SetLoadCachePath(const std::string &_path);
+
+    /// \brief Get the directory of the on-disk load cache.
+    /// \return The cache directory, or an empty string if it is not set.
+    /// \sa void SetLoadCachePath(const std::string &_path)
+    public: const std::string &LoadCachePath() const;
+
+    /// \brief Set the names of elements whose child elements are only read
+    /// when they are first accessed, such as "plugin" or "sensor". The
+    /// attributes and value of these elements are read with the rest of the
+    /// document, but their children are kept as XML text until a function
+    /// of the element that accesses them is called, e.g. GetElement,
+    /// GetFirstElement or ToString. This makes loading cheaper for
+    /// consumers that never look at these subtrees. Errors in a deferred
+    /// subtree are printed when it is read instead of being returned by the
+    /// load, and elements that contain an <include> are always read. No
+    /// element is deferred by default.
+    ///
+    /// Reading deferred children modifies the element, so a document must
+    /// not be accessed from several threads at once while it has deferred
+    /// children.
+    /// \param[in] _names Element names.
+    /// \sa const std::set<std::string> &LazyElements() const
+    public: void SetLazyElements(const std::set<std::string> &_names);
+
+    /// \brief Get the names of elements whose children are read lazily.
+    /// \return The element names.
+    /// \sa void SetLazyElements(const std::set<std::string> &_names)
+    public: const std::set<std::string> &LazyElements() const;
+
+    /// \brief Set whether the children of elements that copy their children,
+    /// such as <plugin>, are only read when they are first accessed. Their
+    /// subtrees are then kept as a single XML text, like the children of
+    /// the elements set with SetLazyElements, instead of an sdf::Element per
+    /// node, which makes plugins with large configurations cheaper to load.
+    /// Disabled by default.
+    /// \param[in] _lazy True to read the copied children lazily.
+    /// \sa bool LazyCopyChildren() const
+    public: void SetLazyCopyChildren(bool _lazy);
+
+    /// \brief Get whether the children of elements that copy their children
+    /// are read lazily.
+    /// \return True if the copied children are read lazily.
+    /// \sa void SetLazyCopyChildren(bool _lazy)
+    public: bool LazyCopyChildren() const;
+
+    /// \brief Set whether the models of a world that are included from the
+    /// same file share their links, joints, frames and nested models, when
+    /// their elements only differ by the name, pose and static flag of the
+    /// model, or by other elements of the model itself such as plugins.
+    /// Each included model is then still an sdf::Model with its own name and
+    /// pose, but loading N identical includes loads their contents once.
+    /// Disabled by default.
+    /// \param[in] _share True to share the contents of included models.
+    /// \sa bool ShareIncludedModels() const
+    public: void SetShareIncludedModels(bool _share);
+
+    /// \brief Get whether identical included models share their contents.
+    /// \return True if the contents of included models are shared.
+    /// \sa void SetShareIncludedModels(bool _share)
+    public: bool ShareIncludedModels() const;
+
+    /// \brief Set whether the visuals of the models of a world share equal
+    /// materials, with their PBR workflows, through a material table of the
+    /// world. Each distinct material is then stored once, and is available
+    /// with World::MaterialByIndex at the index given by
+    /// Visual::MaterialIndex, so that a renderer can create one material per
+    /// entry. Disabled by default.
+    /// \param[in] _share True to share the materials of the visuals.
+    /// \sa bool ShareMaterials() const
+    public: void SetShareMaterials(bool _share);
+
+    /// \brief Get whether the visuals of a world share equal materials.
+    /// \return True if the materials of the visuals are shared.
+    /// \sa void SetShareMaterials(bool _share)
+    public: bool ShareMaterials() const;
+
+    /// \brief Set whether the geometries of a Root share equal meshes
+    /// through a mesh registry of the Root. Meshes are equal when they have
+    /// the same URI, file path, scale, submesh and submesh centering, such
+    /// as the meshes of the visual and collision of a link, or of the
+    /// models included from the same file. Each distinct mesh is then
+    /// stored once, and is available with Root::MeshByIndex, with the
+    /// number of geometries that share it. Disabled by default.
+    /// \param[in] _share True to share the meshes of the geometries.
+    /// \sa bool ShareMeshes() const
+    public: void SetShareMeshes(bool _share);
+
+    /// \brief Get whether the geometries of a Root share equal meshes.
+    /// \return True if the meshes of the geometries are shared.
+    /// \sa void SetShareMeshes(bool _share)
+    public: bool ShareMeshes() const;
+
+    /// \brief Set whether Root records the models included in its worlds,
+    /// so that Root::ReloadIncludes can read them again when their files
+    /// change. Recording keeps the XML of each <include>, and files loaded
+    /// with it are parsed even if they are in the load cache. It has no
+    /// effect when ShareIncludedModels is enabled. Disabled by default.
+    /// \param[in] _track True to record included models.
+    /// \sa bool TrackIncludes() const
+    public: void SetTrackIncludes(bool _track);
+
+    /// \brief Get whether Root records the models included in its worlds.
+    /// \return True if included models are recorded.
+    /// \sa void SetTrackIncludes(bool _track)
+    public: bool TrackIncludes() const;
+
+    /// \brief Set the maximum number of errors of a load. Once a load has
+    /// that many errors, reading the XML and loading the DOM stop at the
+    /// next element instead of traversing the rest of the document, and
+    /// the errors returned are truncated to the maximum. A value of 1 fails
+    /// on the first error. The default of 0 sets no limit.
+    /// \param[in] _count Maximum number of errors, or 0 for no limit.
+    /// \sa std::size_t MaxErrors() const
+    public: void SetMaxErrors(std::size_t _count);
+
+    /// \brief Get the maximum number of errors of a load.
+    /// \return Maximum number of errors, or 0 for no limit.
+    /// \sa void SetMaxErrors(std::size_t _count)
+    public: std::size_t MaxErrors() const;
+
+    /// \brief Set whether documents are read with a streaming XML
+    /// tokenizer, which creates the sdf::Element tree directly instead of
+    /// first building a tinyxml2 DOM of the whole document. This roughly
+    /// halves the peak memory of reading large files. Only the subtrees
+    /// that are handled as XML, such as <include> elements, elements that
+    /// copy their children or are read lazily, and elements that are not
+    /// in the specification, are built as tinyxml2 nodes one at a time.
+    /// Documents that are not SDFormat, or that must be converted from an
+    /// older version, are read through the DOM as usual. Included files
+    /// are read one after the other, even with several load threads.
+    /// Disabled by default.
+    /// \param[in] _streaming True to read documents without a DOM.
+    /// \sa bool StreamingRead() const
+    public: void SetStreamingRead(bool _streaming);
+
+    /// \brief Get whether documents are read with a streaming XML
+    /// tokenizer.
+    /// \return True if documents are read without a DOM.
+    /// \sa void SetStreamingRead(bool _streaming)
+    public: bool StreamingRead() const;
+
+    /// \brief Set whether Root::Load releases the sdf::Element tree once
+    /// the DOM objects and their frame graphs are built, so that only the
+    /// DOM stays in memory. The Element function of the root and of every
+    /// DOM object loaded by it then returns nullptr, including that of the
+    /// template model of populations. The tree itself is freed unless the
+    /// caller holds the SDF object that was loaded, as Root::Load(SDFPtr)
+    /// does. Functions that build frame graphs from DOM objects, such as
+    /// buildFrameAttachedToGraph, fail on the released objects and on the
+    /// models returned by Population::InstanceModel. Disabled by default.
+    /// \param[in] _release True to release the element tree after load.
+    /// \sa bool ReleaseElements() const
+    public: void SetReleaseElements(bool _release);
+
+    /// \brief Get whether Root::Load releases the sdf::Element tree.
+    /// \return True if the element tree is released after load.
+    /// \sa void SetReleaseElements(bool _release)
+    public: bool ReleaseElements() const;
+
+    /// \brief Set whether loaded documents are trusted to be valid, for
+    /// instance because they passed `ign sdf --check` when they were
+    /// produced. Trusted loads skip the passes that only validate the
+    /// document: the checks of required attributes and of reserved frame
+    /// references while reading, the unique name and reserved name checks
+    /// of models and worlds, and the validation of their frame graphs,
+    /// which are still built. Required elements with a default are still
+    /// added. Invalid documents then load without errors into DOM objects
+    /// with unspecified behavior, so this should only be enabled for inputs
+    /// whose content is known to be checked, e.g. by comparing a hash of
+    /// the files to one recorded by the tool that checked them. Disabled
+    /// by default.
+    /// \param[in] _trusted True to skip the validation of loaded documents.
+    /// \sa bool TrustedInput() const
+    public: void SetTrustedInput(bool _trusted);
+
+    /// \brief Get whether loaded documents are trusted to be valid.
+    /// \return True if the validation of loaded documents is skipped.
+    /// \sa void SetTrustedInput(bool _trusted)
+    public: bool TrustedInput() const;
+
+    /// \brief Set whether the models of worlds, and the models at the root
+    /// of a document, load their links, joints, frames and nested models
+    /// the first time they are accessed rather than with the document.
+    /// Root::Load then only reads the properties of these models, such as
+    /// their name, pose, static flag and canonical link name, which is
+    /// enough for tools that list the models of a world. Each model loads
+    /// its contents at most once, even when several threads access it.
+    ///
+    /// The frame graphs of a world, or of a model at the root of the
+    /// document, are built after the contents of one of its models are
+    /// first accessed, since they need the contents of all its models, or
+    /// when World::ResolvePoses, World::PoseSnapshot or World::ApplyState
+    /// is called. The errors of the deferred loads are returned by
+    /// Model::LoadContents instead of Root::Load. The elements of lazy
+    /// models are kept, whatever ReleaseElements is, their contents don't
+    /// share materials or meshes, and ShareIncludedModels doesn't apply to
+    /// them. Disabled by default.
+    /// \param[in] _lazy True to load the contents of models lazily.
+    /// \sa bool LazyModels() const
+    public: void SetLazyModels(bool _lazy);
+
+    /// \brief Get whether the contents of models are loaded lazily.
+    /// \return True if the contents of models are loaded on first access.
+    /// \sa void SetLazyModels(bool _lazy)
+    public: bool LazyModels() const;
+
+    /// \brief Set whether the elements of documents read from a string
+    /// record the range of the text they were read from, which
+    /// Element::SourceRange returns, e.g. for an editor to point at the
+    /// text of an element, and that Root::Reparse needs. Strings are then
+    /// read through a tinyxml2 document even when StreamingRead is enabled.
+    /// Ranges are only recorded for documents at the latest version, since
+    /// the elements of converted documents don't match their text, and not
+    /// for the contents of included files. Disabled by default.
+    /// \param[in] _record True to record the source ranges.
+    /// \sa bool RecordSourceRanges() const
+    public: void SetRecordSourceRanges(bool _record);
+
+    /// \brief Get whether elements record the range of their text.
+    /// \return True if source ranges are recorded.
+    /// \sa void SetRecordSourceRanges(bool _record)
+    public: bool RecordSourceRanges() const;
+
+    /// \brief Set whether a large document is parsed by several threads,
+    /// up to LoadThreadCount. The document is first scanned for the
+    /// <model>, <include> and <light> children of its worlds, which are
+    /// parsed concurrently in runs of consecutive elements, while the rest
+    /// of the document is parsed on its own. The element tree is read from
+    /// the parts in document order, so that it and the errors of the load
+    /// are the same as with a single parse. Documents that are small, have
+    /// an XML error, must be converted from an older version, record their
+    /// source ranges or read their worlds lazily are parsed as a whole.
+    /// StreamingRead takes precedence for the documents it reads.
+    /// Disabled by default.
+    /// \param[in] _chunked True to parse large documents in parts.
+    /// \sa bool ChunkedXmlParse() const
+    public: void SetChunkedXmlParse(bool _chunked);
+
+    /// \brief Get whether large documents are parsed by several threads.
+    /// \return True if large documents are parsed in parts.
+    /// \sa void SetChunkedXmlParse(bool _chunked)
+    public: bool ChunkedXmlParse() const;
+
+    /// \brief Set the names of elements that are left out of loaded
+    /// documents, such as "visual", "sensor", "actor", "light", "plugin",
+    /// "gui" or "scene". Skipped elements are neither read into the
+    /// sdf::Element tree, nor added as defaults when they are required, so
+    /// the DOM objects they would be loaded into are not created either, and
+    /// e.g. Link::VisualCount returns 0. No element is skipped by default.
+    ///
+    /// Skipped elements are not validated, so errors in them are not
+    /// reported. Skipping elements that frames or poses may refer to, such
+    /// as "link", "joint", "frame" or "model", makes the references to them
+    /// fail frame graph validation. Documents written from a document with
+    /// skipped elements lack these elements.
+    /// \param[in] _names Element names.
+    /// \sa const std::set<std::string> &SkippedElements() const
+    public: void SetSkippedElements(const std::set<std::string> &_names);
+
+    /// \brief Get the names of elements that are left out of loaded
+    /// documents.
+    /// \return The element names.
+    /// \sa void SetSkippedElements(const std::set<std::string> &_names)
+    public: const std::set<std::string> &SkippedElements() const;
+
+    /// \brief Function that tells whether a top level model of a world is
+    /// in the region that is loaded, from the name of the model and its pose
+    /// relative to the world frame.
+    public: using RegionFilterCallback = std::function<bool(
+                const std::string &, const ignition::math::Pose3d &)>;
+
+    /// \brief Set a filter of the top level models of the worlds that are
+    /// loaded, so that a shard of a large world only reads the models in its
+    /// region. The filter is called for each <model> and <include> child of
+    /// a <world> element before its subtree is read, with the name of the
+    /// model and the pose of its <pose> element, and the models for which it
+    /// returns false are neither read, nor validated, nor loaded. The name
+    /// of an <include> is that of its <name> element, or an empty string if
+    /// it has none. Models whose pose is relative to a frame other than the
+    /// world frame are always loaded, since their pose is only known once
+    /// the frame graphs are built.
+    ///
+    /// Root::Load reports the top level frames, models, lights and actors
+    /// of a world that refer to a model outside the region with a
+    /// POSE_RELATIVE_TO_INVALID or FRAME_ATTACHED_TO_INVALID error naming
+    /// that model, besides the frame graph errors of the missing name.
+    /// Loads with a filter don't use the load cache. No model is left out
+    /// by default.
+    /// \param[in] _filter The filter, or nullptr to load every model.
+    /// \sa const RegionFilterCallback &RegionFilter() const
+    public: void SetRegionFilter(RegionFilterCallback _filter);
+
+    /// \brief Set the filter of the top level models of the worlds that
+    /// are loaded to a box, so that only the models whose origin is in the
+    /// box are loaded.
+    /// \param[in] _region Box relative to the world frame.
+    /// \sa void SetRegionFilter(RegionFilterCallback _filter)
+    public: void SetRegionFilter(const ignition::math::AxisAlignedBox &_region);
+
+    /// \brief Get the filter of the top level models of the worlds that are
+    /// loaded.
+    /// \return The filter, or nullptr if every model is loaded.
+    /// \sa void SetRegionFilter(RegionFilterCallback _filter)
+    public: const RegionFilterCallback &RegionFilter() const;
+
+    /// \brief Set the filesystem that the loads that use this configuration
+    /// find and read files in, such as an ArchiveFilesystem. It is used by
+    /// findFile, to check model directories and read their model.config,
+    /// to read the files and to check whether included files have changed.
+    /// Loads with a filesystem don't use the load cache. Set the filesystem
+    /// before calling AddURIPath, which checks its paths in it.
+    /// \param[in] _filesystem The filesystem, or nullptr to use the native
+    /// one.
+    /// \sa Filesystem() const
+    public: void SetFilesystem(
+                std::shared_ptr<const VirtualFilesystem> _filesystem);
+
+    /// \brief Get the filesystem set with SetFilesystem.
+    /// \return The filesystem, or nullptr if the native one is used.
+    /// \sa void SetFilesystem(
+    /// std::shared_ptr<const VirtualFilesystem> _filesystem)
+    public: std::shared_ptr<const VirtualFilesystem> Filesystem() const;
+
+    /// \brief Associate paths to a URI for the loads that use this
+    /// configuration, like addURIPath does for all loads. Files are first
+    /// searched in the paths of the configuration, then in the paths added
+    /// with addURIPath. Copies of the configuration made afterwards share
+    /// the paths, and configurations can be modified and used on different
+    /// threads at the same time.
+    /// Example parameters: "model://", "/usr/share/models:~/.gazebo/models"
+    /// \param[in] _uri URI that will be mapped to _path.
+    /// \param[in] _path Colon separated set of paths. Paths that are not
+    /// existing directories are ignored.
+    /// \sa URIPathMap() const
+    public: void AddURIPath(const std::string &_uri, const std::string &_path);
+
+    /// \brief Get the paths associated to URIs by AddURIPath. The paths
+    /// added with addURIPath are not included.
+    /// \return Map from URI to its paths, in the order they were added.
+    /// \sa void AddURIPath(const std::string &_uri, const std::string &_path)
+    public: const std::map<std::string, std::vector<std::string>> &
+                URIPathMap() const;
+
+    /// \brief Set the callback used when a file can't be found by the loads
+    /// that use this configuration. It replaces the callback set with
+    /// setFindCallback for these loads. The callback may be called from
+    /// several threads at once when more than one load thread is used.
+    /// \param[in] _cb The callback function, which returns the complete
+    /// path of the requested file, or an empty string if the file was not
+    /// found. An empty function uses the callback set with setFindCallback.
+    /// \sa FindFileCallback() const
+    public: void SetFindCallback(
+                std::function<std::string(const std::string &)> _cb);
+
+    /// \brief Get the callback set with SetFindCallback.
+    /// \return The callback, or an empty function if none is set.
+    /// \sa void SetFindCallback(
+    /// std::function<std::string(const std::string &)> _cb)
+    public: std::function<std::string(const std::string &)>
+                FindFileCallback() const;
+
+    /// \brief Set a callback that finds the URIs of <include> elements
+    /// asynchronously, such as by downloading models from a server. When a
+    /// document is read, the callback is called at once for every include
+    /// URI that the URI paths and the local search don't find, and the
+    /// document is read while the files are fetched. A load only waits for
+    /// a fetch when it reaches the include. The find callbacks are not used
+    /// for the URIs of includes while this callback is set.
+    ///
+    /// Each URI is fetched once per configuration and its copies: the path
+    /// is remembered, unless the fetch failed. The callback must return
+    /// quickly, and may be called from several threads at once.
+    /// \param[in] _cb The callback function, which returns a future of the
+    /// complete path of the model directory, or of an empty string if it
+    /// was not found. An empty function disables asynchronous fetches.
+    /// \sa AsyncFindCallback() const
+    public: void SetAsyncFindCallback(
+                std::function<std::future<std::string>(const std::string &)>
+                _cb);
+
+    /// \brief Get the callback set with SetAsyncFindCallback.
+    /// \return The callback, or an empty function if none is set.
+    /// \sa void SetAsyncFindCallback(
+    /// std::function<std::future<std::string>(const std::string &)> _cb)
+    public: std::function<std::future<std::string>(const std::string &)>
+                AsyncFindCallback() const;
+
+    /// \brief Gives access to the URI paths and callback of the
+    /// configuration.
+    private: friend class FindFileSettings;
+
+    /// \brief Private data pointer.
+    private: ParserConfigPrivate *dataPtr = nullptr;
+  };
+  }
+}
+#endif
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_PARSER_CONTEXT_HH_
+#define SDF_PARSER_CONTEXT_HH_
+
+#include <cstddef>
+#include <string>
+
+#include "sdf/Error.hh"
+#include "sdf/ParserConfig.hh"
+#include "sdf/Types.hh"
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  // Forward declarations.
+  class ParserContextPrivate;
+  class Root;
+
+  /// \brief Reusable state for loading many small documents in a row, such
+  /// as the models of a spawn service. Each load is the same as
+  /// Root::LoadSdfString with the configuration of the context, but the
+  /// context keeps what loads otherwise allocate and destroy every time:
+  /// the XML document and its memory pools, and an arena that the Element
+  /// and Param objects of the documents are allocated from, as with
+  /// ParserConfig::SetUseElementArena.
+  ///
+  /// The arena is reset rather than destroyed by the next load once no
+  /// element of the previous documents is left, e.g. because their Root
+  /// was destroyed or ParserConfig::SetReleaseElements is set, and it then
+  /// keeps a block as large as the previous documents. While elements of
+  /// earlier documents are alive, the next load starts a new arena, which
+  /// the elements keep alive with the memory of their whole document.
+  ///
+  /// A context is used by one thread at a time.
+  class SDFORMAT_VISIBLE ParserContext
+  {
+    /// \brief Default constructor, for loads with the default ParserConfig.
+    public: ParserContext();
+
+    /// \brief Constructor
+    /// \param[in] _config Configuration of the loads.
+    public: explicit ParserContext(const ParserConfig &_config);
+
+    /// \brief No copy constructor, since the retained state can't be
+    /// shared.
+    public: ParserContext(const ParserContext &_context) = delete;
+
+    /// \brief Move constructor
+    /// \param[in] _context ParserContext to move.
+    public: ParserContext(ParserContext &&_context) noexcept;
+
+    /// \brief No copy assignment operator.
+    public: ParserContext &operator=(const ParserContext &_context) = delete;
+
+    /// \brief Move assignment operator.
+    /// \param[in] _context ParserContext to move.
+    /// \return Reference to this.
+    public: ParserContext &operator=(ParserContext &&_context) noexcept;
+
+    /// \brief Destructor
+    public: ~ParserContext();
+
+    /// \brief Get the configuration of the loads.
+    /// \return The configuration.
+    public: const ParserConfig &Config() const;
+
+    /// \brief Load an SDF string, like Root::LoadSdfString.
+    /// \param[in] _sdf SDF string to parse.
+    /// \param[out] _root Root to load into.
+    /// \return Errors, which is a vector of Error objects. Each Error
+    /// includes an error code and message. An empty vector indicates no
+    /// error.
+    public: Errors LoadSdfString(const std::string &_sdf, Root &_root);
+
+    /// \brief Load SDF from a buffer that the caller owns, like
+    /// Root::LoadSdfBuffer.
+    /// \param[in] _data SDF to parse. It does not need to be null
+    /// terminated.
+    /// \param[in] _size Size of the SDF in bytes.
+    /// \param[out] _root Root to load into.
+    /// \return Errors, which is a vector of Error objects. Each Error
+    /// includes an error code and message. An empty vector indicates no
+    /// error.
+    public: Errors LoadSdfBuffer(const char *_data, std::size_t _size,
+                                 Root &_root);
+
+    /// \brief Release the memory that the context keeps between loads.
+    /// Documents that are still loaded keep their own memory.
+    public: void Reset();
+
+    /// \brief Private data pointer.
+    private: ParserContextPrivate *dataPtr = nullptr;
+  };
+  }
+}
+#endif
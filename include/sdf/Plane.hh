@@ -17,6 +17,7 @@
 #ifndef SDF_PLANE_HH_
 #define SDF_PLANE_HH_
 
+#include <ignition/math/AxisAlignedBox.hh>
 #include <ignition/math/Plane.hh>
 #include <ignition/math/Vector3.hh>
 #include <ignition/math/Vector2.hh>
@@ -103,6 +104,16 @@ namespace sdf
     /// \return A reference to an ignition::math::Planed object.
     public: ignition::math::Planed &Shape();
 
+    /// \brief Get the axis aligned bounding box of the plane, relative to
+    /// its frame.
+    /// \return The smallest box that contains the plane.
+    public: ignition::math::AxisAlignedBox AxisAlignedBox() const;
+
+    /// \brief Get the radius of the smallest sphere centered on the origin
+    /// of the plane frame that contains the plane.
+    /// \return The radius in meters.
+    public: double BoundingRadius() const;
+
     /// \brief Private data pointer.
     private: PlanePrivate *dataPtr;
   };
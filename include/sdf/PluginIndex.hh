@@ -0,0 +1,144 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_PLUGIN_INDEX_HH_
+#define SDF_PLUGIN_INDEX_HH_
+
+#include <cstddef>
+#include <string>
+
+#include "sdf/Element.hh"
+#include "sdf/Span.hh"
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  // Forward declarations.
+  class PluginIndexPrivate;
+
+  /// \enum PluginScope
+  /// \brief Kind of entity that holds a <plugin> element.
+  enum class PluginScope
+  {
+    /// \brief A world.
+    WORLD = 0,
+
+    /// \brief The <gui> of a world.
+    GUI = 1,
+
+    /// \brief A model, or a nested model.
+    MODEL = 2,
+
+    /// \brief A link of a model. Version 1.8 of the specification has no
+    /// <plugin> in <link>, so these only come from elements the parser
+    /// kept as they were, see ParserConfig.
+    LINK = 3,
+
+    /// \brief A sensor of a link.
+    SENSOR = 4,
+
+    /// \brief A visual of a link.
+    VISUAL = 5,
+  };
+
+  /// \brief A <plugin> element of a PluginIndex.
+  struct PluginDescriptor
+  {
+    /// \brief Kind of the entity that holds the plugin.
+    PluginScope scope = PluginScope::WORLD;
+
+    /// \brief Scoped name of the entity that holds the plugin, such as
+    /// "world::model::link". Models at the root of the document are named
+    /// without a world, and the plugins of the <gui> of a world have the
+    /// name of the world.
+    std::string entity;
+
+    /// \brief Value of the name attribute of the plugin.
+    std::string name;
+
+    /// \brief Value of the filename attribute of the plugin.
+    std::string filename;
+
+    /// \brief The <plugin> element, with the configuration of the plugin.
+    ElementPtr element;
+  };
+
+  /// \brief The <plugin> elements of a loaded document, with the entity
+  /// that holds them, listed once when the document is loaded so that
+  /// simulation startup doesn't have to walk the element tree.
+  ///
+  /// Only the elements of entities are visited, so building the index
+  /// costs about the number of worlds, models, links, sensors and visuals
+  /// rather than the number of elements. Plugins are listed entity by
+  /// entity, in the order of the entities in the document: a world, its
+  /// <gui>, then its models, each model before its links and nested
+  /// models, and each link before its sensors and visuals. The plugins of
+  /// each entity are in document order, and adjacent, so that they can be
+  /// found by entity in constant time.
+  class SDFORMAT_VISIBLE PluginIndex
+  {
+    /// \brief Default constructor, for an empty index.
+    public: PluginIndex();
+
+    /// \brief Copy constructor
+    /// \param[in] _index PluginIndex to copy.
+    public: PluginIndex(const PluginIndex &_index);
+
+    /// \brief Move constructor
+    /// \param[in] _index PluginIndex to move.
+    public: PluginIndex(PluginIndex &&_index) noexcept;
+
+    /// \brief Move assignment operator.
+    /// \param[in] _index PluginIndex to move.
+    /// \return Reference to this.
+    public: PluginIndex &operator=(PluginIndex &&_index) noexcept;
+
+    /// \brief Copy assignment operator.
+    /// \param[in] _index PluginIndex to copy.
+    /// \return Reference to this.
+    public: PluginIndex &operator=(const PluginIndex &_index);
+
+    /// \brief Destructor
+    public: ~PluginIndex();
+
+    /// \brief Index the plugins of a document, replacing the previous
+    /// content. Root::Load calls this before the elements are released.
+    /// \param[in] _root The <sdf> element of the document.
+    public: void Build(const ElementPtr &_root);
+
+    /// \brief Get all the plugins.
+    /// \return The plugins, entity by entity.
+    public: Span<const PluginDescriptor> Plugins() const;
+
+    /// \brief Get the plugins of an entity.
+    /// \param[in] _entity Scoped name of the entity, see
+    /// PluginDescriptor::entity.
+    /// \return The plugins of the entity, in document order, or an empty
+    /// span if it has none.
+    public: Span<const PluginDescriptor> PluginsOf(
+                const std::string &_entity) const;
+
+    /// \brief Private data pointer.
+    private: PluginIndexPrivate *dataPtr = nullptr;
+  };
+  }
+}
+#endif
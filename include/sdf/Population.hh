@@ -0,0 +1,262 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_POPULATION_HH_
+#define SDF_POPULATION_HH_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Vector3.hh>
+#include "sdf/Element.hh"
+#include "sdf/Model.hh"
+#include "sdf/Types.hh"
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  // Forward declarations.
+  class Box;
+  class Cylinder;
+  class PopulationPrivate;
+
+  /// \enum PopulationDistribution
+  /// \brief How the models of a population are placed in its region, see
+  /// //population/distribution/type.
+  enum class PopulationDistribution
+  {
+    /// \brief Models placed at random in the region.
+    RANDOM = 0,
+
+    /// \brief Models approximately evenly placed over the region.
+    UNIFORM = 1,
+
+    /// \brief Models placed on a grid of Rows() by Cols() cells, Step()
+    /// apart. ModelCount() is not used.
+    GRID = 2,
+
+    /// \brief Models evenly placed in a row along the x axis of the region.
+    LINEAR_X = 3,
+
+    /// \brief Models evenly placed in a row along the y axis of the region.
+    LINEAR_Y = 4,
+
+    /// \brief Models evenly placed in a row along the z axis of the region.
+    LINEAR_Z = 5,
+  };
+
+  /// \brief A population describes a set of identical models placed in a
+  /// world according to a distribution, see <population>.
+  ///
+  /// All the instances share one Model, the template, and only their
+  /// positions are stored, in one array that is generated the first time
+  /// it is requested. InstanceModel makes a Model for one instance when it
+  /// is needed, which shares the sdf::Element of the template.
+  ///
+  /// Instances are not part of the frame graphs of the world, so they can
+  /// not be referenced by frames or poses, and World::ModelCount does not
+  /// count them. Applications that need a model in the graphs add the
+  /// result of InstanceModel to their own world.
+  class SDFORMAT_VISIBLE Population
+  {
+    /// \brief Default constructor
+    public: Population();
+
+    /// \brief Copy constructor
+    /// \param[in] _population Population to copy.
+    public: Population(const Population &_population);
+
+    /// \brief Move constructor
+    /// \param[in] _population Population to move.
+    public: Population(Population &&_population) noexcept;
+
+    /// \brief Destructor
+    public: ~Population();
+
+    /// \brief Move assignment operator.
+    /// \param[in] _population Population to move.
+    /// \return Reference to this.
+    public: Population &operator=(Population &&_population) noexcept;
+
+    /// \brief Assignment operator.
+    /// \param[in] _population The population to set values from.
+    /// \return *this
+    public: Population &operator=(const Population &_population);
+
+    /// \brief Load the population based on a element pointer. This is *not*
+    /// the usual entry point. Typical usage of the SDF DOM is through the
+    /// Root object.
+    /// \param[in] _sdf The SDF Element pointer
+    /// \return Errors, which is a vector of Error objects. Each Error includes
+    /// an error code and message. An empty vector indicates no error.
+    public: Errors Load(ElementPtr _sdf);
+
+    /// \brief Get the name of the population.
+    /// \return Name of the population.
+    public: const std::string &Name() const;
+
+    /// \brief Set the name of the population.
+    /// \param[in] _name Name of the population.
+    public: void SetName(const std::string &_name);
+
+    /// \brief Get the number of models to place, used by every distribution
+    /// but GRID.
+    /// \return Number of models.
+    public: uint64_t ModelCount() const;
+
+    /// \brief Set the number of models to place.
+    /// \param[in] _count Number of models.
+    public: void SetModelCount(uint64_t _count);
+
+    /// \brief Get the distribution of the models.
+    /// \return The distribution.
+    public: PopulationDistribution Distribution() const;
+
+    /// \brief Set the distribution of the models.
+    /// \param[in] _distribution The distribution.
+    public: void SetDistribution(PopulationDistribution _distribution);
+
+    /// \brief Get the number of rows of a GRID distribution.
+    /// \return Number of rows.
+    public: uint64_t Rows() const;
+
+    /// \brief Set the number of rows of a GRID distribution.
+    /// \param[in] _rows Number of rows.
+    public: void SetRows(uint64_t _rows);
+
+    /// \brief Get the number of columns of a GRID distribution.
+    /// \return Number of columns.
+    public: uint64_t Cols() const;
+
+    /// \brief Set the number of columns of a GRID distribution.
+    /// \param[in] _cols Number of columns.
+    public: void SetCols(uint64_t _cols);
+
+    /// \brief Get the distance between the cells of a GRID distribution.
+    /// \return Distance along the x axis between columns, and along the y
+    /// axis between rows.
+    public: const ignition::math::Vector3d &Step() const;
+
+    /// \brief Set the distance between the cells of a GRID distribution.
+    /// \param[in] _step Distance along the x axis between columns, and
+    /// along the y axis between rows.
+    public: void SetStep(const ignition::math::Vector3d &_step);
+
+    /// \brief Get the box region of the population.
+    /// \return The box, or nullptr if the region is not a box.
+    public: const Box *BoxShape() const;
+
+    /// \brief Set the region of the population to a box, centered on the
+    /// population frame.
+    /// \param[in] _box The box.
+    public: void SetBoxShape(const Box &_box);
+
+    /// \brief Get the cylinder region of the population.
+    /// \return The cylinder, or nullptr if the region is not a cylinder.
+    public: const Cylinder *CylinderShape() const;
+
+    /// \brief Set the region of the population to a cylinder, centered on
+    /// the population frame with its axis along z.
+    /// \param[in] _cylinder The cylinder.
+    public: void SetCylinderShape(const Cylinder &_cylinder);
+
+    /// \brief Get the pose of the population frame, relative to the frame
+    /// named by PoseRelativeTo.
+    /// \return The pose of the population.
+    public: const ignition::math::Pose3d &RawPose() const;
+
+    /// \brief Set the pose of the population frame.
+    /// \param[in] _pose The pose of the population.
+    public: void SetRawPose(const ignition::math::Pose3d &_pose);
+
+    /// \brief Get the name of the frame the pose is relative to. An empty
+    /// value indicates the world frame.
+    /// \return The name of the relative-to frame.
+    public: const std::string &PoseRelativeTo() const;
+
+    /// \brief Set the name of the frame the pose is relative to.
+    /// \param[in] _frame The name of the relative-to frame.
+    public: void SetPoseRelativeTo(const std::string &_frame);
+
+    /// \brief Get the model that every instance is a copy of.
+    /// \return The model, or nullptr if it has not been loaded or set.
+    public: const Model *ModelTemplate() const;
+
+    /// \brief Set the model that every instance is a copy of.
+    /// \param[in] _model The model.
+    public: void SetModelTemplate(const Model &_model);
+
+    /// \brief Get the seed of the RANDOM distribution. Instances are placed
+    /// the same way for a given seed.
+    /// \return The seed, 0 by default.
+    public: uint32_t Seed() const;
+
+    /// \brief Set the seed of the RANDOM distribution.
+    /// \param[in] _seed The seed.
+    public: void SetSeed(uint32_t _seed);
+
+    /// \brief Get the number of instances, which is Rows() * Cols() for a
+    /// GRID distribution and ModelCount() otherwise.
+    /// \return Number of instances.
+    public: uint64_t InstanceCount() const;
+
+    /// \brief Get the position of every instance in the population frame.
+    /// The positions are generated from the distribution the first time
+    /// they are requested after a change.
+    /// \return Array of InstanceCount() positions.
+    public: const std::vector<ignition::math::Vector3d> &InstancePositions()
+                const;
+
+    /// \brief Get the name of an instance, which is the name of the
+    /// template followed by "_clone_" and the index of the instance.
+    /// \param[in] _index Index of the instance.
+    /// \return Name of the instance, or an empty string if the index is
+    /// invalid or there is no template.
+    public: std::string InstanceName(uint64_t _index) const;
+
+    /// \brief Get the pose of the model of an instance, relative to the
+    /// frame named by PoseRelativeTo. This is the pose of the template
+    /// model, moved to the position of the instance in the population
+    /// frame.
+    /// \param[in] _index Index of the instance.
+    /// \return Pose of the instance, or a zero pose if the index is
+    /// invalid or there is no template.
+    public: ignition::math::Pose3d InstancePose(uint64_t _index) const;
+
+    /// \brief Make the model of an instance: a copy of the template with
+    /// the name and pose of the instance, relative to PoseRelativeTo.
+    /// \param[in] _index Index of the instance.
+    /// \return The model. It is a default model if the index is invalid or
+    /// there is no template.
+    public: Model InstanceModel(uint64_t _index) const;
+
+    /// \brief Get a pointer to the SDF element that was used during load.
+    /// \return SDF element pointer. The value will be nullptr if Load has
+    /// not been called.
+    public: sdf::ElementPtr Element() const;
+
+    /// \brief Private data pointer.
+    private: PopulationPrivate *dataPtr = nullptr;
+  };
+  }
+}
+#endif
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_POSE_GRAPH_SNAPSHOT_HH_
+#define SDF_POSE_GRAPH_SNAPSHOT_HH_
+
+#include <cstddef>
+#include <string>
+#include <ignition/math/Pose3.hh>
+
+#include "sdf/Error.hh"
+#include "sdf/Types.hh"
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  // Forward declarations.
+  class PoseGraphSnapshotPrivate;
+  struct PoseRelativeToGraph;
+  template <typename T> class ScopedGraph;
+
+  /// \brief An immutable copy of the resolved poses of the frames of a
+  /// world or model, taken with World::PoseSnapshot or Model::PoseSnapshot,
+  /// for threads that resolve poses concurrently, such as render, physics
+  /// and sensor threads.
+  ///
+  /// Taking a snapshot resolves every frame once. Afterwards the snapshot
+  /// is never modified, so any number of threads can read it without locks,
+  /// and it is not affected by later changes to the DOM or by the
+  /// destruction of the DOM objects; take a new snapshot to see them.
+  /// Copies share the same poses, and are cheap.
+  ///
+  /// SemanticPose::Resolve on the live graph is also safe from several
+  /// threads, since its caches are locked, as long as no thread modifies
+  /// the DOM meanwhile. Taking a snapshot has the same requirement.
+  class SDFORMAT_VISIBLE PoseGraphSnapshot
+  {
+    /// \brief Default constructor, for a snapshot without frames.
+    public: PoseGraphSnapshot();
+
+    /// \brief Copy constructor
+    /// \param[in] _snapshot PoseGraphSnapshot to copy.
+    public: PoseGraphSnapshot(const PoseGraphSnapshot &_snapshot);
+
+    /// \brief Move constructor
+    /// \param[in] _snapshot PoseGraphSnapshot to move.
+    public: PoseGraphSnapshot(PoseGraphSnapshot &&_snapshot) noexcept;
+
+    /// \brief Move assignment operator.
+    /// \param[in] _snapshot PoseGraphSnapshot to move.
+    /// \return Reference to this.
+    public: PoseGraphSnapshot &operator=(PoseGraphSnapshot &&_snapshot)
+                noexcept;
+
+    /// \brief Copy assignment operator.
+    /// \param[in] _snapshot PoseGraphSnapshot to copy.
+    /// \return Reference to this.
+    public: PoseGraphSnapshot &operator=(const PoseGraphSnapshot &_snapshot);
+
+    /// \brief Destructor
+    public: ~PoseGraphSnapshot();
+
+    /// \brief Get the number of frames whose pose was resolved, including
+    /// the implicit frames such as "world" and "__model__".
+    /// \return Number of frames.
+    public: std::size_t FrameCount() const;
+
+    /// \brief Resolve the pose of a frame relative to another frame.
+    /// \param[out] _pose The resolved pose. It is not modified if there are
+    /// errors.
+    /// \param[in] _frame Name of the frame, in the scope of the world or
+    /// model the snapshot was taken of, such as "model::link" for a world.
+    /// \param[in] _resolveTo Name of the frame to resolve the pose
+    /// relative to. If empty, the world frame or the model frame is used.
+    /// \return A POSE_RELATIVE_TO_INVALID error if a frame is not in the
+    /// snapshot.
+    public: Errors Resolve(ignition::math::Pose3d &_pose,
+                const std::string &_frame,
+                const std::string &_resolveTo = "") const;
+
+    /// \brief Take a snapshot of the frames of the scope of a graph.
+    /// \param[in] _graph Graph of a world or model.
+    private: explicit PoseGraphSnapshot(
+                const ScopedGraph<PoseRelativeToGraph> &_graph);
+
+    /// \brief Resolve the pose of a frame relative to another frame, for a
+    /// SemanticPose.
+    /// \param[out] _pose The resolved pose.
+    /// \param[in] _graph Graph of the SemanticPose, which must be the one
+    /// the snapshot was taken of.
+    /// \param[in] _frame Absolute name of the frame in the graph.
+    /// \param[in] _resolveTo Absolute name of the frame to resolve to.
+    /// \return Errors.
+    private: Errors ResolveGraphFrames(ignition::math::Pose3d &_pose,
+                const PoseRelativeToGraph &_graph,
+                const std::string &_frame,
+                const std::string &_resolveTo) const;
+
+    friend class Model;
+    friend class SemanticPose;
+    friend class World;
+
+    /// \brief Private data pointer.
+    private: PoseGraphSnapshotPrivate *dataPtr = nullptr;
+  };
+  }
+}
+#endif
@@ -17,9 +17,18 @@
 #ifndef SDF_ROOT_HH_
 #define SDF_ROOT_HH_
 
+#include <cstddef>
+#include <istream>
+#include <ostream>
 #include <string>
+#include <vector>
 
+#include "sdf/MemoryFootprint.hh"
+#include "sdf/ParserConfig.hh"
+#include "sdf/PluginIndex.hh"
 #include "sdf/SDFImpl.hh"
+#include "sdf/Span.hh"
+#include "sdf/TextRange.hh"
 #include "sdf/Types.hh"
 #include "sdf/sdf_config.h"
 #include "sdf/system_util.hh"
@@ -33,9 +42,15 @@ namespace sdf
   // Forward declarations.
   class Actor;
   class Light;
+  class Mesh;
   class Model;
+  class RootLoadSource;
   class RootPrivate;
+  class StateFrame;
   class World;
+  struct FrameAttachedToGraph;
+  struct PoseRelativeToGraph;
+  template <typename T> struct RootGraphs;
 
   /// \brief Root class that acts as an entry point to the SDF document
   /// model.
@@ -83,6 +98,15 @@ namespace sdf
     /// an error code and message. An empty vector indicates no error.
     public: Errors Load(const std::string &_filename);
 
+    /// \brief Parse the given SDF file, and generate objects based on types
+    /// specified in the SDF file.
+    /// \param[in] _filename Name of the SDF file to parse.
+    /// \param[in] _config Parser configuration
+    /// \return Errors, which is a vector of Error objects. Each Error includes
+    /// an error code and message. An empty vector indicates no error.
+    public: Errors Load(const std::string &_filename,
+                        const ParserConfig &_config);
+
     /// \brief Parse the given SDF string, and generate objects based on types
     /// specified in the SDF file.
     /// \param[in] _sdf SDF string to parse.
@@ -90,6 +114,68 @@ namespace sdf
     /// an error code and message. An empty vector indicates no error.
     public: Errors LoadSdfString(const std::string &_sdf);
 
+    /// \brief Parse the given SDF string, and generate objects based on types
+    /// specified in the SDF file.
+    /// \param[in] _sdf SDF string to parse.
+    /// \param[in] _config Parser configuration
+    /// \return Errors, which is a vector of Error objects. Each Error includes
+    /// an error code and message. An empty vector indicates no error.
+    public: Errors LoadSdfString(const std::string &_sdf,
+                                 const ParserConfig &_config);
+
+    /// \brief Parse SDF from a buffer that the caller owns, without copying
+    /// it into a string first, and generate objects based on types
+    /// specified in the SDF file.
+    /// \param[in] _data SDF to parse. It does not need to be null
+    /// terminated.
+    /// \param[in] _size Size of the SDF in bytes.
+    /// \param[in] _config Parser configuration
+    /// \return Errors, which is a vector of Error objects. Each Error includes
+    /// an error code and message. An empty vector indicates no error.
+    public: Errors LoadSdfBuffer(const char *_data, std::size_t _size,
+                                 const ParserConfig &_config);
+
+    /// \brief Parse SDF read from an input stream, and generate objects
+    /// based on types specified in the SDF file.
+    /// \param[in] _in Stream to read the SDF from, to its end.
+    /// \param[in] _config Parser configuration
+    /// \return Errors, which is a vector of Error objects. Each Error includes
+    /// an error code and message. An empty vector indicates no error.
+    public: Errors LoadSdfStream(std::istream &_in,
+                                 const ParserConfig &_config);
+
+    /// \brief Load a single <model>, <actor> or <light> element, without
+    /// the <sdf> element around it, at the current SDF version, see
+    /// readFragment. The object is at the root of this document, with its
+    /// frame graphs built, ready to be added to a world with Merge.
+    /// \param[in] _xml XML of the fragment.
+    /// \param[in] _config Parser configuration
+    /// \return Errors, which is a vector of Error objects. Each Error includes
+    /// an error code and message. An empty vector indicates no error.
+    public: Errors LoadSdfFragment(const std::string &_xml,
+                                   const ParserConfig &_config);
+
+    /// \brief Load the DOM from a binary snapshot written by WriteBinary,
+    /// for example by another process, without parsing any XML. The
+    /// snapshot already has its includes resolved and its values converted,
+    /// so only the DOM objects are built.
+    /// \param[in] _data Content of the snapshot.
+    /// \param[in] _size Size of the content in bytes.
+    /// \param[in] _config Parser configuration
+    /// \return Errors, which is a vector of Error objects. Each Error includes
+    /// an error code and message. An empty vector indicates no error.
+    public: Errors LoadBinaryBuffer(const char *_data, std::size_t _size,
+                                    const ParserConfig &_config);
+
+    /// \brief Write the element tree this Root was loaded from as a binary
+    /// snapshot, see SDF::WriteBinary, so that a receiver can load it with
+    /// LoadBinaryBuffer instead of parsing the XML of ToString. Changes made
+    /// to the DOM objects after loading are not written.
+    /// \param[out] _out Stream to write to.
+    /// \return An ELEMENT_MISSING error if the elements were released with
+    /// ParserConfig::SetReleaseElements, or errors of the snapshot.
+    public: Errors WriteBinary(std::ostream &_out) const;
+
     /// \brief Parse the given SDF pointer, and generate objects based on types
     /// specified in the SDF file.
     /// \param[in] _sdf SDF pointer to parse.
@@ -97,6 +183,161 @@ namespace sdf
     /// an error code and message. An empty vector indicates no error.
     public: Errors Load(const SDFPtr _sdf);
 
+    /// \brief Parse the given SDF pointer, and generate objects based on types
+    /// specified in the SDF file.
+    ///
+    /// Worlds are loaded one after another, while the models, lights and
+    /// actors within a world or directly under the root are loaded using
+    /// the number of threads given by ParserConfig::LoadThreadCount. Frame
+    /// graphs are always built on the calling thread, and errors are
+    /// returned in document order.
+    /// \param[in] _sdf SDF pointer to parse.
+    /// \param[in] _config Parser configuration
+    /// \return Errors, which is a vector of Error objects. Each Error includes
+    /// an error code and message. An empty vector indicates no error.
+    public: Errors Load(const SDFPtr _sdf, const ParserConfig &_config);
+
+    /// \brief Read again the models included in worlds from files that
+    /// changed, and replace them without reloading the rest of the
+    /// document. Only the frame graph scopes of the replaced models are
+    /// rebuilt, and frames of the world that were attached to, or had their
+    /// pose relative to, a frame of a replaced model are reconnected to the
+    /// frame with the same name in the new model. A model that fails to
+    /// load is kept as it was.
+    ///
+    /// The document must have been loaded with ParserConfig::TrackIncludes
+    /// enabled, and ParserConfig::ReleaseElements disabled.
+    /// \param[in] _changedFiles Paths of the changed files, as resolved
+    /// when the includes were read. An include is read again if its model
+    /// file, or a file that the model includes, is in the list.
+    /// \param[in] _config Parser configuration to read the includes with.
+    /// \return Errors of reading and loading the replaced models. An
+    /// ELEMENT_MISSING error is returned if the includes were not recorded,
+    /// or the element of a changed model was released.
+    /// \sa std::vector<std::string> IncludedFiles() const
+    public: Errors ReloadIncludes(const std::vector<std::string> &_changedFiles,
+                                  const ParserConfig &_config);
+
+    /// \brief Read again the models included in worlds from files whose
+    /// size or modification time changed since they were read, as
+    /// ReloadIncludes does for a list of changed files. Calling this
+    /// periodically is a simple way to watch the included files.
+    /// \param[in] _config Parser configuration to check the files and read
+    /// the includes with.
+    /// \return Errors of reading and loading the replaced models.
+    public: Errors ReloadIncludes(const ParserConfig &_config);
+
+    /// \brief Get the files that the models included in worlds were read
+    /// from, for a file watcher to pass to ReloadIncludes when they change.
+    /// \return Paths of the included files, without duplicates, or nothing
+    /// if ParserConfig::TrackIncludes was disabled.
+    public: std::vector<std::string> IncludedFiles() const;
+
+    /// \brief Apply an edit of the text of the document, such as the edits
+    /// of an editor, by reading again only the smallest element of the text
+    /// that encloses the edit, and patching the element tree and the DOM.
+    /// The element replaces the old one in the tree, and the top level
+    /// model of a world it belongs to is loaded again like ReloadIncludes
+    /// does, while the source ranges of the elements after the edit are
+    /// moved. Checks over the whole document, such as the names of the
+    /// worlds, are not made again.
+    ///
+    /// The document is read again as a whole, as with LoadSdfString, when
+    /// the edit is outside of the top level models of the worlds, when the
+    /// document wasn't loaded with LoadSdfString or LoadSdfBuffer and
+    /// ParserConfig::RecordSourceRanges, when the text of the element
+    /// can't be read on its own, or when the model fails to load.
+    /// \param[in] _text The whole text of the document after the edit.
+    /// \param[in] _edit Edit that turned the previous text into _text.
+    /// \param[in] _config Parser configuration to read the text with.
+    /// Source ranges are recorded whatever RecordSourceRanges is set to.
+    /// \return Errors of reading and loading the text that was read again.
+    public: Errors Reparse(const std::string &_text, const TextEdit &_edit,
+                           const ParserConfig &_config = ParserConfig());
+
+    /// \brief Add the models, lights and actors of another loaded document,
+    /// a layer, to the worlds of this one, so that a world can be composed
+    /// from a base document and layers that are each read once. The
+    /// objects are copied from the DOM of the layer, and each model is
+    /// inserted in the frame graphs of its new world as a scope of its own,
+    /// so nothing is read or loaded again, and the layer can be merged into
+    /// several documents.
+    ///
+    /// The objects of each world of the layer are added to the world of
+    /// this document with the same name, and the models, lights and actors
+    /// at the root of the layer to the first world. When _worldName is
+    /// given, every object of the layer is added to that world instead. An
+    /// object whose name is already used in its new world is skipped, and
+    /// the frames of the worlds of the layer, which the objects of this
+    /// document can't see, are not merged. Other properties of the worlds,
+    /// such as physics or the scene, are those of this document.
+    ///
+    /// Layers should be loaded with the same ParserConfig as this document,
+    /// so that they share materials the same way. Element() and Plugins()
+    /// keep describing the document that was loaded, while merged objects
+    /// keep the elements of the layer. Pointers to the models, lights and
+    /// actors of the worlds that were merged into may be invalidated.
+    /// \param[in] _layer Document to merge.
+    /// \param[in] _worldName Name of the world to add every object to, or
+    /// an empty string to add them by world name.
+    /// \return An ELEMENT_MISSING error for each world of the layer that is
+    /// not in this document, an ELEMENT_INVALID error for each world frame
+    /// of the layer, and the DUPLICATE_NAME and frame graph errors of the
+    /// objects that were added.
+    public: Errors Merge(const Root &_layer,
+                const std::string &_worldName = "");
+
+    /// \brief Apply the model and link poses of a recorded state, such as a
+    /// frame read by StateReader, to the world it was recorded in, which is
+    /// the world named by StateFrame::WorldName, or the only world if the
+    /// state has no world name. The poses of the state are relative to the
+    /// world frame, as Gazebo records them.
+    ///
+    /// The frames are looked up by scoped name in the pose graph of the
+    /// world, and their poses in the graph are replaced in place: top level
+    /// models become relative to the world frame, and links and nested
+    /// models relative to the frame of their model. Only the resolved poses
+    /// of the moved frames and of the frames resolved through them are
+    /// discarded, so seeking through a log costs about the number of
+    /// entities of a state. SemanticPose, World::ResolvePoses and the other
+    /// pose queries then use the poses of the state.
+    ///
+    /// The raw poses of top level models are set too, with no relative_to
+    /// or placement frame. The links and nested models of identical models
+    /// can be shared, so their raw poses are left unchanged, and
+    /// SemanticPose::Resolve of a shared link resolves it in the first of
+    /// those models. Entities that are not in the state keep their pose
+    /// relative to the frame they were defined in.
+    /// \param[in] _state State to apply.
+    /// \return An ELEMENT_MISSING error if there is no such world, or for
+    /// the models and links of the state that are not in the world, which
+    /// are skipped.
+    public: Errors ApplyState(const StateFrame &_state);
+
+    /// \brief Get the number of distinct meshes of the geometries of the
+    /// worlds and models, when they were loaded with
+    /// ParserConfig::ShareMeshes enabled. Geometries whose meshes have the
+    /// same URI, file path, scale, submesh and submesh centering share one
+    /// mesh, so that an application can load each mesh asset once.
+    /// \return Number of meshes, or 0 if meshes are not shared.
+    public: uint64_t MeshCount() const;
+
+    /// \brief Get a distinct mesh. Geometry::MeshShape returns this pointer
+    /// for every geometry that shares it.
+    /// \param[in] _index Index of the mesh. The index should be in the
+    /// range [0..MeshCount()).
+    /// \return Pointer to the mesh. Nullptr if the index does not exist.
+    /// \sa uint64_t MeshCount() const
+    public: const Mesh *MeshByIndex(const uint64_t _index) const;
+
+    /// \brief Get the number of geometries that share a mesh, including
+    /// copies of them and of the DOM objects that hold them. A mesh whose
+    /// geometries were all replaced, for example by ReloadIncludes, stays
+    /// in the registry with a count of 0.
+    /// \param[in] _index Index of the mesh.
+    /// \return Number of geometries, or 0 if the index does not exist.
+    public: uint64_t MeshReferenceCount(const uint64_t _index) const;
+
     /// \brief Get the SDF version specified in the parsed file or SDF
     /// pointer.
     /// \return SDF version string.
@@ -119,6 +360,11 @@ namespace sdf
     /// \sa uint64_t WorldCount() const
     public: const World *WorldByIndex(const uint64_t _index) const;
 
+    /// \brief Get the worlds.
+    /// \return View of the worlds, in the order of WorldByIndex. It
+    /// is invalidated when worlds are added or removed.
+    public: Span<const World> Worlds() const;
+
     /// \brief Get whether a world name exists.
     /// \param[in] _name Name of the world to check.
     /// \return True if there exists a world with the given name.
@@ -179,6 +425,68 @@ namespace sdf
     /// not been called.
     public: sdf::ElementPtr Element() const;
 
+    /// \brief Get the plugins of the loaded document, indexed by entity
+    /// when it was loaded. They are kept when the elements are released,
+    /// see ParserConfig::ReleaseElements.
+    /// \return The plugin index.
+    public: const PluginIndex &Plugins() const;
+
+    /// \brief Get the memory used by the loaded document, by category, in
+    /// total and for each top level model, see MemoryFootprintReport. The
+    /// elements are only counted if they were kept, see
+    /// ParserConfig::ReleaseElements.
+    /// \return The report.
+    public: MemoryFootprintReport MemoryReport() const;
+
+    /// \brief Read a document and load the DOM from it, for the Load
+    /// functions that read a document. The includes, region filter,
+    /// diagnostics, pipelined models and load cache entry of the read are
+    /// handled here, and the errors are truncated and the load stopped as
+    /// the configuration says.
+    /// \param[in] _source Source to read the document from.
+    /// \param[in] _config Parser configuration.
+    /// \return Errors of reading and loading the document.
+    private: Errors LoadImpl(const RootLoadSource &_source,
+                             const ParserConfig &_config);
+
+    /// \brief Get the frame attached-to graphs built during Load.
+    /// \return The graphs of the worlds and top-level models.
+    private: const RootGraphs<FrameAttachedToGraph> &FrameAttachedToGraphs()
+        const;
+
+    /// \brief Get the pose relative-to graphs built during Load.
+    /// \return The graphs of the worlds and top-level models.
+    private: const RootGraphs<PoseRelativeToGraph> &PoseRelativeToGraphs()
+        const;
+
+    /// \brief Get the number of worlds and top level models loaded with
+    /// ParserConfig::LazyModels, whose frame graphs are built on first
+    /// access. This is private and is intended to be called by
+    /// IncrementalLoader.
+    /// \return Number of scopes with deferred graphs.
+    private: std::size_t DeferredGraphCount() const;
+
+    /// \brief Build the frame graphs of a world or top level model loaded
+    /// with ParserConfig::LazyModels, if they are not built yet. This is
+    /// private and is intended to be called by IncrementalLoader.
+    /// \param[in] _index Index of the scope, less than DeferredGraphCount().
+    /// \return Errors of building and validating the graphs.
+    private: Errors BuildDeferredGraphs(std::size_t _index) const;
+
+    /// \brief The graph checks and writers reuse the graphs built during
+    /// Load, and IncrementalLoader builds the deferred graphs in steps.
+    friend SDFORMAT_VISIBLE bool checkFrameAttachedToGraph(
+        const Root *, unsigned int);
+    friend SDFORMAT_VISIBLE bool checkPoseRelativeToGraph(
+        const Root *, unsigned int);
+    friend SDFORMAT_VISIBLE bool checkRoot(
+        const Root *, unsigned int, std::vector<std::string> &);
+    friend SDFORMAT_VISIBLE bool writeFrameAttachedToGraph(
+        const Root *, std::ostream &, const std::string &, int);
+    friend SDFORMAT_VISIBLE bool writePoseRelativeToGraph(
+        const Root *, std::ostream &, const std::string &, int);
+    friend class IncrementalLoaderPrivate;
+
     /// \brief Private data pointer
     private: RootPrivate *dataPtr = nullptr;
   };
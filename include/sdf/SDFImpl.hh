@@ -17,12 +17,15 @@
 #ifndef SDFIMPL_HH_
 #define SDFIMPL_HH_
 
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <ostream>
 #include <string>
 
 #include "sdf/Param.hh"
 #include "sdf/Element.hh"
+#include "sdf/ParserConfig.hh"
 #include "sdf/sdf_config.h"
 #include "sdf/system_util.hh"
 #include "sdf/Types.hh"
@@ -64,6 +67,24 @@ namespace sdf
                        bool _searchLocalPath = true,
                        bool _useCallback = false);
 
+  /// \brief Find the absolute path of a file, also using the URI paths and
+  /// find callback of a parser configuration. This function can be called
+  /// from several threads at once.
+  /// \param[in] _filename Name of the file to find.
+  /// \param[in] _searchLocalPath True to search for the file in the current
+  /// working directory.
+  /// \param[in] _useCallback True to find a file based on the callback of
+  /// the configuration, or else the registered callback, if the file is not
+  /// found via the normal mechanism.
+  /// \param[in] _config Parser configuration, see ParserConfig::AddURIPath
+  /// and ParserConfig::SetFindCallback.
+  /// \return File's full path.
+  SDFORMAT_VISIBLE
+  std::string findFile(const std::string &_filename,
+                       bool _searchLocalPath,
+                       bool _useCallback,
+                       const ParserConfig &_config);
+
   /// \brief Associate paths to a URI.
   /// Example paramters: "model://", "/usr/share/models:~/.gazebo/models"
   /// \param[in] _uri URI that will be mapped to _path
@@ -78,6 +99,43 @@ namespace sdf
   SDFORMAT_VISIBLE
   void setFindCallback(std::function<std::string (const std::string &)> _cb);
 
+  /// \brief Remove all memoized findFile results and reset the hit and miss
+  /// counters.
+  ///
+  /// findFile remembers the result of each search, including files that
+  /// were not found, for the same file name, flags, SDF version, working
+  /// directory and SDF_PATH. Results found with the URI paths or find
+  /// callback of a ParserConfig are remembered with its settings, and are
+  /// cleared as well. The results are cleared automatically by
+  /// addURIPath and setFindCallback. Call this function after creating or
+  /// removing files that may have been searched for before, or when the
+  /// find callback would now answer differently.
+  SDFORMAT_VISIBLE
+  void clearFindFileCache();
+
+  /// \brief Enable or disable memoization of findFile results. It is
+  /// enabled by default. Disabling it also removes all memoized results.
+  /// \param[in] _enabled True to memoize findFile results.
+  SDFORMAT_VISIBLE
+  void setFindFileCacheEnabled(bool _enabled);
+
+  /// \brief Get whether findFile results are memoized.
+  /// \return True if findFile results are memoized.
+  SDFORMAT_VISIBLE
+  bool findFileCacheEnabled();
+
+  /// \brief Get the number of findFile calls answered from memoized results
+  /// since the last call to clearFindFileCache.
+  /// \return Number of cache hits.
+  SDFORMAT_VISIBLE
+  uint64_t findFileCacheHits();
+
+  /// \brief Get the number of findFile calls that searched for the file
+  /// since the last call to clearFindFileCache.
+  /// \return Number of cache misses.
+  SDFORMAT_VISIBLE
+  uint64_t findFileCacheMisses();
+
 
   /// \brief Base SDF class
   class SDFORMAT_VISIBLE SDF
@@ -89,8 +147,45 @@ namespace sdf
     public: void PrintValues();
     public: void PrintDoc();
     public: void Write(const std::string &_filename);
+
+    /// \brief Write the same XML as Write, serializing the children of the
+    /// world, or of the first element with several children, on several
+    /// threads into separate buffers, which are then written to the file in
+    /// order with vectored writes. \sa Element::ToBuffers
+    /// \param[in] _filename Path of the file to write.
+    /// \param[in] _threadCount Maximum number of threads to use. A value of
+    /// 0 uses one thread per hardware thread.
+    public: void Write(const std::string &_filename,
+                       unsigned int _threadCount);
+
     public: std::string ToString() const;
 
+    /// \brief Write the same XML as ToString directly to a stream, without
+    /// building the string in memory first.
+    /// \param[out] _out Stream to write to.
+    /// \param[in] _compact True to write the XML without indentation and
+    /// line breaks.
+    public: void ToStream(std::ostream &_out, bool _compact = false) const;
+
+    /// \brief Write a binary snapshot of the document, which can be read
+    /// back with sdf::readBinaryFile much faster than the XML. Values are
+    /// stored natively and names are stored once. A snapshot can only be
+    /// read by a library with the same SDFormat version, see SDF::Version,
+    /// on a machine with the same byte order.
+    /// \param[in] _filename Name of the file to write.
+    /// \param[out] _errors Errors are appended to this variable.
+    /// \return True if the snapshot was written.
+    public: bool WriteBinary(const std::string &_filename,
+                             Errors &_errors) const;
+
+    /// \brief Write a binary snapshot of the document to a stream, such as
+    /// a message buffer, which can be read back with
+    /// sdf::readBinaryBuffer. \sa WriteBinary(const std::string &, Errors &)
+    /// \param[out] _out Stream to write to.
+    /// \param[out] _errors Errors are appended to this variable.
+    /// \return True if the snapshot was written.
+    public: bool WriteBinary(std::ostream &_out, Errors &_errors) const;
+
     /// \brief Set SDF values from a string
     public: void SetFromString(const std::string &_sdfData);
 
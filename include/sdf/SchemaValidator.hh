@@ -0,0 +1,158 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_SCHEMA_VALIDATOR_HH_
+#define SDF_SCHEMA_VALIDATOR_HH_
+
+#include <cstddef>
+#include <string>
+
+#include "sdf/Element.hh"
+#include "sdf/Error.hh"
+#include "sdf/ParserConfig.hh"
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  // Forward declarations.
+  class SchemaValidatorPrivate;
+
+  /// \brief Validates documents against the structure of the SDFormat
+  /// specification in one pass, without building an element tree or
+  /// running an external schema tool.
+  ///
+  /// The schema is compiled from the description tables of the spec that
+  /// are built into the library, once per version for the whole process,
+  /// so validators are cheap to create and copy, and a validator can be
+  /// used from several threads at the same time.
+  ///
+  /// A document is valid when:
+  /// - every element and attribute is defined by the spec, except names
+  ///   with a namespace prefix, such as `<custom:data>`, and the content of
+  ///   elements whose children are copied, such as `<plugin>`;
+  /// - elements whose spec cardinality is "0" or "1" appear at most once;
+  /// - required attributes are set;
+  /// - values and attributes can be read as their spec types, e.g. a pose
+  ///   is six numbers, and numbers are within the spec minimum and maximum;
+  /// - required child elements are present where the parser doesn't add
+  ///   them with their default, which is in joints other than ball joints.
+  ///
+  /// Like the parser, documents of an older version of the spec are
+  /// converted to the version of the validator before they are checked, so
+  /// a 1.6 document is valid when its 1.8 conversion is. Documents of a
+  /// newer or unknown version are invalid. Deprecated elements are
+  /// accepted. Semantic rules, such as unique names or valid frame
+  /// references, are checked by Root::Load.
+  class SDFORMAT_VISIBLE SchemaValidator
+  {
+    /// \brief Default constructor, for the spec of SDF::Version().
+    public: SchemaValidator();
+
+    /// \brief Constructor for another spec version.
+    /// \param[in] _version Spec version, such as "1.7". If the library has
+    /// no spec for it, every validation fails.
+    public: explicit SchemaValidator(const std::string &_version);
+
+    /// \brief Copy constructor
+    /// \param[in] _validator SchemaValidator to copy.
+    public: SchemaValidator(const SchemaValidator &_validator);
+
+    /// \brief Move constructor
+    /// \param[in] _validator SchemaValidator to move.
+    public: SchemaValidator(SchemaValidator &&_validator) noexcept;
+
+    /// \brief Move assignment operator.
+    /// \param[in] _validator SchemaValidator to move.
+    /// \return Reference to this.
+    public: SchemaValidator &operator=(SchemaValidator &&_validator) noexcept;
+
+    /// \brief Copy assignment operator.
+    /// \param[in] _validator SchemaValidator to copy.
+    /// \return Reference to this.
+    public: SchemaValidator &operator=(const SchemaValidator &_validator);
+
+    /// \brief Destructor
+    public: ~SchemaValidator();
+
+    /// \brief Get the spec version of the validator.
+    /// \return The version given to the constructor, or SDF::Version().
+    public: const std::string &Version() const;
+
+    /// \brief Get the number of distinct element types of the compiled
+    /// schema of a version, compiling it if needed.
+    /// \param[in] _version Spec version, such as "1.8".
+    /// \return Number of element types, or 0 if the library has no spec
+    /// for _version.
+    public: static std::size_t ElementTypeCount(const std::string &_version);
+
+    /// \brief Validate an XML document with the default configuration.
+    /// \param[in] _xml The XML text.
+    /// \return The errors. An empty vector means the document is valid.
+    public: Errors ValidateString(const std::string &_xml) const;
+
+    /// \brief Validate an XML document, or a bare <model>, <actor>,
+    /// <light> or <world> fragment.
+    /// \param[in] _xml The XML text.
+    /// \param[in] _config Parser configuration, of which the maximum
+    /// number of errors is used.
+    /// \return The errors, which include the line of each element. An
+    /// empty vector means the document is valid.
+    public: Errors ValidateString(const std::string &_xml,
+                const ParserConfig &_config) const;
+
+    /// \brief Validate an XML file with the default configuration.
+    /// \param[in] _path Path of the file.
+    /// \return The errors. An empty vector means the document is valid.
+    public: Errors ValidateFile(const std::string &_path) const;
+
+    /// \brief Validate an XML file.
+    /// \param[in] _path Path of the file.
+    /// \param[in] _config Parser configuration, of which the maximum
+    /// number of errors is used.
+    /// \return The errors, with a FILE_READ error if the file can't be
+    /// read or parsed. An empty vector means the document is valid.
+    public: Errors ValidateFile(const std::string &_path,
+                const ParserConfig &_config) const;
+
+    /// \brief Validate an element tree with the default configuration.
+    /// \param[in] _elem Root of the tree.
+    /// \return The errors. An empty vector means the tree is valid.
+    public: Errors Validate(const ElementPtr &_elem) const;
+
+    /// \brief Validate an element tree, such as one that was built or
+    /// modified in code. The tree is checked like a document, with the
+    /// values and the attributes that are set. Element trees are not
+    /// converted, so an <sdf> element must have the version of the
+    /// validator.
+    /// \param[in] _elem Root of the tree, an <sdf> element or one of its
+    /// children such as <model>.
+    /// \param[in] _config Parser configuration, of which the maximum
+    /// number of errors is used.
+    /// \return The errors. An empty vector means the tree is valid.
+    public: Errors Validate(const ElementPtr &_elem,
+                const ParserConfig &_config) const;
+
+    /// \brief Private data pointer.
+    private: SchemaValidatorPrivate *dataPtr = nullptr;
+  };
+  }
+}
+#endif
@@ -23,6 +23,7 @@
 
 #include <sdf/Error.hh>
 #include <sdf/Element.hh>
+#include <sdf/PoseGraphSnapshot.hh>
 #include <sdf/sdf_config.h>
 #include "sdf/system_util.hh"
 
@@ -73,6 +74,22 @@ namespace sdf
     public: Errors Resolve(ignition::math::Pose3d &_pose,
                            const std::string &_resolveTo = "") const;
 
+    /// \brief Resolve pose of this object with respect to another named
+    /// frame, from a snapshot of the graph of this object instead of the
+    /// live graph. The snapshot is read without locks, so any number of
+    /// threads can resolve poses from it. If there are any errors resolving
+    /// the pose, the output will not be modified.
+    /// \param[out] _pose The resolved pose.
+    /// \param[in] _snapshot Snapshot taken of the world or model that this
+    /// object belongs to, or of the model that contains it. The frames must
+    /// be in the snapshot.
+    /// \param[in] _resolveTo The pose will be resolved with respect to this
+    /// frame. If unset or empty, the default resolve-to frame will be used.
+    /// \return Errors in resolving pose.
+    public: Errors Resolve(ignition::math::Pose3d &_pose,
+                           const PoseGraphSnapshot &_snapshot,
+                           const std::string &_resolveTo = "") const;
+
     /// \brief Private constructor.
     /// \param[in] _pose Raw pose of object.
     /// \param[in] _relativeTo Name of frame in graph relative-to which the
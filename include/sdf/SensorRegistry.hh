@@ -0,0 +1,137 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_SENSOR_REGISTRY_HH_
+#define SDF_SENSOR_REGISTRY_HH_
+
+#include <cstddef>
+#include <limits>
+#include <string>
+
+#include "sdf/Sensor.hh"
+#include "sdf/Span.hh"
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  // Forward declarations.
+  class Link;
+  class Model;
+  class SensorRegistryPrivate;
+
+  /// \brief A link that has sensors, in a SensorRegistry.
+  struct SensorRegistryLink
+  {
+    /// \brief Scoped name of the link, such as "model::link".
+    std::string name;
+
+    /// \brief The link.
+    const Link *link = nullptr;
+  };
+
+  /// \brief A sensor of a SensorRegistry.
+  struct SensorRegistryEntry
+  {
+    /// \brief Scoped name of the sensor, such as "model::link::camera".
+    std::string name;
+
+    /// \brief The sensor.
+    const Sensor *sensor = nullptr;
+
+    /// \brief Index of the link of the sensor in SensorRegistry::Links().
+    std::size_t link = 0;
+  };
+
+  /// \brief The sensors of the models of a world, grouped by type, listed
+  /// once when the world is loaded so that a sensor system can start, or
+  /// find the sensors of a type, without walking the models and links.
+  ///
+  /// The sensors of each type are adjacent and in the order of the
+  /// entities of the world: each model before its nested models, and the
+  /// links of a model in order. The links that have sensors are listed in
+  /// the same order. The entries point into the DOM objects the registry
+  /// was built from, so they are valid as long as those objects are not
+  /// modified or destroyed. World keeps its registry up to date, see
+  /// World::Sensors().
+  class SDFORMAT_VISIBLE SensorRegistry
+  {
+    /// \brief Index used when there is no entry.
+    public: static constexpr std::size_t kInvalidIndex =
+                std::numeric_limits<std::size_t>::max();
+
+    /// \brief Default constructor, for an empty registry.
+    public: SensorRegistry();
+
+    /// \brief Copy constructor. The copy points to the same objects.
+    /// \param[in] _registry SensorRegistry to copy.
+    public: SensorRegistry(const SensorRegistry &_registry);
+
+    /// \brief Move constructor
+    /// \param[in] _registry SensorRegistry to move.
+    public: SensorRegistry(SensorRegistry &&_registry) noexcept;
+
+    /// \brief Move assignment operator.
+    /// \param[in] _registry SensorRegistry to move.
+    /// \return Reference to this.
+    public: SensorRegistry &operator=(SensorRegistry &&_registry) noexcept;
+
+    /// \brief Copy assignment operator.
+    /// \param[in] _registry SensorRegistry to copy.
+    /// \return Reference to this.
+    public: SensorRegistry &operator=(const SensorRegistry &_registry);
+
+    /// \brief Destructor
+    public: ~SensorRegistry();
+
+    /// \brief List the sensors of models and of their nested models,
+    /// replacing the previous content.
+    /// \param[in] _models The models, such as World::Models(). Their names
+    /// start the scoped names.
+    public: void Build(Span<const Model> _models);
+
+    /// \brief Get all the sensors.
+    /// \return The sensors, type by type, in increasing order of
+    /// SensorType.
+    public: Span<const SensorRegistryEntry> Sensors() const;
+
+    /// \brief Get the sensors of a type.
+    /// \param[in] _type Type of the sensors.
+    /// \return The sensors of the type, in the order of the world, or an
+    /// empty span if there are none.
+    public: Span<const SensorRegistryEntry> SensorsOfType(
+                SensorType _type) const;
+
+    /// \brief Find a sensor by scoped name.
+    /// \param[in] _name Scoped name, such as "model::link::camera".
+    /// \return The index of the sensor in Sensors(), or kInvalidIndex if
+    /// there is none.
+    public: std::size_t SensorByScopedName(const std::string &_name) const;
+
+    /// \brief Get the links that have sensors.
+    /// \return The links, in the order of the world.
+    public: Span<const SensorRegistryLink> Links() const;
+
+    /// \brief Private data pointer.
+    private: SensorRegistryPrivate *dataPtr = nullptr;
+  };
+  }
+}
+#endif
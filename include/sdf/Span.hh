@@ -0,0 +1,104 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_SPAN_HH_
+#define SDF_SPAN_HH_
+
+#include <cstddef>
+
+#include "sdf/sdf_config.h"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief A view of a contiguous array of DOM objects, such as the links
+  /// of a model, that can be iterated without a function call per object.
+  ///
+  /// A span doesn't own its objects. It is valid until the object it was
+  /// taken from is destroyed, or until children are added to it or removed
+  /// from it, like the pointers returned by the ByIndex functions.
+  template<typename T>
+  class Span
+  {
+    /// \brief Type of the iterators.
+    public: using iterator = T *;
+
+    /// \brief Default constructor, for an empty span.
+    public: constexpr Span() = default;
+
+    /// \brief Constructor.
+    /// \param[in] _data First object.
+    /// \param[in] _size Number of objects.
+    public: constexpr Span(T *_data, std::size_t _size)
+            : data(_data), size(_size)
+    {
+    }
+
+    /// \brief Get an iterator to the first object.
+    /// \return Pointer to the first object.
+    public: constexpr T *begin() const
+    {
+      return this->data;
+    }
+
+    /// \brief Get an iterator after the last object.
+    /// \return Pointer after the last object.
+    public: constexpr T *end() const
+    {
+      return this->data + this->size;
+    }
+
+    /// \brief Get the objects.
+    /// \return Pointer to the first object, or nullptr if there is none.
+    public: constexpr T *Data() const
+    {
+      return this->data;
+    }
+
+    /// \brief Get the number of objects.
+    /// \return Number of objects.
+    public: constexpr std::size_t Size() const
+    {
+      return this->size;
+    }
+
+    /// \brief Get whether there are no objects.
+    /// \return True if Size() is zero.
+    public: constexpr bool Empty() const
+    {
+      return this->size == 0;
+    }
+
+    /// \brief Get an object, without checking the index.
+    /// \param[in] _index Index of the object, less than Size().
+    /// \return Reference to the object.
+    public: constexpr T &operator[](std::size_t _index) const
+    {
+      return this->data[_index];
+    }
+
+    /// \brief First object.
+    private: T *data = nullptr;
+
+    /// \brief Number of objects.
+    private: std::size_t size = 0;
+  };
+  }
+}
+#endif
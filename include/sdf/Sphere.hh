@@ -17,6 +17,7 @@
 #ifndef SDF_SPHERE_HH_
 #define SDF_SPHERE_HH_
 
+#include <ignition/math/AxisAlignedBox.hh>
 #include <ignition/math/Sphere.hh>
 
 #include <sdf/Error.hh>
@@ -90,6 +91,16 @@ namespace sdf
     /// not been called.
     public: sdf::ElementPtr Element() const;
 
+    /// \brief Get the axis aligned bounding box of the sphere, relative to
+    /// its frame.
+    /// \return The smallest box that contains the sphere.
+    public: ignition::math::AxisAlignedBox AxisAlignedBox() const;
+
+    /// \brief Get the radius of the smallest sphere centered on the origin
+    /// of the sphere frame that contains the sphere.
+    /// \return The radius in meters.
+    public: double BoundingRadius() const;
+
     /// \brief Private data pointer.
     private: SpherePrivate *dataPtr;
   };
@@ -0,0 +1,265 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_STATE_READER_HH_
+#define SDF_STATE_READER_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <string>
+
+#include <ignition/math/Pose3.hh>
+
+#include "sdf/Error.hh"
+#include "sdf/Types.hh"
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  // Forward declare private data classes.
+  class StateFramePrivate;
+  class StateReaderPrivate;
+
+  /// \brief The model and link poses and velocities of a single <state>
+  /// element, stored as parallel arrays. Models and links are listed in
+  /// document order. Names of nested models and of links are scoped by
+  /// their parent models, e.g. "outer::inner::link".
+  ///
+  /// A StateFrame keeps its storage when it is refilled, so reading every
+  /// frame of a log into the same object does not allocate once the
+  /// largest frame has been seen.
+  ///
+  /// Frames are filled by StateReader, or by the application with AddModel
+  /// and AddLink before writing them with StateWriter.
+  class SDFORMAT_VISIBLE StateFrame
+  {
+    /// \brief Index used for the parent of a top level model, and returned
+    /// when an entry could not be added.
+    public: static constexpr std::size_t kInvalidIndex =
+                std::numeric_limits<std::size_t>::max();
+
+    /// \brief Default constructor
+    public: StateFrame();
+
+    /// \brief Copy constructor
+    /// \param[in] _frame StateFrame to copy.
+    public: StateFrame(const StateFrame &_frame);
+
+    /// \brief Move constructor
+    /// \param[in] _frame StateFrame to move.
+    public: StateFrame(StateFrame &&_frame) noexcept;
+
+    /// \brief Move assignment operator.
+    /// \param[in] _frame StateFrame to move.
+    /// \return Reference to this.
+    public: StateFrame &operator=(StateFrame &&_frame) noexcept;
+
+    /// \brief Copy assignment operator.
+    /// \param[in] _frame StateFrame to copy.
+    /// \return Reference to this.
+    public: StateFrame &operator=(const StateFrame &_frame);
+
+    /// \brief Destructor
+    public: ~StateFrame();
+
+    /// \brief Remove all models and links and reset the times. Storage is
+    /// kept for reuse.
+    public: void Clear();
+
+    /// \brief Get the name of the world the state applies to.
+    /// \return The world_name attribute of the state.
+    public: const std::string &WorldName() const;
+
+    /// \brief Set the name of the world the state applies to.
+    /// \param[in] _name Name of the world.
+    public: void SetWorldName(const std::string &_name);
+
+    /// \brief Get the simulation time stamp.
+    /// \return The sim_time of the state.
+    public: const sdf::Time &SimTime() const;
+
+    /// \brief Set the simulation time stamp.
+    /// \param[in] _time The sim_time of the state.
+    public: void SetSimTime(const sdf::Time &_time);
+
+    /// \brief Get the wall time stamp.
+    /// \return The wall_time of the state.
+    public: const sdf::Time &WallTime() const;
+
+    /// \brief Set the wall time stamp.
+    /// \param[in] _time The wall_time of the state.
+    public: void SetWallTime(const sdf::Time &_time);
+
+    /// \brief Get the real time stamp.
+    /// \return The real_time of the state.
+    public: const sdf::Time &RealTime() const;
+
+    /// \brief Set the real time stamp.
+    /// \param[in] _time The real_time of the state.
+    public: void SetRealTime(const sdf::Time &_time);
+
+    /// \brief Get the number of simulation iterations.
+    /// \return The iterations of the state.
+    public: std::uint64_t Iterations() const;
+
+    /// \brief Set the number of simulation iterations.
+    /// \param[in] _iterations The iterations of the state.
+    public: void SetIterations(std::uint64_t _iterations);
+
+    /// \brief Add a model state. Nested models have to be added after
+    /// their parent model.
+    /// \param[in] _name Name of the model, without the name of its parent.
+    /// \param[in] _pose Pose of the model.
+    /// \param[in] _parent Index of the parent model, or kInvalidIndex for
+    /// a top level model.
+    /// \return Index of the new model, or kInvalidIndex if _parent is not
+    /// a valid model index.
+    public: std::size_t AddModel(const std::string &_name,
+                const ignition::math::Pose3d &_pose,
+                std::size_t _parent = kInvalidIndex);
+
+    /// \brief Add a link state.
+    /// \param[in] _model Index of the model that contains the link.
+    /// \param[in] _name Name of the link, without the name of its model.
+    /// \param[in] _pose Pose of the link.
+    /// \param[in] _velocity Velocity of the link.
+    /// \return Index of the new link, or kInvalidIndex if _model is not a
+    /// valid model index.
+    public: std::size_t AddLink(std::size_t _model, const std::string &_name,
+                const ignition::math::Pose3d &_pose,
+                const ignition::math::Pose3d &_velocity =
+                    ignition::math::Pose3d::Zero);
+
+    /// \brief Get the number of model states, including nested models.
+    /// \return Number of models.
+    public: std::size_t ModelCount() const;
+
+    /// \brief Get the scoped name of a model.
+    /// \param[in] _index Index of the model, less than ModelCount().
+    /// \return Name of the model, or an empty string if _index is out of
+    /// range.
+    public: const std::string &ModelName(std::size_t _index) const;
+
+    /// \brief Get the model poses. A model without a <pose> has a zero
+    /// pose.
+    /// \return Array of ModelCount() poses.
+    public: const ignition::math::Pose3d *ModelPoses() const;
+
+    /// \brief Get the model poses, to update them in place.
+    /// \return Array of ModelCount() poses.
+    public: ignition::math::Pose3d *ModelPoses();
+
+    /// \brief Get the index of the parent model of each model.
+    /// \return Array of ModelCount() model indices, with kInvalidIndex for
+    /// top level models.
+    public: const std::size_t *ModelParents() const;
+
+    /// \brief Get the number of link states.
+    /// \return Number of links.
+    public: std::size_t LinkCount() const;
+
+    /// \brief Get the scoped name of a link.
+    /// \param[in] _index Index of the link, less than LinkCount().
+    /// \return Name of the link, or an empty string if _index is out of
+    /// range.
+    public: const std::string &LinkName(std::size_t _index) const;
+
+    /// \brief Get the index of the model that contains each link.
+    /// \return Array of LinkCount() model indices.
+    public: const std::size_t *LinkModels() const;
+
+    /// \brief Get the link poses. A link without a <pose> has a zero pose.
+    /// \return Array of LinkCount() poses.
+    public: const ignition::math::Pose3d *LinkPoses() const;
+
+    /// \brief Get the link poses, to update them in place.
+    /// \return Array of LinkCount() poses.
+    public: ignition::math::Pose3d *LinkPoses();
+
+    /// \brief Get the link velocities, with the linear velocity as the
+    /// position and the angular velocity as the roll, pitch and yaw of
+    /// each pose. A link without a <velocity> has a zero velocity.
+    /// \return Array of LinkCount() velocities.
+    public: const ignition::math::Pose3d *LinkVelocities() const;
+
+    /// \brief Get the link velocities, to update them in place.
+    /// \return Array of LinkCount() velocities.
+    public: ignition::math::Pose3d *LinkVelocities();
+
+    /// \brief Allow StateReader to fill the frame.
+    friend class StateReader;
+
+    /// \brief Private data pointer.
+    private: StateFramePrivate *dataPtr = nullptr;
+  };
+
+  /// \brief Reads <state> elements one at a time from a stream, such as a
+  /// recorded simulation log, without building sdf::Element trees.
+  ///
+  /// Everything outside of <state> elements is skipped, so states can be
+  /// wrapped in <sdf>, <world> or plain text log chunks. Only the time
+  /// stamps, the iteration count and model and link poses and velocities
+  /// are read. Insertions, deletions, joint, light and collision states
+  /// are ignored. Use sdf::readString on the text of a state when the full
+  /// description is needed.
+  ///
+  /// The stream is read in blocks, so memory use depends on the size of a
+  /// single state rather than on the size of the log.
+  class SDFORMAT_VISIBLE StateReader
+  {
+    /// \brief Constructor
+    /// \param[in] _input Stream to read from. It has to stay valid for the
+    /// lifetime of the reader.
+    public: explicit StateReader(std::istream &_input);
+
+    /// \brief Copy constructor is deleted, because the reader consumes its
+    /// stream.
+    public: StateReader(const StateReader &_reader) = delete;
+
+    /// \brief Copy assignment operator is deleted.
+    /// \param[in] _reader StateReader to copy.
+    /// \return Reference to this.
+    public: StateReader &operator=(const StateReader &_reader) = delete;
+
+    /// \brief Destructor
+    public: ~StateReader();
+
+    /// \brief Read the next <state> element.
+    /// \param[out] _frame Frame to fill. Its previous content is replaced.
+    /// \param[out] _errors Errors encountered while parsing the state. The
+    /// state is skipped, and reading can continue with the next one.
+    /// \return True if a state was found, false at the end of the stream
+    /// or if the state could not be parsed.
+    public: bool Next(StateFrame &_frame, Errors &_errors);
+
+    /// \brief Get the number of states found so far, including states that
+    /// could not be parsed.
+    /// \return Number of states.
+    public: std::uint64_t Count() const;
+
+    /// \brief Private data pointer.
+    private: StateReaderPrivate *dataPtr = nullptr;
+  };
+  }
+}
+#endif
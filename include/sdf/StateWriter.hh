@@ -0,0 +1,97 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_STATE_WRITER_HH_
+#define SDF_STATE_WRITER_HH_
+
+#include <cstdint>
+#include <iostream>
+
+#include "sdf/StateReader.hh"
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  // Forward declare private data class.
+  class StateWriterPrivate;
+
+  /// \brief Incremental writer of <state> elements.
+  ///
+  /// Each call to Write emits one <state> element with the time stamps and
+  /// iterations of the frame, followed by the models and links whose pose
+  /// changed since the last state written. A model is also written when
+  /// one of its links or nested models is, so that the element stays
+  /// nested like a full state. Written models always include their pose.
+  /// The first state, and the first state after Reset, is written in full.
+  ///
+  /// Only poses are compared and written. Removed models and links are not
+  /// recorded, and models or links that appear again are written in full.
+  ///
+  /// The text is formatted directly into the output stream, so writing a
+  /// frame does not build any Element or intermediate string.
+  class SDFORMAT_VISIBLE StateWriter
+  {
+    /// \brief Constructor
+    /// \param[in] _output Stream to write to. It has to stay valid for the
+    /// lifetime of the writer.
+    public: explicit StateWriter(std::ostream &_output);
+
+    /// \brief Copy constructor is deleted, because the writer tracks what
+    /// has been written to its stream.
+    public: StateWriter(const StateWriter &_writer) = delete;
+
+    /// \brief Copy assignment operator is deleted.
+    /// \param[in] _writer StateWriter to copy.
+    /// \return Reference to this.
+    public: StateWriter &operator=(const StateWriter &_writer) = delete;
+
+    /// \brief Destructor
+    public: ~StateWriter();
+
+    /// \brief Write the changes of a frame as a <state> element.
+    /// \param[in] _frame Frame to write.
+    public: void Write(const StateFrame &_frame);
+
+    /// \brief Forget the states written so far, so that the next state is
+    /// written in full.
+    public: void Reset();
+
+    /// \brief Set the tolerance used to compare poses. Pose positions and
+    /// rotations that differ from the last written value by no more than
+    /// the tolerance are not written again. The default is 0, which writes
+    /// every change.
+    /// \param[in] _tolerance Tolerance used to compare poses.
+    public: void SetTolerance(double _tolerance);
+
+    /// \brief Get the tolerance used to compare poses.
+    /// \return The tolerance.
+    public: double Tolerance() const;
+
+    /// \brief Get the number of states written so far.
+    /// \return Number of states.
+    public: std::uint64_t Count() const;
+
+    /// \brief Private data pointer.
+    private: StateWriterPrivate *dataPtr = nullptr;
+  };
+  }
+}
+#endif
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_TEXT_RANGE_HH_
+#define SDF_TEXT_RANGE_HH_
+
+#include <cstddef>
+
+#include "sdf/sdf_config.h"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief Range of the text of a document that an element was read from,
+  /// from the '<' of its start tag to the '>' of its end tag, or of its
+  /// empty element tag. Offsets count bytes from the start of the document,
+  /// lines start at 1, and columns count bytes from 1 at the start of a
+  /// line. \sa ParserConfig::SetRecordSourceRanges
+  struct TextRange
+  {
+    /// \brief Offset of the '<' of the start tag.
+    std::size_t begin = 0;
+
+    /// \brief Offset one past the '>' of the end tag.
+    std::size_t end = 0;
+
+    /// \brief Line of begin, or 0 if the element has no range, e.g. because
+    /// it was added with its default value or read from an included file.
+    unsigned int beginLine = 0;
+
+    /// \brief Column of begin.
+    unsigned int beginColumn = 0;
+
+    /// \brief Line of end.
+    unsigned int endLine = 0;
+
+    /// \brief Column of end.
+    unsigned int endColumn = 0;
+  };
+
+  /// \brief An edit of the text of a document: the bytes [begin, oldEnd) of
+  /// the old text are replaced by the bytes [begin, newEnd) of the new
+  /// text. An insertion has oldEnd equal to begin, and a deletion has
+  /// newEnd equal to begin. \sa Root::Reparse
+  struct TextEdit
+  {
+    /// \brief Offset of the first byte that changed, in both texts.
+    std::size_t begin = 0;
+
+    /// \brief Offset one past the replaced bytes, in the old text.
+    std::size_t oldEnd = 0;
+
+    /// \brief Offset one past the inserted bytes, in the new text.
+    std::size_t newEnd = 0;
+  };
+  }
+}
+#endif
@@ -22,6 +22,7 @@
 #include <cstdint>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <sdf/sdf_config.h>
@@ -68,6 +69,140 @@ namespace sdf
   std::vector<std::string> split(const std::string &_str,
                                  const std::string &_splitter);
 
+  /// \brief Split a string using the delimiter in splitter, without
+  /// copying the tokens.
+  /// \param[in] _str The string to split.
+  /// \param[in] _splitter The delimiter to use.
+  /// \return Views of the tokens in _str, as returned by split.
+  SDFORMAT_VISIBLE
+  std::vector<std::string_view> splitView(std::string_view _str,
+                                          std::string_view _splitter);
+
+  /// \brief Range over the tokens of a string split with a delimiter. The
+  /// tokens are views of the string, found one at a time as the range is
+  /// iterated, so nothing is allocated:
+  ///
+  ///     for (std::string_view token : sdf::SplitRange(_str, " "))
+  ///
+  /// The tokens are the same as the ones returned by split, so there is
+  /// always at least one, and empty tokens are kept. The string and the
+  /// delimiter must outlive the range.
+  class SplitRange
+  {
+    /// \brief Forward iterator over the tokens.
+    public: class Iterator
+    {
+      /// \brief Constructor of the end iterator.
+      public: Iterator() = default;
+
+      /// \brief Constructor of an iterator on the first token.
+      /// \param[in] _str The string to split.
+      /// \param[in] _splitter The delimiter to use.
+      public: Iterator(std::string_view _str, std::string_view _splitter)
+              : str(_str), splitter(_splitter), done(false)
+      {
+        this->Find();
+      }
+
+      /// \brief Get the current token.
+      /// \return View of the token in the string.
+      public: std::string_view operator*() const
+      {
+        return this->str.substr(this->begin, this->end - this->begin);
+      }
+
+      /// \brief Move to the next token.
+      /// \return This iterator.
+      public: Iterator &operator++()
+      {
+        if (this->end == std::string_view::npos)
+        {
+          this->done = true;
+        }
+        else
+        {
+          this->begin = this->end + this->splitter.size();
+          this->Find();
+        }
+        return *this;
+      }
+
+      /// \brief Equality operator.
+      /// \param[in] _other Iterator of the same range, or the end iterator.
+      /// \return True if both iterators are at the same token.
+      public: bool operator==(const Iterator &_other) const
+      {
+        return this->done == _other.done &&
+            (this->done || this->begin == _other.begin);
+      }
+
+      /// \brief Inequality operator.
+      /// \param[in] _other Iterator of the same range, or the end iterator.
+      /// \return True if the iterators are at different tokens.
+      public: bool operator!=(const Iterator &_other) const
+      {
+        return !(*this == _other);
+      }
+
+      /// \brief Find the end of the token that starts at begin.
+      private: void Find()
+      {
+        this->end = this->splitter.empty() ? std::string_view::npos :
+            this->str.find(this->splitter, this->begin);
+      }
+
+      /// \brief The string to split.
+      private: std::string_view str;
+
+      /// \brief The delimiter.
+      private: std::string_view splitter;
+
+      /// \brief Start of the current token.
+      private: std::size_t begin = 0;
+
+      /// \brief End of the current token, npos for the last one.
+      private: std::size_t end = std::string_view::npos;
+
+      /// \brief True once past the last token.
+      private: bool done = true;
+    };
+
+    /// \brief Constructor.
+    /// \param[in] _str The string to split.
+    /// \param[in] _splitter The delimiter to use.
+    public: SplitRange(std::string_view _str, std::string_view _splitter)
+            : str(_str), splitter(_splitter)
+    {
+    }
+
+    /// \brief Get an iterator on the first token.
+    /// \return The iterator.
+    public: Iterator begin() const
+    {
+      return Iterator(this->str, this->splitter);
+    }
+
+    /// \brief Get the end iterator.
+    /// \return The iterator.
+    public: Iterator end() const
+    {
+      return Iterator();
+    }
+
+    /// \brief The string to split.
+    private: std::string_view str;
+
+    /// \brief The delimiter.
+    private: std::string_view splitter;
+  };
+
+  /// \brief Trim leading and trailing whitespace from a string, without
+  /// copying it.
+  /// \param[in] _in The string to trim.
+  /// \return View of the trimmed value in _in.
+  SDFORMAT_VISIBLE
+  std::string_view trimView(std::string_view _in);
+
   /// \brief Trim leading and trailing whitespace from a string.
   /// \param[in] _in The string to trim.
   /// \return A string containing the trimmed value.
@@ -227,7 +362,7 @@ namespace sdf
   /// \brief Transforms a string to its lowercase equivalent
   /// \param[in] _in String to convert to lowercase
   /// \return Lowercase equilvalent of _in.
-  std::string SDFORMAT_VISIBLE lowercase(const std::string &_in);
+  std::string SDFORMAT_VISIBLE lowercase(std::string_view _in);
   }
 }
 #endif
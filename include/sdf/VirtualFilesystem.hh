@@ -0,0 +1,182 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_VIRTUAL_FILESYSTEM_HH_
+#define SDF_VIRTUAL_FILESYSTEM_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "sdf/Error.hh"
+#include "sdf/Types.hh"
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  // Forward declarations.
+  class ArchiveFilesystemPrivate;
+
+  /// \brief Content of a file opened with VirtualFilesystem::Open.
+  class SDFORMAT_VISIBLE VirtualFile
+  {
+    /// \brief Destructor. Releases the content.
+    public: virtual ~VirtualFile();
+
+    /// \brief Get the content of the file. It is not null terminated, and
+    /// stays valid until the file is destroyed.
+    /// \return Pointer to the first byte of the file.
+    public: virtual const char *Data() const = 0;
+
+    /// \brief Get the size of the file.
+    /// \return Size in bytes.
+    public: virtual std::size_t Size() const = 0;
+  };
+
+  /// \brief Size and modification time of a file, which tell whether a
+  /// file that was read before has changed.
+  struct VirtualFileStatus
+  {
+    /// \brief Size of the file in bytes.
+    std::int64_t size = 0;
+
+    /// \brief Modification time, in nanoseconds where available.
+    std::int64_t modified = 0;
+  };
+
+  /// \brief Files and directories that the parser finds and reads models
+  /// in. ParserConfig::SetFilesystem makes the parser use one for findFile,
+  /// model directories and their model.config, and the files it reads,
+  /// instead of the files of the operating system.
+  ///
+  /// The functions can be called from several threads at once.
+  class SDFORMAT_VISIBLE VirtualFilesystem
+  {
+    /// \brief Destructor
+    public: virtual ~VirtualFilesystem();
+
+    /// \brief Check whether a file or directory exists.
+    /// \param[in] _path Path of the file or directory.
+    /// \return True if it exists.
+    public: virtual bool Exists(const std::string &_path) const = 0;
+
+    /// \brief Check whether a path is a directory.
+    /// \param[in] _path Path to check.
+    /// \return True if _path is a directory.
+    public: virtual bool IsDirectory(const std::string &_path) const = 0;
+
+    /// \brief Get the size and modification time of a file.
+    /// \param[in] _path Path of the file.
+    /// \param[out] _status Set to the status of the file.
+    /// \return True if the file exists.
+    public: virtual bool Stat(const std::string &_path,
+                              VirtualFileStatus &_status) const = 0;
+
+    /// \brief Open a file for reading. Implementations should map or
+    /// reference content they already hold rather than copying it.
+    /// \param[in] _path Path of the file.
+    /// \return The file, or nullptr if it can not be read.
+    public: virtual std::unique_ptr<VirtualFile> Open(
+                const std::string &_path) const = 0;
+
+    /// \brief Get the files of the operating system, which the parser uses
+    /// when no other filesystem is set.
+    /// \return The native filesystem.
+    public: static const VirtualFilesystem &Native();
+  };
+
+  /// \brief A read-only filesystem held in a single archive file, so that
+  /// packed models can be loaded without extracting them to disk.
+  ///
+  /// The archive is memory-mapped and indexed when it is loaded: the files
+  /// it holds are then found in constant time and read without being
+  /// copied. Its content appears under a mount point, such as
+  /// "/opt/models"; paths outside of the mount point are looked up in the
+  /// native filesystem, so that installed spec files and other models
+  /// are still found.
+  ///
+  /// Archives are created from a directory with Create.
+  class SDFORMAT_VISIBLE ArchiveFilesystem : public VirtualFilesystem
+  {
+    /// \brief Default constructor. The filesystem is empty until Load is
+    /// called.
+    public: ArchiveFilesystem();
+
+    /// \brief Copy constructor is deleted, because the object owns the
+    /// mapping of the archive.
+    /// \param[in] _filesystem ArchiveFilesystem to copy.
+    public: ArchiveFilesystem(const ArchiveFilesystem &_filesystem) = delete;
+
+    /// \brief Copy assignment operator is deleted.
+    /// \param[in] _filesystem ArchiveFilesystem to copy.
+    /// \return Reference to this.
+    public: ArchiveFilesystem &operator=(
+                const ArchiveFilesystem &_filesystem) = delete;
+
+    /// \brief Destructor
+    public: ~ArchiveFilesystem() override;
+
+    /// \brief Map and index an archive, replacing any archive loaded
+    /// before. It must not be called while the filesystem is in use.
+    /// \param[in] _archive Path of the archive file.
+    /// \param[in] _mountPoint Directory the content of the archive appears
+    /// in, such as "/opt/models".
+    /// \return Errors, which is a vector of Error objects. Each Error
+    /// includes an error code and message. An empty vector indicates no
+    /// error.
+    public: Errors Load(const std::string &_archive,
+                        const std::string &_mountPoint);
+
+    /// \brief Pack the files of a directory and of its subdirectories into
+    /// an archive.
+    /// \param[in] _directory Directory to pack.
+    /// \param[in] _archive Path of the archive file to write.
+    /// \return Errors, which is a vector of Error objects. Each Error
+    /// includes an error code and message. An empty vector indicates no
+    /// error.
+    public: static Errors Create(const std::string &_directory,
+                                 const std::string &_archive);
+
+    /// \brief Get the number of files in the archive.
+    /// \return Number of files.
+    public: std::size_t FileCount() const;
+
+    // Documentation inherited.
+    public: bool Exists(const std::string &_path) const override;
+
+    // Documentation inherited.
+    public: bool IsDirectory(const std::string &_path) const override;
+
+    // Documentation inherited.
+    public: bool Stat(const std::string &_path,
+                      VirtualFileStatus &_status) const override;
+
+    // Documentation inherited.
+    public: std::unique_ptr<VirtualFile> Open(
+                const std::string &_path) const override;
+
+    /// \brief Private data pointer.
+    private: ArchiveFilesystemPrivate *dataPtr = nullptr;
+  };
+  }
+}
+#endif
@@ -17,6 +17,8 @@
 #ifndef SDF_VISUAL_HH_
 #define SDF_VISUAL_HH_
 
+#include <cstdint>
+#include <limits>
 #include <memory>
 #include <string>
 #include <ignition/math/Pose3.hh>
@@ -40,11 +42,18 @@ namespace sdf
   // Forward declarations.
   class VisualPrivate;
   class Geometry;
+  class MaterialTable;
+  class MeshRegistry;
   struct PoseRelativeToGraph;
   template <typename T> class ScopedGraph;
 
   class SDFORMAT_VISIBLE Visual
   {
+    /// \brief Material index of a visual whose material is not in the
+    /// material table of a world.
+    public: static constexpr uint64_t kInvalidMaterialIndex =
+                std::numeric_limits<uint64_t>::max();
+
     /// \brief Default constructor
     public: Visual();
 
@@ -148,13 +157,25 @@ namespace sdf
     /// \brief Get a pointer to the visual's material properties. This can
     /// be a nullptr if material properties have not been set.
     /// \return Pointer to the visual's material properties. Nullptr
-    /// indicates that material properties have not been set.
+    /// indicates that material properties have not been set. When the
+    /// material is shared through the material table of a world, changes
+    /// apply to every visual that shares it.
+    /// \sa uint64_t MaterialIndex() const
     public: sdf::Material *Material() const;
 
-    /// \brief Set the visual's material
+    /// \brief Set the visual's material. The visual gets its own copy of
+    /// the material, outside of the material table of its world.
     /// \param[in] _material The material of the visual object
     public: void SetMaterial(const sdf::Material &_material);
 
+    /// \brief Get the index of the material of the visual in the material
+    /// table of its world, which is filled when the world is loaded with
+    /// ParserConfig::ShareMaterials enabled.
+    /// \return Index for World::MaterialByIndex, or kInvalidMaterialIndex
+    /// if the material is not in a table or the visual has no material.
+    /// \sa const Material *World::MaterialByIndex(uint64_t) const
+    public: uint64_t MaterialIndex() const;
+
     /// \brief Get the visibility flags of a visual
     /// \return visibility flags
     public: uint32_t VisibilityFlags() const;
@@ -176,9 +197,30 @@ namespace sdf
     private: void SetPoseRelativeToGraph(
         sdf::ScopedGraph<PoseRelativeToGraph> _graph);
 
+    /// \brief Replace the material of the visual with the equal entry of a
+    /// material table, adding it to the table if it has no equal entry.
+    /// This is private and is intended to be called by
+    /// Link::ShareMaterials.
+    /// \param[in,out] _table Material table of the world.
+    private: void ShareMaterial(MaterialTable &_table);
+
+    /// \brief Give the visual the entry of a copy of the material table that
+    /// has the index of its material. This is private and is intended to
+    /// be called by Link::UseMaterialCopies.
+    /// \param[in] _table Copy of the material table of the world.
+    private: void UseMaterialCopy(const MaterialTable &_table);
+
+    /// \brief Share the mesh of the geometry through the mesh registry of
+    /// the Root. This is private and is intended to be called by
+    /// Link::ShareMeshes.
+    /// \param[in,out] _registry Mesh registry of the Root.
+    private: void ShareMesh(MeshRegistry &_registry);
+
     /// \brief Allow Link::SetPoseRelativeToGraph to call SetXmlParentName
-    /// and SetPoseRelativeToGraph, but Link::SetPoseRelativeToGraph is
-    /// a private function, so we need to befriend the entire class.
+    /// and SetPoseRelativeToGraph, and Link::ShareMaterials,
+    /// Link::UseMaterialCopies and Link::ShareMeshes to call ShareMaterial,
+    /// UseMaterialCopy and ShareMesh, but these are private functions, so
+    /// we need to befriend the entire class.
     friend class Link;
 
     /// \brief Private data pointer.
@@ -17,13 +17,21 @@
 #ifndef SDF_WORLD_HH_
 #define SDF_WORLD_HH_
 
+#include <memory>
 #include <string>
+#include <vector>
+#include <ignition/math/Pose3.hh>
 #include <ignition/math/Vector3.hh>
 
 #include "sdf/Atmosphere.hh"
 #include "sdf/Element.hh"
+#include "sdf/EntityTable.hh"
+#include "sdf/PoseGraphSnapshot.hh"
 #include "sdf/Gui.hh"
+#include "sdf/ParserConfig.hh"
 #include "sdf/Scene.hh"
+#include "sdf/SensorRegistry.hh"
+#include "sdf/Span.hh"
 #include "sdf/Types.hh"
 #include "sdf/sdf_config.h"
 #include "sdf/system_util.hh"
@@ -36,10 +44,17 @@ namespace sdf
 
   // Forward declare private data class.
   class Actor;
+  class DeferredGraphs;
   class Frame;
+  class Joint;
   class Light;
+  class Link;
+  class Material;
+  class MeshRegistry;
   class Model;
   class Physics;
+  class Population;
+  class StateFrame;
   class WorldPrivate;
   struct PoseRelativeToGraph;
   struct FrameAttachedToGraph;
@@ -79,6 +94,16 @@ namespace sdf
     /// an error code and message. An empty vector indicates no error.
     public: Errors Load(ElementPtr _sdf);
 
+    /// \brief Load the world based on a element pointer. This is *not* the
+    /// usual entry point. Typical usage of the SDF DOM is through the Root
+    /// object. The models, actors and lights of the world are loaded using
+    /// the number of threads given by _config.
+    /// \param[in] _sdf The SDF Element pointer
+    /// \param[in] _config Parser configuration
+    /// \return Errors, which is a vector of Error objects. Each Error includes
+    /// an error code and message. An empty vector indicates no error.
+    public: Errors Load(ElementPtr _sdf, const ParserConfig &_config);
+
     /// \brief Get the name of the world.
     /// \return Name of the world.
     public: std::string Name() const;
@@ -151,6 +176,11 @@ namespace sdf
     /// \sa uint64_t ModelCount() const
     public: const Model *ModelByIndex(const uint64_t _index) const;
 
+    /// \brief Get the models.
+    /// \return View of the models, in the order of ModelByIndex. It
+    /// is invalidated when models are added or removed.
+    public: Span<const Model> Models() const;
+
     /// \brief Get a model based on a name.
     /// \param[in] _name Name of the model.
     /// \return Pointer to the model. Nullptr if the name does not exist.
@@ -161,6 +191,20 @@ namespace sdf
     /// \return True if there exists a model with the given name.
     public: bool ModelNameExists(const std::string &_name) const;
 
+    /// \brief Get the number of distinct materials of the visuals of the
+    /// models, when the world was loaded with ParserConfig::ShareMaterials
+    /// enabled.
+    /// \return Number of materials, or 0 if materials are not shared.
+    public: uint64_t MaterialCount() const;
+
+    /// \brief Get a distinct material of the visuals of the models. Visuals
+    /// whose Visual::MaterialIndex is _index share this material.
+    /// \param[in] _index Index of the material. The index should be in the
+    /// range [0..MaterialCount()).
+    /// \return Pointer to the material. Nullptr if the index does not exist.
+    /// \sa uint64_t MaterialCount() const
+    public: const Material *MaterialByIndex(const uint64_t _index) const;
+
     /// \brief Get the number of actors.
     /// \return Number of actors contained in this World object.
     public: uint64_t ActorCount() const;
@@ -172,11 +216,39 @@ namespace sdf
     /// \sa uint64_t ActorCount() const
     public: const Actor *ActorByIndex(const uint64_t _index) const;
 
+    /// \brief Get the actors.
+    /// \return View of the actors, in the order of ActorByIndex. It
+    /// is invalidated when actors are added or removed.
+    public: Span<const Actor> Actors() const;
+
     /// \brief Get whether an actor name exists.
     /// \param[in] _name Name of the actor to check.
     /// \return True if there exists an actor with the given name.
     public: bool ActorNameExists(const std::string &_name) const;
 
+    /// \brief Get the number of populations.
+    /// \return Number of populations contained in this World object.
+    public: uint64_t PopulationCount() const;
+
+    /// \brief Get a population based on an index. The instances of a
+    /// population are not counted by ModelCount, see sdf::Population.
+    /// \param[in] _index Index of the population. The index should be in
+    /// the range [0..PopulationCount()).
+    /// \return Pointer to the population. Nullptr if the index does not
+    /// exist.
+    /// \sa uint64_t PopulationCount() const
+    public: const Population *PopulationByIndex(const uint64_t _index) const;
+
+    /// \brief Get the populations.
+    /// \return View of the populations, in the order of PopulationByIndex. It
+    /// is invalidated when populations are added or removed.
+    public: Span<const Population> Populations() const;
+
+    /// \brief Get whether a population name exists.
+    /// \param[in] _name Name of the population to check.
+    /// \return True if there exists a population with the given name.
+    public: bool PopulationNameExists(const std::string &_name) const;
+
     /// \brief Get the number of explicit frames that are immediate (not nested)
     /// children of this World object.
     /// \return Number of explicit frames contained in this World object.
@@ -191,6 +263,11 @@ namespace sdf
     /// \sa uint64_t FrameCount() const
     public: const Frame *FrameByIndex(const uint64_t _index) const;
 
+    /// \brief Get the explicit frames.
+    /// \return View of the frames, in the order of FrameByIndex. It
+    /// is invalidated when frames are added or removed.
+    public: Span<const Frame> Frames() const;
+
     /// \brief Get an explicit frame based on a name.
     /// \param[in] _name Name of the explicit frame.
     /// \return Pointer to the explicit frame. Nullptr if the name does not
@@ -202,6 +279,75 @@ namespace sdf
     /// \return True if there exists an explicit frame with the given name.
     public: bool FrameNameExists(const std::string &_name) const;
 
+    /// \brief Get a model, or a model nested in it, based on its scoped
+    /// name, such as "outer::inner". The lookup uses an index that is built
+    /// when the world is loaded, and does not walk the nested models.
+    /// \param[in] _name Scoped name of the model.
+    /// \return Pointer to the model. Nullptr if the name does not exist.
+    public: const Model *ModelByScopedName(const std::string &_name) const;
+
+    /// \brief Get a link based on its scoped name, such as
+    /// "outer::inner::link".
+    /// \param[in] _name Scoped name of the link.
+    /// \return Pointer to the link. Nullptr if the name does not exist.
+    /// \sa ModelByScopedName
+    public: const Link *LinkByScopedName(const std::string &_name) const;
+
+    /// \brief Get a joint based on its scoped name, such as
+    /// "outer::inner::joint".
+    /// \param[in] _name Scoped name of the joint.
+    /// \return Pointer to the joint. Nullptr if the name does not exist.
+    /// \sa ModelByScopedName
+    public: const Joint *JointByScopedName(const std::string &_name) const;
+
+    /// \brief Get an explicit frame based on its scoped name, such as
+    /// "outer::inner::frame". Frames of the world itself have no scope.
+    /// \param[in] _name Scoped name of the frame.
+    /// \return Pointer to the frame. Nullptr if the name does not exist.
+    /// \sa ModelByScopedName
+    public: const Frame *FrameByScopedName(const std::string &_name) const;
+
+    /// \brief Get the sensors of the models of this world, grouped by type
+    /// with their scoped names and links. The registry is built when the
+    /// world is loaded, and rebuilt when the models change or the world is
+    /// copied.
+    /// \return The sensor registry.
+    public: const SensorRegistry &Sensors() const;
+
+    /// \brief Get the IDs of the entities of this world, with the frames
+    /// they refer to resolved to IDs. Like the sensor registry, the table
+    /// is rebuilt when the models change or the world is copied, and the
+    /// IDs only depend on the content of the world.
+    /// \return The entity table.
+    public: const EntityTable &Entities() const;
+
+    /// \brief Resolve the poses of all the models of this world and of their
+    /// links, visuals, collisions, sensors, joints, frames and nested
+    /// models, followed by the frames of the world, relative to the world
+    /// frame. A single sweep of the pose graph resolves every pose, which
+    /// is equivalent to, and much cheaper than, calling
+    /// SemanticPose().Resolve() on each entity.
+    ///
+    /// Each model is listed before its entities, in the order described
+    /// by Model::ResolvePoses. The order only depends on the world, so
+    /// _names can be read once and reused.
+    /// \param[out] _poses Pose of each entity. The vector is replaced.
+    /// \param[out] _names Scoped name of each entity, such as
+    /// "model::link::visual". The vector is replaced.
+    /// \return Errors. Entities whose pose could not be resolved are still
+    /// listed, with a zero pose.
+    public: Errors ResolvePoses(std::vector<ignition::math::Pose3d> &_poses,
+                std::vector<std::string> &_names) const;
+
+    /// \brief Take an immutable snapshot of the resolved poses of the frames
+    /// of this world, including the frames of its nested models, that
+    /// threads can resolve poses from without locks, with
+    /// PoseGraphSnapshot::Resolve or SemanticPose::Resolve. The DOM must not
+    /// be modified while the snapshot is taken.
+    /// \return The snapshot, without frames if the world was not loaded
+    /// through sdf::Root.
+    public: sdf::PoseGraphSnapshot PoseSnapshot() const;
+
     /// \brief Get the number of lights.
     /// \return Number of lights contained in this World object.
     public: uint64_t LightCount() const;
@@ -213,6 +359,11 @@ namespace sdf
     /// \sa uint64_t LightCount() const
     public: const Light *LightByIndex(const uint64_t _index) const;
 
+    /// \brief Get the lights.
+    /// \return View of the lights, in the order of LightByIndex. It
+    /// is invalidated when lights are added or removed.
+    public: Span<const Light> Lights() const;
+
     /// \brief Get whether a light name exists.
     /// \param[in] _name Name of the light to check.
     /// \return True if there exists a light with the given name.
@@ -266,6 +417,11 @@ namespace sdf
     ///// \sa uint64_t PhysicsCount() const
     public: const Physics *PhysicsByIndex(const uint64_t _index) const;
 
+    /// \brief Get the physics profiles.
+    /// \return View of the physics profiles, in the order of PhysicsByIndex. It
+    /// is invalidated when physics profiles are added or removed.
+    public: Span<const Physics> PhysicsProfiles() const;
+
     /// \brief Get the default physics profile.
     /// \return Pointer to the default physics profile.
     public: const Physics *PhysicsDefault() const;
@@ -289,8 +445,65 @@ namespace sdf
     private: void SetFrameAttachedToGraph(
         sdf::ScopedGraph<FrameAttachedToGraph> _graph);
 
-    /// \brief Allow Root::Load to call SetPoseRelativeToGraph and
-    /// SetFrameAttachedToGraph
+    /// \brief Give the frame graphs of this world, to be built the first
+    /// time the contents of one of its models are accessed, or a function
+    /// that uses the graphs is called. This is private and is intended to be
+    /// called by Root::Load when ParserConfig::LazyModels is enabled.
+    /// \param[in] _graphs Graphs of this world.
+    private: void SetDeferredGraphs(
+        const std::shared_ptr<DeferredGraphs> &_graphs);
+
+    /// \brief Drop the element of this world and of its models, so that
+    /// Element returns nullptr. This is private and is intended to be called
+    /// by Root::Load when ParserConfig::ReleaseElements is enabled, once the
+    /// frame graphs that are built from the element exist.
+    private: void ReleaseElement();
+
+    /// \brief Share the meshes of the visuals and collisions of the models
+    /// through the mesh registry of the Root. This is private and is
+    /// intended to be called by Root::Load and Root::ReloadIncludes when
+    /// ParserConfig::ShareMeshes is enabled.
+    /// \param[in,out] _registry Mesh registry of the Root.
+    private: void ShareMeshes(MeshRegistry &_registry);
+
+    /// \brief Replace a model with one loaded from a new element, and
+    /// update the frame graphs and the element of the world to match. The
+    /// old model is kept if the new one fails to load or its name is used
+    /// by another model or frame. This is private and is intended to be
+    /// called by Root::ReloadIncludes.
+    /// \param[in] _name Name of the model to replace.
+    /// \param[in] _sdf The <model> element to load, without a parent.
+    /// \return Errors of loading the new model and inserting it in the frame
+    /// graphs.
+    private: Errors ReplaceModel(const std::string &_name, ElementPtr _sdf);
+
+    /// \brief Add copies of models, lights and actors of another document
+    /// to this world, and insert the models in the frame graphs of the
+    /// world as new scopes, without loading or building anything else. An
+    /// object whose name is already used in this world is skipped. This is
+    /// private and is intended to be called by Root::Merge.
+    /// \param[in] _models Models to add.
+    /// \param[in] _lights Lights to add.
+    /// \param[in] _actors Actors to add.
+    /// \return DUPLICATE_NAME errors for the skipped objects, and the errors
+    /// of inserting the models in the frame graphs.
+    private: Errors Merge(Span<const Model> _models,
+                 Span<const Light> _lights, Span<const Actor> _actors);
+
+    /// \brief Apply the model and link poses of a state to the pose graph
+    /// of this world and to the raw poses of its top level models. This is
+    /// private and is intended to be called by Root::ApplyState, since
+    /// copies of a world share its graph.
+    /// \param[in] _state State to apply.
+    /// \return Errors if the world has no graph, or for the models and
+    /// links of the state that are not in this world.
+    private: Errors ApplyState(const StateFrame &_state);
+
+    /// \brief Allow Root::Load to call SetPoseRelativeToGraph,
+    /// SetFrameAttachedToGraph, SetDeferredGraphs, ReleaseElement and
+    /// ShareMeshes,
+    /// Root::ReloadIncludes to call ReplaceModel and ShareMeshes,
+    /// Root::Merge to call Merge, and Root::ApplyState to call ApplyState
     friend class Root;
 
     /// \brief Private data pointer.
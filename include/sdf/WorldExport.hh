@@ -0,0 +1,272 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_WORLD_EXPORT_HH_
+#define SDF_WORLD_EXPORT_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+
+#include <ignition/math/AxisAlignedBox.hh>
+#include <ignition/math/Inertial.hh>
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Vector3.hh>
+
+#include "sdf/Geometry.hh"
+#include "sdf/Joint.hh"
+#include "sdf/Mesh.hh"
+#include "sdf/Types.hh"
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  // Forward declarations.
+  class World;
+  class WorldExportPrivate;
+
+  /// \enum ExportEntityType
+  /// \brief Type of an entity of a WorldExport.
+  enum class ExportEntityType : std::uint8_t
+  {
+    /// \brief A model, or a nested model.
+    MODEL = 0,
+
+    /// \brief A link of a model.
+    LINK = 1,
+
+    /// \brief A visual of a link.
+    VISUAL = 2,
+
+    /// \brief A collision of a link.
+    COLLISION = 3,
+
+    /// \brief A sensor of a link.
+    SENSOR = 4,
+
+    /// \brief A joint of a model.
+    JOINT = 5,
+
+    /// \brief An explicit frame of a model or of the world.
+    FRAME = 6,
+  };
+
+  /// \brief A loaded world flattened into parallel arrays, for simulators
+  /// that copy it into their own entity or physics storage in bulk.
+  ///
+  /// Every entity of the world has an index, which identifies it in the
+  /// entity arrays. Entities are listed in the order of
+  /// World::ResolvePoses: each model before its links, visuals, collisions,
+  /// sensors, joints, frames and nested models, then the frames of the
+  /// world. Parents always come before their children.
+  ///
+  /// Links, joints and collisions also have arrays of their own, indexed
+  /// by their position among entities of their type, which refer back to
+  /// their entity index. All arrays are contiguous, and their content only
+  /// depends on the world. A WorldExport keeps its storage when it is
+  /// built again.
+  class SDFORMAT_VISIBLE WorldExport
+  {
+    /// \brief Index used for an entity without a parent, and for a joint
+    /// attached to the world instead of a link.
+    public: static constexpr std::size_t kInvalidIndex =
+                std::numeric_limits<std::size_t>::max();
+
+    /// \brief Number of entries per joint in the joint axis arrays.
+    public: static constexpr std::size_t kAxesPerJoint = 2;
+
+    /// \brief Default constructor
+    public: WorldExport();
+
+    /// \brief Copy constructor
+    /// \param[in] _export WorldExport to copy.
+    public: WorldExport(const WorldExport &_export);
+
+    /// \brief Move constructor
+    /// \param[in] _export WorldExport to move.
+    public: WorldExport(WorldExport &&_export) noexcept;
+
+    /// \brief Move assignment operator.
+    /// \param[in] _export WorldExport to move.
+    /// \return Reference to this.
+    public: WorldExport &operator=(WorldExport &&_export) noexcept;
+
+    /// \brief Copy assignment operator.
+    /// \param[in] _export WorldExport to copy.
+    /// \return Reference to this.
+    public: WorldExport &operator=(const WorldExport &_export);
+
+    /// \brief Destructor
+    public: ~WorldExport();
+
+    /// \brief Fill the arrays from a world, in one pass over its entities
+    /// after resolving every pose with World::ResolvePoses. The previous
+    /// content is replaced.
+    /// \param[in] _world World loaded through sdf::Root, so that its poses
+    /// can be resolved.
+    /// \param[in] _meshCalculator Function that gives the bounds of the data
+    /// of meshes, for CollisionBounds and VisualBounds.
+    /// \return Errors of the pose resolution and of the joint axes.
+    /// Entities whose pose could not be resolved are still listed, with a
+    /// zero pose.
+    public: Errors Build(const World &_world,
+                const Mesh::AxisAlignedBoxCalculator &_meshCalculator =
+                    nullptr);
+
+    /// \brief Get the number of entities.
+    /// \return Number of entities.
+    public: std::size_t EntityCount() const;
+
+    /// \brief Get the type of each entity.
+    /// \return Array of EntityCount() types.
+    public: const ExportEntityType *EntityTypes() const;
+
+    /// \brief Get the index of the parent of each entity: the model of a
+    /// link, joint, frame or nested model, and the link of a visual,
+    /// collision or sensor.
+    /// \return Array of EntityCount() entity indices, with kInvalidIndex for
+    /// top level models and frames of the world.
+    public: const std::size_t *EntityParents() const;
+
+    /// \brief Get the pose of each entity, relative to the world frame.
+    /// \return Array of EntityCount() poses.
+    public: const ignition::math::Pose3d *EntityPoses() const;
+
+    /// \brief Get the scoped name of an entity, such as
+    /// "model::link::visual".
+    /// \param[in] _index Index of the entity, less than EntityCount().
+    /// \return Name of the entity, or an empty string if _index is out of
+    /// range.
+    public: const std::string &EntityName(std::size_t _index) const;
+
+    /// \brief Get the number of links.
+    /// \return Number of links, including those of nested models.
+    public: std::size_t LinkCount() const;
+
+    /// \brief Get the entity index of each link.
+    /// \return Array of LinkCount() entity indices.
+    public: const std::size_t *LinkEntities() const;
+
+    /// \brief Get the inertial of each link, with its pose relative to the
+    /// link frame as in Link::Inertial.
+    /// \return Array of LinkCount() inertials.
+    public: const ignition::math::Inertiald *LinkInertials() const;
+
+    /// \brief Get the number of joints.
+    /// \return Number of joints, including those of nested models.
+    public: std::size_t JointCount() const;
+
+    /// \brief Get the entity index of each joint.
+    /// \return Array of JointCount() entity indices.
+    public: const std::size_t *JointEntities() const;
+
+    /// \brief Get the type of each joint.
+    /// \return Array of JointCount() joint types.
+    public: const JointType *JointTypes() const;
+
+    /// \brief Get the link index of the parent link of each joint.
+    /// \return Array of JointCount() link indices, with kInvalidIndex for
+    /// joints whose parent is the world or a frame.
+    public: const std::size_t *JointParentLinks() const;
+
+    /// \brief Get the link index of the child link of each joint.
+    /// \return Array of JointCount() link indices, with kInvalidIndex for
+    /// joints whose child is a frame.
+    public: const std::size_t *JointChildLinks() const;
+
+    /// \brief Get the unit vector of the axes of each joint, expressed in
+    /// the world frame. The axes of joint i are at index
+    /// i * kAxesPerJoint + axis, and axes a joint doesn't have are zero.
+    /// \return Array of JointCount() * kAxesPerJoint vectors.
+    public: const ignition::math::Vector3d *JointAxes() const;
+
+    /// \brief Get the lower position limit of the axes of each joint,
+    /// indexed like JointAxes, zero for axes a joint doesn't have.
+    /// \return Array of JointCount() * kAxesPerJoint limits.
+    public: const double *JointLowerLimits() const;
+
+    /// \brief Get the upper position limit of the axes of each joint,
+    /// indexed like JointAxes, zero for axes a joint doesn't have.
+    /// \return Array of JointCount() * kAxesPerJoint limits.
+    public: const double *JointUpperLimits() const;
+
+    /// \brief Get the effort limit of the axes of each joint, indexed like
+    /// JointAxes, zero for axes a joint doesn't have.
+    /// \return Array of JointCount() * kAxesPerJoint limits.
+    public: const double *JointEffortLimits() const;
+
+    /// \brief Get the velocity limit of the axes of each joint, indexed
+    /// like JointAxes, zero for axes a joint doesn't have.
+    /// \return Array of JointCount() * kAxesPerJoint limits.
+    public: const double *JointVelocityLimits() const;
+
+    /// \brief Get the number of collisions.
+    /// \return Number of collisions.
+    public: std::size_t CollisionCount() const;
+
+    /// \brief Get the entity index of each collision.
+    /// \return Array of CollisionCount() entity indices.
+    public: const std::size_t *CollisionEntities() const;
+
+    /// \brief Get the link index of the link of each collision.
+    /// \return Array of CollisionCount() link indices.
+    public: const std::size_t *CollisionLinks() const;
+
+    /// \brief Get the shape type of each collision.
+    /// \return Array of CollisionCount() geometry types.
+    public: const GeometryType *CollisionShapes() const;
+
+    /// \brief Get the dimensions of the shape of each collision: the size
+    /// of a box, the radius of a sphere as x, the radius and length of a
+    /// cylinder or capsule as x and y, the size of a plane as x and y, the
+    /// scale of a mesh and the size of a heightmap. Other shapes have zero
+    /// dimensions.
+    /// \return Array of CollisionCount() dimensions.
+    public: const ignition::math::Vector3d *CollisionShapeSizes() const;
+
+    /// \brief Get the axis aligned bounding box of the geometry of each
+    /// collision, relative to the world frame, as given by
+    /// Geometry::AxisAlignedBox and moved by the pose of the collision.
+    /// \return Array of CollisionCount() boxes. Geometries without bounds,
+    /// such as meshes without a calculator, have a default constructed box,
+    /// which is empty.
+    public: const ignition::math::AxisAlignedBox *CollisionBounds() const;
+
+    /// \brief Get the number of visuals.
+    /// \return Number of visuals.
+    public: std::size_t VisualCount() const;
+
+    /// \brief Get the entity index of each visual.
+    /// \return Array of VisualCount() entity indices.
+    public: const std::size_t *VisualEntities() const;
+
+    /// \brief Get the axis aligned bounding box of the geometry of each
+    /// visual, relative to the world frame, as for CollisionBounds.
+    /// \return Array of VisualCount() boxes.
+    public: const ignition::math::AxisAlignedBox *VisualBounds() const;
+
+    /// \brief Private data pointer.
+    private: WorldExportPrivate *dataPtr = nullptr;
+  };
+  }
+}
+#endif
@@ -0,0 +1,175 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_WORLD_PARTITION_HH_
+#define SDF_WORLD_PARTITION_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "sdf/Error.hh"
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  // Forward declarations.
+  class World;
+  class WorldPartitionPrivate;
+
+  /// \enum PartitionStrategy
+  /// \brief How WorldPartition groups the top level models of a world.
+  enum class PartitionStrategy : std::uint8_t
+  {
+    /// \brief Split the world into regions, each with about the same
+    /// number of models, by recursively halving the longest side of the
+    /// box around the models. Models may be posed relative to models of
+    /// another shard.
+    SPATIAL = 0,
+
+    /// \brief Keep the models that refer to each other through the
+    /// relative_to attributes of their poses in the same shard, and
+    /// balance the number of models of the shards.
+    CONNECTIVITY = 1,
+  };
+
+  /// \brief A pose of a top level model or frame of a shard that is
+  /// relative to a frame of another shard.
+  struct SDFORMAT_VISIBLE ShardDependency
+  {
+    /// \brief Name of the model or frame.
+    std::string entity;
+
+    /// \brief Shard of the model or frame, or WorldPartition::kAllShards
+    /// for a frame that is written to every shard.
+    std::size_t entityShard;
+
+    /// \brief The relative_to attribute of the pose of the entity.
+    std::string frame;
+
+    /// \brief Shard of the top level model or frame that frame names.
+    std::size_t frameShard;
+  };
+
+  /// \brief A partition of the top level models of a loaded world into
+  /// shards, for simulating a world on several nodes, which can write each
+  /// shard as an SDFormat document of its own.
+  ///
+  /// Top level frames follow the model they are attached to, through other
+  /// frames, so that a frame and its model are never in different shards.
+  /// Frames attached to the world frame, and the other children of the
+  /// world, such as lights, actors, populations and physics, are written to
+  /// every shard.
+  class SDFORMAT_VISIBLE WorldPartition
+  {
+    /// \brief Shard of the entities that are written to every shard.
+    public: static constexpr std::size_t kAllShards =
+                std::numeric_limits<std::size_t>::max();
+
+    /// \brief Default constructor
+    public: WorldPartition();
+
+    /// \brief Copy constructor
+    /// \param[in] _partition WorldPartition to copy.
+    public: WorldPartition(const WorldPartition &_partition);
+
+    /// \brief Move constructor
+    /// \param[in] _partition WorldPartition to move.
+    public: WorldPartition(WorldPartition &&_partition) noexcept;
+
+    /// \brief Move assignment operator.
+    /// \param[in] _partition WorldPartition to move.
+    /// \return Reference to this.
+    public: WorldPartition &operator=(WorldPartition &&_partition) noexcept;
+
+    /// \brief Copy assignment operator.
+    /// \param[in] _partition WorldPartition to copy.
+    /// \return Reference to this.
+    public: WorldPartition &operator=(const WorldPartition &_partition);
+
+    /// \brief Destructor
+    public: ~WorldPartition();
+
+    /// \brief Partition a world, replacing the previous partition. Poses
+    /// are resolved with one World::ResolvePoses sweep. The partition keeps
+    /// the elements of the world to write the shards, so the world must be
+    /// loaded without ParserConfig::SetReleaseElements.
+    /// \param[in] _world World loaded through sdf::Root.
+    /// \param[in] _shardCount Number of shards. A count of 0 makes one
+    /// shard. Shards are left empty when there are fewer groups of models
+    /// than shards.
+    /// \param[in] _strategy How the models are grouped.
+    /// \return Errors of the pose resolution, or an ELEMENT_MISSING error
+    /// if the elements of the world were released.
+    public: Errors Build(const World &_world, std::size_t _shardCount,
+                PartitionStrategy _strategy = PartitionStrategy::SPATIAL);
+
+    /// \brief Get the number of shards.
+    /// \return Number of shards.
+    public: std::size_t ShardCount() const;
+
+    /// \brief Get the top level models of a shard.
+    /// \param[in] _shard Index of the shard, less than ShardCount().
+    /// \return Indices of the models in World::ModelByIndex, in increasing
+    /// order, or an empty vector if _shard is out of range.
+    public: const std::vector<std::size_t> &ShardModels(
+                std::size_t _shard) const;
+
+    /// \brief Get the shard of a top level model.
+    /// \param[in] _model Index of the model in World::ModelByIndex.
+    /// \return Index of the shard, or kAllShards if _model is out of range.
+    public: std::size_t ModelShard(std::size_t _model) const;
+
+    /// \brief Get the shard of a top level frame.
+    /// \param[in] _frame Index of the frame in World::FrameByIndex.
+    /// \return Index of the shard, or kAllShards if the frame is written to
+    /// every shard or _frame is out of range.
+    public: std::size_t FrameShard(std::size_t _frame) const;
+
+    /// \brief Get the poses of top level models and frames that are
+    /// relative to a frame of another shard. The poses are written relative
+    /// to the world frame in WriteShard instead.
+    /// \return The dependencies, in the order of the models of the world
+    /// followed by its frames.
+    public: const std::vector<ShardDependency> &Dependencies() const;
+
+    /// \brief Write a shard as an SDFormat document with a copy of the
+    /// world that only has the models and frames of the shard, which can be
+    /// loaded by sdf::Root on another node. The elements are written
+    /// directly to the stream, one top level model at a time, and only the
+    /// models and frames with a dependency are copied, to set their pose.
+    /// \param[in] _shard Index of the shard, less than ShardCount().
+    /// \param[out] _out Stream to write to.
+    /// \param[in] _compact True to write the XML without indentation and
+    /// line breaks.
+    /// \return False if _shard is out of range.
+    public: bool WriteShard(std::size_t _shard, std::ostream &_out,
+                bool _compact = false) const;
+
+    /// \brief Private data pointer.
+    private: WorldPartitionPrivate *dataPtr = nullptr;
+  };
+  }
+}
+#endif
@@ -0,0 +1,316 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_WORLD_SNAPSHOT_HH_
+#define SDF_WORLD_SNAPSHOT_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+
+#include "sdf/Error.hh"
+#include "sdf/WorldExport.hh"
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  // Forward declarations.
+  class WorldSnapshotPrivate;
+
+  /// \brief A vector as stored in a WorldSnapshot.
+  struct SnapshotVector3
+  {
+    /// \brief X coordinate.
+    double x;
+
+    /// \brief Y coordinate.
+    double y;
+
+    /// \brief Z coordinate.
+    double z;
+  };
+
+  /// \brief A pose as stored in a WorldSnapshot.
+  struct SnapshotPose
+  {
+    /// \brief Position.
+    SnapshotVector3 position;
+
+    /// \brief W component of the orientation quaternion.
+    double qw;
+
+    /// \brief X component of the orientation quaternion.
+    double qx;
+
+    /// \brief Y component of the orientation quaternion.
+    double qy;
+
+    /// \brief Z component of the orientation quaternion.
+    double qz;
+  };
+
+  /// \brief An inertial as stored in a WorldSnapshot.
+  struct SnapshotInertial
+  {
+    /// \brief Mass.
+    double mass;
+
+    /// \brief Pose of the center of mass relative to the link frame.
+    SnapshotPose pose;
+
+    /// \brief Moments and products of inertia: ixx, iyy, izz, ixy, ixz and
+    /// iyz.
+    double inertia[6];
+  };
+
+  /// \brief An axis aligned box as stored in a WorldSnapshot, with the
+  /// corners of ignition::math::AxisAlignedBox. Empty boxes have a minimum
+  /// larger than their maximum.
+  struct SnapshotBox
+  {
+    /// \brief Minimum corner.
+    SnapshotVector3 min;
+
+    /// \brief Maximum corner.
+    SnapshotVector3 max;
+  };
+
+  /// \brief A read-only view of a WorldExport written in a position
+  /// independent layout, so that several processes can share one loaded
+  /// world through a shared memory segment or a memory-mapped file.
+  ///
+  /// The snapshot is one block of memory: a header, then one array per
+  /// accessor, each at an offset from the start of the block that is a
+  /// multiple of 64 bytes. It holds no pointers, so the block can be
+  /// mapped at any address that is a multiple of 8, and Open only checks
+  /// the header and the name table before the arrays are used in place.
+  /// Arrays and indices are those of WorldExport, with indices stored as
+  /// 64 bit integers, enums as 8 bit integers and math types as the plain
+  /// structs above.
+  ///
+  /// Like BinarySnapshot, a snapshot can only be read on a machine with
+  /// the byte order of the one that wrote it.
+  class SDFORMAT_VISIBLE WorldSnapshot
+  {
+    /// \brief Index used for an entity without a parent, and for a joint
+    /// attached to the world instead of a link.
+    public: static constexpr std::uint64_t kInvalidIndex =
+                std::numeric_limits<std::uint64_t>::max();
+
+    /// \brief Default constructor, for an empty snapshot.
+    public: WorldSnapshot();
+
+    /// \brief Copy constructor is deleted, because the snapshot can own a
+    /// mapped file.
+    /// \param[in] _snapshot WorldSnapshot to copy.
+    public: WorldSnapshot(const WorldSnapshot &_snapshot) = delete;
+
+    /// \brief Move constructor
+    /// \param[in] _snapshot WorldSnapshot to move.
+    public: WorldSnapshot(WorldSnapshot &&_snapshot) noexcept;
+
+    /// \brief Move assignment operator.
+    /// \param[in] _snapshot WorldSnapshot to move.
+    /// \return Reference to this.
+    public: WorldSnapshot &operator=(WorldSnapshot &&_snapshot) noexcept;
+
+    /// \brief Copy assignment operator is deleted.
+    /// \param[in] _snapshot WorldSnapshot to copy.
+    /// \return Reference to this.
+    public: WorldSnapshot &operator=(const WorldSnapshot &_snapshot) =
+                delete;
+
+    /// \brief Destructor
+    public: ~WorldSnapshot();
+
+    /// \brief Get the number of bytes of the snapshot of a world.
+    /// \param[in] _export Exported world.
+    /// \return Size of the snapshot in bytes.
+    public: static std::size_t WriteSize(const WorldExport &_export);
+
+    /// \brief Write the snapshot of a world into memory, such as a shared
+    /// memory segment.
+    /// \param[in] _export Exported world.
+    /// \param[out] _buffer Memory to write to.
+    /// \param[in] _size Size of _buffer, at least WriteSize(_export).
+    /// \return A FILE_READ error if _buffer is too small.
+    public: static Errors Write(const WorldExport &_export, void *_buffer,
+                std::size_t _size);
+
+    /// \brief Write the snapshot of a world to a file, which readers can
+    /// open with Open(const std::string &).
+    /// \param[in] _export Exported world.
+    /// \param[in] _filename Path of the file.
+    /// \return A FILE_READ error if the file can't be written.
+    public: static Errors Write(const WorldExport &_export,
+                const std::string &_filename);
+
+    /// \brief View a snapshot in memory, releasing the previous one. The
+    /// memory isn't copied, and must outlive the view.
+    /// \param[in] _data Start of the snapshot, a multiple of 8.
+    /// \param[in] _size Size of the memory in bytes.
+    /// \return A FILE_READ error if the memory doesn't hold a valid
+    /// snapshot, in which case the view is empty.
+    public: Errors Open(const void *_data, std::size_t _size);
+
+    /// \brief Map a snapshot file and view it, releasing the previous one.
+    /// \param[in] _filename Path of the file.
+    /// \return A FILE_READ error if the file can't be read or doesn't hold
+    /// a valid snapshot, in which case the view is empty.
+    public: Errors Open(const std::string &_filename);
+
+    /// \brief Get the start of the viewed snapshot.
+    /// \return Start of the snapshot, or nullptr if the view is empty.
+    public: const void *Data() const;
+
+    /// \brief Get the size of the viewed snapshot.
+    /// \return Size of the snapshot in bytes.
+    public: std::size_t Size() const;
+
+    /// \brief Get the number of entities.
+    /// \return Number of entities.
+    /// \sa WorldExport::EntityCount
+    public: std::size_t EntityCount() const;
+
+    /// \brief Get the type of each entity.
+    /// \return Array of EntityCount() types.
+    public: const ExportEntityType *EntityTypes() const;
+
+    /// \brief Get the index of the parent of each entity.
+    /// \return Array of EntityCount() entity indices.
+    /// \sa WorldExport::EntityParents
+    public: const std::uint64_t *EntityParents() const;
+
+    /// \brief Get the pose of each entity, relative to the world frame.
+    /// \return Array of EntityCount() poses.
+    public: const SnapshotPose *EntityPoses() const;
+
+    /// \brief Get the scoped name of an entity.
+    /// \param[in] _index Index of the entity, less than EntityCount().
+    /// \return View of the name in the snapshot, which is null terminated,
+    /// or an empty view if _index is out of range.
+    public: std::string_view EntityName(std::size_t _index) const;
+
+    /// \brief Find an entity by its scoped name, with a binary search over
+    /// a sorted name index of the snapshot.
+    /// \param[in] _name Scoped name of the entity.
+    /// \return Index of the entity, or kInvalidIndex if there is none.
+    public: std::uint64_t EntityByName(std::string_view _name) const;
+
+    /// \brief Get the number of links.
+    /// \return Number of links.
+    public: std::size_t LinkCount() const;
+
+    /// \brief Get the entity index of each link.
+    /// \return Array of LinkCount() entity indices.
+    public: const std::uint64_t *LinkEntities() const;
+
+    /// \brief Get the inertial of each link.
+    /// \return Array of LinkCount() inertials.
+    public: const SnapshotInertial *LinkInertials() const;
+
+    /// \brief Get the number of joints.
+    /// \return Number of joints.
+    public: std::size_t JointCount() const;
+
+    /// \brief Get the entity index of each joint.
+    /// \return Array of JointCount() entity indices.
+    public: const std::uint64_t *JointEntities() const;
+
+    /// \brief Get the type of each joint.
+    /// \return Array of JointCount() values of sdf::JointType.
+    public: const std::uint8_t *JointTypes() const;
+
+    /// \brief Get the link index of the parent link of each joint.
+    /// \return Array of JointCount() link indices.
+    public: const std::uint64_t *JointParentLinks() const;
+
+    /// \brief Get the link index of the child link of each joint.
+    /// \return Array of JointCount() link indices.
+    public: const std::uint64_t *JointChildLinks() const;
+
+    /// \brief Get the axes of each joint, in the world frame.
+    /// \return Array of JointCount() * WorldExport::kAxesPerJoint vectors.
+    public: const SnapshotVector3 *JointAxes() const;
+
+    /// \brief Get the lower position limit of the axes of each joint.
+    /// \return Array of JointCount() * WorldExport::kAxesPerJoint limits.
+    public: const double *JointLowerLimits() const;
+
+    /// \brief Get the upper position limit of the axes of each joint.
+    /// \return Array of JointCount() * WorldExport::kAxesPerJoint limits.
+    public: const double *JointUpperLimits() const;
+
+    /// \brief Get the effort limit of the axes of each joint.
+    /// \return Array of JointCount() * WorldExport::kAxesPerJoint limits.
+    public: const double *JointEffortLimits() const;
+
+    /// \brief Get the velocity limit of the axes of each joint.
+    /// \return Array of JointCount() * WorldExport::kAxesPerJoint limits.
+    public: const double *JointVelocityLimits() const;
+
+    /// \brief Get the number of collisions.
+    /// \return Number of collisions.
+    public: std::size_t CollisionCount() const;
+
+    /// \brief Get the entity index of each collision.
+    /// \return Array of CollisionCount() entity indices.
+    public: const std::uint64_t *CollisionEntities() const;
+
+    /// \brief Get the link index of the link of each collision.
+    /// \return Array of CollisionCount() link indices.
+    public: const std::uint64_t *CollisionLinks() const;
+
+    /// \brief Get the shape type of each collision.
+    /// \return Array of CollisionCount() values of sdf::GeometryType.
+    public: const std::uint8_t *CollisionShapes() const;
+
+    /// \brief Get the dimensions of the shape of each collision.
+    /// \return Array of CollisionCount() dimensions.
+    /// \sa WorldExport::CollisionShapeSizes
+    public: const SnapshotVector3 *CollisionShapeSizes() const;
+
+    /// \brief Get the bounds of the geometry of each collision, relative to
+    /// the world frame.
+    /// \return Array of CollisionCount() boxes.
+    public: const SnapshotBox *CollisionBounds() const;
+
+    /// \brief Get the number of visuals.
+    /// \return Number of visuals.
+    public: std::size_t VisualCount() const;
+
+    /// \brief Get the entity index of each visual.
+    /// \return Array of VisualCount() entity indices.
+    public: const std::uint64_t *VisualEntities() const;
+
+    /// \brief Get the bounds of the geometry of each visual, relative to
+    /// the world frame.
+    /// \return Array of VisualCount() boxes.
+    public: const SnapshotBox *VisualBounds() const;
+
+    /// \brief Private data pointer.
+    private: WorldSnapshotPrivate *dataPtr = nullptr;
+  };
+  }
+}
+#endif
@@ -0,0 +1,178 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_WORLD_SPATIAL_INDEX_HH_
+#define SDF_WORLD_SPATIAL_INDEX_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <ignition/math/AxisAlignedBox.hh>
+#include <ignition/math/Pose3.hh>
+
+#include "sdf/Error.hh"
+#include "sdf/Mesh.hh"
+#include "sdf/sdf_config.h"
+#include "sdf/system_util.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  // Forward declarations.
+  class World;
+  class WorldSpatialIndexPrivate;
+
+  /// \enum SpatialEntityType
+  /// \brief Type of an entity of a WorldSpatialIndex.
+  enum class SpatialEntityType : std::uint8_t
+  {
+    /// \brief A model, or a nested model.
+    MODEL = 0,
+
+    /// \brief A link of a model.
+    LINK = 1,
+
+    /// \brief A light of the world or of a link.
+    LIGHT = 2,
+  };
+
+  /// \brief A bounding volume hierarchy over the models, links and lights
+  /// of a loaded world, for region queries such as the models in a tile or
+  /// the lights that reach a box.
+  ///
+  /// The bounds of a link contain the geometries of its collisions and
+  /// visuals, or its origin if it has none. The bounds of a model contain
+  /// its links and nested models, or its origin if it has none. Point and
+  /// spot lights are bounded by the sphere of their attenuation range, and
+  /// directional lights are unbounded, so that every query returns them.
+  ///
+  /// Entities are listed like in WorldExport: each model before its links,
+  /// the lights of each link after the link, and nested models after the
+  /// links, followed by the lights of the world.
+  class SDFORMAT_VISIBLE WorldSpatialIndex
+  {
+    /// \brief Index used for an entity without a parent.
+    public: static constexpr std::size_t kInvalidIndex =
+                std::numeric_limits<std::size_t>::max();
+
+    /// \brief Default constructor
+    public: WorldSpatialIndex();
+
+    /// \brief Copy constructor
+    /// \param[in] _index WorldSpatialIndex to copy.
+    public: WorldSpatialIndex(const WorldSpatialIndex &_index);
+
+    /// \brief Move constructor
+    /// \param[in] _index WorldSpatialIndex to move.
+    public: WorldSpatialIndex(WorldSpatialIndex &&_index) noexcept;
+
+    /// \brief Move assignment operator.
+    /// \param[in] _index WorldSpatialIndex to move.
+    /// \return Reference to this.
+    public: WorldSpatialIndex &operator=(WorldSpatialIndex &&_index) noexcept;
+
+    /// \brief Copy assignment operator.
+    /// \param[in] _index WorldSpatialIndex to copy.
+    /// \return Reference to this.
+    public: WorldSpatialIndex &operator=(const WorldSpatialIndex &_index);
+
+    /// \brief Destructor
+    public: ~WorldSpatialIndex();
+
+    /// \brief Index a world, replacing the previous content. Poses are
+    /// resolved with one World::ResolvePoses sweep through WorldExport.
+    /// \param[in] _world World loaded through sdf::Root.
+    /// \param[in] _meshCalculator Function that gives the bounds of the data
+    /// of meshes. Without it, meshes don't add to the bounds of their link.
+    /// \return Errors of the pose resolution.
+    public: Errors Build(const World &_world,
+                const Mesh::AxisAlignedBoxCalculator &_meshCalculator =
+                    nullptr);
+
+    /// \brief Get the number of entities.
+    /// \return Number of entities.
+    public: std::size_t EntityCount() const;
+
+    /// \brief Get the type of each entity.
+    /// \return Array of EntityCount() types.
+    public: const SpatialEntityType *EntityTypes() const;
+
+    /// \brief Get the index of the parent of each entity: the model of a
+    /// link or nested model, and the link of a light.
+    /// \return Array of EntityCount() entity indices, with kInvalidIndex for
+    /// top level models and lights of the world.
+    public: const std::size_t *EntityParents() const;
+
+    /// \brief Get the bounds of each entity, relative to the world frame.
+    /// \return Array of EntityCount() boxes. Directional lights have
+    /// infinite boxes.
+    public: const ignition::math::AxisAlignedBox *EntityBounds() const;
+
+    /// \brief Get the scoped name of an entity, such as "model::link".
+    /// \param[in] _index Index of the entity, less than EntityCount().
+    /// \return Name of the entity, or an empty string if _index is out of
+    /// range.
+    public: const std::string &EntityName(std::size_t _index) const;
+
+    /// \brief Find an entity by its scoped name.
+    /// \param[in] _name Scoped name of the entity.
+    /// \return Index of the entity, or kInvalidIndex if there is none.
+    public: std::size_t EntityByName(const std::string &_name) const;
+
+    /// \brief Find the entities whose bounds overlap a region.
+    /// \param[in] _region Box relative to the world frame.
+    /// \param[out] _entities Indices of the entities, in increasing order.
+    /// The vector is replaced.
+    public: void Query(const ignition::math::AxisAlignedBox &_region,
+                std::vector<std::size_t> &_entities) const;
+
+    /// \brief Find the entities of a type whose bounds overlap a region.
+    /// \param[in] _region Box relative to the world frame.
+    /// \param[in] _type Type of the entities to find.
+    /// \param[out] _entities Indices of the entities, in increasing order.
+    /// The vector is replaced.
+    public: void Query(const ignition::math::AxisAlignedBox &_region,
+                SpatialEntityType _type,
+                std::vector<std::size_t> &_entities) const;
+
+    /// \brief Move a top level model, with its links, nested models and the
+    /// lights of its links, and update the hierarchy along their paths.
+    /// Call it when the pose of a model is changed in the DOM, with the new
+    /// pose of the model relative to the world frame. Entities whose pose is
+    /// relative to the model but that don't belong to it are not moved, and
+    /// need the index to be built again.
+    ///
+    /// The geometries of the links are bounded in the model frame when the
+    /// index is built, so once a model is rotated its bounds can be a bit
+    /// larger than the bounds Build would give.
+    /// \param[in] _model Entity index of a top level model.
+    /// \param[in] _pose New pose of the model relative to the world frame.
+    /// \return False if _model is not a top level model.
+    public: bool UpdateModelPose(std::size_t _model,
+                const ignition::math::Pose3d &_pose);
+
+    /// \brief Private data pointer.
+    private: WorldSpatialIndexPrivate *dataPtr = nullptr;
+  };
+  }
+}
+#endif
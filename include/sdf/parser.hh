@@ -17,8 +17,15 @@
 #ifndef SDF_PARSER_HH_
 #define SDF_PARSER_HH_
 
+#include <cstddef>
+#include <future>
+#include <istream>
+#include <ostream>
 #include <string>
+#include <string_view>
+#include <vector>
 
+#include "sdf/ParserConfig.hh"
 #include "sdf/SDFImpl.hh"
 #include "sdf/sdf_config.h"
 #include "sdf/system_util.hh"
@@ -41,9 +48,32 @@ namespace sdf
   class Root;
 
   /// \brief Init based on the installed sdf_format.xml file
+  /// The descriptions of the spec are created the first time each of them
+  /// is looked up, such as when a document using them is read, and are then
+  /// shared by the whole process.
   SDFORMAT_VISIBLE
   bool init(SDFPtr _sdf);
 
+  /// \brief Preload the caches that are shared by the whole process and
+  /// otherwise filled by the first documents that are read: the embedded
+  /// spec files, all descriptions of a spec version, the conversion
+  /// recipes and the console. Calling it at startup makes the first call
+  /// to readFile as fast as the following ones. It is safe to call it
+  /// again, or while documents are read by other threads.
+  /// \param[in] _version Spec version to preload, such as "1.8". If empty,
+  /// the version returned by SDF::Version() is used.
+  /// \return False if there is no spec for _version.
+  SDFORMAT_VISIBLE
+  bool Warmup(const std::string &_version = "");
+
+  /// \brief Preload the process-wide caches like Warmup, in a background
+  /// thread.
+  /// \param[in] _version Spec version to preload, such as "1.8". If empty,
+  /// the version returned by SDF::Version() when this is called is used.
+  /// \return Future that holds the result of Warmup once it is done.
+  SDFORMAT_VISIBLE
+  std::future<bool> WarmupAsync(const std::string &_version = "");
+
   /// \brief Initialize the SDF interface using a file
   SDFORMAT_VISIBLE
   bool initFile(const std::string &_filename, SDFPtr _sdf);
@@ -77,6 +107,19 @@ namespace sdf
   SDFORMAT_VISIBLE
   sdf::SDFPtr readFile(const std::string &_filename, Errors &_errors);
 
+  /// \brief Populate the SDF values from a file
+  ///
+  /// This populates the given sdf pointer from a file. If the file is a URDF
+  /// file it is converted to SDF first. All files are converted to the latest
+  /// SDF version
+  /// \param[in] _filename Name of the SDF file
+  /// \param[in] _config Parser configuration
+  /// \param[out] _errors Parsing errors will be appended to this variable.
+  /// \return Populated SDF pointer.
+  SDFORMAT_VISIBLE
+  sdf::SDFPtr readFile(const std::string &_filename,
+      const ParserConfig &_config, Errors &_errors);
+
   /// \brief Populate the SDF values from a file
   ///
   /// This populates the given sdf pointer from a file. If the file is a URDF
@@ -89,6 +132,57 @@ namespace sdf
   SDFORMAT_VISIBLE
   bool readFile(const std::string &_filename, SDFPtr _sdf, Errors &_errors);
 
+  /// \brief Populate the SDF values from a file
+  ///
+  /// This populates the given sdf pointer from a file. If the file is a URDF
+  /// file it is converted to SDF first. All files are converted to the latest
+  /// SDF version.
+  ///
+  /// When ParserConfig::LoadThreadCount is not 1, the <include> elements
+  /// that share a parent are resolved and read concurrently before being
+  /// added in document order. The find callback set with setFindCallback
+  /// or ParserConfig::SetFindCallback may then be called from more than one
+  /// thread at a time.
+  ///
+  /// Files and the uris of <include> elements are found with the URI paths
+  /// and find callback of the configuration, in addition to the global
+  /// ones, see ParserConfig::AddURIPath.
+  /// \param[in] _filename Name of the SDF file
+  /// \param[in] _config Parser configuration
+  /// \param[in] _sdf Pointer to an SDF object.
+  /// \param[out] _errors Parsing errors will be appended to this variable.
+  /// \return True if successful.
+  SDFORMAT_VISIBLE
+  bool readFile(const std::string &_filename, const ParserConfig &_config,
+      SDFPtr _sdf, Errors &_errors);
+
+  /// \brief Populate the SDF values from a binary snapshot written with
+  /// SDF::WriteBinary.
+  ///
+  /// Reading a snapshot skips XML parsing, conversion and resolution of
+  /// includes, which already happened before it was written. The snapshot
+  /// must have been written by a library with the same SDFormat version,
+  /// otherwise an error is reported and the snapshot must be regenerated.
+  /// \param[in] _filename Name of the snapshot file
+  /// \param[in] _sdf Pointer to an SDF object initialized with sdf::init.
+  /// \param[out] _errors Parsing errors will be appended to this variable.
+  /// \return True if successful.
+  SDFORMAT_VISIBLE
+  bool readBinaryFile(const std::string &_filename, SDFPtr _sdf,
+      Errors &_errors);
+
+  /// \brief Populate the SDF values from a binary snapshot in memory, such
+  /// as one received from another process, written with SDF::WriteBinary.
+  /// \sa readBinaryFile
+  /// \param[in] _data Content of the snapshot.
+  /// \param[in] _size Size of the content in bytes.
+  /// \param[in] _sdf Pointer to an SDF object initialized with sdf::init.
+  /// \param[out] _errors Parsing errors will be appended to this variable.
+  /// \return True if successful.
+  SDFORMAT_VISIBLE
+  bool readBinaryBuffer(const char *_data, std::size_t _size, SDFPtr _sdf,
+      Errors &_errors);
+
   /// \brief Populate the SDF values from a file without converting to the
   /// latest SDF version
   ///
@@ -127,6 +221,89 @@ namespace sdf
   SDFORMAT_VISIBLE
   bool readString(const std::string &_xmlString, SDFPtr _sdf, Errors &_errors);
 
+  /// \brief Populate the SDF values from a string
+  ///
+  /// This populates the sdf pointer from a string. If the string is a URDF
+  /// string it is converted to SDF first. All string are converted to the
+  /// latest SDF version. See readFile(const std::string &,
+  /// const ParserConfig &, SDFPtr, Errors &) for how _config affects the
+  /// handling of <include> elements.
+  /// \param[in] _xmlString XML string to be parsed.
+  /// \param[in] _config Parser configuration
+  /// \param[in] _sdf Pointer to an SDF object.
+  /// \param[out] _errors Parsing errors will be appended to this variable.
+  /// \return True if successful.
+  SDFORMAT_VISIBLE
+  bool readString(const std::string &_xmlString, const ParserConfig &_config,
+      SDFPtr _sdf, Errors &_errors);
+
+  /// \brief Populate the SDF values from a buffer that the caller owns,
+  /// such as data received over the network or a memory mapped file,
+  /// without copying it into a string first.
+  ///
+  /// This behaves like readString(const std::string &,
+  /// const ParserConfig &, SDFPtr, Errors &). The buffer is only read during
+  /// the call.
+  /// \param[in] _data XML to be parsed. It does not need to be null
+  /// terminated.
+  /// \param[in] _size Size of the XML in bytes.
+  /// \param[in] _config Parser configuration
+  /// \param[in] _sdf Pointer to an SDF object.
+  /// \param[out] _errors Parsing errors will be appended to this variable.
+  /// \return True if successful.
+  SDFORMAT_VISIBLE
+  bool readBuffer(const char *_data, std::size_t _size,
+      const ParserConfig &_config, SDFPtr _sdf, Errors &_errors);
+
+  /// \brief Populate the SDF values from a buffer that the caller owns.
+  /// See readBuffer(const char *, std::size_t, const ParserConfig &, SDFPtr,
+  /// Errors &).
+  /// \param[in] _xml XML to be parsed.
+  /// \param[in] _config Parser configuration
+  /// \param[in] _sdf Pointer to an SDF object.
+  /// \param[out] _errors Parsing errors will be appended to this variable.
+  /// \return True if successful.
+  SDFORMAT_VISIBLE
+  bool readBuffer(std::string_view _xml, const ParserConfig &_config,
+      SDFPtr _sdf, Errors &_errors);
+
+  /// \brief Populate the SDF values from an input stream, which is read to
+  /// its end.
+  ///
+  /// This behaves like readString(const std::string &,
+  /// const ParserConfig &, SDFPtr, Errors &). The content of the stream is
+  /// read directly into the buffer that is parsed.
+  /// \param[in] _in Stream to read the XML from.
+  /// \param[in] _config Parser configuration
+  /// \param[in] _sdf Pointer to an SDF object.
+  /// \param[out] _errors Parsing errors will be appended to this variable.
+  /// \return True if successful.
+  SDFORMAT_VISIBLE
+  bool readStream(std::istream &_in, const ParserConfig &_config,
+      SDFPtr _sdf, Errors &_errors);
+
+  /// \brief Populate the SDF values from a fragment that holds a single
+  /// <model>, <actor> or <light> element, without the <sdf> element
+  /// around it, such as the messages of a spawn service.
+  ///
+  /// The fragment is read at the current SDF version, so unlike readString
+  /// its version is not detected, it is not converted and it can't be
+  /// URDF. Its element is added to the root of _sdf from the cached
+  /// description of the current version. Includes are resolved as in
+  /// readString.
+  /// \param[in] _data XML of the fragment. It does not need to be null
+  /// terminated.
+  /// \param[in] _size Size of the XML in bytes.
+  /// \param[in] _config Parser configuration
+  /// \param[in] _sdf Pointer to an SDF object initialized with sdf::init.
+  /// \param[out] _errors Parsing errors will be appended to this variable,
+  /// including an ELEMENT_INVALID error if the fragment is not a <model>,
+  /// <actor> or <light>.
+  /// \return True if successful.
+  SDFORMAT_VISIBLE
+  bool readFragment(const char *_data, std::size_t _size,
+      const ParserConfig &_config, SDFPtr _sdf, Errors &_errors);
+
   /// \brief Populate the SDF values from a string
   ///
   /// This populates the sdf pointer from a string. If the string is a URDF
@@ -185,6 +362,37 @@ namespace sdf
   SDFORMAT_VISIBLE
   std::string getModelFilePath(const std::string &_modelDirPath);
 
+  /// \brief Remove every file from the cache of files read for <include>
+  /// elements.
+  ///
+  /// The parser keeps the converted contents of each included file so that
+  /// including the same model many times only reads and converts it once.
+  /// An entry is reused only while the file, and every file it includes,
+  /// keeps the same size and modification time. The cache is also cleared
+  /// by setFindCallback and addURIPath, since they change how includes
+  /// resolve. Files read with a ParserConfig that has URI paths or a find
+  /// callback of its own are kept apart from the others.
+  SDFORMAT_VISIBLE
+  void clearIncludeCache();
+
+  /// \brief Set the maximum number of files kept in the include cache. The
+  /// least recently used files are removed first. A capacity of 0 disables
+  /// the cache. The default capacity is 256.
+  /// \param[in] _capacity Maximum number of cached files.
+  /// \sa void clearIncludeCache()
+  SDFORMAT_VISIBLE
+  void setIncludeCacheCapacity(std::size_t _capacity);
+
+  /// \brief Get the maximum number of files kept in the include cache.
+  /// \return The include cache capacity.
+  SDFORMAT_VISIBLE
+  std::size_t includeCacheCapacity();
+
+  /// \brief Get the number of files in the include cache.
+  /// \return The number of cached files.
+  SDFORMAT_VISIBLE
+  std::size_t includeCacheSize();
+
   /// \brief Convert an SDF file to a specific SDF version.
   /// \param[in] _filename Name of the SDF file to convert.
   /// \param[in] _version Version to convert _filename to.
@@ -203,6 +411,32 @@ namespace sdf
   bool convertString(const std::string &_sdfString,
                      const std::string &_version, SDFPtr _sdf);
 
+  /// \brief Convert an element tree of an older SDFormat version, such as
+  /// one read with readStringWithoutConversion or built by a program, to
+  /// the latest version in place. The conversion recipes are applied to an
+  /// XML document built directly from the elements, without writing them
+  /// as text, and the result is read back into the element. Included
+  /// models are converted with their content, and are not marked as
+  /// included anymore.
+  /// \param[in,out] _elem Element to convert. It is converted from its
+  /// original version, or the one of its closest ancestor that has one.
+  /// \param[in] _config Configuration used to read the converted element.
+  /// \param[out] _errors Errors of the conversion and of the read.
+  /// \return True on success, including when the element already is at
+  /// the latest version.
+  SDFORMAT_VISIBLE
+  bool convertElement(ElementPtr _elem, const ParserConfig &_config,
+                      Errors &_errors);
+
+  /// \brief Convert an element tree of an older SDFormat version to the
+  /// latest version in place, with the default ParserConfig.
+  /// \param[in,out] _elem Element to convert.
+  /// \param[out] _errors Errors of the conversion and of the read.
+  /// \return True on success.
+  /// \sa convertElement(ElementPtr, const ParserConfig &, Errors &)
+  SDFORMAT_VISIBLE
+  bool convertElement(ElementPtr _elem, Errors &_errors);
+
   /// \brief Check that for each model, the canonical_link attribute value
   /// matches the name of a link in the model if the attribute is set and
   /// not empty.
@@ -224,6 +458,18 @@ namespace sdf
   SDFORMAT_VISIBLE
   bool checkFrameAttachedToGraph(const sdf::Root *_root);
 
+  /// \brief Same as checkFrameAttachedToGraph(const sdf::Root *), but checks
+  /// the graphs of the models and worlds concurrently. The errors are printed
+  /// in the same order as when checking on a single thread.
+  /// \param[in] _root sdf Root object to check recursively.
+  /// \param[in] _threadCount Maximum number of threads to use. A value of 0
+  /// uses one thread per hardware thread, and a value of 1 checks every
+  /// graph on the calling thread.
+  /// \return True if all attached_to graphs are valid.
+  SDFORMAT_VISIBLE
+  bool checkFrameAttachedToGraph(const sdf::Root *_root,
+      unsigned int _threadCount);
+
   /// \brief Check that for each frame, the attached_to attribute value
   /// does not match its own frame name but does match the name of a
   /// link, joint, or other frame in the model if the attribute is set and
@@ -256,6 +502,69 @@ namespace sdf
   SDFORMAT_VISIBLE
   bool checkPoseRelativeToGraph(const sdf::Root *_root);
 
+  /// \brief Same as checkPoseRelativeToGraph(const sdf::Root *), but checks the
+  /// graphs of the models and worlds concurrently. The errors are printed
+  /// in the same order as when checking on a single thread.
+  /// \param[in] _root sdf Root object to check recursively.
+  /// \param[in] _threadCount Maximum number of threads to use. A value of 0
+  /// uses one thread per hardware thread, and a value of 1 checks every
+  /// graph on the calling thread.
+  /// \return True if all relative_to graphs are valid.
+  SDFORMAT_VISIBLE
+  bool checkPoseRelativeToGraph(const sdf::Root *_root,
+      unsigned int _threadCount);
+
+  /// \brief Run checkCanonicalLinkNames, checkJointParentChildLinkNames,
+  /// checkFrameAttachedToGraph, checkPoseRelativeToGraph and
+  /// recursiveSiblingUniqueNames on the element of a root in a single
+  /// traversal, as `ign sdf --check` does. The models, the graphs and the
+  /// element tree are checked concurrently, and the errors are printed to
+  /// std::cerr in the order the checks would print them one after the
+  /// other.
+  /// \param[in] _root sdf Root object to check.
+  /// \param[in] _threadCount Maximum number of threads to use. A value of 0
+  /// uses one thread per hardware thread, and a value of 1 runs every check
+  /// on the calling thread.
+  /// \param[out] _failed The names of the checks that failed, such as
+  /// "checkCanonicalLinkNames", are appended to this vector.
+  /// \return True if all checks passed.
+  SDFORMAT_VISIBLE
+  bool checkRoot(const sdf::Root *_root, unsigned int _threadCount,
+      std::vector<std::string> &_failed);
+
+  /// \brief Write the FrameAttachedTo graph that Root::Load built for the
+  /// first world of a root, or for its model if it has no world, in the DOT
+  /// format of graphviz. Vertices are written in order of id followed by
+  /// the edges, one line at a time, so that large graphs aren't held in
+  /// memory twice.
+  /// \param[in] _root Loaded root.
+  /// \param[out] _out Stream to write to.
+  /// \param[in] _scope Name of a model as written in the graph, such as
+  /// "M1::CM1", to only write the vertex of the model and the vertices in
+  /// its scope, with the edges between them. Empty to write the whole
+  /// graph.
+  /// \param[in] _depth Maximum number of "::" separators that the names of
+  /// the written vertices have below _scope, so that 0 only writes the
+  /// frames of the scope and the vertices of its nested models, without
+  /// their content. Negative to write every depth.
+  /// \return False if the root has no graph, or _scope is not in it.
+  SDFORMAT_VISIBLE
+  bool writeFrameAttachedToGraph(const sdf::Root *_root, std::ostream &_out,
+      const std::string &_scope = "", int _depth = -1);
+
+  /// \brief Write the PoseRelativeTo graph that Root::Load built for the
+  /// first world of a root, or for its model if it has no world, in the DOT
+  /// format of graphviz, like writeFrameAttachedToGraph.
+  /// \param[in] _root Loaded root.
+  /// \param[out] _out Stream to write to.
+  /// \param[in] _scope Name of a model as written in the graph, or empty.
+  /// \param[in] _depth Maximum depth of the written vertices below _scope,
+  /// or negative.
+  /// \return False if the root has no graph, or _scope is not in it.
+  SDFORMAT_VISIBLE
+  bool writePoseRelativeToGraph(const sdf::Root *_root, std::ostream &_out,
+      const std::string &_scope = "", int _depth = -1);
+
   /// \brief Check that all sibling elements of the same type have unique names.
   /// This checks recursively and should check the files exhaustively
   /// rather than terminating early when the first duplicate name is found.
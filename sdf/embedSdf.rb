@@ -8,38 +8,64 @@ supportedSdfVersions = ['1.8', '1.7', '1.6', '1.5', '1.4', '1.3', '1.2']
 # a user can convert an existing SDF version to.
 supportedSdfConversions = ['1.8', '1.7', '1.6', '1.5', '1.4', '1.3']
 
+# The supported *.sdf and *.convert files. They are sorted by pathname, so
+# that FindEmbeddedSdf can use a binary search.
+files = []
+supportedSdfVersions.each do |version|
+  files.concat(Dir.glob("#{version}/*.sdf"))
+end
+supportedSdfConversions.each do |version|
+  files.concat(Dir.glob("#{version}/*.convert"))
+end
+files = files.uniq.sort
+
 puts %q!
+#include <algorithm>
+#include <string_view>
+
 #include "EmbeddedSdf.hh"
 
+using namespace std::literals::string_view_literals;
+
 namespace sdf {
 inline namespace SDF_VERSION_NAMESPACE {
 
-const std::map<std::string, std::string> &GetEmbeddedSdf() {
-  static const std::map<std::string, std::string> result{
+namespace {
+constexpr EmbeddedSdfFile kEmbeddedSdfFiles[] = {
 !
 
-# Stores the contents of the file in the map.
+# Stores the contents of the file in the table.
 def embed(pathname)
-  puts "{\"#{pathname}\", R\"__sdf_literal__("
+  puts "{\"#{pathname}\"sv, R\"__sdf_literal__("
   infile = File.open(pathname)
   puts infile.read
-  puts ")__sdf_literal__\"},"
+  puts ")__sdf_literal__\"sv},"
 end
 
-# Embed the supported *.sdf files.
-supportedSdfVersions.each do |version|
-  Dir.glob("#{version}/*.sdf").sort.each { |file| embed(file) }
-end
+files.each { |file| embed(file) }
 
-# Embed the supported *.convert files.
-supportedSdfConversions.each do |version|
-  Dir.glob("#{version}/*.convert").sort.each { |file| embed(file) }
-end
-puts %q!
-  };
+puts <<'CPP'
+};
+}  // namespace
+
+const EmbeddedSdfFiles &GetEmbeddedSdf() {
+  static const EmbeddedSdfFiles result{kEmbeddedSdfFiles,
+    sizeof(kEmbeddedSdfFiles) / sizeof(kEmbeddedSdfFiles[0])};
   return result;
 }
 
+std::string_view FindEmbeddedSdf(std::string_view _pathname) {
+  const EmbeddedSdfFiles &files = GetEmbeddedSdf();
+  auto it = std::lower_bound(files.begin(), files.end(), _pathname,
+      [](const EmbeddedSdfFile &_file, std::string_view _name)
+      {
+        return _file.pathname < _name;
+      });
+  if (it == files.end() || it->pathname != _pathname)
+    return std::string_view();
+  return it->data;
+}
+
 }
 }
-!
+CPP
@@ -0,0 +1,152 @@
+#!/usr/bin/env ruby
+
+# Generates SpecTables.cc, which holds the element descriptions of the
+# supported *.sdf files as constant tables, so that sdf::init does not have
+# to parse the XML of the spec files. The tables are read by parser.cc
+# through SpecTables.hh, and must describe the same elements that initXml
+# reads from the XML.
+
+require 'rexml/document'
+
+# The list of supported SDF specification versions. Keep in sync with
+# embedSdf.rb.
+supportedSdfVersions = ['1.8', '1.7', '1.6', '1.5', '1.4', '1.3', '1.2']
+
+NO_STRING = 'kSpecNoString'
+
+$strings = {}
+$stringData = []
+$elements = []
+$attributes = []
+$children = []
+
+# Get the offset of a string in the string table, adding it if needed.
+def string(value)
+  return NO_STRING if value.nil?
+  unless $strings.key?(value)
+    $strings[value] = $stringData.size
+    # Bytes are written as signed values, which is what char holds.
+    $stringData.concat(value.bytes.map { |b| b > 127 ? b - 256 : b })
+    $stringData.push(0)
+  end
+  $strings[value].to_s
+end
+
+# Get the text of an element, like tinyxml2's GetText: the first child, if it
+# is text. tinyxml2 drops text that is only whitespace, so skip it here too.
+def text(element)
+  return nil if element.nil?
+  first = element.children.find do |node|
+    !node.is_a?(REXML::Text) || node.is_a?(REXML::CData) ||
+      !node.value.strip.empty?
+  end
+  first.is_a?(REXML::Text) ? first.value : nil
+end
+
+# Get the first child element with a given name.
+def child(element, name)
+  element.elements.each { |e| return e if e.name == name }
+  nil
+end
+
+# Add an <element> and its children to the tables, and return its index.
+def addElement(xml)
+  index = $elements.size
+  $elements.push(nil)
+
+  description = text(child(xml, 'description'))
+  elemType = xml.attributes['type']
+  required = xml.attributes['required']
+
+  attributeRows = []
+  xml.elements.each('attribute') do |attr|
+    attributeRows.push([string(attr.attributes['name']),
+                        string(attr.attributes['type']),
+                        string(attr.attributes['default']),
+                        string(text(child(attr, 'description'))),
+                        attr.attributes['required'].to_s.strip == '1'])
+  end
+  firstAttribute = $attributes.size
+  $attributes.concat(attributeRows)
+
+  # Elements come before includes, as initXml reads them.
+  copyChildren = false
+  childRows = []
+  xml.elements.each('element') do |elem|
+    copyData = elem.attributes['copy_data']
+    if copyData == 'true' || copyData == '1'
+      copyChildren = true
+    else
+      childRows.push([addElement(elem).to_s, NO_STRING, NO_STRING, NO_STRING])
+    end
+  end
+  xml.elements.each('include') do |incl|
+    descriptionXml = child(incl, 'description')
+    includeDescription =
+      descriptionXml.nil? ? NO_STRING : string(text(descriptionXml).to_s)
+    childRows.push(['kSpecNoElement', string(incl.attributes['filename']),
+                    includeDescription, string(incl.attributes['required'])])
+  end
+  firstChild = $children.size
+  $children.concat(childRows)
+
+  $elements[index] = [
+    string(xml.attributes['name']),
+    string(required),
+    string(xml.attributes['ref']),
+    string(elemType),
+    elemType.nil? ? NO_STRING : string(xml.attributes['default'].to_s),
+    string(xml.attributes['min'].to_s),
+    string(xml.attributes['max'].to_s),
+    string(description),
+    required == '1',
+    copyChildren,
+    firstAttribute, attributeRows.size,
+    firstChild, childRows.size]
+  index
+end
+
+# Add the root element of every supported *.sdf file, sorted by version and
+# file name so that they can be looked up by binary search.
+files = []
+supportedSdfVersions.sort.each do |version|
+  Dir.glob("#{version}/*.sdf").sort.each do |pathname|
+    doc = REXML::Document.new(File.read(pathname))
+    root = doc.root
+    next if root.nil? || root.name != 'element'
+    files.push([string(version), string(File.basename(pathname)),
+                addElement(root)])
+  end
+end
+
+puts %q!
+#include "SpecTables.hh"
+
+namespace sdf {
+inline namespace SDF_VERSION_NAMESPACE {
+
+namespace {
+
+constexpr char kStrings[] = {!
+$stringData.each_slice(20) { |slice| puts "  #{slice.join(', ')}," }
+puts "};\n\nconstexpr SpecFile kFiles[] = {"
+files.each { |row| puts "  {#{row.join(', ')}}," }
+puts "};\n\nconstexpr SpecElement kElements[] = {"
+$elements.each { |row| puts "  {#{row.join(', ')}}," }
+puts "};\n\nconstexpr SpecAttribute kAttributes[] = {"
+$attributes.each { |row| puts "  {#{row.join(', ')}}," }
+puts "};\n\nconstexpr SpecChild kChildren[] = {"
+$children.each { |row| puts "  {#{row.join(', ')}}," }
+puts %q!};
+}
+
+const SpecTables &GetSpecTables() {
+  static constexpr SpecTables tables{kStrings,
+      kFiles, sizeof(kFiles) / sizeof(kFiles[0]),
+      kElements, kAttributes, kChildren};
+  return tables;
+}
+
+}
+}
+!
@@ -14,11 +14,16 @@
  * limitations under the License.
  *
 */
+#include <algorithm>
 #include <string>
 #include <vector>
 #include <ignition/math/Pose3.hh>
+#include <ignition/math/Quaternion.hh>
+#include <ignition/math/Vector3.hh>
 #include "sdf/Actor.hh"
 #include "sdf/Error.hh"
+#include "ElementRetentionScope.hh"
+#include "LoadStatsScope.hh"
 #include "Utils.hh"
 
 using namespace sdf;
@@ -66,6 +71,41 @@ class sdf::TrajectoryPrivate
 
     /// \brief Each points in the trajectory.
     public: std::vector<Waypoint> waypoints;
+
+    /// \brief Insert a waypoint in the sampling arrays, after the waypoints
+    /// with the same time, and update the affected tangents.
+    /// \param[in] _waypoint Waypoint to insert.
+    public: void Insert(const Waypoint &_waypoint);
+
+    /// \brief Rebuild the sampling arrays from the waypoints.
+    public: void Rebuild();
+
+    /// \brief Compute the spline tangent of a sorted waypoint.
+    /// \param[in] _index Index in the sampling arrays.
+    public: void UpdateTangent(std::size_t _index);
+
+    /// \brief Find the segment [times[i], times[i + 1]] of a time.
+    /// \param[in] _time Time to search.
+    /// \param[in] _hint Segment to start searching from.
+    /// \return Index i of the segment. Requires at least two waypoints.
+    public: std::size_t Segment(double _time, std::size_t _hint) const;
+
+    /// \brief Interpolate the pose in a segment.
+    /// \param[in] _time Time in the segment.
+    /// \param[in] _segment Index of the segment.
+    /// \return Interpolated pose.
+    public: ignition::math::Pose3d Interpolate(double _time,
+                std::size_t _segment) const;
+
+    /// \brief Times of the waypoints, sorted.
+    public: std::vector<double> times;
+
+    /// \brief Poses of the waypoints, in the order of times.
+    public: std::vector<ignition::math::Pose3d> poses;
+
+    /// \brief Velocity of the position spline at each waypoint, in the
+    /// order of times.
+    public: std::vector<ignition::math::Vector3d> tangents;
 };
 
 /// \brief Actor private data.
@@ -166,6 +206,7 @@ void Animation::CopyFrom(const Animation &_animation)
 /////////////////////////////////////////////////
 Errors Animation::Load(ElementPtr _sdf)
 {
+  DomLoadTimer timer("Animation");
   Errors errors;
 
   if (!loadName(_sdf, this->dataPtr->name))
@@ -303,6 +344,7 @@ void Waypoint::CopyFrom(const Waypoint &_waypoint)
 /////////////////////////////////////////////////
 Errors Waypoint::Load(ElementPtr _sdf)
 {
+  DomLoadTimer timer("Waypoint");
   Errors errors;
 
   std::pair timeValue = _sdf->Get<double>("time", this->dataPtr->time);
@@ -395,11 +437,15 @@ void Trajectory::CopyFrom(const Trajectory &_trajectory)
   this->dataPtr->type = _trajectory.dataPtr->type;
   this->dataPtr->tension = _trajectory.dataPtr->tension;
   this->dataPtr->waypoints = _trajectory.dataPtr->waypoints;
+  this->dataPtr->times = _trajectory.dataPtr->times;
+  this->dataPtr->poses = _trajectory.dataPtr->poses;
+  this->dataPtr->tangents = _trajectory.dataPtr->tangents;
 }
 
 /////////////////////////////////////////////////
 Errors Trajectory::Load(ElementPtr _sdf)
 {
+  DomLoadTimer timer("Trajectory");
   Errors errors;
 
   std::pair idValue = _sdf->Get<uint64_t>("id", this->dataPtr->id);
@@ -427,6 +473,8 @@ Errors Trajectory::Load(ElementPtr _sdf)
   errors.insert(errors.end(), waypointLoadErrors.begin(),
                     waypointLoadErrors.end());
 
+  this->dataPtr->Rebuild();
+
   return errors;
 }
 
@@ -464,6 +512,8 @@ double Trajectory::Tension() const
 void Trajectory::SetTension(double _tension)
 {
   this->dataPtr->tension = _tension;
+  for (std::size_t i = 0; i < this->dataPtr->tangents.size(); ++i)
+    this->dataPtr->UpdateTangent(i);
 }
 
 /////////////////////////////////////////////////
@@ -484,6 +534,153 @@ const Waypoint *Trajectory::WaypointByIndex(uint64_t _index) const
 void Trajectory::AddWaypoint(const Waypoint &_waypoint)
 {
   this->dataPtr->waypoints.push_back(_waypoint);
+  this->dataPtr->Insert(_waypoint);
+}
+
+/////////////////////////////////////////////////
+ignition::math::Pose3d Trajectory::Sample(double _time) const
+{
+  uint64_t segment = 0;
+  return this->Sample(_time, segment);
+}
+
+/////////////////////////////////////////////////
+ignition::math::Pose3d Trajectory::Sample(double _time,
+    uint64_t &_segment) const
+{
+  const std::vector<double> &times = this->dataPtr->times;
+  if (times.empty())
+    return ignition::math::Pose3d::Zero;
+  if (_time <= times.front())
+  {
+    _segment = 0;
+    return this->dataPtr->poses.front();
+  }
+  if (_time >= times.back())
+  {
+    _segment = times.size() - 1;
+    return this->dataPtr->poses.back();
+  }
+
+  _segment = this->dataPtr->Segment(_time, _segment);
+  return this->dataPtr->Interpolate(_time, _segment);
+}
+
+/////////////////////////////////////////////////
+void Trajectory::SampleAll(const std::vector<double> &_times,
+    std::vector<ignition::math::Pose3d> &_poses) const
+{
+  _poses.resize(_times.size());
+  uint64_t segment = 0;
+  for (std::size_t i = 0; i < _times.size(); ++i)
+    _poses[i] = this->Sample(_times[i], segment);
+}
+
+/////////////////////////////////////////////////
+void TrajectoryPrivate::Insert(const Waypoint &_waypoint)
+{
+  // Waypoints are usually added in order, making this an append.
+  const std::size_t index = static_cast<std::size_t>(
+      std::upper_bound(this->times.begin(), this->times.end(),
+        _waypoint.Time()) - this->times.begin());
+  this->times.insert(this->times.begin() + index, _waypoint.Time());
+  this->poses.insert(this->poses.begin() + index, _waypoint.Pose());
+  this->tangents.insert(this->tangents.begin() + index,
+      ignition::math::Vector3d::Zero);
+
+  // Only the tangents of the neighbors depend on the new waypoint.
+  const std::size_t first = index > 0 ? index - 1 : 0;
+  const std::size_t last = std::min(index + 1, this->times.size() - 1);
+  for (std::size_t i = first; i <= last; ++i)
+    this->UpdateTangent(i);
+}
+
+/////////////////////////////////////////////////
+void TrajectoryPrivate::Rebuild()
+{
+  std::vector<std::size_t> order(this->waypoints.size());
+  for (std::size_t i = 0; i < order.size(); ++i)
+    order[i] = i;
+  std::stable_sort(order.begin(), order.end(),
+      [this](std::size_t _a, std::size_t _b)
+      {
+        return this->waypoints[_a].Time() < this->waypoints[_b].Time();
+      });
+
+  this->times.resize(order.size());
+  this->poses.resize(order.size());
+  this->tangents.resize(order.size());
+  for (std::size_t i = 0; i < order.size(); ++i)
+  {
+    this->times[i] = this->waypoints[order[i]].Time();
+    this->poses[i] = this->waypoints[order[i]].Pose();
+  }
+  for (std::size_t i = 0; i < order.size(); ++i)
+    this->UpdateTangent(i);
+}
+
+/////////////////////////////////////////////////
+void TrajectoryPrivate::UpdateTangent(std::size_t _index)
+{
+  // Finite difference of the neighbors, one sided at the ends.
+  const std::size_t prev = _index > 0 ? _index - 1 : 0;
+  const std::size_t next = std::min(_index + 1, this->times.size() - 1);
+  const double dt = this->times[next] - this->times[prev];
+  if (dt <= 0.0)
+  {
+    this->tangents[_index] = ignition::math::Vector3d::Zero;
+    return;
+  }
+  this->tangents[_index] = (this->poses[next].Pos() -
+      this->poses[prev].Pos()) * ((1.0 - this->tension) / dt);
+}
+
+/////////////////////////////////////////////////
+std::size_t TrajectoryPrivate::Segment(double _time, std::size_t _hint) const
+{
+  const std::size_t lastSegment = this->times.size() - 2;
+  if (_hint <= lastSegment && this->times[_hint] <= _time)
+  {
+    // Walk forward a few segments before falling back to a search.
+    for (int step = 0; step < 4; ++step)
+    {
+      if (_hint == lastSegment || _time < this->times[_hint + 1])
+        return _hint;
+      ++_hint;
+    }
+  }
+
+  auto it = std::upper_bound(this->times.begin(), this->times.end(), _time);
+  return std::min(static_cast<std::size_t>(it - this->times.begin()) - 1,
+      lastSegment);
+}
+
+/////////////////////////////////////////////////
+ignition::math::Pose3d TrajectoryPrivate::Interpolate(double _time,
+    std::size_t _segment) const
+{
+  const double t0 = this->times[_segment];
+  const double h = this->times[_segment + 1] - t0;
+  if (h <= 0.0)
+    return this->poses[_segment + 1];
+
+  // Cubic Hermite basis functions.
+  const double s = (_time - t0) / h;
+  const double s2 = s * s;
+  const double s3 = s2 * s;
+  const double h00 = 2 * s3 - 3 * s2 + 1;
+  const double h10 = s3 - 2 * s2 + s;
+  const double h01 = -2 * s3 + 3 * s2;
+  const double h11 = s3 - s2;
+
+  const ignition::math::Pose3d &p0 = this->poses[_segment];
+  const ignition::math::Pose3d &p1 = this->poses[_segment + 1];
+  const ignition::math::Vector3d pos =
+      p0.Pos() * h00 + this->tangents[_segment] * (h10 * h) +
+      p1.Pos() * h01 + this->tangents[_segment + 1] * (h11 * h);
+
+  return ignition::math::Pose3d(pos,
+      ignition::math::Quaterniond::Slerp(s, p0.Rot(), p1.Rot(), true));
 }
 
 /////////////////////////////////////////////////
@@ -544,9 +741,10 @@ void Actor::CopyFrom(const Actor &_actor)
 /////////////////////////////////////////////////
 Errors Actor::Load(ElementPtr _sdf)
 {
+  DomLoadTimer timer("Actor");
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
   this->dataPtr->filePath = _sdf->FilePath();
 
   if (_sdf->GetName() != "actor")
@@ -565,7 +763,7 @@ Errors Actor::Load(ElementPtr _sdf)
 
   loadPose(_sdf, this->dataPtr->pose, this->dataPtr->poseRelativeTo);
 
-  sdf::ElementPtr skinElem = _sdf->GetElement("skin");
+  sdf::ElementConstPtr skinElem = _sdf->GetElementOrDefault("skin");
 
   if (skinElem)
   {
@@ -590,7 +788,7 @@ Errors Actor::Load(ElementPtr _sdf)
   errors.insert(errors.end(), animationLoadErrors.begin(),
                     animationLoadErrors.end());
 
-  sdf::ElementPtr scriptElem = _sdf->GetElement("script");
+  sdf::ElementConstPtr scriptElem = _sdf->GetElementOrDefault("script");
 
   if (!scriptElem)
   {
@@ -608,11 +806,15 @@ Errors Actor::Load(ElementPtr _sdf)
     this->dataPtr->scriptAutoStart = scriptElem->Get<bool>("auto_start",
         this->dataPtr->scriptAutoStart).first;
 
-    Errors trajectoryLoadErrors = loadRepeated<Trajectory>(scriptElem,
-        "trajectory", this->dataPtr->trajectories);
+    // A default <script> has no trajectories.
+    if (sdf::ElementPtr scriptChild = _sdf->GetElementImpl("script"))
+    {
+      Errors trajectoryLoadErrors = loadRepeated<Trajectory>(scriptChild,
+          "trajectory", this->dataPtr->trajectories);
 
-    errors.insert(errors.end(), trajectoryLoadErrors.begin(),
-                      trajectoryLoadErrors.end());
+      errors.insert(errors.end(), trajectoryLoadErrors.begin(),
+                        trajectoryLoadErrors.end());
+    }
   }
 
   Errors linkLoadErrors = loadRepeated<Link>(_sdf, "link",
@@ -16,6 +16,7 @@
 */
 
 #include <gtest/gtest.h>
+#include <vector>
 #include <ignition/math/Pose3.hh>
 #include "sdf/Actor.hh"
 
@@ -502,3 +503,58 @@ TEST(DOMTrajectory, CopyAssignmentAfterMove)
   EXPECT_TRUE(TrajectoriesEqual(sdf::Trajectory(), trajectory1));
   EXPECT_TRUE(TrajectoriesEqual(CreateDummyTrajectory(), trajectory2));
 }
+
+/////////////////////////////////////////////////
+TEST(DOMTrajectory, Sample)
+{
+  sdf::Trajectory trajectory;
+  EXPECT_EQ(ignition::math::Pose3d::Zero, trajectory.Sample(1.0));
+
+  // Waypoints added out of order are sampled by time, but keep their index.
+  sdf::Waypoint waypoint;
+  waypoint.SetTime(2.0);
+  waypoint.SetPose({2, 0, 0, 0, 0, 0});
+  trajectory.AddWaypoint(waypoint);
+  waypoint.SetTime(0.0);
+  waypoint.SetPose({0, 0, 0, 0, 0, 0});
+  trajectory.AddWaypoint(waypoint);
+  waypoint.SetTime(1.0);
+  waypoint.SetPose({1, 0, 0, 0, 0, 0});
+  trajectory.AddWaypoint(waypoint);
+  ASSERT_NE(nullptr, trajectory.WaypointByIndex(0));
+  EXPECT_DOUBLE_EQ(2.0, trajectory.WaypointByIndex(0)->Time());
+
+  // Outside of the trajectory, the poses of the ends are used.
+  EXPECT_EQ(ignition::math::Pose3d(0, 0, 0, 0, 0, 0), trajectory.Sample(-1));
+  EXPECT_EQ(ignition::math::Pose3d(2, 0, 0, 0, 0, 0), trajectory.Sample(5));
+  EXPECT_EQ(ignition::math::Pose3d(1, 0, 0, 0, 0, 0), trajectory.Sample(1));
+
+  // Evenly spaced waypoints on a line give a linear Catmull-Rom spline.
+  EXPECT_NEAR(0.25, trajectory.Sample(0.25).Pos().X(), 1e-9);
+  EXPECT_NEAR(1.5, trajectory.Sample(1.5).Pos().X(), 1e-9);
+
+  // A tension of 1 stops at every waypoint.
+  trajectory.SetTension(1.0);
+  EXPECT_NEAR(0.15625, trajectory.Sample(0.25).Pos().X(), 1e-9);
+  EXPECT_NEAR(0.5, trajectory.Sample(0.5).Pos().X(), 1e-9);
+
+  // Sampling with a hint gives the same poses.
+  uint64_t segment = 0;
+  EXPECT_NEAR(0.15625, trajectory.Sample(0.25, segment).Pos().X(), 1e-9);
+  EXPECT_EQ(0u, segment);
+  EXPECT_NEAR(1.15625, trajectory.Sample(1.25, segment).Pos().X(), 1e-9);
+  EXPECT_EQ(1u, segment);
+  EXPECT_NEAR(0.5, trajectory.Sample(0.5, segment).Pos().X(), 1e-9);
+  EXPECT_EQ(0u, segment);
+
+  std::vector<double> times = {0.0, 0.5, 1.0, 1.5, 2.0};
+  std::vector<ignition::math::Pose3d> poses;
+  trajectory.SampleAll(times, poses);
+  ASSERT_EQ(times.size(), poses.size());
+  for (std::size_t i = 0; i < times.size(); ++i)
+    EXPECT_NEAR(times[i], poses[i].Pos().X(), 1e-9);
+
+  // Copies sample the same poses.
+  sdf::Trajectory copy(trajectory);
+  EXPECT_NEAR(0.15625, copy.Sample(0.25).Pos().X(), 1e-9);
+}
@@ -17,6 +17,8 @@
 #include <array>
 #include <string>
 #include "sdf/AirPressure.hh"
+#include "ElementRetentionScope.hh"
+#include "LoadStatsScope.hh"
 
 using namespace sdf;
 
@@ -53,7 +55,7 @@ AirPressure::AirPressure(const AirPressure &_sensor)
 }
 
 //////////////////////////////////////////////////
-AirPressure::AirPressure(AirPressure &&_sensor)
+AirPressure::AirPressure(AirPressure &&_sensor) noexcept
   : dataPtr(std::exchange(_sensor.dataPtr, nullptr))
 {
 }
@@ -76,9 +78,10 @@ AirPressure &AirPressure::operator=(
 //////////////////////////////////////////////////
 Errors AirPressure::Load(ElementPtr _sdf)
 {
+  DomLoadTimer timer("AirPressure");
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that the provided SDF element is a <airPressure> element.
   // This is an error that cannot be recovered, so return an error.
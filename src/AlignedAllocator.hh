@@ -0,0 +1,85 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_ALIGNED_ALLOCATOR_HH_
+#define SDF_ALIGNED_ALLOCATOR_HH_
+
+#include <cstddef>
+#include <new>
+
+#include "sdf/sdf_config.h"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief Alignment of arrays read by SIMD code, which is that of cache
+  /// lines and of the widest SIMD registers.
+  constexpr std::size_t kCacheLineAlignment = 64;
+
+  /// \brief Allocator of over-aligned memory for std::vector.
+  template<typename T>
+  class AlignedAllocator
+  {
+    /// \brief Type of the allocated elements.
+    public: using value_type = T;
+
+    /// \brief Constructor.
+    public: AlignedAllocator() = default;
+
+    /// \brief Converting constructor, for allocators of other types.
+    public: template<typename U>
+            AlignedAllocator(const AlignedAllocator<U> &)
+    {
+    }
+
+    /// \brief Allocate memory.
+    /// \param[in] _count Number of elements.
+    /// \return Memory aligned to kCacheLineAlignment.
+    public: T *allocate(std::size_t _count)
+    {
+      return static_cast<T *>(::operator new(_count * sizeof(T),
+          std::align_val_t(kCacheLineAlignment)));
+    }
+
+    /// \brief Free memory.
+    /// \param[in] _ptr Memory returned by allocate.
+    public: void deallocate(T *_ptr, std::size_t)
+    {
+      ::operator delete(_ptr, std::align_val_t(kCacheLineAlignment));
+    }
+
+    /// \brief All the allocators are interchangeable.
+    /// \return True.
+    public: template<typename U>
+            bool operator==(const AlignedAllocator<U> &) const
+    {
+      return true;
+    }
+
+    /// \brief All the allocators are interchangeable.
+    /// \return False.
+    public: template<typename U>
+            bool operator!=(const AlignedAllocator<U> &) const
+    {
+      return false;
+    }
+  };
+  }
+}
+#endif
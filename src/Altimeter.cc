@@ -17,6 +17,8 @@
 #include <array>
 #include <string>
 #include "sdf/Altimeter.hh"
+#include "ElementRetentionScope.hh"
+#include "LoadStatsScope.hh"
 
 using namespace sdf;
 
@@ -74,9 +76,10 @@ Altimeter &Altimeter::operator=(Altimeter &&_altimeter) noexcept
 //////////////////////////////////////////////////
 Errors Altimeter::Load(ElementPtr _sdf)
 {
+  DomLoadTimer timer("Altimeter");
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that the provided SDF element is a <altimeter> element.
   // This is an error that cannot be recovered, so return an error.
@@ -0,0 +1,446 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "sdf/Actor.hh"
+#include "sdf/AssetManifest.hh"
+#include "sdf/Collision.hh"
+#include "sdf/Element.hh"
+#include "sdf/Filesystem.hh"
+#include "sdf/Geometry.hh"
+#include "sdf/Heightmap.hh"
+#include "sdf/Link.hh"
+#include "sdf/Material.hh"
+#include "sdf/Mesh.hh"
+#include "sdf/Model.hh"
+#include "sdf/ParserConfig.hh"
+#include "sdf/Pbr.hh"
+#include "sdf/Population.hh"
+#include "sdf/Root.hh"
+#include "sdf/SDFImpl.hh"
+#include "sdf/Visual.hh"
+#include "sdf/World.hh"
+
+using namespace sdf;
+
+class sdf::AssetManifestPrivate
+{
+  /// \brief Remove all resources.
+  public: void Clear()
+  {
+    this->assets.clear();
+    this->byPath.clear();
+    this->byReference.clear();
+    this->referenceCount = 0;
+    this->errors.clear();
+  }
+
+  /// \brief Add a reference to a resource.
+  /// \param[in] _type Kind of the resource.
+  /// \param[in] _uri URI of the resource, as written in the document.
+  /// \param[in] _filePath File the reference was read from, which relative
+  /// URIs are resolved against.
+  public: void Add(AssetType _type, const std::string &_uri,
+                   const std::string &_filePath);
+
+  /// \brief Add the resources of a model and of its nested models.
+  /// \param[in] _model The model.
+  public: void AddModel(const Model &_model);
+
+  /// \brief Add the resources of the visuals and collisions of a link.
+  /// \param[in] _link The link.
+  public: void AddLink(const Link &_link);
+
+  /// \brief Add the mesh or heightmap of a geometry.
+  /// \param[in] _geom The geometry.
+  public: void AddGeometry(const Geometry &_geom);
+
+  /// \brief Add the scripts and textures of a material.
+  /// \param[in] _material The material.
+  public: void AddMaterial(const Material &_material);
+
+  /// \brief Add the skin, animations and links of an actor.
+  /// \param[in] _actor The actor.
+  public: void AddActor(const Actor &_actor);
+
+  /// \brief Add the models, populations and actors of a world.
+  /// \param[in] _world The world.
+  public: void AddWorld(const World &_world);
+
+  /// \brief Find the absolute path of a resource.
+  /// \param[in] _uri URI of the resource.
+  /// \param[in] _dir Directory of the file the reference was read from.
+  /// \return Absolute path, or an empty string if it is not found.
+  public: std::string Resolve(const std::string &_uri,
+                              const std::string &_dir) const;
+
+  /// \brief Resources, in the order of their first reference.
+  public: std::vector<Asset> assets;
+
+  /// \brief Index of each resource in assets by its resolved path.
+  public: std::unordered_map<std::string, std::size_t> byPath;
+
+  /// \brief Index of the resource of each URI, keyed by the directory it
+  /// is resolved against and the URI, so that a URI is only resolved once.
+  public: std::unordered_map<std::string, std::size_t> byReference;
+
+  /// \brief Number of references to all resources.
+  public: std::size_t referenceCount = 0;
+
+  /// \brief Errors of the resources that could not be found.
+  public: Errors errors;
+
+  /// \brief Configuration the resources are found with, set while
+  /// building.
+  public: const ParserConfig *config = nullptr;
+};
+
+/////////////////////////////////////////////////
+/// \brief Check whether a URI names a remote resource, which isn't looked
+/// up locally.
+/// \param[in] _uri URI to check.
+/// \return True if _uri has a network scheme.
+static bool isRemote(const std::string &_uri)
+{
+  return _uri.compare(0, 7, "http://") == 0 ||
+    _uri.compare(0, 8, "https://") == 0 ||
+    _uri.compare(0, 6, "ftp://") == 0;
+}
+
+/////////////////////////////////////////////////
+/// \brief Check whether a path is absolute.
+/// \param[in] _path Path to check.
+/// \return True if _path is absolute.
+static bool isAbsolute(const std::string &_path)
+{
+  return (!_path.empty() && (_path[0] == '/' || _path[0] == '\\')) ||
+    (_path.size() > 2 && _path[1] == ':' &&
+     (_path[2] == '/' || _path[2] == '\\'));
+}
+
+/////////////////////////////////////////////////
+std::string AssetManifestPrivate::Resolve(const std::string &_uri,
+    const std::string &_dir) const
+{
+  std::string uri = _uri;
+  const std::string fileScheme = "file://";
+  if (uri.compare(0, fileScheme.size(), fileScheme) == 0)
+    uri = uri.substr(fileScheme.size());
+
+  if (isAbsolute(uri))
+    return sdf::filesystem::exists(uri) ? uri : std::string();
+
+  if (uri.find("://") == std::string::npos && !_dir.empty())
+  {
+    const std::string path = sdf::filesystem::append(_dir, uri);
+    if (sdf::filesystem::exists(path))
+      return path;
+  }
+
+  return sdf::findFile(uri, true, true, *this->config);
+}
+
+/////////////////////////////////////////////////
+void AssetManifestPrivate::Add(AssetType _type, const std::string &_uri,
+    const std::string &_filePath)
+{
+  if (_uri.empty() || _uri == "__default__")
+    return;
+
+  ++this->referenceCount;
+
+  // Relative URIs depend on the file they are written in, others don't.
+  const bool relative = _uri.find("://") == std::string::npos &&
+    !isAbsolute(_uri);
+  std::string dir;
+  if (relative)
+  {
+    const std::size_t slash = _filePath.find_last_of("/\\");
+    if (slash != std::string::npos)
+      dir = _filePath.substr(0, slash);
+  }
+
+  const std::string reference = dir + '\n' + _uri;
+  auto known = this->byReference.find(reference);
+  if (known != this->byReference.end())
+  {
+    ++this->assets[known->second].references;
+    return;
+  }
+
+  std::string path;
+  if (!isRemote(_uri))
+  {
+    path = this->Resolve(_uri, dir);
+    if (path.empty())
+    {
+      this->errors.push_back({ErrorCode::URI_LOOKUP,
+          "Unable to find asset [" + _uri + "] referenced in [" +
+          _filePath + "]"});
+    }
+  }
+
+  if (!path.empty())
+  {
+    auto iter = this->byPath.find(path);
+    if (iter != this->byPath.end())
+    {
+      ++this->assets[iter->second].references;
+      this->byReference[reference] = iter->second;
+      return;
+    }
+    this->byPath[path] = this->assets.size();
+  }
+
+  this->byReference[reference] = this->assets.size();
+  Asset asset;
+  asset.type = _type;
+  asset.uri = _uri;
+  asset.path = path;
+  asset.references = 1;
+  this->assets.push_back(std::move(asset));
+}
+
+/////////////////////////////////////////////////
+void AssetManifestPrivate::AddGeometry(const Geometry &_geom)
+{
+  if (_geom.MeshShape())
+  {
+    this->Add(AssetType::MESH, _geom.MeshShape()->Uri(),
+        _geom.MeshShape()->FilePath());
+  }
+
+  const Heightmap *heightmap = _geom.HeightmapShape();
+  if (!heightmap)
+    return;
+
+  const std::string &filePath = heightmap->FilePath();
+  this->Add(AssetType::HEIGHTMAP, heightmap->Uri(), filePath);
+  for (uint64_t i = 0; i < heightmap->TextureCount(); ++i)
+  {
+    const HeightmapTexture *texture = heightmap->TextureByIndex(i);
+    this->Add(AssetType::TEXTURE, texture->Diffuse(), filePath);
+    this->Add(AssetType::TEXTURE, texture->Normal(), filePath);
+  }
+}
+
+/////////////////////////////////////////////////
+void AssetManifestPrivate::AddMaterial(const Material &_material)
+{
+  ElementPtr elem = _material.Element();
+  const std::string filePath = elem ? elem->FilePath() : std::string();
+
+  // A script can list several files, while Material only keeps the first.
+  ElementPtr script = elem && elem->HasElement("script") ?
+    elem->GetElement("script") : ElementPtr();
+  if (script && script->HasElement("uri"))
+  {
+    for (ElementPtr uri = script->GetElement("uri"); uri;
+         uri = uri->GetNextElement("uri"))
+    {
+      this->Add(AssetType::MATERIAL_SCRIPT, uri->Get<std::string>(),
+          filePath);
+    }
+  }
+  else
+  {
+    this->Add(AssetType::MATERIAL_SCRIPT, _material.ScriptUri(), filePath);
+  }
+
+  this->Add(AssetType::TEXTURE, _material.NormalMap(), filePath);
+
+  const Pbr *pbr = _material.PbrMaterial();
+  if (!pbr)
+    return;
+
+  for (PbrWorkflowType type :
+       {PbrWorkflowType::METAL, PbrWorkflowType::SPECULAR})
+  {
+    const PbrWorkflow *workflow = pbr->Workflow(type);
+    if (!workflow)
+      continue;
+
+    for (const std::string &map :
+         {workflow->AlbedoMap(), workflow->NormalMap(),
+          workflow->EnvironmentMap(), workflow->AmbientOcclusionMap(),
+          workflow->RoughnessMap(), workflow->MetalnessMap(),
+          workflow->EmissiveMap(), workflow->GlossinessMap(),
+          workflow->SpecularMap()})
+    {
+      this->Add(AssetType::TEXTURE, map, filePath);
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+void AssetManifestPrivate::AddLink(const Link &_link)
+{
+  for (uint64_t i = 0; i < _link.VisualCount(); ++i)
+  {
+    const Visual *visual = _link.VisualByIndex(i);
+    if (visual->Geom())
+      this->AddGeometry(*visual->Geom());
+    if (visual->Material())
+      this->AddMaterial(*visual->Material());
+  }
+
+  for (uint64_t i = 0; i < _link.CollisionCount(); ++i)
+  {
+    const Collision *collision = _link.CollisionByIndex(i);
+    if (collision->Geom())
+      this->AddGeometry(*collision->Geom());
+  }
+}
+
+/////////////////////////////////////////////////
+void AssetManifestPrivate::AddModel(const Model &_model)
+{
+  for (uint64_t i = 0; i < _model.LinkCount(); ++i)
+    this->AddLink(*_model.LinkByIndex(i));
+
+  for (uint64_t i = 0; i < _model.ModelCount(); ++i)
+    this->AddModel(*_model.ModelByIndex(i));
+}
+
+/////////////////////////////////////////////////
+void AssetManifestPrivate::AddActor(const Actor &_actor)
+{
+  this->Add(AssetType::SKIN, _actor.SkinFilename(), _actor.FilePath());
+
+  for (uint64_t i = 0; i < _actor.AnimationCount(); ++i)
+  {
+    const Animation *animation = _actor.AnimationByIndex(i);
+    this->Add(AssetType::ANIMATION, animation->Filename(),
+        animation->FilePath());
+  }
+
+  for (uint64_t i = 0; i < _actor.LinkCount(); ++i)
+    this->AddLink(*_actor.LinkByIndex(i));
+}
+
+/////////////////////////////////////////////////
+void AssetManifestPrivate::AddWorld(const World &_world)
+{
+  for (uint64_t i = 0; i < _world.ModelCount(); ++i)
+    this->AddModel(*_world.ModelByIndex(i));
+
+  for (uint64_t i = 0; i < _world.PopulationCount(); ++i)
+  {
+    const Model *model = _world.PopulationByIndex(i)->ModelTemplate();
+    if (model)
+      this->AddModel(*model);
+  }
+
+  for (uint64_t i = 0; i < _world.ActorCount(); ++i)
+    this->AddActor(*_world.ActorByIndex(i));
+}
+
+/////////////////////////////////////////////////
+AssetManifest::AssetManifest()
+  : dataPtr(new AssetManifestPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+AssetManifest::AssetManifest(const AssetManifest &_manifest)
+  : dataPtr(new AssetManifestPrivate(*_manifest.dataPtr))
+{
+}
+
+/////////////////////////////////////////////////
+AssetManifest::AssetManifest(AssetManifest &&_manifest) noexcept
+  : dataPtr(std::exchange(_manifest.dataPtr, nullptr))
+{
+}
+
+/////////////////////////////////////////////////
+AssetManifest &AssetManifest::operator=(AssetManifest &&_manifest) noexcept
+{
+  std::swap(this->dataPtr, _manifest.dataPtr);
+  return *this;
+}
+
+/////////////////////////////////////////////////
+AssetManifest &AssetManifest::operator=(const AssetManifest &_manifest)
+{
+  return *this = AssetManifest(_manifest);
+}
+
+/////////////////////////////////////////////////
+AssetManifest::~AssetManifest()
+{
+  delete this->dataPtr;
+  this->dataPtr = nullptr;
+}
+
+/////////////////////////////////////////////////
+Errors AssetManifest::Build(const Root &_root)
+{
+  return this->Build(_root, ParserConfig());
+}
+
+/////////////////////////////////////////////////
+Errors AssetManifest::Build(const Root &_root, const ParserConfig &_config)
+{
+  this->dataPtr->Clear();
+  this->dataPtr->config = &_config;
+
+  for (uint64_t i = 0; i < _root.WorldCount(); ++i)
+    this->dataPtr->AddWorld(*_root.WorldByIndex(i));
+
+  for (uint64_t i = 0; i < _root.ModelCount(); ++i)
+    this->dataPtr->AddModel(*_root.ModelByIndex(i));
+
+  for (uint64_t i = 0; i < _root.ActorCount(); ++i)
+    this->dataPtr->AddActor(*_root.ActorByIndex(i));
+
+  this->dataPtr->config = nullptr;
+  return std::exchange(this->dataPtr->errors, Errors());
+}
+
+/////////////////////////////////////////////////
+std::size_t AssetManifest::AssetCount() const
+{
+  return this->dataPtr->assets.size();
+}
+
+/////////////////////////////////////////////////
+const Asset *AssetManifest::AssetByIndex(std::size_t _index) const
+{
+  if (_index >= this->dataPtr->assets.size())
+    return nullptr;
+  return &this->dataPtr->assets[_index];
+}
+
+/////////////////////////////////////////////////
+const Asset *AssetManifest::AssetByPath(const std::string &_path) const
+{
+  auto iter = this->dataPtr->byPath.find(_path);
+  if (iter == this->dataPtr->byPath.end())
+    return nullptr;
+  return &this->dataPtr->assets[iter->second];
+}
+
+/////////////////////////////////////////////////
+std::size_t AssetManifest::ReferenceCount() const
+{
+  return this->dataPtr->referenceCount;
+}
@@ -0,0 +1,130 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <string>
+
+#include "sdf/AssetManifest.hh"
+#include "sdf/Filesystem.hh"
+#include "sdf/ParserConfig.hh"
+#include "sdf/Root.hh"
+#include "test_config.h"
+
+/////////////////////////////////////////////////
+TEST(DOMAssetManifest, Construction)
+{
+  sdf::AssetManifest manifest;
+  EXPECT_EQ(0u, manifest.AssetCount());
+  EXPECT_EQ(0u, manifest.ReferenceCount());
+  EXPECT_EQ(nullptr, manifest.AssetByIndex(0));
+  EXPECT_EQ(nullptr, manifest.AssetByPath("/missing"));
+
+  sdf::Root root;
+  EXPECT_TRUE(manifest.Build(root).empty());
+  EXPECT_EQ(0u, manifest.AssetCount());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMAssetManifest, Build)
+{
+  const std::string dir = sdf::filesystem::append(PROJECT_BINARY_DIR,
+      "asset_manifest");
+  sdf::filesystem::create_directory(dir);
+  for (const char *name : {"body.dae", "albedo.png", "skin.dae"})
+  {
+    std::ofstream asset(sdf::filesystem::append(dir, name));
+    asset << name;
+  }
+  const std::string body = sdf::filesystem::append(dir, "body.dae");
+
+  const std::string worldFile = sdf::filesystem::append(dir, "world.sdf");
+  {
+    std::ofstream world(worldFile);
+    world << "<?xml version='1.0'?>"
+      << "<sdf version='1.8'><world name='default'>"
+      << "<model name='m'><link name='l'>"
+      << "  <visual name='v1'><geometry><mesh><uri>body.dae</uri></mesh>"
+      << "    </geometry><material><pbr><metal>"
+      << "      <albedo_map>albedo.png</albedo_map>"
+      << "    </metal></pbr></material></visual>"
+      << "  <visual name='v2'><geometry><mesh><uri>" << body << "</uri>"
+      << "    </mesh></geometry></visual>"
+      << "  <collision name='c'><geometry><mesh><uri>body.dae</uri></mesh>"
+      << "    </geometry></collision>"
+      << "  <visual name='v3'><geometry><mesh>"
+      << "    <uri>https://example.com/remote.dae</uri></mesh></geometry>"
+      << "  </visual>"
+      << "  <visual name='v4'><geometry><mesh><uri>missing.dae</uri></mesh>"
+      << "    </geometry></visual>"
+      << "</link></model>"
+      << "<actor name='a'><skin><filename>skin.dae</filename></skin>"
+      << "  <animation name='walk'><filename>skin.dae</filename></animation>"
+      << "</actor>"
+      << "</world></sdf>";
+  }
+
+  sdf::Root root;
+  root.Load(worldFile);
+
+  sdf::AssetManifest manifest;
+  sdf::Errors errors = manifest.Build(root, sdf::ParserConfig());
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::URI_LOOKUP, errors[0].Code());
+  EXPECT_NE(std::string::npos, errors[0].Message().find("missing.dae"));
+
+  // Meshes, albedo map, remote mesh, missing mesh and the skin.
+  ASSERT_EQ(5u, manifest.AssetCount());
+  EXPECT_EQ(8u, manifest.ReferenceCount());
+
+  // The relative and absolute references to the mesh are one asset.
+  const sdf::Asset *mesh = manifest.AssetByIndex(0);
+  ASSERT_NE(nullptr, mesh);
+  EXPECT_EQ(sdf::AssetType::MESH, mesh->type);
+  EXPECT_EQ("body.dae", mesh->uri);
+  EXPECT_EQ(body, mesh->path);
+  EXPECT_EQ(3u, mesh->references);
+  EXPECT_EQ(mesh, manifest.AssetByPath(body));
+
+  const sdf::Asset *albedo = manifest.AssetByIndex(1);
+  ASSERT_NE(nullptr, albedo);
+  EXPECT_EQ(sdf::AssetType::TEXTURE, albedo->type);
+  EXPECT_EQ(sdf::filesystem::append(dir, "albedo.png"), albedo->path);
+
+  const sdf::Asset *remote = manifest.AssetByIndex(2);
+  ASSERT_NE(nullptr, remote);
+  EXPECT_EQ("https://example.com/remote.dae", remote->uri);
+  EXPECT_TRUE(remote->path.empty());
+
+  const sdf::Asset *missing = manifest.AssetByIndex(3);
+  ASSERT_NE(nullptr, missing);
+  EXPECT_TRUE(missing->path.empty());
+
+  // The skin and the animation share a file.
+  const sdf::Asset *skin = manifest.AssetByIndex(4);
+  ASSERT_NE(nullptr, skin);
+  EXPECT_EQ(sdf::AssetType::SKIN, skin->type);
+  EXPECT_EQ(2u, skin->references);
+
+  // Copies are independent, and building again replaces the content.
+  sdf::AssetManifest copy(manifest);
+  EXPECT_EQ(5u, copy.AssetCount());
+  EXPECT_TRUE(manifest.Build(sdf::Root()).empty());
+  EXPECT_EQ(0u, manifest.AssetCount());
+  EXPECT_EQ(5u, copy.AssetCount());
+}
@@ -18,6 +18,7 @@
 #include <string>
 #include <ignition/math/Helpers.hh>
 #include "sdf/Atmosphere.hh"
+#include "LoadStatsScope.hh"
 
 using namespace sdf;
 
@@ -83,6 +84,7 @@ Atmosphere &Atmosphere::operator=(Atmosphere &&_atmosphere)
 //////////////////////////////////////////////////
 Errors Atmosphere::Load(ElementPtr _sdf)
 {
+  DomLoadTimer timer("Atmosphere");
   Errors errors;
 
   // Check that the provided SDF element is a <atmosphere>
@@ -0,0 +1,661 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "BinarySnapshot.hh"
+
+using namespace sdf;
+
+namespace
+{
+  /// \brief First bytes of every snapshot.
+  const char kMagic[4] = {'S', 'D', 'F', 'B'};
+
+  /// \brief Version of the snapshot format. It must be incremented
+  /// whenever the layout of the records changes.
+  const std::uint32_t kFormatVersion = 1;
+
+  /// \brief Marker written in the byte order of the writer.
+  const std::uint32_t kByteOrder = 0x01020304;
+
+  /// \brief Flag of a parameter that has been set.
+  const std::uint8_t kParamSet = 1;
+
+  /// \brief Flag of a required parameter.
+  const std::uint8_t kParamRequired = 2;
+}
+
+/// \brief Encoder of the records of a snapshot. Strings are interned in a
+/// table, and records refer to them by index.
+class BinarySnapshot::Encoder
+{
+  /// \brief Append a value in its native representation.
+  /// \param[in] _value Value to append.
+  public: template<typename T>
+          void Put(const T &_value)
+  {
+    static_assert(std::is_trivially_copyable_v<T>,
+        "Only trivially copyable values can be encoded");
+    this->body.append(reinterpret_cast<const char *>(&_value), sizeof(T));
+  }
+
+  /// \brief Append the index of a string in the string table, adding the
+  /// string to the table if needed.
+  /// \param[in] _str String to append.
+  public: void PutString(const std::string &_str)
+  {
+    auto inserted = this->stringIndex.emplace(_str,
+        static_cast<std::uint32_t>(this->strings.size()));
+    if (inserted.second)
+    {
+      this->strings.push_back(&inserted.first->first);
+    }
+    this->Put(inserted.first->second);
+  }
+
+  /// \brief Encoded records.
+  public: std::string body;
+
+  /// \brief Strings of the table, in order of their index.
+  public: std::vector<const std::string *> strings;
+
+  /// \brief Index of each string of the table.
+  public: std::unordered_map<std::string, std::uint32_t> stringIndex;
+};
+
+/// \brief Decoder of the records of a snapshot. All reads are bounds
+/// checked, and a failed read leaves the decoder in a failed state.
+class BinarySnapshot::Decoder
+{
+  /// \brief Constructor.
+  /// \param[in] _data Content of the snapshot.
+  /// \param[in] _size Size of the content in bytes.
+  public: Decoder(const char *_data, std::size_t _size)
+    : data(_data), size(_size)
+  {
+  }
+
+  /// \brief Read a value in its native representation.
+  /// \param[out] _value Value read.
+  /// \return True if the value was read.
+  public: template<typename T>
+          bool Get(T &_value)
+  {
+    static_assert(std::is_trivially_copyable_v<T>,
+        "Only trivially copyable values can be decoded");
+    if (!this->ok || this->size - this->pos < sizeof(T))
+    {
+      this->ok = false;
+      return false;
+    }
+    std::memcpy(&_value, this->data + this->pos, sizeof(T));
+    this->pos += sizeof(T);
+    return true;
+  }
+
+  /// \brief Read a string stored inline, as a length followed by its
+  /// bytes.
+  /// \param[out] _str String read.
+  /// \return True if the string was read.
+  public: bool GetInlineString(std::string &_str)
+  {
+    std::uint32_t length = 0;
+    if (!this->Get(length) || this->size - this->pos < length)
+    {
+      this->ok = false;
+      return false;
+    }
+    _str.assign(this->data + this->pos, length);
+    this->pos += length;
+    return true;
+  }
+
+  /// \brief Read a reference to a string of the table.
+  /// \return The string, or an empty string if the read failed.
+  public: const std::string &GetString()
+  {
+    static const std::string empty;
+    std::uint32_t index = 0;
+    if (!this->Get(index) || index >= this->strings.size())
+    {
+      this->ok = false;
+      return empty;
+    }
+    return this->strings[index];
+  }
+
+  /// \brief Content of the snapshot.
+  public: const char *data;
+
+  /// \brief Size of the content.
+  public: std::size_t size;
+
+  /// \brief Read position.
+  public: std::size_t pos = 0;
+
+  /// \brief False once a read failed.
+  public: bool ok = true;
+
+  /// \brief String table.
+  public: std::vector<std::string> strings;
+};
+
+namespace
+{
+  /// \brief Append the native representation of a parameter value.
+  /// \param[in] _value Value to append.
+  /// \param[in,out] _encoder Encoder, with a Put and PutString function.
+  template<typename EncoderT, typename T>
+  void putValue(const T &_value, EncoderT &_encoder)
+  {
+    if constexpr (std::is_same_v<T, bool>)
+    {
+      _encoder.Put(static_cast<std::uint8_t>(_value));
+    }
+    else if constexpr (std::is_same_v<T, std::string>)
+    {
+      _encoder.PutString(_value);
+    }
+    else if constexpr (std::is_arithmetic_v<T>)
+    {
+      _encoder.Put(_value);
+    }
+    else if constexpr (std::is_same_v<T, sdf::Time>)
+    {
+      _encoder.Put(_value.sec);
+      _encoder.Put(_value.nsec);
+    }
+    else if constexpr (std::is_same_v<T, ignition::math::Angle>)
+    {
+      _encoder.Put(_value.Radian());
+    }
+    else if constexpr (std::is_same_v<T, ignition::math::Color>)
+    {
+      _encoder.Put(_value.R());
+      _encoder.Put(_value.G());
+      _encoder.Put(_value.B());
+      _encoder.Put(_value.A());
+    }
+    else if constexpr (std::is_same_v<T, ignition::math::Vector2i> ||
+                       std::is_same_v<T, ignition::math::Vector2d>)
+    {
+      _encoder.Put(_value.X());
+      _encoder.Put(_value.Y());
+    }
+    else if constexpr (std::is_same_v<T, ignition::math::Vector3d>)
+    {
+      _encoder.Put(_value.X());
+      _encoder.Put(_value.Y());
+      _encoder.Put(_value.Z());
+    }
+    else if constexpr (std::is_same_v<T, ignition::math::Quaterniond>)
+    {
+      _encoder.Put(_value.W());
+      _encoder.Put(_value.X());
+      _encoder.Put(_value.Y());
+      _encoder.Put(_value.Z());
+    }
+    else if constexpr (std::is_same_v<T, ignition::math::Pose3d>)
+    {
+      putValue(_value.Pos(), _encoder);
+      putValue(_value.Rot(), _encoder);
+    }
+    else if constexpr (std::is_same_v<T, std::vector<double>>)
+    {
+      _encoder.Put(static_cast<std::uint64_t>(_value.size()));
+      for (const double number : _value)
+        _encoder.Put(number);
+    }
+    else
+    {
+      static_assert(std::is_same_v<T, void>, "Unsupported parameter type");
+    }
+  }
+
+  /// \brief Read the native representation of a parameter value.
+  /// \param[out] _value Value read.
+  /// \param[in,out] _decoder Decoder, with a Get and GetString function.
+  /// \return True if the value was read.
+  template<typename DecoderT, typename T>
+  bool getValue(T &_value, DecoderT &_decoder)
+  {
+    if constexpr (std::is_same_v<T, bool>)
+    {
+      std::uint8_t value = 0;
+      _decoder.Get(value);
+      _value = value != 0;
+    }
+    else if constexpr (std::is_same_v<T, std::string>)
+    {
+      _value = _decoder.GetString();
+    }
+    else if constexpr (std::is_arithmetic_v<T>)
+    {
+      _decoder.Get(_value);
+    }
+    else if constexpr (std::is_same_v<T, sdf::Time>)
+    {
+      _decoder.Get(_value.sec);
+      _decoder.Get(_value.nsec);
+    }
+    else if constexpr (std::is_same_v<T, ignition::math::Angle>)
+    {
+      double radian = 0;
+      _decoder.Get(radian);
+      _value.Radian(radian);
+    }
+    else if constexpr (std::is_same_v<T, ignition::math::Color>)
+    {
+      float rgba[4] = {0, 0, 0, 0};
+      for (float &component : rgba)
+      {
+        _decoder.Get(component);
+      }
+      _value.Set(rgba[0], rgba[1], rgba[2], rgba[3]);
+    }
+    else if constexpr (std::is_same_v<T, ignition::math::Vector2i> ||
+                       std::is_same_v<T, ignition::math::Vector2d>)
+    {
+      std::conditional_t<std::is_same_v<T, ignition::math::Vector2i>,
+          int, double> x = 0, y = 0;
+      _decoder.Get(x);
+      _decoder.Get(y);
+      _value.Set(x, y);
+    }
+    else if constexpr (std::is_same_v<T, ignition::math::Vector3d>)
+    {
+      double x = 0, y = 0, z = 0;
+      _decoder.Get(x);
+      _decoder.Get(y);
+      _decoder.Get(z);
+      _value.Set(x, y, z);
+    }
+    else if constexpr (std::is_same_v<T, ignition::math::Quaterniond>)
+    {
+      double w = 1, x = 0, y = 0, z = 0;
+      _decoder.Get(w);
+      _decoder.Get(x);
+      _decoder.Get(y);
+      _decoder.Get(z);
+      _value.Set(w, x, y, z);
+    }
+    else if constexpr (std::is_same_v<T, ignition::math::Pose3d>)
+    {
+      ignition::math::Vector3d pos;
+      ignition::math::Quaterniond rot;
+      getValue(pos, _decoder);
+      getValue(rot, _decoder);
+      _value.Set(pos, rot);
+    }
+    else if constexpr (std::is_same_v<T, std::vector<double>>)
+    {
+      std::uint64_t size = 0;
+      _decoder.Get(size);
+      _value.clear();
+      // A corrupt size ends the loop once the data runs out.
+      for (std::uint64_t i = 0; i < size && _decoder.ok; ++i)
+      {
+        double number = 0;
+        _decoder.Get(number);
+        _value.push_back(number);
+      }
+    }
+    else
+    {
+      static_assert(std::is_same_v<T, void>, "Unsupported parameter type");
+    }
+    return _decoder.ok;
+  }
+}
+
+/////////////////////////////////////////////////
+bool BinarySnapshot::Write(const SDF &_sdf, std::ostream &_out,
+    Errors &_errors)
+{
+  ElementPtr root = _sdf.Root();
+  if (!root)
+  {
+    _errors.push_back({ErrorCode::ELEMENT_MISSING,
+        "Unable to write a binary snapshot of a document without root."});
+    return false;
+  }
+
+  Encoder encoder;
+  encoder.PutString(_sdf.FilePath());
+  encoder.PutString(_sdf.OriginalVersion());
+  WriteElement(*root, encoder);
+
+  const std::string version = SDF::Version();
+  _out.write(kMagic, sizeof(kMagic));
+  _out.write(reinterpret_cast<const char *>(&kFormatVersion),
+      sizeof(kFormatVersion));
+  _out.write(reinterpret_cast<const char *>(&kByteOrder),
+      sizeof(kByteOrder));
+
+  auto writeString = [&_out](const std::string &_str)
+  {
+    const std::uint32_t length = static_cast<std::uint32_t>(_str.size());
+    _out.write(reinterpret_cast<const char *>(&length), sizeof(length));
+    _out.write(_str.data(), static_cast<std::streamsize>(_str.size()));
+  };
+  writeString(version);
+
+  const std::uint32_t count = static_cast<std::uint32_t>(
+      encoder.strings.size());
+  _out.write(reinterpret_cast<const char *>(&count), sizeof(count));
+  for (const std::string *str : encoder.strings)
+  {
+    writeString(*str);
+  }
+  _out.write(encoder.body.data(),
+      static_cast<std::streamsize>(encoder.body.size()));
+
+  if (!_out)
+  {
+    _errors.push_back({ErrorCode::FILE_READ,
+        "Unable to write the binary snapshot."});
+    return false;
+  }
+  return true;
+}
+
+/////////////////////////////////////////////////
+void BinarySnapshot::WriteElement(const Element &_elem, Encoder &_encoder)
+{
+  _encoder.PutString(_elem.GetName());
+  _encoder.PutString(_elem.GetInclude());
+  _encoder.PutString(_elem.FilePath());
+  _encoder.PutString(_elem.OriginalVersion());
+
+  const std::size_t attributeCount = _elem.GetAttributeCount();
+  _encoder.Put(static_cast<std::uint32_t>(attributeCount));
+  for (std::size_t i = 0; i < attributeCount; ++i)
+  {
+    WriteParam(*_elem.GetAttribute(static_cast<unsigned int>(i)), _encoder);
+  }
+
+  ParamPtr value = _elem.GetValue();
+  _encoder.Put(static_cast<std::uint8_t>(value ? 1 : 0));
+  if (value)
+  {
+    WriteParam(*value, _encoder);
+  }
+
+  // The child count is patched once the children are written.
+  const std::size_t countPos = _encoder.body.size();
+  std::uint32_t childCount = 0;
+  _encoder.Put(childCount);
+  for (ElementPtr child = _elem.GetFirstElement(); child;
+       child = child->GetNextElement())
+  {
+    WriteElement(*child, _encoder);
+    ++childCount;
+  }
+  std::memcpy(&_encoder.body[countPos], &childCount, sizeof(childCount));
+}
+
+/////////////////////////////////////////////////
+void BinarySnapshot::WriteParam(const Param &_param, Encoder &_encoder)
+{
+  const ParamPrivate &data = *_param.dataPtr;
+  _encoder.PutString(*data.descriptionData->key);
+  _encoder.PutString(*data.descriptionData->typeName);
+  _encoder.PutString(_param.GetDefaultAsString());
+
+  std::uint8_t flags = 0;
+  if (data.set)
+    flags |= kParamSet;
+  if (data.descriptionData->required)
+    flags |= kParamRequired;
+  _encoder.Put(flags);
+
+  _encoder.Put(static_cast<std::uint8_t>(data.value.index()));
+  std::visit([&_encoder](const auto &_value)
+      {
+        putValue(_value, _encoder);
+      }, data.value);
+}
+
+/////////////////////////////////////////////////
+bool BinarySnapshot::Read(const char *_data, std::size_t _size,
+    SDFPtr _sdf, Errors &_errors)
+{
+  Decoder decoder(_data, _size);
+
+  char magic[sizeof(kMagic)];
+  std::uint32_t formatVersion = 0;
+  std::uint32_t byteOrder = 0;
+  if (!decoder.Get(magic) || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0)
+  {
+    _errors.push_back({ErrorCode::FILE_READ,
+        "Data is not an SDFormat binary snapshot."});
+    return false;
+  }
+  if (!decoder.Get(formatVersion) || formatVersion != kFormatVersion)
+  {
+    _errors.push_back({ErrorCode::FILE_READ,
+        "Binary snapshot format version [" + std::to_string(formatVersion) +
+        "] is not supported, expected version [" +
+        std::to_string(kFormatVersion) + "]."});
+    return false;
+  }
+  if (!decoder.Get(byteOrder) || byteOrder != kByteOrder)
+  {
+    _errors.push_back({ErrorCode::FILE_READ,
+        "Binary snapshot was written with a different byte order."});
+    return false;
+  }
+
+  std::string version;
+  if (!decoder.GetInlineString(version))
+  {
+    _errors.push_back({ErrorCode::FILE_READ,
+        "Binary snapshot is truncated."});
+    return false;
+  }
+  if (version != SDF::Version())
+  {
+    _errors.push_back({ErrorCode::FILE_READ,
+        "Binary snapshot has SDFormat version [" + version +
+        "], which does not match the version of this library [" +
+        SDF::Version() + "]. The snapshot must be regenerated."});
+    return false;
+  }
+
+  std::uint32_t stringCount = 0;
+  decoder.Get(stringCount);
+  // Every string takes at least the bytes of its length.
+  if (decoder.ok &&
+      stringCount > (decoder.size - decoder.pos) / sizeof(std::uint32_t))
+  {
+    decoder.ok = false;
+  }
+  if (decoder.ok)
+  {
+    decoder.strings.resize(stringCount);
+  }
+  for (std::uint32_t i = 0; i < stringCount && decoder.ok; ++i)
+  {
+    decoder.GetInlineString(decoder.strings[i]);
+  }
+
+  const std::string &path = decoder.GetString();
+  const std::string &originalVersion = decoder.GetString();
+  if (!decoder.ok)
+  {
+    _errors.push_back({ErrorCode::FILE_READ,
+        "Binary snapshot is truncated."});
+    return false;
+  }
+
+  ElementPtr root = _sdf->Root();
+  if (!root || root->GetElementDescriptionCount() == 0)
+  {
+    _errors.push_back({ErrorCode::ELEMENT_MISSING,
+        "The SDF object must be initialized before reading a binary "
+        "snapshot."});
+    return false;
+  }
+  _sdf->SetFilePath(path);
+  _sdf->SetOriginalVersion(originalVersion);
+
+  const std::size_t rootPos = decoder.pos;
+  const std::string &rootName = decoder.GetString();
+  if (rootName != root->GetName())
+  {
+    _errors.push_back({ErrorCode::ELEMENT_INCORRECT_TYPE,
+        "Binary snapshot has root element [" + rootName +
+        "], expected [" + root->GetName() + "]."});
+    return false;
+  }
+  decoder.pos = rootPos;
+
+  if (!ReadElement(root, decoder, _errors))
+  {
+    if (!decoder.ok)
+    {
+      _errors.push_back({ErrorCode::FILE_READ,
+          "Binary snapshot is truncated."});
+    }
+    return false;
+  }
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool BinarySnapshot::ReadElement(const ElementPtr &_elem, Decoder &_decoder,
+    Errors &_errors)
+{
+  const std::string &name = _decoder.GetString();
+  _elem->SetName(name);
+  const std::string &include = _decoder.GetString();
+  if (!include.empty())
+  {
+    _elem->SetInclude(include);
+  }
+  _elem->SetFilePath(_decoder.GetString());
+  _elem->SetOriginalVersion(_decoder.GetString());
+
+  std::uint32_t attributeCount = 0;
+  _decoder.Get(attributeCount);
+  for (std::uint32_t i = 0; i < attributeCount && _decoder.ok; ++i)
+  {
+    if (!ReadParam(_elem, false, _decoder, _errors))
+    {
+      return false;
+    }
+  }
+
+  std::uint8_t hasValue = 0;
+  _decoder.Get(hasValue);
+  if (hasValue && !ReadParam(_elem, true, _decoder, _errors))
+  {
+    return false;
+  }
+
+  std::uint32_t childCount = 0;
+  _decoder.Get(childCount);
+  for (std::uint32_t i = 0; i < childCount && _decoder.ok; ++i)
+  {
+    // Peek at the name of the child to find its description.
+    const std::size_t childPos = _decoder.pos;
+    const std::string &childName = _decoder.GetString();
+    if (!_decoder.ok)
+    {
+      return false;
+    }
+    _decoder.pos = childPos;
+
+    ElementPtr desc = _elem->GetElementDescription(childName);
+
+    // A reference sdf that does not have element descriptions of its own
+    // uses the ones of its parent, as in Element::AddElement.
+    ElementPtr parent = _elem->GetParent();
+    if (!desc && !_elem->ReferenceSDF().empty() && parent &&
+        parent->GetName() == _elem->GetName())
+    {
+      desc = parent->GetElementDescription(childName);
+    }
+
+    // Elements without description are copied children, which hold their
+    // attributes and value as written.
+    ElementPtr child = desc ? desc->Instantiate() : ElementPtr(new Element);
+    child->SetParent(_elem);
+    if (!ReadElement(child, _decoder, _errors))
+    {
+      return false;
+    }
+    _elem->InsertElement(child);
+  }
+  return _decoder.ok;
+}
+
+/////////////////////////////////////////////////
+bool BinarySnapshot::ReadParam(const ElementPtr &_elem, bool _isValue,
+    Decoder &_decoder, Errors &_errors)
+{
+  const std::string &key = _decoder.GetString();
+  const std::string &typeName = _decoder.GetString();
+  const std::string &defaultValue = _decoder.GetString();
+  std::uint8_t flags = 0;
+  std::uint8_t index = 0;
+  _decoder.Get(flags);
+  _decoder.Get(index);
+  if (!_decoder.ok)
+  {
+    return false;
+  }
+
+  const bool required = (flags & kParamRequired) != 0;
+  ParamPtr param = _isValue ? _elem->GetValue() : _elem->GetAttribute(key);
+  if (!param)
+  {
+    if (_isValue)
+    {
+      _elem->AddValue(typeName, defaultValue, required);
+      param = _elem->GetValue();
+    }
+    else
+    {
+      _elem->AddAttribute(key, typeName, defaultValue, required);
+      param = _elem->GetAttribute(key);
+    }
+  }
+
+  ParamPrivate &data = *param->dataPtr;
+  if (index != data.value.index())
+  {
+    _errors.push_back({ErrorCode::ELEMENT_INVALID,
+        "Binary snapshot has a value of type [" + typeName +
+        "] for parameter [" + key + "] of element [" + _elem->GetName() +
+        "], which has type [" + param->GetTypeName() + "]."});
+    return false;
+  }
+
+  std::visit([&_decoder](auto &_value)
+      {
+        getValue(_value, _decoder);
+      }, data.value);
+  data.set = (flags & kParamSet) != 0;
+  return _decoder.ok;
+}
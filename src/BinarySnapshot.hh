@@ -0,0 +1,105 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_BINARY_SNAPSHOT_HH_
+#define SDF_BINARY_SNAPSHOT_HH_
+
+#include <cstddef>
+#include <ostream>
+
+#include "sdf/Element.hh"
+#include "sdf/Error.hh"
+#include "sdf/Param.hh"
+#include "sdf/SDFImpl.hh"
+#include "sdf/sdf_config.h"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief Binary snapshot of a parsed SDF document.
+  ///
+  /// A snapshot starts with a header holding a magic number, the snapshot
+  /// format version, a byte order marker and the SDFormat specification
+  /// version of the document. It is followed by a table of all the distinct
+  /// strings of the document, i.e. element names, attribute keys, type
+  /// names and string values, and by the element tree. Values are stored in
+  /// their native representation, so that reading a snapshot needs neither
+  /// XML parsing nor conversion of values from text.
+  ///
+  /// A snapshot can only be read by a library that uses the same
+  /// specification version, and on a machine with the same byte order as
+  /// the one that wrote it.
+  class BinarySnapshot
+  {
+    /// \brief Write a document.
+    /// \param[in] _sdf Document to write.
+    /// \param[out] _out Stream to write to.
+    /// \param[out] _errors Errors are appended to this variable.
+    /// \return True if the snapshot was written.
+    public: static bool Write(const SDF &_sdf, std::ostream &_out,
+                Errors &_errors);
+
+    /// \brief Read a document.
+    /// \param[in] _data Content of the snapshot.
+    /// \param[in] _size Size of the content in bytes.
+    /// \param[in,out] _sdf Document to populate. It must be initialized
+    /// with sdf::init.
+    /// \param[out] _errors Errors are appended to this variable.
+    /// \return True if the snapshot was read.
+    public: static bool Read(const char *_data, std::size_t _size,
+                SDFPtr _sdf, Errors &_errors);
+
+    /// \brief Encoder of the records of a snapshot.
+    private: class Encoder;
+
+    /// \brief Decoder of the records of a snapshot.
+    private: class Decoder;
+
+    /// \brief Write an element and its children.
+    /// \param[in] _elem Element to write.
+    /// \param[in,out] _encoder Encoder.
+    private: static void WriteElement(const Element &_elem,
+                 Encoder &_encoder);
+
+    /// \brief Write a parameter.
+    /// \param[in] _param Parameter to write.
+    /// \param[in,out] _encoder Encoder.
+    private: static void WriteParam(const Param &_param, Encoder &_encoder);
+
+    /// \brief Read the content of an element and its children.
+    /// \param[in,out] _elem Element to populate.
+    /// \param[in,out] _decoder Decoder.
+    /// \param[out] _errors Errors are appended to this variable.
+    /// \return True if the element was read.
+    private: static bool ReadElement(const ElementPtr &_elem,
+                 Decoder &_decoder, Errors &_errors);
+
+    /// \brief Read a parameter into an attribute or value of an element.
+    /// \param[in,out] _elem Element that holds the parameter.
+    /// \param[in] _isValue True to read the value of the element, false to
+    /// read an attribute.
+    /// \param[in,out] _decoder Decoder.
+    /// \param[out] _errors Errors are appended to this variable.
+    /// \return True if the parameter was read.
+    private: static bool ReadParam(const ElementPtr &_elem, bool _isValue,
+                 Decoder &_decoder, Errors &_errors);
+  };
+  }
+}
+#endif
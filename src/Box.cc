@@ -16,6 +16,8 @@
 */
 #include <ignition/math/Vector3.hh>
 #include "sdf/Box.hh"
+#include "ElementRetentionScope.hh"
+#include "LoadStatsScope.hh"
 
 using namespace sdf;
 
@@ -73,9 +75,10 @@ Box &Box::operator=(Box &&_box)
 /////////////////////////////////////////////////
 Errors Box::Load(ElementPtr _sdf)
 {
+  DomLoadTimer timer("Box");
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that sdf is a valid pointer
   if (!_sdf)
@@ -147,3 +150,16 @@ ignition::math::Boxd &Box::Shape()
 {
   return this->dataPtr->box;
 }
+
+/////////////////////////////////////////////////
+ignition::math::AxisAlignedBox Box::AxisAlignedBox() const
+{
+  const ignition::math::Vector3d half = this->Size() * 0.5;
+  return ignition::math::AxisAlignedBox(-half, half);
+}
+
+/////////////////////////////////////////////////
+double Box::BoundingRadius() const
+{
+  return this->Size().Length() * 0.5;
+}
@@ -15,6 +15,7 @@
  *
 */
 
+#include <cmath>
 #include <gtest/gtest.h>
 #include "sdf/Box.hh"
 #include "sdf/Element.hh"
@@ -143,3 +144,14 @@ TEST(DOMBox, Shape)
   box.Shape().SetSize(ignition::math::Vector3d(1, 2, 3));
   EXPECT_EQ(ignition::math::Vector3d(1, 2, 3), box.Size());
 }
+
+/////////////////////////////////////////////////
+TEST(DOMBox, Bounds)
+{
+  sdf::Box box;
+  box.SetSize(ignition::math::Vector3d(2, 4, 6));
+  EXPECT_EQ(ignition::math::AxisAlignedBox(
+      ignition::math::Vector3d(-1, -2, -3), ignition::math::Vector3d(1, 2, 3)),
+      box.AxisAlignedBox());
+  EXPECT_DOUBLE_EQ(std::sqrt(14.0), box.BoundingRadius());
+}
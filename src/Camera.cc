@@ -15,7 +15,18 @@
  *
 */
 #include <array>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <ignition/math/Matrix3.hh>
+#include <ignition/math/Matrix4.hh>
+#include <ignition/math/Vector2.hh>
 #include "sdf/Camera.hh"
+#include "ElementRetentionScope.hh"
+#include "LoadStatsScope.hh"
+#include "ResolvedCache.hh"
 #include "Utils.hh"
 
 using namespace sdf;
@@ -45,6 +56,23 @@ static std::array<std::string, 19> kPixelFormatNames =
   "BAYER_GRBG8"
 };
 
+/// \brief Matrices derived from the properties of a camera.
+struct CameraMatrices
+{
+  /// \brief Intrinsic matrix.
+  ignition::math::Matrix3d intrinsic;
+
+  /// \brief OpenGL projection matrix.
+  ignition::math::Matrix4d projection;
+};
+
+/// \brief Lookup table of a lens distortion, one position per pixel.
+using DistortionTable = std::vector<ignition::math::Vector2f>;
+
+/// \brief Image size, focal lengths, coefficients and center that a
+/// distortion table is built from.
+using DistortionKey = std::array<double, 11>;
+
 // Private data class
 class sdf::CameraPrivate
 {
@@ -164,8 +192,131 @@ class sdf::CameraPrivate
 
   /// \brief Visibility mask of a camera. Defaults to 0xFFFFFFFF
   public: uint32_t visibilityMask{4294967295u};
+
+  /// \brief Whether the lens intrinsics were loaded or set.
+  public: bool hasLensIntrinsics{false};
+
+  /// \brief Matrices derived from the properties.
+  public: ResolvedCache<CameraMatrices> matrices;
+
+  /// \brief Distortion table, shared with identical cameras.
+  public: ResolvedCache<std::shared_ptr<const DistortionTable>> distortion;
+
+  /// \brief Forget the derived data, when the properties change.
+  public: void Invalidate()
+  {
+    this->matrices.Reset();
+    this->distortion.Reset();
+  }
 };
 
+/////////////////////////////////////////////////
+/// \brief Compute the matrices of a camera.
+/// \param[in] _data Properties of the camera.
+/// \return The intrinsic and projection matrices.
+static CameraMatrices computeMatrices(const CameraPrivate &_data)
+{
+  const double width = _data.imageWidth;
+  const double height = _data.imageHeight;
+
+  double fx = _data.lensIntrinsicsFx;
+  double fy = _data.lensIntrinsicsFy;
+  double cx = _data.lensIntrinsicsCx;
+  double cy = _data.lensIntrinsicsCy;
+  double skew = _data.lensIntrinsicsS;
+  if (!_data.hasLensIntrinsics)
+  {
+    fx = width / (2.0 * std::tan(_data.hfov.Radian() * 0.5));
+    fy = fx;
+    cx = width * 0.5;
+    cy = height * 0.5;
+    skew = 0.0;
+  }
+
+  CameraMatrices matrices;
+  matrices.intrinsic.Set(
+      fx, skew, cx,
+      0, fy, cy,
+      0, 0, 1);
+
+  const double nearClip = _data.nearClip;
+  const double farClip = _data.farClip;
+  const double depth = farClip - nearClip;
+  matrices.projection.Set(
+      2.0 * fx / width, -2.0 * skew / width, (width - 2.0 * cx) / width, 0,
+      0, 2.0 * fy / height, -(height - 2.0 * cy) / height, 0,
+      0, 0, -(farClip + nearClip) / depth, -2.0 * farClip * nearClip / depth,
+      0, 0, -1, 0);
+  return matrices;
+}
+
+/////////////////////////////////////////////////
+/// \brief Build the distortion table of a camera.
+/// \param[in] _key Parameters of the table.
+/// \return The table.
+static DistortionTable buildDistortionTable(const DistortionKey &_key)
+{
+  const auto width = static_cast<std::size_t>(_key[0]);
+  const auto height = static_cast<std::size_t>(_key[1]);
+  const double fx = _key[2];
+  const double fy = _key[3];
+  const double k1 = _key[4];
+  const double k2 = _key[5];
+  const double k3 = _key[6];
+  const double p1 = _key[7];
+  const double p2 = _key[8];
+  const double cx = _key[9] * _key[0];
+  const double cy = _key[10] * _key[1];
+
+  DistortionTable table(width * height);
+  for (std::size_t v = 0; v < height; ++v)
+  {
+    const double y = (v + 0.5 - cy) / fy;
+    for (std::size_t u = 0; u < width; ++u)
+    {
+      const double x = (u + 0.5 - cx) / fx;
+      const double r2 = x * x + y * y;
+      const double radial = 1.0 + r2 * (k1 + r2 * (k2 + r2 * k3));
+      const double xd = x * radial + 2.0 * p1 * x * y + p2 * (r2 + 2.0 * x * x);
+      const double yd = y * radial + p1 * (r2 + 2.0 * y * y) + 2.0 * p2 * x * y;
+      table[v * width + u].Set(
+          static_cast<float>(xd * fx + cx), static_cast<float>(yd * fy + cy));
+    }
+  }
+  return table;
+}
+
+/////////////////////////////////////////////////
+/// \brief Get the distortion table for some parameters, shared by all the
+/// cameras that have them.
+/// \param[in] _key Parameters of the table.
+/// \return The table.
+static std::shared_ptr<const DistortionTable> sharedDistortionTable(
+    const DistortionKey &_key)
+{
+  static std::mutex mutex;
+  static std::map<DistortionKey, std::weak_ptr<const DistortionTable>> tables;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  auto &entry = tables[_key];
+  if (auto table = entry.lock())
+    return table;
+
+  // Drop the entries of the tables that were freed.
+  for (auto it = tables.begin(); it != tables.end();)
+  {
+    if (&it->second != &entry && it->second.expired())
+      it = tables.erase(it);
+    else
+      ++it;
+  }
+
+  auto table = std::make_shared<const DistortionTable>(
+      buildDistortionTable(_key));
+  entry = table;
+  return table;
+}
+
 /////////////////////////////////////////////////
 Camera::Camera()
   : dataPtr(new CameraPrivate)
@@ -207,9 +358,10 @@ Camera &Camera::operator=(Camera &&_camera) noexcept
 /////////////////////////////////////////////////
 Errors Camera::Load(ElementPtr _sdf)
 {
+  DomLoadTimer timer("Camera");
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that sdf is a valid pointer
   if (!_sdf)
@@ -377,6 +529,7 @@ Errors Camera::Load(ElementPtr _sdf)
           this->dataPtr->lensIntrinsicsCy).first;
       this->dataPtr->lensIntrinsicsS = intrinsics->Get<double>("s",
           this->dataPtr->lensIntrinsicsS).first;
+      this->dataPtr->hasLensIntrinsics = true;
     }
   }
 
@@ -386,6 +539,7 @@ Errors Camera::Load(ElementPtr _sdf)
         this->dataPtr->visibilityMask).first;
   }
 
+  this->dataPtr->Invalidate();
   return errors;
 }
 
@@ -417,6 +571,7 @@ ignition::math::Angle Camera::HorizontalFov() const
 void Camera::SetHorizontalFov(const ignition::math::Angle &_hfov)
 {
   this->dataPtr->hfov = _hfov;
+  this->dataPtr->Invalidate();
 }
 
 //////////////////////////////////////////////////
@@ -429,6 +584,7 @@ uint32_t Camera::ImageWidth() const
 void Camera::SetImageWidth(uint32_t _width)
 {
   this->dataPtr->imageWidth = _width;
+  this->dataPtr->Invalidate();
 }
 
 //////////////////////////////////////////////////
@@ -441,6 +597,7 @@ uint32_t Camera::ImageHeight() const
 void Camera::SetImageHeight(uint32_t _height)
 {
   this->dataPtr->imageHeight = _height;
+  this->dataPtr->Invalidate();
 }
 
 //////////////////////////////////////////////////
@@ -503,6 +660,7 @@ double Camera::NearClip() const
 void Camera::SetNearClip(double _near)
 {
   this->dataPtr->nearClip = _near;
+  this->dataPtr->Invalidate();
 }
 
 //////////////////////////////////////////////////
@@ -515,6 +673,7 @@ double Camera::FarClip() const
 void Camera::SetFarClip(double _far)
 {
   this->dataPtr->farClip = _far;
+  this->dataPtr->Invalidate();
 }
 
 //////////////////////////////////////////////////
@@ -621,6 +780,7 @@ double Camera::DistortionK1() const
 void Camera::SetDistortionK1(double _k1)
 {
   this->dataPtr->distortionK1 = _k1;
+  this->dataPtr->Invalidate();
 }
 
 //////////////////////////////////////////////////
@@ -633,6 +793,7 @@ double Camera::DistortionK2() const
 void Camera::SetDistortionK2(double _k2)
 {
   this->dataPtr->distortionK2 = _k2;
+  this->dataPtr->Invalidate();
 }
 
 //////////////////////////////////////////////////
@@ -645,6 +806,7 @@ double Camera::DistortionK3() const
 void Camera::SetDistortionK3(double _k3)
 {
   this->dataPtr->distortionK3 = _k3;
+  this->dataPtr->Invalidate();
 }
 
 //////////////////////////////////////////////////
@@ -657,6 +819,7 @@ double Camera::DistortionP1() const
 void Camera::SetDistortionP1(double _p1)
 {
   this->dataPtr->distortionP1 = _p1;
+  this->dataPtr->Invalidate();
 }
 
 //////////////////////////////////////////////////
@@ -669,6 +832,7 @@ double Camera::DistortionP2() const
 void Camera::SetDistortionP2(double _p2)
 {
   this->dataPtr->distortionP2 = _p2;
+  this->dataPtr->Invalidate();
 }
 
 //////////////////////////////////////////////////
@@ -682,6 +846,7 @@ void Camera::SetDistortionCenter(
                 const ignition::math::Vector2d &_center) const
 {
   this->dataPtr->distortionCenter = _center;
+  this->dataPtr->Invalidate();
 }
 
 /////////////////////////////////////////////////
@@ -826,6 +991,8 @@ double Camera::LensIntrinsicsFx() const
 void Camera::SetLensIntrinsicsFx(double _fx)
 {
   this->dataPtr->lensIntrinsicsFx = _fx;
+  this->dataPtr->hasLensIntrinsics = true;
+  this->dataPtr->Invalidate();
 }
 
 /////////////////////////////////////////////////
@@ -838,6 +1005,8 @@ double Camera::LensIntrinsicsFy() const
 void Camera::SetLensIntrinsicsFy(double _fy)
 {
   this->dataPtr->lensIntrinsicsFy = _fy;
+  this->dataPtr->hasLensIntrinsics = true;
+  this->dataPtr->Invalidate();
 }
 
 /////////////////////////////////////////////////
@@ -850,6 +1019,8 @@ double Camera::LensIntrinsicsCx() const
 void Camera::SetLensIntrinsicsCx(double _cx)
 {
   this->dataPtr->lensIntrinsicsCx = _cx;
+  this->dataPtr->hasLensIntrinsics = true;
+  this->dataPtr->Invalidate();
 }
 
 /////////////////////////////////////////////////
@@ -862,6 +1033,8 @@ double Camera::LensIntrinsicsCy() const
 void Camera::SetLensIntrinsicsCy(double _cy)
 {
   this->dataPtr->lensIntrinsicsCy = _cy;
+  this->dataPtr->hasLensIntrinsics = true;
+  this->dataPtr->Invalidate();
 }
 
 /////////////////////////////////////////////////
@@ -874,6 +1047,49 @@ double Camera::LensIntrinsicsSkew() const
 void Camera::SetLensIntrinsicsSkew(double _s)
 {
   this->dataPtr->lensIntrinsicsS = _s;
+  this->dataPtr->hasLensIntrinsics = true;
+  this->dataPtr->Invalidate();
+}
+
+/////////////////////////////////////////////////
+ignition::math::Matrix3d Camera::IntrinsicMatrix() const
+{
+  return this->dataPtr->matrices.Get([this]
+      {
+        return computeMatrices(*this->dataPtr);
+      }).intrinsic;
+}
+
+/////////////////////////////////////////////////
+ignition::math::Matrix4d Camera::ProjectionMatrix() const
+{
+  return this->dataPtr->matrices.Get([this]
+      {
+        return computeMatrices(*this->dataPtr);
+      }).projection;
+}
+
+/////////////////////////////////////////////////
+const ignition::math::Vector2f *Camera::DistortionMap() const
+{
+  if (this->dataPtr->imageWidth == 0 || this->dataPtr->imageHeight == 0)
+    return nullptr;
+
+  const auto &table = this->dataPtr->distortion.Get([this]
+      {
+        const ignition::math::Matrix3d intrinsic = this->IntrinsicMatrix();
+        const DistortionKey key{
+            static_cast<double>(this->dataPtr->imageWidth),
+            static_cast<double>(this->dataPtr->imageHeight),
+            intrinsic(0, 0), intrinsic(1, 1),
+            this->dataPtr->distortionK1, this->dataPtr->distortionK2,
+            this->dataPtr->distortionK3, this->dataPtr->distortionP1,
+            this->dataPtr->distortionP2,
+            this->dataPtr->distortionCenter.X(),
+            this->dataPtr->distortionCenter.Y()};
+        return sharedDistortionTable(key);
+      });
+  return table->data();
 }
 
 /////////////////////////////////////////////////
@@ -16,6 +16,9 @@
 */
 
 #include <gtest/gtest.h>
+#include <ignition/math/Matrix3.hh>
+#include <ignition/math/Matrix4.hh>
+#include <ignition/math/Vector2.hh>
 #include "sdf/Camera.hh"
 
 /////////////////////////////////////////////////
@@ -193,3 +196,79 @@ TEST(DOMCamera, Construction)
   // The Camera::Load function is tested more thoroughly in the
   // link_dom.cc integration test.
 }
+
+/////////////////////////////////////////////////
+TEST(DOMCamera, IntrinsicMatrix)
+{
+  sdf::Camera cam;
+  cam.SetHorizontalFov(IGN_PI_2);
+  cam.SetImageWidth(320);
+  cam.SetImageHeight(240);
+
+  // Without lens intrinsics, the focal lengths follow the field of view.
+  ignition::math::Matrix3d intrinsic = cam.IntrinsicMatrix();
+  EXPECT_NEAR(160.0, intrinsic(0, 0), 1e-9);
+  EXPECT_NEAR(160.0, intrinsic(1, 1), 1e-9);
+  EXPECT_DOUBLE_EQ(0.0, intrinsic(0, 1));
+  EXPECT_DOUBLE_EQ(160.0, intrinsic(0, 2));
+  EXPECT_DOUBLE_EQ(120.0, intrinsic(1, 2));
+  EXPECT_DOUBLE_EQ(1.0, intrinsic(2, 2));
+
+  ignition::math::Matrix4d projection = cam.ProjectionMatrix();
+  EXPECT_NEAR(1.0, projection(0, 0), 1e-9);
+  EXPECT_NEAR(4.0 / 3.0, projection(1, 1), 1e-9);
+  EXPECT_NEAR(0.0, projection(0, 2), 1e-9);
+  EXPECT_NEAR(-(100.0 + 0.1) / (100.0 - 0.1), projection(2, 2), 1e-9);
+  EXPECT_DOUBLE_EQ(-1.0, projection(3, 2));
+
+  // The matrices follow the properties that are set.
+  cam.SetImageWidth(640);
+  EXPECT_NEAR(320.0, cam.IntrinsicMatrix()(0, 0), 1e-9);
+
+  cam.SetLensIntrinsicsFx(500);
+  intrinsic = cam.IntrinsicMatrix();
+  EXPECT_DOUBLE_EQ(500.0, intrinsic(0, 0));
+  EXPECT_DOUBLE_EQ(277.0, intrinsic(1, 1));
+  EXPECT_DOUBLE_EQ(1.0, intrinsic(0, 1));
+  EXPECT_DOUBLE_EQ(160.0, intrinsic(0, 2));
+  EXPECT_NEAR(2.0 * 500.0 / 640.0, cam.ProjectionMatrix()(0, 0), 1e-9);
+
+  // Copies compute their own matrices.
+  sdf::Camera cam2(cam);
+  cam2.SetLensIntrinsicsFy(300);
+  EXPECT_DOUBLE_EQ(300.0, cam2.IntrinsicMatrix()(1, 1));
+  EXPECT_DOUBLE_EQ(277.0, cam.IntrinsicMatrix()(1, 1));
+}
+
+/////////////////////////////////////////////////
+TEST(DOMCamera, DistortionMap)
+{
+  sdf::Camera cam;
+  cam.SetImageWidth(4);
+  cam.SetImageHeight(2);
+
+  // Without distortion, each pixel maps to its center.
+  const ignition::math::Vector2f *map = cam.DistortionMap();
+  ASSERT_NE(nullptr, map);
+  EXPECT_EQ(ignition::math::Vector2f(0.5f, 0.5f), map[0]);
+  EXPECT_EQ(ignition::math::Vector2f(3.5f, 1.5f), map[7]);
+
+  // Identical cameras share the table.
+  sdf::Camera cam2;
+  cam2.SetImageWidth(4);
+  cam2.SetImageHeight(2);
+  EXPECT_EQ(map, cam2.DistortionMap());
+
+  // Barrel distortion pulls the corners toward the center.
+  cam2.SetDistortionK1(-0.5);
+  const ignition::math::Vector2f *barrel = cam2.DistortionMap();
+  ASSERT_NE(nullptr, barrel);
+  EXPECT_NE(map, barrel);
+  EXPECT_GT(barrel[0].X(), 0.5f);
+  EXPECT_GT(barrel[0].Y(), 0.5f);
+  EXPECT_LT(barrel[7].X(), 3.5f);
+  EXPECT_EQ(map, cam.DistortionMap());
+
+  cam.SetImageWidth(0);
+  EXPECT_EQ(nullptr, cam.DistortionMap());
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <atomic>
+#include <utility>
+
+#include "sdf/CancellationToken.hh"
+
+using namespace sdf;
+
+/// \brief Private data for sdf::CancellationToken
+class sdf::CancellationTokenPrivate
+{
+  /// \brief Default constructor
+  public: CancellationTokenPrivate() = default;
+
+  /// \brief Copy constructor
+  /// \param[in] _other CancellationTokenPrivate to copy.
+  public: CancellationTokenPrivate(const CancellationTokenPrivate &_other)
+    : cancelled(_other.cancelled.load())
+  {
+  }
+
+  /// \brief True once Cancel was called.
+  public: std::atomic<bool> cancelled{false};
+};
+
+/////////////////////////////////////////////////
+CancellationToken::CancellationToken()
+  : dataPtr(new CancellationTokenPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+CancellationToken::CancellationToken(const CancellationToken &_token)
+  : dataPtr(new CancellationTokenPrivate(*_token.dataPtr))
+{
+}
+
+/////////////////////////////////////////////////
+CancellationToken::CancellationToken(CancellationToken &&_token) noexcept
+  : dataPtr(std::exchange(_token.dataPtr, nullptr))
+{
+}
+
+/////////////////////////////////////////////////
+CancellationToken &CancellationToken::operator=(
+    CancellationToken &&_token) noexcept
+{
+  std::swap(this->dataPtr, _token.dataPtr);
+  return *this;
+}
+
+/////////////////////////////////////////////////
+CancellationToken &CancellationToken::operator=(
+    const CancellationToken &_token)
+{
+  return *this = CancellationToken(_token);
+}
+
+/////////////////////////////////////////////////
+CancellationToken::~CancellationToken()
+{
+  delete this->dataPtr;
+  this->dataPtr = nullptr;
+}
+
+/////////////////////////////////////////////////
+void CancellationToken::Cancel()
+{
+  this->dataPtr->cancelled.store(true, std::memory_order_relaxed);
+}
+
+/////////////////////////////////////////////////
+bool CancellationToken::Cancelled() const
+{
+  return this->dataPtr->cancelled.load(std::memory_order_relaxed);
+}
+
+/////////////////////////////////////////////////
+void CancellationToken::Reset()
+{
+  this->dataPtr->cancelled.store(false, std::memory_order_relaxed);
+}
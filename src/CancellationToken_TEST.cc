@@ -0,0 +1,58 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <utility>
+
+#include <gtest/gtest.h>
+#include "sdf/CancellationToken.hh"
+
+/////////////////////////////////////////////////
+TEST(CancellationToken, Cancel)
+{
+  sdf::CancellationToken token;
+  EXPECT_FALSE(token.Cancelled());
+  token.Cancel();
+  EXPECT_TRUE(token.Cancelled());
+  token.Cancel();
+  EXPECT_TRUE(token.Cancelled());
+  token.Reset();
+  EXPECT_FALSE(token.Cancelled());
+}
+
+/////////////////////////////////////////////////
+TEST(CancellationToken, CopyAndMove)
+{
+  sdf::CancellationToken token;
+  token.Cancel();
+
+  sdf::CancellationToken copy(token);
+  EXPECT_TRUE(copy.Cancelled());
+
+  // Copies are independent of the original.
+  copy.Reset();
+  EXPECT_TRUE(token.Cancelled());
+
+  sdf::CancellationToken assigned;
+  assigned = token;
+  EXPECT_TRUE(assigned.Cancelled());
+
+  sdf::CancellationToken moved(std::move(assigned));
+  EXPECT_TRUE(moved.Cancelled());
+
+  copy = std::move(moved);
+  EXPECT_TRUE(copy.Cancelled());
+}
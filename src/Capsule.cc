@@ -14,8 +14,11 @@
  * limitations under the License.
  *
 */
+#include <cmath>
 #include <sstream>
 #include "sdf/Capsule.hh"
+#include "ElementRetentionScope.hh"
+#include "LoadStatsScope.hh"
 
 using namespace sdf;
 
@@ -71,9 +74,10 @@ Capsule &Capsule::operator=(Capsule &&_capsule)
 /////////////////////////////////////////////////
 Errors Capsule::Load(ElementPtr _sdf)
 {
+  DomLoadTimer timer("Capsule");
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that sdf is a valid pointer
   if (!_sdf)
@@ -167,3 +171,19 @@ ignition::math::Capsuled &Capsule::Shape()
 {
   return this->dataPtr->capsule;
 }
+
+/////////////////////////////////////////////////
+ignition::math::AxisAlignedBox Capsule::AxisAlignedBox() const
+{
+  const double radius = this->Radius();
+  const double halfLength = this->Length() * 0.5 + radius;
+  return ignition::math::AxisAlignedBox(
+      ignition::math::Vector3d(-radius, -radius, -halfLength),
+      ignition::math::Vector3d(radius, radius, halfLength));
+}
+
+/////////////////////////////////////////////////
+double Capsule::BoundingRadius() const
+{
+  return this->Length() * 0.5 + this->Radius();
+}
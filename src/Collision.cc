@@ -22,7 +22,10 @@
 #include "sdf/Geometry.hh"
 #include "sdf/Surface.hh"
 #include "sdf/Types.hh"
+#include "ElementRetentionScope.hh"
 #include "FrameSemantics.hh"
+#include "LoadStatsScope.hh"
+#include "MemoryAccounting.hh"
 #include "ScopedGraph.hh"
 #include "Utils.hh"
 
@@ -96,9 +99,10 @@ Collision &Collision::operator=(Collision &&_collision)
 /////////////////////////////////////////////////
 Errors Collision::Load(ElementPtr _sdf)
 {
+  DomLoadTimer timer("Collision");
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that the provided SDF element is a <collision>
   // This is an error that cannot be recovered, so return an error.
@@ -128,9 +132,13 @@ Errors Collision::Load(ElementPtr _sdf)
   // Load the pose. Ignore the return value since the pose is optional.
   loadPose(_sdf, this->dataPtr->pose, this->dataPtr->poseRelativeTo);
 
-  // Load the geometry
-  Errors geomErr = this->dataPtr->geom.Load(_sdf->GetElement("geometry"));
-  errors.insert(errors.end(), geomErr.begin(), geomErr.end());
+  // Load the geometry. The <geometry> is required, so the parser reports
+  // a missing one, and an empty geometry is kept.
+  if (_sdf->HasElement("geometry"))
+  {
+    Errors geomErr = this->dataPtr->geom.Load(_sdf->GetElement("geometry"));
+    errors.insert(errors.end(), geomErr.begin(), geomErr.end());
+  }
 
   // Load the surface parameters if they are given
   if (_sdf->HasElement("surface"))
@@ -214,6 +222,12 @@ void Collision::SetPoseRelativeToGraph(
   this->dataPtr->poseRelativeToGraph = _graph;
 }
 
+/////////////////////////////////////////////////
+void Collision::ShareMesh(MeshRegistry &_registry)
+{
+  this->dataPtr->geom.ShareMesh(_registry);
+}
+
 /////////////////////////////////////////////////
 sdf::SemanticPose Collision::SemanticPose() const
 {
@@ -229,3 +243,10 @@ sdf::ElementPtr Collision::Element() const
 {
   return this->dataPtr->sdf;
 }
+
+/////////////////////////////////////////////////
+template <>
+std::size_t sdf::domPrivateSize<Collision>()
+{
+  return sizeof(CollisionPrivate);
+}
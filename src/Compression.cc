@@ -0,0 +1,339 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+
+// The HAVE_ZLIB and HAVE_ZSTD macros are set in sdf_config.h.
+#include "sdf/sdf_config.h"
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "Compression.hh"
+
+using namespace sdf;
+
+/// \brief Number of bytes the output buffer grows by at least.
+static const std::size_t kMinGrowth = 64 * 1024;
+
+/// \brief Largest ratio of decompressed to compressed size that a size
+/// stored in a compressed document is trusted up to, when reserving the
+/// output buffer.
+static const std::size_t kMaxRatio = 1024;
+
+namespace
+{
+  /// \brief A file whose content was decompressed into memory.
+  class DecompressedFile : public VirtualFile
+  {
+    /// \brief Constructor
+    /// \param[in] _content Decompressed content.
+    public: explicit DecompressedFile(std::string &&_content)
+      : content(std::move(_content))
+    {
+    }
+
+    // Documentation inherited.
+    public: const char *Data() const override
+    {
+      return this->content.data();
+    }
+
+    // Documentation inherited.
+    public: std::size_t Size() const override
+    {
+      return this->content.size();
+    }
+
+    /// \brief Decompressed content.
+    private: std::string content;
+  };
+}
+
+/////////////////////////////////////////////////
+/// \brief Make room at the end of the output buffer.
+/// \param[in,out] _out Output buffer, whose size is the number of bytes
+/// written so far plus the room left.
+/// \param[in] _used Number of bytes written.
+static void grow(std::string &_out, std::size_t _used)
+{
+  if (_used < _out.size())
+    return;
+  _out.resize(std::max(_out.size() * 2, _out.size() + kMinGrowth));
+}
+
+/////////////////////////////////////////////////
+/// \brief Reserve the output buffer for a decompressed size read from a
+/// compressed document, if it is plausible.
+/// \param[in,out] _out Output buffer.
+/// \param[in] _expected Decompressed size.
+/// \param[in] _compressed Compressed size.
+static void reserve(std::string &_out, std::uint64_t _expected,
+    std::size_t _compressed)
+{
+  if (_expected > 0 &&
+      _expected / kMaxRatio <= _compressed &&
+      _expected < std::numeric_limits<std::size_t>::max())
+  {
+    _out.resize(static_cast<std::size_t>(_expected));
+  }
+}
+
+#ifdef HAVE_ZLIB
+/////////////////////////////////////////////////
+/// \brief Decompress gzip members.
+/// \param[in] _data Compressed document.
+/// \param[in] _size Size of the compressed document.
+/// \param[out] _out Decompressed document.
+/// \param[out] _error Reason of a failure.
+/// \return True on success.
+static bool inflateGzip(const char *_data, std::size_t _size,
+    std::string &_out, std::string &_error)
+{
+  // The last four bytes hold the size of the last member modulo 2^32,
+  // which is the whole size for the usual single member file.
+  if (_size >= 18)
+  {
+    const unsigned char *tail =
+      reinterpret_cast<const unsigned char *>(_data + _size - 4);
+    reserve(_out, static_cast<std::uint64_t>(tail[0]) |
+        (static_cast<std::uint64_t>(tail[1]) << 8) |
+        (static_cast<std::uint64_t>(tail[2]) << 16) |
+        (static_cast<std::uint64_t>(tail[3]) << 24), _size);
+  }
+
+  z_stream stream{};
+  // 16 selects the gzip wrapper.
+  if (inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK)
+  {
+    _error = "Unable to initialize zlib";
+    return false;
+  }
+
+  const unsigned char *next = reinterpret_cast<const unsigned char *>(_data);
+  std::size_t remaining = _size;
+  std::size_t used = 0;
+  int result = Z_OK;
+  while (true)
+  {
+    grow(_out, used);
+
+    // zlib counts in 32 bit integers, so large buffers are fed in parts.
+    const uInt maxChunk = std::numeric_limits<uInt>::max();
+    stream.next_in = const_cast<unsigned char *>(next);
+    stream.avail_in = static_cast<uInt>(std::min<std::size_t>(remaining,
+          maxChunk));
+    stream.next_out = reinterpret_cast<unsigned char *>(&_out[used]);
+    stream.avail_out = static_cast<uInt>(std::min<std::size_t>(
+          _out.size() - used, maxChunk));
+    const uInt availIn = stream.avail_in;
+    const uInt availOut = stream.avail_out;
+
+    result = inflate(&stream, Z_NO_FLUSH);
+    next += availIn - stream.avail_in;
+    remaining -= availIn - stream.avail_in;
+    used += availOut - stream.avail_out;
+
+    if (result == Z_STREAM_END)
+    {
+      // Another member may follow.
+      if (remaining == 0)
+        break;
+      inflateReset(&stream);
+    }
+    else if (result == Z_BUF_ERROR && remaining == 0 && stream.avail_out > 0)
+    {
+      break;
+    }
+    else if (result != Z_OK && result != Z_BUF_ERROR)
+    {
+      break;
+    }
+  }
+  inflateEnd(&stream);
+
+  _out.resize(used);
+  if (result != Z_STREAM_END)
+  {
+    _error = result == Z_BUF_ERROR ? "Truncated gzip data" :
+      std::string("Invalid gzip data: ") + (stream.msg ? stream.msg : "");
+    return false;
+  }
+  return true;
+}
+#endif
+
+#ifdef HAVE_ZSTD
+/////////////////////////////////////////////////
+/// \brief Decompress zstd frames.
+/// \param[in] _data Compressed document.
+/// \param[in] _size Size of the compressed document.
+/// \param[out] _out Decompressed document.
+/// \param[out] _error Reason of a failure.
+/// \return True on success.
+static bool decompressZstd(const char *_data, std::size_t _size,
+    std::string &_out, std::string &_error)
+{
+  const unsigned long long contentSize =
+    ZSTD_getFrameContentSize(_data, _size);
+  if (contentSize != ZSTD_CONTENTSIZE_UNKNOWN &&
+      contentSize != ZSTD_CONTENTSIZE_ERROR)
+  {
+    reserve(_out, contentSize, _size);
+  }
+
+  std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)> context(
+      ZSTD_createDCtx(), &ZSTD_freeDCtx);
+  if (!context)
+  {
+    _error = "Unable to initialize zstd";
+    return false;
+  }
+
+  ZSTD_inBuffer input = {_data, _size, 0};
+  std::size_t used = 0;
+  std::size_t result = 0;
+  while (input.pos < input.size)
+  {
+    grow(_out, used);
+    ZSTD_outBuffer output = {&_out[used], _out.size() - used, 0};
+    result = ZSTD_decompressStream(context.get(), &output, &input);
+    used += output.pos;
+    if (ZSTD_isError(result))
+    {
+      _out.resize(used);
+      _error = std::string("Invalid zstd data: ") +
+        ZSTD_getErrorName(result);
+      return false;
+    }
+  }
+
+  // Flush the output that didn't fit in the buffer.
+  while (result != 0)
+  {
+    grow(_out, used);
+    ZSTD_outBuffer output = {&_out[used], _out.size() - used, 0};
+    result = ZSTD_decompressStream(context.get(), &output, &input);
+    used += output.pos;
+    if (ZSTD_isError(result) || output.pos == 0)
+    {
+      _out.resize(used);
+      _error = "Truncated zstd data";
+      return false;
+    }
+  }
+
+  _out.resize(used);
+  return true;
+}
+#endif
+
+/////////////////////////////////////////////////
+CompressionFormat sdf::detectCompression(const char *_data, std::size_t _size)
+{
+  const unsigned char *bytes = reinterpret_cast<const unsigned char *>(_data);
+  if (_size >= 2 && bytes[0] == 0x1f && bytes[1] == 0x8b)
+    return CompressionFormat::GZIP;
+  if (_size >= 4 && bytes[0] == 0x28 && bytes[1] == 0xb5 &&
+      bytes[2] == 0x2f && bytes[3] == 0xfd)
+  {
+    return CompressionFormat::ZSTD;
+  }
+  return CompressionFormat::NONE;
+}
+
+/////////////////////////////////////////////////
+bool sdf::compressionSupported(CompressionFormat _format)
+{
+  switch (_format)
+  {
+    case CompressionFormat::NONE:
+      return true;
+    case CompressionFormat::GZIP:
+#ifdef HAVE_ZLIB
+      return true;
+#else
+      return false;
+#endif
+    case CompressionFormat::ZSTD:
+#ifdef HAVE_ZSTD
+      return true;
+#else
+      return false;
+#endif
+  }
+  return false;
+}
+
+/////////////////////////////////////////////////
+bool sdf::decompress(const char *_data, std::size_t _size, std::string &_out,
+    std::string &_error)
+{
+  _out.clear();
+  switch (detectCompression(_data, _size))
+  {
+    case CompressionFormat::NONE:
+      _out.assign(_data, _size);
+      return true;
+    case CompressionFormat::GZIP:
+#ifdef HAVE_ZLIB
+      return inflateGzip(_data, _size, _out, _error);
+#else
+      _error = "Reading gzip compressed files requires sdformat to be built "
+        "with zlib";
+      return false;
+#endif
+    case CompressionFormat::ZSTD:
+#ifdef HAVE_ZSTD
+      return decompressZstd(_data, _size, _out, _error);
+#else
+      _error = "Reading zstd compressed files requires sdformat to be built "
+        "with libzstd";
+      return false;
+#endif
+  }
+  return false;
+}
+
+/////////////////////////////////////////////////
+std::unique_ptr<VirtualFile> sdf::decompressFile(
+    std::unique_ptr<VirtualFile> _file, std::string &_error)
+{
+  if (!_file || detectCompression(_file->Data(), _file->Size()) ==
+      CompressionFormat::NONE)
+  {
+    return _file;
+  }
+
+  std::string content;
+  if (!decompress(_file->Data(), _file->Size(), content, _error))
+    return nullptr;
+
+  // The compressed content is released before the document is parsed.
+  _file.reset();
+  return std::make_unique<DecompressedFile>(std::move(content));
+}
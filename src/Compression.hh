@@ -0,0 +1,80 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_COMPRESSION_HH_
+#define SDF_COMPRESSION_HH_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "sdf/VirtualFilesystem.hh"
+#include "sdf/sdf_config.h"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief Compression format of a document.
+  enum class CompressionFormat
+  {
+    /// \brief Not compressed.
+    NONE,
+
+    /// \brief gzip, as written by gzip(1) and zlib.
+    GZIP,
+
+    /// \brief Zstandard.
+    ZSTD
+  };
+
+  /// \brief Detect the compression of a document from its first bytes, so
+  /// that files, strings and streams are recognized whatever their name.
+  /// \param[in] _data Start of the document.
+  /// \param[in] _size Size of the document in bytes.
+  /// \return Compression format of the document.
+  CompressionFormat detectCompression(const char *_data, std::size_t _size);
+
+  /// \brief Check whether a compression format can be decompressed, which
+  /// depends on the libraries sdformat was built with.
+  /// \param[in] _format Compression format.
+  /// \return True if documents in _format can be read.
+  bool compressionSupported(CompressionFormat _format);
+
+  /// \brief Decompress a whole document in one pass, straight into the
+  /// buffer the XML parser reads. Concatenated gzip members and zstd frames
+  /// are decompressed one after the other.
+  /// \param[in] _data Compressed document.
+  /// \param[in] _size Size of the compressed document in bytes.
+  /// \param[out] _out Set to the decompressed document.
+  /// \param[out] _error Set to the reason on a failure.
+  /// \return True on success. A document that is not compressed is copied.
+  bool decompress(const char *_data, std::size_t _size, std::string &_out,
+                  std::string &_error);
+
+  /// \brief Decompress an opened file if it is compressed.
+  /// \param[in] _file The opened file.
+  /// \param[out] _error Set to the reason on a failure.
+  /// \return _file itself if it is not compressed, a file holding the
+  /// decompressed content if it is, or nullptr if it can not be
+  /// decompressed.
+  std::unique_ptr<VirtualFile> decompressFile(
+      std::unique_ptr<VirtualFile> _file, std::string &_error);
+  }
+}
+#endif
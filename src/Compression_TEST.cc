@@ -0,0 +1,149 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <string>
+
+#include "sdf/Filesystem.hh"
+#include "sdf/Root.hh"
+#include "sdf/World.hh"
+#include "sdf/sdf_config.h"
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include "Compression.hh"
+#include "test_config.h"
+
+#ifdef HAVE_ZLIB
+/////////////////////////////////////////////////
+/// \brief Compress a string in the gzip format.
+/// \param[in] _data String to compress.
+/// \return The compressed string.
+static std::string gzip(const std::string &_data)
+{
+  z_stream stream{};
+  EXPECT_EQ(Z_OK, deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED,
+        16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY));
+  std::string out(deflateBound(&stream, _data.size()) + 32, '\0');
+  stream.next_in = reinterpret_cast<Bytef *>(
+      const_cast<char *>(_data.data()));
+  stream.avail_in = static_cast<uInt>(_data.size());
+  stream.next_out = reinterpret_cast<Bytef *>(&out[0]);
+  stream.avail_out = static_cast<uInt>(out.size());
+  EXPECT_EQ(Z_STREAM_END, deflate(&stream, Z_FINISH));
+  out.resize(stream.total_out);
+  deflateEnd(&stream);
+  return out;
+}
+#endif
+
+/////////////////////////////////////////////////
+TEST(Compression, Detect)
+{
+  const std::string xml = "<sdf version='1.8'/>";
+  EXPECT_EQ(sdf::CompressionFormat::NONE,
+      sdf::detectCompression(xml.data(), xml.size()));
+  EXPECT_EQ(sdf::CompressionFormat::NONE, sdf::detectCompression("", 0));
+  EXPECT_EQ(sdf::CompressionFormat::GZIP,
+      sdf::detectCompression("\x1f\x8b\x08", 3));
+  EXPECT_EQ(sdf::CompressionFormat::ZSTD,
+      sdf::detectCompression("\x28\xb5\x2f\xfd\x00", 5));
+  EXPECT_TRUE(sdf::compressionSupported(sdf::CompressionFormat::NONE));
+
+  // Documents that are not compressed are copied.
+  std::string out;
+  std::string error;
+  EXPECT_TRUE(sdf::decompress(xml.data(), xml.size(), out, error));
+  EXPECT_EQ(xml, out);
+
+  // Corrupt or unsupported data is an error.
+  EXPECT_FALSE(sdf::decompress("\x1f\x8b\x08\x00", 4, out, error));
+  EXPECT_FALSE(error.empty());
+}
+
+#ifdef HAVE_ZLIB
+/////////////////////////////////////////////////
+TEST(Compression, Gzip)
+{
+  EXPECT_TRUE(sdf::compressionSupported(sdf::CompressionFormat::GZIP));
+
+  std::string xml = "<sdf version='1.8'><model name='m'>";
+  for (int i = 0; i < 10000; ++i)
+    xml += "<link name='link_" + std::to_string(i) + "'/>";
+  xml += "</model></sdf>";
+
+  const std::string compressed = gzip(xml);
+  EXPECT_LT(compressed.size() * 4, xml.size());
+  EXPECT_EQ(sdf::CompressionFormat::GZIP,
+      sdf::detectCompression(compressed.data(), compressed.size()));
+
+  std::string out;
+  std::string error;
+  ASSERT_TRUE(sdf::decompress(compressed.data(), compressed.size(), out,
+        error)) << error;
+  EXPECT_EQ(xml, out);
+
+  // Concatenated members are read one after the other.
+  const std::string members = gzip("<sdf ") + gzip("version='1.8'/>");
+  ASSERT_TRUE(sdf::decompress(members.data(), members.size(), out, error));
+  EXPECT_EQ("<sdf version='1.8'/>", out);
+
+  // Truncated data is an error.
+  EXPECT_FALSE(sdf::decompress(compressed.data(), compressed.size() / 2,
+        out, error));
+  EXPECT_FALSE(error.empty());
+}
+
+/////////////////////////////////////////////////
+TEST(Compression, LoadGzip)
+{
+  const std::string xml =
+    "<?xml version='1.0'?>"
+    "<sdf version='1.8'><world name='compressed'>"
+    "  <model name='m'><link name='l'/></model>"
+    "</world></sdf>";
+
+  const std::string path = sdf::filesystem::append(PROJECT_BINARY_DIR,
+      "compression_world.sdf.gz");
+  {
+    std::ofstream out(path, std::ios::binary);
+    out << gzip(xml);
+  }
+
+  sdf::Root fileRoot;
+  EXPECT_TRUE(fileRoot.Load(path).empty());
+  ASSERT_NE(nullptr, fileRoot.WorldByIndex(0));
+  EXPECT_EQ("compressed", fileRoot.WorldByIndex(0)->Name());
+  EXPECT_TRUE(fileRoot.WorldByIndex(0)->ModelNameExists("m"));
+
+  sdf::ParserConfig streaming;
+  streaming.SetStreamingRead(true);
+  sdf::Root streamingRoot;
+  EXPECT_TRUE(streamingRoot.Load(path, streaming).empty());
+  ASSERT_NE(nullptr, streamingRoot.WorldByIndex(0));
+  EXPECT_TRUE(streamingRoot.WorldByIndex(0)->ModelNameExists("m"));
+
+  sdf::Root stringRoot;
+  EXPECT_TRUE(stringRoot.LoadSdfString(gzip(xml)).empty());
+  ASSERT_NE(nullptr, stringRoot.WorldByIndex(0));
+  EXPECT_EQ("compressed", stringRoot.WorldByIndex(0)->Name());
+}
+#endif
@@ -15,15 +15,25 @@
  *
  */
 
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
 #include <cstdlib>
+#include <fstream>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <sstream>
+#include <streambuf>
 #include <string>
+#include <thread>
+#include <utility>
 
 #include "sdf/Console.hh"
+#include "sdf/DiagnosticSink.hh"
 #include "sdf/Filesystem.hh"
 #include "sdf/Types.hh"
+#include "DiagnosticScope.hh"
 
 using namespace sdf;
 
@@ -31,6 +41,14 @@ using namespace sdf;
 static std::shared_ptr<Console> myself;
 static std::mutex g_instance_mutex;
 
+/// \brief Incremented by Console::Clear, so that the instances cached by
+/// each thread are refreshed.
+static std::atomic<uint64_t> g_instanceGeneration{0};
+
+/// \brief Messages above this level are discarded, see
+/// Console::SetVerbosity.
+static std::atomic<int> g_verbosity{4};
+
 /// \todo Output disabled for windows, to allow tests to pass. We should
 /// disable output just for tests on windows.
 #ifndef _WIN32
@@ -41,6 +59,268 @@ static bool g_quiet = true;
 
 static Console::ConsoleStream g_NullStream(nullptr);
 
+namespace
+{
+  /// \brief Stream buffer that appends to a string.
+  class StringBuf : public std::streambuf
+  {
+    /// \brief Constructor.
+    /// \param[in] _str String to append to.
+    public: explicit StringBuf(std::string &_str) : str(_str) {}
+
+    // Documentation inherited.
+    protected: int_type overflow(int_type _c) override
+    {
+      if (!traits_type::eq_int_type(_c, traits_type::eof()))
+        this->str.push_back(traits_type::to_char_type(_c));
+      return traits_type::not_eof(_c);
+    }
+
+    // Documentation inherited.
+    protected: std::streamsize xsputn(const char *_s,
+                   std::streamsize _n) override
+    {
+      this->str.append(_s, static_cast<std::size_t>(_n));
+      return _n;
+    }
+
+    /// \brief String to append to.
+    private: std::string &str;
+  };
+
+  /// \brief Message being collected by a thread.
+  struct PendingMessage
+  {
+    /// \brief Constructor.
+    PendingMessage() : buffer(text), stream(&buffer) {}
+
+    /// \brief Destructor. Writes the message if it was never ended.
+    ~PendingMessage()
+    {
+      if (this->owner)
+        this->owner->End();
+    }
+
+    /// \brief Console that writes the message.
+    ConsolePtr console;
+
+    /// \brief Stream the message belongs to, nullptr if there is none.
+    Console::ConsoleStream *owner = nullptr;
+
+    /// \brief Terminal stream the message is written to, can be nullptr.
+    std::ostream *terminal = nullptr;
+
+    /// \brief True if the message is written to the log file.
+    bool toFile = false;
+
+    /// \brief True if repetitions of the message are limited.
+    bool limited = false;
+
+    /// \brief Sink of the load the message is written in, which gets it
+    /// instead of the terminal and the log file, or nullptr.
+    DiagnosticSink *sink = nullptr;
+
+    /// \brief Level of the message, for the sink.
+    DiagnosticLevel level = DiagnosticLevel::MESSAGE;
+
+    /// \brief Source file that wrote the message, for the sink.
+    std::string file;
+
+    /// \brief Source line that wrote the message, for the sink.
+    unsigned int line = 0;
+
+    /// \brief Prefix written to the terminal.
+    std::string terminalPrefix;
+
+    /// \brief Prefix written to the log file.
+    std::string filePrefix;
+
+    /// \brief Text of the message.
+    std::string text;
+
+    /// \brief Buffer that appends to text.
+    StringBuf buffer;
+
+    /// \brief Stream that formats into text.
+    std::ostream stream;
+  };
+
+  /// \brief Get the message being collected by the calling thread.
+  /// \return The message.
+  PendingMessage &pendingMessage()
+  {
+    static thread_local PendingMessage message;
+    return message;
+  }
+}
+
+/// \brief Private data for Console
+class sdf::ConsolePrivate
+{
+  /// \brief Constructor
+  public: ConsolePrivate() : msgStream(&std::cerr), logStream(nullptr) {}
+
+  /// \brief Write a message to the terminal and queue it for the log file.
+  /// \param[in] _message The message.
+  public: void Write(const PendingMessage &_message);
+
+  /// \brief Queue text for the log file.
+  /// \param[in] _text Text to write.
+  public: void QueueLog(const std::string &_text);
+
+  /// \brief Write the repetitions of warnings that were suppressed.
+  public: void ReportRepeats();
+
+  /// \brief Wait until everything queued is written to the log file.
+  public: void DrainLog();
+
+  /// \brief Body of the thread that writes the log file.
+  public: void RunLogThread();
+
+  /// \brief message stream
+  public: Console::ConsoleStream msgStream;
+
+  /// \brief log stream
+  public: Console::ConsoleStream logStream;
+
+  /// \brief logfile stream
+  public: std::ofstream logFileStream;
+
+  /// \brief Serializes writes to the terminal.
+  public: std::mutex terminalMutex;
+
+  /// \brief Maximum number of repetitions of a warning, 0 for no limit.
+  public: std::atomic<unsigned int> repeatLimit{0u};
+
+  /// \brief Number of times each limited message was seen, keyed by its
+  /// file prefix and text.
+  public: std::map<std::string, uint64_t> repeats;
+
+  /// \brief Protects repeats.
+  public: std::mutex repeatsMutex;
+
+  /// \brief Text waiting to be written to the log file.
+  public: std::string logQueue;
+
+  /// \brief True while the log thread writes text it took from logQueue.
+  public: bool logWriting = false;
+
+  /// \brief True to stop the log thread.
+  public: bool logStop = false;
+
+  /// \brief Protects logQueue, logWriting and logStop.
+  public: std::mutex logMutex;
+
+  /// \brief Signals the log thread that there is text or it must stop.
+  public: std::condition_variable logPending;
+
+  /// \brief Signals waiting threads that the queue was written.
+  public: std::condition_variable logWritten;
+
+  /// \brief Thread that writes the log file, started with the first
+  /// message.
+  public: std::thread logThread;
+};
+
+//////////////////////////////////////////////////
+void ConsolePrivate::Write(const PendingMessage &_message)
+{
+  if (_message.limited && this->repeatLimit > 0u)
+  {
+    std::lock_guard<std::mutex> lock(this->repeatsMutex);
+    if (++this->repeats[_message.filePrefix + _message.text] >
+        this->repeatLimit)
+    {
+      return;
+    }
+  }
+
+  if (_message.terminal)
+  {
+    std::lock_guard<std::mutex> lock(this->terminalMutex);
+    *_message.terminal << _message.terminalPrefix << _message.text;
+  }
+
+  if (_message.toFile)
+    this->QueueLog(_message.filePrefix + _message.text);
+}
+
+//////////////////////////////////////////////////
+void ConsolePrivate::QueueLog(const std::string &_text)
+{
+  std::lock_guard<std::mutex> lock(this->logMutex);
+  if (!this->logThread.joinable())
+    this->logThread = std::thread(&ConsolePrivate::RunLogThread, this);
+  this->logQueue += _text;
+  this->logPending.notify_one();
+}
+
+//////////////////////////////////////////////////
+void ConsolePrivate::RunLogThread()
+{
+  std::unique_lock<std::mutex> lock(this->logMutex);
+  while (true)
+  {
+    this->logPending.wait(lock, [this]
+        {
+          return this->logStop || !this->logQueue.empty();
+        });
+    if (this->logQueue.empty())
+      break;
+
+    // Write without the lock, so that messages can be queued meanwhile.
+    std::string text;
+    text.swap(this->logQueue);
+    this->logWriting = true;
+    lock.unlock();
+    this->logFileStream << text;
+    this->logFileStream.flush();
+    lock.lock();
+    this->logWriting = false;
+    this->logWritten.notify_all();
+  }
+}
+
+//////////////////////////////////////////////////
+void ConsolePrivate::DrainLog()
+{
+  std::unique_lock<std::mutex> lock(this->logMutex);
+  this->logWritten.wait(lock, [this]
+      {
+        return this->logQueue.empty() && !this->logWriting;
+      });
+}
+
+//////////////////////////////////////////////////
+void ConsolePrivate::ReportRepeats()
+{
+  std::map<std::string, uint64_t> repeated;
+  {
+    std::lock_guard<std::mutex> lock(this->repeatsMutex);
+    repeated.swap(this->repeats);
+  }
+
+  for (const auto &[message, count] : repeated)
+  {
+    if (this->repeatLimit == 0u || count <= this->repeatLimit)
+      continue;
+
+    std::string text = message;
+    if (!text.empty() && text.back() == '\n')
+      text.pop_back();
+    text += " [suppressed " + std::to_string(count - this->repeatLimit) +
+        " repetitions]\n";
+
+    if (!g_quiet)
+    {
+      std::lock_guard<std::mutex> lock(this->terminalMutex);
+      std::cerr << text;
+    }
+    if (this->logFileStream.is_open())
+      this->QueueLog(text);
+  }
+}
+
 //////////////////////////////////////////////////
 Console::Console()
   : dataPtr(new ConsolePrivate)
@@ -77,17 +357,35 @@ Console::Console()
 //////////////////////////////////////////////////
 Console::~Console()
 {
+  this->dataPtr->ReportRepeats();
+
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->logMutex);
+    this->dataPtr->logStop = true;
+    this->dataPtr->logPending.notify_one();
+  }
+  if (this->dataPtr->logThread.joinable())
+    this->dataPtr->logThread.join();
 }
 
 //////////////////////////////////////////////////
 ConsolePtr Console::Instance()
 {
+  // Each thread keeps the instance, so that the mutex is only locked again
+  // after Clear.
+  static thread_local ConsolePtr cached;
+  static thread_local uint64_t cachedGeneration = 0;
+  if (cached && cachedGeneration == g_instanceGeneration)
+    return cached;
+
   std::lock_guard<std::mutex> lock(g_instance_mutex);
   if (!myself)
   {
     myself.reset(new Console());
   }
 
+  cached = myself;
+  cachedGeneration = g_instanceGeneration;
   return myself;
 }
 
@@ -97,6 +395,7 @@ void Console::Clear()
   std::lock_guard<std::mutex> lock(g_instance_mutex);
 
   myself = nullptr;
+  ++g_instanceGeneration;
 }
 
 //////////////////////////////////////////////////
@@ -105,6 +404,47 @@ void Console::SetQuiet(bool _quiet)
   g_quiet = _quiet;
 }
 
+//////////////////////////////////////////////////
+void Console::SetVerbosity(int _verbosity)
+{
+  g_verbosity = _verbosity;
+}
+
+//////////////////////////////////////////////////
+int Console::Verbosity()
+{
+  return g_verbosity;
+}
+
+//////////////////////////////////////////////////
+bool Console::Enabled(int _level)
+{
+  return _level <= g_verbosity.load(std::memory_order_relaxed);
+}
+
+//////////////////////////////////////////////////
+void Console::SetRepeatLimit(unsigned int _limit)
+{
+  this->dataPtr->repeatLimit = _limit;
+}
+
+//////////////////////////////////////////////////
+unsigned int Console::RepeatLimit() const
+{
+  return this->dataPtr->repeatLimit;
+}
+
+//////////////////////////////////////////////////
+void Console::Flush()
+{
+  PendingMessage &message = pendingMessage();
+  if (message.owner)
+    message.owner->End();
+
+  this->dataPtr->ReportRepeats();
+  this->dataPtr->DrainLog();
+}
+
 //////////////////////////////////////////////////
 Console::ConsoleStream &Console::ColorMsg(const std::string &lbl,
                                           const std::string &file,
@@ -117,6 +457,7 @@ Console::ConsoleStream &Console::ColorMsg(const std::string &lbl,
   }
   else
   {
+    g_NullStream.Prefix(lbl, file, line, color);
     return g_NullStream;
   }
 }
@@ -130,30 +471,110 @@ Console::ConsoleStream &Console::Log(const std::string &lbl,
   return this->dataPtr->logStream;
 }
 
+//////////////////////////////////////////////////
+void Console::MessageEnd::operator&(ConsoleStream &_stream) const
+{
+  _stream.End();
+}
+
 //////////////////////////////////////////////////
 void Console::ConsoleStream::Prefix(const std::string &_lbl,
                                     const std::string &_file,
                                     unsigned int _line,
                                     int _color)
 {
-  size_t index = _file.find_last_of("/") + 1;
+  PendingMessage &message = pendingMessage();
+  if (message.owner)
+    message.owner->End();
+
+  message.console = Console::Instance();
+  message.owner = this;
+  message.terminal = this->stream;
+  message.toFile = message.console->dataPtr->logFileStream.is_open();
+  message.limited = _lbl == "Warning";
+  message.sink = DiagnosticScope::Sink();
+  if (_lbl == "Error")
+    message.level = DiagnosticLevel::ERROR;
+  else if (_lbl == "Warning")
+    message.level = DiagnosticLevel::WARNING;
+  else if (_lbl == "Dbg")
+    message.level = DiagnosticLevel::DEBUG;
+  else
+    message.level = DiagnosticLevel::MESSAGE;
+
+  const size_t index = _file.find_last_of("/") + 1;
+  message.file = _file.substr(index , _file.size() - index);
+  message.line = _line;
+  const std::string location = " [" + message.file + ":" +
+      std::to_string(_line) + "]";
 
   (void)_color;
-  if (this->stream)
+  if (message.terminal)
   {
 #ifndef _WIN32
-    *this->stream << "\033[1;" << _color << "m" << _lbl << " [" <<
-      _file.substr(index , _file.size() - index) << ":" << _line <<
-      "]\033[0m ";
+    message.terminalPrefix = "\033[1;" + std::to_string(_color) + "m" +
+        _lbl + location + "\033[0m ";
 #else
-    *this->stream << _lbl << " [" <<
-      _file.substr(index , _file.size() - index) << ":" << _line << "] ";
+    message.terminalPrefix = _lbl + location + " ";
 #endif
   }
 
-  if (Console::Instance()->dataPtr->logFileStream.is_open())
+  // The file prefix also identifies repeated messages.
+  message.filePrefix = _lbl + location + " ";
+}
+
+//////////////////////////////////////////////////
+std::ostream *Console::ConsoleStream::Buffer()
+{
+  PendingMessage &message = pendingMessage();
+  if (message.owner != this)
   {
-    Console::Instance()->dataPtr->logFileStream << _lbl << " [" <<
-      _file.substr(index , _file.size() - index)<< ":" << _line << "] ";
+    // Text without a prefix is a message of its own.
+    if (message.owner)
+      message.owner->End();
+    message.console = Console::Instance();
+    message.owner = this;
+    message.terminal = this->stream;
+    message.toFile = message.console->dataPtr->logFileStream.is_open();
+    message.limited = false;
+    message.sink = DiagnosticScope::Sink();
+    message.level = DiagnosticLevel::MESSAGE;
+    message.file.clear();
+    message.line = 0;
   }
+
+  if (!message.terminal && !message.toFile && !message.sink)
+    return nullptr;
+  return &message.stream;
+}
+
+//////////////////////////////////////////////////
+void Console::ConsoleStream::End()
+{
+  PendingMessage &message = pendingMessage();
+  if (message.owner != this)
+    return;
+
+  if (message.sink)
+  {
+    Diagnostic diagnostic;
+    diagnostic.level = message.level;
+    diagnostic.message = message.text;
+    while (!diagnostic.message.empty() && diagnostic.message.back() == '\n')
+      diagnostic.message.pop_back();
+    diagnostic.file = message.file;
+    diagnostic.line = message.line;
+    message.sink->Write(diagnostic);
+  }
+  else if (message.terminal || message.toFile)
+  {
+    message.console->dataPtr->Write(message);
+  }
+
+  message.console.reset();
+  message.owner = nullptr;
+  message.sink = nullptr;
+  message.terminalPrefix.clear();
+  message.filePrefix.clear();
+  message.text.clear();
 }
@@ -15,7 +15,10 @@
  *
  */
 
+#include <sstream>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -121,6 +124,136 @@ TEST(Console, quiet)
   con->SetQuiet(false);
 }
 
+////////////////////////////////////////////////////
+/// Count the occurrences of a string.
+static std::size_t count(const std::string &_str, const std::string &_sub)
+{
+  std::size_t result = 0;
+  for (std::size_t pos = _str.find(_sub); pos != std::string::npos;
+       pos = _str.find(_sub, pos + _sub.size()))
+  {
+    ++result;
+  }
+  return result;
+}
+
+////////////////////////////////////////////////////
+TEST(Console, Verbosity)
+{
+  sdf::Console::Instance()->SetQuiet(false);
+  std::stringstream buffer;
+  auto old = std::cerr.rdbuf(buffer.rdbuf());
+
+  int formatted = 0;
+  auto format = [&formatted]()
+  {
+    ++formatted;
+    return "formatted";
+  };
+
+  EXPECT_EQ(4, sdf::Console::Verbosity());
+  sdf::Console::SetVerbosity(1);
+  EXPECT_TRUE(sdf::Console::Enabled(1));
+  EXPECT_FALSE(sdf::Console::Enabled(2));
+
+  // Messages above the verbosity are not even formatted.
+  sdfwarn << format() << "\n";
+  sdfmsg << format() << "\n";
+  sdfdbg << format() << "\n";
+  EXPECT_EQ(0, formatted);
+  EXPECT_TRUE(buffer.str().empty());
+
+  sdferr << format() << "\n";
+  EXPECT_EQ(1, formatted);
+  EXPECT_EQ(1u, count(buffer.str(), "Error ["));
+  EXPECT_EQ(1u, count(buffer.str(), "formatted\n"));
+
+  sdf::Console::SetVerbosity(4);
+  std::cerr.rdbuf(old);
+#ifdef _WIN32
+  sdf::Console::Instance()->SetQuiet(true);
+#endif
+}
+
+////////////////////////////////////////////////////
+TEST(Console, RepeatLimit)
+{
+  sdf::ConsolePtr con = sdf::Console::Instance();
+  con->SetQuiet(false);
+  EXPECT_EQ(0u, con->RepeatLimit());
+
+  std::stringstream buffer;
+  auto old = std::cerr.rdbuf(buffer.rdbuf());
+
+  // By default every repetition is written.
+  for (int i = 0; i < 15; ++i)
+    sdfwarn << "Unlimited warning.\n";
+  con->Flush();
+  EXPECT_EQ(15u, count(buffer.str(), "Unlimited warning.\n"));
+  EXPECT_EQ(0u, count(buffer.str(), "suppressed"));
+
+  con->SetRepeatLimit(3u);
+
+  // Identical warnings are only written up to the limit, other messages are
+  // not limited.
+  for (int i = 0; i < 10; ++i)
+  {
+    sdfwarn << "Repeated warning.\n";
+    sdfwarn << "Warning " << i << ".\n";
+    sdferr << "Repeated error.\n";
+  }
+  EXPECT_EQ(3u, count(buffer.str(), "Repeated warning.\n"));
+  EXPECT_EQ(1u, count(buffer.str(), "Warning 9.\n"));
+  EXPECT_EQ(10u, count(buffer.str(), "Repeated error.\n"));
+
+  // Flush reports the suppressed repetitions.
+  con->Flush();
+  EXPECT_EQ(1u, count(buffer.str(),
+        "Repeated warning. [suppressed 7 repetitions]\n")) << buffer.str();
+
+  con->SetRepeatLimit(0u);
+  std::cerr.rdbuf(old);
+#ifdef _WIN32
+  con->SetQuiet(true);
+#endif
+}
+
+////////////////////////////////////////////////////
+TEST(Console, Threads)
+{
+  sdf::Console::Instance()->SetQuiet(false);
+  std::stringstream buffer;
+  auto old = std::cerr.rdbuf(buffer.rdbuf());
+
+  // Messages are written whole, even when their parts are written by
+  // several threads at once.
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t)
+  {
+    threads.emplace_back([t]()
+        {
+          for (int i = 0; i < 100; ++i)
+            sdferr << "thread " << t << " message " << i << " end\n";
+        });
+  }
+  for (auto &thread : threads)
+    thread.join();
+  std::cerr.rdbuf(old);
+
+  std::string line;
+  std::size_t lines = 0;
+  while (std::getline(buffer, line))
+  {
+    ++lines;
+    EXPECT_EQ(1u, count(line, "Error [")) << line;
+    EXPECT_EQ(1u, count(line, " end")) << line;
+  }
+  EXPECT_EQ(400u, lines);
+#ifdef _WIN32
+  sdf::Console::Instance()->SetQuiet(true);
+#endif
+}
+
 /////////////////////////////////////////////////
 /// Main
 int main(int argc, char **argv)
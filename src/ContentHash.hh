@@ -0,0 +1,94 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_CONTENT_HASH_HH_
+#define SDF_CONTENT_HASH_HH_
+
+#include <atomic>
+#include <cstdint>
+#include <string_view>
+
+#include "sdf/sdf_config.h"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief Process-wide count of the element content hashes computed.
+  ///
+  /// A Param value change drops the hashes cached by the element of the
+  /// Param and its ancestors, which locks the weak pointer to the element.
+  /// Until a hash has been computed there is nothing to drop, so parsing
+  /// pays a relaxed load per value instead.
+  class ContentHashCount
+  {
+    /// \brief Get the number of element hashes computed so far.
+    /// \return The number of hashes computed, not counting cache hits.
+    public: static std::uint64_t Get()
+    {
+      return Count().load(std::memory_order_relaxed);
+    }
+
+    /// \brief Record that the hash of an element was computed.
+    public: static void Add()
+    {
+      Count().fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /// \brief The count.
+    private: static std::atomic<std::uint64_t> &Count()
+    {
+      static std::atomic<std::uint64_t> count{0};
+      return count;
+    }
+  };
+
+  /// \brief Mix a value into a 64 bit hash. The result doesn't depend on
+  /// the platform, so hashes can be compared across processes.
+  /// \param[in] _hash Hash so far.
+  /// \param[in] _value Value to mix in.
+  /// \return The new hash.
+  inline std::uint64_t hashCombine(std::uint64_t _hash, std::uint64_t _value)
+  {
+    // The finalizer of splitmix64 applied to the sum.
+    std::uint64_t x = _hash + 0x9e3779b97f4a7c15ULL + (_value << 6) +
+      (_value >> 2) + _value;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+  }
+
+  /// \brief Mix a string into a 64 bit hash, including its length so that
+  /// consecutive strings can't run into each other.
+  /// \param[in] _hash Hash so far.
+  /// \param[in] _str String to mix in.
+  /// \return The new hash.
+  inline std::uint64_t hashCombine(std::uint64_t _hash, std::string_view _str)
+  {
+    // 64 bit FNV-1a.
+    std::uint64_t h = 0xcbf29ce484222325ULL;
+    for (const char c : _str)
+    {
+      h ^= static_cast<unsigned char>(c);
+      h *= 0x100000001b3ULL;
+    }
+    return hashCombine(hashCombine(_hash, h), _str.size());
+  }
+  }
+}
+#endif
@@ -16,10 +16,13 @@
  */
 
 #include <algorithm>
+#include <cstdint>
 #include <map>
+#include <memory>
 #include <set>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -29,24 +32,283 @@
 #include "sdf/Types.hh"
 
 #include "Converter.hh"
+#include "DiagnosticScope.hh"
 #include "EmbeddedSdf.hh"
+#include "LoadStatsScope.hh"
+#include "Tracing.hh"
+#include "Utils.hh"
 #include "XmlUtils.hh"
 
 using namespace sdf;
 
 namespace {
-bool EndsWith(const std::string& _a, const std::string& _b)
+bool EndsWith(std::string_view _a, std::string_view _b)
 {
   return (_a.size() >= _b.size()) &&
       (_a.compare(_a.size() - _b.size(), _b.size(), _b) == 0);
 }
+
+/// \brief One step of the conversion chain, e.g. from 1.7 to 1.8, with its
+/// recipe parsed and compiled.
+struct ConvertStep
+{
+  /// \brief Version produced by this step.
+  std::string toVersion;
+
+  /// \brief The parsed recipe, which owns the elements used by rule.
+  tinyxml2::XMLDocument doc;
+
+  /// \brief The compiled recipe.
+  ConvertRule rule;
+
+  /// \brief Error message if the recipe could not be parsed.
+  std::string error;
+};
+
+/// \brief Get the conversion step that upgrades a version. The embedded
+/// recipes are parsed and compiled once per process, the first time this
+/// is called, and are only read afterwards.
+/// \param[in] _fromVersion Version to upgrade, e.g. "1.7".
+/// \return The step, or nullptr if there is no recipe for _fromVersion.
+const ConvertStep *FindConvertStep(const std::string &_fromVersion)
+{
+  static const std::map<std::string, std::unique_ptr<ConvertStep>> steps =
+    []()
+    {
+      std::map<std::string, std::unique_ptr<ConvertStep>> result;
+
+      // The conversion recipes within the embedded files database are named,
+      // e.g., "1.8/1_7.convert" to upgrade from 1.7 to 1.8.
+      const std::string extension = ".convert";
+      for (const EmbeddedSdfFile &file : GetEmbeddedSdf())
+      {
+        const std::string_view pathname = file.pathname;
+        const std::size_t slash = pathname.rfind('/');
+        if (slash == std::string_view::npos ||
+            !EndsWith(pathname, extension))
+        {
+          continue;
+        }
+
+        std::string fromVersion(pathname.substr(slash + 1,
+            pathname.size() - slash - 1 - extension.size()));
+        std::replace(fromVersion.begin(), fromVersion.end(), '_', '.');
+        if (result.count(fromVersion) > 0)
+          continue;
+
+        auto step = std::make_unique<ConvertStep>();
+        step->toVersion = std::string(pathname.substr(0, slash));
+        step->doc.Parse(file.data.data(), file.data.size());
+        if (step->doc.Error())
+        {
+          step->error = step->doc.ErrorStr();
+        }
+        else if (step->doc.FirstChildElement("convert"))
+        {
+          step->rule =
+              ConvertRule::Compile(step->doc.FirstChildElement("convert"));
+        }
+        result[fromVersion] = std::move(step);
+      }
+      return result;
+    }();
+
+  auto it = steps.find(_fromVersion);
+  return it == steps.end() ? nullptr : it->second.get();
+}
+}
+
+/////////////////////////////////////////////////
+/// \brief Split the paths of a <move> or <copy> operation.
+/// \param[in,out] _action The operation.
+static void compileMove(ConvertRule::Action &_action)
+{
+  tinyxml2::XMLElement *fromConvertElem =
+      _action.xml->FirstChildElement("from");
+  tinyxml2::XMLElement *toConvertElem = _action.xml->FirstChildElement("to");
+  if (!fromConvertElem || !toConvertElem)
+  {
+    _action.error = std::string("<") + _action.xml->Name() +
+        "> element requires <from> and <to> child elements.\n";
+    return;
+  }
+
+  const char *fromElemStr = fromConvertElem->Attribute("element");
+  const char *fromAttrStr = fromConvertElem->Attribute("attribute");
+  const char *toElemStr = toConvertElem->Attribute("element");
+  const char *toAttrStr = toConvertElem->Attribute("attribute");
+
+  _action.fromElement = fromElemStr != nullptr;
+  _action.fromAttribute = fromAttrStr != nullptr;
+  _action.toElement = toElemStr != nullptr;
+  _action.toAttribute = toAttrStr != nullptr;
+  if (toAttrStr)
+    _action.toAttributeName = toAttrStr;
+
+  // split() always returns at least one element, even with the empty
+  // string, so the paths are never empty.
+  std::string fromStr = "";
+  if (fromElemStr)
+    fromStr = fromElemStr;
+  else if (fromAttrStr)
+    fromStr = fromAttrStr;
+  std::string toStr = "";
+  if (toElemStr)
+    toStr = toElemStr;
+  else if (toAttrStr)
+    toStr = toAttrStr;
+  _action.fromPath = split(fromStr, "::");
+  _action.toPath = split(toStr, "::");
+}
+
+/////////////////////////////////////////////////
+/// \brief Split the paths and collect the values of a <map> operation.
+/// \param[in,out] _action The operation.
+static void compileMap(ConvertRule::Action &_action)
+{
+  tinyxml2::XMLElement *fromConvertElem =
+      _action.xml->FirstChildElement("from");
+  tinyxml2::XMLElement *toConvertElem = _action.xml->FirstChildElement("to");
+
+  if (!fromConvertElem)
+  {
+    _action.error = "<map> element requires a <from> child element.\n";
+    return;
+  }
+  if (!toConvertElem)
+  {
+    _action.error = "<map> element requires a <to> child element.\n";
+    return;
+  }
+
+  const char *fromNameStr = fromConvertElem->Attribute("name");
+  const char *toNameStr = toConvertElem->Attribute("name");
+
+  if (!fromNameStr || fromNameStr[0] == '\0')
+  {
+    _action.error =
+        "Map: <from> element requires a non-empty name attribute.\n";
+    return;
+  }
+  if (!toNameStr || toNameStr[0] == '\0')
+  {
+    _action.error =
+        "Map: <to> element requires a non-empty name attribute.\n";
+    return;
+  }
+
+  // create map of input and output values
+  auto *fromValueElem = fromConvertElem->FirstChildElement("value");
+  auto *toValueElem = toConvertElem->FirstChildElement("value");
+  if (!fromValueElem)
+  {
+    _action.error =
+        "Map: <from> element requires at least one <value> element.\n";
+    return;
+  }
+  if (!toValueElem)
+  {
+    _action.error =
+        "Map: <to> element requires at least one <value> element.\n";
+    return;
+  }
+  while (fromValueElem)
+  {
+    if (!fromValueElem->GetText())
+    {
+      _action.error = "Map: from value must not be empty.\n";
+      return;
+    }
+    if (!toValueElem->GetText())
+    {
+      _action.error = "Map: to value must not be empty.\n";
+      return;
+    }
+    _action.values[fromValueElem->GetText()] = toValueElem->GetText();
+
+    // The last <to> value is used for the remaining <from> values.
+    fromValueElem = fromValueElem->NextSiblingElement("value");
+    if (fromValueElem && toValueElem->NextSiblingElement("value"))
+      toValueElem = toValueElem->NextSiblingElement("value");
+  }
+
+  // split() always returns at least one element, even with the empty
+  // string, so the paths are never empty.
+  _action.fromPath = split(fromNameStr, "/");
+  _action.toPath = split(toNameStr, "/");
+}
+
+/////////////////////////////////////////////////
+ConvertRule ConvertRule::Compile(tinyxml2::XMLElement *_convert)
+{
+  SDF_ASSERT(_convert != nullptr, "Convert element is NULL");
+
+  ConvertRule rule;
+  rule.xml = _convert;
+  rule.name = _convert->Attribute("name");
+  rule.descendantName = _convert->Attribute("descendant_name");
+  rule.hasDeprecated = _convert->FirstChildElement("deprecated") != nullptr;
+
+  for (tinyxml2::XMLElement *childElem = _convert->FirstChildElement();
+       childElem; childElem = childElem->NextSiblingElement())
+  {
+    const auto name = std::string(childElem->Name());
+
+    if (name == "convert")
+    {
+      rule.converts.push_back(Compile(childElem));
+      const char *descendantName = rule.converts.back().descendantName;
+      if (descendantName && std::none_of(rule.descendantNames.begin(),
+            rule.descendantNames.end(), [descendantName](const char *_name)
+            {
+              return strcmp(_name, descendantName) == 0;
+            }))
+      {
+        rule.descendantNames.push_back(descendantName);
+      }
+      continue;
+    }
+
+    ActionType type = ActionType::UNKNOWN;
+    if (name == "rename")
+      type = ActionType::RENAME;
+    else if (name == "copy")
+      type = ActionType::COPY;
+    else if (name == "map")
+      type = ActionType::MAP;
+    else if (name == "move")
+      type = ActionType::MOVE;
+    else if (name == "add")
+      type = ActionType::ADD;
+    else if (name == "remove")
+      type = ActionType::REMOVE;
+    Action action;
+    action.type = type;
+    action.xml = childElem;
+    if (type == ActionType::COPY || type == ActionType::MOVE)
+      compileMove(action);
+    else if (type == ActionType::MAP)
+      compileMap(action);
+    rule.actions.push_back(std::move(action));
+  }
+
+  return rule;
+}
+
+/////////////////////////////////////////////////
+void Converter::Preload()
+{
+  FindConvertStep("");
 }
 
 /////////////////////////////////////////////////
 bool Converter::Convert(tinyxml2::XMLDocument *_doc,
                         const std::string &_toVersion,
-                        bool _quiet)
+                        bool _quiet,
+                        bool _singlePass,
+                        unsigned int _threadCount)
 {
+  LoadPhaseTimer timer(LoadPhase::CONVERSION);
   SDF_ASSERT(_doc != nullptr, "SDF XML doc is NULL");
 
   tinyxml2::XMLElement *elem = _doc->FirstChildElement("sdf");
@@ -81,43 +343,52 @@ bool Converter::Convert(tinyxml2::XMLDocument *_doc,
 
   elem->SetAttribute("version", _toVersion.c_str());
 
-  // The conversion recipes within the embedded files database are named, e.g.,
-  // "1.8/1_7.convert" to upgrade from 1.7 to 1.8.
-  const std::map<std::string, std::string> &embedded = GetEmbeddedSdf();
-
-  // Apply the conversions one at a time until we reach the desired _toVersion.
+  // Collect the conversions needed to reach the desired _toVersion.
+  std::vector<const ConvertRule *> rules;
   std::string curVersion = origVersion;
+  std::string error;
   while (curVersion != _toVersion)
   {
-    // Find the (at most one) file named, e.g., ".../1_7.convert".
-    std::string snakeVersion = curVersion;
-    std::replace(snakeVersion.begin(), snakeVersion.end(), '.', '_');
-    const std::string suffix = "/" + snakeVersion + ".convert";
-    const char* convertXml = nullptr;
-    for (const auto& [pathname, data] : embedded)
+    const ConvertStep *step = FindConvertStep(curVersion);
+    if (step == nullptr)
     {
-      if (EndsWith(pathname, suffix))
-      {
-        curVersion = pathname.substr(0, pathname.size() - suffix.size());
-        convertXml = data.c_str();
-        break;
-      }
+      break;
     }
-    if (convertXml == nullptr)
+    curVersion = step->toVersion;
+
+    if (!step->error.empty())
     {
+      error = step->error;
       break;
     }
+    if (step->rule.xml)
+    {
+      rules.push_back(&step->rule);
+    }
+  }
 
-    // Parse and apply the conversion XML.
-    tinyxml2::XMLDocument xmlDoc;
-    xmlDoc.Parse(convertXml);
-    if (xmlDoc.Error())
+  // Apply the conversions, which may be combined into a single traversal.
+  if (_threadCount != 1 &&
+      ConvertModelsInParallel(elem, rules, _singlePass, _threadCount))
+  {
+    // The models were converted in parallel with the other elements.
+  }
+  else if (_singlePass)
+  {
+    ConvertFusedImpl(elem, rules);
+  }
+  else
+  {
+    for (const ConvertRule *rule : rules)
     {
-      sdferr << "Error parsing XML from string: "
-             << xmlDoc.ErrorStr() << '\n';
-      return false;
+      ConvertImpl(elem, *rule);
     }
-    ConvertImpl(elem, xmlDoc.FirstChildElement("convert"));
+  }
+
+  if (!error.empty())
+  {
+    sdferr << "Error parsing XML from string: " << error << '\n';
+    return false;
   }
 
   // Check that we actually converted to the desired final version.
@@ -138,100 +409,519 @@ void Converter::Convert(tinyxml2::XMLDocument *_doc,
   SDF_ASSERT(_doc != NULL, "SDF XML doc is NULL");
   SDF_ASSERT(_convertDoc != NULL, "Convert XML doc is NULL");
 
-  ConvertImpl(_doc->FirstChildElement(), _convertDoc->FirstChildElement());
+  ConvertImpl(_doc->FirstChildElement(),
+      ConvertRule::Compile(_convertDoc->FirstChildElement()));
 }
 
 /////////////////////////////////////////////////
-void Converter::ConvertDescendantsImpl(tinyxml2::XMLElement *_e,
-                                       tinyxml2::XMLElement *_c)
+/// \brief Check whether all nested rules of a rule only apply to named
+/// children, so that they can be merged with the nested rules of other
+/// rules.
+/// \param[in] _rule The rule to check.
+/// \return True if no nested rule uses descendant_name.
+static bool HasOnlyNamedConverts(const ConvertRule &_rule)
 {
-  if (!_c->Attribute("descendant_name"))
+  for (const ConvertRule &convertRule : _rule.converts)
   {
-    return;
+    if (!convertRule.name || convertRule.descendantName)
+      return false;
   }
+  return true;
+}
 
-  if (strcmp(_e->Name(), "plugin") == 0)
+/////////////////////////////////////////////////
+void Converter::ConvertFusedImpl(tinyxml2::XMLElement *_elem,
+    const std::vector<const ConvertRule *> &_rules)
+{
+  std::size_t i = 0;
+  while (i < _rules.size())
   {
-    return;
+    if (!HasOnlyNamedConverts(*_rules[i]))
+    {
+      ConvertImpl(_elem, *_rules[i]);
+      ++i;
+      continue;
+    }
+
+    // Form a group of rules whose nested rules are applied in one pass over
+    // the children. Every rule of the group except the last one must only
+    // forward to named children: such a rule only changes the subtrees of
+    // the children, which are disjoint, so its work on one child can be
+    // interleaved with later rules' work on the same child. The last rule
+    // may also have operations, which run after all children are done, as
+    // they do when the rules are applied one by one. Only the first rule
+    // may check for deprecated elements, since the check has to see the
+    // children before any of the group's rules modify them.
+    std::size_t end = i + 1;
+    bool lastHasActions = !_rules[i]->actions.empty();
+    while (!lastHasActions && end < _rules.size() &&
+           HasOnlyNamedConverts(*_rules[end]) &&
+           !_rules[end]->hasDeprecated)
+    {
+      lastHasActions = !_rules[end]->actions.empty();
+      ++end;
+    }
+
+    if (_rules[i]->hasDeprecated)
+    {
+      CheckDeprecation(_elem, _rules[i]->xml);
+    }
+
+    std::vector<const ConvertRule *> childRules;
+    for (tinyxml2::XMLElement *child = _elem->FirstChildElement(); child;
+         child = child->NextSiblingElement())
+    {
+      childRules.clear();
+      for (std::size_t r = i; r < end; ++r)
+      {
+        for (const ConvertRule &convertRule : _rules[r]->converts)
+        {
+          if (strcmp(child->Name(), convertRule.name) == 0)
+            childRules.push_back(&convertRule);
+        }
+      }
+
+      if (!childRules.empty())
+      {
+        ConvertFusedImpl(child, childRules);
+      }
+    }
+
+    // Only the last rule of the group can have operations.
+    ConvertActions(_elem, *_rules[end - 1]);
+    i = end;
   }
+}
 
-  if (strchr(_e->Name(), ':') != nullptr)
+/////////////////////////////////////////////////
+/// \brief Check whether the operations of a rule name an element, as the
+/// first element of one of their paths, e.g. "model::link".
+/// \param[in] _rule The rule to check.
+/// \param[in] _name Name of the element.
+/// \return True if an attribute of an operation, or of the elements of an
+/// operation, starts with the element name.
+static bool OperationsName(const ConvertRule &_rule, std::string_view _name)
+{
+  std::vector<const tinyxml2::XMLElement *> stack;
+  for (const ConvertRule::Action &action : _rule.actions)
+    stack.push_back(action.xml);
+
+  while (!stack.empty())
   {
-    return;
+    const tinyxml2::XMLElement *elem = stack.back();
+    stack.pop_back();
+    for (const tinyxml2::XMLAttribute *attr = elem->FirstAttribute(); attr;
+         attr = attr->Next())
+    {
+      const std::string_view value = attr->Value();
+      if (value.substr(0, value.find("::")) == _name)
+        return true;
+    }
+    for (const tinyxml2::XMLElement *child = elem->FirstChildElement(); child;
+         child = child->NextSiblingElement())
+    {
+      stack.push_back(child);
+    }
   }
+  return false;
+}
 
-  tinyxml2::XMLElement *e = _e->FirstChildElement();
-  while (e)
+/////////////////////////////////////////////////
+/// \brief Check whether a rule applies to elements with a name, directly
+/// or as descendants.
+/// \param[in] _rule The rule to check.
+/// \param[in] _name Name of the elements.
+/// \return True if the name or descendant_name of the rule is _name.
+static bool AppliesTo(const ConvertRule &_rule, const char *_name)
+{
+  return (_rule.name && strcmp(_rule.name, _name) == 0) ||
+      (_rule.descendantName && strcmp(_rule.descendantName, _name) == 0);
+}
+
+/////////////////////////////////////////////////
+bool Converter::ConvertModelsInParallel(tinyxml2::XMLElement *_elem,
+    const std::vector<const ConvertRule *> &_rules, bool _singlePass,
+    unsigned int _threadCount)
+{
+  // The rules of the <sdf> and <world> elements must leave the worlds and
+  // their models in place, and deprecation checks must see the models.
+  for (const ConvertRule *rule : _rules)
   {
-    if (strcmp(e->Name(), _c->Attribute("descendant_name")) == 0)
+    if (rule->hasDeprecated || OperationsName(*rule, "world"))
+      return false;
+
+    for (const ConvertRule &convertRule : rule->converts)
+    {
+      if (convertRule.descendantName &&
+          strcmp(convertRule.descendantName, "world") == 0)
+      {
+        return false;
+      }
+      if (AppliesTo(convertRule, "world") &&
+          (convertRule.hasDeprecated || OperationsName(convertRule, "model")))
+      {
+        return false;
+      }
+    }
+  }
+
+  std::vector<tinyxml2::XMLElement *> models;
+  for (tinyxml2::XMLElement *world = _elem->FirstChildElement("world"); world;
+       world = world->NextSiblingElement("world"))
+  {
+    for (tinyxml2::XMLElement *model = world->FirstChildElement("model");
+         model; model = model->NextSiblingElement("model"))
+    {
+      models.push_back(model);
+    }
+  }
+  if (models.size() < 2)
+    return false;
+
+  // Apply the parts of a rule of the <sdf> element that reach a model of a
+  // world, in the order ConvertImpl would apply them.
+  auto convertModel = [](tinyxml2::XMLElement *_model,
+                         const ConvertRule &_rule)
+  {
+    auto convertDescendants = [_model](const ConvertRule &_descendantRule)
+    {
+      if (strcmp(_model->Name(), _descendantRule.descendantName) == 0)
+        ConvertImpl(_model, _descendantRule);
+      ConvertDescendantsImpl(_model, _descendantRule);
+    };
+
+    for (const ConvertRule &convertRule : _rule.converts)
     {
-      ConvertImpl(e, _c);
+      if (convertRule.name && strcmp(convertRule.name, "world") == 0)
+      {
+        for (const ConvertRule &worldRule : convertRule.converts)
+        {
+          if (worldRule.name && strcmp(worldRule.name, "model") == 0)
+            ConvertImpl(_model, worldRule);
+          if (worldRule.descendantName)
+            convertDescendants(worldRule);
+        }
+      }
+      if (convertRule.descendantName)
+        convertDescendants(convertRule);
     }
-    ConvertDescendantsImpl(e, _c);
-    e = e->NextSiblingElement();
+  };
+
+  // Each model is copied to a document of its own, which a worker converts
+  // while only reading the model in the original document.
+  std::vector<std::unique_ptr<tinyxml2::XMLDocument>> docs(models.size());
+  parallelFor(models.size(), _threadCount, [&](std::size_t _index)
+  {
+    auto doc = std::make_unique<tinyxml2::XMLDocument>();
+    tinyxml2::XMLNode *model = models[_index]->DeepClone(doc.get());
+    doc->InsertEndChild(model);
+    for (const ConvertRule *rule : _rules)
+      convertModel(model->ToElement(), *rule);
+    docs[_index] = std::move(doc);
+  });
+
+  // The models are replaced by comments, which convert rules don't see,
+  // while the rest of the element is converted.
+  tinyxml2::XMLDocument *doc = _elem->GetDocument();
+  std::vector<tinyxml2::XMLComment *> placeholders;
+  placeholders.reserve(models.size());
+  for (tinyxml2::XMLElement *model : models)
+  {
+    tinyxml2::XMLNode *parent = model->Parent();
+    placeholders.push_back(doc->NewComment(""));
+    parent->InsertAfterChild(model, placeholders.back());
+    parent->DeleteChild(model);
+  }
+
+  if (_singlePass)
+  {
+    ConvertFusedImpl(_elem, _rules);
+  }
+  else
+  {
+    for (const ConvertRule *rule : _rules)
+      ConvertImpl(_elem, *rule);
+  }
+
+  for (std::size_t i = 0; i < placeholders.size(); ++i)
+  {
+    tinyxml2::XMLNode *parent = placeholders[i]->Parent();
+    parent->InsertAfterChild(placeholders[i],
+        docs[i]->RootElement()->DeepClone(doc));
+    parent->DeleteChild(placeholders[i]);
   }
+  return true;
 }
 
 /////////////////////////////////////////////////
-void Converter::ConvertImpl(tinyxml2::XMLElement *_elem,
-                            tinyxml2::XMLElement *_convert)
+/// \brief Mask of a subtree whose content is unknown, e.g. because it was
+/// converted after the masks were computed. The walks visit all of it.
+static constexpr std::uint64_t kUnknownMask = ~std::uint64_t(0);
+
+/////////////////////////////////////////////////
+/// \brief Mask with the bits of all the descendant names of a rule, which
+/// are fewer than 64. The walks still skip the subtrees of the children of
+/// an element with this mask.
+static constexpr std::uint64_t kAnyNameMask = kUnknownMask >> 1;
+
+/////////////////////////////////////////////////
+/// \brief Get the mask of the descendant names in the subtree of an
+/// element, which is kept in its user data.
+/// \param[in] _elem The element.
+/// \return The mask.
+static std::uint64_t subtreeMask(const tinyxml2::XMLElement *_elem)
 {
-  SDF_ASSERT(_elem != NULL, "SDF element is NULL");
-  SDF_ASSERT(_convert != NULL, "Convert element is NULL");
+  return reinterpret_cast<std::uintptr_t>(_elem->GetUserData());
+}
+
+/////////////////////////////////////////////////
+/// \brief Set the mask of the descendant names in the subtree of an
+/// element.
+/// \param[in] _elem The element.
+/// \param[in] _mask The mask.
+static void setSubtreeMask(tinyxml2::XMLElement *_elem, std::uint64_t _mask)
+{
+  _elem->SetUserData(
+      reinterpret_cast<void *>(static_cast<std::uintptr_t>(_mask)));
+}
 
-  CheckDeprecation(_elem, _convert);
+/////////////////////////////////////////////////
+/// \brief Check whether descendant_name rules descend into an element. The
+/// descendants of plugins and of namespaced elements are left as is.
+/// \param[in] _elem The element.
+/// \return True if the children of the element are visited.
+static bool descends(const tinyxml2::XMLElement *_elem)
+{
+  return strcmp(_elem->Name(), "plugin") != 0 &&
+      strchr(_elem->Name(), ':') == nullptr;
+}
 
-  for (auto *convertElem = _convert->FirstChildElement("convert");
-       convertElem; convertElem = convertElem->NextSiblingElement("convert"))
+/////////////////////////////////////////////////
+/// \brief Store in each descendant of an element the mask of the names
+/// that are in its subtree, where bit i stands for _names[i]. The
+/// descendants are visited like in ConvertDescendantsImpl.
+/// \param[in] _e The element.
+/// \param[in] _names Descendant names, fewer than 64.
+static void markDescendants(tinyxml2::XMLElement *_e,
+    const std::vector<const char *> &_names)
+{
+  if (!descends(_e) || !_e->FirstChildElement())
+  {
+    return;
+  }
+
+  std::vector<tinyxml2::XMLElement *> stack = {_e->FirstChildElement()};
+  bool enter = true;
+  while (!stack.empty())
   {
-    if (convertElem->Attribute("name"))
+    tinyxml2::XMLElement *e = stack.back();
+    if (enter)
     {
-      tinyxml2::XMLElement *elem = _elem->FirstChildElement(
-          convertElem->Attribute("name"));
-      while (elem)
+      std::uint64_t mask = 0;
+      for (std::size_t i = 0; i < _names.size(); ++i)
       {
-        ConvertImpl(elem, convertElem);
-        elem = elem->NextSiblingElement(convertElem->Attribute("name"));
+        if (strcmp(e->Name(), _names[i]) == 0)
+          mask |= std::uint64_t(1) << i;
+      }
+      setSubtreeMask(e, mask);
+
+      tinyxml2::XMLElement *child =
+          descends(e) ? e->FirstChildElement() : nullptr;
+      if (child)
+      {
+        stack.push_back(child);
+        continue;
       }
     }
-    if (convertElem->Attribute("descendant_name"))
+
+    // The subtree of e is done, so its mask is complete.
+    if (stack.size() > 1)
+    {
+      tinyxml2::XMLElement *parent = stack[stack.size() - 2];
+      setSubtreeMask(parent, subtreeMask(parent) | subtreeMask(e));
+    }
+
+    tinyxml2::XMLElement *next = e->NextSiblingElement();
+    if (next)
     {
-      ConvertDescendantsImpl(_elem, convertElem);
+      stack.back() = next;
+      enter = true;
+    }
+    else
+    {
+      stack.pop_back();
+      enter = false;
     }
   }
+}
 
-  for (tinyxml2::XMLElement *childElem = _convert->FirstChildElement();
-       childElem; childElem = childElem->NextSiblingElement())
+/////////////////////////////////////////////////
+void Converter::ConvertDescendantsImpl(tinyxml2::XMLElement *_e,
+                                       const ConvertRule &_c,
+                                       std::uint64_t _mask)
+{
+  if (!_c.descendantName)
   {
-    const auto name = std::string(childElem->Name());
+    return;
+  }
 
-    if (name == "rename")
-    {
-      Rename(_elem, childElem);
-    }
-    else if (name == "copy")
+  if (!descends(_e) || !_e->FirstChildElement())
+  {
+    return;
+  }
+
+  // Depth first traversal with an explicit stack holding the element being
+  // visited at each depth, so that deep documents can be converted on
+  // threads with small stacks. Each element is converted before its
+  // descendants, and its next sibling is only looked up once they are
+  // done, as they may have been changed.
+  //
+  // With a mask, the subtrees without the descendant name are skipped,
+  // except below unmaskedDepth, in a subtree whose masks are unknown.
+  std::vector<tinyxml2::XMLElement *> stack = {_e->FirstChildElement()};
+  std::size_t unmaskedDepth = std::string::npos;
+  bool enter = true;
+  while (!stack.empty())
+  {
+    tinyxml2::XMLElement *e = stack.back();
+    if (enter)
     {
-      Move(_elem, childElem, true);
+      bool skip = false;
+      if (_mask != 0 && stack.size() < unmaskedDepth)
+      {
+        const std::uint64_t mask = subtreeMask(e);
+        if (mask == kUnknownMask)
+          unmaskedDepth = stack.size() + 1;
+        else
+          skip = (mask & _mask) == 0;
+      }
+
+      if (!skip && strcmp(e->Name(), _c.descendantName) == 0)
+      {
+        ConvertImpl(e, _c);
+
+        // The subtree of e may have changed, including its masks, which
+        // later walks of the same parent rule must not trust.
+        if (_mask != 0)
+        {
+          setSubtreeMask(e, kUnknownMask);
+          for (std::size_t i = 0; i + 1 < stack.size(); ++i)
+            setSubtreeMask(stack[i], subtreeMask(stack[i]) | kAnyNameMask);
+          unmaskedDepth = std::min(unmaskedDepth, stack.size() + 1);
+        }
+      }
+
+      tinyxml2::XMLElement *child =
+          !skip && descends(e) ? e->FirstChildElement() : nullptr;
+      if (child)
+      {
+        stack.push_back(child);
+        continue;
+      }
     }
-    else if (name == "map")
+
+    tinyxml2::XMLElement *next = e->NextSiblingElement();
+    if (next)
     {
-      Map(_elem, childElem);
+      stack.back() = next;
+      enter = true;
     }
-    else if (name == "move")
+    else
     {
-      Move(_elem, childElem, false);
+      stack.pop_back();
+      enter = false;
     }
-    else if (name == "add")
+    if (stack.size() < unmaskedDepth)
+      unmaskedDepth = std::string::npos;
+  }
+}
+
+/////////////////////////////////////////////////
+void Converter::ConvertImpl(tinyxml2::XMLElement *_elem,
+                            const ConvertRule &_convert)
+{
+  SDF_TRACE_SCOPE_TEXT("sdf::Converter::ConvertImpl",
+      std::string(_elem ? _elem->Name() : ""));
+  SDF_ASSERT(_elem != NULL, "SDF element is NULL");
+  SDF_ASSERT(_convert.xml != NULL, "Convert element is NULL");
+
+  if (_convert.hasDeprecated)
+  {
+    CheckDeprecation(_elem, _convert.xml);
+  }
+
+  // When several rules walk the descendants, the subtree is scanned once
+  // for all their names, before the first walk, so that each walk skips
+  // the subtrees without its name.
+  const std::vector<const char *> &names = _convert.descendantNames;
+  const bool useMasks = names.size() > 1 && names.size() < 64;
+  bool marked = false;
+
+  for (const ConvertRule &convertRule : _convert.converts)
+  {
+    if (convertRule.name)
     {
-      Add(_elem, childElem);
+      tinyxml2::XMLElement *elem = _elem->FirstChildElement(convertRule.name);
+      while (elem)
+      {
+        ConvertImpl(elem, convertRule);
+        if (marked)
+          setSubtreeMask(elem, kUnknownMask);
+        elem = elem->NextSiblingElement(convertRule.name);
+      }
     }
-    else if (name == "remove")
+    if (convertRule.descendantName)
     {
-      Remove(_elem, childElem);
+      std::uint64_t mask = 0;
+      if (useMasks)
+      {
+        if (!marked)
+        {
+          markDescendants(_elem, names);
+          marked = true;
+        }
+        for (std::size_t i = 0; i < names.size(); ++i)
+        {
+          if (strcmp(names[i], convertRule.descendantName) == 0)
+            mask = std::uint64_t(1) << i;
+        }
+      }
+      ConvertDescendantsImpl(_elem, convertRule, mask);
     }
-    else if (name != "convert")
+  }
+
+  ConvertActions(_elem, _convert);
+}
+
+/////////////////////////////////////////////////
+void Converter::ConvertActions(tinyxml2::XMLElement *_elem,
+                               const ConvertRule &_convert)
+{
+  for (const ConvertRule::Action &action : _convert.actions)
+  {
+    switch (action.type)
     {
-      sdferr << "Unknown convert element[" << name << "]\n";
+      case ConvertRule::ActionType::RENAME:
+        Rename(_elem, action.xml);
+        break;
+      case ConvertRule::ActionType::COPY:
+        Move(_elem, action, true);
+        break;
+      case ConvertRule::ActionType::MAP:
+        Map(_elem, action);
+        break;
+      case ConvertRule::ActionType::MOVE:
+        Move(_elem, action, false);
+        break;
+      case ConvertRule::ActionType::ADD:
+        Add(_elem, action.xml);
+        break;
+      case ConvertRule::ActionType::REMOVE:
+        Remove(_elem, action.xml);
+        break;
+      default:
+        sdferr << "Unknown convert element[" << action.xml->Name() << "]\n";
+        break;
     }
   }
 }
@@ -365,97 +1055,24 @@ void Converter::Remove(tinyxml2::XMLElement *_elem,
 }
 
 /////////////////////////////////////////////////
-void Converter::Map(tinyxml2::XMLElement *_elem, tinyxml2::XMLElement *_mapElem)
+void Converter::Map(tinyxml2::XMLElement *_elem,
+                    const ConvertRule::Action &_map)
 {
   SDF_ASSERT(_elem != nullptr, "SDF element is nullptr");
-  SDF_ASSERT(_mapElem != nullptr, "Map element is nullptr");
+  SDF_ASSERT(_map.xml != nullptr, "Map element is nullptr");
 
-  tinyxml2::XMLElement *fromConvertElem = _mapElem->FirstChildElement("from");
-  tinyxml2::XMLElement *toConvertElem = _mapElem->FirstChildElement("to");
-
-  if (!fromConvertElem)
-  {
-    sdferr << "<map> element requires a <from> child element.\n";
-    return;
-  }
-  if (!toConvertElem)
-  {
-    sdferr << "<map> element requires a <to> child element.\n";
-    return;
-  }
-
-  const char *fromNameStr = fromConvertElem->Attribute("name");
-  const char *toNameStr = toConvertElem->Attribute("name");
-
-  if (!fromNameStr || fromNameStr[0] == '\0')
-  {
-    sdferr << "Map: <from> element requires a non-empty name attribute.\n";
-    return;
-  }
-  if (!toNameStr || toNameStr[0] == '\0')
-  {
-    sdferr << "Map: <to> element requires a non-empty name attribute.\n";
-    return;
-  }
-
-  // create map of input and output values
-  std::map<std::string, std::string> valueMap;
-  auto *fromValueElem = fromConvertElem->FirstChildElement("value");
-  auto *toValueElem = toConvertElem->FirstChildElement("value");
-  if (!fromValueElem)
-  {
-    sdferr << "Map: <from> element requires at least one <value> element.\n";
-    return;
-  }
-  if (!toValueElem)
-  {
-    sdferr << "Map: <to> element requires at least one <value> element.\n";
-    return;
-  }
-  if (!fromValueElem->GetText())
-  {
-    sdferr << "Map: from value must not be empty.\n";
-    return;
-  }
-  if (!toValueElem->GetText())
+  if (!_map.error.empty())
   {
-    sdferr << "Map: to value must not be empty.\n";
+    sdferr << _map.error;
     return;
   }
-  valueMap[fromValueElem->GetText()] = toValueElem->GetText();
-  while (fromValueElem->NextSiblingElement("value"))
-  {
-    fromValueElem = fromValueElem->NextSiblingElement("value");
-    if (toValueElem->NextSiblingElement("value"))
-    {
-      toValueElem = toValueElem->NextSiblingElement("value");
-    }
-    if (!fromValueElem->GetText())
-    {
-      sdferr << "Map: from value must not be empty.\n";
-      return;
-    }
-    if (!toValueElem->GetText())
-    {
-      sdferr << "Map: to value must not be empty.\n";
-      return;
-    }
-    valueMap[fromValueElem->GetText()] = toValueElem->GetText();
-  }
-
-  // tokenize 'from' and 'to' name attributes
-  std::string fromStr = fromNameStr;
-  std::string toStr = toNameStr;
 
-  std::vector<std::string> fromTokens = split(fromStr, "/");
-  std::vector<std::string> toTokens = split(toStr, "/");
-
-  // split() always returns at least one element, even with the
-  // empty string.  Thus we don't check if the fromTokens or toTokens are empty.
+  const std::vector<std::string> &fromTokens = _map.fromPath;
+  const std::vector<std::string> &toTokens = _map.toPath;
 
   // get value of the 'from' element/attribute
   tinyxml2::XMLElement *fromElem = _elem;
-  for (unsigned int i = 0; i < fromTokens.size()-1; ++i)
+  for (std::size_t i = 0; i < fromTokens.size()-1; ++i)
   {
     fromElem = fromElem->FirstChildElement(fromTokens[i].c_str());
     if (!fromElem)
@@ -485,19 +1102,23 @@ void Converter::Map(tinyxml2::XMLElement *_elem, tinyxml2::XMLElement *_mapElem)
     fromValue = GetValue(fromLeaf, nullptr, fromElem);
   }
 
-  if (!fromValue || valueMap.end() == valueMap.find(std::string(fromValue)))
+  if (!fromValue)
+  {
+    return;
+  }
+  auto value = _map.values.find(std::string_view(fromValue));
+  if (value == _map.values.end())
   {
     // No match, no message to avoid spam.
     return;
   }
-  const char *toValue = valueMap[std::string(fromValue)].c_str();
-  // sdfdbg << "Map from [" << fromValue << "] to [" << toValue << "]\n";
+  const char *toValue = value->second.c_str();
 
   // check if destination elements before leaf exist and create if necessary
-  unsigned int newDirIndex = 0;
+  std::size_t newDirIndex = 0;
   tinyxml2::XMLElement *toElem = _elem;
   tinyxml2::XMLElement *childElem = NULL;
-  for (unsigned int i = 0; i < toTokens.size()-1; ++i)
+  for (std::size_t i = 0; i < toTokens.size()-1; ++i)
   {
     childElem = toElem->FirstChildElement(toTokens[i].c_str());
     if (!childElem)
@@ -524,7 +1145,7 @@ void Converter::Map(tinyxml2::XMLElement *_elem, tinyxml2::XMLElement *_mapElem)
   // elements if they aren't empty
   if (!childElem)
   {
-    int offset = toAttribute ? 1 : 0;
+    std::size_t offset = toAttribute ? 1 : 0;
     while (newDirIndex < (toTokens.size()-offset))
     {
       if (toTokens[newDirIndex].empty())
@@ -553,50 +1174,24 @@ void Converter::Map(tinyxml2::XMLElement *_elem, tinyxml2::XMLElement *_mapElem)
 
 /////////////////////////////////////////////////
 void Converter::Move(tinyxml2::XMLElement *_elem,
-                     tinyxml2::XMLElement *_moveElem,
+                     const ConvertRule::Action &_move,
                      const bool _copy)
 {
   SDF_ASSERT(_elem != NULL, "SDF element is NULL");
-  SDF_ASSERT(_moveElem != NULL, "Move element is NULL");
-
-  tinyxml2::XMLElement *fromConvertElem = _moveElem->FirstChildElement("from");
-  tinyxml2::XMLElement *toConvertElem = _moveElem->FirstChildElement("to");
-
-  const char *fromElemStr = fromConvertElem->Attribute("element");
-  const char *fromAttrStr = fromConvertElem->Attribute("attribute");
+  SDF_ASSERT(_move.xml != NULL, "Move element is NULL");
 
-  const char *toElemStr = toConvertElem->Attribute("element");
-  const char *toAttrStr = toConvertElem->Attribute("attribute");
-
-  // tokenize 'from' and 'to' strs
-  std::string fromStr = "";
-  if (fromElemStr)
-  {
-    fromStr = fromElemStr;
-  }
-  else if (fromAttrStr)
-  {
-    fromStr = fromAttrStr;
-  }
-  std::string toStr = "";
-  if (toElemStr)
+  if (!_move.error.empty())
   {
-    toStr = toElemStr;
-  }
-  else if (toAttrStr)
-  {
-    toStr = toAttrStr;
+    sdferr << _move.error;
+    return;
   }
 
-  std::vector<std::string> fromTokens = split(fromStr, "::");
-  std::vector<std::string> toTokens = split(toStr, "::");
-
-  // split() always returns at least one element, even with the
-  // empty string.  Thus we don't check if the fromTokens or toTokens are empty.
+  const std::vector<std::string> &fromTokens = _move.fromPath;
+  const std::vector<std::string> &toTokens = _move.toPath;
 
   // get value of the 'from' element/attribute
   tinyxml2::XMLElement *fromElem = _elem;
-  for (unsigned int i = 0; i < fromTokens.size()-1; ++i)
+  for (std::size_t i = 0; i < fromTokens.size()-1; ++i)
   {
     fromElem = fromElem->FirstChildElement(fromTokens[i].c_str());
     if (!fromElem)
@@ -610,12 +1205,12 @@ void Converter::Move(tinyxml2::XMLElement *_elem,
   const char *fromName = fromTokens.back().c_str();
   const char *value = nullptr;
 
-  unsigned int newDirIndex = 0;
+  std::size_t newDirIndex = 0;
   // get the new element/attribute name
   const char *toName = toTokens.back().c_str();
   tinyxml2::XMLElement *toElem = _elem;
   tinyxml2::XMLElement *childElem = nullptr;
-  for (unsigned int i = 0; i < toTokens.size()-1; ++i)
+  for (std::size_t i = 0; i < toTokens.size()-1; ++i)
   {
     childElem = toElem->FirstChildElement(toTokens[i].c_str());
     if (!childElem)
@@ -630,7 +1225,7 @@ void Converter::Move(tinyxml2::XMLElement *_elem,
   // elements
   if (!childElem)
   {
-    int offset = toElemStr != nullptr && toAttrStr != nullptr ? 0 : 1;
+    std::size_t offset = _move.toElement && _move.toAttribute ? 0 : 1;
     while (newDirIndex < (toTokens.size()-offset))
     {
       auto *doc = toElem->GetDocument();
@@ -643,7 +1238,7 @@ void Converter::Move(tinyxml2::XMLElement *_elem,
 
   // Get value, or return if no element/attribute found as they don't have to
   // be specified in the sdf.
-  if (fromElemStr)
+  if (_move.fromElement)
   {
     tinyxml2::XMLElement *moveFrom = fromElem->FirstChildElement(fromName);
 
@@ -653,7 +1248,7 @@ void Converter::Move(tinyxml2::XMLElement *_elem,
       return;
     }
 
-    if (toElemStr && !toAttrStr)
+    if (_move.toElement && !_move.toAttribute)
     {
       tinyxml2::XMLNode *cloned = DeepClone(moveFrom->GetDocument(), moveFrom);
       tinyxml2::XMLElement *moveTo = static_cast<tinyxml2::XMLElement*>(cloned);
@@ -663,14 +1258,14 @@ void Converter::Move(tinyxml2::XMLElement *_elem,
     }
     else
     {
-      value = GetValue(fromName, nullptr, fromElem);
+      value = moveFrom->GetText();
       if (!value)
       {
         return;
       }
       std::string valueStr = value;
 
-      toElem->SetAttribute(toAttrStr, valueStr.c_str());
+      toElem->SetAttribute(_move.toAttributeName.c_str(), valueStr.c_str());
     }
 
     if (!_copy)
@@ -678,7 +1273,7 @@ void Converter::Move(tinyxml2::XMLElement *_elem,
       fromElem->DeleteChild(moveFrom);
     }
   }
-  else if (fromAttrStr)
+  else if (_move.fromAttribute)
   {
     value = GetValue(nullptr, fromName, fromElem);
 
@@ -689,7 +1284,7 @@ void Converter::Move(tinyxml2::XMLElement *_elem,
 
     std::string valueStr = value;
 
-    if (toElemStr)
+    if (_move.toElement)
     {
       auto *doc = toElem->GetDocument();
       tinyxml2::XMLElement *moveTo = doc->NewElement(toName);
@@ -697,12 +1292,12 @@ void Converter::Move(tinyxml2::XMLElement *_elem,
       moveTo->LinkEndChild(text);
       toElem->LinkEndChild(moveTo);
     }
-    else if (toAttrStr)
+    else if (_move.toAttribute)
     {
       toElem->SetAttribute(toName, valueStr.c_str());
     }
 
-    if (!_copy && fromAttrStr)
+    if (!_copy)
     {
       fromElem->DeleteAttribute(fromName);
     }
@@ -716,18 +1311,19 @@ const char *Converter::GetValue(const char *_valueElem, const char *_valueAttr,
   if (_valueElem)
   {
     // Check to see if the element that is being converted has the value
-    if (!_elem->FirstChildElement(_valueElem))
+    tinyxml2::XMLElement *valueElem = _elem->FirstChildElement(_valueElem);
+    if (!valueElem)
     {
       return NULL;
     }
 
     if (_valueAttr)
     {
-      return _elem->FirstChildElement(_valueElem)->Attribute(_valueAttr);
+      return valueElem->Attribute(_valueAttr);
     }
     else
     {
-      return _elem->FirstChildElement(_valueElem)->GetText();
+      return valueElem->GetText();
     }
   }
   else if (_valueAttr)
@@ -776,7 +1372,12 @@ void Converter::CheckDeprecation(tinyxml2::XMLElement *_elem,
       }
     }
 
-    sdfwarn << "Deprecated SDF Values in original file:\n"
-            << stream.str() << "\n\n";
+    // A deprecated value is reported once per load, not for each element
+    // that has it.
+    if (DiagnosticScope::FirstTime("deprecated:" + stream.str()))
+    {
+      sdfwarn << "Deprecated SDF Values in original file:\n"
+              << stream.str() << "\n\n";
+    }
   }
 }
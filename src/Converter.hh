@@ -19,7 +19,11 @@
 
 #include <tinyxml2.h>
 
+#include <cstdint>
+#include <functional>
+#include <map>
 #include <string>
+#include <vector>
 
 #include <sdf/sdf_config.h>
 #include "sdf/system_util.hh"
@@ -30,6 +34,100 @@ namespace sdf
   inline namespace SDF_VERSION_NAMESPACE {
   //
 
+  /// \brief A <convert> element of a conversion recipe, compiled so that
+  /// it can be applied to many documents without searching and comparing
+  /// the names of the recipe's XML elements again. The rule points into
+  /// the recipe document, which has to outlive it.
+  struct ConvertRule
+  {
+    /// \brief Operations that a <convert> element can contain.
+    enum class ActionType
+    {
+      RENAME,
+      COPY,
+      MAP,
+      MOVE,
+      ADD,
+      REMOVE,
+      UNKNOWN
+    };
+
+    /// \brief An operation and the recipe element that describes it.
+    struct Action
+    {
+      /// \brief Type of the operation.
+      ActionType type = ActionType::UNKNOWN;
+
+      /// \brief Recipe element, e.g. <rename>.
+      tinyxml2::XMLElement *xml = nullptr;
+
+      /// \brief For <move>, <copy> and <map>, the path of the <from>
+      /// element split into tokens, the last one naming the element or
+      /// attribute that is read.
+      std::vector<std::string> fromPath;
+
+      /// \brief For <move>, <copy> and <map>, the path of the <to>
+      /// element split into tokens.
+      std::vector<std::string> toPath;
+
+      /// \brief For <move> and <copy>, whether the <from> element has an
+      /// element attribute, and otherwise an attribute attribute.
+      bool fromElement = false;
+
+      /// \brief For <move> and <copy>, whether the <from> element has an
+      /// attribute attribute.
+      bool fromAttribute = false;
+
+      /// \brief For <move> and <copy>, whether the <to> element has an
+      /// element attribute.
+      bool toElement = false;
+
+      /// \brief For <move> and <copy>, whether the <to> element has an
+      /// attribute attribute.
+      bool toAttribute = false;
+
+      /// \brief For <move> and <copy>, the attribute attribute of the <to>
+      /// element.
+      std::string toAttributeName;
+
+      /// \brief For <map>, the output value of each input value.
+      std::map<std::string, std::string, std::less<>> values;
+
+      /// \brief Message printed instead of applying a malformed operation,
+      /// or an empty string.
+      std::string error;
+    };
+
+    /// \brief Compile a <convert> element and its nested <convert>
+    /// elements.
+    /// \param[in] _convert Convert xml element tree.
+    /// \return The compiled rule.
+    static ConvertRule Compile(tinyxml2::XMLElement *_convert);
+
+    /// \brief The <convert> element.
+    tinyxml2::XMLElement *xml = nullptr;
+
+    /// \brief Value of the name attribute, or nullptr.
+    const char *name = nullptr;
+
+    /// \brief Value of the descendant_name attribute, or nullptr.
+    const char *descendantName = nullptr;
+
+    /// \brief True if the element has <deprecated> children.
+    bool hasDeprecated = false;
+
+    /// \brief Nested <convert> elements, in document order.
+    std::vector<ConvertRule> converts;
+
+    /// \brief Distinct descendant_name values of the nested rules. The
+    /// index of a name is its bit in the masks that let the walks of
+    /// Converter::ConvertDescendantsImpl skip subtrees without it.
+    std::vector<const char *> descendantNames;
+
+    /// \brief Operations in document order.
+    std::vector<Action> actions;
+  };
+
   /// \brief Convert from one version of SDF to another
   class Converter
   {
@@ -37,9 +135,21 @@ namespace sdf
     /// \param[in] _doc SDF xml doc
     /// \param[in] _toVersion Version number in string format
     /// \param[in] _quiet False to be more verbose
+    /// \param[in] _singlePass True to combine the version steps into
+    /// one traversal of the document where that does not change the
+    /// result, false to apply each step in a separate traversal.
+    /// \param[in] _threadCount Maximum number of threads used to convert
+    /// the models of the worlds, see parallelFor. A value of 1 converts
+    /// the document on the calling thread.
     public: static bool Convert(tinyxml2::XMLDocument *_doc,
                                 const std::string &_toVersion,
-                                bool _quiet = false);
+                                bool _quiet = false,
+                                bool _singlePass = true,
+                                unsigned int _threadCount = 1);
+
+    /// \brief Compile the conversion recipes of all versions, which is
+    /// otherwise done by the first call to Convert.
+    public: static void Preload();
 
     /// \cond
     /// This is an internal function.
@@ -53,16 +163,62 @@ namespace sdf
 
     /// \brief Implementation of Convert functionality.
     /// \param[in] _elem SDF xml element tree to convert.
-    /// \param[in] _convert Convert xml element tree.
+    /// \param[in] _convert Compiled convert rule.
     private: static void ConvertImpl(tinyxml2::XMLElement *_elem,
-                                     tinyxml2::XMLElement *_convert);
+                                     const ConvertRule &_convert);
+
+    /// \brief Apply several compiled rules to an element, in order, with as
+    /// few traversals of the element's subtree as possible. Consecutive
+    /// rules that only forward to named children are merged, so that each
+    /// child is visited once for all of them. Any other rule is applied
+    /// with ConvertImpl when its turn comes, which keeps the result and
+    /// the deprecation warnings identical to applying the rules one by one.
+    /// \param[in] _elem SDF xml element tree to convert.
+    /// \param[in] _rules Rules to apply, in order.
+    private: static void ConvertFusedImpl(tinyxml2::XMLElement *_elem,
+                 const std::vector<const ConvertRule *> &_rules);
+
+    /// \brief Apply rules to an <sdf> element, with the models of its
+    /// worlds converted on up to _threadCount threads. Each model is
+    /// converted in a document of its own, since a tinyxml2 document is
+    /// not safe to change from several threads, while the rest of the
+    /// element is converted as usual. The result is the same as applying
+    /// the rules serially, as long as the rules that apply to the <sdf>
+    /// and <world> elements never name the worlds and models in their
+    /// operations, e.g. a <move> out of a model, so that models only
+    /// change through the rules nested under <world><model>.
+    /// \param[in] _elem The <sdf> element.
+    /// \param[in] _rules Rules to apply, in order.
+    /// \param[in] _singlePass True to apply the rules to the rest of the
+    /// element with ConvertFusedImpl.
+    /// \param[in] _threadCount Maximum number of threads, see parallelFor.
+    /// \return False, without any change to _elem, if a rule names the
+    /// worlds or models, or if there are less than two models to convert,
+    /// in which case the rules have to be applied serially.
+    private: static bool ConvertModelsInParallel(tinyxml2::XMLElement *_elem,
+                 const std::vector<const ConvertRule *> &_rules,
+                 bool _singlePass, unsigned int _threadCount);
 
-    /// \brief Recursive helper function for ConvertImpl that converts
-    /// elements named by the descendant_name attribute.
+    /// \brief Apply the operations of a compiled rule, e.g. <rename>, to an
+    /// element.
+    /// \param[in] _elem SDF xml element to convert.
+    /// \param[in] _convert Compiled convert rule.
+    private: static void ConvertActions(tinyxml2::XMLElement *_elem,
+                                        const ConvertRule &_convert);
+
+    /// \brief Helper function for ConvertImpl that converts the elements
+    /// named by the descendant_name attribute. The descendants are visited
+    /// with an explicit stack, since documents can be much deeper than
+    /// convert rules.
     /// \param[in] _e SDF xml element tree to convert.
-    /// \param[in] _c Convert xml element tree.
+    /// \param[in] _c Compiled convert rule.
+    /// \param[in] _mask Bit of the descendant name in the masks that
+    /// ConvertImpl stored in the user data of the descendants, so that the
+    /// subtrees without the name are skipped, or 0 to visit every
+    /// descendant.
     private: static void ConvertDescendantsImpl(tinyxml2::XMLElement *_e,
-                                                tinyxml2::XMLElement *_c);
+                                                const ConvertRule &_c,
+                                                std::uint64_t _mask = 0);
 
     /// \brief Rename an element or attribute.
     /// \param[in] _elem The element to be renamed, or the element which
@@ -75,19 +231,17 @@ namespace sdf
     /// \brief Map values from one element or attribute to another.
     /// \param[in] _elem Ancestor element of the element or attribute to
     /// be mapped.
-    /// \param[in] _mapElem A 'convert' element that describes the map
-    /// operation.
+    /// \param[in] _map Compiled map operation.
     private: static void Map(tinyxml2::XMLElement *_elem,
-                             tinyxml2::XMLElement *_mapElem);
+                             const ConvertRule::Action &_map);
 
     /// \brief Move an element or attribute within a common ancestor element.
     /// \param[in] _elem Ancestor element of the element or attribute to
     /// be moved.
-    /// \param[in] _moveElem A 'convert' element that describes the move
-    /// operation.
+    /// \param[in] _move Compiled move or copy operation.
     /// \param[in] _copy True to copy the element
     private: static void Move(tinyxml2::XMLElement *_elem,
-                              tinyxml2::XMLElement *_moveElem,
+                              const ConvertRule::Action &_move,
                               const bool _copy);
 
     /// \brief Add an element or attribute to an element.
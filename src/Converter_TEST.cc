@@ -18,10 +18,15 @@
 #include <gtest/gtest.h>
 #include <array>
 #include <sstream>
+#include <string>
+#include <vector>
+#include "sdf/DiagnosticSink.hh"
 #include "sdf/Exception.hh"
 #include "sdf/Filesystem.hh"
+#include "sdf/ParserConfig.hh"
 
 #include "Converter.hh"
+#include "DiagnosticScope.hh"
 #include "XmlUtils.hh"
 
 #include "test_config.h"
@@ -2141,6 +2146,320 @@ TEST(Converter, Pose_16_to_17)
   EXPECT_STREQ("parent", jointLinkPoseElem->Attribute("relative_to"));
 }
 
+/////////////////////////////////////////////////
+/// Test that the cached, compiled embedded recipes produce the same result
+/// as applying the recipe file directly, and can be applied repeatedly.
+TEST(Converter, CachedRecipes_16_to_17)
+{
+  const std::string xmlString = R"(
+<?xml version="1.0" ?>
+<sdf version="1.6">
+  <model name="model">
+    <pose frame="world">0 0 0 0 0 0</pose>
+    <link name="link">
+      <pose frame="model">0 0 1 0 0 0</pose>
+    </link>
+  </model>
+</sdf>)";
+
+  tinyxml2::XMLDocument expectedDoc;
+  expectedDoc.Parse(xmlString.c_str());
+  tinyxml2::XMLDocument convertXmlDoc;
+  convertXmlDoc.LoadFile(CONVERT_DOC_16_17.c_str());
+  sdf::Converter::Convert(&expectedDoc, &convertXmlDoc);
+  expectedDoc.FirstChildElement("sdf")->SetAttribute("version", "1.7");
+  tinyxml2::XMLPrinter expectedPrinter;
+  expectedDoc.Print(&expectedPrinter);
+
+  for (int i = 0; i < 3; ++i)
+  {
+    tinyxml2::XMLDocument xmlDoc;
+    xmlDoc.Parse(xmlString.c_str());
+    ASSERT_TRUE(sdf::Converter::Convert(&xmlDoc, "1.7"));
+    tinyxml2::XMLPrinter printer;
+    xmlDoc.Print(&printer);
+    EXPECT_STREQ(expectedPrinter.CStr(), printer.CStr());
+  }
+}
+
+/////////////////////////////////////////////////
+/// Test that combining the version steps into a single traversal gives the
+/// same result as applying them one by one.
+TEST(Converter, SinglePassMatchesSequential)
+{
+  for (const char *modelFile :
+      {"pr2.sdf", "turtlebot.sdf", "double_pendulum.sdf"})
+  {
+    const std::string filename = sdf::filesystem::append(PROJECT_SOURCE_PATH,
+        "test", "integration", "model", modelFile);
+
+    tinyxml2::XMLDocument sequentialDoc;
+    ASSERT_EQ(tinyxml2::XML_SUCCESS, sequentialDoc.LoadFile(filename.c_str()));
+    ASSERT_TRUE(sdf::Converter::Convert(&sequentialDoc, "1.8", true, false));
+
+    tinyxml2::XMLDocument singlePassDoc;
+    ASSERT_EQ(tinyxml2::XML_SUCCESS, singlePassDoc.LoadFile(filename.c_str()));
+    ASSERT_TRUE(sdf::Converter::Convert(&singlePassDoc, "1.8", true, true));
+
+    tinyxml2::XMLPrinter sequentialPrinter;
+    sequentialDoc.Print(&sequentialPrinter);
+    tinyxml2::XMLPrinter singlePassPrinter;
+    singlePassDoc.Print(&singlePassPrinter);
+    EXPECT_STREQ(sequentialPrinter.CStr(), singlePassPrinter.CStr())
+      << modelFile;
+  }
+
+  // A 1.0 document, for the 1.0 to 1.2 step that checks for deprecated
+  // elements
+  const std::string xmlString = R"(
+<sdf version="1.0">
+  <world name="default">
+    <model name="model">
+      <link name="link">
+        <collision name="collision">
+          <geometry><box><size>1 1 1</size></box></geometry>
+        </collision>
+      </link>
+    </model>
+  </world>
+</sdf>)";
+
+  tinyxml2::XMLDocument sequentialDoc;
+  sequentialDoc.Parse(xmlString.c_str());
+  ASSERT_TRUE(sdf::Converter::Convert(&sequentialDoc, "1.8", true, false));
+
+  tinyxml2::XMLDocument singlePassDoc;
+  singlePassDoc.Parse(xmlString.c_str());
+  ASSERT_TRUE(sdf::Converter::Convert(&singlePassDoc, "1.8", true, true));
+
+  tinyxml2::XMLPrinter sequentialPrinter;
+  sequentialDoc.Print(&sequentialPrinter);
+  tinyxml2::XMLPrinter singlePassPrinter;
+  singlePassDoc.Print(&singlePassPrinter);
+  EXPECT_STREQ(sequentialPrinter.CStr(), singlePassPrinter.CStr());
+}
+
+/////////////////////////////////////////////////
+/// Check that the compiled paths of a rule are applied to every element
+/// the rule matches
+TEST(Converter, CompiledPathsReused)
+{
+  std::string xmlString = "<root>";
+  for (int i = 0; i < 4; ++i)
+  {
+    xmlString += "<item><a><b>" + std::string(i % 2 ? "on" : "off") +
+        "</b></a><c x='" + std::to_string(i) + "'/></item>";
+  }
+  xmlString += "</root>";
+  tinyxml2::XMLDocument xmlDoc;
+  xmlDoc.Parse(xmlString.c_str());
+
+  const std::string convertString = R"(
+<convert name="root">
+  <convert name="item">
+    <map>
+      <from name="a/b">
+        <value>on</value>
+        <value>off</value>
+      </from>
+      <to name="d/@state">
+        <value>1</value>
+        <value>0</value>
+      </to>
+    </map>
+    <move>
+      <from attribute="c::x"/>
+      <to element="e::x"/>
+    </move>
+  </convert>
+</convert>)";
+  tinyxml2::XMLDocument convertXmlDoc;
+  convertXmlDoc.Parse(convertString.c_str());
+  sdf::Converter::Convert(&xmlDoc, &convertXmlDoc);
+
+  int i = 0;
+  for (tinyxml2::XMLElement *item =
+         xmlDoc.FirstChildElement("root")->FirstChildElement("item");
+       item; item = item->NextSiblingElement("item"), ++i)
+  {
+    tinyxml2::XMLElement *d = item->FirstChildElement("d");
+    ASSERT_NE(nullptr, d);
+    EXPECT_STREQ(i % 2 ? "1" : "0", d->Attribute("state"));
+
+    EXPECT_EQ(nullptr, item->FirstChildElement("c")->Attribute("x"));
+    tinyxml2::XMLElement *x =
+        item->FirstChildElement("e")->FirstChildElement("x");
+    ASSERT_NE(nullptr, x);
+    EXPECT_EQ(std::to_string(i), x->GetText());
+  }
+  EXPECT_EQ(4, i);
+}
+
+/////////////////////////////////////////////////
+/// Check that identical deprecation warnings are written once per load
+TEST(Converter, DeprecationOncePerLoad)
+{
+  const std::string xmlString =
+      "<root><item><b c='1'/></item><item><b c='1'/></item>"
+      "<item><b c='2'/></item></root>";
+  const std::string convertString =
+      "<convert name='root'><convert name='item'>"
+      "<deprecated>b/c</deprecated>"
+      "</convert></convert>";
+  tinyxml2::XMLDocument convertXmlDoc;
+  convertXmlDoc.Parse(convertString.c_str());
+
+  sdf::DiagnosticBuffer buffer;
+  sdf::ParserConfig config;
+  config.SetDiagnostics(&buffer);
+  for (int load = 0; load < 2; ++load)
+  {
+    sdf::DiagnosticScope scope(config);
+    tinyxml2::XMLDocument xmlDoc;
+    xmlDoc.Parse(xmlString.c_str());
+    sdf::Converter::Convert(&xmlDoc, &convertXmlDoc);
+  }
+
+  const std::vector<sdf::Diagnostic> diagnostics = buffer.Diagnostics();
+  ASSERT_EQ(4u, diagnostics.size());
+  EXPECT_EQ(sdf::DiagnosticLevel::WARNING, diagnostics[0].level);
+  EXPECT_EQ("Converter.cc", diagnostics[0].file);
+  EXPECT_NE(std::string::npos, diagnostics[0].message.find("c='1'"));
+  EXPECT_NE(std::string::npos, diagnostics[1].message.find("c='2'"));
+  EXPECT_EQ(diagnostics[0].message, diagnostics[2].message);
+}
+
+/////////////////////////////////////////////////
+/// Check that several descendant_name rules skip the subtrees without
+/// their elements, but still see the elements added by earlier rules
+TEST(Converter, DescendantNamesMasks)
+{
+  const std::string xmlString = R"(
+<root>
+  <x><y><z/></y></x>
+  <a/>
+  <p><b/></p>
+  <q><a><b/></a></q>
+  <plugin><b/></plugin>
+</root>)";
+  tinyxml2::XMLDocument xmlDoc;
+  xmlDoc.Parse(xmlString.c_str());
+
+  const std::string convertString = R"(
+<convert name="root">
+  <convert descendant_name="a">
+    <add element="b"/>
+  </convert>
+  <convert descendant_name="b">
+    <add attribute="seen" value="1"/>
+  </convert>
+</convert>)";
+  tinyxml2::XMLDocument convertXmlDoc;
+  convertXmlDoc.Parse(convertString.c_str());
+  sdf::Converter::Convert(&xmlDoc, &convertXmlDoc);
+
+  tinyxml2::XMLElement *root = xmlDoc.FirstChildElement("root");
+  ASSERT_NE(nullptr, root);
+  EXPECT_EQ(nullptr, root->FirstChildElement("x")->FirstChildElement("b"));
+
+  tinyxml2::XMLElement *b =
+      root->FirstChildElement("a")->FirstChildElement("b");
+  ASSERT_NE(nullptr, b);
+  EXPECT_STREQ("1", b->Attribute("seen"));
+
+  b = root->FirstChildElement("p")->FirstChildElement("b");
+  ASSERT_NE(nullptr, b);
+  EXPECT_STREQ("1", b->Attribute("seen"));
+
+  // The b added to the a of q is converted as well as the one that was
+  // there.
+  int count = 0;
+  for (b = root->FirstChildElement("q")->FirstChildElement("a")
+         ->FirstChildElement("b"); b; b = b->NextSiblingElement("b"))
+  {
+    EXPECT_STREQ("1", b->Attribute("seen"));
+    ++count;
+  }
+  EXPECT_EQ(2, count);
+
+  b = root->FirstChildElement("plugin")->FirstChildElement("b");
+  ASSERT_NE(nullptr, b);
+  EXPECT_EQ(nullptr, b->Attribute("seen"));
+}
+
+/////////////////////////////////////////////////
+/// Check that converting the models of a world in parallel gives the same
+/// document as converting them serially
+TEST(Converter, ParallelMatchesSerial)
+{
+  std::string xmlString = R"(
+<sdf version="1.4">
+  <world name="default">
+    <physics type="ode">
+      <gravity>0 0 -9.8</gravity>
+      <magnetic_field>6e-06 2.3e-05 -4.2e-05</magnetic_field>
+    </physics>)";
+  for (int i = 0; i < 16; ++i)
+  {
+    xmlString += R"(
+    <model name="model)" + std::to_string(i) + R"(">
+      <pose frame="world">)" + std::to_string(i) + R"( 0 0 0 0 0</pose>
+      <link name="parent"/>
+      <link name="child">
+        <sensor name="imu" type="imu">
+          <imu>
+            <noise>
+              <type>gaussian</type>
+              <rate><mean>0</mean><stddev>0.01</stddev></rate>
+              <accel><mean>0</mean><stddev>0.1</stddev></accel>
+            </noise>
+          </imu>
+        </sensor>
+      </link>
+      <joint name="joint" type="revolute">
+        <parent>parent</parent>
+        <child>child</child>
+        <axis>
+          <xyz>0 0 1</xyz>
+          <use_parent_model_frame>true</use_parent_model_frame>
+        </axis>
+      </joint>
+    </model>)";
+  }
+  xmlString += R"(
+    <light name="sun" type="directional">
+      <pose frame="world">0 0 10 0 0 0</pose>
+    </light>
+  </world>
+</sdf>)";
+
+  tinyxml2::XMLDocument serialDoc;
+  serialDoc.Parse(xmlString.c_str());
+  ASSERT_TRUE(sdf::Converter::Convert(&serialDoc, "1.8", true, false, 1));
+  tinyxml2::XMLPrinter serialPrinter;
+  serialDoc.Print(&serialPrinter);
+
+  for (bool singlePass : {false, true})
+  {
+    tinyxml2::XMLDocument parallelDoc;
+    parallelDoc.Parse(xmlString.c_str());
+    ASSERT_TRUE(sdf::Converter::Convert(
+        &parallelDoc, "1.8", true, singlePass, 4));
+    tinyxml2::XMLPrinter parallelPrinter;
+    parallelDoc.Print(&parallelPrinter);
+    EXPECT_STREQ(serialPrinter.CStr(), parallelPrinter.CStr()) << singlePass;
+  }
+
+  // The gravity was moved out of the physics and the models were converted.
+  tinyxml2::XMLElement *world =
+      serialDoc.FirstChildElement("sdf")->FirstChildElement("world");
+  EXPECT_NE(nullptr, world->FirstChildElement("gravity"));
+  tinyxml2::XMLElement *pose =
+      world->FirstChildElement("model")->FirstChildElement("pose");
+  ASSERT_NE(nullptr, pose);
+  EXPECT_STREQ("world", pose->Attribute("relative_to"));
+}
+
 /////////////////////////////////////////////////
 /// Main
 int main(int argc, char **argv)
@@ -14,8 +14,11 @@
  * limitations under the License.
  *
 */
+#include <cmath>
 #include <sstream>
 #include "sdf/Cylinder.hh"
+#include "ElementRetentionScope.hh"
+#include "LoadStatsScope.hh"
 
 using namespace sdf;
 
@@ -72,9 +75,10 @@ Cylinder &Cylinder::operator=(Cylinder &&_cylinder)
 /////////////////////////////////////////////////
 Errors Cylinder::Load(ElementPtr _sdf)
 {
+  DomLoadTimer timer("Cylinder");
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that sdf is a valid pointer
   if (!_sdf)
@@ -168,3 +172,19 @@ ignition::math::Cylinderd &Cylinder::Shape()
 {
   return this->dataPtr->cylinder;
 }
+
+/////////////////////////////////////////////////
+ignition::math::AxisAlignedBox Cylinder::AxisAlignedBox() const
+{
+  const double radius = this->Radius();
+  const double halfLength = this->Length() * 0.5;
+  return ignition::math::AxisAlignedBox(
+      ignition::math::Vector3d(-radius, -radius, -halfLength),
+      ignition::math::Vector3d(radius, radius, halfLength));
+}
+
+/////////////////////////////////////////////////
+double Cylinder::BoundingRadius() const
+{
+  return std::hypot(this->Radius(), this->Length() * 0.5);
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_DIAGNOSTIC_SCOPE_HH_
+#define SDF_DIAGNOSTIC_SCOPE_HH_
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+#include "sdf/DiagnosticSink.hh"
+#include "sdf/ParserConfig.hh"
+#include "sdf/sdf_config.h"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief Diagnostic state of one load, shared by its threads.
+  struct LoadDiagnostics
+  {
+    /// \brief Sink of the messages, or nullptr to write them to the
+    /// Console.
+    DiagnosticSink *sink = nullptr;
+
+    /// \brief Keys of the messages already written once.
+    std::unordered_set<std::string> written;
+
+    /// \brief Protects written.
+    std::mutex mutex;
+  };
+
+  /// \brief Makes the diagnostic state of a load current on the calling
+  /// thread while this scope is alive, so that the Console hands the
+  /// messages of the load to its sink. The previous state is restored when
+  /// the scope is destroyed, so scopes can nest.
+  class DiagnosticScope
+  {
+    /// \brief Constructor
+    /// \param[in] _diagnostics State to make current, used by the workers
+    /// of a load.
+    public: explicit DiagnosticScope(LoadDiagnostics *_diagnostics)
+      : previous(Current())
+    {
+      Current() = _diagnostics;
+    }
+
+    /// \brief Constructor that starts a load with the sink of a
+    /// ParserConfig. Nested loads keep the state of the outer load, unless
+    /// they have a sink of their own.
+    /// \param[in] _config Parser configuration.
+    public: explicit DiagnosticScope(const ParserConfig &_config)
+      : previous(Current())
+    {
+      DiagnosticSink *sink = _config.Diagnostics();
+      if (!this->previous || (sink && sink != this->previous->sink))
+      {
+        this->own = std::make_unique<LoadDiagnostics>();
+        this->own->sink = sink;
+        Current() = this->own.get();
+      }
+    }
+
+    /// \brief Destructor
+    public: ~DiagnosticScope()
+    {
+      Current() = this->previous;
+    }
+
+    /// \brief Get the diagnostic state of the current thread.
+    /// \return Reference to the state, which is nullptr outside of loads.
+    public: static LoadDiagnostics *&Current()
+    {
+      static thread_local LoadDiagnostics *current = nullptr;
+      return current;
+    }
+
+    /// \brief Get the sink of the current thread.
+    /// \return The sink, or nullptr if messages go to the Console.
+    public: static DiagnosticSink *Sink()
+    {
+      LoadDiagnostics *diagnostics = Current();
+      return diagnostics ? diagnostics->sink : nullptr;
+    }
+
+    /// \brief Check whether a message is written for the first time in the
+    /// current load, so that repeated messages are written once per load.
+    /// \param[in] _key Key that identifies the message.
+    /// \return True the first time the key is seen by the load, and always
+    /// outside of loads.
+    public: static bool FirstTime(const std::string &_key)
+    {
+      LoadDiagnostics *diagnostics = Current();
+      if (!diagnostics)
+        return true;
+      std::lock_guard<std::mutex> lock(diagnostics->mutex);
+      return diagnostics->written.insert(_key).second;
+    }
+
+    /// \brief State that was current before this scope.
+    private: LoadDiagnostics *previous;
+
+    /// \brief State started by this scope.
+    private: std::unique_ptr<LoadDiagnostics> own;
+  };
+  }
+}
+#endif
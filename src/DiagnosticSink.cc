@@ -0,0 +1,91 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "sdf/DiagnosticSink.hh"
+
+using namespace sdf;
+
+/// \brief Private data for DiagnosticBuffer
+class sdf::DiagnosticBufferPrivate
+{
+  /// \brief Messages above this level are dropped.
+  public: DiagnosticLevel level;
+
+  /// \brief The collected messages.
+  public: std::vector<Diagnostic> diagnostics;
+
+  /// \brief Protects diagnostics.
+  public: mutable std::mutex mutex;
+};
+
+/////////////////////////////////////////////////
+DiagnosticSink::~DiagnosticSink() = default;
+
+/////////////////////////////////////////////////
+DiagnosticBuffer::DiagnosticBuffer(DiagnosticLevel _level)
+  : dataPtr(new DiagnosticBufferPrivate)
+{
+  this->dataPtr->level = _level;
+}
+
+/////////////////////////////////////////////////
+DiagnosticBuffer::~DiagnosticBuffer()
+{
+  delete this->dataPtr;
+  this->dataPtr = nullptr;
+}
+
+/////////////////////////////////////////////////
+void DiagnosticBuffer::Write(const Diagnostic &_diagnostic)
+{
+  if (_diagnostic.level > this->dataPtr->level)
+    return;
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->diagnostics.push_back(_diagnostic);
+}
+
+/////////////////////////////////////////////////
+std::vector<Diagnostic> DiagnosticBuffer::Diagnostics() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->diagnostics;
+}
+
+/////////////////////////////////////////////////
+std::size_t DiagnosticBuffer::Count(DiagnosticLevel _level) const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  std::size_t count = 0;
+  for (const Diagnostic &diagnostic : this->dataPtr->diagnostics)
+  {
+    if (diagnostic.level == _level)
+      ++count;
+  }
+  return count;
+}
+
+/////////////////////////////////////////////////
+void DiagnosticBuffer::Clear()
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->diagnostics.clear();
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include "sdf/Console.hh"
+#include "sdf/DiagnosticSink.hh"
+#include "sdf/ParserConfig.hh"
+#include "sdf/Root.hh"
+
+/////////////////////////////////////////////////
+TEST(DiagnosticBuffer, Write)
+{
+  sdf::DiagnosticBuffer buffer;
+  EXPECT_TRUE(buffer.Diagnostics().empty());
+
+  sdf::Diagnostic diagnostic;
+  diagnostic.level = sdf::DiagnosticLevel::WARNING;
+  diagnostic.message = "warning";
+  buffer.Write(diagnostic);
+  diagnostic.level = sdf::DiagnosticLevel::DEBUG;
+  buffer.Write(diagnostic);
+  diagnostic.level = sdf::DiagnosticLevel::ERROR;
+  buffer.Write(diagnostic);
+
+  // Debug messages are dropped by default.
+  ASSERT_EQ(2u, buffer.Diagnostics().size());
+  EXPECT_EQ(sdf::DiagnosticLevel::WARNING, buffer.Diagnostics()[0].level);
+  EXPECT_EQ(1u, buffer.Count(sdf::DiagnosticLevel::ERROR));
+  EXPECT_EQ(0u, buffer.Count(sdf::DiagnosticLevel::DEBUG));
+
+  buffer.Clear();
+  EXPECT_TRUE(buffer.Diagnostics().empty());
+
+  sdf::DiagnosticBuffer debugBuffer(sdf::DiagnosticLevel::DEBUG);
+  debugBuffer.Write(diagnostic);
+  diagnostic.level = sdf::DiagnosticLevel::DEBUG;
+  debugBuffer.Write(diagnostic);
+  EXPECT_EQ(2u, debugBuffer.Diagnostics().size());
+}
+
+/////////////////////////////////////////////////
+TEST(DiagnosticBuffer, Load)
+{
+  const std::string sdfString =
+    "<sdf version='1.8'>"
+    "  <model name='model' unknown='1'>"
+    "    <link name='link'/>"
+    "  </model>"
+    "</sdf>";
+
+  sdf::DiagnosticBuffer buffer;
+  sdf::ParserConfig config;
+  config.SetDiagnostics(&buffer);
+  EXPECT_EQ(&buffer, config.Diagnostics());
+
+  sdf::Root root;
+  EXPECT_TRUE(root.LoadSdfString(sdfString, config).empty());
+  const std::vector<sdf::Diagnostic> diagnostics = buffer.Diagnostics();
+  ASSERT_EQ(1u, diagnostics.size());
+  EXPECT_EQ(sdf::DiagnosticLevel::WARNING, diagnostics[0].level);
+  EXPECT_EQ("parser.cc", diagnostics[0].file);
+  EXPECT_LT(0u, diagnostics[0].line);
+  EXPECT_EQ("XML Attribute[unknown] in element[model] not defined in SDF, "
+      "ignoring.", diagnostics[0].message);
+
+  // Messages written outside of the load don't reach the sink.
+  sdfwarn << "Outside of a load\n";
+  sdf::Console::Instance()->Flush();
+  EXPECT_EQ(1u, buffer.Diagnostics().size());
+
+  // Each load of another thread writes to its own sink.
+  std::vector<sdf::DiagnosticBuffer> buffers(4);
+  std::vector<std::thread> threads;
+  for (sdf::DiagnosticBuffer &threadBuffer : buffers)
+  {
+    threads.emplace_back([&sdfString, &threadBuffer]
+        {
+          sdf::ParserConfig threadConfig;
+          threadConfig.SetDiagnostics(&threadBuffer);
+          sdf::Root threadRoot;
+          EXPECT_TRUE(threadRoot.LoadSdfString(sdfString,
+              threadConfig).empty());
+        });
+  }
+  for (std::thread &thread : threads)
+    thread.join();
+  for (const sdf::DiagnosticBuffer &threadBuffer : buffers)
+    EXPECT_EQ(1u, threadBuffer.Diagnostics().size());
+}
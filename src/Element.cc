@@ -16,26 +16,326 @@
  */
 
 #include <algorithm>
+#include <cstddef>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <variant>
+#include <vector>
 
 #include "sdf/Assert.hh"
 #include "sdf/Element.hh"
 #include "sdf/Filesystem.hh"
 
+#include "ContentHash.hh"
+#include "ElementArena.hh"
+#include "ElementChangeEpoch.hh"
+#include "ElementReclaimer.hh"
+#include "ElementTagIndex.hh"
+#include "LazyChildren.hh"
+#include "LazyDescriptions.hh"
+#include "MemoryAccounting.hh"
+#include "SymbolTable.hh"
+#include "Utils.hh"
+
 using namespace sdf;
 
+/// \brief Number of entries from which a name index is kept alongside the
+/// child elements, element descriptions or attributes of an Element. Below
+/// this size a linear scan is faster than hashing the name.
+static const std::size_t kNameIndexThreshold = 16;
+
+/////////////////////////////////////////////////
+/// \brief Get the name of an element, used for indexing.
+static const std::string &indexName(const ElementPtr &_elem)
+{
+  return _elem->GetName();
+}
+
+/////////////////////////////////////////////////
+/// \brief Get the key of an attribute, used for indexing.
+static const std::string &indexName(const ParamPtr &_param)
+{
+  return _param->GetKey();
+}
+
+/////////////////////////////////////////////////
+/// \brief Rebuild a name index from scratch.
+/// \param[in] _vec Vector of elements or attributes to index.
+/// \param[out] _index Index to rebuild.
+template <typename T>
+static void rebuildIndex(const std::vector<T> &_vec,
+    std::unordered_map<std::string, std::size_t> &_index)
+{
+  _index.clear();
+  if (_vec.size() < kNameIndexThreshold)
+    return;
+
+  _index.reserve(_vec.size());
+  for (std::size_t i = 0; i < _vec.size(); ++i)
+  {
+    // emplace keeps the first entry for duplicated names.
+    _index.emplace(indexName(_vec[i]), i);
+  }
+}
+
+/////////////////////////////////////////////////
+/// \brief Update a name index after an entry has been appended to the
+/// indexed vector.
+/// \param[in] _vec Vector of elements or attributes that was appended to.
+/// \param[in,out] _index Index to update.
+template <typename T>
+static void indexAppended(const std::vector<T> &_vec,
+    std::unordered_map<std::string, std::size_t> &_index)
+{
+  if (_vec.size() < kNameIndexThreshold)
+    return;
+
+  if (_vec.size() == kNameIndexThreshold)
+    rebuildIndex(_vec, _index);
+  else
+    _index.emplace(indexName(_vec.back()), _vec.size() - 1);
+}
+
+/////////////////////////////////////////////////
+/// \brief Rebuild the name index and the name counts of the child
+/// elements of an element.
+/// \param[in,out] _data Private data of the element.
+static void rebuildElementIndex(ElementPrivate &_data)
+{
+  rebuildIndex(_data.elements, _data.elementIndex);
+  _data.elementCounts.clear();
+  if (_data.elements.size() < kNameIndexThreshold)
+    return;
+
+  for (const ElementPtr &elem : _data.elements)
+    ++_data.elementCounts[elem->GetName()];
+}
+
+/////////////////////////////////////////////////
+/// \brief Update the name index and the name counts of the child elements
+/// of an element after a child has been appended.
+/// \param[in,out] _data Private data of the element.
+static void elementAppended(ElementPrivate &_data)
+{
+  if (_data.elements.size() < kNameIndexThreshold)
+    return;
+
+  if (_data.elements.size() == kNameIndexThreshold)
+  {
+    rebuildElementIndex(_data);
+  }
+  else
+  {
+    indexAppended(_data.elements, _data.elementIndex);
+    ++_data.elementCounts[_data.elements.back()->GetName()];
+  }
+}
+
+/////////////////////////////////////////////////
+/// \brief Clear the name index and the name counts of the child elements
+/// of an element.
+/// \param[in,out] _data Private data of the element.
+static void clearElementIndex(ElementPrivate &_data)
+{
+  _data.elementIndex.clear();
+  _data.elementCounts.clear();
+}
+
+/////////////////////////////////////////////////
+/// \brief Convert a name to the key type of a name index.
+static const std::string &indexKey(const std::string &_name)
+{
+  return _name;
+}
+
+/////////////////////////////////////////////////
+/// \brief Convert a name to the key type of a name index. This is only
+/// needed, and only allocates, for vectors large enough to be indexed.
+static std::string indexKey(std::string_view _name)
+{
+  return std::string(_name);
+}
+
+/////////////////////////////////////////////////
+/// \brief Find the first entry with the given name, using the index when
+/// available.
+/// \param[in] _vec Vector of elements or attributes to search.
+/// \param[in] _index Name index of _vec.
+/// \param[in] _name Name to look for.
+/// \return Pointer to the first entry named _name, or nullptr if there is
+/// none.
+template <typename T, typename NameT>
+static const T *findEntry(const std::vector<T> &_vec,
+    const std::unordered_map<std::string, std::size_t> &_index,
+    const NameT &_name)
+{
+  if (_vec.size() < kNameIndexThreshold)
+  {
+    for (const T &entry : _vec)
+    {
+      if (indexName(entry) == _name)
+        return &entry;
+    }
+    return nullptr;
+  }
+
+  auto iter = _index.find(indexKey(_name));
+  if (iter == _index.end())
+    return nullptr;
+  return &_vec[iter->second];
+}
+
+/////////////////////////////////////////////////
+/// \brief Find the first entry with the given name, using the index when
+/// available.
+/// \param[in] _vec Vector of elements or attributes to search.
+/// \param[in] _index Name index of _vec.
+/// \param[in] _name Name to look for.
+/// \return The first entry named _name, or nullptr if there is none.
+template <typename T, typename NameT>
+static T findIndexed(const std::vector<T> &_vec,
+    const std::unordered_map<std::string, std::size_t> &_index,
+    const NameT &_name)
+{
+  const T *entry = findEntry(_vec, _index, _name);
+  return entry ? *entry : T();
+}
+
+/////////////////////////////////////////////////
+/// \brief Get the description data shared by all elements that have no
+/// description.
+static const std::shared_ptr<ElementDescriptionData> &emptyDescriptionData()
+{
+  static const std::shared_ptr<ElementDescriptionData> empty =
+      std::make_shared<ElementDescriptionData>();
+  return empty;
+}
+
+/////////////////////////////////////////////////
+/// \brief Get the data that holds the child descriptions of an element,
+/// creating them first if that was deferred.
+/// \param[in] _data Description data of the element.
+/// \return _data, or the data of its LazyDescriptions.
+static const ElementDescriptionData &childDescriptions(
+    const ElementDescriptionData &_data)
+{
+  if (!_data.lazyDescriptions)
+    return _data;
+
+  LazyDescriptions &lazy = *_data.lazyDescriptions;
+  std::call_once(lazy.once, [&lazy]()
+  {
+    // The descriptions are shared by every later load, so they are not
+    // allocated from the arena of the load that first needs them.
+    ElementArenaScope heapScope(nullptr);
+    for (ElementPtr &desc : lazy.Create())
+    {
+      lazy.children.elementDescriptions.push_back(std::move(desc));
+      indexAppended(lazy.children.elementDescriptions,
+          lazy.children.elementDescriptionIndex);
+    }
+  });
+  return lazy.children;
+}
+
+/////////////////////////////////////////////////
+/// \brief Get the data that holds the child descriptions of an element.
+/// \param[in] _data Private data of the element.
+/// \return Description data with the child descriptions.
+static const ElementDescriptionData &childDescriptions(
+    const ElementPrivate &_data)
+{
+  return childDescriptions(*_data.descriptionData);
+}
+
+/////////////////////////////////////////////////
+/// \brief Move the child descriptions of description data that is owned
+/// by a single element into the data itself, so that they can be modified.
+/// \param[in,out] _data Description data, which must not be shared.
+static void ownChildDescriptions(ElementDescriptionData &_data)
+{
+  if (_data.lazyDescriptions)
+  {
+    const ElementDescriptionData &children = childDescriptions(_data);
+    _data.elementDescriptions = children.elementDescriptions;
+    _data.elementDescriptionIndex = children.elementDescriptionIndex;
+    _data.lazyDescriptions.reset();
+  }
+}
+
+/////////////////////////////////////////////////
+/// \brief Get the description data of an element for modification, copying
+/// it first if it is shared with other elements.
+/// \param[in,out] _data Private data of the element.
+/// \return Description data owned only by the element.
+static ElementDescriptionData &mutableDescriptionData(ElementPrivate &_data)
+{
+  if (_data.descriptionData.use_count() != 1)
+  {
+    _data.descriptionData =
+        std::make_shared<ElementDescriptionData>(*_data.descriptionData);
+  }
+  return *_data.descriptionData;
+}
+
 /////////////////////////////////////////////////
 Element::Element()
   : dataPtr(new ElementPrivate)
 {
+  this->dataPtr->name = SymbolTable::Empty();
+  this->dataPtr->required = SymbolTable::Empty();
   this->dataPtr->copyChildren = false;
   this->dataPtr->referenceSDF = "";
+  this->dataPtr->descriptionData = emptyDescriptionData();
+  this->dataPtr->releaseInBackground = ElementReclaimScope::Background();
+  this->dataPtr->changeEpoch = ElementChangeEpoch::Current();
 }
 
 /////////////////////////////////////////////////
 Element::~Element()
 {
+  if (this->dataPtr->elements.empty())
+    return;
+
+  // Children of an element destroyed further up the stack of this thread
+  // are queued there, so that deep trees are destroyed without recursion.
+  static thread_local ElementPtr_V *releasing = nullptr;
+
+  ElementPtr_V children = std::move(this->dataPtr->elements);
+  if (this->dataPtr->releaseInBackground &&
+      !ElementReclaimer::OnReclaimerThread() &&
+      ElementReclaimer::Release(children))
+  {
+    return;
+  }
+
+  if (releasing)
+  {
+    releasing->insert(releasing->end(),
+        std::make_move_iterator(children.begin()),
+        std::make_move_iterator(children.end()));
+    return;
+  }
+
+  releasing = &children;
+  while (!children.empty())
+  {
+    ElementPtr child = std::move(children.back());
+    children.pop_back();
+    child.reset();
+  }
+  releasing = nullptr;
+}
+
+/////////////////////////////////////////////////
+void Element::WaitForBackgroundRelease()
+{
+  ElementReclaimer::Flush();
 }
 
 /////////////////////////////////////////////////
@@ -48,6 +348,8 @@ ElementPtr Element::GetParent() const
 void Element::SetParent(const ElementPtr _parent)
 {
   this->dataPtr->parent = _parent;
+  if (_parent && this->dataPtr->dirty)
+    _parent->MarkDirty();
 
   // If this element doesn't have a path, get it from the parent
   if (nullptr != _parent && (this->FilePath().empty() ||
@@ -66,25 +368,38 @@ void Element::SetParent(const ElementPtr _parent)
 /////////////////////////////////////////////////
 void Element::SetName(const std::string &_name)
 {
-  this->dataPtr->name = _name;
+  if (*this->dataPtr->name == _name)
+    return;
+
+  this->dataPtr->name = SymbolTable::Intern(_name);
+  this->InvalidateContentHash();
+  if (this->dataPtr->tagIndexId != 0)
+    ElementTagIndex::Renamed(*this);
+
+  // Keep the name index of the parent in sync.
+  auto parent = this->dataPtr->parent.lock();
+  if (parent && !parent->dataPtr->elementIndex.empty())
+  {
+    rebuildElementIndex(*parent->dataPtr);
+  }
 }
 
 /////////////////////////////////////////////////
 const std::string &Element::GetName() const
 {
-  return this->dataPtr->name;
+  return *this->dataPtr->name;
 }
 
 /////////////////////////////////////////////////
 void Element::SetRequired(const std::string &_req)
 {
-  this->dataPtr->required = _req;
+  this->dataPtr->required = SymbolTable::Intern(_req);
 }
 
 /////////////////////////////////////////////////
 const std::string &Element::GetRequired() const
 {
-  return this->dataPtr->required;
+  return *this->dataPtr->required;
 }
 
 /////////////////////////////////////////////////
@@ -117,8 +432,10 @@ void Element::AddValue(const std::string &_type,
                        bool _required,
                        const std::string &_description)
 {
-  this->dataPtr->value = this->CreateParam(this->dataPtr->name,
+  this->dataPtr->value = this->CreateParam(*this->dataPtr->name,
       _type, _defaultValue, _required, _description);
+  this->dataPtr->value->SetParentElement(this->weak_from_this());
+  this->InvalidateContentHash();
 }
 
 /////////////////////////////////////////////////
@@ -130,8 +447,10 @@ void Element::AddValue(const std::string &_type,
                        const std::string &_description)
 {
   this->dataPtr->value =
-      std::make_shared<Param>(this->dataPtr->name, _type, _defaultValue,
-                              _required, _minValue, _maxValue, _description);
+      makeArenaShared<Param>(*this->dataPtr->name, _type, _defaultValue,
+                             _required, _minValue, _maxValue, _description);
+  this->dataPtr->value->SetParentElement(this->weak_from_this());
+  this->InvalidateContentHash();
 }
 
 /////////////////////////////////////////////////
@@ -141,8 +460,8 @@ ParamPtr Element::CreateParam(const std::string &_key,
                               bool _required,
                               const std::string &_description)
 {
-  return ParamPtr(
-      new Param(_key, _type, _defaultValue, _required, _description));
+  return makeArenaShared<Param>(
+      _key, _type, _defaultValue, _required, _description);
 }
 
 /////////////////////////////////////////////////
@@ -154,61 +473,183 @@ void Element::AddAttribute(const std::string &_key,
 {
   this->dataPtr->attributes.push_back(
       this->CreateParam(_key, _type, _defaultValue, _required, _description));
+  this->dataPtr->attributes.back()->SetParentElement(this->weak_from_this());
+  indexAppended(this->dataPtr->attributes, this->dataPtr->attributeIndex);
+  this->InvalidateContentHash();
+  if (_key == "name")
+    this->InvalidateSiblingNames();
 }
 
 /////////////////////////////////////////////////
-ElementPtr Element::Clone() const
+ElementPtr Element::Instantiate() const
 {
-  ElementPtr clone(new Element);
-  clone->dataPtr->description = this->dataPtr->description;
-  clone->dataPtr->name = this->dataPtr->name;
-  clone->dataPtr->required = this->dataPtr->required;
-  clone->dataPtr->copyChildren = this->dataPtr->copyChildren;
-  clone->dataPtr->includeFilename = this->dataPtr->includeFilename;
-  clone->dataPtr->referenceSDF = this->dataPtr->referenceSDF;
-  clone->dataPtr->path = this->dataPtr->path;
-  clone->dataPtr->originalVersion = this->dataPtr->originalVersion;
-
-  Param_V::const_iterator aiter;
-  for (aiter = this->dataPtr->attributes.begin();
-       aiter != this->dataPtr->attributes.end(); ++aiter)
+  // Unlike Clone, an instance starts clean, without children, indices of
+  // them or a cached hash, and it is released like the other elements
+  // created in the current scope rather than like the description.
+  const ElementPrivate &data = *this->dataPtr;
+  ElementPtr elem = makeArenaShared<Element>();
+  elem->dataPtr->descriptionData = data.descriptionData;
+  elem->dataPtr->name = data.name;
+  elem->dataPtr->required = data.required;
+  elem->dataPtr->copyChildren = data.copyChildren;
+  elem->dataPtr->includeFilename = data.includeFilename;
+  elem->dataPtr->referenceSDF = data.referenceSDF;
+  elem->dataPtr->path = data.path;
+  elem->dataPtr->originalVersion = data.originalVersion;
+
+  elem->dataPtr->attributes.reserve(data.attributes.size());
+  for (const ParamPtr &attribute : data.attributes)
   {
-    clone->dataPtr->attributes.push_back((*aiter)->Clone());
+    elem->dataPtr->attributes.push_back(attribute->Clone());
+    elem->dataPtr->attributes.back()->SetParentElement(elem);
   }
+  elem->dataPtr->attributeIndex = data.attributeIndex;
 
-  ElementPtr_V::const_iterator eiter;
-  for (eiter = this->dataPtr->elementDescriptions.begin();
-      eiter != this->dataPtr->elementDescriptions.end(); ++eiter)
+  if (data.value)
   {
-    clone->dataPtr->elementDescriptions.push_back((*eiter)->Clone());
+    elem->dataPtr->value = data.value->Clone();
+    elem->dataPtr->value->SetParentElement(elem);
   }
+  return elem;
+}
+
+/////////////////////////////////////////////////
+ElementPtr Element::Clone() const
+{
+  return this->Clone(1u);
+}
 
-  for (eiter = this->dataPtr->elements.begin();
-       eiter != this->dataPtr->elements.end(); ++eiter)
+/////////////////////////////////////////////////
+ElementPtr Element::Clone(unsigned int _threadCount) const
+{
+  // Copy an element without its children.
+  auto cloneNode = [](const Element &_elem)
   {
-    clone->dataPtr->elements.push_back((*eiter)->Clone());
-    clone->dataPtr->elements.back()->SetParent(clone);
-  }
+    const ElementPrivate &data = *_elem.dataPtr;
+    ElementPtr clone = makeArenaShared<Element>();
+    clone->dataPtr->descriptionData = data.descriptionData;
+    clone->dataPtr->name = data.name;
+    clone->dataPtr->required = data.required;
+    clone->dataPtr->copyChildren = data.copyChildren;
+    clone->dataPtr->includeFilename = data.includeFilename;
+    clone->dataPtr->referenceSDF = data.referenceSDF;
+    clone->dataPtr->path = data.path;
+    clone->dataPtr->originalVersion = data.originalVersion;
+    clone->dataPtr->sourceRange = data.sourceRange;
+
+    // The clone is as dirty as the original.
+    clone->dataPtr->dirty = data.dirty;
+    clone->dataPtr->releaseInBackground = data.releaseInBackground;
+
+    clone->dataPtr->attributes.reserve(data.attributes.size());
+    for (const ParamPtr &attribute : data.attributes)
+    {
+      clone->dataPtr->attributes.push_back(attribute->Clone());
+      clone->dataPtr->attributes.back()->SetParentElement(clone);
+    }
 
-  if (this->dataPtr->value)
+    // Children that have not been read yet stay unread in the clone.
+    clone->dataPtr->lazyChildren = data.lazyChildren;
+
+    if (data.value)
+    {
+      clone->dataPtr->value = data.value->Clone();
+      clone->dataPtr->value->SetParentElement(clone);
+    }
+
+    // The clone has the same names at the same positions, so the indices
+    // are copied instead of being rebuilt.
+    clone->dataPtr->attributeIndex = data.attributeIndex;
+    clone->dataPtr->elementIndex = data.elementIndex;
+    clone->dataPtr->elementCounts = data.elementCounts;
+
+    // The content is the same, so is its hash.
+    clone->dataPtr->hash = data.hash;
+    clone->dataPtr->hashCached = data.hashCached;
+
+    // And so are the names of the children.
+    clone->dataPtr->childNames.store(
+        data.childNames.load(std::memory_order_relaxed),
+        std::memory_order_relaxed);
+
+    clone->dataPtr->elements.reserve(data.elements.size());
+    return clone;
+  };
+
+  using Pending = std::vector<std::pair<const Element *, ElementPtr>>;
+
+  // Clone the children of an element, and queue them to clone theirs.
+  auto cloneChildren = [&cloneNode](const Element &_source,
+      const ElementPtr &_target, Pending &_pending)
+  {
+    for (const ElementPtr &element : _source.dataPtr->elements)
+    {
+      ElementPtr child = cloneNode(*element);
+      child->SetParent(_target);
+      child->dataPtr->indexInParent = _target->dataPtr->elements.size();
+      _target->dataPtr->elements.push_back(child);
+      _pending.emplace_back(element.get(), std::move(child));
+    }
+  };
+
+  // The children are cloned with an explicit stack rather than recursion,
+  // so that deep trees can be cloned on threads with small stacks.
+  auto cloneSubtree = [&cloneChildren](Pending &_stack)
+  {
+    while (!_stack.empty())
+    {
+      auto [source, target] = std::move(_stack.back());
+      _stack.pop_back();
+      cloneChildren(*source, target, _stack);
+    }
+  };
+
+  ElementPtr clone = cloneNode(*this);
+  Pending pending;
+  pending.emplace_back(this, clone);
+
+  if (_threadCount != 1u)
   {
-    clone->dataPtr->value = this->dataPtr->value->Clone();
+    // Clone the top of the tree level by level, until there are enough
+    // subtrees for the threads to balance their sizes. The subtrees only
+    // write to their own elements, and read the cloned parents.
+    const std::size_t threads = _threadCount == 0u ?
+        std::max(1u, std::thread::hardware_concurrency()) : _threadCount;
+    for (int level = 0; level < 8 && !pending.empty() &&
+         pending.size() < 8 * threads; ++level)
+    {
+      Pending next;
+      for (const auto &[source, target] : pending)
+        cloneChildren(*source, target, next);
+      pending = std::move(next);
+    }
+
+    parallelFor(pending.size(), _threadCount, [&](std::size_t _index)
+        {
+          Pending stack;
+          stack.push_back(std::move(pending[_index]));
+          cloneSubtree(stack);
+        });
+    return clone;
   }
 
+  cloneSubtree(pending);
   return clone;
 }
 
 /////////////////////////////////////////////////
 void Element::Copy(const ElementPtr _elem)
 {
-  this->dataPtr->name = _elem->GetName();
-  this->dataPtr->description = _elem->GetDescription();
-  this->dataPtr->required = _elem->GetRequired();
+  _elem->ReadLazyChildren();
+  this->SetName(_elem->GetName());
+  this->dataPtr->descriptionData = _elem->dataPtr->descriptionData;
+  this->dataPtr->required = _elem->dataPtr->required;
   this->dataPtr->copyChildren = _elem->GetCopyChildren();
   this->dataPtr->includeFilename = _elem->dataPtr->includeFilename;
   this->dataPtr->referenceSDF = _elem->ReferenceSDF();
   this->dataPtr->originalVersion = _elem->OriginalVersion();
   this->dataPtr->path = _elem->FilePath();
+  this->dataPtr->sourceRange = _elem->SourceRange();
 
   for (Param_V::iterator iter = _elem->dataPtr->attributes.begin();
        iter != _elem->dataPtr->attributes.end(); ++iter)
@@ -216,6 +657,9 @@ void Element::Copy(const ElementPtr _elem)
     if (!this->HasAttribute((*iter)->GetKey()))
     {
       this->dataPtr->attributes.push_back((*iter)->Clone());
+      this->dataPtr->attributes.back()->SetParentElement(
+          this->weak_from_this());
+      indexAppended(this->dataPtr->attributes, this->dataPtr->attributeIndex);
     }
     ParamPtr param = this->GetAttribute((*iter)->GetKey());
     (*param) = (**iter);
@@ -226,6 +670,7 @@ void Element::Copy(const ElementPtr _elem)
     if (!this->dataPtr->value)
     {
       this->dataPtr->value = _elem->GetValue()->Clone();
+      this->dataPtr->value->SetParentElement(this->weak_from_this());
     }
     else
     {
@@ -233,14 +678,6 @@ void Element::Copy(const ElementPtr _elem)
     }
   }
 
-  this->dataPtr->elementDescriptions.clear();
-  for (ElementPtr_V::const_iterator iter =
-       _elem->dataPtr->elementDescriptions.begin();
-       iter != _elem->dataPtr->elementDescriptions.end(); ++iter)
-  {
-    this->dataPtr->elementDescriptions.push_back((*iter)->Clone());
-  }
-
   this->dataPtr->elements.clear();
   for (ElementPtr_V::iterator iter = _elem->dataPtr->elements.begin();
        iter != _elem->dataPtr->elements.end(); ++iter)
@@ -248,15 +685,19 @@ void Element::Copy(const ElementPtr _elem)
     ElementPtr elem = (*iter)->Clone();
     elem->Copy(*iter);
     elem->SetParent(shared_from_this());
+    elem->dataPtr->indexInParent = this->dataPtr->elements.size();
     this->dataPtr->elements.push_back(elem);
+    ElementTagIndex::Inserted(*this, *elem);
   }
+  rebuildElementIndex(*this->dataPtr);
+  this->InvalidateContentHash();
 }
 
 /////////////////////////////////////////////////
 void Element::PrintDescription(const std::string &_prefix) const
 {
-  std::cout << _prefix << "<element name ='" << this->dataPtr->name
-            << "' required ='" << this->dataPtr->required << "'";
+  std::cout << _prefix << "<element name ='" << *this->dataPtr->name
+            << "' required ='" << *this->dataPtr->required << "'";
 
   if (this->dataPtr->value)
   {
@@ -279,7 +720,8 @@ void Element::PrintDescription(const std::string &_prefix) const
 
   std::cout << ">\n";
 
-  std::cout << _prefix << "  <description>" << this->dataPtr->description
+  std::cout << _prefix << "  <description>"
+            << this->dataPtr->descriptionData->description
             << "</description>\n";
 
   Param_V::iterator aiter;
@@ -308,11 +750,10 @@ void Element::PrintDescription(const std::string &_prefix) const
               << "' required ='*'/>\n";
   }
 
-  ElementPtr_V::iterator eiter;
-  for (eiter = this->dataPtr->elementDescriptions.begin();
-      eiter != this->dataPtr->elementDescriptions.end(); ++eiter)
+  for (const ElementPtr &desc :
+       childDescriptions(*this->dataPtr).elementDescriptions)
   {
-    (*eiter)->PrintDescription(_prefix + "  ");
+    desc->PrintDescription(_prefix + "  ");
   }
 
   std::cout << _prefix << "</element>\n";
@@ -323,28 +764,27 @@ void Element::PrintDocRightPane(std::string &_html, int _spacing,
                                 int &_index) const
 {
   std::ostringstream stream;
-  ElementPtr_V::iterator eiter;
 
   int start = _index++;
 
   std::string childHTML;
-  for (eiter = this->dataPtr->elementDescriptions.begin();
-      eiter != this->dataPtr->elementDescriptions.end(); ++eiter)
+  for (const ElementPtr &desc :
+       childDescriptions(*this->dataPtr).elementDescriptions)
   {
-    (*eiter)->PrintDocRightPane(childHTML, _spacing + 4, _index);
+    desc->PrintDocRightPane(childHTML, _spacing + 4, _index);
   }
 
-  stream << "<a name=\"" << this->dataPtr->name << start
-         << "\">&lt" << this->dataPtr->name << "&gt</a>";
+  stream << "<a name=\"" << *this->dataPtr->name << start
+         << "\">&lt" << *this->dataPtr->name << "&gt</a>";
 
   stream << "<div style='padding-left:" << _spacing << "px;'>\n";
 
   stream << "<div style='background-color: #ffffff'>\n";
 
   stream << "<font style='font-weight:bold'>Description: </font>";
-  if (!this->dataPtr->description.empty())
+  if (!this->dataPtr->descriptionData->description.empty())
   {
-    stream << this->dataPtr->description << "<br>\n";
+    stream << this->dataPtr->descriptionData->description << "<br>\n";
   }
   else
   {
@@ -352,7 +792,7 @@ void Element::PrintDocRightPane(std::string &_html, int _spacing,
   }
 
   stream << "<font style='font-weight:bold'>Required: </font>"
-         << this->dataPtr->required << "&nbsp;&nbsp;&nbsp;\n";
+         << *this->dataPtr->required << "&nbsp;&nbsp;&nbsp;\n";
 
   stream << "<font style='font-weight:bold'>Type: </font>";
   if (this->dataPtr->value)
@@ -419,20 +859,19 @@ void Element::PrintDocLeftPane(std::string &_html, int _spacing,
                                int &_index) const
 {
   std::ostringstream stream;
-  ElementPtr_V::iterator eiter;
 
   int start = _index++;
 
   std::string childHTML;
-  for (eiter = this->dataPtr->elementDescriptions.begin();
-      eiter != this->dataPtr->elementDescriptions.end(); ++eiter)
+  for (const ElementPtr &desc :
+       childDescriptions(*this->dataPtr).elementDescriptions)
   {
-    (*eiter)->PrintDocLeftPane(childHTML, _spacing + 4, _index);
+    desc->PrintDocLeftPane(childHTML, _spacing + 4, _index);
   }
 
   stream << "<a id='" << start << "' onclick='highlight(" << start
-         << ");' href=\"#" << this->dataPtr->name << start
-         << "\">&lt" << this->dataPtr->name << "&gt</a>";
+         << ");' href=\"#" << *this->dataPtr->name << start
+         << "\">&lt" << *this->dataPtr->name << "&gt</a>";
 
   stream << "<div style='padding-left:" << _spacing << "px;'>\n";
 
@@ -441,49 +880,134 @@ void Element::PrintDocLeftPane(std::string &_html, int _spacing,
   _html += "</div>\n";
 }
 
+/////////////////////////////////////////////////
+/// \brief Write the line start of an element.
+/// \param[in] _prefix Prefix of every line.
+/// \param[in] _indent Number of spaces to write after the prefix.
+/// \param[in] _compact True to write nothing.
+/// \param[out] _out Stream to write to.
+static void writeIndent(const std::string &_prefix, std::size_t _indent,
+    bool _compact, std::ostream &_out)
+{
+  if (_compact)
+    return;
+
+  static const char spaces[] = "                                ";
+  const std::size_t chunk = sizeof(spaces) - 1;
+  _out.write(_prefix.data(), static_cast<std::streamsize>(_prefix.size()));
+  for (; _indent > chunk; _indent -= chunk)
+    _out.write(spaces, static_cast<std::streamsize>(chunk));
+  _out.write(spaces, static_cast<std::streamsize>(_indent));
+}
+
+/////////////////////////////////////////////////
+/// \brief Write an element that was included from a file as an include.
+/// \param[in] _prefix Prefix of every line.
+/// \param[in] _indent Number of spaces to write after the prefix.
+/// \param[in] _compact True to leave out indentation and line breaks.
+/// \param[in] _filename Name of the included file.
+/// \param[out] _out Stream to write to.
+static void writeInclude(const std::string &_prefix, std::size_t _indent,
+    bool _compact, const std::string &_filename, std::ostream &_out)
+{
+  writeIndent(_prefix, _indent, _compact, _out);
+  _out << "<include filename='" << _filename << "'/>";
+  if (!_compact)
+    _out << '\n';
+}
+
+/////////////////////////////////////////////////
 void Element::PrintValuesImpl(const std::string &_prefix,
-                              std::ostringstream &_out) const
+                              std::size_t _indent, bool _compact,
+                              std::ostream &_out, const Element *_split,
+                              std::size_t *_splitOffset) const
 {
-  _out << _prefix << "<" << this->dataPtr->name;
+  // Write the start of an element, or all of it if it has no children.
+  // Returns true if the children and the end tag remain to be written.
+  auto writeStart = [&](const Element &_elem, std::size_t _indentation)
+  {
+    _elem.ReadLazyChildren();
+    const ElementPrivate &data = *_elem.dataPtr;
+    writeIndent(_prefix, _indentation, _compact, _out);
+    _out << '<' << *data.name;
 
-  Param_V::const_iterator aiter;
-  for (aiter = this->dataPtr->attributes.begin();
-       aiter != this->dataPtr->attributes.end(); ++aiter)
-  {
-    // Only print attribute values if they were set
-    // TODO(anyone): GetRequired is added here to support up-conversions where a
-    // new required attribute with a default value is added. We would have
-    // better separation of concerns if the conversion process set the required
-    // attributes with their default values.
-    if ((*aiter)->GetSet() || (*aiter)->GetRequired())
+    for (const ParamPtr &attribute : data.attributes)
     {
-      _out << " " << (*aiter)->GetKey() << "='"
-           << (*aiter)->GetAsString() << "'";
+      // Only print attribute values if they were set
+      // TODO(anyone): GetRequired is added here to support up-conversions
+      // where a new required attribute with a default value is added. We
+      // would have better separation of concerns if the conversion process
+      // set the required attributes with their default values.
+      if (attribute->GetSet() || attribute->GetRequired())
+      {
+        _out << ' ' << attribute->GetKey() << "='"
+             << attribute->GetAsString() << '\'';
+      }
     }
-  }
 
-  if (this->dataPtr->elements.size() > 0)
-  {
-    _out << ">\n";
-    ElementPtr_V::const_iterator eiter;
-    for (eiter = this->dataPtr->elements.begin();
-         eiter != this->dataPtr->elements.end(); ++eiter)
+    const bool hasChildren = !data.elements.empty();
+    if (hasChildren)
     {
-      (*eiter)->ToString(_prefix + "  ", _out);
+      _out << '>';
     }
-    _out << _prefix << "</" << this->dataPtr->name << ">\n";
-  }
-  else
-  {
-    if (this->dataPtr->value)
+    else if (data.value)
     {
-      _out << ">" << this->dataPtr->value->GetAsString()
-           << "</" << this->dataPtr->name << ">\n";
+      _out << '>' << data.value->GetAsString() << "</" << *data.name << '>';
     }
     else
     {
-      _out << "/>\n";
+      _out << "/>";
+    }
+
+    if (!_compact)
+      _out << '\n';
+    return hasChildren;
+  };
+
+  // Elements whose children are being written, with their indentation and
+  // the index of their next child. An explicit stack is used instead of
+  // recursion so that deep trees can be written on small thread stacks.
+  struct Frame
+  {
+    const Element *elem;
+    std::size_t indent;
+    std::size_t next;
+  };
+  std::vector<Frame> stack;
+  if (writeStart(*this, _indent))
+    stack.push_back({this, _indent, 0u});
+
+  while (!stack.empty())
+  {
+    Frame &frame = stack.back();
+    const ElementPtr_V &elements = frame.elem->dataPtr->elements;
+    if (frame.elem == _split && frame.next == 0u)
+    {
+      // The children of the split element are written by the caller.
+      *_splitOffset = static_cast<std::size_t>(_out.tellp());
+      frame.next = elements.size();
+    }
+    if (frame.next < elements.size())
+    {
+      const Element &child = *elements[frame.next++];
+      const std::size_t indent = frame.indent + 2;
+      if (!child.dataPtr->includeFilename.empty())
+      {
+        writeInclude(_prefix, indent, _compact,
+            child.dataPtr->includeFilename, _out);
+      }
+      else if (writeStart(child, indent))
+      {
+        stack.push_back({&child, indent, 0u});
+      }
+      continue;
     }
+
+    writeIndent(_prefix, frame.indent, _compact, _out);
+    _out << "</" << frame.elem->dataPtr->name << '>';
+    if (!_compact)
+      _out << '\n';
+    stack.pop_back();
   }
 }
 
@@ -491,7 +1015,7 @@ void Element::PrintValuesImpl(const std::string &_prefix,
 void Element::PrintValues(std::string _prefix) const
 {
   std::ostringstream ss;
-  PrintValuesImpl(_prefix, ss);
+  PrintValuesImpl(_prefix, 0, false, ss);
   std::cout << ss.str();
 }
 
@@ -499,253 +1023,826 @@ void Element::PrintValues(std::string _prefix) const
 std::string Element::ToString(const std::string &_prefix) const
 {
   std::ostringstream out;
-  this->ToString(_prefix, out);
+  this->ToString(_prefix, 0, false, out);
   return out.str();
 }
 
 /////////////////////////////////////////////////
-void Element::ToString(const std::string &_prefix,
-                       std::ostringstream &_out) const
+void Element::ToStream(std::ostream &_out, std::size_t _indent,
+                       bool _compact) const
+{
+  static const std::string noPrefix;
+  this->ToString(noPrefix, _indent, _compact, _out);
+}
+
+/////////////////////////////////////////////////
+std::vector<std::string> Element::ToBuffers(std::size_t _indent,
+    bool _compact, unsigned int _threadCount) const
 {
+  static const std::string noPrefix;
+
+  // Find the element to split at, under a chain of single children.
+  const Element *split = this;
+  std::size_t splitIndent = _indent;
   if (this->dataPtr->includeFilename.empty())
   {
-    PrintValuesImpl(_prefix, _out);
+    split->ReadLazyChildren();
+    while (split->dataPtr->elements.size() == 1u &&
+           split->dataPtr->elements.front()->dataPtr->includeFilename.empty())
+    {
+      split = split->dataPtr->elements.front().get();
+      split->ReadLazyChildren();
+      splitIndent += 2;
+    }
   }
-  else
+
+  const ElementPtr_V &children = split->dataPtr->elements;
+  if (_threadCount == 1u || children.size() < 2u ||
+      !this->dataPtr->includeFilename.empty())
   {
-    _out << _prefix << "<include filename='"
-         << this->dataPtr->includeFilename << "'/>\n";
+    std::ostringstream out;
+    this->ToString(noPrefix, _indent, _compact, out);
+    return {out.str()};
   }
+
+  // The start of the tree up to the split element, its children and the
+  // rest of the tree.
+  std::vector<std::string> buffers(children.size() + 2u);
+  parallelFor(children.size(), _threadCount, [&](std::size_t _index)
+      {
+        std::ostringstream out;
+        children[_index]->ToString(noPrefix, splitIndent + 2, _compact, out);
+        buffers[_index + 1] = out.str();
+      });
+
+  std::ostringstream out;
+  std::size_t splitOffset = 0;
+  this->PrintValuesImpl(noPrefix, _indent, _compact, out, split,
+      &splitOffset);
+  const std::string text = out.str();
+  buffers.front() = text.substr(0, splitOffset);
+  buffers.back() = text.substr(splitOffset);
+  return buffers;
 }
 
 /////////////////////////////////////////////////
-bool Element::HasAttribute(const std::string &_key) const
+void Element::ToStream(std::ostream &_out, std::size_t _indent,
+                       bool _compact, unsigned int _threadCount) const
 {
-  return this->GetAttribute(_key) != nullptr;
+  for (const std::string &buffer : this->ToBuffers(_indent, _compact,
+           _threadCount))
+  {
+    _out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+  }
 }
 
 /////////////////////////////////////////////////
-bool Element::GetAttributeSet(const std::string &_key) const
+void Element::ToString(const std::string &_prefix, std::size_t _indent,
+                       bool _compact, std::ostream &_out) const
 {
-  bool result = false;
-  ParamPtr p = this->GetAttribute(_key);
-  if (p)
+  if (this->dataPtr->includeFilename.empty())
   {
-    result = p->GetSet();
+    PrintValuesImpl(_prefix, _indent, _compact, _out);
+  }
+  else
+  {
+    writeInclude(_prefix, _indent, _compact, this->dataPtr->includeFilename,
+        _out);
   }
-
-  return result;
 }
 
 /////////////////////////////////////////////////
-ParamPtr Element::GetAttribute(const std::string &_key) const
+std::uint64_t Element::ContentHash() const
 {
-  Param_V::const_iterator iter;
-  for (iter = this->dataPtr->attributes.begin();
-      iter != this->dataPtr->attributes.end(); ++iter)
+  if (this->dataPtr->hashCached)
+    return this->dataPtr->hash;
+
+  // The hashes are computed children first with an explicit stack, so
+  // that deep trees can be hashed on small thread stacks. Subtrees whose
+  // hash is cached are not entered.
+  struct Frame
+  {
+    const Element *elem;
+    std::size_t next;
+  };
+  std::vector<Frame> stack;
+  this->ReadLazyChildren();
+  stack.push_back({this, 0u});
+  while (!stack.empty())
   {
-    if ((*iter)->GetKey() == _key)
+    Frame &frame = stack.back();
+    const ElementPtr_V &elements = frame.elem->dataPtr->elements;
+    if (frame.next < elements.size())
+    {
+      const Element *child = elements[frame.next++].get();
+      if (!child->dataPtr->hashCached)
+      {
+        child->ReadLazyChildren();
+        stack.push_back({child, 0u});
+      }
+      continue;
+    }
+
+    ElementPrivate &data = *frame.elem->dataPtr;
+    std::uint64_t hash = hashCombine(0u, *data.name);
+    hash = hashCombine(hash, data.includeFilename);
+
+    // Only the attributes that ToString writes are part of the content.
+    std::size_t attributeCount = 0;
+    for (const ParamPtr &attribute : data.attributes)
     {
-      return (*iter);
+      if (attribute->GetSet() || attribute->GetRequired())
+      {
+        hash = hashCombine(hash, attribute->GetKey());
+        hash = hashCombine(hash, attribute->GetAsString());
+        ++attributeCount;
+      }
     }
+    hash = hashCombine(hash, attributeCount);
+
+    if (data.value)
+      hash = hashCombine(hashCombine(hash, 1u), data.value->GetAsString());
+    else
+      hash = hashCombine(hash, 0u);
+
+    hash = hashCombine(hash, elements.size());
+    for (const ElementPtr &element : elements)
+      hash = hashCombine(hash, element->dataPtr->hash);
+
+    data.hash = hash;
+    data.hashCached = true;
+    ContentHashCount::Add();
+    stack.pop_back();
   }
-  return ParamPtr();
+
+  return this->dataPtr->hash;
 }
 
 /////////////////////////////////////////////////
-size_t Element::GetAttributeCount() const
+/// \brief Get the heap storage of a param value.
+/// \param[in] _value The value.
+/// \return Bytes of the characters of a string value, or of the numbers
+/// of a numeric array, else 0.
+static std::size_t paramValueHeapBytes(
+    const ParamPrivate::ParamVariant &_value)
 {
-  return this->dataPtr->attributes.size();
+  if (const auto *str = std::get_if<std::string>(&_value))
+    return stringHeapBytes(*str);
+  if (const auto *numbers = std::get_if<std::vector<double>>(&_value))
+    return numbers->capacity() * sizeof(double);
+  return 0;
 }
 
 /////////////////////////////////////////////////
-ParamPtr Element::GetAttribute(unsigned int _index) const
+MemoryFootprint Element::MemoryUsage() const
 {
-  ParamPtr result;
-  if (_index < this->dataPtr->attributes.size())
+  MemoryFootprint footprint;
+  std::unordered_set<const void *> descriptions;
+
+  auto addNameIndex = [&footprint](
+      const std::unordered_map<std::string, std::size_t> &_index)
   {
-    result = this->dataPtr->attributes[_index];
+    footprint.elements += hashContainerBytes(_index);
+    for (const auto &entry : _index)
+      footprint.strings += stringHeapBytes(entry.first);
+  };
+
+  auto addParam = [&footprint, &descriptions](const ParamPtr &_param)
+  {
+    if (!_param)
+      return;
+    const ParamPrivate &data = *_param->dataPtr;
+    footprint.params += kSharedBlockBytes + sizeof(Param) + sizeof(data);
+    if (data.updateFunc)
+      footprint.params += sizeof(*data.updateFunc);
+    footprint.strings += paramValueHeapBytes(data.value);
+
+    const auto &desc = data.descriptionData;
+    if (desc && descriptions.insert(desc.get()).second)
+    {
+      footprint.descriptions += kSharedBlockBytes + sizeof(*desc) +
+          stringHeapBytes(desc->description) +
+          paramValueHeapBytes(desc->defaultValue);
+    }
+  };
+
+  std::vector<const Element *> stack{this};
+  while (!stack.empty())
+  {
+    const Element *elem = stack.back();
+    stack.pop_back();
+    const ElementPrivate &data = *elem->dataPtr;
+
+    footprint.elements += kSharedBlockBytes + sizeof(Element) +
+        sizeof(data) + data.elements.capacity() * sizeof(ElementPtr) +
+        data.attributes.capacity() * sizeof(ParamPtr);
+    addNameIndex(data.elementIndex);
+    addNameIndex(data.elementCounts);
+    addNameIndex(data.attributeIndex);
+    footprint.strings += stringHeapBytes(data.includeFilename) +
+        stringHeapBytes(data.referenceSDF) + stringHeapBytes(data.path) +
+        stringHeapBytes(data.originalVersion);
+
+    for (const ParamPtr &attribute : data.attributes)
+      addParam(attribute);
+    addParam(data.value);
+
+    if (data.lazyChildren &&
+        descriptions.insert(data.lazyChildren.get()).second)
+    {
+      footprint.elements += kSharedBlockBytes + sizeof(LazyChildren);
+      footprint.strings += stringHeapBytes(data.lazyChildren->xml);
+    }
+
+    const auto &desc = data.descriptionData;
+    if (desc && descriptions.insert(desc.get()).second)
+    {
+      footprint.descriptions += kSharedBlockBytes + sizeof(*desc) +
+          stringHeapBytes(desc->description) +
+          desc->elementDescriptions.capacity() * sizeof(ElementPtr) +
+          hashContainerBytes(desc->elementDescriptionIndex);
+    }
+
+    for (const ElementPtr &child : data.elements)
+      stack.push_back(child.get());
   }
 
-  return result;
+  return footprint;
 }
 
 /////////////////////////////////////////////////
-size_t Element::GetElementDescriptionCount() const
+void Element::InvalidateContentHash()
 {
-  return this->dataPtr->elementDescriptions.size();
+  this->MarkChanged();
+
+  // The content of this element changes with its children, which have to
+  // be checked for unique names again.
+  this->dataPtr->childNames.store(ElementPrivate::kNamesUnknown,
+      std::memory_order_relaxed);
+
+  this->ClearContentHash();
 }
 
 /////////////////////////////////////////////////
-ElementPtr Element::GetElementDescription(unsigned int _index) const
+void Element::ClearContentHash()
 {
-  ElementPtr result;
-  if (_index < this->dataPtr->elementDescriptions.size())
+  // An element whose hash is not cached has no cached ancestors either,
+  // so the walk stops there.
+  ElementPrivate *data = this->dataPtr.get();
+  while (data->hashCached)
   {
-    result = this->dataPtr->elementDescriptions[_index];
+    data->hashCached = false;
+    ElementPtr parent = data->parent.lock();
+    if (!parent)
+      break;
+    data = parent->dataPtr.get();
   }
-  return result;
 }
 
 /////////////////////////////////////////////////
-ElementPtr Element::GetElementDescription(const std::string &_key) const
+void Element::BuildTagIndex()
 {
-  ElementPtr_V::const_iterator iter;
-  for (iter = this->dataPtr->elementDescriptions.begin();
-       iter != this->dataPtr->elementDescriptions.end(); ++iter)
-  {
-    if ((*iter)->GetName() == _key)
-    {
-      return (*iter);
-    }
-  }
+  ElementTagIndex::Build(*this);
+}
 
-  return ElementPtr();
+/////////////////////////////////////////////////
+void Element::ClearTagIndex()
+{
+  ElementTagIndex::Clear(*this);
 }
 
 /////////////////////////////////////////////////
-ParamPtr Element::GetValue() const
+bool Element::HasTagIndex() const
 {
-  return this->dataPtr->value;
+  return this->dataPtr->tagIndex != nullptr;
 }
 
 /////////////////////////////////////////////////
-bool Element::HasElement(const std::string &_name) const
+bool Element::Dirty() const
 {
-  return this->GetElementImpl(_name) != ElementPtr();
+  return this->dataPtr->dirty;
 }
 
 /////////////////////////////////////////////////
-ElementPtr Element::GetElementImpl(const std::string &_name) const
+void Element::ClearDirty()
 {
-  ElementPtr_V::const_iterator iter;
-  for (iter = this->dataPtr->elements.begin();
-       iter != this->dataPtr->elements.end(); ++iter)
+  if (!this->dataPtr->dirty)
+    return;
+
+  // Subtrees that are clean are not entered, since all of their
+  // descendants are clean too.
+  std::vector<Element *> stack{this};
+  while (!stack.empty())
   {
-    if ((*iter)->GetName() == _name)
+    ElementPrivate &data = *stack.back()->dataPtr;
+    stack.pop_back();
+    data.dirty = false;
+    for (const ParamPtr &attribute : data.attributes)
+      attribute->ClearDirty();
+    if (data.value)
+      data.value->ClearDirty();
+    for (const ElementPtr &child : data.elements)
     {
-      return (*iter);
+      if (child->dataPtr->dirty)
+        stack.push_back(child.get());
     }
   }
+}
 
-  return ElementPtr();
+/////////////////////////////////////////////////
+void Element::InvalidateSiblingNames()
+{
+  if (ElementPtr parent = this->dataPtr->parent.lock())
+  {
+    parent->dataPtr->childNames.store(ElementPrivate::kNamesUnknown,
+        std::memory_order_relaxed);
+  }
 }
 
 /////////////////////////////////////////////////
-ElementPtr Element::GetFirstElement() const
+void Element::MarkDirty()
 {
-  if (this->dataPtr->elements.empty())
+  this->MarkChanged();
+
+  // The ancestors of a dirty element are dirty, so the walk stops at the
+  // first one.
+  ElementPrivate *data = this->dataPtr.get();
+  while (!data->dirty)
   {
-    return ElementPtr();
+    data->dirty = true;
+    ElementPtr parent = data->parent.lock();
+    if (!parent)
+      break;
+    data = parent->dataPtr.get();
   }
-  else
+}
+
+/////////////////////////////////////////////////
+void Element::MarkChanged()
+{
+  const std::uint64_t epoch = ElementChangeEpoch::Current();
+  if (epoch == 0u)
+    return;
+
+  // The ancestors of an element stamped in this epoch are stamped too, so
+  // the walk stops at the first one.
+  ElementPrivate *data = this->dataPtr.get();
+  while (data->changeEpoch != epoch)
   {
-    return this->dataPtr->elements.front();
+    data->changeEpoch = epoch;
+    ElementPtr parent = data->parent.lock();
+    if (!parent)
+      break;
+    data = parent->dataPtr.get();
   }
 }
 
 /////////////////////////////////////////////////
-ElementPtr Element::GetNextElement(const std::string &_name) const
+bool Element::SameOwnContent(const Element &_elem) const
 {
-  auto parent = this->dataPtr->parent.lock();
-  if (parent)
+  const ElementPrivate &a = *this->dataPtr;
+  const ElementPrivate &b = *_elem.dataPtr;
+  if (a.name != b.name || a.includeFilename != b.includeFilename)
+    return false;
+
+  // Attributes that ToString doesn't write are ignored, so the attributes
+  // of both elements are compared in both directions.
+  auto written = [](const ParamPtr &_attribute)
   {
-    ElementPtr_V::const_iterator iter;
-    iter = std::find(parent->dataPtr->elements.begin(),
-        parent->dataPtr->elements.end(), shared_from_this());
+    return _attribute->GetSet() || _attribute->GetRequired();
+  };
+  for (const ParamPtr &attribute : a.attributes)
+  {
+    ParamPtr other = _elem.GetAttribute(attribute->GetKey());
+    const bool otherWritten = other && written(other);
+    if (written(attribute) != otherWritten ||
+        (otherWritten && attribute->GetAsString() != other->GetAsString()))
+    {
+      return false;
+    }
+  }
+  for (const ParamPtr &attribute : b.attributes)
+  {
+    if (written(attribute) && !this->GetAttribute(attribute->GetKey()))
+      return false;
+  }
+
+  if (static_cast<bool>(a.value) != static_cast<bool>(b.value))
+    return false;
+  return !a.value || a.value->GetAsString() == b.value->GetAsString();
+}
+
+/////////////////////////////////////////////////
+void Element::DirtyToStream(std::ostream &_out, std::size_t _indent,
+                            bool _compact) const
+{
+  static const std::string noPrefix;
+  this->PrintDirtyImpl(noPrefix, _indent, _compact, _out);
+}
 
-    if (iter == parent->dataPtr->elements.end())
+/////////////////////////////////////////////////
+std::string Element::DirtyToString(const std::string &_prefix) const
+{
+  std::ostringstream out;
+  this->PrintDirtyImpl(_prefix, 0, false, out);
+  return out.str();
+}
+
+/////////////////////////////////////////////////
+void Element::PrintDirtyImpl(const std::string &_prefix,
+                             std::size_t _indent, bool _compact,
+                             std::ostream &_out) const
+{
+  // Write the start of a dirty element, or all of it if none of its
+  // children are dirty. Returns true if the dirty children and the end tag
+  // remain to be written.
+  auto writeStart = [&](const Element &_elem, std::size_t _indentation)
+  {
+    const ElementPrivate &data = *_elem.dataPtr;
+    writeIndent(_prefix, _indentation, _compact, _out);
+    _out << '<' << *data.name;
+
+    for (const ParamPtr &attribute : data.attributes)
     {
-      return ElementPtr();
+      if (attribute->Dirty() || attribute->GetKey() == "name")
+      {
+        _out << ' ' << attribute->GetKey() << "='"
+             << attribute->GetAsString() << '\'';
+      }
     }
 
-    ++iter;
-    if (iter == parent->dataPtr->elements.end())
+    const bool hasChildren = std::any_of(data.elements.begin(),
+        data.elements.end(), [](const ElementPtr &_child)
+        {
+          return _child->dataPtr->dirty;
+        });
+    if (hasChildren)
     {
-      return ElementPtr();
+      _out << '>';
     }
-    else if (_name.empty())
+    else if (data.value && data.value->Dirty())
     {
-      return *(iter);
+      _out << '>' << data.value->GetAsString() << "</" << *data.name << '>';
     }
     else
     {
-      for (; iter != parent->dataPtr->elements.end(); ++iter)
-      {
-        if ((*iter)->GetName() == _name)
-        {
-          return (*iter);
-        }
-      }
+      _out << "/>";
     }
+
+    if (!_compact)
+      _out << '\n';
+    return hasChildren;
+  };
+
+  if (!this->dataPtr->dirty)
+    return;
+
+  // Elements whose dirty children are being written, as in
+  // PrintValuesImpl.
+  struct Frame
+  {
+    const Element *elem;
+    std::size_t indent;
+    std::size_t next;
+  };
+  std::vector<Frame> stack;
+  if (writeStart(*this, _indent))
+    stack.push_back({this, _indent, 0u});
+
+  while (!stack.empty())
+  {
+    Frame &frame = stack.back();
+    const ElementPtr_V &elements = frame.elem->dataPtr->elements;
+    if (frame.next < elements.size())
+    {
+      const Element &child = *elements[frame.next++];
+      const std::size_t indent = frame.indent + 2;
+      if (child.dataPtr->dirty && writeStart(child, indent))
+        stack.push_back({&child, indent, 0u});
+      continue;
+    }
+
+    writeIndent(_prefix, frame.indent, _compact, _out);
+    _out << "</" << frame.elem->dataPtr->name << '>';
+    if (!_compact)
+      _out << '\n';
+    stack.pop_back();
   }
+}
 
-  return ElementPtr();
+/////////////////////////////////////////////////
+bool Element::HasAttribute(const std::string &_key) const
+{
+  return this->GetAttribute(_key) != nullptr;
 }
 
 /////////////////////////////////////////////////
-std::set<std::string> Element::GetElementTypeNames() const
+bool Element::GetAttributeSet(const std::string &_key) const
 {
-  std::set<std::string> result;
-  auto elem = this->GetFirstElement();
-  while (elem)
+  bool result = false;
+  ParamPtr p = this->GetAttribute(_key);
+  if (p)
   {
-    std::string typeName = elem->GetName();
-    result.insert(typeName);
-    elem = elem->GetNextElement();
+    result = p->GetSet();
   }
+
   return result;
 }
 
 /////////////////////////////////////////////////
-bool Element::HasUniqueChildNames(const std::string &_type) const
+ParamPtr Element::GetAttribute(std::string_view _key) const
+{
+  return findIndexed(this->dataPtr->attributes, this->dataPtr->attributeIndex,
+      _key);
+}
+
+/////////////////////////////////////////////////
+const Param *Element::FindAttribute(std::string_view _key) const
+{
+  const ParamPtr *attribute = findEntry(this->dataPtr->attributes,
+      this->dataPtr->attributeIndex, _key);
+  return attribute ? attribute->get() : nullptr;
+}
+
+/////////////////////////////////////////////////
+const Param_V &Element::Attributes() const
+{
+  return this->dataPtr->attributes;
+}
+
+/////////////////////////////////////////////////
+size_t Element::GetAttributeCount() const
 {
-  auto namedElementsCount = this->CountNamedElements(_type);
-  for (auto &iter : namedElementsCount)
+  return this->dataPtr->attributes.size();
+}
+
+/////////////////////////////////////////////////
+ParamPtr Element::GetAttribute(unsigned int _index) const
+{
+  ParamPtr result;
+  if (_index < this->dataPtr->attributes.size())
   {
-    if (iter.second > 1)
-    {
-      return false;
-    }
+    result = this->dataPtr->attributes[_index];
   }
-  return true;
+
+  return result;
 }
 
 /////////////////////////////////////////////////
-std::map<std::string, std::size_t>
-Element::CountNamedElements(const std::string &_type) const
+size_t Element::GetElementDescriptionCount() const
 {
-  std::map<std::string, std::size_t> result;
+  return childDescriptions(*this->dataPtr).elementDescriptions.size();
+}
 
-  sdf::ElementPtr elem;
-  if (_type.empty())
+/////////////////////////////////////////////////
+ElementPtr Element::GetElementDescription(unsigned int _index) const
+{
+  ElementPtr result;
+  const ElementDescriptionData &data = childDescriptions(*this->dataPtr);
+  if (_index < data.elementDescriptions.size())
   {
-    elem = this->GetFirstElement();
+    result = data.elementDescriptions[_index];
+  }
+  return result;
+}
+
+/////////////////////////////////////////////////
+ElementPtr Element::GetElementDescription(const std::string &_key) const
+{
+  const ElementDescriptionData &data = childDescriptions(*this->dataPtr);
+  return findIndexed(data.elementDescriptions, data.elementDescriptionIndex,
+      _key);
+}
+
+/////////////////////////////////////////////////
+ParamPtr Element::GetValue() const
+{
+  return this->dataPtr->value;
+}
+
+/////////////////////////////////////////////////
+const Param *Element::FindValue() const
+{
+  return this->dataPtr->value.get();
+}
+
+/////////////////////////////////////////////////
+bool Element::HasElement(const std::string &_name) const
+{
+  return this->GetElementImpl(_name) != ElementPtr();
+}
+
+/////////////////////////////////////////////////
+std::size_t Element::CountChildren(const std::string &_name) const
+{
+  this->ReadLazyChildren();
+  if (this->dataPtr->elements.size() < kNameIndexThreshold)
+  {
+    return static_cast<std::size_t>(std::count_if(
+        this->dataPtr->elements.begin(), this->dataPtr->elements.end(),
+        [&_name](const ElementPtr &_elem)
+        {
+          return _elem->GetName() == _name;
+        }));
+  }
+
+  auto iter = this->dataPtr->elementCounts.find(_name);
+  return iter == this->dataPtr->elementCounts.end() ? 0u : iter->second;
+}
+
+/////////////////////////////////////////////////
+ElementPtr Element::GetElementImpl(const std::string &_name) const
+{
+  this->ReadLazyChildren();
+  return findIndexed(this->dataPtr->elements, this->dataPtr->elementIndex,
+      _name);
+}
+
+/////////////////////////////////////////////////
+const Element *Element::FindKey(std::string_view _key,
+    const Param *&_attribute) const
+{
+  _attribute = nullptr;
+  if (const ParamPtr *attribute = findEntry(this->dataPtr->attributes,
+          this->dataPtr->attributeIndex, _key))
+  {
+    _attribute = attribute->get();
+    return nullptr;
+  }
+
+  this->ReadLazyChildren();
+  if (const ElementPtr *child = findEntry(this->dataPtr->elements,
+          this->dataPtr->elementIndex, _key))
+  {
+    return child->get();
+  }
+
+  const ElementDescriptionData &data = childDescriptions(*this->dataPtr);
+  if (const ElementPtr *desc = findEntry(data.elementDescriptions,
+          data.elementDescriptionIndex, _key))
+  {
+    return desc->get();
+  }
+  return nullptr;
+}
+
+/////////////////////////////////////////////////
+ElementPtr Element::GetFirstElement() const
+{
+  this->ReadLazyChildren();
+  if (this->dataPtr->elements.empty())
+  {
+    return ElementPtr();
   }
   else
   {
-    elem = this->GetElementImpl(_type);
+    return this->dataPtr->elements.front();
+  }
+}
+
+/////////////////////////////////////////////////
+ElementPtr Element::GetNextElement(const std::string &_name) const
+{
+  auto parent = this->dataPtr->parent.lock();
+  if (!parent)
+  {
+    return ElementPtr();
+  }
+
+  const ElementPtr_V &siblings = parent->dataPtr->elements;
+  std::size_t index = this->dataPtr->indexInParent;
+
+  // The stored position can be stale if this element was inserted into a
+  // different element than its parent, so fall back to a search.
+  if (index >= siblings.size() || siblings[index].get() != this)
+  {
+    auto iter = std::find(siblings.begin(), siblings.end(),
+        shared_from_this());
+    if (iter == siblings.end())
+    {
+      return ElementPtr();
+    }
+    index = static_cast<std::size_t>(iter - siblings.begin());
+  }
+
+  for (++index; index < siblings.size(); ++index)
+  {
+    if (_name.empty() || siblings[index]->GetName() == _name)
+    {
+      return siblings[index];
+    }
+  }
+
+  return ElementPtr();
+}
+
+/////////////////////////////////////////////////
+ElementChildren Element::Children(const std::string &_name) const
+{
+  this->ReadLazyChildren();
+  const ElementPtr_V &elements = this->dataPtr->elements;
+  const ElementPtr *end = elements.data() + elements.size();
+  if (_name.empty())
+    return ElementChildren(elements.data(), end, nullptr);
+
+  const ElementPtr *first = findEntry(elements, this->dataPtr->elementIndex,
+      _name);
+  if (!first)
+    return ElementChildren(end, end, nullptr);
+
+  // The interned name of the first child is kept, rather than _name, so
+  // that the range stays valid after a temporary _name is destroyed.
+  return ElementChildren(first, end, &(*first)->GetName());
+}
+
+/////////////////////////////////////////////////
+const Element *Element::FindElement(const std::string &_name) const
+{
+  this->ReadLazyChildren();
+  const ElementPtr *child = findEntry(this->dataPtr->elements,
+      this->dataPtr->elementIndex, _name);
+  return child ? child->get() : nullptr;
+}
+
+/////////////////////////////////////////////////
+std::set<std::string> Element::GetElementTypeNames() const
+{
+  std::set<std::string> result;
+  for (const Element &elem : this->Children())
+    result.insert(elem.GetName());
+  return result;
+}
+
+/////////////////////////////////////////////////
+bool Element::HasUniqueChildNames(const std::string &_type) const
+{
+  this->ReadLazyChildren();
+  ElementPrivate &data = *this->dataPtr;
+
+  // Names that are unique among all children are unique among the
+  // children of each type as well.
+  const std::uint8_t known = data.childNames.load(std::memory_order_relaxed);
+  if (known == ElementPrivate::kNamesUnique ||
+      (known == ElementPrivate::kNamesDuplicate && _type.empty()))
+  {
+    return known == ElementPrivate::kNamesUnique;
   }
 
-  while (elem)
+  // The set is reused between checks, and only refers to the names of the
+  // children while a check runs.
+  static thread_local std::unordered_set<std::string_view> names;
+  static thread_local std::vector<std::string> converted;
+  names.clear();
+  converted.clear();
+
+  bool unique = true;
+  if (data.elements.size() > 1)
   {
-    if (elem->HasAttribute("name"))
+    for (const ElementPtr &elem : data.elements)
     {
-      // Get("name") returns attribute value if it exists before checking
-      // for the value of a child element <name>, so it's safe to use
-      // here since we've checked HasAttribute("name").
-      std::string childNameAttributeValue = elem->Get<std::string>("name");
-      if (result.find(childNameAttributeValue) == result.end())
+      if (!_type.empty() && elem->GetName() != _type)
+        continue;
+
+      const Param *nameParam = elem->FindAttribute("name");
+      if (!nameParam)
+        continue;
+
+      const std::string *name =
+          std::get_if<std::string>(&nameParam->dataPtr->value);
+      if (!name)
       {
-        result[childNameAttributeValue] = 1;
+        converted.reserve(data.elements.size());
+        converted.push_back(nameParam->GetAsString());
+        name = &converted.back();
       }
-      else
+
+      if (!names.insert(*name).second)
       {
-        ++result[childNameAttributeValue];
+        unique = false;
+        break;
       }
     }
+  }
+  names.clear();
 
-    elem = elem->GetNextElement(_type);
+  if (_type.empty())
+  {
+    data.childNames.store(unique ? ElementPrivate::kNamesUnique :
+        ElementPrivate::kNamesDuplicate, std::memory_order_relaxed);
+  }
+  return unique;
+}
+
+/////////////////////////////////////////////////
+std::map<std::string, std::size_t>
+Element::CountNamedElements(const std::string &_type) const
+{
+  std::map<std::string, std::size_t> result;
+
+  for (const Element &elem : this->Children(_type))
+  {
+    if (const Param *name = elem.FindAttribute("name"))
+      ++result[name->GetAsString()];
   }
 
   return result;
@@ -763,10 +1860,55 @@ ElementPtr Element::GetElement(const std::string &_name)
   return result;
 }
 
+/////////////////////////////////////////////////
+ElementConstPtr Element::GetElementOrDefault(const std::string &_name) const
+{
+  if (ElementPtr result = this->GetElementImpl(_name))
+    return result;
+
+  const ElementDescriptionData &data = childDescriptions(*this->dataPtr);
+  if (const ElementPtr *desc = findEntry(data.elementDescriptions,
+          data.elementDescriptionIndex, _name))
+  {
+    return *desc;
+  }
+  return nullptr;
+}
+
 /////////////////////////////////////////////////
 void Element::InsertElement(ElementPtr _elem)
 {
+  this->ReadLazyChildren();
+  _elem->dataPtr->indexInParent = this->dataPtr->elements.size();
+  if (_elem->dataPtr->dirty)
+    this->MarkDirty();
   this->dataPtr->elements.push_back(_elem);
+  elementAppended(*this->dataPtr);
+  this->InvalidateContentHash();
+  ElementTagIndex::Inserted(*this, *_elem);
+}
+
+/////////////////////////////////////////////////
+void Element::InsertElement(ElementPtr _elem, std::size_t _index)
+{
+  this->ReadLazyChildren();
+  ElementPtr_V &elements = this->dataPtr->elements;
+  if (_index >= elements.size())
+  {
+    this->InsertElement(std::move(_elem));
+    return;
+  }
+
+  if (_elem->dataPtr->dirty)
+    this->MarkDirty();
+  Element &inserted = *_elem;
+  elements.insert(elements.begin() + static_cast<std::ptrdiff_t>(_index),
+      std::move(_elem));
+  for (std::size_t i = _index; i < elements.size(); ++i)
+    elements[i]->dataPtr->indexInParent = i;
+  rebuildElementIndex(*this->dataPtr);
+  this->InvalidateContentHash();
+  ElementTagIndex::Inserted(*this, inserted);
 }
 
 /////////////////////////////////////////////////
@@ -782,39 +1924,36 @@ ElementPtr Element::AddElement(const std::string &_name)
   // descriptions then get them from its parent
   auto parent = this->dataPtr->parent.lock();
   if (!this->dataPtr->referenceSDF.empty() &&
-      this->dataPtr->elementDescriptions.empty() && parent &&
-      parent->GetName() == this->dataPtr->name)
+      childDescriptions(*this->dataPtr).elementDescriptions.empty() &&
+      parent && parent->dataPtr->name == this->dataPtr->name)
   {
-    for (unsigned int i = 0; i < parent->GetElementDescriptionCount(); ++i)
-    {
-      this->dataPtr->elementDescriptions.push_back(
-          parent->GetElementDescription(i)->Clone());
-    }
+    ElementDescriptionData &data = mutableDescriptionData(*this->dataPtr);
+    const ElementDescriptionData &parentData =
+        childDescriptions(*parent->dataPtr);
+    data.elementDescriptions = parentData.elementDescriptions;
+    data.elementDescriptionIndex = parentData.elementDescriptionIndex;
+    data.lazyDescriptions.reset();
   }
 
-  ElementPtr_V::const_iterator iter, iter2;
-  for (iter = this->dataPtr->elementDescriptions.begin();
-      iter != this->dataPtr->elementDescriptions.end(); ++iter)
+  ElementPtr desc = this->GetElementDescription(_name);
+  if (desc)
   {
-    if ((*iter)->dataPtr->name == _name)
-    {
-      ElementPtr elem = (*iter)->Clone();
-      elem->SetParent(shared_from_this());
-      this->dataPtr->elements.push_back(elem);
+    ElementPtr elem = desc->Instantiate();
+    elem->SetParent(shared_from_this());
+    this->InsertElement(elem);
 
-      // Add all child elements.
-      for (iter2 = elem->dataPtr->elementDescriptions.begin();
-           iter2 != elem->dataPtr->elementDescriptions.end(); ++iter2)
+    // Add all child elements.
+    for (const ElementPtr &childDesc :
+         childDescriptions(*elem->dataPtr).elementDescriptions)
+    {
+      // Add only required child element
+      if (childDesc->GetRequired() == "1")
       {
-        // Add only required child element
-        if ((*iter2)->GetRequired() == "1")
-        {
-          elem->AddElement((*iter2)->dataPtr->name);
-        }
+        elem->AddElement(*childDesc->dataPtr->name);
       }
-
-      return this->dataPtr->elements.back();
     }
+
+    return elem;
   }
 
   sdferr << "Missing element description for [" << _name << "]\n";
@@ -827,6 +1966,30 @@ void Element::Clear()
   this->ClearElements();
   this->dataPtr->originalVersion.clear();
   this->dataPtr->path.clear();
+  this->dataPtr->sourceRange = TextRange();
+}
+
+/////////////////////////////////////////////////
+void Element::SetEditedChildren(ElementPtr_V &_elements,
+    const std::vector<Element *> &_inserted)
+{
+  ElementPtr_V &elements = this->dataPtr->elements;
+  elements.swap(_elements);
+  for (std::size_t i = 0; i < elements.size(); ++i)
+    elements[i]->dataPtr->indexInParent = i;
+  rebuildElementIndex(*this->dataPtr);
+
+  for (Element *inserted : _inserted)
+  {
+    if (inserted->dataPtr->dirty)
+    {
+      this->MarkDirty();
+      break;
+    }
+  }
+  this->InvalidateContentHash();
+  for (Element *inserted : _inserted)
+    ElementTagIndex::Inserted(*this, *inserted);
 }
 
 /////////////////////////////////////////////////
@@ -839,11 +2002,15 @@ void Element::ClearElements()
   }
 
   this->dataPtr->elements.clear();
+  clearElementIndex(*this->dataPtr);
+  this->dataPtr->lazyChildren.reset();
+  this->InvalidateContentHash();
 }
 
 /////////////////////////////////////////////////
 void Element::Update()
 {
+  this->ReadLazyChildren();
   for (sdf::Param_V::iterator iter = this->dataPtr->attributes.begin();
       iter != this->dataPtr->attributes.end(); ++iter)
   {
@@ -875,33 +2042,43 @@ void Element::Reset()
     (*iter).reset();
   }
 
-  for (ElementPtr_V::iterator iter = this->dataPtr->elementDescriptions.begin();
-      iter != this->dataPtr->elementDescriptions.end(); ++iter)
-  {
-    if (*iter)
-    {
-      (*iter)->Reset();
-    }
-    (*iter).reset();
-  }
+  // Descriptions may be shared with other elements, so they are released
+  // instead of being reset.
   this->dataPtr->elements.clear();
-  this->dataPtr->elementDescriptions.clear();
+  this->dataPtr->descriptionData = emptyDescriptionData();
+  clearElementIndex(*this->dataPtr);
+  this->dataPtr->lazyChildren.reset();
 
   this->dataPtr->value.reset();
+  this->InvalidateContentHash();
 
   this->dataPtr->parent.reset();
 }
 
+/////////////////////////////////////////////////
+void Element::ReadLazyChildren() const
+{
+  if (this->dataPtr->lazyChildren)
+  {
+    LazyChildren::Read(
+        std::const_pointer_cast<Element>(this->shared_from_this()));
+  }
+}
+
 /////////////////////////////////////////////////
 void Element::AddElementDescription(ElementPtr _elem)
 {
-  this->dataPtr->elementDescriptions.push_back(_elem);
+  ElementDescriptionData &data = mutableDescriptionData(*this->dataPtr);
+  ownChildDescriptions(data);
+  data.elementDescriptions.push_back(_elem);
+  indexAppended(data.elementDescriptions, data.elementDescriptionIndex);
 }
 
 /////////////////////////////////////////////////
 void Element::SetInclude(const std::string &_filename)
 {
   this->dataPtr->includeFilename = _filename;
+  this->InvalidateContentHash();
 }
 
 /////////////////////////////////////////////////
@@ -934,16 +2111,28 @@ const std::string &Element::OriginalVersion() const
   return this->dataPtr->originalVersion;
 }
 
+/////////////////////////////////////////////////
+void Element::SetSourceRange(const TextRange &_range)
+{
+  this->dataPtr->sourceRange = _range;
+}
+
+/////////////////////////////////////////////////
+const TextRange &Element::SourceRange() const
+{
+  return this->dataPtr->sourceRange;
+}
+
 /////////////////////////////////////////////////
 std::string Element::GetDescription() const
 {
-  return this->dataPtr->description;
+  return this->dataPtr->descriptionData->description;
 }
 
 /////////////////////////////////////////////////
 void Element::SetDescription(const std::string &_desc)
 {
-  this->dataPtr->description = _desc;
+  mutableDescriptionData(*this->dataPtr).description = _desc;
 }
 
 /////////////////////////////////////////////////
@@ -958,7 +2147,14 @@ void Element::RemoveFromParent()
 
     if (iter != parent->dataPtr->elements.end())
     {
-      parent->dataPtr->elements.erase(iter);
+      iter = parent->dataPtr->elements.erase(iter);
+      for (; iter != parent->dataPtr->elements.end(); ++iter)
+      {
+        (*iter)->dataPtr->indexInParent =
+            static_cast<std::size_t>(iter - parent->dataPtr->elements.begin());
+      }
+      rebuildElementIndex(*parent->dataPtr);
+      parent->InvalidateContentHash();
       parent.reset();
     }
   }
@@ -976,7 +2172,14 @@ void Element::RemoveChild(ElementPtr _child)
   if (iter != this->dataPtr->elements.end())
   {
     _child->SetParent(ElementPtr());
-    this->dataPtr->elements.erase(iter);
+    iter = this->dataPtr->elements.erase(iter);
+    for (; iter != this->dataPtr->elements.end(); ++iter)
+    {
+      (*iter)->dataPtr->indexInParent =
+          static_cast<std::size_t>(iter - this->dataPtr->elements.begin());
+    }
+    rebuildElementIndex(*this->dataPtr);
+    this->InvalidateContentHash();
   }
 }
 
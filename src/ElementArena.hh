@@ -0,0 +1,297 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_ELEMENT_ARENA_HH_
+#define SDF_ELEMENT_ARENA_HH_
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+#include "sdf/ParserConfig.hh"
+#include "sdf/sdf_config.h"
+
+/// \ingroup sdf_parser
+/// \brief namespace for Simulation Description Format parser
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief Monotonic memory arena that holds the Element and Param
+  /// objects of a loaded document. Memory is only returned when the arena
+  /// is destroyed, which happens once the last object allocated from it is
+  /// released. Allocation is thread safe, so that sibling includes can be
+  /// read concurrently into the same arena.
+  class ElementArena : public std::pmr::memory_resource
+  {
+    /// \brief Constructor
+    /// \param[in] _upstream Resource that the blocks of the arena are taken
+    /// from, which must outlive the arena.
+    public: explicit ElementArena(std::pmr::memory_resource *_upstream =
+                                      std::pmr::new_delete_resource())
+      : upstream(_upstream)
+    {
+      this->resource.emplace(this->upstream);
+    }
+
+    /// \brief Destructor
+    public: ~ElementArena() override
+    {
+      this->resource.reset();
+      if (this->buffer)
+        this->upstream->deallocate(this->buffer, this->bufferSize);
+    }
+
+    /// \brief Copy constructor is deleted.
+    public: ElementArena(const ElementArena &) = delete;
+
+    /// \brief Copy assignment operator is deleted.
+    /// \return Reference to this.
+    public: ElementArena &operator=(const ElementArena &) = delete;
+
+    /// \brief Get the resource that the blocks of the arena are taken from.
+    /// \return The upstream resource.
+    public: std::pmr::memory_resource *Upstream() const
+    {
+      return this->upstream;
+    }
+
+    /// \brief Release the memory of every object allocated so far, and
+    /// keep one block as large as all of it for the objects allocated
+    /// next, so that an arena reused for documents of similar sizes stops
+    /// taking memory from the heap. Only call it once every object
+    /// allocated from the arena is destroyed.
+    public: void Reset()
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      this->resource.reset();
+      if (this->allocated > this->bufferSize)
+      {
+        if (this->buffer)
+          this->upstream->deallocate(this->buffer, this->bufferSize);
+        this->buffer = this->upstream->allocate(this->allocated);
+        this->bufferSize = this->allocated;
+      }
+      if (this->buffer)
+      {
+        this->resource.emplace(this->buffer, this->bufferSize,
+                               this->upstream);
+      }
+      else
+      {
+        this->resource.emplace(this->upstream);
+      }
+      this->allocated = 0;
+    }
+
+    /// \brief Allocate memory from the arena.
+    /// \param[in] _bytes Number of bytes.
+    /// \param[in] _alignment Alignment of the memory.
+    /// \return Pointer to the memory.
+    private: void *do_allocate(std::size_t _bytes,
+                               std::size_t _alignment) override
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      this->allocated += _bytes + _alignment;
+      return this->resource->allocate(_bytes, _alignment);
+    }
+
+    /// \brief Memory is released all at once by the destructor.
+    private: void do_deallocate(void *, std::size_t, std::size_t) override
+    {
+    }
+
+    /// \brief Arenas are only equal to themselves.
+    /// \param[in] _other Resource to compare to.
+    /// \return True if _other is this arena.
+    private: bool do_is_equal(
+        const std::pmr::memory_resource &_other) const noexcept override
+    {
+      return this == &_other;
+    }
+
+    /// \brief Protects the resource.
+    private: std::mutex mutex;
+
+    /// \brief Resource that buffer and the blocks of resource come from.
+    private: std::pmr::memory_resource *upstream;
+
+    /// \brief Block kept by Reset, which the resource uses first.
+    private: void *buffer = nullptr;
+
+    /// \brief Size of buffer in bytes.
+    private: std::size_t bufferSize = 0;
+
+    /// \brief Number of bytes allocated since the last reset, including
+    /// the padding for their alignment.
+    private: std::size_t allocated = 0;
+
+    /// \brief Underlying storage, which grows in geometrically sized
+    /// blocks taken from upstream once buffer is used up.
+    private: std::optional<std::pmr::monotonic_buffer_resource> resource;
+  };
+
+  /// \brief Create an arena whose memory, including that of the arena
+  /// itself and of its control block, comes from a resource.
+  /// \param[in] _upstream Resource to allocate from, or nullptr for the
+  /// heap.
+  /// \return The arena.
+  inline std::shared_ptr<ElementArena> makeElementArena(
+      std::pmr::memory_resource *_upstream)
+  {
+    if (!_upstream)
+      return std::make_shared<ElementArena>();
+    return std::allocate_shared<ElementArena>(
+        std::pmr::polymorphic_allocator<ElementArena>(_upstream), _upstream);
+  }
+
+  /// \brief Standard allocator that takes memory from an ElementArena and
+  /// keeps the arena alive for as long as any copy of it exists. It is
+  /// used with std::allocate_shared, so that the control block of every
+  /// object shares ownership of the arena.
+  template <typename T>
+  class ElementArenaAllocator
+  {
+    /// \brief Allocated type.
+    public: using value_type = T;
+
+    /// \brief Constructor
+    /// \param[in] _arena Arena to allocate from.
+    public: explicit ElementArenaAllocator(std::shared_ptr<ElementArena> _arena)
+      : arena(std::move(_arena))
+    {
+    }
+
+    /// \brief Rebinding constructor
+    /// \param[in] _other Allocator of another type.
+    public: template <typename U>
+    ElementArenaAllocator(const ElementArenaAllocator<U> &_other)
+      : arena(_other.arena)
+    {
+    }
+
+    /// \brief Allocate memory for objects.
+    /// \param[in] _count Number of objects.
+    /// \return Pointer to the memory.
+    public: T *allocate(std::size_t _count)
+    {
+      return static_cast<T *>(
+          this->arena->allocate(_count * sizeof(T), alignof(T)));
+    }
+
+    /// \brief Release memory, which is a no-op for the arena.
+    /// \param[in] _ptr Memory to release.
+    /// \param[in] _count Number of objects.
+    public: void deallocate(T *_ptr, std::size_t _count)
+    {
+      this->arena->deallocate(_ptr, _count * sizeof(T), alignof(T));
+    }
+
+    /// \brief Equality operator.
+    /// \param[in] _other Allocator to compare to.
+    /// \return True if both allocators use the same arena.
+    public: template <typename U>
+    bool operator==(const ElementArenaAllocator<U> &_other) const
+    {
+      return this->arena == _other.arena;
+    }
+
+    /// \brief Inequality operator.
+    /// \param[in] _other Allocator to compare to.
+    /// \return True if the allocators use different arenas.
+    public: template <typename U>
+    bool operator!=(const ElementArenaAllocator<U> &_other) const
+    {
+      return !(*this == _other);
+    }
+
+    /// \brief Arena to allocate from.
+    private: std::shared_ptr<ElementArena> arena;
+
+    template <typename U> friend class ElementArenaAllocator;
+  };
+
+  /// \brief Makes an ElementArena the source of the Element and Param
+  /// objects created on the current thread while this scope is alive.
+  /// The previous arena is restored when the scope is destroyed, so
+  /// scopes can nest.
+  class ElementArenaScope
+  {
+    /// \brief Constructor
+    /// \param[in] _arena Arena to allocate from, or nullptr to allocate
+    /// from the heap in this scope.
+    public: explicit ElementArenaScope(std::shared_ptr<ElementArena> _arena)
+      : previous(std::exchange(Current(), std::move(_arena)))
+    {
+    }
+
+    /// \brief Constructor that creates a new arena if the ParserConfig
+    /// enables element arenas or has a memory resource, and no arena is
+    /// current yet. Otherwise the current arena is kept, so that nested
+    /// reads of included files share the arena of the outer document.
+    /// \param[in] _config Parser configuration.
+    public: explicit ElementArenaScope(const ParserConfig &_config)
+      : previous(Current())
+    {
+      if ((_config.UseElementArena() || _config.MemoryResource()) &&
+          !Current())
+      {
+        Current() = makeElementArena(_config.MemoryResource());
+      }
+    }
+
+    /// \brief Destructor
+    public: ~ElementArenaScope()
+    {
+      Current() = std::move(this->previous);
+    }
+
+    /// \brief Get the arena of the current thread.
+    /// \return Reference to the current arena, which is nullptr when
+    /// objects are allocated from the heap.
+    public: static std::shared_ptr<ElementArena> &Current()
+    {
+      static thread_local std::shared_ptr<ElementArena> current;
+      return current;
+    }
+
+    /// \brief Arena that was current before this scope.
+    private: std::shared_ptr<ElementArena> previous;
+  };
+
+  /// \brief Create a shared object from the current ElementArena, or from
+  /// the heap when no arena is current.
+  /// \param[in] _args Constructor arguments.
+  /// \return The new object.
+  template <typename T, typename... Args>
+  std::shared_ptr<T> makeArenaShared(Args &&... _args)
+  {
+    const std::shared_ptr<ElementArena> &arena = ElementArenaScope::Current();
+    if (arena)
+    {
+      return std::allocate_shared<T>(ElementArenaAllocator<T>(arena),
+                                     std::forward<Args>(_args)...);
+    }
+    return std::make_shared<T>(std::forward<Args>(_args)...);
+  }
+  }
+}
+#endif
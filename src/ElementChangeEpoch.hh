@@ -0,0 +1,74 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_ELEMENT_CHANGE_EPOCH_HH_
+#define SDF_ELEMENT_CHANGE_EPOCH_HH_
+
+#include <atomic>
+#include <cstdint>
+
+#include "sdf/sdf_config.h"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief Process-wide epoch that tells ElementSnapshot which elements
+  /// changed since a snapshot was taken.
+  ///
+  /// Elements are stamped with the current epoch when they are created, and
+  /// a change of an element stamps it and its ancestors. Taking a snapshot
+  /// advances the epoch, so an element whose stamp is older than the epoch
+  /// a snapshot left behind has not changed since the snapshot, nor has any
+  /// of its descendants. The epoch stays zero until the first snapshot is
+  /// taken, so that elements pay a relaxed load per change until then.
+  class ElementChangeEpoch
+  {
+    /// \brief Get the current epoch.
+    /// \return The current epoch, or zero if no snapshot was taken yet.
+    public: static std::uint64_t Current()
+    {
+      return Epoch().load(std::memory_order_relaxed);
+    }
+
+    /// \brief Start stamping the elements, before the first snapshot.
+    public: static void Start()
+    {
+      std::uint64_t expected = 0u;
+      Epoch().compare_exchange_strong(expected, 1u,
+          std::memory_order_relaxed);
+    }
+
+    /// \brief Advance the epoch, once a snapshot is taken.
+    /// \return The new epoch, which the changes after the snapshot are
+    /// stamped with.
+    public: static std::uint64_t Advance()
+    {
+      return Epoch().fetch_add(1u, std::memory_order_relaxed) + 1u;
+    }
+
+    /// \brief The current epoch.
+    private: static std::atomic<std::uint64_t> &Epoch()
+    {
+      static std::atomic<std::uint64_t> epoch{0u};
+      return epoch;
+    }
+  };
+  }
+}
+#endif
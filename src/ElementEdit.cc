@@ -0,0 +1,298 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "sdf/Element.hh"
+#include "sdf/ElementEdit.hh"
+
+using namespace sdf;
+
+class sdf::ElementEditPrivate
+{
+  /// \brief Kind of a queued change.
+  public: enum class ChangeType : std::uint8_t
+  {
+    INSERT,
+    REMOVE,
+    MOVE,
+    REPLACE,
+  };
+
+  /// \brief A queued change.
+  public: struct Change
+  {
+    /// \brief Kind of the change.
+    ChangeType type;
+
+    /// \brief The inserted element, or the removed, moved or replaced
+    /// child.
+    ElementPtr elem;
+
+    /// \brief The element that replaces elem.
+    ElementPtr replacement;
+
+    /// \brief Position of the child to insert or move elem before.
+    std::size_t index;
+  };
+
+  /// \brief An element of the new children, before the old child it is
+  /// inserted before.
+  public: struct Insertion
+  {
+    /// \brief Position of the old child, or the number of old children to
+    /// insert after all of them.
+    std::size_t anchor;
+
+    /// \brief The element.
+    ElementPtr elem;
+
+    /// \brief True if the element was not a child before.
+    bool inserted;
+  };
+
+  /// \brief Value of a position that is not found.
+  public: static constexpr std::size_t kNotFound =
+              std::numeric_limits<std::size_t>::max();
+
+  /// \brief Find the position of a child.
+  /// \param[in] _elements Children of the edited element.
+  /// \param[in] _child The element to look for.
+  /// \return Position of _child, or kNotFound if it is not a child.
+  public: static std::size_t Position(const ElementPtr_V &_elements,
+      const Element &_child)
+  {
+    // The stored position is stale if the element was inserted into
+    // another element than its parent, like in GetNextElement.
+    const std::size_t index = _child.dataPtr->indexInParent;
+    if (index < _elements.size() && _elements[index].get() == &_child)
+      return index;
+
+    auto iter = std::find_if(_elements.begin(), _elements.end(),
+        [&_child](const ElementPtr &_elem)
+        {
+          return _elem.get() == &_child;
+        });
+    if (iter == _elements.end())
+      return kNotFound;
+    return static_cast<std::size_t>(iter - _elements.begin());
+  }
+
+  /// \brief Apply the changes.
+  /// \param[in,out] _errors Errors of the changes that are skipped.
+  public: void Commit(Errors &_errors)
+  {
+    this->elem->ReadLazyChildren();
+    const ElementPtr_V &elements = this->elem->dataPtr->elements;
+    const std::size_t count = elements.size();
+
+    std::vector<bool> removed(count, false);
+    std::vector<Insertion> insertions;
+    std::unordered_set<const Element *> added;
+
+    auto missing = [&_errors](std::size_t _change, const std::string &_what)
+    {
+      _errors.push_back({ErrorCode::ELEMENT_MISSING,
+          "Element edit change [" + std::to_string(_change) + "] refers to " +
+          _what + "."});
+    };
+
+    // Inserted elements must not be children, unless they are removed by
+    // an earlier change, nor be inserted by another change.
+    auto insert = [&](std::size_t _change, std::size_t _anchor,
+        const ElementPtr &_child, bool _moved)
+    {
+      const std::size_t position =
+          _moved ? kNotFound : Position(elements, *_child);
+      if (position != kNotFound && !removed[position])
+      {
+        _errors.push_back({ErrorCode::ELEMENT_INVALID,
+            "Element edit change [" + std::to_string(_change) +
+            "] inserts the element [" + _child->GetName() +
+            "] that is already a child of [" + this->elem->GetName() +
+            "]. Move it instead."});
+        return;
+      }
+      if (!added.insert(_child.get()).second)
+      {
+        _errors.push_back({ErrorCode::ELEMENT_INVALID,
+            "Element edit change [" + std::to_string(_change) +
+            "] inserts the element [" + _child->GetName() +
+            "] that is inserted by another change."});
+        return;
+      }
+      insertions.push_back({std::min(_anchor, count), _child,
+          position == kNotFound && !_moved});
+    };
+
+    for (std::size_t i = 0; i < this->changes.size(); ++i)
+    {
+      const Change &change = this->changes[i];
+      if (!change.elem ||
+          (change.type == ChangeType::REPLACE && !change.replacement))
+      {
+        missing(i, "a null element");
+        continue;
+      }
+
+      if (change.type == ChangeType::INSERT)
+      {
+        insert(i, change.index, change.elem, false);
+        continue;
+      }
+
+      const std::size_t position = Position(elements, *change.elem);
+      if (position == kNotFound || removed[position])
+      {
+        missing(i, "the element [" + change.elem->GetName() +
+            "] that is not a child of [" + this->elem->GetName() + "]");
+        continue;
+      }
+      removed[position] = true;
+
+      if (change.type == ChangeType::MOVE)
+        insert(i, change.index, change.elem, true);
+      else if (change.type == ChangeType::REPLACE)
+        insert(i, position, change.replacement, false);
+    }
+    this->changes.clear();
+
+    // Elements inserted at the same position keep their order.
+    std::stable_sort(insertions.begin(), insertions.end(),
+        [](const Insertion &_a, const Insertion &_b)
+        {
+          return _a.anchor < _b.anchor;
+        });
+
+    ElementPtr_V result;
+    result.reserve(count + insertions.size());
+    std::vector<Element *> inserted;
+    auto next = insertions.begin();
+    for (std::size_t i = 0; i <= count; ++i)
+    {
+      for (; next != insertions.end() && next->anchor == i; ++next)
+      {
+        if (next->inserted)
+          inserted.push_back(next->elem.get());
+        result.push_back(next->elem);
+      }
+      if (i < count && !removed[i])
+        result.push_back(elements[i]);
+    }
+
+    // Moved children are removed and inserted again, and keep their
+    // parent.
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      if (removed[i] && added.count(elements[i].get()) == 0)
+        elements[i]->SetParent(ElementPtr());
+    }
+    for (Element *child : inserted)
+      child->SetParent(this->elem);
+
+    this->elem->SetEditedChildren(result, inserted);
+  }
+
+  /// \brief The edited element.
+  public: ElementPtr elem;
+
+  /// \brief The queued changes, in order.
+  public: std::vector<Change> changes;
+};
+
+/////////////////////////////////////////////////
+ElementEdit::ElementEdit(ElementPtr _elem)
+  : dataPtr(new ElementEditPrivate)
+{
+  this->dataPtr->elem = std::move(_elem);
+}
+
+/////////////////////////////////////////////////
+ElementEdit::~ElementEdit()
+{
+  delete this->dataPtr;
+  this->dataPtr = nullptr;
+}
+
+/////////////////////////////////////////////////
+void ElementEdit::Insert(ElementPtr _child)
+{
+  this->Insert(std::move(_child), ElementEditPrivate::kNotFound);
+}
+
+/////////////////////////////////////////////////
+void ElementEdit::Insert(ElementPtr _child, std::size_t _index)
+{
+  this->dataPtr->changes.push_back({ElementEditPrivate::ChangeType::INSERT,
+      std::move(_child), ElementPtr(), _index});
+}
+
+/////////////////////////////////////////////////
+void ElementEdit::Remove(ElementPtr _child)
+{
+  this->dataPtr->changes.push_back({ElementEditPrivate::ChangeType::REMOVE,
+      std::move(_child), ElementPtr(), 0});
+}
+
+/////////////////////////////////////////////////
+void ElementEdit::Move(ElementPtr _child, std::size_t _index)
+{
+  this->dataPtr->changes.push_back({ElementEditPrivate::ChangeType::MOVE,
+      std::move(_child), ElementPtr(), _index});
+}
+
+/////////////////////////////////////////////////
+void ElementEdit::Replace(ElementPtr _child, ElementPtr _replacement)
+{
+  this->dataPtr->changes.push_back({ElementEditPrivate::ChangeType::REPLACE,
+      std::move(_child), std::move(_replacement), 0});
+}
+
+/////////////////////////////////////////////////
+std::size_t ElementEdit::ChangeCount() const
+{
+  return this->dataPtr->changes.size();
+}
+
+/////////////////////////////////////////////////
+Errors ElementEdit::Commit()
+{
+  Errors errors;
+  if (!this->dataPtr->elem)
+  {
+    this->dataPtr->changes.clear();
+    errors.push_back({ErrorCode::ELEMENT_MISSING,
+        "Unable to edit a null element."});
+    return errors;
+  }
+
+  if (!this->dataPtr->changes.empty())
+    this->dataPtr->Commit(errors);
+  return errors;
+}
+
+/////////////////////////////////////////////////
+void ElementEdit::Discard()
+{
+  this->dataPtr->changes.clear();
+}
@@ -0,0 +1,191 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "sdf/Element.hh"
+#include "sdf/ElementEdit.hh"
+
+/////////////////////////////////////////////////
+/// \brief Make an element with named children.
+/// \param[in] _count Number of children, named "c0", "c1" and so on.
+/// \return The element.
+static sdf::ElementPtr makeParent(int _count)
+{
+  sdf::ElementPtr parent(new sdf::Element);
+  parent->SetName("parent");
+  for (int i = 0; i < _count; ++i)
+  {
+    sdf::ElementPtr child(new sdf::Element);
+    child->SetName("c" + std::to_string(i));
+    child->SetParent(parent);
+    parent->InsertElement(child);
+  }
+  return parent;
+}
+
+/////////////////////////////////////////////////
+/// \brief Get the names of the children of an element.
+/// \param[in] _elem The element.
+/// \return The names, separated by spaces.
+static std::string childNames(const sdf::ElementPtr &_elem)
+{
+  std::string names;
+  for (const sdf::Element &child : _elem->Children())
+    names += (names.empty() ? "" : " ") + child.GetName();
+  return names;
+}
+
+/////////////////////////////////////////////////
+TEST(ElementEdit, Empty)
+{
+  sdf::ElementPtr parent = makeParent(3);
+  sdf::ElementEdit edit(parent);
+  EXPECT_EQ(0u, edit.ChangeCount());
+  EXPECT_TRUE(edit.Commit().empty());
+  EXPECT_EQ("c0 c1 c2", childNames(parent));
+
+  sdf::ElementEdit nullEdit(nullptr);
+  nullEdit.Insert(parent);
+  sdf::Errors errors = nullEdit.Commit();
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::ELEMENT_MISSING, errors[0].Code());
+  EXPECT_EQ(0u, nullEdit.ChangeCount());
+}
+
+/////////////////////////////////////////////////
+TEST(ElementEdit, Changes)
+{
+  sdf::ElementPtr parent = makeParent(4);
+  sdf::ElementPtr c0 = parent->GetElementImpl("c0");
+  sdf::ElementPtr c1 = parent->GetElementImpl("c1");
+  sdf::ElementPtr c2 = parent->GetElementImpl("c2");
+  sdf::ElementPtr c3 = parent->GetElementImpl("c3");
+
+  sdf::ElementPtr a(new sdf::Element);
+  a->SetName("a");
+  sdf::ElementPtr b(new sdf::Element);
+  b->SetName("b");
+  sdf::ElementPtr r(new sdf::Element);
+  r->SetName("r");
+
+  sdf::ElementEdit edit(parent);
+  edit.Insert(a, 2);
+  edit.Insert(b);
+  edit.Remove(c0);
+  edit.Move(c3, 0);
+  edit.Replace(c1, r);
+  EXPECT_EQ(5u, edit.ChangeCount());
+
+  // Nothing changes until the edit is committed.
+  EXPECT_EQ("c0 c1 c2 c3", childNames(parent));
+  EXPECT_TRUE(edit.Commit().empty());
+  EXPECT_EQ(0u, edit.ChangeCount());
+
+  // Positions refer to the children before the edit.
+  EXPECT_EQ("c3 r a c2 b", childNames(parent));
+  EXPECT_EQ(nullptr, c0->GetParent());
+  EXPECT_EQ(nullptr, c1->GetParent());
+  EXPECT_EQ(parent, c3->GetParent());
+  EXPECT_EQ(parent, a->GetParent());
+  EXPECT_EQ(parent, b->GetParent());
+  EXPECT_EQ(parent, r->GetParent());
+
+  // Sibling walks and lookups by name see the new children.
+  EXPECT_EQ(r, c3->GetNextElement());
+  EXPECT_EQ(b, c2->GetNextElement());
+  EXPECT_EQ(nullptr, b->GetNextElement());
+  EXPECT_FALSE(parent->HasElement("c0"));
+  EXPECT_EQ(a, parent->GetElementImpl("a"));
+}
+
+/////////////////////////////////////////////////
+TEST(ElementEdit, InvalidChanges)
+{
+  sdf::ElementPtr parent = makeParent(2);
+  sdf::ElementPtr c0 = parent->GetElementImpl("c0");
+  sdf::ElementPtr c1 = parent->GetElementImpl("c1");
+  sdf::ElementPtr other(new sdf::Element);
+  other->SetName("other");
+
+  sdf::ElementEdit edit(parent);
+  edit.Insert(nullptr);
+  edit.Remove(other);
+  edit.Insert(c0);
+  edit.Insert(other);
+  edit.Insert(other, 0);
+  edit.Remove(c1);
+  edit.Remove(c1);
+  sdf::Errors errors = edit.Commit();
+  ASSERT_EQ(5u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::ELEMENT_MISSING, errors[0].Code());
+  EXPECT_EQ(sdf::ErrorCode::ELEMENT_MISSING, errors[1].Code());
+  EXPECT_EQ(sdf::ErrorCode::ELEMENT_INVALID, errors[2].Code());
+  EXPECT_EQ(sdf::ErrorCode::ELEMENT_INVALID, errors[3].Code());
+  EXPECT_EQ(sdf::ErrorCode::ELEMENT_MISSING, errors[4].Code());
+
+  // The valid changes are applied.
+  EXPECT_EQ("c0 other", childNames(parent));
+
+  // A removed child can be inserted again, which moves it.
+  edit.Remove(c0);
+  edit.Insert(c0);
+  EXPECT_TRUE(edit.Commit().empty());
+  EXPECT_EQ("other c0", childNames(parent));
+  EXPECT_EQ(parent, c0->GetParent());
+
+  edit.Remove(c0);
+  edit.Discard();
+  EXPECT_TRUE(edit.Commit().empty());
+  EXPECT_EQ("other c0", childNames(parent));
+}
+
+/////////////////////////////////////////////////
+TEST(ElementEdit, ManyChildren)
+{
+  // Enough children to use the name index of the element.
+  const int count = 1000;
+  sdf::ElementPtr parent = makeParent(count);
+  std::vector<sdf::ElementPtr> children;
+  for (const sdf::Element &child : parent->Children())
+    children.push_back(parent->GetElementImpl(child.GetName()));
+
+  // Remove the odd children and move the last one first.
+  sdf::ElementEdit edit(parent);
+  for (int i = 1; i < count; i += 2)
+    edit.Remove(children[i]);
+  edit.Move(children[count - 2], 0);
+  EXPECT_TRUE(edit.Commit().empty());
+
+  int remaining = 0;
+  for (const sdf::Element &child : parent->Children())
+  {
+    EXPECT_EQ(parent.get(), child.GetParent().get());
+    ++remaining;
+  }
+  EXPECT_EQ(count / 2, remaining);
+  EXPECT_EQ(children[count - 2], parent->GetFirstElement());
+  EXPECT_EQ(children[0], children[count - 2]->GetNextElement());
+  EXPECT_FALSE(parent->HasElement("c1"));
+  EXPECT_TRUE(parent->HasElement("c998"));
+  EXPECT_EQ(children[2], parent->GetElementImpl("c2"));
+  EXPECT_EQ(1u, parent->CountChildren("c2"));
+  EXPECT_EQ(0u, parent->CountChildren("c3"));
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_ELEMENT_FIELDS_HH_
+#define SDF_ELEMENT_FIELDS_HH_
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "sdf/Element.hh"
+#include "sdf/sdf_config.h"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief Table of the child elements that a DOM object loads into the
+  /// members of its private data.
+  ///
+  /// Load iterates the children of an element once, and writes each child
+  /// that has a field into its member. Members of children that are not
+  /// set keep their value, so the defaults stay in the private data class,
+  /// as with the usual HasElement and Get calls. Only the first child with
+  /// a given name is loaded, like GetElement does.
+  ///
+  /// Tables are meant to be built once, in a function-local static, and
+  /// shared by all loads:
+  ///
+  ///     static const ElementFields<LidarPrivate> fields =
+  ///       ElementFields<LidarPrivate>()
+  ///         .Value("min", &LidarPrivate::minRange)
+  ///         .Value("max", &LidarPrivate::maxRange);
+  ///     fields.Load(_sdf->GetElement("range"), *this->dataPtr);
+  template<typename T>
+  class ElementFields
+  {
+    /// \brief Function that loads a child element into an object.
+    public: using Loader = std::function<void(T &, const ElementPtr &)>;
+
+    /// \brief Add a child whose value is written to a member.
+    /// \param[in] _name Name of the child element.
+    /// \param[in] _member Member written to.
+    /// \tparam V Type the value is read as, the member type by default.
+    /// The member is constructed from it, such as a math::Angle from a
+    /// double.
+    /// \return This table.
+    public: template<typename V = void, typename M>
+            ElementFields &Value(const std::string &_name, M T::*_member)
+    {
+      using ValueType = std::conditional_t<std::is_void_v<V>, M, V>;
+      return this->Child(_name, [_member](T &_object,
+                                          const ElementPtr &_elem)
+      {
+        ParamPtr param = _elem->GetValue();
+        ValueType value;
+        if (param && param->Get<ValueType>(value))
+          _object.*_member = M(value);
+      });
+    }
+
+    /// \brief Add a child loaded by a function, such as a child with
+    /// children or attributes of its own.
+    /// \param[in] _name Name of the child element.
+    /// \param[in] _loader Function that loads the child.
+    /// \return This table.
+    public: ElementFields &Child(const std::string &_name, Loader _loader)
+    {
+      this->indices[_name] = this->loaders.size();
+      this->loaders.push_back(std::move(_loader));
+      return *this;
+    }
+
+    /// \brief Load the children of an element.
+    /// \param[in] _sdf Element whose children are loaded, may be null.
+    /// \param[in,out] _object Object the children are loaded into.
+    public: void Load(const ElementPtr &_sdf, T &_object) const
+    {
+      if (!_sdf)
+        return;
+
+      std::vector<bool> loaded(this->loaders.size(), false);
+      for (ElementPtr child = _sdf->GetFirstElement(); child;
+           child = child->GetNextElement())
+      {
+        auto iter = this->indices.find(child->GetName());
+        if (iter == this->indices.end() || loaded[iter->second])
+          continue;
+        loaded[iter->second] = true;
+        this->loaders[iter->second](_object, child);
+      }
+    }
+
+    /// \brief Index in loaders of each child name.
+    private: std::map<std::string, std::size_t> indices;
+
+    /// \brief Loader of each child.
+    private: std::vector<Loader> loaders;
+  };
+  }
+}
+#endif
@@ -0,0 +1,94 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <string>
+#include <ignition/math/Angle.hh>
+
+#include "sdf/Element.hh"
+#include "ElementFields.hh"
+
+/// \brief Object loaded by the tests.
+struct Fields
+{
+  int count{1};
+  double scale{2.0};
+  ignition::math::Angle angle{0.5};
+  std::string name{"default"};
+  int nestedCount{0};
+};
+
+/////////////////////////////////////////////////
+/// \brief Add a child element with a value.
+template<typename T>
+sdf::ElementPtr addChild(sdf::ElementPtr _parent, const std::string &_name,
+    const std::string &_type, const T &_value)
+{
+  sdf::ElementPtr child(new sdf::Element);
+  child->SetName(_name);
+  child->AddValue(_type, "0", false);
+  child->Set(_value);
+  _parent->InsertElement(child);
+  return child;
+}
+
+/////////////////////////////////////////////////
+TEST(ElementFields, Load)
+{
+  static const sdf::ElementFields<Fields> nestedFields =
+    sdf::ElementFields<Fields>()
+      .Value("count", &Fields::nestedCount);
+
+  static const sdf::ElementFields<Fields> fields =
+    sdf::ElementFields<Fields>()
+      .Value("count", &Fields::count)
+      .Value("scale", &Fields::scale)
+      .Value<double>("angle", &Fields::angle)
+      .Value("name", &Fields::name)
+      .Child("nested", [](Fields &_fields, const sdf::ElementPtr &_elem)
+        {
+          nestedFields.Load(_elem, _fields);
+        });
+
+  sdf::ElementPtr elem(new sdf::Element);
+  elem->SetName("fields");
+  addChild(elem, "count", "int", 3);
+  addChild(elem, "angle", "double", 1.5);
+  addChild(elem, "ignored", "double", 4.0);
+  // Only the first child with a name is loaded.
+  addChild(elem, "count", "int", 4);
+
+  sdf::ElementPtr nested(new sdf::Element);
+  nested->SetName("nested");
+  elem->InsertElement(nested);
+  addChild(nested, "count", "int", 7);
+
+  Fields loaded;
+  fields.Load(elem, loaded);
+  EXPECT_EQ(3, loaded.count);
+  EXPECT_DOUBLE_EQ(1.5, loaded.angle.Radian());
+  EXPECT_EQ(7, loaded.nestedCount);
+
+  // Members without a child keep their value.
+  EXPECT_DOUBLE_EQ(2.0, loaded.scale);
+  EXPECT_EQ("default", loaded.name);
+
+  // A null element loads nothing.
+  Fields empty;
+  fields.Load(sdf::ElementPtr(), empty);
+  EXPECT_EQ(1, empty.count);
+}
@@ -0,0 +1,413 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "sdf/Element.hh"
+#include "sdf/ElementPatch.hh"
+
+using namespace sdf;
+
+class sdf::ElementPatchPrivate
+{
+  /// \brief A pair of elements to diff, with the path to them.
+  public: struct Pending
+  {
+    /// \brief Element of the original tree.
+    const Element *from;
+
+    /// \brief Element of the modified tree.
+    const Element *to;
+
+    /// \brief Path to the elements in the patched tree.
+    std::vector<std::size_t> path;
+  };
+
+  /// \brief Get the children of an element, reading them first if they
+  /// were deferred.
+  /// \param[in] _elem The element.
+  /// \return The children of _elem.
+  public: static const ElementPtr_V &Children(const Element &_elem)
+  {
+    _elem.ReadLazyChildren();
+    return _elem.dataPtr->elements;
+  }
+
+  /// \brief Get the key children are matched by: their element name and
+  /// the value of their "name" attribute, if it is set.
+  /// \param[in] _elem The child element.
+  /// \return The key of _elem.
+  public: static std::string MatchKey(const Element &_elem)
+  {
+    std::string key = *_elem.dataPtr->name;
+    ParamPtr name = _elem.GetAttribute("name");
+    if (name && name->GetSet())
+    {
+      key += '\0';
+      key += name->GetAsString();
+    }
+    return key;
+  }
+
+  /// \brief Copy an element without its children.
+  /// \param[in] _elem The element to copy.
+  /// \return The copy.
+  public: static ElementPtr CopyOwnContent(const Element &_elem)
+  {
+    const ElementPrivate &data = *_elem.dataPtr;
+    ElementPtr copy = std::make_shared<Element>();
+    copy->SetName(*data.name);
+    copy->SetInclude(data.includeFilename);
+    for (const ParamPtr &attribute : data.attributes)
+      AddParam(*copy, *attribute, false);
+    if (data.value)
+      AddParam(*copy, *data.value, true);
+    return copy;
+  }
+
+  /// \brief Add an attribute or the value to an element, with the
+  /// description and value of another Param.
+  /// \param[in,out] _elem The element.
+  /// \param[in] _param The Param to copy.
+  /// \param[in] _isValue True to set the value instead of an attribute.
+  /// \return The Param of _elem.
+  public: static ParamPtr AddParam(Element &_elem, const Param &_param,
+      bool _isValue)
+  {
+    ParamPtr param;
+    if (_isValue)
+    {
+      _elem.AddValue(_param.GetTypeName(), _param.GetDefaultAsString(),
+          _param.GetRequired(), _param.GetDescription());
+      param = _elem.GetValue();
+    }
+    else
+    {
+      _elem.AddAttribute(_param.GetKey(), _param.GetTypeName(),
+          _param.GetDefaultAsString(), _param.GetRequired(),
+          _param.GetDescription());
+      param = _elem.GetAttribute(_param.GetKey());
+    }
+    *param = _param;
+    return param;
+  }
+
+  /// \brief Give an element the name, include file, attributes and value of
+  /// another one.
+  /// \param[in,out] _elem The element to modify.
+  /// \param[in] _source The element to copy the content of.
+  public: static void Modify(Element &_elem, const Element &_source)
+  {
+    const ElementPrivate &source = *_source.dataPtr;
+    _elem.SetName(*source.name);
+    _elem.SetInclude(source.includeFilename);
+
+    for (const ParamPtr &attribute : _elem.dataPtr->attributes)
+    {
+      if (!_source.GetAttribute(attribute->GetKey()))
+        attribute->Reset();
+    }
+    for (const ParamPtr &attribute : source.attributes)
+    {
+      ParamPtr target = _elem.GetAttribute(attribute->GetKey());
+      if (target)
+        *target = *attribute;
+      else
+        AddParam(_elem, *attribute, false);
+    }
+
+    if (source.value && _elem.dataPtr->value)
+    {
+      *_elem.dataPtr->value = *source.value;
+    }
+    else if (source.value)
+    {
+      AddParam(_elem, *source.value, true);
+    }
+    else if (_elem.dataPtr->value)
+    {
+      _elem.dataPtr->value.reset();
+      _elem.InvalidateContentHash();
+    }
+  }
+
+  /// \brief Diff two trees.
+  /// \param[in] _from The original tree.
+  /// \param[in] _to The modified tree.
+  public: void Diff(const Element &_from, const Element &_to)
+  {
+    // Pairs are diffed with an explicit stack, so that deep trees can be
+    // diffed on small thread stacks. The operations on the children of a
+    // pair are all added before any of its descendants are diffed, so the
+    // paths of the descendants are their final positions.
+    std::vector<Pending> stack;
+    stack.push_back({&_from, &_to, {}});
+    while (!stack.empty())
+    {
+      Pending pending = std::move(stack.back());
+      stack.pop_back();
+      if (pending.from->ContentHash() == pending.to->ContentHash())
+        continue;
+
+      if (!pending.from->SameOwnContent(*pending.to))
+      {
+        this->ops.push_back({ElementPatchOpType::MODIFY, pending.path,
+            CopyOwnContent(*pending.to)});
+      }
+
+      const ElementPtr_V &from = Children(*pending.from);
+      const ElementPtr_V &to = Children(*pending.to);
+
+      // Positions of the original children, by key.
+      std::unordered_map<std::string, std::vector<std::size_t>> positions;
+      for (std::size_t i = 0; i < from.size(); ++i)
+        positions[MatchKey(*from[i])].push_back(i);
+      std::unordered_map<std::string, std::size_t> cursors;
+
+      // Each modified child is matched with the next original child that
+      // has the same key. The original children skipped over are removed,
+      // and modified children without a match are added. _next is the
+      // first original child that is neither matched nor removed, and
+      // _position is its index in the tree as patched so far.
+      std::size_t next = 0;
+      std::size_t position = 0;
+      auto removeUntil = [&](std::size_t _end)
+      {
+        for (; next < _end; ++next)
+        {
+          std::vector<std::size_t> path = pending.path;
+          path.push_back(position);
+          this->ops.push_back({ElementPatchOpType::REMOVE, std::move(path),
+              ElementPtr()});
+        }
+      };
+
+      for (const ElementPtr &child : to)
+      {
+        std::size_t match = from.size();
+        auto found = positions.find(MatchKey(*child));
+        if (found != positions.end())
+        {
+          std::size_t &cursor = cursors[found->first];
+          while (cursor < found->second.size() &&
+                 found->second[cursor] < next)
+          {
+            ++cursor;
+          }
+          if (cursor < found->second.size())
+            match = found->second[cursor++];
+        }
+
+        std::vector<std::size_t> path = pending.path;
+        path.push_back(position);
+        if (match < from.size())
+        {
+          removeUntil(match);
+          stack.push_back({from[match].get(), child.get(), std::move(path)});
+          ++next;
+        }
+        else
+        {
+          this->ops.push_back({ElementPatchOpType::ADD, std::move(path),
+              child->Clone()});
+        }
+        ++position;
+      }
+      removeUntil(from.size());
+    }
+  }
+
+  /// \brief Get the element at the end of a path.
+  /// \param[in] _elem Root of the path.
+  /// \param[in] _path Child indices to follow.
+  /// \param[in] _length Number of indices of _path to follow.
+  /// \return The element, or nullptr if the path doesn't exist.
+  public: static ElementPtr Follow(const ElementPtr &_elem,
+      const std::vector<std::size_t> &_path, std::size_t _length)
+  {
+    ElementPtr elem = _elem;
+    for (std::size_t i = 0; i < _length; ++i)
+    {
+      const ElementPtr_V &children = Children(*elem);
+      if (_path[i] >= children.size())
+        return ElementPtr();
+      elem = children[_path[i]];
+    }
+    return elem;
+  }
+
+  /// \brief Apply one operation.
+  /// \param[in] _elem Root of the tree to patch.
+  /// \param[in] _op The operation.
+  /// \return True on success, false if the path doesn't exist.
+  public: static bool Apply(const ElementPtr &_elem, const ElementPatchOp &_op)
+  {
+    if (_op.type == ElementPatchOpType::MODIFY)
+    {
+      ElementPtr target = Follow(_elem, _op.path, _op.path.size());
+      if (!target)
+        return false;
+      Modify(*target, *_op.element);
+      return true;
+    }
+
+    if (_op.path.empty())
+      return false;
+    ElementPtr parent = Follow(_elem, _op.path, _op.path.size() - 1);
+    if (!parent)
+      return false;
+    const ElementPtr_V &children = Children(*parent);
+    const std::size_t index = _op.path.back();
+    if (_op.type == ElementPatchOpType::ADD)
+    {
+      if (index > children.size())
+        return false;
+      ElementPtr child = _op.element->Clone();
+      child->SetParent(parent);
+      parent->InsertElement(std::move(child), index);
+      return true;
+    }
+
+    if (index >= children.size())
+      return false;
+    parent->RemoveChild(children[index]);
+    return true;
+  }
+
+  /// \brief The operations, in the order they are applied.
+  public: std::vector<ElementPatchOp> ops;
+};
+
+/////////////////////////////////////////////////
+/// \brief Write a path of child indices.
+/// \param[in] _path The path.
+/// \return The indices separated by slashes.
+static std::string pathString(const std::vector<std::size_t> &_path)
+{
+  std::string result;
+  for (std::size_t index : _path)
+  {
+    if (!result.empty())
+      result += '/';
+    result += std::to_string(index);
+  }
+  return result;
+}
+
+/////////////////////////////////////////////////
+ElementPatch::ElementPatch()
+  : dataPtr(new ElementPatchPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+ElementPatch::ElementPatch(const ElementPatch &_patch)
+  : dataPtr(new ElementPatchPrivate(*_patch.dataPtr))
+{
+}
+
+/////////////////////////////////////////////////
+ElementPatch::ElementPatch(ElementPatch &&_patch) noexcept
+  : dataPtr(std::exchange(_patch.dataPtr, nullptr))
+{
+}
+
+/////////////////////////////////////////////////
+ElementPatch &ElementPatch::operator=(ElementPatch &&_patch) noexcept
+{
+  std::swap(this->dataPtr, _patch.dataPtr);
+  return *this;
+}
+
+/////////////////////////////////////////////////
+ElementPatch &ElementPatch::operator=(const ElementPatch &_patch)
+{
+  return *this = ElementPatch(_patch);
+}
+
+/////////////////////////////////////////////////
+ElementPatch::~ElementPatch()
+{
+  delete this->dataPtr;
+  this->dataPtr = nullptr;
+}
+
+/////////////////////////////////////////////////
+Errors ElementPatch::Diff(const ElementPtr &_from, const ElementPtr &_to)
+{
+  this->dataPtr->ops.clear();
+  if (!_from || !_to)
+  {
+    return {Error(ErrorCode::ELEMENT_MISSING,
+        "Unable to diff a null element tree.")};
+  }
+
+  this->dataPtr->Diff(*_from, *_to);
+  return {};
+}
+
+/////////////////////////////////////////////////
+Errors ElementPatch::Apply(const ElementPtr &_elem) const
+{
+  if (!_elem)
+  {
+    return {Error(ErrorCode::ELEMENT_MISSING,
+        "Unable to patch a null element tree.")};
+  }
+
+  for (std::size_t i = 0; i < this->dataPtr->ops.size(); ++i)
+  {
+    const ElementPatchOp &op = this->dataPtr->ops[i];
+    if (!ElementPatchPrivate::Apply(_elem, op))
+    {
+      return {Error(ErrorCode::ELEMENT_MISSING,
+          "Patch operation [" + std::to_string(i) +
+          "] refers to the missing element at path [" +
+          pathString(op.path) + "] of element [" + _elem->GetName() + "].")};
+    }
+  }
+  return {};
+}
+
+/////////////////////////////////////////////////
+bool ElementPatch::Empty() const
+{
+  return this->dataPtr->ops.empty();
+}
+
+/////////////////////////////////////////////////
+std::size_t ElementPatch::OpCount() const
+{
+  return this->dataPtr->ops.size();
+}
+
+/////////////////////////////////////////////////
+const ElementPatchOp *ElementPatch::OpByIndex(std::size_t _index) const
+{
+  if (_index >= this->dataPtr->ops.size())
+    return nullptr;
+  return &this->dataPtr->ops[_index];
+}
+
+/////////////////////////////////////////////////
+void ElementPatch::AddOp(ElementPatchOp _op)
+{
+  this->dataPtr->ops.push_back(std::move(_op));
+}
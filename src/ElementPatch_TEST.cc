@@ -0,0 +1,150 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <string>
+
+#include "sdf/Element.hh"
+#include "sdf/ElementPatch.hh"
+#include "sdf/SDFImpl.hh"
+
+/////////////////////////////////////////////////
+/// \brief Parse a world.
+/// \param[in] _models The models of the world.
+/// \return The root element.
+static sdf::ElementPtr parseWorld(const std::string &_models)
+{
+  sdf::SDFPtr sdfParsed(new sdf::SDF());
+  sdfParsed->SetFromString(
+      "<sdf version='1.8'><world name='default'>" + _models +
+      "</world></sdf>");
+  return sdfParsed->Root()->Clone();
+}
+
+/////////////////////////////////////////////////
+TEST(ElementPatch, Construction)
+{
+  sdf::ElementPatch patch;
+  EXPECT_TRUE(patch.Empty());
+  EXPECT_EQ(0u, patch.OpCount());
+  EXPECT_EQ(nullptr, patch.OpByIndex(0));
+
+  EXPECT_FALSE(patch.Diff(nullptr, nullptr).empty());
+  EXPECT_FALSE(patch.Apply(nullptr).empty());
+
+  sdf::ElementPtr world =
+    parseWorld("<model name='m'><link name='l'/></model>");
+  ASSERT_NE(nullptr, world);
+  EXPECT_TRUE(patch.Diff(world, world->Clone()).empty());
+  EXPECT_TRUE(patch.Empty());
+  EXPECT_TRUE(patch.Apply(world).empty());
+}
+
+/////////////////////////////////////////////////
+TEST(ElementPatch, DiffAndApply)
+{
+  const std::string unchanged =
+    "<model name='unchanged'><link name='l'/></model>";
+  sdf::ElementPtr before = parseWorld(unchanged +
+      "<model name='a'><pose>1 2 3 0 0 0</pose>"
+      "  <link name='l1'/><link name='l2'/><link name='l3'/></model>"
+      "<model name='b'><static>true</static><link name='l'/></model>");
+  sdf::ElementPtr after = parseWorld(unchanged +
+      "<model name='a'><pose>1 2 4 0 0 0</pose>"
+      "  <link name='l1'/><link name='l3'/><link name='l4'/></model>"
+      "<model name='c'><link name='l'/></model>");
+  ASSERT_NE(nullptr, before);
+  ASSERT_NE(nullptr, after);
+
+  sdf::ElementPatch patch;
+  EXPECT_TRUE(patch.Diff(before, after).empty());
+  EXPECT_FALSE(patch.Empty());
+
+  // Model b is replaced by model c. In model a, the pose is modified, l2
+  // is removed and l4 is added. The unchanged model is skipped.
+  int adds = 0;
+  int removes = 0;
+  int modifies = 0;
+  for (std::size_t i = 0; i < patch.OpCount(); ++i)
+  {
+    const sdf::ElementPatchOp *op = patch.OpByIndex(i);
+    ASSERT_NE(nullptr, op);
+    ASSERT_LE(2u, op->path.size());
+    // The first child of the world is the unchanged model.
+    EXPECT_NE(0u, op->path[1]);
+    switch (op->type)
+    {
+      case sdf::ElementPatchOpType::ADD:
+        ++adds;
+        break;
+      case sdf::ElementPatchOpType::REMOVE:
+        ++removes;
+        break;
+      case sdf::ElementPatchOpType::MODIFY:
+        ++modifies;
+        break;
+    }
+  }
+  EXPECT_EQ(2, adds);
+  EXPECT_EQ(2, removes);
+  EXPECT_EQ(1, modifies);
+
+  // Patching a copy of the original tree gives the modified tree.
+  sdf::ElementPtr copy = before->Clone();
+  EXPECT_TRUE(patch.Apply(copy).empty());
+  EXPECT_EQ(after->ContentHash(), copy->ContentHash());
+  EXPECT_EQ(after->ToString(""), copy->ToString(""));
+
+  // The added elements are copies, so the patch can be applied again.
+  sdf::ElementPtr other = before->Clone();
+  EXPECT_TRUE(patch.Apply(other).empty());
+  EXPECT_EQ(after->ToString(""), other->ToString(""));
+
+  // The reverse patch restores the original tree.
+  sdf::ElementPatch reverse;
+  EXPECT_TRUE(reverse.Diff(after, before).empty());
+  EXPECT_TRUE(reverse.Apply(copy).empty());
+  EXPECT_EQ(before->ToString(""), copy->ToString(""));
+
+  // A tree that doesn't have the original structure can't be patched.
+  sdf::ElementPtr empty = parseWorld("");
+  EXPECT_FALSE(patch.Apply(empty).empty());
+}
+
+/////////////////////////////////////////////////
+TEST(ElementPatch, Attributes)
+{
+  sdf::ElementPtr before = parseWorld(
+      "<model name='m' canonical_link='l1'><link name='l1'/>"
+      "  <link name='l2'/></model>");
+  sdf::ElementPtr after = parseWorld(
+      "<model name='m' canonical_link='l2' placement_frame='l2'>"
+      "  <link name='l1'/><link name='l2'/></model>");
+  ASSERT_NE(nullptr, before);
+  ASSERT_NE(nullptr, after);
+
+  sdf::ElementPatch patch;
+  EXPECT_TRUE(patch.Diff(before, after).empty());
+  ASSERT_EQ(1u, patch.OpCount());
+  EXPECT_EQ(sdf::ElementPatchOpType::MODIFY, patch.OpByIndex(0)->type);
+  EXPECT_EQ(nullptr, patch.OpByIndex(0)->element->GetFirstElement());
+
+  EXPECT_TRUE(patch.Apply(before).empty());
+  EXPECT_EQ(after->ToString(""), before->ToString(""));
+}
@@ -0,0 +1,466 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "sdf/ElementQuery.hh"
+
+#include "ElementTagIndex.hh"
+
+namespace sdf
+{
+inline namespace SDF_VERSION_NAMESPACE
+{
+  /// \brief How a step of a path relates to the previous one.
+  enum class QueryAxis
+  {
+    /// \brief The queried element itself. Only for the first step.
+    SELF,
+
+    /// \brief A child.
+    CHILD,
+
+    /// \brief The queried element or a descendant. Only for the first
+    /// step.
+    DESCENDANT_OR_SELF,
+
+    /// \brief A descendant. Never the first step.
+    DESCENDANT,
+  };
+
+  /// \brief An attribute predicate of a step.
+  struct QueryPredicate
+  {
+    /// \brief Attribute key.
+    std::string key;
+
+    /// \brief Whether the value is compared.
+    bool hasValue = false;
+
+    /// \brief Value the attribute must have.
+    std::string value;
+  };
+
+  /// \brief A step of a path.
+  struct QueryStep
+  {
+    /// \brief Relation to the element matched by the previous step.
+    QueryAxis axis = QueryAxis::CHILD;
+
+    /// \brief Element name, or empty for any name.
+    std::string name;
+
+    /// \brief Predicates the element must satisfy.
+    std::vector<QueryPredicate> predicates;
+  };
+
+  /// \brief Private data for ElementQuery
+  class ElementQueryPrivate
+  {
+    /// \brief Check whether an element matches a step, ignoring the axis.
+    /// \param[in] _step The step.
+    /// \param[in] _elem The element.
+    /// \return True if the name and predicates match.
+    public: static bool MatchStep(const QueryStep &_step,
+                                  const Element &_elem);
+
+    /// \brief Check whether a step matches an element of a chain, given
+    /// the steps before it.
+    /// \param[in] _step Index of the step.
+    /// \param[in] _chain The queried element followed by the descendants
+    /// that lead to the element to match.
+    /// \param[in] _depth Index in _chain of the element to match.
+    /// \return True if the steps up to _step match.
+    public: bool Match(std::size_t _step, const std::vector<Element *> &_chain,
+                       std::size_t _depth) const;
+
+    /// \brief Evaluate with the tag index of the tree.
+    /// \param[in] _index The index.
+    /// \param[in] _elem The queried element.
+    /// \param[in] _limit Maximum number of results.
+    /// \return The matching elements.
+    public: ElementPtr_V EvaluateIndexed(const ElementTagIndex &_index,
+                                         const ElementPtr &_elem,
+                                         std::size_t _limit) const;
+
+    /// \brief Evaluate by walking the subtree of the queried element.
+    /// \param[in] _elem The queried element.
+    /// \param[in] _limit Maximum number of results.
+    /// \return The matching elements.
+    public: ElementPtr_V EvaluateWalk(const ElementPtr &_elem,
+                                      std::size_t _limit) const;
+
+    /// \brief Evaluate the query.
+    /// \param[in] _elem The queried element.
+    /// \param[in] _limit Maximum number of results.
+    /// \return The matching elements.
+    public: ElementPtr_V Evaluate(const ElementPtr &_elem,
+                                  std::size_t _limit) const;
+
+    /// \brief The compiled path.
+    public: std::string path;
+
+    /// \brief Steps of the path, empty if it didn't compile.
+    public: std::vector<QueryStep> steps;
+  };
+}
+}
+
+using namespace sdf;
+
+/////////////////////////////////////////////////
+/// \brief Check whether a character can be part of a name in a path.
+/// \param[in] _c The character.
+/// \return True for letters, digits, and the characters _ - . and :
+static bool isNameChar(char _c)
+{
+  return (_c >= 'a' && _c <= 'z') || (_c >= 'A' && _c <= 'Z') ||
+         (_c >= '0' && _c <= '9') || _c == '_' || _c == '-' || _c == '.' ||
+         _c == ':';
+}
+
+/////////////////////////////////////////////////
+/// \brief Read a name from a path.
+/// \param[in] _path The path.
+/// \param[in,out] _pos Position to read from, moved past the name.
+/// \return The name, empty if there is none at _pos.
+static std::string readName(const std::string &_path, std::size_t &_pos)
+{
+  const std::size_t start = _pos;
+  while (_pos < _path.size() && isNameChar(_path[_pos]))
+    ++_pos;
+  return _path.substr(start, _pos - start);
+}
+
+/////////////////////////////////////////////////
+/// \brief Parse a path into steps.
+/// \param[in] _path The path.
+/// \param[out] _steps The steps.
+/// \param[out] _error Description of the problem, if parsing fails.
+/// \return True if the path was parsed.
+static bool parsePath(const std::string &_path,
+    std::vector<QueryStep> &_steps, std::string &_error)
+{
+  std::size_t pos = 0;
+  QueryAxis axis = QueryAxis::CHILD;
+  if (_path.compare(0, 2, "//") == 0)
+  {
+    axis = QueryAxis::DESCENDANT_OR_SELF;
+    pos = 2;
+  }
+  else if (_path.compare(0, 1, "/") == 0)
+  {
+    axis = QueryAxis::SELF;
+    pos = 1;
+  }
+
+  while (true)
+  {
+    QueryStep step;
+    step.axis = axis;
+    if (pos < _path.size() && _path[pos] == '*')
+      ++pos;
+    else if ((step.name = readName(_path, pos)).empty())
+    {
+      _error = "Missing element name at position " + std::to_string(pos);
+      return false;
+    }
+
+    while (pos < _path.size() && _path[pos] == '[')
+    {
+      QueryPredicate predicate;
+      ++pos;
+      if (pos >= _path.size() || _path[pos] != '@')
+      {
+        _error = "Expected '@' at position " + std::to_string(pos);
+        return false;
+      }
+      ++pos;
+      predicate.key = readName(_path, pos);
+      if (predicate.key.empty())
+      {
+        _error = "Missing attribute name at position " + std::to_string(pos);
+        return false;
+      }
+
+      if (pos < _path.size() && _path[pos] == '=')
+      {
+        ++pos;
+        const char quote = pos < _path.size() ? _path[pos] : '\0';
+        const std::size_t end = (quote == '\'' || quote == '"') ?
+          _path.find(quote, pos + 1) : std::string::npos;
+        if (end == std::string::npos)
+        {
+          _error = "Expected a quoted value at position " +
+            std::to_string(pos);
+          return false;
+        }
+        predicate.hasValue = true;
+        predicate.value = _path.substr(pos + 1, end - pos - 1);
+        pos = end + 1;
+      }
+
+      if (pos >= _path.size() || _path[pos] != ']')
+      {
+        _error = "Expected ']' at position " + std::to_string(pos);
+        return false;
+      }
+      ++pos;
+      step.predicates.push_back(std::move(predicate));
+    }
+    _steps.push_back(std::move(step));
+
+    if (pos == _path.size())
+      return true;
+
+    if (_path.compare(pos, 2, "//") == 0)
+    {
+      axis = QueryAxis::DESCENDANT;
+      pos += 2;
+    }
+    else if (_path[pos] == '/')
+    {
+      axis = QueryAxis::CHILD;
+      ++pos;
+    }
+    else
+    {
+      _error = "Unexpected character at position " + std::to_string(pos);
+      return false;
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+bool ElementQueryPrivate::MatchStep(const QueryStep &_step,
+    const Element &_elem)
+{
+  if (!_step.name.empty() && _step.name != _elem.GetName())
+    return false;
+
+  for (const QueryPredicate &predicate : _step.predicates)
+  {
+    // Like ContentHash, only the attributes that ToString writes count.
+    ParamPtr attribute = _elem.GetAttribute(predicate.key);
+    if (!attribute || !(attribute->GetSet() || attribute->GetRequired()))
+      return false;
+    if (predicate.hasValue && attribute->GetAsString() != predicate.value)
+      return false;
+  }
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool ElementQueryPrivate::Match(std::size_t _step,
+    const std::vector<Element *> &_chain, std::size_t _depth) const
+{
+  const QueryStep &step = this->steps[_step];
+  if (!MatchStep(step, *_chain[_depth]))
+    return false;
+
+  switch (step.axis)
+  {
+    case QueryAxis::SELF:
+      return _depth == 0;
+    case QueryAxis::DESCENDANT_OR_SELF:
+      return true;
+    case QueryAxis::CHILD:
+      if (_step == 0)
+        return _depth == 1;
+      return _depth > 0 && this->Match(_step - 1, _chain, _depth - 1);
+    case QueryAxis::DESCENDANT:
+      for (std::size_t depth = _depth; depth > 0; --depth)
+      {
+        if (this->Match(_step - 1, _chain, depth - 1))
+          return true;
+      }
+      return false;
+  }
+  return false;
+}
+
+/////////////////////////////////////////////////
+ElementPtr_V ElementQueryPrivate::EvaluateIndexed(
+    const ElementTagIndex &_index, const ElementPtr &_elem,
+    std::size_t _limit) const
+{
+  ElementPtr_V result;
+  std::vector<ElementPtr> ancestors;
+  std::vector<Element *> chain;
+  for (ElementPtr &candidate : _index.Tagged(this->steps.back().name))
+  {
+    if (!MatchStep(this->steps.back(), *candidate))
+      continue;
+
+    // Candidates that are not in the subtree of the queried element, or
+    // no longer in the tree at all, don't reach it.
+    ancestors.clear();
+    ancestors.push_back(candidate);
+    while (ancestors.back() != _elem)
+    {
+      ElementPtr parent = ElementTagIndex::Parent(*ancestors.back());
+      if (!parent)
+        break;
+      ancestors.push_back(std::move(parent));
+    }
+    if (ancestors.back() != _elem)
+      continue;
+
+    chain.clear();
+    for (auto it = ancestors.rbegin(); it != ancestors.rend(); ++it)
+      chain.push_back(it->get());
+    if (this->Match(this->steps.size() - 1, chain, chain.size() - 1))
+    {
+      result.push_back(std::move(candidate));
+      if (result.size() >= _limit)
+        break;
+    }
+  }
+  return result;
+}
+
+/////////////////////////////////////////////////
+ElementPtr_V ElementQueryPrivate::EvaluateWalk(const ElementPtr &_elem,
+    std::size_t _limit) const
+{
+  // Depth first, in document order, keeping the chain of elements from
+  // the queried element to the current one.
+  ElementPtr_V result;
+  std::vector<std::pair<ElementPtr, std::size_t>> stack{{_elem, 0u}};
+  std::vector<Element *> chain;
+  ElementPtr_V children;
+  while (!stack.empty())
+  {
+    auto [elem, depth] = std::move(stack.back());
+    stack.pop_back();
+    chain.resize(depth);
+    chain.push_back(elem.get());
+
+    if (this->Match(this->steps.size() - 1, chain, depth))
+    {
+      result.push_back(elem);
+      if (result.size() >= _limit)
+        break;
+    }
+
+    children.clear();
+    for (ElementPtr child = elem->GetFirstElement(); child;
+         child = child->GetNextElement())
+    {
+      children.push_back(std::move(child));
+    }
+    for (auto it = children.rbegin(); it != children.rend(); ++it)
+      stack.emplace_back(std::move(*it), depth + 1);
+  }
+  return result;
+}
+
+/////////////////////////////////////////////////
+ElementPtr_V ElementQueryPrivate::Evaluate(const ElementPtr &_elem,
+    std::size_t _limit) const
+{
+  if (!_elem || this->steps.empty() || _limit == 0)
+    return {};
+
+  if (!this->steps.back().name.empty())
+  {
+    const ElementTagIndex *index = ElementTagIndex::Find(*_elem);
+    if (index)
+      return this->EvaluateIndexed(*index, _elem, _limit);
+  }
+  return this->EvaluateWalk(_elem, _limit);
+}
+
+/////////////////////////////////////////////////
+ElementQuery::ElementQuery()
+  : dataPtr(new ElementQueryPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+ElementQuery::ElementQuery(const ElementQuery &_query)
+  : dataPtr(new ElementQueryPrivate(*_query.dataPtr))
+{
+}
+
+/////////////////////////////////////////////////
+ElementQuery::ElementQuery(ElementQuery &&_query) noexcept
+  : dataPtr(std::exchange(_query.dataPtr, nullptr))
+{
+}
+
+/////////////////////////////////////////////////
+ElementQuery &ElementQuery::operator=(ElementQuery &&_query) noexcept
+{
+  std::swap(this->dataPtr, _query.dataPtr);
+  return *this;
+}
+
+/////////////////////////////////////////////////
+ElementQuery &ElementQuery::operator=(const ElementQuery &_query)
+{
+  return *this = ElementQuery(_query);
+}
+
+/////////////////////////////////////////////////
+ElementQuery::~ElementQuery()
+{
+  delete this->dataPtr;
+  this->dataPtr = nullptr;
+}
+
+/////////////////////////////////////////////////
+Errors ElementQuery::Compile(const std::string &_path)
+{
+  this->dataPtr->path.clear();
+  this->dataPtr->steps.clear();
+
+  std::vector<QueryStep> steps;
+  std::string error;
+  if (!parsePath(_path, steps, error))
+  {
+    return {Error(ErrorCode::ELEMENT_INVALID,
+        "Invalid element query [" + _path + "]: " + error + ".")};
+  }
+
+  this->dataPtr->path = _path;
+  this->dataPtr->steps = std::move(steps);
+  return {};
+}
+
+/////////////////////////////////////////////////
+const std::string &ElementQuery::Path() const
+{
+  return this->dataPtr->path;
+}
+
+/////////////////////////////////////////////////
+ElementPtr_V ElementQuery::Evaluate(const ElementPtr &_elem) const
+{
+  return this->dataPtr->Evaluate(_elem, static_cast<std::size_t>(-1));
+}
+
+/////////////////////////////////////////////////
+ElementPtr ElementQuery::EvaluateFirst(const ElementPtr &_elem) const
+{
+  ElementPtr_V result = this->dataPtr->Evaluate(_elem, 1u);
+  return result.empty() ? nullptr : result.front();
+}
@@ -0,0 +1,243 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "sdf/Element.hh"
+#include "sdf/ElementQuery.hh"
+#include "sdf/SDFImpl.hh"
+
+/////////////////////////////////////////////////
+/// \brief Parse a world.
+/// \param[in] _models The models of the world.
+/// \return The root element.
+static sdf::ElementPtr parseWorld(const std::string &_models)
+{
+  sdf::SDFPtr sdfParsed(new sdf::SDF());
+  sdfParsed->SetFromString(
+      "<sdf version='1.8'><world name='default'>" + _models +
+      "</world></sdf>");
+  return sdfParsed->Root()->Clone();
+}
+
+/////////////////////////////////////////////////
+/// \brief Evaluate a query and get the name attributes of the results.
+/// \param[in] _path The path to query.
+/// \param[in] _elem The element to query.
+/// \return The names, separated by spaces.
+static std::string names(const std::string &_path,
+    const sdf::ElementPtr &_elem)
+{
+  sdf::ElementQuery query;
+  EXPECT_TRUE(query.Compile(_path).empty()) << _path;
+  std::string result;
+  for (const sdf::ElementPtr &elem : query.Evaluate(_elem))
+  {
+    if (!result.empty())
+      result += " ";
+    result += elem->Get<std::string>("name");
+  }
+  return result;
+}
+
+/////////////////////////////////////////////////
+/// \brief A world with two models, one nested in the other.
+static const char kModels[] =
+  "<model name='a'>"
+  "  <link name='a1'>"
+  "    <sensor name='cam1' type='camera'/>"
+  "    <sensor name='imu1' type='imu'/>"
+  "  </link>"
+  "  <model name='b'>"
+  "    <link name='b1'><sensor name='cam2' type='camera'/></link>"
+  "  </model>"
+  "</model>"
+  "<model name='c'>"
+  "  <link name='c1'><sensor name='cam3' type='camera'/></link>"
+  "</model>";
+
+/////////////////////////////////////////////////
+TEST(ElementQuery, Compile)
+{
+  sdf::ElementQuery query;
+  EXPECT_TRUE(query.Path().empty());
+  EXPECT_TRUE(query.Evaluate(parseWorld("")).empty());
+
+  EXPECT_TRUE(query.Compile("//model/link/sensor[@type='camera']").empty());
+  EXPECT_EQ("//model/link/sensor[@type='camera']", query.Path());
+  EXPECT_TRUE(query.Evaluate(nullptr).empty());
+  EXPECT_EQ(nullptr, query.EvaluateFirst(nullptr));
+
+  for (const char *path : {"", "/", "//", "model/", "model//",
+       "model[", "model[name]", "model[@]", "model[@name='a'",
+       "model[@name=a]", "model[@name='a]", "model!"})
+  {
+    sdf::Errors errors = query.Compile(path);
+    ASSERT_EQ(1u, errors.size()) << path;
+    EXPECT_EQ(sdf::ErrorCode::ELEMENT_INVALID, errors[0].Code());
+    EXPECT_TRUE(query.Path().empty());
+  }
+
+  EXPECT_TRUE(query.Compile("/sdf/*[@name=\"default\"]").empty());
+  sdf::ElementQuery copy(query);
+  EXPECT_EQ(query.Path(), copy.Path());
+}
+
+/////////////////////////////////////////////////
+TEST(ElementQuery, Evaluate)
+{
+  sdf::ElementPtr root = parseWorld(kModels);
+  ASSERT_NE(nullptr, root);
+
+  for (bool indexed : {false, true})
+  {
+    if (indexed)
+    {
+      root->BuildTagIndex();
+      EXPECT_TRUE(root->HasTagIndex());
+    }
+
+    EXPECT_EQ("cam1 cam2 cam3",
+        names("//model/link/sensor[@type='camera']", root)) << indexed;
+    EXPECT_EQ("cam1 imu1 cam2 cam3", names("//sensor", root));
+    EXPECT_EQ("cam1 imu1 cam2 cam3", names("//sensor[@type]", root));
+    EXPECT_EQ("a1 c1", names("/sdf/world/model/link", root));
+    EXPECT_EQ("a1 b1", names("//model[@name='a']//link", root));
+    EXPECT_EQ("b", names("//model/model", root));
+    EXPECT_EQ("default", names("/sdf/*", root));
+    EXPECT_EQ("default", names("world", root));
+    EXPECT_EQ("", names("/world", root));
+    EXPECT_EQ("", names("model", root));
+    EXPECT_EQ("", names("//sensor[@name='cam1'][@type='imu']", root));
+
+    // Queries on an element of the tree only look at its subtree.
+    sdf::ElementQuery query;
+    ASSERT_TRUE(query.Compile("//model[@name='c']").empty());
+    sdf::ElementPtr modelC = query.EvaluateFirst(root);
+    ASSERT_NE(nullptr, modelC);
+    EXPECT_EQ("cam3", names("//sensor", modelC));
+    EXPECT_EQ("c", names("//model", modelC));
+    EXPECT_EQ("c1", names("link", modelC));
+    EXPECT_EQ("c", names("/model", modelC));
+
+    ASSERT_TRUE(query.Compile("//sensor").empty());
+    EXPECT_EQ("cam1", query.EvaluateFirst(root)->Get<std::string>("name"));
+  }
+
+  root->ClearTagIndex();
+  EXPECT_FALSE(root->HasTagIndex());
+  EXPECT_EQ("cam1 imu1 cam2 cam3", names("//sensor", root));
+}
+
+/////////////////////////////////////////////////
+TEST(ElementQuery, IndexUpdates)
+{
+  sdf::ElementPtr root = parseWorld(kModels);
+  ASSERT_NE(nullptr, root);
+  root->BuildTagIndex();
+
+  sdf::ElementQuery query;
+  ASSERT_TRUE(query.Compile("//model[@name='c']").empty());
+  sdf::ElementPtr modelC = query.EvaluateFirst(root);
+  ASSERT_NE(nullptr, modelC);
+  sdf::ElementPtr world = modelC->GetParent();
+
+  // Inserted elements are found.
+  sdf::ElementPtr link = modelC->AddElement("link");
+  link->GetAttribute("name")->SetFromString("c2");
+  sdf::ElementPtr sensor = link->AddElement("sensor");
+  sensor->GetAttribute("name")->SetFromString("cam4");
+  sensor->GetAttribute("type")->SetFromString("camera");
+  EXPECT_EQ("cam1 cam2 cam3 cam4",
+      names("//link/sensor[@type='camera']", root));
+
+  // Removed elements are not.
+  modelC->RemoveChild(link);
+  EXPECT_EQ("cam1 cam2 cam3", names("//link/sensor[@type='camera']", root));
+  world->RemoveChild(modelC);
+  EXPECT_EQ("cam1 cam2", names("//link/sensor[@type='camera']", root));
+  EXPECT_EQ("", names("//model[@name='c']", root));
+
+  // Moving a model finds it at its new place, once. The index keeps the
+  // order the elements were indexed in, while walking the tree follows the
+  // document.
+  modelC->SetParent(world);
+  world->InsertElement(modelC, 0);
+  EXPECT_EQ("cam1 cam2 cam3", names("//link/sensor[@type='camera']", root));
+  EXPECT_EQ("a b c", names("//model", root));
+  sdf::ElementPtr copy = root->Clone();
+  EXPECT_FALSE(copy->HasTagIndex());
+  EXPECT_EQ("c a b", names("//model", copy));
+
+  // Renamed elements are found under their new name only.
+  link = modelC->GetElement("link");
+  link->SetName("frame");
+  EXPECT_EQ("a1 b1", names("//link", root));
+  EXPECT_EQ("c1", names("//frame", root));
+  link->SetName("link");
+  EXPECT_EQ("a1 b1 c1", names("//link", root));
+
+  // Many insertions and removals keep the index consistent.
+  for (int i = 0; i < 2000; ++i)
+  {
+    sdf::ElementPtr model = world->AddElement("model");
+    model->GetAttribute("name")->SetFromString("m" + std::to_string(i));
+    if (i % 2 == 0)
+      world->RemoveChild(model);
+  }
+  ASSERT_TRUE(query.Compile("//model").empty());
+  EXPECT_EQ(3u + 1000u, query.Evaluate(root).size());
+  EXPECT_EQ("m1999", names("world/model[@name='m1999']", root));
+}
+
+/////////////////////////////////////////////////
+TEST(ElementQuery, LargeTree)
+{
+  // 1000 models of 10 links with a sensor each, about 50k elements with
+  // the poses and other required children.
+  std::string models;
+  for (int m = 0; m < 1000; ++m)
+  {
+    models += "<model name='m" + std::to_string(m) + "'>";
+    for (int l = 0; l < 10; ++l)
+    {
+      models += "<link name='l" + std::to_string(l) + "'><sensor name='s' "
+        "type='" + std::string(l == 0 ? "camera" : "imu") + "'/></link>";
+    }
+    models += "</model>";
+  }
+  sdf::ElementPtr root = parseWorld(models);
+  ASSERT_NE(nullptr, root);
+
+  sdf::ElementQuery query;
+  ASSERT_TRUE(query.Compile("//model/link/sensor[@type='camera']").empty());
+  const sdf::ElementPtr_V walked = query.Evaluate(root);
+  EXPECT_EQ(1000u, walked.size());
+
+  root->BuildTagIndex();
+  EXPECT_EQ(walked, query.Evaluate(root));
+}
+
+/////////////////////////////////////////////////
+/// Main
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
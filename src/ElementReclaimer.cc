@@ -0,0 +1,146 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "ElementReclaimer.hh"
+
+using namespace sdf;
+
+namespace
+{
+/// \brief True on the reclaimer thread.
+thread_local bool onReclaimerThread = false;
+
+/// \brief True once the reclaimer stopped at exit. It is trivially
+/// destructible, so it can be read while other statics are destroyed.
+std::atomic<bool> reclaimerStopped{false};
+
+/// \brief State of the reclaimer thread.
+class Reclaimer
+{
+  /// \brief Stop the thread once the queue is empty.
+  public: ~Reclaimer()
+  {
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      this->stop = true;
+      this->pending.notify_one();
+    }
+    if (this->thread.joinable())
+      this->thread.join();
+    reclaimerStopped = true;
+  }
+
+  /// \brief Body of the reclaimer thread.
+  public: void Run()
+  {
+    onReclaimerThread = true;
+    std::unique_lock<std::mutex> lock(this->mutex);
+    while (true)
+    {
+      this->pending.wait(lock, [this]
+          {
+            return this->stop || !this->queue.empty();
+          });
+      if (this->queue.empty())
+        break;
+
+      // Destroy without the lock, so that elements can be queued meanwhile.
+      std::vector<ElementPtr_V> batch;
+      batch.swap(this->queue);
+      this->destroying = true;
+      lock.unlock();
+      batch.clear();
+      lock.lock();
+      this->destroying = false;
+      this->released.notify_all();
+    }
+  }
+
+  /// \brief Children of destroyed elements waiting to be destroyed.
+  public: std::vector<ElementPtr_V> queue;
+
+  /// \brief True while the thread destroys elements it took from queue.
+  public: bool destroying = false;
+
+  /// \brief True to stop the thread.
+  public: bool stop = false;
+
+  /// \brief Protects queue, destroying and stop.
+  public: std::mutex mutex;
+
+  /// \brief Signals the thread that there are elements or it must stop.
+  public: std::condition_variable pending;
+
+  /// \brief Signals waiting threads that the queue was destroyed.
+  public: std::condition_variable released;
+
+  /// \brief Thread that destroys the elements, started with the first
+  /// release.
+  public: std::thread thread;
+};
+
+/////////////////////////////////////////////////
+Reclaimer &reclaimer()
+{
+  static Reclaimer instance;
+  return instance;
+}
+}
+
+/////////////////////////////////////////////////
+bool ElementReclaimer::Release(ElementPtr_V &_elements)
+{
+  if (reclaimerStopped)
+    return false;
+
+  Reclaimer &instance = reclaimer();
+  std::lock_guard<std::mutex> lock(instance.mutex);
+  if (instance.stop)
+    return false;
+  if (!instance.thread.joinable())
+    instance.thread = std::thread(&Reclaimer::Run, &instance);
+  instance.queue.push_back(std::move(_elements));
+  instance.pending.notify_one();
+  return true;
+}
+
+/////////////////////////////////////////////////
+void ElementReclaimer::Flush()
+{
+  if (reclaimerStopped)
+    return;
+
+  Reclaimer &instance = reclaimer();
+  std::unique_lock<std::mutex> lock(instance.mutex);
+  instance.released.wait(lock, [&instance]
+      {
+        return instance.queue.empty() && !instance.destroying;
+      });
+}
+
+/////////////////////////////////////////////////
+bool ElementReclaimer::OnReclaimerThread()
+{
+  return onReclaimerThread;
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_ELEMENT_RECLAIMER_HH_
+#define SDF_ELEMENT_RECLAIMER_HH_
+
+#include "sdf/Element.hh"
+#include "sdf/ParserConfig.hh"
+#include "sdf/sdf_config.h"
+
+/// \ingroup sdf_parser
+/// \brief namespace for Simulation Description Format parser
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief Thread that destroys the children of elements released in the
+  /// background, so that dropping the last reference to a large tree
+  /// doesn't block the thread that drops it. The thread is started by the
+  /// first release, and the elements still queued when the program exits
+  /// are destroyed before it stops.
+  class ElementReclaimer
+  {
+    /// \brief Queue children for destruction on the reclaimer thread.
+    /// \param[in,out] _elements Children of a destroyed element. They are
+    /// moved out of the vector if they are queued.
+    /// \return False if the reclaimer already stopped, in which case the
+    /// caller destroys the children itself.
+    public: static bool Release(ElementPtr_V &_elements);
+
+    /// \brief Wait until the elements queued so far are destroyed.
+    public: static void Flush();
+
+    /// \brief Get whether the calling thread is the reclaimer thread.
+    /// \return True on the reclaimer thread.
+    public: static bool OnReclaimerThread();
+  };
+
+  /// \brief Sets whether the elements created on the current thread while
+  /// this scope is alive release their children in the background when
+  /// they are destroyed. The previous setting is restored when the scope
+  /// is destroyed, so scopes can nest.
+  class ElementReclaimScope
+  {
+    /// \brief Constructor
+    /// \param[in] _background True to release elements in the background.
+    public: explicit ElementReclaimScope(bool _background)
+      : previous(Background())
+    {
+      Background() = _background;
+    }
+
+    /// \brief Constructor that uses the setting of a ParserConfig.
+    /// \param[in] _config Parser configuration.
+    public: explicit ElementReclaimScope(const ParserConfig &_config)
+      : ElementReclaimScope(_config.ReleaseElementsInBackground())
+    {
+    }
+
+    /// \brief Destructor
+    public: ~ElementReclaimScope()
+    {
+      Background() = this->previous;
+    }
+
+    /// \brief Get the setting of the current thread.
+    /// \return Reference to the setting, which is true when elements are
+    /// released in the background.
+    public: static bool &Background()
+    {
+      static thread_local bool background = false;
+      return background;
+    }
+
+    /// \brief Setting that was current before this scope.
+    private: bool previous;
+  };
+  }
+}
+#endif
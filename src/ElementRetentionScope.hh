@@ -0,0 +1,85 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_ELEMENT_RETENTION_SCOPE_HH_
+#define SDF_ELEMENT_RETENTION_SCOPE_HH_
+
+#include "sdf/Element.hh"
+#include "sdf/ParserConfig.hh"
+#include "sdf/sdf_config.h"
+
+/// \ingroup sdf_parser
+/// \brief namespace for Simulation Description Format parser
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief Sets whether the DOM objects loaded on the current thread while
+  /// this scope is alive keep the element they were loaded from. The
+  /// previous setting is restored when the scope is destroyed, so scopes
+  /// can nest.
+  ///
+  /// Models and worlds keep their element regardless, since the frame
+  /// graphs are built from them; Root::Load releases it afterwards.
+  class ElementRetentionScope
+  {
+    /// \brief Constructor
+    /// \param[in] _release True to release the elements in this scope.
+    public: explicit ElementRetentionScope(bool _release)
+      : previous(Release())
+    {
+      Release() = _release;
+    }
+
+    /// \brief Constructor that uses the setting of a ParserConfig.
+    /// \param[in] _config Parser configuration.
+    public: explicit ElementRetentionScope(const ParserConfig &_config)
+      : ElementRetentionScope(_config.ReleaseElements())
+    {
+    }
+
+    /// \brief Destructor
+    public: ~ElementRetentionScope()
+    {
+      Release() = this->previous;
+    }
+
+    /// \brief Get the setting of the current thread.
+    /// \return Reference to the setting, which is true when elements are
+    /// released.
+    public: static bool &Release()
+    {
+      static thread_local bool release = false;
+      return release;
+    }
+
+    /// \brief Setting that was current before this scope.
+    private: bool previous;
+  };
+
+  /// \brief Get the element a DOM object should keep after loading from
+  /// _sdf, according to the current ElementRetentionScope.
+  /// \param[in] _sdf Element the object is loaded from.
+  /// \return _sdf, or nullptr if elements are released.
+  inline ElementPtr retainedElement(const ElementPtr &_sdf)
+  {
+    return ElementRetentionScope::Release() ? ElementPtr() : _sdf;
+  }
+  }
+}
+#endif
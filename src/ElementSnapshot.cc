@@ -0,0 +1,377 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "sdf/ElementSnapshot.hh"
+#include "ElementChangeEpoch.hh"
+
+using namespace sdf;
+
+class sdf::ElementSnapshotPrivate
+{
+  /// \brief An element of a snapshot, shared by the snapshots in which its
+  /// subtree didn't change.
+  public: struct Node
+  {
+    /// \brief Copy of the element without its children.
+    ElementPtr content;
+
+    /// \brief Children of the element.
+    std::vector<std::shared_ptr<const Node>> children;
+
+    /// \brief The element the copy was made of. It is only compared, since
+    /// the element may have been released since.
+    const Element *source = nullptr;
+  };
+
+  /// \brief Shared pointer to a Node.
+  public: using NodePtr = std::shared_ptr<const Node>;
+
+  /// \brief Copy the elements of a tree that changed since a previous
+  /// snapshot, and share the subtrees that didn't.
+  /// \param[in] _elem Root of the tree.
+  /// \param[in] _previous Root of the previous snapshot, or nullptr.
+  /// \param[in] _epoch Epoch left behind by the previous snapshot.
+  /// \return Root of the new snapshot.
+  public: static NodePtr Build(const Element &_elem,
+      const NodePtr &_previous, std::uint64_t _epoch)
+  {
+    // An element stamped before the previous snapshot was taken didn't
+    // change since, nor did its descendants.
+    auto unchanged = [_epoch](const Element &_source,
+        const Node &_node)
+    {
+      return _node.source == &_source &&
+          _source.dataPtr->changeEpoch < _epoch;
+    };
+    if (_previous && unchanged(_elem, *_previous))
+      return _previous;
+
+    // The nodes are built with an explicit stack, so that deep trees can be
+    // copied on small thread stacks. A node is only shared once it is
+    // complete, when Build returns.
+    struct Pending
+    {
+      const Element *elem;
+      const Node *previous;
+      Node *node;
+    };
+
+    auto root = std::make_shared<Node>();
+    root->content = _elem.Instantiate();
+    root->source = &_elem;
+    std::vector<Pending> stack;
+    stack.push_back({&_elem, _previous.get(), root.get()});
+    std::unordered_map<const Element *, std::size_t> previousIndex;
+    while (!stack.empty())
+    {
+      const Pending pending = stack.back();
+      stack.pop_back();
+      pending.elem->ReadLazyChildren();
+      const ElementPtr_V &elements = pending.elem->dataPtr->elements;
+
+      // The previous children are usually at the same positions, and are
+      // only indexed when they are not.
+      const Node *previous = pending.previous;
+      previousIndex.clear();
+      bool indexed = false;
+      auto findPrevious = [&](std::size_t _index) -> const NodePtr *
+      {
+        if (!previous)
+          return nullptr;
+        const Element *child = elements[_index].get();
+        if (_index < previous->children.size() &&
+            previous->children[_index]->source == child)
+        {
+          return &previous->children[_index];
+        }
+        if (!indexed)
+        {
+          for (std::size_t i = 0; i < previous->children.size(); ++i)
+            previousIndex.emplace(previous->children[i]->source, i);
+          indexed = true;
+        }
+        auto found = previousIndex.find(child);
+        return found == previousIndex.end() ? nullptr :
+            &previous->children[found->second];
+      };
+
+      pending.node->children.reserve(elements.size());
+      for (std::size_t i = 0; i < elements.size(); ++i)
+      {
+        const Element &child = *elements[i];
+        const NodePtr *previousChild = findPrevious(i);
+        if (previousChild && unchanged(child, **previousChild))
+        {
+          pending.node->children.push_back(*previousChild);
+          continue;
+        }
+
+        auto node = std::make_shared<Node>();
+        node->content = child.Instantiate();
+        node->source = &child;
+        stack.push_back({&child,
+            previousChild ? previousChild->get() : nullptr, node.get()});
+        pending.node->children.push_back(std::move(node));
+      }
+    }
+    return root;
+  }
+
+  /// \brief Create an element tree with the content of a snapshot.
+  /// \param[in] _node Root of the snapshot.
+  /// \return Root of the new tree.
+  public: static ElementPtr Materialize(const Node &_node)
+  {
+    ElementPtr root = _node.content->Instantiate();
+    std::vector<std::pair<const Node *, ElementPtr>> stack;
+    stack.emplace_back(&_node, root);
+    while (!stack.empty())
+    {
+      auto [node, elem] = std::move(stack.back());
+      stack.pop_back();
+      for (const NodePtr &childNode : node->children)
+      {
+        ElementPtr child = childNode->content->Instantiate();
+        child->SetParent(elem);
+        elem->InsertElement(child);
+        stack.emplace_back(childNode.get(), std::move(child));
+      }
+    }
+    return root;
+  }
+
+  /// \brief Add the operations that turn the tree of one snapshot into the
+  /// tree of another one to a patch, in the order of ElementPatch::Diff.
+  /// \param[in] _from Root of the earlier snapshot.
+  /// \param[in] _to Root of the later snapshot.
+  /// \param[in,out] _patch The patch.
+  public: static void Diff(const Node &_from,
+      const Node &_to, ElementPatch &_patch)
+  {
+    struct Pending
+    {
+      const Node *from;
+      const Node *to;
+      std::vector<std::size_t> path;
+    };
+
+    // The operations on the children of a pair are all added before any
+    // of its descendants are diffed, so the paths of the descendants are
+    // their final positions.
+    std::vector<Pending> stack;
+    stack.push_back({&_from, &_to, {}});
+    std::unordered_map<const Element *, std::size_t> positions;
+    while (!stack.empty())
+    {
+      Pending pending = std::move(stack.back());
+      stack.pop_back();
+
+      if (!pending.from->content->SameOwnContent(*pending.to->content))
+      {
+        _patch.AddOp({ElementPatchOpType::MODIFY, pending.path,
+            pending.to->content->Instantiate()});
+      }
+
+      const auto &from = pending.from->children;
+      const auto &to = pending.to->children;
+      positions.clear();
+      for (std::size_t i = 0; i < from.size(); ++i)
+        positions.emplace(from[i]->source, i);
+
+      // Each later child is matched with the earlier child made of the same
+      // element, if it wasn't skipped over. The earlier children skipped
+      // over are removed, and later children without a match are added.
+      // _next is the first earlier child that is neither matched nor
+      // removed, and _position is its index in the tree as patched so far.
+      std::size_t next = 0;
+      std::size_t position = 0;
+      auto removeUntil = [&](std::size_t _end)
+      {
+        for (; next < _end; ++next)
+        {
+          std::vector<std::size_t> path = pending.path;
+          path.push_back(position);
+          _patch.AddOp({ElementPatchOpType::REMOVE, std::move(path),
+              ElementPtr()});
+        }
+      };
+
+      for (const NodePtr &child : to)
+      {
+        auto found = positions.find(child->source);
+        std::vector<std::size_t> path = pending.path;
+        path.push_back(position);
+        if (found != positions.end() && found->second >= next)
+        {
+          removeUntil(found->second);
+          if (from[found->second] != child)
+          {
+            stack.push_back({from[found->second].get(), child.get(),
+                std::move(path)});
+          }
+          ++next;
+        }
+        else
+        {
+          _patch.AddOp({ElementPatchOpType::ADD, std::move(path),
+              Materialize(*child)});
+        }
+        ++position;
+      }
+      removeUntil(from.size());
+    }
+  }
+
+  /// \brief Root of the snapshot, or nullptr if it is empty.
+  public: NodePtr root;
+
+  /// \brief Epoch that the changes after the snapshot are stamped with.
+  public: std::uint64_t epoch = 0u;
+};
+
+/////////////////////////////////////////////////
+ElementSnapshot::ElementSnapshot()
+  : dataPtr(new ElementSnapshotPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+ElementSnapshot::ElementSnapshot(const ElementSnapshot &_snapshot)
+  : dataPtr(new ElementSnapshotPrivate(*_snapshot.dataPtr))
+{
+}
+
+/////////////////////////////////////////////////
+ElementSnapshot::ElementSnapshot(ElementSnapshot &&_snapshot) noexcept
+  : dataPtr(std::exchange(_snapshot.dataPtr, nullptr))
+{
+}
+
+/////////////////////////////////////////////////
+ElementSnapshot &ElementSnapshot::operator=(
+    ElementSnapshot &&_snapshot) noexcept
+{
+  std::swap(this->dataPtr, _snapshot.dataPtr);
+  return *this;
+}
+
+/////////////////////////////////////////////////
+ElementSnapshot &ElementSnapshot::operator=(const ElementSnapshot &_snapshot)
+{
+  return *this = ElementSnapshot(_snapshot);
+}
+
+/////////////////////////////////////////////////
+ElementSnapshot::~ElementSnapshot()
+{
+  delete this->dataPtr;
+  this->dataPtr = nullptr;
+}
+
+/////////////////////////////////////////////////
+ElementSnapshot ElementSnapshot::Take(const ElementPtr &_elem,
+    const ElementSnapshot &_previous)
+{
+  ElementSnapshot snapshot;
+  if (!_elem)
+    return snapshot;
+
+  ElementChangeEpoch::Start();
+  snapshot.dataPtr->root = ElementSnapshotPrivate::Build(*_elem,
+      _previous.dataPtr->root, _previous.dataPtr->epoch);
+  snapshot.dataPtr->epoch = ElementChangeEpoch::Advance();
+  return snapshot;
+}
+
+/////////////////////////////////////////////////
+bool ElementSnapshot::Empty() const
+{
+  return !this->dataPtr->root;
+}
+
+/////////////////////////////////////////////////
+ElementConstPtr ElementSnapshot::Content() const
+{
+  if (!this->dataPtr->root)
+    return ElementConstPtr();
+  return this->dataPtr->root->content;
+}
+
+/////////////////////////////////////////////////
+std::size_t ElementSnapshot::ChildCount() const
+{
+  return this->dataPtr->root ? this->dataPtr->root->children.size() : 0u;
+}
+
+/////////////////////////////////////////////////
+ElementSnapshot ElementSnapshot::Child(std::size_t _index) const
+{
+  ElementSnapshot child;
+  if (_index < this->ChildCount())
+  {
+    child.dataPtr->root = this->dataPtr->root->children[_index];
+    child.dataPtr->epoch = this->dataPtr->epoch;
+  }
+  return child;
+}
+
+/////////////////////////////////////////////////
+bool ElementSnapshot::SameAs(const ElementSnapshot &_snapshot) const
+{
+  return this->dataPtr->root == _snapshot.dataPtr->root;
+}
+
+/////////////////////////////////////////////////
+ElementPtr ElementSnapshot::ToElement() const
+{
+  if (!this->dataPtr->root)
+    return ElementPtr();
+  return ElementSnapshotPrivate::Materialize(*this->dataPtr->root);
+}
+
+/////////////////////////////////////////////////
+ElementPatch ElementSnapshot::Diff(const ElementSnapshot &_from,
+    const ElementSnapshot &_to)
+{
+  ElementPatch patch;
+  if (_from.dataPtr->root && _to.dataPtr->root &&
+      _from.dataPtr->root != _to.dataPtr->root)
+  {
+    ElementSnapshotPrivate::Diff(*_from.dataPtr->root, *_to.dataPtr->root,
+        patch);
+  }
+  return patch;
+}
+
+/////////////////////////////////////////////////
+Errors ElementSnapshot::Restore(const ElementPtr &_elem) const
+{
+  if (!_elem || !this->dataPtr->root)
+  {
+    return {Error(ErrorCode::ELEMENT_MISSING,
+        "Unable to restore a null element tree or an empty snapshot.")};
+  }
+
+  const ElementSnapshot current = Take(_elem, *this);
+  return Diff(current, *this).Apply(_elem);
+}
@@ -0,0 +1,169 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "sdf/Element.hh"
+#include "sdf/ElementSnapshot.hh"
+#include "sdf/Param.hh"
+#include "sdf/SDFImpl.hh"
+
+/////////////////////////////////////////////////
+/// \brief Parse a world with two models.
+/// \return The root element.
+static sdf::ElementPtr parseWorld()
+{
+  sdf::SDFPtr sdfParsed(new sdf::SDF());
+  sdfParsed->SetFromString(
+      "<sdf version='1.8'><world name='default'>"
+      "<model name='a'><pose>1 2 3 0 0 0</pose><link name='l'/></model>"
+      "<model name='b'><link name='l'/></model>"
+      "</world></sdf>");
+  return sdfParsed->Root()->Clone();
+}
+
+/////////////////////////////////////////////////
+TEST(ElementSnapshot, Construction)
+{
+  sdf::ElementSnapshot snapshot;
+  EXPECT_TRUE(snapshot.Empty());
+  EXPECT_EQ(nullptr, snapshot.Content());
+  EXPECT_EQ(0u, snapshot.ChildCount());
+  EXPECT_TRUE(snapshot.Child(0).Empty());
+  EXPECT_EQ(nullptr, snapshot.ToElement());
+  EXPECT_TRUE(snapshot.SameAs(sdf::ElementSnapshot()));
+  EXPECT_TRUE(sdf::ElementSnapshot::Take(nullptr).Empty());
+  EXPECT_TRUE(sdf::ElementSnapshot::Diff(snapshot, snapshot).Empty());
+
+  sdf::ElementPtr root = parseWorld();
+  ASSERT_NE(nullptr, root);
+  EXPECT_FALSE(snapshot.Restore(root).empty());
+
+  const sdf::ElementSnapshot taken = sdf::ElementSnapshot::Take(root);
+  EXPECT_FALSE(taken.Empty());
+  EXPECT_FALSE(taken.Restore(nullptr).empty());
+  EXPECT_EQ("sdf", taken.Content()->GetName());
+  ASSERT_EQ(1u, taken.ChildCount());
+  EXPECT_EQ("world", taken.Child(0).Content()->GetName());
+  EXPECT_EQ(root->ToString(""), taken.ToElement()->ToString(""));
+
+  // Copies share the snapshot.
+  sdf::ElementSnapshot copy(taken);
+  EXPECT_TRUE(copy.SameAs(taken));
+  snapshot = copy;
+  EXPECT_TRUE(snapshot.SameAs(taken));
+}
+
+/////////////////////////////////////////////////
+TEST(ElementSnapshot, Sharing)
+{
+  sdf::ElementPtr root = parseWorld();
+  ASSERT_NE(nullptr, root);
+  sdf::ElementPtr world = root->GetElementImpl("world");
+  ASSERT_NE(nullptr, world);
+  sdf::ElementPtr a = world->GetElementImpl("model");
+  ASSERT_NE(nullptr, a);
+  sdf::ElementPtr b = a->GetNextElement("model");
+  ASSERT_NE(nullptr, b);
+
+  const sdf::ElementSnapshot first = sdf::ElementSnapshot::Take(root);
+  const std::string original = root->ToString("");
+
+  // A tree that didn't change gives the same snapshot.
+  const sdf::ElementSnapshot same = sdf::ElementSnapshot::Take(root, first);
+  EXPECT_TRUE(same.SameAs(first));
+  EXPECT_TRUE(sdf::ElementSnapshot::Diff(first, same).Empty());
+
+  // Only the path to the pose is copied.
+  sdf::ElementPtr pose = a->GetElementImpl("pose");
+  ASSERT_NE(nullptr, pose);
+  ASSERT_TRUE(pose->GetValue()->SetFromString("1 2 4 0 0 0"));
+  const sdf::ElementSnapshot second = sdf::ElementSnapshot::Take(root, same);
+  EXPECT_FALSE(second.SameAs(first));
+  const sdf::ElementSnapshot worldBefore = first.Child(0);
+  const sdf::ElementSnapshot worldAfter = second.Child(0);
+  ASSERT_EQ(worldBefore.ChildCount(), worldAfter.ChildCount());
+  std::size_t shared = 0;
+  for (std::size_t i = 0; i < worldAfter.ChildCount(); ++i)
+  {
+    if (worldAfter.Child(i).SameAs(worldBefore.Child(i)))
+      ++shared;
+  }
+  EXPECT_EQ(worldAfter.ChildCount() - 1u, shared);
+
+  sdf::ElementPatch patch = sdf::ElementSnapshot::Diff(first, second);
+  ASSERT_EQ(1u, patch.OpCount());
+  EXPECT_EQ(sdf::ElementPatchOpType::MODIFY, patch.OpByIndex(0)->type);
+  sdf::ElementPtr patched = first.ToElement();
+  EXPECT_TRUE(patch.Apply(patched).empty());
+  EXPECT_EQ(root->ToString(""), patched->ToString(""));
+
+  // Every change is seen, not only the first one since ClearDirty.
+  ASSERT_TRUE(pose->GetValue()->SetFromString("1 2 5 0 0 0"));
+  const sdf::ElementSnapshot third = sdf::ElementSnapshot::Take(root,
+      second);
+  EXPECT_FALSE(third.SameAs(second));
+  EXPECT_EQ(1u, sdf::ElementSnapshot::Diff(second, third).OpCount());
+
+  // The snapshots keep their content.
+  EXPECT_EQ(original, first.ToElement()->ToString(""));
+  EXPECT_NE(std::string::npos,
+      third.ToElement()->ToString("").find("1 2 5 0 0 0"));
+}
+
+/////////////////////////////////////////////////
+TEST(ElementSnapshot, UndoRedo)
+{
+  sdf::ElementPtr root = parseWorld();
+  ASSERT_NE(nullptr, root);
+  sdf::ElementPtr world = root->GetElementImpl("world");
+  ASSERT_NE(nullptr, world);
+  sdf::ElementPtr a = world->GetElementImpl("model");
+  ASSERT_NE(nullptr, a);
+  sdf::ElementPtr b = a->GetNextElement("model");
+  ASSERT_NE(nullptr, b);
+
+  const std::string original = root->ToString("");
+  const sdf::ElementSnapshot before = sdf::ElementSnapshot::Take(root);
+
+  // Remove a model, rename the other one and add a third one.
+  world->RemoveChild(b);
+  a->GetAttribute("name")->SetFromString("renamed");
+  sdf::ElementPtr c = b->Clone();
+  c->GetAttribute("name")->SetFromString("c");
+  c->SetParent(world);
+  world->InsertElement(c);
+  const std::string edited = root->ToString("");
+  ASSERT_NE(original, edited);
+  const sdf::ElementSnapshot after =
+      sdf::ElementSnapshot::Take(root, before);
+
+  // Undo.
+  EXPECT_TRUE(before.Restore(root).empty());
+  EXPECT_EQ(original, root->ToString(""));
+  EXPECT_TRUE(sdf::ElementSnapshot::Diff(
+      sdf::ElementSnapshot::Take(root, before), before).Empty());
+
+  // Redo.
+  EXPECT_TRUE(after.Restore(root).empty());
+  EXPECT_EQ(edited, root->ToString(""));
+
+  // The model that is still in the tree kept its element.
+  EXPECT_EQ(a, world->GetElementImpl("model"));
+}
@@ -0,0 +1,209 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+#include "ElementTagIndex.hh"
+
+using namespace sdf;
+
+/// \brief Number of entries below which the index is not cleaned up.
+static const std::size_t kMinCompactSize = 1024;
+
+/////////////////////////////////////////////////
+ElementTagIndex::ElementTagIndex()
+{
+  static std::atomic<std::uint64_t> lastId{0};
+  this->id = ++lastId;
+  LiveCount().fetch_add(1, std::memory_order_relaxed);
+}
+
+/////////////////////////////////////////////////
+ElementTagIndex::~ElementTagIndex()
+{
+  LiveCount().fetch_sub(1, std::memory_order_relaxed);
+}
+
+/////////////////////////////////////////////////
+std::atomic<std::size_t> &ElementTagIndex::LiveCount()
+{
+  static std::atomic<std::size_t> count{0};
+  return count;
+}
+
+/////////////////////////////////////////////////
+void ElementTagIndex::Build(Element &_root)
+{
+  auto index = std::make_shared<ElementTagIndex>();
+  index->Add(_root, true);
+  index->compactAt = std::max(2 * index->entryCount, kMinCompactSize);
+  _root.dataPtr->tagIndex = std::move(index);
+}
+
+/////////////////////////////////////////////////
+void ElementTagIndex::Clear(Element &_root)
+{
+  _root.dataPtr->tagIndex.reset();
+}
+
+/////////////////////////////////////////////////
+ElementTagIndex *ElementTagIndex::Find(const Element &_elem)
+{
+  if (LiveCount().load(std::memory_order_relaxed) == 0)
+    return nullptr;
+
+  const Element *elem = &_elem;
+  ElementPtr ancestor;
+  while (!elem->dataPtr->tagIndex)
+  {
+    ancestor = Parent(*elem);
+    if (!ancestor)
+      return nullptr;
+    elem = ancestor.get();
+  }
+  return elem->dataPtr->tagIndex.get();
+}
+
+/////////////////////////////////////////////////
+void ElementTagIndex::Inserted(const Element &_parent, Element &_child)
+{
+  ElementTagIndex *index = Find(_parent);
+  if (index)
+    index->Add(_child, true);
+}
+
+/////////////////////////////////////////////////
+void ElementTagIndex::Renamed(Element &_elem)
+{
+  // The entry under the old name is invalidated by the new serial number.
+  _elem.dataPtr->tagIndexId = 0;
+  _elem.dataPtr->tagIndexEntry = 0;
+  ElementTagIndex *index = Find(_elem);
+  if (index)
+    index->Add(_elem, false);
+}
+
+/////////////////////////////////////////////////
+ElementPtr ElementTagIndex::Parent(const Element &_elem)
+{
+  ElementPtr parent = _elem.dataPtr->parent.lock();
+  if (!parent)
+    return nullptr;
+
+  const ElementPtr_V &siblings = parent->dataPtr->elements;
+  const std::size_t index = _elem.dataPtr->indexInParent;
+  if (index >= siblings.size() || siblings[index].get() != &_elem)
+    return nullptr;
+  return parent;
+}
+
+/////////////////////////////////////////////////
+ElementPtr_V ElementTagIndex::Tagged(const std::string &_name) const
+{
+  ElementPtr_V result;
+  auto it = this->tags.find(_name);
+  if (it == this->tags.end())
+    return result;
+
+  result.reserve(it->second.size());
+  for (const Entry &entry : it->second)
+  {
+    ElementPtr elem = this->Valid(entry);
+    if (elem)
+      result.push_back(std::move(elem));
+  }
+  return result;
+}
+
+/////////////////////////////////////////////////
+ElementPtr ElementTagIndex::Valid(const Entry &_entry) const
+{
+  ElementPtr elem = _entry.element.lock();
+  if (elem && elem->dataPtr->tagIndexId == this->id &&
+      elem->dataPtr->tagIndexEntry == _entry.serial)
+  {
+    return elem;
+  }
+  return nullptr;
+}
+
+/////////////////////////////////////////////////
+void ElementTagIndex::Add(Element &_elem, bool _descendants)
+{
+  // Children are pushed in reverse, so that elements are added in document
+  // order.
+  std::vector<Element *> stack{&_elem};
+  while (!stack.empty())
+  {
+    Element *elem = stack.back();
+    stack.pop_back();
+
+    ElementPrivate &data = *elem->dataPtr;
+    if (data.tagIndexId != this->id || data.tagIndexEntry == 0)
+    {
+      data.tagIndexId = this->id;
+      data.tagIndexEntry = ++this->serial;
+      this->tags[*data.name].push_back({elem->weak_from_this(), this->serial});
+      ++this->entryCount;
+    }
+
+    if (_descendants)
+    {
+      elem->ReadLazyChildren();
+      for (auto it = data.elements.rbegin(); it != data.elements.rend(); ++it)
+        stack.push_back(it->get());
+    }
+  }
+
+  if (this->entryCount > this->compactAt)
+    this->Compact();
+}
+
+/////////////////////////////////////////////////
+void ElementTagIndex::Compact()
+{
+  this->entryCount = 0;
+  for (auto it = this->tags.begin(); it != this->tags.end();)
+  {
+    std::vector<Entry> &entries = it->second;
+    auto end = std::remove_if(entries.begin(), entries.end(),
+        [this](const Entry &_entry)
+        {
+          ElementPtr elem = this->Valid(_entry);
+          if (!elem)
+            return true;
+          if (Find(*elem) != this)
+          {
+            // Removed elements are indexed again when they are inserted.
+            elem->dataPtr->tagIndexId = 0;
+            elem->dataPtr->tagIndexEntry = 0;
+            return true;
+          }
+          return false;
+        });
+    entries.erase(end, entries.end());
+    this->entryCount += entries.size();
+
+    if (entries.empty())
+      it = this->tags.erase(it);
+    else
+      ++it;
+  }
+  this->compactAt = std::max(2 * this->entryCount, kMinCompactSize);
+}
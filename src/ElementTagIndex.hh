@@ -0,0 +1,142 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_ELEMENT_TAG_INDEX_HH_
+#define SDF_ELEMENT_TAG_INDEX_HH_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "sdf/Element.hh"
+#include "sdf/sdf_config.h"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief Index from an element name to the elements of a tree with that
+  /// name, held by the element the index was built on.
+  /// \sa Element::BuildTagIndex
+  ///
+  /// Elements inserted into the tree are added to the index by Element.
+  /// Removing elements doesn't update the index, since elements are
+  /// removed in many ways. Instead the index holds weak pointers, and the
+  /// elements it returns must be checked with Parent as they are matched,
+  /// which queries do anyway. Renaming an element invalidates its entry
+  /// and adds a new one. Entries that are no longer valid are dropped once
+  /// the index has grown to twice its size after the last cleanup.
+  class ElementTagIndex
+  {
+    /// \brief Constructor
+    public: ElementTagIndex();
+
+    /// \brief Destructor
+    public: ~ElementTagIndex();
+
+    /// \brief Index a tree, replacing the index it had.
+    /// \param[in] _root Element to build the index on.
+    public: static void Build(Element &_root);
+
+    /// \brief Drop the index built on an element.
+    /// \param[in] _root Element the index was built on.
+    public: static void Clear(Element &_root);
+
+    /// \brief Find the index of the tree an element belongs to.
+    /// \param[in] _elem The element.
+    /// \return The index of the nearest ancestor-or-self of _elem with an
+    /// index, or nullptr if there is none.
+    public: static ElementTagIndex *Find(const Element &_elem);
+
+    /// \brief Add an element and its descendants to the index of the tree
+    /// it was inserted into, if that tree is indexed.
+    /// \param[in] _parent The element _child was inserted into.
+    /// \param[in] _child The inserted element.
+    public: static void Inserted(const Element &_parent, Element &_child);
+
+    /// \brief Index an element under its new name, if its tree is indexed.
+    /// \param[in] _elem The renamed element.
+    public: static void Renamed(Element &_elem);
+
+    /// \brief Get the parent of an element, if the element is still one of
+    /// the children of that parent.
+    /// \param[in] _elem The element.
+    /// \return The parent, or nullptr if _elem has no parent or was removed
+    /// from it.
+    public: static ElementPtr Parent(const Element &_elem);
+
+    /// \brief Get the elements indexed under a name, in the order they
+    /// were indexed. The result can hold elements that were removed from
+    /// the tree.
+    /// \param[in] _name Element name.
+    /// \return The elements.
+    public: ElementPtr_V Tagged(const std::string &_name) const;
+
+    /// \brief An element indexed under a name.
+    private: struct Entry
+    {
+      /// \brief The element.
+      ElementWeakPtr element;
+
+      /// \brief Serial number of the entry, which is valid only while the
+      /// element holds the same number.
+      std::uint64_t serial = 0;
+    };
+
+    /// \brief Check whether an entry is valid.
+    /// \param[in] _entry The entry.
+    /// \return The element of the entry if the entry is valid, else
+    /// nullptr.
+    private: ElementPtr Valid(const Entry &_entry) const;
+
+    /// \brief Add elements that are not indexed yet, in document order.
+    /// \param[in] _elem The element to add.
+    /// \param[in] _descendants Whether to add the descendants of _elem.
+    private: void Add(Element &_elem, bool _descendants);
+
+    /// \brief Drop the entries of elements that are no longer in the
+    /// indexed tree.
+    private: void Compact();
+
+    /// \brief Number of indices alive in the process, so that trees are
+    /// not searched for an index when there is none.
+    /// \return Reference to the count.
+    private: static std::atomic<std::size_t> &LiveCount();
+
+    /// \brief Identifier of this index, stored by the elements it holds so
+    /// that they are not added twice.
+    private: std::uint64_t id = 0;
+
+    /// \brief Serial number of the last entry.
+    private: std::uint64_t serial = 0;
+
+    /// \brief The indexed elements by name.
+    private: std::unordered_map<std::string, std::vector<Entry>> tags;
+
+    /// \brief Number of entries in tags.
+    private: std::size_t entryCount = 0;
+
+    /// \brief Number of entries from which Compact is called.
+    private: std::size_t compactAt = 0;
+  };
+  }
+}
+#endif
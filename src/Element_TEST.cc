@@ -17,9 +17,21 @@
 
 #include <gtest/gtest.h>
 
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
 #include "sdf/Element.hh"
 #include "sdf/Filesystem.hh"
 #include "sdf/Param.hh"
+#include "sdf/ParserConfig.hh"
+#include "sdf/SDFImpl.hh"
+#include "sdf/parser.hh"
+
+#include "ContentHash.hh"
 
 /////////////////////////////////////////////////
 TEST(Element, New)
@@ -72,6 +84,35 @@ TEST(Element, Required)
   ASSERT_EQ(elem.GetRequired(), "1");
 }
 
+/////////////////////////////////////////////////
+TEST(Element, SharedIdentifiers)
+{
+  sdf::ElementPtr a(new sdf::Element);
+  sdf::ElementPtr b(new sdf::Element);
+  EXPECT_EQ(&a->GetName(), &b->GetName());
+
+  // Elements and params with the same identifiers share one copy of them.
+  a->SetName("shared_identifier");
+  b->SetName(std::string("shared_") + "identifier");
+  EXPECT_EQ(&a->GetName(), &b->GetName());
+  b->SetName("other_identifier");
+  EXPECT_NE(&a->GetName(), &b->GetName());
+
+  a->SetRequired("*");
+  b->SetRequired("*");
+  EXPECT_EQ(&a->GetRequired(), &b->GetRequired());
+
+  a->AddAttribute("shared_key", "string", "", false);
+  b->AddAttribute("shared_key", "string", "", false);
+  EXPECT_EQ(&a->GetAttribute("shared_key")->GetKey(),
+      &b->GetAttribute("shared_key")->GetKey());
+  EXPECT_EQ(&a->GetAttribute("shared_key")->GetTypeName(),
+      &b->GetAttribute("shared_key")->GetTypeName());
+
+  sdf::ElementPtr clone = a->Clone();
+  EXPECT_EQ(&a->GetName(), &clone->GetName());
+}
+
 /////////////////////////////////////////////////
 TEST(Element, CopyChildren)
 {
@@ -153,6 +194,23 @@ TEST(Element, GetAttributeSet)
   EXPECT_TRUE(elem.GetAttributeSet("test"));
 }
 
+/////////////////////////////////////////////////
+TEST(Element, GetAttributeStringView)
+{
+  sdf::Element elem;
+  elem.AddAttribute("test", "string", "foo", false, "foo description");
+
+  // The key does not need to be null terminated.
+  const std::string_view keys = "testing";
+  sdf::ParamPtr param = elem.GetAttribute(keys.substr(0, 4));
+  ASSERT_NE(nullptr, param);
+  EXPECT_EQ(param->GetKey(), "test");
+
+  EXPECT_EQ(nullptr, elem.GetAttribute(keys));
+  EXPECT_EQ(nullptr, elem.GetAttribute(keys.substr(0, 3)));
+  EXPECT_EQ(nullptr, elem.GetAttribute(std::string_view()));
+}
+
 /////////////////////////////////////////////////
 TEST(Element, Include)
 {
@@ -255,6 +313,84 @@ TEST(Element, GetTemplates)
   ASSERT_EQ(found, true);
 }
 
+/////////////////////////////////////////////////
+TEST(Element, GetKeyLookup)
+{
+  sdf::ElementPtr desc = std::make_shared<sdf::Element>();
+  desc->SetName("mass");
+  desc->AddValue("double", "1.5", false);
+
+  sdf::ElementPtr elem = std::make_shared<sdf::Element>();
+  elem->SetName("inertial");
+  elem->AddAttribute("name", "string", "default", false);
+  elem->AddElementDescription(desc);
+
+  // Element descriptions give the default value of missing children.
+  const std::string_view massKey = "mass";
+  EXPECT_DOUBLE_EQ(1.5, elem->Get<double>(massKey));
+  EXPECT_FALSE(elem->HasElement("mass"));
+
+  // Children take precedence over their description.
+  elem->GetElement("mass")->Set(2.5);
+  EXPECT_DOUBLE_EQ(2.5, elem->Get<double>(massKey));
+  EXPECT_DOUBLE_EQ(2.5, elem->Get<double>(std::string("mass")));
+
+  // Attributes take precedence over children.
+  EXPECT_EQ("default", elem->Get<std::string>("name"));
+
+  std::pair<double, bool> missing = elem->Get<double>("missing", 7.0);
+  EXPECT_DOUBLE_EQ(7.0, missing.first);
+  EXPECT_FALSE(missing.second);
+
+  // Keys are also found in indexed children.
+  for (int i = 0; i < 40; ++i)
+  {
+    sdf::ElementPtr child = std::make_shared<sdf::Element>();
+    child->SetName("child" + std::to_string(i));
+    child->AddValue("int", "0", false);
+    child->Set(i);
+    elem->InsertElement(child);
+  }
+  EXPECT_EQ(33, elem->Get<int>("child33"));
+  EXPECT_DOUBLE_EQ(2.5, elem->Get<double>("mass"));
+  EXPECT_FALSE(elem->Get<int>("child40", 0).second);
+}
+
+/////////////////////////////////////////////////
+TEST(Element, GetElementOrDefault)
+{
+  sdf::ElementPtr range = std::make_shared<sdf::Element>();
+  range->SetName("range");
+  range->AddValue("double", "10", false);
+
+  sdf::ElementPtr desc = std::make_shared<sdf::Element>();
+  desc->SetName("attenuation");
+  desc->AddElementDescription(range);
+
+  sdf::ElementPtr elem = std::make_shared<sdf::Element>();
+  elem->SetName("light");
+  elem->AddElementDescription(desc);
+
+  // A missing child gives its description, and nothing is added.
+  sdf::ElementConstPtr attenuation = elem->GetElementOrDefault("attenuation");
+  ASSERT_NE(nullptr, attenuation);
+  EXPECT_EQ(desc, attenuation);
+  EXPECT_DOUBLE_EQ(10.0, attenuation->Get<double>("range"));
+  EXPECT_FALSE(elem->HasElement("attenuation"));
+  EXPECT_EQ(nullptr, elem->GetFirstElement());
+  EXPECT_FALSE(attenuation->HasElement("range"));
+
+  EXPECT_EQ(nullptr, elem->GetElementOrDefault("spot"));
+
+  // An existing child is returned.
+  elem->GetElement("attenuation")->GetElement("range")->Set(2.0);
+  attenuation = elem->GetElementOrDefault("attenuation");
+  EXPECT_NE(desc, attenuation);
+  EXPECT_EQ(elem->GetFirstElement(), attenuation);
+  EXPECT_DOUBLE_EQ(2.0, attenuation->Get<double>("range"));
+  EXPECT_DOUBLE_EQ(10.0, desc->Get<double>("range"));
+}
+
 /////////////////////////////////////////////////
 TEST(Element, Clone)
 {
@@ -285,6 +421,81 @@ TEST(Element, Clone)
   ASSERT_EQ(newelem->GetAttributeCount(), 1UL);
 }
 
+/////////////////////////////////////////////////
+TEST(Element, CloneManyChildren)
+{
+  // Enough children and attributes for the name indices to be used.
+  sdf::ElementPtr parent = std::make_shared<sdf::Element>();
+  for (int i = 0; i < 40; ++i)
+  {
+    sdf::ElementPtr child = std::make_shared<sdf::Element>();
+    child->SetName("child_" + std::to_string(i));
+    parent->InsertElement(child);
+    parent->AddAttribute("attr_" + std::to_string(i), "int",
+                         std::to_string(i), false);
+  }
+
+  sdf::ElementPtr clone = parent->Clone();
+  ASSERT_TRUE(clone->HasElement("child_39"));
+  EXPECT_EQ(clone, clone->GetElement("child_39")->GetParent());
+  EXPECT_NE(parent->GetElement("child_39"), clone->GetElement("child_39"));
+  EXPECT_EQ(39, clone->Get<int>("attr_39"));
+
+  // Changes to the clone leave the original untouched.
+  clone->GetAttribute("attr_39")->Set(100);
+  clone->RemoveChild(clone->GetElement("child_10"));
+  EXPECT_FALSE(clone->HasElement("child_10"));
+  EXPECT_TRUE(clone->HasElement("child_11"));
+  EXPECT_TRUE(parent->HasElement("child_10"));
+  EXPECT_EQ(39, parent->Get<int>("attr_39"));
+  EXPECT_EQ(100, clone->Get<int>("attr_39"));
+}
+
+/////////////////////////////////////////////////
+TEST(Element, CloneSharesDescriptions)
+{
+  sdf::ElementPtr parent = std::make_shared<sdf::Element>();
+  parent->SetName("parent");
+  parent->SetDescription("parent description");
+  sdf::ElementPtr desc = std::make_shared<sdf::Element>();
+  desc->SetName("child");
+  desc->SetRequired("1");
+  desc->AddValue("string", "foo", false, "child description");
+  parent->AddElementDescription(desc);
+
+  // Clones and copies point to the same descriptions.
+  sdf::ElementPtr clone = parent->Clone();
+  EXPECT_EQ(desc, clone->GetElementDescription("child"));
+  sdf::ElementPtr copy = std::make_shared<sdf::Element>();
+  copy->Copy(parent);
+  EXPECT_EQ(desc, copy->GetElementDescription(0));
+  EXPECT_EQ("parent description", copy->GetDescription());
+
+  // Instances only copy their own data.
+  sdf::ElementPtr child = clone->AddElement("child");
+  ASSERT_NE(nullptr, child);
+  child->GetValue()->Set<std::string>("bar");
+  EXPECT_EQ("foo", desc->GetValue()->GetAsString());
+
+  // Modifying the descriptions of one element does not affect the others.
+  sdf::ElementPtr extra = std::make_shared<sdf::Element>();
+  extra->SetName("extra");
+  clone->AddElementDescription(extra);
+  clone->SetDescription("clone description");
+  EXPECT_EQ(2u, clone->GetElementDescriptionCount());
+  EXPECT_EQ(1u, parent->GetElementDescriptionCount());
+  EXPECT_EQ(1u, copy->GetElementDescriptionCount());
+  EXPECT_EQ("parent description", parent->GetDescription());
+  EXPECT_EQ("clone description", clone->GetDescription());
+
+  // Reset releases the descriptions without resetting them.
+  clone->Reset();
+  EXPECT_EQ(0u, clone->GetElementDescriptionCount());
+  EXPECT_TRUE(clone->GetDescription().empty());
+  EXPECT_EQ(1u, parent->GetElementDescriptionCount());
+  EXPECT_NE(nullptr, desc->GetValue());
+}
+
 /////////////////////////////////////////////////
 TEST(Element, ClearElements)
 {
@@ -368,6 +579,45 @@ TEST(Element, ToStringElements)
     "<!-- prefix --></parent>\n");
 }
 
+/////////////////////////////////////////////////
+TEST(Element, ToStream)
+{
+  sdf::ElementPtr parent = std::make_shared<sdf::Element>();
+  sdf::ElementPtr child = std::make_shared<sdf::Element>();
+  sdf::ElementPtr grandchild = std::make_shared<sdf::Element>();
+  parent->SetName("parent");
+  child->SetName("child");
+  grandchild->SetName("grandchild");
+  grandchild->AddValue("double", "1.5", false);
+  parent->AddAttribute("test", "string", "foo", true);
+  parent->InsertElement(child);
+  child->InsertElement(grandchild);
+
+  std::ostringstream stream;
+  parent->ToStream(stream);
+  EXPECT_EQ(parent->ToString(""), stream.str());
+
+  stream.str("");
+  parent->ToStream(stream, 40);
+  const std::string indent(40, ' ');
+  EXPECT_EQ(indent + "<parent test='foo'>\n" +
+            indent + "  <child>\n" +
+            indent + "    <grandchild>1.5</grandchild>\n" +
+            indent + "  </child>\n" +
+            indent + "</parent>\n", stream.str());
+
+  stream.str("");
+  parent->ToStream(stream, 4, true);
+  EXPECT_EQ("<parent test='foo'><child><grandchild>1.5</grandchild></child>"
+            "</parent>", stream.str());
+
+  child->SetInclude("model.sdf");
+  stream.str("");
+  parent->ToStream(stream, 0, true);
+  EXPECT_EQ("<parent test='foo'><include filename='model.sdf'/></parent>",
+            stream.str());
+}
+
 /////////////////////////////////////////////////
 TEST(Element, ToStringRequiredAttributes)
 {
@@ -629,6 +879,51 @@ TEST(Element, GetNextElementMultiple)
   ASSERT_EQ(child2->GetNextElement(""), nullptr);
 }
 
+/////////////////////////////////////////////////
+TEST(Element, GetNextElementAfterRemoval)
+{
+  sdf::ElementPtr parent = std::make_shared<sdf::Element>();
+  std::vector<sdf::ElementPtr> children;
+  for (int i = 0; i < 10; ++i)
+  {
+    sdf::ElementPtr child = std::make_shared<sdf::Element>();
+    child->SetName(i % 2 == 0 ? "even" : "odd");
+    child->SetParent(parent);
+    parent->InsertElement(child);
+    children.push_back(child);
+  }
+
+  EXPECT_EQ(children[1], children[0]->GetNextElement());
+  EXPECT_EQ(children[2], children[0]->GetNextElement("even"));
+  EXPECT_EQ(children[3], children[0]->GetNextElement("odd"));
+  EXPECT_EQ(nullptr, children[8]->GetNextElement("even"));
+  EXPECT_EQ(children[9], children[8]->GetNextElement("odd"));
+  EXPECT_EQ(nullptr, children[9]->GetNextElement());
+
+  // Siblings after a removed element are still found.
+  parent->RemoveChild(children[2]);
+  EXPECT_EQ(children[4], children[0]->GetNextElement("even"));
+  EXPECT_EQ(children[3], children[1]->GetNextElement());
+  children[5]->RemoveFromParent();
+  EXPECT_EQ(children[6], children[4]->GetNextElement());
+  EXPECT_EQ(children[7], children[3]->GetNextElement("odd"));
+
+  int evenCount = 0;
+  for (sdf::ElementPtr elem = parent->GetElementImpl("even"); elem;
+       elem = elem->GetNextElement("even"))
+  {
+    ++evenCount;
+  }
+  EXPECT_EQ(4, evenCount);
+
+  // An element inserted into an element other than its parent is found by
+  // searching the parent.
+  sdf::ElementPtr other = std::make_shared<sdf::Element>();
+  other->InsertElement(std::make_shared<sdf::Element>());
+  other->InsertElement(children[0]);
+  EXPECT_EQ(children[1], children[0]->GetNextElement());
+}
+
 /////////////////////////////////////////////////
 TEST(Element, CountNamedElements)
 {
@@ -689,6 +984,9 @@ TEST(Element, CountNamedElements)
   EXPECT_FALSE(parent->HasUniqueChildNames(""));
 
   EXPECT_TRUE(parent->CountNamedElements("empty").empty());
+  EXPECT_EQ(0u, parent->CountChildren("empty"));
+  EXPECT_EQ(2u, parent->CountChildren("child"));
+  EXPECT_EQ(3u, parent->CountChildren("element"));
 
   auto childMap = parent->CountNamedElements("child");
   EXPECT_FALSE(childMap.empty());
@@ -718,6 +1016,571 @@ TEST(Element, CountNamedElements)
   EXPECT_EQ(allMap.at("child3"), 1u);
 }
 
+/////////////////////////////////////////////////
+TEST(Element, UniqueChildNamesCache)
+{
+  sdf::ElementPtr parent = std::make_shared<sdf::Element>();
+  auto addChild = [&parent](const std::string &_name)
+  {
+    sdf::ElementPtr child = std::make_shared<sdf::Element>();
+    child->SetParent(parent);
+    child->SetName("child");
+    parent->InsertElement(child);
+    child->AddAttribute("name", "string", _name, false, "description");
+    return child;
+  };
+
+  addChild("a");
+  sdf::ElementPtr b = addChild("b");
+  EXPECT_TRUE(parent->HasUniqueChildNames());
+
+  // Renaming a child updates the cached result of its parent.
+  ASSERT_TRUE(b->GetAttribute("name")->Set<std::string>("a"));
+  EXPECT_FALSE(parent->HasUniqueChildNames());
+  EXPECT_FALSE(parent->HasUniqueChildNames("child"));
+  EXPECT_TRUE(parent->HasUniqueChildNames("other"));
+  ASSERT_TRUE(b->GetAttribute("name")->Set<std::string>("b"));
+  EXPECT_TRUE(parent->HasUniqueChildNames());
+
+  // So do inserted and removed children.
+  sdf::ElementPtr duplicate = addChild("b");
+  EXPECT_FALSE(parent->HasUniqueChildNames());
+  sdf::ElementPtr clone = parent->Clone();
+  EXPECT_FALSE(clone->HasUniqueChildNames());
+  parent->RemoveChild(duplicate);
+  EXPECT_TRUE(parent->HasUniqueChildNames());
+  EXPECT_FALSE(clone->HasUniqueChildNames());
+}
+
+/////////////////////////////////////////////////
+TEST(Element, NameLookupManyChildren)
+{
+  sdf::ElementPtr parent = std::make_shared<sdf::Element>();
+  parent->SetName("parent");
+
+  // Enough children, descriptions and attributes to use the name indices.
+  const int count = 100;
+  for (int i = 0; i < count; ++i)
+  {
+    const std::string name = "child" + std::to_string(i % (count / 2));
+    sdf::ElementPtr child = std::make_shared<sdf::Element>();
+    child->SetName(name);
+    child->AddAttribute("index", "int", std::to_string(i), false);
+    child->SetParent(parent);
+    parent->InsertElement(child);
+
+    sdf::ElementPtr desc = std::make_shared<sdf::Element>();
+    desc->SetName("desc" + std::to_string(i));
+    parent->AddElementDescription(desc);
+
+    parent->AddAttribute("attr" + std::to_string(i), "string", "", false);
+  }
+
+  // The first child with a duplicated name is returned.
+  ASSERT_TRUE(parent->HasElement("child7"));
+  EXPECT_EQ(7, parent->GetElementImpl("child7")->Get<int>("index"));
+  EXPECT_FALSE(parent->HasElement("child50"));
+  EXPECT_TRUE(parent->HasElementDescription("desc99"));
+  EXPECT_FALSE(parent->HasElementDescription("desc100"));
+  EXPECT_TRUE(parent->HasAttribute("attr42"));
+  EXPECT_EQ("attr42", parent->GetAttribute("attr42")->GetKey());
+  EXPECT_FALSE(parent->HasAttribute("attr100"));
+  EXPECT_EQ(2u, parent->CountChildren("child7"));
+  EXPECT_EQ(0u, parent->CountChildren("child50"));
+
+  // Removing the first child makes the next one with that name visible.
+  parent->RemoveChild(parent->GetElementImpl("child7"));
+  ASSERT_TRUE(parent->HasElement("child7"));
+  EXPECT_EQ(57, parent->GetElementImpl("child7")->Get<int>("index"));
+  parent->GetElementImpl("child7")->RemoveFromParent();
+  EXPECT_FALSE(parent->HasElement("child7"));
+  EXPECT_EQ(0u, parent->CountChildren("child7"));
+
+  // Renaming a child is reflected in its parent.
+  parent->GetElementImpl("child8")->SetName("renamed");
+  EXPECT_TRUE(parent->HasElement("renamed"));
+  EXPECT_EQ(8, parent->GetElementImpl("renamed")->Get<int>("index"));
+  EXPECT_EQ(58, parent->GetElementImpl("child8")->Get<int>("index"));
+  EXPECT_EQ(1u, parent->CountChildren("renamed"));
+  EXPECT_EQ(1u, parent->CountChildren("child8"));
+
+  // Clones have their own indices.
+  sdf::ElementPtr clone = parent->Clone();
+  EXPECT_TRUE(clone->HasElement("renamed"));
+  EXPECT_NE(parent->GetElementImpl("renamed"),
+            clone->GetElementImpl("renamed"));
+  EXPECT_TRUE(clone->HasElementDescription("desc50"));
+  EXPECT_TRUE(clone->HasAttribute("attr50"));
+  EXPECT_EQ(2u, clone->CountChildren("child9"));
+
+  parent->ClearElements();
+  EXPECT_FALSE(parent->HasElement("child0"));
+  EXPECT_EQ(nullptr, parent->GetFirstElement());
+  EXPECT_EQ(0u, parent->CountChildren("child9"));
+}
+
+/////////////////////////////////////////////////
+TEST(Element, Children)
+{
+  sdf::ElementPtr parent = std::make_shared<sdf::Element>();
+  parent->SetName("parent");
+  parent->AddValue("string", "text", false);
+  parent->AddAttribute("name", "string", "p", false);
+  EXPECT_TRUE(parent->Children().empty());
+  EXPECT_EQ(nullptr, parent->FindElement("a"));
+  EXPECT_EQ(parent->GetValue().get(), parent->FindValue());
+  EXPECT_EQ(parent->GetAttribute("name").get(),
+      parent->FindAttribute("name"));
+  EXPECT_EQ(nullptr, parent->FindAttribute("missing"));
+  ASSERT_EQ(1u, parent->Attributes().size());
+  EXPECT_EQ("name", parent->Attributes()[0]->GetKey());
+
+  // Enough children to look the first of a name up in the name index.
+  const int count = 40;
+  for (int i = 0; i < count; ++i)
+  {
+    sdf::ElementPtr child = std::make_shared<sdf::Element>();
+    child->SetName(i % 4 == 0 ? "a" : "b");
+    child->AddAttribute("index", "int", std::to_string(i), false);
+    child->SetParent(parent);
+    parent->InsertElement(child);
+  }
+
+  int visited = 0;
+  for (const sdf::Element &child : parent->Children())
+  {
+    EXPECT_EQ(visited, child.Get<int>("index"));
+    EXPECT_EQ(parent.get(), child.GetParent().get());
+    ++visited;
+  }
+  EXPECT_EQ(count, visited);
+
+  // A temporary name doesn't need to outlive the range.
+  std::vector<int> indices;
+  for (const sdf::Element &child : parent->Children(std::string("a")))
+    indices.push_back(child.Get<int>("index"));
+  ASSERT_EQ(10u, indices.size());
+  for (std::size_t i = 0; i < indices.size(); ++i)
+    EXPECT_EQ(static_cast<int>(i) * 4, indices[i]);
+
+  EXPECT_TRUE(parent->Children("c").empty());
+  EXPECT_FALSE(parent->Children("b").empty());
+  EXPECT_EQ(1, parent->Children("b").begin()->Get<int>("index"));
+
+  const sdf::Element *first = parent->FindElement("b");
+  ASSERT_NE(nullptr, first);
+  EXPECT_EQ(parent->GetElementImpl("b").get(), first);
+  ASSERT_NE(nullptr, first->FindAttribute("index"));
+  EXPECT_EQ("1", first->FindAttribute("index")->GetAsString());
+
+  // The walk matches GetFirstElement and GetNextElement.
+  sdf::ElementPtr elem = parent->GetElementImpl("b");
+  for (const sdf::Element &child : parent->Children("b"))
+  {
+    ASSERT_NE(nullptr, elem);
+    EXPECT_EQ(elem.get(), &child);
+    elem = elem->GetNextElement("b");
+  }
+  EXPECT_EQ(nullptr, elem);
+}
+
+/////////////////////////////////////////////////
+TEST(Element, DeepTree)
+{
+  // A chain of nested elements, each with a value at the bottom.
+  const int depth = 2000;
+  sdf::ElementPtr root = std::make_shared<sdf::Element>();
+  root->SetName("e");
+  sdf::ElementPtr elem = root;
+  for (int i = 1; i < depth; ++i)
+  {
+    sdf::ElementPtr child = std::make_shared<sdf::Element>();
+    child->SetName("e");
+    child->SetParent(elem);
+    elem->InsertElement(child);
+    elem = child;
+  }
+  elem->AddValue("int", "7", false);
+
+  sdf::ElementPtr clone = root->Clone();
+  int cloneDepth = 1;
+  elem = clone;
+  while (elem->GetFirstElement())
+  {
+    EXPECT_EQ(elem, elem->GetFirstElement()->GetParent());
+    elem = elem->GetFirstElement();
+    ++cloneDepth;
+  }
+  EXPECT_EQ(depth, cloneDepth);
+  EXPECT_EQ(7, elem->Get<int>());
+
+  std::string expected;
+  for (int i = 0; i < depth - 1; ++i)
+    expected += "<e>";
+  expected += "<e>7</e>";
+  for (int i = 0; i < depth - 1; ++i)
+    expected += "</e>";
+  std::ostringstream stream;
+  clone->ToStream(stream, 0, true);
+  EXPECT_EQ(expected, stream.str());
+}
+
+/////////////////////////////////////////////////
+TEST(Element, VisitAttributes)
+{
+  sdf::ElementPtr parent = std::make_shared<sdf::Element>();
+  parent->SetName("parent");
+  parent->AddAttribute("name", "string", "p", false);
+  sdf::ElementPtr child = std::make_shared<sdf::Element>();
+  child->SetName("child");
+  child->AddValue("double", "1.5", false);
+  child->AddAttribute("index", "int", "2", false);
+  child->SetParent(parent);
+  parent->InsertElement(child);
+  sdf::ElementPtr sibling = std::make_shared<sdf::Element>();
+  sibling->SetName("sibling");
+  sibling->AddValue("pose", "1 2 3 0 0 0", false);
+  sibling->SetParent(parent);
+  parent->InsertElement(sibling);
+
+  std::vector<std::string> visited;
+  double sum = 0;
+  parent->VisitAttributes(
+      [&](const sdf::Element &_elem, const sdf::Param &_param,
+          const auto &_value)
+      {
+        visited.push_back(_elem.GetName() + ":" + _param.GetKey());
+        using T = std::decay_t<decltype(_value)>;
+        if constexpr (std::is_same_v<T, double>)
+          sum += _value;
+        else if constexpr (std::is_same_v<T, int>)
+          sum += _value;
+        else if constexpr (std::is_same_v<T, ignition::math::Pose3d>)
+          sum += _value.Pos().Z();
+      });
+
+  const std::vector<std::string> expected{"parent:name", "child:child",
+      "child:index", "sibling:sibling"};
+  EXPECT_EQ(expected, visited);
+  EXPECT_DOUBLE_EQ(6.5, sum);
+
+  // Only the subtree of an element is visited.
+  visited.clear();
+  child->VisitAttributes(
+      [&](const sdf::Element &, const sdf::Param &_param, const auto &)
+      {
+        visited.push_back(_param.GetKey());
+      });
+  EXPECT_EQ(2u, visited.size());
+}
+
+/////////////////////////////////////////////////
+TEST(Element, ContentHash)
+{
+  auto makeTree = []()
+  {
+    sdf::ElementPtr parent = std::make_shared<sdf::Element>();
+    parent->SetName("parent");
+    parent->AddAttribute("name", "string", "p", false);
+    parent->GetAttribute("name")->SetFromString("first");
+    for (const char *name : {"a", "b"})
+    {
+      sdf::ElementPtr child = std::make_shared<sdf::Element>();
+      child->SetName(name);
+      child->AddValue("double", "1.5", false);
+      child->SetParent(parent);
+      parent->InsertElement(child);
+    }
+    return parent;
+  };
+
+  sdf::ElementPtr tree = makeTree();
+  sdf::ElementPtr other = makeTree();
+  const std::uint64_t hash = tree->ContentHash();
+  EXPECT_EQ(hash, tree->ContentHash());
+  EXPECT_EQ(hash, other->ContentHash());
+  EXPECT_EQ(hash, tree->Clone()->ContentHash());
+  EXPECT_NE(hash, tree->GetFirstElement()->ContentHash());
+
+  // Changing a value anywhere in the tree changes the hash, and changing
+  // it back restores it.
+  sdf::ElementPtr b = other->GetElement("b");
+  b->GetValue()->SetFromString("2.5");
+  EXPECT_NE(hash, other->ContentHash());
+  b->GetValue()->SetFromString("1.5");
+  EXPECT_EQ(hash, other->ContentHash());
+
+  // Attributes that are not set are not part of the content.
+  other->AddAttribute("unset", "int", "0", false);
+  EXPECT_EQ(hash, other->ContentHash());
+  other->GetAttribute("unset")->SetFromString("3");
+  EXPECT_NE(hash, other->ContentHash());
+  other->GetAttribute("unset")->Reset();
+  EXPECT_EQ(hash, other->ContentHash());
+
+  // Renaming, adding and removing children update the cached hashes of
+  // the ancestors.
+  b->SetName("c");
+  EXPECT_NE(hash, other->ContentHash());
+  b->SetName("b");
+  EXPECT_EQ(hash, other->ContentHash());
+
+  sdf::ElementPtr grandchild = std::make_shared<sdf::Element>();
+  grandchild->SetName("g");
+  grandchild->SetParent(b);
+  b->InsertElement(grandchild);
+  EXPECT_NE(hash, other->ContentHash());
+  b->RemoveChild(grandchild);
+  EXPECT_EQ(hash, other->ContentHash());
+
+  // The order of the children is part of the content.
+  sdf::ElementPtr a = other->GetElement("a");
+  a->RemoveFromParent();
+  EXPECT_NE(hash, other->ContentHash());
+  a->SetParent(other);
+  other->InsertElement(a);
+  EXPECT_NE(hash, other->ContentHash());
+
+  other->ClearElements();
+  EXPECT_NE(hash, other->ContentHash());
+  other->Copy(tree);
+  EXPECT_EQ(hash, other->ContentHash());
+}
+
+/////////////////////////////////////////////////
+TEST(Element, ContentHashKeptByUnrelatedChange)
+{
+  auto makeTree = []()
+  {
+    sdf::ElementPtr parent = std::make_shared<sdf::Element>();
+    parent->SetName("parent");
+    for (const char *name : {"a", "b"})
+    {
+      sdf::ElementPtr child = std::make_shared<sdf::Element>();
+      child->SetName(name);
+      child->AddValue("double", "1.5", false);
+      child->SetParent(parent);
+      parent->InsertElement(child);
+    }
+    return parent;
+  };
+
+  sdf::ElementPtr tree = makeTree();
+  sdf::ElementPtr other = makeTree();
+  const std::uint64_t hash = tree->ContentHash();
+  EXPECT_EQ(hash, other->ContentHash());
+
+  // A change in another tree doesn't drop the cached hashes of this one.
+  other->GetElement("b")->GetValue()->Set(2.5);
+  std::uint64_t computed = sdf::ContentHashCount::Get();
+  EXPECT_EQ(hash, tree->ContentHash());
+  EXPECT_EQ(computed, sdf::ContentHashCount::Get());
+
+  // Only the changed element and its ancestors are hashed again.
+  EXPECT_NE(hash, other->ContentHash());
+  EXPECT_EQ(computed + 2u, sdf::ContentHashCount::Get());
+
+  computed = sdf::ContentHashCount::Get();
+  other->GetElement("a")->GetValue()->SetFromString("1.5");
+  EXPECT_NE(hash, other->ContentHash());
+  EXPECT_EQ(computed + 2u, sdf::ContentHashCount::Get());
+}
+
+/////////////////////////////////////////////////
+TEST(Element, Dirty)
+{
+  sdf::ElementPtr parent = std::make_shared<sdf::Element>();
+  parent->SetName("model");
+  parent->AddAttribute("name", "string", "", false);
+  parent->GetAttribute("name")->SetFromString("box");
+  for (const char *name : {"a", "b"})
+  {
+    sdf::ElementPtr child = std::make_shared<sdf::Element>();
+    child->SetName(name);
+    child->AddAttribute("name", "string", "", false);
+    child->GetAttribute("name")->SetFromString(name);
+    child->AddAttribute("type", "string", "fixed", false);
+    child->AddValue("double", "1.5", false);
+    child->SetParent(parent);
+    parent->InsertElement(child);
+  }
+
+  // Setting the names made the tree dirty.
+  EXPECT_TRUE(parent->Dirty());
+  EXPECT_FALSE(parent->DirtyToString("").empty());
+  parent->ClearDirty();
+  EXPECT_FALSE(parent->Dirty());
+  EXPECT_FALSE(parent->GetElement("a")->Dirty());
+  EXPECT_FALSE(parent->GetElement("a")->GetAttribute("name")->Dirty());
+  EXPECT_EQ("", parent->DirtyToString(""));
+
+  // A change is propagated to the ancestors, and only the changed
+  // parameters are written, with the names of the elements on the way.
+  sdf::ElementPtr b = parent->GetElement("b");
+  b->GetValue()->Set(2.5);
+  EXPECT_TRUE(b->Dirty());
+  EXPECT_TRUE(parent->Dirty());
+  EXPECT_FALSE(parent->GetElement("a")->Dirty());
+  EXPECT_EQ("<model name='box'>\n"
+            "  <b name='b'>2.5</b>\n"
+            "</model>\n", parent->DirtyToString(""));
+
+  b->GetAttribute("type")->SetFromString("revolute");
+  std::ostringstream stream;
+  b->DirtyToStream(stream, 0, true);
+  EXPECT_EQ("<b name='b' type='revolute'>2.5</b>", stream.str());
+
+  // Clones have the same flags, and clearing a subtree leaves the
+  // ancestors of the subtree dirty.
+  sdf::ElementPtr clone = parent->Clone();
+  EXPECT_TRUE(clone->GetElement("b")->Dirty());
+  EXPECT_FALSE(clone->GetElement("a")->Dirty());
+  clone->GetElement("b")->ClearDirty();
+  EXPECT_TRUE(clone->Dirty());
+  EXPECT_TRUE(parent->GetElement("b")->Dirty());
+  EXPECT_EQ("<model name='box'/>\n", clone->DirtyToString(""));
+
+  clone->GetElement("a")->GetValue()->Set(0.5);
+  EXPECT_TRUE(clone->GetElement("a")->Dirty());
+  EXPECT_EQ("<model name='box'>\n"
+            "  <a name='a'>0.5</a>\n"
+            "</model>\n", clone->DirtyToString(""));
+}
+
+/////////////////////////////////////////////////
+TEST(Element, Instantiate)
+{
+  sdf::ElementPtr desc = std::make_shared<sdf::Element>();
+  desc->SetName("link");
+  desc->SetRequired("*");
+  desc->AddAttribute("name", "string", "__default__", true);
+  desc->AddValue("double", "1.5", false);
+  sdf::ElementPtr visualDesc = std::make_shared<sdf::Element>();
+  visualDesc->SetName("visual");
+  desc->AddElementDescription(visualDesc);
+
+  // Children of the description are not instantiated with it.
+  sdf::ElementPtr child = std::make_shared<sdf::Element>();
+  child->SetName("visual");
+  child->SetParent(desc);
+  desc->InsertElement(child);
+  desc->GetValue()->Set(2.5);
+
+  sdf::ElementPtr elem = desc->Instantiate();
+  EXPECT_EQ("link", elem->GetName());
+  EXPECT_EQ("*", elem->GetRequired());
+  EXPECT_EQ(nullptr, elem->GetParent());
+  EXPECT_EQ(nullptr, elem->GetFirstElement());
+  EXPECT_FALSE(elem->Dirty());
+  EXPECT_DOUBLE_EQ(2.5, elem->Get<double>());
+
+  // The child descriptions are shared, the parameters are not.
+  ASSERT_EQ(1u, elem->GetElementDescriptionCount());
+  EXPECT_EQ(visualDesc, elem->GetElementDescription(0));
+  elem->GetAttribute("name")->Set(std::string("l"));
+  EXPECT_EQ("__default__", desc->GetAttribute("name")->GetAsString());
+
+  sdf::ElementPtr visual = elem->AddElement("visual");
+  ASSERT_NE(nullptr, visual);
+  EXPECT_EQ(elem, visual->GetParent());
+  EXPECT_EQ(1u, elem->CountChildren("visual"));
+  EXPECT_EQ(1u, desc->CountChildren("visual"));
+}
+
+/////////////////////////////////////////////////
+TEST(Element, ParallelClone)
+{
+  auto addChild = [](const sdf::ElementPtr &_parent, const std::string &_name)
+  {
+    sdf::ElementPtr child = std::make_shared<sdf::Element>();
+    child->SetName(_name);
+    child->SetParent(_parent);
+    _parent->InsertElement(child);
+    return child;
+  };
+
+  // Wide subtrees of different sizes, and a deep one.
+  sdf::ElementPtr root = std::make_shared<sdf::Element>();
+  root->SetName("world");
+  for (int i = 0; i < 20; ++i)
+  {
+    sdf::ElementPtr model = addChild(root, "model");
+    model->AddAttribute("name", "string", "m" + std::to_string(i), false);
+    for (int j = 0; j < i * 5; ++j)
+      addChild(model, "link")->AddValue("int", std::to_string(j), false);
+  }
+  sdf::ElementPtr elem = addChild(root, "deep");
+  for (int i = 0; i < 100; ++i)
+    elem = addChild(elem, "deep");
+
+  const std::string expected = root->ToString("");
+  for (unsigned int threads : {0u, 2u, 8u})
+  {
+    sdf::ElementPtr clone = root->Clone(threads);
+    EXPECT_EQ(expected, clone->ToString("")) << threads;
+
+    sdf::ElementPtr model = clone->GetElement("model");
+    EXPECT_EQ(clone, model->GetParent());
+    model = model->GetNextElement("model");
+    ASSERT_NE(nullptr, model);
+    EXPECT_EQ("m1", model->GetAttribute("name")->GetAsString());
+    EXPECT_EQ(5u, model->CountChildren("link"));
+    EXPECT_EQ(model, model->GetElement("link")->GetParent());
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(Element, DestroyDeepTree)
+{
+  // Destroying the chain must not recurse once per level.
+  std::weak_ptr<sdf::Element> leaf;
+  {
+    sdf::ElementPtr root = std::make_shared<sdf::Element>();
+    sdf::ElementPtr elem = root;
+    for (int i = 0; i < 200000; ++i)
+    {
+      sdf::ElementPtr child = std::make_shared<sdf::Element>();
+      child->SetParent(elem);
+      elem->InsertElement(child);
+      elem = child;
+    }
+    leaf = elem;
+  }
+  EXPECT_TRUE(leaf.expired());
+}
+
+/////////////////////////////////////////////////
+TEST(Element, ReleaseInBackground)
+{
+  const std::string sdfString = R"(
+  <sdf version="1.8">
+    <model name="m">
+      <link name="a"/>
+      <link name="b"/>
+    </model>
+  </sdf>)";
+
+  sdf::ParserConfig config;
+  config.SetReleaseElementsInBackground(true);
+  sdf::SDFPtr sdf(new sdf::SDF());
+  sdf::init(sdf);
+  sdf::Errors errors;
+  ASSERT_TRUE(sdf::readString(sdfString, config, sdf, errors));
+  EXPECT_TRUE(errors.empty());
+
+  // Clones are released in the background like the original.
+  sdf::ElementPtr model = sdf->Root()->GetElement("model");
+  std::weak_ptr<sdf::Element> link = model->GetElement("link");
+  std::weak_ptr<sdf::Element> cloneLink =
+      model->Clone()->GetElement("link");
+  model.reset();
+  sdf.reset();
+
+  sdf::Element::WaitForBackgroundRelease();
+  EXPECT_TRUE(link.expired());
+  EXPECT_TRUE(cloneLink.expired());
+}
+
 /////////////////////////////////////////////////
 /// Main
 int main(int argc, char **argv)
@@ -18,8 +18,8 @@
 #ifndef SDF_EMBEDDEDSDF_HH_
 #define SDF_EMBEDDEDSDF_HH_
 
-#include <map>
-#include <string>
+#include <cstddef>
+#include <string_view>
 
 #include "sdf/Types.hh"
 
@@ -31,10 +31,47 @@ namespace sdf
 
   /// \internal
 
-  /// A map where the keys are a source-relative pathnames within the "sdf"
-  /// directory such as "1.8/root.sdf", and the values are the contents of
-  /// that source file.
-  const std::map<std::string, std::string> &GetEmbeddedSdf();
+  /// \brief A file of the "sdf" source directory that is embedded in the
+  /// library. Both views point to read-only data.
+  struct EmbeddedSdfFile
+  {
+    /// \brief Source-relative pathname, such as "1.8/root.sdf".
+    std::string_view pathname;
+
+    /// \brief Content of the source file.
+    std::string_view data;
+  };
+
+  /// \brief The files embedded in the library, sorted by pathname. The
+  /// table is generated as constant data, so nothing is copied when it is
+  /// first used.
+  struct EmbeddedSdfFiles
+  {
+    /// \brief First file of the table.
+    const EmbeddedSdfFile *first;
+
+    /// \brief Number of files.
+    std::size_t count;
+
+    /// \brief Get the first file, to iterate over them.
+    /// \return Pointer to the first file.
+    const EmbeddedSdfFile *begin() const { return this->first; }
+
+    /// \brief Get the end of the table, to iterate over the files.
+    /// \return Pointer past the last file.
+    const EmbeddedSdfFile *end() const { return this->first + this->count; }
+  };
+
+  /// \brief Get all the embedded files, which are the spec files such as
+  /// "1.8/root.sdf" and the conversion recipes such as "1.8/1_7.convert".
+  /// \return The files, sorted by pathname.
+  const EmbeddedSdfFiles &GetEmbeddedSdf();
+
+  /// \brief Find an embedded file by pathname, with a binary search.
+  /// \param[in] _pathname Source-relative pathname, such as "1.8/root.sdf".
+  /// \return The content of the file, or an empty view if it is not
+  /// embedded.
+  std::string_view FindEmbeddedSdf(std::string_view _pathname);
 }
 }
 #endif
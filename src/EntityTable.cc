@@ -0,0 +1,496 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "sdf/Collision.hh"
+#include "sdf/EntityTable.hh"
+#include "sdf/Frame.hh"
+#include "sdf/Joint.hh"
+#include "sdf/JointAxis.hh"
+#include "sdf/Light.hh"
+#include "sdf/Link.hh"
+#include "sdf/Model.hh"
+#include "sdf/Sensor.hh"
+#include "sdf/Visual.hh"
+
+#include "Tracing.hh"
+
+using namespace sdf;
+
+/// \brief Number of values of EntityType.
+static constexpr std::size_t kEntityTypeCount = 8;
+
+/// \brief Private data for EntityTable
+class sdf::EntityTablePrivate
+{
+  /// \brief Give an ID to an entity.
+  /// \param[in] _type Type of the entity.
+  /// \param[in] _object The DOM object of the entity.
+  /// \param[in] _name Scoped name of the entity.
+  /// \param[in] _parent ID of the parent of the entity.
+  /// \param[in] _scope ID of the model whose scope the references of the
+  /// entity are resolved in, or kInvalidId for the world.
+  /// \return ID of the entity.
+  public: std::size_t Add(EntityType _type, const void *_object,
+              std::string _name, std::size_t _parent, std::size_t _scope);
+
+  /// \brief Give IDs to a model and to its entities.
+  /// \param[in] _model The model.
+  /// \param[in] _parent ID of the parent model, or kInvalidId.
+  public: void AddModel(const Model &_model, std::size_t _parent);
+
+  /// \brief Resolve the references of an entity.
+  /// \param[in] _id ID of the entity.
+  public: void ResolveReferences(std::size_t _id);
+
+  /// \brief Resolve a frame name in a scope.
+  /// \param[in] _scope ID of the model of the scope, or kInvalidId for the
+  /// world.
+  /// \param[in] _name Name relative to the scope.
+  /// \return ID of the frame, kWorldId, or kInvalidId if there is none.
+  public: std::size_t Resolve(std::size_t _scope,
+              const std::string &_name) const;
+
+  /// \brief Get the frame that an empty reference resolves to in a scope.
+  /// \param[in] _scope ID of the model of the scope, or kInvalidId for the
+  /// world.
+  /// \return _scope, or kWorldId for the world.
+  public: static std::size_t DefaultFrame(std::size_t _scope)
+  {
+    return _scope == EntityTable::kInvalidId ? EntityTable::kWorldId :
+        _scope;
+  }
+
+  /// \brief Find the ID of a DOM object.
+  /// \param[in] _type Type of the entity.
+  /// \param[in] _object The DOM object.
+  /// \return ID of the entity, or kInvalidId if there is none.
+  public: std::size_t Find(EntityType _type, const void *_object) const
+  {
+    auto iter = this->objectIndex.find(_object);
+    if (iter == this->objectIndex.end() || this->types[iter->second] != _type)
+      return EntityTable::kInvalidId;
+    return iter->second;
+  }
+
+  /// \brief Type of each entity.
+  public: std::vector<EntityType> types;
+
+  /// \brief Parent of each entity.
+  public: std::vector<std::size_t> parents;
+
+  /// \brief Scope of the references of each entity.
+  public: std::vector<std::size_t> scopes;
+
+  /// \brief Scoped name of each entity.
+  public: std::vector<std::string> names;
+
+  /// \brief DOM object of each entity.
+  public: std::vector<const void *> objects;
+
+  /// \brief Resolved relative_to of the pose of each entity.
+  public: std::vector<std::size_t> poseRelativeTo;
+
+  /// \brief Resolved attached_to of each frame.
+  public: std::vector<std::size_t> attachedTo;
+
+  /// \brief Resolved parent of each joint.
+  public: std::vector<std::size_t> jointParent;
+
+  /// \brief Resolved child of each joint.
+  public: std::vector<std::size_t> jointChild;
+
+  /// \brief Resolved expressed_in of the axes of each joint.
+  public: std::array<std::vector<std::size_t>, 2> axisExpressedIn;
+
+  /// \brief Canonical link of each model.
+  public: std::vector<std::size_t> canonicalLink;
+
+  /// \brief ID of the entities of each type by scoped name.
+  public: std::array<std::unordered_map<std::string, std::size_t>,
+              kEntityTypeCount> nameIndex;
+
+  /// \brief ID of each DOM object.
+  public: std::unordered_map<const void *, std::size_t> objectIndex;
+};
+
+/////////////////////////////////////////////////
+std::size_t EntityTablePrivate::Add(EntityType _type, const void *_object,
+    std::string _name, std::size_t _parent, std::size_t _scope)
+{
+  const std::size_t id = this->types.size();
+  this->types.push_back(_type);
+  this->parents.push_back(_parent);
+  this->scopes.push_back(_scope);
+  this->objects.push_back(_object);
+  this->objectIndex.emplace(_object, id);
+
+  // The first entity with a name keeps it, like the DOM lookups by name.
+  this->nameIndex[static_cast<std::size_t>(_type)].emplace(_name, id);
+  this->names.push_back(std::move(_name));
+  return id;
+}
+
+/////////////////////////////////////////////////
+void EntityTablePrivate::AddModel(const Model &_model, std::size_t _parent)
+{
+  const std::string scope = (_parent == EntityTable::kInvalidId ? "" :
+      this->names[_parent] + "::") + _model.Name();
+  const std::size_t model = this->Add(EntityType::MODEL, &_model, scope,
+      _parent, _parent);
+
+  auto addChildren = [&](EntityType _type, const auto &_children,
+      std::size_t _link)
+  {
+    for (const auto &child : _children)
+    {
+      this->Add(_type, &child,
+          this->names[_link] + "::" + child.Name(), _link, model);
+    }
+  };
+
+  for (const Link &link : _model.Links())
+  {
+    const std::size_t id = this->Add(EntityType::LINK, &link,
+        scope + "::" + link.Name(), model, model);
+    addChildren(EntityType::VISUAL, link.Visuals(), id);
+    addChildren(EntityType::COLLISION, link.Collisions(), id);
+    addChildren(EntityType::SENSOR, link.Sensors(), id);
+    addChildren(EntityType::LIGHT, link.Lights(), id);
+  }
+
+  for (const Joint &joint : _model.Joints())
+  {
+    this->Add(EntityType::JOINT, &joint, scope + "::" + joint.Name(), model,
+        model);
+  }
+
+  for (const Frame &frame : _model.Frames())
+  {
+    this->Add(EntityType::FRAME, &frame, scope + "::" + frame.Name(), model,
+        model);
+  }
+
+  for (const Model &nested : _model.Models())
+    this->AddModel(nested, model);
+}
+
+/////////////////////////////////////////////////
+std::size_t EntityTablePrivate::Resolve(std::size_t _scope,
+    const std::string &_name) const
+{
+  if (_scope == EntityTable::kInvalidId)
+  {
+    if (_name == "world")
+      return EntityTable::kWorldId;
+  }
+  else if (_name == "__model__")
+  {
+    return _scope;
+  }
+
+  const std::string name = _scope == EntityTable::kInvalidId ? _name :
+      this->names[_scope] + "::" + _name;
+  for (EntityType type : {EntityType::MODEL, EntityType::LINK,
+           EntityType::JOINT, EntityType::FRAME})
+  {
+    const auto &index = this->nameIndex[static_cast<std::size_t>(type)];
+    auto iter = index.find(name);
+    if (iter != index.end())
+      return iter->second;
+  }
+  return EntityTable::kInvalidId;
+}
+
+/////////////////////////////////////////////////
+void EntityTablePrivate::ResolveReferences(std::size_t _id)
+{
+  const std::size_t scope = this->scopes[_id];
+
+  // Resolve a reference, or give its default frame if it is empty.
+  auto resolve = [&](const std::string &_name, std::size_t _default)
+  {
+    return _name.empty() ? _default : this->Resolve(scope, _name);
+  };
+
+  // Entities of links are relative to their link by default, and lights of
+  // the world to the world.
+  const std::size_t parent = this->parents[_id];
+  const std::size_t parentFrame = parent == EntityTable::kInvalidId ?
+      EntityTable::kWorldId : parent;
+
+  const void *object = this->objects[_id];
+  switch (this->types[_id])
+  {
+    case EntityType::MODEL:
+    {
+      const Model *model = static_cast<const Model *>(object);
+      this->poseRelativeTo[_id] =
+          resolve(model->PoseRelativeTo(), DefaultFrame(scope));
+      if (const Link *link = model->CanonicalLink())
+        this->canonicalLink[_id] = this->Find(EntityType::LINK, link);
+      break;
+    }
+    case EntityType::LINK:
+      this->poseRelativeTo[_id] = resolve(
+          static_cast<const Link *>(object)->PoseRelativeTo(), parentFrame);
+      break;
+    case EntityType::VISUAL:
+      this->poseRelativeTo[_id] = resolve(
+          static_cast<const Visual *>(object)->PoseRelativeTo(),
+          parentFrame);
+      break;
+    case EntityType::COLLISION:
+      this->poseRelativeTo[_id] = resolve(
+          static_cast<const Collision *>(object)->PoseRelativeTo(),
+          parentFrame);
+      break;
+    case EntityType::SENSOR:
+      this->poseRelativeTo[_id] = resolve(
+          static_cast<const Sensor *>(object)->PoseRelativeTo(),
+          parentFrame);
+      break;
+    case EntityType::LIGHT:
+      this->poseRelativeTo[_id] = resolve(
+          static_cast<const Light *>(object)->PoseRelativeTo(),
+          parentFrame);
+      break;
+    case EntityType::JOINT:
+    {
+      const Joint *joint = static_cast<const Joint *>(object);
+      this->jointChild[_id] = this->Resolve(scope, joint->ChildLinkName());
+      this->jointParent[_id] = joint->ParentLinkName() == "world" ?
+          EntityTable::kWorldId :
+          this->Resolve(scope, joint->ParentLinkName());
+      this->poseRelativeTo[_id] =
+          resolve(joint->PoseRelativeTo(), this->jointChild[_id]);
+      for (unsigned int i = 0; i < this->axisExpressedIn.size(); ++i)
+      {
+        if (const JointAxis *axis = joint->Axis(i))
+          this->axisExpressedIn[i][_id] = resolve(axis->XyzExpressedIn(), _id);
+      }
+      break;
+    }
+    case EntityType::FRAME:
+    {
+      const Frame *frame = static_cast<const Frame *>(object);
+      this->attachedTo[_id] =
+          resolve(frame->AttachedTo(), DefaultFrame(scope));
+      this->poseRelativeTo[_id] =
+          resolve(frame->PoseRelativeTo(), this->attachedTo[_id]);
+      break;
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+EntityTable::EntityTable()
+  : dataPtr(new EntityTablePrivate)
+{
+}
+
+/////////////////////////////////////////////////
+EntityTable::EntityTable(const EntityTable &_table)
+  : dataPtr(new EntityTablePrivate(*_table.dataPtr))
+{
+}
+
+/////////////////////////////////////////////////
+EntityTable::EntityTable(EntityTable &&_table) noexcept
+  : dataPtr(std::exchange(_table.dataPtr, nullptr))
+{
+}
+
+/////////////////////////////////////////////////
+EntityTable &EntityTable::operator=(EntityTable &&_table) noexcept
+{
+  std::swap(this->dataPtr, _table.dataPtr);
+  return *this;
+}
+
+/////////////////////////////////////////////////
+EntityTable &EntityTable::operator=(const EntityTable &_table)
+{
+  return *this = EntityTable(_table);
+}
+
+/////////////////////////////////////////////////
+EntityTable::~EntityTable()
+{
+  delete this->dataPtr;
+  this->dataPtr = nullptr;
+}
+
+/////////////////////////////////////////////////
+void EntityTable::Build(Span<const Model> _models, Span<const Frame> _frames,
+    Span<const Light> _lights)
+{
+  SDF_TRACE_SCOPE("EntityTable::Build");
+  *this->dataPtr = EntityTablePrivate();
+  EntityTablePrivate &data = *this->dataPtr;
+
+  for (const Model &model : _models)
+    data.AddModel(model, kInvalidId);
+  for (const Frame &frame : _frames)
+    data.Add(EntityType::FRAME, &frame, frame.Name(), kInvalidId, kInvalidId);
+  for (const Light &light : _lights)
+    data.Add(EntityType::LIGHT, &light, light.Name(), kInvalidId, kInvalidId);
+
+  // References are resolved once every entity has an ID, since they can
+  // refer to entities that come later.
+  const std::size_t count = data.types.size();
+  data.poseRelativeTo.assign(count, kInvalidId);
+  data.attachedTo.assign(count, kInvalidId);
+  data.jointParent.assign(count, kInvalidId);
+  data.jointChild.assign(count, kInvalidId);
+  for (auto &expressedIn : data.axisExpressedIn)
+    expressedIn.assign(count, kInvalidId);
+  data.canonicalLink.assign(count, kInvalidId);
+  for (std::size_t id = 0; id < count; ++id)
+    data.ResolveReferences(id);
+}
+
+/////////////////////////////////////////////////
+std::size_t EntityTable::EntityCount() const
+{
+  return this->dataPtr->types.size();
+}
+
+/////////////////////////////////////////////////
+const EntityType *EntityTable::EntityTypes() const
+{
+  return this->dataPtr->types.data();
+}
+
+/////////////////////////////////////////////////
+const std::size_t *EntityTable::EntityParents() const
+{
+  return this->dataPtr->parents.data();
+}
+
+/////////////////////////////////////////////////
+const std::string &EntityTable::EntityName(std::size_t _id) const
+{
+  static const std::string empty;
+  return _id < this->dataPtr->names.size() ? this->dataPtr->names[_id] :
+      empty;
+}
+
+/////////////////////////////////////////////////
+std::size_t EntityTable::EntityByScopedName(EntityType _type,
+    const std::string &_name) const
+{
+  const std::size_t type = static_cast<std::size_t>(_type);
+  if (type >= kEntityTypeCount)
+    return kInvalidId;
+  const auto &index = this->dataPtr->nameIndex[type];
+  auto iter = index.find(_name);
+  return iter == index.end() ? kInvalidId : iter->second;
+}
+
+/////////////////////////////////////////////////
+std::size_t EntityTable::Id(const Model *_model) const
+{
+  return this->dataPtr->Find(EntityType::MODEL, _model);
+}
+
+/////////////////////////////////////////////////
+std::size_t EntityTable::Id(const Link *_link) const
+{
+  return this->dataPtr->Find(EntityType::LINK, _link);
+}
+
+/////////////////////////////////////////////////
+std::size_t EntityTable::Id(const Visual *_visual) const
+{
+  return this->dataPtr->Find(EntityType::VISUAL, _visual);
+}
+
+/////////////////////////////////////////////////
+std::size_t EntityTable::Id(const Collision *_collision) const
+{
+  return this->dataPtr->Find(EntityType::COLLISION, _collision);
+}
+
+/////////////////////////////////////////////////
+std::size_t EntityTable::Id(const Sensor *_sensor) const
+{
+  return this->dataPtr->Find(EntityType::SENSOR, _sensor);
+}
+
+/////////////////////////////////////////////////
+std::size_t EntityTable::Id(const Light *_light) const
+{
+  return this->dataPtr->Find(EntityType::LIGHT, _light);
+}
+
+/////////////////////////////////////////////////
+std::size_t EntityTable::Id(const Joint *_joint) const
+{
+  return this->dataPtr->Find(EntityType::JOINT, _joint);
+}
+
+/////////////////////////////////////////////////
+std::size_t EntityTable::Id(const Frame *_frame) const
+{
+  return this->dataPtr->Find(EntityType::FRAME, _frame);
+}
+
+/////////////////////////////////////////////////
+const std::size_t *EntityTable::PoseRelativeTo() const
+{
+  return this->dataPtr->poseRelativeTo.data();
+}
+
+/////////////////////////////////////////////////
+const std::size_t *EntityTable::FrameAttachedTo() const
+{
+  return this->dataPtr->attachedTo.data();
+}
+
+/////////////////////////////////////////////////
+const std::size_t *EntityTable::JointParent() const
+{
+  return this->dataPtr->jointParent.data();
+}
+
+/////////////////////////////////////////////////
+const std::size_t *EntityTable::JointChild() const
+{
+  return this->dataPtr->jointChild.data();
+}
+
+/////////////////////////////////////////////////
+const std::size_t *EntityTable::JointAxisExpressedIn(
+    unsigned int _index) const
+{
+  if (_index >= this->dataPtr->axisExpressedIn.size())
+    return nullptr;
+  return this->dataPtr->axisExpressedIn[_index].data();
+}
+
+/////////////////////////////////////////////////
+const std::size_t *EntityTable::ModelCanonicalLink() const
+{
+  return this->dataPtr->canonicalLink.data();
+}
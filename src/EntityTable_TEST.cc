@@ -0,0 +1,162 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <string>
+#include "sdf/EntityTable.hh"
+#include "sdf/Frame.hh"
+#include "sdf/Joint.hh"
+#include "sdf/Link.hh"
+#include "sdf/Model.hh"
+#include "sdf/Root.hh"
+#include "sdf/World.hh"
+
+/////////////////////////////////////////////////
+TEST(DOMEntityTable, Construction)
+{
+  sdf::EntityTable table;
+  EXPECT_EQ(0u, table.EntityCount());
+  EXPECT_TRUE(table.EntityName(0).empty());
+  EXPECT_EQ(sdf::EntityTable::kInvalidId,
+      table.EntityByScopedName(sdf::EntityType::MODEL, "m"));
+  sdf::Model model;
+  EXPECT_EQ(sdf::EntityTable::kInvalidId, table.Id(&model));
+  EXPECT_EQ(nullptr, table.JointAxisExpressedIn(2));
+
+  sdf::World world;
+  EXPECT_EQ(0u, world.Entities().EntityCount());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMEntityTable, World)
+{
+  const std::string sdfString = R"(
+  <sdf version="1.8">
+    <world name="default">
+      <model name="robot">
+        <pose relative_to="marker">1 0 0 0 0 0</pose>
+        <link name="base">
+          <visual name="v">
+            <geometry><box><size>1 1 1</size></box></geometry>
+          </visual>
+          <collision name="c">
+            <geometry><box><size>1 1 1</size></box></geometry>
+          </collision>
+          <sensor name="imu" type="imu"/>
+        </link>
+        <link name="arm">
+          <pose relative_to="base">0 0 1 0 0 0</pose>
+          <light name="lamp" type="point"/>
+        </link>
+        <joint name="j" type="revolute">
+          <parent>base</parent>
+          <child>arm</child>
+          <axis>
+            <xyz expressed_in="__model__">0 0 1</xyz>
+          </axis>
+        </joint>
+        <joint name="fixed" type="fixed">
+          <parent>world</parent>
+          <child>base</child>
+        </joint>
+        <frame name="f" attached_to="arm"/>
+        <model name="inner">
+          <link name="l"/>
+        </model>
+      </model>
+      <frame name="marker"/>
+      <light name="sun" type="directional"/>
+    </world>
+  </sdf>)";
+
+  sdf::Root root;
+  ASSERT_TRUE(root.LoadSdfString(sdfString).empty());
+  const sdf::World *world = root.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+  const sdf::EntityTable &table = world->Entities();
+
+  // robot, base, v, c, imu, arm, lamp, j, fixed, f, inner, l, marker, sun
+  ASSERT_EQ(14u, table.EntityCount());
+  const sdf::EntityType *types = table.EntityTypes();
+  const std::size_t *parents = table.EntityParents();
+  const std::size_t none = sdf::EntityTable::kInvalidId;
+  const std::size_t worldId = sdf::EntityTable::kWorldId;
+  EXPECT_EQ(sdf::EntityType::MODEL, types[0]);
+  EXPECT_EQ(sdf::EntityType::VISUAL, types[2]);
+  EXPECT_EQ(sdf::EntityType::LIGHT, types[6]);
+  EXPECT_EQ(sdf::EntityType::JOINT, types[7]);
+  EXPECT_EQ(sdf::EntityType::FRAME, types[9]);
+  EXPECT_EQ(sdf::EntityType::FRAME, types[12]);
+  EXPECT_EQ(sdf::EntityType::LIGHT, types[13]);
+  EXPECT_EQ(none, parents[0]);
+  EXPECT_EQ(1u, parents[2]);
+  EXPECT_EQ(5u, parents[6]);
+  EXPECT_EQ(0u, parents[10]);
+  EXPECT_EQ(10u, parents[11]);
+  EXPECT_EQ(none, parents[12]);
+  EXPECT_EQ("robot::arm::lamp", table.EntityName(6));
+  EXPECT_EQ("robot::inner::l", table.EntityName(11));
+  EXPECT_EQ("marker", table.EntityName(12));
+
+  EXPECT_EQ(5u, table.EntityByScopedName(sdf::EntityType::LINK,
+      "robot::arm"));
+  EXPECT_EQ(13u, table.EntityByScopedName(sdf::EntityType::LIGHT, "sun"));
+  EXPECT_EQ(none, table.EntityByScopedName(sdf::EntityType::FRAME,
+      "robot::arm"));
+  EXPECT_EQ(0u, table.Id(world->ModelByIndex(0)));
+  EXPECT_EQ(7u, table.Id(world->JointByScopedName("robot::j")));
+  EXPECT_EQ(11u, table.Id(world->LinkByScopedName("robot::inner::l")));
+  EXPECT_EQ(12u, table.Id(world->FrameByName("marker")));
+
+  // Empty references resolve to their default frame.
+  const std::size_t *relativeTo = table.PoseRelativeTo();
+  EXPECT_EQ(12u, relativeTo[0]);
+  EXPECT_EQ(0u, relativeTo[1]);
+  EXPECT_EQ(1u, relativeTo[2]);
+  EXPECT_EQ(1u, relativeTo[5]);
+  EXPECT_EQ(5u, relativeTo[6]);
+  EXPECT_EQ(5u, relativeTo[7]);
+  EXPECT_EQ(5u, relativeTo[9]);
+  EXPECT_EQ(0u, relativeTo[10]);
+  EXPECT_EQ(10u, relativeTo[11]);
+  EXPECT_EQ(worldId, relativeTo[12]);
+  EXPECT_EQ(worldId, relativeTo[13]);
+
+  const std::size_t *attachedTo = table.FrameAttachedTo();
+  EXPECT_EQ(none, attachedTo[1]);
+  EXPECT_EQ(5u, attachedTo[9]);
+  EXPECT_EQ(worldId, attachedTo[12]);
+
+  EXPECT_EQ(1u, table.JointParent()[7]);
+  EXPECT_EQ(5u, table.JointChild()[7]);
+  EXPECT_EQ(worldId, table.JointParent()[8]);
+  EXPECT_EQ(1u, table.JointChild()[8]);
+  EXPECT_EQ(none, table.JointParent()[9]);
+  EXPECT_EQ(0u, table.JointAxisExpressedIn(0)[7]);
+  EXPECT_EQ(none, table.JointAxisExpressedIn(0)[8]);
+  EXPECT_EQ(none, table.JointAxisExpressedIn(1)[7]);
+
+  EXPECT_EQ(1u, table.ModelCanonicalLink()[0]);
+  EXPECT_EQ(11u, table.ModelCanonicalLink()[10]);
+  EXPECT_EQ(none, table.ModelCanonicalLink()[1]);
+
+  // A copy of the world has the same IDs for its own objects.
+  sdf::World copy(*world);
+  EXPECT_EQ(14u, copy.Entities().EntityCount());
+  EXPECT_EQ(0u, copy.Entities().Id(copy.ModelByIndex(0)));
+  EXPECT_EQ(none, copy.Entities().Id(world->ModelByIndex(0)));
+}
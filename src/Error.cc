@@ -15,6 +15,8 @@
  *
 */
 
+#include <string>
+#include <utility>
 #include "sdf/Error.hh"
 
 using namespace sdf;
@@ -26,6 +28,12 @@ Error::Error(const ErrorCode _code, const std::string &_message)
   this->message = _message;
 }
 
+/////////////////////////////////////////////////
+Error::Error(const ErrorCode _code, std::string &&_message)
+  : code(_code), message(std::move(_message))
+{
+}
+
 /////////////////////////////////////////////////
 ErrorCode Error::Code() const
 {
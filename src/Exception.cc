@@ -67,8 +67,8 @@ Exception &Exception::operator=(Exception &&_exception) = default;
 //////////////////////////////////////////////////
 void Exception::Print() const
 {
-  sdf::Console::Instance()->ColorMsg("Exception",
-      this->dataPtr->file,
+  sdf::Console::MessageEnd() & sdf::Console::Instance()->ColorMsg(
+      "Exception", this->dataPtr->file,
       static_cast<unsigned int>(this->dataPtr->line), 31) << *this;
 }
 
@@ -0,0 +1,224 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "sdf/Executor.hh"
+
+using namespace sdf;
+
+namespace
+{
+/// \brief The default executor: a pool of threads with a queue each, where
+/// the threads that run out of tasks steal the tasks of the others.
+class WorkStealingExecutor : public Executor
+{
+  /// \brief Constructor
+  /// \param[in] _threadCount Number of threads, at least 1.
+  public: explicit WorkStealingExecutor(unsigned int _threadCount)
+    : threadCount(_threadCount)
+  {
+    for (unsigned int i = 0; i < _threadCount; ++i)
+      this->queues.emplace_back(new Queue);
+  }
+
+  /// \brief Destructor. Runs the queued tasks, then stops the threads.
+  public: ~WorkStealingExecutor() override
+  {
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      this->stop = true;
+      this->pending.notify_all();
+    }
+    for (std::thread &thread : this->threads)
+      thread.join();
+  }
+
+  // Documentation inherited.
+  public: void Submit(std::function<void()> _task) override
+  {
+    std::call_once(this->started, [this]
+        {
+          for (unsigned int i = 0; i < this->threadCount; ++i)
+            this->threads.emplace_back(&WorkStealingExecutor::Run, this, i);
+        });
+
+    // Tasks submitted by a task stay on the queue of its thread, and the
+    // others are spread over the queues.
+    std::size_t index = 0;
+    if (CurrentPool() == this)
+      index = CurrentIndex();
+    else
+      index = this->nextQueue++ % this->queues.size();
+
+    {
+      Queue &queue = *this->queues[index];
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      queue.tasks.push_back(std::move(_task));
+    }
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    ++this->queued;
+    this->pending.notify_one();
+  }
+
+  // Documentation inherited.
+  public: unsigned int Concurrency() const override
+  {
+    return this->threadCount;
+  }
+
+  /// \brief Tasks of a thread.
+  private: struct Queue
+  {
+    /// \brief Protects tasks.
+    std::mutex mutex;
+
+    /// \brief Tasks, from the oldest to the newest.
+    std::deque<std::function<void()>> tasks;
+  };
+
+  /// \brief Take a task, the newest of the thread's queue or else the
+  /// oldest of another queue. There must be a task reserved by the thread.
+  /// \param[in] _index Index of the thread.
+  /// \return The task.
+  private: std::function<void()> Take(std::size_t _index)
+  {
+    // A task that is reserved is in one of the queues, or about to be.
+    // Other threads only take the tasks they reserved, so it is found.
+    while (true)
+    {
+      for (std::size_t i = 0; i < this->queues.size(); ++i)
+      {
+        Queue &queue = *this->queues[(_index + i) % this->queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty())
+          continue;
+
+        std::function<void()> task;
+        if (i == 0)
+        {
+          task = std::move(queue.tasks.back());
+          queue.tasks.pop_back();
+        }
+        else
+        {
+          task = std::move(queue.tasks.front());
+          queue.tasks.pop_front();
+        }
+        return task;
+      }
+      std::this_thread::yield();
+    }
+  }
+
+  /// \brief Body of the threads.
+  /// \param[in] _index Index of the thread.
+  private: void Run(std::size_t _index)
+  {
+    CurrentPool() = this;
+    CurrentIndex() = _index;
+    while (true)
+    {
+      {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        this->pending.wait(lock, [this]
+            {
+              return this->stop || this->queued > 0;
+            });
+        if (this->queued == 0)
+          break;
+        --this->queued;
+      }
+
+      std::function<void()> task = this->Take(_index);
+      try
+      {
+        task();
+      }
+      catch (...)
+      {
+        // Tasks must not throw, and an exception can't be reported here.
+      }
+    }
+  }
+
+  /// \brief Get the pool of the current thread.
+  /// \return Reference to the pool, or nullptr outside of the pools.
+  private: static const WorkStealingExecutor *&CurrentPool()
+  {
+    static thread_local const WorkStealingExecutor *pool = nullptr;
+    return pool;
+  }
+
+  /// \brief Get the index of the current thread in its pool.
+  /// \return Reference to the index.
+  private: static std::size_t &CurrentIndex()
+  {
+    static thread_local std::size_t index = 0;
+    return index;
+  }
+
+  /// \brief Number of threads.
+  private: const unsigned int threadCount;
+
+  /// \brief Queue of each thread.
+  private: std::vector<std::unique_ptr<Queue>> queues;
+
+  /// \brief Queue of the next task submitted from outside of the pool.
+  private: std::atomic<std::size_t> nextQueue{0};
+
+  /// \brief Threads, started by the first task.
+  private: std::vector<std::thread> threads;
+
+  /// \brief Starts the threads once.
+  private: std::once_flag started;
+
+  /// \brief Protects queued and stop.
+  private: std::mutex mutex;
+
+  /// \brief Signals the threads that tasks were queued or they must stop.
+  private: std::condition_variable pending;
+
+  /// \brief Number of tasks that no thread reserved.
+  private: std::size_t queued = 0;
+
+  /// \brief True to stop the threads once the queues are empty.
+  private: bool stop = false;
+};
+}
+
+/////////////////////////////////////////////////
+Executor::~Executor() = default;
+
+/////////////////////////////////////////////////
+std::shared_ptr<Executor> Executor::Default()
+{
+  static std::shared_ptr<Executor> executor =
+      std::make_shared<WorkStealingExecutor>(
+          std::max(1u, std::thread::hardware_concurrency()));
+  return executor;
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_EXECUTOR_SCOPE_HH_
+#define SDF_EXECUTOR_SCOPE_HH_
+
+#include <memory>
+#include <utility>
+
+#include "sdf/Executor.hh"
+#include "sdf/ParserConfig.hh"
+#include "sdf/sdf_config.h"
+
+/// \ingroup sdf_parser
+/// \brief namespace for Simulation Description Format parser
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief Sets the executor of the parallel work started on the current
+  /// thread while this scope is alive. The previous executor is restored
+  /// when the scope is destroyed, so scopes can nest.
+  class ExecutorScope
+  {
+    /// \brief Constructor
+    /// \param[in] _executor Executor to use, or nullptr for the default.
+    public: explicit ExecutorScope(std::shared_ptr<Executor> _executor)
+      : previous(std::move(Current()))
+    {
+      Current() = std::move(_executor);
+    }
+
+    /// \brief Constructor that uses the executor of a ParserConfig.
+    /// \param[in] _config Parser configuration.
+    public: explicit ExecutorScope(const ParserConfig &_config)
+      : ExecutorScope(_config.LoadExecutor())
+    {
+    }
+
+    /// \brief Destructor
+    public: ~ExecutorScope()
+    {
+      Current() = std::move(this->previous);
+    }
+
+    /// \brief Get the executor set on the current thread.
+    /// \return Reference to the executor, which is nullptr when the default
+    /// one is used.
+    public: static std::shared_ptr<Executor> &Current()
+    {
+      static thread_local std::shared_ptr<Executor> current;
+      return current;
+    }
+
+    /// \brief Get the executor to use on the current thread.
+    /// \return The current executor, or Executor::Default.
+    public: static std::shared_ptr<Executor> Get()
+    {
+      const std::shared_ptr<Executor> &current = Current();
+      return current ? current : Executor::Default();
+    }
+
+    /// \brief Executor that was current before this scope.
+    private: std::shared_ptr<Executor> previous;
+  };
+  }
+}
+#endif
@@ -0,0 +1,144 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "sdf/Executor.hh"
+#include "sdf/ParserConfig.hh"
+#include "sdf/Root.hh"
+#include "sdf/World.hh"
+
+/// \brief Executor that keeps its tasks until they are run explicitly.
+class ManualExecutor : public sdf::Executor
+{
+  // Documentation inherited.
+  public: void Submit(std::function<void()> _task) override
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->tasks.push_back(std::move(_task));
+    ++this->submitted;
+  }
+
+  // Documentation inherited.
+  public: unsigned int Concurrency() const override
+  {
+    return 4u;
+  }
+
+  /// \brief Run the tasks submitted so far.
+  public: void RunAll()
+  {
+    std::vector<std::function<void()>> pending;
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      pending.swap(this->tasks);
+    }
+    for (std::function<void()> &task : pending)
+      task();
+  }
+
+  /// \brief Number of tasks submitted.
+  public: std::size_t submitted = 0;
+
+  /// \brief Tasks that were not run.
+  private: std::vector<std::function<void()>> tasks;
+
+  /// \brief Protects tasks and submitted.
+  private: std::mutex mutex;
+};
+
+/////////////////////////////////////////////////
+TEST(Executor, Default)
+{
+  std::shared_ptr<sdf::Executor> executor = sdf::Executor::Default();
+  ASSERT_NE(nullptr, executor);
+  EXPECT_EQ(executor, sdf::Executor::Default());
+  EXPECT_LE(1u, executor->Concurrency());
+
+  // Tasks that submit tasks, like nested includes. The state is static
+  // since the last task still runs when the test is notified.
+  static std::mutex mutex;
+  static std::condition_variable finished;
+  static std::atomic<int> remaining{0};
+  static std::function<void(int)> spawn = [executor](int _depth)
+  {
+    if (_depth > 0)
+    {
+      for (int i = 0; i < 3; ++i)
+      {
+        ++remaining;
+        executor->Submit([_depth]
+            {
+              spawn(_depth - 1);
+            });
+      }
+    }
+    if (--remaining == 0)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      finished.notify_all();
+    }
+  };
+
+  ++remaining;
+  executor->Submit([]
+      {
+        spawn(4);
+      });
+
+  std::unique_lock<std::mutex> lock(mutex);
+  finished.wait(lock, []
+      {
+        return remaining == 0;
+      });
+}
+
+/////////////////////////////////////////////////
+TEST(Executor, LoadExecutor)
+{
+  std::string sdfString = "<sdf version='1.8'><world name='default'>";
+  for (int i = 0; i < 20; ++i)
+  {
+    sdfString += "<model name='m" + std::to_string(i) + "'>"
+      "<link name='l'/></model>";
+  }
+  sdfString += "</world></sdf>";
+
+  auto executor = std::make_shared<ManualExecutor>();
+  sdf::ParserConfig config;
+  config.SetLoadThreadCount(0u);
+  config.SetLoadExecutor(executor);
+  EXPECT_EQ(executor, config.LoadExecutor());
+
+  // The parser doesn't wait for the tasks of the executor, and does their
+  // work itself when they don't run.
+  sdf::Root root;
+  EXPECT_TRUE(root.LoadSdfString(sdfString, config).empty());
+  EXPECT_LT(0u, executor->submitted);
+  ASSERT_EQ(1u, root.WorldCount());
+  EXPECT_EQ(20u, root.WorldByIndex(0)->ModelCount());
+
+  // Tasks that start after their load finished do nothing.
+  executor->RunAll();
+  EXPECT_EQ(20u, root.WorldByIndex(0)->ModelCount());
+}
@@ -0,0 +1,153 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_FIND_FILE_SETTINGS_HH_
+#define SDF_FIND_FILE_SETTINGS_HH_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "sdf/ParserConfig.hh"
+#include "sdf/VirtualFilesystem.hh"
+#include "sdf/sdf_config.h"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief URI paths and find callback that a ParserConfig adds to the
+  /// ones set globally with addURIPath and setFindCallback, together with
+  /// the findFile results memoized for them.
+  ///
+  /// Settings are shared by copies of a ParserConfig, and are never
+  /// modified once they are shared: ParserConfig::AddURIPath and
+  /// ParserConfig::SetFindCallback replace them with a modified copy. Only
+  /// the memoized results change, under their mutex, so settings can be
+  /// used by loads on several threads at once.
+  class FindFileSettings
+  {
+    /// \brief Arguments and environment that determine the result of
+    /// findFile: file name, search local path and use callback flags, SDF
+    /// version, working directory and SDF_PATH.
+    public: using Key = std::tuple<std::string, bool, bool, std::string,
+                std::string, std::string>;
+
+    /// \brief Paths associated with each URI, see ParserConfig::URIPathMap.
+    public: using URIPathMap =
+                std::map<std::string, std::vector<std::string>>;
+
+    /// \brief Constructor.
+    public: FindFileSettings() = default;
+
+    /// \brief Copy the paths and callback, but not the memoized results.
+    /// \param[in] _settings Settings to copy.
+    public: FindFileSettings(const FindFileSettings &_settings)
+      : uriPathMap(_settings.uriPathMap),
+        findCallback(_settings.findCallback),
+        asyncFindCallback(_settings.asyncFindCallback),
+        filesystem(_settings.filesystem)
+    {
+    }
+
+    /// \brief Get the settings of a parser configuration.
+    /// \param[in] _config Parser configuration.
+    /// \return The settings, or nullptr if the configuration only uses the
+    /// global ones.
+    public: static std::shared_ptr<FindFileSettings> Of(
+                const ParserConfig &_config);
+
+    /// \brief Get the filesystem that files are found and read in.
+    /// \param[in] _settings Settings, or nullptr for the global ones.
+    /// \return The filesystem of the settings, or the native one.
+    public: static const VirtualFilesystem &FilesystemOf(
+                const FindFileSettings *_settings);
+
+    /// \brief Get the filesystem of a parser configuration.
+    /// \param[in] _config Parser configuration.
+    /// \return The filesystem set with ParserConfig::SetFilesystem, or the
+    /// native one. It lives as long as _config keeps it.
+    public: static const VirtualFilesystem &FilesystemOf(
+                const ParserConfig &_config);
+
+    /// \brief Add the valid directories of a colon separated path to a URI.
+    /// \param[in,out] _map Map to add to.
+    /// \param[in] _uri URI that will be mapped to _path.
+    /// \param[in] _path Colon separated set of paths.
+    /// \param[in] _filesystem Filesystem the directories are checked in.
+    public: static void AddURIPath(URIPathMap &_map,
+                const std::string &_uri, const std::string &_path,
+                const VirtualFilesystem &_filesystem);
+
+    /// \brief Get a new settings identifier.
+    /// \return An identifier that is different from every identifier
+    /// returned before, and from 0.
+    private: static std::uint64_t NextId()
+    {
+      static std::atomic<std::uint64_t> nextId{1};
+      return nextId++;
+    }
+
+    /// \brief Identifier of the settings, which is never reused. Documents
+    /// read with different settings are memoized apart by IncludeCache.
+    public: const std::uint64_t id = NextId();
+
+    /// \brief Paths associated with each URI.
+    public: URIPathMap uriPathMap;
+
+    /// \brief Callback used when a file can't be found otherwise.
+    public: std::function<std::string(const std::string &)> findCallback;
+
+    /// \brief Callback that fetches the URIs of includes that can't be
+    /// found locally.
+    public: std::function<std::future<std::string>(const std::string &)>
+                asyncFindCallback;
+
+    /// \brief Filesystem files are found and read in, or nullptr for the
+    /// native one.
+    public: std::shared_ptr<const VirtualFilesystem> filesystem;
+
+    /// \brief Memoized findFile results, including files that were not
+    /// found.
+    public: std::map<Key, std::string> results;
+
+    /// \brief Value of the global generation when the results were
+    /// memoized. Changes to the global settings increment the generation,
+    /// which invalidates the results.
+    public: std::uint64_t generation = 0;
+
+    /// \brief Protects results and generation.
+    public: std::mutex resultsMutex;
+
+    /// \brief Fetches started with asyncFindCallback, by URI. Fetches that
+    /// failed are removed, so that they are tried again.
+    public: std::map<std::string, std::shared_future<std::string>> fetches;
+
+    /// \brief Protects fetches.
+    public: std::mutex fetchesMutex;
+  };
+  }
+}
+#endif
@@ -16,6 +16,8 @@
  */
 #include <string>
 #include "sdf/ForceTorque.hh"
+#include "ElementRetentionScope.hh"
+#include "LoadStatsScope.hh"
 
 using namespace sdf;
 
@@ -74,9 +76,10 @@ ForceTorque &ForceTorque::operator=(ForceTorque &&_ft) noexcept
 //////////////////////////////////////////////////
 Errors ForceTorque::Load(ElementPtr _sdf)
 {
+  DomLoadTimer timer("ForceTorque");
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that the provided SDF element is a <force_torque> element.
   // This is an error that cannot be recovered, so return an error.
@@ -15,11 +15,15 @@
  *
 */
 #include <string>
+#include <utility>
 #include <ignition/math/Pose3.hh>
 #include "sdf/Frame.hh"
 #include "sdf/Error.hh"
 #include "sdf/Types.hh"
+#include "ElementRetentionScope.hh"
 #include "FrameSemantics.hh"
+#include "LoadStatsScope.hh"
+#include "MemoryAccounting.hh"
 #include "ScopedGraph.hh"
 #include "Utils.hh"
 
@@ -60,10 +64,9 @@ Frame::Frame()
 }
 
 /////////////////////////////////////////////////
-Frame::Frame(Frame &&_frame)
+Frame::Frame(Frame &&_frame) noexcept
+  : dataPtr(std::exchange(_frame.dataPtr, nullptr))
 {
-  this->dataPtr = _frame.dataPtr;
-  _frame.dataPtr = nullptr;
 }
 
 /////////////////////////////////////////////////
@@ -94,17 +97,17 @@ Frame &Frame::operator=(const Frame &_frame)
 //////////////////////////////////////////////////
 Frame &Frame::operator=(Frame &&_frame)
 {
-  this->dataPtr = _frame.dataPtr;
-  _frame.dataPtr = nullptr;
+  std::swap(this->dataPtr, _frame.dataPtr);
   return *this;
 }
 
 /////////////////////////////////////////////////
 Errors Frame::Load(ElementPtr _sdf)
 {
+  DomLoadTimer timer("Frame");
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that the provided SDF element is a <frame>
   // This is an error that cannot be recovered, so return an error.
@@ -257,3 +260,10 @@ sdf::ElementPtr Frame::Element() const
 {
   return this->dataPtr->sdf;
 }
+
+/////////////////////////////////////////////////
+template <>
+std::size_t sdf::domPrivateSize<Frame>()
+{
+  return sizeof(FramePrivate);
+}
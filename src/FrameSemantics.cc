@@ -15,21 +15,31 @@
  *
 */
 #include <algorithm>
+#include <functional>
+#include <mutex>
 #include <string>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include "sdf/Collision.hh"
 #include "sdf/Element.hh"
 #include "sdf/Error.hh"
 #include "sdf/Frame.hh"
 #include "sdf/Joint.hh"
 #include "sdf/Link.hh"
 #include "sdf/Model.hh"
+#include "sdf/Sensor.hh"
+#include "sdf/StateReader.hh"
 #include "sdf/Types.hh"
+#include "sdf/Visual.hh"
 #include "sdf/World.hh"
 
 #include "FrameSemantics.hh"
+#include "LoadStatsScope.hh"
+#include "PoseBatch.hh"
 #include "ScopedGraph.hh"
+#include "Tracing.hh"
 
 namespace sdf
 {
@@ -59,6 +69,9 @@ void printGraph(const ScopedGraph<FrameAttachedToGraph> &_graph)
 /// It also returns the sequence of edges leading to the source vertex.
 /// \param[in] _graph A directed graph.
 /// \param[in] _id VertexId of the starting vertex.
+/// \param[in] _stopAt Optional function that returns true for vertices
+/// where the search can stop before reaching the scope vertex, because the
+/// rest of the path is already known.
 /// \return A source vertex paired with a vector of the edges leading the
 /// source to the starting vertex, or a NullVertex paired with an empty
 /// vector if a cycle or vertex with multiple incoming edges are detected.
@@ -66,7 +79,8 @@ template <typename T>
 std::pair<const typename ScopedGraph<T>::Vertex &,
     std::vector<typename ScopedGraph<T>::Edge>>
 FindSourceVertex(const ScopedGraph<T> &_graph,
-    const ignition::math::graph::VertexId _id, Errors &_errors)
+    const ignition::math::graph::VertexId _id, Errors &_errors,
+    const std::function<bool(ignition::math::graph::VertexId)> &_stopAt = {})
 {
   using DirectedEdge = typename ScopedGraph<T>::Edge;
   using Vertex = typename ScopedGraph<T>::Vertex;
@@ -117,6 +131,11 @@ FindSourceVertex(const ScopedGraph<T> &_graph,
       // This is the source.
       break;
     }
+    if (_stopAt && _stopAt(vertex.get().Id()))
+    {
+      // The path from here to the source is already known.
+      return PairType(vertex, edges);
+    }
     visited.insert(vertex.get().Id());
     incidentsTo = _graph.Graph().IncidentsTo(vertex);
   }
@@ -137,6 +156,9 @@ FindSourceVertex(const ScopedGraph<T> &_graph,
 /// It also returns the sequence of edges leading to the sink vertex.
 /// \param[in] _graph A directed graph.
 /// \param[in] _id VertexId of the starting vertex.
+/// \param[in] _stopAt Optional function that returns true for vertices
+/// where the search can stop before reaching the sink, because the sink
+/// of that vertex is already known.
 /// \return A sink vertex paired with a vector of the edges leading the
 /// sink to the starting vertex, or a NullVertex paired with an empty
 /// vector if a cycle or vertex with multiple outgoing edges are detected.
@@ -146,7 +168,8 @@ std::pair<const typename ScopedGraph<T>::Vertex &,
 FindSinkVertex(
     const ScopedGraph<T> &_graph,
     const ignition::math::graph::VertexId _id,
-    Errors &_errors)
+    Errors &_errors,
+    const std::function<bool(ignition::math::graph::VertexId)> &_stopAt = {})
 {
   using DirectedEdge = typename ScopedGraph<T>::Edge;
   using Vertex = typename ScopedGraph<T>::Vertex;
@@ -186,6 +209,11 @@ FindSinkVertex(
           vertex.get().Name() + "]."});
       return PairType(Vertex::NullVertex, EdgesType());
     }
+    if (_stopAt && _stopAt(vertex.get().Id()))
+    {
+      // The sink of this vertex is already known.
+      return PairType(vertex, edges);
+    }
     visited.insert(vertex.get().Id());
     incidentsFrom = _graph.Graph().IncidentsFrom(vertex);
   }
@@ -277,6 +305,9 @@ static Errors resolveModelPoseWithPlacementFrame(const sdf::Model &_model,
 Errors buildFrameAttachedToGraph(
     ScopedGraph<FrameAttachedToGraph> &_out, const Model *_model, bool _root)
 {
+  SDF_TRACE_SCOPE_TEXT("sdf::buildFrameAttachedToGraph",
+      std::string(_model ? _model->Name() : ""));
+  LoadPhaseTimer timer(LoadPhase::FRAME_GRAPH_BUILD);
   Errors errors;
 
   if (!_model)
@@ -496,6 +527,9 @@ Errors buildFrameAttachedToGraph(
 Errors buildFrameAttachedToGraph(
             ScopedGraph<FrameAttachedToGraph> &_out, const World *_world)
 {
+  SDF_TRACE_SCOPE_TEXT("sdf::buildFrameAttachedToGraph",
+      std::string(_world ? _world->Name() : ""));
+  LoadPhaseTimer timer(LoadPhase::FRAME_GRAPH_BUILD);
   Errors errors;
 
   if (!_world)
@@ -597,6 +631,9 @@ Errors buildFrameAttachedToGraph(
 Errors buildPoseRelativeToGraph(
     ScopedGraph<PoseRelativeToGraph> &_out, const Model *_model, bool _root)
 {
+  SDF_TRACE_SCOPE_TEXT("sdf::buildPoseRelativeToGraph",
+      std::string(_model ? _model->Name() : ""));
+  LoadPhaseTimer timer(LoadPhase::FRAME_GRAPH_BUILD);
   Errors errors;
 
   if (!_model)
@@ -895,6 +932,9 @@ Errors buildPoseRelativeToGraph(
 Errors buildPoseRelativeToGraph(
     ScopedGraph<PoseRelativeToGraph> &_out, const World *_world)
 {
+  SDF_TRACE_SCOPE_TEXT("sdf::buildPoseRelativeToGraph",
+      std::string(_world ? _world->Name() : ""));
+  LoadPhaseTimer timer(LoadPhase::FRAME_GRAPH_BUILD);
   Errors errors;
 
   if (!_world)
@@ -1063,6 +1103,8 @@ Errors buildPoseRelativeToGraph(
 Errors validateFrameAttachedToGraph(
     const ScopedGraph<FrameAttachedToGraph> &_in)
 {
+  SDF_TRACE_SCOPE("sdf::validateFrameAttachedToGraph");
+  LoadPhaseTimer timer(LoadPhase::FRAME_GRAPH_VALIDATE);
   Errors errors;
 
   // Expect ScopeContextName to be either "__model__" or "world"
@@ -1289,6 +1331,8 @@ Errors validateFrameAttachedToGraph(
 Errors validatePoseRelativeToGraph(
     const ScopedGraph<PoseRelativeToGraph> &_in)
 {
+  SDF_TRACE_SCOPE("sdf::validatePoseRelativeToGraph");
+  LoadPhaseTimer timer(LoadPhase::FRAME_GRAPH_VALIDATE);
   Errors errors;
 
   // Expect scopeContextName to be either "__model__" or "world"
@@ -1498,21 +1542,54 @@ Errors resolveFrameAttachedToBody(
   }
   auto vertexId = _in.VertexIdByName(_vertexName);
 
-  auto sinkVertexEdges = FindSinkVertex(_in, vertexId, errors);
-  auto sinkVertex = sinkVertexEdges.first;
-
-  if (!errors.empty())
+  // The sink of every vertex on the walked path is cached, so resolving
+  // the bodies of all the frames of a graph walks each edge once.
+  const FrameAttachedToGraph &data = _in.GraphData();
+  std::lock_guard<std::mutex> lock(data.cache.mutex);
+  if (data.cache.version != data.version)
   {
-    return errors;
+    data.cache.sinks.clear();
+    data.cache.version = data.version;
   }
+  auto &sinks = data.cache.sinks;
 
-  if (!sinkVertex.Valid())
+  auto cachedSink = sinks.find(vertexId);
+  if (cachedSink == sinks.end())
   {
-    errors.push_back({ErrorCode::FRAME_ATTACHED_TO_GRAPH_ERROR,
-        "FrameAttachedToGraph unable to find sink vertex when starting "
-        "from vertex with name [" + _vertexName + "]."});
-    return errors;
+    auto sinkVertexEdges = FindSinkVertex(_in, vertexId, errors,
+        [&sinks](ignition::math::graph::VertexId _id)
+        {
+          return sinks.count(_id) > 0;
+        });
+
+    if (!errors.empty())
+    {
+      return errors;
+    }
+
+    if (!sinkVertexEdges.first.Valid())
+    {
+      errors.push_back({ErrorCode::FRAME_ATTACHED_TO_GRAPH_ERROR,
+          "FrameAttachedToGraph unable to find sink vertex when starting "
+          "from vertex with name [" + _vertexName + "]."});
+      return errors;
+    }
+
+    auto sinkId = sinkVertexEdges.first.Id();
+    auto known = sinks.find(sinkId);
+    if (known != sinks.end())
+    {
+      sinkId = known->second;
+    }
+
+    sinks[vertexId] = sinkId;
+    for (const auto &edge : sinkVertexEdges.second)
+    {
+      sinks[edge.Tail()] = sinkId;
+    }
+    cachedSink = sinks.find(vertexId);
   }
+  auto sinkVertex = _in.Graph().VertexFromId(cachedSink->second);
 
   if (_in.ScopeContextName() == "world" &&
       !(sinkVertex.Data() == FrameType::WORLD ||
@@ -1574,14 +1651,54 @@ Errors resolvePoseRelativeToRoot(
       _pose, _graph, _graph.VertexIdByName(_vertexName));
 }
 /////////////////////////////////////////////////
-Errors resolvePoseRelativeToRoot(
+/// \brief Get the poses cached for the scope of a graph, discarding them if
+/// the graph was modified. The cache must be locked.
+/// \param[in] _graph Scope of the cached poses.
+/// \return Cached poses relative to the scope vertex.
+static std::unordered_map<ignition::math::graph::VertexId,
+    ignition::math::Pose3d> &cachedScopePoses(
+      const ScopedGraph<PoseRelativeToGraph> &_graph)
+{
+  const PoseRelativeToGraph &data = _graph.GraphData();
+  if (data.cache.version != data.version)
+  {
+    data.cache.poses.clear();
+    data.cache.version = data.version;
+  }
+  return data.cache.poses[_graph.ScopeVertexId()];
+}
+
+/////////////////////////////////////////////////
+/// \brief Resolve the pose of a vertex relative to the scope vertex, with
+/// the cache locked.
+/// \param[out] _pose Pose object to write.
+/// \param[in] _graph PoseRelativeToGraph to read from.
+/// \param[in] _vertexId Vertex whose pose is to be computed.
+/// \param[in,out] _cached Poses cached for the scope of _graph.
+/// \return Errors.
+static Errors resolveCachedPoseRelativeToRoot(
       ignition::math::Pose3d &_pose,
       const ScopedGraph<PoseRelativeToGraph> &_graph,
-      const ignition::math::graph::VertexId &_vertexId)
+      const ignition::math::graph::VertexId &_vertexId,
+      std::unordered_map<ignition::math::graph::VertexId,
+          ignition::math::Pose3d> &_cached)
 {
   Errors errors;
+  const auto scopeId = _graph.ScopeVertexId();
+  {
+    auto it = _cached.find(_vertexId);
+    if (it != _cached.end())
+    {
+      _pose = it->second;
+      return errors;
+    }
+  }
 
-  auto incomingVertexEdges = FindSourceVertex(_graph, _vertexId, errors);
+  auto incomingVertexEdges = FindSourceVertex(_graph, _vertexId, errors,
+      [&_cached](ignition::math::graph::VertexId _id)
+      {
+        return _cached.count(_id) > 0;
+      });
 
   if (!errors.empty())
   {
@@ -1595,7 +1712,8 @@ Errors resolvePoseRelativeToRoot(
             std::to_string(_vertexId) + "]."});
     return errors;
   }
-  else if (incomingVertexEdges.first.Id() != _graph.ScopeVertex().Id())
+  else if (incomingVertexEdges.first.Id() != _graph.ScopeVertex().Id() &&
+           _cached.count(incomingVertexEdges.first.Id()) == 0)
   {
     errors.push_back({ErrorCode::POSE_RELATIVE_TO_GRAPH_ERROR,
         "PoseRelativeToGraph frame with name [" + std::to_string(_vertexId) +
@@ -1606,9 +1724,18 @@ Errors resolvePoseRelativeToRoot(
   }
 
   ignition::math::Pose3d pose;
-  for (auto const &edge : incomingVertexEdges.second)
+  if (incomingVertexEdges.first.Id() != scopeId)
   {
-    pose = edge.Data() * pose;
+    pose = _cached[incomingVertexEdges.first.Id()];
+  }
+
+  // Compose the poses from the source down to the vertex, caching the
+  // pose of each vertex on the way.
+  const auto &edges = incomingVertexEdges.second;
+  for (auto edge = edges.rbegin(); edge != edges.rend(); ++edge)
+  {
+    pose = pose * edge->Data();
+    _cached[edge->Head()] = pose;
   }
 
   if (errors.empty())
@@ -1619,25 +1746,45 @@ Errors resolvePoseRelativeToRoot(
   return errors;
 }
 
+/////////////////////////////////////////////////
+Errors resolvePoseRelativeToRoot(
+      ignition::math::Pose3d &_pose,
+      const ScopedGraph<PoseRelativeToGraph> &_graph,
+      const ignition::math::graph::VertexId &_vertexId)
+{
+  // Poses are cached relative to the scope vertex, and every vertex on the
+  // path to the scope is cached as it is resolved, so resolving all the
+  // frames of a graph walks each edge once.
+  std::lock_guard<std::mutex> lock(_graph.GraphData().cache.mutex);
+  return resolveCachedPoseRelativeToRoot(
+      _pose, _graph, _vertexId, cachedScopePoses(_graph));
+}
+
 /////////////////////////////////////////////////
 Errors resolvePose(ignition::math::Pose3d &_pose,
     const ScopedGraph<PoseRelativeToGraph> &_graph,
     const ignition::math::graph::VertexId &_frameVertexId,
     const ignition::math::graph::VertexId &_resolveToVertexId)
 {
-  Errors errors = resolvePoseRelativeToRoot(_pose, _graph, _frameVertexId);
+  // Both frames are resolved under one lock of the cache, so that once
+  // their poses are cached a query costs two lookups.
+  std::lock_guard<std::mutex> lock(_graph.GraphData().cache.mutex);
+  auto &cached = cachedScopePoses(_graph);
+  Errors errors = resolveCachedPoseRelativeToRoot(
+      _pose, _graph, _frameVertexId, cached);
 
   // If the resolveTo is empty, we're resolving to the Root, so we're done
   if (_resolveToVertexId != ignition::math::graph::kNullId)
   {
     ignition::math::Pose3d poseR;
-    Errors errorsR =
-        resolvePoseRelativeToRoot(poseR, _graph, _resolveToVertexId);
+    Errors errorsR = resolveCachedPoseRelativeToRoot(
+        poseR, _graph, _resolveToVertexId, cached);
     errors.insert(errors.end(), errorsR.begin(), errorsR.end());
 
     if (errors.empty())
     {
-      _pose = poseR.Inverse() * _pose;
+      _pose = _resolveToVertexId == _frameVertexId ?
+          ignition::math::Pose3d::Zero : poseR.Inverse() * _pose;
     }
   }
 
@@ -1670,5 +1817,681 @@ Errors resolvePose(
   return resolvePose(_pose, _graph, _graph.VertexIdByName(_frameName),
       _graph.VertexIdByName(_resolveTo));
 }
+
+/////////////////////////////////////////////////
+Errors resolveAllPosesRelativeToRoot(
+    ResolvedVertexPoses &_poses,
+    const ScopedGraph<PoseRelativeToGraph> &_graph)
+{
+  SDF_TRACE_SCOPE("sdf::resolveAllPosesRelativeToRoot");
+  Errors errors;
+  _poses.clear();
+
+  if (!_graph)
+  {
+    errors.push_back({ErrorCode::POSE_RELATIVE_TO_GRAPH_ERROR,
+        "Invalid pointer to PoseRelativeToGraph."});
+    return errors;
+  }
+
+  const auto &graph = _graph.Graph();
+  _poses.reserve(graph.Vertices().size());
+
+  // Walk the tree from the scope vertex one level at a time, composing the
+  // edges of each level as a batch.
+  std::vector<ignition::math::graph::VertexId> level{_graph.ScopeVertexId()};
+  PoseBatch levelPoses(1);
+  _poses.emplace(_graph.ScopeVertexId(), ignition::math::Pose3d::Zero);
+
+  std::vector<ignition::math::graph::VertexId> next;
+  std::vector<std::size_t> parents;
+  std::vector<const ignition::math::Pose3d *> edgePoses;
+  std::vector<ignition::math::Pose3d *> resolved;
+  PoseBatch parentPoses;
+  PoseBatch childPoses;
+  while (!level.empty())
+  {
+    next.clear();
+    parents.clear();
+    edgePoses.clear();
+    resolved.clear();
+    for (std::size_t i = 0; i < level.size(); ++i)
+    {
+      for (const auto &edgePair : graph.IncidentsFrom(level[i]))
+      {
+        const auto &edge = edgePair.second.get();
+        auto inserted = _poses.emplace(edge.Head(), ignition::math::Pose3d());
+        if (!inserted.second)
+        {
+          errors.push_back({ErrorCode::POSE_RELATIVE_TO_GRAPH_ERROR,
+              "PoseRelativeToGraph error: multiple incoming edges to "
+              "vertex [" + graph.VertexFromId(edge.Head()).Name() + "]."});
+          continue;
+        }
+        next.push_back(edge.Head());
+        parents.push_back(i);
+        edgePoses.push_back(&edge.Data());
+        resolved.push_back(&inserted.first->second);
+      }
+    }
+
+    parentPoses.Resize(next.size());
+    childPoses.Resize(next.size());
+    for (std::size_t j = 0; j < next.size(); ++j)
+    {
+      parentPoses.Set(j, levelPoses.Get(parents[j]));
+      childPoses.Set(j, *edgePoses[j]);
+    }
+    composePoses(next.size(), parentPoses.Arrays(), childPoses.Arrays(),
+        childPoses.Arrays());
+    for (std::size_t j = 0; j < next.size(); ++j)
+      *resolved[j] = childPoses.Get(j);
+
+    std::swap(levelPoses, childPoses);
+    level.swap(next);
+  }
+
+  return errors;
+}
+
+/////////////////////////////////////////////////
+void appendModelPoses(const Model &_model, const std::string &_scope,
+    const ScopedGraph<PoseRelativeToGraph> &_graph,
+    const ResolvedVertexPoses &_resolved,
+    std::vector<ignition::math::Pose3d> &_poses,
+    std::vector<std::string> &_names, Errors &_errors)
+{
+  // Append an entity whose pose is _rawPose relative to a vertex.
+  auto append = [&](const std::string &_name, const std::string &_vertex,
+      const ignition::math::Pose3d &_rawPose)
+  {
+    _names.push_back(_scope + _name);
+    auto it = _resolved.find(_graph.VertexIdByName(_scope + _vertex));
+    if (it == _resolved.end())
+    {
+      _errors.push_back({ErrorCode::POSE_RELATIVE_TO_GRAPH_ERROR,
+          "Unable to resolve pose of [" + _scope + _name +
+          "], frame [" + _scope + _vertex + "] is not connected to the "
+          "root of the PoseRelativeToGraph."});
+      _poses.push_back(ignition::math::Pose3d::Zero);
+      return;
+    }
+    _poses.push_back(it->second * _rawPose);
+  };
+
+  // Append an entity that is attached to a link.
+  auto appendChild = [&](const std::string &_link, const auto &_child)
+  {
+    const std::string &relativeTo = _child.PoseRelativeTo();
+    append(_link + "::" + _child.Name(),
+        relativeTo.empty() ? _link : relativeTo, _child.RawPose());
+  };
+
+  for (uint64_t i = 0; i < _model.LinkCount(); ++i)
+  {
+    const Link *link = _model.LinkByIndex(i);
+    append(link->Name(), link->Name(), ignition::math::Pose3d::Zero);
+    for (uint64_t j = 0; j < link->VisualCount(); ++j)
+      appendChild(link->Name(), *link->VisualByIndex(j));
+    for (uint64_t j = 0; j < link->CollisionCount(); ++j)
+      appendChild(link->Name(), *link->CollisionByIndex(j));
+    for (uint64_t j = 0; j < link->SensorCount(); ++j)
+      appendChild(link->Name(), *link->SensorByIndex(j));
+  }
+
+  for (uint64_t i = 0; i < _model.JointCount(); ++i)
+  {
+    const std::string &name = _model.JointByIndex(i)->Name();
+    append(name, name, ignition::math::Pose3d::Zero);
+  }
+
+  for (uint64_t i = 0; i < _model.FrameCount(); ++i)
+  {
+    const std::string &name = _model.FrameByIndex(i)->Name();
+    append(name, name, ignition::math::Pose3d::Zero);
+  }
+
+  for (uint64_t i = 0; i < _model.ModelCount(); ++i)
+  {
+    const Model *nested = _model.ModelByIndex(i);
+    append(nested->Name(), nested->Name(), ignition::math::Pose3d::Zero);
+    appendModelPoses(*nested, _scope + nested->Name() + "::", _graph,
+        _resolved, _poses, _names, _errors);
+  }
+}
+
+/////////////////////////////////////////////////
+/// \brief Get the local names of a model vertex and of the vertices in the
+/// scope of that model, in order of their absolute names.
+/// \param[in] _graph Scope that contains the model.
+/// \param[in] _modelName Local name of the model.
+/// \return Local names in _graph.
+template <typename T>
+static std::vector<std::string> modelScopeVertexNames(
+    const ScopedGraph<T> &_graph, const std::string &_modelName)
+{
+  const std::string prefix = _modelName + "::";
+  std::vector<std::string> names;
+  for (const std::string &name : _graph.VertexNames())
+  {
+    if (name == _modelName || 0 == name.compare(0, prefix.size(), prefix))
+      names.push_back(name);
+  }
+  return names;
+}
+
+/////////////////////////////////////////////////
+/// \brief Follow the single edge out of (or into) each vertex, starting at a
+/// vertex, and check whether another vertex is reached.
+/// \param[in] _graph Graph to read from.
+/// \param[in] _start Vertex to start from.
+/// \param[in] _target Vertex to look for.
+/// \param[in] _outgoing True to follow outgoing edges, false to follow
+/// incoming edges.
+/// \return True if _target is reached, or if the walk does not end, which
+/// only happens if the graph already has a cycle.
+template <typename T>
+static bool reaches(const ScopedGraph<T> &_graph,
+    ignition::math::graph::VertexId _start,
+    ignition::math::graph::VertexId _target, bool _outgoing)
+{
+  std::size_t steps = _graph.Map().size();
+  for (auto id = _start; steps > 0; --steps)
+  {
+    if (id == _target)
+      return true;
+    const auto edges = _outgoing ? _graph.Graph().IncidentsFrom(id) :
+        _graph.Graph().IncidentsTo(id);
+    if (edges.empty())
+      return false;
+    const auto &edge = edges.begin()->second.get();
+    id = _outgoing ? edge.Head() : edge.Tail();
+  }
+  return true;
+}
+
+/////////////////////////////////////////////////
+Errors insertModelScope(ScopedGraph<FrameAttachedToGraph> &_graph,
+    const Model *_model)
+{
+  Errors errors;
+  if (!_model)
+  {
+    errors.push_back({ErrorCode::ELEMENT_INVALID,
+        "Invalid sdf::Model pointer."});
+    return errors;
+  }
+  else if (_graph.Count(_model->Name()) > 0)
+  {
+    errors.push_back({ErrorCode::DUPLICATE_NAME,
+        "Model with non-unique name [" + _model->Name() +
+        "] detected in FrameAttachedToGraph."});
+    return errors;
+  }
+
+  errors = buildFrameAttachedToGraph(_graph, _model, false);
+
+  // Frames outside the model can not be attached to it yet, so only the
+  // new vertices need to lead to a link.
+  for (const auto &name : modelScopeVertexNames(_graph, _model->Name()))
+  {
+    std::string resolvedBody;
+    Errors e = resolveFrameAttachedToBody(resolvedBody, _graph, name);
+    errors.insert(errors.end(), e.begin(), e.end());
+  }
+  return errors;
+}
+
+/////////////////////////////////////////////////
+Errors insertModelScope(ScopedGraph<PoseRelativeToGraph> &_graph,
+    const Model *_model)
+{
+  Errors errors;
+  if (!_model)
+  {
+    errors.push_back({ErrorCode::ELEMENT_INVALID,
+        "Invalid sdf::Model pointer."});
+    return errors;
+  }
+  else if (_graph.Count(_model->Name()) > 0)
+  {
+    errors.push_back({ErrorCode::DUPLICATE_NAME,
+        "Model with non-unique name [" + _model->Name() +
+        "] detected in PoseRelativeToGraph."});
+    return errors;
+  }
+
+  errors = buildPoseRelativeToGraph(_graph, _model, false);
+
+  // if relative_to is empty, add edge from the scope vertex to the model
+  auto relativeToId = _graph.ScopeVertexId();
+  const std::string &relativeTo = _model->PoseRelativeTo();
+  if (!relativeTo.empty())
+  {
+    if (_graph.Count(relativeTo) != 1)
+    {
+      errors.push_back({ErrorCode::POSE_RELATIVE_TO_INVALID,
+          "relative_to name[" + relativeTo +
+          "] specified by model with name[" + _model->Name() +
+          "] does not match a model or frame name in PoseRelativeToGraph."});
+      return errors;
+    }
+    relativeToId = _graph.VertexIdByName(relativeTo);
+  }
+
+  const auto modelId = _graph.VertexIdByName(_model->Name());
+  if (reaches(_graph, relativeToId, modelId, false))
+  {
+    errors.push_back({ErrorCode::POSE_RELATIVE_TO_CYCLE,
+        "relative_to name[" + relativeTo +
+        "] specified by model with name[" + _model->Name() +
+        "] causes a graph cycle in PoseRelativeToGraph."});
+    return errors;
+  }
+
+  ignition::math::Pose3d resolvedModelPose = _model->RawPose();
+  Errors resolveErrors = resolveModelPoseWithPlacementFrame(*_model,
+      _graph.ChildModelScope(_model->Name()), resolvedModelPose);
+  errors.insert(errors.end(), resolveErrors.begin(), resolveErrors.end());
+  _graph.AddEdge({relativeToId, modelId}, resolvedModelPose);
+
+  for (const auto &name : modelScopeVertexNames(_graph, _model->Name()))
+  {
+    ignition::math::Pose3d pose;
+    Errors e = resolvePoseRelativeToRoot(pose, _graph, name);
+    errors.insert(errors.end(), e.begin(), e.end());
+  }
+  return errors;
+}
+
+/////////////////////////////////////////////////
+/// \brief Remove a model, and the vertices of its scope, from a graph.
+/// \param[in,out] _graph Scope that contains the model.
+/// \param[in] _modelName Local name of the model.
+/// \param[in] _outgoing True if the edges of the graph point from a frame to
+/// the frame it depends on, as in a FrameAttachedToGraph.
+/// \param[in] _code Error code for frames that depended on a removed vertex.
+/// \return Errors.
+template <typename T>
+static Errors removeModelScopeImpl(ScopedGraph<T> &_graph,
+    const std::string &_modelName, bool _outgoing, ErrorCode _code)
+{
+  Errors errors;
+  if (_graph.Count(_modelName) != 1)
+  {
+    errors.push_back({ErrorCode::ELEMENT_MISSING,
+        "Unable to find unique model with name [" + _modelName +
+        "] in graph."});
+    return errors;
+  }
+
+  std::vector<ignition::math::graph::VertexId> removed;
+  for (const auto &name : modelScopeVertexNames(_graph, _modelName))
+    removed.push_back(_graph.VertexIdByName(name));
+  std::sort(removed.begin(), removed.end());
+
+  // Find the frames that remain and depend on a removed vertex.
+  std::vector<std::string> dependents;
+  for (const auto id : removed)
+  {
+    const auto edges = _outgoing ? _graph.Graph().IncidentsTo(id) :
+        _graph.Graph().IncidentsFrom(id);
+    for (const auto &edgePair : edges)
+    {
+      const auto &edge = edgePair.second.get();
+      const auto dependent = _outgoing ? edge.Tail() : edge.Head();
+      if (!std::binary_search(removed.begin(), removed.end(), dependent))
+        dependents.push_back(_graph.VertexLocalName(dependent));
+    }
+  }
+
+  for (const auto id : removed)
+    _graph.RemoveVertex(id);
+
+  std::sort(dependents.begin(), dependents.end());
+  for (const auto &name : dependents)
+  {
+    errors.push_back({_code,
+        "Frame with name [" + name + "] depended on a vertex of removed "
+        "model with name [" + _modelName + "]."});
+  }
+  return errors;
+}
+
+/////////////////////////////////////////////////
+Errors removeModelScope(ScopedGraph<FrameAttachedToGraph> &_graph,
+    const std::string &_modelName)
+{
+  return removeModelScopeImpl(_graph, _modelName, true,
+      ErrorCode::FRAME_ATTACHED_TO_GRAPH_ERROR);
+}
+
+/////////////////////////////////////////////////
+Errors removeModelScope(ScopedGraph<PoseRelativeToGraph> &_graph,
+    const std::string &_modelName)
+{
+  return removeModelScopeImpl(_graph, _modelName, false,
+      ErrorCode::POSE_RELATIVE_TO_GRAPH_ERROR);
+}
+
+/////////////////////////////////////////////////
+/// \brief An edge from a frame outside a model to a vertex of its scope.
+/// \tparam D Type of the data of the edge.
+template <typename D>
+struct ModelScopeDependent
+{
+  /// \brief Local name of the frame outside the model.
+  std::string name;
+
+  /// \brief Local name of the vertex of the model scope.
+  std::string target;
+
+  /// \brief Data of the edge.
+  D data;
+};
+
+/////////////////////////////////////////////////
+/// \brief Find the frames outside a model that depend on a vertex of its
+/// scope.
+/// \param[in] _graph Scope that contains the model.
+/// \param[in] _modelName Local name of the model.
+/// \param[in] _outgoing True if the edges of the graph point from a frame to
+/// the frame it depends on, as in a FrameAttachedToGraph.
+/// \return The edges from the dependent frames, or nothing if the model
+/// isn't found.
+template <typename D, typename T>
+static std::vector<ModelScopeDependent<D>> modelScopeDependents(
+    const ScopedGraph<T> &_graph, const std::string &_modelName,
+    bool _outgoing)
+{
+  std::vector<ModelScopeDependent<D>> dependents;
+  if (_graph.Count(_modelName) != 1)
+    return dependents;
+
+  std::vector<ignition::math::graph::VertexId> scope;
+  for (const auto &name : modelScopeVertexNames(_graph, _modelName))
+    scope.push_back(_graph.VertexIdByName(name));
+  std::sort(scope.begin(), scope.end());
+
+  for (const auto id : scope)
+  {
+    const auto edges = _outgoing ? _graph.Graph().IncidentsTo(id) :
+        _graph.Graph().IncidentsFrom(id);
+    for (const auto &edgePair : edges)
+    {
+      const auto &edge = edgePair.second.get();
+      const auto dependent = _outgoing ? edge.Tail() : edge.Head();
+      if (!std::binary_search(scope.begin(), scope.end(), dependent))
+      {
+        dependents.push_back({_graph.VertexLocalName(dependent),
+            _graph.VertexLocalName(id), edge.Data()});
+      }
+    }
+  }
+  return dependents;
+}
+
+/////////////////////////////////////////////////
+/// \brief Remove the errors of removeModelScope about dependent frames,
+/// which are reconnected when a model is replaced.
+/// \param[in,out] _errors Errors of removeModelScope.
+/// \param[in] _code Error code of the dependent frames.
+static void dropDependentErrors(Errors &_errors, ErrorCode _code)
+{
+  _errors.erase(std::remove_if(_errors.begin(), _errors.end(),
+      [_code](const Error &_error)
+      {
+        return _error.Code() == _code;
+      }), _errors.end());
+}
+
+/////////////////////////////////////////////////
+Errors replaceModelScope(ScopedGraph<FrameAttachedToGraph> &_graph,
+    const std::string &_modelName, const Model *_model)
+{
+  Errors errors;
+  if (!_model)
+  {
+    errors.push_back({ErrorCode::ELEMENT_INVALID,
+        "Invalid sdf::Model pointer."});
+    return errors;
+  }
+
+  const auto dependents =
+      modelScopeDependents<bool>(_graph, _modelName, true);
+  errors = removeModelScope(_graph, _modelName);
+  dropDependentErrors(errors, ErrorCode::FRAME_ATTACHED_TO_GRAPH_ERROR);
+  if (!errors.empty())
+    return errors;
+
+  errors = insertModelScope(_graph, _model);
+  for (const auto &dependent : dependents)
+  {
+    Errors e = updateFrameAttachedTo(_graph, dependent.name,
+        dependent.target);
+    errors.insert(errors.end(), e.begin(), e.end());
+  }
+  return errors;
+}
+
+/////////////////////////////////////////////////
+Errors replaceModelScope(ScopedGraph<PoseRelativeToGraph> &_graph,
+    const std::string &_modelName, const Model *_model)
+{
+  Errors errors;
+  if (!_model)
+  {
+    errors.push_back({ErrorCode::ELEMENT_INVALID,
+        "Invalid sdf::Model pointer."});
+    return errors;
+  }
+
+  const auto dependents = modelScopeDependents<ignition::math::Pose3d>(
+      _graph, _modelName, false);
+  errors = removeModelScope(_graph, _modelName);
+  dropDependentErrors(errors, ErrorCode::POSE_RELATIVE_TO_GRAPH_ERROR);
+  if (!errors.empty())
+    return errors;
+
+  errors = insertModelScope(_graph, _model);
+  for (const auto &dependent : dependents)
+  {
+    Errors e = updatePoseRelativeTo(_graph, dependent.name,
+        dependent.target, dependent.data);
+    errors.insert(errors.end(), e.begin(), e.end());
+  }
+  return errors;
+}
+
+/////////////////////////////////////////////////
+Errors updateFrameAttachedTo(ScopedGraph<FrameAttachedToGraph> &_graph,
+    const std::string &_vertexName, const std::string &_attachedTo)
+{
+  Errors errors;
+  for (const auto &name : {_vertexName, _attachedTo})
+  {
+    if (_graph.Count(name) != 1)
+    {
+      errors.push_back({ErrorCode::FRAME_ATTACHED_TO_INVALID,
+          "FrameAttachedToGraph unable to find unique frame with name [" +
+          name + "] in graph."});
+      return errors;
+    }
+  }
+
+  const auto vertexId = _graph.VertexIdByName(_vertexName);
+  const auto attachedToId = _graph.VertexIdByName(_attachedTo);
+  if (reaches(_graph, attachedToId, vertexId, true))
+  {
+    errors.push_back({ErrorCode::FRAME_ATTACHED_TO_CYCLE,
+        "attached_to name[" + _attachedTo + "] of frame with name[" +
+        _vertexName + "] causes a graph cycle in FrameAttachedToGraph."});
+    return errors;
+  }
+
+  std::vector<ignition::math::graph::EdgeId> edges;
+  for (const auto &edgePair : _graph.Graph().IncidentsFrom(vertexId))
+    edges.push_back(edgePair.first);
+  for (const auto id : edges)
+    _graph.RemoveEdge(id);
+  _graph.AddEdge({vertexId, attachedToId}, true);
+
+  // Every frame attached to this one leads to the same body, so checking
+  // this frame checks them all.
+  std::string resolvedBody;
+  return resolveFrameAttachedToBody(resolvedBody, _graph, _vertexName);
+}
+
+/////////////////////////////////////////////////
+Errors updatePoseRelativeTo(ScopedGraph<PoseRelativeToGraph> &_graph,
+    const std::string &_vertexName, const std::string &_relativeTo,
+    const ignition::math::Pose3d &_pose)
+{
+  Errors errors;
+  for (const auto &name : {_vertexName, _relativeTo})
+  {
+    if (_graph.Count(name) != 1)
+    {
+      errors.push_back({ErrorCode::POSE_RELATIVE_TO_INVALID,
+          "PoseRelativeToGraph unable to find unique frame with name [" +
+          name + "] in graph."});
+      return errors;
+    }
+  }
+
+  const auto vertexId = _graph.VertexIdByName(_vertexName);
+  const auto relativeToId = _graph.VertexIdByName(_relativeTo);
+  if (reaches(_graph, relativeToId, vertexId, false))
+  {
+    errors.push_back({ErrorCode::POSE_RELATIVE_TO_CYCLE,
+        "relative_to name[" + _relativeTo + "] of frame with name[" +
+        _vertexName + "] causes a graph cycle in PoseRelativeToGraph."});
+    return errors;
+  }
+
+  std::vector<ignition::math::graph::EdgeId> edges;
+  for (const auto &edgePair : _graph.Graph().IncidentsTo(vertexId))
+    edges.push_back(edgePair.first);
+  for (const auto id : edges)
+    _graph.RemoveEdge(id);
+  _graph.AddEdge({relativeToId, vertexId}, _pose);
+
+  // Every frame relative to this one is resolved through it, so checking
+  // this frame checks them all.
+  ignition::math::Pose3d pose;
+  return resolvePoseRelativeToRoot(pose, _graph, vertexId);
+}
+
+/////////////////////////////////////////////////
+Errors applyStatePoses(ScopedGraph<PoseRelativeToGraph> &_graph,
+    const StateFrame &_state)
+{
+  using ignition::math::graph::VertexId;
+  using ignition::math::graph::kNullId;
+
+  Errors errors;
+  const auto &graph = _graph.Graph();
+  const ignition::math::Pose3d *modelPoses = _state.ModelPoses();
+  const std::size_t *modelParents = _state.ModelParents();
+
+  // The state names are scoped like the vertices of the world graph, so
+  // the name index of the graph finds them directly.
+  auto vertexOfType = [&_graph, &graph](const std::string &_name,
+      std::initializer_list<FrameType> _types)
+  {
+    const VertexId id = _graph.VertexIdByName(_name);
+    if (id == kNullId)
+      return kNullId;
+    const FrameType type = graph.VertexFromId(id).Data();
+    for (const FrameType t : _types)
+    {
+      if (type == t)
+        return id;
+    }
+    return kNullId;
+  };
+
+  std::vector<VertexId> moved;
+  moved.reserve(_state.ModelCount() + _state.LinkCount());
+
+  // Frame vertex of each model of the state, or kNullId if the model is not
+  // in the graph.
+  std::vector<VertexId> modelFrames(_state.ModelCount(), kNullId);
+  std::string frameName;
+  for (std::size_t m = 0; m < _state.ModelCount(); ++m)
+  {
+    const std::string &name = _state.ModelName(m);
+    const std::size_t parent = modelParents[m];
+    const VertexId id = vertexOfType(name,
+        {FrameType::MODEL, FrameType::STATIC_MODEL});
+    if (id == kNullId ||
+        (parent != StateFrame::kInvalidIndex && modelFrames[parent] == kNullId))
+    {
+      errors.push_back({ErrorCode::ELEMENT_MISSING,
+          "State of model with name[" + name +
+          "] does not match a model of the world."});
+      continue;
+    }
+
+    frameName.assign(name).append("::__model__");
+    modelFrames[m] = _graph.VertexIdByName(frameName);
+    if (parent == StateFrame::kInvalidIndex)
+    {
+      _graph.ReplaceIncomingEdges({_graph.ScopeVertexId(), id},
+          modelPoses[m]);
+    }
+    else
+    {
+      _graph.ReplaceIncomingEdges({modelFrames[parent], id},
+          modelPoses[parent].Inverse() * modelPoses[m]);
+    }
+    moved.push_back(id);
+  }
+
+  const ignition::math::Pose3d *linkPoses = _state.LinkPoses();
+  const std::size_t *linkModels = _state.LinkModels();
+  for (std::size_t l = 0; l < _state.LinkCount(); ++l)
+  {
+    const std::string &name = _state.LinkName(l);
+    const std::size_t model = linkModels[l];
+    const VertexId id = vertexOfType(name, {FrameType::LINK});
+    if (id == kNullId || modelFrames[model] == kNullId)
+    {
+      errors.push_back({ErrorCode::ELEMENT_MISSING,
+          "State of link with name[" + name +
+          "] does not match a link of the world."});
+      continue;
+    }
+
+    _graph.ReplaceIncomingEdges({modelFrames[model], id},
+        modelPoses[model].Inverse() * linkPoses[l]);
+    moved.push_back(id);
+  }
+
+  // The frames below a moved frame are resolved through it, and so are
+  // the only cached poses that change.
+  const PoseRelativeToGraph &data = _graph.GraphData();
+  std::lock_guard<std::mutex> lock(data.cache.mutex);
+  if (data.cache.version != data.version || data.cache.poses.empty())
+    return errors;
+
+  std::unordered_set<VertexId> stale;
+  while (!moved.empty())
+  {
+    const VertexId id = moved.back();
+    moved.pop_back();
+    if (!stale.insert(id).second)
+      continue;
+    for (const auto &edgePair : graph.IncidentsFrom(id))
+      moved.push_back(edgePair.second.get().Head());
+  }
+
+  for (auto &scopePoses : data.cache.poses)
+  {
+    for (const VertexId id : stale)
+      scopePoses.second.erase(id);
+  }
+  return errors;
+}
 }
 }
@@ -17,9 +17,12 @@
 #ifndef SDF_FRAMESEMANTICS_HH_
 #define SDF_FRAMESEMANTICS_HH_
 
-#include <map>
+#include <cstdint>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include <ignition/math/Pose3.hh>
 #include <ignition/math/graph/Graph.hh>
@@ -45,6 +48,7 @@ namespace sdf
   //
   // Forward declaration.
   class Model;
+  class StateFrame;
   class World;
   template <typename T> class ScopedGraph;
 
@@ -82,11 +86,36 @@ namespace sdf
     GraphType graph;
 
     /// \brief A Map from Vertex names to Vertex Ids.
-    using MapType = std::map<std::string, ignition::math::graph::VertexId>;
+    using MapType =
+        std::unordered_map<std::string, ignition::math::graph::VertexId>;
     MapType map;
 
     /// \brief Name of scope vertex, either __model__ or world.
     std::string scopeName;
+
+    /// \brief Incremented by ScopedGraph whenever the graph is modified.
+    std::uint64_t version = 0;
+
+    /// \brief Sink vertices found by resolveFrameAttachedToBody. The sink
+    /// of a vertex does not depend on the scope it is resolved in. The
+    /// entries are discarded when the graph is modified.
+    struct SinkCache
+    {
+      /// \brief Protects the cache, so that bodies can be resolved from
+      /// several threads.
+      std::mutex mutex;
+
+      /// \brief Version of the graph the entries were found for.
+      std::uint64_t version = 0;
+
+      /// \brief Sink vertex of each vertex.
+      std::unordered_map<ignition::math::graph::VertexId,
+          ignition::math::graph::VertexId> sinks;
+    };
+
+    /// \brief Cache of sink vertices. It is mutable because resolving
+    /// bodies does not modify the graph.
+    mutable SinkCache cache;
   };
 
   /// \brief Data structure for pose relative_to graphs for Model or World.
@@ -102,11 +131,36 @@ namespace sdf
     GraphType graph;
 
     /// \brief A Map from Vertex names to Vertex Ids.
-    using MapType = std::map<std::string, ignition::math::graph::VertexId>;
+    using MapType =
+        std::unordered_map<std::string, ignition::math::graph::VertexId>;
     MapType map;
 
     /// \brief Name of source vertex, either __model__ or world.
     std::string sourceName;
+
+    /// \brief Incremented by ScopedGraph whenever the graph is modified.
+    std::uint64_t version = 0;
+
+    /// \brief Poses resolved by resolvePoseRelativeToRoot, relative to the
+    /// scope vertex they were resolved in. The entries are discarded when
+    /// the graph is modified.
+    struct ResolvedPoseCache
+    {
+      /// \brief Protects the cache, so that poses can be resolved from
+      /// several threads.
+      std::mutex mutex;
+
+      /// \brief Version of the graph the entries were resolved for.
+      std::uint64_t version = 0;
+
+      /// \brief Resolved poses, keyed by scope vertex and then by vertex.
+      std::unordered_map<ignition::math::graph::VertexId,
+          std::unordered_map<ignition::math::graph::VertexId, Pose3d>> poses;
+    };
+
+    /// \brief Cache of resolved poses. It is mutable because resolving
+    /// poses does not modify the graph.
+    mutable ResolvedPoseCache cache;
   };
 
   /// \brief Build a FrameAttachedToGraph for a model.
@@ -140,6 +194,8 @@ namespace sdf
 
   /// \brief Confirm that FrameAttachedToGraph is valid by checking the number
   /// of outbound edges for each vertex and checking for graph cycles.
+  /// The graph is only read, so graphs of different models or worlds can be
+  /// validated concurrently.
   /// \param[in] _in Graph object to validate.
   /// \return Errors.
   Errors validateFrameAttachedToGraph(
@@ -147,6 +203,8 @@ namespace sdf
 
   /// \brief Confirm that PoseRelativeToGraph is valid by checking the number
   /// of outbound edges for each vertex and checking for graph cycles.
+  /// Resolved poses are cached under a lock, so graphs of different models
+  /// or worlds can be validated concurrently.
   /// \param[in] _in Graph object to validate.
   /// \return Errors.
   Errors validatePoseRelativeToGraph(
@@ -201,6 +259,136 @@ namespace sdf
       const ScopedGraph<PoseRelativeToGraph> &_graph,
       const ignition::math::graph::VertexId &_frameVertexId,
       const ignition::math::graph::VertexId &_resolveToVertexId);
+
+  /// \brief Add a model to the FrameAttachedToGraph of the world or model
+  /// that contains it, after the graph was built. Only the vertices of the
+  /// new model are validated.
+  /// \param[in,out] _graph Scope of the world or model that contains the
+  /// model.
+  /// \param[in] _model Model to add.
+  /// \return Errors found while adding or validating the model.
+  Errors insertModelScope(ScopedGraph<FrameAttachedToGraph> &_graph,
+      const Model *_model);
+
+  /// \brief Add a model to the PoseRelativeToGraph of the world or model
+  /// that contains it, after the graph was built, including the edge from
+  /// the frame its pose is relative to. Only the vertices of the new model
+  /// are validated.
+  /// \param[in,out] _graph Scope of the world or model that contains the
+  /// model.
+  /// \param[in] _model Model to add.
+  /// \return Errors found while adding or validating the model.
+  Errors insertModelScope(ScopedGraph<PoseRelativeToGraph> &_graph,
+      const Model *_model);
+
+  /// \brief Remove a model, and the vertices of its scope, from a
+  /// FrameAttachedToGraph. Frames that remain and were attached to a
+  /// removed vertex are reported.
+  /// \param[in,out] _graph Scope that contains the model.
+  /// \param[in] _modelName Local name of the model.
+  /// \return Errors.
+  Errors removeModelScope(ScopedGraph<FrameAttachedToGraph> &_graph,
+      const std::string &_modelName);
+
+  /// \brief Remove a model, and the vertices of its scope, from a
+  /// PoseRelativeToGraph. Frames that remain and had their pose relative to
+  /// a removed vertex are reported.
+  /// \param[in,out] _graph Scope that contains the model.
+  /// \param[in] _modelName Local name of the model.
+  /// \return Errors.
+  Errors removeModelScope(ScopedGraph<PoseRelativeToGraph> &_graph,
+      const std::string &_modelName);
+
+  /// \brief Replace a model of a FrameAttachedToGraph with a new version of
+  /// it. Frames outside the model that were attached to a vertex of the old
+  /// model are attached to the vertex with the same name in the new one.
+  /// \param[in,out] _graph Scope that contains the model.
+  /// \param[in] _modelName Local name of the model to replace.
+  /// \param[in] _model New model.
+  /// \return Errors found while adding or validating the new model, or
+  /// reattaching the frames that depended on the old one.
+  Errors replaceModelScope(ScopedGraph<FrameAttachedToGraph> &_graph,
+      const std::string &_modelName, const Model *_model);
+
+  /// \brief Replace a model of a PoseRelativeToGraph with a new version of
+  /// it. Frames outside the model whose pose was relative to a vertex of
+  /// the old model keep their pose, relative to the vertex with the same
+  /// name in the new one.
+  /// \param[in,out] _graph Scope that contains the model.
+  /// \param[in] _modelName Local name of the model to replace.
+  /// \param[in] _model New model.
+  /// \return Errors found while adding or validating the new model, or
+  /// reconnecting the frames that depended on the old one.
+  Errors replaceModelScope(ScopedGraph<PoseRelativeToGraph> &_graph,
+      const std::string &_modelName, const Model *_model);
+
+  /// \brief Attach a frame to another frame in a FrameAttachedToGraph that
+  /// was already built, and validate the frame. The graph is not modified
+  /// if the new edge would cause a cycle.
+  /// \param[in,out] _graph Graph to modify.
+  /// \param[in] _vertexName Name of the frame to attach.
+  /// \param[in] _attachedTo Name of the frame to attach it to.
+  /// \return Errors.
+  Errors updateFrameAttachedTo(ScopedGraph<FrameAttachedToGraph> &_graph,
+      const std::string &_vertexName, const std::string &_attachedTo);
+
+  /// \brief Make the pose of a frame relative to another frame in a
+  /// PoseRelativeToGraph that was already built, and validate the frame.
+  /// The graph is not modified if the new edge would cause a cycle.
+  /// \param[in,out] _graph Graph to modify.
+  /// \param[in] _vertexName Name of the frame to update.
+  /// \param[in] _relativeTo Name of the frame that the pose is relative to.
+  /// \param[in] _pose Pose of the frame relative to _relativeTo.
+  /// \return Errors.
+  Errors updatePoseRelativeTo(ScopedGraph<PoseRelativeToGraph> &_graph,
+      const std::string &_vertexName, const std::string &_relativeTo,
+      const ignition::math::Pose3d &_pose);
+
+  /// \brief Set the poses of the models of a world, and of their links and
+  /// nested models, from a state whose poses are relative to the world
+  /// frame, as Gazebo records them. Top level models are made relative to
+  /// the world frame, and links and nested models to the frame of their
+  /// model. The edges are replaced in place, and only the cached resolved
+  /// poses of the moved frames and of the frames resolved through them are
+  /// discarded.
+  /// \param[in,out] _graph PoseRelativeToGraph of a world.
+  /// \param[in] _state State to apply.
+  /// \return Errors for the models and links of the state that are not in
+  /// the graph, which are skipped with their links and nested models.
+  Errors applyStatePoses(ScopedGraph<PoseRelativeToGraph> &_graph,
+      const StateFrame &_state);
+
+  /// \brief Resolved poses of the vertices of a graph, by vertex id.
+  using ResolvedVertexPoses = std::unordered_map<
+      ignition::math::graph::VertexId, ignition::math::Pose3d>;
+
+  /// \brief Resolve the pose of every vertex reachable from the scope
+  /// vertex of a graph, relative to the scope vertex, in a single sweep.
+  /// \param[out] _poses Resolved poses.
+  /// \param[in] _graph PoseRelativeToGraph to read from.
+  /// \return Errors.
+  Errors resolveAllPosesRelativeToRoot(
+      ResolvedVertexPoses &_poses,
+      const ScopedGraph<PoseRelativeToGraph> &_graph);
+
+  /// \brief Append the resolved poses of the links, visuals, collisions,
+  /// sensors, joints, frames and nested models of a model. Nested models
+  /// are appended recursively after the other entities.
+  /// \param[in] _model Model whose entities are appended.
+  /// \param[in] _scope Scope of the model entities in _graph, ending with
+  /// "::", or empty if _graph is the scope of the model itself. It is also
+  /// prepended to the names.
+  /// \param[in] _graph Graph the poses were resolved from.
+  /// \param[in] _resolved Poses resolved by resolveAllPosesRelativeToRoot.
+  /// \param[out] _poses Poses of the entities.
+  /// \param[out] _names Scoped names of the entities.
+  /// \param[out] _errors Entities whose pose is not resolved are reported
+  /// here, and appended with a zero pose.
+  void appendModelPoses(const Model &_model, const std::string &_scope,
+      const ScopedGraph<PoseRelativeToGraph> &_graph,
+      const ResolvedVertexPoses &_resolved,
+      std::vector<ignition::math::Pose3d> &_poses,
+      std::vector<std::string> &_names, Errors &_errors);
   }
 }
 #endif
@@ -15,14 +15,17 @@
  *
  */
 
+#include <algorithm>
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include <gtest/gtest.h>
 #include <ignition/math/Helpers.hh>
 
 #include "sdf/Element.hh"
 #include "sdf/Frame.hh"
+#include "sdf/LoadStats.hh"
 #include "sdf/Filesystem.hh"
 #include "sdf/Model.hh"
 #include "sdf/Root.hh"
@@ -32,6 +35,7 @@
 #include "sdf/sdf_config.h"
 
 #include "FrameSemantics.hh"
+#include "LoadStatsScope.hh"
 #include "ScopedGraph.hh"
 #include "test_config.h"
 
@@ -300,6 +304,87 @@ TEST(FrameSemantics, buildPoseRelativeToGraph)
         "invalid] in graph."));
 }
 
+/////////////////////////////////////////////////
+TEST(FrameSemantics, resolvePoseCacheInvalidation)
+{
+  auto ownedGraph = std::make_shared<sdf::PoseRelativeToGraph>();
+  sdf::ScopedGraph<sdf::PoseRelativeToGraph> graph(ownedGraph);
+  graph = graph.AddScopeVertex("", "__model__", "__model__",
+      sdf::FrameType::MODEL);
+  const auto rootId = graph.ScopeVertexId();
+
+  // Chain of frames, each one 1 m above the previous one.
+  auto parentId = rootId;
+  for (int i = 0; i < 5; ++i)
+  {
+    const auto id = graph.AddVertex("F" + std::to_string(i),
+        sdf::FrameType::FRAME).Id();
+    graph.AddEdge({parentId, id}, ignition::math::Pose3d(0, 0, 1, 0, 0, 0));
+    parentId = id;
+  }
+
+  // Resolving the tip first caches the whole chain.
+  ignition::math::Pose3d pose;
+  EXPECT_TRUE(sdf::resolvePoseRelativeToRoot(pose, graph, "F4").empty());
+  EXPECT_EQ(ignition::math::Pose3d(0, 0, 5, 0, 0, 0), pose);
+  EXPECT_TRUE(sdf::resolvePoseRelativeToRoot(pose, graph, "F1").empty());
+  EXPECT_EQ(ignition::math::Pose3d(0, 0, 2, 0, 0, 0), pose);
+  EXPECT_TRUE(sdf::resolvePose(pose, graph, "F4", "F1").empty());
+  EXPECT_EQ(ignition::math::Pose3d(0, 0, 3, 0, 0, 0), pose);
+
+  // Updating an edge discards the cached poses.
+  const auto f0 = graph.VertexIdByName("F0");
+  auto edges = graph.Graph().IncidentsTo(f0);
+  ASSERT_EQ(1u, edges.size());
+  auto edge = graph.Graph().EdgeFromId(edges.begin()->first);
+  graph.UpdateEdge(edge, ignition::math::Pose3d(1, 0, 1, 0, 0, 0));
+  EXPECT_TRUE(sdf::resolvePoseRelativeToRoot(pose, graph, "F4").empty());
+  EXPECT_EQ(ignition::math::Pose3d(1, 0, 5, 0, 0, 0), pose);
+
+  // So does adding an edge, which makes the graph invalid.
+  const auto extraId = graph.AddVertex("extra", sdf::FrameType::FRAME).Id();
+  graph.AddEdge({extraId, graph.VertexIdByName("F2")}, {});
+  sdf::Errors errors = sdf::resolvePoseRelativeToRoot(pose, graph, "F4");
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::POSE_RELATIVE_TO_GRAPH_ERROR, errors[0].Code());
+}
+
+/////////////////////////////////////////////////
+TEST(FrameSemantics, ScopedGraphNames)
+{
+  auto ownedGraph = std::make_shared<sdf::FrameAttachedToGraph>();
+  sdf::ScopedGraph<sdf::FrameAttachedToGraph> graph(ownedGraph);
+  graph = graph.AddScopeVertex("", "world", "world", sdf::FrameType::WORLD);
+  auto outer = graph.AddScopeVertex("outer", "__model__", "__model__",
+      sdf::FrameType::MODEL);
+  auto inner = outer.AddScopeVertex("inner", "__model__", "__model__",
+      sdf::FrameType::MODEL);
+  for (const std::string name : {"c", "a", "b"})
+  {
+    outer.AddVertex(name, sdf::FrameType::LINK);
+    inner.AddVertex(name, sdf::FrameType::LINK);
+  }
+
+  // Names are returned in order of their absolute name, whatever the
+  // order in which the vertices were added.
+  const std::vector<std::string> expectedNames = {
+    "__model__", "a", "b", "c", "inner::__model__", "inner::a", "inner::b",
+    "inner::c"};
+  EXPECT_EQ(expectedNames, outer.VertexNames());
+  EXPECT_EQ(9u, graph.VertexNames().size());
+
+  // Lookups use local names, and nested scopes through scoped names.
+  EXPECT_EQ(1u, outer.Count("a"));
+  EXPECT_EQ(1u, outer.Count("inner::a"));
+  EXPECT_EQ(0u, outer.Count("outer::a"));
+  EXPECT_EQ(1u, graph.Count("outer::inner::c"));
+  EXPECT_EQ(inner.VertexIdByName("b"), outer.VertexIdByName("inner::b"));
+  EXPECT_EQ(inner.ScopeVertexId(),
+      outer.ChildModelScope("inner").ScopeVertexId());
+  EXPECT_EQ(ignition::math::graph::kNullId, inner.VertexIdByName("inner"));
+  EXPECT_EQ("b", inner.VertexLocalName(inner.VertexIdByName("b")));
+}
+
 /////////////////////////////////////////////////
 TEST(NestedFrameSemantics, buildFrameAttachedToGraph_Model)
 {
@@ -630,3 +715,372 @@ TEST(NestedFrameSemantics, InvalidAttachedToScope)
   EXPECT_FALSE(sdf::checkFrameAttachedToGraph(&root));
   EXPECT_FALSE(sdf::checkFrameAttachedToNames(&root));
 }
+
+/////////////////////////////////////////////////
+TEST(FrameSemantics, ParallelValidation)
+{
+  // Several top-level models, every third one with a cycle of frames.
+  std::ostringstream stream;
+  stream << "<sdf version='1.8'>";
+  for (int m = 0; m < 12; ++m)
+  {
+    stream << "<model name='model_" << m << "'>"
+           << "<link name='link'/>";
+    if (m % 3 == 0)
+    {
+      stream << "<frame name='F1' attached_to='F2'/>"
+             << "<frame name='F2' attached_to='F1'/>";
+    }
+    else
+    {
+      stream << "<frame name='F1' attached_to='link'/>";
+    }
+    stream << "</model>";
+  }
+  stream << "</sdf>";
+
+  sdf::Root sequentialRoot;
+  sdf::Errors sequentialErrors = sequentialRoot.LoadSdfString(stream.str());
+  EXPECT_FALSE(sequentialErrors.empty());
+
+  sdf::ParserConfig config;
+  config.SetLoadThreadCount(4u);
+  sdf::Root parallelRoot;
+  sdf::Errors parallelErrors =
+      parallelRoot.LoadSdfString(stream.str(), config);
+
+  // The errors are reported in document order whatever the thread count.
+  ASSERT_EQ(sequentialErrors.size(), parallelErrors.size());
+  for (std::size_t i = 0; i < sequentialErrors.size(); ++i)
+  {
+    EXPECT_EQ(sequentialErrors[i].Code(), parallelErrors[i].Code());
+    EXPECT_EQ(sequentialErrors[i].Message(), parallelErrors[i].Message());
+  }
+  EXPECT_LE(4u, parallelErrors.size());
+
+  // Valid models have their graphs.
+  for (uint64_t m = 0; m < parallelRoot.ModelCount(); ++m)
+  {
+    const sdf::Model *model = parallelRoot.ModelByIndex(m);
+    if (model->Name() != "model_1")
+      continue;
+    ignition::math::Pose3d pose;
+    EXPECT_TRUE(model->FrameByName("F1")->SemanticPose().Resolve(
+        pose, "__model__").empty());
+  }
+
+  EXPECT_FALSE(sdf::checkFrameAttachedToGraph(&parallelRoot, 4u));
+  EXPECT_FALSE(sdf::checkPoseRelativeToGraph(&parallelRoot, 0u));
+}
+
+/////////////////////////////////////////////////
+TEST(FrameSemantics, CheckGraphsReusesLoadedGraphs)
+{
+  const std::string testFile =
+    sdf::filesystem::append(PROJECT_SOURCE_PATH, "test", "sdf",
+        "world_nested_frame_attached_to.sdf");
+
+  sdf::Root root;
+  EXPECT_TRUE(root.Load(testFile).empty());
+
+  // The checks validate the graphs built by Load without building them
+  // again.
+  sdf::LoadStats stats;
+  sdf::LoadStatsScope scope(&stats);
+  EXPECT_TRUE(sdf::checkFrameAttachedToGraph(&root));
+  EXPECT_TRUE(sdf::checkPoseRelativeToGraph(&root, 2u));
+  EXPECT_EQ(0u, stats.Count(sdf::LoadPhase::FRAME_GRAPH_BUILD));
+  EXPECT_LT(0u, stats.Count(sdf::LoadPhase::FRAME_GRAPH_VALIDATE));
+
+  // A root that was not loaded has nothing to check.
+  sdf::Root empty;
+  EXPECT_TRUE(sdf::checkFrameAttachedToGraph(&empty));
+  EXPECT_TRUE(sdf::checkPoseRelativeToGraph(&empty));
+}
+
+/////////////////////////////////////////////////
+TEST(FrameSemantics, CheckRoot)
+{
+  const std::string sdf =
+    "<sdf version='1.8'>"
+    "  <world name='default'>"
+    "    <model name='valid'>"
+    "      <link name='link'/>"
+    "      <frame name='F1' attached_to='link'/>"
+    "    </model>"
+    "    <model name='cycle'>"
+    "      <link name='link'/>"
+    "      <frame name='F1' attached_to='F2'/>"
+    "      <frame name='F2' attached_to='F1'/>"
+    "    </model>"
+    "    <model name='canonical' canonical_link='missing'>"
+    "      <link name='link'/>"
+    "    </model>"
+    "  </world>"
+    "</sdf>";
+
+  sdf::Root root;
+  EXPECT_FALSE(root.LoadSdfString(sdf).empty());
+
+  // The fused checks fail like the checks run one after the other.
+  std::vector<std::string> failed;
+  EXPECT_FALSE(sdf::checkRoot(&root, 1u, failed));
+  auto failedCheck = [&failed](const std::string &_name)
+  {
+    return std::find(failed.begin(), failed.end(), _name) != failed.end();
+  };
+  EXPECT_TRUE(failedCheck("checkCanonicalLinkNames"));
+  EXPECT_TRUE(failedCheck("checkFrameAttachedToGraph"));
+  EXPECT_NE(sdf::checkJointParentChildLinkNames(&root),
+      failedCheck("checkJointParentChildLinkNames"));
+  EXPECT_NE(sdf::checkPoseRelativeToGraph(&root),
+      failedCheck("checkPoseRelativeToGraph"));
+  EXPECT_NE(sdf::recursiveSiblingUniqueNames(root.Element()),
+      failedCheck("recursiveSiblingUniqueNames"));
+
+  // The failed checks don't depend on the number of threads.
+  std::vector<std::string> parallelFailed;
+  EXPECT_FALSE(sdf::checkRoot(&root, 4u, parallelFailed));
+  EXPECT_EQ(failed, parallelFailed);
+
+  // A valid root passes every check.
+  sdf::Root validRoot;
+  const std::string testFile =
+    sdf::filesystem::append(PROJECT_SOURCE_PATH, "test", "sdf",
+        "world_nested_frame_attached_to.sdf");
+  EXPECT_TRUE(validRoot.Load(testFile).empty());
+  std::vector<std::string> validFailed;
+  EXPECT_TRUE(sdf::checkRoot(&validRoot, 0u, validFailed));
+  EXPECT_TRUE(validFailed.empty());
+}
+
+/////////////////////////////////////////////////
+TEST(FrameSemantics, IncrementalGraphUpdates)
+{
+  const std::string worldString =
+    "<sdf version='1.8'>"
+    "  <world name='default'>"
+    "    <frame name='F'><pose>1 0 0 0 0 0</pose></frame>"
+    "    <model name='box'>"
+    "      <pose>2 0 0 0 0 0</pose>"
+    "      <link name='link'/>"
+    "    </model>"
+    "  </world>"
+    "</sdf>";
+  sdf::Root root;
+  EXPECT_TRUE(root.LoadSdfString(worldString).empty());
+  const sdf::World *world = root.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+
+  auto ownedPoseGraph = std::make_shared<sdf::PoseRelativeToGraph>();
+  sdf::ScopedGraph<sdf::PoseRelativeToGraph> poseGraph(ownedPoseGraph);
+  EXPECT_TRUE(sdf::buildPoseRelativeToGraph(poseGraph, world).empty());
+  auto ownedFrameGraph = std::make_shared<sdf::FrameAttachedToGraph>();
+  sdf::ScopedGraph<sdf::FrameAttachedToGraph> frameGraph(ownedFrameGraph);
+  EXPECT_TRUE(sdf::buildFrameAttachedToGraph(frameGraph, world).empty());
+
+  // Add a model that was loaded in another world.
+  const std::string otherWorldString =
+    "<sdf version='1.8'>"
+    "  <world name='other'>"
+    "    <frame name='F'/>"
+    "    <model name='added'>"
+    "      <pose relative_to='F'>0 0 1 0 0 0</pose>"
+    "      <link name='link'><pose>0 1 0 0 0 0</pose></link>"
+    "    </model>"
+    "  </world>"
+    "</sdf>";
+  sdf::Root otherRoot;
+  EXPECT_TRUE(otherRoot.LoadSdfString(otherWorldString).empty());
+  const sdf::Model *added = otherRoot.WorldByIndex(0)->ModelByName("added");
+  ASSERT_NE(nullptr, added);
+
+  sdf::Errors errors = sdf::insertModelScope(poseGraph, added);
+  EXPECT_TRUE(errors.empty()) << errors;
+  errors = sdf::insertModelScope(frameGraph, added);
+  EXPECT_TRUE(errors.empty()) << errors;
+
+  ignition::math::Pose3d pose;
+  EXPECT_TRUE(
+      sdf::resolvePoseRelativeToRoot(pose, poseGraph, "added::link").empty());
+  EXPECT_EQ(ignition::math::Pose3d(1, 1, 1, 0, 0, 0), pose);
+  std::string body;
+  EXPECT_TRUE(
+      sdf::resolveFrameAttachedToBody(body, frameGraph, "added").empty());
+  EXPECT_EQ("added::link", body);
+
+  errors = sdf::insertModelScope(poseGraph, added);
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::DUPLICATE_NAME, errors[0].Code());
+
+  // Moving F moves the model whose pose is relative to it.
+  errors = sdf::updatePoseRelativeTo(poseGraph, "F", "box",
+      ignition::math::Pose3d(0, 0, 2, 0, 0, 0));
+  EXPECT_TRUE(errors.empty()) << errors;
+  EXPECT_TRUE(sdf::resolvePoseRelativeToRoot(pose, poseGraph, "F").empty());
+  EXPECT_EQ(ignition::math::Pose3d(2, 0, 2, 0, 0, 0), pose);
+  EXPECT_TRUE(
+      sdf::resolvePoseRelativeToRoot(pose, poseGraph, "added::link").empty());
+  EXPECT_EQ(ignition::math::Pose3d(2, 1, 3, 0, 0, 0), pose);
+
+  errors = sdf::updateFrameAttachedTo(frameGraph, "F", "box");
+  EXPECT_TRUE(errors.empty()) << errors;
+  EXPECT_TRUE(sdf::resolveFrameAttachedToBody(body, frameGraph, "F").empty());
+  EXPECT_EQ("box::link", body);
+
+  // Edges that would cause a cycle are rejected and the graphs unchanged.
+  errors = sdf::updatePoseRelativeTo(poseGraph, "box", "F", {});
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::POSE_RELATIVE_TO_CYCLE, errors[0].Code());
+  EXPECT_TRUE(sdf::resolvePoseRelativeToRoot(pose, poseGraph, "box").empty());
+  EXPECT_EQ(ignition::math::Pose3d(2, 0, 0, 0, 0, 0), pose);
+
+  errors = sdf::updateFrameAttachedTo(frameGraph, "box", "F");
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::FRAME_ATTACHED_TO_CYCLE, errors[0].Code());
+
+  errors = sdf::updatePoseRelativeTo(poseGraph, "F", "invalid", {});
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::POSE_RELATIVE_TO_INVALID, errors[0].Code());
+
+  // Removing the box leaves F without the frame it depends on.
+  errors = sdf::removeModelScope(poseGraph, "box");
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::POSE_RELATIVE_TO_GRAPH_ERROR, errors[0].Code());
+  EXPECT_EQ(0u, poseGraph.Count("box"));
+  EXPECT_EQ(0u, poseGraph.Count("box::link"));
+  EXPECT_EQ(1u, poseGraph.Count("added::link"));
+
+  errors = sdf::removeModelScope(frameGraph, "box");
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::FRAME_ATTACHED_TO_GRAPH_ERROR, errors[0].Code());
+
+  // Removing the added model leaves nothing depending on it.
+  EXPECT_TRUE(sdf::removeModelScope(frameGraph, "added").empty());
+  errors = sdf::removeModelScope(frameGraph, "added");
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::ELEMENT_MISSING, errors[0].Code());
+}
+
+/////////////////////////////////////////////////
+TEST(FrameSemantics, ReplaceModelScope)
+{
+  const std::string worldString =
+    "<sdf version='1.8'>"
+    "  <world name='default'>"
+    "    <frame name='F' attached_to='box::link'>"
+    "      <pose relative_to='box::link'>1 0 0 0 0 0</pose>"
+    "    </frame>"
+    "    <model name='box'>"
+    "      <pose>2 0 0 0 0 0</pose>"
+    "      <link name='link'/>"
+    "    </model>"
+    "  </world>"
+    "</sdf>";
+  sdf::Root root;
+  EXPECT_TRUE(root.LoadSdfString(worldString).empty());
+  const sdf::World *world = root.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+
+  auto ownedPoseGraph = std::make_shared<sdf::PoseRelativeToGraph>();
+  sdf::ScopedGraph<sdf::PoseRelativeToGraph> poseGraph(ownedPoseGraph);
+  EXPECT_TRUE(sdf::buildPoseRelativeToGraph(poseGraph, world).empty());
+  auto ownedFrameGraph = std::make_shared<sdf::FrameAttachedToGraph>();
+  sdf::ScopedGraph<sdf::FrameAttachedToGraph> frameGraph(ownedFrameGraph);
+  EXPECT_TRUE(sdf::buildFrameAttachedToGraph(frameGraph, world).empty());
+
+  // A new version of the box, with the link moved and a second link.
+  const std::string newWorldString =
+    "<sdf version='1.8'>"
+    "  <world name='default'>"
+    "    <model name='box'>"
+    "      <pose>3 0 0 0 0 0</pose>"
+    "      <link name='base'/>"
+    "      <link name='link'><pose>0 1 0 0 0 0</pose></link>"
+    "    </model>"
+    "  </world>"
+    "</sdf>";
+  sdf::Root newRoot;
+  EXPECT_TRUE(newRoot.LoadSdfString(newWorldString).empty());
+  const sdf::Model *box = newRoot.WorldByIndex(0)->ModelByName("box");
+  ASSERT_NE(nullptr, box);
+
+  // F stays attached to, and relative to, the link of the new box.
+  sdf::Errors errors = sdf::replaceModelScope(poseGraph, "box", box);
+  EXPECT_TRUE(errors.empty()) << errors;
+  errors = sdf::replaceModelScope(frameGraph, "box", box);
+  EXPECT_TRUE(errors.empty()) << errors;
+  EXPECT_EQ(1u, poseGraph.Count("box::base"));
+
+  ignition::math::Pose3d pose;
+  EXPECT_TRUE(sdf::resolvePoseRelativeToRoot(pose, poseGraph, "F").empty());
+  EXPECT_EQ(ignition::math::Pose3d(4, 1, 0, 0, 0, 0), pose);
+  std::string body;
+  EXPECT_TRUE(sdf::resolveFrameAttachedToBody(body, frameGraph, "F").empty());
+  EXPECT_EQ("box::link", body);
+
+  // A version without the link leaves F without the frame it depends on.
+  const std::string lastWorldString =
+    "<sdf version='1.8'>"
+    "  <world name='default'>"
+    "    <model name='box'><link name='base'/></model>"
+    "  </world>"
+    "</sdf>";
+  sdf::Root lastRoot;
+  EXPECT_TRUE(lastRoot.LoadSdfString(lastWorldString).empty());
+  box = lastRoot.WorldByIndex(0)->ModelByName("box");
+  ASSERT_NE(nullptr, box);
+
+  errors = sdf::replaceModelScope(frameGraph, "box", box);
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::FRAME_ATTACHED_TO_INVALID, errors[0].Code());
+
+  errors = sdf::replaceModelScope(frameGraph, "invalid", box);
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::ELEMENT_MISSING, errors[0].Code());
+  EXPECT_FALSE(sdf::replaceModelScope(poseGraph, "box", nullptr).empty());
+}
+
+/////////////////////////////////////////////////
+TEST(FrameSemantics, resolveFrameAttachedToBodyCache)
+{
+  auto ownedGraph = std::make_shared<sdf::FrameAttachedToGraph>();
+  sdf::ScopedGraph<sdf::FrameAttachedToGraph> graph(ownedGraph);
+  graph = graph.AddScopeVertex("", "__model__", "__model__",
+      sdf::FrameType::MODEL);
+  const auto linkA = graph.AddVertex("A", sdf::FrameType::LINK).Id();
+  const auto linkB = graph.AddVertex("B", sdf::FrameType::LINK).Id();
+  graph.AddEdge({graph.ScopeVertexId(), linkA}, true);
+
+  // Long chain of frames, each one attached to the previous one.
+  const int frameCount = 2000;
+  auto attachedTo = linkA;
+  for (int i = 0; i < frameCount; ++i)
+  {
+    const auto id = graph.AddVertex("F" + std::to_string(i),
+        sdf::FrameType::FRAME).Id();
+    graph.AddEdge({id, attachedTo}, true);
+    attachedTo = id;
+  }
+
+  // Resolving from the middle and then the whole chain reuses the sinks
+  // found on the way.
+  std::string body;
+  EXPECT_TRUE(sdf::resolveFrameAttachedToBody(body, graph, "F1000").empty());
+  EXPECT_EQ("A", body);
+  for (int i = frameCount - 1; i >= 0; --i)
+  {
+    body.clear();
+    ASSERT_TRUE(sdf::resolveFrameAttachedToBody(
+        body, graph, "F" + std::to_string(i)).empty());
+    ASSERT_EQ("A", body);
+  }
+  EXPECT_TRUE(sdf::validateFrameAttachedToGraph(graph).empty());
+
+  // Attaching the chain to another link discards the cached sinks.
+  EXPECT_TRUE(sdf::updateFrameAttachedTo(graph, "F0", "B").empty());
+  EXPECT_TRUE(sdf::resolveFrameAttachedToBody(
+      body, graph, "F" + std::to_string(frameCount - 1)).empty());
+  EXPECT_EQ("B", body);
+  EXPECT_EQ(linkB, graph.VertexIdByName(body));
+}
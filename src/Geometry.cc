@@ -14,13 +14,20 @@
  * limitations under the License.
  *
 */
+#include <algorithm>
+#include <cmath>
+#include <memory>
 #include "sdf/Geometry.hh"
 #include "sdf/Box.hh"
 #include "sdf/Capsule.hh"
 #include "sdf/Cylinder.hh"
+#include "sdf/Heightmap.hh"
 #include "sdf/Mesh.hh"
 #include "sdf/Plane.hh"
 #include "sdf/Sphere.hh"
+#include "ElementRetentionScope.hh"
+#include "LoadStatsScope.hh"
+#include "MeshRegistry.hh"
 
 using namespace sdf;
 
@@ -45,8 +52,12 @@ class sdf::GeometryPrivate
   /// \brief Pointer to a sphere.
   public: std::unique_ptr<Sphere> sphere;
 
-  /// \brief Pointer to a mesh.
-  public: std::unique_ptr<Mesh> mesh;
+  /// \brief Pointer to a mesh. It is never changed in place, so copies of
+  /// the geometry and the mesh registry of the Root can share it.
+  public: std::shared_ptr<const Mesh> mesh;
+
+  /// \brief Pointer to a heightmap.
+  public: std::unique_ptr<Heightmap> heightmap;
 
   /// \brief The SDF element pointer used during load.
   public: sdf::ElementPtr sdf;
@@ -102,7 +113,13 @@ Geometry::Geometry(const Geometry &_geometry)
 
   if (_geometry.dataPtr->mesh)
   {
-    this->dataPtr->mesh = std::make_unique<sdf::Mesh>(*_geometry.dataPtr->mesh);
+    this->dataPtr->mesh = _geometry.dataPtr->mesh;
+  }
+
+  if (_geometry.dataPtr->heightmap)
+  {
+    this->dataPtr->heightmap = std::make_unique<sdf::Heightmap>(
+        *_geometry.dataPtr->heightmap);
   }
 
   this->dataPtr->sdf = _geometry.dataPtr->sdf;
@@ -130,9 +147,10 @@ Geometry &Geometry::operator=(Geometry &&_geometry)
 /////////////////////////////////////////////////
 Errors Geometry::Load(ElementPtr _sdf)
 {
+  DomLoadTimer timer("Geometry");
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that sdf is a valid pointer
   if (!_sdf)
@@ -191,8 +209,17 @@ Errors Geometry::Load(ElementPtr _sdf)
   else if (_sdf->HasElement("mesh"))
   {
     this->dataPtr->type = GeometryType::MESH;
-    this->dataPtr->mesh.reset(new Mesh());
-    Errors err = this->dataPtr->mesh->Load(_sdf->GetElement("mesh"));
+    auto mesh = std::make_shared<Mesh>();
+    Errors err = mesh->Load(_sdf->GetElement("mesh"));
+    errors.insert(errors.end(), err.begin(), err.end());
+    this->dataPtr->mesh = std::move(mesh);
+  }
+  else if (_sdf->HasElement("heightmap"))
+  {
+    this->dataPtr->type = GeometryType::HEIGHTMAP;
+    this->dataPtr->heightmap.reset(new Heightmap());
+    Errors err = this->dataPtr->heightmap->Load(
+        _sdf->GetElement("heightmap"));
     errors.insert(errors.end(), err.begin(), err.end());
   }
 
@@ -280,7 +307,26 @@ const Mesh *Geometry::MeshShape() const
 /////////////////////////////////////////////////
 void Geometry::SetMeshShape(const Mesh &_mesh)
 {
-  this->dataPtr->mesh = std::make_unique<Mesh>(_mesh);
+  this->dataPtr->mesh = std::make_shared<Mesh>(_mesh);
+}
+
+/////////////////////////////////////////////////
+const Heightmap *Geometry::HeightmapShape() const
+{
+  return this->dataPtr->heightmap.get();
+}
+
+/////////////////////////////////////////////////
+void Geometry::SetHeightmapShape(const Heightmap &_heightmap)
+{
+  this->dataPtr->heightmap = std::make_unique<Heightmap>(_heightmap);
+}
+
+/////////////////////////////////////////////////
+void Geometry::ShareMesh(MeshRegistry &_registry)
+{
+  if (this->dataPtr->mesh)
+    _registry.Intern(this->dataPtr->mesh);
 }
 
 /////////////////////////////////////////////////
@@ -288,3 +334,92 @@ sdf::ElementPtr Geometry::Element() const
 {
   return this->dataPtr->sdf;
 }
+
+/////////////////////////////////////////////////
+std::optional<ignition::math::AxisAlignedBox> Geometry::AxisAlignedBox(
+    const Mesh::AxisAlignedBoxCalculator &_meshCalculator) const
+{
+  switch (this->dataPtr->type)
+  {
+    case GeometryType::BOX:
+      if (this->dataPtr->box)
+        return this->dataPtr->box->AxisAlignedBox();
+      break;
+    case GeometryType::CAPSULE:
+      if (this->dataPtr->capsule)
+        return this->dataPtr->capsule->AxisAlignedBox();
+      break;
+    case GeometryType::CYLINDER:
+      if (this->dataPtr->cylinder)
+        return this->dataPtr->cylinder->AxisAlignedBox();
+      break;
+    case GeometryType::PLANE:
+      if (this->dataPtr->plane)
+        return this->dataPtr->plane->AxisAlignedBox();
+      break;
+    case GeometryType::SPHERE:
+      if (this->dataPtr->sphere)
+        return this->dataPtr->sphere->AxisAlignedBox();
+      break;
+    case GeometryType::MESH:
+      if (this->dataPtr->mesh)
+        return this->dataPtr->mesh->AxisAlignedBox(_meshCalculator);
+      break;
+    case GeometryType::HEIGHTMAP:
+      if (this->dataPtr->heightmap)
+        return this->dataPtr->heightmap->AxisAlignedBox();
+      break;
+    case GeometryType::EMPTY:
+    default:
+      break;
+  }
+  return std::nullopt;
+}
+
+/////////////////////////////////////////////////
+std::optional<double> Geometry::BoundingRadius(
+    const Mesh::AxisAlignedBoxCalculator &_meshCalculator) const
+{
+  switch (this->dataPtr->type)
+  {
+    case GeometryType::BOX:
+      if (this->dataPtr->box)
+        return this->dataPtr->box->BoundingRadius();
+      break;
+    case GeometryType::CAPSULE:
+      if (this->dataPtr->capsule)
+        return this->dataPtr->capsule->BoundingRadius();
+      break;
+    case GeometryType::CYLINDER:
+      if (this->dataPtr->cylinder)
+        return this->dataPtr->cylinder->BoundingRadius();
+      break;
+    case GeometryType::PLANE:
+      if (this->dataPtr->plane)
+        return this->dataPtr->plane->BoundingRadius();
+      break;
+    case GeometryType::SPHERE:
+      if (this->dataPtr->sphere)
+        return this->dataPtr->sphere->BoundingRadius();
+      break;
+    case GeometryType::MESH:
+    case GeometryType::HEIGHTMAP:
+    {
+      std::optional<ignition::math::AxisAlignedBox> box =
+          this->AxisAlignedBox(_meshCalculator);
+      if (!box)
+        break;
+      // The farthest corner from the origin.
+      const ignition::math::Vector3d &min = box->Min();
+      const ignition::math::Vector3d &max = box->Max();
+      return ignition::math::Vector3d(
+          std::max(std::abs(min.X()), std::abs(max.X())),
+          std::max(std::abs(min.Y()), std::abs(max.Y())),
+          std::max(std::abs(min.Z()), std::abs(max.Z()))).Length();
+    }
+    case GeometryType::EMPTY:
+    default:
+      break;
+  }
+  return std::nullopt;
+}
@@ -16,6 +16,7 @@
 */
 
 #include <gtest/gtest.h>
+#include <optional>
 #include "sdf/Box.hh"
 #include "sdf/Capsule.hh"
 #include "sdf/Cylinder.hh"
@@ -239,3 +240,56 @@ TEST(DOMGeometry, Plane)
   EXPECT_EQ(ignition::math::Vector3d::UnitX, geom.PlaneShape()->Normal());
   EXPECT_EQ(ignition::math::Vector2d(9, 8), geom.PlaneShape()->Size());
 }
+
+/////////////////////////////////////////////////
+TEST(DOMGeometry, Bounds)
+{
+  using ignition::math::AxisAlignedBox;
+  using ignition::math::Vector3d;
+
+  sdf::Geometry geom;
+  EXPECT_FALSE(geom.AxisAlignedBox());
+  EXPECT_FALSE(geom.BoundingRadius());
+
+  // A type without its shape has no bounds.
+  geom.SetType(sdf::GeometryType::SPHERE);
+  EXPECT_FALSE(geom.AxisAlignedBox());
+
+  sdf::Sphere sphere;
+  sphere.SetRadius(2);
+  geom.SetSphereShape(sphere);
+  EXPECT_EQ(AxisAlignedBox(Vector3d(-2, -2, -2), Vector3d(2, 2, 2)),
+      geom.AxisAlignedBox());
+  EXPECT_DOUBLE_EQ(2.0, geom.BoundingRadius().value());
+
+  sdf::Cylinder cylinder;
+  cylinder.SetRadius(3);
+  cylinder.SetLength(8);
+  geom.SetType(sdf::GeometryType::CYLINDER);
+  geom.SetCylinderShape(cylinder);
+  EXPECT_EQ(AxisAlignedBox(Vector3d(-3, -3, -4), Vector3d(3, 3, 4)),
+      geom.AxisAlignedBox());
+  EXPECT_DOUBLE_EQ(5.0, geom.BoundingRadius().value());
+
+  sdf::Capsule capsule;
+  capsule.SetRadius(1);
+  capsule.SetLength(2);
+  geom.SetType(sdf::GeometryType::CAPSULE);
+  geom.SetCapsuleShape(capsule);
+  EXPECT_EQ(AxisAlignedBox(Vector3d(-1, -1, -2), Vector3d(1, 1, 2)),
+      geom.AxisAlignedBox());
+  EXPECT_DOUBLE_EQ(2.0, geom.BoundingRadius().value());
+
+  // Meshes need a calculator.
+  geom.SetType(sdf::GeometryType::MESH);
+  geom.SetMeshShape(sdf::Mesh());
+  EXPECT_FALSE(geom.AxisAlignedBox());
+  auto calculator = [](const sdf::Mesh &)
+  {
+    return std::optional<AxisAlignedBox>(
+        AxisAlignedBox(Vector3d(-1, 0, 0), Vector3d(0, 2, 2)));
+  };
+  EXPECT_EQ(AxisAlignedBox(Vector3d(-1, 0, 0), Vector3d(0, 2, 2)),
+      geom.AxisAlignedBox(calculator));
+  EXPECT_DOUBLE_EQ(3.0, geom.BoundingRadius(calculator).value());
+}
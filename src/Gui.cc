@@ -15,6 +15,8 @@
  *
 */
 #include "sdf/Gui.hh"
+#include "ElementRetentionScope.hh"
+#include "LoadStatsScope.hh"
 #include "Utils.hh"
 
 using namespace sdf;
@@ -70,9 +72,10 @@ Gui &Gui::operator=(Gui &&_gui)
 /////////////////////////////////////////////////
 Errors Gui::Load(ElementPtr _sdf)
 {
+  DomLoadTimer timer("Gui");
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that the provided SDF element is a <gui> element.
   // This is an error that cannot be recovered, so return an error.
@@ -0,0 +1,793 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <exception>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "sdf/Filesystem.hh"
+#include "sdf/Heightmap.hh"
+#include "sdf/SDFImpl.hh"
+#include "ElementRetentionScope.hh"
+#include "LoadStatsScope.hh"
+#include "MappedFile.hh"
+#include "Utils.hh"
+
+using namespace sdf;
+
+// Private data class
+class sdf::HeightmapDataPrivate
+{
+  /// \brief The mapped or read file, when the data was opened from one.
+  public: MappedFile file;
+
+  /// \brief Content given to the constructor.
+  public: std::string content;
+
+  /// \brief Whether the data is content rather than file.
+  public: bool useContent = false;
+};
+
+// Private data class
+class sdf::HeightmapTexturePrivate
+{
+  /// \brief Size of the applied texture in meters.
+  public: double size = 10.0;
+
+  /// \brief Filename of the diffuse texture.
+  public: std::string diffuse = "";
+
+  /// \brief Filename of the normal map.
+  public: std::string normal = "";
+
+  /// \brief The SDF element pointer used during load.
+  public: sdf::ElementPtr sdf = nullptr;
+};
+
+// Private data class
+class sdf::HeightmapBlendPrivate
+{
+  /// \brief Minimum height of the blend layer.
+  public: double minHeight = 0.0;
+
+  /// \brief Distance over which the blend occurs.
+  public: double fadeDistance = 0.0;
+
+  /// \brief The SDF element pointer used during load.
+  public: sdf::ElementPtr sdf = nullptr;
+};
+
+// Private data class
+class sdf::HeightmapPrivate
+{
+  /// \brief Data of a heightmap that is found and loaded on request, and
+  /// is shared by the copies of the heightmap.
+  public: struct DataState
+  {
+    /// \brief Protects the other members.
+    std::mutex mutex;
+
+    /// \brief Whether resolvedPath was looked up.
+    bool resolved = false;
+
+    /// \brief Absolute path of the height file, or empty if it wasn't
+    /// found.
+    std::string resolvedPath;
+
+    /// \brief The loaded data, or an invalid future if it wasn't requested.
+    std::shared_future<std::shared_ptr<const HeightmapData>> data;
+  };
+
+  /// \brief URI of the height file.
+  public: std::string uri = "";
+
+  /// \brief The path to the file where this heightmap was defined.
+  public: std::string filePath = "";
+
+  /// \brief Size of the heightmap in meters.
+  public: ignition::math::Vector3d size {1, 1, 1};
+
+  /// \brief Position offset in meters.
+  public: ignition::math::Vector3d position {0, 0, 0};
+
+  /// \brief Whether the heightmap uses terrain paging.
+  public: bool useTerrainPaging = false;
+
+  /// \brief Samples per heightmap datum.
+  public: unsigned int sampling = 2u;
+
+  /// \brief The textures, from the lowest to the highest.
+  public: std::vector<HeightmapTexture> textures;
+
+  /// \brief The blends between adjacent textures.
+  public: std::vector<HeightmapBlend> blends;
+
+  /// \brief The SDF element pointer used during load.
+  public: sdf::ElementPtr sdf = nullptr;
+
+  /// \brief The resolved path and data, shared by the copies.
+  public: std::shared_ptr<DataState> state =
+              std::make_shared<DataState>();
+};
+
+/////////////////////////////////////////////////
+/// \brief Find the absolute path of the height file of a heightmap.
+/// \param[in] _uri URI of the file.
+/// \param[in] _filePath File the URI was read from, which relative URIs
+/// are resolved against.
+/// \return Absolute path, or an empty string if it is not found.
+static std::string resolveHeightmapUri(const std::string &_uri,
+    const std::string &_filePath)
+{
+  if (_uri.empty() || _uri == "__default__")
+    return "";
+
+  std::string uri = _uri;
+  const std::string fileScheme = "file://";
+  if (uri.compare(0, fileScheme.size(), fileScheme) == 0)
+    uri = uri.substr(fileScheme.size());
+
+  const bool absolute = (!uri.empty() && (uri[0] == '/' || uri[0] == '\\')) ||
+    (uri.size() > 2 && uri[1] == ':' && (uri[2] == '/' || uri[2] == '\\'));
+  if (absolute)
+    return sdf::filesystem::exists(uri) ? uri : std::string();
+
+  if (uri.find("://") == std::string::npos)
+  {
+    const std::size_t slash = _filePath.find_last_of("/\\");
+    if (slash != std::string::npos)
+    {
+      const std::string path =
+          sdf::filesystem::append(_filePath.substr(0, slash), uri);
+      if (sdf::filesystem::exists(path))
+        return path;
+    }
+  }
+
+  return sdf::findFile(uri, true, true);
+}
+
+/////////////////////////////////////////////////
+/// \brief Load the data of a heightmap.
+/// \param[in] _heightmap The heightmap.
+/// \param[in] _loader Function that loads the data, or nullptr to map the
+/// height file.
+/// \return The data, or nullptr if it can't be loaded.
+static std::shared_ptr<const HeightmapData> loadHeightmapData(
+    const Heightmap &_heightmap, const Heightmap::DataLoader &_loader)
+{
+  if (_loader)
+    return _loader(_heightmap);
+
+  const std::string path = _heightmap.ResolvedPath();
+  if (path.empty())
+    return nullptr;
+
+  auto data = std::make_shared<HeightmapData>();
+  if (!data->Open(path))
+    return nullptr;
+  return data;
+}
+
+/////////////////////////////////////////////////
+HeightmapData::HeightmapData()
+  : dataPtr(new HeightmapDataPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+HeightmapData::HeightmapData(std::string _content)
+  : dataPtr(new HeightmapDataPrivate)
+{
+  this->dataPtr->content = std::move(_content);
+  this->dataPtr->useContent = true;
+}
+
+/////////////////////////////////////////////////
+HeightmapData::~HeightmapData()
+{
+  delete this->dataPtr;
+  this->dataPtr = nullptr;
+}
+
+/////////////////////////////////////////////////
+bool HeightmapData::Open(const std::string &_filename)
+{
+  this->dataPtr->content.clear();
+  this->dataPtr->useContent = false;
+  return this->dataPtr->file.Open(_filename);
+}
+
+/////////////////////////////////////////////////
+const char *HeightmapData::Data() const
+{
+  if (this->dataPtr->useContent)
+    return this->dataPtr->content.data();
+  return this->dataPtr->file.Data();
+}
+
+/////////////////////////////////////////////////
+std::size_t HeightmapData::Size() const
+{
+  if (this->dataPtr->useContent)
+    return this->dataPtr->content.size();
+  return this->dataPtr->file.Size();
+}
+
+/////////////////////////////////////////////////
+bool HeightmapData::Mapped() const
+{
+  return !this->dataPtr->useContent && this->dataPtr->file.Mapped();
+}
+
+/////////////////////////////////////////////////
+HeightmapTexture::HeightmapTexture()
+  : dataPtr(new HeightmapTexturePrivate)
+{
+}
+
+/////////////////////////////////////////////////
+HeightmapTexture::HeightmapTexture(const HeightmapTexture &_texture)
+  : dataPtr(new HeightmapTexturePrivate(*_texture.dataPtr))
+{
+}
+
+/////////////////////////////////////////////////
+HeightmapTexture::HeightmapTexture(HeightmapTexture &&_texture) noexcept
+  : dataPtr(std::exchange(_texture.dataPtr, nullptr))
+{
+}
+
+/////////////////////////////////////////////////
+HeightmapTexture &HeightmapTexture::operator=(
+    const HeightmapTexture &_texture)
+{
+  return *this = HeightmapTexture(_texture);
+}
+
+/////////////////////////////////////////////////
+HeightmapTexture &HeightmapTexture::operator=(
+    HeightmapTexture &&_texture) noexcept
+{
+  std::swap(this->dataPtr, _texture.dataPtr);
+  return *this;
+}
+
+/////////////////////////////////////////////////
+HeightmapTexture::~HeightmapTexture()
+{
+  delete this->dataPtr;
+  this->dataPtr = nullptr;
+}
+
+/////////////////////////////////////////////////
+Errors HeightmapTexture::Load(ElementPtr _sdf)
+{
+  DomLoadTimer timer("HeightmapTexture");
+  Errors errors;
+
+  this->dataPtr->sdf = retainedElement(_sdf);
+
+  // Check that sdf is a valid pointer
+  if (!_sdf)
+  {
+    errors.push_back({ErrorCode::ELEMENT_MISSING,
+        "Attempting to load a heightmap texture, but the provided SDF "
+        "element is null."});
+    return errors;
+  }
+
+  // We need a texture element
+  if (_sdf->GetName() != "texture")
+  {
+    errors.push_back({ErrorCode::ELEMENT_INCORRECT_TYPE,
+        "Attempting to load a heightmap texture, but the provided SDF "
+        "element is not a <texture>."});
+    return errors;
+  }
+
+  this->dataPtr->size = _sdf->Get<double>("size", this->dataPtr->size).first;
+
+  if (_sdf->HasElement("diffuse"))
+  {
+    this->dataPtr->diffuse = _sdf->Get<std::string>("diffuse", "").first;
+  }
+  else
+  {
+    errors.push_back({ErrorCode::ELEMENT_MISSING,
+        "Heightmap texture is missing a <diffuse> child element."});
+  }
+
+  if (_sdf->HasElement("normal"))
+  {
+    this->dataPtr->normal = _sdf->Get<std::string>("normal", "").first;
+  }
+  else
+  {
+    errors.push_back({ErrorCode::ELEMENT_MISSING,
+        "Heightmap texture is missing a <normal> child element."});
+  }
+
+  return errors;
+}
+
+/////////////////////////////////////////////////
+double HeightmapTexture::Size() const
+{
+  return this->dataPtr->size;
+}
+
+/////////////////////////////////////////////////
+void HeightmapTexture::SetSize(double _size)
+{
+  this->dataPtr->size = _size;
+}
+
+/////////////////////////////////////////////////
+const std::string &HeightmapTexture::Diffuse() const
+{
+  return this->dataPtr->diffuse;
+}
+
+/////////////////////////////////////////////////
+void HeightmapTexture::SetDiffuse(const std::string &_diffuse)
+{
+  this->dataPtr->diffuse = _diffuse;
+}
+
+/////////////////////////////////////////////////
+const std::string &HeightmapTexture::Normal() const
+{
+  return this->dataPtr->normal;
+}
+
+/////////////////////////////////////////////////
+void HeightmapTexture::SetNormal(const std::string &_normal)
+{
+  this->dataPtr->normal = _normal;
+}
+
+/////////////////////////////////////////////////
+sdf::ElementPtr HeightmapTexture::Element() const
+{
+  return this->dataPtr->sdf;
+}
+
+/////////////////////////////////////////////////
+HeightmapBlend::HeightmapBlend()
+  : dataPtr(new HeightmapBlendPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+HeightmapBlend::HeightmapBlend(const HeightmapBlend &_blend)
+  : dataPtr(new HeightmapBlendPrivate(*_blend.dataPtr))
+{
+}
+
+/////////////////////////////////////////////////
+HeightmapBlend::HeightmapBlend(HeightmapBlend &&_blend) noexcept
+  : dataPtr(std::exchange(_blend.dataPtr, nullptr))
+{
+}
+
+/////////////////////////////////////////////////
+HeightmapBlend &HeightmapBlend::operator=(const HeightmapBlend &_blend)
+{
+  return *this = HeightmapBlend(_blend);
+}
+
+/////////////////////////////////////////////////
+HeightmapBlend &HeightmapBlend::operator=(HeightmapBlend &&_blend) noexcept
+{
+  std::swap(this->dataPtr, _blend.dataPtr);
+  return *this;
+}
+
+/////////////////////////////////////////////////
+HeightmapBlend::~HeightmapBlend()
+{
+  delete this->dataPtr;
+  this->dataPtr = nullptr;
+}
+
+/////////////////////////////////////////////////
+Errors HeightmapBlend::Load(ElementPtr _sdf)
+{
+  DomLoadTimer timer("HeightmapBlend");
+  Errors errors;
+
+  this->dataPtr->sdf = retainedElement(_sdf);
+
+  // Check that sdf is a valid pointer
+  if (!_sdf)
+  {
+    errors.push_back({ErrorCode::ELEMENT_MISSING,
+        "Attempting to load a heightmap blend, but the provided SDF "
+        "element is null."});
+    return errors;
+  }
+
+  // We need a blend element
+  if (_sdf->GetName() != "blend")
+  {
+    errors.push_back({ErrorCode::ELEMENT_INCORRECT_TYPE,
+        "Attempting to load a heightmap blend, but the provided SDF "
+        "element is not a <blend>."});
+    return errors;
+  }
+
+  this->dataPtr->minHeight = _sdf->Get<double>("min_height",
+      this->dataPtr->minHeight).first;
+  this->dataPtr->fadeDistance = _sdf->Get<double>("fade_dist",
+      this->dataPtr->fadeDistance).first;
+
+  return errors;
+}
+
+/////////////////////////////////////////////////
+double HeightmapBlend::MinHeight() const
+{
+  return this->dataPtr->minHeight;
+}
+
+/////////////////////////////////////////////////
+void HeightmapBlend::SetMinHeight(double _minHeight)
+{
+  this->dataPtr->minHeight = _minHeight;
+}
+
+/////////////////////////////////////////////////
+double HeightmapBlend::FadeDistance() const
+{
+  return this->dataPtr->fadeDistance;
+}
+
+/////////////////////////////////////////////////
+void HeightmapBlend::SetFadeDistance(double _fadeDistance)
+{
+  this->dataPtr->fadeDistance = _fadeDistance;
+}
+
+/////////////////////////////////////////////////
+sdf::ElementPtr HeightmapBlend::Element() const
+{
+  return this->dataPtr->sdf;
+}
+
+/////////////////////////////////////////////////
+Heightmap::Heightmap()
+  : dataPtr(new HeightmapPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+Heightmap::Heightmap(const Heightmap &_heightmap)
+  : dataPtr(new HeightmapPrivate(*_heightmap.dataPtr))
+{
+}
+
+/////////////////////////////////////////////////
+Heightmap::Heightmap(Heightmap &&_heightmap) noexcept
+  : dataPtr(std::exchange(_heightmap.dataPtr, nullptr))
+{
+}
+
+/////////////////////////////////////////////////
+Heightmap &Heightmap::operator=(const Heightmap &_heightmap)
+{
+  return *this = Heightmap(_heightmap);
+}
+
+/////////////////////////////////////////////////
+Heightmap &Heightmap::operator=(Heightmap &&_heightmap) noexcept
+{
+  std::swap(this->dataPtr, _heightmap.dataPtr);
+  return *this;
+}
+
+/////////////////////////////////////////////////
+Heightmap::~Heightmap()
+{
+  delete this->dataPtr;
+  this->dataPtr = nullptr;
+}
+
+/////////////////////////////////////////////////
+Errors Heightmap::Load(ElementPtr _sdf)
+{
+  DomLoadTimer timer("Heightmap");
+  Errors errors;
+
+  this->dataPtr->sdf = retainedElement(_sdf);
+
+  // Check that sdf is a valid pointer
+  if (!_sdf)
+  {
+    errors.push_back({ErrorCode::ELEMENT_MISSING,
+        "Attempting to load a heightmap geometry, but the provided SDF "
+        "element is null."});
+    return errors;
+  }
+
+  this->dataPtr->filePath = _sdf->FilePath();
+
+  // We need a heightmap element
+  if (_sdf->GetName() != "heightmap")
+  {
+    errors.push_back({ErrorCode::ELEMENT_INCORRECT_TYPE,
+        "Attempting to load a heightmap geometry, but the provided SDF "
+        "element is not a <heightmap>."});
+    return errors;
+  }
+
+  // Only the description is read. The height file is found and loaded
+  // when its data is requested.
+  this->dataPtr->state = std::make_shared<HeightmapPrivate::DataState>();
+  if (_sdf->HasElement("uri"))
+  {
+    this->dataPtr->uri = _sdf->Get<std::string>("uri", "").first;
+  }
+  else
+  {
+    errors.push_back({ErrorCode::ELEMENT_MISSING,
+        "Heightmap geometry is missing a <uri> child element."});
+  }
+
+  this->dataPtr->size = _sdf->Get<ignition::math::Vector3d>("size",
+      this->dataPtr->size).first;
+  this->dataPtr->position = _sdf->Get<ignition::math::Vector3d>("pos",
+      this->dataPtr->position).first;
+  this->dataPtr->useTerrainPaging = _sdf->Get<bool>("use_terrain_paging",
+      this->dataPtr->useTerrainPaging).first;
+  this->dataPtr->sampling = _sdf->Get<unsigned int>("sampling",
+      this->dataPtr->sampling).first;
+
+  Errors textureErrors = loadRepeated<HeightmapTexture>(_sdf, "texture",
+      this->dataPtr->textures);
+  errors.insert(errors.end(), textureErrors.begin(), textureErrors.end());
+
+  Errors blendErrors = loadRepeated<HeightmapBlend>(_sdf, "blend",
+      this->dataPtr->blends);
+  errors.insert(errors.end(), blendErrors.begin(), blendErrors.end());
+
+  return errors;
+}
+
+/////////////////////////////////////////////////
+const std::string &Heightmap::Uri() const
+{
+  return this->dataPtr->uri;
+}
+
+/////////////////////////////////////////////////
+void Heightmap::SetUri(const std::string &_uri)
+{
+  this->dataPtr->uri = _uri;
+  this->dataPtr->state = std::make_shared<HeightmapPrivate::DataState>();
+}
+
+/////////////////////////////////////////////////
+const std::string &Heightmap::FilePath() const
+{
+  return this->dataPtr->filePath;
+}
+
+/////////////////////////////////////////////////
+void Heightmap::SetFilePath(const std::string &_filePath)
+{
+  this->dataPtr->filePath = _filePath;
+  this->dataPtr->state = std::make_shared<HeightmapPrivate::DataState>();
+}
+
+/////////////////////////////////////////////////
+std::string Heightmap::ResolvedPath() const
+{
+  HeightmapPrivate::DataState &state = *this->dataPtr->state;
+  std::lock_guard<std::mutex> lock(state.mutex);
+  if (!state.resolved)
+  {
+    state.resolvedPath =
+        resolveHeightmapUri(this->dataPtr->uri, this->dataPtr->filePath);
+    state.resolved = true;
+  }
+  return state.resolvedPath;
+}
+
+/////////////////////////////////////////////////
+ignition::math::Vector3d Heightmap::Size() const
+{
+  return this->dataPtr->size;
+}
+
+/////////////////////////////////////////////////
+void Heightmap::SetSize(const ignition::math::Vector3d &_size)
+{
+  this->dataPtr->size = _size;
+}
+
+/////////////////////////////////////////////////
+ignition::math::Vector3d Heightmap::Position() const
+{
+  return this->dataPtr->position;
+}
+
+/////////////////////////////////////////////////
+void Heightmap::SetPosition(const ignition::math::Vector3d &_position)
+{
+  this->dataPtr->position = _position;
+}
+
+/////////////////////////////////////////////////
+bool Heightmap::UseTerrainPaging() const
+{
+  return this->dataPtr->useTerrainPaging;
+}
+
+/////////////////////////////////////////////////
+void Heightmap::SetUseTerrainPaging(bool _use)
+{
+  this->dataPtr->useTerrainPaging = _use;
+}
+
+/////////////////////////////////////////////////
+unsigned int Heightmap::Sampling() const
+{
+  return this->dataPtr->sampling;
+}
+
+/////////////////////////////////////////////////
+void Heightmap::SetSampling(unsigned int _sampling)
+{
+  this->dataPtr->sampling = _sampling;
+}
+
+/////////////////////////////////////////////////
+uint64_t Heightmap::TextureCount() const
+{
+  return this->dataPtr->textures.size();
+}
+
+/////////////////////////////////////////////////
+const HeightmapTexture *Heightmap::TextureByIndex(uint64_t _index) const
+{
+  if (_index < this->dataPtr->textures.size())
+    return &this->dataPtr->textures[_index];
+  return nullptr;
+}
+
+/////////////////////////////////////////////////
+void Heightmap::AddTexture(const HeightmapTexture &_texture)
+{
+  this->dataPtr->textures.push_back(_texture);
+}
+
+/////////////////////////////////////////////////
+uint64_t Heightmap::BlendCount() const
+{
+  return this->dataPtr->blends.size();
+}
+
+/////////////////////////////////////////////////
+const HeightmapBlend *Heightmap::BlendByIndex(uint64_t _index) const
+{
+  if (_index < this->dataPtr->blends.size())
+    return &this->dataPtr->blends[_index];
+  return nullptr;
+}
+
+/////////////////////////////////////////////////
+void Heightmap::AddBlend(const HeightmapBlend &_blend)
+{
+  this->dataPtr->blends.push_back(_blend);
+}
+
+/////////////////////////////////////////////////
+ignition::math::AxisAlignedBox Heightmap::AxisAlignedBox() const
+{
+  const ignition::math::Vector3d &size = this->dataPtr->size;
+  const ignition::math::Vector3d &pos = this->dataPtr->position;
+  return ignition::math::AxisAlignedBox(
+      ignition::math::Vector3d(pos.X() - size.X() * 0.5,
+          pos.Y() - size.Y() * 0.5, pos.Z()),
+      ignition::math::Vector3d(pos.X() + size.X() * 0.5,
+          pos.Y() + size.Y() * 0.5, pos.Z() + size.Z()));
+}
+
+/////////////////////////////////////////////////
+std::shared_ptr<const HeightmapData> Heightmap::Data(
+    const DataLoader &_loader) const
+{
+  // A load that another request started is waited for outside of the
+  // lock, since loading takes it to resolve the path.
+  std::promise<std::shared_ptr<const HeightmapData>> promise;
+  std::shared_future<std::shared_ptr<const HeightmapData>> pending;
+  {
+    HeightmapPrivate::DataState &state = *this->dataPtr->state;
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (state.data.valid())
+      pending = state.data;
+    else
+      state.data = promise.get_future().share();
+  }
+  if (pending.valid())
+    return pending.get();
+
+  try
+  {
+    std::shared_ptr<const HeightmapData> data =
+        loadHeightmapData(*this, _loader);
+    promise.set_value(data);
+    return data;
+  }
+  catch (...)
+  {
+    promise.set_exception(std::current_exception());
+    throw;
+  }
+}
+
+/////////////////////////////////////////////////
+std::shared_future<std::shared_ptr<const HeightmapData>>
+    Heightmap::DataAsync(const DataLoader &_loader,
+        std::shared_ptr<Executor> _executor) const
+{
+  auto promise =
+      std::make_shared<std::promise<std::shared_ptr<const HeightmapData>>>();
+  std::shared_future<std::shared_ptr<const HeightmapData>> future;
+  {
+    HeightmapPrivate::DataState &state = *this->dataPtr->state;
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (state.data.valid())
+      return state.data;
+    state.data = promise->get_future().share();
+    future = state.data;
+  }
+
+  if (!_executor)
+    _executor = Executor::Default();
+
+  // The task loads a copy, which shares the state, so that the heightmap
+  // can be destroyed before the data is loaded.
+  _executor->Submit([heightmap = *this, _loader, promise]()
+  {
+    try
+    {
+      promise->set_value(loadHeightmapData(heightmap, _loader));
+    }
+    catch (...)
+    {
+      promise->set_exception(std::current_exception());
+    }
+  });
+  return future;
+}
+
+/////////////////////////////////////////////////
+void Heightmap::ReleaseData() const
+{
+  HeightmapPrivate::DataState &state = *this->dataPtr->state;
+  std::lock_guard<std::mutex> lock(state.mutex);
+  state.data = {};
+}
+
+/////////////////////////////////////////////////
+sdf::ElementPtr Heightmap::Element() const
+{
+  return this->dataPtr->sdf;
+}
@@ -0,0 +1,268 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <string>
+#include <gtest/gtest.h>
+#include "sdf/Filesystem.hh"
+#include "sdf/Geometry.hh"
+#include "sdf/Heightmap.hh"
+#include "sdf/Link.hh"
+#include "sdf/Model.hh"
+#include "sdf/Root.hh"
+#include "sdf/Visual.hh"
+#include "sdf/World.hh"
+
+/////////////////////////////////////////////////
+TEST(DOMHeightmap, Construction)
+{
+  sdf::Heightmap heightmap;
+  EXPECT_EQ(nullptr, heightmap.Element());
+  EXPECT_TRUE(heightmap.Uri().empty());
+  EXPECT_TRUE(heightmap.FilePath().empty());
+  EXPECT_TRUE(heightmap.ResolvedPath().empty());
+  EXPECT_EQ(ignition::math::Vector3d::One, heightmap.Size());
+  EXPECT_EQ(ignition::math::Vector3d::Zero, heightmap.Position());
+  EXPECT_FALSE(heightmap.UseTerrainPaging());
+  EXPECT_EQ(2u, heightmap.Sampling());
+  EXPECT_EQ(0u, heightmap.TextureCount());
+  EXPECT_EQ(nullptr, heightmap.TextureByIndex(0));
+  EXPECT_EQ(0u, heightmap.BlendCount());
+  EXPECT_EQ(nullptr, heightmap.BlendByIndex(0));
+  EXPECT_EQ(nullptr, heightmap.Data());
+
+  sdf::HeightmapTexture texture;
+  EXPECT_EQ(nullptr, texture.Element());
+  EXPECT_DOUBLE_EQ(10.0, texture.Size());
+  EXPECT_TRUE(texture.Diffuse().empty());
+  EXPECT_TRUE(texture.Normal().empty());
+
+  sdf::HeightmapBlend blend;
+  EXPECT_EQ(nullptr, blend.Element());
+  EXPECT_DOUBLE_EQ(0.0, blend.MinHeight());
+  EXPECT_DOUBLE_EQ(0.0, blend.FadeDistance());
+
+  sdf::HeightmapData data;
+  EXPECT_EQ(nullptr, data.Data());
+  EXPECT_EQ(0u, data.Size());
+  EXPECT_FALSE(data.Mapped());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMHeightmap, CopyAndMove)
+{
+  sdf::Heightmap heightmap;
+  heightmap.SetUri("banana");
+  heightmap.SetSize({2, 3, 4});
+  sdf::HeightmapTexture texture;
+  texture.SetDiffuse("diffuse.png");
+  heightmap.AddTexture(texture);
+  sdf::HeightmapBlend blend;
+  blend.SetFadeDistance(5.0);
+  heightmap.AddBlend(blend);
+
+  sdf::Heightmap copy(heightmap);
+  EXPECT_EQ("banana", copy.Uri());
+  EXPECT_EQ(ignition::math::Vector3d(2, 3, 4), copy.Size());
+  ASSERT_EQ(1u, copy.TextureCount());
+  EXPECT_EQ("diffuse.png", copy.TextureByIndex(0)->Diffuse());
+  ASSERT_EQ(1u, copy.BlendCount());
+  EXPECT_DOUBLE_EQ(5.0, copy.BlendByIndex(0)->FadeDistance());
+
+  sdf::Heightmap moved(std::move(copy));
+  EXPECT_EQ("banana", moved.Uri());
+
+  sdf::Heightmap assigned;
+  assigned = moved;
+  EXPECT_EQ("banana", assigned.Uri());
+  sdf::Heightmap moveAssigned;
+  moveAssigned = std::move(assigned);
+  EXPECT_EQ(1u, moveAssigned.TextureCount());
+
+  // Copy assignment after move.
+  assigned = moveAssigned;
+  EXPECT_EQ("banana", assigned.Uri());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMHeightmap, Set)
+{
+  sdf::Heightmap heightmap;
+  heightmap.SetUri("model://terrain/heights.png");
+  EXPECT_EQ("model://terrain/heights.png", heightmap.Uri());
+  heightmap.SetFilePath("/tmp/world.sdf");
+  EXPECT_EQ("/tmp/world.sdf", heightmap.FilePath());
+  heightmap.SetPosition({1, 2, 3});
+  EXPECT_EQ(ignition::math::Vector3d(1, 2, 3), heightmap.Position());
+  heightmap.SetUseTerrainPaging(true);
+  EXPECT_TRUE(heightmap.UseTerrainPaging());
+  heightmap.SetSampling(1u);
+  EXPECT_EQ(1u, heightmap.Sampling());
+
+  heightmap.SetSize({10, 20, 5});
+  EXPECT_EQ(ignition::math::AxisAlignedBox(
+      ignition::math::Vector3d(-4, -8, 3),
+      ignition::math::Vector3d(6, 12, 8)), heightmap.AxisAlignedBox());
+
+  sdf::Geometry geom;
+  geom.SetType(sdf::GeometryType::HEIGHTMAP);
+  geom.SetHeightmapShape(heightmap);
+  ASSERT_NE(nullptr, geom.HeightmapShape());
+  EXPECT_EQ(heightmap.Uri(), geom.HeightmapShape()->Uri());
+  ASSERT_TRUE(geom.AxisAlignedBox().has_value());
+  EXPECT_EQ(heightmap.AxisAlignedBox(), *geom.AxisAlignedBox());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMHeightmap, Load)
+{
+  sdf::Heightmap heightmap;
+  sdf::Errors errors;
+
+  // Null element name
+  errors = heightmap.Load(nullptr);
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::ELEMENT_MISSING, errors[0].Code());
+  EXPECT_EQ(nullptr, heightmap.Element());
+
+  // Bad element name
+  sdf::ElementPtr sdf(new sdf::Element());
+  sdf->SetName("bad");
+  errors = heightmap.Load(sdf);
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::ELEMENT_INCORRECT_TYPE, errors[0].Code());
+  EXPECT_NE(nullptr, heightmap.Element());
+
+  // Missing <uri> element
+  sdf->SetName("heightmap");
+  errors = heightmap.Load(sdf);
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::ELEMENT_MISSING, errors[0].Code());
+  EXPECT_NE(std::string::npos, errors[0].Message().find("missing a <uri>"));
+
+  sdf::HeightmapTexture texture;
+  errors = texture.Load(nullptr);
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::ELEMENT_MISSING, errors[0].Code());
+
+  sdf::HeightmapBlend blend;
+  errors = blend.Load(sdf);
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::ELEMENT_INCORRECT_TYPE, errors[0].Code());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMHeightmap, LoadWorld)
+{
+  const std::string dir = sdf::filesystem::current_path();
+  const std::string heightsPath =
+      sdf::filesystem::append(dir, "heightmap_test_heights.png");
+  const std::string worldPath =
+      sdf::filesystem::append(dir, "heightmap_test.sdf");
+  const std::string heights = "not really a png";
+  {
+    std::ofstream output(heightsPath, std::ios::binary);
+    output << heights;
+  }
+  {
+    std::ofstream output(worldPath);
+    output <<
+      "<sdf version='1.8'><world name='default'><model name='ground'>"
+      "<static>true</static><link name='link'><visual name='visual'>"
+      "<geometry><heightmap>"
+      "  <uri>heightmap_test_heights.png</uri>"
+      "  <size>129 129 10</size>"
+      "  <pos>0 0 -1</pos>"
+      "  <texture><size>5</size><diffuse>dirt.png</diffuse>"
+      "    <normal>flat.png</normal></texture>"
+      "  <texture><size>10</size><diffuse>grass.png</diffuse>"
+      "    <normal>flat.png</normal></texture>"
+      "  <blend><min_height>2</min_height><fade_dist>5</fade_dist></blend>"
+      "  <use_terrain_paging>true</use_terrain_paging>"
+      "  <sampling>1</sampling>"
+      "</heightmap></geometry></visual></link></model></world></sdf>";
+  }
+
+  sdf::Root root;
+  sdf::Errors errors = root.Load(worldPath);
+  EXPECT_TRUE(errors.empty()) << errors;
+  const sdf::Visual *visual = root.WorldByIndex(0)->ModelByIndex(0)
+      ->LinkByIndex(0)->VisualByIndex(0);
+  ASSERT_NE(nullptr, visual);
+  EXPECT_EQ(sdf::GeometryType::HEIGHTMAP, visual->Geom()->Type());
+  const sdf::Heightmap *heightmap = visual->Geom()->HeightmapShape();
+  ASSERT_NE(nullptr, heightmap);
+
+  EXPECT_EQ("heightmap_test_heights.png", heightmap->Uri());
+  EXPECT_EQ(worldPath, heightmap->FilePath());
+  EXPECT_EQ(ignition::math::Vector3d(129, 129, 10), heightmap->Size());
+  EXPECT_EQ(ignition::math::Vector3d(0, 0, -1), heightmap->Position());
+  EXPECT_TRUE(heightmap->UseTerrainPaging());
+  EXPECT_EQ(1u, heightmap->Sampling());
+  ASSERT_EQ(2u, heightmap->TextureCount());
+  EXPECT_DOUBLE_EQ(5.0, heightmap->TextureByIndex(0)->Size());
+  EXPECT_EQ("dirt.png", heightmap->TextureByIndex(0)->Diffuse());
+  EXPECT_EQ("grass.png", heightmap->TextureByIndex(1)->Diffuse());
+  EXPECT_EQ("flat.png", heightmap->TextureByIndex(1)->Normal());
+  ASSERT_EQ(1u, heightmap->BlendCount());
+  EXPECT_DOUBLE_EQ(2.0, heightmap->BlendByIndex(0)->MinHeight());
+  EXPECT_DOUBLE_EQ(5.0, heightmap->BlendByIndex(0)->FadeDistance());
+
+  // The relative URI is resolved against the file of the world, and the
+  // data is only read when it is requested.
+  EXPECT_EQ(heightsPath, heightmap->ResolvedPath());
+  std::shared_ptr<const sdf::HeightmapData> data = heightmap->Data();
+  ASSERT_NE(nullptr, data);
+  EXPECT_EQ(heights, std::string(data->Data(), data->Size()));
+
+  // Later requests and copies get the same data.
+  EXPECT_EQ(data, heightmap->Data());
+  sdf::Heightmap copy(*heightmap);
+  EXPECT_EQ(data, copy.DataAsync().get());
+
+  // A loader is used by the request that loads the data.
+  heightmap->ReleaseData();
+  int calls = 0;
+  auto loader = [&calls](const sdf::Heightmap &_heightmap)
+  {
+    ++calls;
+    return std::make_shared<const sdf::HeightmapData>(
+        "decoded " + _heightmap.Uri());
+  };
+  std::shared_future<std::shared_ptr<const sdf::HeightmapData>> future =
+      heightmap->DataAsync(loader);
+  std::shared_ptr<const sdf::HeightmapData> decoded = future.get();
+  ASSERT_NE(nullptr, decoded);
+  EXPECT_FALSE(decoded->Mapped());
+  EXPECT_EQ("decoded heightmap_test_heights.png",
+      std::string(decoded->Data(), decoded->Size()));
+  EXPECT_EQ(decoded, heightmap->Data(loader));
+  EXPECT_EQ(1, calls);
+  EXPECT_EQ(heights, std::string(data->Data(), data->Size()));
+
+  // Changing the URI gives the heightmap data of its own.
+  copy.SetUri("missing_heights.png");
+  EXPECT_TRUE(copy.ResolvedPath().empty());
+  EXPECT_EQ(nullptr, copy.Data());
+  EXPECT_EQ(decoded, heightmap->Data());
+
+  EXPECT_EQ(0, std::remove(worldPath.c_str()));
+  EXPECT_EQ(0, std::remove(heightsPath.c_str()));
+}
@@ -18,6 +18,10 @@
 #include <string>
 #include "sdf/Imu.hh"
 
+#include "ElementFields.hh"
+#include "ElementRetentionScope.hh"
+#include "LoadStatsScope.hh"
+
 using namespace sdf;
 
 /// \brief Private imu data.
@@ -66,6 +70,72 @@ class sdf::ImuPrivate
   public: sdf::ElementPtr sdf;
 };
 
+/// \brief Get a loader for the noise of an axis, which is the <noise>
+/// element of its <x>, <y> or <z> element.
+/// \param[in] _member Noise member of the axis.
+/// \return Loader of the axis element.
+static ElementFields<ImuPrivate>::Loader axisNoise(Noise ImuPrivate::*_member)
+{
+  return [_member](ImuPrivate &_imu, const ElementPtr &_axis)
+  {
+    if (_axis->HasElement("noise"))
+      (_imu.*_member).Load(_axis->GetElement("noise"));
+  };
+}
+
+/// \brief Fields of the <imu> element.
+static const ElementFields<ImuPrivate> &imuFields()
+{
+  static const ElementFields<ImuPrivate> linearAccelerationFields =
+    ElementFields<ImuPrivate>()
+      .Child("x", axisNoise(&ImuPrivate::linearAccelXNoise))
+      .Child("y", axisNoise(&ImuPrivate::linearAccelYNoise))
+      .Child("z", axisNoise(&ImuPrivate::linearAccelZNoise));
+
+  static const ElementFields<ImuPrivate> angularVelocityFields =
+    ElementFields<ImuPrivate>()
+      .Child("x", axisNoise(&ImuPrivate::angularVelXNoise))
+      .Child("y", axisNoise(&ImuPrivate::angularVelYNoise))
+      .Child("z", axisNoise(&ImuPrivate::angularVelZNoise));
+
+  static const ElementFields<ImuPrivate> orientationFields =
+    ElementFields<ImuPrivate>()
+      .Value("localization", &ImuPrivate::localization)
+      .Child("grav_dir_x", [](ImuPrivate &_imu, const ElementPtr &_elem)
+        {
+          _imu.gravityDirX = _elem->Get<ignition::math::Vector3d>(
+              "", _imu.gravityDirX).first;
+          _imu.gravityDirXParentFrame = _elem->Get<std::string>(
+              "parent_frame", _imu.gravityDirXParentFrame).first;
+        })
+      .Child("custom_rpy", [](ImuPrivate &_imu, const ElementPtr &_elem)
+        {
+          _imu.customRpy = _elem->Get<ignition::math::Vector3d>(
+              "", _imu.customRpy).first;
+          _imu.customRpyParentFrame = _elem->Get<std::string>(
+              "parent_frame", _imu.customRpyParentFrame).first;
+        });
+
+  static const ElementFields<ImuPrivate> fields =
+    ElementFields<ImuPrivate>()
+      .Child("linear_acceleration",
+        [](ImuPrivate &_imu, const ElementPtr &_elem)
+        {
+          linearAccelerationFields.Load(_elem, _imu);
+        })
+      .Child("angular_velocity",
+        [](ImuPrivate &_imu, const ElementPtr &_elem)
+        {
+          angularVelocityFields.Load(_elem, _imu);
+        })
+      .Child("orientation_reference_frame",
+        [](ImuPrivate &_imu, const ElementPtr &_elem)
+        {
+          orientationFields.Load(_elem, _imu);
+        });
+  return fields;
+}
+
 //////////////////////////////////////////////////
 Imu::Imu()
   : dataPtr(new ImuPrivate)
@@ -107,9 +177,10 @@ Imu &Imu::operator=(Imu &&_imu) noexcept
 //////////////////////////////////////////////////
 Errors Imu::Load(ElementPtr _sdf)
 {
+  DomLoadTimer timer("Imu");
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that the provided SDF element is a <imu> element.
   // This is an error that cannot be recovered, so return an error.
@@ -121,94 +192,7 @@ Errors Imu::Load(ElementPtr _sdf)
     return errors;
   }
 
-  // Load the linear acceleration noise values.
-  if (_sdf->HasElement("linear_acceleration"))
-  {
-    sdf::ElementPtr elem = _sdf->GetElement("linear_acceleration");
-    if (elem->HasElement("x"))
-    {
-      if (elem->GetElement("x")->HasElement("noise"))
-      {
-        this->dataPtr->linearAccelXNoise.Load(
-            elem->GetElement("x")->GetElement("noise"));
-      }
-    }
-
-    if (elem->HasElement("y"))
-    {
-      if (elem->GetElement("y")->HasElement("noise"))
-      {
-        this->dataPtr->linearAccelYNoise.Load(
-            elem->GetElement("y")->GetElement("noise"));
-      }
-    }
-
-    if (elem->HasElement("z"))
-    {
-      if (elem->GetElement("z")->HasElement("noise"))
-      {
-        this->dataPtr->linearAccelZNoise.Load(
-            elem->GetElement("z")->GetElement("noise"));
-      }
-    }
-  }
-
-  // Load the angular velocity noise values.
-  if (_sdf->HasElement("angular_velocity"))
-  {
-    sdf::ElementPtr elem = _sdf->GetElement("angular_velocity");
-    if (elem->HasElement("x"))
-    {
-      if (elem->GetElement("x")->HasElement("noise"))
-      {
-        this->dataPtr->angularVelXNoise.Load(
-            elem->GetElement("x")->GetElement("noise"));
-      }
-    }
-
-    if (elem->HasElement("y"))
-    {
-      if (elem->GetElement("y")->HasElement("noise"))
-      {
-        this->dataPtr->angularVelYNoise.Load(
-            elem->GetElement("y")->GetElement("noise"));
-      }
-    }
-
-    if (elem->HasElement("z"))
-    {
-      if (elem->GetElement("z")->HasElement("noise"))
-      {
-        this->dataPtr->angularVelZNoise.Load(
-            elem->GetElement("z")->GetElement("noise"));
-      }
-    }
-  }
-
-  if (_sdf->HasElement("orientation_reference_frame"))
-  {
-    sdf::ElementPtr elem = _sdf->GetElement("orientation_reference_frame");
-    this->dataPtr->localization = elem->Get<std::string>("localization",
-        this->dataPtr->localization).first;
-
-    if (elem->HasElement("grav_dir_x"))
-    {
-      this->dataPtr->gravityDirX = elem->Get<ignition::math::Vector3d>(
-          "grav_dir_x", this->dataPtr->gravityDirX).first;
-      this->dataPtr->gravityDirXParentFrame =
-        elem->GetElement("grav_dir_x")->Get<std::string>("parent_frame",
-            this->dataPtr->gravityDirXParentFrame).first;
-    }
-
-    if (elem->HasElement("custom_rpy"))
-    {
-      this->dataPtr->customRpy = elem->Get<ignition::math::Vector3d>(
-          "custom_rpy", this->dataPtr->customRpy).first;
-      this->dataPtr->customRpyParentFrame =
-        elem->GetElement("custom_rpy")->Get<std::string>("parent_frame",
-            this->dataPtr->customRpyParentFrame).first;
-    }
-  }
+  imuFields().Load(_sdf, *this->dataPtr);
 
   return errors;
 }
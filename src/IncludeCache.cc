@@ -0,0 +1,256 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "sdf/Element.hh"
+#include "ElementArena.hh"
+#include "IncludeCache.hh"
+
+using namespace sdf;
+
+/////////////////////////////////////////////////
+/// \brief Make a deep copy of a parsed file on the heap. The cached copies
+/// outlive the load that read them, so they can't use its arena.
+/// \param[in] _sdf The SDF to copy.
+/// \return The copy.
+static SDFPtr cloneSDF(const SDFPtr &_sdf)
+{
+  ElementArenaScope heapScope(nullptr);
+  SDFPtr clone(new SDF);
+  clone->Root(_sdf->Root()->Clone());
+  clone->SetFilePath(_sdf->FilePath());
+  clone->SetOriginalVersion(_sdf->OriginalVersion());
+  return clone;
+}
+
+/////////////////////////////////////////////////
+IncludeCache &IncludeCache::Instance()
+{
+  static IncludeCache cache;
+  return cache;
+}
+
+/////////////////////////////////////////////////
+bool IncludeCache::Stamp(const VirtualFilesystem &_filesystem,
+    const std::string &_filename, FileStamp &_stamp)
+{
+  _stamp.filename = _filename;
+  VirtualFileStatus status;
+  if (!_filesystem.Stat(_filename, status))
+    return false;
+  _stamp.size = status.size;
+  _stamp.modified = status.modified;
+  return true;
+}
+
+/////////////////////////////////////////////////
+SDFPtr IncludeCache::Get(const std::string &_filename,
+    const std::string &_version, const VirtualFilesystem &_filesystem,
+    std::vector<FileStamp> &_files)
+{
+  const Key key(_filename, _version);
+  SDFPtr cached;
+  std::vector<FileStamp> files;
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    auto iter = this->index.find(key);
+    if (iter == this->index.end())
+      return nullptr;
+    cached = iter->second->sdf;
+    files = iter->second->files;
+  }
+
+  // Drop the entry if any of the files it was read from has changed. The
+  // files are checked without the lock, so concurrent lookups don't wait
+  // on each other's stat calls.
+  for (const FileStamp &file : files)
+  {
+    FileStamp current;
+    if (!Stamp(_filesystem, file.filename, current) ||
+        current.size != file.size || current.modified != file.modified)
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      auto iter = this->index.find(key);
+      if (iter != this->index.end() && iter->second->sdf == cached)
+      {
+        this->entries.erase(iter->second);
+        this->index.erase(iter);
+      }
+      return nullptr;
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    auto iter = this->index.find(key);
+    if (iter != this->index.end())
+      this->entries.splice(this->entries.begin(), this->entries, iter->second);
+  }
+
+  _files = files;
+
+  // Cached trees are never modified, so they can be cloned without the lock.
+  return cloneSDF(cached);
+}
+
+/////////////////////////////////////////////////
+void IncludeCache::Put(const std::string &_filename,
+    const std::string &_version, const SDFPtr &_sdf,
+    const std::vector<FileStamp> &_files)
+{
+  if (!_sdf || !_sdf->Root())
+    return;
+
+  SDFPtr clone = cloneSDF(_sdf);
+
+  std::lock_guard<std::mutex> lock(this->mutex);
+  if (this->capacity == 0)
+    return;
+
+  Key key(_filename, _version);
+  auto iter = this->index.find(key);
+  if (iter != this->index.end())
+  {
+    this->entries.erase(iter->second);
+    this->index.erase(iter);
+  }
+
+  this->entries.push_front({key, clone, _files});
+  this->index[key] = this->entries.begin();
+  this->Trim();
+}
+
+/////////////////////////////////////////////////
+bool IncludeCache::GetModelFile(const VirtualFilesystem &_filesystem,
+    const std::string &_modelDir, std::string &_modelFile)
+{
+  const ModelKey key(&_filesystem, _modelDir);
+  ModelEntry entry;
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    auto iter = this->modelFiles.find(key);
+    if (iter == this->modelFiles.end())
+      return false;
+    entry = iter->second;
+  }
+
+  FileStamp current;
+  if (!Stamp(_filesystem, entry.config.filename, current) ||
+      current.size != entry.config.size ||
+      current.modified != entry.config.modified)
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->modelFiles.erase(key);
+    return false;
+  }
+
+  _modelFile = entry.modelFile;
+  return true;
+}
+
+/////////////////////////////////////////////////
+void IncludeCache::PutModelFile(const VirtualFilesystem &_filesystem,
+    const std::string &_modelDir, const FileStamp &_config,
+    const std::string &_modelFile)
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  if (this->capacity == 0)
+    return;
+
+  this->modelFiles[ModelKey(&_filesystem, _modelDir)] = {_config, _modelFile};
+}
+
+/////////////////////////////////////////////////
+void IncludeCache::Clear()
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->entries.clear();
+  this->index.clear();
+  this->modelFiles.clear();
+}
+
+/////////////////////////////////////////////////
+void IncludeCache::Remove(const std::string &_filename)
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  for (auto iter = this->entries.begin(); iter != this->entries.end();)
+  {
+    const bool readFrom = std::any_of(iter->files.begin(), iter->files.end(),
+        [&_filename](const FileStamp &_file)
+        {
+          return _file.filename == _filename;
+        });
+    if (readFrom)
+    {
+      this->index.erase(iter->key);
+      iter = this->entries.erase(iter);
+    }
+    else
+    {
+      ++iter;
+    }
+  }
+
+  for (auto iter = this->modelFiles.begin(); iter != this->modelFiles.end();)
+  {
+    if (iter->second.config.filename == _filename ||
+        iter->second.modelFile == _filename)
+    {
+      iter = this->modelFiles.erase(iter);
+    }
+    else
+    {
+      ++iter;
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+void IncludeCache::SetCapacity(std::size_t _capacity)
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->capacity = _capacity;
+  if (this->capacity == 0)
+    this->modelFiles.clear();
+  this->Trim();
+}
+
+/////////////////////////////////////////////////
+std::size_t IncludeCache::Capacity() const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->capacity;
+}
+
+/////////////////////////////////////////////////
+std::size_t IncludeCache::Size() const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->entries.size();
+}
+
+/////////////////////////////////////////////////
+void IncludeCache::Trim()
+{
+  while (this->entries.size() > this->capacity)
+  {
+    this->index.erase(this->entries.back().key);
+    this->entries.pop_back();
+  }
+}
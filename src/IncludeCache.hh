@@ -0,0 +1,201 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_INCLUDE_CACHE_HH_
+#define SDF_INCLUDE_CACHE_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "sdf/SDFImpl.hh"
+#include "sdf/VirtualFilesystem.hh"
+#include "sdf/sdf_config.h"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief Process-wide cache of files read for <include> elements.
+  ///
+  /// Entries are keyed by the resolved file name and the SDF version the
+  /// file was converted to. Each entry remembers the size and modification
+  /// time of the file, and of every file it included in turn, and is
+  /// discarded as soon as any of them changes. Lookups hand out clones, so
+  /// callers are free to modify the result.
+  ///
+  /// The cache also remembers the model file that the model.config of each
+  /// model directory selects, so that includes of the same model don't
+  /// look for and parse the model.config again.
+  class IncludeCache
+  {
+    /// \brief Size and modification time of a file.
+    public: struct FileStamp
+    {
+      /// \brief Name of the file.
+      std::string filename;
+
+      /// \brief Size of the file in bytes.
+      int64_t size = 0;
+
+      /// \brief Modification time, in nanoseconds where available.
+      int64_t modified = 0;
+    };
+
+    /// \brief Get the process-wide cache.
+    /// \return The include cache.
+    public: static IncludeCache &Instance();
+
+    /// \brief Read the size and modification time of a file.
+    /// \param[in] _filesystem Filesystem the file is read from.
+    /// \param[in] _filename Name of the file.
+    /// \param[out] _stamp Stamp of the file.
+    /// \return True if the file exists.
+    public: static bool Stamp(const VirtualFilesystem &_filesystem,
+                              const std::string &_filename,
+                              FileStamp &_stamp);
+
+    /// \brief Look up a previously read file.
+    /// \param[in] _filename Resolved name of the file.
+    /// \param[in] _version SDF version the file must be converted to.
+    /// \param[in] _filesystem Filesystem the file was read from, which the
+    /// stamps are checked in.
+    /// \param[out] _files Stamps of the file and the files it includes,
+    /// set on a hit.
+    /// \return A clone of the cached SDF, or nullptr if there is no
+    /// up to date entry.
+    public: SDFPtr Get(const std::string &_filename,
+                       const std::string &_version,
+                       const VirtualFilesystem &_filesystem,
+                       std::vector<FileStamp> &_files);
+
+    /// \brief Store a file that has been read successfully.
+    /// \param[in] _filename Resolved name of the file.
+    /// \param[in] _version SDF version the file was converted to.
+    /// \param[in] _sdf The parsed file. It is cloned, so the caller keeps
+    /// ownership of _sdf.
+    /// \param[in] _files Stamps of the file and the files it includes.
+    public: void Put(const std::string &_filename,
+                     const std::string &_version,
+                     const SDFPtr &_sdf,
+                     const std::vector<FileStamp> &_files);
+
+    /// \brief Look up the model file of a model directory resolved before.
+    /// \param[in] _filesystem Filesystem the model directory is in.
+    /// \param[in] _modelDir Path of the model directory.
+    /// \param[out] _modelFile Path of the model file, set on a hit.
+    /// \return True if the model file is known and the model.config it was
+    /// read from has not changed.
+    public: bool GetModelFile(const VirtualFilesystem &_filesystem,
+                              const std::string &_modelDir,
+                              std::string &_modelFile);
+
+    /// \brief Store the model file of a model directory.
+    /// \param[in] _filesystem Filesystem the model directory is in.
+    /// \param[in] _modelDir Path of the model directory.
+    /// \param[in] _config Stamp of the model.config the model file was read
+    /// from, taken before it was read.
+    /// \param[in] _modelFile Path of the model file.
+    public: void PutModelFile(const VirtualFilesystem &_filesystem,
+                              const std::string &_modelDir,
+                              const FileStamp &_config,
+                              const std::string &_modelFile);
+
+    /// \brief Remove all entries.
+    public: void Clear();
+
+    /// \brief Remove the entries that were read from a file, directly or
+    /// through an include, and the model directories whose model.config or
+    /// model file it is, whether or not the file looks changed.
+    /// \param[in] _filename Name of the file.
+    public: void Remove(const std::string &_filename);
+
+    /// \brief Set the maximum number of entries. The least recently used
+    /// entries are removed when the cache is full. A capacity of 0 disables
+    /// the cache.
+    /// \param[in] _capacity Maximum number of entries.
+    public: void SetCapacity(std::size_t _capacity);
+
+    /// \brief Get the maximum number of entries.
+    /// \return The capacity.
+    public: std::size_t Capacity() const;
+
+    /// \brief Get the number of entries.
+    /// \return The number of cached files.
+    public: std::size_t Size() const;
+
+    /// \brief Key of an entry, the file name and SDF version.
+    private: using Key = std::pair<std::string, std::string>;
+
+    /// \brief A cached file.
+    private: struct Entry
+    {
+      /// \brief Key of this entry.
+      Key key;
+
+      /// \brief The parsed file.
+      SDFPtr sdf;
+
+      /// \brief Stamps of the file and the files it includes.
+      std::vector<FileStamp> files;
+    };
+
+    /// \brief Key of a model directory, the filesystem it is in and its
+    /// path.
+    private: using ModelKey = std::pair<const VirtualFilesystem *,
+                                        std::string>;
+
+    /// \brief A resolved model directory.
+    private: struct ModelEntry
+    {
+      /// \brief Stamp of the model.config of the directory.
+      FileStamp config;
+
+      /// \brief Path of the model file.
+      std::string modelFile;
+    };
+
+    /// \brief Remove least recently used entries until the size is within
+    /// capacity. The mutex must be held.
+    private: void Trim();
+
+    /// \brief Protects the members below.
+    private: mutable std::mutex mutex;
+
+    /// \brief Entries, most recently used first.
+    private: std::list<Entry> entries;
+
+    /// \brief Position of each entry in the entries list.
+    private: std::map<Key, std::list<Entry>::iterator> index;
+
+    /// \brief Model files of the model directories resolved so far. There
+    /// are few model directories compared to the files read, so they are
+    /// not bounded by the capacity.
+    private: std::map<ModelKey, ModelEntry> modelFiles;
+
+    /// \brief Maximum number of entries.
+    private: std::size_t capacity = 256;
+  };
+  }
+}
+#endif
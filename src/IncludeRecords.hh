@@ -0,0 +1,83 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_INCLUDE_RECORDS_HH_
+#define SDF_INCLUDE_RECORDS_HH_
+
+#include <string>
+#include <vector>
+
+#include "sdf/Element.hh"
+#include "sdf/sdf_config.h"
+
+#include "IncludeCache.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief A model included in a world, recorded so that the include can be
+  /// read again when the files it came from change.
+  /// \sa Root::ReloadIncludes
+  struct IncludeRecord
+  {
+    /// \brief The <model> element the include was merged as.
+    ElementWeakPtr element;
+
+    /// \brief The <include> element, as XML.
+    std::string xml;
+
+    /// \brief Stamps of the included file and of the files it includes.
+    std::vector<IncludeCache::FileStamp> files;
+  };
+
+  /// \brief Sets where the models included in worlds read on the current
+  /// thread are recorded, for as long as the scope is alive. Scopes nest,
+  /// and the previous setting is restored when a scope is destroyed.
+  class IncludeRecordScope
+  {
+    /// \brief Constructor
+    /// \param[in] _records Vector to add the records to, or nullptr to not
+    /// record includes in this scope.
+    public: explicit IncludeRecordScope(std::vector<IncludeRecord> *_records)
+      : previous(Records())
+    {
+      Records() = _records;
+    }
+
+    /// \brief Destructor
+    public: ~IncludeRecordScope()
+    {
+      Records() = this->previous;
+    }
+
+    /// \brief Get the records of the current thread.
+    /// \return Reference to the vector the records are added to, or to
+    /// nullptr if includes are not recorded.
+    public: static std::vector<IncludeRecord> *&Records()
+    {
+      static thread_local std::vector<IncludeRecord> *records = nullptr;
+      return records;
+    }
+
+    /// \brief Setting that was current before this scope.
+    private: std::vector<IncludeRecord> *previous;
+  };
+  }
+}
+#endif
@@ -0,0 +1,307 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "sdf/IncrementalLoader.hh"
+#include "sdf/Model.hh"
+#include "sdf/Root.hh"
+#include "sdf/World.hh"
+#include "DiagnosticScope.hh"
+#include "IncrementalRead.hh"
+#include "RegionExclusions.hh"
+#include "Tracing.hh"
+#include "Utils.hh"
+
+using namespace sdf;
+
+/// \brief Number of XML elements read between two checks of the time
+/// budget.
+static constexpr std::size_t kReadChunk = 64u;
+
+class sdf::IncrementalLoaderPrivate
+{
+  /// \brief Constructor
+  /// \param[in,out] _root Root to load the file into.
+  /// \param[in] _filename Name of the file to load.
+  /// \param[in] _config Parser configuration.
+  public: IncrementalLoaderPrivate(Root &_root, const std::string &_filename,
+              const ParserConfig &_config)
+    : root(_root), filename(_filename), config(_config),
+      read(_filename, this->config)
+  {
+    this->diagnostics.sink = this->config.Diagnostics();
+  }
+
+  /// \brief Read more of the file, then check the document once it is
+  /// read.
+  /// \param[in] _budget Budget of the step.
+  /// \param[in] _inTime Function that tells whether the step has time left.
+  public: template <typename InTime>
+          void Read(const IncrementalLoadBudget &_budget, InTime &&_inTime)
+  {
+    std::size_t left = std::max<std::size_t>(_budget.elements, 1u);
+    bool fileRead = false;
+    do
+    {
+      const std::size_t chunk = std::min(left, kReadChunk);
+      fileRead = this->read.Step(chunk, this->errors);
+      left -= chunk;
+    }
+    while (!fileRead && left > 0u && _inTime());
+
+    if (!fileRead)
+      return;
+
+    this->sdf = this->read.Document();
+    if (!this->sdf)
+    {
+      addError(this->errors, this->config, ErrorCode::FILE_READ, [&]
+          {
+            return "Unable to read file:" + this->filename;
+          });
+      this->phase = IncrementalLoadPhase::DONE;
+      return;
+    }
+
+    this->phase = loadStopped(this->errors, this->config) ?
+        IncrementalLoadPhase::DONE : IncrementalLoadPhase::LOAD;
+  }
+
+  /// \brief Load the DOM with lazy models, and list the models and the
+  /// graph scopes that the next steps load and build.
+  public: void Load()
+  {
+    ParserConfig lazyConfig = this->config;
+    lazyConfig.SetLazyModels(true);
+    Errors loadErrors = this->root.Load(this->sdf, lazyConfig);
+    this->errors.insert(this->errors.end(), loadErrors.begin(),
+        loadErrors.end());
+
+    // Models that are lazy in the configuration stay lazy.
+    if (this->config.LazyModels() || loadStopped(this->errors, this->config))
+    {
+      this->phase = IncrementalLoadPhase::DONE;
+      return;
+    }
+
+    for (uint64_t w = 0; w < this->root.WorldCount(); ++w)
+    {
+      const World *world = this->root.WorldByIndex(w);
+      for (uint64_t m = 0; m < world->ModelCount(); ++m)
+        this->models.push_back(world->ModelByIndex(m));
+    }
+    for (uint64_t m = 0; m < this->root.ModelCount(); ++m)
+      this->models.push_back(this->root.ModelByIndex(m));
+    this->graphScopeCount = this->root.DeferredGraphCount();
+
+    this->phase = IncrementalLoadPhase::MODELS;
+    this->SkipEmptyPhases();
+  }
+
+  /// \brief Load the contents of more models.
+  /// \param[in] _budget Budget of the step.
+  /// \param[in] _inTime Function that tells whether the step has time left.
+  public: template <typename InTime>
+          void LoadModels(const IncrementalLoadBudget &_budget,
+              InTime &&_inTime)
+  {
+    const std::size_t limit = std::max<std::size_t>(_budget.models, 1u);
+    for (std::size_t loaded = 0; this->modelsLoaded < this->models.size() &&
+        loaded < limit && (loaded == 0 || _inTime()); ++loaded)
+    {
+      Errors modelErrors =
+          this->models[this->modelsLoaded++]->LoadOwnContents();
+      this->errors.insert(this->errors.end(), modelErrors.begin(),
+          modelErrors.end());
+      if (loadStopped(this->errors, this->config))
+      {
+        this->phase = IncrementalLoadPhase::DONE;
+        return;
+      }
+    }
+    this->SkipEmptyPhases();
+  }
+
+  /// \brief Build the frame graphs of more scopes.
+  /// \param[in] _budget Budget of the step.
+  /// \param[in] _inTime Function that tells whether the step has time left.
+  public: template <typename InTime>
+          void BuildGraphs(const IncrementalLoadBudget &_budget,
+              InTime &&_inTime)
+  {
+    const std::size_t limit = std::max<std::size_t>(_budget.graphScopes, 1u);
+    for (std::size_t built = 0; this->graphScopesBuilt < this->graphScopeCount
+        && built < limit && (built == 0 || _inTime()); ++built)
+    {
+      Errors graphErrors =
+          this->root.BuildDeferredGraphs(this->graphScopesBuilt++);
+      this->errors.insert(this->errors.end(), graphErrors.begin(),
+          graphErrors.end());
+      if (loadStopped(this->errors, this->config))
+      {
+        this->phase = IncrementalLoadPhase::DONE;
+        return;
+      }
+    }
+    this->SkipEmptyPhases();
+  }
+
+  /// \brief Move past the MODELS and GRAPHS phases once their work is
+  /// done, so that no step is spent on a phase without work.
+  public: void SkipEmptyPhases()
+  {
+    if (this->phase == IncrementalLoadPhase::MODELS &&
+        this->modelsLoaded == this->models.size())
+    {
+      this->phase = IncrementalLoadPhase::GRAPHS;
+    }
+    if (this->phase == IncrementalLoadPhase::GRAPHS &&
+        this->graphScopesBuilt == this->graphScopeCount)
+    {
+      this->phase = IncrementalLoadPhase::DONE;
+    }
+  }
+
+  /// \brief Root to load the file into.
+  public: Root &root;
+
+  /// \brief Name of the file to load.
+  public: std::string filename;
+
+  /// \brief Copy of the parser configuration.
+  public: ParserConfig config;
+
+  /// \brief Read of the file, which refers to config.
+  public: IncrementalRead read;
+
+  /// \brief Diagnostic state of the load, shared by its steps so that
+  /// repeated messages are written once per load.
+  public: LoadDiagnostics diagnostics;
+
+  /// \brief Models left out of the worlds by the region filter, recorded
+  /// by the read and checked by Root::Load.
+  public: std::vector<RegionExclusion> exclusions;
+
+  /// \brief The document, once it is read.
+  public: SDFPtr sdf;
+
+  /// \brief Errors of the load so far.
+  public: Errors errors;
+
+  /// \brief Phase of the next step.
+  public: IncrementalLoadPhase phase = IncrementalLoadPhase::READ;
+
+  /// \brief Models of the worlds followed by the top level models, whose
+  /// contents are loaded by the MODELS phase.
+  public: std::vector<const Model *> models;
+
+  /// \brief Number of models whose contents are loaded.
+  public: std::size_t modelsLoaded = 0u;
+
+  /// \brief Number of scopes whose frame graphs are built.
+  public: std::size_t graphScopesBuilt = 0u;
+
+  /// \brief Number of scopes with frame graphs to build.
+  public: std::size_t graphScopeCount = 0u;
+};
+
+/////////////////////////////////////////////////
+IncrementalLoader::IncrementalLoader(Root &_root, const std::string &_filename,
+    const ParserConfig &_config)
+  : dataPtr(new IncrementalLoaderPrivate(_root, _filename, _config))
+{
+}
+
+/////////////////////////////////////////////////
+IncrementalLoader::~IncrementalLoader()
+{
+  delete this->dataPtr;
+  this->dataPtr = nullptr;
+}
+
+/////////////////////////////////////////////////
+bool IncrementalLoader::Step(const IncrementalLoadBudget &_budget)
+{
+  IncrementalLoaderPrivate &data = *this->dataPtr;
+  if (data.phase == IncrementalLoadPhase::DONE)
+    return true;
+
+  SDF_TRACE_SCOPE_TEXT("sdf::IncrementalLoader::Step", data.filename);
+  DiagnosticScope diagnosticScope(&data.diagnostics);
+  RegionExclusionScope exclusionScope(&data.exclusions);
+
+  const auto start = std::chrono::steady_clock::now();
+  const auto inTime = [&]()
+  {
+    return _budget.time.count() <= 0 ||
+        std::chrono::steady_clock::now() - start < _budget.time;
+  };
+
+  switch (data.phase)
+  {
+    case IncrementalLoadPhase::READ:
+      data.Read(_budget, inTime);
+      break;
+    case IncrementalLoadPhase::LOAD:
+      data.Load();
+      break;
+    case IncrementalLoadPhase::MODELS:
+      data.LoadModels(_budget, inTime);
+      break;
+    case IncrementalLoadPhase::GRAPHS:
+      data.BuildGraphs(_budget, inTime);
+      break;
+    case IncrementalLoadPhase::DONE:
+      break;
+  }
+
+  if (data.phase != IncrementalLoadPhase::DONE)
+    return false;
+
+  truncateErrors(data.errors, data.config);
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool IncrementalLoader::Done() const
+{
+  return this->dataPtr->phase == IncrementalLoadPhase::DONE;
+}
+
+/////////////////////////////////////////////////
+IncrementalLoadProgress IncrementalLoader::Progress() const
+{
+  const IncrementalLoaderPrivate &data = *this->dataPtr;
+  IncrementalLoadProgress progress;
+  progress.phase = data.phase;
+  progress.elementsRead = data.read.ElementCount();
+  progress.modelsLoaded = data.modelsLoaded;
+  progress.modelCount = data.models.size();
+  progress.graphScopesBuilt = data.graphScopesBuilt;
+  progress.graphScopeCount = data.graphScopeCount;
+  return progress;
+}
+
+/////////////////////////////////////////////////
+const Errors &IncrementalLoader::LoadErrors() const
+{
+  return this->dataPtr->errors;
+}
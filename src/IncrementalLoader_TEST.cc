@@ -0,0 +1,202 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <string>
+
+#include "sdf/Filesystem.hh"
+#include "sdf/IncrementalLoader.hh"
+#include "sdf/Model.hh"
+#include "sdf/ParserConfig.hh"
+#include "sdf/Root.hh"
+#include "sdf/World.hh"
+#include "test_config.h"
+
+/////////////////////////////////////////////////
+/// \brief Write a world with models to a file.
+/// \param[in] _name Name of the file.
+/// \param[in] _models Number of models.
+/// \return Path of the file.
+static std::string writeWorld(const std::string &_name, int _models)
+{
+  const std::string path = sdf::filesystem::append(PROJECT_BINARY_DIR, _name);
+  std::ofstream out(path);
+  out << "<sdf version='1.8'><world name='default'>";
+  for (int i = 0; i < _models; ++i)
+  {
+    out << "<model name='m" << i << "'>"
+        << "<pose>" << i << " 0 0 0 0 0</pose>"
+        << "<link name='l'><visual name='v'><geometry><box>"
+        << "<size>1 1 1</size></box></geometry></visual></link>"
+        << "<frame name='f' attached_to='l'/></model>";
+  }
+  out << "</world></sdf>";
+  return path;
+}
+
+/////////////////////////////////////////////////
+TEST(IncrementalLoader, Steps)
+{
+  const std::string path = writeWorld("incremental_loader_world.sdf", 20);
+
+  sdf::Root root;
+  sdf::IncrementalLoader loader(root, path);
+  EXPECT_FALSE(loader.Done());
+  EXPECT_EQ(sdf::IncrementalLoadPhase::READ, loader.Progress().phase);
+
+  sdf::IncrementalLoadBudget budget;
+  budget.elements = 10u;
+  budget.models = 3u;
+
+  int steps = 0;
+  std::size_t elementsRead = 0u;
+  while (!loader.Step(budget))
+  {
+    ++steps;
+    const sdf::IncrementalLoadProgress progress = loader.Progress();
+    EXPECT_GE(progress.elementsRead, elementsRead);
+    elementsRead = progress.elementsRead;
+    if (progress.phase == sdf::IncrementalLoadPhase::MODELS)
+    {
+      EXPECT_EQ(20u, progress.modelCount);
+      EXPECT_EQ(1u, progress.graphScopeCount);
+      EXPECT_EQ(0u, progress.modelsLoaded % 3u);
+    }
+    ASSERT_LT(steps, 1000);
+  }
+
+  // The first step reads the <sdf> element, and the 161 other elements of
+  // the file take 17 steps, followed by the load and 7 steps of models.
+  // The last step builds the graphs.
+  EXPECT_LE(25, steps);
+  EXPECT_TRUE(loader.Done());
+  EXPECT_TRUE(loader.Step());
+  EXPECT_TRUE(loader.LoadErrors().empty()) << loader.LoadErrors();
+
+  const sdf::IncrementalLoadProgress progress = loader.Progress();
+  EXPECT_EQ(sdf::IncrementalLoadPhase::DONE, progress.phase);
+  EXPECT_LE(160u, progress.elementsRead);
+  EXPECT_EQ(20u, progress.modelsLoaded);
+  EXPECT_EQ(1u, progress.graphScopesBuilt);
+
+  ASSERT_EQ(1u, root.WorldCount());
+  const sdf::World *world = root.WorldByIndex(0);
+  ASSERT_EQ(20u, world->ModelCount());
+  for (uint64_t i = 0; i < world->ModelCount(); ++i)
+    EXPECT_TRUE(world->ModelByIndex(i)->ContentsLoaded());
+
+  // The DOM matches a load of the whole file.
+  sdf::Root expected;
+  ASSERT_TRUE(expected.Load(path).empty());
+  const sdf::World *expectedWorld = expected.WorldByIndex(0);
+  for (uint64_t i = 0; i < world->ModelCount(); ++i)
+  {
+    const sdf::Model *model = world->ModelByIndex(i);
+    const sdf::Model *expectedModel = expectedWorld->ModelByIndex(i);
+    EXPECT_EQ(expectedModel->Name(), model->Name());
+    EXPECT_EQ(expectedModel->LinkCount(), model->LinkCount());
+    EXPECT_EQ(expectedModel->FrameCount(), model->FrameCount());
+
+    ignition::math::Pose3d pose, expectedPose;
+    EXPECT_TRUE(model->SemanticPose().Resolve(pose, "world").empty());
+    EXPECT_TRUE(
+        expectedModel->SemanticPose().Resolve(expectedPose, "world").empty());
+    EXPECT_EQ(expectedPose, pose);
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(IncrementalLoader, OneStep)
+{
+  const std::string path = writeWorld("incremental_loader_one_step.sdf", 5);
+
+  // A large enough budget finishes each phase in one step.
+  sdf::Root root;
+  sdf::IncrementalLoader loader(root, path);
+  sdf::IncrementalLoadBudget budget;
+  EXPECT_FALSE(loader.Step(budget));
+  EXPECT_EQ(sdf::IncrementalLoadPhase::LOAD, loader.Progress().phase);
+  EXPECT_FALSE(loader.Step(budget));
+  EXPECT_EQ(sdf::IncrementalLoadPhase::MODELS, loader.Progress().phase);
+  EXPECT_FALSE(loader.Step(budget));
+  EXPECT_EQ(sdf::IncrementalLoadPhase::GRAPHS, loader.Progress().phase);
+  EXPECT_TRUE(loader.Step(budget));
+  EXPECT_TRUE(loader.LoadErrors().empty()) << loader.LoadErrors();
+  EXPECT_EQ(5u, root.WorldByIndex(0)->ModelCount());
+
+  // Lazy models are left to load on first access.
+  sdf::ParserConfig config;
+  config.SetLazyModels(true);
+  sdf::Root lazyRoot;
+  sdf::IncrementalLoader lazyLoader(lazyRoot, path, config);
+  EXPECT_FALSE(lazyLoader.Step(budget));
+  EXPECT_TRUE(lazyLoader.Step(budget));
+  EXPECT_EQ(0u, lazyLoader.Progress().modelCount);
+  EXPECT_FALSE(lazyRoot.WorldByIndex(0)->ModelByIndex(0)->ContentsLoaded());
+}
+
+/////////////////////////////////////////////////
+TEST(IncrementalLoader, Errors)
+{
+  sdf::Root root;
+  sdf::IncrementalLoader loader(root, sdf::filesystem::append(
+      PROJECT_BINARY_DIR, "incremental_loader_missing.sdf"));
+  EXPECT_TRUE(loader.Step());
+  ASSERT_EQ(1u, loader.LoadErrors().size());
+  EXPECT_EQ(sdf::ErrorCode::FILE_READ, loader.LoadErrors()[0].Code());
+  EXPECT_EQ(0u, root.WorldCount());
+
+  // The errors of a model and of the graphs are found by their steps.
+  const std::string path = sdf::filesystem::append(PROJECT_BINARY_DIR,
+      "incremental_loader_errors.sdf");
+  {
+    std::ofstream out(path);
+    out << "<sdf version='1.8'><world name='default'>"
+        << "<model name='a'><link name='l'/>"
+        << "<frame name='f' attached_to='missing'/></model>"
+        << "<model name='b'><static>true</static></model>"
+        << "<model name='c'/>"
+        << "</world></sdf>";
+  }
+
+  sdf::Root expected;
+  const sdf::Errors expectedErrors = expected.Load(path);
+  ASSERT_FALSE(expectedErrors.empty());
+
+  sdf::Root errorRoot;
+  sdf::IncrementalLoader errorLoader(errorRoot, path);
+  sdf::IncrementalLoadBudget budget;
+  budget.models = 1u;
+  while (!errorLoader.Step(budget))
+    continue;
+
+  // The same errors are found, although not in the same order.
+  ASSERT_EQ(expectedErrors.size(), errorLoader.LoadErrors().size())
+      << errorLoader.LoadErrors();
+  for (const sdf::Error &error : expectedErrors)
+  {
+    bool found = false;
+    for (const sdf::Error &loadError : errorLoader.LoadErrors())
+    {
+      found = found || (loadError.Code() == error.Code() &&
+          loadError.Message() == error.Message());
+    }
+    EXPECT_TRUE(found) << error;
+  }
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_INCREMENTAL_READ_HH_
+#define SDF_INCREMENTAL_READ_HH_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "sdf/Error.hh"
+#include "sdf/ParserConfig.hh"
+#include "sdf/SDFImpl.hh"
+#include "sdf/sdf_config.h"
+
+/// \ingroup sdf_parser
+/// \brief namespace for Simulation Description Format parser
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  class IncrementalReadPrivate;
+
+  /// \brief Reads a file in steps, for IncrementalLoader. The first step
+  /// parses the file as XML and converts it to the current version, and
+  /// each step then reads up to a number of XML elements into the element
+  /// tree, as readFile does. An included file counts as one element.
+  /// URDF files, and files read with ParserConfig::StreamingRead or
+  /// ParserConfig::ChunkedXmlParse, are read as a whole by the first step,
+  /// which is the only way such a read uses the on-disk load cache.
+  class IncrementalRead
+  {
+    /// \brief Constructor
+    /// \param[in] _filename Name of the file to read.
+    /// \param[in] _config Parser configuration, which must outlive the
+    /// read.
+    public: IncrementalRead(const std::string &_filename,
+                const ParserConfig &_config);
+
+    /// \brief No copy constructor, the state refers to the XML document.
+    public: IncrementalRead(const IncrementalRead &) = delete;
+
+    /// \brief No copy assignment operator.
+    public: IncrementalRead &operator=(const IncrementalRead &) = delete;
+
+    /// \brief Destructor
+    public: ~IncrementalRead();
+
+    /// \brief Read more of the file.
+    /// \param[in] _elements Maximum number of XML elements to read.
+    /// \param[out] _errors Captures errors found during parsing.
+    /// \return True once the file is read, or reading it failed.
+    public: bool Step(std::size_t _elements, Errors &_errors);
+
+    /// \brief Get the number of XML elements read so far.
+    /// \return Number of elements.
+    public: std::size_t ElementCount() const;
+
+    /// \brief Get the document, once Step returned true.
+    /// \return The document, or nullptr if it could not be read.
+    public: SDFPtr Document() const;
+
+    /// \brief Private data pointer.
+    private: std::unique_ptr<IncrementalReadPrivate> dataPtr;
+  };
+  }
+}
+#endif
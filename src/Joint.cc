@@ -24,8 +24,12 @@
 #include "sdf/Joint.hh"
 #include "sdf/JointAxis.hh"
 #include "sdf/Types.hh"
+#include "ElementRetentionScope.hh"
 #include "FrameSemantics.hh"
+#include "LoadStatsScope.hh"
+#include "MemoryAccounting.hh"
 #include "ScopedGraph.hh"
+#include "Tracing.hh"
 #include "Utils.hh"
 
 using namespace sdf;
@@ -145,9 +149,11 @@ Joint &Joint::operator=(Joint &&_joint)
 /////////////////////////////////////////////////
 Errors Joint::Load(ElementPtr _sdf)
 {
+  SDF_TRACE_SCOPE_TEXT("sdf::Joint::Load", _sdf->Get<std::string>("name"));
+  DomLoadTimer timer("Joint");
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that the provided SDF element is a <joint>
   // This is an error that cannot be recovered, so return an error.
@@ -475,3 +481,10 @@ sdf::ElementPtr Joint::Element() const
 {
   return this->dataPtr->sdf;
 }
+
+/////////////////////////////////////////////////
+template <>
+std::size_t sdf::domPrivateSize<Joint>()
+{
+  return sizeof(JointPrivate);
+}
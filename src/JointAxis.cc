@@ -16,18 +16,92 @@
  */
 #include <algorithm>
 #include <iterator>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include <ignition/math/Pose3.hh>
+#include <ignition/math/Quaternion.hh>
 #include <ignition/math/Vector3.hh>
 
 #include "sdf/Assert.hh"
 #include "sdf/Error.hh"
 #include "sdf/JointAxis.hh"
+#include "ElementRetentionScope.hh"
 #include "FrameSemantics.hh"
+#include "LoadStatsScope.hh"
 #include "ScopedGraph.hh"
 
 using namespace sdf;
 
+/// \brief Rotations from the frame xyz is expressed in to the frames it
+/// was resolved to. A joint axis is typically resolved to one or two
+/// frames, so the entries are searched linearly.
+class ResolvedAxisCache
+{
+  /// \brief Constructor.
+  public: ResolvedAxisCache() = default;
+
+  /// \brief Copy constructor. Copies resolve with the same graph, so the
+  /// entries are copied.
+  /// \param[in] _cache Cache to copy.
+  public: ResolvedAxisCache(const ResolvedAxisCache &_cache)
+  {
+    std::lock_guard<std::mutex> lock(_cache.mutex);
+    this->entries = _cache.entries;
+  }
+
+  /// \brief Look up the rotation to a frame.
+  /// \param[in] _frame Name of the frame.
+  /// \param[out] _rotation The rotation, if found.
+  /// \return True if the rotation to _frame was cached.
+  public: bool Find(const std::string &_frame,
+                    ignition::math::Quaterniond &_rotation) const
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    for (const auto &entry : this->entries)
+    {
+      if (entry.first == _frame)
+      {
+        _rotation = entry.second;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// \brief Cache the rotation to a frame.
+  /// \param[in] _frame Name of the frame.
+  /// \param[in] _rotation The rotation.
+  public: void Insert(const std::string &_frame,
+                      const ignition::math::Quaterniond &_rotation) const
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    for (const auto &entry : this->entries)
+    {
+      if (entry.first == _frame)
+        return;
+    }
+    this->entries.emplace_back(_frame, _rotation);
+  }
+
+  /// \brief Forget the cached rotations, when the frames or the graph
+  /// change.
+  public: void Clear()
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->entries.clear();
+  }
+
+  /// \brief Protects the entries.
+  private: mutable std::mutex mutex;
+
+  /// \brief Frame names and the rotations to them.
+  private: mutable std::vector<
+               std::pair<std::string, ignition::math::Quaterniond>> entries;
+};
+
 class sdf::JointAxisPrivate
 {
   /// \brief Default joint position for this joint axis.
@@ -88,6 +162,9 @@ class sdf::JointAxisPrivate
 
   /// \brief Scoped Pose Relative-To graph at the parent model scope.
   public: sdf::ScopedGraph<sdf::PoseRelativeToGraph> poseRelativeToGraph;
+
+  /// \brief Rotations resolved by ResolveXyz, which don't depend on xyz.
+  public: ResolvedAxisCache resolvedRotations;
 };
 
 /////////////////////////////////////////////////
@@ -131,9 +208,11 @@ JointAxis &JointAxis::operator=(JointAxis &&_jointAxis)
 /////////////////////////////////////////////////
 Errors JointAxis::Load(ElementPtr _sdf)
 {
+  DomLoadTimer timer("JointAxis");
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
+  this->dataPtr->resolvedRotations.Clear();
 
   // Read the initial position. This is optional, with a default value of 0.
   this->dataPtr->initialPosition = _sdf->Get<double>(
@@ -368,12 +447,14 @@ const std::string &JointAxis::XyzExpressedIn() const
 void JointAxis::SetXyzExpressedIn(const std::string &_frame)
 {
   this->dataPtr->xyzExpressedIn = _frame;
+  this->dataPtr->resolvedRotations.Clear();
 }
 
 /////////////////////////////////////////////////
 void JointAxis::SetXmlParentName(const std::string &_xmlParentName)
 {
   this->dataPtr->xmlParentName = _xmlParentName;
+  this->dataPtr->resolvedRotations.Clear();
 }
 
 /////////////////////////////////////////////////
@@ -381,6 +462,7 @@ void JointAxis::SetPoseRelativeToGraph(
     sdf::ScopedGraph<PoseRelativeToGraph> _graph)
 {
   this->dataPtr->poseRelativeToGraph = _graph;
+  this->dataPtr->resolvedRotations.Clear();
 }
 
 /////////////////////////////////////////////////
@@ -405,16 +487,18 @@ Errors JointAxis::ResolveXyz(
 
   // JointAxis is not in the graph, but its XyzExpressedIn() name should be.
   // If XyzExpressedIn() is empty, use the name of the xml parent object.
-  std::string axisExpressedIn = this->XyzExpressedIn();
-  if (axisExpressedIn.empty())
-  {
-    axisExpressedIn = this->dataPtr->xmlParentName;
-  }
-
-  std::string resolveTo = _resolveTo;
-  if (resolveTo.empty())
+  const std::string &axisExpressedIn = this->dataPtr->xyzExpressedIn.empty() ?
+    this->dataPtr->xmlParentName : this->dataPtr->xyzExpressedIn;
+  const std::string &resolveTo = _resolveTo.empty() ?
+    this->dataPtr->xmlParentName : _resolveTo;
+
+  // The rotation only depends on the frames, so it is resolved once per
+  // frame until the frames or the graph change.
+  ignition::math::Quaterniond rotation;
+  if (this->dataPtr->resolvedRotations.Find(resolveTo, rotation))
   {
-    resolveTo = this->dataPtr->xmlParentName;
+    _xyz = rotation * this->Xyz();
+    return errors;
   }
 
   ignition::math::Pose3d pose;
@@ -422,6 +506,7 @@ Errors JointAxis::ResolveXyz(
 
   if (errors.empty())
   {
+    this->dataPtr->resolvedRotations.Insert(resolveTo, pose.Rot());
     _xyz = pose.Rot() * this->Xyz();
   }
 
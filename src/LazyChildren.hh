@@ -0,0 +1,61 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_LAZY_CHILDREN_HH_
+#define SDF_LAZY_CHILDREN_HH_
+
+#include <string>
+
+#include "sdf/Element.hh"
+#include "sdf/ParserConfig.hh"
+#include "sdf/sdf_config.h"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief Child elements of an element whose reading was deferred, see
+  /// ParserConfig::SetLazyElements. The parser stores the XML of the
+  /// element, and the children are read from it the first time they are
+  /// accessed. The attributes and value of the element are read when it is
+  /// parsed.
+  ///
+  /// The functions are implemented by the parser, next to readXml.
+  class LazyChildren
+  {
+    /// \brief Defer reading the children of an element.
+    /// \param[in] _elem Element whose attributes and value have been read.
+    /// \param[in] _xml Compact XML of the element.
+    /// \param[in] _config Configuration to read the children with.
+    public: static void Defer(const ElementPtr &_elem, std::string _xml,
+                              const ParserConfig &_config);
+
+    /// \brief Read the deferred children of an element. Errors are printed,
+    /// because there is no caller to return them to.
+    /// \param[in] _elem Element with deferred children.
+    public: static void Read(const ElementPtr &_elem);
+
+    /// \brief Compact XML of the element.
+    public: std::string xml;
+
+    /// \brief Configuration to read the children with, without statistics.
+    public: ParserConfig config;
+  };
+  }
+}
+#endif
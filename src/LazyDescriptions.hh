@@ -0,0 +1,83 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_LAZY_DESCRIPTIONS_HH_
+#define SDF_LAZY_DESCRIPTIONS_HH_
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+
+#include "sdf/Element.hh"
+#include "sdf/sdf_config.h"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  struct SpecElement;
+
+  /// \brief Child descriptions of an element description whose creation
+  /// was deferred. Descriptions initialized from the generated spec tables
+  /// only get their name, value and attributes at first, and their child
+  /// descriptions are created the first time any of them is looked up,
+  /// such as when readXml first finds one of the child tags. Loading a
+  /// simple model then only creates the small part of the spec it uses.
+  ///
+  /// The descriptions are shared by the whole process, so they are created
+  /// once even if several threads look them up at the same time.
+  ///
+  /// The functions are implemented by the parser, next to init.
+  class LazyDescriptions
+  {
+    /// \brief Defer creating the child descriptions of an element.
+    /// \param[in] _elem Description whose name, value and attributes are
+    /// set.
+    /// \param[in] _spec Element of the spec tables that _elem was
+    /// initialized from.
+    /// \param[in] _version Spec version of the tables, such as "1.8".
+    public: static void Defer(const ElementPtr &_elem,
+                              const SpecElement &_spec,
+                              const std::string &_version);
+
+    /// \brief Create all the deferred descriptions under a description.
+    /// Spec files that include each other are only expanded once.
+    /// \param[in] _elem Description to expand.
+    /// \return Number of distinct descriptions that were visited.
+    public: static std::size_t Expand(const ElementPtr &_elem);
+
+    /// \brief Create the child descriptions.
+    /// \return The child descriptions, in the order of the spec.
+    public: ElementPtr_V Create() const;
+
+    /// \brief Element of the spec tables whose children are created.
+    public: const SpecElement *spec = nullptr;
+
+    /// \brief Spec version of the included files.
+    public: std::string version;
+
+    /// \brief Makes sure the children are created only once.
+    public: std::once_flag once;
+
+    /// \brief The child descriptions once they are created. Description
+    /// data that is copied to be modified shares them with the original.
+    public: ElementDescriptionData children;
+  };
+  }
+}
+#endif
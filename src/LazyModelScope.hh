@@ -0,0 +1,143 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_LAZY_MODEL_SCOPE_HH_
+#define SDF_LAZY_MODEL_SCOPE_HH_
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "sdf/Error.hh"
+#include "sdf/ParserConfig.hh"
+#include "sdf/sdf_config.h"
+
+/// \ingroup sdf_parser
+/// \brief namespace for Simulation Description Format parser
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief Sets whether the models loaded on the current thread while this
+  /// scope is alive load their contents on first access, as set by
+  /// ParserConfig::SetLazyModels. The previous setting is restored when the
+  /// scope is destroyed, so scopes can nest.
+  class LazyModelScope
+  {
+    /// \brief Constructor
+    /// \param[in] _lazy True to defer the contents of models in this scope.
+    public: explicit LazyModelScope(bool _lazy)
+      : previous(Lazy())
+    {
+      Lazy() = _lazy;
+    }
+
+    /// \brief Constructor that uses the setting of a ParserConfig.
+    /// \param[in] _config Parser configuration.
+    public: explicit LazyModelScope(const ParserConfig &_config)
+      : LazyModelScope(_config.LazyModels())
+    {
+    }
+
+    /// \brief Destructor
+    public: ~LazyModelScope()
+    {
+      Lazy() = this->previous;
+    }
+
+    /// \brief Get the setting of the current thread.
+    /// \return Reference to the setting, which is true when models are lazy.
+    public: static bool &Lazy()
+    {
+      static thread_local bool lazy = false;
+      return lazy;
+    }
+
+    /// \brief Setting that was current before this scope.
+    private: bool previous;
+  };
+
+  /// \brief Frame graphs of a world or root model whose models are lazy,
+  /// built once by the first access to the contents of one of the models.
+  /// Building loads the contents of every model of the scope, which calls
+  /// Build again on the same thread, so such calls return at once. Calls
+  /// from other threads wait until the graphs are built.
+  class DeferredGraphs
+  {
+    /// \brief Constructor
+    /// \param[in] _build Function that builds the graphs and gives them to
+    /// the world or model, returning the errors of the graphs.
+    public: explicit DeferredGraphs(std::function<Errors()> _build)
+      : build(std::move(_build))
+    {
+    }
+
+    /// \brief Build the graphs if they are not built yet.
+    public: void Build()
+    {
+      if (this->built.load(std::memory_order_acquire) ||
+          this->builder.load() == std::this_thread::get_id())
+      {
+        return;
+      }
+
+      std::lock_guard<std::mutex> lock(this->mutex);
+      if (this->built.load(std::memory_order_relaxed))
+        return;
+
+      this->builder = std::this_thread::get_id();
+      this->errors = this->build();
+      this->build = nullptr;
+      this->builder = std::thread::id();
+      this->built.store(true, std::memory_order_release);
+    }
+
+    /// \brief Get whether the graphs are built.
+    /// \return True once Build has returned on some thread.
+    public: bool Built() const
+    {
+      return this->built.load(std::memory_order_acquire);
+    }
+
+    /// \brief Get the errors of the graphs.
+    /// \return The errors, which are empty until Built() is true.
+    public: const Errors &BuildErrors() const
+    {
+      return this->errors;
+    }
+
+    /// \brief Function that builds the graphs.
+    private: std::function<Errors()> build;
+
+    /// \brief Errors returned by build.
+    private: Errors errors;
+
+    /// \brief True once the graphs are built.
+    private: std::atomic<bool> built{false};
+
+    /// \brief Thread that is building the graphs.
+    private: std::atomic<std::thread::id> builder{std::thread::id()};
+
+    /// \brief Protects the build.
+    private: std::mutex mutex;
+  };
+  }
+}
+#endif
@@ -14,11 +14,27 @@
  * limitations under the License.
  *
  */
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include <ignition/math/Vector3.hh>
+
 #include "sdf/Lidar.hh"
 
+#include "ElementFields.hh"
+#include "AlignedAllocator.hh"
+#include "ElementRetentionScope.hh"
+#include "LoadStatsScope.hh"
+#include "ResolvedCache.hh"
+
 using namespace sdf;
 using namespace ignition;
 
+/// \brief Directions of the rays of a lidar.
+using RayDirectionArray =
+    std::vector<math::Vector3d, AlignedAllocator<math::Vector3d>>;
+
 /// \brief Private lidar data.
 class sdf::LidarPrivate
 {
@@ -58,10 +74,48 @@ class sdf::LidarPrivate
   /// \brief Noise values for the lidar sensor
   public: Noise lidarNoise;
 
+  /// \brief Directions of the rays, computed from the scans.
+  public: ResolvedCache<RayDirectionArray> rayDirections;
+
   /// \brief The SDF element pointer used during load.
   public: sdf::ElementPtr sdf{nullptr};
 };
 
+/// \brief Fields of the <scan><horizontal> element.
+static const ElementFields<LidarPrivate> &horizontalScanFields()
+{
+  static const ElementFields<LidarPrivate> fields =
+    ElementFields<LidarPrivate>()
+      .Value("samples", &LidarPrivate::horizontalScanSamples)
+      .Value("resolution", &LidarPrivate::horizontalScanResolution)
+      .Value<double>("min_angle", &LidarPrivate::horizontalScanMinAngle)
+      .Value<double>("max_angle", &LidarPrivate::horizontalScanMaxAngle);
+  return fields;
+}
+
+/// \brief Fields of the <scan><vertical> element.
+static const ElementFields<LidarPrivate> &verticalScanFields()
+{
+  static const ElementFields<LidarPrivate> fields =
+    ElementFields<LidarPrivate>()
+      .Value("samples", &LidarPrivate::verticalScanSamples)
+      .Value("resolution", &LidarPrivate::verticalScanResolution)
+      .Value<double>("min_angle", &LidarPrivate::verticalScanMinAngle)
+      .Value<double>("max_angle", &LidarPrivate::verticalScanMaxAngle);
+  return fields;
+}
+
+/// \brief Fields of the <range> element.
+static const ElementFields<LidarPrivate> &rangeFields()
+{
+  static const ElementFields<LidarPrivate> fields =
+    ElementFields<LidarPrivate>()
+      .Value("min", &LidarPrivate::minRange)
+      .Value("max", &LidarPrivate::maxRange)
+      .Value("resolution", &LidarPrivate::rangeResolution);
+  return fields;
+}
+
 //////////////////////////////////////////////////
 Lidar::Lidar()
   : dataPtr(new LidarPrivate)
@@ -109,9 +163,10 @@ Lidar &Lidar::operator=(Lidar &&_lidar) noexcept
 /// an error code and message. An empty vector indicates no error.
 Errors Lidar::Load(ElementPtr _sdf)
 {
+  DomLoadTimer timer("Lidar");
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that sdf is a valid pointer
   if (!_sdf)
@@ -139,19 +194,8 @@ Errors Lidar::Load(ElementPtr _sdf)
     sdf::ElementPtr elem = _sdf->GetElement("scan");
     if (elem->HasElement("horizontal"))
     {
-      sdf::ElementPtr subElem = elem->GetElement("horizontal");
-      if (subElem->HasElement("samples"))
-        this->dataPtr->horizontalScanSamples = subElem->Get<unsigned int>(
-          "samples");
-      if (subElem->HasElement("resolution"))
-        this->dataPtr->horizontalScanResolution = subElem->Get<double>(
-          "resolution");
-      if (subElem->HasElement("min_angle"))
-        this->dataPtr->horizontalScanMinAngle = math::Angle(
-          subElem->Get<double>("min_angle"));
-      if (subElem->HasElement("max_angle"))
-        this->dataPtr->horizontalScanMaxAngle = math::Angle(
-          subElem->Get<double>("max_angle"));
+      horizontalScanFields().Load(elem->GetElement("horizontal"),
+          *this->dataPtr);
     }
     else
     {
@@ -162,19 +206,8 @@ Errors Lidar::Load(ElementPtr _sdf)
 
     if (elem->HasElement("vertical"))
     {
-      sdf::ElementPtr subElem = elem->GetElement("vertical");
-      if (subElem->HasElement("samples"))
-        this->dataPtr->verticalScanSamples = subElem->Get<unsigned int>(
-          "samples");
-      if (subElem->HasElement("resolution"))
-        this->dataPtr->verticalScanResolution = subElem->Get<double>(
-          "resolution");
-      if (subElem->HasElement("min_angle"))
-        this->dataPtr->verticalScanMinAngle = math::Angle(subElem->Get<double>(
-          "min_angle"));
-      if (subElem->HasElement("max_angle"))
-        this->dataPtr->verticalScanMaxAngle = math::Angle(subElem->Get<double>(
-          "max_angle"));
+      verticalScanFields().Load(elem->GetElement("vertical"),
+          *this->dataPtr);
     }
   }
   else
@@ -186,13 +219,7 @@ Errors Lidar::Load(ElementPtr _sdf)
 
   if (_sdf->HasElement("range"))
   {
-    sdf::ElementPtr elem = _sdf->GetElement("range");
-    if (elem->HasElement("min"))
-      this->dataPtr->minRange = elem->Get<double>("min");
-    if (elem->HasElement("max"))
-      this->dataPtr->maxRange = elem->Get<double>("max");
-    if (elem->HasElement("resolution"))
-      this->dataPtr->rangeResolution = elem->Get<double>("resolution");
+    rangeFields().Load(_sdf->GetElement("range"), *this->dataPtr);
   }
   else
   {
@@ -204,6 +231,10 @@ Errors Lidar::Load(ElementPtr _sdf)
   if (_sdf->HasElement("noise"))
     this->dataPtr->lidarNoise.Load(_sdf->GetElement("noise"));
 
+  // The consumers of the lidar share the directions computed on load.
+  this->dataPtr->rayDirections.Reset();
+  this->RayDirections();
+
   return errors;
 }
 
@@ -223,6 +254,7 @@ unsigned int Lidar::HorizontalScanSamples() const
 void Lidar::SetHorizontalScanSamples(unsigned int _samples)
 {
   this->dataPtr->horizontalScanSamples = _samples;
+  this->dataPtr->rayDirections.Reset();
 }
 
 //////////////////////////////////////////////////
@@ -247,6 +279,7 @@ math::Angle Lidar::HorizontalScanMinAngle() const
 void Lidar::SetHorizontalScanMinAngle(const math::Angle &_min)
 {
   this->dataPtr->horizontalScanMinAngle = _min;
+  this->dataPtr->rayDirections.Reset();
 }
 
 //////////////////////////////////////////////////
@@ -259,6 +292,7 @@ math::Angle Lidar::HorizontalScanMaxAngle() const
 void Lidar::SetHorizontalScanMaxAngle(const math::Angle &_max)
 {
   this->dataPtr->horizontalScanMaxAngle = _max;
+  this->dataPtr->rayDirections.Reset();
 }
 
 //////////////////////////////////////////////////
@@ -271,6 +305,7 @@ unsigned int Lidar::VerticalScanSamples() const
 void Lidar::SetVerticalScanSamples(unsigned int _samples)
 {
   this->dataPtr->verticalScanSamples = _samples;
+  this->dataPtr->rayDirections.Reset();
 }
 
 //////////////////////////////////////////////////
@@ -295,6 +330,7 @@ math::Angle Lidar::VerticalScanMinAngle() const
 void Lidar::SetVerticalScanMinAngle(const math::Angle &_min)
 {
   this->dataPtr->verticalScanMinAngle = _min;
+  this->dataPtr->rayDirections.Reset();
 }
 
 //////////////////////////////////////////////////
@@ -307,6 +343,7 @@ math::Angle Lidar::VerticalScanMaxAngle() const
 void Lidar::SetVerticalScanMaxAngle(const math::Angle &_max)
 {
   this->dataPtr->verticalScanMaxAngle = _max;
+  this->dataPtr->rayDirections.Reset();
 }
 
 //////////////////////////////////////////////////
@@ -357,6 +394,76 @@ void Lidar::SetLidarNoise(const Noise &_noise)
   this->dataPtr->lidarNoise = _noise;
 }
 
+//////////////////////////////////////////////////
+std::size_t Lidar::RayCount() const
+{
+  return static_cast<std::size_t>(this->dataPtr->horizontalScanSamples) *
+      this->dataPtr->verticalScanSamples;
+}
+
+//////////////////////////////////////////////////
+/// \brief Get the angles of the samples of a scan.
+/// \param[in] _samples Number of samples.
+/// \param[in] _min Minimum angle.
+/// \param[in] _max Maximum angle.
+/// \return The angle of each sample.
+static std::vector<double> scanAngles(unsigned int _samples,
+    const math::Angle &_min, const math::Angle &_max)
+{
+  std::vector<double> angles(_samples);
+  if (_samples == 1)
+  {
+    angles[0] = 0.5 * (_min.Radian() + _max.Radian());
+  }
+  else
+  {
+    const double step = (_max.Radian() - _min.Radian()) / (_samples - 1);
+    for (unsigned int i = 0; i < _samples; ++i)
+      angles[i] = _min.Radian() + step * i;
+  }
+  return angles;
+}
+
+//////////////////////////////////////////////////
+const math::Vector3d *Lidar::RayDirections() const
+{
+  const LidarPrivate &data = *this->dataPtr;
+  const RayDirectionArray &directions = data.rayDirections.Get([&]
+      {
+        const std::vector<double> yaws = scanAngles(
+            data.horizontalScanSamples, data.horizontalScanMinAngle,
+            data.horizontalScanMaxAngle);
+        const std::vector<double> pitches = scanAngles(
+            data.verticalScanSamples, data.verticalScanMinAngle,
+            data.verticalScanMaxAngle);
+
+        // The sines and cosines of the horizontal angles are shared by
+        // the rows.
+        std::vector<double> cosYaws(yaws.size());
+        std::vector<double> sinYaws(yaws.size());
+        for (std::size_t h = 0; h < yaws.size(); ++h)
+        {
+          cosYaws[h] = std::cos(yaws[h]);
+          sinYaws[h] = std::sin(yaws[h]);
+        }
+
+        RayDirectionArray result;
+        result.reserve(yaws.size() * pitches.size());
+        for (double pitch : pitches)
+        {
+          const double cosPitch = std::cos(pitch);
+          const double sinPitch = std::sin(pitch);
+          for (std::size_t h = 0; h < yaws.size(); ++h)
+          {
+            result.emplace_back(cosPitch * cosYaws[h],
+                cosPitch * sinYaws[h], sinPitch);
+          }
+        }
+        return result;
+      });
+  return directions.empty() ? nullptr : directions.data();
+}
+
 //////////////////////////////////////////////////
 bool Lidar::operator==(const Lidar &_lidar) const
 {
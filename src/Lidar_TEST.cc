@@ -16,7 +16,10 @@
 */
 
 #include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
 #include <ignition/math/Angle.hh>
+#include <ignition/math/Vector3.hh>
 #include "sdf/Lidar.hh"
 
 /////////////////////////////////////////////////
@@ -118,3 +121,44 @@ TEST(DOMLidar, Load)
   // The Lidar::Load function is tested more thouroughly in the
   // link_dom.cc integration test.
 }
+
+/////////////////////////////////////////////////
+TEST(DOMLidar, RayDirections)
+{
+  sdf::Lidar lidar;
+  lidar.SetHorizontalScanSamples(3);
+  lidar.SetHorizontalScanMinAngle(-IGN_PI_2);
+  lidar.SetHorizontalScanMaxAngle(IGN_PI_2);
+  lidar.SetVerticalScanSamples(2);
+  lidar.SetVerticalScanMinAngle(0);
+  lidar.SetVerticalScanMaxAngle(IGN_PI_2);
+  ASSERT_EQ(6u, lidar.RayCount());
+
+  const ignition::math::Vector3d *directions = lidar.RayDirections();
+  ASSERT_NE(nullptr, directions);
+  EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(directions) % 64);
+  EXPECT_EQ(directions, lidar.RayDirections());
+
+  // The first row is horizontal, and the second one points up.
+  EXPECT_EQ(ignition::math::Vector3d(0, -1, 0), directions[0]);
+  EXPECT_EQ(ignition::math::Vector3d(1, 0, 0), directions[1]);
+  EXPECT_EQ(ignition::math::Vector3d(0, 1, 0), directions[2]);
+  for (std::size_t i = 3; i < 6; ++i)
+    EXPECT_EQ(ignition::math::Vector3d(0, 0, 1), directions[i]);
+
+  // Setting a scan computes the directions again, and a single sample is
+  // in the middle of the scan.
+  lidar.SetVerticalScanSamples(1);
+  ASSERT_EQ(3u, lidar.RayCount());
+  directions = lidar.RayDirections();
+  const double half = std::sqrt(0.5);
+  EXPECT_EQ(ignition::math::Vector3d(half, 0, half), directions[1]);
+
+  sdf::Lidar copy(lidar);
+  ASSERT_NE(nullptr, copy.RayDirections());
+  EXPECT_EQ(directions[2], copy.RayDirections()[2]);
+
+  lidar.SetHorizontalScanSamples(0);
+  EXPECT_EQ(0u, lidar.RayCount());
+  EXPECT_EQ(nullptr, lidar.RayDirections());
+}
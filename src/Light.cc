@@ -18,7 +18,10 @@
 #include <ignition/math/Pose3.hh>
 #include "sdf/Error.hh"
 #include "sdf/Light.hh"
+#include "ElementRetentionScope.hh"
 #include "FrameSemantics.hh"
+#include "LoadStatsScope.hh"
+#include "MemoryAccounting.hh"
 #include "ScopedGraph.hh"
 #include "Utils.hh"
 
@@ -145,9 +148,10 @@ void Light::CopyFrom(const Light &_light)
 /////////////////////////////////////////////////
 Errors Light::Load(ElementPtr _sdf)
 {
+  DomLoadTimer timer("Light");
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that the provided SDF element is a <light>
   // This is an error that cannot be recovered, so return an error.
@@ -201,7 +205,8 @@ Errors Light::Load(ElementPtr _sdf)
   this->dataPtr->specular = _sdf->Get<ignition::math::Color>("specular",
       this->dataPtr->specular).first;
 
-  sdf::ElementPtr attenuationElem = _sdf->GetElement("attenuation");
+  sdf::ElementConstPtr attenuationElem =
+      _sdf->GetElementOrDefault("attenuation");
   if (attenuationElem)
   {
     std::pair<double, bool> doubleValue = attenuationElem->Get<double>(
@@ -239,7 +244,7 @@ Errors Light::Load(ElementPtr _sdf)
     this->dataPtr->direction = dirPair.first;
   }
 
-  sdf::ElementPtr spotElem = _sdf->GetElement("spot");
+  sdf::ElementConstPtr spotElem = _sdf->GetElementOrDefault("spot");
   if (this->dataPtr->type == LightType::SPOT && spotElem)
   {
     // Check for and set inner_angle
@@ -484,3 +489,10 @@ void Light::SetType(const LightType _type)
 {
   this->dataPtr->type = _type;
 }
+
+/////////////////////////////////////////////////
+template <>
+std::size_t sdf::domPrivateSize<Light>()
+{
+  return sizeof(LightPrivate);
+}
@@ -18,6 +18,8 @@
 #include <gtest/gtest.h>
 #include <ignition/math/Pose3.hh>
 #include "sdf/Light.hh"
+#include "sdf/Root.hh"
+#include "sdf/World.hh"
 
 /////////////////////////////////////////////////
 TEST(DOMLight, DefaultConstruction)
@@ -307,3 +309,29 @@ TEST(DOMLight, AttenuationClamp)
   light.SetQuadraticAttenuationFactor(-1.0);
   EXPECT_DOUBLE_EQ(0.0, light.QuadraticAttenuationFactor());
 }
+
+/////////////////////////////////////////////////
+TEST(DOMLight, LoadKeepsOptionalElementsMissing)
+{
+  const std::string sdfString = R"(
+  <sdf version="1.8">
+    <world name="default">
+      <light name="lamp" type="point">
+        <cast_shadows>true</cast_shadows>
+      </light>
+    </world>
+  </sdf>)";
+
+  sdf::Root root;
+  ASSERT_TRUE(root.LoadSdfString(sdfString).empty());
+  const sdf::Light *light = root.WorldByIndex(0)->LightByIndex(0);
+  ASSERT_NE(nullptr, light);
+
+  // Defaults of <attenuation> and <spot> are read from their descriptions,
+  // without adding the elements.
+  EXPECT_DOUBLE_EQ(10.0, light->AttenuationRange());
+  EXPECT_DOUBLE_EQ(0.0, light->SpotInnerAngle().Radian());
+  ASSERT_NE(nullptr, light->Element());
+  EXPECT_FALSE(light->Element()->HasElement("attenuation"));
+  EXPECT_FALSE(light->Element()->HasElement("spot"));
+}
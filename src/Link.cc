@@ -29,8 +29,12 @@
 #include "sdf/Types.hh"
 #include "sdf/Visual.hh"
 
+#include "ElementRetentionScope.hh"
 #include "FrameSemantics.hh"
+#include "LoadStatsScope.hh"
+#include "MemoryAccounting.hh"
 #include "ScopedGraph.hh"
+#include "Tracing.hh"
 #include "Utils.hh"
 
 using namespace sdf;
@@ -58,6 +62,18 @@ class sdf::LinkPrivate
   /// \brief The sensors specified in this link.
   public: std::vector<Sensor> sensors;
 
+  /// \brief Index of the visuals by name.
+  public: NameIndex visualIndex;
+
+  /// \brief Index of the lights by name.
+  public: NameIndex lightIndex;
+
+  /// \brief Index of the collisions by name.
+  public: NameIndex collisionIndex;
+
+  /// \brief Index of the sensors by name.
+  public: NameIndex sensorIndex;
+
   /// \brief The inertial information for this link.
   public: ignition::math::Inertiald inertial {{1.0,
             ignition::math::Vector3d::One, ignition::math::Vector3d::Zero},
@@ -114,9 +130,11 @@ Link &Link::operator=(Link &&_link)
 /////////////////////////////////////////////////
 Errors Link::Load(ElementPtr _sdf)
 {
+  SDF_TRACE_SCOPE_TEXT("sdf::Link::Load", _sdf->Get<std::string>("name"));
+  DomLoadTimer timer("Link");
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that the provided SDF element is a <link>
   // This is an error that cannot be recovered, so return an error.
@@ -166,6 +184,11 @@ Errors Link::Load(ElementPtr _sdf)
       this->dataPtr->sensors);
   errors.insert(errors.end(), sensorLoadErrors.begin(), sensorLoadErrors.end());
 
+  buildNameIndex(this->dataPtr->visuals, this->dataPtr->visualIndex);
+  buildNameIndex(this->dataPtr->collisions, this->dataPtr->collisionIndex);
+  buildNameIndex(this->dataPtr->lights, this->dataPtr->lightIndex);
+  buildNameIndex(this->dataPtr->sensors, this->dataPtr->sensorIndex);
+
   ignition::math::Vector3d xxyyzz = ignition::math::Vector3d::One;
   ignition::math::Vector3d xyxzyz = ignition::math::Vector3d::Zero;
   ignition::math::Pose3d inertiaPose;
@@ -239,17 +262,16 @@ const Visual *Link::VisualByIndex(const uint64_t _index) const
   return nullptr;
 }
 
+/////////////////////////////////////////////////
+Span<const Visual> Link::Visuals() const
+{
+  return {this->dataPtr->visuals.data(), this->dataPtr->visuals.size()};
+}
+
 /////////////////////////////////////////////////
 bool Link::VisualNameExists(const std::string &_name) const
 {
-  for (auto const &v : this->dataPtr->visuals)
-  {
-    if (v.Name() == _name)
-    {
-      return true;
-    }
-  }
-  return false;
+  return this->dataPtr->visualIndex.count(_name) > 0;
 }
 
 /////////////////////////////////////////////////
@@ -266,17 +288,16 @@ const Collision *Link::CollisionByIndex(const uint64_t _index) const
   return nullptr;
 }
 
+/////////////////////////////////////////////////
+Span<const Collision> Link::Collisions() const
+{
+  return {this->dataPtr->collisions.data(), this->dataPtr->collisions.size()};
+}
+
 /////////////////////////////////////////////////
 bool Link::CollisionNameExists(const std::string &_name) const
 {
-  for (auto const &c : this->dataPtr->collisions)
-  {
-    if (c.Name() == _name)
-    {
-      return true;
-    }
-  }
-  return false;
+  return this->dataPtr->collisionIndex.count(_name) > 0;
 }
 
 /////////////////////////////////////////////////
@@ -293,10 +314,16 @@ const Light *Link::LightByIndex(const uint64_t _index) const
   return nullptr;
 }
 
+/////////////////////////////////////////////////
+Span<const Light> Link::Lights() const
+{
+  return {this->dataPtr->lights.data(), this->dataPtr->lights.size()};
+}
+
 /////////////////////////////////////////////////
 bool Link::LightNameExists(const std::string &_name) const
 {
-  return this->LightByName(_name) != nullptr;
+  return this->dataPtr->lightIndex.count(_name) > 0;
 }
 
 /////////////////////////////////////////////////
@@ -313,30 +340,22 @@ const Sensor *Link::SensorByIndex(const uint64_t _index) const
   return nullptr;
 }
 
+/////////////////////////////////////////////////
+Span<const Sensor> Link::Sensors() const
+{
+  return {this->dataPtr->sensors.data(), this->dataPtr->sensors.size()};
+}
+
 /////////////////////////////////////////////////
 bool Link::SensorNameExists(const std::string &_name) const
 {
-  for (auto const &s : this->dataPtr->sensors)
-  {
-    if (s.Name() == _name)
-    {
-      return true;
-    }
-  }
-  return false;
+  return this->dataPtr->sensorIndex.count(_name) > 0;
 }
 
 /////////////////////////////////////////////////
 const Sensor *Link::SensorByName(const std::string &_name) const
 {
-  for (auto const &s : this->dataPtr->sensors)
-  {
-    if (s.Name() == _name)
-    {
-      return &s;
-    }
-  }
-  return nullptr;
+  return findByName(this->dataPtr->sensors, this->dataPtr->sensorIndex, _name);
 }
 
 /////////////////////////////////////////////////
@@ -404,6 +423,29 @@ void Link::SetPoseRelativeToGraph(sdf::ScopedGraph<PoseRelativeToGraph> _graph)
   }
 }
 
+/////////////////////////////////////////////////
+void Link::ShareMaterials(MaterialTable &_table)
+{
+  for (auto &visual : this->dataPtr->visuals)
+    visual.ShareMaterial(_table);
+}
+
+/////////////////////////////////////////////////
+void Link::UseMaterialCopies(const MaterialTable &_table)
+{
+  for (auto &visual : this->dataPtr->visuals)
+    visual.UseMaterialCopy(_table);
+}
+
+/////////////////////////////////////////////////
+void Link::ShareMeshes(MeshRegistry &_registry)
+{
+  for (auto &visual : this->dataPtr->visuals)
+    visual.ShareMesh(_registry);
+  for (auto &collision : this->dataPtr->collisions)
+    collision.ShareMesh(_registry);
+}
+
 /////////////////////////////////////////////////
 sdf::SemanticPose Link::SemanticPose() const
 {
@@ -418,40 +460,20 @@ sdf::SemanticPose Link::SemanticPose() const
 /////////////////////////////////////////////////
 const Visual *Link::VisualByName(const std::string &_name) const
 {
-  for (auto const &v : this->dataPtr->visuals)
-  {
-    if (v.Name() == _name)
-    {
-      return &v;
-    }
-  }
-  return nullptr;
+  return findByName(this->dataPtr->visuals, this->dataPtr->visualIndex, _name);
 }
 
 /////////////////////////////////////////////////
 const Collision *Link::CollisionByName(const std::string &_name) const
 {
-  for (auto const &c : this->dataPtr->collisions)
-  {
-    if (c.Name() == _name)
-    {
-      return &c;
-    }
-  }
-  return nullptr;
+  return findByName(this->dataPtr->collisions, this->dataPtr->collisionIndex,
+      _name);
 }
 
 /////////////////////////////////////////////////
 const Light *Link::LightByName(const std::string &_name) const
 {
-  for (auto const &c : this->dataPtr->lights)
-  {
-    if (c.Name() == _name)
-    {
-      return &c;
-    }
-  }
-  return nullptr;
+  return findByName(this->dataPtr->lights, this->dataPtr->lightIndex, _name);
 }
 
 /////////////////////////////////////////////////
@@ -471,3 +493,10 @@ void Link::SetEnableWind(const bool _enableWind)
 {
   this->dataPtr->enableWind =_enableWind;
 }
+
+/////////////////////////////////////////////////
+template <>
+std::size_t sdf::domPrivateSize<Link>()
+{
+  return sizeof(LinkPrivate);
+}
@@ -16,14 +16,19 @@
 */
 
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <string>
 #include <ignition/math/Inertial.hh>
 #include <ignition/math/Pose3.hh>
 #include <ignition/math/Vector3.hh>
 #include "sdf/Collision.hh"
 #include "sdf/Light.hh"
 #include "sdf/Link.hh"
+#include "sdf/Model.hh"
+#include "sdf/Root.hh"
 #include "sdf/Sensor.hh"
 #include "sdf/Visual.hh"
+#include "sdf/World.hh"
 
 /////////////////////////////////////////////////
 TEST(DOMLink, Construction)
@@ -203,3 +208,60 @@ TEST(DOMLink, InvalidInertia)
   EXPECT_DOUBLE_EQ(3.4, link.Inertial().MassMatrix().OffDiagonalMoments().Z());
   EXPECT_FALSE(link.Inertial().MassMatrix().IsValid());
 }
+
+/////////////////////////////////////////////////
+TEST(DOMLink, ChildrenByName)
+{
+  std::string sdfString = "<sdf version='1.8'><world name='default'>"
+    "<model name='m'><link name='l'>";
+  for (int i = 0; i < 100; ++i)
+  {
+    const std::string name = std::to_string(i);
+    sdfString += "<visual name='v" + name + "'>"
+      "<geometry><box><size>1 1 1</size></box></geometry></visual>"
+      "<collision name='c" + name + "'>"
+      "<geometry><box><size>1 1 1</size></box></geometry></collision>";
+  }
+  sdfString += "<visual name='v42'>"
+    "<geometry><sphere><radius>1</radius></sphere></geometry></visual>"
+    "<light name='lamp' type='point'/>"
+    "<sensor name='imu' type='imu'/>"
+    "</link></model></world></sdf>";
+
+  // The duplicate visual is not loaded.
+  sdf::Root root;
+  sdf::Errors errors = root.LoadSdfString(sdfString);
+  EXPECT_TRUE(std::any_of(errors.begin(), errors.end(),
+      [](const sdf::Error &_error)
+      {
+        return _error.Code() == sdf::ErrorCode::DUPLICATE_NAME;
+      }));
+
+  const sdf::Link *link =
+    root.WorldByIndex(0)->ModelByIndex(0)->LinkByIndex(0);
+  ASSERT_NE(nullptr, link);
+  ASSERT_EQ(100u, link->VisualCount());
+  ASSERT_EQ(100u, link->CollisionCount());
+
+  EXPECT_EQ(link->VisualByIndex(42), link->VisualByName("v42"));
+  EXPECT_EQ(link->CollisionByIndex(99), link->CollisionByName("c99"));
+  EXPECT_EQ(link->LightByIndex(0), link->LightByName("lamp"));
+  EXPECT_EQ(link->SensorByIndex(0), link->SensorByName("imu"));
+  EXPECT_TRUE(link->VisualNameExists("v0"));
+  EXPECT_TRUE(link->CollisionNameExists("c0"));
+  EXPECT_TRUE(link->LightNameExists("lamp"));
+  EXPECT_TRUE(link->SensorNameExists("imu"));
+  EXPECT_EQ(nullptr, link->VisualByName("c0"));
+  EXPECT_EQ(nullptr, link->CollisionByName("v0"));
+  EXPECT_EQ(nullptr, link->LightByName("imu"));
+  EXPECT_EQ(nullptr, link->SensorByName("lamp"));
+  EXPECT_FALSE(link->VisualNameExists("v100"));
+  EXPECT_FALSE(link->CollisionNameExists("c100"));
+  EXPECT_FALSE(link->LightNameExists("sun"));
+  EXPECT_FALSE(link->SensorNameExists("camera"));
+
+  // Copies look up their own children.
+  sdf::Link copy(*link);
+  EXPECT_EQ(copy.VisualByIndex(7), copy.VisualByName("v7"));
+  EXPECT_EQ(copy.SensorByIndex(0), copy.SensorByName("imu"));
+}
@@ -0,0 +1,654 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "sdf/Console.hh"
+#include "sdf/Filesystem.hh"
+#include "sdf/VirtualFilesystem.hh"
+#include "sdf/parser.hh"
+#include "BinarySnapshot.hh"
+#include "LoadCache.hh"
+#include "MappedFile.hh"
+
+using namespace sdf;
+
+namespace
+{
+  /// \brief First bytes of every entry.
+  const char kEntryMagic[4] = {'S', 'D', 'F', 'C'};
+
+  /// \brief Version of the entry layout, not counting the snapshot.
+  const std::uint32_t kEntryVersion = 2;
+
+  /// \brief Offset basis of the 64-bit FNV-1a hash.
+  const std::uint64_t kHashBasis = 14695981039346656037ull;
+
+  /// \brief Prime of the 64-bit FNV-1a hash.
+  const std::uint64_t kHashPrime = 1099511628211ull;
+
+  /// \brief Add bytes to a 64-bit FNV-1a hash.
+  /// \param[in] _data Bytes to add.
+  /// \param[in] _size Number of bytes.
+  /// \param[in,out] _hash Hash to update.
+  void hashBytes(const char *_data, std::size_t _size, std::uint64_t &_hash)
+  {
+    for (std::size_t i = 0; i < _size; ++i)
+    {
+      _hash ^= static_cast<unsigned char>(_data[i]);
+      _hash *= kHashPrime;
+    }
+  }
+
+  /// \brief Add a string and its length to a hash, so that consecutive
+  /// strings can not be confused.
+  /// \param[in] _str String to add.
+  /// \param[in,out] _hash Hash to update.
+  void hashString(const std::string &_str, std::uint64_t &_hash)
+  {
+    const std::uint64_t size = _str.size();
+    hashBytes(reinterpret_cast<const char *>(&size), sizeof(size), _hash);
+    hashBytes(_str.data(), _str.size(), _hash);
+  }
+
+  /// \brief Append a value in its native representation.
+  /// \param[in] _value Value to append.
+  /// \param[in,out] _out String to append to.
+  template<typename T>
+  void putValue(const T &_value, std::string &_out)
+  {
+    _out.append(reinterpret_cast<const char *>(&_value), sizeof(T));
+  }
+
+  /// \brief Read a value in its native representation.
+  /// \param[in] _file Content of the entry.
+  /// \param[in,out] _pos Read position.
+  /// \param[out] _value Value read.
+  /// \return True if the value was read.
+  template<typename T>
+  bool getValue(const MappedFile &_file, std::size_t &_pos, T &_value)
+  {
+    if (_file.Size() - _pos < sizeof(T))
+      return false;
+    std::memcpy(&_value, _file.Data() + _pos, sizeof(T));
+    _pos += sizeof(T);
+    return true;
+  }
+
+  /// \brief Append a string, preceded by its length.
+  /// \param[in] _str String to append.
+  /// \param[in,out] _out String to append to.
+  void putString(const std::string &_str, std::string &_out)
+  {
+    putValue(static_cast<std::uint32_t>(_str.size()), _out);
+    _out += _str;
+  }
+
+  /// \brief Read a string written by putString.
+  /// \param[in] _file Content of the entry.
+  /// \param[in,out] _pos Read position.
+  /// \param[out] _str String read.
+  /// \return True if the string was read.
+  bool getString(const MappedFile &_file, std::size_t &_pos, std::string &_str)
+  {
+    std::uint32_t length = 0;
+    if (!getValue(_file, _pos, length) || _file.Size() - _pos < length)
+      return false;
+    _str.assign(_file.Data() + _pos, length);
+    _pos += length;
+    return true;
+  }
+
+  /// \brief Append a pose.
+  /// \param[in] _pose Pose to append.
+  /// \param[in,out] _out String to append to.
+  void putPose(const ignition::math::Pose3d &_pose, std::string &_out)
+  {
+    const double values[7] = {_pose.Pos().X(), _pose.Pos().Y(),
+        _pose.Pos().Z(), _pose.Rot().W(), _pose.Rot().X(), _pose.Rot().Y(),
+        _pose.Rot().Z()};
+    putValue(values, _out);
+  }
+
+  /// \brief Read a pose written by putPose.
+  /// \param[in] _file Content of the entry.
+  /// \param[in,out] _pos Read position.
+  /// \param[out] _pose Pose read.
+  /// \return True if the pose was read.
+  bool getPose(const MappedFile &_file, std::size_t &_pos,
+      ignition::math::Pose3d &_pose)
+  {
+    double values[7];
+    if (!getValue(_file, _pos, values))
+      return false;
+    _pose.Pos().Set(values[0], values[1], values[2]);
+    _pose.Rot().Set(values[3], values[4], values[5], values[6]);
+    return true;
+  }
+
+  /// \brief Check whether a vertex name is the frame of a model scope.
+  /// \param[in] _name Absolute name of the vertex.
+  /// \return True if the name is __model__ or ends with ::__model__.
+  bool isModelFrame(const std::string &_name)
+  {
+    const std::string frame = "__model__";
+    return _name == frame || (_name.size() > frame.size() + 2 &&
+        _name.compare(_name.size() - frame.size() - 2, std::string::npos,
+            "::" + frame) == 0);
+  }
+
+  /// \brief Append the poses of the vertices of a graph resolved relative
+  /// to its scope vertex and to each model frame, which are the scopes the
+  /// DOM objects resolve their poses in.
+  /// \param[in] _graph Validated graph.
+  /// \param[in,out] _out String to append to.
+  void putPoseTables(const ScopedGraph<PoseRelativeToGraph> &_graph,
+      std::string &_out)
+  {
+    std::vector<ScopedGraph<PoseRelativeToGraph>> scopes{_graph};
+    for (const auto &[name, id] : _graph.Map())
+    {
+      if (id != _graph.ScopeVertexId() && isModelFrame(name))
+        scopes.push_back(_graph.VertexScope(id, "__model__"));
+    }
+
+    std::vector<std::pair<ignition::math::graph::VertexId,
+        ResolvedVertexPoses>> tables;
+    for (const auto &scope : scopes)
+    {
+      ResolvedVertexPoses poses;
+      if (resolveAllPosesRelativeToRoot(poses, scope).empty())
+        tables.emplace_back(scope.ScopeVertexId(), std::move(poses));
+    }
+
+    putValue(static_cast<std::uint32_t>(tables.size()), _out);
+    for (const auto &[scopeId, poses] : tables)
+    {
+      putValue(static_cast<std::uint64_t>(scopeId), _out);
+      putValue(static_cast<std::uint32_t>(poses.size()), _out);
+      for (const auto &[id, pose] : poses)
+      {
+        putValue(static_cast<std::uint64_t>(id), _out);
+        putPose(pose, _out);
+      }
+    }
+  }
+
+  /// \brief Read the pose tables written by putPoseTables into the cache of
+  /// resolved poses of a graph.
+  /// \param[in] _file Content of the entry.
+  /// \param[in,out] _pos Read position.
+  /// \param[in,out] _graph Graph whose cache is filled.
+  /// \return True if the tables were read.
+  bool getPoseTables(const MappedFile &_file, std::size_t &_pos,
+      PoseRelativeToGraph &_graph)
+  {
+    std::uint32_t tableCount = 0;
+    if (!getValue(_file, _pos, tableCount))
+      return false;
+    for (std::uint32_t i = 0; i < tableCount; ++i)
+    {
+      std::uint64_t scopeId = 0;
+      std::uint32_t poseCount = 0;
+      if (!getValue(_file, _pos, scopeId) ||
+          !getValue(_file, _pos, poseCount))
+      {
+        return false;
+      }
+      auto &poses = _graph.cache.poses[scopeId];
+      poses.reserve(poseCount);
+      for (std::uint32_t j = 0; j < poseCount; ++j)
+      {
+        std::uint64_t id = 0;
+        ignition::math::Pose3d pose;
+        if (!getValue(_file, _pos, id) || !getPose(_file, _pos, pose))
+          return false;
+        poses.emplace(id, pose);
+      }
+    }
+    _graph.cache.version = _graph.version;
+    return true;
+  }
+
+  /// \brief Append a graph: its scope, vertices, edges and name map, and
+  /// the resolved poses of a PoseRelativeToGraph.
+  /// \param[in] _graph Graph to append.
+  /// \param[in,out] _out String to append to.
+  template<typename T>
+  void putGraph(const ScopedGraph<T> &_graph, std::string &_out)
+  {
+    constexpr bool isPoseGraph = std::is_same_v<T, PoseRelativeToGraph>;
+    const T &data = _graph.GraphData();
+    putString(_graph.ScopeContextName(), _out);
+    putValue(static_cast<std::uint64_t>(_graph.ScopeVertexId()), _out);
+    if constexpr (isPoseGraph)
+      putString(data.sourceName, _out);
+    else
+      putString(data.scopeName, _out);
+
+    const auto vertices = data.graph.Vertices();
+    putValue(static_cast<std::uint32_t>(vertices.size()), _out);
+    for (const auto &[id, vertex] : vertices)
+    {
+      putValue(static_cast<std::uint64_t>(id), _out);
+      putString(vertex.get().Name(), _out);
+      putValue(static_cast<std::int32_t>(vertex.get().Data()), _out);
+    }
+
+    // Edges are added back in the order of their ids, so that the edges of
+    // each vertex are visited in the same order.
+    const auto edges = data.graph.Edges();
+    putValue(static_cast<std::uint32_t>(edges.size()), _out);
+    for (const auto &edgePair : edges)
+    {
+      const auto &edge = edgePair.second.get();
+      putValue(static_cast<std::uint64_t>(edge.Tail()), _out);
+      putValue(static_cast<std::uint64_t>(edge.Head()), _out);
+      putValue(edge.Weight(), _out);
+      if constexpr (isPoseGraph)
+        putPose(edge.Data(), _out);
+      else
+        putValue(static_cast<char>(edge.Data() ? 1 : 0), _out);
+    }
+
+    putValue(static_cast<std::uint32_t>(data.map.size()), _out);
+    for (const auto &[name, id] : data.map)
+    {
+      putString(name, _out);
+      putValue(static_cast<std::uint64_t>(id), _out);
+    }
+
+    if constexpr (isPoseGraph)
+      putPoseTables(_graph, _out);
+  }
+
+  /// \brief Read a graph written by putGraph.
+  /// \param[in] _file Content of the entry.
+  /// \param[in,out] _pos Read position.
+  /// \param[out] _graph Scope of the graph read.
+  /// \return True if the graph was read.
+  template<typename T>
+  bool getGraph(const MappedFile &_file, std::size_t &_pos,
+      ScopedGraph<T> &_graph)
+  {
+    constexpr bool isPoseGraph = std::is_same_v<T, PoseRelativeToGraph>;
+    auto data = std::make_shared<T>();
+    std::string scopeContextName;
+    std::uint64_t scopeId = 0;
+    std::string rootName;
+    if (!getString(_file, _pos, scopeContextName) ||
+        !getValue(_file, _pos, scopeId) || !getString(_file, _pos, rootName))
+    {
+      return false;
+    }
+    if constexpr (isPoseGraph)
+      data->sourceName = rootName;
+    else
+      data->scopeName = rootName;
+
+    std::uint32_t count = 0;
+    if (!getValue(_file, _pos, count))
+      return false;
+    for (std::uint32_t i = 0; i < count; ++i)
+    {
+      std::uint64_t id = 0;
+      std::string name;
+      std::int32_t type = 0;
+      if (!getValue(_file, _pos, id) || !getString(_file, _pos, name) ||
+          !getValue(_file, _pos, type) || type < 0 ||
+          type > static_cast<std::int32_t>(FrameType::STATIC_MODEL) ||
+          data->graph.AddVertex(name, static_cast<FrameType>(type), id).Id()
+              != id)
+      {
+        return false;
+      }
+    }
+
+    if (!getValue(_file, _pos, count))
+      return false;
+    for (std::uint32_t i = 0; i < count; ++i)
+    {
+      std::uint64_t tail = 0;
+      std::uint64_t head = 0;
+      double weight = 0;
+      std::conditional_t<isPoseGraph, ignition::math::Pose3d, bool>
+          edgeData{};
+      if (!getValue(_file, _pos, tail) || !getValue(_file, _pos, head) ||
+          !getValue(_file, _pos, weight))
+      {
+        return false;
+      }
+      if constexpr (isPoseGraph)
+      {
+        if (!getPose(_file, _pos, edgeData))
+          return false;
+      }
+      else
+      {
+        char value = 0;
+        if (!getValue(_file, _pos, value))
+          return false;
+        edgeData = value != 0;
+      }
+      if (!data->graph.AddEdge({tail, head}, edgeData, weight).Valid())
+        return false;
+    }
+
+    if (!getValue(_file, _pos, count))
+      return false;
+    data->map.reserve(count);
+    for (std::uint32_t i = 0; i < count; ++i)
+    {
+      std::string name;
+      std::uint64_t id = 0;
+      if (!getString(_file, _pos, name) || !getValue(_file, _pos, id))
+        return false;
+      data->map.emplace(std::move(name), id);
+    }
+
+    if constexpr (isPoseGraph)
+    {
+      if (!getPoseTables(_file, _pos, *data))
+        return false;
+    }
+
+    _graph = ScopedGraph<T>(data).VertexScope(scopeId, scopeContextName);
+    return true;
+  }
+
+  /// \brief Append the graphs of the worlds and models of a document.
+  /// \param[in] _graphs Graphs to append.
+  /// \param[in,out] _out String to append to.
+  void putGraphs(const LoadCache::Graphs &_graphs, std::string &_out)
+  {
+    const auto &frameGraphs = _graphs.frameAttachedTo;
+    const auto &poseGraphs = _graphs.poseRelativeTo;
+    putValue(static_cast<std::uint32_t>(frameGraphs.worlds.size()), _out);
+    putValue(static_cast<std::uint32_t>(frameGraphs.models.size()), _out);
+    for (std::size_t i = 0; i < frameGraphs.worlds.size(); ++i)
+    {
+      putGraph(frameGraphs.worlds[i], _out);
+      putGraph(poseGraphs.worlds[i], _out);
+    }
+    for (std::size_t i = 0; i < frameGraphs.models.size(); ++i)
+    {
+      putGraph(frameGraphs.models[i], _out);
+      putGraph(poseGraphs.models[i], _out);
+    }
+  }
+
+  /// \brief Read the graphs written by putGraphs.
+  /// \param[in] _file Content of the entry.
+  /// \param[in,out] _pos Read position.
+  /// \param[out] _graphs Graphs read, with no build errors.
+  /// \return True if the graphs were read.
+  bool getGraphs(const MappedFile &_file, std::size_t &_pos,
+      LoadCache::Graphs &_graphs)
+  {
+    std::uint32_t worldCount = 0;
+    std::uint32_t modelCount = 0;
+    if (!getValue(_file, _pos, worldCount) ||
+        !getValue(_file, _pos, modelCount))
+    {
+      return false;
+    }
+
+    auto &frameGraphs = _graphs.frameAttachedTo;
+    auto &poseGraphs = _graphs.poseRelativeTo;
+    frameGraphs.worlds.resize(worldCount);
+    poseGraphs.worlds.resize(worldCount);
+    for (std::uint32_t i = 0; i < worldCount; ++i)
+    {
+      if (!getGraph(_file, _pos, frameGraphs.worlds[i]) ||
+          !getGraph(_file, _pos, poseGraphs.worlds[i]))
+      {
+        return false;
+      }
+    }
+    frameGraphs.models.resize(modelCount);
+    poseGraphs.models.resize(modelCount);
+    for (std::uint32_t i = 0; i < modelCount; ++i)
+    {
+      if (!getGraph(_file, _pos, frameGraphs.models[i]) ||
+          !getGraph(_file, _pos, poseGraphs.models[i]))
+      {
+        return false;
+      }
+    }
+    frameGraphs.worldBuildErrors.resize(worldCount);
+    poseGraphs.worldBuildErrors.resize(worldCount);
+    frameGraphs.modelBuildErrors.resize(modelCount);
+    poseGraphs.modelBuildErrors.resize(modelCount);
+    return _pos == _file.Size();
+  }
+}
+
+/////////////////////////////////////////////////
+std::string LoadCache::Directory(const ParserConfig &_config)
+{
+  if (!_config.LoadCachePath().empty())
+    return _config.LoadCachePath();
+
+  const char *path = std::getenv("SDF_LOAD_CACHE_PATH");
+  return path ? std::string(path) : std::string();
+}
+
+/////////////////////////////////////////////////
+LoadCache::LoadCache(const std::string &_directory,
+    const std::string &_filename, bool _convert,
+    const std::set<std::string> &_skipped, bool _trusted)
+{
+  std::uint64_t contentHash = 0;
+  if (_directory.empty() || !HashFile(_filename, contentHash))
+    return;
+
+  std::uint64_t key = kHashBasis;
+  hashString(SDF_VERSION_FULL, key);
+  hashString(SDF::Version(), key);
+  hashString(_filename, key);
+  hashBytes(reinterpret_cast<const char *>(&contentHash),
+      sizeof(contentHash), key);
+  const char convert = _convert ? 1 : 0;
+  hashBytes(&convert, sizeof(convert), key);
+  for (const std::string &name : _skipped)
+    hashString(name, key);
+  const char trusted = _trusted ? 1 : 0;
+  hashBytes(&trusted, sizeof(trusted), key);
+
+  char name[32];
+  std::snprintf(name, sizeof(name), "%016llx.sdfc",
+      static_cast<unsigned long long>(key));
+  this->directory = _directory;
+  this->entryPath = sdf::filesystem::append(_directory, name);
+}
+
+/////////////////////////////////////////////////
+bool LoadCache::Valid() const
+{
+  return !this->entryPath.empty();
+}
+
+/////////////////////////////////////////////////
+bool LoadCache::HashFile(const std::string &_filename, std::uint64_t &_hash)
+{
+  MappedFile file;
+  if (!file.Open(_filename))
+    return false;
+
+  _hash = kHashBasis;
+  hashBytes(file.Data(), file.Size(), _hash);
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool LoadCache::Load(SDFPtr _sdf, std::optional<Graphs> *_graphs) const
+{
+  MappedFile file;
+  if (!this->Valid() || !file.Open(this->entryPath))
+    return false;
+
+  std::size_t pos = 0;
+  char magic[sizeof(kEntryMagic)];
+  std::uint32_t version = 0;
+  std::uint32_t fileCount = 0;
+  if (!getValue(file, pos, magic) ||
+      std::memcmp(magic, kEntryMagic, sizeof(kEntryMagic)) != 0 ||
+      !getValue(file, pos, version) || version != kEntryVersion ||
+      !getValue(file, pos, fileCount))
+  {
+    return false;
+  }
+
+  // Every included file must still have the content it had when the
+  // entry was written.
+  for (std::uint32_t i = 0; i < fileCount; ++i)
+  {
+    std::string filename;
+    std::uint64_t expected = 0;
+    std::uint64_t actual = 0;
+    if (!getString(file, pos, filename) || !getValue(file, pos, expected) ||
+        !HashFile(filename, actual) || actual != expected)
+    {
+      return false;
+    }
+  }
+
+  std::uint64_t snapshotSize = 0;
+  if (!getValue(file, pos, snapshotSize) || file.Size() - pos < snapshotSize)
+    return false;
+
+  // Read into a separate document, so that a damaged entry leaves _sdf
+  // untouched for the regular parser.
+  SDFPtr cached(new SDF);
+  Errors errors;
+  if (!init(cached) ||
+      !BinarySnapshot::Read(file.Data() + pos,
+          static_cast<std::size_t>(snapshotSize), cached, errors))
+  {
+    for (const auto &e : errors)
+    {
+      sdfdbg << "Ignoring load cache entry [" << this->entryPath << "]: "
+             << e.Message() << "\n";
+    }
+    return false;
+  }
+  pos += static_cast<std::size_t>(snapshotSize);
+
+  // Damaged graphs are built again from the document.
+  if (_graphs)
+  {
+    _graphs->reset();
+    char hasGraphs = 0;
+    if (getValue(file, pos, hasGraphs) && hasGraphs &&
+        !getGraphs(file, pos, _graphs->emplace()))
+    {
+      sdfdbg << "Ignoring the graphs of load cache entry ["
+             << this->entryPath << "]\n";
+      _graphs->reset();
+    }
+  }
+
+  _sdf->Root(cached->Root());
+  _sdf->SetFilePath(cached->FilePath());
+  _sdf->SetOriginalVersion(cached->OriginalVersion());
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool LoadCache::Store(const SDF &_sdf,
+    const std::vector<IncludeCache::FileStamp> &_files,
+    const Graphs *_graphs) const
+{
+  if (!this->Valid())
+    return false;
+
+  std::string header(kEntryMagic, sizeof(kEntryMagic));
+  putValue(kEntryVersion, header);
+  putValue(static_cast<std::uint32_t>(_files.size()), header);
+  for (const IncludeCache::FileStamp &stamp : _files)
+  {
+    // The document was parsed from the files as they were when they were
+    // stamped. A file that changed since then would be stored with the
+    // hash of its new content, so nothing is stored. The stamp is checked
+    // after hashing, so that the hash is of the content that was parsed.
+    std::uint64_t hash = 0;
+    IncludeCache::FileStamp current;
+    if (!HashFile(stamp.filename, hash) ||
+        !IncludeCache::Stamp(VirtualFilesystem::Native(), stamp.filename,
+                             current) ||
+        current.size != stamp.size || current.modified != stamp.modified)
+    {
+      sdfdbg << "Not storing load cache entry [" << this->entryPath
+             << "], file [" << stamp.filename << "] changed while loading\n";
+      return false;
+    }
+    putString(stamp.filename, header);
+    putValue(hash, header);
+  }
+
+  std::string graphs;
+  putValue(static_cast<char>(_graphs ? 1 : 0), graphs);
+  if (_graphs)
+    putGraphs(*_graphs, graphs);
+
+  if (!sdf::filesystem::is_directory(this->directory))
+    sdf::filesystem::create_directory(this->directory);
+
+  // Write to a file of our own, then move it in place.
+  std::random_device random;
+  const std::string tmpPath = this->entryPath + "." +
+      std::to_string(random()) + ".tmp";
+  bool written = false;
+  {
+    std::ofstream out(tmpPath, std::ios::out | std::ios::binary);
+    Errors errors;
+    if (out)
+    {
+      // The size of the snapshot is filled in once it is written.
+      std::uint64_t snapshotSize = 0;
+      putValue(snapshotSize, header);
+      out.write(header.data(), static_cast<std::streamsize>(header.size()));
+      const std::streamoff start = out.tellp();
+      written = BinarySnapshot::Write(_sdf, out, errors);
+      snapshotSize = static_cast<std::uint64_t>(out.tellp() - start);
+      out.write(graphs.data(), static_cast<std::streamsize>(graphs.size()));
+      out.seekp(start - static_cast<std::streamoff>(sizeof(snapshotSize)));
+      out.write(reinterpret_cast<const char *>(&snapshotSize),
+          sizeof(snapshotSize));
+      out.close();
+      written = written && !out.fail();
+    }
+  }
+
+  if (!written || std::rename(tmpPath.c_str(), this->entryPath.c_str()) != 0)
+  {
+    std::remove(tmpPath.c_str());
+    sdfdbg << "Unable to write load cache entry [" << this->entryPath
+           << "]\n";
+    return false;
+  }
+  return true;
+}
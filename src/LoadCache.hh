@@ -0,0 +1,173 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_LOAD_CACHE_HH_
+#define SDF_LOAD_CACHE_HH_
+
+#include <cstdint>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "sdf/ParserConfig.hh"
+#include "sdf/SDFImpl.hh"
+#include "sdf/sdf_config.h"
+#include "FrameSemantics.hh"
+#include "IncludeCache.hh"
+#include "ScopedGraph.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief Entry of the on-disk load cache for one source file.
+  ///
+  /// An entry is a file in the cache directory named after a hash of the
+  /// library version, the SDFormat version, the name and the content of the
+  /// source file, and the names of the skipped elements. It holds the name
+  /// and content hash of every file the source included, directly or not,
+  /// followed by a binary snapshot of the converted and include-expanded
+  /// document. The entry is only used if all included files still have the
+  /// same content.
+  ///
+  /// Entries written by sdf::Root also hold the validated frame graphs of
+  /// the worlds and top level models of the document, with the poses of
+  /// their vertices resolved relative to each world and model frame, so
+  /// that loading the document again doesn't build or validate them.
+  ///
+  /// Entries are written to a temporary file that is then renamed, so that
+  /// processes sharing the directory never read a partial entry.
+  class LoadCache
+  {
+    /// \brief Frame graphs of the worlds and top level models of a
+    /// document, built and validated by sdf::Root.
+    public: struct Graphs
+    {
+      /// \brief The attached_to graphs.
+      RootGraphs<FrameAttachedToGraph> frameAttachedTo;
+
+      /// \brief The relative_to graphs.
+      RootGraphs<PoseRelativeToGraph> poseRelativeTo;
+    };
+
+    /// \brief Get the cache directory of a configuration.
+    /// \param[in] _config Parser configuration.
+    /// \return ParserConfig::LoadCachePath if set, else the value of the
+    /// SDF_LOAD_CACHE_PATH environment variable, else an empty string if
+    /// the cache is disabled.
+    public: static std::string Directory(const ParserConfig &_config);
+
+    /// \brief Constructor. Hashes the source file.
+    /// \param[in] _directory Cache directory.
+    /// \param[in] _filename Resolved name of the source file.
+    /// \param[in] _convert True if the document is converted to the
+    /// latest SDFormat version.
+    /// \param[in] _skipped Names of the elements left out of the document,
+    /// see ParserConfig::SetSkippedElements.
+    /// \param[in] _trusted True if the document is read without validation,
+    /// see ParserConfig::SetTrustedInput.
+    public: LoadCache(const std::string &_directory,
+                      const std::string &_filename, bool _convert,
+                      const std::set<std::string> &_skipped, bool _trusted);
+
+    /// \brief Check whether the source file could be hashed.
+    /// \return True if entries can be loaded and stored.
+    public: bool Valid() const;
+
+    /// \brief Populate a document from the entry, if it is up to date.
+    /// \param[in,out] _sdf Document initialized with sdf::init.
+    /// \param[out] _graphs If not null, set to the graphs of the entry, or
+    /// reset if it has none.
+    /// \return True if the document was loaded from the entry.
+    public: bool Load(SDFPtr _sdf,
+                      std::optional<Graphs> *_graphs = nullptr) const;
+
+    /// \brief Write the entry.
+    /// \param[in] _sdf The loaded document.
+    /// \param[in] _files Files included by the source file.
+    /// \param[in] _graphs Validated graphs of the document, or nullptr to
+    /// store the document alone.
+    /// \return True if the entry was written.
+    public: bool Store(const SDF &_sdf,
+                       const std::vector<IncludeCache::FileStamp> &_files,
+                       const Graphs *_graphs = nullptr) const;
+
+    /// \brief Hash the content of a file.
+    /// \param[in] _filename Name of the file.
+    /// \param[out] _hash Hash of the content.
+    /// \return True if the file could be read.
+    public: static bool HashFile(const std::string &_filename,
+                                 std::uint64_t &_hash);
+
+    /// \brief Cache directory.
+    private: std::string directory;
+
+    /// \brief Path of the entry file, empty if the entry is not valid.
+    private: std::string entryPath;
+  };
+
+  /// \brief Entry of the load cache of a top level file read by
+  /// sdf::Root::Load, which stores it once the graphs are built.
+  struct LoadCacheRecord
+  {
+    /// \brief Entry to store, set if the file was read without errors and
+    /// not loaded from the cache.
+    std::optional<LoadCache> cache;
+
+    /// \brief Files included by the file, for the entry to store.
+    std::vector<IncludeCache::FileStamp> files;
+
+    /// \brief Graphs of the entry the file was loaded from, if any.
+    std::optional<LoadCache::Graphs> graphs;
+  };
+
+  /// \brief Records the load cache entry of the top level file read on the
+  /// current thread, instead of storing it right away.
+  class LoadCacheScope
+  {
+    /// \brief Constructor
+    /// \param[in] _record Record to fill, or nullptr to store entries when
+    /// they are read.
+    public: explicit LoadCacheScope(LoadCacheRecord *_record)
+      : previous(Record())
+    {
+      Record() = _record;
+    }
+
+    /// \brief Destructor
+    public: ~LoadCacheScope()
+    {
+      Record() = this->previous;
+    }
+
+    /// \brief Get the record of the current thread.
+    /// \return Reference to the record, or to nullptr if entries are stored
+    /// when they are read.
+    public: static LoadCacheRecord *&Record()
+    {
+      static thread_local LoadCacheRecord *record = nullptr;
+      return record;
+    }
+
+    /// \brief Setting that was current before this scope.
+    private: LoadCacheRecord *previous;
+  };
+  }
+}
+#endif
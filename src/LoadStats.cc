@@ -0,0 +1,254 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+#include "sdf/LoadStats.hh"
+
+using namespace sdf;
+
+/// \brief Number of phases measured by LoadStats.
+static constexpr std::size_t kPhaseCount =
+    static_cast<std::size_t>(LoadPhase::PHASE_COUNT);
+
+/// \brief Private data for sdf::LoadStats
+class sdf::LoadStatsPrivate
+{
+  /// \brief Default constructor
+  public: LoadStatsPrivate() = default;
+
+  /// \brief Copy constructor
+  /// \param[in] _other LoadStatsPrivate to copy.
+  public: LoadStatsPrivate(const LoadStatsPrivate &_other)
+  {
+    for (std::size_t i = 0; i < kPhaseCount; ++i)
+    {
+      this->nanoseconds[i] = _other.nanoseconds[i].load();
+      this->counts[i] = _other.counts[i].load();
+    }
+    this->domProfiling = _other.domProfiling.load();
+    std::lock_guard<std::mutex> lock(_other.domMutex);
+    this->dom = _other.dom;
+  }
+
+  /// \brief Time spent in each phase, in nanoseconds.
+  public: std::array<std::atomic<std::int64_t>, kPhaseCount> nanoseconds {};
+
+  /// \brief Number of times each phase was entered.
+  public: std::array<std::atomic<std::uint64_t>, kPhaseCount> counts {};
+
+  /// \brief True if the DOM profile is collected.
+  public: std::atomic<bool> domProfiling{false};
+
+  /// \brief Protects dom.
+  public: mutable std::mutex domMutex;
+
+  /// \brief DOM profile, by class name.
+  public: std::unordered_map<std::string, DomLoadProfile> dom;
+};
+
+/////////////////////////////////////////////////
+LoadStats::LoadStats()
+  : dataPtr(new LoadStatsPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+LoadStats::LoadStats(const LoadStats &_stats)
+  : dataPtr(new LoadStatsPrivate(*_stats.dataPtr))
+{
+}
+
+/////////////////////////////////////////////////
+LoadStats::LoadStats(LoadStats &&_stats) noexcept
+  : dataPtr(std::exchange(_stats.dataPtr, nullptr))
+{
+}
+
+/////////////////////////////////////////////////
+LoadStats &LoadStats::operator=(LoadStats &&_stats) noexcept
+{
+  std::swap(this->dataPtr, _stats.dataPtr);
+  return *this;
+}
+
+/////////////////////////////////////////////////
+LoadStats &LoadStats::operator=(const LoadStats &_stats)
+{
+  return *this = LoadStats(_stats);
+}
+
+/////////////////////////////////////////////////
+LoadStats::~LoadStats()
+{
+  delete this->dataPtr;
+  this->dataPtr = nullptr;
+}
+
+/////////////////////////////////////////////////
+std::chrono::nanoseconds LoadStats::Duration(LoadPhase _phase) const
+{
+  const auto index = static_cast<std::size_t>(_phase);
+  if (index >= kPhaseCount)
+    return std::chrono::nanoseconds::zero();
+  return std::chrono::nanoseconds(this->dataPtr->nanoseconds[index].load());
+}
+
+/////////////////////////////////////////////////
+std::uint64_t LoadStats::Count(LoadPhase _phase) const
+{
+  const auto index = static_cast<std::size_t>(_phase);
+  if (index >= kPhaseCount)
+    return 0u;
+  return this->dataPtr->counts[index].load();
+}
+
+/////////////////////////////////////////////////
+void LoadStats::Add(LoadPhase _phase, std::chrono::nanoseconds _duration,
+    std::uint64_t _count)
+{
+  const auto index = static_cast<std::size_t>(_phase);
+  if (index >= kPhaseCount)
+    return;
+  this->dataPtr->nanoseconds[index].fetch_add(_duration.count(),
+      std::memory_order_relaxed);
+  this->dataPtr->counts[index].fetch_add(_count, std::memory_order_relaxed);
+}
+
+/////////////////////////////////////////////////
+void LoadStats::Reset()
+{
+  for (std::size_t i = 0; i < kPhaseCount; ++i)
+  {
+    this->dataPtr->nanoseconds[i] = 0;
+    this->dataPtr->counts[i] = 0u;
+  }
+  std::lock_guard<std::mutex> lock(this->dataPtr->domMutex);
+  this->dataPtr->dom.clear();
+}
+
+/////////////////////////////////////////////////
+void LoadStats::SetDomProfiling(bool _enabled)
+{
+  this->dataPtr->domProfiling = _enabled;
+}
+
+/////////////////////////////////////////////////
+bool LoadStats::DomProfiling() const
+{
+  return this->dataPtr->domProfiling.load(std::memory_order_relaxed);
+}
+
+/////////////////////////////////////////////////
+void LoadStats::AddDomLoad(const std::string &_className,
+    std::chrono::nanoseconds _total, std::chrono::nanoseconds _self,
+    std::uint64_t _count)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->domMutex);
+  DomLoadProfile &profile = this->dataPtr->dom[_className];
+  profile.count += _count;
+  profile.total += _total;
+  profile.self += _self;
+}
+
+/////////////////////////////////////////////////
+std::vector<DomLoadProfile> LoadStats::DomProfile() const
+{
+  std::vector<DomLoadProfile> result;
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->domMutex);
+    result.reserve(this->dataPtr->dom.size());
+    for (const auto &[className, profile] : this->dataPtr->dom)
+    {
+      result.push_back(profile);
+      result.back().className = className;
+    }
+  }
+
+  std::sort(result.begin(), result.end(),
+      [](const DomLoadProfile &_a, const DomLoadProfile &_b)
+      {
+        if (_a.self != _b.self)
+          return _a.self > _b.self;
+        return _a.className < _b.className;
+      });
+  return result;
+}
+
+/////////////////////////////////////////////////
+std::string LoadStats::PhaseName(LoadPhase _phase)
+{
+  switch (_phase)
+  {
+    case LoadPhase::XML_PARSE:
+      return "xml_parse";
+    case LoadPhase::CONVERSION:
+      return "conversion";
+    case LoadPhase::URDF_CONVERSION:
+      return "urdf_conversion";
+    case LoadPhase::INCLUDE:
+      return "include";
+    case LoadPhase::READ_XML:
+      return "read_xml";
+    case LoadPhase::DOM_LOAD:
+      return "dom_load";
+    case LoadPhase::FRAME_GRAPH_BUILD:
+      return "frame_graph_build";
+    case LoadPhase::FRAME_GRAPH_VALIDATE:
+      return "frame_graph_validate";
+    case LoadPhase::URDF_PARSE:
+      return "urdf_parse";
+    case LoadPhase::URDF_REDUCE_FIXED_JOINTS:
+      return "urdf_reduce_fixed_joints";
+    case LoadPhase::URDF_CREATE_SDF:
+      return "urdf_create_sdf";
+    default:
+      return "";
+  }
+}
+
+/////////////////////////////////////////////////
+namespace sdf
+{
+inline namespace SDF_VERSION_NAMESPACE {
+std::ostream &operator<<(std::ostream &_out, const LoadStats &_stats)
+{
+  for (std::size_t i = 0; i < kPhaseCount; ++i)
+  {
+    const auto phase = static_cast<LoadPhase>(i);
+    const std::chrono::duration<double, std::milli> duration =
+        _stats.Duration(phase);
+    _out << LoadStats::PhaseName(phase) << ": " << duration.count()
+         << " ms, " << _stats.Count(phase) << " calls\n";
+  }
+
+  using Milliseconds = std::chrono::duration<double, std::milli>;
+  for (const DomLoadProfile &profile : _stats.DomProfile())
+  {
+    _out << "dom " << profile.className << ": "
+         << Milliseconds(profile.self).count() << " ms self, "
+         << Milliseconds(profile.total).count() << " ms total, "
+         << profile.count << " calls\n";
+  }
+  return _out;
+}
+}
+}
@@ -0,0 +1,203 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_LOAD_STATS_SCOPE_HH_
+#define SDF_LOAD_STATS_SCOPE_HH_
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <utility>
+
+#include "sdf/LoadStats.hh"
+#include "sdf/ParserConfig.hh"
+#include "sdf/sdf_config.h"
+
+/// \ingroup sdf_parser
+/// \brief namespace for Simulation Description Format parser
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief Makes a LoadStats object the destination of the LoadPhaseTimer
+  /// objects created on the current thread while this scope is alive. The
+  /// previous destination is restored when the scope is destroyed, so
+  /// scopes can nest.
+  class LoadStatsScope
+  {
+    /// \brief Constructor
+    /// \param[in] _stats Statistics to update, or nullptr to disable
+    /// collection in this scope.
+    public: explicit LoadStatsScope(LoadStats *_stats)
+      : previous(Current())
+    {
+      Current() = _stats;
+    }
+
+    /// \brief Constructor that uses the statistics set on a ParserConfig.
+    /// If the ParserConfig has no statistics, the current destination is
+    /// kept, so that nested loads keep reporting to the outer scope.
+    /// \param[in] _config Parser configuration.
+    public: explicit LoadStatsScope(const ParserConfig &_config)
+      : previous(Current())
+    {
+      if (_config.Stats())
+        Current() = _config.Stats();
+    }
+
+    /// \brief Destructor
+    public: ~LoadStatsScope()
+    {
+      Current() = this->previous;
+    }
+
+    /// \brief Get the statistics of the current thread.
+    /// \return Reference to the current destination, which is nullptr
+    /// when statistics are not being collected.
+    public: static LoadStats *&Current()
+    {
+      static thread_local LoadStats *current = nullptr;
+      return current;
+    }
+
+    /// \brief Destination that was current before this scope.
+    private: LoadStats *previous;
+  };
+
+  /// \brief Measures the wall time of a LoadPhase from construction to
+  /// destruction and adds it to the current LoadStats. This does nothing
+  /// beyond a thread local lookup when no statistics are being collected.
+  class LoadPhaseTimer
+  {
+    /// \brief Constructor
+    /// \param[in] _phase Phase being measured.
+    public: explicit LoadPhaseTimer(LoadPhase _phase)
+      : stats(LoadStatsScope::Current()), phase(_phase)
+    {
+      if (this->stats)
+      {
+        // Only the outermost entry of a phase on a thread is timed, so that
+        // recursive calls, e.g. readXml, are not counted more than once.
+        this->outermost = Depth(this->phase)++ == 0u;
+        if (this->outermost)
+          this->start = std::chrono::steady_clock::now();
+      }
+    }
+
+    /// \brief Destructor
+    public: ~LoadPhaseTimer()
+    {
+      if (!this->stats)
+        return;
+
+      std::chrono::nanoseconds elapsed{0};
+      if (this->outermost)
+        elapsed = std::chrono::steady_clock::now() - this->start;
+      --Depth(this->phase);
+      this->stats->Add(this->phase, elapsed);
+    }
+
+    /// \brief Get the number of active timers of a phase on this thread.
+    /// \param[in] _phase The phase.
+    /// \return Reference to the depth of the phase.
+    private: static unsigned int &Depth(LoadPhase _phase)
+    {
+      static thread_local std::array<unsigned int,
+          static_cast<std::size_t>(LoadPhase::PHASE_COUNT)> depth {};
+      return depth[static_cast<std::size_t>(_phase)];
+    }
+
+    /// \brief Statistics to update, or nullptr.
+    private: LoadStats *stats;
+
+    /// \brief Phase being measured.
+    private: LoadPhase phase;
+
+    /// \brief True if this is the outermost timer of its phase.
+    private: bool outermost = false;
+
+    /// \brief Time at which the phase was entered.
+    private: std::chrono::steady_clock::time_point start;
+  };
+
+  /// \brief Measures the wall time of the Load function of a DOM class and
+  /// adds it to the DOM profile of the current LoadStats. The timers of a
+  /// thread form a stack, so the time of an object loaded by another one is
+  /// subtracted from the self time of the outer object. Objects loaded on
+  /// other threads, e.g. by parallelFor, are not subtracted. This does
+  /// nothing beyond a thread local lookup when no statistics are being
+  /// collected, and an atomic load when DOM profiling is disabled.
+  class DomLoadTimer
+  {
+    /// \brief Constructor
+    /// \param[in] _className Name of the DOM class, which must outlive the
+    /// timer, e.g. a string literal.
+    public: explicit DomLoadTimer(const char *_className)
+      : stats(LoadStatsScope::Current()), className(_className)
+    {
+      if (!this->stats || !this->stats->DomProfiling())
+      {
+        this->stats = nullptr;
+        return;
+      }
+
+      this->parent = std::exchange(Innermost(), this);
+      this->start = std::chrono::steady_clock::now();
+    }
+
+    /// \brief Destructor
+    public: ~DomLoadTimer()
+    {
+      if (!this->stats)
+        return;
+
+      const std::chrono::nanoseconds elapsed =
+          std::chrono::steady_clock::now() - this->start;
+      Innermost() = this->parent;
+      if (this->parent)
+        this->parent->children += elapsed;
+      this->stats->AddDomLoad(this->className, elapsed,
+          elapsed - this->children);
+    }
+
+    /// \brief Get the innermost active timer of this thread.
+    /// \return Reference to the innermost timer, or nullptr.
+    private: static DomLoadTimer *&Innermost()
+    {
+      static thread_local DomLoadTimer *innermost = nullptr;
+      return innermost;
+    }
+
+    /// \brief Statistics to update, or nullptr.
+    private: LoadStats *stats;
+
+    /// \brief Name of the DOM class.
+    private: const char *className;
+
+    /// \brief Timer that was innermost before this one.
+    private: DomLoadTimer *parent = nullptr;
+
+    /// \brief Time spent in the timers nested in this one.
+    private: std::chrono::nanoseconds children{0};
+
+    /// \brief Time at which the Load function was entered.
+    private: std::chrono::steady_clock::time_point start;
+  };
+  }
+}
+#endif
@@ -0,0 +1,139 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "sdf/LoadStats.hh"
+
+/////////////////////////////////////////////////
+TEST(LoadStats, Construction)
+{
+  sdf::LoadStats stats;
+  for (int i = 0; i < static_cast<int>(sdf::LoadPhase::PHASE_COUNT); ++i)
+  {
+    const auto phase = static_cast<sdf::LoadPhase>(i);
+    EXPECT_EQ(std::chrono::nanoseconds::zero(), stats.Duration(phase));
+    EXPECT_EQ(0u, stats.Count(phase));
+    EXPECT_FALSE(sdf::LoadStats::PhaseName(phase).empty());
+  }
+  EXPECT_TRUE(
+      sdf::LoadStats::PhaseName(sdf::LoadPhase::PHASE_COUNT).empty());
+  EXPECT_EQ(0u, stats.Count(sdf::LoadPhase::PHASE_COUNT));
+}
+
+/////////////////////////////////////////////////
+TEST(LoadStats, AddReset)
+{
+  sdf::LoadStats stats;
+  stats.Add(sdf::LoadPhase::READ_XML, std::chrono::nanoseconds(100));
+  stats.Add(sdf::LoadPhase::READ_XML, std::chrono::nanoseconds(50), 3u);
+  stats.Add(sdf::LoadPhase::PHASE_COUNT, std::chrono::nanoseconds(50));
+
+  EXPECT_EQ(std::chrono::nanoseconds(150),
+            stats.Duration(sdf::LoadPhase::READ_XML));
+  EXPECT_EQ(4u, stats.Count(sdf::LoadPhase::READ_XML));
+  EXPECT_EQ(0u, stats.Count(sdf::LoadPhase::XML_PARSE));
+
+  std::ostringstream stream;
+  stream << stats;
+  EXPECT_NE(std::string::npos, stream.str().find("read_xml: "));
+  EXPECT_NE(std::string::npos, stream.str().find(" 4 calls"));
+
+  stats.Reset();
+  EXPECT_EQ(std::chrono::nanoseconds::zero(),
+            stats.Duration(sdf::LoadPhase::READ_XML));
+  EXPECT_EQ(0u, stats.Count(sdf::LoadPhase::READ_XML));
+}
+
+/////////////////////////////////////////////////
+TEST(LoadStats, CopyConstruction)
+{
+  sdf::LoadStats stats;
+  stats.Add(sdf::LoadPhase::DOM_LOAD, std::chrono::nanoseconds(10));
+
+  sdf::LoadStats stats2(stats);
+  EXPECT_EQ(1u, stats2.Count(sdf::LoadPhase::DOM_LOAD));
+
+  stats2.Add(sdf::LoadPhase::DOM_LOAD, std::chrono::nanoseconds(10));
+  EXPECT_EQ(1u, stats.Count(sdf::LoadPhase::DOM_LOAD));
+  EXPECT_EQ(2u, stats2.Count(sdf::LoadPhase::DOM_LOAD));
+}
+
+/////////////////////////////////////////////////
+TEST(LoadStats, CopyAssignmentAfterMove)
+{
+  sdf::LoadStats stats1;
+  stats1.Add(sdf::LoadPhase::INCLUDE, std::chrono::nanoseconds(1));
+
+  sdf::LoadStats stats2;
+  stats2.Add(sdf::LoadPhase::CONVERSION, std::chrono::nanoseconds(1));
+
+  sdf::LoadStats tmp = std::move(stats1);
+  stats1 = stats2;
+  stats2 = tmp;
+
+  EXPECT_EQ(1u, stats1.Count(sdf::LoadPhase::CONVERSION));
+  EXPECT_EQ(0u, stats1.Count(sdf::LoadPhase::INCLUDE));
+  EXPECT_EQ(1u, stats2.Count(sdf::LoadPhase::INCLUDE));
+  EXPECT_EQ(0u, stats2.Count(sdf::LoadPhase::CONVERSION));
+}
+
+/////////////////////////////////////////////////
+TEST(LoadStats, DomProfile)
+{
+  sdf::LoadStats stats;
+  EXPECT_FALSE(stats.DomProfiling());
+  EXPECT_TRUE(stats.DomProfile().empty());
+
+  stats.SetDomProfiling(true);
+  EXPECT_TRUE(stats.DomProfiling());
+  stats.AddDomLoad("Link", std::chrono::nanoseconds(100),
+      std::chrono::nanoseconds(40));
+  stats.AddDomLoad("Link", std::chrono::nanoseconds(50),
+      std::chrono::nanoseconds(20), 2u);
+  stats.AddDomLoad("Visual", std::chrono::nanoseconds(70),
+      std::chrono::nanoseconds(70));
+  stats.AddDomLoad("Box", std::chrono::nanoseconds(60),
+      std::chrono::nanoseconds(60));
+
+  // Sorted by decreasing self time, then by name.
+  std::vector<sdf::DomLoadProfile> profile = stats.DomProfile();
+  ASSERT_EQ(3u, profile.size());
+  EXPECT_EQ("Visual", profile[0].className);
+  EXPECT_EQ("Box", profile[1].className);
+  EXPECT_EQ("Link", profile[2].className);
+  EXPECT_EQ(3u, profile[2].count);
+  EXPECT_EQ(std::chrono::nanoseconds(150), profile[2].total);
+  EXPECT_EQ(std::chrono::nanoseconds(60), profile[2].self);
+
+  std::ostringstream stream;
+  stream << stats;
+  EXPECT_NE(std::string::npos, stream.str().find("\ndom Link: "));
+  EXPECT_NE(std::string::npos, stream.str().find(" 3 calls\n"));
+
+  sdf::LoadStats copy(stats);
+  EXPECT_TRUE(copy.DomProfiling());
+  EXPECT_EQ(3u, copy.DomProfile().size());
+
+  stats.Reset();
+  EXPECT_TRUE(stats.DomProfiling());
+  EXPECT_TRUE(stats.DomProfile().empty());
+  EXPECT_EQ(3u, copy.DomProfile().size());
+}
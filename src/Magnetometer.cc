@@ -17,6 +17,8 @@
 #include <array>
 #include <string>
 #include "sdf/Magnetometer.hh"
+#include "ElementRetentionScope.hh"
+#include "LoadStatsScope.hh"
 
 using namespace sdf;
 
@@ -71,9 +73,10 @@ Magnetometer &Magnetometer::operator=(Magnetometer &&_magnetometer)
 //////////////////////////////////////////////////
 Errors Magnetometer::Load(ElementPtr _sdf)
 {
+  DomLoadTimer timer("Magnetometer");
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that the provided SDF element is a <magnetometer> element.
   // This is an error that cannot be recovered, so return an error.
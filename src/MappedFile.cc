@@ -0,0 +1,115 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include "MappedFile.hh"
+
+using namespace sdf;
+
+/////////////////////////////////////////////////
+MappedFile::~MappedFile()
+{
+  this->Close();
+}
+
+/////////////////////////////////////////////////
+bool MappedFile::Open(const std::string &_filename)
+{
+  this->Close();
+
+#ifndef _WIN32
+  const int fd = ::open(_filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  struct stat info;
+  if (::fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0)
+  {
+    const std::size_t length = static_cast<std::size_t>(info.st_size);
+    void *address = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (address != MAP_FAILED)
+    {
+      // The parser reads the file once from start to end.
+      ::madvise(address, length, MADV_SEQUENTIAL);
+      this->mapping = address;
+      this->data = static_cast<const char *>(address);
+      this->size = length;
+      ::close(fd);
+      return true;
+    }
+  }
+  ::close(fd);
+#endif
+
+  // Empty files, special files and platforms without mmap are read.
+  std::ifstream input(_filename, std::ios::in | std::ios::binary);
+  if (!input)
+    return false;
+
+  this->buffer.assign(std::istreambuf_iterator<char>(input),
+                      std::istreambuf_iterator<char>());
+  if (input.bad())
+  {
+    this->buffer.clear();
+    return false;
+  }
+
+  this->data = this->buffer.data();
+  this->size = this->buffer.size();
+  return true;
+}
+
+/////////////////////////////////////////////////
+void MappedFile::Close()
+{
+#ifndef _WIN32
+  if (this->mapping)
+    ::munmap(this->mapping, this->size);
+#endif
+  this->mapping = nullptr;
+  this->buffer.clear();
+  this->buffer.shrink_to_fit();
+  this->data = nullptr;
+  this->size = 0;
+}
+
+/////////////////////////////////////////////////
+const char *MappedFile::Data() const
+{
+  return this->data;
+}
+
+/////////////////////////////////////////////////
+std::size_t MappedFile::Size() const
+{
+  return this->size;
+}
+
+/////////////////////////////////////////////////
+bool MappedFile::Mapped() const
+{
+  return this->mapping != nullptr;
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_MAPPED_FILE_HH_
+#define SDF_MAPPED_FILE_HH_
+
+#include <cstddef>
+#include <string>
+
+#include "sdf/sdf_config.h"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief Read-only view of the content of a file.
+  ///
+  /// Where available the file is memory-mapped, so that it can be handed
+  /// to the XML parser without first copying it into a buffer of its own.
+  /// On other platforms, and for files that can not be mapped, the content
+  /// is read into memory instead.
+  class MappedFile
+  {
+    /// \brief Constructor
+    public: MappedFile() = default;
+
+    /// \brief Copy constructor is deleted, because the object owns the
+    /// mapping.
+    /// \param[in] _file MappedFile to copy.
+    public: MappedFile(const MappedFile &_file) = delete;
+
+    /// \brief Copy assignment operator is deleted.
+    /// \param[in] _file MappedFile to copy.
+    /// \return Reference to this.
+    public: MappedFile &operator=(const MappedFile &_file) = delete;
+
+    /// \brief Destructor. Unmaps the file.
+    public: ~MappedFile();
+
+    /// \brief Map or read a file, releasing any previous file.
+    /// \param[in] _filename Name of the file.
+    /// \return True if the content of the file is available.
+    public: bool Open(const std::string &_filename);
+
+    /// \brief Release the file.
+    public: void Close();
+
+    /// \brief Get the content of the file. It is not null terminated.
+    /// \return Pointer to the first byte of the file, or nullptr if no file
+    /// is open.
+    public: const char *Data() const;
+
+    /// \brief Get the size of the file.
+    /// \return Size in bytes.
+    public: std::size_t Size() const;
+
+    /// \brief Check whether the file is memory-mapped.
+    /// \return True if the content is mapped, false if it was read.
+    public: bool Mapped() const;
+
+    /// \brief Start of the mapping, or nullptr.
+    private: void *mapping = nullptr;
+
+    /// \brief Content of the file when it could not be mapped.
+    private: std::string buffer;
+
+    /// \brief Pointer to the content.
+    private: const char *data = nullptr;
+
+    /// \brief Size of the content.
+    private: std::size_t size = 0;
+  };
+  }
+}
+#endif
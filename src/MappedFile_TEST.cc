@@ -0,0 +1,72 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "sdf/Filesystem.hh"
+#include "MappedFile.hh"
+#include "test_config.h"
+
+/////////////////////////////////////////////////
+TEST(MappedFile, ReadFile)
+{
+  const std::string path = sdf::filesystem::append(PROJECT_SOURCE_PATH,
+      "test", "integration", "model", "double_pendulum.sdf");
+
+  std::ifstream input(path, std::ios::binary);
+  const std::string expected((std::istreambuf_iterator<char>(input)),
+                             std::istreambuf_iterator<char>());
+  ASSERT_FALSE(expected.empty());
+
+  sdf::MappedFile file;
+  EXPECT_EQ(nullptr, file.Data());
+  EXPECT_EQ(0u, file.Size());
+
+  ASSERT_TRUE(file.Open(path));
+  EXPECT_TRUE(file.Mapped());
+  ASSERT_EQ(expected.size(), file.Size());
+  EXPECT_EQ(expected, std::string(file.Data(), file.Size()));
+
+  file.Close();
+  EXPECT_FALSE(file.Mapped());
+  EXPECT_EQ(nullptr, file.Data());
+  EXPECT_EQ(0u, file.Size());
+}
+
+/////////////////////////////////////////////////
+TEST(MappedFile, EmptyAndMissing)
+{
+  const std::string path = sdf::filesystem::append(
+      sdf::filesystem::current_path(), "mapped_file_empty.txt");
+  {
+    std::ofstream output(path);
+  }
+
+  // Empty files can not be mapped, and are read instead.
+  sdf::MappedFile file;
+  ASSERT_TRUE(file.Open(path));
+  EXPECT_FALSE(file.Mapped());
+  EXPECT_EQ(0u, file.Size());
+  EXPECT_EQ(0, std::remove(path.c_str()));
+
+  EXPECT_FALSE(file.Open(path));
+  EXPECT_EQ(nullptr, file.Data());
+}
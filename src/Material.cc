@@ -21,6 +21,8 @@
 #include "sdf/Types.hh"
 #include "sdf/Material.hh"
 #include "sdf/Pbr.hh"
+#include "ElementRetentionScope.hh"
+#include "LoadStatsScope.hh"
 #include "Utils.hh"
 
 using namespace sdf;
@@ -114,9 +116,10 @@ Material &Material::operator=(Material &&_material)
 /////////////////////////////////////////////////
 Errors Material::Load(sdf::ElementPtr _sdf)
 {
+  DomLoadTimer timer("Material");
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that the provided SDF element is a <material>
   // This is an error that cannot be recovered, so return an error.
@@ -0,0 +1,224 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include <ignition/math/Color.hh>
+
+#include "sdf/Pbr.hh"
+#include "ContentHash.hh"
+#include "MaterialTable.hh"
+
+using namespace sdf;
+
+namespace
+{
+/// \brief Mix a color into a hash.
+/// \param[in] _hash Hash so far.
+/// \param[in] _color Color to mix in.
+/// \return The new hash.
+std::uint64_t hashColor(std::uint64_t _hash,
+    const ignition::math::Color &_color)
+{
+  for (const float value : {_color.R(), _color.G(), _color.B(), _color.A()})
+    _hash = hashCombine(_hash, std::hash<float>()(value));
+  return _hash;
+}
+
+/// \brief Mix a PBR workflow into a hash.
+/// \param[in] _hash Hash so far.
+/// \param[in] _workflow Workflow to mix in, or nullptr.
+/// \return The new hash.
+std::uint64_t hashWorkflow(std::uint64_t _hash,
+    const PbrWorkflow *_workflow)
+{
+  if (!_workflow)
+    return hashCombine(_hash, 0u);
+
+  _hash = hashCombine(_hash, static_cast<std::uint64_t>(_workflow->Type()));
+  for (const std::string &map : {_workflow->AlbedoMap(),
+       _workflow->NormalMap(), _workflow->EnvironmentMap(),
+       _workflow->AmbientOcclusionMap(), _workflow->RoughnessMap(),
+       _workflow->MetalnessMap(), _workflow->EmissiveMap(),
+       _workflow->GlossinessMap(), _workflow->SpecularMap()})
+  {
+    _hash = hashCombine(_hash, map);
+  }
+  _hash = hashCombine(_hash,
+      static_cast<std::uint64_t>(_workflow->NormalMapType()));
+  for (const double value : {_workflow->Metalness(), _workflow->Roughness(),
+       _workflow->Glossiness()})
+  {
+    _hash = hashCombine(_hash, std::hash<double>()(value));
+  }
+  return _hash;
+}
+
+/// \brief Hash the content of a material.
+/// \param[in] _material Material to hash.
+/// \return The hash.
+std::uint64_t hashMaterial(const Material &_material)
+{
+  std::uint64_t hash = 0;
+  for (const auto &color : {_material.Ambient(), _material.Diffuse(),
+       _material.Specular(), _material.Emissive()})
+  {
+    hash = hashColor(hash, color);
+  }
+  hash = hashCombine(hash, _material.Lighting() ? 1u : 2u);
+  hash = hashCombine(hash, _material.ScriptUri());
+  hash = hashCombine(hash, _material.ScriptName());
+  hash = hashCombine(hash, static_cast<std::uint64_t>(_material.Shader()));
+  hash = hashCombine(hash, _material.NormalMap());
+
+  const Pbr *pbr = _material.PbrMaterial();
+  hash = hashCombine(hash, pbr ? 1u : 0u);
+  if (pbr)
+  {
+    hash = hashWorkflow(hash, pbr->Workflow(PbrWorkflowType::METAL));
+    hash = hashWorkflow(hash, pbr->Workflow(PbrWorkflowType::SPECULAR));
+  }
+  return hash;
+}
+
+/// \brief Check whether two colors are exactly equal. Color::operator==
+/// has a tolerance, which would make equality disagree with the hash.
+/// \param[in] _a First color.
+/// \param[in] _b Second color.
+/// \return True if all the components are equal.
+bool sameColor(const ignition::math::Color &_a,
+    const ignition::math::Color &_b)
+{
+  return _a.R() == _b.R() && _a.G() == _b.G() && _a.B() == _b.B() &&
+      _a.A() == _b.A();
+}
+
+/// \brief Check whether two PBR workflows are exactly equal.
+/// PbrWorkflow::operator== leaves out the type, the normal map space and
+/// the specular map, and has a tolerance.
+/// \param[in] _a First workflow, or nullptr.
+/// \param[in] _b Second workflow, or nullptr.
+/// \return True if both are nullptr or have the same properties.
+bool sameWorkflow(const PbrWorkflow *_a, const PbrWorkflow *_b)
+{
+  if (!_a || !_b)
+    return _a == _b;
+  return _a->Type() == _b->Type() &&
+      _a->AlbedoMap() == _b->AlbedoMap() &&
+      _a->NormalMap() == _b->NormalMap() &&
+      _a->NormalMapType() == _b->NormalMapType() &&
+      _a->EnvironmentMap() == _b->EnvironmentMap() &&
+      _a->AmbientOcclusionMap() == _b->AmbientOcclusionMap() &&
+      _a->RoughnessMap() == _b->RoughnessMap() &&
+      _a->MetalnessMap() == _b->MetalnessMap() &&
+      _a->EmissiveMap() == _b->EmissiveMap() &&
+      _a->GlossinessMap() == _b->GlossinessMap() &&
+      _a->SpecularMap() == _b->SpecularMap() &&
+      _a->Metalness() == _b->Metalness() &&
+      _a->Roughness() == _b->Roughness() &&
+      _a->Glossiness() == _b->Glossiness();
+}
+
+/// \brief Check whether two materials are exactly equal.
+/// \param[in] _a First material.
+/// \param[in] _b Second material.
+/// \return True if the materials and their PBR workflows are equal.
+bool sameMaterial(const Material &_a, const Material &_b)
+{
+  if (!sameColor(_a.Ambient(), _b.Ambient()) ||
+      !sameColor(_a.Diffuse(), _b.Diffuse()) ||
+      !sameColor(_a.Specular(), _b.Specular()) ||
+      !sameColor(_a.Emissive(), _b.Emissive()) ||
+      _a.Lighting() != _b.Lighting() ||
+      _a.ScriptUri() != _b.ScriptUri() ||
+      _a.ScriptName() != _b.ScriptName() ||
+      _a.Shader() != _b.Shader() ||
+      _a.NormalMap() != _b.NormalMap())
+  {
+    return false;
+  }
+
+  const Pbr *pbrA = _a.PbrMaterial();
+  const Pbr *pbrB = _b.PbrMaterial();
+  if (!pbrA || !pbrB)
+    return pbrA == pbrB;
+  return sameWorkflow(pbrA->Workflow(PbrWorkflowType::METAL),
+          pbrB->Workflow(PbrWorkflowType::METAL)) &&
+      sameWorkflow(pbrA->Workflow(PbrWorkflowType::SPECULAR),
+          pbrB->Workflow(PbrWorkflowType::SPECULAR));
+}
+}
+
+/////////////////////////////////////////////////
+MaterialTable::MaterialTable(const MaterialTable &_table)
+  : byHash(_table.byHash)
+{
+  this->entries.reserve(_table.entries.size());
+  for (const std::shared_ptr<Material> &entry : _table.entries)
+    this->entries.push_back(std::make_shared<Material>(*entry));
+}
+
+/////////////////////////////////////////////////
+MaterialTable &MaterialTable::operator=(const MaterialTable &_table)
+{
+  return *this = MaterialTable(_table);
+}
+
+/////////////////////////////////////////////////
+std::uint64_t MaterialTable::Intern(std::shared_ptr<Material> &_material)
+{
+  const std::uint64_t hash = hashMaterial(*_material);
+  const auto range = this->byHash.equal_range(hash);
+  for (auto iter = range.first; iter != range.second; ++iter)
+  {
+    const std::shared_ptr<Material> &entry = this->entries[iter->second];
+    if (entry == _material || sameMaterial(*entry, *_material))
+    {
+      _material = entry;
+      return iter->second;
+    }
+  }
+
+  const std::uint64_t index = this->entries.size();
+  this->entries.push_back(_material);
+  this->byHash.emplace(hash, index);
+  return index;
+}
+
+/////////////////////////////////////////////////
+std::uint64_t MaterialTable::Count() const
+{
+  return this->entries.size();
+}
+
+/////////////////////////////////////////////////
+const Material *MaterialTable::ByIndex(std::uint64_t _index) const
+{
+  if (_index >= this->entries.size())
+    return nullptr;
+  return this->entries[_index].get();
+}
+
+/////////////////////////////////////////////////
+std::shared_ptr<Material> MaterialTable::Entry(std::uint64_t _index) const
+{
+  if (_index >= this->entries.size())
+    return nullptr;
+  return this->entries[_index];
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_MATERIAL_TABLE_HH_
+#define SDF_MATERIAL_TABLE_HH_
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "sdf/Material.hh"
+#include "sdf/sdf_config.h"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief Table of the distinct materials of a world, with their PBR
+  /// workflows. Visuals with equal materials share one entry of the table.
+  class MaterialTable
+  {
+    /// \brief Default constructor
+    public: MaterialTable() = default;
+
+    /// \brief Copy constructor. The copy has copies of the entries, so that
+    /// changing an entry of one table doesn't change the other.
+    /// \param[in] _table Table to copy.
+    public: MaterialTable(const MaterialTable &_table);
+
+    /// \brief Move constructor
+    /// \param[in] _table Table to move.
+    public: MaterialTable(MaterialTable &&_table) noexcept = default;
+
+    /// \brief Copy assignment operator, which copies the entries.
+    /// \param[in] _table Table to copy.
+    /// \return Reference to this table.
+    public: MaterialTable &operator=(const MaterialTable &_table);
+
+    /// \brief Move assignment operator
+    /// \param[in] _table Table to move.
+    /// \return Reference to this table.
+    public: MaterialTable &operator=(MaterialTable &&_table) noexcept =
+        default;
+
+    /// \brief Find the entry equal to a material, adding the material as a
+    /// new entry if there is none. Materials are equal when all their
+    /// properties and the properties of their PBR workflows are exactly
+    /// equal.
+    /// \param[in,out] _material Material to look up, replaced by its entry.
+    /// \return Index of the entry.
+    public: std::uint64_t Intern(std::shared_ptr<Material> &_material);
+
+    /// \brief Get the number of entries.
+    /// \return Number of entries.
+    public: std::uint64_t Count() const;
+
+    /// \brief Get an entry.
+    /// \param[in] _index Index of the entry, less than Count().
+    /// \return The entry, or nullptr if _index is out of range.
+    public: const Material *ByIndex(std::uint64_t _index) const;
+
+    /// \brief Get an entry, to be held by a visual.
+    /// \param[in] _index Index of the entry.
+    /// \return The entry, or nullptr if _index is out of range.
+    public: std::shared_ptr<Material> Entry(std::uint64_t _index) const;
+
+    /// \brief The entries, in the order they were added.
+    private: std::vector<std::shared_ptr<Material>> entries;
+
+    /// \brief Indices of the entries by the hash of their content.
+    private: std::unordered_multimap<std::uint64_t, std::uint64_t> byHash;
+  };
+  }
+}
+#endif
@@ -0,0 +1,141 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_MEMORY_ACCOUNTING_HH_
+#define SDF_MEMORY_ACCOUNTING_HH_
+
+#include <cstddef>
+#include <string>
+#include <unordered_set>
+
+#include "sdf/MemoryFootprint.hh"
+#include "sdf/sdf_config.h"
+
+/// \ingroup sdf_parser
+/// \brief namespace for Simulation Description Format parser
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  // Forward declarations.
+  class Actor;
+  class Collision;
+  class Frame;
+  class Joint;
+  class Light;
+  class Link;
+  class Model;
+  class Sensor;
+  class Visual;
+  class World;
+  struct FrameAttachedToGraph;
+  struct PoseRelativeToGraph;
+
+  /// \brief Estimated bytes of a node of a std::map or std::set, besides
+  /// its value: three pointers and the color.
+  constexpr std::size_t kTreeNodeBytes = 4 * sizeof(void *);
+
+  /// \brief Estimated bytes of a node of an unordered container, besides
+  /// its value: the next pointer and the cached hash.
+  constexpr std::size_t kHashNodeBytes = sizeof(void *) + sizeof(std::size_t);
+
+  /// \brief Estimated bytes of the control block of a std::shared_ptr made
+  /// with std::make_shared: the vtable pointer and the two counts.
+  constexpr std::size_t kSharedBlockBytes = 2 * sizeof(void *);
+
+  /// \brief Get the heap storage of a string.
+  /// \param[in] _str The string.
+  /// \return Bytes allocated for the characters, or 0 if they are stored in
+  /// the object.
+  inline std::size_t stringHeapBytes(const std::string &_str)
+  {
+    const char *data = _str.data();
+    const char *object = reinterpret_cast<const char *>(&_str);
+    if (data >= object && data < object + sizeof(_str))
+      return 0;
+    return _str.capacity() + 1;
+  }
+
+  /// \brief Get the storage of an unordered map or set, besides the heap
+  /// storage of its keys and values.
+  /// \param[in] _container The container.
+  /// \return Bytes of the buckets and nodes.
+  template <typename Container>
+  std::size_t hashContainerBytes(const Container &_container)
+  {
+    return _container.bucket_count() * sizeof(void *) +
+        _container.size() *
+        (kHashNodeBytes + sizeof(typename Container::value_type));
+  }
+
+  /// \brief Get the size of the private data of a DOM class, which is
+  /// only known in the translation unit of the class.
+  /// \return sizeof the private data class.
+  template <typename T>
+  std::size_t domPrivateSize();
+
+  template <> std::size_t domPrivateSize<Collision>();
+  template <> std::size_t domPrivateSize<Frame>();
+  template <> std::size_t domPrivateSize<Joint>();
+  template <> std::size_t domPrivateSize<Light>();
+  template <> std::size_t domPrivateSize<Link>();
+  template <> std::size_t domPrivateSize<Model>();
+  template <> std::size_t domPrivateSize<Sensor>();
+  template <> std::size_t domPrivateSize<Visual>();
+  template <> std::size_t domPrivateSize<World>();
+
+  /// \brief Get the memory used by a frame attached-to graph.
+  /// \param[in] _graph The graph.
+  /// \return Estimated bytes of the vertices, edges, name map and cache.
+  std::size_t frameGraphBytes(const FrameAttachedToGraph &_graph);
+
+  /// \brief Get the memory used by a pose relative-to graph.
+  /// \param[in] _graph The graph.
+  /// \return Estimated bytes of the vertices, edges, name map and cache.
+  std::size_t frameGraphBytes(const PoseRelativeToGraph &_graph);
+
+  /// \brief Add the DOM objects of a world, except its frame graphs, to a
+  /// footprint.
+  /// \param[in] _world The world.
+  /// \param[in,out] _footprint Footprint to add to.
+  /// \param[in,out] _seen Children shared by model instances that were
+  /// already counted.
+  void addDomFootprint(const World &_world, MemoryFootprint &_footprint,
+      std::unordered_set<const void *> &_seen);
+
+  /// \brief Add the DOM objects of a model and of its nested models to a
+  /// footprint.
+  /// \param[in] _model The model.
+  /// \param[in,out] _footprint Footprint to add to.
+  /// \param[in,out] _seen Children shared by model instances that were
+  /// already counted.
+  void addDomFootprint(const Model &_model, MemoryFootprint &_footprint,
+      std::unordered_set<const void *> &_seen);
+
+  /// \brief Add a light to a footprint.
+  /// \param[in] _light The light.
+  /// \param[in,out] _footprint Footprint to add to.
+  void addDomFootprint(const Light &_light, MemoryFootprint &_footprint);
+
+  /// \brief Add an actor to a footprint.
+  /// \param[in] _actor The actor.
+  /// \param[in,out] _footprint Footprint to add to.
+  void addDomFootprint(const Actor &_actor, MemoryFootprint &_footprint);
+  }
+}
+#endif
@@ -0,0 +1,344 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <cstddef>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <ignition/math/graph/Graph.hh>
+
+#include "sdf/Actor.hh"
+#include "sdf/Collision.hh"
+#include "sdf/Frame.hh"
+#include "sdf/Joint.hh"
+#include "sdf/Light.hh"
+#include "sdf/Link.hh"
+#include "sdf/MemoryFootprint.hh"
+#include "sdf/Model.hh"
+#include "sdf/Physics.hh"
+#include "sdf/Population.hh"
+#include "sdf/Sensor.hh"
+#include "sdf/Visual.hh"
+#include "sdf/World.hh"
+#include "FrameSemantics.hh"
+#include "MemoryAccounting.hh"
+
+using namespace sdf;
+
+/// \brief Private data for sdf::MemoryFootprintReport
+class sdf::MemoryFootprintReportPrivate
+{
+  /// \brief Footprint of the whole document.
+  public: MemoryFootprint total;
+
+  /// \brief Names of the top level models.
+  public: std::vector<std::string> names;
+
+  /// \brief Footprints of the top level models.
+  public: std::vector<MemoryFootprint> models;
+};
+
+/////////////////////////////////////////////////
+std::size_t MemoryFootprint::Total() const
+{
+  return this->elements + this->params + this->descriptions + this->strings +
+      this->domObjects + this->frameGraphs;
+}
+
+/////////////////////////////////////////////////
+MemoryFootprint &MemoryFootprint::operator+=(
+    const MemoryFootprint &_footprint)
+{
+  this->elements += _footprint.elements;
+  this->params += _footprint.params;
+  this->descriptions += _footprint.descriptions;
+  this->strings += _footprint.strings;
+  this->domObjects += _footprint.domObjects;
+  this->frameGraphs += _footprint.frameGraphs;
+  return *this;
+}
+
+/////////////////////////////////////////////////
+MemoryFootprintReport::MemoryFootprintReport()
+  : dataPtr(new MemoryFootprintReportPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+MemoryFootprintReport::MemoryFootprintReport(
+    const MemoryFootprintReport &_report)
+  : dataPtr(new MemoryFootprintReportPrivate(*_report.dataPtr))
+{
+}
+
+/////////////////////////////////////////////////
+MemoryFootprintReport::MemoryFootprintReport(
+    MemoryFootprintReport &&_report) noexcept
+  : dataPtr(std::exchange(_report.dataPtr, nullptr))
+{
+}
+
+/////////////////////////////////////////////////
+MemoryFootprintReport &MemoryFootprintReport::operator=(
+    MemoryFootprintReport &&_report) noexcept
+{
+  std::swap(this->dataPtr, _report.dataPtr);
+  return *this;
+}
+
+/////////////////////////////////////////////////
+MemoryFootprintReport &MemoryFootprintReport::operator=(
+    const MemoryFootprintReport &_report)
+{
+  return *this = MemoryFootprintReport(_report);
+}
+
+/////////////////////////////////////////////////
+MemoryFootprintReport::~MemoryFootprintReport()
+{
+  delete this->dataPtr;
+  this->dataPtr = nullptr;
+}
+
+/////////////////////////////////////////////////
+const MemoryFootprint &MemoryFootprintReport::Total() const
+{
+  return this->dataPtr->total;
+}
+
+/////////////////////////////////////////////////
+void MemoryFootprintReport::SetTotal(const MemoryFootprint &_total)
+{
+  this->dataPtr->total = _total;
+}
+
+/////////////////////////////////////////////////
+std::size_t MemoryFootprintReport::ModelCount() const
+{
+  return this->dataPtr->models.size();
+}
+
+/////////////////////////////////////////////////
+const std::string &MemoryFootprintReport::ModelName(std::size_t _index) const
+{
+  static const std::string kEmpty;
+  if (_index >= this->dataPtr->names.size())
+    return kEmpty;
+  return this->dataPtr->names[_index];
+}
+
+/////////////////////////////////////////////////
+const MemoryFootprint &MemoryFootprintReport::ModelFootprint(
+    std::size_t _index) const
+{
+  static const MemoryFootprint kEmpty;
+  if (_index >= this->dataPtr->models.size())
+    return kEmpty;
+  return this->dataPtr->models[_index];
+}
+
+/////////////////////////////////////////////////
+void MemoryFootprintReport::AddModel(const std::string &_name,
+    const MemoryFootprint &_footprint)
+{
+  this->dataPtr->names.push_back(_name);
+  this->dataPtr->models.push_back(_footprint);
+}
+
+/////////////////////////////////////////////////
+namespace sdf
+{
+inline namespace SDF_VERSION_NAMESPACE {
+std::ostream &operator<<(std::ostream &_out,
+    const MemoryFootprintReport &_report)
+{
+  const MemoryFootprint &total = _report.Total();
+  _out << "total: " << total.Total() << " bytes\n"
+       << "  elements: " << total.elements << " bytes\n"
+       << "  params: " << total.params << " bytes\n"
+       << "  descriptions: " << total.descriptions << " bytes\n"
+       << "  strings: " << total.strings << " bytes\n"
+       << "  dom_objects: " << total.domObjects << " bytes\n"
+       << "  frame_graphs: " << total.frameGraphs << " bytes\n";
+  for (std::size_t i = 0; i < _report.ModelCount(); ++i)
+  {
+    _out << "model " << _report.ModelName(i) << ": "
+         << _report.ModelFootprint(i).Total() << " bytes\n";
+  }
+  return _out;
+}
+
+/////////////////////////////////////////////////
+/// \brief Get the memory used by the vertices and edges of a graph.
+/// \param[in] _graph The graph.
+/// \return Estimated bytes of the vertex and edge maps and of the
+/// adjacency list.
+template <typename V, typename E>
+static std::size_t mathGraphBytes(
+    const ignition::math::graph::DirectedGraph<V, E> &_graph)
+{
+  using ignition::math::graph::DirectedEdge;
+  using ignition::math::graph::EdgeId;
+  using ignition::math::graph::Vertex;
+  using ignition::math::graph::VertexId;
+
+  std::size_t bytes = 0;
+  for (const auto &vertex : _graph.Vertices())
+  {
+    // The vertex map and the adjacency list have a node for each vertex.
+    bytes += 2 * kTreeNodeBytes + 2 * sizeof(VertexId) +
+        sizeof(Vertex<V>) + sizeof(std::set<EdgeId>) +
+        stringHeapBytes(vertex.second.get().Name());
+  }
+
+  // The edge map has a node for each edge, and so has the adjacency set of
+  // its tail vertex.
+  bytes += _graph.Edges().size() *
+      (2 * kTreeNodeBytes + 2 * sizeof(EdgeId) + sizeof(DirectedEdge<E>));
+  return bytes;
+}
+
+/////////////////////////////////////////////////
+/// \brief Get the memory used by the name map of a frame graph.
+/// \param[in] _map The map.
+/// \return Bytes of the map and of its keys.
+template <typename Map>
+static std::size_t nameMapBytes(const Map &_map)
+{
+  std::size_t bytes = hashContainerBytes(_map);
+  for (const auto &entry : _map)
+    bytes += stringHeapBytes(entry.first);
+  return bytes;
+}
+
+/////////////////////////////////////////////////
+std::size_t frameGraphBytes(const FrameAttachedToGraph &_graph)
+{
+  std::size_t bytes = kSharedBlockBytes + sizeof(_graph) +
+      mathGraphBytes(_graph.graph) + nameMapBytes(_graph.map) +
+      stringHeapBytes(_graph.scopeName);
+
+  std::lock_guard<std::mutex> lock(_graph.cache.mutex);
+  bytes += hashContainerBytes(_graph.cache.sinks);
+  return bytes;
+}
+
+/////////////////////////////////////////////////
+std::size_t frameGraphBytes(const PoseRelativeToGraph &_graph)
+{
+  std::size_t bytes = kSharedBlockBytes + sizeof(_graph) +
+      mathGraphBytes(_graph.graph) + nameMapBytes(_graph.map) +
+      stringHeapBytes(_graph.sourceName);
+
+  std::lock_guard<std::mutex> lock(_graph.cache.mutex);
+  bytes += hashContainerBytes(_graph.cache.poses);
+  for (const auto &poses : _graph.cache.poses)
+    bytes += hashContainerBytes(poses.second);
+  return bytes;
+}
+
+/////////////////////////////////////////////////
+/// \brief Add a DOM object that is an element of a vector of its parent to
+/// a footprint.
+/// \param[in] _object The object.
+/// \param[in,out] _footprint Footprint to add to.
+template <typename T>
+static void addDomObject(const T &_object, MemoryFootprint &_footprint)
+{
+  _footprint.domObjects += sizeof(T) + domPrivateSize<T>();
+  _footprint.strings += stringHeapBytes(_object.Name());
+}
+
+/////////////////////////////////////////////////
+/// \brief Add a link and the objects it contains to a footprint.
+/// \param[in] _link The link.
+/// \param[in,out] _footprint Footprint to add to.
+static void addDomFootprint(const Link &_link, MemoryFootprint &_footprint)
+{
+  addDomObject(_link, _footprint);
+  for (const Visual &visual : _link.Visuals())
+    addDomObject(visual, _footprint);
+  for (const Collision &collision : _link.Collisions())
+    addDomObject(collision, _footprint);
+  for (const Light &light : _link.Lights())
+    addDomObject(light, _footprint);
+  for (const Sensor &sensor : _link.Sensors())
+    addDomObject(sensor, _footprint);
+}
+
+/////////////////////////////////////////////////
+void addDomFootprint(const Model &_model, MemoryFootprint &_footprint,
+    std::unordered_set<const void *> &_seen)
+{
+  addDomObject(_model, _footprint);
+
+  // Instances of the same model share their children, so the children are
+  // only counted the first time their storage is seen.
+  const void *children = nullptr;
+  if (!_model.Links().Empty())
+    children = _model.Links().Data();
+  else if (!_model.Models().Empty())
+    children = _model.Models().Data();
+  if (children && !_seen.insert(children).second)
+    return;
+
+  for (const Link &link : _model.Links())
+    addDomFootprint(link, _footprint);
+  for (const Joint &joint : _model.Joints())
+    addDomObject(joint, _footprint);
+  for (const Frame &frame : _model.Frames())
+    addDomObject(frame, _footprint);
+  for (const Model &model : _model.Models())
+    addDomFootprint(model, _footprint, _seen);
+}
+
+/////////////////////////////////////////////////
+void addDomFootprint(const Light &_light, MemoryFootprint &_footprint)
+{
+  addDomObject(_light, _footprint);
+}
+
+/////////////////////////////////////////////////
+void addDomFootprint(const Actor &_actor, MemoryFootprint &_footprint)
+{
+  _footprint.domObjects += sizeof(Actor);
+  _footprint.strings += stringHeapBytes(_actor.Name());
+}
+
+/////////////////////////////////////////////////
+void addDomFootprint(const World &_world, MemoryFootprint &_footprint,
+    std::unordered_set<const void *> &_seen)
+{
+  addDomObject(_world, _footprint);
+  for (const Model &model : _world.Models())
+    addDomFootprint(model, _footprint, _seen);
+  for (const Frame &frame : _world.Frames())
+    addDomObject(frame, _footprint);
+  for (const Light &light : _world.Lights())
+    addDomObject(light, _footprint);
+  for (const Actor &actor : _world.Actors())
+    addDomFootprint(actor, _footprint);
+  _footprint.domObjects += _world.Populations().Size() * sizeof(Population) +
+      _world.PhysicsProfiles().Size() * sizeof(Physics);
+}
+}
+}
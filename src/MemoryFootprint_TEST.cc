@@ -0,0 +1,179 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include "sdf/Element.hh"
+#include "sdf/MemoryFootprint.hh"
+#include "sdf/ParserConfig.hh"
+#include "sdf/Root.hh"
+
+/////////////////////////////////////////////////
+TEST(DOMMemoryFootprint, Footprint)
+{
+  sdf::MemoryFootprint footprint;
+  EXPECT_EQ(0u, footprint.Total());
+
+  footprint.elements = 1;
+  footprint.params = 2;
+  footprint.descriptions = 3;
+  footprint.strings = 4;
+  footprint.domObjects = 5;
+  footprint.frameGraphs = 6;
+  EXPECT_EQ(21u, footprint.Total());
+
+  footprint += footprint;
+  EXPECT_EQ(2u, footprint.elements);
+  EXPECT_EQ(12u, footprint.frameGraphs);
+  EXPECT_EQ(42u, footprint.Total());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMMemoryFootprint, Report)
+{
+  sdf::MemoryFootprintReport report;
+  EXPECT_EQ(0u, report.Total().Total());
+  EXPECT_EQ(0u, report.ModelCount());
+  EXPECT_TRUE(report.ModelName(0).empty());
+  EXPECT_EQ(0u, report.ModelFootprint(0).Total());
+
+  sdf::MemoryFootprint footprint;
+  footprint.strings = 10;
+  report.SetTotal(footprint);
+  report.AddModel("m", footprint);
+  ASSERT_EQ(1u, report.ModelCount());
+  EXPECT_EQ("m", report.ModelName(0));
+  EXPECT_EQ(10u, report.ModelFootprint(0).strings);
+
+  sdf::MemoryFootprintReport copy(report);
+  sdf::MemoryFootprintReport moved(std::move(report));
+  EXPECT_EQ(10u, copy.Total().Total());
+  EXPECT_EQ(1u, moved.ModelCount());
+
+  std::ostringstream stream;
+  stream << copy;
+  EXPECT_NE(std::string::npos, stream.str().find("total: 10 bytes"));
+  EXPECT_NE(std::string::npos, stream.str().find("strings: 10 bytes"));
+  EXPECT_NE(std::string::npos, stream.str().find("model m: 10 bytes"));
+}
+
+/////////////////////////////////////////////////
+TEST(DOMMemoryFootprint, ElementUsage)
+{
+  sdf::ElementPtr elem(new sdf::Element);
+  elem->SetName("parent");
+  const sdf::MemoryFootprint empty = elem->MemoryUsage();
+  EXPECT_GT(empty.elements, 0u);
+  EXPECT_EQ(0u, empty.params);
+  EXPECT_EQ(0u, empty.domObjects);
+  EXPECT_EQ(0u, empty.frameGraphs);
+
+  elem->AddAttribute("name", "string", "", true, "description");
+  sdf::ElementPtr child(new sdf::Element);
+  child->SetName("child");
+  elem->InsertElement(child);
+
+  const sdf::MemoryFootprint usage = elem->MemoryUsage();
+  EXPECT_GT(usage.elements, empty.elements);
+  EXPECT_GT(usage.params, 0u);
+  EXPECT_GT(usage.descriptions, 0u);
+
+  // Long strings are stored on the heap.
+  elem->GetAttribute("name")->Set(std::string(100, 'a'));
+  EXPECT_GE(elem->MemoryUsage().strings, usage.strings + 100u);
+}
+
+/////////////////////////////////////////////////
+TEST(DOMMemoryFootprint, RootReport)
+{
+  const std::string sdfString = R"(
+  <sdf version="1.8">
+    <world name="default">
+      <model name="small">
+        <link name="l"/>
+      </model>
+      <model name="large">
+        <link name="l1">
+          <visual name="v">
+            <geometry><box><size>1 1 1</size></box></geometry>
+          </visual>
+        </link>
+        <link name="l2"/>
+        <link name="l3"/>
+        <joint name="j" type="fixed">
+          <parent>l1</parent>
+          <child>l2</child>
+        </joint>
+      </model>
+    </world>
+  </sdf>)";
+
+  sdf::Root root;
+  ASSERT_TRUE(root.LoadSdfString(sdfString).empty());
+  const sdf::MemoryFootprintReport report = root.MemoryReport();
+
+  const sdf::MemoryFootprint &total = report.Total();
+  EXPECT_GT(total.elements, 0u);
+  EXPECT_GT(total.params, 0u);
+  EXPECT_GT(total.descriptions, 0u);
+  EXPECT_GT(total.domObjects, 0u);
+  EXPECT_GT(total.frameGraphs, 0u);
+
+  ASSERT_EQ(2u, report.ModelCount());
+  EXPECT_EQ("default::small", report.ModelName(0));
+  EXPECT_EQ("default::large", report.ModelName(1));
+  const sdf::MemoryFootprint &small = report.ModelFootprint(0);
+  const sdf::MemoryFootprint &large = report.ModelFootprint(1);
+  EXPECT_GT(small.elements, 0u);
+  EXPECT_GT(large.elements, small.elements);
+  EXPECT_GT(large.domObjects, small.domObjects);
+  EXPECT_EQ(0u, large.frameGraphs);
+  EXPECT_LT(small.elements + large.elements, total.elements);
+  EXPECT_LT(small.domObjects + large.domObjects, total.domObjects);
+
+  // Without the elements, only the DOM objects and graphs are left.
+  sdf::ParserConfig config;
+  config.SetReleaseElements(true);
+  sdf::Root released;
+  ASSERT_TRUE(released.LoadSdfString(sdfString, config).empty());
+  const sdf::MemoryFootprintReport releasedReport = released.MemoryReport();
+  EXPECT_EQ(0u, releasedReport.Total().elements);
+  EXPECT_EQ(total.domObjects, releasedReport.Total().domObjects);
+  EXPECT_EQ(0u, releasedReport.ModelFootprint(1).elements);
+  EXPECT_EQ(large.domObjects, releasedReport.ModelFootprint(1).domObjects);
+}
+
+/////////////////////////////////////////////////
+TEST(DOMMemoryFootprint, RootModel)
+{
+  const std::string sdfString = R"(
+  <sdf version="1.8">
+    <model name="m">
+      <link name="l"/>
+    </model>
+  </sdf>)";
+
+  sdf::Root root;
+  ASSERT_TRUE(root.LoadSdfString(sdfString).empty());
+  const sdf::MemoryFootprintReport report = root.MemoryReport();
+  ASSERT_EQ(1u, report.ModelCount());
+  EXPECT_EQ("m", report.ModelName(0));
+  EXPECT_GT(report.ModelFootprint(0).frameGraphs, 0u);
+  EXPECT_EQ(report.Total().frameGraphs,
+      report.ModelFootprint(0).frameGraphs);
+}
@@ -15,6 +15,8 @@
  *
 */
 #include "sdf/Mesh.hh"
+#include "ElementRetentionScope.hh"
+#include "LoadStatsScope.hh"
 
 using namespace sdf;
 
@@ -87,9 +89,10 @@ Mesh &Mesh::operator=(Mesh &&_mesh)
 /////////////////////////////////////////////////
 Errors Mesh::Load(ElementPtr _sdf)
 {
+  DomLoadTimer timer("Mesh");
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that sdf is a valid pointer
   if (!_sdf)
@@ -214,3 +217,20 @@ void Mesh::SetCenterSubmesh(const bool _center)
 {
   this->dataPtr->centerSubmesh = _center;
 }
+
+/////////////////////////////////////////////////
+std::optional<ignition::math::AxisAlignedBox> Mesh::AxisAlignedBox(
+    const AxisAlignedBoxCalculator &_calculator) const
+{
+  if (!_calculator)
+    return std::nullopt;
+
+  std::optional<ignition::math::AxisAlignedBox> box = _calculator(*this);
+  if (!box)
+    return std::nullopt;
+
+  // The constructor sorts the corners, which a negative scale swaps.
+  const ignition::math::Vector3d scale = this->Scale();
+  return ignition::math::AxisAlignedBox(box->Min() * scale,
+      box->Max() * scale);
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <functional>
+
+#include <ignition/math/Vector3.hh>
+
+#include "ContentHash.hh"
+#include "MeshRegistry.hh"
+
+using namespace sdf;
+
+namespace
+{
+/// \brief Hash the content of a mesh.
+/// \param[in] _mesh Mesh to hash.
+/// \return The hash.
+std::uint64_t hashMesh(const Mesh &_mesh)
+{
+  std::uint64_t hash = hashCombine(0, _mesh.Uri());
+  hash = hashCombine(hash, _mesh.FilePath());
+  hash = hashCombine(hash, _mesh.Submesh());
+  hash = hashCombine(hash, _mesh.CenterSubmesh() ? 1u : 2u);
+  const ignition::math::Vector3d scale = _mesh.Scale();
+  for (const double value : {scale.X(), scale.Y(), scale.Z()})
+    hash = hashCombine(hash, std::hash<double>()(value));
+  return hash;
+}
+
+/// \brief Check whether two meshes are exactly equal.
+/// \param[in] _a First mesh.
+/// \param[in] _b Second mesh.
+/// \return True if the meshes describe the same asset.
+bool sameMesh(const Mesh &_a, const Mesh &_b)
+{
+  const ignition::math::Vector3d scaleA = _a.Scale();
+  const ignition::math::Vector3d scaleB = _b.Scale();
+  return _a.Uri() == _b.Uri() &&
+      _a.FilePath() == _b.FilePath() &&
+      _a.Submesh() == _b.Submesh() &&
+      _a.CenterSubmesh() == _b.CenterSubmesh() &&
+      scaleA.X() == scaleB.X() && scaleA.Y() == scaleB.Y() &&
+      scaleA.Z() == scaleB.Z();
+}
+}
+
+/////////////////////////////////////////////////
+std::uint64_t MeshRegistry::Intern(std::shared_ptr<const Mesh> &_mesh)
+{
+  const std::uint64_t hash = hashMesh(*_mesh);
+  const auto range = this->byHash.equal_range(hash);
+  for (auto iter = range.first; iter != range.second; ++iter)
+  {
+    const std::shared_ptr<const Mesh> &entry = this->entries[iter->second];
+    if (entry == _mesh || sameMesh(*entry, *_mesh))
+    {
+      _mesh = entry;
+      return iter->second;
+    }
+  }
+
+  const std::uint64_t index = this->entries.size();
+  this->entries.push_back(_mesh);
+  this->byHash.emplace(hash, index);
+  return index;
+}
+
+/////////////////////////////////////////////////
+std::uint64_t MeshRegistry::Count() const
+{
+  return this->entries.size();
+}
+
+/////////////////////////////////////////////////
+const Mesh *MeshRegistry::ByIndex(std::uint64_t _index) const
+{
+  if (_index >= this->entries.size())
+    return nullptr;
+  return this->entries[_index].get();
+}
+
+/////////////////////////////////////////////////
+std::uint64_t MeshRegistry::ReferenceCount(std::uint64_t _index) const
+{
+  if (_index >= this->entries.size())
+    return 0;
+  return static_cast<std::uint64_t>(this->entries[_index].use_count()) - 1;
+}
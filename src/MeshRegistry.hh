@@ -0,0 +1,68 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_MESH_REGISTRY_HH_
+#define SDF_MESH_REGISTRY_HH_
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "sdf/Mesh.hh"
+#include "sdf/sdf_config.h"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief Registry of the distinct meshes of a Root. Geometries with
+  /// equal meshes share one entry of the registry.
+  class MeshRegistry
+  {
+    /// \brief Find the entry equal to a mesh, adding the mesh as a new
+    /// entry if there is none. Meshes are equal when they have the same
+    /// URI, file path, scale, submesh and submesh centering.
+    /// \param[in,out] _mesh Mesh to look up, replaced by its entry.
+    /// \return Index of the entry.
+    public: std::uint64_t Intern(std::shared_ptr<const Mesh> &_mesh);
+
+    /// \brief Get the number of entries.
+    /// \return Number of entries.
+    public: std::uint64_t Count() const;
+
+    /// \brief Get an entry.
+    /// \param[in] _index Index of the entry, less than Count().
+    /// \return The entry, or nullptr if _index is out of range.
+    public: const Mesh *ByIndex(std::uint64_t _index) const;
+
+    /// \brief Get the number of holders of an entry, other than the
+    /// registry.
+    /// \param[in] _index Index of the entry, less than Count().
+    /// \return Number of holders, or 0 if _index is out of range.
+    public: std::uint64_t ReferenceCount(std::uint64_t _index) const;
+
+    /// \brief The entries, in the order they were added.
+    private: std::vector<std::shared_ptr<const Mesh>> entries;
+
+    /// \brief Indices of the entries by the hash of their content.
+    private: std::unordered_multimap<std::uint64_t, std::uint64_t> byHash;
+  };
+  }
+}
+#endif
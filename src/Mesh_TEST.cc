@@ -15,6 +15,8 @@
  *
 */
 
+#include <optional>
+#include <string>
 #include <gtest/gtest.h>
 #include "sdf/Mesh.hh"
 
@@ -179,3 +181,32 @@ TEST(DOMMesh, Load)
   EXPECT_NE(std::string::npos, errors[0].Message().find("missing a <uri>"));
   EXPECT_NE(nullptr, mesh.Element());
 }
+
+/////////////////////////////////////////////////
+TEST(DOMMesh, Bounds)
+{
+  sdf::Mesh mesh;
+  mesh.SetUri("banana");
+  mesh.SetScale(ignition::math::Vector3d(2, -1, 1));
+  EXPECT_FALSE(mesh.AxisAlignedBox(nullptr));
+
+  std::string uri;
+  auto calculator = [&uri](const sdf::Mesh &_mesh)
+      -> std::optional<ignition::math::AxisAlignedBox>
+  {
+    uri = _mesh.Uri();
+    return ignition::math::AxisAlignedBox(
+        ignition::math::Vector3d(0, 1, 2), ignition::math::Vector3d(1, 2, 3));
+  };
+  auto box = mesh.AxisAlignedBox(calculator);
+  ASSERT_TRUE(box);
+  EXPECT_EQ("banana", uri);
+  EXPECT_EQ(ignition::math::AxisAlignedBox(
+      ignition::math::Vector3d(0, -2, 2), ignition::math::Vector3d(2, -1, 3)),
+      *box);
+
+  EXPECT_FALSE(mesh.AxisAlignedBox([](const sdf::Mesh &)
+      {
+        return std::optional<ignition::math::AxisAlignedBox>();
+      }));
+}
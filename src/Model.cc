@@ -14,24 +14,360 @@
  * limitations under the License.
  *
 */
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
+#include <ignition/math/Inertial.hh>
 #include <ignition/math/Pose3.hh>
+#include <ignition/math/Quaternion.hh>
+#include <ignition/math/Vector3.hh>
 #include <ignition/math/SemanticVersion.hh>
 #include "sdf/Error.hh"
 #include "sdf/Frame.hh"
 #include "sdf/Joint.hh"
+#include "sdf/JointAxis.hh"
 #include "sdf/Link.hh"
 #include "sdf/Model.hh"
 #include "sdf/Types.hh"
 #include "FrameSemantics.hh"
+#include "LazyModelScope.hh"
+#include "LoadStatsScope.hh"
+#include "MemoryAccounting.hh"
+#include "PoseBatch.hh"
+#include "ResolvedCache.hh"
 #include "ScopedGraph.hh"
+#include "ScopedNameIndex.hh"
+#include "Tracing.hh"
+#include "TrustedInputScope.hh"
 #include "Utils.hh"
 
 using namespace sdf;
 
+/// \brief Canonical link of a model, resolved the first time it is
+/// requested. The link may belong to a nested model, so copies of a model
+/// start unresolved rather than pointing into the links of the original.
+class CanonicalLinkCache
+{
+  /// \brief Constructor.
+  public: CanonicalLinkCache() = default;
+
+  /// \brief Copy constructor, which doesn't copy the resolved link.
+  public: CanonicalLinkCache(const CanonicalLinkCache &)
+  {
+  }
+
+  /// \brief Get the canonical link, resolving it if needed.
+  /// \param[in] _resolve Function that resolves the canonical link.
+  /// \return The canonical link and its name relative to the model.
+  public: template<typename F>
+          const std::pair<const Link *, std::string> &Get(F _resolve) const
+  {
+    if (!this->resolved.load(std::memory_order_acquire))
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      if (!this->resolved.load(std::memory_order_relaxed))
+      {
+        this->linkAndName = _resolve();
+        this->resolved.store(true, std::memory_order_release);
+      }
+    }
+    return this->linkAndName;
+  }
+
+  /// \brief Forget the resolved link, when the model changes.
+  public: void Reset()
+  {
+    this->resolved = false;
+  }
+
+  /// \brief True once linkAndName is resolved.
+  private: mutable std::atomic<bool> resolved{false};
+
+  /// \brief Protects the resolution.
+  private: mutable std::mutex mutex;
+
+  /// \brief Resolved canonical link and relative name.
+  private: mutable std::pair<const Link *, std::string> linkAndName;
+};
+
+/// \brief How a link moves relative to its parent in forward kinematics.
+enum class LinkMotion
+{
+  /// \brief The link doesn't move.
+  FIXED,
+
+  /// \brief The link rotates about an axis.
+  ROTATION,
+
+  /// \brief The link translates along an axis.
+  TRANSLATION,
+};
+
+/// \brief A link in the order that forward kinematics computes them.
+struct ForwardKinematicsLink
+{
+  /// \brief Index of the link.
+  std::size_t link = 0;
+
+  /// \brief Index of the parent link, or kInvalidIndex if the link moves
+  /// relative to the model frame.
+  std::size_t parent = KinematicTopology::kInvalidIndex;
+
+  /// \brief Index of the joint that moves the link.
+  std::size_t joint = KinematicTopology::kInvalidIndex;
+
+  /// \brief How the joint moves the link.
+  LinkMotion motion = LinkMotion::FIXED;
+
+  /// \brief Rotation of the link relative to its parent at zero position,
+  /// as a quaternion w, x, y, z.
+  double rotation[4] = {1, 0, 0, 0};
+
+  /// \brief The same rotation as a row major matrix.
+  double matrix[9] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+
+  /// \brief Position of the link relative to its parent at zero position.
+  double position[3] = {0, 0, 0};
+
+  /// \brief Unit axis of the joint in the link frame. For translations,
+  /// the axis rotated into the parent frame.
+  double axis[3] = {0, 0, 0};
+
+  /// \brief Origin of the joint frame in the link frame.
+  double origin[3] = {0, 0, 0};
+};
+
+/// \brief Joint frames and zero position poses of the links of a model,
+/// for forward kinematics.
+struct ForwardKinematicsData
+{
+  /// \brief The links, parents first.
+  std::vector<ForwardKinematicsLink> links;
+
+  /// \brief Errors found while resolving the data.
+  Errors errors;
+};
+
+/// \brief Poses of the entities of a model and its composite inertials,
+/// for mass properties.
+struct MassPropertiesData
+{
+  /// \brief Pose of each entity relative to the model frame, by scoped
+  /// name, as listed by Model::ResolvePoses.
+  std::unordered_map<std::string, ignition::math::Pose3d> poses;
+
+  /// \brief Composite inertial of the links of the model, relative to the
+  /// model frame.
+  ignition::math::Inertiald links;
+
+  /// \brief Composite inertial of the links of the model and of its nested
+  /// models, relative to the model frame.
+  ignition::math::Inertiald nested;
+
+  /// \brief Errors found while resolving the data.
+  Errors errors;
+};
+
+/// \brief The links, joints, frames and nested models of a model, with their
+/// indices.
+class ModelChildren
+{
+  /// \brief The links specified in this model.
+  public: std::vector<Link> links;
+
+  /// \brief The joints specified in this model.
+  public: std::vector<Joint> joints;
+
+  /// \brief The frames specified in this model.
+  public: std::vector<Frame> frames;
+
+  /// \brief The nested models specified in this model.
+  public: std::vector<Model> models;
+
+  /// \brief Index of the links by name.
+  public: NameIndex linkIndex;
+
+  /// \brief Index of the joints by name.
+  public: NameIndex jointIndex;
+
+  /// \brief Index of the frames by name.
+  public: NameIndex frameIndex;
+
+  /// \brief Index of the nested models by name.
+  public: NameIndex modelIndex;
+
+  /// \brief Index of the entities of nested models by scoped name.
+  public: ScopedNameIndex scopedIndex;
+
+  /// \brief Rebuild the scoped name index from the nested models.
+  public: void BuildScopedIndex()
+  {
+    this->scopedIndex.Clear();
+    for (const auto &model : this->models)
+      this->scopedIndex.AddModel(model, "");
+  }
+
+  /// \brief Rebuild the kinematic tree from the links and joints. The
+  /// links of the joints are resolved through the frame graph of the
+  /// joints if they have one, else taken from their link names.
+  public: void BuildTopology()
+  {
+    const std::size_t none = KinematicTopology::kInvalidIndex;
+    const std::size_t linkCount = this->links.size();
+    const std::size_t jointCount = this->joints.size();
+    KinematicTopology &tree = this->topology;
+    tree = KinematicTopology();
+    this->forwardKinematics.Reset();
+    this->massProperties.Reset();
+    tree.jointParentLink.assign(jointCount, none);
+    tree.jointChildLink.assign(jointCount, none);
+    tree.parentJoint.assign(linkCount, none);
+    tree.parentLink.assign(linkCount, none);
+
+    auto linkByName = [this, none](const std::string &_name)
+    {
+      auto it = this->linkIndex.find(_name);
+      return it == this->linkIndex.end() ? none : it->second;
+    };
+
+    for (std::size_t j = 0; j < jointCount; ++j)
+    {
+      const Joint &joint = this->joints[j];
+      std::string parentName;
+      if (!joint.ResolveParentLink(parentName).empty())
+        parentName = joint.ParentLinkName();
+      std::string childName;
+      if (!joint.ResolveChildLink(childName).empty())
+        childName = joint.ChildLinkName();
+
+      const std::size_t parent = linkByName(parentName);
+      const std::size_t child = linkByName(childName);
+      tree.jointParentLink[j] = parent;
+      tree.jointChildLink[j] = child;
+      if (child == none)
+        continue;
+
+      if (tree.parentJoint[child] != none || child == parent)
+      {
+        tree.loopJoints.push_back(j);
+        continue;
+      }
+      tree.parentJoint[child] = j;
+      tree.parentLink[child] = parent;
+    }
+
+    // Follow the parents of each link up to a root or to a link already
+    // known to reach one. Reaching a link of the current walk again means
+    // the walk went around a loop, which is cut at that link.
+    enum : char { UNVISITED, ON_WALK, DONE };
+    std::vector<char> state(linkCount, UNVISITED);
+    std::vector<std::size_t> walk;
+    for (std::size_t i = 0; i < linkCount; ++i)
+    {
+      std::size_t link = i;
+      while (link != none && state[link] == UNVISITED)
+      {
+        state[link] = ON_WALK;
+        walk.push_back(link);
+        link = tree.parentLink[link];
+      }
+      if (link != none && state[link] == ON_WALK)
+      {
+        tree.loopJoints.push_back(tree.parentJoint[link]);
+        tree.parentJoint[link] = none;
+        tree.parentLink[link] = none;
+      }
+      for (std::size_t visited : walk)
+        state[visited] = DONE;
+      walk.clear();
+    }
+    std::sort(tree.loopJoints.begin(), tree.loopJoints.end());
+
+    // Group the joints to the children of each link.
+    tree.childOffsets.assign(linkCount + 1, 0u);
+    for (std::size_t i = 0; i < linkCount; ++i)
+    {
+      if (tree.parentLink[i] != none)
+        ++tree.childOffsets[tree.parentLink[i] + 1];
+      else
+        tree.rootLinks.push_back(i);
+    }
+    for (std::size_t i = 0; i < linkCount; ++i)
+      tree.childOffsets[i + 1] += tree.childOffsets[i];
+
+    tree.childJoints.resize(tree.childOffsets[linkCount]);
+    std::vector<std::size_t> next(tree.childOffsets.begin(),
+        tree.childOffsets.end() - 1);
+    for (std::size_t j = 0; j < jointCount; ++j)
+    {
+      const std::size_t child = tree.jointChildLink[j];
+      if (child != none && tree.parentJoint[child] == j &&
+          tree.parentLink[child] != none)
+      {
+        tree.childJoints[next[tree.parentLink[child]]++] = j;
+      }
+    }
+
+    // Depth first from each root, children in order.
+    tree.order.reserve(linkCount);
+    std::vector<std::size_t> stack;
+    for (std::size_t root : tree.rootLinks)
+    {
+      stack.push_back(root);
+      while (!stack.empty())
+      {
+        const std::size_t link = stack.back();
+        stack.pop_back();
+        tree.order.push_back(link);
+        for (std::size_t c = tree.childOffsets[link + 1];
+             c > tree.childOffsets[link]; --c)
+        {
+          stack.push_back(tree.jointChildLink[tree.childJoints[c - 1]]);
+        }
+      }
+    }
+  }
+
+  /// \brief Kinematic tree of the links and joints.
+  public: KinematicTopology topology;
+
+  /// \brief Data for Model::ForwardKinematics, resolved from the tree.
+  public: ResolvedCache<ForwardKinematicsData> forwardKinematics;
+
+  /// \brief Data for Model::CompositeInertial, resolved from the pose graph.
+  public: ResolvedCache<MassPropertiesData> massProperties;
+
+  /// \brief True once a model has given its graphs to these children.
+  public: bool claimed = false;
+};
+
+/// \brief Contents of a model loaded with ParserConfig::LazyModels,
+/// which are loaded the first time they are accessed.
+struct LazyContents
+{
+  /// \brief True once the contents are loaded.
+  std::atomic<bool> loaded{false};
+
+  /// \brief Protects the load.
+  std::mutex mutex;
+
+  /// \brief Whether the model was loaded from trusted input.
+  bool trusted = false;
+
+  /// \brief Errors found while loading the contents.
+  Errors errors;
+
+  /// \brief Frame graphs of the scope of the model, built once the
+  /// contents are loaded, or null if the model has no such scope.
+  std::shared_ptr<DeferredGraphs> graphs;
+};
+
 class sdf::ModelPrivate
 {
   /// \brief Name of the model.
@@ -53,6 +389,10 @@ class sdf::ModelPrivate
   /// \brief Name of the canonical link.
   public: std::string canonicalLink = "";
 
+  /// \brief Canonical link resolved from canonicalLink, or chosen when it is
+  /// empty.
+  public: CanonicalLinkCache canonicalLinkCache;
+
   /// \brief Name of the placement frame
   public: std::string placementFrameName = "";
 
@@ -62,17 +402,28 @@ class sdf::ModelPrivate
   /// \brief Frame of the pose.
   public: std::string poseRelativeTo = "";
 
-  /// \brief The links specified in this model.
-  public: std::vector<Link> links;
-
-  /// \brief The joints specified in this model.
-  public: std::vector<Joint> joints;
+  /// \brief Links, joints, frames and nested models of the model. They are
+  /// shared with the models that World loads as instances of this one.
+  public: std::shared_ptr<ModelChildren> children =
+      std::make_shared<ModelChildren>();
 
-  /// \brief The frames specified in this model.
-  public: std::vector<Frame> frames;
+  /// \brief True if this model gives its graphs to its children.
+  public: bool setsChildGraphs = false;
 
-  /// \brief The nested models specified in this model.
-  public: std::vector<Model> models;
+  /// \brief Get whether this model gives its graphs to its children. The
+  /// first model that gives its graphs claims its children, and models that
+  /// share them then leave them the graphs of that model, which resolve the
+  /// same poses since the children are identical.
+  /// \return True if the graphs of this model are given to its children.
+  public: bool SetsChildGraphs()
+  {
+    if (!this->children->claimed)
+    {
+      this->children->claimed = true;
+      this->setsChildGraphs = true;
+    }
+    return this->setsChildGraphs;
+  }
 
   /// \brief The SDF element pointer used during load.
   public: sdf::ElementPtr sdf;
@@ -85,6 +436,18 @@ class sdf::ModelPrivate
 
   /// \brief Scope name of parent Pose Relative-To Graph (world or __model__).
   public: std::string poseGraphScopeVertexName;
+
+  /// \brief State of the contents if they are loaded on first access, or
+  /// null if they were loaded with the model.
+  public: std::shared_ptr<LazyContents> lazy;
+
+  /// \brief Load the contents of a lazy model if they are not loaded yet.
+  public: void LoadLazyContents();
+
+  /// \brief Get the children, after loading the contents of a lazy model
+  /// and building the graphs of its scope.
+  /// \return The children of the model.
+  public: ModelChildren &Children();
 };
 
 /////////////////////////////////////////////////
@@ -104,6 +467,19 @@ Model::~Model()
 Model::Model(const Model &_model)
   : dataPtr(new ModelPrivate(*_model.dataPtr))
 {
+  // The copy has the contents of a lazy model, but not its scope.
+  _model.dataPtr->LoadLazyContents();
+  this->dataPtr->lazy.reset();
+
+  // The copy has its own children, so that the graphs given to either model
+  // don't affect the other.
+  this->dataPtr->children =
+      std::make_shared<ModelChildren>(*_model.dataPtr->children);
+  this->dataPtr->children->claimed = false;
+  this->dataPtr->setsChildGraphs = false;
+
+  // The scoped index points into the nested models, which were copied.
+  this->dataPtr->children->BuildScopedIndex();
 }
 
 /////////////////////////////////////////////////
@@ -126,36 +502,42 @@ Model &Model::operator=(Model &&_model)
 }
 
 /////////////////////////////////////////////////
-Errors Model::Load(ElementPtr _sdf)
+/// \brief Load the properties of a model, which are all that is read from
+/// the element of a model that shares the children of another.
+/// \param[in] _sdf The <model> element.
+/// \param[out] _data Private data of the model.
+/// \param[out] _errors Errors are appended to this.
+/// \return False if _sdf is not a <model>, in which case the children must
+/// not be loaded either.
+static bool loadProperties(ElementPtr _sdf, ModelPrivate &_data,
+    Errors &_errors)
 {
-  Errors errors;
-
-  this->dataPtr->sdf = _sdf;
-  ignition::math::SemanticVersion sdfVersion(_sdf->OriginalVersion());
+  _data.sdf = _sdf;
+  _data.canonicalLinkCache.Reset();
 
   // Check that the provided SDF element is a <model>
   // This is an error that cannot be recovered, so return an error.
   if (_sdf->GetName() != "model")
   {
-    errors.push_back({ErrorCode::ELEMENT_INCORRECT_TYPE,
+    _errors.push_back({ErrorCode::ELEMENT_INCORRECT_TYPE,
         "Attempting to load a Model, but the provided SDF element is not a "
         "<model>."});
-    return errors;
+    return false;
   }
 
   // Read the models's name
-  if (!loadName(_sdf, this->dataPtr->name))
+  if (!loadName(_sdf, _data.name))
   {
-    errors.push_back({ErrorCode::ATTRIBUTE_MISSING,
-                     "A model name is required, but the name is not set."});
+    _errors.push_back({ErrorCode::ATTRIBUTE_MISSING,
+                      "A model name is required, but the name is not set."});
   }
 
   // Check that the model's name is valid
-  if (isReservedName(this->dataPtr->name))
+  if (!TrustedInputScope::Trusted() && isReservedName(_data.name))
   {
-    errors.push_back({ErrorCode::RESERVED_NAME,
-                     "The supplied model name [" + this->dataPtr->name +
-                     "] is reserved."});
+    _errors.push_back({ErrorCode::RESERVED_NAME,
+                      "The supplied model name [" + _data.name +
+                      "] is reserved."});
   }
 
   // Read the model's canonical_link attribute
@@ -164,29 +546,44 @@ Errors Model::Load(ElementPtr _sdf)
     auto pair = _sdf->Get<std::string>("canonical_link", "");
     if (pair.second)
     {
-      this->dataPtr->canonicalLink = pair.first;
+      _data.canonicalLink = pair.first;
     }
   }
 
-  this->dataPtr->placementFrameName = _sdf->Get<std::string>("placement_frame",
-                             this->dataPtr->placementFrameName).first;
+  _data.placementFrameName = _sdf->Get<std::string>("placement_frame",
+                             _data.placementFrameName).first;
 
-  this->dataPtr->isStatic = _sdf->Get<bool>("static", false).first;
+  _data.isStatic = _sdf->Get<bool>("static", false).first;
 
-  this->dataPtr->selfCollide = _sdf->Get<bool>("self_collide", false).first;
+  _data.selfCollide = _sdf->Get<bool>("self_collide", false).first;
 
-  this->dataPtr->allowAutoDisable =
-    _sdf->Get<bool>("allow_auto_disable", true).first;
+  _data.allowAutoDisable = _sdf->Get<bool>("allow_auto_disable", true).first;
 
-  this->dataPtr->enableWind = _sdf->Get<bool>("enable_wind", false).first;
+  _data.enableWind = _sdf->Get<bool>("enable_wind", false).first;
 
   // Load the pose. Ignore the return value since the model pose is optional.
-  loadPose(_sdf, this->dataPtr->pose, this->dataPtr->poseRelativeTo);
+  loadPose(_sdf, _data.pose, _data.poseRelativeTo);
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+/// \brief Load the links, joints, frames and nested models of a model.
+/// \param[in] _sdf The <model> element.
+/// \param[in,out] _data Private data of the model, whose properties are
+/// loaded.
+/// \param[out] _errors Errors are appended to this.
+static void loadContents(ElementPtr _sdf, ModelPrivate &_data,
+    Errors &_errors)
+{
+  ignition::math::SemanticVersion sdfVersion(_sdf->OriginalVersion());
 
-  if (!_sdf->HasUniqueChildNames())
+  ModelChildren &children = *_data.children;
+
+  if (!TrustedInputScope::Trusted() && !_sdf->HasUniqueChildNames())
   {
     sdfwarn << "Non-unique names detected in XML children of model with name["
-            << this->Name() << "].\n";
+            << _data.name << "].\n";
   }
 
   // Set of implicit and explicit frame names in this model for tracking
@@ -195,26 +592,26 @@ Errors Model::Load(ElementPtr _sdf)
 
   // Load nested models.
   Errors nestedModelLoadErrors = loadUniqueRepeated<Model>(_sdf, "model",
-    this->dataPtr->models);
-  errors.insert(errors.end(),
-                nestedModelLoadErrors.begin(),
-                nestedModelLoadErrors.end());
+    children.models);
+  _errors.insert(_errors.end(),
+                 nestedModelLoadErrors.begin(),
+                 nestedModelLoadErrors.end());
 
   // Nested models are loaded first, and loadUniqueRepeated ensures there are no
   // duplicate names, so these names can be added to frameNames without
   // checking uniqueness.
-  for (const auto &model : this->dataPtr->models)
+  for (const auto &model : children.models)
   {
     frameNames.insert(model.Name());
   }
 
   // Load all the links.
   Errors linkLoadErrors = loadUniqueRepeated<Link>(_sdf, "link",
-    this->dataPtr->links);
-  errors.insert(errors.end(), linkLoadErrors.begin(), linkLoadErrors.end());
+    children.links);
+  _errors.insert(_errors.end(), linkLoadErrors.begin(), linkLoadErrors.end());
 
   // Check links for name collisions and modify and warn if so.
-  for (auto &link : this->dataPtr->links)
+  for (auto &link : children.links)
   {
     std::string linkName = link.Name();
     if (frameNames.count(linkName) > 0)
@@ -230,7 +627,7 @@ Errors Model::Load(ElementPtr _sdf)
           linkName = link.Name() + "_link" + std::to_string(i++);
         }
         sdfwarn << "Link with name [" << link.Name() << "] "
-                << "in model with name [" << this->Name() << "] "
+                << "in model with name [" << _data.name << "] "
                 << "has a name collision, changing link name to ["
                 << linkName << "].\n";
         link.SetName(linkName);
@@ -238,7 +635,7 @@ Errors Model::Load(ElementPtr _sdf)
       else
       {
         sdferr << "Link with name [" << link.Name() << "] "
-               << "in model with name [" << this->Name() << "] "
+               << "in model with name [" << _data.name << "] "
                << "has a name collision. Please rename this link.\n";
       }
     }
@@ -248,20 +645,20 @@ Errors Model::Load(ElementPtr _sdf)
   // If the model is not static and has no nested models:
   // Require at least one link so the implicit model frame can be attached to
   // something.
-  if (!this->Static() && this->dataPtr->links.empty() &&
-      this->dataPtr->models.empty())
+  if (!_data.isStatic && children.links.empty() &&
+      children.models.empty())
   {
-    errors.push_back({ErrorCode::MODEL_WITHOUT_LINK,
+    _errors.push_back({ErrorCode::MODEL_WITHOUT_LINK,
                      "A model must have at least one link."});
   }
 
   // Load all the joints.
   Errors jointLoadErrors = loadUniqueRepeated<Joint>(_sdf, "joint",
-    this->dataPtr->joints);
-  errors.insert(errors.end(), jointLoadErrors.begin(), jointLoadErrors.end());
+    children.joints);
+  _errors.insert(_errors.end(), jointLoadErrors.begin(), jointLoadErrors.end());
 
   // Check joints for name collisions and modify and warn if so.
-  for (auto &joint : this->dataPtr->joints)
+  for (auto &joint : children.joints)
   {
     std::string jointName = joint.Name();
     if (frameNames.count(jointName) > 0)
@@ -277,7 +674,7 @@ Errors Model::Load(ElementPtr _sdf)
           jointName = joint.Name() + "_joint" + std::to_string(i++);
         }
         sdfwarn << "Joint with name [" << joint.Name() << "] "
-                << "in model with name [" << this->Name() << "] "
+                << "in model with name [" << _data.name << "] "
                 << "has a name collision, changing joint name to ["
                 << jointName << "].\n";
         joint.SetName(jointName);
@@ -285,7 +682,7 @@ Errors Model::Load(ElementPtr _sdf)
       else
       {
         sdferr << "Joint with name [" << joint.Name() << "] "
-               << "in model with name [" << this->Name() << "] "
+               << "in model with name [" << _data.name << "] "
                << "has a name collision. Please rename this joint.\n";
       }
     }
@@ -294,11 +691,11 @@ Errors Model::Load(ElementPtr _sdf)
 
   // Load all the frames.
   Errors frameLoadErrors = loadUniqueRepeated<Frame>(_sdf, "frame",
-    this->dataPtr->frames);
-  errors.insert(errors.end(), frameLoadErrors.begin(), frameLoadErrors.end());
+    children.frames);
+  _errors.insert(_errors.end(), frameLoadErrors.begin(), frameLoadErrors.end());
 
   // Check frames for name collisions and modify and warn if so.
-  for (auto &frame : this->dataPtr->frames)
+  for (auto &frame : children.frames)
   {
     std::string frameName = frame.Name();
     if (frameNames.count(frameName) > 0)
@@ -314,7 +711,7 @@ Errors Model::Load(ElementPtr _sdf)
           frameName = frame.Name() + "_frame" + std::to_string(i++);
         }
         sdfwarn << "Frame with name [" << frame.Name() << "] "
-                << "in model with name [" << this->Name() << "] "
+                << "in model with name [" << _data.name << "] "
                 << "has a name collision, changing frame name to ["
                 << frameName << "].\n";
         frame.SetName(frameName);
@@ -322,17 +719,148 @@ Errors Model::Load(ElementPtr _sdf)
       else
       {
         sdferr << "Frame with name [" << frame.Name() << "] "
-               << "in model with name [" << this->Name() << "] "
+               << "in model with name [" << _data.name << "] "
                << "has a name collision. Please rename this frame.\n";
       }
     }
     frameNames.insert(frameName);
   }
 
+  // Index the names now that collisions have been renamed.
+  buildNameIndex(children.links, children.linkIndex);
+  buildNameIndex(children.joints, children.jointIndex);
+  buildNameIndex(children.frames, children.frameIndex);
+  buildNameIndex(children.models, children.modelIndex);
+  children.BuildScopedIndex();
+  children.BuildTopology();
+}
+
+/////////////////////////////////////////////////
+void ModelPrivate::LoadLazyContents()
+{
+  if (!this->lazy || this->lazy->loaded.load(std::memory_order_acquire))
+    return;
+
+  std::lock_guard<std::mutex> lock(this->lazy->mutex);
+  if (this->lazy->loaded.load(std::memory_order_relaxed))
+    return;
+
+  SDF_TRACE_SCOPE_TEXT("sdf::Model::LoadContents", this->name);
+  // Nested models are loaded with their parent.
+  TrustedInputScope trustedScope(this->lazy->trusted);
+  LazyModelScope lazyScope(false);
+  loadContents(this->sdf, *this, this->lazy->errors);
+  this->lazy->loaded.store(true, std::memory_order_release);
+}
+
+/////////////////////////////////////////////////
+ModelChildren &ModelPrivate::Children()
+{
+  if (this->lazy)
+  {
+    this->LoadLazyContents();
+    if (this->lazy->graphs)
+      this->lazy->graphs->Build();
+  }
+  return *this->children;
+}
+
+/////////////////////////////////////////////////
+Errors Model::Load(ElementPtr _sdf)
+{
+  SDF_TRACE_SCOPE_TEXT("sdf::Model::Load", _sdf->Get<std::string>("name"));
+  DomLoadTimer timer("Model");
+  Errors errors;
+
+  if (!loadProperties(_sdf, *this->dataPtr, errors))
+    return errors;
+
+  // Load into new children, in case the previous ones are shared.
+  this->dataPtr->children = std::make_shared<ModelChildren>();
+  this->dataPtr->setsChildGraphs = false;
+  this->dataPtr->lazy.reset();
+
+  if (LazyModelScope::Lazy())
+  {
+    this->dataPtr->lazy = std::make_shared<LazyContents>();
+    this->dataPtr->lazy->trusted = TrustedInputScope::Trusted();
+    return errors;
+  }
+
+  loadContents(_sdf, *this->dataPtr, errors);
+  return errors;
+}
+
+/////////////////////////////////////////////////
+Errors Model::LoadInstance(ElementPtr _sdf, const Model &_template)
+{
+  SDF_TRACE_SCOPE_TEXT("sdf::Model::LoadInstance",
+      _sdf->Get<std::string>("name"));
+  Errors errors;
+
+  if (!loadProperties(_sdf, *this->dataPtr, errors))
+    return errors;
+
+  // The children were loaded from an identical subtree by the template, and
+  // any errors in them were reported there.
+  _template.dataPtr->LoadLazyContents();
+  this->dataPtr->children = _template.dataPtr->children;
+  this->dataPtr->setsChildGraphs = false;
+  this->dataPtr->lazy.reset();
+
+  if (!this->Static() && this->dataPtr->children->links.empty() &&
+      this->dataPtr->children->models.empty())
+  {
+    errors.push_back({ErrorCode::MODEL_WITHOUT_LINK,
+                     "A model must have at least one link."});
+  }
 
   return errors;
 }
 
+/////////////////////////////////////////////////
+bool Model::ContentsLoaded() const
+{
+  return !this->dataPtr->lazy ||
+      this->dataPtr->lazy->loaded.load(std::memory_order_acquire);
+}
+
+/////////////////////////////////////////////////
+Errors Model::LoadContents() const
+{
+  this->dataPtr->Children();
+
+  Errors errors;
+  if (this->dataPtr->lazy)
+  {
+    errors = this->dataPtr->lazy->errors;
+    const auto &graphs = this->dataPtr->lazy->graphs;
+    if (graphs && graphs->Built())
+    {
+      errors.insert(errors.end(), graphs->BuildErrors().begin(),
+          graphs->BuildErrors().end());
+    }
+  }
+  return errors;
+}
+
+/////////////////////////////////////////////////
+Errors Model::LoadOwnContents() const
+{
+  if (!this->dataPtr->lazy)
+    return Errors();
+
+  this->dataPtr->LoadLazyContents();
+  return this->dataPtr->lazy->errors;
+}
+
+/////////////////////////////////////////////////
+void Model::SetDeferredGraphs(const std::shared_ptr<DeferredGraphs> &_graphs)
+{
+  if (this->dataPtr->lazy)
+    this->dataPtr->lazy->graphs = _graphs;
+}
+
 /////////////////////////////////////////////////
 std::string Model::Name() const
 {
@@ -396,17 +924,24 @@ void Model::SetEnableWind(const bool _enableWind)
 /////////////////////////////////////////////////
 uint64_t Model::LinkCount() const
 {
-  return this->dataPtr->links.size();
+  return this->dataPtr->Children().links.size();
 }
 
 /////////////////////////////////////////////////
 const Link *Model::LinkByIndex(const uint64_t _index) const
 {
-  if (_index < this->dataPtr->links.size())
-    return &this->dataPtr->links[_index];
+  if (_index < this->dataPtr->Children().links.size())
+    return &this->dataPtr->Children().links[_index];
   return nullptr;
 }
 
+/////////////////////////////////////////////////
+Span<const Link> Model::Links() const
+{
+  const auto &links = this->dataPtr->Children().links;
+  return {links.data(), links.size()};
+}
+
 /////////////////////////////////////////////////
 bool Model::LinkNameExists(const std::string &_name) const
 {
@@ -416,17 +951,24 @@ bool Model::LinkNameExists(const std::string &_name) const
 /////////////////////////////////////////////////
 uint64_t Model::JointCount() const
 {
-  return this->dataPtr->joints.size();
+  return this->dataPtr->Children().joints.size();
 }
 
 /////////////////////////////////////////////////
 const Joint *Model::JointByIndex(const uint64_t _index) const
 {
-  if (_index < this->dataPtr->joints.size())
-    return &this->dataPtr->joints[_index];
+  if (_index < this->dataPtr->Children().joints.size())
+    return &this->dataPtr->Children().joints[_index];
   return nullptr;
 }
 
+/////////////////////////////////////////////////
+Span<const Joint> Model::Joints() const
+{
+  const auto &joints = this->dataPtr->Children().joints;
+  return {joints.data(), joints.size()};
+}
+
 /////////////////////////////////////////////////
 bool Model::JointNameExists(const std::string &_name) const
 {
@@ -439,6 +981,14 @@ const Joint *Model::JointByName(const std::string &_name) const
   auto index = _name.rfind("::");
   if (index != std::string::npos)
   {
+    const Joint *scoped =
+        ScopedNameIndex::Find(
+            this->dataPtr->Children().scopedIndex.joints, _name);
+    if (nullptr != scoped)
+    {
+      return scoped;
+    }
+
     const Model *model = this->ModelByName(_name.substr(0, index));
     if (nullptr != model)
     {
@@ -452,30 +1002,31 @@ const Joint *Model::JointByName(const std::string &_name) const
     // return nullptr;
   }
 
-  for (auto const &j : this->dataPtr->joints)
-  {
-    if (j.Name() == _name)
-    {
-      return &j;
-    }
-  }
-  return nullptr;
+  return findByName(this->dataPtr->Children().joints,
+      this->dataPtr->Children().jointIndex, _name);
 }
 
 /////////////////////////////////////////////////
 uint64_t Model::FrameCount() const
 {
-  return this->dataPtr->frames.size();
+  return this->dataPtr->Children().frames.size();
 }
 
 /////////////////////////////////////////////////
 const Frame *Model::FrameByIndex(const uint64_t _index) const
 {
-  if (_index < this->dataPtr->frames.size())
-    return &this->dataPtr->frames[_index];
+  if (_index < this->dataPtr->Children().frames.size())
+    return &this->dataPtr->Children().frames[_index];
   return nullptr;
 }
 
+/////////////////////////////////////////////////
+Span<const Frame> Model::Frames() const
+{
+  const auto &frames = this->dataPtr->Children().frames;
+  return {frames.data(), frames.size()};
+}
+
 /////////////////////////////////////////////////
 bool Model::FrameNameExists(const std::string &_name) const
 {
@@ -488,6 +1039,14 @@ const Frame *Model::FrameByName(const std::string &_name) const
   auto index = _name.rfind("::");
   if (index != std::string::npos)
   {
+    const Frame *scoped =
+        ScopedNameIndex::Find(
+            this->dataPtr->Children().scopedIndex.frames, _name);
+    if (nullptr != scoped)
+    {
+      return scoped;
+    }
+
     const Model *model = this->ModelByName(_name.substr(0, index));
     if (nullptr != model)
     {
@@ -501,30 +1060,31 @@ const Frame *Model::FrameByName(const std::string &_name) const
     // return nullptr;
   }
 
-  for (auto const &f : this->dataPtr->frames)
-  {
-    if (f.Name() == _name)
-    {
-      return &f;
-    }
-  }
-  return nullptr;
+  return findByName(this->dataPtr->Children().frames,
+      this->dataPtr->Children().frameIndex, _name);
 }
 
 /////////////////////////////////////////////////
 uint64_t Model::ModelCount() const
 {
-  return this->dataPtr->models.size();
+  return this->dataPtr->Children().models.size();
 }
 
 /////////////////////////////////////////////////
 const Model *Model::ModelByIndex(const uint64_t _index) const
 {
-  if (_index < this->dataPtr->models.size())
-    return &this->dataPtr->models[_index];
+  if (_index < this->dataPtr->Children().models.size())
+    return &this->dataPtr->Children().models[_index];
   return nullptr;
 }
 
+/////////////////////////////////////////////////
+Span<const Model> Model::Models() const
+{
+  const auto &models = this->dataPtr->Children().models;
+  return {models.data(), models.size()};
+}
+
 /////////////////////////////////////////////////
 bool Model::ModelNameExists(const std::string &_name) const
 {
@@ -535,18 +1095,21 @@ bool Model::ModelNameExists(const std::string &_name) const
 const Model *Model::ModelByName(const std::string &_name) const
 {
   auto index = _name.find("::");
-  const std::string nextModelName = _name.substr(0, index);
-  const Model *nextModel = nullptr;
-
-  for (auto const &m : this->dataPtr->models)
+  if (index != std::string::npos)
   {
-    if (m.Name() == nextModelName)
+    const Model *scoped =
+        ScopedNameIndex::Find(
+            this->dataPtr->Children().scopedIndex.models, _name);
+    if (nullptr != scoped)
     {
-      nextModel = &m;
-      break;
+      return scoped;
     }
   }
 
+  const std::string nextModelName = _name.substr(0, index);
+  const Model *nextModel = findByName(this->dataPtr->Children().models,
+      this->dataPtr->Children().modelIndex, nextModelName);
+
   if (nullptr != nextModel && index != std::string::npos)
   {
     return nextModel->ModelByName(_name.substr(index + 2));
@@ -561,20 +1124,24 @@ const Link *Model::CanonicalLink() const
 }
 
 /////////////////////////////////////////////////
-std::pair<const Link*, std::string> Model::CanonicalLinkAndRelativeName() const
+/// \brief Find the canonical link of a model, without its cache.
+/// \param[in] _model Model to find the canonical link of.
+/// \return The canonical link and its name relative to the model.
+static std::pair<const Link*, std::string> resolveCanonicalLink(
+    const Model &_model)
 {
-  if (this->CanonicalLinkName().empty())
+  if (_model.CanonicalLinkName().empty())
   {
-    if (this->LinkCount() > 0)
+    if (_model.LinkCount() > 0)
     {
-      auto firstLink = this->LinkByIndex(0);
+      auto firstLink = _model.LinkByIndex(0);
       return std::make_pair(firstLink, firstLink->Name());
     }
-    else if (this->ModelCount() > 0)
+    else if (_model.ModelCount() > 0)
     {
       // Recursively choose the canonical link of the first nested model
       // (depth first search).
-      auto firstModel = this->ModelByIndex(0);
+      auto firstModel = _model.ModelByIndex(0);
       auto canonicalLinkAndName = firstModel->CanonicalLinkAndRelativeName();
       // Prepend firstModelName if a valid link is found.
       if (nullptr != canonicalLinkAndName.first)
@@ -591,9 +1158,49 @@ std::pair<const Link*, std::string> Model::CanonicalLinkAndRelativeName() const
   }
   else
   {
-    return std::make_pair(this->LinkByName(this->CanonicalLinkName()),
-                          this->CanonicalLinkName());
+    return std::make_pair(_model.LinkByName(_model.CanonicalLinkName()),
+                          _model.CanonicalLinkName());
+  }
+}
+
+/////////////////////////////////////////////////
+std::pair<const Link*, std::string> Model::CanonicalLinkAndRelativeName() const
+{
+  return this->dataPtr->canonicalLinkCache.Get([this]()
+  {
+    return resolveCanonicalLink(*this);
+  });
+}
+
+/////////////////////////////////////////////////
+Errors Model::ResolvePoses(std::vector<ignition::math::Pose3d> &_poses,
+    std::vector<std::string> &_names) const
+{
+  Errors errors;
+  _poses.clear();
+  _names.clear();
+
+  if (!this->dataPtr->poseGraph)
+  {
+    errors.push_back({ErrorCode::POSE_RELATIVE_TO_GRAPH_ERROR,
+        "Model has invalid pointer to PoseRelativeToGraph."});
+    return errors;
   }
+
+  auto graph = this->dataPtr->poseGraph.ChildModelScope(this->Name());
+  ResolvedVertexPoses resolved;
+  errors = resolveAllPosesRelativeToRoot(resolved, graph);
+  appendModelPoses(*this, "", graph, resolved, _poses, _names, errors);
+  return errors;
+}
+
+/////////////////////////////////////////////////
+PoseGraphSnapshot Model::PoseSnapshot() const
+{
+  if (!this->dataPtr->poseGraph)
+    return PoseGraphSnapshot();
+  return PoseGraphSnapshot(
+      this->dataPtr->poseGraph.ChildModelScope(this->Name()));
 }
 
 /////////////////////////////////////////////////
@@ -606,6 +1213,7 @@ const std::string &Model::CanonicalLinkName() const
 void Model::SetCanonicalLinkName(const std::string &_canonicalLink)
 {
   this->dataPtr->canonicalLink = _canonicalLink;
+  this->dataPtr->canonicalLinkCache.Reset();
 }
 
 /////////////////////////////////////////////////
@@ -651,46 +1259,423 @@ void Model::SetPoseRelativeToGraph(sdf::ScopedGraph<PoseRelativeToGraph> _graph)
   this->dataPtr->poseGraphScopeVertexName =
       _graph.VertexLocalName(_graph.ScopeVertexId());
 
+  if (!this->dataPtr->SetsChildGraphs())
+    return;
+  this->dataPtr->Children().forwardKinematics.Reset();
+  this->dataPtr->Children().massProperties.Reset();
+
   auto childPoseGraph =
       this->dataPtr->poseGraph.ChildModelScope(this->Name());
-  for (auto &model : this->dataPtr->models)
+  for (auto &model : this->dataPtr->Children().models)
   {
     model.SetPoseRelativeToGraph(childPoseGraph);
   }
-  for (auto &link : this->dataPtr->links)
+  for (auto &link : this->dataPtr->Children().links)
   {
     link.SetPoseRelativeToGraph(childPoseGraph);
   }
-  for (auto &joint : this->dataPtr->joints)
+  for (auto &joint : this->dataPtr->Children().joints)
   {
     joint.SetPoseRelativeToGraph(childPoseGraph);
   }
-  for (auto &frame : this->dataPtr->frames)
+  for (auto &frame : this->dataPtr->Children().frames)
   {
     frame.SetPoseRelativeToGraph(childPoseGraph);
   }
 }
 
+/////////////////////////////////////////////////
+void Model::ResetPoseCaches()
+{
+  this->dataPtr->Children().forwardKinematics.Reset();
+  this->dataPtr->Children().massProperties.Reset();
+  for (auto &model : this->dataPtr->Children().models)
+    model.ResetPoseCaches();
+}
+
+/////////////////////////////////////////////////
+void Model::ShareMaterials(MaterialTable &_table)
+{
+  for (auto &link : this->dataPtr->Children().links)
+    link.ShareMaterials(_table);
+  for (auto &model : this->dataPtr->Children().models)
+    model.ShareMaterials(_table);
+}
+
+/////////////////////////////////////////////////
+void Model::UseMaterialCopies(const MaterialTable &_table)
+{
+  for (auto &link : this->dataPtr->Children().links)
+    link.UseMaterialCopies(_table);
+  for (auto &model : this->dataPtr->Children().models)
+    model.UseMaterialCopies(_table);
+}
+
+/////////////////////////////////////////////////
+void Model::ShareMeshes(MeshRegistry &_registry)
+{
+  for (auto &link : this->dataPtr->Children().links)
+    link.ShareMeshes(_registry);
+  for (auto &model : this->dataPtr->Children().models)
+    model.ShareMeshes(_registry);
+}
+
 /////////////////////////////////////////////////
 void Model::SetFrameAttachedToGraph(
     sdf::ScopedGraph<FrameAttachedToGraph> _graph)
 {
   this->dataPtr->frameAttachedToGraph = _graph;
 
+  if (!this->dataPtr->SetsChildGraphs())
+    return;
+
   auto childFrameAttachedToGraph =
       this->dataPtr->frameAttachedToGraph.ChildModelScope(this->Name());
-  for (auto &joint : this->dataPtr->joints)
+  for (auto &joint : this->dataPtr->Children().joints)
   {
     joint.SetFrameAttachedToGraph(childFrameAttachedToGraph);
   }
-  for (auto &frame : this->dataPtr->frames)
+  for (auto &frame : this->dataPtr->Children().frames)
   {
     frame.SetFrameAttachedToGraph(childFrameAttachedToGraph);
   }
-  for (auto &model : this->dataPtr->models)
+  for (auto &model : this->dataPtr->Children().models)
   {
     model.SetFrameAttachedToGraph(childFrameAttachedToGraph);
   }
+
+  // Joints can now be resolved through frames.
+  this->dataPtr->Children().BuildTopology();
+}
+
+/////////////////////////////////////////////////
+const KinematicTopology &Model::Topology() const
+{
+  return this->dataPtr->Children().topology;
+}
+
+/////////////////////////////////////////////////
+/// \brief Resolve the data of forward kinematics.
+/// \param[in] _model The model.
+/// \param[in] _children Children of the model.
+/// \return The links, parents first, with their joint frames.
+static ForwardKinematicsData resolveForwardKinematics(
+    const Model &_model, const ModelChildren &_children)
+{
+  using ignition::math::Pose3d;
+  using ignition::math::Quaterniond;
+  using ignition::math::Vector3d;
+  const std::size_t none = KinematicTopology::kInvalidIndex;
+  const KinematicTopology &tree = _children.topology;
+
+  ForwardKinematicsData data;
+  std::vector<Pose3d> poses;
+  std::vector<std::string> names;
+  data.errors = _model.ResolvePoses(poses, names);
+  std::unordered_map<std::string, std::size_t> poseIndex;
+  for (std::size_t i = 0; i < names.size(); ++i)
+    poseIndex.emplace(names[i], i);
+  auto poseOf = [&](const std::string &_name)
+  {
+    auto it = poseIndex.find(_name);
+    return it == poseIndex.end() ? Pose3d::Zero : poses[it->second];
+  };
+
+  data.links.reserve(tree.order.size());
+  for (std::size_t link : tree.order)
+  {
+    ForwardKinematicsLink entry;
+    entry.link = link;
+    entry.parent = tree.parentLink[link];
+    entry.joint = tree.parentJoint[link];
+
+    const Pose3d pose = poseOf(_children.links[link].Name());
+    const Pose3d parentPose = entry.parent == none ? Pose3d::Zero :
+      poseOf(_children.links[entry.parent].Name());
+    const Quaterniond rotation = parentPose.Rot().Inverse() * pose.Rot();
+    const Vector3d position =
+      parentPose.Rot().RotateVectorReverse(pose.Pos() - parentPose.Pos());
+    entry.rotation[0] = rotation.W();
+    entry.rotation[1] = rotation.X();
+    entry.rotation[2] = rotation.Y();
+    entry.rotation[3] = rotation.Z();
+    for (int i = 0; i < 3; ++i)
+    {
+      const Vector3d column = rotation.RotateVector(
+          Vector3d(i == 0, i == 1, i == 2));
+      for (int j = 0; j < 3; ++j)
+        entry.matrix[j * 3 + i] = column[j];
+      entry.position[i] = position[i];
+    }
+
+    if (entry.joint != none)
+    {
+      const Joint &joint = _children.joints[entry.joint];
+      switch (joint.Type())
+      {
+        case JointType::REVOLUTE:
+        case JointType::CONTINUOUS:
+          entry.motion = LinkMotion::ROTATION;
+          break;
+        case JointType::PRISMATIC:
+          entry.motion = LinkMotion::TRANSLATION;
+          break;
+        case JointType::FIXED:
+          break;
+        default:
+          data.errors.push_back({ErrorCode::ATTRIBUTE_INVALID,
+              "Joint [" + joint.Name() + "] has a type that forward "
+              "kinematics doesn't support, and is treated as fixed."});
+          break;
+      }
+
+      Vector3d axis;
+      if (entry.motion != LinkMotion::FIXED)
+      {
+        const JointAxis *jointAxis = joint.Axis(0);
+        Errors axisErrors;
+        if (jointAxis)
+        {
+          axisErrors = jointAxis->ResolveXyz(axis,
+              _children.links[link].Name());
+        }
+        if (!jointAxis || !axisErrors.empty() || axis.Length() <= 0)
+        {
+          data.errors.push_back({ErrorCode::ELEMENT_INVALID,
+              "Joint [" + joint.Name() + "] has no axis in the frame of its "
+              "child link, and is treated as fixed."});
+          data.errors.insert(data.errors.end(), axisErrors.begin(),
+              axisErrors.end());
+          entry.motion = LinkMotion::FIXED;
+        }
+        axis.Normalize();
+      }
+
+      // Translations are applied in the parent frame, rotations about the
+      // joint origin in the link frame.
+      if (entry.motion == LinkMotion::TRANSLATION)
+        axis = rotation.RotateVector(axis);
+      const Vector3d origin = pose.Rot().RotateVectorReverse(
+          poseOf(joint.Name()).Pos() - pose.Pos());
+      for (int i = 0; i < 3; ++i)
+      {
+        entry.axis[i] = axis[i];
+        entry.origin[i] = origin[i];
+      }
+    }
+    data.links.push_back(entry);
+  }
+  return data;
+}
+
+/////////////////////////////////////////////////
+Errors Model::ForwardKinematics(const std::vector<double> &_positions,
+    std::size_t _count, std::vector<ignition::math::Pose3d> &_poses) const
+{
+  _poses.clear();
+  const ModelChildren &children = this->dataPtr->Children();
+  if (_positions.size() != children.joints.size() * _count)
+  {
+    return {Error(ErrorCode::ELEMENT_INVALID,
+        "Forward kinematics of model [" + this->Name() + "] expects " +
+        std::to_string(children.joints.size() * _count) +
+        " joint positions, got " + std::to_string(_positions.size()) + ".")};
+  }
+
+  const ForwardKinematicsData &data = children.forwardKinematics.Get(
+      [this, &children]()
+      {
+        return resolveForwardKinematics(*this, children);
+      });
+
+  // The rotation w, x, y, z and position x, y, z of each link, for every
+  // configuration.
+  const std::size_t linkCount = children.links.size();
+  std::vector<double> state(linkCount * 7 * _count);
+  auto column = [&](std::size_t _link, int _component)
+  {
+    return state.data() + (_link * 7 + _component) * _count;
+  };
+
+  for (const ForwardKinematicsLink &entry : data.links)
+  {
+    double *qw = column(entry.link, 0);
+    double *qx = column(entry.link, 1);
+    double *qy = column(entry.link, 2);
+    double *qz = column(entry.link, 3);
+    double *px = column(entry.link, 4);
+    double *py = column(entry.link, 5);
+    double *pz = column(entry.link, 6);
+    const double *r = entry.rotation;
+    const double *m = entry.matrix;
+    const double *p = entry.position;
+    const double *a = entry.axis;
+    const double *o = entry.origin;
+
+    // Pose relative to the parent.
+    switch (entry.motion)
+    {
+      case LinkMotion::FIXED:
+        for (std::size_t k = 0; k < _count; ++k)
+        {
+          qw[k] = r[0];
+          qx[k] = r[1];
+          qy[k] = r[2];
+          qz[k] = r[3];
+          px[k] = p[0];
+          py[k] = p[1];
+          pz[k] = p[2];
+        }
+        break;
+      case LinkMotion::TRANSLATION:
+      {
+        const double *q = _positions.data() + entry.joint * _count;
+        for (std::size_t k = 0; k < _count; ++k)
+        {
+          qw[k] = r[0];
+          qx[k] = r[1];
+          qy[k] = r[2];
+          qz[k] = r[3];
+          px[k] = p[0] + a[0] * q[k];
+          py[k] = p[1] + a[1] * q[k];
+          pz[k] = p[2] + a[2] * q[k];
+        }
+        break;
+      }
+      case LinkMotion::ROTATION:
+      {
+        const double *q = _positions.data() + entry.joint * _count;
+        for (std::size_t k = 0; k < _count; ++k)
+        {
+          const double s = std::sin(0.5 * q[k]);
+          const double c = std::cos(0.5 * q[k]);
+          const double vx = a[0] * s;
+          const double vy = a[1] * s;
+          const double vz = a[2] * s;
+
+          // Rotating about the origin moves the link by o - R o.
+          const double tx = 2 * (vy * o[2] - vz * o[1]);
+          const double ty = 2 * (vz * o[0] - vx * o[2]);
+          const double tz = 2 * (vx * o[1] - vy * o[0]);
+          const double dx = -(c * tx + vy * tz - vz * ty);
+          const double dy = -(c * ty + vz * tx - vx * tz);
+          const double dz = -(c * tz + vx * ty - vy * tx);
+
+          qw[k] = r[0] * c - r[1] * vx - r[2] * vy - r[3] * vz;
+          qx[k] = r[0] * vx + r[1] * c + r[2] * vz - r[3] * vy;
+          qy[k] = r[0] * vy - r[1] * vz + r[2] * c + r[3] * vx;
+          qz[k] = r[0] * vz + r[1] * vy - r[2] * vx + r[3] * c;
+          px[k] = p[0] + m[0] * dx + m[1] * dy + m[2] * dz;
+          py[k] = p[1] + m[3] * dx + m[4] * dy + m[5] * dz;
+          pz[k] = p[2] + m[6] * dx + m[7] * dy + m[8] * dz;
+        }
+        break;
+      }
+    }
+
+    if (entry.parent == KinematicTopology::kInvalidIndex)
+      continue;
+
+    // Compose with the pose of the parent, which comes first in the order.
+    const PoseArrays link{qw, qx, qy, qz, px, py, pz};
+    const ConstPoseArrays parent(PoseArrays{column(entry.parent, 0),
+        column(entry.parent, 1), column(entry.parent, 2),
+        column(entry.parent, 3), column(entry.parent, 4),
+        column(entry.parent, 5), column(entry.parent, 6)});
+    composePoses(_count, parent, link, link);
+  }
+
+  _poses.resize(linkCount * _count);
+  for (std::size_t i = 0; i < linkCount; ++i)
+  {
+    for (std::size_t k = 0; k < _count; ++k)
+    {
+      _poses[i * _count + k] = ignition::math::Pose3d(
+          column(i, 4)[k], column(i, 5)[k], column(i, 6)[k],
+          column(i, 0)[k], column(i, 1)[k], column(i, 2)[k], column(i, 3)[k]);
+    }
+  }
+  return data.errors;
+}
+
+/////////////////////////////////////////////////
+/// \brief Resolve the data of mass properties.
+/// \param[in] _model The model.
+/// \return The poses of the entities of the model, and the composite
+/// inertials of its links with and without nested models.
+static MassPropertiesData resolveMassProperties(const Model &_model)
+{
+  MassPropertiesData data;
+  std::vector<ignition::math::Pose3d> poses;
+  std::vector<std::string> names;
+  data.errors = _model.ResolvePoses(poses, names);
+  for (std::size_t i = 0; i < names.size(); ++i)
+    data.poses.emplace(std::move(names[i]), poses[i]);
+
+  // Add the inertial of a link, moved to the model frame.
+  auto add = [&data](ignition::math::Inertiald &_total, const Link &_link,
+      const std::string &_scope)
+  {
+    ignition::math::Inertiald inertial = _link.Inertial();
+    auto it = data.poses.find(_scope + _link.Name());
+    if (inertial.MassMatrix().Mass() <= 0 || it == data.poses.end())
+      return;
+    inertial.SetPose(it->second * inertial.Pose());
+    _total += inertial;
+  };
+
+  for (uint64_t i = 0; i < _model.LinkCount(); ++i)
+    add(data.links, *_model.LinkByIndex(i), "");
+
+  data.nested = data.links;
+  std::vector<std::pair<const Model *, std::string>> stack;
+  for (uint64_t i = 0; i < _model.ModelCount(); ++i)
+  {
+    const Model *nested = _model.ModelByIndex(i);
+    stack.emplace_back(nested, nested->Name() + "::");
+  }
+  while (!stack.empty())
+  {
+    const Model *model = stack.back().first;
+    const std::string scope = std::move(stack.back().second);
+    stack.pop_back();
+    for (uint64_t i = 0; i < model->LinkCount(); ++i)
+      add(data.nested, *model->LinkByIndex(i), scope);
+    for (uint64_t i = 0; i < model->ModelCount(); ++i)
+    {
+      const Model *nested = model->ModelByIndex(i);
+      stack.emplace_back(nested, scope + nested->Name() + "::");
+    }
+  }
+  return data;
+}
+
+/////////////////////////////////////////////////
+Errors Model::CompositeInertial(ignition::math::Inertiald &_inertial,
+    const std::string &_frame, bool _nested) const
+{
+  const MassPropertiesData &data =
+    this->dataPtr->Children().massProperties.Get([this]()
+    {
+      return resolveMassProperties(*this);
+    });
+
+  Errors errors = data.errors;
+  _inertial = _nested ? data.nested : data.links;
+  if (_frame.empty() || _frame == "__model__")
+    return errors;
+
+  auto it = data.poses.find(_frame);
+  if (it == data.poses.end())
+  {
+    errors.push_back({ErrorCode::POSE_RELATIVE_TO_INVALID,
+        "Unable to express the composite inertial of model [" +
+        this->Name() + "] in frame [" + _frame + "], which is not in the "
+        "model."});
+    return errors;
+  }
+  _inertial.SetPose(it->second.Inverse() * _inertial.Pose());
+  return errors;
 }
 
 /////////////////////////////////////////////////
@@ -710,6 +1695,14 @@ const Link *Model::LinkByName(const std::string &_name) const
   auto index = _name.rfind("::");
   if (index != std::string::npos)
   {
+    const Link *scoped =
+        ScopedNameIndex::Find(
+            this->dataPtr->Children().scopedIndex.links, _name);
+    if (nullptr != scoped)
+    {
+      return scoped;
+    }
+
     const Model *model = this->ModelByName(_name.substr(0, index));
     if (nullptr != model)
     {
@@ -723,14 +1716,8 @@ const Link *Model::LinkByName(const std::string &_name) const
     // return nullptr;
   }
 
-  for (auto const &l : this->dataPtr->links)
-  {
-    if (l.Name() == _name)
-    {
-      return &l;
-    }
-  }
-  return nullptr;
+  return findByName(this->dataPtr->Children().links,
+      this->dataPtr->Children().linkIndex, _name);
 }
 
 /////////////////////////////////////////////////
@@ -738,3 +1725,22 @@ sdf::ElementPtr Model::Element() const
 {
   return this->dataPtr->sdf;
 }
+
+/////////////////////////////////////////////////
+void Model::ReleaseElement()
+{
+  // The contents of a lazy model are loaded from its element.
+  if (!this->ContentsLoaded())
+    return;
+
+  this->dataPtr->sdf.reset();
+  for (Model &model : this->dataPtr->Children().models)
+    model.ReleaseElement();
+}
+
+/////////////////////////////////////////////////
+template <>
+std::size_t sdf::domPrivateSize<Model>()
+{
+  return sizeof(ModelPrivate);
+}
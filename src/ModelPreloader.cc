@@ -0,0 +1,177 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <utility>
+
+#include "DiagnosticScope.hh"
+#include "ElementReclaimer.hh"
+#include "ElementRetentionScope.hh"
+#include "ExecutorScope.hh"
+#include "LoadStatsScope.hh"
+#include "ModelPreloader.hh"
+#include "TrustedInputScope.hh"
+
+using namespace sdf;
+
+/////////////////////////////////////////////////
+ModelPreloader::ModelPreloader(const ParserConfig &_config)
+  : state(std::make_shared<State>())
+{
+  this->state->executor = _config.LoadExecutor() ?
+      _config.LoadExecutor() : Executor::Default();
+  this->state->releaseElements = _config.ReleaseElements();
+  this->state->trusted = _config.TrustedInput();
+  this->state->workerCount = _config.LoadThreadCount();
+  if (this->state->workerCount == 0)
+    this->state->workerCount = this->state->executor->Concurrency();
+  this->state->workerCount =
+      std::max<std::size_t>(this->state->workerCount, 1u);
+  this->state->capacity = 2 * this->state->workerCount;
+}
+
+/////////////////////////////////////////////////
+ModelPreloader::~ModelPreloader()
+{
+  // Workers that didn't start yet do nothing once they do.
+  std::unique_lock<std::mutex> lock(this->state->mutex);
+  this->state->stop = true;
+  this->state->progress.wait(lock, [this]
+      {
+        return this->state->busy == 0;
+      });
+}
+
+/////////////////////////////////////////////////
+void ModelPreloader::Submit(const ElementPtr &_elem)
+{
+  State &shared = *this->state;
+  std::unique_lock<std::mutex> lock(shared.mutex);
+
+  // When the workers fall behind, the parser loads the oldest model
+  // itself, which also keeps it going when the executor has no thread
+  // free for the workers.
+  while (shared.queue.size() >= shared.capacity)
+  {
+    Task &task = shared.tasks[shared.queue.front()];
+    shared.queue.pop_front();
+    task.started = true;
+    lock.unlock();
+    Run(shared, task);
+    lock.lock();
+    task.done = true;
+    shared.progress.notify_all();
+  }
+
+  Task &task = shared.tasks[_elem.get()];
+  task.elem = _elem;
+  task.stats = LoadStatsScope::Current();
+  task.diagnostics = DiagnosticScope::Current();
+  task.arena = ElementArenaScope::Current();
+  task.background = ElementReclaimScope::Background();
+  shared.queue.push_back(_elem.get());
+
+  if (shared.workers < shared.workerCount)
+  {
+    ++shared.workers;
+    std::shared_ptr<State> worker = this->state;
+    shared.executor->Submit([worker]
+        {
+          Work(*worker);
+        });
+  }
+}
+
+/////////////////////////////////////////////////
+bool ModelPreloader::Take(const ElementPtr &_elem, Model &_model,
+    Errors &_errors)
+{
+  State &shared = *this->state;
+  std::unique_lock<std::mutex> lock(shared.mutex);
+  auto iter = shared.tasks.find(_elem.get());
+  if (iter == shared.tasks.end())
+    return false;
+
+  // A model that no worker started is loaded here rather than waited for.
+  Task &task = iter->second;
+  if (!task.started)
+  {
+    task.started = true;
+    shared.queue.erase(
+        std::find(shared.queue.begin(), shared.queue.end(), _elem.get()));
+    lock.unlock();
+    Run(shared, task);
+    lock.lock();
+    task.done = true;
+  }
+  shared.progress.wait(lock, [&task]
+      {
+        return task.done;
+      });
+
+  Task done = std::move(task);
+  shared.tasks.erase(iter);
+  lock.unlock();
+
+  if (done.exception)
+    std::rethrow_exception(done.exception);
+  _model = std::move(done.model);
+  _errors = std::move(done.errors);
+  return true;
+}
+
+/////////////////////////////////////////////////
+void ModelPreloader::Run(const State &_state, Task &_task)
+{
+  ExecutorScope executorScope(_state.executor);
+  LoadStatsScope statsScope(_task.stats);
+  DiagnosticScope diagnosticScope(_task.diagnostics);
+  ElementArenaScope arenaScope(_task.arena);
+  ElementRetentionScope retentionScope(_state.releaseElements);
+  ElementReclaimScope reclaimScope(_task.background);
+  TrustedInputScope trustedScope(_state.trusted);
+  LoadPhaseTimer timer(LoadPhase::DOM_LOAD);
+  try
+  {
+    _task.errors = _task.model.Load(_task.elem);
+  }
+  catch(...)
+  {
+    _task.exception = std::current_exception();
+  }
+}
+
+/////////////////////////////////////////////////
+void ModelPreloader::Work(State &_state)
+{
+  std::unique_lock<std::mutex> lock(_state.mutex);
+  while (!_state.stop && !_state.queue.empty())
+  {
+    Task &task = _state.tasks[_state.queue.front()];
+    _state.queue.pop_front();
+    task.started = true;
+    ++_state.busy;
+
+    lock.unlock();
+    Run(_state, task);
+    lock.lock();
+    task.done = true;
+    --_state.busy;
+    _state.progress.notify_all();
+  }
+  --_state.workers;
+}
@@ -0,0 +1,215 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_MODEL_PRELOADER_HH_
+#define SDF_MODEL_PRELOADER_HH_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "sdf/Element.hh"
+#include "sdf/Error.hh"
+#include "sdf/Executor.hh"
+#include "sdf/LoadStats.hh"
+#include "sdf/Model.hh"
+#include "sdf/ParserConfig.hh"
+#include "sdf/sdf_config.h"
+
+#include "DiagnosticScope.hh"
+#include "ElementArena.hh"
+
+/// \ingroup sdf_parser
+/// \brief namespace for Simulation Description Format parser
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief Loads the DOM of the models of a world on worker tasks while
+  /// the parser is still reading the rest of the document, for
+  /// ParserConfig::PipelinedLoad. The parser submits each model once its
+  /// element, including its includes, is read, and World::Load takes the
+  /// loaded models instead of loading them again. Submitted models wait in
+  /// a bounded queue, so the parser is slowed down rather than the memory
+  /// of waiting models growing when the workers fall behind.
+  class ModelPreloader
+  {
+    /// \brief Constructor
+    /// \param[in] _config Configuration of the load. The workers are up to
+    /// ParserConfig::LoadThreadCount tasks of its executor, or one per
+    /// thread of the executor when the count is 0.
+    public: explicit ModelPreloader(const ParserConfig &_config);
+
+    /// \brief No copy constructor, the workers share the state of the
+    /// loader.
+    public: ModelPreloader(const ModelPreloader &) = delete;
+
+    /// \brief No copy assignment operator.
+    public: ModelPreloader &operator=(const ModelPreloader &) = delete;
+
+    /// \brief Destructor. Models that were not taken are dropped, after
+    /// the ones being loaded are finished.
+    public: ~ModelPreloader();
+
+    /// \brief Queue the loading of a model, and wait while the queue is
+    /// full. The element must not be modified by the parser afterwards.
+    /// \param[in] _elem Model element that was read completely.
+    public: void Submit(const ElementPtr &_elem);
+
+    /// \brief Take the loaded model of an element, waiting for it if it is
+    /// being loaded, or loading it on the calling thread if it is still
+    /// queued.
+    /// \param[in] _elem Model element.
+    /// \param[out] _model Loaded model.
+    /// \param[out] _errors Errors of Model::Load.
+    /// \return False if the element was not submitted, in which case the
+    /// outputs are unchanged.
+    public: bool Take(const ElementPtr &_elem, Model &_model,
+                      Errors &_errors);
+
+    /// \brief A submitted model.
+    private: struct Task
+    {
+      /// \brief Model element.
+      ElementPtr elem;
+
+      /// \brief Load statistics of the thread that submitted the model.
+      LoadStats *stats = nullptr;
+
+      /// \brief Diagnostic state of the thread that submitted the model.
+      LoadDiagnostics *diagnostics = nullptr;
+
+      /// \brief Arena of the document of the model.
+      std::shared_ptr<ElementArena> arena;
+
+      /// \brief Background release setting of the document.
+      bool background = false;
+
+      /// \brief True once a thread started loading the model.
+      bool started = false;
+
+      /// \brief True once the model is loaded.
+      bool done = false;
+
+      /// \brief Loaded model.
+      Model model;
+
+      /// \brief Errors of the load.
+      Errors errors;
+
+      /// \brief Exception thrown by the load, if any.
+      std::exception_ptr exception;
+    };
+
+    /// \brief State shared with the tasks of the executor, which can start
+    /// after the loader is destroyed.
+    private: struct State
+    {
+      /// \brief Executor that runs the workers.
+      std::shared_ptr<Executor> executor;
+
+      /// \brief True to release the elements of the loaded models.
+      bool releaseElements = false;
+
+      /// \brief True to skip the validation of the loaded models.
+      bool trusted = false;
+
+      /// \brief Maximum number of workers.
+      std::size_t workerCount = 1;
+
+      /// \brief Maximum number of queued models that no thread started.
+      std::size_t capacity = 2;
+
+      /// \brief Submitted models, by element.
+      std::unordered_map<const Element *, Task> tasks;
+
+      /// \brief Elements of the models that no thread started, in order.
+      std::deque<const Element *> queue;
+
+      /// \brief Number of workers submitted to the executor that didn't
+      /// finish.
+      std::size_t workers = 0;
+
+      /// \brief Number of workers that are loading a model.
+      std::size_t busy = 0;
+
+      /// \brief True to stop the workers.
+      bool stop = false;
+
+      /// \brief Protects the tasks, queue, counts and stop.
+      std::mutex mutex;
+
+      /// \brief Signals the parser that the queue has room, World::Load
+      /// that a model was loaded, and the destructor that a worker is idle.
+      std::condition_variable progress;
+    };
+
+    /// \brief Load a model with the settings of the thread that submitted
+    /// it.
+    /// \param[in] _state State of the loader.
+    /// \param[in,out] _task Task to run, without the lock held.
+    private: static void Run(const State &_state, Task &_task);
+
+    /// \brief Body of the workers, which load the queued models until the
+    /// queue is empty.
+    /// \param[in] _state State of the loader.
+    private: static void Work(State &_state);
+
+    /// \brief State of the loader.
+    private: std::shared_ptr<State> state;
+  };
+
+  /// \brief Sets the pipelined loader of the loads on the current thread
+  /// while this scope is alive. The previous one is restored when the scope
+  /// is destroyed, so scopes can nest.
+  class ModelPreloadScope
+  {
+    /// \brief Constructor
+    /// \param[in] _preloader Loader to use, or nullptr for none.
+    public: explicit ModelPreloadScope(ModelPreloader *_preloader)
+      : previous(Current())
+    {
+      Current() = _preloader;
+    }
+
+    /// \brief Destructor
+    public: ~ModelPreloadScope()
+    {
+      Current() = this->previous;
+    }
+
+    /// \brief Get the loader of the current thread.
+    /// \return Reference to the loader, which is nullptr when loads are not
+    /// pipelined.
+    public: static ModelPreloader *&Current()
+    {
+      static thread_local ModelPreloader *current = nullptr;
+      return current;
+    }
+
+    /// \brief Loader that was current before this scope.
+    private: ModelPreloader *previous;
+  };
+  }
+}
+#endif
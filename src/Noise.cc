@@ -18,6 +18,8 @@
 #include <algorithm>
 #include "sdf/Noise.hh"
 #include "sdf/Types.hh"
+#include "ElementRetentionScope.hh"
+#include "LoadStatsScope.hh"
 
 using namespace sdf;
 
@@ -95,9 +97,10 @@ Noise &Noise::operator=(Noise &&_noise)
 //////////////////////////////////////////////////
 Errors Noise::Load(ElementPtr _sdf)
 {
+  DomLoadTimer timer("Noise");
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that the provided SDF element is a <noise> element.
   // This is an error that cannot be recovered, so return an error.
@@ -0,0 +1,481 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "sdf/NoiseSampler.hh"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace sdf
+{
+// Inline bracket to help doxygen filtering.
+inline namespace SDF_VERSION_NAMESPACE {
+
+/// \brief Number of readings whose normal values are made at a time.
+static constexpr std::size_t kNoiseBlockSize = 256;
+
+/// \brief Streams of the generator, so that the readings, the bias and the
+/// dynamic bias don't share normal values.
+static constexpr std::uint64_t kReadingStream = 0;
+static constexpr std::uint64_t kBiasStream = 1;
+static constexpr std::uint64_t kDynamicBiasStream = 2;
+
+/// \brief Private data for NoiseSampler.
+class NoiseSamplerPrivate
+{
+  /// \brief Type of the noise.
+  public: NoiseType type = NoiseType::NONE;
+
+  /// \brief Mean of the noise.
+  public: double mean = 0.0;
+
+  /// \brief Standard deviation of the noise.
+  public: double stdDev = 0.0;
+
+  /// \brief Precision of the quantized noise.
+  public: double precision = 0.0;
+
+  /// \brief Standard deviation of the dynamic bias.
+  public: double dynamicBiasStdDev = 0.0;
+
+  /// \brief Correlation time of the dynamic bias, in seconds.
+  public: double dynamicBiasCorrelationTime = 0.0;
+
+  /// \brief Seed of the generator.
+  public: std::uint64_t seed = 0;
+
+  /// \brief Counter of the next reading.
+  public: std::uint64_t counter = 0;
+
+  /// \brief Number of updates of the dynamic bias.
+  public: std::uint64_t dynamicBiasSteps = 0;
+
+  /// \brief Constant bias.
+  public: double bias = 0.0;
+
+  /// \brief Current dynamic bias.
+  public: double dynamicBias = 0.0;
+};
+
+/////////////////////////////////////////////////
+/// \brief Mix the bits of a 64 bit value, with the finalizer of SplitMix64.
+/// \param[in] _z Value to mix.
+/// \return Mixed value.
+static std::uint64_t mixBits(std::uint64_t _z)
+{
+  _z = (_z ^ (_z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  _z = (_z ^ (_z >> 27)) * 0x94d049bb133111ebull;
+  return _z ^ (_z >> 31);
+}
+
+/////////////////////////////////////////////////
+/// \brief Get the random bits of a counter in a stream.
+/// \param[in] _seed Seed of the generator.
+/// \param[in] _stream Stream of the value.
+/// \param[in] _counter Counter of the value.
+/// \return SplitMix64 output of the counter, keyed by the seed and stream.
+static std::uint64_t randomBits(std::uint64_t _seed, std::uint64_t _stream,
+    std::uint64_t _counter)
+{
+  const std::uint64_t key = mixBits(_seed * 4 + _stream);
+  return mixBits(key + (_counter + 1) * 0x9e3779b97f4a7c15ull);
+}
+
+/////////////////////////////////////////////////
+/// \brief Get a standard normal value from random bits, with the cosine
+/// branch of the Box-Muller transform.
+/// \param[in] _bits Random bits.
+/// \return Normal value.
+static double normalValue(std::uint64_t _bits)
+{
+  constexpr double kScale = 1.0 / 4294967296.0;
+  const double u1 = (static_cast<double>(_bits >> 32) + 1.0) * kScale;
+  const double u2 = static_cast<double>(_bits & 0xffffffffull) * kScale;
+  return std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * M_PI * u2);
+}
+
+/// \brief Operations on one value, for the readings that don't fill a SIMD
+/// register.
+template<typename T>
+struct ScalarLanes
+{
+  using Vector = T;
+  static constexpr std::size_t kWidth = 1;
+  static Vector Load(const T *_p) { return *_p; }
+  static void Store(T *_p, Vector _v) { *_p = _v; }
+  static Vector Set(T _v) { return _v; }
+  static Vector Add(Vector _a, Vector _b) { return _a + _b; }
+  static Vector Mul(Vector _a, Vector _b) { return _a * _b; }
+  static Vector Div(Vector _a, Vector _b) { return _a / _b; }
+  static Vector Round(Vector _v) { return std::nearbyint(_v); }
+};
+
+/// \brief Operations on several values with SIMD instructions.
+template<typename T>
+struct SimdLanes;
+
+#if defined(__AVX__)
+/// \brief Operations on four doubles with AVX.
+template<>
+struct SimdLanes<double>
+{
+  using Vector = __m256d;
+  static constexpr std::size_t kWidth = 4;
+  static constexpr const char *kName = "AVX";
+  static Vector Load(const double *_p) { return _mm256_loadu_pd(_p); }
+  static void Store(double *_p, Vector _v) { _mm256_storeu_pd(_p, _v); }
+  static Vector Set(double _v) { return _mm256_set1_pd(_v); }
+  static Vector Add(Vector _a, Vector _b) { return _mm256_add_pd(_a, _b); }
+  static Vector Mul(Vector _a, Vector _b) { return _mm256_mul_pd(_a, _b); }
+  static Vector Div(Vector _a, Vector _b) { return _mm256_div_pd(_a, _b); }
+  static Vector Round(Vector _v)
+  {
+    return _mm256_round_pd(_v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  }
+};
+
+/// \brief Operations on eight floats with AVX.
+template<>
+struct SimdLanes<float>
+{
+  using Vector = __m256;
+  static constexpr std::size_t kWidth = 8;
+  static Vector Load(const float *_p) { return _mm256_loadu_ps(_p); }
+  static void Store(float *_p, Vector _v) { _mm256_storeu_ps(_p, _v); }
+  static Vector Set(float _v) { return _mm256_set1_ps(_v); }
+  static Vector Add(Vector _a, Vector _b) { return _mm256_add_ps(_a, _b); }
+  static Vector Mul(Vector _a, Vector _b) { return _mm256_mul_ps(_a, _b); }
+  static Vector Div(Vector _a, Vector _b) { return _mm256_div_ps(_a, _b); }
+  static Vector Round(Vector _v)
+  {
+    return _mm256_round_ps(_v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  }
+};
+#elif defined(__SSE2__) || defined(_M_X64)
+/// \brief Operations on two doubles with SSE2.
+template<>
+struct SimdLanes<double>
+{
+  using Vector = __m128d;
+  static constexpr std::size_t kWidth = 2;
+  static constexpr const char *kName = "SSE2";
+  static Vector Load(const double *_p) { return _mm_loadu_pd(_p); }
+  static void Store(double *_p, Vector _v) { _mm_storeu_pd(_p, _v); }
+  static Vector Set(double _v) { return _mm_set1_pd(_v); }
+  static Vector Add(Vector _a, Vector _b) { return _mm_add_pd(_a, _b); }
+  static Vector Mul(Vector _a, Vector _b) { return _mm_mul_pd(_a, _b); }
+  static Vector Div(Vector _a, Vector _b) { return _mm_div_pd(_a, _b); }
+
+  /// SSE2 has no rounding instruction, so values below 2^52 are rounded to
+  /// the nearest even integer by adding and subtracting 2^52.
+  static Vector Round(Vector _v)
+  {
+    const Vector sign = _mm_set1_pd(-0.0);
+    const Vector big = _mm_set1_pd(4503599627370496.0);
+    const Vector magic = _mm_or_pd(_mm_and_pd(_v, sign), big);
+    const Vector rounded = _mm_sub_pd(_mm_add_pd(_v, magic), magic);
+    const Vector small = _mm_cmplt_pd(_mm_andnot_pd(sign, _v), big);
+    return _mm_or_pd(_mm_and_pd(small, rounded), _mm_andnot_pd(small, _v));
+  }
+};
+
+/// \brief Operations on four floats with SSE2.
+template<>
+struct SimdLanes<float>
+{
+  using Vector = __m128;
+  static constexpr std::size_t kWidth = 4;
+  static Vector Load(const float *_p) { return _mm_loadu_ps(_p); }
+  static void Store(float *_p, Vector _v) { _mm_storeu_ps(_p, _v); }
+  static Vector Set(float _v) { return _mm_set1_ps(_v); }
+  static Vector Add(Vector _a, Vector _b) { return _mm_add_ps(_a, _b); }
+  static Vector Mul(Vector _a, Vector _b) { return _mm_mul_ps(_a, _b); }
+  static Vector Div(Vector _a, Vector _b) { return _mm_div_ps(_a, _b); }
+
+  /// Values below 2^23 are rounded like doubles below 2^52.
+  static Vector Round(Vector _v)
+  {
+    const Vector sign = _mm_set1_ps(-0.0f);
+    const Vector big = _mm_set1_ps(8388608.0f);
+    const Vector magic = _mm_or_ps(_mm_and_ps(_v, sign), big);
+    const Vector rounded = _mm_sub_ps(_mm_add_ps(_v, magic), magic);
+    const Vector small = _mm_cmplt_ps(_mm_andnot_ps(sign, _v), big);
+    return _mm_or_ps(_mm_and_ps(small, rounded), _mm_andnot_ps(small, _v));
+  }
+};
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+/// \brief Operations on two doubles with NEON.
+template<>
+struct SimdLanes<double>
+{
+  using Vector = float64x2_t;
+  static constexpr std::size_t kWidth = 2;
+  static constexpr const char *kName = "NEON";
+  static Vector Load(const double *_p) { return vld1q_f64(_p); }
+  static void Store(double *_p, Vector _v) { vst1q_f64(_p, _v); }
+  static Vector Set(double _v) { return vdupq_n_f64(_v); }
+  static Vector Add(Vector _a, Vector _b) { return vaddq_f64(_a, _b); }
+  static Vector Mul(Vector _a, Vector _b) { return vmulq_f64(_a, _b); }
+  static Vector Div(Vector _a, Vector _b) { return vdivq_f64(_a, _b); }
+  static Vector Round(Vector _v) { return vrndnq_f64(_v); }
+};
+
+/// \brief Operations on four floats with NEON.
+template<>
+struct SimdLanes<float>
+{
+  using Vector = float32x4_t;
+  static constexpr std::size_t kWidth = 4;
+  static Vector Load(const float *_p) { return vld1q_f32(_p); }
+  static void Store(float *_p, Vector _v) { vst1q_f32(_p, _v); }
+  static Vector Set(float _v) { return vdupq_n_f32(_v); }
+  static Vector Add(Vector _a, Vector _b) { return vaddq_f32(_a, _b); }
+  static Vector Mul(Vector _a, Vector _b) { return vmulq_f32(_a, _b); }
+  static Vector Div(Vector _a, Vector _b) { return vdivq_f32(_a, _b); }
+  static Vector Round(Vector _v) { return vrndnq_f32(_v); }
+};
+#else
+/// \brief Without SIMD instructions, readings are changed one by one.
+template<typename T>
+struct SimdLanes : ScalarLanes<T>
+{
+  static constexpr const char *kName = "scalar";
+};
+#endif
+
+/// \brief Parameters of one Apply call, in the type of the readings.
+template<typename T>
+struct NoiseParams
+{
+  /// \brief Sum of the mean, the bias and the dynamic bias.
+  T offset;
+
+  /// \brief Standard deviation.
+  T scale;
+
+  /// \brief Precision to round to, when quantize is true.
+  T precision;
+
+  /// \brief Whether the readings are rounded to the precision.
+  bool quantize;
+};
+
+/////////////////////////////////////////////////
+/// \brief Add noise to readings from a starting index, as many at a time
+/// as the lanes hold.
+/// \param[in] _begin Index of the first reading.
+/// \param[in] _count Number of readings.
+/// \param[in] _normals Normal value of each reading.
+/// \param[in] _params Parameters of the noise.
+/// \param[in,out] _data Readings.
+/// \return Index after the last reading that was changed.
+template<typename L, typename T>
+static std::size_t applyLanes(std::size_t _begin, std::size_t _count,
+    const T *_normals, const NoiseParams<T> &_params, T *_data)
+{
+  const auto offset = L::Set(_params.offset);
+  const auto scale = L::Set(_params.scale);
+  const auto precision = L::Set(_params.precision);
+  std::size_t k = _begin;
+  for (; k + L::kWidth <= _count; k += L::kWidth)
+  {
+    auto value = L::Add(L::Load(_data + k),
+        L::Add(offset, L::Mul(scale, L::Load(_normals + k))));
+    if (_params.quantize)
+      value = L::Mul(L::Round(L::Div(value, precision)), precision);
+    L::Store(_data + k, value);
+  }
+  return k;
+}
+
+/////////////////////////////////////////////////
+/// \brief Add noise to readings, in blocks of kNoiseBlockSize.
+/// \param[in,out] _data Private data of the sampler.
+/// \param[in,out] _readings Readings.
+/// \param[in] _count Number of readings.
+template<typename T>
+static void applyNoise(NoiseSamplerPrivate &_data, T *_readings,
+    std::size_t _count)
+{
+  if (_data.type == NoiseType::NONE || _count == 0)
+  {
+    _data.counter += _count;
+    return;
+  }
+
+  NoiseParams<T> params;
+  params.offset = static_cast<T>(_data.mean + _data.bias + _data.dynamicBias);
+  params.scale = static_cast<T>(_data.stdDev);
+  params.precision = static_cast<T>(_data.precision);
+  params.quantize = _data.type == NoiseType::GAUSSIAN_QUANTIZED &&
+      _data.precision > 0.0;
+
+  T normals[kNoiseBlockSize] = {};
+  for (std::size_t start = 0; start < _count; start += kNoiseBlockSize)
+  {
+    const std::size_t count = std::min(kNoiseBlockSize, _count - start);
+    if (_data.stdDev != 0.0)
+    {
+      const std::uint64_t counter = _data.counter + start;
+      for (std::size_t k = 0; k < count; ++k)
+      {
+        normals[k] = static_cast<T>(normalValue(
+            randomBits(_data.seed, kReadingStream, counter + k)));
+      }
+    }
+
+    T *readings = _readings + start;
+    const std::size_t k =
+        applyLanes<SimdLanes<T>>(0, count, normals, params, readings);
+    applyLanes<ScalarLanes<T>>(k, count, normals, params, readings);
+  }
+  _data.counter += _count;
+}
+
+/////////////////////////////////////////////////
+NoiseSampler::NoiseSampler()
+  : dataPtr(new NoiseSamplerPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+NoiseSampler::NoiseSampler(const Noise &_noise, std::uint64_t _seed)
+  : dataPtr(new NoiseSamplerPrivate)
+{
+  this->dataPtr->type = _noise.Type();
+  this->dataPtr->mean = _noise.Mean();
+  this->dataPtr->stdDev = _noise.StdDev();
+  this->dataPtr->precision = _noise.Precision();
+  this->dataPtr->dynamicBiasStdDev = _noise.DynamicBiasStdDev();
+  this->dataPtr->dynamicBiasCorrelationTime =
+      _noise.DynamicBiasCorrelationTime();
+  this->dataPtr->seed = _seed;
+
+  if (this->dataPtr->type != NoiseType::NONE)
+  {
+    this->dataPtr->bias = _noise.BiasMean() + _noise.BiasStdDev() *
+        normalValue(randomBits(_seed, kBiasStream, 0));
+    if (randomBits(_seed, kBiasStream, 1) & 1u)
+      this->dataPtr->bias = -this->dataPtr->bias;
+  }
+}
+
+/////////////////////////////////////////////////
+NoiseSampler::NoiseSampler(const NoiseSampler &_sampler)
+  : dataPtr(new NoiseSamplerPrivate(*_sampler.dataPtr))
+{
+}
+
+/////////////////////////////////////////////////
+NoiseSampler::NoiseSampler(NoiseSampler &&_sampler) noexcept
+  : dataPtr(std::exchange(_sampler.dataPtr, nullptr))
+{
+}
+
+/////////////////////////////////////////////////
+NoiseSampler &NoiseSampler::operator=(NoiseSampler &&_sampler) noexcept
+{
+  std::swap(this->dataPtr, _sampler.dataPtr);
+  return *this;
+}
+
+/////////////////////////////////////////////////
+NoiseSampler &NoiseSampler::operator=(const NoiseSampler &_sampler)
+{
+  return *this = NoiseSampler(_sampler);
+}
+
+/////////////////////////////////////////////////
+NoiseSampler::~NoiseSampler()
+{
+  delete this->dataPtr;
+  this->dataPtr = nullptr;
+}
+
+/////////////////////////////////////////////////
+void NoiseSampler::Apply(double *_data, std::size_t _count)
+{
+  applyNoise(*this->dataPtr, _data, _count);
+}
+
+/////////////////////////////////////////////////
+void NoiseSampler::Apply(float *_data, std::size_t _count)
+{
+  applyNoise(*this->dataPtr, _data, _count);
+}
+
+/////////////////////////////////////////////////
+std::uint64_t NoiseSampler::Counter() const
+{
+  return this->dataPtr->counter;
+}
+
+/////////////////////////////////////////////////
+void NoiseSampler::SetCounter(std::uint64_t _counter)
+{
+  this->dataPtr->counter = _counter;
+}
+
+/////////////////////////////////////////////////
+double NoiseSampler::Bias() const
+{
+  return this->dataPtr->bias;
+}
+
+/////////////////////////////////////////////////
+double NoiseSampler::DynamicBias() const
+{
+  return this->dataPtr->dynamicBias;
+}
+
+/////////////////////////////////////////////////
+void NoiseSampler::UpdateDynamicBias(double _dt)
+{
+  const double sigma = this->dataPtr->dynamicBiasStdDev;
+  const double tau = this->dataPtr->dynamicBiasCorrelationTime;
+  if (this->dataPtr->type == NoiseType::NONE || sigma <= 0.0 || tau <= 0.0 ||
+      _dt <= 0.0)
+  {
+    return;
+  }
+
+  // Discrete form of the Gauss-Markov process, as in the IMU sensors of
+  // Gazebo.
+  const double sigmaD =
+      std::sqrt(-sigma * sigma * tau / 2.0 * std::expm1(-2.0 * _dt / tau));
+  const double phi = std::exp(-_dt / tau);
+  this->dataPtr->dynamicBias = phi * this->dataPtr->dynamicBias +
+      sigmaD * normalValue(randomBits(this->dataPtr->seed,
+          kDynamicBiasStream, this->dataPtr->dynamicBiasSteps++));
+}
+
+/////////////////////////////////////////////////
+const char *NoiseSampler::InstructionSet()
+{
+  return SimdLanes<double>::kName;
+}
+}
+}
@@ -0,0 +1,217 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <string>
+#include <vector>
+#include "sdf/Noise.hh"
+#include "sdf/NoiseSampler.hh"
+
+/////////////////////////////////////////////////
+/// \brief Get a Gaussian noise model.
+/// \param[in] _mean Mean.
+/// \param[in] _stdDev Standard deviation.
+/// \return The noise.
+static sdf::Noise gaussian(double _mean, double _stdDev)
+{
+  sdf::Noise noise;
+  noise.SetType(sdf::NoiseType::GAUSSIAN);
+  noise.SetMean(_mean);
+  noise.SetStdDev(_stdDev);
+  return noise;
+}
+
+/////////////////////////////////////////////////
+TEST(DOMNoiseSampler, Construction)
+{
+  sdf::NoiseSampler sampler;
+  EXPECT_EQ(0u, sampler.Counter());
+  EXPECT_DOUBLE_EQ(0.0, sampler.Bias());
+  EXPECT_DOUBLE_EQ(0.0, sampler.DynamicBias());
+  const std::string instructionSet = sdf::NoiseSampler::InstructionSet();
+  EXPECT_FALSE(instructionSet.empty());
+
+  // Without noise the readings don't change, but the counter moves.
+  std::vector<double> readings{1.0, 2.0, 3.0};
+  sampler.Apply(readings.data(), readings.size());
+  EXPECT_EQ(std::vector<double>({1.0, 2.0, 3.0}), readings);
+  EXPECT_EQ(3u, sampler.Counter());
+  sampler.UpdateDynamicBias(1.0);
+  EXPECT_DOUBLE_EQ(0.0, sampler.DynamicBias());
+
+  sdf::NoiseSampler copy(sampler);
+  EXPECT_EQ(3u, copy.Counter());
+  sdf::NoiseSampler moved(std::move(copy));
+  EXPECT_EQ(3u, moved.Counter());
+  sdf::NoiseSampler assigned;
+  assigned = moved;
+  EXPECT_EQ(3u, assigned.Counter());
+  sdf::NoiseSampler moveAssigned;
+  moveAssigned = std::move(assigned);
+  EXPECT_EQ(3u, moveAssigned.Counter());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMNoiseSampler, Gaussian)
+{
+  sdf::NoiseSampler sampler(gaussian(0.5, 2.0), 7u);
+  EXPECT_DOUBLE_EQ(0.0, sampler.Bias());
+
+  const std::size_t count = 100000;
+  std::vector<double> readings(count, 10.0);
+  sampler.Apply(readings.data(), readings.size());
+  EXPECT_EQ(count, sampler.Counter());
+
+  double sum = 0.0;
+  double sumSquares = 0.0;
+  for (double reading : readings)
+  {
+    sum += reading;
+    sumSquares += reading * reading;
+  }
+  const double mean = sum / count;
+  const double variance = sumSquares / count - mean * mean;
+  EXPECT_NEAR(10.5, mean, 0.05);
+  EXPECT_NEAR(2.0, std::sqrt(variance), 0.05);
+
+  // Floats get the same noise.
+  std::vector<float> floats(count, 10.0f);
+  sampler.SetCounter(0u);
+  sampler.Apply(floats.data(), floats.size());
+  for (std::size_t k = 0; k < count; k += 997)
+    EXPECT_NEAR(readings[k], floats[k], 1e-5) << k;
+
+  // Another seed gives other values.
+  sdf::NoiseSampler other(gaussian(0.5, 2.0), 8u);
+  std::vector<double> otherReadings(count, 10.0);
+  other.Apply(otherReadings.data(), otherReadings.size());
+  EXPECT_NE(readings, otherReadings);
+}
+
+/////////////////////////////////////////////////
+TEST(DOMNoiseSampler, Counter)
+{
+  const sdf::Noise noise = gaussian(0.0, 1.0);
+  const std::size_t count = 1000;
+  std::vector<double> whole(count, 0.0);
+  sdf::NoiseSampler sampler(noise, 3u);
+  sampler.Apply(whole.data(), whole.size());
+
+  // Calls with odd sizes give the same values as one call.
+  std::vector<double> parts(count, 0.0);
+  sdf::NoiseSampler partSampler(noise, 3u);
+  partSampler.Apply(parts.data(), 3);
+  partSampler.Apply(parts.data() + 3, 258);
+  partSampler.Apply(parts.data() + 261, count - 261);
+  EXPECT_EQ(count, partSampler.Counter());
+  for (std::size_t k = 0; k < count; ++k)
+    EXPECT_DOUBLE_EQ(whole[k], parts[k]) << k;
+
+  // So do samplers that start at an offset.
+  std::vector<double> tail(count - 500, 0.0);
+  sdf::NoiseSampler tailSampler(noise, 3u);
+  tailSampler.SetCounter(500u);
+  tailSampler.Apply(tail.data(), tail.size());
+  for (std::size_t k = 0; k < tail.size(); ++k)
+    EXPECT_DOUBLE_EQ(whole[500 + k], tail[k]) << k;
+}
+
+/////////////////////////////////////////////////
+TEST(DOMNoiseSampler, Quantized)
+{
+  sdf::Noise noise = gaussian(0.0, 0.1);
+  noise.SetType(sdf::NoiseType::GAUSSIAN_QUANTIZED);
+  noise.SetPrecision(0.25);
+  sdf::NoiseSampler sampler(noise, 1u);
+
+  std::vector<double> readings(1003, 1.0);
+  sampler.Apply(readings.data(), readings.size());
+  std::vector<float> floats(1003, 1.0f);
+  sampler.SetCounter(0u);
+  sampler.Apply(floats.data(), floats.size());
+
+  bool changed = false;
+  for (std::size_t k = 0; k < readings.size(); ++k)
+  {
+    EXPECT_DOUBLE_EQ(readings[k] / 0.25, std::round(readings[k] / 0.25)) << k;
+    EXPECT_FLOAT_EQ(floats[k] / 0.25f, std::round(floats[k] / 0.25f)) << k;
+    EXPECT_NEAR(1.0, readings[k], 1.0) << k;
+    changed = changed || readings[k] != 1.0;
+  }
+  EXPECT_TRUE(changed);
+
+  // Without a precision there is no rounding.
+  noise.SetPrecision(0.0);
+  sdf::NoiseSampler unrounded(noise, 1u);
+  std::vector<double> values(100, 1.0);
+  unrounded.Apply(values.data(), values.size());
+  bool fractional = false;
+  for (double value : values)
+    fractional = fractional || value / 0.25 != std::round(value / 0.25);
+  EXPECT_TRUE(fractional);
+}
+
+/////////////////////////////////////////////////
+TEST(DOMNoiseSampler, Bias)
+{
+  sdf::Noise noise = gaussian(0.0, 0.0);
+  noise.SetBiasMean(3.0);
+  sdf::NoiseSampler sampler(noise, 5u);
+  EXPECT_DOUBLE_EQ(3.0, std::abs(sampler.Bias()));
+
+  std::vector<double> readings(10, 1.0);
+  sampler.Apply(readings.data(), readings.size());
+  for (double reading : readings)
+    EXPECT_DOUBLE_EQ(1.0 + sampler.Bias(), reading);
+
+  // Both signs are drawn.
+  bool positive = false;
+  bool negative = false;
+  for (std::uint64_t seed = 0; seed < 64; ++seed)
+  {
+    const double bias = sdf::NoiseSampler(noise, seed).Bias();
+    positive = positive || bias > 0.0;
+    negative = negative || bias < 0.0;
+  }
+  EXPECT_TRUE(positive);
+  EXPECT_TRUE(negative);
+
+  // The dynamic bias wanders around zero with the given deviation.
+  noise.SetBiasMean(0.0);
+  noise.SetDynamicBiasStdDev(0.5);
+  noise.SetDynamicBiasCorrelationTime(1.0);
+  sdf::NoiseSampler dynamic(noise, 5u);
+  dynamic.UpdateDynamicBias(0.0);
+  EXPECT_DOUBLE_EQ(0.0, dynamic.DynamicBias());
+
+  double sumSquares = 0.0;
+  const int steps = 20000;
+  for (int k = 0; k < steps; ++k)
+  {
+    dynamic.UpdateDynamicBias(0.01);
+    sumSquares += dynamic.DynamicBias() * dynamic.DynamicBias();
+  }
+  EXPECT_NE(0.0, dynamic.DynamicBias());
+  // The stationary variance of the process is sigma^2 tau / 2.
+  EXPECT_NEAR(0.125, sumSquares / steps, 0.05);
+
+  std::vector<double> biased(4, 1.0);
+  dynamic.Apply(biased.data(), biased.size());
+  for (double reading : biased)
+    EXPECT_DOUBLE_EQ(1.0 + dynamic.DynamicBias(), reading);
+}
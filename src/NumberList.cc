@@ -0,0 +1,129 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <string>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#include "NumberList.hh"
+#include "NumberParsing.hh"
+
+namespace sdf
+{
+// Inline bracket to help doxygen filtering.
+inline namespace SDF_VERSION_NAMESPACE {
+
+/// \brief Number of characters classified at a time.
+static constexpr std::ptrdiff_t kBlockSize = 16;
+
+#if defined(__SSE2__) || defined(_M_X64)
+/////////////////////////////////////////////////
+/// \brief Classify a block of characters with SSE2.
+/// \param[in] _chars First of kBlockSize characters.
+/// \return Bit i is set if character i is white space, as IsClassicSpace.
+static int spaceMask(const char *_chars)
+{
+  const __m128i chars =
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(_chars));
+  const __m128i space = _mm_cmpeq_epi8(chars, _mm_set1_epi8(' '));
+  // '\t', '\n', '\v', '\f' and '\r' are the five characters from 9. There
+  // is no unsigned comparison, but the characters that are not in the
+  // range are outside of [0, 4] once 9 is taken from them as signed bytes.
+  const __m128i control = _mm_sub_epi8(chars, _mm_set1_epi8(9));
+  const __m128i inRange = _mm_and_si128(
+      _mm_cmpgt_epi8(control, _mm_set1_epi8(-1)),
+      _mm_cmplt_epi8(control, _mm_set1_epi8(5)));
+  return _mm_movemask_epi8(_mm_or_si128(space, inRange));
+}
+#endif
+
+/////////////////////////////////////////////////
+/// \brief Find the first character of a range that is, or is not, white
+/// space. Blocks of characters without one are skipped with SIMD
+/// instructions when they are available.
+/// \param[in] _c First character of the range.
+/// \param[in] _end Pointer past the last character of the range.
+/// \param[in] _space True to find white space, false to find the rest.
+/// \return The character, or _end if there is none.
+static const char *findClass(const char *_c, const char *_end,
+    const bool _space)
+{
+#if defined(__SSE2__) || defined(_M_X64)
+  const int skipped = _space ? 0 : 0xFFFF;
+  while (_end - _c >= kBlockSize && spaceMask(_c) == skipped)
+    _c += kBlockSize;
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  while (_end - _c >= kBlockSize)
+  {
+    const uint8x16_t chars =
+        vld1q_u8(reinterpret_cast<const uint8_t *>(_c));
+    const uint8x16_t space = vorrq_u8(vceqq_u8(chars, vdupq_n_u8(' ')),
+        vcltq_u8(vsubq_u8(chars, vdupq_n_u8(9)), vdupq_n_u8(5)));
+    if (_space ? vmaxvq_u8(space) != 0 : vminvq_u8(space) == 0)
+      break;
+    _c += kBlockSize;
+  }
+#endif
+  while (_c != _end && IsClassicSpace(*_c) != _space)
+    ++_c;
+  return _c;
+}
+
+/////////////////////////////////////////////////
+/// \brief Convert a number that TokenFromChars rejects.
+/// \param[in] _first Pointer to the first character of the token.
+/// \param[in] _last Pointer past the last character of the token.
+/// \param[out] _value The number.
+/// \return False if the token is not a number.
+static bool slowToken(const char *_first, const char *_last, double &_value)
+{
+  const std::string token(_first, _last);
+  char *end = nullptr;
+  errno = 0;
+  _value = std::strtod(token.c_str(), &end);
+  return errno == 0 && end == token.c_str() + token.size();
+}
+
+/////////////////////////////////////////////////
+bool ParseNumberList(const char *_first, const char *_last,
+    std::vector<double> &_values)
+{
+  _values.clear();
+  const char *c = findClass(_first, _last, false);
+  while (c != _last)
+  {
+    const char *tokenEnd = findClass(c, _last, true);
+    double value;
+    if (!TokenFromChars(c, tokenEnd, value) &&
+        !slowToken(c, tokenEnd, value))
+    {
+      return false;
+    }
+    _values.push_back(value);
+    c = findClass(tokenEnd, _last, false);
+  }
+  return true;
+}
+}
+}
@@ -0,0 +1,45 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDFORMAT_NUMBER_LIST_HH_
+#define SDFORMAT_NUMBER_LIST_HH_
+
+#include <vector>
+
+#include "sdf/sdf_config.h"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief Parse a white space separated list of numbers of any length,
+  /// such as the value of a "double_array" parameter. The white space
+  /// between the numbers is skipped 16 characters at a time with SSE2 or
+  /// NEON instructions when they are available. The numbers are converted
+  /// with TokenFromChars, and the ones it rejects, such as "inf" or a
+  /// leading '+', with strtod, which expects LC_NUMERIC to be "C", as
+  /// Param::ValueFromString sets it.
+  /// \param[in] _first Pointer to the first character of the list.
+  /// \param[in] _last Pointer past the last character of the list.
+  /// \param[out] _values The numbers of the list. The vector is replaced.
+  /// \return False if a token of the list is not a number.
+  bool ParseNumberList(const char *_first, const char *_last,
+                       std::vector<double> &_values);
+  }
+}
+#endif
@@ -0,0 +1,243 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef SDFORMAT_NUMBER_PARSING_HH_
+#define SDFORMAT_NUMBER_PARSING_HH_
+
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+#include "sdf/sdf_config.h"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief Check whether a character is white space in the classic locale.
+  /// \param[in] _c Character to check.
+  /// \return True if _c is a white space character.
+  inline bool IsClassicSpace(const char _c)
+  {
+    return _c == ' ' || _c == '\t' || _c == '\n' ||
+           _c == '\v' || _c == '\f' || _c == '\r';
+  }
+
+  /// \brief Convert a single token to a number without using streams.
+  /// Only plain decimal numbers are accepted. Anything else, such as "inf",
+  /// "nan", hexadecimal values or a leading '+', is rejected so that it can
+  /// be handled by the slower conversion functions exactly as before.
+  /// \param[in] _first Pointer to the first character of the token.
+  /// \param[in] _last Pointer past the last character of the token.
+  /// \param[out] _out This will be set with the parsed value.
+  /// \return True if the whole token was converted.
+  template <typename T>
+  inline bool TokenFromChars(const char *_first, const char *_last, T &_out)
+  {
+    if (_first == _last || *_first == '+')
+      return false;
+
+    for (const char *c = _first; c != _last; ++c)
+    {
+      if (!std::isdigit(static_cast<unsigned char>(*c)) && *c != '.' &&
+          *c != '-' && *c != '+' && *c != 'e' && *c != 'E')
+      {
+        return false;
+      }
+    }
+
+    if constexpr (std::is_floating_point_v<T>)
+    {
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+      auto result = std::from_chars(_first, _last, _out);
+      return result.ec == std::errc() && result.ptr == _last;
+#else
+      // Floating point std::from_chars is not available with this standard
+      // library. Use strtod/strtof, which expect the caller to have forced
+      // LC_NUMERIC to "C", as Param::ValueFromString does.
+      const std::string token(_first, _last);
+      char *end = nullptr;
+      errno = 0;
+      if constexpr (std::is_same_v<T, float>)
+        _out = std::strtof(token.c_str(), &end);
+      else
+        _out = std::strtod(token.c_str(), &end);
+      return errno == 0 && end == token.c_str() + token.size();
+#endif
+    }
+    else
+    {
+      auto result = std::from_chars(_first, _last, _out);
+      return result.ec == std::errc() && result.ptr == _last;
+    }
+  }
+
+  /// \brief Parse a list of white space separated numbers. The whole input
+  /// has to be consumed, so that any unusual input is left to the stream
+  /// based parsers.
+  /// \param[in] _first Pointer to the first character of the input.
+  /// \param[in] _last Pointer past the last character of the input.
+  /// \param[out] _values Array that will be filled with the parsed values.
+  /// \param[in] _maxCount Size of the _values array.
+  /// \return The number of values parsed, or 0 if the input could not be
+  /// parsed completely.
+  template <typename T>
+  inline std::size_t ParseNumbers(const char *_first, const char *_last,
+                                  T *_values, const std::size_t _maxCount)
+  {
+    const char *c = _first;
+    const char *end = _last;
+    std::size_t count = 0;
+
+    while (true)
+    {
+      while (c != end && IsClassicSpace(*c))
+        ++c;
+
+      if (c == end)
+        break;
+
+      if (count == _maxCount)
+        return 0;
+
+      const char *tokenEnd = c;
+      while (tokenEnd != end && !IsClassicSpace(*tokenEnd))
+        ++tokenEnd;
+
+      if (!TokenFromChars(c, tokenEnd, _values[count]))
+        return 0;
+
+      ++count;
+      c = tokenEnd;
+    }
+
+    return count;
+  }
+
+  /// \brief Parse a list of white space separated numbers from a string.
+  /// \sa ParseNumbers(const char *, const char *, T *, const std::size_t)
+  /// \param[in] _input Input string.
+  /// \param[out] _values Array that will be filled with the parsed values.
+  /// \param[in] _maxCount Size of the _values array.
+  /// \return The number of values parsed, or 0 if the input could not be
+  /// parsed completely.
+  template <typename T>
+  inline std::size_t ParseNumbers(const std::string &_input, T *_values,
+                                  const std::size_t _maxCount)
+  {
+    return ParseNumbers(_input.data(), _input.data() + _input.size(), _values,
+                        _maxCount);
+  }
+
+  /// \brief Format a number into a character buffer without using streams.
+  /// Floating point values are written with the shortest representation
+  /// that reads back to the same value.
+  /// \param[in] _value Value to format.
+  /// \param[out] _first Pointer to the first character of the buffer.
+  /// \param[in] _last Pointer past the end of the buffer, which should have
+  /// room for at least 32 characters.
+  /// \return Pointer past the last character written.
+  template <typename T>
+  inline char *NumberToChars(const T _value, char *_first, char *_last)
+  {
+    if constexpr (std::is_floating_point_v<T>)
+    {
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+      auto result = std::to_chars(_first, _last, _value);
+      return result.ec == std::errc() ? result.ptr : _first;
+#else
+      const int size = std::snprintf(_first, _last - _first, "%.17g",
+          static_cast<double>(_value));
+      return size > 0 && size < _last - _first ? _first + size : _first;
+#endif
+    }
+    else
+    {
+      auto result = std::to_chars(_first, _last, _value);
+      return result.ec == std::errc() ? result.ptr : _first;
+    }
+  }
+
+  /// \brief Format a number into a character buffer the way an output
+  /// stream with the classic locale and default flags does, i.e. with six
+  /// significant digits for floating point values unless another stream
+  /// precision is given.
+  /// \param[in] _value Value to format.
+  /// \param[out] _first Pointer to the first character of the buffer.
+  /// \param[in] _last Pointer past the end of the buffer, which should have
+  /// room for at least 32 characters.
+  /// \param[in] _precision Stream precision used for floating point values.
+  /// \return Pointer past the last character written, or nullptr if the
+  /// value can not be formatted without a stream with this standard
+  /// library.
+  template <typename T>
+  inline char *StreamNumberToChars(const T _value, char *_first, char *_last,
+                                   const int _precision = 6)
+  {
+    if constexpr (std::is_floating_point_v<T>)
+    {
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+      auto result =
+          std::to_chars(_first, _last, _value, std::chars_format::general,
+                        _precision);
+      return result.ec == std::errc() ? result.ptr : nullptr;
+#else
+      (void)_value;
+      (void)_first;
+      (void)_last;
+      (void)_precision;
+      return nullptr;
+#endif
+    }
+    else
+    {
+      (void)_precision;
+      auto result = std::to_chars(_first, _last, _value);
+      return result.ec == std::errc() ? result.ptr : nullptr;
+    }
+  }
+
+  /// \brief Append a number to a string the way the stream insertion
+  /// operator does.
+  /// \sa StreamNumberToChars
+  /// \param[in,out] _out String to append to.
+  /// \param[in] _value Number to append.
+  /// \param[in] _precision Stream precision used for floating point values.
+  /// \return False if the number can not be formatted without a stream, in
+  /// which case _out is unchanged.
+  template <typename T>
+  inline bool AppendStreamNumber(std::string &_out, const T _value,
+                                 const int _precision = 6)
+  {
+    char chars[32];
+    char *end = StreamNumberToChars(_value, chars, chars + sizeof(chars),
+                                    _precision);
+    if (!end)
+      return false;
+    _out.append(chars, end);
+    return true;
+  }
+  }
+}
+#endif
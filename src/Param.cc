@@ -16,19 +16,40 @@
  */
 
 #include <algorithm>
+#include <array>
 #include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <cmath>
 #include <cstdint>
+#include <cstdlib>
+#include <initializer_list>
+#include <limits>
 #include <locale>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <unordered_map>
+#include <variant>
+#include <vector>
 
 #include <locale.h>
 #include <math.h>
 
 #include "sdf/Assert.hh"
+#include "sdf/Element.hh"
 #include "sdf/Param.hh"
 #include "sdf/Types.hh"
 
+#include "ContentHash.hh"
+#include "ElementArena.hh"
+#include "ElementChangeEpoch.hh"
+#include "NumberList.hh"
+#include "NumberParsing.hh"
+#include "SymbolTable.hh"
+
 using namespace sdf;
 
 // For some locale, the decimal separator is not a point, but a
@@ -56,20 +77,82 @@ namespace sdf
   }
 }
 
+using ValueType = ParamPrivate::ValueType;
+
+// Each type is the index of its alternative in ParamVariant.
+static_assert(std::is_same_v<std::variant_alternative_t<
+    static_cast<std::size_t>(ValueType::STRING), ParamPrivate::ParamVariant>,
+    std::string>);
+static_assert(std::is_same_v<std::variant_alternative_t<
+    static_cast<std::size_t>(ValueType::TIME), ParamPrivate::ParamVariant>,
+    sdf::Time>);
+static_assert(std::is_same_v<std::variant_alternative_t<
+    static_cast<std::size_t>(ValueType::POSE), ParamPrivate::ParamVariant>,
+    ignition::math::Pose3d>);
+static_assert(std::is_same_v<std::variant_alternative_t<
+    static_cast<std::size_t>(ValueType::DOUBLE_ARRAY),
+    ParamPrivate::ParamVariant>, std::vector<double>>);
+static_assert(static_cast<std::size_t>(ValueType::UNKNOWN) ==
+    std::variant_size_v<ParamPrivate::ParamVariant>);
+
+//////////////////////////////////////////////////
+/// \brief Resolve the type of a parameter from its type name.
+/// \param[in] _typeName Type name used in the SDFormat description.
+/// \return The type, or ValueType::UNKNOWN if the name is not supported.
+static ValueType valueTypeFromName(const std::string &_typeName)
+{
+  static const std::unordered_map<std::string, ValueType> types = {
+    {"bool", ValueType::BOOL},
+    {"char", ValueType::CHAR},
+    {"std::string", ValueType::STRING},
+    {"string", ValueType::STRING},
+    {"int", ValueType::INT},
+    {"uint64_t", ValueType::UINT64},
+    {"unsigned int", ValueType::UNSIGNED_INT},
+    {"double", ValueType::DOUBLE},
+    {"float", ValueType::FLOAT},
+    {"sdf::Time", ValueType::TIME},
+    {"time", ValueType::TIME},
+    {"ignition::math::Color", ValueType::COLOR},
+    {"color", ValueType::COLOR},
+    {"ignition::math::Vector2i", ValueType::VECTOR2I},
+    {"vector2i", ValueType::VECTOR2I},
+    {"ignition::math::Vector2d", ValueType::VECTOR2D},
+    {"vector2d", ValueType::VECTOR2D},
+    {"ignition::math::Vector3d", ValueType::VECTOR3D},
+    {"vector3", ValueType::VECTOR3D},
+    {"ignition::math::Pose3d", ValueType::POSE},
+    {"pose", ValueType::POSE},
+    {"Pose", ValueType::POSE},
+    {"ignition::math::Quaterniond", ValueType::QUATERNION},
+    {"quaternion", ValueType::QUATERNION},
+    {"std::vector<double>", ValueType::DOUBLE_ARRAY},
+    {"double_array", ValueType::DOUBLE_ARRAY},
+  };
+
+  auto iter = types.find(_typeName);
+  if (iter == types.end())
+    return ValueType::UNKNOWN;
+  return iter->second;
+}
+
 //////////////////////////////////////////////////
 Param::Param(const std::string &_key, const std::string &_typeName,
              const std::string &_default, bool _required,
              const std::string &_description)
   : dataPtr(new ParamPrivate)
 {
-  this->dataPtr->key = _key;
-  this->dataPtr->required = _required;
-  this->dataPtr->typeName = _typeName;
-  this->dataPtr->description = _description;
+  auto data = std::make_shared<ParamPrivate::DescriptionData>();
+  data->key = SymbolTable::Intern(_key);
+  data->required = _required;
+  data->typeName = SymbolTable::Intern(_typeName);
+  data->type = valueTypeFromName(_typeName);
+  data->description = _description;
+  this->dataPtr->descriptionData = data;
   this->dataPtr->set = false;
 
   SDF_ASSERT(this->ValueFromString(_default), "Invalid parameter");
-  this->dataPtr->defaultValue = this->dataPtr->value;
+  data->defaultValue = this->dataPtr->value;
 }
 
 //////////////////////////////////////////////////
@@ -79,6 +162,10 @@ Param::Param(const std::string &_key, const std::string &_typeName,
              const std::string &_description)
     : Param(_key, _typeName, _default, _required, _description)
 {
+  // The description data was just created by the delegated constructor, so
+  // it is not shared yet and can still be completed.
+  auto data = std::const_pointer_cast<ParamPrivate::DescriptionData>(
+      this->dataPtr->descriptionData);
   auto valCopy = this->dataPtr->value;
   if (!_minValue.empty())
   {
@@ -86,7 +173,7 @@ Param::Param(const std::string &_key, const std::string &_typeName,
         this->ValueFromString(_minValue),
         std::string("Invalid [min] parameter in SDFormat description of [") +
             _key + "]");
-    this->dataPtr->minValue = this->dataPtr->value;
+    data->minValue = this->dataPtr->value;
   }
 
   if (!_maxValue.empty())
@@ -95,17 +182,20 @@ Param::Param(const std::string &_key, const std::string &_typeName,
         this->ValueFromString(_maxValue),
         std::string("Invalid [max] parameter in SDFormat description of [") +
             _key + "]");
-    this->dataPtr->maxValue = this->dataPtr->value;
+    data->maxValue = this->dataPtr->value;
   }
 
   this->dataPtr->value = valCopy;
 }
 
 Param::Param(const Param &_param)
-    : dataPtr(std::make_unique<ParamPrivate>(*_param.dataPtr))
+    : dataPtr(std::make_unique<ParamPrivate>())
 {
   // We don't want to copy the updateFunc
-  this->dataPtr->updateFunc = nullptr;
+  this->dataPtr->descriptionData = _param.dataPtr->descriptionData;
+  this->dataPtr->value = _param.dataPtr->value;
+  this->dataPtr->set = _param.dataPtr->set;
+  this->dataPtr->dirty = _param.dataPtr->dirty;
 }
 
 //////////////////////////////////////////////////
@@ -116,11 +206,20 @@ Param::~Param()
 /////////////////////////////////////////////////
 Param &Param::operator=(const Param &_param)
 {
-  auto updateFuncCopy = this->dataPtr->updateFunc;
+  auto updateFuncCopy = std::move(this->dataPtr->updateFunc);
+  auto parentElement = std::move(this->dataPtr->parentElement);
+  const bool dirty = this->dataPtr->dirty;
+  const bool changed = !(this->dataPtr->value == _param.dataPtr->value) ||
+      this->dataPtr->set != _param.dataPtr->set;
   *this = Param(_param);
+  this->ValueChanged();
 
-  // Restore the update func
-  this->dataPtr->updateFunc = updateFuncCopy;
+  // Restore the update func and the element, which are not copied
+  this->dataPtr->updateFunc = std::move(updateFuncCopy);
+  this->dataPtr->parentElement = std::move(parentElement);
+  this->dataPtr->dirty = dirty;
+  if (changed)
+    this->MarkDirty();
   return *this;
 }
 
@@ -262,6 +361,10 @@ bool Param::GetAny(std::any &_anyVal) const
     }
     _anyVal = ret;
   }
+  else if (this->IsType<std::vector<double>>())
+  {
+    _anyVal = std::get<std::vector<double>>(this->dataPtr->value);
+  }
   else
   {
     sdferr << "Type of parameter not known: [" << this->GetTypeName() << "]\n";
@@ -270,6 +373,16 @@ bool Param::GetAny(std::any &_anyVal) const
   return true;
 }
 
+//////////////////////////////////////////////////
+Span<const double> Param::NumericArray() const
+{
+  const auto *numbers =
+      std::get_if<std::vector<double>>(&this->dataPtr->value);
+  if (!numbers)
+    return Span<const double>();
+  return Span<const double>(numbers->data(), numbers->size());
+}
+
 //////////////////////////////////////////////////
 void Param::Update()
 {
@@ -277,48 +390,228 @@ void Param::Update()
   {
     try
     {
-      std::any newValue = this->dataPtr->updateFunc();
+      std::any newValue = (*this->dataPtr->updateFunc)();
+      const auto oldValue = this->dataPtr->value;
       std::visit([&](auto &&arg)
         {
           using T = std::decay_t<decltype(arg)>;
           arg = std::any_cast<T>(newValue);
         }, this->dataPtr->value);
+      this->ValueChanged();
+      if (!(oldValue == this->dataPtr->value))
+        this->MarkDirty();
     }
     catch(...)
     {
       sdferr << "Unable to set value using Update for key["
-             << this->dataPtr->key << "]\n";
+             << *this->dataPtr->descriptionData->key << "]\n";
     }
   }
 }
 
 //////////////////////////////////////////////////
-std::string Param::GetAsString() const
+/// \brief Append the components of an ignition math type to a string,
+/// separated by spaces. Like the ignition math insertion operators, zero
+/// components are written as "0", without a sign.
+/// \param[in,out] _out String to append to.
+/// \param[in] _values Components to append.
+/// \return False if a component can not be formatted without a stream.
+template <typename T>
+static bool appendComponents(std::string &_out,
+    std::initializer_list<T> _values)
 {
-  StringStreamClassicLocale ss;
+  bool first = true;
+  for (const T value : _values)
+  {
+    if (!first)
+      _out += ' ';
+    first = false;
 
-  ss << ParamStreamer{ this->dataPtr->value };
-  return ss.str();
+    if (std::fpclassify(value) == FP_ZERO)
+      _out += '0';
+    else if (!AppendStreamNumber(_out, value))
+      return false;
+  }
+  return true;
 }
 
 //////////////////////////////////////////////////
-std::string Param::GetDefaultAsString() const
+/// \brief Append a parameter value to a string without using a stream.
+/// \param[in,out] _out String to append to.
+/// \param[in] _value Value to append.
+/// \return False if the type of the value has no stream-free formatting.
+template <typename T>
+static bool appendValue(std::string &_out, const T &_value)
 {
-  StringStreamClassicLocale ss;
+  if constexpr (std::is_same_v<T, bool>)
+  {
+    _out += _value ? '1' : '0';
+    return true;
+  }
+  else if constexpr (std::is_same_v<T, char>)
+  {
+    _out += _value;
+    return true;
+  }
+  else if constexpr (std::is_same_v<T, std::string>)
+  {
+    _out += _value;
+    return true;
+  }
+  else if constexpr (std::is_arithmetic_v<T>)
+  {
+    return AppendStreamNumber(_out, _value);
+  }
+  else if constexpr (std::is_same_v<T, sdf::Time>)
+  {
+    if (!AppendStreamNumber(_out, _value.sec))
+      return false;
+    _out += ' ';
+    return AppendStreamNumber(_out, _value.nsec);
+  }
+  else if constexpr (std::is_same_v<T, ignition::math::Color>)
+  {
+    return appendComponents(_out, {_value.R(), _value.G(), _value.B(),
+                                   _value.A()});
+  }
+  else if constexpr (std::is_same_v<T, ignition::math::Vector2i>)
+  {
+    if (!AppendStreamNumber(_out, _value.X()))
+      return false;
+    _out += ' ';
+    return AppendStreamNumber(_out, _value.Y());
+  }
+  else if constexpr (std::is_same_v<T, ignition::math::Vector2d>)
+  {
+    return appendComponents(_out, {_value.X(), _value.Y()});
+  }
+  else if constexpr (std::is_same_v<T, ignition::math::Vector3d>)
+  {
+    return appendComponents(_out, {_value.X(), _value.Y(), _value.Z()});
+  }
+  else if constexpr (std::is_same_v<T, ignition::math::Quaterniond>)
+  {
+    // Quaternions are written as roll, pitch and yaw.
+    return appendValue(_out, _value.Euler());
+  }
+  else if constexpr (std::is_same_v<T, ignition::math::Pose3d>)
+  {
+    if (!appendValue(_out, _value.Pos()))
+      return false;
+    _out += ' ';
+    return appendValue(_out, _value.Rot());
+  }
+  else if constexpr (std::is_same_v<T, std::vector<double>>)
+  {
+    for (std::size_t i = 0; i < _value.size(); ++i)
+    {
+      if (i > 0)
+        _out += ' ';
+      if (!AppendStreamNumber(_out, _value[i]))
+        return false;
+    }
+    return true;
+  }
+  else
+  {
+    return false;
+  }
+}
 
-  ss << ParamStreamer{ this->dataPtr->defaultValue };
+//////////////////////////////////////////////////
+/// \brief Check, for each alternative of ParamVariant, that appendValue
+/// writes the same text as the stream insertion operator for a set of
+/// values with signed zeros, small, large and fractional components.
+/// Types that do not match, for instance because the ignition math version
+/// formats them differently, are always written with a stream.
+/// \return Whether appendValue can be used, indexed by variant index.
+static std::array<bool, std::variant_size_v<ParamPrivate::ParamVariant>>
+checkAppendValue()
+{
+  const std::vector<double> numbers = {0.0, -0.0, 1.0, -2.5, 0.1, 1.0 / 3.0,
+      1e-7, -1234567.0, 123456789.0, 1e100};
+
+  std::vector<ParamPrivate::ParamVariant> probes = {
+      true, false, 'c', std::string("text"), -7, 42,
+      std::numeric_limits<std::uint64_t>::max(), 7u, sdf::Time(3, 500),
+      numbers, std::vector<double>()};
+  for (std::size_t i = 0; i < numbers.size(); ++i)
+  {
+    const double x = numbers[i];
+    const double y = numbers[(i + 1) % numbers.size()];
+    const double z = numbers[(i + 2) % numbers.size()];
+    ignition::math::Color color;
+    color.R(static_cast<float>(x));
+    color.G(static_cast<float>(y));
+    color.B(static_cast<float>(z));
+    color.A(0.5f);
+
+    probes.push_back(x);
+    probes.push_back(static_cast<float>(x));
+    probes.push_back(color);
+    probes.push_back(ignition::math::Vector2i(static_cast<int>(i) - 5, 7));
+    probes.push_back(ignition::math::Vector2d(x, y));
+    probes.push_back(ignition::math::Vector3d(x, y, z));
+    probes.push_back(ignition::math::Quaterniond(0.1 * x, 0.2, -0.3 * z));
+    probes.push_back(ignition::math::Pose3d(x, y, z, 0.1, -0.2 * y, 0.0));
+  }
+
+  std::array<bool, std::variant_size_v<ParamPrivate::ParamVariant>> result;
+  result.fill(true);
+  for (const ParamPrivate::ParamVariant &probe : probes)
+  {
+    StringStreamClassicLocale ss;
+    ss << ParamStreamer{probe};
+
+    std::string fast;
+    const bool appended = std::visit(
+        [&fast](const auto &_v) { return appendValue(fast, _v); }, probe);
+    if (!appended || fast != ss.str())
+      result[probe.index()] = false;
+  }
+  return result;
+}
+
+//////////////////////////////////////////////////
+/// \brief Convert a parameter value to the same string that the stream
+/// insertion operator writes, without a stream when possible.
+/// \param[in] _value Value to convert.
+/// \return The value as a string.
+static std::string valueToString(const ParamPrivate::ParamVariant &_value)
+{
+  static const auto canAppend = checkAppendValue();
+
+  if (canAppend[_value.index()])
+  {
+    std::string result;
+    auto append = [&result](const auto &_v) { return appendValue(result, _v); };
+    if (std::visit(append, _value))
+      return result;
+  }
+
+  StringStreamClassicLocale ss;
+  ss << ParamStreamer{ _value };
   return ss.str();
 }
 
+//////////////////////////////////////////////////
+std::string Param::GetAsString() const
+{
+  return valueToString(this->dataPtr->value);
+}
+
+//////////////////////////////////////////////////
+std::string Param::GetDefaultAsString() const
+{
+  return valueToString(this->dataPtr->descriptionData->defaultValue);
+}
+
 //////////////////////////////////////////////////
 std::optional<std::string> Param::GetMinValueAsString() const
 {
-  if (this->dataPtr->minValue.has_value())
+  if (this->dataPtr->descriptionData->minValue.has_value())
   {
-    StringStreamClassicLocale ss;
-
-    ss << ParamStreamer{ *this->dataPtr->minValue };
-    return ss.str();
+    return valueToString(*this->dataPtr->descriptionData->minValue);
   }
   return std::nullopt;
 }
@@ -326,12 +619,9 @@ std::optional<std::string> Param::GetMinValueAsString() const
 //////////////////////////////////////////////////
 std::optional<std::string> Param::GetMaxValueAsString() const
 {
-  if (this->dataPtr->maxValue.has_value())
+  if (this->dataPtr->descriptionData->maxValue.has_value())
   {
-    StringStreamClassicLocale ss;
-
-    ss << ParamStreamer{ *this->dataPtr->maxValue };
-    return ss.str();
+    return valueToString(*this->dataPtr->descriptionData->maxValue);
   }
   return std::nullopt;
 }
@@ -366,9 +656,28 @@ bool Param::ValueFromString(const std::string &_value)
   // comma for decimal position instead of a dot, making the conversion
   // to fail. See bug #60 for more information. Force to use always C
   setlocale(LC_NUMERIC, "C");
-  std::string trimmed = sdf::trim(_value);
+  const std::string &key = *this->dataPtr->descriptionData->key;
+
+  // Numeric arrays can be long, so their text is parsed where it is.
+  if (this->dataPtr->descriptionData->type == ValueType::DOUBLE_ARRAY)
+  {
+    std::vector<double> numbers;
+    if (!ParseNumberList(_value.data(), _value.data() + _value.size(),
+            numbers))
+    {
+      sdferr << "Invalid argument. Unable to set value [" << _value
+             << " ] for key[" << key << "].\n";
+      return false;
+    }
+    this->dataPtr->value = std::move(numbers);
+    return true;
+  }
+
+  const std::string_view trimmed = sdf::trimView(_value);
   std::string tmp(trimmed);
-  std::string lowerTmp = lowercase(trimmed);
+  // Only short values are compared below, to "true", "false", "1" and "0",
+  // and the "0x" prefix, so lowercase no more than six characters.
+  const std::string lowerTmp = lowercase(trimmed.substr(0, 6));
 
   // "true" and "false" doesn't work properly
   if (lowerTmp == "true")
@@ -392,117 +701,197 @@ bool Param::ValueFromString(const std::string &_value)
       numericBase = 16;
     }
 
-    if (this->dataPtr->typeName == "bool")
+    switch (this->dataPtr->descriptionData->type)
     {
-      if (lowerTmp == "true" || lowerTmp == "1")
+      case ValueType::BOOL:
       {
-        this->dataPtr->value = true;
+        if (lowerTmp == "true" || lowerTmp == "1")
+        {
+          this->dataPtr->value = true;
+        }
+        else if (lowerTmp == "false" || lowerTmp == "0")
+        {
+          this->dataPtr->value = false;
+        }
+        else
+        {
+          sdferr << "Invalid boolean value\n";
+          return false;
+        }
+        break;
       }
-      else if (lowerTmp == "false" || lowerTmp == "0")
+      case ValueType::CHAR:
       {
-        this->dataPtr->value = false;
+        this->dataPtr->value = tmp[0];
+        break;
       }
-      else
+      case ValueType::STRING:
       {
-        sdferr << "Invalid boolean value\n";
-        return false;
+        this->dataPtr->value = tmp;
+        break;
       }
-    }
-    else if (this->dataPtr->typeName == "char")
-    {
-      this->dataPtr->value = tmp[0];
-    }
-    else if (this->dataPtr->typeName == "std::string" ||
-             this->dataPtr->typeName == "string")
-    {
-      this->dataPtr->value = tmp;
-    }
-    else if (this->dataPtr->typeName == "int")
-    {
-      this->dataPtr->value = std::stoi(tmp, nullptr, numericBase);
-    }
-    else if (this->dataPtr->typeName == "uint64_t")
-    {
-      return ParseUsingStringStream<std::uint64_t>(tmp, this->dataPtr->key,
-                                                   this->dataPtr->value);
-    }
-    else if (this->dataPtr->typeName == "unsigned int")
-    {
-      this->dataPtr->value = static_cast<unsigned int>(
-          std::stoul(tmp, nullptr, numericBase));
-    }
-    else if (this->dataPtr->typeName == "double")
-    {
-      this->dataPtr->value = std::stod(tmp);
-    }
-    else if (this->dataPtr->typeName == "float")
-    {
-      this->dataPtr->value = std::stof(tmp);
-    }
-    else if (this->dataPtr->typeName == "sdf::Time" ||
-             this->dataPtr->typeName == "time")
-    {
-      return ParseUsingStringStream<sdf::Time>(tmp, this->dataPtr->key,
-                                               this->dataPtr->value);
-    }
-    else if (this->dataPtr->typeName == "ignition::math::Color" ||
-             this->dataPtr->typeName == "color")
-    {
-      // The insertion operator (>>) expects 4 values, but the last value (the
-      // alpha) is optional. We first try to parse assuming the alpha is
-      // specified. If that fails, we append the default value of alpha to the
-      // string and try to parse again.
-      bool result = ParseUsingStringStream<ignition::math::Color>(
-          tmp, this->dataPtr->key, this->dataPtr->value);
-
-      if (!result)
+      case ValueType::INT:
       {
-        ignition::math::Color colortmp;
-        return ParseUsingStringStream<ignition::math::Color>(
-            tmp + " " + std::to_string(colortmp.A()), this->dataPtr->key,
-            this->dataPtr->value);
+        int v;
+        if (!isHex && ParseNumbers(tmp, &v, 1) == 1)
+          this->dataPtr->value = v;
+        else
+          this->dataPtr->value = std::stoi(tmp, nullptr, numericBase);
+        break;
       }
-      else
-        return true;
-    }
-    else if (this->dataPtr->typeName == "ignition::math::Vector2i" ||
-             this->dataPtr->typeName == "vector2i")
-    {
-      return ParseUsingStringStream<ignition::math::Vector2i>(
-          tmp, this->dataPtr->key, this->dataPtr->value);
-    }
-    else if (this->dataPtr->typeName == "ignition::math::Vector2d" ||
-             this->dataPtr->typeName == "vector2d")
-    {
-      return ParseUsingStringStream<ignition::math::Vector2d>(
-          tmp, this->dataPtr->key, this->dataPtr->value);
-    }
-    else if (this->dataPtr->typeName == "ignition::math::Vector3d" ||
-             this->dataPtr->typeName == "vector3")
-    {
-      return ParseUsingStringStream<ignition::math::Vector3d>(
-          tmp, this->dataPtr->key, this->dataPtr->value);
-    }
-    else if (this->dataPtr->typeName == "ignition::math::Pose3d" ||
-             this->dataPtr->typeName == "pose" ||
-             this->dataPtr->typeName == "Pose")
-    {
-      if (!tmp.empty())
+      case ValueType::UINT64:
       {
-        return ParseUsingStringStream<ignition::math::Pose3d>(
-            tmp, this->dataPtr->key, this->dataPtr->value);
+        std::uint64_t v;
+        if (ParseNumbers(tmp, &v, 1) == 1)
+        {
+          this->dataPtr->value = v;
+          return true;
+        }
+        return ParseUsingStringStream<std::uint64_t>(tmp, key,
+                                                     this->dataPtr->value);
+      }
+      case ValueType::UNSIGNED_INT:
+      {
+        unsigned int v;
+        if (!isHex && ParseNumbers(tmp, &v, 1) == 1)
+        {
+          this->dataPtr->value = v;
+        }
+        else
+        {
+          this->dataPtr->value = static_cast<unsigned int>(
+              std::stoul(tmp, nullptr, numericBase));
+        }
+        break;
+      }
+      case ValueType::DOUBLE:
+      {
+        double v;
+        if (ParseNumbers(tmp, &v, 1) == 1)
+          this->dataPtr->value = v;
+        else
+          this->dataPtr->value = std::stod(tmp);
+        break;
+      }
+      case ValueType::FLOAT:
+      {
+        float v;
+        if (ParseNumbers(tmp, &v, 1) == 1)
+          this->dataPtr->value = v;
+        else
+          this->dataPtr->value = std::stof(tmp);
+        break;
+      }
+      case ValueType::TIME:
+      {
+        return ParseUsingStringStream<sdf::Time>(tmp, key,
+                                                 this->dataPtr->value);
+      }
+      case ValueType::COLOR:
+      {
+        // Assign the components directly, like the insertion operator does,
+        // since the Color constructor would clamp the values.
+        float v[4];
+        std::size_t count = ParseNumbers(tmp, v, 4);
+        if (count == 3 || count == 4)
+        {
+          ignition::math::Color color;
+          color.R(v[0]);
+          color.G(v[1]);
+          color.B(v[2]);
+          if (count == 4)
+            color.A(v[3]);
+          this->dataPtr->value = color;
+          return true;
+        }
+
+        // The insertion operator (>>) expects 4 values, but the last value
+        // (the alpha) is optional. We first try to parse assuming the alpha
+        // is specified. If that fails, we append the default value of alpha
+        // to the string and try to parse again.
+        bool result = ParseUsingStringStream<ignition::math::Color>(
+            tmp, key, this->dataPtr->value);
+
+        if (!result)
+        {
+          ignition::math::Color colortmp;
+          return ParseUsingStringStream<ignition::math::Color>(
+              tmp + " " + std::to_string(colortmp.A()), key,
+              this->dataPtr->value);
+        }
+        else
+          return true;
+      }
+      case ValueType::VECTOR2I:
+      {
+        int v[2];
+        if (ParseNumbers(tmp, v, 2) == 2)
+        {
+          this->dataPtr->value = ignition::math::Vector2i(v[0], v[1]);
+          return true;
+        }
+        return ParseUsingStringStream<ignition::math::Vector2i>(
+            tmp, key, this->dataPtr->value);
+      }
+      case ValueType::VECTOR2D:
+      {
+        double v[2];
+        if (ParseNumbers(tmp, v, 2) == 2)
+        {
+          this->dataPtr->value = ignition::math::Vector2d(v[0], v[1]);
+          return true;
+        }
+        return ParseUsingStringStream<ignition::math::Vector2d>(
+            tmp, key, this->dataPtr->value);
+      }
+      case ValueType::VECTOR3D:
+      {
+        double v[3];
+        if (ParseNumbers(tmp, v, 3) == 3)
+        {
+          this->dataPtr->value = ignition::math::Vector3d(v[0], v[1], v[2]);
+          return true;
+        }
+        return ParseUsingStringStream<ignition::math::Vector3d>(
+            tmp, key, this->dataPtr->value);
+      }
+      case ValueType::POSE:
+      {
+        // Like the insertion operator, the last three values are roll, pitch
+        // and yaw.
+        double v[6];
+        if (ParseNumbers(tmp, v, 6) == 6)
+        {
+          this->dataPtr->value =
+              ignition::math::Pose3d(v[0], v[1], v[2], v[3], v[4], v[5]);
+          return true;
+        }
+        if (!tmp.empty())
+        {
+          return ParseUsingStringStream<ignition::math::Pose3d>(
+              tmp, key, this->dataPtr->value);
+        }
+        break;
+      }
+      case ValueType::QUATERNION:
+      {
+        // The insertion operator reads roll, pitch and yaw.
+        double v[3];
+        if (ParseNumbers(tmp, v, 3) == 3)
+        {
+          this->dataPtr->value =
+              ignition::math::Quaterniond(v[0], v[1], v[2]);
+          return true;
+        }
+        return ParseUsingStringStream<ignition::math::Quaterniond>(
+            tmp, key, this->dataPtr->value);
+      }
+      default:
+      {
+        sdferr << "Unknown parameter type["
+               << *this->dataPtr->descriptionData->typeName << "]\n";
+        return false;
       }
-    }
-    else if (this->dataPtr->typeName == "ignition::math::Quaterniond" ||
-             this->dataPtr->typeName == "quaternion")
-    {
-      return ParseUsingStringStream<ignition::math::Quaterniond>(
-          tmp, this->dataPtr->key, this->dataPtr->value);
-    }
-    else
-    {
-      sdferr << "Unknown parameter type[" << this->dataPtr->typeName << "]\n";
-      return false;
     }
   }
   // Catch invalid argument exception from std::stoi/stoul/stod/stof
@@ -510,7 +899,7 @@ bool Param::ValueFromString(const std::string &_value)
   {
     sdferr << "Invalid argument. Unable to set value ["
            << _value << " ] for key["
-           << this->dataPtr->key << "].\n";
+           << key << "].\n";
     return false;
   }
   // Catch out of range exception from std::stoi/stoul/stod/stof
@@ -518,7 +907,7 @@ bool Param::ValueFromString(const std::string &_value)
   {
     sdferr << "Out of range. Unable to set value ["
            << _value << " ] for key["
-           << this->dataPtr->key << "].\n";
+           << key << "].\n";
     return false;
   }
 
@@ -528,9 +917,9 @@ bool Param::ValueFromString(const std::string &_value)
 //////////////////////////////////////////////////
 bool Param::SetFromString(const std::string &_value)
 {
-  std::string str = sdf::trim(_value.c_str());
+  std::string str(sdf::trimView(_value));
 
-  if (str.empty() && this->dataPtr->required)
+  if (str.empty() && this->dataPtr->descriptionData->required)
   {
     sdferr << "Empty string used when setting a required parameter. Key["
            << this->GetKey() << "]\n";
@@ -538,11 +927,18 @@ bool Param::SetFromString(const std::string &_value)
   }
   else if (str.empty())
   {
-    this->dataPtr->value = this->dataPtr->defaultValue;
+    if (!(this->dataPtr->value ==
+          this->dataPtr->descriptionData->defaultValue))
+    {
+      this->dataPtr->value = this->dataPtr->descriptionData->defaultValue;
+      this->MarkDirty();
+    }
+    this->ValueChanged();
     return true;
   }
 
   auto oldValue = this->dataPtr->value;
+  this->ValueChanged();
   if (!this->ValueFromString(str))
   {
     return false;
@@ -555,6 +951,8 @@ bool Param::SetFromString(const std::string &_value)
     return false;
   }
 
+  if (!this->dataPtr->set || !(oldValue == this->dataPtr->value))
+    this->MarkDirty();
   this->dataPtr->set = true;
   return this->dataPtr->set;
 }
@@ -562,44 +960,53 @@ bool Param::SetFromString(const std::string &_value)
 //////////////////////////////////////////////////
 void Param::Reset()
 {
-  this->dataPtr->value = this->dataPtr->defaultValue;
+  if (this->dataPtr->set ||
+      !(this->dataPtr->value == this->dataPtr->descriptionData->defaultValue))
+  {
+    this->MarkDirty();
+  }
+  this->dataPtr->value = this->dataPtr->descriptionData->defaultValue;
   this->dataPtr->set = false;
+  this->ValueChanged();
 }
 
 //////////////////////////////////////////////////
 ParamPtr Param::Clone() const
 {
-  return std::make_shared<Param>(*this);
+  return makeArenaShared<Param>(*this);
 }
 
 //////////////////////////////////////////////////
 const std::string &Param::GetTypeName() const
 {
-  return this->dataPtr->typeName;
+  return *this->dataPtr->descriptionData->typeName;
 }
 
 /////////////////////////////////////////////////
 void Param::SetDescription(const std::string &_desc)
 {
-  this->dataPtr->description = _desc;
+  auto data = std::make_shared<ParamPrivate::DescriptionData>(
+      *this->dataPtr->descriptionData);
+  data->description = _desc;
+  this->dataPtr->descriptionData = std::move(data);
 }
 
 /////////////////////////////////////////////////
 std::string Param::GetDescription() const
 {
-  return this->dataPtr->description;
+  return this->dataPtr->descriptionData->description;
 }
 
 /////////////////////////////////////////////////
 const std::string &Param::GetKey() const
 {
-  return this->dataPtr->key;
+  return *this->dataPtr->descriptionData->key;
 }
 
 /////////////////////////////////////////////////
 bool Param::GetRequired() const
 {
-  return this->dataPtr->required;
+  return this->dataPtr->descriptionData->required;
 }
 
 /////////////////////////////////////////////////
@@ -608,6 +1015,72 @@ bool Param::GetSet() const
   return this->dataPtr->set;
 }
 
+/////////////////////////////////////////////////
+bool Param::Dirty() const
+{
+  return this->dataPtr->dirty;
+}
+
+/////////////////////////////////////////////////
+void Param::ClearDirty()
+{
+  this->dataPtr->dirty = false;
+}
+
+/////////////////////////////////////////////////
+void Param::SetParentElement(const std::weak_ptr<Element> &_parent)
+{
+  this->dataPtr->parentElement = _parent;
+  if (this->dataPtr->dirty)
+  {
+    if (ElementPtr parent = _parent.lock())
+      parent->MarkDirty();
+  }
+}
+
+/////////////////////////////////////////////////
+void Param::ValueChanged() const
+{
+  if (ContentHashCount::Get() > 0)
+  {
+    if (ElementPtr element = this->dataPtr->parentElement.lock())
+      element->ClearContentHash();
+  }
+  this->NameChanged();
+}
+
+/////////////////////////////////////////////////
+void Param::NameChanged() const
+{
+  // Elements are only attached to a parent once they are read, so this
+  // costs little while a document is read.
+  static const Symbol kName = SymbolTable::Intern("name");
+  if (this->dataPtr->descriptionData->key == kName)
+  {
+    if (ElementPtr element = this->dataPtr->parentElement.lock())
+      element->InvalidateSiblingNames();
+  }
+}
+
+/////////////////////////////////////////////////
+void Param::MarkDirty()
+{
+  // The element was marked when the value first became dirty, but element
+  // snapshots need to know of every change.
+  if (this->dataPtr->dirty)
+  {
+    if (ElementChangeEpoch::Current() != 0u)
+    {
+      if (ElementPtr parent = this->dataPtr->parentElement.lock())
+        parent->MarkChanged();
+    }
+    return;
+  }
+  this->dataPtr->dirty = true;
+  if (ElementPtr parent = this->dataPtr->parentElement.lock())
+    parent->MarkDirty();
+}
+
 /////////////////////////////////////////////////
 bool Param::ValidateValue() const
 {
@@ -618,9 +1091,9 @@ bool Param::ValidateValue() const
         // cppcheck-suppress syntaxError
         if constexpr (std::is_scalar_v<T>)
         {
-          if (this->dataPtr->minValue.has_value())
+          if (this->dataPtr->descriptionData->minValue.has_value())
           {
-            if (_val < std::get<T>(*this->dataPtr->minValue))
+            if (_val < std::get<T>(*this->dataPtr->descriptionData->minValue))
             {
               sdferr << "The value [" << _val
                      << "] is less than the minimum allowed value of ["
@@ -629,9 +1102,9 @@ bool Param::ValidateValue() const
               return false;
             }
           }
-          if (this->dataPtr->maxValue.has_value())
+          if (this->dataPtr->descriptionData->maxValue.has_value())
           {
-            if (_val > std::get<T>(*this->dataPtr->maxValue))
+            if (_val > std::get<T>(*this->dataPtr->descriptionData->maxValue))
             {
               sdferr << "The value [" << _val
                      << "] is greater than the maximum allowed value of ["
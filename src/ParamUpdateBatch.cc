@@ -0,0 +1,170 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <cstddef>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "sdf/ParamUpdateBatch.hh"
+#include "Utils.hh"
+
+using namespace sdf;
+
+class sdf::ParamUpdateBatchPrivate
+{
+  /// \brief A bound parameter.
+  public: struct Binding
+  {
+    /// \brief The parameter.
+    ParamPtr param;
+
+    /// \brief Updates the value and returns true if it changed.
+    std::function<bool(ParamPrivate &)> apply;
+  };
+
+  /// \brief The bindings, in the order they were added, except for removed
+  /// ones which are replaced by the last binding.
+  public: std::vector<Binding> bindings;
+
+  /// \brief Index from a parameter to its position in `bindings`.
+  public: std::unordered_map<const Param *, std::size_t> index;
+
+  /// \brief Whether each binding changed its value in the last Update,
+  /// kept to reuse its storage.
+  public: std::vector<char> changed;
+};
+
+/////////////////////////////////////////////////
+ParamUpdateBatch::ParamUpdateBatch()
+  : dataPtr(new ParamUpdateBatchPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+ParamUpdateBatch::ParamUpdateBatch(const ParamUpdateBatch &_batch)
+  : dataPtr(new ParamUpdateBatchPrivate(*_batch.dataPtr))
+{
+}
+
+/////////////////////////////////////////////////
+ParamUpdateBatch::ParamUpdateBatch(ParamUpdateBatch &&_batch) noexcept
+  : dataPtr(std::exchange(_batch.dataPtr, nullptr))
+{
+}
+
+/////////////////////////////////////////////////
+ParamUpdateBatch &ParamUpdateBatch::operator=(
+    ParamUpdateBatch &&_batch) noexcept
+{
+  std::swap(this->dataPtr, _batch.dataPtr);
+  return *this;
+}
+
+/////////////////////////////////////////////////
+ParamUpdateBatch &ParamUpdateBatch::operator=(const ParamUpdateBatch &_batch)
+{
+  return *this = ParamUpdateBatch(_batch);
+}
+
+/////////////////////////////////////////////////
+ParamUpdateBatch::~ParamUpdateBatch()
+{
+  delete this->dataPtr;
+  this->dataPtr = nullptr;
+}
+
+/////////////////////////////////////////////////
+void ParamUpdateBatch::AddBinding(const ParamPtr &_param,
+    std::function<bool(ParamPrivate &)> _apply)
+{
+  auto [iter, inserted] = this->dataPtr->index.emplace(
+      _param.get(), this->dataPtr->bindings.size());
+  if (inserted)
+    this->dataPtr->bindings.push_back({_param, std::move(_apply)});
+  else
+    this->dataPtr->bindings[iter->second].apply = std::move(_apply);
+}
+
+/////////////////////////////////////////////////
+bool ParamUpdateBatch::Unbind(const ParamPtr &_param)
+{
+  auto iter = this->dataPtr->index.find(_param.get());
+  if (iter == this->dataPtr->index.end())
+    return false;
+
+  // The last binding takes the place of the removed one.
+  std::vector<ParamUpdateBatchPrivate::Binding> &bindings =
+      this->dataPtr->bindings;
+  const std::size_t position = iter->second;
+  this->dataPtr->index.erase(iter);
+  if (position + 1 != bindings.size())
+  {
+    bindings[position] = std::move(bindings.back());
+    this->dataPtr->index[bindings[position].param.get()] = position;
+  }
+  bindings.pop_back();
+  return true;
+}
+
+/////////////////////////////////////////////////
+void ParamUpdateBatch::Clear()
+{
+  this->dataPtr->bindings.clear();
+  this->dataPtr->index.clear();
+}
+
+/////////////////////////////////////////////////
+std::size_t ParamUpdateBatch::BindingCount() const
+{
+  return this->dataPtr->bindings.size();
+}
+
+/////////////////////////////////////////////////
+std::size_t ParamUpdateBatch::Update(unsigned int _threadCount)
+{
+  const std::vector<ParamUpdateBatchPrivate::Binding> &bindings =
+      this->dataPtr->bindings;
+  std::vector<char> &changed = this->dataPtr->changed;
+  changed.assign(bindings.size(), 0);
+
+  // Each callback only touches its own parameter. Marking the parameters
+  // as dirty walks up their elements, which may be shared, so it is done
+  // afterwards on this thread.
+  parallelFor(bindings.size(), _threadCount, [&](std::size_t _index)
+      {
+        const ParamUpdateBatchPrivate::Binding &binding = bindings[_index];
+        ParamPrivate &data = *binding.param->dataPtr;
+        if (binding.apply(data))
+        {
+          data.set = true;
+          changed[_index] = 1;
+        }
+      });
+
+  std::size_t count = 0;
+  for (std::size_t i = 0; i < bindings.size(); ++i)
+  {
+    if (changed[i])
+    {
+      bindings[i].param->MarkDirty();
+      bindings[i].param->ValueChanged();
+      ++count;
+    }
+  }
+  return count;
+}
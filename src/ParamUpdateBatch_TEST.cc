@@ -0,0 +1,152 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <ignition/math/Pose3.hh>
+
+#include "sdf/Element.hh"
+#include "sdf/Param.hh"
+#include "sdf/ParamUpdateBatch.hh"
+
+/////////////////////////////////////////////////
+TEST(ParamUpdateBatch, Bind)
+{
+  sdf::ParamUpdateBatch batch;
+  EXPECT_EQ(0u, batch.BindingCount());
+  EXPECT_EQ(0u, batch.Update());
+
+  auto param = std::make_shared<sdf::Param>("key", "double", "1.5", false);
+  EXPECT_FALSE(batch.Bind<double>(nullptr, [](double &){ return false; }));
+  EXPECT_FALSE(batch.Bind<double>(param, nullptr));
+  // The parameter holds a double, not a float.
+  EXPECT_FALSE(batch.Bind<float>(param, [](float &){ return false; }));
+  EXPECT_EQ(0u, batch.BindingCount());
+
+  double source = 1.5;
+  auto update = [&source](double &_value)
+  {
+    if (_value == source)
+      return false;
+    _value = source;
+    return true;
+  };
+  EXPECT_TRUE(batch.Bind<double>(param, update));
+  EXPECT_TRUE(batch.Bind<double>(param, update));
+  EXPECT_EQ(1u, batch.BindingCount());
+
+  // Unchanged data leaves the parameter as it was.
+  EXPECT_EQ(0u, batch.Update());
+  EXPECT_FALSE(param->GetSet());
+  EXPECT_FALSE(param->Dirty());
+
+  source = 2.5;
+  EXPECT_EQ(1u, batch.Update());
+  double value = 0;
+  EXPECT_TRUE(param->Get<double>(value));
+  EXPECT_DOUBLE_EQ(2.5, value);
+  EXPECT_TRUE(param->GetSet());
+  EXPECT_TRUE(param->Dirty());
+
+  // Copies share the parameters.
+  sdf::ParamUpdateBatch copy(batch);
+  source = 3.5;
+  EXPECT_EQ(1u, copy.Update());
+  EXPECT_TRUE(param->Get<double>(value));
+  EXPECT_DOUBLE_EQ(3.5, value);
+
+  EXPECT_TRUE(batch.Unbind(param));
+  EXPECT_FALSE(batch.Unbind(param));
+  EXPECT_EQ(0u, batch.BindingCount());
+  EXPECT_EQ(1u, copy.BindingCount());
+  copy.Clear();
+  EXPECT_EQ(0u, copy.BindingCount());
+}
+
+/////////////////////////////////////////////////
+TEST(ParamUpdateBatch, Elements)
+{
+  sdf::ElementPtr world = std::make_shared<sdf::Element>();
+  world->SetName("world");
+
+  const std::size_t modelCount = 100;
+  std::vector<ignition::math::Pose3d> poses(modelCount);
+  sdf::ParamUpdateBatch batch;
+  for (std::size_t i = 0; i < modelCount; ++i)
+  {
+    sdf::ElementPtr model = std::make_shared<sdf::Element>();
+    model->SetName("model");
+    model->AddAttribute("name", "string", "", false);
+    model->GetAttribute("name")->SetFromString("m" + std::to_string(i));
+    sdf::ElementPtr pose = std::make_shared<sdf::Element>();
+    pose->SetName("pose");
+    pose->AddValue("pose", "0 0 0 0 0 0", false);
+    pose->SetParent(model);
+    model->InsertElement(pose);
+    model->SetParent(world);
+    world->InsertElement(model);
+
+    ignition::math::Pose3d *source = &poses[i];
+    EXPECT_TRUE(batch.Bind<ignition::math::Pose3d>(pose->GetValue(),
+        [source](ignition::math::Pose3d &_value)
+        {
+          if (_value == *source)
+            return false;
+          _value = *source;
+          return true;
+        }));
+  }
+  world->ClearDirty();
+
+  // Only the models that moved are dirty.
+  poses[3].Pos().X(1);
+  poses[42].Pos().Y(2);
+  EXPECT_EQ(2u, batch.Update(4));
+  EXPECT_TRUE(world->Dirty());
+  std::size_t dirtyCount = 0;
+  for (sdf::ElementPtr model = world->GetFirstElement(); model;
+       model = model->GetNextElement())
+  {
+    if (model->Dirty())
+      ++dirtyCount;
+  }
+  EXPECT_EQ(2u, dirtyCount);
+
+  sdf::ElementPtr moved = world->GetFirstElement();
+  for (int i = 0; i < 42; ++i)
+    moved = moved->GetNextElement();
+  EXPECT_TRUE(moved->Dirty());
+  EXPECT_EQ(ignition::math::Pose3d(0, 2, 0, 0, 0, 0),
+      moved->Get<ignition::math::Pose3d>("pose"));
+
+  world->ClearDirty();
+  EXPECT_EQ(0u, batch.Update(4));
+  EXPECT_FALSE(world->Dirty());
+}
+
+/////////////////////////////////////////////////
+/// Main
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -16,8 +16,13 @@
  */
 
 #include <any>
+#include <cmath>
 #include <cstdint>
 #include <limits>
+#include <locale>
+#include <sstream>
+#include <string>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -283,6 +288,97 @@ TEST(Param, Vector2i)
   EXPECT_EQ(value, ignition::math::Vector2i(0, 0));
 }
 
+////////////////////////////////////////////////////
+TEST(Param, GetAsStringMatchesStream)
+{
+  // The values are written exactly as the stream insertion operators do.
+  auto streamed = [](const auto &_value)
+  {
+    std::ostringstream stream;
+    stream.imbue(std::locale::classic());
+    stream << _value;
+    return stream.str();
+  };
+
+  for (const double value : {0.0, -0.0, 0.1, 1.0 / 3.0, -2.5e-8, 1e21,
+                             123456.7, 1234567.0})
+  {
+    sdf::Param doubleParam("key", "double", "0", false);
+    EXPECT_TRUE(doubleParam.Set(value));
+    EXPECT_EQ(streamed(value), doubleParam.GetAsString());
+
+    sdf::Param floatParam("key", "float", "0", false);
+    EXPECT_TRUE(floatParam.Set(static_cast<float>(value)));
+    EXPECT_EQ(streamed(static_cast<float>(value)), floatParam.GetAsString());
+
+    const ignition::math::Pose3d pose(value, 1, -value, 0.1, 0, value);
+    sdf::Param poseParam("key", "pose", "0 0 0 0 0 0", false);
+    EXPECT_TRUE(poseParam.Set(pose));
+    EXPECT_EQ(streamed(pose), poseParam.GetAsString());
+
+    const ignition::math::Vector3d vector(value, 0, 2);
+    sdf::Param vectorParam("key", "vector3", "0 0 0", false);
+    EXPECT_TRUE(vectorParam.Set(vector));
+    EXPECT_EQ(streamed(vector), vectorParam.GetAsString());
+  }
+
+  sdf::Param intParam("key", "int", "-12", false);
+  EXPECT_EQ("-12", intParam.GetAsString());
+  sdf::Param uint64Param("key", "uint64_t", "18446744073709551615", false);
+  EXPECT_EQ("18446744073709551615", uint64Param.GetAsString());
+  sdf::Param boolParam("key", "bool", "true", false);
+  EXPECT_EQ("1", boolParam.GetAsString());
+  sdf::Param timeParam("key", "time", "1 5", false);
+  EXPECT_EQ("1 5", timeParam.GetAsString());
+  sdf::Param colorParam("key", "color", "0.1 0.2 0.3 1", false);
+  EXPECT_EQ("0.1 0.2 0.3 1", colorParam.GetAsString());
+  EXPECT_EQ("0.1 0.2 0.3 1", colorParam.GetDefaultAsString());
+
+  sdf::Param limited("key", "double", "0", false, "-0.5", "1e-3");
+  EXPECT_EQ("-0.5", limited.GetMinValueAsString().value_or(""));
+  EXPECT_EQ("0.001", limited.GetMaxValueAsString().value_or(""));
+}
+
+////////////////////////////////////////////////////
+TEST(Param, TypeNameAliases)
+{
+  // Every spelling of a type name holds the same alternative.
+  const std::vector<std::vector<std::string>> aliases = {
+    {"std::string", "string", "text"},
+    {"sdf::Time", "time", "1 2"},
+    {"ignition::math::Color", "color", "0.1 0.2 0.3 1"},
+    {"ignition::math::Vector2i", "vector2i", "1 2"},
+    {"ignition::math::Vector2d", "vector2d", "1.5 2"},
+    {"ignition::math::Vector3d", "vector3", "1 2 3"},
+    {"ignition::math::Pose3d", "pose", "1 2 3 0 0 0.5"},
+    {"ignition::math::Pose3d", "Pose", "1 2 3 0 0 0.5"},
+    {"ignition::math::Quaterniond", "quaternion", "0 0 0.5"},
+  };
+  for (const std::vector<std::string> &alias : aliases)
+  {
+    sdf::Param param("key", alias[0], alias[2], false);
+    sdf::Param aliasParam("key", alias[1], alias[2], false);
+    EXPECT_EQ(param.GetAsString(), aliasParam.GetAsString()) << alias[1];
+    EXPECT_EQ(alias[1], aliasParam.GetTypeName());
+  }
+
+  sdf::Param poseParam("key", "pose", "1 2 3 0 0 0", false);
+  EXPECT_TRUE(poseParam.IsType<ignition::math::Pose3d>());
+  sdf::Param vectorParam("key", "vector3", "1 2 3", false);
+  EXPECT_TRUE(vectorParam.IsType<ignition::math::Vector3d>());
+  sdf::Param uintParam("key", "unsigned int", "3", false);
+  EXPECT_TRUE(uintParam.IsType<unsigned int>());
+
+  // Strings are read as booleans.
+  sdf::Param stringParam("key", "string", "TRUE", false);
+  bool value = false;
+  EXPECT_TRUE(stringParam.Get<bool>(value));
+  EXPECT_TRUE(value);
+  EXPECT_TRUE(stringParam.Set<std::string>("0"));
+  EXPECT_TRUE(stringParam.Get<bool>(value));
+  EXPECT_FALSE(value);
+}
+
 ////////////////////////////////////////////////////
 TEST(Param, InvalidConstructor)
 {
@@ -300,6 +396,57 @@ TEST(Param, SetDescription)
   ASSERT_EQ("new desc", uint64Param.GetDescription());
 }
 
+////////////////////////////////////////////////////
+TEST(Param, UpdateFuncNotCopied)
+{
+  sdf::Param param("key", "int", "1", false);
+  param.SetUpdateFunc([]() { return std::any(5); });
+  param.Update();
+  EXPECT_EQ("5", param.GetAsString());
+
+  // Copies do not take the update function.
+  sdf::Param copy(param);
+  EXPECT_TRUE(copy.Set(2));
+  copy.Update();
+  EXPECT_EQ("2", copy.GetAsString());
+
+  // Assignment keeps the update function of the assigned parameter.
+  param = copy;
+  EXPECT_EQ("2", param.GetAsString());
+  param.Update();
+  EXPECT_EQ("5", param.GetAsString());
+}
+
+////////////////////////////////////////////////////
+TEST(Param, CopiesShareDescription)
+{
+  sdf::Param param("key", "double", "1.5", true, "0", "10", "description");
+  sdf::ParamPtr clone = param.Clone();
+  sdf::Param copy(param);
+
+  // Copies start with the same description, and keep their own values.
+  EXPECT_EQ("description", clone->GetDescription());
+  EXPECT_EQ("key", copy.GetKey());
+  EXPECT_TRUE(clone->Set(2.5));
+  EXPECT_EQ("1.5", param.GetAsString());
+  EXPECT_EQ("2.5", clone->GetAsString());
+  EXPECT_EQ("1.5", clone->GetDefaultAsString());
+  EXPECT_FALSE(clone->Set(20.0));
+  EXPECT_EQ("10", clone->GetMaxValueAsString().value_or(""));
+
+  // Changing the description of one copy does not affect the others.
+  clone->SetDescription("changed");
+  EXPECT_EQ("changed", clone->GetDescription());
+  EXPECT_EQ("description", param.GetDescription());
+  EXPECT_EQ("description", copy.GetDescription());
+
+  copy = *clone;
+  EXPECT_EQ("changed", copy.GetDescription());
+  EXPECT_EQ("2.5", copy.GetAsString());
+  param.SetDescription("original");
+  EXPECT_EQ("changed", copy.GetDescription());
+}
+
 ////////////////////////////////////////////////////
 TEST(Param, Reset)
 {
@@ -450,6 +597,243 @@ TEST(Param, MinMaxViolation)
   }
 }
 
+////////////////////////////////////////////////////
+/// Values that take the fast parsing path should match the values
+/// produced by the stream based fallback. A leading '+' forces the
+/// fallback.
+TEST(Param, FastPathMatchesFallback)
+{
+  {
+    sdf::Param fast("key", "double", "0", false);
+    sdf::Param slow("key", "double", "0", false);
+    EXPECT_TRUE(fast.SetFromString("0.1234567890123"));
+    EXPECT_TRUE(slow.SetFromString("+0.1234567890123"));
+    double fastValue, slowValue;
+    EXPECT_TRUE(fast.Get<double>(fastValue));
+    EXPECT_TRUE(slow.Get<double>(slowValue));
+    EXPECT_EQ(fastValue, slowValue);
+
+    // Trailing characters are still ignored by the fallback
+    EXPECT_TRUE(fast.SetFromString("1.5abc"));
+    EXPECT_TRUE(fast.Get<double>(fastValue));
+    EXPECT_DOUBLE_EQ(1.5, fastValue);
+  }
+
+  {
+    sdf::Param fast("key", "int", "0", false);
+    EXPECT_TRUE(fast.SetFromString("-42"));
+    int value;
+    EXPECT_TRUE(fast.Get<int>(value));
+    EXPECT_EQ(-42, value);
+    EXPECT_FALSE(fast.SetFromString("99999999999"));
+  }
+
+  {
+    sdf::Param fast("key", "vector3", "0 0 0", false);
+    sdf::Param slow("key", "vector3", "0 0 0", false);
+    EXPECT_TRUE(fast.SetFromString("1.1 -2.2e-3 3"));
+    EXPECT_TRUE(slow.SetFromString("+1.1 +2.2e-3 +3"));
+    ignition::math::Vector3d fastValue, slowValue;
+    EXPECT_TRUE(fast.Get<ignition::math::Vector3d>(fastValue));
+    EXPECT_TRUE(slow.Get<ignition::math::Vector3d>(slowValue));
+    EXPECT_EQ(ignition::math::Vector3d(1.1, -2.2e-3, 3), fastValue);
+    EXPECT_EQ(ignition::math::Vector3d(1.1, 2.2e-3, 3), slowValue);
+    EXPECT_FALSE(fast.SetFromString("1 2"));
+  }
+
+  {
+    sdf::Param fast("key", "pose", "0 0 0 0 0 0", false);
+    sdf::Param slow("key", "pose", "0 0 0 0 0 0", false);
+    EXPECT_TRUE(fast.SetFromString("1 2 3 0.1 0.2 0.3"));
+    EXPECT_TRUE(slow.SetFromString("+1 2 3 0.1 0.2 0.3"));
+    ignition::math::Pose3d fastValue, slowValue;
+    EXPECT_TRUE(fast.Get<ignition::math::Pose3d>(fastValue));
+    EXPECT_TRUE(slow.Get<ignition::math::Pose3d>(slowValue));
+    EXPECT_EQ(slowValue, fastValue);
+  }
+
+  {
+    sdf::Param fast("key", "quaternion", "0 0 0", false);
+    sdf::Param slow("key", "quaternion", "0 0 0", false);
+    EXPECT_TRUE(fast.SetFromString("0.1 0.2 0.3"));
+    EXPECT_TRUE(slow.SetFromString("+0.1 0.2 0.3"));
+    ignition::math::Quaterniond fastValue, slowValue;
+    EXPECT_TRUE(fast.Get<ignition::math::Quaterniond>(fastValue));
+    EXPECT_TRUE(slow.Get<ignition::math::Quaterniond>(slowValue));
+    EXPECT_EQ(slowValue, fastValue);
+  }
+
+  {
+    sdf::Param color("key", "color", "0 0 0 1", false);
+    ignition::math::Color value;
+    EXPECT_TRUE(color.SetFromString("0.1 0.2 0.3"));
+    EXPECT_TRUE(color.Get<ignition::math::Color>(value));
+    EXPECT_EQ(ignition::math::Color(0.1f, 0.2f, 0.3f, 1.0f), value);
+    EXPECT_TRUE(color.SetFromString("0.1 0.2 0.3 0.4"));
+    EXPECT_TRUE(color.Get<ignition::math::Color>(value));
+    EXPECT_EQ(ignition::math::Color(0.1f, 0.2f, 0.3f, 0.4f), value);
+  }
+}
+
+/////////////////////////////////////////////////
+/// Values read as another numeric type are converted directly.
+TEST(Param, CrossTypeGet)
+{
+  sdf::Param intParam("key", "int", "-3", false);
+  double doubleValue = 0;
+  EXPECT_TRUE(intParam.Get<double>(doubleValue));
+  EXPECT_DOUBLE_EQ(-3.0, doubleValue);
+  bool boolValue = false;
+  EXPECT_TRUE(intParam.Get<bool>(boolValue));
+  EXPECT_TRUE(boolValue);
+
+  // Negative values are out of range, and converted as before.
+  unsigned int uintValue = 0;
+  EXPECT_TRUE(intParam.Get<unsigned int>(uintValue));
+  EXPECT_EQ(static_cast<unsigned int>(-3), uintValue);
+
+  sdf::Param doubleParam("key", "double", "1234567.75", false);
+  int intValue = 0;
+  EXPECT_TRUE(doubleParam.Get<int>(intValue));
+  EXPECT_EQ(1234567, intValue);
+  std::uint64_t uint64Value = 0;
+  EXPECT_TRUE(doubleParam.Get<std::uint64_t>(uint64Value));
+  EXPECT_EQ(1234567u, uint64Value);
+
+  // Precision is not lost to formatting.
+  EXPECT_TRUE(doubleParam.SetFromString("0.123456789"));
+  float floatValue = 0;
+  EXPECT_TRUE(doubleParam.Get<float>(floatValue));
+  EXPECT_FLOAT_EQ(0.123456789f, floatValue);
+
+  ignition::math::Angle angle;
+  EXPECT_TRUE(doubleParam.Get<ignition::math::Angle>(angle));
+  EXPECT_DOUBLE_EQ(0.123456789, angle.Radian());
+
+  sdf::Param floatParam("key", "float", "0.5", false);
+  EXPECT_TRUE(floatParam.Get<double>(doubleValue));
+  EXPECT_DOUBLE_EQ(0.5, doubleValue);
+
+  sdf::Param boolParam("key", "bool", "true", false);
+  EXPECT_TRUE(boolParam.Get<int>(intValue));
+  EXPECT_EQ(1, intValue);
+
+  // Defaults are converted in the same way.
+  sdf::Param uintParam("key", "unsigned int", "42", false);
+  EXPECT_TRUE(uintParam.GetDefault<double>(doubleValue));
+  EXPECT_DOUBLE_EQ(42.0, doubleValue);
+
+  // Strings are still parsed.
+  sdf::Param stringParam("key", "string", "2.5", false);
+  EXPECT_TRUE(stringParam.Get<double>(doubleValue));
+  EXPECT_DOUBLE_EQ(2.5, doubleValue);
+}
+
+/////////////////////////////////////////////////
+TEST(Param, Visit)
+{
+  sdf::Param poseParam("key", "pose", "1 2 3 0 0 0", false);
+  EXPECT_TRUE(poseParam.Visit([](const auto &_value)
+      {
+        using T = std::decay_t<decltype(_value)>;
+        if constexpr (std::is_same_v<T, ignition::math::Pose3d>)
+          return _value == ignition::math::Pose3d(1, 2, 3, 0, 0, 0);
+        else
+          return false;
+      }));
+
+  sdf::Param stringParam("key", "string", "hello", false);
+  std::size_t length = 0;
+  stringParam.Visit([&length](const auto &_value)
+      {
+        if constexpr (std::is_same_v<std::decay_t<decltype(_value)>,
+                                     std::string>)
+        {
+          length = _value.size();
+        }
+      });
+  EXPECT_EQ(5u, length);
+}
+
+/////////////////////////////////////////////////
+TEST(Param, Dirty)
+{
+  sdf::Param param("key", "double", "1.5", false);
+  EXPECT_FALSE(param.Dirty());
+
+  // Setting the current value is not a change.
+  EXPECT_TRUE(param.SetFromString("1.5"));
+  EXPECT_TRUE(param.Dirty());
+  param.ClearDirty();
+  EXPECT_TRUE(param.SetFromString("1.5"));
+  EXPECT_FALSE(param.Dirty());
+  EXPECT_TRUE(param.Set(2.5));
+  EXPECT_TRUE(param.Dirty());
+
+  // Values that are rejected are not changes.
+  param.ClearDirty();
+  EXPECT_FALSE(param.SetFromString("not a number"));
+  EXPECT_FALSE(param.Dirty());
+
+  param.Reset();
+  EXPECT_TRUE(param.Dirty());
+  param.ClearDirty();
+  param.Reset();
+  EXPECT_FALSE(param.Dirty());
+
+  // Copies keep the dirty flag.
+  EXPECT_TRUE(param.Set(3.5));
+  EXPECT_TRUE(param.Clone()->Dirty());
+  sdf::Param other("key", "double", "1.5", false);
+  other = param;
+  EXPECT_TRUE(other.Dirty());
+}
+
+/////////////////////////////////////////////////
+TEST(Param, DoubleArray)
+{
+  sdf::Param param("key", "double_array", "", false);
+  EXPECT_TRUE(param.IsType<std::vector<double>>());
+  EXPECT_EQ(0u, param.NumericArray().Size());
+  EXPECT_EQ("", param.GetAsString());
+
+  // Long lists, and tokens that need the slow conversion.
+  std::string text;
+  for (int i = 0; i < 100; ++i)
+    text += std::to_string(i) + ".5\t\n   ";
+  text += "+1 -inf";
+  EXPECT_TRUE(param.SetFromString(text));
+  const sdf::Span<const double> numbers = param.NumericArray();
+  ASSERT_EQ(102u, numbers.Size());
+  EXPECT_DOUBLE_EQ(0.5, numbers.Data()[0]);
+  EXPECT_DOUBLE_EQ(99.5, numbers.Data()[99]);
+  EXPECT_DOUBLE_EQ(1.0, numbers.Data()[100]);
+  EXPECT_TRUE(std::isinf(numbers.Data()[101]));
+
+  // A list with a token that isn't a number is rejected.
+  EXPECT_FALSE(param.SetFromString("1 2 three"));
+  EXPECT_EQ(102u, param.NumericArray().Size());
+
+  EXPECT_TRUE(param.SetFromString("1.5 -2 0.25"));
+  EXPECT_EQ("1.5 -2 0.25", param.GetAsString());
+  std::vector<double> values;
+  EXPECT_TRUE(param.Get(values));
+  EXPECT_EQ(std::vector<double>({1.5, -2, 0.25}), values);
+  double first = 0;
+  EXPECT_TRUE(param.Get(first));
+  EXPECT_DOUBLE_EQ(1.5, first);
+
+  EXPECT_TRUE(param.Set(std::vector<double>{3, 4}));
+  EXPECT_EQ("3 4", param.GetAsString());
+  EXPECT_EQ(2u, param.Clone()->NumericArray().Size());
+
+  // Other types read as arrays give their numbers.
+  sdf::Param pose("key", "pose", "1 2 3 0 0 0", false);
+  EXPECT_TRUE(pose.Get(values));
+  EXPECT_EQ(std::vector<double>({1, 2, 3, 0, 0, 0}), values);
+  EXPECT_EQ(0u, pose.NumericArray().Size());
+}
+
 /////////////////////////////////////////////////
 /// Main
 int main(int argc, char **argv)
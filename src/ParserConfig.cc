@@ -0,0 +1,594 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "sdf/Executor.hh"
+#include "sdf/ParserConfig.hh"
+#include "FindFileSettings.hh"
+
+using namespace sdf;
+
+/// \brief Private data for sdf::ParserConfig
+class sdf::ParserConfigPrivate
+{
+  /// \brief Number of threads used to load sibling DOM objects.
+  public: unsigned int loadThreadCount = 1u;
+
+  /// \brief Executor of the parallel work, or nullptr for the default.
+  public: std::shared_ptr<Executor> loadExecutor;
+
+  /// \brief Statistics collected while loading, not owned.
+  public: LoadStats *stats = nullptr;
+
+  /// \brief Observer of the loaded entities, not owned.
+  public: LoadObserver *observer = nullptr;
+
+  /// \brief Sink of the messages of the loads, not owned.
+  public: DiagnosticSink *diagnostics = nullptr;
+
+  /// \brief Token that cancels the loads, not owned.
+  public: CancellationToken *cancellation = nullptr;
+
+  /// \brief Time by which the loads have to finish.
+  public: std::chrono::steady_clock::time_point deadline =
+              std::chrono::steady_clock::time_point::max();
+
+  /// \brief True to allocate loaded documents from an arena.
+  public: bool useElementArena = false;
+
+  /// \brief Resource that arenas take their memory from.
+  public: std::pmr::memory_resource *memoryResource = nullptr;
+
+  /// \brief True to release loaded elements on a background thread.
+  public: bool releaseInBackground = false;
+
+  /// \brief True to load models while the file is read.
+  public: bool pipelinedLoad = false;
+
+  /// \brief Directory of the on-disk load cache.
+  public: std::string loadCachePath;
+
+  /// \brief Names of elements whose children are read lazily.
+  public: std::set<std::string> lazyElements;
+
+  /// \brief Read the children of copy-children elements lazily.
+  public: bool lazyCopyChildren = false;
+
+  /// \brief Share the children of identical included models.
+  public: bool shareIncludedModels = false;
+
+  /// \brief Share equal materials through a material table of the world.
+  public: bool shareMaterials = false;
+
+  /// \brief Share equal meshes through a mesh registry of the Root.
+  public: bool shareMeshes = false;
+
+  /// \brief Record included models for Root::ReloadIncludes.
+  public: bool trackIncludes = false;
+
+  /// \brief Maximum number of errors of a load, or 0 for no limit.
+  public: std::size_t maxErrors = 0;
+
+  /// \brief Read documents without building a tinyxml2 DOM of them.
+  public: bool streamingRead = false;
+
+  /// \brief Drop the element tree once Root::Load has built the DOM.
+  public: bool releaseElements = false;
+
+  /// \brief Skip the passes that only validate loaded documents.
+  public: bool trustedInput = false;
+
+  /// \brief Load the contents of models on first access.
+  public: bool lazyModels = false;
+
+  /// \brief Record the range of the text of each element read.
+  public: bool recordSourceRanges = false;
+
+  /// \brief Parse the top level entities of large worlds concurrently.
+  public: bool chunkedXmlParse = false;
+
+  /// \brief Names of elements that are left out of loaded documents.
+  public: std::set<std::string> skippedElements;
+
+  /// \brief Filter of the top level models of worlds, or nullptr.
+  public: ParserConfig::RegionFilterCallback regionFilter;
+
+  /// \brief URI paths and find callback, or nullptr if none were set.
+  /// Shared by copies, and replaced instead of modified.
+  public: std::shared_ptr<FindFileSettings> findFileSettings;
+};
+
+/////////////////////////////////////////////////
+ParserConfig::ParserConfig()
+  : dataPtr(new ParserConfigPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+ParserConfig::ParserConfig(const ParserConfig &_config)
+  : dataPtr(new ParserConfigPrivate(*_config.dataPtr))
+{
+}
+
+/////////////////////////////////////////////////
+ParserConfig::ParserConfig(ParserConfig &&_config) noexcept
+  : dataPtr(std::exchange(_config.dataPtr, nullptr))
+{
+}
+
+/////////////////////////////////////////////////
+ParserConfig &ParserConfig::operator=(ParserConfig &&_config) noexcept
+{
+  std::swap(this->dataPtr, _config.dataPtr);
+  return *this;
+}
+
+/////////////////////////////////////////////////
+ParserConfig &ParserConfig::operator=(const ParserConfig &_config)
+{
+  return *this = ParserConfig(_config);
+}
+
+/////////////////////////////////////////////////
+ParserConfig::~ParserConfig()
+{
+  delete this->dataPtr;
+  this->dataPtr = nullptr;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetLoadThreadCount(unsigned int _count)
+{
+  this->dataPtr->loadThreadCount = _count;
+}
+
+/////////////////////////////////////////////////
+unsigned int ParserConfig::LoadThreadCount() const
+{
+  return this->dataPtr->loadThreadCount;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetLoadExecutor(std::shared_ptr<Executor> _executor)
+{
+  this->dataPtr->loadExecutor = std::move(_executor);
+}
+
+/////////////////////////////////////////////////
+std::shared_ptr<Executor> ParserConfig::LoadExecutor() const
+{
+  return this->dataPtr->loadExecutor;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetStats(LoadStats *_stats)
+{
+  this->dataPtr->stats = _stats;
+}
+
+/////////////////////////////////////////////////
+LoadStats *ParserConfig::Stats() const
+{
+  return this->dataPtr->stats;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetObserver(LoadObserver *_observer)
+{
+  this->dataPtr->observer = _observer;
+}
+
+/////////////////////////////////////////////////
+LoadObserver *ParserConfig::Observer() const
+{
+  return this->dataPtr->observer;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetDiagnostics(DiagnosticSink *_sink)
+{
+  this->dataPtr->diagnostics = _sink;
+}
+
+/////////////////////////////////////////////////
+DiagnosticSink *ParserConfig::Diagnostics() const
+{
+  return this->dataPtr->diagnostics;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetCancellation(CancellationToken *_token)
+{
+  this->dataPtr->cancellation = _token;
+}
+
+/////////////////////////////////////////////////
+CancellationToken *ParserConfig::Cancellation() const
+{
+  return this->dataPtr->cancellation;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetDeadline(std::chrono::steady_clock::time_point _deadline)
+{
+  this->dataPtr->deadline = _deadline;
+}
+
+/////////////////////////////////////////////////
+std::chrono::steady_clock::time_point ParserConfig::Deadline() const
+{
+  return this->dataPtr->deadline;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetUseElementArena(bool _use)
+{
+  this->dataPtr->useElementArena = _use;
+}
+
+/////////////////////////////////////////////////
+bool ParserConfig::UseElementArena() const
+{
+  return this->dataPtr->useElementArena;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetMemoryResource(std::pmr::memory_resource *_resource)
+{
+  this->dataPtr->memoryResource = _resource;
+}
+
+/////////////////////////////////////////////////
+std::pmr::memory_resource *ParserConfig::MemoryResource() const
+{
+  return this->dataPtr->memoryResource;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetReleaseElementsInBackground(bool _background)
+{
+  this->dataPtr->releaseInBackground = _background;
+}
+
+/////////////////////////////////////////////////
+bool ParserConfig::ReleaseElementsInBackground() const
+{
+  return this->dataPtr->releaseInBackground;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetPipelinedLoad(bool _pipelined)
+{
+  this->dataPtr->pipelinedLoad = _pipelined;
+}
+
+/////////////////////////////////////////////////
+bool ParserConfig::PipelinedLoad() const
+{
+  return this->dataPtr->pipelinedLoad;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetLoadCachePath(const std::string &_path)
+{
+  this->dataPtr->loadCachePath = _path;
+}
+
+/////////////////////////////////////////////////
+const std::string &ParserConfig::LoadCachePath() const
+{
+  return this->dataPtr->loadCachePath;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetLazyElements(const std::set<std::string> &_names)
+{
+  this->dataPtr->lazyElements = _names;
+}
+
+/////////////////////////////////////////////////
+const std::set<std::string> &ParserConfig::LazyElements() const
+{
+  return this->dataPtr->lazyElements;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetLazyCopyChildren(bool _lazy)
+{
+  this->dataPtr->lazyCopyChildren = _lazy;
+}
+
+/////////////////////////////////////////////////
+bool ParserConfig::LazyCopyChildren() const
+{
+  return this->dataPtr->lazyCopyChildren;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetShareIncludedModels(bool _share)
+{
+  this->dataPtr->shareIncludedModels = _share;
+}
+
+/////////////////////////////////////////////////
+bool ParserConfig::ShareIncludedModels() const
+{
+  return this->dataPtr->shareIncludedModels;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetShareMaterials(bool _share)
+{
+  this->dataPtr->shareMaterials = _share;
+}
+
+/////////////////////////////////////////////////
+bool ParserConfig::ShareMaterials() const
+{
+  return this->dataPtr->shareMaterials;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetShareMeshes(bool _share)
+{
+  this->dataPtr->shareMeshes = _share;
+}
+
+/////////////////////////////////////////////////
+bool ParserConfig::ShareMeshes() const
+{
+  return this->dataPtr->shareMeshes;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetTrackIncludes(bool _track)
+{
+  this->dataPtr->trackIncludes = _track;
+}
+
+/////////////////////////////////////////////////
+bool ParserConfig::TrackIncludes() const
+{
+  return this->dataPtr->trackIncludes;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetMaxErrors(std::size_t _count)
+{
+  this->dataPtr->maxErrors = _count;
+}
+
+/////////////////////////////////////////////////
+std::size_t ParserConfig::MaxErrors() const
+{
+  return this->dataPtr->maxErrors;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetStreamingRead(bool _streaming)
+{
+  this->dataPtr->streamingRead = _streaming;
+}
+
+/////////////////////////////////////////////////
+bool ParserConfig::StreamingRead() const
+{
+  return this->dataPtr->streamingRead;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetReleaseElements(bool _release)
+{
+  this->dataPtr->releaseElements = _release;
+}
+
+/////////////////////////////////////////////////
+bool ParserConfig::ReleaseElements() const
+{
+  return this->dataPtr->releaseElements;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetTrustedInput(bool _trusted)
+{
+  this->dataPtr->trustedInput = _trusted;
+}
+
+/////////////////////////////////////////////////
+bool ParserConfig::TrustedInput() const
+{
+  return this->dataPtr->trustedInput;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetLazyModels(bool _lazy)
+{
+  this->dataPtr->lazyModels = _lazy;
+}
+
+/////////////////////////////////////////////////
+bool ParserConfig::LazyModels() const
+{
+  return this->dataPtr->lazyModels;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetRecordSourceRanges(bool _record)
+{
+  this->dataPtr->recordSourceRanges = _record;
+}
+
+/////////////////////////////////////////////////
+bool ParserConfig::RecordSourceRanges() const
+{
+  return this->dataPtr->recordSourceRanges;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetChunkedXmlParse(bool _chunked)
+{
+  this->dataPtr->chunkedXmlParse = _chunked;
+}
+
+/////////////////////////////////////////////////
+bool ParserConfig::ChunkedXmlParse() const
+{
+  return this->dataPtr->chunkedXmlParse;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetSkippedElements(const std::set<std::string> &_names)
+{
+  this->dataPtr->skippedElements = _names;
+}
+
+/////////////////////////////////////////////////
+const std::set<std::string> &ParserConfig::SkippedElements() const
+{
+  return this->dataPtr->skippedElements;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetRegionFilter(RegionFilterCallback _filter)
+{
+  this->dataPtr->regionFilter = std::move(_filter);
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetRegionFilter(
+    const ignition::math::AxisAlignedBox &_region)
+{
+  this->dataPtr->regionFilter =
+      [_region](const std::string &, const ignition::math::Pose3d &_pose)
+      {
+        return _region.Contains(_pose.Pos());
+      };
+}
+
+/////////////////////////////////////////////////
+const ParserConfig::RegionFilterCallback &ParserConfig::RegionFilter() const
+{
+  return this->dataPtr->regionFilter;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetFilesystem(
+    std::shared_ptr<const VirtualFilesystem> _filesystem)
+{
+  auto settings = this->dataPtr->findFileSettings ?
+      std::make_shared<FindFileSettings>(*this->dataPtr->findFileSettings) :
+      std::make_shared<FindFileSettings>();
+  settings->filesystem = std::move(_filesystem);
+  this->dataPtr->findFileSettings = settings;
+}
+
+/////////////////////////////////////////////////
+std::shared_ptr<const VirtualFilesystem> ParserConfig::Filesystem() const
+{
+  return this->dataPtr->findFileSettings ?
+      this->dataPtr->findFileSettings->filesystem : nullptr;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::AddURIPath(const std::string &_uri,
+    const std::string &_path)
+{
+  auto settings = this->dataPtr->findFileSettings ?
+      std::make_shared<FindFileSettings>(*this->dataPtr->findFileSettings) :
+      std::make_shared<FindFileSettings>();
+  FindFileSettings::AddURIPath(settings->uriPathMap, _uri, _path,
+      FindFileSettings::FilesystemOf(settings.get()));
+  this->dataPtr->findFileSettings = settings;
+}
+
+/////////////////////////////////////////////////
+const std::map<std::string, std::vector<std::string>> &
+ParserConfig::URIPathMap() const
+{
+  static const FindFileSettings::URIPathMap empty;
+  return this->dataPtr->findFileSettings ?
+      this->dataPtr->findFileSettings->uriPathMap : empty;
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetFindCallback(
+    std::function<std::string(const std::string &)> _cb)
+{
+  auto settings = this->dataPtr->findFileSettings ?
+      std::make_shared<FindFileSettings>(*this->dataPtr->findFileSettings) :
+      std::make_shared<FindFileSettings>();
+  settings->findCallback = std::move(_cb);
+  this->dataPtr->findFileSettings = settings;
+}
+
+/////////////////////////////////////////////////
+std::function<std::string(const std::string &)>
+ParserConfig::FindFileCallback() const
+{
+  return this->dataPtr->findFileSettings ?
+      this->dataPtr->findFileSettings->findCallback :
+      std::function<std::string(const std::string &)>();
+}
+
+/////////////////////////////////////////////////
+void ParserConfig::SetAsyncFindCallback(
+    std::function<std::future<std::string>(const std::string &)> _cb)
+{
+  auto settings = this->dataPtr->findFileSettings ?
+      std::make_shared<FindFileSettings>(*this->dataPtr->findFileSettings) :
+      std::make_shared<FindFileSettings>();
+  settings->asyncFindCallback = std::move(_cb);
+  this->dataPtr->findFileSettings = settings;
+}
+
+/////////////////////////////////////////////////
+std::function<std::future<std::string>(const std::string &)>
+ParserConfig::AsyncFindCallback() const
+{
+  return this->dataPtr->findFileSettings ?
+      this->dataPtr->findFileSettings->asyncFindCallback :
+      std::function<std::future<std::string>(const std::string &)>();
+}
+
+/////////////////////////////////////////////////
+std::shared_ptr<FindFileSettings> FindFileSettings::Of(
+    const ParserConfig &_config)
+{
+  return _config.dataPtr->findFileSettings;
+}
+
+/////////////////////////////////////////////////
+const VirtualFilesystem &FindFileSettings::FilesystemOf(
+    const FindFileSettings *_settings)
+{
+  return _settings && _settings->filesystem ?
+      *_settings->filesystem : VirtualFilesystem::Native();
+}
+
+/////////////////////////////////////////////////
+const VirtualFilesystem &FindFileSettings::FilesystemOf(
+    const ParserConfig &_config)
+{
+  return FilesystemOf(_config.dataPtr->findFileSettings.get());
+}
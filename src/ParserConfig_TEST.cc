@@ -0,0 +1,192 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include "sdf/CancellationToken.hh"
+#include "sdf/Executor.hh"
+#include <memory_resource>
+#include "sdf/ParserConfig.hh"
+
+/////////////////////////////////////////////////
+TEST(ParserConfig, Construction)
+{
+  sdf::ParserConfig config;
+  EXPECT_EQ(1u, config.LoadThreadCount());
+  EXPECT_FALSE(config.UseElementArena());
+
+  config.SetUseElementArena(true);
+  EXPECT_TRUE(config.UseElementArena());
+
+  EXPECT_EQ(nullptr, config.MemoryResource());
+  config.SetMemoryResource(std::pmr::new_delete_resource());
+  EXPECT_EQ(std::pmr::new_delete_resource(), config.MemoryResource());
+
+  EXPECT_FALSE(config.ReleaseElementsInBackground());
+  config.SetReleaseElementsInBackground(true);
+  EXPECT_TRUE(config.ReleaseElementsInBackground());
+
+  EXPECT_FALSE(config.PipelinedLoad());
+  config.SetPipelinedLoad(true);
+  EXPECT_TRUE(config.PipelinedLoad());
+
+  EXPECT_TRUE(config.LoadCachePath().empty());
+  config.SetLoadCachePath("/tmp/sdf_cache");
+  EXPECT_EQ("/tmp/sdf_cache", config.LoadCachePath());
+
+  EXPECT_TRUE(config.LazyElements().empty());
+  config.SetLazyElements({"plugin", "sensor"});
+  EXPECT_EQ(2u, config.LazyElements().size());
+  EXPECT_EQ(1u, config.LazyElements().count("plugin"));
+
+  EXPECT_FALSE(config.LazyCopyChildren());
+  config.SetLazyCopyChildren(true);
+  EXPECT_TRUE(config.LazyCopyChildren());
+
+  EXPECT_FALSE(config.ShareIncludedModels());
+  config.SetShareIncludedModels(true);
+  EXPECT_TRUE(config.ShareIncludedModels());
+
+  EXPECT_FALSE(config.ShareMaterials());
+  config.SetShareMaterials(true);
+  EXPECT_TRUE(config.ShareMaterials());
+
+  EXPECT_FALSE(config.ShareMeshes());
+  config.SetShareMeshes(true);
+  EXPECT_TRUE(config.ShareMeshes());
+
+  EXPECT_FALSE(config.TrackIncludes());
+  config.SetTrackIncludes(true);
+  EXPECT_TRUE(config.TrackIncludes());
+
+  EXPECT_EQ(0u, config.MaxErrors());
+  config.SetMaxErrors(10u);
+  EXPECT_EQ(10u, config.MaxErrors());
+
+  EXPECT_FALSE(config.StreamingRead());
+  config.SetStreamingRead(true);
+  EXPECT_TRUE(config.StreamingRead());
+
+  EXPECT_FALSE(config.ReleaseElements());
+  config.SetReleaseElements(true);
+  EXPECT_TRUE(config.ReleaseElements());
+
+  EXPECT_FALSE(config.TrustedInput());
+  config.SetTrustedInput(true);
+  EXPECT_TRUE(config.TrustedInput());
+
+  EXPECT_FALSE(config.LazyModels());
+  config.SetLazyModels(true);
+  EXPECT_TRUE(config.LazyModels());
+
+  EXPECT_FALSE(config.RecordSourceRanges());
+  config.SetRecordSourceRanges(true);
+  EXPECT_TRUE(config.RecordSourceRanges());
+
+  EXPECT_FALSE(config.ChunkedXmlParse());
+  config.SetChunkedXmlParse(true);
+  EXPECT_TRUE(config.ChunkedXmlParse());
+
+  sdf::CancellationToken token;
+  EXPECT_EQ(nullptr, config.Cancellation());
+  config.SetCancellation(&token);
+  EXPECT_EQ(&token, config.Cancellation());
+
+  EXPECT_EQ(std::chrono::steady_clock::time_point::max(), config.Deadline());
+  const auto deadline = std::chrono::steady_clock::now();
+  config.SetDeadline(deadline);
+  EXPECT_EQ(deadline, config.Deadline());
+
+  EXPECT_TRUE(config.SkippedElements().empty());
+  config.SetSkippedElements({"visual"});
+  EXPECT_EQ(1u, config.SkippedElements().count("visual"));
+
+  config.SetLoadThreadCount(8u);
+  EXPECT_EQ(8u, config.LoadThreadCount());
+
+  config.SetLoadThreadCount(0u);
+  EXPECT_EQ(0u, config.LoadThreadCount());
+
+  EXPECT_EQ(nullptr, config.LoadExecutor());
+  config.SetLoadExecutor(sdf::Executor::Default());
+  EXPECT_EQ(sdf::Executor::Default(), config.LoadExecutor());
+}
+
+/////////////////////////////////////////////////
+TEST(ParserConfig, CopyConstruction)
+{
+  sdf::ParserConfig config;
+  config.SetLoadThreadCount(4u);
+  config.SetUseElementArena(true);
+  config.SetLoadCachePath("cache");
+
+  sdf::ParserConfig config2(config);
+  EXPECT_EQ(4u, config2.LoadThreadCount());
+  EXPECT_TRUE(config2.UseElementArena());
+  EXPECT_EQ("cache", config2.LoadCachePath());
+
+  config2.SetLoadThreadCount(2u);
+  EXPECT_EQ(4u, config.LoadThreadCount());
+  EXPECT_EQ(2u, config2.LoadThreadCount());
+}
+
+/////////////////////////////////////////////////
+TEST(ParserConfig, FindFileSettings)
+{
+  sdf::ParserConfig config;
+  EXPECT_TRUE(config.URIPathMap().empty());
+  EXPECT_FALSE(config.FindFileCallback());
+
+  // Only existing directories are added.
+  config.AddURIPath("test://", ".:/sdf_missing_dir:");
+  ASSERT_EQ(1u, config.URIPathMap().size());
+  ASSERT_EQ(1u, config.URIPathMap().at("test://").size());
+  EXPECT_EQ(".", config.URIPathMap().at("test://")[0]);
+
+  config.SetFindCallback([](const std::string &_file)
+      {
+        return "found_" + _file;
+      });
+  ASSERT_TRUE(config.FindFileCallback());
+  EXPECT_EQ("found_a", config.FindFileCallback()("a"));
+
+  // Copies are not affected by later changes.
+  sdf::ParserConfig config2(config);
+  config2.AddURIPath("other://", ".");
+  config2.SetFindCallback(nullptr);
+  EXPECT_EQ(1u, config.URIPathMap().size());
+  EXPECT_TRUE(config.FindFileCallback());
+  EXPECT_EQ(2u, config2.URIPathMap().size());
+  EXPECT_FALSE(config2.FindFileCallback());
+}
+
+/////////////////////////////////////////////////
+TEST(ParserConfig, CopyAssignmentAfterMove)
+{
+  sdf::ParserConfig config1;
+  config1.SetLoadThreadCount(3u);
+
+  sdf::ParserConfig config2;
+  config2.SetLoadThreadCount(5u);
+
+  sdf::ParserConfig tmp = std::move(config1);
+  config1 = config2;
+  config2 = tmp;
+
+  EXPECT_EQ(5u, config1.LoadThreadCount());
+  EXPECT_EQ(3u, config2.LoadThreadCount());
+}
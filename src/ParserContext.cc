@@ -0,0 +1,117 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <tinyxml2.h>
+
+#include <memory>
+#include <utility>
+
+#include "sdf/ParserContext.hh"
+#include "sdf/Root.hh"
+#include "ElementArena.hh"
+#include "XmlDocumentScope.hh"
+
+using namespace sdf;
+
+/// \brief Private data for sdf::ParserContext
+class sdf::ParserContextPrivate
+{
+  /// \brief Get the arena of the next load: the arena of the previous ones
+  /// once nothing else holds it, or else a new one.
+  /// \return The arena.
+  public: std::shared_ptr<ElementArena> NextArena()
+  {
+    if (this->arena && this->arena.use_count() == 1)
+      this->arena->Reset();
+    else
+      this->arena = makeElementArena(this->config.MemoryResource());
+    return this->arena;
+  }
+
+  /// \brief Configuration of the loads.
+  public: ParserConfig config;
+
+  /// \brief Document that the loads parse into.
+  public: std::unique_ptr<tinyxml2::XMLDocument> xmlDoc =
+      std::make_unique<tinyxml2::XMLDocument>();
+
+  /// \brief Arena of the last load.
+  public: std::shared_ptr<ElementArena> arena;
+};
+
+/////////////////////////////////////////////////
+ParserContext::ParserContext()
+  : dataPtr(new ParserContextPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+ParserContext::ParserContext(const ParserConfig &_config)
+  : dataPtr(new ParserContextPrivate)
+{
+  this->dataPtr->config = _config;
+}
+
+/////////////////////////////////////////////////
+ParserContext::ParserContext(ParserContext &&_context) noexcept
+  : dataPtr(std::exchange(_context.dataPtr, nullptr))
+{
+}
+
+/////////////////////////////////////////////////
+ParserContext &ParserContext::operator=(ParserContext &&_context) noexcept
+{
+  std::swap(this->dataPtr, _context.dataPtr);
+  return *this;
+}
+
+/////////////////////////////////////////////////
+ParserContext::~ParserContext()
+{
+  delete this->dataPtr;
+  this->dataPtr = nullptr;
+}
+
+/////////////////////////////////////////////////
+const ParserConfig &ParserContext::Config() const
+{
+  return this->dataPtr->config;
+}
+
+/////////////////////////////////////////////////
+Errors ParserContext::LoadSdfString(const std::string &_sdf, Root &_root)
+{
+  ElementArenaScope arenaScope(this->dataPtr->NextArena());
+  XmlDocumentScope docScope(this->dataPtr->xmlDoc.get());
+  return _root.LoadSdfString(_sdf, this->dataPtr->config);
+}
+
+/////////////////////////////////////////////////
+Errors ParserContext::LoadSdfBuffer(const char *_data, std::size_t _size,
+    Root &_root)
+{
+  ElementArenaScope arenaScope(this->dataPtr->NextArena());
+  XmlDocumentScope docScope(this->dataPtr->xmlDoc.get());
+  return _root.LoadSdfBuffer(_data, _size, this->dataPtr->config);
+}
+
+/////////////////////////////////////////////////
+void ParserContext::Reset()
+{
+  this->dataPtr->xmlDoc = std::make_unique<tinyxml2::XMLDocument>();
+  this->dataPtr->arena.reset();
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "sdf/Link.hh"
+#include "sdf/Model.hh"
+#include "sdf/ParserContext.hh"
+#include "sdf/Root.hh"
+
+/////////////////////////////////////////////////
+/// \brief A small model with a name and a number of links.
+/// \param[in] _name Name of the model.
+/// \param[in] _linkCount Number of links.
+/// \return SDF string of the model.
+static std::string smallModel(const std::string &_name, int _linkCount)
+{
+  std::string sdf = "<sdf version='1.8'><model name='" + _name + "'>";
+  for (int i = 0; i < _linkCount; ++i)
+    sdf += "<link name='l" + std::to_string(i) + "'/>";
+  return sdf + "</model></sdf>";
+}
+
+/////////////////////////////////////////////////
+TEST(ParserContext, LoadSdfString)
+{
+  sdf::ParserConfig config;
+  config.SetMaxErrors(3u);
+  sdf::ParserContext context(config);
+  EXPECT_EQ(3u, context.Config().MaxErrors());
+
+  // Roots that are kept hold the memory of their documents, while the
+  // following loads use new memory.
+  std::vector<sdf::Root> roots(10);
+  for (int i = 0; i < 10; ++i)
+  {
+    EXPECT_TRUE(context.LoadSdfString(
+          smallModel("m" + std::to_string(i), i + 1), roots[i]).empty());
+  }
+  for (int i = 0; i < 10; ++i)
+  {
+    const sdf::Model *model = roots[i].ModelByIndex(0);
+    ASSERT_NE(nullptr, model);
+    EXPECT_EQ("m" + std::to_string(i), model->Name());
+    EXPECT_EQ(static_cast<uint64_t>(i + 1), model->LinkCount());
+    EXPECT_EQ("l0", model->LinkByIndex(0)->Name());
+    ASSERT_NE(nullptr, model->Element());
+    EXPECT_EQ("m" + std::to_string(i),
+        model->Element()->Get<std::string>("name"));
+  }
+
+  // A failed read doesn't affect the next one.
+  sdf::Root invalid;
+  EXPECT_FALSE(context.LoadSdfString("<sdf version='1.8'><model", invalid)
+      .empty());
+
+  const std::string sdf = smallModel("buffer", 2);
+  sdf::Root root;
+  EXPECT_TRUE(context.LoadSdfBuffer(sdf.data(), sdf.size(), root).empty());
+  ASSERT_NE(nullptr, root.ModelByIndex(0));
+  EXPECT_EQ("buffer", root.ModelByIndex(0)->Name());
+
+  context.Reset();
+  sdf::Root afterReset;
+  EXPECT_TRUE(context.LoadSdfString(sdf, afterReset).empty());
+  ASSERT_NE(nullptr, afterReset.ModelByIndex(0));
+  EXPECT_EQ(2u, afterReset.ModelByIndex(0)->LinkCount());
+  EXPECT_EQ("buffer", root.ModelByIndex(0)->Name());
+
+  sdf::ParserContext moved(std::move(context));
+  EXPECT_EQ(3u, moved.Config().MaxErrors());
+}
+
+/////////////////////////////////////////////////
+TEST(ParserContext, ReuseMemory)
+{
+  // Without elements kept, every load resets the memory of the previous
+  // one, and the loaded objects stay valid.
+  sdf::ParserConfig config;
+  config.SetReleaseElements(true);
+  sdf::ParserContext context(config);
+  for (int i = 0; i < 100; ++i)
+  {
+    sdf::Root root;
+    ASSERT_TRUE(context.LoadSdfString(
+          smallModel("m" + std::to_string(i), i % 5 + 1), root).empty());
+    const sdf::Model *model = root.ModelByIndex(0);
+    ASSERT_NE(nullptr, model);
+    EXPECT_EQ("m" + std::to_string(i), model->Name());
+    EXPECT_EQ(static_cast<uint64_t>(i % 5 + 1), model->LinkCount());
+    EXPECT_EQ(nullptr, model->Element());
+  }
+}
@@ -21,6 +21,8 @@
 #include "sdf/Model.hh"
 #include "sdf/Types.hh"
 #include "sdf/Pbr.hh"
+#include "ElementRetentionScope.hh"
+#include "LoadStatsScope.hh"
 #include "Utils.hh"
 
 using namespace sdf;
@@ -153,9 +155,10 @@ bool PbrWorkflow::operator==(const PbrWorkflow &_workflow) const
 /////////////////////////////////////////////////
 Errors PbrWorkflow::Load(sdf::ElementPtr _sdf)
 {
+  DomLoadTimer timer("PbrWorkflow");
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Load the workflow element
   sdf::ElementPtr workflowElem;
@@ -426,9 +429,10 @@ Pbr &Pbr::operator=(Pbr &&_pbr)
 /////////////////////////////////////////////////
 Errors Pbr::Load(sdf::ElementPtr _sdf)
 {
+  DomLoadTimer timer("Pbr");
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that the provided SDF element is a <pbr>
   // This is an error that cannot be recovered, so return an error.
@@ -17,6 +17,8 @@
 #include <ignition/math/Vector3.hh>
 
 #include "sdf/Physics.hh"
+#include "ElementRetentionScope.hh"
+#include "LoadStatsScope.hh"
 #include "Utils.hh"
 
 using namespace sdf;
@@ -84,9 +86,10 @@ Physics &Physics::operator=(Physics &&_physics)
 /////////////////////////////////////////////////
 Errors Physics::Load(sdf::ElementPtr _sdf)
 {
+  DomLoadTimer timer("Physics");
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that the provided SDF element is a <physics>
   // This is an error that cannot be recovered, so return an error.
@@ -14,9 +14,13 @@
  * limitations under the License.
  *
 */
+#include <cmath>
+#include <ignition/math/Quaternion.hh>
 #include <ignition/math/Vector2.hh>
 #include <ignition/math/Vector3.hh>
 #include "sdf/Plane.hh"
+#include "ElementRetentionScope.hh"
+#include "LoadStatsScope.hh"
 
 using namespace sdf;
 
@@ -75,9 +79,10 @@ Plane &Plane::operator=(Plane &&_plane)
 /////////////////////////////////////////////////
 Errors Plane::Load(ElementPtr _sdf)
 {
+  DomLoadTimer timer("Plane");
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that sdf is a valid pointer
   if (!_sdf)
@@ -184,3 +189,26 @@ ignition::math::Planed &Plane::Shape()
 {
   return this->dataPtr->plane;
 }
+
+/////////////////////////////////////////////////
+ignition::math::AxisAlignedBox Plane::AxisAlignedBox() const
+{
+  // The sides of the rectangle are the x and y axes of a frame whose z axis
+  // is the normal.
+  ignition::math::Quaterniond rotation;
+  rotation.From2Axes(ignition::math::Vector3d::UnitZ, this->Normal());
+  const ignition::math::Vector3d u =
+    rotation.RotateVector(ignition::math::Vector3d::UnitX);
+  const ignition::math::Vector3d v =
+    rotation.RotateVector(ignition::math::Vector3d::UnitY);
+  const ignition::math::Vector2d half = this->Size() * 0.5;
+  const ignition::math::Vector3d extent =
+    u.Abs() * half.X() + v.Abs() * half.Y();
+  return ignition::math::AxisAlignedBox(-extent, extent);
+}
+
+/////////////////////////////////////////////////
+double Plane::BoundingRadius() const
+{
+  return std::hypot(this->Size().X(), this->Size().Y()) * 0.5;
+}
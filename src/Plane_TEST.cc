@@ -15,6 +15,7 @@
  *
 */
 
+#include <cmath>
 #include <gtest/gtest.h>
 #include <ignition/math/Vector3.hh>
 #include <ignition/math/Vector2.hh>
@@ -167,3 +168,20 @@ TEST(DOMPlane, Shape)
       plane.Shape().Offset());
   EXPECT_EQ(ignition::math::Vector2d(1, 2), plane.Size());
 }
+
+/////////////////////////////////////////////////
+TEST(DOMPlane, Bounds)
+{
+  sdf::Plane plane;
+  plane.SetSize(ignition::math::Vector2d(2, 4));
+  EXPECT_EQ(ignition::math::AxisAlignedBox(
+      ignition::math::Vector3d(-1, -2, 0), ignition::math::Vector3d(1, 2, 0)),
+      plane.AxisAlignedBox());
+
+  // The size is measured in the plane, whichever its normal.
+  plane.SetNormal(ignition::math::Vector3d::UnitX);
+  EXPECT_EQ(ignition::math::AxisAlignedBox(
+      ignition::math::Vector3d(0, -2, -1), ignition::math::Vector3d(0, 2, 1)),
+      plane.AxisAlignedBox());
+  EXPECT_DOUBLE_EQ(std::sqrt(5.0), plane.BoundingRadius());
+}
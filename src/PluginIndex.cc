@@ -0,0 +1,249 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "sdf/PluginIndex.hh"
+
+#include "SymbolTable.hh"
+#include "Tracing.hh"
+
+using namespace sdf;
+
+/// \brief Private data for PluginIndex
+class sdf::PluginIndexPrivate
+{
+  /// \brief Visit the plugins of an entity, then the entities below it.
+  /// \param[in] _elem Element of the entity.
+  /// \param[in] _scope Kind of the entity.
+  /// \param[in] _entity Scoped name of the entity.
+  public: void AddEntity(const ElementPtr &_elem, PluginScope _scope,
+              const std::string &_entity);
+
+  /// \brief Add the <plugin> children of an element.
+  /// \param[in] _elem Element with the plugins.
+  /// \param[in] _scope Kind of the entity.
+  /// \param[in] _entity Scoped name of the entity.
+  public: void AddPlugins(const ElementPtr &_elem, PluginScope _scope,
+              const std::string &_entity);
+
+  /// \brief Record the plugins added since an offset as the plugins of an
+  /// entity.
+  /// \param[in] _entity Scoped name of the entity.
+  /// \param[in] _offset Number of plugins before those of the entity.
+  public: void AddRange(const std::string &_entity, std::size_t _offset);
+
+  /// \brief The plugins, entity by entity.
+  public: std::vector<PluginDescriptor> plugins;
+
+  /// \brief Offset and count in plugins of the plugins of each entity.
+  public: std::unordered_map<std::string, std::pair<std::size_t, std::size_t>>
+              entities;
+};
+
+namespace
+{
+  const Symbol kGuiSymbol = SymbolTable::Intern("gui");
+  const Symbol kLinkSymbol = SymbolTable::Intern("link");
+  const Symbol kModelSymbol = SymbolTable::Intern("model");
+  const Symbol kPluginSymbol = SymbolTable::Intern("plugin");
+  const Symbol kSensorSymbol = SymbolTable::Intern("sensor");
+  const Symbol kVisualSymbol = SymbolTable::Intern("visual");
+  const Symbol kWorldSymbol = SymbolTable::Intern("world");
+
+  /// \brief Check the name of an element. Element names are interned, so
+  /// this is a pointer compare.
+  bool hasName(const ElementPtr &_elem, Symbol _name)
+  {
+    return &_elem->GetName() == _name;
+  }
+
+  /// \brief Scoped name of a child entity.
+  std::string childEntity(const std::string &_entity, const ElementPtr &_elem)
+  {
+    const std::string name = _elem->Get<std::string>("name");
+    return _entity + "::" + name;
+  }
+}
+
+/////////////////////////////////////////////////
+void PluginIndexPrivate::AddPlugins(const ElementPtr &_elem,
+    PluginScope _scope, const std::string &_entity)
+{
+  for (ElementPtr child = _elem->GetFirstElement(); child;
+       child = child->GetNextElement())
+  {
+    if (!hasName(child, kPluginSymbol))
+      continue;
+
+    PluginDescriptor plugin;
+    plugin.scope = _scope;
+    plugin.entity = _entity;
+    plugin.name = child->Get<std::string>("name");
+    plugin.filename = child->Get<std::string>("filename");
+    plugin.element = child;
+    this->plugins.push_back(std::move(plugin));
+  }
+}
+
+/////////////////////////////////////////////////
+void PluginIndexPrivate::AddRange(const std::string &_entity,
+    std::size_t _offset)
+{
+  if (this->plugins.size() > _offset)
+  {
+    // The first entity with a name keeps it, like the DOM lookups by name.
+    this->entities.emplace(_entity,
+        std::make_pair(_offset, this->plugins.size() - _offset));
+  }
+}
+
+/////////////////////////////////////////////////
+void PluginIndexPrivate::AddEntity(const ElementPtr &_elem,
+    PluginScope _scope, const std::string &_entity)
+{
+  const std::size_t offset = this->plugins.size();
+  this->AddPlugins(_elem, _scope, _entity);
+
+  // The <gui> plugins are listed with the plugins of their world.
+  if (_scope == PluginScope::WORLD)
+  {
+    for (ElementPtr gui = _elem->GetFirstElement(); gui;
+         gui = gui->GetNextElement())
+    {
+      if (hasName(gui, kGuiSymbol))
+        this->AddPlugins(gui, PluginScope::GUI, _entity);
+    }
+  }
+  this->AddRange(_entity, offset);
+
+  for (ElementPtr child = _elem->GetFirstElement(); child;
+       child = child->GetNextElement())
+  {
+    if (hasName(child, kModelSymbol))
+    {
+      if (_scope == PluginScope::WORLD || _scope == PluginScope::MODEL)
+      {
+        this->AddEntity(child, PluginScope::MODEL,
+            childEntity(_entity, child));
+      }
+    }
+    else if (hasName(child, kLinkSymbol))
+    {
+      if (_scope == PluginScope::MODEL)
+      {
+        this->AddEntity(child, PluginScope::LINK,
+            childEntity(_entity, child));
+      }
+    }
+    else if (_scope == PluginScope::LINK &&
+        (hasName(child, kSensorSymbol) || hasName(child, kVisualSymbol)))
+    {
+      const std::string entity = childEntity(_entity, child);
+      const std::size_t childOffset = this->plugins.size();
+      this->AddPlugins(child, hasName(child, kSensorSymbol) ?
+          PluginScope::SENSOR : PluginScope::VISUAL, entity);
+      this->AddRange(entity, childOffset);
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+PluginIndex::PluginIndex()
+  : dataPtr(new PluginIndexPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+PluginIndex::PluginIndex(const PluginIndex &_index)
+  : dataPtr(new PluginIndexPrivate(*_index.dataPtr))
+{
+}
+
+/////////////////////////////////////////////////
+PluginIndex::PluginIndex(PluginIndex &&_index) noexcept
+  : dataPtr(std::exchange(_index.dataPtr, nullptr))
+{
+}
+
+/////////////////////////////////////////////////
+PluginIndex &PluginIndex::operator=(PluginIndex &&_index) noexcept
+{
+  std::swap(this->dataPtr, _index.dataPtr);
+  return *this;
+}
+
+/////////////////////////////////////////////////
+PluginIndex &PluginIndex::operator=(const PluginIndex &_index)
+{
+  return *this = PluginIndex(_index);
+}
+
+/////////////////////////////////////////////////
+PluginIndex::~PluginIndex()
+{
+  delete this->dataPtr;
+  this->dataPtr = nullptr;
+}
+
+/////////////////////////////////////////////////
+void PluginIndex::Build(const ElementPtr &_root)
+{
+  SDF_TRACE_SCOPE("PluginIndex::Build");
+  this->dataPtr->plugins.clear();
+  this->dataPtr->entities.clear();
+  if (!_root)
+    return;
+
+  for (ElementPtr child = _root->GetFirstElement(); child;
+       child = child->GetNextElement())
+  {
+    if (hasName(child, kWorldSymbol))
+    {
+      this->dataPtr->AddEntity(child, PluginScope::WORLD,
+          child->Get<std::string>("name"));
+    }
+    else if (hasName(child, kModelSymbol))
+    {
+      this->dataPtr->AddEntity(child, PluginScope::MODEL,
+          child->Get<std::string>("name"));
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+Span<const PluginDescriptor> PluginIndex::Plugins() const
+{
+  return Span<const PluginDescriptor>(this->dataPtr->plugins.data(),
+      this->dataPtr->plugins.size());
+}
+
+/////////////////////////////////////////////////
+Span<const PluginDescriptor> PluginIndex::PluginsOf(
+    const std::string &_entity) const
+{
+  auto range = this->dataPtr->entities.find(_entity);
+  if (range == this->dataPtr->entities.end())
+    return Span<const PluginDescriptor>();
+  return Span<const PluginDescriptor>(
+      this->dataPtr->plugins.data() + range->second.first,
+      range->second.second);
+}
@@ -0,0 +1,150 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <string>
+#include "sdf/ParserConfig.hh"
+#include "sdf/PluginIndex.hh"
+#include "sdf/Root.hh"
+
+/////////////////////////////////////////////////
+TEST(DOMPluginIndex, Construction)
+{
+  sdf::PluginIndex index;
+  EXPECT_EQ(0u, index.Plugins().Size());
+  EXPECT_EQ(0u, index.PluginsOf("default").Size());
+
+  index.Build(nullptr);
+  EXPECT_EQ(0u, index.Plugins().Size());
+
+  sdf::Root root;
+  EXPECT_EQ(0u, root.Plugins().Plugins().Size());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMPluginIndex, World)
+{
+  const std::string sdfString = R"(
+  <sdf version="1.8">
+    <world name="default">
+      <plugin name="physics" filename="libphysics.so"/>
+      <gui>
+        <plugin name="scene" filename="libscene.so"/>
+      </gui>
+      <plugin name="sensors" filename="libsensors.so">
+        <render_engine>ogre2</render_engine>
+      </plugin>
+      <model name="robot">
+        <plugin name="drive" filename="libdrive.so"/>
+        <link name="base">
+          <visual name="v">
+            <geometry><box><size>1 1 1</size></box></geometry>
+            <plugin name="blink" filename="libblink.so"/>
+          </visual>
+          <sensor name="imu" type="imu">
+            <plugin name="imu" filename="libimu.so"/>
+          </sensor>
+        </link>
+        <model name="arm">
+          <link name="l"/>
+          <plugin name="controller" filename="libcontroller.so"/>
+        </model>
+      </model>
+      <model name="box">
+        <link name="l"/>
+      </model>
+    </world>
+  </sdf>)";
+
+  sdf::Root root;
+  ASSERT_TRUE(root.LoadSdfString(sdfString).empty());
+  const sdf::PluginIndex &index = root.Plugins();
+
+  // The world and its gui, then robot, its link and nested model.
+  auto plugins = index.Plugins();
+  ASSERT_EQ(7u, plugins.Size());
+  EXPECT_EQ("physics", plugins.begin()[0].name);
+  EXPECT_EQ("sensors", plugins.begin()[1].name);
+  EXPECT_EQ("scene", plugins.begin()[2].name);
+  EXPECT_EQ(sdf::PluginScope::GUI, plugins.begin()[2].scope);
+  EXPECT_EQ("drive", plugins.begin()[3].name);
+  EXPECT_EQ("blink", plugins.begin()[4].name);
+  EXPECT_EQ("imu", plugins.begin()[5].name);
+  EXPECT_EQ("controller", plugins.begin()[6].name);
+
+  auto world = index.PluginsOf("default");
+  ASSERT_EQ(3u, world.Size());
+  EXPECT_EQ(sdf::PluginScope::WORLD, world.begin()[0].scope);
+  EXPECT_EQ("default", world.begin()[0].entity);
+  EXPECT_EQ("libphysics.so", world.begin()[0].filename);
+  ASSERT_NE(nullptr, world.begin()[1].element);
+  EXPECT_EQ("ogre2", world.begin()[1].element->Get<std::string>(
+      "render_engine"));
+
+  auto model = index.PluginsOf("default::robot");
+  ASSERT_EQ(1u, model.Size());
+  EXPECT_EQ(sdf::PluginScope::MODEL, model.begin()->scope);
+  EXPECT_EQ("libdrive.so", model.begin()->filename);
+
+  auto visual = index.PluginsOf("default::robot::base::v");
+  ASSERT_EQ(1u, visual.Size());
+  EXPECT_EQ(sdf::PluginScope::VISUAL, visual.begin()->scope);
+  EXPECT_EQ("default::robot::base::v", visual.begin()->entity);
+
+  auto sensor = index.PluginsOf("default::robot::base::imu");
+  ASSERT_EQ(1u, sensor.Size());
+  EXPECT_EQ(sdf::PluginScope::SENSOR, sensor.begin()->scope);
+
+  auto nested = index.PluginsOf("default::robot::arm");
+  ASSERT_EQ(1u, nested.Size());
+  EXPECT_EQ("controller", nested.begin()->name);
+
+  EXPECT_EQ(0u, index.PluginsOf("default::box").Size());
+  EXPECT_EQ(0u, index.PluginsOf("default::robot::base").Size());
+  EXPECT_EQ(0u, index.PluginsOf("robot").Size());
+
+  sdf::PluginIndex copy(index);
+  EXPECT_EQ(7u, copy.Plugins().Size());
+  EXPECT_EQ(1u, copy.PluginsOf("default::robot::arm").Size());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMPluginIndex, ReleasedElements)
+{
+  const std::string sdfString = R"(
+  <sdf version="1.8">
+    <model name="robot">
+      <plugin name="drive" filename="libdrive.so">
+        <wheel>left</wheel>
+      </plugin>
+      <link name="base"/>
+    </model>
+  </sdf>)";
+
+  sdf::ParserConfig config;
+  config.SetReleaseElements(true);
+  sdf::Root root;
+  ASSERT_TRUE(root.LoadSdfString(sdfString, config).empty());
+  EXPECT_EQ(nullptr, root.Element());
+
+  // Plugins keep their elements.
+  auto plugins = root.Plugins().PluginsOf("robot");
+  ASSERT_EQ(1u, plugins.Size());
+  EXPECT_EQ(sdf::PluginScope::MODEL, plugins.begin()->scope);
+  ASSERT_NE(nullptr, plugins.begin()->element);
+  EXPECT_EQ("left", plugins.begin()->element->Get<std::string>("wheel"));
+}
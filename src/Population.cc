@@ -0,0 +1,641 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include <ignition/math/Helpers.hh>
+#include <ignition/math/Pose3.hh>
+
+#include "sdf/Box.hh"
+#include "sdf/Cylinder.hh"
+#include "sdf/Error.hh"
+#include "sdf/Model.hh"
+#include "sdf/Population.hh"
+#include "sdf/Types.hh"
+#include "ElementRetentionScope.hh"
+#include "LoadStatsScope.hh"
+#include "Utils.hh"
+
+using namespace sdf;
+
+/// \brief Instance positions generated from the distribution the first time
+/// they are requested. Copies start empty, and are generated again.
+class InstancePositions
+{
+  /// \brief Constructor.
+  public: InstancePositions() = default;
+
+  /// \brief Copy constructor, which doesn't copy the positions.
+  public: InstancePositions(const InstancePositions &)
+  {
+  }
+
+  /// \brief Get the positions, generating them if needed.
+  /// \param[in] _generate Function that generates the positions.
+  /// \return The positions.
+  public: template<typename F>
+          const std::vector<ignition::math::Vector3d> &Get(F _generate) const
+  {
+    if (!this->generated.load(std::memory_order_acquire))
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      if (!this->generated.load(std::memory_order_relaxed))
+      {
+        this->positions = _generate();
+        this->generated.store(true, std::memory_order_release);
+      }
+    }
+    return this->positions;
+  }
+
+  /// \brief Forget the positions, when the distribution changes.
+  public: void Reset()
+  {
+    this->generated = false;
+    this->positions.clear();
+  }
+
+  /// \brief True once positions are generated.
+  private: mutable std::atomic<bool> generated{false};
+
+  /// \brief Protects the generation.
+  private: mutable std::mutex mutex;
+
+  /// \brief Generated positions.
+  private: mutable std::vector<ignition::math::Vector3d> positions;
+};
+
+class sdf::PopulationPrivate
+{
+  /// \brief Name of the population.
+  public: std::string name = "";
+
+  /// \brief Number of models to place.
+  public: uint64_t modelCount = 1;
+
+  /// \brief Distribution of the models.
+  public: PopulationDistribution distribution =
+      PopulationDistribution::RANDOM;
+
+  /// \brief Number of rows of a grid.
+  public: uint64_t rows = 1;
+
+  /// \brief Number of columns of a grid.
+  public: uint64_t cols = 1;
+
+  /// \brief Distance between the cells of a grid.
+  public: ignition::math::Vector3d step{0.5, 0.5, 0};
+
+  /// \brief Box region, if any.
+  public: std::optional<Box> box;
+
+  /// \brief Cylinder region, if any.
+  public: std::optional<Cylinder> cylinder;
+
+  /// \brief Pose of the population frame.
+  public: ignition::math::Pose3d pose = ignition::math::Pose3d::Zero;
+
+  /// \brief Frame of the pose.
+  public: std::string poseRelativeTo = "";
+
+  /// \brief Model that every instance is a copy of.
+  public: std::optional<Model> model;
+
+  /// \brief Seed of the random distribution.
+  public: uint32_t seed = 0;
+
+  /// \brief Positions of the instances.
+  public: InstancePositions positions;
+
+  /// \brief The SDF element pointer used during load.
+  public: sdf::ElementPtr sdf;
+};
+
+/////////////////////////////////////////////////
+/// \brief Get the distribution named by //distribution/type.
+/// \param[in] _type Type of the distribution.
+/// \param[out] _distribution The distribution.
+/// \return True if _type is a known distribution.
+static bool distributionFromString(const std::string &_type,
+    PopulationDistribution &_distribution)
+{
+  static const std::pair<const char *, PopulationDistribution> kTypes[] =
+  {
+    {"random", PopulationDistribution::RANDOM},
+    {"uniform", PopulationDistribution::UNIFORM},
+    {"grid", PopulationDistribution::GRID},
+    {"linear-x", PopulationDistribution::LINEAR_X},
+    {"linear-y", PopulationDistribution::LINEAR_Y},
+    {"linear-z", PopulationDistribution::LINEAR_Z}
+  };
+
+  for (const auto &type : kTypes)
+  {
+    if (_type == type.first)
+    {
+      _distribution = type.second;
+      return true;
+    }
+  }
+  return false;
+}
+
+/////////////////////////////////////////////////
+/// \brief Generate the instance positions of a population.
+/// \param[in] _data Population data.
+/// \param[in] _count Number of instances.
+/// \return Position of each instance in the population frame.
+static std::vector<ignition::math::Vector3d> generatePositions(
+    const PopulationPrivate &_data, uint64_t _count)
+{
+  using ignition::math::Vector3d;
+  std::vector<Vector3d> positions;
+  positions.reserve(_count);
+
+  if (_data.distribution == PopulationDistribution::GRID)
+  {
+    for (uint64_t row = 0; row < _data.rows; ++row)
+    {
+      for (uint64_t col = 0; col < _data.cols; ++col)
+      {
+        positions.emplace_back(col * _data.step.X(), row * _data.step.Y(),
+            0.0);
+      }
+    }
+    return positions;
+  }
+
+  // Every other distribution places the models in the region, centered on
+  // the population frame.
+  Vector3d size = Vector3d::Zero;
+  if (_data.box)
+  {
+    size = _data.box->Size();
+  }
+  else if (_data.cylinder)
+  {
+    size.Set(2 * _data.cylinder->Radius(), 2 * _data.cylinder->Radius(),
+        _data.cylinder->Length());
+  }
+
+  switch (_data.distribution)
+  {
+    case PopulationDistribution::RANDOM:
+    {
+      std::mt19937 generator(_data.seed);
+      std::uniform_real_distribution<double> unit(0.0, 1.0);
+      for (uint64_t i = 0; i < _count; ++i)
+      {
+        if (_data.cylinder)
+        {
+          // Uniform over the area of the disc.
+          const double radius = _data.cylinder->Radius() *
+              std::sqrt(unit(generator));
+          const double angle = 2 * IGN_PI * unit(generator);
+          positions.emplace_back(radius * std::cos(angle),
+              radius * std::sin(angle), (unit(generator) - 0.5) * size.Z());
+        }
+        else
+        {
+          const double x = (unit(generator) - 0.5) * size.X();
+          const double y = (unit(generator) - 0.5) * size.Y();
+          const double z = (unit(generator) - 0.5) * size.Z();
+          positions.emplace_back(x, y, z);
+        }
+      }
+      break;
+    }
+    case PopulationDistribution::UNIFORM:
+    {
+      if (_data.cylinder)
+      {
+        // Sunflower spiral, which covers a disc evenly.
+        const double goldenAngle = IGN_PI * (3.0 - std::sqrt(5.0));
+        for (uint64_t i = 0; i < _count; ++i)
+        {
+          const double radius = _data.cylinder->Radius() *
+              std::sqrt((i + 0.5) / static_cast<double>(_count));
+          const double angle = i * goldenAngle;
+          positions.emplace_back(radius * std::cos(angle),
+              radius * std::sin(angle), 0.0);
+        }
+      }
+      else
+      {
+        // Centers of the cells of the smallest square grid that fits the
+        // models, filled row by row.
+        const uint64_t side = static_cast<uint64_t>(
+            std::ceil(std::sqrt(static_cast<double>(_count))));
+        for (uint64_t i = 0; i < _count; ++i)
+        {
+          const double x = ((i % side) + 0.5) / side - 0.5;
+          const double y = ((i / side) + 0.5) / side - 0.5;
+          positions.emplace_back(x * size.X(), y * size.Y(), 0.0);
+        }
+      }
+      break;
+    }
+    case PopulationDistribution::LINEAR_X:
+    case PopulationDistribution::LINEAR_Y:
+    case PopulationDistribution::LINEAR_Z:
+    {
+      const int axis =
+          static_cast<int>(_data.distribution) -
+          static_cast<int>(PopulationDistribution::LINEAR_X);
+      for (uint64_t i = 0; i < _count; ++i)
+      {
+        Vector3d position = Vector3d::Zero;
+        position[axis] = ((i + 0.5) / _count - 0.5) * size[axis];
+        positions.push_back(position);
+      }
+      break;
+    }
+    case PopulationDistribution::GRID:
+    default:
+      break;
+  }
+  return positions;
+}
+
+/////////////////////////////////////////////////
+Population::Population()
+  : dataPtr(new PopulationPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+Population::~Population()
+{
+  delete this->dataPtr;
+  this->dataPtr = nullptr;
+}
+
+/////////////////////////////////////////////////
+Population::Population(const Population &_population)
+  : dataPtr(new PopulationPrivate(*_population.dataPtr))
+{
+}
+
+/////////////////////////////////////////////////
+Population::Population(Population &&_population) noexcept
+  : dataPtr(std::exchange(_population.dataPtr, nullptr))
+{
+}
+
+/////////////////////////////////////////////////
+Population &Population::operator=(const Population &_population)
+{
+  return *this = Population(_population);
+}
+
+/////////////////////////////////////////////////
+Population &Population::operator=(Population &&_population) noexcept
+{
+  std::swap(this->dataPtr, _population.dataPtr);
+  return *this;
+}
+
+/////////////////////////////////////////////////
+Errors Population::Load(ElementPtr _sdf)
+{
+  DomLoadTimer timer("Population");
+  Errors errors;
+
+  this->dataPtr->sdf = retainedElement(_sdf);
+  this->dataPtr->positions.Reset();
+
+  // Check that the provided SDF element is a <population>
+  // This is an error that cannot be recovered, so return an error.
+  if (_sdf->GetName() != "population")
+  {
+    errors.push_back({ErrorCode::ELEMENT_INCORRECT_TYPE,
+        "Attempting to load a Population, but the provided SDF element is "
+        "not a <population>."});
+    return errors;
+  }
+
+  // Read the population's name
+  if (!loadName(_sdf, this->dataPtr->name))
+  {
+    errors.push_back({ErrorCode::ATTRIBUTE_MISSING,
+                     "A population name is required, but the name is not "
+                     "set."});
+  }
+
+  // Load the pose. Ignore the return value since the pose is optional.
+  loadPose(_sdf, this->dataPtr->pose, this->dataPtr->poseRelativeTo);
+
+  const int modelCount = _sdf->Get<int>("model_count", 1).first;
+  if (modelCount < 0)
+  {
+    errors.push_back({ErrorCode::ELEMENT_INVALID,
+        "The model_count of population[" + this->dataPtr->name +
+        "] must not be negative."});
+  }
+  else
+  {
+    this->dataPtr->modelCount = static_cast<uint64_t>(modelCount);
+  }
+
+  if (_sdf->HasElement("distribution"))
+  {
+    ElementPtr elem = _sdf->GetElement("distribution");
+    const std::string type = elem->Get<std::string>("type", "random").first;
+    if (!distributionFromString(type, this->dataPtr->distribution))
+    {
+      errors.push_back({ErrorCode::ELEMENT_INVALID,
+          "Unknown distribution type[" + type + "] in population[" +
+          this->dataPtr->name + "]."});
+    }
+
+    const int rows = elem->Get<int>("rows", 1).first;
+    const int cols = elem->Get<int>("cols", 1).first;
+    if (rows < 0 || cols < 0)
+    {
+      errors.push_back({ErrorCode::ELEMENT_INVALID,
+          "The rows and cols of population[" + this->dataPtr->name +
+          "] must not be negative."});
+    }
+    else
+    {
+      this->dataPtr->rows = static_cast<uint64_t>(rows);
+      this->dataPtr->cols = static_cast<uint64_t>(cols);
+    }
+    this->dataPtr->step = elem->Get<ignition::math::Vector3d>("step",
+        this->dataPtr->step).first;
+  }
+
+  this->dataPtr->box.reset();
+  this->dataPtr->cylinder.reset();
+  if (_sdf->HasElement("box"))
+  {
+    this->dataPtr->box.emplace();
+    Errors boxErrors = this->dataPtr->box->Load(_sdf->GetElement("box"));
+    errors.insert(errors.end(), boxErrors.begin(), boxErrors.end());
+  }
+  else if (_sdf->HasElement("cylinder"))
+  {
+    this->dataPtr->cylinder.emplace();
+    Errors cylinderErrors =
+        this->dataPtr->cylinder->Load(_sdf->GetElement("cylinder"));
+    errors.insert(errors.end(), cylinderErrors.begin(), cylinderErrors.end());
+  }
+  else if (this->dataPtr->distribution != PopulationDistribution::GRID)
+  {
+    errors.push_back({ErrorCode::ELEMENT_MISSING,
+        "Population[" + this->dataPtr->name + "] requires a <box> or "
+        "<cylinder> region for its distribution."});
+  }
+
+  // Load the template model once; the instances only store positions.
+  this->dataPtr->model.reset();
+  if (_sdf->HasElement("model"))
+  {
+    this->dataPtr->model.emplace();
+    Errors modelErrors = this->dataPtr->model->Load(_sdf->GetElement("model"));
+    errors.insert(errors.end(), modelErrors.begin(), modelErrors.end());
+
+    // No graphs are built for the template while loading.
+    if (ElementRetentionScope::Release())
+      this->dataPtr->model->ReleaseElement();
+  }
+  else
+  {
+    errors.push_back({ErrorCode::ELEMENT_MISSING,
+        "Population[" + this->dataPtr->name + "] requires a <model>."});
+  }
+
+  return errors;
+}
+
+/////////////////////////////////////////////////
+const std::string &Population::Name() const
+{
+  return this->dataPtr->name;
+}
+
+/////////////////////////////////////////////////
+void Population::SetName(const std::string &_name)
+{
+  this->dataPtr->name = _name;
+}
+
+/////////////////////////////////////////////////
+uint64_t Population::ModelCount() const
+{
+  return this->dataPtr->modelCount;
+}
+
+/////////////////////////////////////////////////
+void Population::SetModelCount(uint64_t _count)
+{
+  this->dataPtr->modelCount = _count;
+  this->dataPtr->positions.Reset();
+}
+
+/////////////////////////////////////////////////
+PopulationDistribution Population::Distribution() const
+{
+  return this->dataPtr->distribution;
+}
+
+/////////////////////////////////////////////////
+void Population::SetDistribution(PopulationDistribution _distribution)
+{
+  this->dataPtr->distribution = _distribution;
+  this->dataPtr->positions.Reset();
+}
+
+/////////////////////////////////////////////////
+uint64_t Population::Rows() const
+{
+  return this->dataPtr->rows;
+}
+
+/////////////////////////////////////////////////
+void Population::SetRows(uint64_t _rows)
+{
+  this->dataPtr->rows = _rows;
+  this->dataPtr->positions.Reset();
+}
+
+/////////////////////////////////////////////////
+uint64_t Population::Cols() const
+{
+  return this->dataPtr->cols;
+}
+
+/////////////////////////////////////////////////
+void Population::SetCols(uint64_t _cols)
+{
+  this->dataPtr->cols = _cols;
+  this->dataPtr->positions.Reset();
+}
+
+/////////////////////////////////////////////////
+const ignition::math::Vector3d &Population::Step() const
+{
+  return this->dataPtr->step;
+}
+
+/////////////////////////////////////////////////
+void Population::SetStep(const ignition::math::Vector3d &_step)
+{
+  this->dataPtr->step = _step;
+  this->dataPtr->positions.Reset();
+}
+
+/////////////////////////////////////////////////
+const Box *Population::BoxShape() const
+{
+  return this->dataPtr->box ? &*this->dataPtr->box : nullptr;
+}
+
+/////////////////////////////////////////////////
+void Population::SetBoxShape(const Box &_box)
+{
+  this->dataPtr->box = _box;
+  this->dataPtr->cylinder.reset();
+  this->dataPtr->positions.Reset();
+}
+
+/////////////////////////////////////////////////
+const Cylinder *Population::CylinderShape() const
+{
+  return this->dataPtr->cylinder ? &*this->dataPtr->cylinder : nullptr;
+}
+
+/////////////////////////////////////////////////
+void Population::SetCylinderShape(const Cylinder &_cylinder)
+{
+  this->dataPtr->cylinder = _cylinder;
+  this->dataPtr->box.reset();
+  this->dataPtr->positions.Reset();
+}
+
+/////////////////////////////////////////////////
+const ignition::math::Pose3d &Population::RawPose() const
+{
+  return this->dataPtr->pose;
+}
+
+/////////////////////////////////////////////////
+void Population::SetRawPose(const ignition::math::Pose3d &_pose)
+{
+  this->dataPtr->pose = _pose;
+}
+
+/////////////////////////////////////////////////
+const std::string &Population::PoseRelativeTo() const
+{
+  return this->dataPtr->poseRelativeTo;
+}
+
+/////////////////////////////////////////////////
+void Population::SetPoseRelativeTo(const std::string &_frame)
+{
+  this->dataPtr->poseRelativeTo = _frame;
+}
+
+/////////////////////////////////////////////////
+const Model *Population::ModelTemplate() const
+{
+  return this->dataPtr->model ? &*this->dataPtr->model : nullptr;
+}
+
+/////////////////////////////////////////////////
+void Population::SetModelTemplate(const Model &_model)
+{
+  this->dataPtr->model = _model;
+}
+
+/////////////////////////////////////////////////
+uint32_t Population::Seed() const
+{
+  return this->dataPtr->seed;
+}
+
+/////////////////////////////////////////////////
+void Population::SetSeed(uint32_t _seed)
+{
+  this->dataPtr->seed = _seed;
+  this->dataPtr->positions.Reset();
+}
+
+/////////////////////////////////////////////////
+uint64_t Population::InstanceCount() const
+{
+  if (this->dataPtr->distribution == PopulationDistribution::GRID)
+    return this->dataPtr->rows * this->dataPtr->cols;
+  return this->dataPtr->modelCount;
+}
+
+/////////////////////////////////////////////////
+const std::vector<ignition::math::Vector3d> &
+Population::InstancePositions() const
+{
+  return this->dataPtr->positions.Get([this]()
+  {
+    return generatePositions(*this->dataPtr, this->InstanceCount());
+  });
+}
+
+/////////////////////////////////////////////////
+std::string Population::InstanceName(uint64_t _index) const
+{
+  if (!this->dataPtr->model || _index >= this->InstanceCount())
+    return "";
+  return this->dataPtr->model->Name() + "_clone_" + std::to_string(_index);
+}
+
+/////////////////////////////////////////////////
+ignition::math::Pose3d Population::InstancePose(uint64_t _index) const
+{
+  if (!this->dataPtr->model || _index >= this->InstanceCount())
+    return ignition::math::Pose3d::Zero;
+
+  // The template pose is expressed in the frame of the instance, which is
+  // the population frame moved to the position of the instance.
+  const ignition::math::Pose3d instanceFrame(
+      this->InstancePositions()[_index], ignition::math::Quaterniond::Identity);
+  return this->dataPtr->model->RawPose() * instanceFrame * this->dataPtr->pose;
+}
+
+/////////////////////////////////////////////////
+Model Population::InstanceModel(uint64_t _index) const
+{
+  if (!this->dataPtr->model || _index >= this->InstanceCount())
+    return Model();
+
+  Model model(*this->dataPtr->model);
+  model.SetName(this->InstanceName(_index));
+  model.SetRawPose(this->InstancePose(_index));
+  model.SetPoseRelativeTo(this->dataPtr->poseRelativeTo);
+  return model;
+}
+
+/////////////////////////////////////////////////
+sdf::ElementPtr Population::Element() const
+{
+  return this->dataPtr->sdf;
+}
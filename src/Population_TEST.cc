@@ -0,0 +1,168 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Vector3.hh>
+#include "sdf/Box.hh"
+#include "sdf/Cylinder.hh"
+#include "sdf/Model.hh"
+#include "sdf/Population.hh"
+
+/////////////////////////////////////////////////
+TEST(DOMPopulation, Construction)
+{
+  sdf::Population population;
+  EXPECT_EQ(nullptr, population.Element());
+  EXPECT_TRUE(population.Name().empty());
+  EXPECT_EQ(1u, population.ModelCount());
+  EXPECT_EQ(sdf::PopulationDistribution::RANDOM, population.Distribution());
+  EXPECT_EQ(1u, population.Rows());
+  EXPECT_EQ(1u, population.Cols());
+  EXPECT_EQ(ignition::math::Vector3d(0.5, 0.5, 0), population.Step());
+  EXPECT_EQ(nullptr, population.BoxShape());
+  EXPECT_EQ(nullptr, population.CylinderShape());
+  EXPECT_EQ(nullptr, population.ModelTemplate());
+  EXPECT_EQ(0u, population.Seed());
+  EXPECT_EQ(1u, population.InstanceCount());
+
+  // Without a template there are no instances to name.
+  EXPECT_TRUE(population.InstanceName(0).empty());
+  EXPECT_TRUE(population.InstanceModel(0).Name().empty());
+
+  population.SetName("trees");
+  EXPECT_EQ("trees", population.Name());
+
+  sdf::Box box;
+  box.SetSize({2, 4, 0});
+  population.SetBoxShape(box);
+  ASSERT_NE(nullptr, population.BoxShape());
+  EXPECT_EQ(ignition::math::Vector3d(2, 4, 0), population.BoxShape()->Size());
+
+  // Setting a cylinder replaces the box.
+  population.SetCylinderShape(sdf::Cylinder());
+  EXPECT_EQ(nullptr, population.BoxShape());
+  EXPECT_NE(nullptr, population.CylinderShape());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMPopulation, Grid)
+{
+  sdf::Model model;
+  model.SetName("tree");
+  model.SetRawPose({0, 0, 1, 0, 0, 0});
+
+  sdf::Population population;
+  population.SetModelTemplate(model);
+  population.SetDistribution(sdf::PopulationDistribution::GRID);
+  population.SetRows(2);
+  population.SetCols(3);
+  population.SetStep({1, 2, 0});
+  population.SetRawPose({10, 0, 0, 0, 0, 0});
+  population.SetPoseRelativeTo("ground");
+
+  ASSERT_EQ(6u, population.InstanceCount());
+  const auto &positions = population.InstancePositions();
+  ASSERT_EQ(6u, positions.size());
+  EXPECT_EQ(ignition::math::Vector3d(0, 0, 0), positions[0]);
+  EXPECT_EQ(ignition::math::Vector3d(2, 0, 0), positions[2]);
+  EXPECT_EQ(ignition::math::Vector3d(1, 2, 0), positions[4]);
+
+  EXPECT_EQ("tree_clone_4", population.InstanceName(4));
+  EXPECT_EQ(ignition::math::Pose3d(11, 2, 1, 0, 0, 0),
+      population.InstancePose(4));
+  EXPECT_TRUE(population.InstanceName(6).empty());
+
+  sdf::Model instance = population.InstanceModel(5);
+  EXPECT_EQ("tree_clone_5", instance.Name());
+  EXPECT_EQ(ignition::math::Pose3d(12, 2, 1, 0, 0, 0), instance.RawPose());
+  EXPECT_EQ("ground", instance.PoseRelativeTo());
+
+  // The template is unchanged.
+  ASSERT_NE(nullptr, population.ModelTemplate());
+  EXPECT_EQ("tree", population.ModelTemplate()->Name());
+
+  // Changing the grid generates the positions again.
+  population.SetCols(1);
+  EXPECT_EQ(2u, population.InstancePositions().size());
+  EXPECT_EQ(ignition::math::Vector3d(0, 2, 0),
+      population.InstancePositions()[1]);
+}
+
+/////////////////////////////////////////////////
+TEST(DOMPopulation, Distributions)
+{
+  sdf::Box box;
+  box.SetSize({4, 2, 1});
+
+  sdf::Population population;
+  population.SetBoxShape(box);
+  population.SetModelCount(100);
+
+  // Random positions are in the box, and the same for a seed.
+  population.SetSeed(7);
+  const std::vector<ignition::math::Vector3d> random =
+      population.InstancePositions();
+  ASSERT_EQ(100u, random.size());
+  for (const auto &position : random)
+  {
+    EXPECT_LE(std::abs(position.X()), 2.0);
+    EXPECT_LE(std::abs(position.Y()), 1.0);
+    EXPECT_LE(std::abs(position.Z()), 0.5);
+  }
+  sdf::Population copy(population);
+  EXPECT_EQ(random, copy.InstancePositions());
+
+  population.SetSeed(8);
+  EXPECT_NE(random, population.InstancePositions());
+
+  // Uniform positions are the centers of a 10 by 10 grid of cells.
+  population.SetDistribution(sdf::PopulationDistribution::UNIFORM);
+  ASSERT_EQ(100u, population.InstancePositions().size());
+  EXPECT_EQ(ignition::math::Vector3d(-1.8, -0.9, 0),
+      population.InstancePositions()[0]);
+  EXPECT_EQ(ignition::math::Vector3d(1.8, 0.9, 0),
+      population.InstancePositions()[99]);
+
+  // Linear positions are evenly spaced along an axis.
+  population.SetModelCount(4);
+  population.SetDistribution(sdf::PopulationDistribution::LINEAR_X);
+  ASSERT_EQ(4u, population.InstancePositions().size());
+  EXPECT_EQ(ignition::math::Vector3d(-1.5, 0, 0),
+      population.InstancePositions()[0]);
+  EXPECT_EQ(ignition::math::Vector3d(1.5, 0, 0),
+      population.InstancePositions()[3]);
+
+  // Positions in a cylinder are within its radius.
+  sdf::Cylinder cylinder;
+  cylinder.SetRadius(3);
+  cylinder.SetLength(2);
+  population.SetCylinderShape(cylinder);
+  population.SetModelCount(50);
+  population.SetDistribution(sdf::PopulationDistribution::UNIFORM);
+  for (const auto &position : population.InstancePositions())
+  {
+    EXPECT_LE(std::hypot(position.X(), position.Y()), 3.0);
+  }
+
+  population.SetDistribution(sdf::PopulationDistribution::LINEAR_Z);
+  population.SetModelCount(2);
+  EXPECT_EQ(ignition::math::Vector3d(0, 0, 0.5),
+      population.InstancePositions()[1]);
+}
@@ -0,0 +1,241 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "PoseBatch.hh"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace sdf
+{
+// Inline bracket to help doxygen filtering.
+inline namespace SDF_VERSION_NAMESPACE {
+
+/// \brief Number of doubles in an aligned block.
+static constexpr std::size_t kBlockSize = kCacheLineAlignment / sizeof(double);
+
+/////////////////////////////////////////////////
+PoseBatch::PoseBatch(std::size_t _count)
+{
+  this->Resize(_count);
+}
+
+/////////////////////////////////////////////////
+void PoseBatch::Resize(std::size_t _count)
+{
+  this->count = _count;
+  this->stride = (_count + kBlockSize - 1) / kBlockSize * kBlockSize;
+  this->data.assign(this->stride * 7, 0.0);
+  for (std::size_t k = 0; k < _count; ++k)
+    this->data[k] = 1.0;
+}
+
+/////////////////////////////////////////////////
+std::size_t PoseBatch::Size() const
+{
+  return this->count;
+}
+
+/////////////////////////////////////////////////
+void PoseBatch::Set(std::size_t _index, const ignition::math::Pose3d &_pose)
+{
+  double *column = this->data.data() + _index;
+  column[0] = _pose.Rot().W();
+  column[this->stride] = _pose.Rot().X();
+  column[this->stride * 2] = _pose.Rot().Y();
+  column[this->stride * 3] = _pose.Rot().Z();
+  column[this->stride * 4] = _pose.Pos().X();
+  column[this->stride * 5] = _pose.Pos().Y();
+  column[this->stride * 6] = _pose.Pos().Z();
+}
+
+/////////////////////////////////////////////////
+ignition::math::Pose3d PoseBatch::Get(std::size_t _index) const
+{
+  const double *column = this->data.data() + _index;
+  return ignition::math::Pose3d(
+      column[this->stride * 4], column[this->stride * 5],
+      column[this->stride * 6], column[0], column[this->stride],
+      column[this->stride * 2], column[this->stride * 3]);
+}
+
+/////////////////////////////////////////////////
+PoseArrays PoseBatch::Arrays()
+{
+  double *d = this->data.data();
+  const std::size_t s = this->stride;
+  return {d, d + s, d + s * 2, d + s * 3, d + s * 4, d + s * 5, d + s * 6};
+}
+
+/////////////////////////////////////////////////
+ConstPoseArrays PoseBatch::Arrays() const
+{
+  return const_cast<PoseBatch *>(this)->Arrays();
+}
+
+/// \brief Operations on one double, for the poses that don't fill a SIMD
+/// register.
+struct ScalarLanes
+{
+  using Vector = double;
+  static constexpr std::size_t kWidth = 1;
+  static Vector Load(const double *_p) { return *_p; }
+  static void Store(double *_p, Vector _v) { *_p = _v; }
+  static Vector Add(Vector _a, Vector _b) { return _a + _b; }
+  static Vector Sub(Vector _a, Vector _b) { return _a - _b; }
+  static Vector Mul(Vector _a, Vector _b) { return _a * _b; }
+};
+
+#if defined(__AVX__)
+/// \brief Operations on four doubles with AVX.
+struct SimdLanes
+{
+  using Vector = __m256d;
+  static constexpr std::size_t kWidth = 4;
+  static constexpr const char *kName = "AVX";
+  static Vector Load(const double *_p) { return _mm256_loadu_pd(_p); }
+  static void Store(double *_p, Vector _v) { _mm256_storeu_pd(_p, _v); }
+  static Vector Add(Vector _a, Vector _b) { return _mm256_add_pd(_a, _b); }
+  static Vector Sub(Vector _a, Vector _b) { return _mm256_sub_pd(_a, _b); }
+  static Vector Mul(Vector _a, Vector _b) { return _mm256_mul_pd(_a, _b); }
+};
+#elif defined(__SSE2__) || defined(_M_X64)
+/// \brief Operations on two doubles with SSE2.
+struct SimdLanes
+{
+  using Vector = __m128d;
+  static constexpr std::size_t kWidth = 2;
+  static constexpr const char *kName = "SSE2";
+  static Vector Load(const double *_p) { return _mm_loadu_pd(_p); }
+  static void Store(double *_p, Vector _v) { _mm_storeu_pd(_p, _v); }
+  static Vector Add(Vector _a, Vector _b) { return _mm_add_pd(_a, _b); }
+  static Vector Sub(Vector _a, Vector _b) { return _mm_sub_pd(_a, _b); }
+  static Vector Mul(Vector _a, Vector _b) { return _mm_mul_pd(_a, _b); }
+};
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+/// \brief Operations on two doubles with NEON.
+struct SimdLanes
+{
+  using Vector = float64x2_t;
+  static constexpr std::size_t kWidth = 2;
+  static constexpr const char *kName = "NEON";
+  static Vector Load(const double *_p) { return vld1q_f64(_p); }
+  static void Store(double *_p, Vector _v) { vst1q_f64(_p, _v); }
+  static Vector Add(Vector _a, Vector _b) { return vaddq_f64(_a, _b); }
+  static Vector Sub(Vector _a, Vector _b) { return vsubq_f64(_a, _b); }
+  static Vector Mul(Vector _a, Vector _b) { return vmulq_f64(_a, _b); }
+};
+#else
+/// \brief Without SIMD instructions, poses are composed one by one.
+struct SimdLanes : ScalarLanes
+{
+  static constexpr const char *kName = "scalar";
+};
+#endif
+
+/////////////////////////////////////////////////
+/// \brief Compose poses from a starting index, as many at a time as the
+/// lanes hold.
+/// \param[in] _begin Index of the first pose.
+/// \param[in] _count Number of poses.
+/// \param[in] _parent Poses of the parents.
+/// \param[in] _child Poses of the children relative to their parents.
+/// \param[out] _out Poses of the children.
+/// \return Index after the last pose that was composed.
+template<typename L>
+static std::size_t composeLanes(std::size_t _begin, std::size_t _count,
+    const ConstPoseArrays &_parent, const ConstPoseArrays &_child,
+    const PoseArrays &_out)
+{
+  std::size_t k = _begin;
+  for (; k + L::kWidth <= _count; k += L::kWidth)
+  {
+    const auto pw = L::Load(_parent.qw + k);
+    const auto pvx = L::Load(_parent.qx + k);
+    const auto pvy = L::Load(_parent.qy + k);
+    const auto pvz = L::Load(_parent.qz + k);
+    const auto cw = L::Load(_child.qw + k);
+    const auto cvx = L::Load(_child.qx + k);
+    const auto cvy = L::Load(_child.qy + k);
+    const auto cvz = L::Load(_child.qz + k);
+    const auto cx = L::Load(_child.px + k);
+    const auto cy = L::Load(_child.py + k);
+    const auto cz = L::Load(_child.pz + k);
+
+    // Rotate the position of the child, p + 2 w (v x c) + 2 v x (v x c),
+    // with t = 2 (v x c).
+    auto tx = L::Sub(L::Mul(pvy, cz), L::Mul(pvz, cy));
+    auto ty = L::Sub(L::Mul(pvz, cx), L::Mul(pvx, cz));
+    auto tz = L::Sub(L::Mul(pvx, cy), L::Mul(pvy, cx));
+    tx = L::Add(tx, tx);
+    ty = L::Add(ty, ty);
+    tz = L::Add(tz, tz);
+    const auto x = L::Add(L::Add(L::Load(_parent.px + k), cx), L::Add(
+        L::Mul(pw, tx), L::Sub(L::Mul(pvy, tz), L::Mul(pvz, ty))));
+    const auto y = L::Add(L::Add(L::Load(_parent.py + k), cy), L::Add(
+        L::Mul(pw, ty), L::Sub(L::Mul(pvz, tx), L::Mul(pvx, tz))));
+    const auto z = L::Add(L::Add(L::Load(_parent.pz + k), cz), L::Add(
+        L::Mul(pw, tz), L::Sub(L::Mul(pvx, ty), L::Mul(pvy, tx))));
+
+    const auto w = L::Sub(L::Sub(L::Mul(pw, cw), L::Mul(pvx, cvx)),
+        L::Add(L::Mul(pvy, cvy), L::Mul(pvz, cvz)));
+    const auto vx = L::Add(L::Add(L::Mul(pw, cvx), L::Mul(pvx, cw)),
+        L::Sub(L::Mul(pvy, cvz), L::Mul(pvz, cvy)));
+    const auto vy = L::Add(L::Sub(L::Mul(pw, cvy), L::Mul(pvx, cvz)),
+        L::Add(L::Mul(pvy, cw), L::Mul(pvz, cvx)));
+    const auto vz = L::Add(L::Add(L::Mul(pw, cvz), L::Mul(pvx, cvy)),
+        L::Sub(L::Mul(pvz, cw), L::Mul(pvy, cvx)));
+
+    L::Store(_out.qw + k, w);
+    L::Store(_out.qx + k, vx);
+    L::Store(_out.qy + k, vy);
+    L::Store(_out.qz + k, vz);
+    L::Store(_out.px + k, x);
+    L::Store(_out.py + k, y);
+    L::Store(_out.pz + k, z);
+  }
+  return k;
+}
+
+/////////////////////////////////////////////////
+void composePoses(std::size_t _count, const ConstPoseArrays &_parent,
+    const ConstPoseArrays &_child, const PoseArrays &_out)
+{
+  const std::size_t k =
+      composeLanes<SimdLanes>(0, _count, _parent, _child, _out);
+  composeLanes<ScalarLanes>(k, _count, _parent, _child, _out);
+}
+
+/////////////////////////////////////////////////
+void composePosesScalar(std::size_t _count, const ConstPoseArrays &_parent,
+    const ConstPoseArrays &_child, const PoseArrays &_out)
+{
+  composeLanes<ScalarLanes>(0, _count, _parent, _child, _out);
+}
+
+/////////////////////////////////////////////////
+const char *composePosesInstructionSet()
+{
+  return SimdLanes::kName;
+}
+}
+}
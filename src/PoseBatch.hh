@@ -0,0 +1,130 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_POSE_BATCH_HH_
+#define SDF_POSE_BATCH_HH_
+
+#include <cstddef>
+#include <vector>
+
+#include <ignition/math/Pose3.hh>
+
+#include "sdf/sdf_config.h"
+#include "AlignedAllocator.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief Components of poses stored as a structure of arrays: the
+  /// rotation w, x, y, z and the position x, y, z of pose k are qw[k],
+  /// qx[k], qy[k], qz[k], px[k], py[k] and pz[k].
+  struct PoseArrays
+  {
+    /// \brief Arrays of the components.
+    double *qw, *qx, *qy, *qz, *px, *py, *pz;
+  };
+
+  /// \brief Read only components of poses stored as a structure of arrays.
+  struct ConstPoseArrays
+  {
+    /// \brief Constructor.
+    /// \param[in] _arrays Arrays of the components.
+    ConstPoseArrays(const PoseArrays &_arrays)  // NOLINT
+      : qw(_arrays.qw), qx(_arrays.qx), qy(_arrays.qy), qz(_arrays.qz),
+        px(_arrays.px), py(_arrays.py), pz(_arrays.pz)
+    {
+    }
+
+    /// \brief Arrays of the components.
+    const double *qw, *qx, *qy, *qz, *px, *py, *pz;
+  };
+
+  /// \brief Poses stored as a structure of arrays, each component in its
+  /// own column aligned to kCacheLineAlignment.
+  class PoseBatch
+  {
+    /// \brief Constructor.
+    /// \param[in] _count Number of poses, which are zero.
+    public: explicit PoseBatch(std::size_t _count = 0);
+
+    /// \brief Change the number of poses. The poses are not preserved.
+    /// \param[in] _count Number of poses.
+    public: void Resize(std::size_t _count);
+
+    /// \brief Get the number of poses.
+    /// \return Number of poses.
+    public: std::size_t Size() const;
+
+    /// \brief Set a pose.
+    /// \param[in] _index Index of the pose, less than Size().
+    /// \param[in] _pose The pose.
+    public: void Set(std::size_t _index, const ignition::math::Pose3d &_pose);
+
+    /// \brief Get a pose.
+    /// \param[in] _index Index of the pose, less than Size().
+    /// \return The pose.
+    public: ignition::math::Pose3d Get(std::size_t _index) const;
+
+    /// \brief Get the columns of the components.
+    /// \return The columns.
+    public: PoseArrays Arrays();
+
+    /// \brief Get the columns of the components.
+    /// \return The columns.
+    public: ConstPoseArrays Arrays() const;
+
+    /// \brief Number of poses.
+    private: std::size_t count = 0;
+
+    /// \brief Distance between the columns, a multiple of the alignment.
+    private: std::size_t stride = 0;
+
+    /// \brief The columns, one after the other.
+    private: std::vector<double, AlignedAllocator<double>> data;
+  };
+
+  /// \brief Compose poses of children with the poses of their parents,
+  /// _out[k] = _parent[k] * _child[k], with the components of the poses in
+  /// separate arrays so that several poses are composed at once by SIMD
+  /// instructions. The rotations must be unit quaternions. _out may be the
+  /// same arrays as _parent or _child, but may not overlap them otherwise.
+  /// The arrays need no particular alignment.
+  /// \param[in] _count Number of poses.
+  /// \param[in] _parent Poses of the parents.
+  /// \param[in] _child Poses of the children relative to their parents.
+  /// \param[out] _out Poses of the children.
+  void composePoses(std::size_t _count, const ConstPoseArrays &_parent,
+      const ConstPoseArrays &_child, const PoseArrays &_out);
+
+  /// \brief Compose poses like composePoses, with scalar instructions only.
+  /// \param[in] _count Number of poses.
+  /// \param[in] _parent Poses of the parents.
+  /// \param[in] _child Poses of the children relative to their parents.
+  /// \param[out] _out Poses of the children.
+  void composePosesScalar(std::size_t _count, const ConstPoseArrays &_parent,
+      const ConstPoseArrays &_child, const PoseArrays &_out);
+
+  /// \brief Get the name of the instructions used by composePoses, which
+  /// are chosen when the library is compiled: "AVX", "SSE2", "NEON" or
+  /// "scalar".
+  /// \return Name of the instruction set.
+  const char *composePosesInstructionSet();
+  }
+}
+#endif
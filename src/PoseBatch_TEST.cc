@@ -0,0 +1,168 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+#include <ignition/math/Pose3.hh>
+#include "PoseBatch.hh"
+#include "AlignedAllocator.hh"
+
+/////////////////////////////////////////////////
+/// \brief Make random poses.
+/// \param[in] _count Number of poses.
+/// \param[in,out] _random Random number generator.
+/// \return The poses.
+static std::vector<ignition::math::Pose3d> randomPoses(std::size_t _count,
+    std::mt19937 &_random)
+{
+  std::uniform_real_distribution<double> value(-3, 3);
+  std::vector<ignition::math::Pose3d> poses;
+  for (std::size_t i = 0; i < _count; ++i)
+  {
+    poses.emplace_back(value(_random), value(_random), value(_random),
+        value(_random), value(_random), value(_random));
+  }
+  return poses;
+}
+
+/////////////////////////////////////////////////
+TEST(PoseBatch, Storage)
+{
+  sdf::PoseBatch batch(3);
+  EXPECT_EQ(3u, batch.Size());
+  EXPECT_EQ(ignition::math::Pose3d::Zero, batch.Get(2));
+
+  const ignition::math::Pose3d pose(1, 2, 3, 0.1, 0.2, 0.3);
+  batch.Set(1, pose);
+  EXPECT_EQ(pose, batch.Get(1));
+  EXPECT_DOUBLE_EQ(pose.Rot().W(), batch.Arrays().qw[1]);
+  EXPECT_DOUBLE_EQ(3.0, batch.Arrays().pz[1]);
+
+  const sdf::PoseArrays arrays = batch.Arrays();
+  for (const double *column : {arrays.qw, arrays.qx, arrays.qy, arrays.qz,
+      arrays.px, arrays.py, arrays.pz})
+  {
+    EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(column) %
+        sdf::kCacheLineAlignment);
+  }
+
+  batch.Resize(0);
+  EXPECT_EQ(0u, batch.Size());
+}
+
+/////////////////////////////////////////////////
+TEST(PoseBatch, Compose)
+{
+  std::mt19937 random(3);
+
+  // Sizes that leave poses for the scalar path after the SIMD lanes.
+  for (std::size_t count : {0u, 1u, 2u, 3u, 5u, 8u, 13u})
+  {
+    const auto parents = randomPoses(count, random);
+    const auto children = randomPoses(count, random);
+    sdf::PoseBatch parentBatch(count);
+    sdf::PoseBatch childBatch(count);
+    for (std::size_t k = 0; k < count; ++k)
+    {
+      parentBatch.Set(k, parents[k]);
+      childBatch.Set(k, children[k]);
+    }
+
+    sdf::PoseBatch out(count);
+    sdf::composePoses(count, parentBatch.Arrays(), childBatch.Arrays(),
+        out.Arrays());
+    sdf::PoseBatch scalar(count);
+    sdf::composePosesScalar(count, parentBatch.Arrays(), childBatch.Arrays(),
+        scalar.Arrays());
+    for (std::size_t k = 0; k < count; ++k)
+    {
+      EXPECT_EQ(parents[k] * children[k], out.Get(k)) << k;
+      EXPECT_EQ(out.Get(k), scalar.Get(k)) << k;
+    }
+
+    // The output may be the children.
+    sdf::composePoses(count, parentBatch.Arrays(), childBatch.Arrays(),
+        childBatch.Arrays());
+    for (std::size_t k = 0; k < count; ++k)
+      EXPECT_EQ(out.Get(k), childBatch.Get(k)) << k;
+  }
+}
+
+/////////////////////////////////////////////////
+/// \brief Compare the time of composing poses with Pose3d and with the
+/// batch kernel.
+TEST(PoseBatch, ComposeBenchmark)
+{
+  const std::size_t count = 4096;
+  const int runs = 200;
+  std::mt19937 random(7);
+  const auto parents = randomPoses(count, random);
+  const auto children = randomPoses(count, random);
+
+  std::vector<ignition::math::Pose3d> poses(count);
+  auto start = std::chrono::steady_clock::now();
+  for (int run = 0; run < runs; ++run)
+  {
+    for (std::size_t k = 0; k < count; ++k)
+      poses[k] = parents[k] * children[k];
+  }
+  auto end = std::chrono::steady_clock::now();
+  const double pose3d =
+      std::chrono::duration<double, std::milli>(end - start).count();
+
+  sdf::PoseBatch parentBatch(count);
+  sdf::PoseBatch childBatch(count);
+  sdf::PoseBatch out(count);
+  for (std::size_t k = 0; k < count; ++k)
+  {
+    parentBatch.Set(k, parents[k]);
+    childBatch.Set(k, children[k]);
+  }
+
+  start = std::chrono::steady_clock::now();
+  for (int run = 0; run < runs; ++run)
+  {
+    sdf::composePosesScalar(count, parentBatch.Arrays(), childBatch.Arrays(),
+        out.Arrays());
+  }
+  end = std::chrono::steady_clock::now();
+  const double scalar =
+      std::chrono::duration<double, std::milli>(end - start).count();
+
+  start = std::chrono::steady_clock::now();
+  for (int run = 0; run < runs; ++run)
+  {
+    sdf::composePoses(count, parentBatch.Arrays(), childBatch.Arrays(),
+        out.Arrays());
+  }
+  end = std::chrono::steady_clock::now();
+  const double simd =
+      std::chrono::duration<double, std::milli>(end - start).count();
+
+  for (std::size_t k = 0; k < count; ++k)
+    EXPECT_EQ(poses[k], out.Get(k)) << k;
+
+  std::cout << runs << " x " << count << " compositions: Pose3d " << pose3d
+            << " ms, scalar batch " << scalar << " ms, "
+            << sdf::composePosesInstructionSet() << " batch " << simd
+            << " ms\n";
+}
@@ -0,0 +1,172 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "sdf/PoseGraphSnapshot.hh"
+#include "FrameSemantics.hh"
+#include "ScopedGraph.hh"
+
+using namespace sdf;
+
+/// \brief Resolved poses of a snapshot, shared by its copies.
+struct PoseGraphSnapshotData
+{
+  /// \brief Graph the poses were resolved from, to check that a
+  /// SemanticPose belongs to it. It is never dereferenced.
+  const PoseRelativeToGraph *graph = nullptr;
+
+  /// \brief Prefix of the names of the scope, ending with "::", or empty
+  /// for the scope of a world.
+  std::string prefix;
+
+  /// \brief Local name of the frame that poses are resolved to by default,
+  /// "world" or "__model__".
+  std::string scopeName;
+
+  /// \brief Pose of each frame relative to the scope frame, by absolute
+  /// name in the graph.
+  std::unordered_map<std::string, ignition::math::Pose3d> poses;
+};
+
+/// \brief Private data for PoseGraphSnapshot.
+class sdf::PoseGraphSnapshotPrivate
+{
+  /// \brief The poses, which are never modified once they are shared.
+  public: std::shared_ptr<const PoseGraphSnapshotData> data;
+};
+
+/////////////////////////////////////////////////
+PoseGraphSnapshot::PoseGraphSnapshot()
+  : dataPtr(new PoseGraphSnapshotPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+PoseGraphSnapshot::PoseGraphSnapshot(
+    const ScopedGraph<PoseRelativeToGraph> &_graph)
+  : dataPtr(new PoseGraphSnapshotPrivate)
+{
+  if (!_graph)
+    return;
+
+  // Frames that are not connected to the scope frame are left out, so
+  // that resolving them reports that they are not in the snapshot.
+  ResolvedVertexPoses resolved;
+  resolveAllPosesRelativeToRoot(resolved, _graph);
+
+  auto data = std::make_shared<PoseGraphSnapshotData>();
+  data->graph = &_graph.GraphData();
+  data->prefix = _graph.AddPrefix("");
+  data->scopeName = _graph.ScopeContextName();
+  data->poses.reserve(resolved.size());
+  const auto &graph = _graph.Graph();
+  for (const auto &[id, pose] : resolved)
+    data->poses.emplace(graph.VertexFromId(id).Name(), pose);
+  this->dataPtr->data = std::move(data);
+}
+
+/////////////////////////////////////////////////
+PoseGraphSnapshot::PoseGraphSnapshot(const PoseGraphSnapshot &_snapshot)
+  : dataPtr(new PoseGraphSnapshotPrivate(*_snapshot.dataPtr))
+{
+}
+
+/////////////////////////////////////////////////
+PoseGraphSnapshot::PoseGraphSnapshot(PoseGraphSnapshot &&_snapshot) noexcept
+  : dataPtr(std::exchange(_snapshot.dataPtr, nullptr))
+{
+}
+
+/////////////////////////////////////////////////
+PoseGraphSnapshot &PoseGraphSnapshot::operator=(
+    PoseGraphSnapshot &&_snapshot) noexcept
+{
+  std::swap(this->dataPtr, _snapshot.dataPtr);
+  return *this;
+}
+
+/////////////////////////////////////////////////
+PoseGraphSnapshot &PoseGraphSnapshot::operator=(
+    const PoseGraphSnapshot &_snapshot)
+{
+  return *this = PoseGraphSnapshot(_snapshot);
+}
+
+/////////////////////////////////////////////////
+PoseGraphSnapshot::~PoseGraphSnapshot()
+{
+  delete this->dataPtr;
+  this->dataPtr = nullptr;
+}
+
+/////////////////////////////////////////////////
+std::size_t PoseGraphSnapshot::FrameCount() const
+{
+  return this->dataPtr->data ? this->dataPtr->data->poses.size() : 0u;
+}
+
+/////////////////////////////////////////////////
+Errors PoseGraphSnapshot::Resolve(ignition::math::Pose3d &_pose,
+    const std::string &_frame, const std::string &_resolveTo) const
+{
+  const auto &data = this->dataPtr->data;
+  if (!data)
+  {
+    return {Error(ErrorCode::POSE_RELATIVE_TO_INVALID,
+        "PoseGraphSnapshot has no frame with name [" + _frame + "].")};
+  }
+
+  return this->ResolveGraphFrames(_pose, *data->graph,
+      data->prefix + _frame,
+      data->prefix + (_resolveTo.empty() ? data->scopeName : _resolveTo));
+}
+
+/////////////////////////////////////////////////
+Errors PoseGraphSnapshot::ResolveGraphFrames(ignition::math::Pose3d &_pose,
+    const PoseRelativeToGraph &_graph, const std::string &_frame,
+    const std::string &_resolveTo) const
+{
+  const auto &data = this->dataPtr->data;
+  if (!data || data->graph != &_graph)
+  {
+    return {Error(ErrorCode::POSE_RELATIVE_TO_GRAPH_ERROR,
+        "PoseGraphSnapshot was not taken of the graph of frame [" + _frame +
+        "].")};
+  }
+
+  Errors errors;
+  auto frame = data->poses.find(_frame);
+  if (frame == data->poses.end())
+  {
+    errors.push_back({ErrorCode::POSE_RELATIVE_TO_INVALID,
+        "PoseGraphSnapshot has no frame with name [" + _frame + "]."});
+  }
+  auto resolveTo = data->poses.find(_resolveTo);
+  if (resolveTo == data->poses.end())
+  {
+    errors.push_back({ErrorCode::POSE_RELATIVE_TO_INVALID,
+        "PoseGraphSnapshot has no frame with name [" + _resolveTo + "]."});
+  }
+
+  if (errors.empty())
+    _pose = resolveTo->second.Inverse() * frame->second;
+  return errors;
+}
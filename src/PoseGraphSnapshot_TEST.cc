@@ -0,0 +1,200 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <ignition/math/Pose3.hh>
+#include "sdf/Frame.hh"
+#include "sdf/Link.hh"
+#include "sdf/Model.hh"
+#include "sdf/PoseGraphSnapshot.hh"
+#include "sdf/Root.hh"
+#include "sdf/SemanticPose.hh"
+#include "sdf/Visual.hh"
+#include "sdf/World.hh"
+
+using ignition::math::Pose3d;
+
+/////////////////////////////////////////////////
+static const char kWorld[] = R"(
+  <sdf version="1.8">
+    <world name="default">
+      <model name="robot">
+        <pose>1 0 0 0 0 0</pose>
+        <link name="base"/>
+        <link name="arm">
+          <pose relative_to="base">0 2 0 0 0 1.5707963267948966</pose>
+          <visual name="v">
+            <pose>0 0 3 0 0 0</pose>
+            <geometry><box><size>1 1 1</size></box></geometry>
+          </visual>
+        </link>
+        <model name="gripper">
+          <pose relative_to="arm">1 0 0 0 0 0</pose>
+          <link name="finger"/>
+        </model>
+      </model>
+      <frame name="marker">
+        <pose>0 0 5 0 0 0</pose>
+      </frame>
+    </world>
+  </sdf>)";
+
+/////////////////////////////////////////////////
+TEST(DOMPoseGraphSnapshot, Construction)
+{
+  sdf::PoseGraphSnapshot snapshot;
+  EXPECT_EQ(0u, snapshot.FrameCount());
+  Pose3d pose(1, 2, 3, 0, 0, 0);
+  EXPECT_FALSE(snapshot.Resolve(pose, "world").empty());
+  EXPECT_EQ(Pose3d(1, 2, 3, 0, 0, 0), pose);
+
+  // DOM objects that were not loaded through sdf::Root have no frames.
+  EXPECT_EQ(0u, sdf::World().PoseSnapshot().FrameCount());
+  EXPECT_EQ(0u, sdf::Model().PoseSnapshot().FrameCount());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMPoseGraphSnapshot, Resolve)
+{
+  auto root = std::make_unique<sdf::Root>();
+  ASSERT_TRUE(root->LoadSdfString(kWorld).empty());
+  const sdf::World *world = root->WorldByIndex(0);
+  const sdf::Model *robot = world->ModelByName("robot");
+  const sdf::Link *arm = robot->LinkByName("arm");
+  const sdf::Link *finger = robot->ModelByName("gripper")->LinkByName(
+      "finger");
+
+  const sdf::PoseGraphSnapshot snapshot = world->PoseSnapshot();
+  EXPECT_LT(0u, snapshot.FrameCount());
+
+  // The snapshot agrees with the live graph.
+  Pose3d live;
+  Pose3d pose;
+  ASSERT_TRUE(arm->SemanticPose().Resolve(live).empty());
+  ASSERT_TRUE(arm->SemanticPose().Resolve(pose, snapshot).empty());
+  EXPECT_EQ(live, pose);
+  EXPECT_EQ(Pose3d(1, 2, 0, 0, 0, IGN_PI_2), pose);
+
+  ASSERT_TRUE(finger->SemanticPose().Resolve(live, "arm").empty());
+  ASSERT_TRUE(finger->SemanticPose().Resolve(pose, snapshot, "arm").empty());
+  EXPECT_EQ(live, pose);
+  EXPECT_EQ(Pose3d(1, 0, 0, 0, 0, 0), pose);
+
+  // Poses relative to a frame, such as the pose of a visual.
+  const sdf::SemanticPose visual = arm->VisualByIndex(0)->SemanticPose();
+  ASSERT_TRUE(visual.Resolve(live, "base").empty());
+  ASSERT_TRUE(visual.Resolve(pose, snapshot, "base").empty());
+  EXPECT_EQ(live, pose);
+
+  // Names in the scope of the world.
+  ASSERT_TRUE(snapshot.Resolve(pose, "robot::arm").empty());
+  EXPECT_EQ(Pose3d(1, 2, 0, 0, 0, IGN_PI_2), pose);
+  ASSERT_TRUE(snapshot.Resolve(pose, "robot::gripper::finger",
+      "marker").empty());
+  EXPECT_EQ(Pose3d(1, 3, -5, 0, 0, IGN_PI_2), pose);
+  EXPECT_FALSE(snapshot.Resolve(pose, "robot::missing").empty());
+
+  // A snapshot of a model is in the scope of the model, and has none of the
+  // frames of the world.
+  const sdf::PoseGraphSnapshot robotSnapshot = robot->PoseSnapshot();
+  ASSERT_TRUE(robotSnapshot.Resolve(pose, "gripper::finger").empty());
+  EXPECT_EQ(Pose3d(0, 3, 0, 0, 0, IGN_PI_2), pose);
+  ASSERT_TRUE(finger->SemanticPose().Resolve(pose, robotSnapshot).empty());
+  EXPECT_EQ(Pose3d::Zero, pose);
+  EXPECT_FALSE(world->FrameByName("marker")->SemanticPose().Resolve(
+      pose, robotSnapshot).empty());
+
+  // Snapshots of other graphs are rejected.
+  sdf::Root other;
+  ASSERT_TRUE(other.LoadSdfString(kWorld).empty());
+  EXPECT_FALSE(arm->SemanticPose().Resolve(pose,
+      other.WorldByIndex(0)->PoseSnapshot()).empty());
+
+  // The snapshot outlives the DOM, and copies share it.
+  root.reset();
+  sdf::PoseGraphSnapshot copy(snapshot);
+  sdf::PoseGraphSnapshot moved(std::move(copy));
+  ASSERT_TRUE(moved.Resolve(pose, "robot::arm", "robot").empty());
+  EXPECT_EQ(Pose3d(0, 2, 0, 0, 0, IGN_PI_2), pose);
+  copy = moved;
+  EXPECT_EQ(snapshot.FrameCount(), copy.FrameCount());
+}
+
+/////////////////////////////////////////////////
+/// \brief Resolve the poses of many frames from several threads, from a
+/// shared snapshot and from the live graph, and compare them with the poses
+/// resolved by one thread.
+TEST(DOMPoseGraphSnapshot, ConcurrentResolve)
+{
+  std::string sdfString = "<sdf version='1.8'><world name='default'>"
+      "<model name='chain'><link name='l0'/>";
+  const int linkCount = 64;
+  for (int i = 1; i < linkCount; ++i)
+  {
+    sdfString += "<link name='l" + std::to_string(i) + "'>"
+        "<pose relative_to='l" + std::to_string(i - 1) + "'>"
+        "0.1 0 0 0 0 0.05</pose></link>";
+  }
+  sdfString += "</model></world></sdf>";
+
+  sdf::Root root;
+  ASSERT_TRUE(root.LoadSdfString(sdfString).empty());
+  const sdf::Model *model = root.WorldByIndex(0)->ModelByIndex(0);
+
+  std::vector<sdf::SemanticPose> poses;
+  std::vector<Pose3d> expected;
+  for (int i = 0; i < linkCount; ++i)
+  {
+    poses.push_back(model->LinkByIndex(i)->SemanticPose());
+    Pose3d pose;
+    ASSERT_TRUE(poses.back().Resolve(pose, "l0").empty());
+    expected.push_back(pose);
+  }
+
+  const sdf::PoseGraphSnapshot snapshot = root.WorldByIndex(0)->PoseSnapshot();
+  std::atomic<int> mismatches{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t)
+  {
+    threads.emplace_back([&, t]()
+        {
+          for (int run = 0; run < 200; ++run)
+          {
+            for (int i = 0; i < linkCount; ++i)
+            {
+              const int link = (i * 7 + t + run) % linkCount;
+              Pose3d pose;
+              const bool fromSnapshot = (t % 2) == 0;
+              const sdf::Errors errors = fromSnapshot ?
+                  poses[link].Resolve(pose, snapshot, "l0") :
+                  poses[link].Resolve(pose, "l0");
+              if (!errors.empty() || pose != expected[link])
+                ++mismatches;
+            }
+          }
+        });
+  }
+  for (auto &thread : threads)
+    thread.join();
+
+  EXPECT_EQ(0, mismatches.load());
+}
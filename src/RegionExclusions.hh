@@ -0,0 +1,85 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_REGION_EXCLUSIONS_HH_
+#define SDF_REGION_EXCLUSIONS_HH_
+
+#include <string>
+#include <vector>
+
+#include <ignition/math/Pose3.hh>
+
+#include "sdf/Element.hh"
+#include "sdf/sdf_config.h"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief A top level model of a world that was left out of a load by
+  /// ParserConfig::RegionFilter.
+  struct RegionExclusion
+  {
+    /// \brief The <world> element the model is a child of. It is only
+    /// compared, never dereferenced.
+    const Element *world = nullptr;
+
+    /// \brief Name of the model, or an empty string for an <include>
+    /// without a <name>.
+    std::string name;
+
+    /// \brief Pose of the model relative to the world frame.
+    ignition::math::Pose3d pose;
+  };
+
+  /// \brief Sets where the models left out of the worlds read on the
+  /// current thread are recorded, for as long as the scope is alive. Scopes
+  /// nest, and the previous setting is restored when a scope is destroyed.
+  class RegionExclusionScope
+  {
+    /// \brief Constructor
+    /// \param[in] _exclusions Vector to add the models to, or nullptr to not
+    /// record them in this scope.
+    public: explicit RegionExclusionScope(
+                std::vector<RegionExclusion> *_exclusions)
+      : previous(Exclusions())
+    {
+      Exclusions() = _exclusions;
+    }
+
+    /// \brief Destructor
+    public: ~RegionExclusionScope()
+    {
+      Exclusions() = this->previous;
+    }
+
+    /// \brief Get the exclusions of the current thread.
+    /// \return Reference to the vector the models are added to, or to
+    /// nullptr if they are not recorded.
+    public: static std::vector<RegionExclusion> *&Exclusions()
+    {
+      static thread_local std::vector<RegionExclusion> *exclusions = nullptr;
+      return exclusions;
+    }
+
+    /// \brief Setting that was current before this scope.
+    private: std::vector<RegionExclusion> *previous;
+  };
+  }
+}
+#endif
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_RESOLVED_CACHE_HH_
+#define SDF_RESOLVED_CACHE_HH_
+
+#include <atomic>
+#include <mutex>
+
+#include "sdf/sdf_config.h"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief Data of a DOM object resolved the first time it is requested,
+  /// such as the data that a model resolves from its graphs.
+  template<typename T>
+  class ResolvedCache
+  {
+    /// \brief Constructor.
+    public: ResolvedCache() = default;
+
+    /// \brief Copy constructor, which doesn't copy the resolved data, so that
+    /// copies resolve it again, e.g. from their own graphs.
+    public: ResolvedCache(const ResolvedCache &)
+    {
+    }
+
+    /// \brief Get the data, resolving it if needed.
+    /// \param[in] _resolve Function that resolves the data.
+    /// \return The resolved data.
+    public: template<typename F>
+            const T &Get(F _resolve) const
+    {
+      if (!this->resolved.load(std::memory_order_acquire))
+      {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        if (!this->resolved.load(std::memory_order_relaxed))
+        {
+          this->data = _resolve();
+          this->resolved.store(true, std::memory_order_release);
+        }
+      }
+      return this->data;
+    }
+
+    /// \brief Forget the resolved data, when what it is resolved from
+    /// changes.
+    public: void Reset()
+    {
+      this->resolved = false;
+    }
+
+    /// \brief True once data is resolved.
+    private: mutable std::atomic<bool> resolved{false};
+
+    /// \brief Protects the resolution.
+    private: mutable std::mutex mutex;
+
+    /// \brief Resolved data.
+    private: mutable T data;
+  };
+  }
+}
+#endif
@@ -14,20 +14,48 @@
  * limitations under the License.
  *
 */
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <sstream>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <utility>
 
 #include "sdf/Actor.hh"
+#include "sdf/ElementEdit.hh"
+#include "sdf/Frame.hh"
 #include "sdf/Light.hh"
+#include "sdf/LoadObserver.hh"
 #include "sdf/Model.hh"
 #include "sdf/Root.hh"
+#include "sdf/StateReader.hh"
 #include "sdf/Types.hh"
 #include "sdf/World.hh"
 #include "sdf/parser.hh"
 #include "sdf/sdf_config.h"
+#include "DiagnosticScope.hh"
+#include "FindFileSettings.hh"
 #include "FrameSemantics.hh"
+#include "ElementRetentionScope.hh"
+#include "ExecutorScope.hh"
+#include "IncludeCache.hh"
+#include "IncludeRecords.hh"
+#include "LazyModelScope.hh"
+#include "LoadCache.hh"
+#include "LoadStatsScope.hh"
+#include "MemoryAccounting.hh"
+#include "MeshRegistry.hh"
+#include "ModelPreloader.hh"
+#include "RegionExclusions.hh"
 #include "ScopedGraph.hh"
+#include "SourceRanges.hh"
+#include "Tracing.hh"
+#include "TrustedInputScope.hh"
 #include "Utils.hh"
 
 using namespace sdf;
@@ -50,61 +78,318 @@ class sdf::RootPrivate
   /// \brief The actors specified under the root SDF element
   public: std::vector<Actor> actors;
 
-  /// \brief Frame Attached-To Graphs constructed when loading Worlds.
-  public: std::vector<sdf::ScopedGraph<FrameAttachedToGraph>>
-              worldFrameAttachedToGraphs;
+  /// \brief Frame Attached-To Graphs constructed when loading Worlds and
+  /// Models.
+  public: sdf::RootGraphs<FrameAttachedToGraph> frameAttachedToGraphs;
 
-  /// \brief Frame Attached-To Graphs constructed when loading Models.
-  public: std::vector<sdf::ScopedGraph<FrameAttachedToGraph>>
-              modelFrameAttachedToGraphs;
-
-  /// \brief Pose Relative-To Graphs constructed when loading Worlds.
-  public: std::vector<sdf::ScopedGraph<PoseRelativeToGraph>>
-              worldPoseRelativeToGraphs;
-
-  /// \brief Pose Relative-To Graphs constructed when loading Models.
-  public: std::vector<sdf::ScopedGraph<PoseRelativeToGraph>>
-              modelPoseRelativeToGraphs;
+  /// \brief Pose Relative-To Graphs constructed when loading Worlds and
+  /// Models.
+  public: sdf::RootGraphs<PoseRelativeToGraph> poseRelativeToGraphs;
 
   /// \brief The SDF element pointer generated during load.
   public: sdf::ElementPtr sdf;
+
+  /// \brief Models included in the worlds, recorded when the document was
+  /// read with ParserConfig::TrackIncludes.
+  public: std::vector<IncludeRecord> includes;
+
+  /// \brief Whether the included models were recorded.
+  public: bool includesTracked = false;
+
+  /// \brief Text the document was read from, kept by LoadSdfString and
+  /// LoadSdfBuffer when ParserConfig::RecordSourceRanges is enabled, for
+  /// Reparse.
+  public: std::string sourceText;
+
+  /// \brief Whether sourceText and the source ranges of the elements are
+  /// kept.
+  public: bool sourceRanges = false;
+
+  /// \brief Whether the geometries share their meshes through meshRegistry.
+  public: bool shareMeshes = false;
+
+  /// \brief The distinct meshes of the geometries of the worlds and models.
+  public: MeshRegistry meshRegistry;
+
+  /// \brief The plugins of the loaded document.
+  public: PluginIndex plugins;
+
+  /// \brief Graphs of the worlds and models loaded with
+  /// ParserConfig::LazyModels, which are built on first access.
+  public: std::vector<std::shared_ptr<DeferredGraphs>> deferredGraphs;
+
+  /// \brief Build all the deferred graphs, before the graphs are used as
+  /// a whole.
+  public: void BuildDeferredGraphs()
+  {
+    for (auto &graphs : this->deferredGraphs)
+      graphs->Build();
+  }
 };
 
+/////////////////////////////////////////////////
+/// \brief Check whether the models included in worlds are recorded.
+/// \param[in] _config Parser configuration.
+/// \return True if the includes are recorded.
+static bool tracksIncludes(const ParserConfig &_config)
+{
+  // Shared models have no elements of their own to replace.
+  return _config.TrackIncludes() && !_config.ShareIncludedModels();
+}
+
+/////////////////////////////////////////////////
+/// \brief Find the smallest element whose source range encloses an edit,
+/// with its first and last characters outside of the edit, so that the
+/// text of the element after the edit is still one element.
+/// \param[in] _root Root of the element tree.
+/// \param[in] _edit Edit of the text of the document.
+/// \return The element, or nullptr if not even the root encloses the edit.
+static ElementPtr enclosingElement(const ElementPtr &_root,
+    const TextEdit &_edit)
+{
+  auto encloses = [&_edit](const ElementPtr &_elem)
+  {
+    const TextRange &range = _elem->SourceRange();
+    return range.beginLine != 0 && range.begin < _edit.begin &&
+        _edit.oldEnd < range.end;
+  };
+  if (!encloses(_root))
+    return nullptr;
+
+  ElementPtr elem = _root;
+  ElementPtr child = elem->GetFirstElement();
+  while (child)
+  {
+    if (encloses(child))
+    {
+      elem = child;
+      child = elem->GetFirstElement();
+    }
+    else
+    {
+      child = child->GetNextElement();
+    }
+  }
+  return elem;
+}
+
+/////////////////////////////////////////////////
+/// \brief Move the source ranges of the elements of a tree past an edit by
+/// the size of the edit, leaving the ranges before the edit as they are.
+/// \param[in] _elem Root of the tree.
+/// \param[in] _skip Subtree whose ranges are already those of the new
+/// text, which is left out.
+/// \param[in] _edit Edit of the text of the document.
+/// \param[in] _oldLine Line of the end of the edit in the old text.
+/// \param[in] _oldColumn Column of the end of the edit in the old text.
+/// \param[in] _newLine Line of the end of the edit in the new text.
+/// \param[in] _newColumn Column of the end of the edit in the new text.
+static void shiftSourceRanges(const ElementPtr &_elem,
+    const ElementPtr &_skip, const TextEdit &_edit, unsigned int _oldLine,
+    unsigned int _oldColumn, unsigned int _newLine, unsigned int _newColumn)
+{
+  TextRange range = _elem->SourceRange();
+  // Elements without a range have no children with one.
+  if (_elem == _skip || range.beginLine == 0 || range.end <= _edit.begin)
+    return;
+
+  // Positions on the last line of the edit move by its columns as well.
+  auto shift = [&](std::size_t &_offset, unsigned int &_line,
+      unsigned int &_column)
+  {
+    if (_offset < _edit.oldEnd)
+      return;
+    _offset = _offset - _edit.oldEnd + _edit.newEnd;
+    if (_line == _oldLine)
+      _column = _column - _oldColumn + _newColumn;
+    _line = _line - _oldLine + _newLine;
+  };
+  shift(range.begin, range.beginLine, range.beginColumn);
+  shift(range.end, range.endLine, range.endColumn);
+  _elem->SetSourceRange(range);
+
+  for (ElementPtr child = _elem->GetFirstElement(); child;
+       child = child->GetNextElement())
+  {
+    shiftSourceRanges(child, _skip, _edit, _oldLine, _oldColumn, _newLine,
+        _newColumn);
+  }
+}
+
+/////////////////////////////////////////////////
+/// \brief Report the top level entities of a world that refer to models
+/// left out of the load by ParserConfig::RegionFilter, which the frame
+/// graphs only report as names that don't exist.
+/// \param[in] _world The loaded world.
+/// \param[in] _worldElem The element the world was loaded from.
+/// \param[out] _errors Errors the references are added to.
+static void checkRegionExclusions(const World &_world,
+    const Element &_worldElem, Errors &_errors)
+{
+  const std::vector<RegionExclusion> *exclusions =
+      RegionExclusionScope::Exclusions();
+  if (!exclusions || exclusions->empty())
+    return;
+
+  std::unordered_map<std::string, const RegionExclusion *> excluded;
+  for (const RegionExclusion &exclusion : *exclusions)
+  {
+    if (exclusion.world == &_worldElem && !exclusion.name.empty())
+      excluded.emplace(exclusion.name, &exclusion);
+  }
+  if (excluded.empty())
+    return;
+
+  auto check = [&](ErrorCode _code, const std::string &_attribute,
+      const std::string &_reference, const std::string &_type,
+      const std::string &_name)
+  {
+    const std::string model = _reference.substr(0, _reference.find("::"));
+    auto it = excluded.find(model);
+    if (it == excluded.end() || _world.ModelNameExists(model))
+      return;
+
+    const ignition::math::Vector3d &pos = it->second->pose.Pos();
+    std::ostringstream stream;
+    stream << _attribute << " name[" << _reference << "] specified by "
+           << _type << " with name[" << _name << "] refers to model with "
+           << "name[" << model << "] at position [" << pos << "], which is "
+           << "outside the region of the load of world with name["
+           << _world.Name() << "] and was not loaded.";
+    _errors.push_back({_code, stream.str()});
+  };
+
+  for (uint64_t i = 0; i < _world.ModelCount(); ++i)
+  {
+    const Model *model = _world.ModelByIndex(i);
+    check(ErrorCode::POSE_RELATIVE_TO_INVALID, "relative_to",
+        model->PoseRelativeTo(), "model", model->Name());
+  }
+  for (uint64_t i = 0; i < _world.FrameCount(); ++i)
+  {
+    const Frame *frame = _world.FrameByIndex(i);
+    check(ErrorCode::FRAME_ATTACHED_TO_INVALID, "attached_to",
+        frame->AttachedTo(), "frame", frame->Name());
+    check(ErrorCode::POSE_RELATIVE_TO_INVALID, "relative_to",
+        frame->PoseRelativeTo(), "frame", frame->Name());
+  }
+  for (uint64_t i = 0; i < _world.LightCount(); ++i)
+  {
+    const Light *light = _world.LightByIndex(i);
+    check(ErrorCode::POSE_RELATIVE_TO_INVALID, "relative_to",
+        light->PoseRelativeTo(), "light", light->Name());
+  }
+  for (uint64_t i = 0; i < _world.ActorCount(); ++i)
+  {
+    const Actor *actor = _world.ActorByIndex(i);
+    check(ErrorCode::POSE_RELATIVE_TO_INVALID, "relative_to",
+        actor->PoseRelativeTo(), "actor", actor->Name());
+  }
+}
+
+/////////////////////////////////////////////////
+/// \brief Give the top level entities of a world whose graphs are built to
+/// an observer.
+/// \param[in] _observer The observer.
+/// \param[in] _world The world.
+static void notifyWorld(LoadObserver &_observer, const World &_world)
+{
+  for (const Model &model : _world.Models())
+    _observer.ModelLoaded(&_world, model);
+  for (const Light &light : _world.Lights())
+    _observer.LightLoaded(&_world, light);
+  for (const Actor &actor : _world.Actors())
+    _observer.ActorLoaded(&_world, actor);
+}
+
 /////////////////////////////////////////////////
 template <typename T>
-sdf::ScopedGraph<FrameAttachedToGraph> addFrameAttachedToGraph(
-    std::vector<sdf::ScopedGraph<sdf::FrameAttachedToGraph>> &_graphList,
-    const T &_domObj, sdf::Errors &_errors)
+void buildAndValidateGraph(
+    sdf::ScopedGraph<sdf::FrameAttachedToGraph> &_frameGraph,
+    const T &_domObj, sdf::Errors &_buildErrors, sdf::Errors &_errors)
 {
-  auto &frameGraph =
-      _graphList.emplace_back(std::make_shared<FrameAttachedToGraph>());
+  _buildErrors = sdf::buildFrameAttachedToGraph(_frameGraph, &_domObj);
+  _errors.insert(_errors.end(), _buildErrors.begin(), _buildErrors.end());
+  if (TrustedInputScope::Trusted())
+    return;
 
-  sdf::Errors buildErrors =
-      sdf::buildFrameAttachedToGraph(frameGraph, &_domObj);
-  _errors.insert(_errors.end(), buildErrors.begin(), buildErrors.end());
+  sdf::Errors validateErrors = sdf::validateFrameAttachedToGraph(_frameGraph);
+  _errors.insert(_errors.end(), validateErrors.begin(), validateErrors.end());
+}
+
+/////////////////////////////////////////////////
+template <typename T>
+void buildAndValidateGraph(
+    sdf::ScopedGraph<sdf::PoseRelativeToGraph> &_poseGraph,
+    const T &_domObj, sdf::Errors &_buildErrors, sdf::Errors &_errors)
+{
+  _buildErrors = buildPoseRelativeToGraph(_poseGraph, &_domObj);
+  _errors.insert(_errors.end(), _buildErrors.begin(), _buildErrors.end());
+  if (TrustedInputScope::Trusted())
+    return;
 
-  sdf::Errors validateErrors = sdf::validateFrameAttachedToGraph(frameGraph);
+  Errors validateErrors = validatePoseRelativeToGraph(_poseGraph);
   _errors.insert(_errors.end(), validateErrors.begin(), validateErrors.end());
+}
 
+/////////////////////////////////////////////////
+template <typename T>
+sdf::ScopedGraph<FrameAttachedToGraph> addFrameAttachedToGraph(
+    sdf::RootGraphs<sdf::FrameAttachedToGraph> &_graphs,
+    const T &_domObj, sdf::Errors &_errors)
+{
+  auto &frameGraph =
+      _graphs.worlds.emplace_back(std::make_shared<FrameAttachedToGraph>());
+  buildAndValidateGraph(frameGraph, _domObj,
+      _graphs.worldBuildErrors.emplace_back(), _errors);
   return frameGraph;
 }
 
 /////////////////////////////////////////////////
 template <typename T>
 ScopedGraph<PoseRelativeToGraph> addPoseRelativeToGraph(
-    std::vector<sdf::ScopedGraph<sdf::PoseRelativeToGraph>> &_graphList,
+    sdf::RootGraphs<sdf::PoseRelativeToGraph> &_graphs,
     const T &_domObj, Errors &_errors)
 {
   auto &poseGraph =
-      _graphList.emplace_back(std::make_shared<sdf::PoseRelativeToGraph>());
+      _graphs.worlds.emplace_back(std::make_shared<PoseRelativeToGraph>());
+  buildAndValidateGraph(poseGraph, _domObj,
+      _graphs.worldBuildErrors.emplace_back(), _errors);
+  return poseGraph;
+}
 
-  Errors buildErrors = buildPoseRelativeToGraph(poseGraph, &_domObj);
-  _errors.insert(_errors.end(), buildErrors.begin(), buildErrors.end());
+/////////////////////////////////////////////////
+/// \brief Add a graph read from the load cache to the graphs of the
+/// worlds.
+/// \param[in,out] _graphs Graphs of the worlds.
+/// \param[in] _graph Graph of the world.
+/// \return The added graph.
+template <typename T>
+ScopedGraph<T> addCachedGraph(RootGraphs<T> &_graphs,
+    const ScopedGraph<T> &_graph)
+{
+  _graphs.worldBuildErrors.emplace_back();
+  return _graphs.worlds.emplace_back(_graph);
+}
 
-  Errors validateErrors = validatePoseRelativeToGraph(poseGraph);
-  _errors.insert(_errors.end(), validateErrors.begin(), validateErrors.end());
+/////////////////////////////////////////////////
+/// \brief Get the graphs read with the load cache entry of a document.
+/// \param[in] _root Root element of the document.
+/// \return The graphs, or nullptr if there are none or if they don't have
+/// a graph for each world and model of the document.
+static const LoadCache::Graphs *cachedGraphs(const ElementPtr &_root)
+{
+  LoadCacheRecord *record = LoadCacheScope::Record();
+  if (!record || !record->graphs)
+    return nullptr;
 
-  return poseGraph;
+  const LoadCache::Graphs &graphs = *record->graphs;
+  if (graphs.frameAttachedTo.worlds.size() != _root->CountChildren("world") ||
+      graphs.frameAttachedTo.models.size() != _root->CountChildren("model"))
+  {
+    return nullptr;
+  }
+  return &graphs;
 }
 
 /////////////////////////////////////////////////
@@ -136,52 +421,275 @@ Root::~Root()
 /////////////////////////////////////////////////
 Errors Root::Load(const std::string &_filename)
 {
+  return this->Load(_filename, ParserConfig());
+}
+
+/////////////////////////////////////////////////
+/// \brief Source of a document loaded by Root::LoadImpl.
+class sdf::RootLoadSource
+{
+  /// \brief Read the document into an initialized SDF.
+  public: std::function<bool(SDFPtr, Errors &)> read;
+
+  /// \brief Code of the error reported when the document can't be read.
+  public: ErrorCode errorCode = ErrorCode::STRING_READ;
+
+  /// \brief Message of the error reported when the document can't be
+  /// read.
+  public: std::function<std::string()> errorMessage;
+
+  /// \brief Text of the document, kept for Reparse when source ranges are
+  /// recorded, or nullopt if the document is not read from a text.
+  public: std::optional<std::string_view> text;
+
+  /// \brief Whether the includes of the document are recorded. A binary
+  /// snapshot has its includes resolved already.
+  public: bool recordsIncludes = true;
+};
+
+/////////////////////////////////////////////////
+Errors Root::LoadImpl(const RootLoadSource &_source,
+    const ParserConfig &_config)
+{
+  DiagnosticScope diagnosticScope(_config);
   Errors errors;
 
-  // Read an SDF file, and store the result in sdfParsed.
-  SDFPtr sdfParsed = readFile(_filename, errors);
+  std::vector<IncludeRecord> includes;
+  const bool recordIncludes = _source.recordsIncludes &&
+      tracksIncludes(_config);
+  // The models left out by the region filter are checked by Load(SDFPtr).
+  std::vector<RegionExclusion> exclusions;
+  RegionExclusionScope exclusionScope(&exclusions);
+
+  // The models of the worlds are loaded while the rest of the document is
+  // read, and World::Load takes them from the preloader.
+  std::unique_ptr<ModelPreloader> preloader;
+  if (_config.PipelinedLoad() && !_config.ShareIncludedModels() &&
+      LoadCache::Directory(_config).empty())
+  {
+    preloader = std::make_unique<ModelPreloader>(_config);
+  }
+  ModelPreloadScope preloadScope(preloader.get());
+
+  // The load cache entry of a file is stored with the validated graphs
+  // once they are built, and the graphs of an entry are used by
+  // Load(SDFPtr). The graphs of lazy models are built on first access.
+  LoadCacheRecord cacheRecord;
+  LoadCacheScope cacheScope(_config.LazyModels() ? nullptr : &cacheRecord);
 
-  // Return if we were not able to read the file.
-  if (!sdfParsed)
+  SDFPtr sdfParsed(new SDF());
+  init(sdfParsed);
+  bool read = false;
   {
-    errors.push_back(
-        {ErrorCode::FILE_READ, "Unable to read file:" + _filename});
+    IncludeRecordScope recordScope(recordIncludes ? &includes : nullptr);
+    read = _source.read(sdfParsed, errors);
+  }
+  if (!read)
+  {
+    addError(errors, _config, _source.errorCode, _source.errorMessage);
+    truncateErrors(errors, _config);
+    return errors;
+  }
+
+  if (loadStopped(errors, _config))
+  {
+    reportCancellation(errors, _config);
     return errors;
   }
 
-  Errors loadErrors = this->Load(sdfParsed);
+  Errors loadErrors = this->Load(sdfParsed, _config);
   errors.insert(errors.end(), loadErrors.begin(), loadErrors.end());
+  truncateErrors(errors, _config);
+  this->dataPtr->includes = std::move(includes);
+  this->dataPtr->includesTracked = recordIncludes;
+  if (_source.text && _config.RecordSourceRanges())
+  {
+    this->dataPtr->sourceText = std::string(*_source.text);
+    this->dataPtr->sourceRanges = true;
+  }
+
+  // Only graphs that were validated without errors are stored.
+  if (cacheRecord.cache)
+  {
+    std::optional<LoadCache::Graphs> graphs;
+    if (errors.empty() && !_config.TrustedInput() &&
+        !loadCancelled(_config))
+    {
+      graphs.emplace(LoadCache::Graphs{this->dataPtr->frameAttachedToGraphs,
+          this->dataPtr->poseRelativeToGraphs});
+    }
+    cacheRecord.cache->Store(*sdfParsed, cacheRecord.files,
+        graphs ? &*graphs : nullptr);
+  }
 
   return errors;
 }
 
+/////////////////////////////////////////////////
+Errors Root::Load(const std::string &_filename, const ParserConfig &_config)
+{
+  SDF_TRACE_SCOPE_TEXT("sdf::Root::Load", _filename);
+  RootLoadSource source;
+  source.read = [&](SDFPtr _sdf, Errors &_errors)
+  {
+    return readFile(_filename, _config, _sdf, _errors);
+  };
+  source.errorCode = ErrorCode::FILE_READ;
+  source.errorMessage = [&]
+  {
+    return "Unable to read file:" + _filename;
+  };
+  return this->LoadImpl(source, _config);
+}
+
 /////////////////////////////////////////////////
 Errors Root::LoadSdfString(const std::string &_sdf)
 {
-  Errors errors;
-  SDFPtr sdfParsed(new SDF());
-  init(sdfParsed);
+  return this->LoadSdfString(_sdf, ParserConfig());
+}
 
-  // Read an SDF string, and store the result in sdfParsed.
-  if (!readString(_sdf, sdfParsed, errors))
+/////////////////////////////////////////////////
+Errors Root::LoadSdfString(const std::string &_sdf,
+                           const ParserConfig &_config)
+{
+  RootLoadSource source;
+  source.read = [&](SDFPtr _sdfParsed, Errors &_errors)
   {
-    errors.push_back(
-        {ErrorCode::STRING_READ, "Unable to SDF string: " + _sdf});
+    return readString(_sdf, _config, _sdfParsed, _errors);
+  };
+  source.errorMessage = [&]
+  {
+    return "Unable to SDF string: " + _sdf;
+  };
+  source.text = _sdf;
+  return this->LoadImpl(source, _config);
+}
+
+/////////////////////////////////////////////////
+Errors Root::LoadSdfBuffer(const char *_data, std::size_t _size,
+                           const ParserConfig &_config)
+{
+  RootLoadSource source;
+  source.read = [&](SDFPtr _sdf, Errors &_errors)
+  {
+    return readBuffer(_data, _size, _config, _sdf, _errors);
+  };
+  source.errorMessage = [&]
+  {
+    return "Unable to read SDF buffer: " + std::string(_data, _size);
+  };
+  source.text = std::string_view(_data, _size);
+  return this->LoadImpl(source, _config);
+}
+
+/////////////////////////////////////////////////
+Errors Root::LoadSdfFragment(const std::string &_xml,
+                             const ParserConfig &_config)
+{
+  RootLoadSource source;
+  source.read = [&](SDFPtr _sdf, Errors &_errors)
+  {
+    return readFragment(_xml.data(), _xml.size(), _config, _sdf, _errors);
+  };
+  source.errorMessage = [&]
+  {
+    return "Unable to read SDF fragment: " + _xml;
+  };
+  return this->LoadImpl(source, _config);
+}
+
+/////////////////////////////////////////////////
+Errors Root::LoadBinaryBuffer(const char *_data, std::size_t _size,
+                              const ParserConfig &_config)
+{
+  RootLoadSource source;
+  source.read = [&](SDFPtr _sdf, Errors &_errors)
+  {
+    return readBinaryBuffer(_data, _size, _sdf, _errors);
+  };
+  source.errorCode = ErrorCode::FILE_READ;
+  source.errorMessage = []
+  {
+    return std::string("Unable to read binary snapshot buffer.");
+  };
+  source.recordsIncludes = false;
+  return this->LoadImpl(source, _config);
+}
+
+/////////////////////////////////////////////////
+Errors Root::WriteBinary(std::ostream &_out) const
+{
+  Errors errors;
+  if (!this->dataPtr->sdf)
+  {
+    errors.push_back({ErrorCode::ELEMENT_MISSING,
+        "Root has no elements to write, they were released after loading."});
     return errors;
   }
 
-  Errors loadErrors = this->Load(sdfParsed);
-  errors.insert(errors.end(), loadErrors.begin(), loadErrors.end());
-
+  SDF sdf;
+  sdf.Root(this->dataPtr->sdf);
+  sdf.WriteBinary(_out, errors);
   return errors;
 }
 
+/////////////////////////////////////////////////
+Errors Root::LoadSdfStream(std::istream &_in, const ParserConfig &_config)
+{
+  RootLoadSource source;
+  source.read = [&](SDFPtr _sdf, Errors &_errors)
+  {
+    return readStream(_in, _config, _sdf, _errors);
+  };
+  source.errorMessage = []
+  {
+    return std::string("Unable to read SDF stream.");
+  };
+  return this->LoadImpl(source, _config);
+}
+
 /////////////////////////////////////////////////
 Errors Root::Load(SDFPtr _sdf)
 {
+  return this->Load(_sdf, ParserConfig());
+}
+
+/////////////////////////////////////////////////
+Errors Root::Load(SDFPtr _sdf, const ParserConfig &_config)
+{
+  SDF_TRACE_SCOPE("sdf::Root::LoadDom");
+  LoadStatsScope statsScope(_config);
+  DiagnosticScope diagnosticScope(_config);
+  ElementRetentionScope retentionScope(_config);
+  ExecutorScope executorScope(_config);
+  TrustedInputScope trustedScope(_config);
+  LoadPhaseTimer timer(LoadPhase::DOM_LOAD);
   Errors errors;
 
+  // Models and worlds keep their elements until their graphs are built,
+  // and the other DOM objects don't keep them at all.
+  auto releaseElements = [&]()
+  {
+    // Lazy models load their contents from their elements.
+    if (!_config.ReleaseElements() || _config.LazyModels())
+      return;
+    this->dataPtr->sdf.reset();
+    for (World &world : this->dataPtr->worlds)
+      world.ReleaseElement();
+    for (Model &model : this->dataPtr->models)
+      model.ReleaseElement();
+  };
+
   this->dataPtr->sdf = _sdf->Root();
+  this->dataPtr->includes.clear();
+  this->dataPtr->includesTracked = false;
+  this->dataPtr->sourceText.clear();
+  this->dataPtr->sourceRanges = false;
+
+  // The element tree is complete once it is read, so the plugins are
+  // indexed before any DOM object is loaded, and stay available when the
+  // elements are released.
+  this->dataPtr->plugins.Build(this->dataPtr->sdf);
 
   // Get the SDF version.
   std::pair<std::string, bool> versionPair =
@@ -194,6 +702,7 @@ Errors Root::Load(SDFPtr _sdf)
   {
     errors.push_back(
         {ErrorCode::ATTRIBUTE_MISSING, "SDF does not have a version."});
+    releaseElements();
     return errors;
   }
 
@@ -205,29 +714,87 @@ Errors Root::Load(SDFPtr _sdf)
         "SDF version attribute[" + versionPair.first + "] should match "
         "the latest version[" + SDF_PROTOCOL_VERSION + "] when loading DOM "
         "objects."});
+    releaseElements();
     return errors;
   }
 
   this->dataPtr->version = versionPair.first;
 
+  // The graphs stored with the load cache entry the document was read from
+  // were built from the same document and validated, so they are used as
+  // they are.
+  const LoadCache::Graphs *cached = cachedGraphs(this->dataPtr->sdf);
+
   // Read all the worlds
   if (this->dataPtr->sdf->HasElement("world"))
   {
     ElementPtr elem = this->dataPtr->sdf->GetElement("world");
-    while (elem)
+    for (std::size_t worldIndex = 0; elem && !loadStopped(errors, _config);
+         ++worldIndex)
     {
       World world;
 
-      Errors worldErrors = world.Load(elem);
+      Errors worldErrors = world.Load(elem, _config);
+      checkRegionExclusions(world, *elem, worldErrors);
 
-      // Build the graphs.
-      auto frameAttachedToGraph = addFrameAttachedToGraph(
-          this->dataPtr->worldFrameAttachedToGraphs, world, worldErrors);
-      world.SetFrameAttachedToGraph(frameAttachedToGraph);
+      // Build the graphs, unless loading the world used up the error budget
+      // or the load was cancelled. The graphs of a world with lazy models
+      // are built into their slots the first time they are needed.
+      const bool hasGraphs = !loadStopped(worldErrors, _config);
+      if (_config.LazyModels() && hasGraphs)
+      {
+        auto &frameGraphs = this->dataPtr->frameAttachedToGraphs;
+        auto &poseGraphs = this->dataPtr->poseRelativeToGraphs;
+        const std::size_t graph = frameGraphs.worlds.size();
+        frameGraphs.worlds.emplace_back(
+            std::make_shared<FrameAttachedToGraph>());
+        frameGraphs.worldBuildErrors.emplace_back();
+        poseGraphs.worlds.emplace_back(std::make_shared<PoseRelativeToGraph>());
+        poseGraphs.worldBuildErrors.emplace_back();
+
+        RootPrivate *data = this->dataPtr;
+        const std::size_t index = data->worlds.size();
+        const bool trusted = _config.TrustedInput();
+        data->deferredGraphs.push_back(std::make_shared<DeferredGraphs>(
+            [data, index, graph, trusted]()
+            {
+              TrustedInputScope graphTrustedScope(trusted);
+              World &lazyWorld = data->worlds[index];
+              Errors graphErrors;
+              auto &frameGraph = data->frameAttachedToGraphs.worlds[graph];
+              buildAndValidateGraph(frameGraph, lazyWorld,
+                  data->frameAttachedToGraphs.worldBuildErrors[graph],
+                  graphErrors);
+              lazyWorld.SetFrameAttachedToGraph(frameGraph);
+
+              auto &poseGraph = data->poseRelativeToGraphs.worlds[graph];
+              buildAndValidateGraph(poseGraph, lazyWorld,
+                  data->poseRelativeToGraphs.worldBuildErrors[graph],
+                  graphErrors);
+              lazyWorld.SetPoseRelativeToGraph(poseGraph);
+              return graphErrors;
+            }));
+        world.SetDeferredGraphs(data->deferredGraphs.back());
+      }
+      else if (hasGraphs && cached)
+      {
+        world.SetFrameAttachedToGraph(addCachedGraph(
+            this->dataPtr->frameAttachedToGraphs,
+            cached->frameAttachedTo.worlds[worldIndex]));
+        world.SetPoseRelativeToGraph(addCachedGraph(
+            this->dataPtr->poseRelativeToGraphs,
+            cached->poseRelativeTo.worlds[worldIndex]));
+      }
+      else if (hasGraphs)
+      {
+        auto frameAttachedToGraph = addFrameAttachedToGraph(
+            this->dataPtr->frameAttachedToGraphs, world, worldErrors);
+        world.SetFrameAttachedToGraph(frameAttachedToGraph);
 
-      auto poseRelativeToGraph = addPoseRelativeToGraph(
-          this->dataPtr->worldPoseRelativeToGraphs, world, worldErrors);
-      world.SetPoseRelativeToGraph(poseRelativeToGraph);
+        auto poseRelativeToGraph = addPoseRelativeToGraph(
+            this->dataPtr->poseRelativeToGraphs, world, worldErrors);
+        world.SetPoseRelativeToGraph(poseRelativeToGraph);
+      }
 
       // Attempt to load the world
       if (worldErrors.empty())
@@ -249,38 +816,151 @@ Errors Root::Load(SDFPtr _sdf)
       }
 
       this->dataPtr->worlds.push_back(std::move(world));
+      if (_config.Observer() && hasGraphs)
+        notifyWorld(*_config.Observer(), this->dataPtr->worlds.back());
       elem = elem->GetNextElement("world");
     }
   }
 
+  // Stop here if the worlds used up the error budget or were cancelled.
+  if (loadStopped(errors, _config))
+  {
+    truncateErrors(errors, _config);
+    releaseElements();
+    return errors;
+  }
+
   // Load all the models.
+  LazyModelScope lazyScope(_config);
   Errors modelLoadErrors = loadUniqueRepeated<Model>(
-      this->dataPtr->sdf, "model", this->dataPtr->models);
+      this->dataPtr->sdf, "model", this->dataPtr->models,
+      _config.LoadThreadCount());
   errors.insert(errors.end(), modelLoadErrors.begin(), modelLoadErrors.end());
+  LazyModelScope eagerScope(false);
+
+  // Build the graphs. Each model has graphs of its own, so they are built
+  // and validated concurrently, and the errors are merged in document order.
+  auto &models = this->dataPtr->models;
+  auto &frameGraphs = this->dataPtr->frameAttachedToGraphs;
+  auto &poseGraphs = this->dataPtr->poseRelativeToGraphs;
+  const std::size_t firstGraph = frameGraphs.models.size();
+  for (std::size_t i = 0; i < models.size(); ++i)
+  {
+    frameGraphs.models.emplace_back(std::make_shared<FrameAttachedToGraph>());
+    poseGraphs.models.emplace_back(std::make_shared<PoseRelativeToGraph>());
+  }
+  frameGraphs.modelBuildErrors.resize(frameGraphs.models.size());
+  poseGraphs.modelBuildErrors.resize(poseGraphs.models.size());
 
-  // Build the graphs.
-  for (sdf::Model &model : this->dataPtr->models)
+  // The graphs of lazy models are built the first time they are needed.
+  if (_config.LazyModels())
   {
-    auto frameAttachedToGraph = addFrameAttachedToGraph(
-        this->dataPtr->modelFrameAttachedToGraphs, model, errors);
+    RootPrivate *data = this->dataPtr;
+    const bool trusted = _config.TrustedInput();
+    for (std::size_t i = 0; i < models.size(); ++i)
+    {
+      const std::size_t graph = firstGraph + i;
+      data->deferredGraphs.push_back(std::make_shared<DeferredGraphs>(
+          [data, i, graph, trusted]()
+          {
+            TrustedInputScope graphTrustedScope(trusted);
+            Model &lazyModel = data->models[i];
+            Errors graphErrors;
+            auto &frameGraph = data->frameAttachedToGraphs.models[graph];
+            buildAndValidateGraph(frameGraph, lazyModel,
+                data->frameAttachedToGraphs.modelBuildErrors[graph],
+                graphErrors);
+            lazyModel.SetFrameAttachedToGraph(frameGraph);
+
+            auto &poseGraph = data->poseRelativeToGraphs.models[graph];
+            buildAndValidateGraph(poseGraph, lazyModel,
+                data->poseRelativeToGraphs.modelBuildErrors[graph],
+                graphErrors);
+            lazyModel.SetPoseRelativeToGraph(poseGraph);
+            return graphErrors;
+          }));
+      models[i].SetDeferredGraphs(data->deferredGraphs.back());
+    }
+  }
 
+  std::vector<Errors> graphErrors(models.size());
+  parallelFor(_config.LazyModels() ? 0 : models.size(),
+      _config.LoadThreadCount(),
+      [&](std::size_t _index)
+  {
+    // The graphs of the models left once a load is cancelled aren't built.
+    if (loadCancelled(_config))
+      return;
+
+    sdf::Model &model = models[_index];
+    const std::size_t graph = firstGraph + _index;
+    auto &frameAttachedToGraph = frameGraphs.models[graph];
+    if (cached)
+    {
+      frameAttachedToGraph = cached->frameAttachedTo.models[_index];
+    }
+    else
+    {
+      buildAndValidateGraph(frameAttachedToGraph, model,
+          frameGraphs.modelBuildErrors[graph], graphErrors[_index]);
+    }
     model.SetFrameAttachedToGraph(frameAttachedToGraph);
 
-    auto poseRelativeToGraph = addPoseRelativeToGraph(
-        this->dataPtr->modelPoseRelativeToGraphs, model, errors);
+    auto &poseRelativeToGraph = poseGraphs.models[graph];
+    if (cached)
+    {
+      poseRelativeToGraph = cached->poseRelativeTo.models[_index];
+    }
+    else
+    {
+      buildAndValidateGraph(poseRelativeToGraph, model,
+          poseGraphs.modelBuildErrors[graph], graphErrors[_index]);
+    }
     model.SetPoseRelativeToGraph(poseRelativeToGraph);
+  });
+  for (Errors &modelErrors : graphErrors)
+  {
+    std::move(modelErrors.begin(), modelErrors.end(),
+              std::back_inserter(errors));
+  }
+  if (LoadObserver *observer = _config.Observer())
+  {
+    for (const Model &model : models)
+      observer->ModelLoaded(nullptr, model);
   }
 
   // Load all the lights.
   Errors lightLoadErrors = loadUniqueRepeated<Light>(this->dataPtr->sdf,
-      "light", this->dataPtr->lights);
+      "light", this->dataPtr->lights, _config.LoadThreadCount());
   errors.insert(errors.end(), lightLoadErrors.begin(), lightLoadErrors.end());
 
   // Load all the actors.
   Errors actorLoadErrors = loadUniqueRepeated<Actor>(this->dataPtr->sdf,
-      "actor", this->dataPtr->actors);
+      "actor", this->dataPtr->actors, _config.LoadThreadCount());
   errors.insert(errors.end(), actorLoadErrors.begin(), actorLoadErrors.end());
 
+  if (LoadObserver *observer = _config.Observer())
+  {
+    for (const Light &light : this->dataPtr->lights)
+      observer->LightLoaded(nullptr, light);
+    for (const Actor &actor : this->dataPtr->actors)
+      observer->ActorLoaded(nullptr, actor);
+  }
+
+  // Geometries with equal meshes share one entry of the registry, across
+  // the worlds and models. Geometries that share it already keep it. The
+  // contents of lazy models don't share them.
+  if (_config.ShareMeshes() && !_config.LazyModels())
+  {
+    this->dataPtr->shareMeshes = true;
+    for (World &world : this->dataPtr->worlds)
+      world.ShareMeshes(this->dataPtr->meshRegistry);
+    for (Model &model : this->dataPtr->models)
+      model.ShareMeshes(this->dataPtr->meshRegistry);
+  }
+
+  truncateErrors(errors, _config);
+  releaseElements();
   return errors;
 }
 
@@ -310,6 +990,12 @@ const World *Root::WorldByIndex(const uint64_t _index) const
   return nullptr;
 }
 
+/////////////////////////////////////////////////
+Span<const World> Root::Worlds() const
+{
+  return {this->dataPtr->worlds.data(), this->dataPtr->worlds.size()};
+}
+
 /////////////////////////////////////////////////
 bool Root::WorldNameExists(const std::string &_name) const
 {
@@ -409,3 +1095,467 @@ sdf::ElementPtr Root::Element() const
 {
   return this->dataPtr->sdf;
 }
+
+/////////////////////////////////////////////////
+const PluginIndex &Root::Plugins() const
+{
+  return this->dataPtr->plugins;
+}
+
+/////////////////////////////////////////////////
+MemoryFootprintReport Root::MemoryReport() const
+{
+  MemoryFootprintReport report;
+  MemoryFootprint total;
+  if (this->dataPtr->sdf)
+    total = this->dataPtr->sdf->MemoryUsage();
+
+  std::unordered_set<const void *> seen;
+  for (const World &world : this->dataPtr->worlds)
+    addDomFootprint(world, total, seen);
+  for (const Model &model : this->dataPtr->models)
+    addDomFootprint(model, total, seen);
+  for (const Light &light : this->dataPtr->lights)
+    addDomFootprint(light, total);
+  for (const Actor &actor : this->dataPtr->actors)
+    addDomFootprint(actor, total);
+
+  // Graphs are shared by their scopes, so each is counted once.
+  std::unordered_set<const void *> graphs;
+  auto addGraphs = [&graphs](const auto &_graphs, MemoryFootprint &_out)
+  {
+    for (const auto &graph : _graphs)
+    {
+      if (graph && graphs.insert(&graph.GraphData()).second)
+        _out.frameGraphs += frameGraphBytes(graph.GraphData());
+    }
+  };
+  addGraphs(this->dataPtr->frameAttachedToGraphs.worlds, total);
+  addGraphs(this->dataPtr->poseRelativeToGraphs.worlds, total);
+  addGraphs(this->dataPtr->frameAttachedToGraphs.models, total);
+  addGraphs(this->dataPtr->poseRelativeToGraphs.models, total);
+  report.SetTotal(total);
+
+  auto modelFootprint = [](const Model &_model)
+  {
+    MemoryFootprint footprint;
+    if (_model.Element())
+      footprint = _model.Element()->MemoryUsage();
+    std::unordered_set<const void *> modelSeen;
+    addDomFootprint(_model, footprint, modelSeen);
+    return footprint;
+  };
+  for (const World &world : this->dataPtr->worlds)
+  {
+    for (const Model &model : world.Models())
+      report.AddModel(world.Name() + "::" + model.Name(),
+          modelFootprint(model));
+  }
+
+  // The graphs of the model of the root belong to it alone.
+  graphs.clear();
+  for (const Model &model : this->dataPtr->models)
+  {
+    MemoryFootprint footprint = modelFootprint(model);
+    addGraphs(this->dataPtr->frameAttachedToGraphs.models, footprint);
+    addGraphs(this->dataPtr->poseRelativeToGraphs.models, footprint);
+    report.AddModel(model.Name(), footprint);
+  }
+
+  return report;
+}
+
+/////////////////////////////////////////////////
+Errors Root::ReloadIncludes(const std::vector<std::string> &_changedFiles,
+    const ParserConfig &_config)
+{
+  Errors errors;
+  if (!this->dataPtr->includesTracked)
+  {
+    errors.push_back({ErrorCode::ELEMENT_MISSING,
+        "Included models were not recorded. Load the document with "
+        "ParserConfig::TrackIncludes enabled to reload them."});
+    return errors;
+  }
+
+  // The include cache could otherwise return the old version of a file
+  // that was changed without changing its size or modification time.
+  IncludeCache &cache = IncludeCache::Instance();
+  for (const std::string &filename : _changedFiles)
+    cache.Remove(filename);
+
+  const std::unordered_set<std::string> changed(
+      _changedFiles.begin(), _changedFiles.end());
+  for (IncludeRecord &record : this->dataPtr->includes)
+  {
+    const bool affected = std::any_of(record.files.begin(),
+        record.files.end(), [&changed](const IncludeCache::FileStamp &_file)
+        {
+          return changed.count(_file.filename) > 0;
+        });
+    if (!affected)
+      continue;
+
+    const std::string filename = record.files.front().filename;
+    const ElementPtr elem = record.element.lock();
+    World *world = nullptr;
+    if (elem)
+    {
+      const ElementPtr parent = elem->GetParent();
+      for (World &candidate : this->dataPtr->worlds)
+      {
+        if (parent && candidate.Element() == parent)
+          world = &candidate;
+      }
+    }
+    if (!world)
+    {
+      errors.push_back({ErrorCode::ELEMENT_MISSING,
+          "The element of the model included from file[" + filename +
+          "] is no longer part of a world."});
+      continue;
+    }
+    const std::string name = elem->Get<std::string>("name");
+
+    // The <include> is read on its own, in a world that holds nothing
+    // else, so that the model is merged as it was the first time.
+    std::vector<IncludeRecord> newRecords;
+    SDFPtr sdfParsed(new SDF());
+    init(sdfParsed);
+    {
+      IncludeRecordScope recordScope(&newRecords);
+      readString("<sdf version='" + std::string(SDF_PROTOCOL_VERSION) +
+          "'><world name='reload'>" + record.xml + "</world></sdf>",
+          _config, sdfParsed, errors);
+    }
+    const ElementPtr newElem =
+        newRecords.size() == 1 ? newRecords[0].element.lock() : nullptr;
+    if (!newElem)
+    {
+      errors.push_back({ErrorCode::ELEMENT_MISSING,
+          "Unable to read model with name[" + name + "] again from file[" +
+          filename + "]."});
+      continue;
+    }
+
+    newElem->RemoveFromParent();
+    Errors replaceErrors = world->ReplaceModel(name, newElem);
+    errors.insert(errors.end(), replaceErrors.begin(), replaceErrors.end());
+    if (this->dataPtr->shareMeshes)
+      world->ShareMeshes(this->dataPtr->meshRegistry);
+    if (newElem->GetParent())
+    {
+      record.element = newElem;
+      record.files = std::move(newRecords[0].files);
+    }
+  }
+  return errors;
+}
+
+/////////////////////////////////////////////////
+Errors Root::ReloadIncludes(const ParserConfig &_config)
+{
+  const VirtualFilesystem &fs = FindFileSettings::FilesystemOf(_config);
+  std::vector<std::string> changed;
+  for (const IncludeRecord &record : this->dataPtr->includes)
+  {
+    for (const IncludeCache::FileStamp &file : record.files)
+    {
+      IncludeCache::FileStamp current;
+      if (IncludeCache::Stamp(fs, file.filename, current) &&
+          current.size == file.size && current.modified == file.modified)
+      {
+        continue;
+      }
+      if (std::find(changed.begin(), changed.end(), file.filename) ==
+          changed.end())
+      {
+        changed.push_back(file.filename);
+      }
+    }
+  }
+  return this->ReloadIncludes(changed, _config);
+}
+
+/////////////////////////////////////////////////
+Errors Root::Merge(const Root &_layer, const std::string &_worldName)
+{
+  Errors errors;
+  auto findWorld = [this](const std::string &_name) -> World *
+  {
+    for (World &world : this->dataPtr->worlds)
+    {
+      if (world.Name() == _name)
+        return &world;
+    }
+    return nullptr;
+  };
+
+  std::unordered_set<World *> merged;
+  for (const World &layerWorld : _layer.dataPtr->worlds)
+  {
+    const std::string name =
+        _worldName.empty() ? layerWorld.Name() : _worldName;
+    World *world = findWorld(name);
+    if (!world)
+    {
+      errors.push_back({ErrorCode::ELEMENT_MISSING,
+          "World with name[" + layerWorld.Name() + "] can not be merged, "
+          "there is no world with name[" + name + "]."});
+      continue;
+    }
+
+    for (const Frame &frame : layerWorld.Frames())
+    {
+      errors.push_back({ErrorCode::ELEMENT_INVALID,
+          "Frame with name[" + frame.Name() + "] of world with name[" +
+          layerWorld.Name() + "] is not merged, only models, lights and "
+          "actors are."});
+    }
+
+    Errors mergeErrors = world->Merge(layerWorld.Models(),
+        layerWorld.Lights(), layerWorld.Actors());
+    errors.insert(errors.end(), mergeErrors.begin(), mergeErrors.end());
+    merged.insert(world);
+  }
+
+  const RootPrivate &layer = *_layer.dataPtr;
+  if (!layer.models.empty() || !layer.lights.empty() ||
+      !layer.actors.empty())
+  {
+    World *world = nullptr;
+    if (!_worldName.empty())
+      world = findWorld(_worldName);
+    else if (!this->dataPtr->worlds.empty())
+      world = &this->dataPtr->worlds.front();
+
+    if (!world)
+    {
+      errors.push_back({ErrorCode::ELEMENT_MISSING,
+          "The models, lights and actors at the root of the layer can not "
+          "be merged, there is no world" + (_worldName.empty() ? "" :
+          " with name[" + _worldName + "]") + "."});
+    }
+    else
+    {
+      Errors mergeErrors = world->Merge(
+          {layer.models.data(), layer.models.size()},
+          {layer.lights.data(), layer.lights.size()},
+          {layer.actors.data(), layer.actors.size()});
+      errors.insert(errors.end(), mergeErrors.begin(), mergeErrors.end());
+      merged.insert(world);
+    }
+  }
+
+  if (this->dataPtr->shareMeshes)
+  {
+    for (World *world : merged)
+      world->ShareMeshes(this->dataPtr->meshRegistry);
+  }
+  return errors;
+}
+
+/////////////////////////////////////////////////
+Errors Root::ApplyState(const StateFrame &_state)
+{
+  auto &worlds = this->dataPtr->worlds;
+  auto world = worlds.end();
+  if (_state.WorldName().empty())
+  {
+    if (worlds.size() == 1u)
+      world = worlds.begin();
+  }
+  else
+  {
+    world = std::find_if(worlds.begin(), worlds.end(),
+        [&_state](const World &_world)
+        {
+          return _world.Name() == _state.WorldName();
+        });
+  }
+
+  if (world == worlds.end())
+  {
+    return {Error(ErrorCode::ELEMENT_MISSING,
+        "State with world name[" + _state.WorldName() +
+        "] does not match a world of the root.")};
+  }
+  return world->ApplyState(_state);
+}
+
+/////////////////////////////////////////////////
+uint64_t Root::MeshCount() const
+{
+  return this->dataPtr->meshRegistry.Count();
+}
+
+/////////////////////////////////////////////////
+const Mesh *Root::MeshByIndex(const uint64_t _index) const
+{
+  return this->dataPtr->meshRegistry.ByIndex(_index);
+}
+
+/////////////////////////////////////////////////
+uint64_t Root::MeshReferenceCount(const uint64_t _index) const
+{
+  return this->dataPtr->meshRegistry.ReferenceCount(_index);
+}
+
+/////////////////////////////////////////////////
+std::vector<std::string> Root::IncludedFiles() const
+{
+  std::vector<std::string> files;
+  std::unordered_set<std::string> seen;
+  for (const IncludeRecord &record : this->dataPtr->includes)
+  {
+    for (const IncludeCache::FileStamp &file : record.files)
+    {
+      if (seen.insert(file.filename).second)
+        files.push_back(file.filename);
+    }
+  }
+  return files;
+}
+
+/////////////////////////////////////////////////
+Errors Root::Reparse(const std::string &_text, const TextEdit &_edit,
+    const ParserConfig &_config)
+{
+  SDF_TRACE_SCOPE("sdf::Root::Reparse");
+  ParserConfig config = _config;
+  config.SetRecordSourceRanges(true);
+
+  auto reload = [&]()
+  {
+    Root root;
+    Errors errors = root.LoadSdfString(_text, config);
+    *this = std::move(root);
+    return errors;
+  };
+
+  // The text after the edit must be the same as before it.
+  const std::string &oldText = this->dataPtr->sourceText;
+  if (!this->dataPtr->sourceRanges || !this->dataPtr->sdf ||
+      _edit.begin > _edit.oldEnd || _edit.begin > _edit.newEnd ||
+      _edit.oldEnd > oldText.size() || _edit.newEnd > _text.size() ||
+      oldText.size() - _edit.oldEnd != _text.size() - _edit.newEnd)
+  {
+    return reload();
+  }
+
+  // The smallest part of the DOM that is loaded again is a top level model
+  // of a world.
+  const ElementPtr elem = enclosingElement(this->dataPtr->sdf, _edit);
+  ElementPtr model = elem;
+  while (model && !(model->GetName() == "model" && model->GetParent() &&
+      model->GetParent()->GetName() == "world"))
+  {
+    model = model->GetParent();
+  }
+  World *world = nullptr;
+  for (World &candidate : this->dataPtr->worlds)
+  {
+    if (model && candidate.Element() == model->GetParent())
+      world = &candidate;
+  }
+  std::size_t modelIndex = 0;
+  while (world && modelIndex < world->ModelCount() &&
+      world->ModelByIndex(modelIndex)->Element() != model)
+  {
+    ++modelIndex;
+  }
+  if (!world || modelIndex == world->ModelCount())
+    return reload();
+
+  const TextRange range = elem->SourceRange();
+  Errors errors;
+  const ElementPtr newElem = SourceRanges::Read(_text.data() + range.begin,
+      range.end - _edit.oldEnd + _edit.newEnd - range.begin, range,
+      elem->GetParent(), config, errors);
+  if (!newElem || newElem->GetName() != elem->GetName())
+    return reload();
+
+  // The element is swapped in a copy of the model, so that the tree is
+  // left as it was if the model fails to load.
+  ElementPtr newModel = newElem;
+  if (elem != model)
+  {
+    std::vector<std::size_t> path;
+    for (ElementPtr child = elem; child != model; child = child->GetParent())
+    {
+      std::size_t position = 0;
+      for (ElementPtr sibling = child->GetParent()->GetFirstElement();
+           sibling != child; sibling = sibling->GetNextElement())
+      {
+        ++position;
+      }
+      path.push_back(position);
+    }
+
+    newModel = model->Clone();
+    ElementPtr oldElem = newModel;
+    for (auto position = path.rbegin(); position != path.rend(); ++position)
+    {
+      oldElem = oldElem->GetFirstElement();
+      for (std::size_t i = 0; i < *position; ++i)
+        oldElem = oldElem->GetNextElement();
+    }
+    ElementEdit edit(oldElem->GetParent());
+    edit.Replace(oldElem, newElem);
+    edit.Commit();
+  }
+
+  const std::string name = model->Get<std::string>("name");
+  Errors replaceErrors = world->ReplaceModel(name, newModel);
+  if (world->ModelByIndex(modelIndex)->Element() != newModel)
+    return reload();
+  errors.insert(errors.end(), replaceErrors.begin(), replaceErrors.end());
+
+  unsigned int oldLine = range.beginLine;
+  unsigned int oldColumn = range.beginColumn;
+  SourceRanges::Advance(oldText.data() + range.begin,
+      oldText.data() + _edit.oldEnd, oldLine, oldColumn);
+  unsigned int newLine = range.beginLine;
+  unsigned int newColumn = range.beginColumn;
+  SourceRanges::Advance(_text.data() + range.begin,
+      _text.data() + _edit.newEnd, newLine, newColumn);
+  shiftSourceRanges(this->dataPtr->sdf, newElem, _edit, oldLine, oldColumn,
+      newLine, newColumn);
+
+  if (this->dataPtr->shareMeshes)
+    world->ShareMeshes(this->dataPtr->meshRegistry);
+  this->dataPtr->plugins.Build(this->dataPtr->sdf);
+  this->dataPtr->sourceText = _text;
+  return errors;
+}
+
+/////////////////////////////////////////////////
+const RootGraphs<FrameAttachedToGraph> &Root::FrameAttachedToGraphs() const
+{
+  this->dataPtr->BuildDeferredGraphs();
+  return this->dataPtr->frameAttachedToGraphs;
+}
+
+/////////////////////////////////////////////////
+const RootGraphs<PoseRelativeToGraph> &Root::PoseRelativeToGraphs() const
+{
+  this->dataPtr->BuildDeferredGraphs();
+  return this->dataPtr->poseRelativeToGraphs;
+}
+
+/////////////////////////////////////////////////
+std::size_t Root::DeferredGraphCount() const
+{
+  return this->dataPtr->deferredGraphs.size();
+}
+
+/////////////////////////////////////////////////
+Errors Root::BuildDeferredGraphs(std::size_t _index) const
+{
+  if (_index >= this->dataPtr->deferredGraphs.size())
+    return Errors();
+
+  DeferredGraphs &graphs = *this->dataPtr->deferredGraphs[_index];
+  graphs.Build();
+  return graphs.BuildErrors();
+}
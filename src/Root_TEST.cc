@@ -16,15 +16,38 @@
 */
 
 #include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <ignition/math/AxisAlignedBox.hh>
+#include <ignition/math/Color.hh>
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Vector3.hh>
 #include "sdf/Actor.hh"
+#include "sdf/CancellationToken.hh"
 #include "sdf/sdf_config.h"
 #include "sdf/Collision.hh"
 #include "sdf/Error.hh"
+#include "sdf/Filesystem.hh"
 #include "sdf/Link.hh"
+#include "sdf/Material.hh"
+#include "sdf/Mesh.hh"
 #include "sdf/Light.hh"
+#include "sdf/LoadObserver.hh"
+#include "sdf/LoadStats.hh"
 #include "sdf/Model.hh"
+#include "sdf/ParserConfig.hh"
+#include "sdf/Visual.hh"
 #include "sdf/World.hh"
 #include "sdf/Frame.hh"
+#include "sdf/Geometry.hh"
+#include "sdf/Sphere.hh"
 #include "sdf/Root.hh"
 
 /////////////////////////////////////////////////
@@ -155,6 +178,1093 @@ TEST(DOMRoot, StringParse)
   EXPECT_NE(nullptr, actor->Element());
 }
 
+/////////////////////////////////////////////////
+TEST(DOMRoot, BufferAndStreamParse)
+{
+  // The buffer is not null terminated where the document ends.
+  const std::string buffer =
+    "<sdf version='1.8'>"
+    "  <model name='shapes'><link name='link'/></model>"
+    "</sdf>garbage";
+  const std::size_t size = buffer.find("garbage");
+
+  sdf::Root root;
+  EXPECT_TRUE(root.LoadSdfBuffer(buffer.data(), size,
+      sdf::ParserConfig()).empty());
+  ASSERT_NE(nullptr, root.ModelByIndex(0));
+  EXPECT_EQ("shapes", root.ModelByIndex(0)->Name());
+
+  // Cutting the buffer in the end tag leaves the document unterminated.
+  sdf::Errors errors = root.LoadSdfBuffer(buffer.data(), size - 3,
+      sdf::ParserConfig());
+  ASSERT_FALSE(errors.empty());
+  EXPECT_EQ(sdf::ErrorCode::STRING_READ, errors.back().Code());
+
+  std::istringstream stream(buffer.substr(0, size));
+  sdf::Root streamRoot;
+  EXPECT_TRUE(streamRoot.LoadSdfStream(stream, sdf::ParserConfig()).empty());
+  ASSERT_NE(nullptr, streamRoot.ModelByIndex(0));
+  EXPECT_EQ("link", streamRoot.ModelByIndex(0)->LinkByIndex(0)->Name());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMRoot, ParallelLoad)
+{
+  std::string sdf = "<?xml version=\"1.0\"?>"
+    "<sdf version=\"1.8\">"
+    "  <world name='default'>";
+  for (int i = 0; i < 40; ++i)
+  {
+    const std::string index = std::to_string(i);
+    sdf += "<model name='model" + index + "'>"
+      "  <link name='link'/>"
+      "</model>"
+      "<light type='point' name='light" + index + "'/>";
+  }
+  // A duplicate model name and a model without links, both of which must be
+  // reported in document order.
+  sdf += "    <model name='model7'>"
+    "      <link name='link'/>"
+    "    </model>"
+    "    <model name='empty'/>"
+    "  </world>"
+    "  <model name='top'>"
+    "    <link name='link'/>"
+    "  </model>"
+    "</sdf>";
+
+  sdf::Root sequentialRoot;
+  sdf::Errors sequentialErrors = sequentialRoot.LoadSdfString(sdf);
+  ASSERT_FALSE(sequentialErrors.empty());
+
+  sdf::ParserConfig config;
+  config.SetLoadThreadCount(4u);
+
+  sdf::Root parallelRoot;
+  sdf::Errors parallelErrors = parallelRoot.LoadSdfString(sdf, config);
+  ASSERT_EQ(sequentialErrors.size(), parallelErrors.size());
+  for (std::size_t i = 0; i < sequentialErrors.size(); ++i)
+  {
+    EXPECT_EQ(sequentialErrors[i].Code(), parallelErrors[i].Code());
+    EXPECT_EQ(sequentialErrors[i].Message(), parallelErrors[i].Message());
+  }
+
+  ASSERT_EQ(1u, parallelRoot.WorldCount());
+  const sdf::World *sequentialWorld = sequentialRoot.WorldByIndex(0);
+  const sdf::World *parallelWorld = parallelRoot.WorldByIndex(0);
+  ASSERT_NE(nullptr, sequentialWorld);
+  ASSERT_NE(nullptr, parallelWorld);
+
+  EXPECT_EQ(41u, parallelWorld->ModelCount());
+  ASSERT_EQ(sequentialWorld->ModelCount(), parallelWorld->ModelCount());
+  for (uint64_t i = 0; i < parallelWorld->ModelCount(); ++i)
+  {
+    EXPECT_EQ(sequentialWorld->ModelByIndex(i)->Name(),
+              parallelWorld->ModelByIndex(i)->Name());
+  }
+
+  EXPECT_EQ(40u, parallelWorld->LightCount());
+  ASSERT_EQ(sequentialWorld->LightCount(), parallelWorld->LightCount());
+  for (uint64_t i = 0; i < parallelWorld->LightCount(); ++i)
+  {
+    EXPECT_EQ(sequentialWorld->LightByIndex(i)->Name(),
+              parallelWorld->LightByIndex(i)->Name());
+  }
+
+  EXPECT_EQ(1u, parallelRoot.ModelCount());
+  EXPECT_TRUE(parallelRoot.ModelNameExists("top"));
+}
+
+/////////////////////////////////////////////////
+TEST(DOMRoot, PipelinedLoad)
+{
+  const std::string path = sdf::filesystem::append(
+      sdf::filesystem::current_path(), "root_pipelined_load.sdf");
+  {
+    std::ofstream output(path);
+    output << "<sdf version='1.8'><world name='default'>";
+    for (int i = 0; i < 30; ++i)
+    {
+      const std::string index = std::to_string(i);
+      output << "<model name='model" << index << "'>"
+        "<pose>" << index << " 0 0 0 0 0</pose>"
+        "<link name='link'/>"
+        "<frame name='f' attached_to='link'/>"
+        "</model>"
+        "<light type='point' name='light" << index << "'/>";
+    }
+    // A duplicate model name and a model without links, which are reported
+    // in document order.
+    output << "<model name='model7'><link name='link'/></model>"
+      "<model name='empty'/>"
+      "</world><model name='top'><link name='link'/></model></sdf>";
+  }
+
+  sdf::Root sequentialRoot;
+  const sdf::Errors sequentialErrors = sequentialRoot.Load(path);
+  ASSERT_FALSE(sequentialErrors.empty());
+
+  for (unsigned int threads : {1u, 4u})
+  {
+    sdf::ParserConfig config;
+    config.SetPipelinedLoad(true);
+    config.SetLoadThreadCount(threads);
+
+    sdf::Root root;
+    const sdf::Errors errors = root.Load(path, config);
+    ASSERT_EQ(sequentialErrors.size(), errors.size());
+    for (std::size_t i = 0; i < errors.size(); ++i)
+    {
+      EXPECT_EQ(sequentialErrors[i].Code(), errors[i].Code());
+      EXPECT_EQ(sequentialErrors[i].Message(), errors[i].Message());
+    }
+
+    const sdf::World *sequentialWorld = sequentialRoot.WorldByIndex(0);
+    const sdf::World *world = root.WorldByIndex(0);
+    ASSERT_NE(nullptr, world);
+    EXPECT_EQ(31u, world->ModelCount());
+    ASSERT_EQ(sequentialWorld->ModelCount(), world->ModelCount());
+    for (uint64_t i = 0; i < world->ModelCount(); ++i)
+    {
+      EXPECT_EQ(sequentialWorld->ModelByIndex(i)->Name(),
+                world->ModelByIndex(i)->Name());
+    }
+    EXPECT_EQ(30u, world->LightCount());
+    EXPECT_TRUE(root.ModelNameExists("top"));
+
+    // The frame graphs of the preloaded models are built as usual.
+    const sdf::Model *model = world->ModelByName("model12");
+    ASSERT_NE(nullptr, model);
+    ignition::math::Pose3d pose;
+    EXPECT_TRUE(model->SemanticPose().Resolve(pose, "world").empty());
+    EXPECT_EQ(ignition::math::Pose3d(12, 0, 0, 0, 0, 0), pose);
+    std::string body;
+    EXPECT_TRUE(model->FrameByName("f")->ResolveAttachedToBody(body).empty());
+    EXPECT_EQ("link", body);
+  }
+
+  EXPECT_EQ(0, std::remove(path.c_str()));
+}
+
+/////////////////////////////////////////////////
+TEST(DOMRoot, SkippedElements)
+{
+  const std::string sdf = "<?xml version=\"1.0\"?>"
+    "<sdf version=\"1.8\">"
+    "  <world name='default'>"
+    "    <gui/>"
+    "    <scene><ambient>0.1 0.1 0.1 1</ambient></scene>"
+    "    <light type='point' name='lamp'/>"
+    "    <model name='robot'>"
+    "      <link name='link'>"
+    "        <collision name='collision'>"
+    "          <geometry><sphere><radius>1</radius></sphere></geometry>"
+    "        </collision>"
+    "        <visual name='visual'>"
+    "          <geometry><sphere><radius>1</radius></sphere></geometry>"
+    "          <material><ambient>1 0 0 1</ambient></material>"
+    "        </visual>"
+    "        <sensor name='camera' type='camera'/>"
+    "      </link>"
+    "      <plugin name='p' filename='libp.so'/>"
+    "    </model>"
+    "  </world>"
+    "</sdf>";
+
+  sdf::Root fullRoot;
+  EXPECT_TRUE(fullRoot.LoadSdfString(sdf).empty());
+  const sdf::World *fullWorld = fullRoot.WorldByIndex(0);
+  ASSERT_NE(nullptr, fullWorld);
+  EXPECT_EQ(1u, fullWorld->LightCount());
+  EXPECT_NE(nullptr, fullWorld->Gui());
+  EXPECT_EQ(1u, fullWorld->ModelByIndex(0)->LinkByIndex(0)->VisualCount());
+
+  sdf::ParserConfig config;
+  config.SetSkippedElements(
+      {"gui", "light", "plugin", "scene", "sensor", "visual"});
+
+  sdf::Root root;
+  EXPECT_TRUE(root.LoadSdfString(sdf, config).empty());
+  ASSERT_EQ(1u, root.WorldCount());
+  const sdf::World *world = root.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+  EXPECT_EQ(0u, world->LightCount());
+  EXPECT_EQ(nullptr, world->Gui());
+  EXPECT_EQ(nullptr, world->Scene());
+
+  ASSERT_EQ(1u, world->ModelCount());
+  const sdf::Link *link = world->ModelByIndex(0)->LinkByIndex(0);
+  ASSERT_NE(nullptr, link);
+  EXPECT_EQ(1u, link->CollisionCount());
+  EXPECT_EQ(0u, link->VisualCount());
+  EXPECT_EQ(0u, link->SensorCount());
+
+  // The element tree leaves the skipped elements out as well.
+  sdf::ElementPtr modelElem = world->ModelByIndex(0)->Element();
+  EXPECT_FALSE(modelElem->HasElement("plugin"));
+  EXPECT_FALSE(modelElem->GetElement("link")->HasElement("visual"));
+  EXPECT_FALSE(world->Element()->HasElement("scene"));
+}
+
+/////////////////////////////////////////////////
+TEST(DOMRoot, RegionFilter)
+{
+  const std::string sdf = "<?xml version=\"1.0\"?>"
+    "<sdf version=\"1.8\">"
+    "  <world name='default'>"
+    "    <model name='near'>"
+    "      <link name='link'/>"
+    "    </model>"
+    "    <model name='far'>"
+    "      <link name='link'/>"
+    "      <pose>100 0 0 0 0 0</pose>"
+    "    </model>"
+    "    <model name='beside_far'>"
+    "      <pose relative_to='far'>0 1 0 0 0 0</pose>"
+    "      <link name='link'/>"
+    "    </model>"
+    "    <include>"
+    "      <uri>model://does_not_exist</uri>"
+    "      <name>missing</name>"
+    "      <pose>-100 0 0 0 0 0</pose>"
+    "    </include>"
+    "    <frame name='near_frame' attached_to='near'/>"
+    "  </world>"
+    "</sdf>";
+
+  sdf::ParserConfig config;
+  EXPECT_FALSE(config.RegionFilter());
+  config.SetRegionFilter(ignition::math::AxisAlignedBox(
+      ignition::math::Vector3d(-10, -10, -10),
+      ignition::math::Vector3d(10, 10, 10)));
+  ASSERT_TRUE(config.RegionFilter());
+  EXPECT_TRUE(config.RegionFilter()("a", ignition::math::Pose3d::Zero));
+
+  // The include outside the region is not resolved, and the model placed
+  // relative to the far one is loaded and fails to find it.
+  sdf::Root root;
+  sdf::Errors errors = root.LoadSdfString(sdf, config);
+  ASSERT_FALSE(errors.empty());
+  EXPECT_EQ(sdf::ErrorCode::POSE_RELATIVE_TO_INVALID, errors[0].Code());
+  EXPECT_NE(std::string::npos, errors[0].Message().find(
+      "refers to model with name[far] at position [100 0 0], which is "
+      "outside the region"));
+  for (const sdf::Error &error : errors)
+    EXPECT_EQ(std::string::npos, error.Message().find("does_not_exist"));
+
+  const sdf::World *world = root.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+  EXPECT_EQ(2u, world->ModelCount());
+  EXPECT_TRUE(world->ModelNameExists("near"));
+  EXPECT_FALSE(world->ModelNameExists("far"));
+  EXPECT_TRUE(world->ModelNameExists("beside_far"));
+  EXPECT_FALSE(world->ModelNameExists("missing"));
+
+  // References within the region are still validated.
+  config.SetRegionFilter(
+      [](const std::string &_name, const ignition::math::Pose3d &)
+      {
+        return _name != "missing";
+      });
+  sdf::Root farRoot;
+  EXPECT_TRUE(farRoot.LoadSdfString(sdf, config).empty());
+  ASSERT_NE(nullptr, farRoot.WorldByIndex(0));
+  EXPECT_EQ(3u, farRoot.WorldByIndex(0)->ModelCount());
+  EXPECT_EQ(1u, farRoot.WorldByIndex(0)->FrameCount());
+
+  // The streaming reader reads the models of the world as XML to find
+  // their pose.
+  config.SetRegionFilter(
+      [](const std::string &, const ignition::math::Pose3d &_pose)
+      {
+        return _pose.Pos().Length() < 50;
+      });
+  config.SetStreamingRead(true);
+  std::istringstream stream(sdf);
+  sdf::Root streamRoot;
+  errors = streamRoot.LoadSdfStream(stream, config);
+  ASSERT_FALSE(errors.empty());
+  EXPECT_EQ(sdf::ErrorCode::POSE_RELATIVE_TO_INVALID, errors[0].Code());
+  ASSERT_NE(nullptr, streamRoot.WorldByIndex(0));
+  EXPECT_FALSE(streamRoot.WorldByIndex(0)->ModelNameExists("far"));
+  EXPECT_TRUE(streamRoot.WorldByIndex(0)->ModelNameExists("near"));
+
+  config.SetRegionFilter(nullptr);
+  EXPECT_FALSE(config.RegionFilter());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMRoot, MaxErrors)
+{
+  // Every model without a link is an error.
+  std::string sdf = "<?xml version=\"1.0\"?>"
+    "<sdf version=\"1.8\">"
+    "  <world name='default'>";
+  for (int i = 0; i < 20; ++i)
+    sdf += "<model name='model" + std::to_string(i) + "'/>";
+  sdf += "    <light type='point' name='lamp'/>"
+    "  </world>"
+    "</sdf>";
+
+  sdf::Root fullRoot;
+  EXPECT_LE(20u, fullRoot.LoadSdfString(sdf).size());
+  ASSERT_NE(nullptr, fullRoot.WorldByIndex(0));
+  EXPECT_EQ(1u, fullRoot.WorldByIndex(0)->LightCount());
+
+  sdf::ParserConfig config;
+  config.SetMaxErrors(3);
+  sdf::Root root;
+  sdf::Errors errors = root.LoadSdfString(sdf, config);
+  ASSERT_EQ(3u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::MODEL_WITHOUT_LINK, errors[0].Code());
+
+  // The children after the models are left out once the budget is used.
+  const sdf::World *world = root.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+  EXPECT_EQ(20u, world->ModelCount());
+  EXPECT_EQ(0u, world->LightCount());
+
+  // Fail on the first error.
+  config.SetMaxErrors(1);
+  sdf::Root failFastRoot;
+  EXPECT_EQ(1u, failFastRoot.LoadSdfString(sdf, config).size());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMRoot, ReleaseElements)
+{
+  const std::string sdf = "<?xml version=\"1.0\"?>"
+    "<sdf version=\"1.8\">"
+    "  <world name='default'>"
+    "    <light type='point' name='lamp'/>"
+    "    <model name='robot'>"
+    "      <link name='link'>"
+    "        <visual name='visual'>"
+    "          <geometry><sphere><radius>2</radius></sphere></geometry>"
+    "        </visual>"
+    "      </link>"
+    "      <frame name='frame' attached_to='link'/>"
+    "      <model name='nested'>"
+    "        <link name='link'/>"
+    "      </model>"
+    "    </model>"
+    "  </world>"
+    "</sdf>";
+
+  sdf::ParserConfig config;
+  config.SetReleaseElements(true);
+  config.SetLoadThreadCount(2u);
+
+  sdf::Root root;
+  EXPECT_TRUE(root.LoadSdfString(sdf, config).empty());
+  EXPECT_EQ(nullptr, root.Element());
+  EXPECT_EQ("1.8", root.Version());
+
+  const sdf::World *world = root.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+  EXPECT_EQ(nullptr, world->Element());
+  ASSERT_EQ(1u, world->LightCount());
+  EXPECT_EQ(nullptr, world->LightByIndex(0)->Element());
+
+  const sdf::Model *model = world->ModelByIndex(0);
+  ASSERT_NE(nullptr, model);
+  EXPECT_EQ(nullptr, model->Element());
+  ASSERT_EQ(1u, model->ModelCount());
+  EXPECT_EQ(nullptr, model->ModelByIndex(0)->Element());
+
+  const sdf::Link *link = model->LinkByIndex(0);
+  ASSERT_NE(nullptr, link);
+  EXPECT_EQ(nullptr, link->Element());
+  ASSERT_EQ(1u, link->VisualCount());
+  const sdf::Visual *visual = link->VisualByIndex(0);
+  EXPECT_EQ(nullptr, visual->Element());
+  EXPECT_EQ(nullptr, visual->Geom()->Element());
+  ASSERT_NE(nullptr, visual->Geom()->SphereShape());
+  EXPECT_DOUBLE_EQ(2.0, visual->Geom()->SphereShape()->Radius());
+
+  // The graphs were built before the elements were released.
+  const sdf::Frame *frame = model->FrameByIndex(0);
+  ASSERT_NE(nullptr, frame);
+  EXPECT_EQ(nullptr, frame->Element());
+  std::string body;
+  EXPECT_TRUE(frame->ResolveAttachedToBody(body).empty());
+  EXPECT_EQ("link", body);
+
+  // The elements are kept by default.
+  sdf::Root keptRoot;
+  EXPECT_TRUE(keptRoot.LoadSdfString(sdf).empty());
+  EXPECT_NE(nullptr, keptRoot.Element());
+  const sdf::Model *keptModel = keptRoot.WorldByIndex(0)->ModelByIndex(0);
+  EXPECT_NE(nullptr, keptModel->Element());
+  EXPECT_NE(nullptr, keptModel->LinkByIndex(0)->VisualByIndex(0)->Element());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMRoot, TrustedInput)
+{
+  const std::string sdf = "<?xml version=\"1.0\"?>"
+    "<sdf version=\"1.8\">"
+    "  <model name='__robot__'>"
+    "    <link name='link'/>"
+    "    <frame name='frame' attached_to='link'/>"
+    "  </model>"
+    "</sdf>";
+
+  sdf::Root root;
+  sdf::Errors errors = root.LoadSdfString(sdf);
+  ASSERT_FALSE(errors.empty());
+  EXPECT_EQ(sdf::ErrorCode::RESERVED_NAME, errors[0].Code());
+
+  // Trusted loads skip the validation, but still build the graphs.
+  sdf::ParserConfig config;
+  config.SetTrustedInput(true);
+  sdf::Root trustedRoot;
+  EXPECT_TRUE(trustedRoot.LoadSdfString(sdf, config).empty());
+  const sdf::Model *model = trustedRoot.ModelByIndex(0);
+  ASSERT_NE(nullptr, model);
+  const sdf::Frame *frame = model->FrameByIndex(0);
+  ASSERT_NE(nullptr, frame);
+  std::string body;
+  EXPECT_TRUE(frame->ResolveAttachedToBody(body).empty());
+  EXPECT_EQ("link", body);
+}
+
+/////////////////////////////////////////////////
+TEST(DOMRoot, LazyModels)
+{
+  const std::string sdf = "<?xml version=\"1.0\"?>"
+    "<sdf version=\"1.8\">"
+    "  <world name='default'>"
+    "    <model name='a'>"
+    "      <pose>1 0 0 0 0 0</pose>"
+    "      <link name='link'>"
+    "        <pose>0 2 0 0 0 0</pose>"
+    "      </link>"
+    "    </model>"
+    "    <model name='b'>"
+    "      <link name='link'/>"
+    "      <model name='nested'>"
+    "        <link name='link'/>"
+    "      </model>"
+    "    </model>"
+    "  </world>"
+    "</sdf>";
+
+  sdf::ParserConfig config;
+  config.SetLazyModels(true);
+  sdf::Root root;
+  EXPECT_TRUE(root.LoadSdfString(sdf, config).empty());
+  const sdf::World *world = root.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+  ASSERT_EQ(2u, world->ModelCount());
+  const sdf::Model *a = world->ModelByIndex(0);
+  const sdf::Model *b = world->ModelByIndex(1);
+
+  // The properties are loaded with the model, and the contents on first
+  // access.
+  EXPECT_EQ("a", a->Name());
+  EXPECT_EQ(ignition::math::Pose3d(1, 0, 0, 0, 0, 0), a->RawPose());
+  EXPECT_FALSE(a->ContentsLoaded());
+  EXPECT_FALSE(b->ContentsLoaded());
+  EXPECT_EQ(1u, b->LinkCount());
+  EXPECT_TRUE(b->ContentsLoaded());
+  EXPECT_EQ(1u, b->ModelCount());
+
+  // Building the graphs of the world loaded the other model.
+  EXPECT_TRUE(a->ContentsLoaded());
+  ignition::math::Pose3d pose;
+  EXPECT_TRUE(
+      a->LinkByIndex(0)->SemanticPose().Resolve(pose, "world").empty());
+  EXPECT_EQ(ignition::math::Pose3d(1, 2, 0, 0, 0, 0), pose);
+  EXPECT_NE(nullptr, world->LinkByScopedName("b::nested::link"));
+  EXPECT_TRUE(a->LoadContents().empty());
+
+  // Concurrent first accesses wait for one load.
+  sdf::Root concurrentRoot;
+  EXPECT_TRUE(concurrentRoot.LoadSdfString(sdf, config).empty());
+  world = concurrentRoot.WorldByIndex(0);
+  std::atomic<int> resolved{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t)
+  {
+    threads.emplace_back([&resolved, world, t]()
+        {
+          const sdf::Model *model = world->ModelByIndex(t % 2);
+          ignition::math::Pose3d linkPose;
+          if (model->LinkCount() == 1u && model->LinkByIndex(0)->
+                SemanticPose().Resolve(linkPose, "world").empty())
+          {
+            ++resolved;
+          }
+        });
+  }
+  for (std::thread &thread : threads)
+    thread.join();
+  EXPECT_EQ(4, resolved);
+
+  // The errors of the graphs are given when the contents are loaded.
+  const std::string invalid = "<?xml version=\"1.0\"?>"
+    "<sdf version=\"1.8\">"
+    "  <model name='m'>"
+    "    <link name='link'/>"
+    "    <frame name='frame' attached_to='missing'/>"
+    "  </model>"
+    "</sdf>";
+  sdf::Root eagerRoot;
+  sdf::Errors eagerErrors = eagerRoot.LoadSdfString(invalid);
+  ASSERT_FALSE(eagerErrors.empty());
+
+  sdf::Root lazyRoot;
+  EXPECT_TRUE(lazyRoot.LoadSdfString(invalid, config).empty());
+  const sdf::Model *model = lazyRoot.ModelByIndex(0);
+  ASSERT_NE(nullptr, model);
+  EXPECT_FALSE(model->ContentsLoaded());
+  sdf::Errors lazyErrors = model->LoadContents();
+  ASSERT_EQ(eagerErrors.size(), lazyErrors.size());
+  EXPECT_EQ(eagerErrors[0].Code(), lazyErrors[0].Code());
+  EXPECT_EQ(1u, model->FrameCount());
+
+  // Copies have the contents.
+  sdf::Root copyRoot;
+  EXPECT_TRUE(copyRoot.LoadSdfString(sdf, config).empty());
+  sdf::World copy(*copyRoot.WorldByIndex(0));
+  EXPECT_TRUE(copy.ModelByIndex(0)->ContentsLoaded());
+  EXPECT_EQ(1u, copy.ModelByIndex(1)->ModelCount());
+}
+
+/////////////////////////////////////////////////
+/// \brief Observer that records the entities it is given.
+class RecordingObserver : public sdf::LoadObserver
+{
+  public: void ModelLoaded(const sdf::World *_world,
+              const sdf::Model &_model) override
+  {
+    std::string prefix = _world ? _world->Name() + "/" : "";
+    this->names.push_back(prefix + "model " + _model.Name());
+
+    // The graphs of the scope of the model are built.
+    ignition::math::Pose3d pose;
+    if (_model.LinkCount() > 0u && _model.LinkByIndex(0)->SemanticPose()
+          .Resolve(pose, _world ? "world" : "__model__").empty())
+    {
+      this->poses.push_back(pose);
+    }
+  }
+
+  public: void LightLoaded(const sdf::World *_world,
+              const sdf::Light &_light) override
+  {
+    std::string prefix = _world ? _world->Name() + "/" : "";
+    this->names.push_back(prefix + "light " + _light.Name());
+  }
+
+  /// \brief Entities in the order they were given.
+  public: std::vector<std::string> names;
+
+  /// \brief Resolved poses of the first link of each model.
+  public: std::vector<ignition::math::Pose3d> poses;
+};
+
+/////////////////////////////////////////////////
+TEST(DOMRoot, LoadObserver)
+{
+  const std::string sdf = "<?xml version=\"1.0\"?>"
+    "<sdf version=\"1.8\">"
+    "  <world name='w1'>"
+    "    <model name='a'>"
+    "      <pose>1 0 0 0 0 0</pose>"
+    "      <link name='link'/>"
+    "    </model>"
+    "    <model name='b'>"
+    "      <pose relative_to='f'>0 1 0 0 0 0</pose>"
+    "      <link name='link'/>"
+    "    </model>"
+    "    <frame name='f'><pose>0 0 1 0 0 0</pose></frame>"
+    "    <light name='sun' type='directional'/>"
+    "  </world>"
+    "  <world name='w2'>"
+    "    <model name='c'>"
+    "      <link name='link'/>"
+    "    </model>"
+    "  </world>"
+    "</sdf>";
+
+  RecordingObserver observer;
+  sdf::ParserConfig config;
+  EXPECT_EQ(nullptr, config.Observer());
+  config.SetObserver(&observer);
+  EXPECT_EQ(&observer, config.Observer());
+
+  sdf::Root root;
+  EXPECT_TRUE(root.LoadSdfString(sdf, config).empty());
+  EXPECT_EQ(std::vector<std::string>({"w1/model a", "w1/model b",
+      "w1/light sun", "w2/model c"}), observer.names);
+  EXPECT_EQ(std::vector<ignition::math::Pose3d>({
+      ignition::math::Pose3d(1, 0, 0, 0, 0, 0),
+      ignition::math::Pose3d(0, 1, 1, 0, 0, 0),
+      ignition::math::Pose3d::Zero}), observer.poses);
+
+  // Models at the root have graphs of their own.
+  RecordingObserver modelObserver;
+  config.SetObserver(&modelObserver);
+  sdf::Root modelRoot;
+  EXPECT_TRUE(modelRoot.LoadSdfString("<?xml version=\"1.0\"?>"
+      "<sdf version=\"1.8\">"
+      "  <model name='m'>"
+      "    <link name='link'><pose>0 0 2 0 0 0</pose></link>"
+      "  </model>"
+      "</sdf>", config).empty());
+  EXPECT_EQ(std::vector<std::string>({"model m"}), modelObserver.names);
+  EXPECT_EQ(std::vector<ignition::math::Pose3d>({
+      ignition::math::Pose3d(0, 0, 2, 0, 0, 0)}), modelObserver.poses);
+}
+
+/////////////////////////////////////////////////
+/// \brief Observer that cancels the load once it is given a model.
+class CancellingObserver : public sdf::LoadObserver
+{
+  public: void ModelLoaded(const sdf::World *, const sdf::Model &) override
+  {
+    this->token.Cancel();
+  }
+
+  /// \brief Token of the load.
+  public: sdf::CancellationToken token;
+};
+
+/////////////////////////////////////////////////
+TEST(DOMRoot, Cancellation)
+{
+  const std::string sdf = "<?xml version=\"1.0\"?>"
+    "<sdf version=\"1.8\">"
+    "  <world name='w1'>"
+    "    <model name='a'>"
+    "      <link name='link'/>"
+    "    </model>"
+    "  </world>"
+    "  <world name='w2'>"
+    "    <model name='b'>"
+    "      <link name='link'/>"
+    "    </model>"
+    "  </world>"
+    "</sdf>";
+
+  auto hasError = [](const sdf::Errors &_errors, sdf::ErrorCode _code)
+  {
+    std::size_t count = 0;
+    for (const sdf::Error &error : _errors)
+      count += error.Code() == _code;
+    return count == 1u;
+  };
+
+  // A cancelled token stops the load before it reads the document.
+  sdf::CancellationToken token;
+  token.Cancel();
+  sdf::ParserConfig config;
+  config.SetCancellation(&token);
+  sdf::Root root;
+  sdf::Errors errors = root.LoadSdfString(sdf, config);
+  EXPECT_TRUE(hasError(errors, sdf::ErrorCode::LOAD_CANCELLED));
+  EXPECT_EQ(0u, root.WorldCount());
+
+  // Loads can use the token again once it is reset.
+  token.Reset();
+  sdf::Root resetRoot;
+  EXPECT_TRUE(resetRoot.LoadSdfString(sdf, config).empty());
+  EXPECT_EQ(2u, resetRoot.WorldCount());
+
+  // A load cancelled while it runs keeps what it loaded so far.
+  CancellingObserver observer;
+  sdf::ParserConfig observerConfig;
+  observerConfig.SetCancellation(&observer.token);
+  observerConfig.SetObserver(&observer);
+  sdf::Root partialRoot;
+  errors = partialRoot.LoadSdfString(sdf, observerConfig);
+  EXPECT_TRUE(hasError(errors, sdf::ErrorCode::LOAD_CANCELLED));
+  ASSERT_EQ(1u, partialRoot.WorldCount());
+  EXPECT_EQ("w1", partialRoot.WorldByIndex(0)->Name());
+
+  // A deadline that has passed stops the load with an error of its own,
+  // whether the document is read as a whole or streamed.
+  sdf::ParserConfig deadlineConfig;
+  deadlineConfig.SetDeadline(std::chrono::steady_clock::now());
+  for (bool streaming : {false, true})
+  {
+    deadlineConfig.SetStreamingRead(streaming);
+    sdf::Root deadlineRoot;
+    errors = deadlineRoot.LoadSdfString(sdf, deadlineConfig);
+    EXPECT_TRUE(hasError(errors, sdf::ErrorCode::LOAD_DEADLINE_EXCEEDED));
+    EXPECT_FALSE(hasError(errors, sdf::ErrorCode::LOAD_CANCELLED));
+    EXPECT_EQ(0u, deadlineRoot.WorldCount());
+  }
+
+  // A deadline in the future leaves the load alone.
+  deadlineConfig.SetDeadline(
+      std::chrono::steady_clock::now() + std::chrono::hours(1));
+  sdf::Root futureRoot;
+  EXPECT_TRUE(futureRoot.LoadSdfString(sdf, deadlineConfig).empty());
+  EXPECT_EQ(2u, futureRoot.WorldCount());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMRoot, Reparse)
+{
+  const std::string sdf =
+    "<sdf version='1.8'>\n"
+    "  <world name='default'>\n"
+    "    <model name='a'>\n"
+    "      <link name='l'>\n"
+    "        <pose>1 0 0 0 0 0</pose>\n"
+    "      </link>\n"
+    "    </model>\n"
+    "    <model name='b'>\n"
+    "      <link name='l'/>\n"
+    "    </model>\n"
+    "  </world>\n"
+    "</sdf>";
+
+  // Ranges are only recorded when they are asked for.
+  sdf::Root plainRoot;
+  ASSERT_TRUE(plainRoot.LoadSdfString(sdf).empty());
+  EXPECT_EQ(0u, plainRoot.WorldByIndex(0)->ModelByIndex(0)->Element()
+      ->SourceRange().beginLine);
+
+  sdf::ParserConfig config;
+  config.SetRecordSourceRanges(true);
+  sdf::Root root;
+  ASSERT_TRUE(root.LoadSdfString(sdf, config).empty());
+  const sdf::ElementPtr worldElem = root.WorldByIndex(0)->Element();
+  sdf::TextRange range =
+      root.WorldByIndex(0)->ModelByIndex(0)->Element()->SourceRange();
+  EXPECT_EQ(sdf.find("<model name='a'>"), range.begin);
+  EXPECT_EQ(sdf.find("</model>") + 8, range.end);
+  EXPECT_EQ(3u, range.beginLine);
+  EXPECT_EQ(5u, range.beginColumn);
+  EXPECT_EQ(7u, range.endLine);
+  EXPECT_EQ(13u, range.endColumn);
+
+  // An edit of a pose reads the pose again, and loads its model again.
+  std::string text = sdf;
+  sdf::TextEdit edit;
+  edit.begin = text.find("1 0 0");
+  edit.oldEnd = edit.begin + 1;
+  edit.newEnd = edit.begin + 3;
+  text.replace(edit.begin, 1, "2.5");
+  EXPECT_TRUE(root.Reparse(text, edit).empty());
+  ASSERT_EQ(worldElem, root.WorldByIndex(0)->Element());
+  const sdf::Model *model = root.WorldByIndex(0)->ModelByName("a");
+  ASSERT_NE(nullptr, model);
+  EXPECT_EQ(ignition::math::Pose3d(2.5, 0, 0, 0, 0, 0),
+      model->LinkByName("l")->RawPose());
+  range = model->LinkByName("l")->Element()->GetElement("pose")
+      ->SourceRange();
+  EXPECT_EQ(text.find("<pose>"), range.begin);
+  EXPECT_EQ(text.find("</pose>") + 7, range.end);
+  EXPECT_EQ(5u, range.endLine);
+  EXPECT_EQ(35u, range.endColumn);
+
+  // The elements after the edit are moved.
+  range = root.WorldByIndex(0)->ModelByName("b")->Element()->SourceRange();
+  EXPECT_EQ(text.find("<model name='b'>"), range.begin);
+  EXPECT_EQ(8u, range.beginLine);
+
+  // Lines added to a model move the lines of the elements after it.
+  const std::string link = "<link name='l'/>";
+  edit.begin = text.find(link);
+  edit.oldEnd = edit.begin + link.size();
+  const std::string links = link + "\n      <link name='m'/>";
+  edit.newEnd = edit.begin + links.size();
+  text.replace(edit.begin, link.size(), links);
+  EXPECT_TRUE(root.Reparse(text, edit).empty());
+  ASSERT_EQ(worldElem, root.WorldByIndex(0)->Element());
+  EXPECT_EQ(2u, root.WorldByIndex(0)->ModelByName("b")->LinkCount());
+  range = worldElem->SourceRange();
+  EXPECT_EQ(text.find("</world>") + 8, range.end);
+  EXPECT_EQ(12u, range.endLine);
+
+  // An edit outside of the models reads the whole document again.
+  edit.begin = text.find("default");
+  edit.oldEnd = edit.begin + 7;
+  edit.newEnd = edit.begin + 5;
+  text.replace(edit.begin, 7, "other");
+  EXPECT_TRUE(root.Reparse(text, edit).empty());
+  EXPECT_NE(worldElem, root.WorldByIndex(0)->Element());
+  EXPECT_EQ("other", root.WorldByIndex(0)->Name());
+  EXPECT_EQ(2u, root.WorldByIndex(0)->ModelByName("b")->LinkCount());
+  EXPECT_EQ(3u, root.WorldByIndex(0)->ModelByIndex(0)->Element()
+      ->SourceRange().beginLine);
+
+  // So does an edit that breaks the element it is in, which is reported.
+  edit.begin = text.find("<pose>") + 1;
+  edit.oldEnd = edit.begin + 4;
+  edit.newEnd = edit.begin + 4;
+  text.replace(edit.begin, 4, "bad>");
+  EXPECT_FALSE(root.Reparse(text, edit).empty());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMRoot, LoadStats)
+{
+  const std::string sdf = "<?xml version=\"1.0\"?>"
+    "<sdf version=\"1.7\">"
+    "  <world name='default'>"
+    "    <model name='model'>"
+    "      <link name='link'/>"
+    "      <frame name='frame' attached_to='link'/>"
+    "    </model>"
+    "  </world>"
+    "</sdf>";
+
+  // Statistics are only collected when requested.
+  sdf::LoadStats stats;
+  sdf::Root root;
+  EXPECT_TRUE(root.LoadSdfString(sdf).empty());
+  EXPECT_EQ(0u, stats.Count(sdf::LoadPhase::DOM_LOAD));
+
+  sdf::ParserConfig config;
+  config.SetStats(&stats);
+  EXPECT_EQ(&stats, config.Stats());
+
+  sdf::Root statsRoot;
+  EXPECT_TRUE(statsRoot.LoadSdfString(sdf, config).empty());
+  EXPECT_EQ(1u, stats.Count(sdf::LoadPhase::XML_PARSE));
+  EXPECT_EQ(1u, stats.Count(sdf::LoadPhase::CONVERSION));
+  EXPECT_EQ(1u, stats.Count(sdf::LoadPhase::DOM_LOAD));
+  EXPECT_EQ(0u, stats.Count(sdf::LoadPhase::INCLUDE));
+  EXPECT_EQ(0u, stats.Count(sdf::LoadPhase::URDF_CONVERSION));
+  EXPECT_LT(1u, stats.Count(sdf::LoadPhase::READ_XML));
+  EXPECT_LT(0u, stats.Count(sdf::LoadPhase::FRAME_GRAPH_BUILD));
+  EXPECT_LT(0u, stats.Count(sdf::LoadPhase::FRAME_GRAPH_VALIDATE));
+  EXPECT_LT(std::chrono::nanoseconds::zero(),
+            stats.Duration(sdf::LoadPhase::DOM_LOAD));
+}
+
+/////////////////////////////////////////////////
+TEST(DOMRoot, LoadCacheGraphs)
+{
+  const std::string dir = sdf::filesystem::append(
+      sdf::filesystem::current_path(), "root_load_cache");
+  const std::string cacheDir = sdf::filesystem::append(dir, "cache");
+  sdf::filesystem::create_directory(dir);
+  sdf::filesystem::create_directory(cacheDir);
+  sdf::filesystem::DirIter endIter;
+  for (sdf::filesystem::DirIter entry(cacheDir); entry != endIter; ++entry)
+    std::remove((*entry).c_str());
+
+  const std::string path = sdf::filesystem::append(dir, "world.sdf");
+  {
+    std::ofstream output(path);
+    output << "<sdf version='1.8'><world name='default'>"
+      "<frame name='wf'><pose>0 1 0 0 0 0</pose></frame>"
+      "<model name='m'>"
+      "  <pose relative_to='wf'>1 0 0 0 0 0</pose>"
+      "  <link name='link'><pose>0 0 1 0 0 0</pose></link>"
+      "  <frame name='f' attached_to='link'/>"
+      "  <model name='nested'>"
+      "    <pose>2 0 0 0 0 0</pose>"
+      "    <link name='link'/>"
+      "  </model>"
+      "</model>"
+      "</world>"
+      "<model name='top'><pose>0 0 5 0 0 0</pose>"
+      "<link name='link'><pose>1 0 0 0 0 0</pose></link></model>"
+      "</sdf>";
+  }
+
+  sdf::LoadStats stats;
+  sdf::ParserConfig config;
+  config.SetLoadCachePath(cacheDir);
+  config.SetStats(&stats);
+
+  auto check = [](const sdf::Root &_root)
+  {
+    const sdf::World *world = _root.WorldByIndex(0);
+    ASSERT_NE(nullptr, world);
+    const sdf::Model *model = world->ModelByName("m");
+    ASSERT_NE(nullptr, model);
+    ignition::math::Pose3d pose;
+    EXPECT_TRUE(model->LinkByName("link")->SemanticPose().Resolve(
+        pose, "world").empty());
+    EXPECT_EQ(ignition::math::Pose3d(1, 1, 1, 0, 0, 0), pose);
+    EXPECT_TRUE(model->ModelByName("nested")->LinkByName("link")
+        ->SemanticPose().Resolve(pose, "__model__").empty());
+    EXPECT_EQ(ignition::math::Pose3d::Zero, pose);
+    EXPECT_TRUE(model->ModelByName("nested")->SemanticPose().Resolve(
+        pose, "world").empty());
+    EXPECT_EQ(ignition::math::Pose3d(3, 1, 0, 0, 0, 0), pose);
+    std::string body;
+    EXPECT_TRUE(model->FrameByName("f")->ResolveAttachedToBody(body).empty());
+    EXPECT_EQ("link", body);
+
+    const sdf::Model *top = _root.ModelByIndex(0);
+    ASSERT_NE(nullptr, top);
+    EXPECT_TRUE(top->LinkByName("link")->SemanticPose().Resolve(
+        pose, "__model__").empty());
+    EXPECT_EQ(ignition::math::Pose3d(1, 0, 0, 0, 0, 0), pose);
+  };
+
+  // The first load builds and validates the graphs, and stores them.
+  sdf::Root parsed;
+  EXPECT_TRUE(parsed.Load(path, config).empty());
+  EXPECT_LT(0u, stats.Count(sdf::LoadPhase::FRAME_GRAPH_BUILD));
+  EXPECT_LT(0u, stats.Count(sdf::LoadPhase::FRAME_GRAPH_VALIDATE));
+  check(parsed);
+
+  // The second load maps them back in.
+  stats.Reset();
+  sdf::Root cached;
+  EXPECT_TRUE(cached.Load(path, config).empty());
+  EXPECT_EQ(0u, stats.Count(sdf::LoadPhase::XML_PARSE));
+  EXPECT_EQ(0u, stats.Count(sdf::LoadPhase::FRAME_GRAPH_BUILD));
+  EXPECT_EQ(0u, stats.Count(sdf::LoadPhase::FRAME_GRAPH_VALIDATE));
+  check(cached);
+
+  // Lazy models build their graphs.
+  stats.Reset();
+  config.SetLazyModels(true);
+  sdf::Root lazy;
+  EXPECT_TRUE(lazy.Load(path, config).empty());
+  check(lazy);
+  EXPECT_LT(0u, stats.Count(sdf::LoadPhase::FRAME_GRAPH_BUILD));
+
+  EXPECT_EQ(0, std::remove(path.c_str()));
+}
+
+/////////////////////////////////////////////////
+TEST(DOMRoot, LoadStatsDomProfile)
+{
+  const std::string sdf = "<?xml version=\"1.0\"?>"
+    "<sdf version=\"1.8\">"
+    "  <world name='default'>"
+    "    <model name='outer'>"
+    "      <link name='a'/>"
+    "      <link name='b'>"
+    "        <visual name='v'>"
+    "          <geometry><box><size>1 1 1</size></box></geometry>"
+    "        </visual>"
+    "      </link>"
+    "      <model name='inner'>"
+    "        <link name='c'/>"
+    "      </model>"
+    "    </model>"
+    "  </world>"
+    "</sdf>";
+
+  // The DOM profile is only collected when enabled.
+  sdf::LoadStats stats;
+  sdf::ParserConfig config;
+  config.SetStats(&stats);
+  config.SetLoadThreadCount(1u);
+  EXPECT_FALSE(stats.DomProfiling());
+
+  sdf::Root root;
+  EXPECT_TRUE(root.LoadSdfString(sdf, config).empty());
+  EXPECT_EQ(1u, stats.Count(sdf::LoadPhase::DOM_LOAD));
+  EXPECT_TRUE(stats.DomProfile().empty());
+
+  stats.Reset();
+  stats.SetDomProfiling(true);
+  sdf::Root profiledRoot;
+  EXPECT_TRUE(profiledRoot.LoadSdfString(sdf, config).empty());
+
+  std::map<std::string, sdf::DomLoadProfile> profiles;
+  for (const sdf::DomLoadProfile &profile : stats.DomProfile())
+  {
+    EXPECT_LE(profile.self, profile.total) << profile.className;
+    profiles[profile.className] = profile;
+  }
+  EXPECT_EQ(1u, profiles["World"].count);
+  EXPECT_EQ(2u, profiles["Model"].count);
+  EXPECT_EQ(3u, profiles["Link"].count);
+  EXPECT_EQ(1u, profiles["Visual"].count);
+  EXPECT_EQ(1u, profiles["Geometry"].count);
+  EXPECT_EQ(1u, profiles["Box"].count);
+
+  // The world contains every other object, which are loaded on the same
+  // thread, so its total time is the largest, and it is larger than its
+  // self time.
+  for (const auto &[className, profile] : profiles)
+    EXPECT_LE(profile.total, profiles["World"].total) << className;
+  EXPECT_LT(profiles["World"].self, profiles["World"].total);
+}
+
+/////////////////////////////////////////////////
+TEST(DOMRoot, ShareMeshes)
+{
+  auto meshLink = [](const std::string &_scale)
+  {
+    const std::string geometry = "<geometry><mesh>"
+      "<uri>model://box/meshes/box.dae</uri><scale>" + _scale + "</scale>"
+      "</mesh></geometry>";
+    return "<link name='l'><visual name='v'>" + geometry + "</visual>"
+      "<collision name='c'>" + geometry + "</collision></link>";
+  };
+
+  std::string sdfString = "<sdf version='1.8'><world name='a'>";
+  for (int i = 0; i < 3; ++i)
+  {
+    sdfString += "<model name='m" + std::to_string(i) + "'>" +
+      meshLink("1 1 1") + "</model>";
+  }
+  sdfString += "<model name='big'>" + meshLink("2 2 2") + "</model>"
+    "</world><world name='b'><model name='m0'>" + meshLink("1 1 1") +
+    "</model></world></sdf>";
+
+  // Without the option, each geometry has its own mesh.
+  sdf::Root root;
+  sdf::Errors errors = root.LoadSdfString(sdfString);
+  EXPECT_TRUE(errors.empty()) << errors;
+  EXPECT_EQ(0u, root.MeshCount());
+  EXPECT_EQ(nullptr, root.MeshByIndex(0));
+  EXPECT_EQ(0u, root.MeshReferenceCount(0));
+  const sdf::Link *link = root.WorldByIndex(0)->ModelByIndex(0)->LinkByIndex(0);
+  EXPECT_NE(link->VisualByIndex(0)->Geom()->MeshShape(),
+      link->CollisionByIndex(0)->Geom()->MeshShape());
+
+  sdf::ParserConfig config;
+  config.SetShareMeshes(true);
+  sdf::Root sharedRoot;
+  errors = sharedRoot.LoadSdfString(sdfString, config);
+  EXPECT_TRUE(errors.empty()) << errors;
+  ASSERT_EQ(2u, sharedRoot.MeshCount());
+  EXPECT_EQ(nullptr, sharedRoot.MeshByIndex(2));
+
+  const sdf::Mesh *mesh = sharedRoot.MeshByIndex(0);
+  ASSERT_NE(nullptr, mesh);
+  EXPECT_EQ("model://box/meshes/box.dae", mesh->Uri());
+  EXPECT_EQ(ignition::math::Vector3d::One, mesh->Scale());
+  const sdf::Mesh *bigMesh = sharedRoot.MeshByIndex(1);
+  ASSERT_NE(nullptr, bigMesh);
+  EXPECT_EQ(ignition::math::Vector3d(2, 2, 2), bigMesh->Scale());
+
+  // The visuals and collisions of both worlds share the mesh.
+  EXPECT_EQ(8u, sharedRoot.MeshReferenceCount(0));
+  EXPECT_EQ(2u, sharedRoot.MeshReferenceCount(1));
+  for (uint64_t w = 0; w < sharedRoot.WorldCount(); ++w)
+  {
+    const sdf::World *world = sharedRoot.WorldByIndex(w);
+    for (uint64_t m = 0; m < world->ModelCount(); ++m)
+    {
+      const sdf::Model *model = world->ModelByIndex(m);
+      link = model->LinkByIndex(0);
+      const sdf::Mesh *expected = model->Name() == "big" ? bigMesh : mesh;
+      EXPECT_EQ(expected, link->VisualByIndex(0)->Geom()->MeshShape());
+      EXPECT_EQ(expected, link->CollisionByIndex(0)->Geom()->MeshShape());
+    }
+  }
+
+  // Copies of geometries hold the mesh too.
+  {
+    sdf::Geometry copy(*link->VisualByIndex(0)->Geom());
+    EXPECT_EQ(mesh, copy.MeshShape());
+    EXPECT_EQ(9u, sharedRoot.MeshReferenceCount(0));
+    copy.SetMeshShape(*mesh);
+    EXPECT_NE(mesh, copy.MeshShape());
+    EXPECT_EQ(8u, sharedRoot.MeshReferenceCount(0));
+  }
+  EXPECT_EQ(8u, sharedRoot.MeshReferenceCount(0));
+}
+
 /////////////////////////////////////////////////
 TEST(DOMRoot, Set)
 {
@@ -251,3 +1361,327 @@ TEST(DOMRoot, FrameSemanticsOnMove)
     testFrame1(root2);
   }
 }
+
+/////////////////////////////////////////////////
+TEST(DOMRoot, Spans)
+{
+  const std::string sdfString = R"(
+  <sdf version="1.8">
+    <world name="default">
+      <frame name="world_frame"/>
+      <light name="sun" type="directional"/>
+      <model name="a">
+        <link name="l0">
+          <visual name="v0"><geometry><sphere/></geometry></visual>
+          <visual name="v1"><geometry><sphere/></geometry></visual>
+          <collision name="c0"><geometry><sphere/></geometry></collision>
+        </link>
+        <link name="l1"/>
+        <joint name="j" type="fixed">
+          <parent>l0</parent>
+          <child>l1</child>
+        </joint>
+        <frame name="model_frame"/>
+        <model name="nested">
+          <link name="l"/>
+        </model>
+      </model>
+      <model name="b">
+        <link name="l"/>
+      </model>
+    </world>
+  </sdf>)";
+
+  sdf::Root root;
+  ASSERT_TRUE(root.LoadSdfString(sdfString).empty());
+  ASSERT_EQ(1u, root.Worlds().Size());
+  EXPECT_EQ(root.WorldByIndex(0), root.Worlds().Data());
+
+  const sdf::World &world = root.Worlds()[0];
+  EXPECT_EQ(1u, world.Frames().Size());
+  EXPECT_EQ(1u, world.Lights().Size());
+  EXPECT_TRUE(world.Actors().Empty());
+  EXPECT_EQ(world.PhysicsCount(), world.PhysicsProfiles().Size());
+
+  std::vector<std::string> names;
+  for (const sdf::Model &model : world.Models())
+    names.push_back(model.Name());
+  EXPECT_EQ(std::vector<std::string>({"a", "b"}), names);
+
+  const sdf::Model &model = world.Models()[0];
+  ASSERT_EQ(2u, model.Links().Size());
+  EXPECT_EQ(model.LinkByIndex(1), &model.Links()[1]);
+  EXPECT_EQ(1u, model.Joints().Size());
+  EXPECT_EQ("model_frame", model.Frames()[0].Name());
+  ASSERT_EQ(1u, model.Models().Size());
+  EXPECT_EQ("nested", model.Models()[0].Name());
+
+  const sdf::Link &link = model.Links()[0];
+  names.clear();
+  for (const sdf::Visual &visual : link.Visuals())
+    names.push_back(visual.Name());
+  EXPECT_EQ(std::vector<std::string>({"v0", "v1"}), names);
+  EXPECT_EQ(1u, link.Collisions().Size());
+  EXPECT_TRUE(link.Lights().Empty());
+  EXPECT_TRUE(link.Sensors().Empty());
+  EXPECT_TRUE(model.Links()[1].Visuals().Empty());
+  EXPECT_TRUE(sdf::Link().Visuals().Empty());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMRoot, BinaryBuffer)
+{
+  const std::string sdfString = R"(
+  <sdf version="1.8">
+    <world name="default">
+      <gravity>0 0 -9.5</gravity>
+      <model name="box">
+        <pose>1 2 3 0 0 0</pose>
+        <link name="link">
+          <inertial><mass>2.5</mass></inertial>
+          <visual name="visual">
+            <geometry><box><size>1 2 3</size></box></geometry>
+            <material><diffuse>1 0 0 1</diffuse></material>
+          </visual>
+        </link>
+      </model>
+    </world>
+  </sdf>)";
+
+  sdf::Root root;
+  ASSERT_TRUE(root.LoadSdfString(sdfString).empty());
+  std::ostringstream stream;
+  EXPECT_TRUE(root.WriteBinary(stream).empty());
+  const std::string binary = stream.str();
+  EXPECT_FALSE(binary.empty());
+
+  sdf::Root received;
+  sdf::Errors errors = received.LoadBinaryBuffer(binary.data(),
+      binary.size(), sdf::ParserConfig());
+  EXPECT_TRUE(errors.empty()) << errors;
+  ASSERT_EQ(1u, received.WorldCount());
+  const sdf::World *world = received.WorldByIndex(0);
+  EXPECT_EQ("default", world->Name());
+  EXPECT_EQ(ignition::math::Vector3d(0, 0, -9.5), world->Gravity());
+  ASSERT_EQ(1u, world->ModelCount());
+  const sdf::Model *model = world->ModelByIndex(0);
+  EXPECT_EQ(ignition::math::Pose3d(1, 2, 3, 0, 0, 0), model->RawPose());
+  const sdf::Link *link = model->LinkByIndex(0);
+  ASSERT_NE(nullptr, link);
+  EXPECT_DOUBLE_EQ(2.5, link->Inertial().MassMatrix().Mass());
+  ASSERT_NE(nullptr, link->VisualByIndex(0)->Material());
+  EXPECT_EQ(ignition::math::Color(1, 0, 0, 1),
+      link->VisualByIndex(0)->Material()->Diffuse());
+  EXPECT_EQ(root.Element()->ToString(""), received.Element()->ToString(""));
+
+  // The received DOM can be sent on.
+  std::ostringstream forwarded;
+  EXPECT_TRUE(received.WriteBinary(forwarded).empty());
+  EXPECT_EQ(binary, forwarded.str());
+
+  sdf::Root invalid;
+  errors = invalid.LoadBinaryBuffer(sdfString.data(), sdfString.size(),
+      sdf::ParserConfig());
+  EXPECT_FALSE(errors.empty());
+  EXPECT_EQ(0u, invalid.WorldCount());
+
+  // Without its elements, a Root can't be written.
+  sdf::ParserConfig config;
+  config.SetReleaseElements(true);
+  sdf::Root released;
+  ASSERT_TRUE(released.LoadSdfString(sdfString, config).empty());
+  errors = released.WriteBinary(stream);
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::ELEMENT_MISSING, errors[0].Code());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMRoot, BinaryBufferLimits)
+{
+  // Every model without a link is an error.
+  std::string sdf = "<?xml version=\"1.0\"?>"
+    "<sdf version=\"1.8\">"
+    "  <world name='default'>";
+  for (int i = 0; i < 20; ++i)
+    sdf += "<model name='model" + std::to_string(i) + "'/>";
+  sdf += "  </world>"
+    "</sdf>";
+
+  sdf::Root root;
+  EXPECT_LE(20u, root.LoadSdfString(sdf).size());
+  std::ostringstream stream;
+  EXPECT_TRUE(root.WriteBinary(stream).empty());
+  const std::string binary = stream.str();
+
+  // The errors of a binary snapshot are truncated like those of the text.
+  sdf::ParserConfig config;
+  config.SetMaxErrors(3);
+  sdf::Root limited;
+  sdf::Errors errors = limited.LoadBinaryBuffer(binary.data(),
+      binary.size(), config);
+  ASSERT_EQ(3u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::MODEL_WITHOUT_LINK, errors[0].Code());
+
+  // A cancelled token stops the load of a binary snapshot too.
+  sdf::CancellationToken token;
+  token.Cancel();
+  sdf::ParserConfig cancelConfig;
+  cancelConfig.SetCancellation(&token);
+  sdf::Root cancelled;
+  errors = cancelled.LoadBinaryBuffer(binary.data(), binary.size(),
+      cancelConfig);
+  std::size_t cancelCount = 0;
+  for (const sdf::Error &error : errors)
+    cancelCount += error.Code() == sdf::ErrorCode::LOAD_CANCELLED;
+  EXPECT_EQ(1u, cancelCount);
+  EXPECT_EQ(0u, cancelled.WorldCount());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMRoot, Merge)
+{
+  const std::string baseString = R"(
+  <sdf version="1.8">
+    <world name="default">
+      <frame name="spot">
+        <pose>5 0 0 0 0 0</pose>
+      </frame>
+      <model name="ground">
+        <static>true</static>
+        <link name="l"/>
+      </model>
+    </world>
+  </sdf>)";
+  const std::string propsString = R"(
+  <sdf version="1.8">
+    <world name="default">
+      <frame name="corner"/>
+      <model name="box">
+        <pose>0 1 0 0 0 0</pose>
+        <link name="l"/>
+      </model>
+      <model name="ground">
+        <link name="l"/>
+      </model>
+      <light name="sun" type="directional"/>
+    </world>
+  </sdf>)";
+  const std::string robotString = R"(
+  <sdf version="1.8">
+    <model name="robot">
+      <pose relative_to="spot">0 0 1 0 0 0</pose>
+      <link name="base">
+        <pose>1 0 0 0 0 0</pose>
+      </link>
+    </model>
+  </sdf>)";
+
+  sdf::Root base;
+  ASSERT_TRUE(base.LoadSdfString(baseString).empty());
+  sdf::Root props;
+  ASSERT_TRUE(props.LoadSdfString(propsString).empty());
+  sdf::Root robot;
+  ASSERT_TRUE(robot.LoadSdfString(robotString).empty());
+
+  // The duplicate ground and the frame are skipped.
+  sdf::Errors errors = base.Merge(props);
+  ASSERT_EQ(2u, errors.size()) << errors;
+  EXPECT_EQ(sdf::ErrorCode::ELEMENT_INVALID, errors[0].Code());
+  EXPECT_EQ(sdf::ErrorCode::DUPLICATE_NAME, errors[1].Code());
+
+  // The model at the root of the layer goes to the first world, and can
+  // be placed relative to its frames.
+  errors = base.Merge(robot);
+  EXPECT_TRUE(errors.empty()) << errors;
+
+  const sdf::World *world = base.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+  ASSERT_EQ(3u, world->ModelCount());
+  EXPECT_TRUE(world->ModelByName("ground")->Static());
+  EXPECT_EQ(1u, world->LightCount());
+  EXPECT_TRUE(world->LightNameExists("sun"));
+  EXPECT_FALSE(world->FrameNameExists("corner"));
+
+  ignition::math::Pose3d pose;
+  const sdf::Model *box = world->ModelByName("box");
+  ASSERT_NE(nullptr, box);
+  EXPECT_TRUE(box->SemanticPose().Resolve(pose, "world").empty());
+  EXPECT_EQ(ignition::math::Pose3d(0, 1, 0, 0, 0, 0), pose);
+
+  const sdf::Model *merged = world->ModelByName("robot");
+  ASSERT_NE(nullptr, merged);
+  EXPECT_TRUE(merged->SemanticPose().Resolve(pose, "world").empty());
+  EXPECT_EQ(ignition::math::Pose3d(5, 0, 1, 0, 0, 0), pose);
+  const sdf::Link *link = merged->LinkByName("base");
+  ASSERT_NE(nullptr, link);
+  EXPECT_TRUE(link->SemanticPose().Resolve(pose, "world").empty());
+  EXPECT_EQ(ignition::math::Pose3d(6, 0, 1, 0, 0, 0), pose);
+  EXPECT_NE(nullptr, world->LinkByScopedName("robot::base"));
+
+  // The layer is unchanged, and can be merged again.
+  const sdf::Link *layerLink = robot.ModelByIndex(0)->LinkByName("base");
+  EXPECT_NE(link, layerLink);
+  EXPECT_TRUE(layerLink->SemanticPose().Resolve(pose).empty());
+  EXPECT_EQ(ignition::math::Pose3d(1, 0, 0, 0, 0, 0), pose);
+  errors = base.Merge(robot);
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::DUPLICATE_NAME, errors[0].Code());
+
+  errors = base.Merge(props, "other");
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::ELEMENT_MISSING, errors[0].Code());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMRoot, LoadSdfFragment)
+{
+  sdf::ParserConfig config;
+  sdf::Root robot;
+  sdf::Errors errors = robot.LoadSdfFragment(R"(
+    <model name="robot">
+      <pose>1 0 0 0 0 0</pose>
+      <link name="base">
+        <pose>0 0 1 0 0 0</pose>
+      </link>
+    </model>)", config);
+  EXPECT_TRUE(errors.empty()) << errors;
+  EXPECT_EQ(SDF_PROTOCOL_VERSION, robot.Version());
+  ASSERT_EQ(1u, robot.ModelCount());
+  const sdf::Link *link = robot.ModelByIndex(0)->LinkByName("base");
+  ASSERT_NE(nullptr, link);
+  ignition::math::Pose3d pose;
+  EXPECT_TRUE(link->SemanticPose().Resolve(pose).empty());
+  EXPECT_EQ(ignition::math::Pose3d(0, 0, 1, 0, 0, 0), pose);
+
+  sdf::Root lamp;
+  EXPECT_TRUE(lamp.LoadSdfFragment(
+      "<light name='lamp' type='point'/>", config).empty());
+  ASSERT_EQ(1u, lamp.LightCount());
+  EXPECT_EQ("lamp", lamp.LightByIndex(0)->Name());
+
+  sdf::Root walker;
+  EXPECT_TRUE(walker.LoadSdfFragment(
+      "<actor name='walker'/>", config).empty());
+  EXPECT_EQ(1u, walker.ActorCount());
+
+  // The fragments are ready to be added to a world.
+  sdf::Root world;
+  ASSERT_TRUE(world.LoadSdfString(
+      "<sdf version='1.8'><world name='default'/></sdf>").empty());
+  EXPECT_TRUE(world.Merge(robot).empty());
+  EXPECT_TRUE(world.Merge(lamp).empty());
+  EXPECT_TRUE(world.WorldByIndex(0)->ModelNameExists("robot"));
+  EXPECT_TRUE(world.WorldByIndex(0)->LightNameExists("lamp"));
+
+  // Only single objects, without <sdf>.
+  sdf::Root invalid;
+  errors = invalid.LoadSdfFragment(
+      "<sdf version='1.8'><model name='m'/></sdf>", config);
+  ASSERT_FALSE(errors.empty());
+  EXPECT_EQ(sdf::ErrorCode::ELEMENT_INVALID, errors[0].Code());
+  EXPECT_EQ(0u, invalid.ModelCount());
+
+  errors = invalid.LoadSdfFragment("<model name='m'", config);
+  ASSERT_FALSE(errors.empty());
+  EXPECT_EQ(sdf::ErrorCode::STRING_READ, errors[0].Code());
+}
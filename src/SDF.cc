@@ -15,34 +15,71 @@
  *
  */
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
 #include <cstdlib>
 #include <fstream>
 #include <sstream>
 #include <functional>
-#include <list>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "sdf/parser.hh"
 #include "sdf/Assert.hh"
 #include "sdf/Console.hh"
 #include "sdf/Filesystem.hh"
+#include "sdf/ParserConfig.hh"
 #include "sdf/SDFImpl.hh"
+#include "BinarySnapshot.hh"
 #include "SDFImplPrivate.hh"
 #include "sdf/sdf_config.h"
 #include "EmbeddedSdf.hh"
+#include "FindFileSettings.hh"
+#include "IncludeCache.hh"
+#include "Tracing.hh"
 
 namespace sdf
 {
 inline namespace SDF_VERSION_NAMESPACE
 {
-typedef std::list<std::string> PathList;
-typedef std::map<std::string, PathList> URIPathMap;
+/// \brief URI paths and find callback set with addURIPath and
+/// setFindCallback, and the findFile results memoized for loads that don't
+/// have settings of their own.
+static FindFileSettings &globalSettings()
+{
+  static FindFileSettings settings;
+  return settings;
+}
+
+/// \brief Protects the URI paths and find callback of globalSettings. The
+/// memoized results are protected by their own mutex.
+static std::shared_mutex g_globalSettingsMutex;
 
-static URIPathMap g_uriPathMap;
+/// \brief Incremented whenever the global settings change or the memoized
+/// results are cleared, which invalidates the results memoized by the
+/// settings of parser configurations.
+static std::atomic<uint64_t> g_findFileGeneration{0};
 
-static std::function<std::string(const std::string &)> g_findFileCB;
+/// \brief True to memoize findFile results.
+static std::atomic<bool> g_findFileCacheEnabled{true};
+
+/// \brief Number of findFile calls answered from memoized results.
+static std::atomic<uint64_t> g_findFileCacheHits{0};
+
+/// \brief Number of findFile calls that had to search for the file.
+static std::atomic<uint64_t> g_findFileCacheMisses{0};
 
 std::string SDF::version = SDF_VERSION;
 
@@ -50,21 +87,54 @@ std::string SDF::version = SDF_VERSION;
 // cppcheck-suppress passedByValue
 void setFindCallback(std::function<std::string(const std::string &)> _cb)
 {
-  g_findFileCB = _cb;
+  {
+    std::unique_lock<std::shared_mutex> lock(g_globalSettingsMutex);
+    globalSettings().findCallback = _cb;
+  }
+
+  // Files and included files may resolve differently now.
+  clearFindFileCache();
+  IncludeCache::Instance().Clear();
 }
 
 /////////////////////////////////////////////////
-std::string findFile(const std::string &_filename, bool _searchLocalPath,
-                          bool _useCallback)
+/// \brief Read the SDF_PATH environment variable.
+/// \return The value of SDF_PATH, or an empty string if it is not set.
+static std::string sdfPathEnv()
 {
-  std::string path = _filename;
+  std::string result;
+#ifndef _WIN32
+  const char *pathCStr = std::getenv("SDF_PATH");
+  if (pathCStr)
+    result = pathCStr;
+#else
+  char *pathCStr;
+  size_t sz = 0;
+  _dupenv_s(&pathCStr, &sz, "SDF_PATH");
+  if (pathCStr)
+  {
+    result = pathCStr;
+    free(pathCStr);
+  }
+#endif
+  return result;
+}
 
-  // Check to see if _filename is URI. If so, resolve the URI path.
-  for (URIPathMap::iterator iter = g_uriPathMap.begin();
-       iter != g_uriPathMap.end(); ++iter)
+/////////////////////////////////////////////////
+/// \brief Search for a file in the paths associated to URIs.
+/// \param[in] _filename Name of the file to find.
+/// \param[in] _uriPathMap Paths associated with each URI.
+/// \param[in] _filesystem Filesystem to search in.
+/// \return Full path of the file, or an empty string if it is not in the
+/// paths of a URI it starts with.
+static std::string findURIFile(const std::string &_filename,
+    const FindFileSettings::URIPathMap &_uriPathMap,
+    const VirtualFilesystem &_filesystem)
+{
+  for (auto iter = _uriPathMap.begin(); iter != _uriPathMap.end(); ++iter)
   {
-    // Check to see if the URI in the global map is the first part of the
-    // given filename
+    // Check to see if the URI in the map is the first part of the given
+    // filename
     // cppcheck-suppress stlIfStrFind
     if (_filename.find(iter->first) == 0)
     {
@@ -76,18 +146,48 @@ std::string findFile(const std::string &_filename, bool _searchLocalPath,
       }
 
       // Check each path in the list.
-      for (PathList::iterator pathIter = iter->second.begin();
+      for (auto pathIter = iter->second.begin();
            pathIter != iter->second.end(); ++pathIter)
       {
         // Return the path string if the path + suffix exists.
         std::string pathSuffix = sdf::filesystem::append(*pathIter, suffix);
-        if (sdf::filesystem::exists(pathSuffix))
+        if (_filesystem.Exists(pathSuffix))
         {
           return pathSuffix;
         }
       }
     }
   }
+  return std::string();
+}
+
+/////////////////////////////////////////////////
+/// \brief Search for a file without consulting the findFile cache.
+/// \param[in] _settings Settings of the parser configuration, or nullptr
+/// to only use the global settings.
+/// \sa findFile
+static std::string findFileUncached(const std::string &_filename,
+    bool _searchLocalPath, bool _useCallback,
+    const FindFileSettings *_settings)
+{
+  std::string path = _filename;
+  const VirtualFilesystem &fs = FindFileSettings::FilesystemOf(_settings);
+
+  // Check to see if _filename is URI. If so, resolve the URI path, first
+  // with the paths of the configuration.
+  if (_settings)
+  {
+    path = findURIFile(_filename, _settings->uriPathMap, fs);
+    if (!path.empty())
+      return path;
+  }
+
+  {
+    std::shared_lock<std::shared_mutex> lock(g_globalSettingsMutex);
+    path = findURIFile(_filename, globalSettings().uriPathMap, fs);
+    if (!path.empty())
+      return path;
+  }
 
   // Strip scheme, if any
   std::string filename = _filename;
@@ -100,7 +200,7 @@ std::string findFile(const std::string &_filename, bool _searchLocalPath,
 
   // Next check the install path.
   path = sdf::filesystem::append(SDF_SHARE_PATH, filename);
-  if (sdf::filesystem::exists(path))
+  if (fs.Exists(path))
   {
     return path;
   }
@@ -109,35 +209,28 @@ std::string findFile(const std::string &_filename, bool _searchLocalPath,
   path = sdf::filesystem::append(SDF_SHARE_PATH,
                                  "sdformat" SDF_MAJOR_VERSION_STR,
                                  sdf::SDF::Version(), filename);
-  if (sdf::filesystem::exists(path))
+  if (fs.Exists(path))
   {
     return path;
   }
 
   // Next check to see if the given file exists.
   path = filename;
-  if (sdf::filesystem::exists(path))
+  if (fs.Exists(path))
   {
     return path;
   }
 
   // Next check SDF_PATH environment variable
-#ifndef _WIN32
-  const char *pathCStr = std::getenv("SDF_PATH");
-#else
-  char *pathCStr;
-  size_t sz = 0;
-  _dupenv_s(&pathCStr, &sz, "SDF_PATH");
-#endif
-
-  if (pathCStr)
+  const std::string pathEnv = sdfPathEnv();
+  if (!pathEnv.empty())
   {
-    std::vector<std::string> paths = sdf::split(pathCStr, ":");
+    std::vector<std::string> paths = sdf::split(pathEnv, ":");
     for (std::vector<std::string>::iterator iter = paths.begin();
          iter != paths.end(); ++iter)
     {
       path = sdf::filesystem::append(*iter, filename);
-      if (sdf::filesystem::exists(path))
+      if (fs.Exists(path))
       {
         return path;
       }
@@ -148,7 +241,7 @@ std::string findFile(const std::string &_filename, bool _searchLocalPath,
   if (_searchLocalPath)
   {
     path = sdf::filesystem::append(sdf::filesystem::current_path(), filename);
-    if (sdf::filesystem::exists(path))
+    if (fs.Exists(path))
     {
       return path;
     }
@@ -158,7 +251,19 @@ std::string findFile(const std::string &_filename, bool _searchLocalPath,
   // flag has been set
   if (_useCallback)
   {
-    if (!g_findFileCB)
+    std::function<std::string(const std::string &)> findCallback;
+    if (_settings && _settings->findCallback)
+    {
+      findCallback = _settings->findCallback;
+    }
+    else
+    {
+      // Copy the callback, so that it runs without the lock.
+      std::shared_lock<std::shared_mutex> lock(g_globalSettingsMutex);
+      findCallback = globalSettings().findCallback;
+    }
+
+    if (!findCallback)
     {
       sdferr << "Tried to use callback in sdf::findFile(), but the callback "
         "is empty.  Did you call sdf::setFindCallback()?";
@@ -166,7 +271,7 @@ std::string findFile(const std::string &_filename, bool _searchLocalPath,
     }
     else
     {
-      return g_findFileCB(_filename);
+      return findCallback(_filename);
     }
   }
 
@@ -174,23 +279,152 @@ std::string findFile(const std::string &_filename, bool _searchLocalPath,
 }
 
 /////////////////////////////////////////////////
-void addURIPath(const std::string &_uri, const std::string &_path)
+/// \brief Search for a file, or get the memoized result of a previous
+/// search.
+/// \param[in] _settings Settings of the parser configuration, or nullptr
+/// to only use the global settings.
+/// \sa findFile
+static std::string findFileMemoized(const std::string &_filename,
+    bool _searchLocalPath, bool _useCallback,
+    const std::shared_ptr<FindFileSettings> &_settings)
+{
+  if (!g_findFileCacheEnabled)
+  {
+    return findFileUncached(_filename, _searchLocalPath, _useCallback,
+        _settings.get());
+  }
+
+  // Results that depend on the settings of the configuration are memoized
+  // with them, the others globally.
+  FindFileSettings &memo = _settings ? *_settings : globalSettings();
+  FindFileSettings::Key key(_filename, _searchLocalPath, _useCallback,
+      SDF::Version(), sdf::filesystem::current_path(), sdfPathEnv());
+  {
+    std::lock_guard<std::mutex> lock(memo.resultsMutex);
+    if (memo.generation != g_findFileGeneration)
+    {
+      memo.results.clear();
+      memo.generation = g_findFileGeneration;
+    }
+
+    auto iter = memo.results.find(key);
+    if (iter != memo.results.end())
+    {
+      ++g_findFileCacheHits;
+      return iter->second;
+    }
+  }
+
+  // Search without the lock, so that concurrent lookups and the find
+  // callback don't serialize.
+  ++g_findFileCacheMisses;
+  const uint64_t generation = g_findFileGeneration;
+  std::string path = findFileUncached(_filename, _searchLocalPath,
+      _useCallback, _settings.get());
+
+  // Don't memoize a result that may predate a change of the settings.
+  std::lock_guard<std::mutex> lock(memo.resultsMutex);
+  if (memo.generation == generation)
+    memo.results.emplace(std::move(key), path);
+  return path;
+}
+
+/////////////////////////////////////////////////
+std::string findFile(const std::string &_filename, bool _searchLocalPath,
+                          bool _useCallback)
+{
+  SDF_TRACE_SCOPE_TEXT("sdf::findFile", _filename);
+  return findFileMemoized(_filename, _searchLocalPath, _useCallback, nullptr);
+}
+
+/////////////////////////////////////////////////
+std::string findFile(const std::string &_filename, bool _searchLocalPath,
+    bool _useCallback, const ParserConfig &_config)
+{
+  SDF_TRACE_SCOPE_TEXT("sdf::findFile", _filename);
+  return findFileMemoized(_filename, _searchLocalPath, _useCallback,
+      FindFileSettings::Of(_config));
+}
+
+/////////////////////////////////////////////////
+void clearFindFileCache()
+{
+  ++g_findFileGeneration;
+  {
+    FindFileSettings &memo = globalSettings();
+    std::lock_guard<std::mutex> lock(memo.resultsMutex);
+    memo.results.clear();
+    memo.generation = g_findFileGeneration;
+  }
+  g_findFileCacheHits = 0;
+  g_findFileCacheMisses = 0;
+}
+
+/////////////////////////////////////////////////
+void setFindFileCacheEnabled(bool _enabled)
+{
+  g_findFileCacheEnabled = _enabled;
+  if (!_enabled)
+  {
+    ++g_findFileGeneration;
+    FindFileSettings &memo = globalSettings();
+    std::lock_guard<std::mutex> lock(memo.resultsMutex);
+    memo.results.clear();
+    memo.generation = g_findFileGeneration;
+  }
+}
+
+/////////////////////////////////////////////////
+bool findFileCacheEnabled()
+{
+  return g_findFileCacheEnabled;
+}
+
+/////////////////////////////////////////////////
+uint64_t findFileCacheHits()
+{
+  return g_findFileCacheHits;
+}
+
+/////////////////////////////////////////////////
+uint64_t findFileCacheMisses()
+{
+  return g_findFileCacheMisses;
+}
+
+/////////////////////////////////////////////////
+void FindFileSettings::AddURIPath(URIPathMap &_map, const std::string &_uri,
+    const std::string &_path, const VirtualFilesystem &_filesystem)
 {
   // Split _path on colons.
   std::vector<std::string> parts = sdf::split(_path, ":");
 
-  // Add each part of the colon separated path to the global URI map.
+  // Add each part of the colon separated path to the URI map.
   for (std::vector<std::string>::iterator iter = parts.begin();
        iter != parts.end(); ++iter)
   {
     // Only add valid paths
-    if (!(*iter).empty() && sdf::filesystem::is_directory(*iter))
+    if (!(*iter).empty() && _filesystem.IsDirectory(*iter))
     {
-      g_uriPathMap[_uri].push_back(*iter);
+      _map[_uri].push_back(*iter);
     }
   }
 }
 
+/////////////////////////////////////////////////
+void addURIPath(const std::string &_uri, const std::string &_path)
+{
+  {
+    std::unique_lock<std::shared_mutex> lock(g_globalSettingsMutex);
+    FindFileSettings::AddURIPath(globalSettings().uriPathMap, _uri, _path,
+        VirtualFilesystem::Native());
+  }
+
+  // Files and included files may resolve differently now.
+  clearFindFileCache();
+  IncludeCache::Instance().Clear();
+}
+
 /////////////////////////////////////////////////
 SDF::SDF()
   : dataPtr(new SDFPrivate)
@@ -331,38 +565,141 @@ void SDF::PrintDoc()
 /////////////////////////////////////////////////
 void SDF::Write(const std::string &_filename)
 {
-  std::string string = this->Root()->ToString("");
-
-  std::ofstream out(_filename.c_str(), std::ios::out);
+  // Stream the document through a large buffer, so that writing big
+  // documents is bound by the disk rather than by building the string.
+  std::vector<char> buffer(1 << 16);
+  std::ofstream out;
+  out.rdbuf()->pubsetbuf(buffer.data(),
+      static_cast<std::streamsize>(buffer.size()));
+  out.open(_filename.c_str(), std::ios::out);
 
   if (!out)
   {
     sdferr << "Unable to open file[" << _filename << "] for writing\n";
     return;
   }
-  out << string;
+  this->Root()->ToStream(out);
+  out.close();
+}
+
+/////////////////////////////////////////////////
+/// \brief Write buffers to a file one after the other, with as few
+/// vectored writes as the system allows.
+/// \param[in] _filename Path of the file, which is replaced.
+/// \param[in] _buffers Buffers to write.
+/// \return False if the file can't be opened or written.
+static bool writeBuffers(const std::string &_filename,
+    const std::vector<std::string> &_buffers)
+{
+#ifndef _WIN32
+  const int fd = ::open(_filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC,
+      0644);
+  if (fd < 0)
+    return false;
+
+  std::vector<iovec> vectors;
+  vectors.reserve(_buffers.size());
+  for (const std::string &buffer : _buffers)
+  {
+    if (!buffer.empty())
+      vectors.push_back({const_cast<char *>(buffer.data()), buffer.size()});
+  }
+
+  const long maxVectors = std::max(16L, ::sysconf(_SC_IOV_MAX));
+  bool written = true;
+  std::size_t first = 0;
+  while (first < vectors.size())
+  {
+    const int count = static_cast<int>(std::min<std::size_t>(
+        vectors.size() - first, static_cast<std::size_t>(maxVectors)));
+    const ssize_t result = ::writev(fd, &vectors[first], count);
+    if (result < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      written = false;
+      break;
+    }
+
+    // Skip what was written, which can end in the middle of a buffer.
+    std::size_t remaining = static_cast<std::size_t>(result);
+    while (first < vectors.size() && remaining >= vectors[first].iov_len)
+      remaining -= vectors[first++].iov_len;
+    if (remaining > 0)
+    {
+      vectors[first].iov_base =
+          static_cast<char *>(vectors[first].iov_base) + remaining;
+      vectors[first].iov_len -= remaining;
+    }
+  }
+  return ::close(fd) == 0 && written;
+#else
+  std::ofstream out(_filename.c_str(), std::ios::out);
+  for (const std::string &buffer : _buffers)
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
   out.close();
+  return !out.fail();
+#endif
+}
+
+/////////////////////////////////////////////////
+void SDF::Write(const std::string &_filename, unsigned int _threadCount)
+{
+  if (!writeBuffers(_filename, this->Root()->ToBuffers(0, false,
+          _threadCount)))
+  {
+    sdferr << "Unable to write file[" << _filename << "]\n";
+  }
+}
+
+/////////////////////////////////////////////////
+bool SDF::WriteBinary(const std::string &_filename, Errors &_errors) const
+{
+  std::vector<char> buffer(1 << 16);
+  std::ofstream out;
+  out.rdbuf()->pubsetbuf(buffer.data(),
+      static_cast<std::streamsize>(buffer.size()));
+  out.open(_filename.c_str(), std::ios::out | std::ios::binary);
+
+  if (!out)
+  {
+    _errors.push_back({ErrorCode::FILE_READ,
+        "Unable to open file[" + _filename + "] for writing."});
+    return false;
+  }
+  return BinarySnapshot::Write(*this, out, _errors);
+}
+
+/////////////////////////////////////////////////
+bool SDF::WriteBinary(std::ostream &_out, Errors &_errors) const
+{
+  return BinarySnapshot::Write(*this, _out, _errors);
 }
 
 /////////////////////////////////////////////////
 std::string SDF::ToString() const
 {
   std::ostringstream stream;
+  this->ToStream(stream);
+  return stream.str();
+}
 
-  stream << "<?xml version='1.0'?>\n";
+/////////////////////////////////////////////////
+void SDF::ToStream(std::ostream &_out, bool _compact) const
+{
+  const char *newline = _compact ? "" : "\n";
+  _out << "<?xml version='1.0'?>" << newline;
   if (this->Root()->GetName() != "sdf")
   {
-    stream << "<sdf version='" << SDF::Version() << "'>\n";
+    _out << "<sdf version='" << SDF::Version() << "'>" << newline;
   }
 
-  stream << this->Root()->ToString("");
+  this->Root()->ToStream(_out, 0, _compact);
 
   if (this->Root()->GetName() != "sdf")
   {
-    stream << "</sdf>";
+    _out << "</sdf>";
   }
-
-  return stream.str();
 }
 
 /////////////////////////////////////////////////
@@ -449,19 +786,31 @@ ElementPtr SDF::WrapInRoot(const ElementPtr &_sdf)
 const std::string &SDF::EmbeddedSpec(
     const std::string &_filename, const bool _quiet)
 {
-  try
+  // The embedded files are kept in read-only data, and only those that are
+  // requested through this function are copied into strings, once.
+  static std::mutex specsMutex;
+  static std::map<std::string, std::string, std::less<>> specs;
+
+  const std::string pathname = SDF::Version() + "/" + _filename;
   {
-    const std::string pathname = SDF::Version() + "/" + _filename;
-    return GetEmbeddedSdf().at(pathname);
+    std::lock_guard<std::mutex> lock(specsMutex);
+    auto it = specs.find(pathname);
+    if (it != specs.end())
+      return it->second;
   }
-  catch(const std::out_of_range &)
+
+  const std::string_view data = FindEmbeddedSdf(pathname);
+  if (!data.empty())
   {
-    if (!_quiet)
-      sdferr << "Unable to find SDF filename[" << _filename << "] with "
-        << "version " << SDF::Version() << "\n";
+    std::lock_guard<std::mutex> lock(specsMutex);
+    return specs.emplace(pathname, std::string(data)).first->second;
   }
 
-  // An empty SDF string is returned if a query into the embeddedSdf map fails.
+  if (!_quiet)
+    sdferr << "Unable to find SDF filename[" << _filename << "] with "
+      << "version " << SDF::Version() << "\n";
+
+  // An empty SDF string is returned if the file is not embedded.
   static const std::string emptySdfString;
   return emptySdfString;
 }
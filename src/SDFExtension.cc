@@ -16,6 +16,7 @@
 */
 
 #include "SDFExtension.hh"
+#include "XmlUtils.hh"
 
 using namespace sdf;
 
@@ -114,3 +115,21 @@ SDFExtension::SDFExtension(const SDFExtension &_ge)
   this->stopErp = _ge.stopErp;
   this->fudgeFactor = _ge.fudgeFactor;
 }
+
+/////////////////////////////////////////////////
+tinyxml2::XMLDocument *SDFExtension::MutableBlob(XMLDocumentPtr &_blob)
+{
+  if (_blob.use_count() > 1)
+  {
+    auto copy = std::make_shared<tinyxml2::XMLDocument>();
+    for (const tinyxml2::XMLNode *node = _blob->FirstChild(); node;
+         node = node->NextSibling())
+    {
+      tinyxml2::XMLNode *clone = DeepClone(copy.get(), node);
+      if (clone)
+        copy->LinkEndChild(clone);
+    }
+    _blob = std::move(copy);
+  }
+  return _blob.get();
+}
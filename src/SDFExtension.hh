@@ -44,7 +44,9 @@ namespace sdf
     /// \brief Constructor
     public: SDFExtension();
 
-    /// \brief Copy constructor
+    /// \brief Copy constructor. The copy shares the blobs of _ge, which
+    /// are only copied when one of the extensions modifies them, see
+    /// MutableBlob.
     /// \param[in] _ge SDFExtension to copy.
     public: SDFExtension(const SDFExtension &_ge);
 
@@ -122,6 +124,14 @@ namespace sdf
     // blobs into body or robot
     public: std::vector<XMLDocumentPtr> blobs;
 
+    /// \brief Get a blob for modification, such as replacing the names of
+    /// reduced links. A blob that is shared with another extension is
+    /// first replaced by a copy of its own, so the other extensions keep
+    /// the original.
+    /// \param[in,out] _blob One of the blobs of an extension.
+    /// \return The document of the blob.
+    public: static tinyxml2::XMLDocument *MutableBlob(XMLDocumentPtr &_blob);
+
     friend class URDF2SDF;
   };
   }
@@ -17,6 +17,13 @@
 
 #include <gtest/gtest.h>
 #include <any>
+#include <atomic>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
 #include <ignition/math.hh>
 
 #include "sdf/sdf.hh"
@@ -537,6 +544,19 @@ TEST(SDF, Version)
   EXPECT_STREQ(SDF_VERSION, sdf::SDF::Version().c_str());
 }
 
+/////////////////////////////////////////////////
+TEST(SDF, EmbeddedSpec)
+{
+  const std::string &root = sdf::SDF::EmbeddedSpec("root.sdf", true);
+  EXPECT_NE(std::string::npos, root.find("<element name=\"sdf\""));
+
+  // The string is created once and then reused.
+  EXPECT_EQ(&root, &sdf::SDF::EmbeddedSpec("root.sdf", true));
+  EXPECT_NE(root, sdf::SDF::EmbeddedSpec("world.sdf", true));
+
+  EXPECT_TRUE(sdf::SDF::EmbeddedSpec("missing.sdf", true).empty());
+}
+
 /////////////////////////////////////////////////
 TEST(SDF, FilePath)
 {
@@ -639,6 +659,29 @@ TEST(SDF, ToStringAndParse)
   EXPECT_TRUE(sdf::readString(sdfToString, rootClone));
 }
 
+/////////////////////////////////////////////////
+TEST(SDF, ToStream)
+{
+  sdf::SDF sdfParsed;
+  sdfParsed.SetFromString(
+    "<sdf version='1.8'><model name='m'><link name='l'/></model></sdf>");
+
+  std::ostringstream stream;
+  sdfParsed.ToStream(stream);
+  EXPECT_EQ(sdfParsed.ToString(), stream.str());
+
+  std::ostringstream compact;
+  sdfParsed.ToStream(compact, true);
+  EXPECT_EQ(std::string::npos, compact.str().find('\n'));
+  EXPECT_NE(std::string::npos,
+            compact.str().find("<model name='m'><link name='l'"));
+
+  // The compact output is read back into the same document.
+  sdf::SDF reparsed;
+  reparsed.SetFromString(compact.str());
+  EXPECT_EQ(sdfParsed.ToString(), reparsed.ToString());
+}
+
 #ifndef _WIN32
 bool create_new_temp_dir(std::string &_new_temp_path)
 {
@@ -710,6 +753,186 @@ TEST(SDF, WriteURIPath)
   ASSERT_EQ(std::remove(tempFile.c_str()), 0);
   ASSERT_EQ(rmdir(tempDir.c_str()), 0);
 }
+
+/////////////////////////////////////////////////
+TEST(SDF, FindFileCache)
+{
+  // Create temp dir
+  std::string tempDir;
+  ASSERT_TRUE(create_new_temp_dir(tempDir));
+  auto tempFile = tempDir + "/cached.sdf";
+
+  int callbackCount = 0;
+  sdf::setFindCallback([&](const std::string &)
+      {
+        ++callbackCount;
+        return std::string();
+      });
+  EXPECT_TRUE(sdf::findFileCacheEnabled());
+  EXPECT_EQ(0u, sdf::findFileCacheHits());
+  EXPECT_EQ(0u, sdf::findFileCacheMisses());
+
+  // Files that are not found are remembered as well.
+  EXPECT_EQ("", sdf::findFile("cache://cached.sdf", false, true));
+  EXPECT_EQ("", sdf::findFile("cache://cached.sdf", false, true));
+  EXPECT_EQ(1, callbackCount);
+  EXPECT_EQ(1u, sdf::findFileCacheHits());
+  EXPECT_EQ(1u, sdf::findFileCacheMisses());
+
+  // Adding a URI path invalidates the memoized results.
+  sdf::SDF sdf;
+  sdf.Write(tempFile);
+  sdf::addURIPath("cache://", tempDir);
+  EXPECT_EQ(0u, sdf::findFileCacheMisses());
+  EXPECT_EQ(tempFile, sdf::findFile("cache://cached.sdf", false, true));
+  EXPECT_EQ(tempFile, sdf::findFile("cache://cached.sdf", false, true));
+  EXPECT_EQ(1u, sdf::findFileCacheHits());
+  EXPECT_EQ(1u, sdf::findFileCacheMisses());
+
+  // Files are searched every time while the cache is disabled.
+  sdf::setFindFileCacheEnabled(false);
+  EXPECT_FALSE(sdf::findFileCacheEnabled());
+  EXPECT_EQ("", sdf::findFile("cache://missing.sdf", false, true));
+  EXPECT_EQ("", sdf::findFile("cache://missing.sdf", false, true));
+  EXPECT_EQ(2, callbackCount);
+  EXPECT_EQ(1u, sdf::findFileCacheHits());
+  EXPECT_EQ(1u, sdf::findFileCacheMisses());
+  sdf::setFindFileCacheEnabled(true);
+
+  sdf::clearFindFileCache();
+  EXPECT_EQ(0u, sdf::findFileCacheHits());
+  EXPECT_EQ(0u, sdf::findFileCacheMisses());
+
+  // Cleanup
+  sdf::setFindCallback(findFileCb);
+  ASSERT_EQ(std::remove(tempFile.c_str()), 0);
+  ASSERT_EQ(rmdir(tempDir.c_str()), 0);
+}
+
+/////////////////////////////////////////////////
+TEST(SDF, FindFileParserConfig)
+{
+  std::string tempDir1;
+  std::string tempDir2;
+  ASSERT_TRUE(create_new_temp_dir(tempDir1));
+  ASSERT_TRUE(create_new_temp_dir(tempDir2));
+  const std::string tempFile1 = tempDir1 + "/config.sdf";
+  const std::string tempFile2 = tempDir2 + "/config.sdf";
+  sdf::SDF sdf;
+  sdf.Write(tempFile1);
+  sdf.Write(tempFile2);
+
+  sdf::ParserConfig config1;
+  config1.AddURIPath("config://", tempDir1);
+  sdf::ParserConfig config2;
+  config2.AddURIPath("config://", tempDir2);
+  config2.SetFindCallback([](const std::string &)
+      {
+        return std::string("from_config");
+      });
+
+  // Each configuration finds files in its own paths, and the global paths
+  // are not changed.
+  EXPECT_EQ(tempFile1, sdf::findFile("config://config.sdf", false, false,
+        config1));
+  EXPECT_EQ(tempFile2, sdf::findFile("config://config.sdf", false, false,
+        config2));
+  EXPECT_EQ("", sdf::findFile("config://config.sdf", false, false));
+  EXPECT_EQ("", sdf::findFile("config://config.sdf", false, false,
+        sdf::ParserConfig()));
+
+  // The callback of the configuration replaces the global one.
+  sdf::setFindCallback(findFileCb);
+  EXPECT_EQ("from_config", sdf::findFile("banana", false, true, config2));
+  EXPECT_EQ("coconut", sdf::findFile("banana", false, true, config1));
+
+  // Global paths are searched after the ones of the configuration.
+  sdf::addURIPath("config://", tempDir2);
+  EXPECT_EQ(tempFile1, sdf::findFile("config://config.sdf", false, false,
+        config1));
+  EXPECT_EQ(tempFile2, sdf::findFile("config://config.sdf", false, false));
+
+  // Configurations can be used from several threads at once.
+  std::vector<std::thread> threads;
+  std::atomic<int> failures{0};
+  for (int i = 0; i < 4; ++i)
+  {
+    threads.emplace_back([&, i]()
+        {
+          const sdf::ParserConfig &config = (i % 2) ? config1 : config2;
+          const std::string &expected = (i % 2) ? tempFile1 : tempFile2;
+          for (int j = 0; j < 100; ++j)
+          {
+            if (sdf::findFile("config://config.sdf", false, false, config) !=
+                expected)
+            {
+              ++failures;
+            }
+          }
+        });
+  }
+  for (auto &thread : threads)
+    thread.join();
+  EXPECT_EQ(0, failures);
+
+  // Cleanup
+  ASSERT_EQ(std::remove(tempFile1.c_str()), 0);
+  ASSERT_EQ(std::remove(tempFile2.c_str()), 0);
+  ASSERT_EQ(rmdir(tempDir1.c_str()), 0);
+  ASSERT_EQ(rmdir(tempDir2.c_str()), 0);
+}
+
+/////////////////////////////////////////////////
+TEST(SDF, ParallelWrite)
+{
+  std::string sdfString = "<sdf version='1.8'><world name='w'>";
+  for (int i = 0; i < 20; ++i)
+  {
+    sdfString += "<model name='m" + std::to_string(i) + "'>"
+      "<link name='l'><pose>" + std::to_string(i) + " 0 0 0 0 0</pose>"
+      "</link></model>";
+  }
+  sdfString += "<light name='sun' type='directional'/></world></sdf>";
+  sdf::SDF sdf;
+  sdf.SetFromString(sdfString);
+
+  // The world is split into its children.
+  const sdf::ElementPtr root = sdf.Root();
+  const std::vector<std::string> buffers = root->ToBuffers(0, false, 4u);
+  ASSERT_LT(20u, buffers.size());
+  std::string joined;
+  for (const std::string &buffer : buffers)
+    joined += buffer;
+  EXPECT_EQ(root->ToString(""), joined);
+  EXPECT_EQ(1u, root->ToBuffers(0, false, 1u).size());
+
+  std::ostringstream compact;
+  root->ToStream(compact, 2, true, 0u);
+  std::ostringstream expected;
+  root->ToStream(expected, 2, true);
+  EXPECT_EQ(expected.str(), compact.str());
+
+  std::string tempDir;
+  ASSERT_TRUE(create_new_temp_dir(tempDir));
+  const std::string serialFile = tempDir + "/serial.sdf";
+  const std::string parallelFile = tempDir + "/parallel.sdf";
+  sdf.Write(serialFile);
+  sdf.Write(parallelFile, 4u);
+
+  auto readFile = [](const std::string &_path)
+  {
+    std::ifstream in(_path);
+    return std::string(std::istreambuf_iterator<char>(in),
+                       std::istreambuf_iterator<char>());
+  };
+  EXPECT_FALSE(readFile(serialFile).empty());
+  EXPECT_EQ(readFile(serialFile), readFile(parallelFile));
+
+  // Cleanup
+  ASSERT_EQ(std::remove(serialFile.c_str()), 0);
+  ASSERT_EQ(std::remove(parallelFile.c_str()), 0);
+  ASSERT_EQ(rmdir(tempDir.c_str()), 0);
+}
 #endif  // _WIN32
 
 /////////////////////////////////////////////////
@@ -15,6 +15,8 @@
  *
 */
 #include "sdf/Scene.hh"
+#include "ElementRetentionScope.hh"
+#include "LoadStatsScope.hh"
 #include "Utils.hh"
 
 using namespace sdf;
@@ -84,9 +86,10 @@ Scene &Scene::operator=(Scene &&_scene)
 /////////////////////////////////////////////////
 Errors Scene::Load(ElementPtr _sdf)
 {
+  DomLoadTimer timer("Scene");
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that the provided SDF element is a <scene> element.
   // This is an error that cannot be recovered, so return an error.
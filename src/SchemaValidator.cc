@@ -0,0 +1,1056 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <tinyxml2.h>
+
+#include <ignition/math/SemanticVersion.hh>
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "sdf/Param.hh"
+#include "sdf/SDFImpl.hh"
+#include "sdf/SchemaValidator.hh"
+#include "sdf/Types.hh"
+
+#include "Converter.hh"
+#include "NumberParsing.hh"
+#include "SpecTables.hh"
+#include "Tracing.hh"
+#include "Utils.hh"
+
+using namespace sdf;
+
+namespace
+{
+/// \brief Type of a value or an attribute of the schema.
+enum class ValueKind : std::uint8_t
+{
+  NONE,
+  STRING,
+  BOOL,
+  INT,
+  UNSIGNED_INT,
+  UINT64,
+  DOUBLE,
+  TIME,
+  COLOR,
+  VECTOR2I,
+  VECTOR2D,
+  VECTOR3,
+  POSE,
+  QUATERNION,
+  DOUBLE_ARRAY,
+};
+
+/// \brief An attribute of an element type.
+struct SchemaAttribute
+{
+  /// \brief Name of the attribute.
+  std::string name;
+
+  /// \brief Type name of the spec, for messages.
+  std::string typeName;
+
+  /// \brief Type of the attribute.
+  ValueKind kind = ValueKind::STRING;
+
+  /// \brief True if the attribute must be set.
+  bool required = false;
+};
+
+/// \brief A child element of an element type.
+struct SchemaChild
+{
+  /// \brief Name of the child.
+  std::string name;
+
+  /// \brief Index of the element type of the child.
+  std::uint32_t node = 0;
+
+  /// \brief True if the child may appear at most once in its parent.
+  bool single = false;
+
+  /// \brief True if the child must appear at least once in its parent.
+  bool required = false;
+};
+
+/// \brief An element type, compiled from an element of the spec tables.
+/// Element types that are included from several files, such as link.sdf,
+/// are compiled once. The cardinality of an element is a property of its
+/// edge from the parent, since an include can override it.
+struct SchemaNode
+{
+  /// \brief Name of the element.
+  std::string name;
+
+  /// \brief Type name of the value of the element, for messages.
+  std::string typeName;
+
+  /// \brief Type of the value of the element.
+  ValueKind kind = ValueKind::NONE;
+
+  /// \brief Minimum that a scalar value can have, if set.
+  double minValue = -std::numeric_limits<double>::infinity();
+
+  /// \brief Maximum that a scalar value can have, if set.
+  double maxValue = std::numeric_limits<double>::infinity();
+
+  /// \brief True if the children are copied without a description, as in a
+  /// plugin.
+  bool copyChildren = false;
+
+  /// \brief The attributes, in the order of the spec.
+  std::vector<SchemaAttribute> attributes;
+
+  /// \brief The children, sorted by name.
+  std::vector<SchemaChild> children;
+};
+
+/// \brief The compiled schema of a spec version.
+struct Schema
+{
+  /// \brief Spec version, such as "1.8".
+  std::string version;
+
+  /// \brief Element types. The first one is the <sdf> element.
+  std::vector<SchemaNode> nodes;
+
+  /// \brief Index of the <plugin> element type, which the parser also
+  /// accepts in an <include>, or kNoNode.
+  std::uint32_t pluginNode = kNoNode;
+
+  /// \brief Index used when there is no element type.
+  static constexpr std::uint32_t kNoNode =
+      std::numeric_limits<std::uint32_t>::max();
+};
+
+/////////////////////////////////////////////////
+/// \brief Read the cardinality of the spec, "0", "1", "+" or "*".
+/// \param[in] _required The cardinality.
+/// \param[out] _child Child whose single and required flags are set.
+void setCardinality(const std::string &_required, SchemaChild &_child)
+{
+  _child.single = _required == "0" || _required == "1";
+  _child.required = _required == "1" || _required == "+";
+}
+
+/////////////////////////////////////////////////
+/// \brief Resolve the type of a value from its spec type name, with the
+/// names accepted by sdf::Param.
+/// \param[in] _typeName Type name, such as "pose".
+/// \return The type. Unknown names are read as strings.
+ValueKind valueKindFromName(const std::string &_typeName)
+{
+  static const std::unordered_map<std::string, ValueKind> kinds = {
+    {"bool", ValueKind::BOOL},
+    {"char", ValueKind::STRING},
+    {"std::string", ValueKind::STRING},
+    {"string", ValueKind::STRING},
+    {"int", ValueKind::INT},
+    {"uint64_t", ValueKind::UINT64},
+    {"unsigned int", ValueKind::UNSIGNED_INT},
+    {"double", ValueKind::DOUBLE},
+    {"float", ValueKind::DOUBLE},
+    {"sdf::Time", ValueKind::TIME},
+    {"time", ValueKind::TIME},
+    {"ignition::math::Color", ValueKind::COLOR},
+    {"color", ValueKind::COLOR},
+    {"ignition::math::Vector2i", ValueKind::VECTOR2I},
+    {"vector2i", ValueKind::VECTOR2I},
+    {"ignition::math::Vector2d", ValueKind::VECTOR2D},
+    {"vector2d", ValueKind::VECTOR2D},
+    {"ignition::math::Vector3d", ValueKind::VECTOR3},
+    {"vector3", ValueKind::VECTOR3},
+    {"ignition::math::Pose3d", ValueKind::POSE},
+    {"pose", ValueKind::POSE},
+    {"Pose", ValueKind::POSE},
+    {"ignition::math::Quaterniond", ValueKind::QUATERNION},
+    {"quaternion", ValueKind::QUATERNION},
+    {"std::vector<double>", ValueKind::DOUBLE_ARRAY},
+    {"double_array", ValueKind::DOUBLE_ARRAY},
+  };
+
+  auto iter = kinds.find(_typeName);
+  return iter == kinds.end() ? ValueKind::STRING : iter->second;
+}
+
+/////////////////////////////////////////////////
+/// \brief Parse a limit of the spec.
+/// \param[in] _value Text of the limit, or an empty string if unset.
+/// \param[in] _unset Value returned when the limit is unset or invalid.
+/// \return The limit.
+double parseLimit(const char *_value, double _unset)
+{
+  double limit = 0.0;
+  const std::string_view value = sdf::trimView(_value);
+  if (TokenFromChars(value.data(), value.data() + value.size(), limit))
+    return limit;
+  return _unset;
+}
+
+/// \brief Compiles the element types of a spec version from the spec
+/// tables.
+class SchemaCompiler
+{
+  /// \brief Constructor
+  /// \param[in] _tables Generated spec tables.
+  /// \param[out] _schema Schema to fill.
+  public: SchemaCompiler(const SpecTables &_tables, Schema &_schema)
+    : tables(_tables), schema(_schema)
+  {
+  }
+
+  /// \brief Compile the element type of a spec element and the types below
+  /// it.
+  /// \param[in] _spec Element of the spec tables.
+  /// \return Index of the element type.
+  public: std::uint32_t Compile(const SpecElement &_spec)
+  {
+    const auto [iter, inserted] = this->indices.emplace(&_spec,
+        static_cast<std::uint32_t>(this->schema.nodes.size()));
+    const std::uint32_t index = iter->second;
+    if (!inserted)
+      return index;
+
+    // The children are compiled after the node is added, since files
+    // include each other, so the node is only referred to by index.
+    this->schema.nodes.emplace_back();
+    {
+      SchemaNode &node = this->schema.nodes.back();
+      node.name = this->tables.String(_spec.name);
+      if (node.name == "plugin" && this->schema.pluginNode == Schema::kNoNode)
+        this->schema.pluginNode = index;
+
+      if (_spec.type != kSpecNoString)
+      {
+        node.typeName = this->tables.String(_spec.type);
+        node.kind = valueKindFromName(node.typeName);
+        node.minValue = parseLimit(this->tables.String(_spec.minValue),
+            node.minValue);
+        node.maxValue = parseLimit(this->tables.String(_spec.maxValue),
+            node.maxValue);
+      }
+      node.copyChildren = _spec.copyChildren;
+
+      node.attributes.reserve(_spec.attributeCount);
+      for (std::uint32_t i = 0; i < _spec.attributeCount; ++i)
+      {
+        const SpecAttribute &attr =
+            this->tables.attributes[_spec.firstAttribute + i];
+        SchemaAttribute &attribute = node.attributes.emplace_back();
+        attribute.name = this->tables.String(attr.name);
+        attribute.typeName = this->tables.String(attr.type);
+        attribute.kind = valueKindFromName(attribute.typeName);
+        attribute.required = attr.required;
+      }
+    }
+
+    std::vector<SchemaChild> children;
+    children.reserve(_spec.childCount);
+    for (std::uint32_t i = 0; i < _spec.childCount; ++i)
+    {
+      const SpecChild &child = this->tables.children[_spec.firstChild + i];
+      const SpecElement *childSpec = child.element != kSpecNoElement ?
+          &this->tables.elements[child.element] :
+          this->tables.FindFile(this->schema.version.c_str(),
+              this->tables.String(child.includeFilename));
+
+      // Unnamed elements, such as the copied data of a plugin, have no
+      // type.
+      if (!childSpec || childSpec->name == kSpecNoString)
+        continue;
+
+      // An element with a ref, such as a nested <model>, has the type of
+      // the root of the referenced file, as in readXmlValue.
+      const SpecElement *typeSpec = childSpec;
+      if (childSpec->ref != kSpecNoString)
+      {
+        const std::string refFile =
+            std::string(this->tables.String(childSpec->ref)) + ".sdf";
+        typeSpec = this->tables.FindFile(this->schema.version.c_str(),
+            refFile.c_str());
+        if (!typeSpec)
+          continue;
+      }
+
+      SchemaChild &schemaChild = children.emplace_back();
+      schemaChild.name = this->tables.String(childSpec->name);
+      schemaChild.node = this->Compile(*typeSpec);
+      setCardinality(this->tables.String(
+          child.element == kSpecNoElement &&
+          child.includeRequired != kSpecNoString ?
+          child.includeRequired : childSpec->required), schemaChild);
+    }
+
+    std::stable_sort(children.begin(), children.end(),
+        [](const SchemaChild &_a, const SchemaChild &_b)
+        {
+          return _a.name < _b.name;
+        });
+    this->schema.nodes[index].children = std::move(children);
+    return index;
+  }
+
+  /// \brief Generated spec tables.
+  private: const SpecTables &tables;
+
+  /// \brief Schema being filled.
+  private: Schema &schema;
+
+  /// \brief Index of the element type of each compiled spec element.
+  private: std::unordered_map<const SpecElement *, std::uint32_t> indices;
+};
+
+/////////////////////////////////////////////////
+/// \brief Get the compiled schema of a spec version, compiling it the
+/// first time it is requested.
+/// \param[in] _version Spec version, such as "1.8".
+/// \return The schema, or nullptr if the spec tables don't have the
+/// version.
+std::shared_ptr<const Schema> compiledSchema(const std::string &_version)
+{
+  static std::mutex mutex;
+  static std::map<std::string, std::shared_ptr<const Schema>> cache;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  auto iter = cache.find(_version);
+  if (iter != cache.end())
+    return iter->second;
+
+  SDF_TRACE_SCOPE("sdf::SchemaValidator::Compile");
+  std::shared_ptr<Schema> schema;
+  const SpecTables &tables = GetSpecTables();
+  const SpecElement *root = tables.FindFile(_version.c_str(), "root.sdf");
+  if (root)
+  {
+    schema = std::make_shared<Schema>();
+    schema->version = _version;
+    SchemaCompiler(tables, *schema).Compile(*root);
+  }
+  return cache.emplace(_version, std::move(schema)).first->second;
+}
+
+/////////////////////////////////////////////////
+/// \brief Check whether a name has a namespace prefix, such as
+/// "custom:data". Such elements and attributes are not part of the spec.
+/// \param[in] _name The name.
+/// \return True if the name has a prefix.
+bool hasNamespace(const char *_name)
+{
+  return std::strchr(_name, ':') != nullptr;
+}
+
+/////////////////////////////////////////////////
+/// \brief Read a number token, with an optional leading '+'.
+/// \param[in] _token The token.
+/// \param[out] _out The number.
+/// \return True if the whole token is a number of type T.
+template <typename T>
+bool numberToken(std::string_view _token, T &_out)
+{
+  if (!_token.empty() && _token.front() == '+')
+    _token.remove_prefix(1);
+
+  if constexpr (std::is_integral_v<T>)
+  {
+    // Param accepts hexadecimal integers.
+    if (_token.size() > 2 && _token[0] == '0' &&
+        (_token[1] == 'x' || _token[1] == 'X'))
+    {
+      const auto result = std::from_chars(_token.data() + 2,
+          _token.data() + _token.size(), _out, 16);
+      return result.ec == std::errc() &&
+          result.ptr == _token.data() + _token.size();
+    }
+  }
+
+  if (TokenFromChars(_token.data(), _token.data() + _token.size(), _out))
+    return true;
+
+  if constexpr (std::is_floating_point_v<T>)
+  {
+    // Param reads infinities and NaN with std::stod.
+    if (!_token.empty() && _token.front() == '-')
+      _token.remove_prefix(1);
+    const std::string lower = sdf::lowercase(_token);
+    if (lower == "inf" || lower == "infinity" || lower == "nan")
+    {
+      _out = std::numeric_limits<T>::infinity();
+      return true;
+    }
+  }
+  return false;
+}
+
+/////////////////////////////////////////////////
+/// \brief Count the white space separated numbers of a value.
+/// \param[in] _value The value.
+/// \param[in] _max Maximum number of numbers to read.
+/// \param[out] _first The first number.
+/// \return The number of numbers, or _max + 1 if there are more than _max
+/// numbers or a token is not a number of type T.
+template <typename T>
+std::size_t countNumbers(std::string_view _value, std::size_t _max,
+    double &_first)
+{
+  std::size_t count = 0;
+  std::size_t pos = 0;
+  while (true)
+  {
+    while (pos < _value.size() && IsClassicSpace(_value[pos]))
+      ++pos;
+    if (pos == _value.size())
+      return count;
+
+    std::size_t end = pos;
+    while (end < _value.size() && !IsClassicSpace(_value[end]))
+      ++end;
+
+    T number;
+    if (count == _max || !numberToken(_value.substr(pos, end - pos), number))
+      return _max + 1;
+    if (count == 0)
+      _first = static_cast<double>(number);
+
+    ++count;
+    pos = end;
+  }
+}
+
+/////////////////////////////////////////////////
+/// \brief Check that a value can be read as a type.
+/// \param[in] _kind Type of the value.
+/// \param[in] _value The value, without surrounding white space.
+/// \param[out] _scalar The value of a scalar number, for range checks.
+/// \return True if the value is valid.
+bool validValue(ValueKind _kind, std::string_view _value, double &_scalar)
+{
+  double first = 0.0;
+  switch (_kind)
+  {
+    case ValueKind::NONE:
+    case ValueKind::STRING:
+      return true;
+    case ValueKind::BOOL:
+    {
+      const std::string lower = sdf::lowercase(_value);
+      return lower == "true" || lower == "false" || lower == "1" ||
+          lower == "0";
+    }
+    case ValueKind::INT:
+      return countNumbers<int>(_value, 1, _scalar) == 1;
+    case ValueKind::UNSIGNED_INT:
+      return countNumbers<unsigned int>(_value, 1, _scalar) == 1;
+    case ValueKind::UINT64:
+      return countNumbers<std::uint64_t>(_value, 1, _scalar) == 1;
+    case ValueKind::DOUBLE:
+      return countNumbers<double>(_value, 1, _scalar) == 1;
+    case ValueKind::TIME:
+      // Seconds and nanoseconds, or seconds as in the XML schema.
+      return countNumbers<std::int32_t>(_value, 2, first) == 2 ||
+          countNumbers<double>(_value, 1, first) == 1;
+    case ValueKind::COLOR:
+    {
+      const std::size_t count = countNumbers<float>(_value, 4, first);
+      return count == 3 || count == 4;
+    }
+    case ValueKind::VECTOR2I:
+      return countNumbers<int>(_value, 2, first) == 2;
+    case ValueKind::VECTOR2D:
+      return countNumbers<double>(_value, 2, first) == 2;
+    case ValueKind::VECTOR3:
+      return countNumbers<double>(_value, 3, first) == 3;
+    case ValueKind::POSE:
+      return countNumbers<double>(_value, 6, first) == 6;
+    case ValueKind::QUATERNION:
+    {
+      const std::size_t count = countNumbers<double>(_value, 4, first);
+      return count == 3 || count == 4;
+    }
+    case ValueKind::DOUBLE_ARRAY:
+    {
+      const std::size_t max = std::numeric_limits<std::size_t>::max() - 1;
+      return countNumbers<double>(_value, max, first) <= max;
+    }
+  }
+  return true;
+}
+
+/// \brief Access to the elements of a tinyxml2 document.
+struct XmlTree
+{
+  using Handle = const tinyxml2::XMLElement *;
+
+  static const char *Name(Handle _elem)
+  {
+    return _elem->Name();
+  }
+
+  static int Line(Handle _elem)
+  {
+    return _elem->GetLineNum();
+  }
+
+  static std::string_view Text(Handle _elem, std::string &)
+  {
+    const char *text = _elem->GetText();
+    return text ? std::string_view(text) : std::string_view();
+  }
+
+  template <typename Func>
+  static void ForEachAttribute(Handle _elem, Func &&_func)
+  {
+    for (const tinyxml2::XMLAttribute *attr = _elem->FirstAttribute(); attr;
+         attr = attr->Next())
+    {
+      _func(attr->Name(), std::string_view(attr->Value()));
+    }
+  }
+
+  template <typename Func>
+  static void ForEachChild(Handle _elem, Func &&_func)
+  {
+    for (Handle child = _elem->FirstChildElement(); child;
+         child = child->NextSiblingElement())
+    {
+      _func(child);
+    }
+  }
+};
+
+/// \brief Access to the elements of an sdf::Element tree. The attributes
+/// that are set are visited as if they were written in a document, and
+/// required attributes are visited with their default, since the parser
+/// adds required elements without setting their attributes.
+struct ElementTree
+{
+  using Handle = const Element *;
+
+  static const char *Name(Handle _elem)
+  {
+    return _elem->GetName().c_str();
+  }
+
+  static int Line(Handle)
+  {
+    return 0;
+  }
+
+  static std::string_view Text(Handle _elem, std::string &_buffer)
+  {
+    const Param *value = _elem->FindValue();
+    if (!value || !value->GetSet())
+      return std::string_view();
+    _buffer = value->GetAsString();
+    return _buffer;
+  }
+
+  template <typename Func>
+  static void ForEachAttribute(Handle _elem, Func &&_func)
+  {
+    for (const ParamPtr &attr : _elem->Attributes())
+    {
+      if (attr->GetSet() || attr->GetRequired())
+        _func(attr->GetKey().c_str(), std::string_view(attr->GetAsString()));
+    }
+  }
+
+  template <typename Func>
+  static void ForEachChild(Handle _elem, Func &&_func)
+  {
+    for (const Element &child : _elem->Children())
+      _func(&child);
+  }
+};
+
+/// \brief One validation of a document or element tree.
+class Validation
+{
+  /// \brief Constructor
+  /// \param[in] _schema Schema of the document.
+  /// \param[in] _config Parser configuration, for the error budget.
+  /// \param[out] _errors Errors of the validation.
+  public: Validation(const Schema &_schema, const ParserConfig &_config,
+              Errors &_errors)
+    : schema(_schema), config(_config), errors(_errors)
+  {
+  }
+
+  /// \brief Validate an element and its descendants.
+  /// \param[in] _node Index of the element type.
+  /// \param[in] _elem The element.
+  public: template <typename Tree>
+          void Element(std::uint32_t _node, typename Tree::Handle _elem)
+  {
+    if (errorBudgetReached(this->errors, this->config))
+      return;
+
+    const SchemaNode &node = this->schema.nodes[_node];
+    const std::size_t pathSize = this->path.size();
+    this->path += '/';
+    this->path += Tree::Name(_elem);
+    const int line = Tree::Line(_elem);
+
+    if (node.kind != ValueKind::NONE)
+    {
+      std::string buffer;
+      const std::string_view text = sdf::trimView(Tree::Text(_elem, buffer));
+      if (!text.empty())
+        this->Value(node, text, line);
+    }
+
+    // The type of a joint says if its required elements are defaulted.
+    bool ballJoint = false;
+    std::vector<bool> set(node.attributes.size(), false);
+    Tree::ForEachAttribute(_elem,
+        [&](const char *_name, std::string_view _value)
+        {
+          if (hasNamespace(_name))
+            return;
+
+          auto attr = std::find_if(node.attributes.begin(),
+              node.attributes.end(), [&](const SchemaAttribute &_attr)
+              {
+                return _attr.name == _name;
+              });
+          if (attr == node.attributes.end())
+          {
+            this->Error(ErrorCode::ATTRIBUTE_INVALID, line, [&]
+                {
+                  return "Attribute [" + std::string(_name) +
+                      "] is not defined for this element";
+                });
+            return;
+          }
+
+          set[attr - node.attributes.begin()] = true;
+          this->Attribute(*attr, sdf::trimView(_value), line);
+          if (node.name == "joint" && attr->name == "type")
+            ballJoint = sdf::trimView(_value) == "ball";
+        });
+
+    for (std::size_t i = 0; i < node.attributes.size(); ++i)
+    {
+      if (node.attributes[i].required && !set[i])
+      {
+        this->Error(ErrorCode::ATTRIBUTE_MISSING, line, [&]
+            {
+              return "Required attribute [" + node.attributes[i].name +
+                  "] is missing";
+            });
+      }
+    }
+
+    if (!node.copyChildren)
+    {
+      std::vector<std::uint32_t> counts(node.children.size(), 0u);
+      Tree::ForEachChild(_elem, [&](typename Tree::Handle _child)
+          {
+            const char *name = Tree::Name(_child);
+            if (hasNamespace(name))
+              return;
+
+            auto iter = std::lower_bound(node.children.begin(),
+                node.children.end(), name,
+                [](const SchemaChild &_entry, const char *_name)
+                {
+                  return _entry.name < _name;
+                });
+            const bool known =
+                iter != node.children.end() && iter->name == name;
+
+            // The parser reads the plugins of an include, which the spec
+            // doesn't list.
+            if (!known && node.name == "include" &&
+                this->schema.pluginNode != Schema::kNoNode &&
+                std::strcmp(name, "plugin") == 0)
+            {
+              this->Element<Tree>(this->schema.pluginNode, _child);
+              return;
+            }
+
+            if (!known)
+            {
+              this->Error(ErrorCode::ELEMENT_INVALID, Tree::Line(_child), [&]
+                  {
+                    return "Element <" + std::string(name) +
+                        "> is not defined in SDFormat " +
+                        this->schema.version + " as a child of <" +
+                        node.name + ">";
+                  });
+              return;
+            }
+
+            if (++counts[iter - node.children.begin()] == 2u && iter->single)
+            {
+              this->Error(ErrorCode::ELEMENT_INVALID, Tree::Line(_child), [&]
+                  {
+                    return "Element <" + iter->name +
+                        "> can appear at most once in <" + node.name + ">";
+                  });
+            }
+            this->Element<Tree>(iter->node, _child);
+          });
+
+      // Like the parser, require the elements of joints other than ball
+      // joints, and add the missing elements of the others.
+      if (node.name == "joint" && !ballJoint)
+      {
+        for (std::size_t i = 0; i < node.children.size(); ++i)
+        {
+          if (node.children[i].required && counts[i] == 0u)
+          {
+            this->Error(ErrorCode::ELEMENT_MISSING, line, [&]
+                {
+                  return "Required element <" + node.children[i].name +
+                      "> is missing";
+                });
+          }
+        }
+      }
+    }
+
+    this->path.resize(pathSize);
+  }
+
+  /// \brief Check the value of an element.
+  /// \param[in] _node Element type.
+  /// \param[in] _value The value, without surrounding white space.
+  /// \param[in] _line Line of the element, or 0.
+  private: void Value(const SchemaNode &_node, std::string_view _value,
+               int _line)
+  {
+    double scalar = 0.0;
+    if (!validValue(_node.kind, _value, scalar))
+    {
+      this->Error(ErrorCode::ELEMENT_INVALID, _line, [&]
+          {
+            return "Value [" + std::string(_value) + "] is not a valid " +
+                _node.typeName;
+          });
+    }
+    else if (scalar < _node.minValue || scalar > _node.maxValue)
+    {
+      this->Error(ErrorCode::ELEMENT_INVALID, _line, [&]
+          {
+            return "Value [" + std::string(_value) +
+                "] is out of the range of the spec";
+          });
+    }
+  }
+
+  /// \brief Check the value of an attribute.
+  /// \param[in] _attr Attribute type.
+  /// \param[in] _value The value, without surrounding white space.
+  /// \param[in] _line Line of the element, or 0.
+  private: void Attribute(const SchemaAttribute &_attr,
+               std::string_view _value, int _line)
+  {
+    double scalar = 0.0;
+    if (_value.empty() ? _attr.required :
+        !validValue(_attr.kind, _value, scalar))
+    {
+      this->Error(ErrorCode::ATTRIBUTE_INVALID, _line, [&]
+          {
+            return "Attribute [" + _attr.name + "] value [" +
+                std::string(_value) + "] is not a valid " + _attr.typeName;
+          });
+    }
+  }
+
+  /// \brief Add an error about the current element, unless the error
+  /// budget is reached.
+  /// \param[in] _code Code of the error.
+  /// \param[in] _line Line of the element, or 0.
+  /// \param[in] _message Function that returns the message.
+  private: template <typename MessageFunc>
+           void Error(ErrorCode _code, int _line, MessageFunc &&_message)
+  {
+    addError(this->errors, this->config, _code, [&]
+        {
+          std::string message = this->path;
+          if (_line > 0)
+            message += " (line " + std::to_string(_line) + ")";
+          return message + ": " + _message() + ".";
+        });
+  }
+
+  /// \brief Schema of the document.
+  private: const Schema &schema;
+
+  /// \brief Parser configuration, for the error budget.
+  private: const ParserConfig &config;
+
+  /// \brief Errors of the validation.
+  private: Errors &errors;
+
+  /// \brief Path of the current element, such as "/sdf/model/link".
+  private: std::string path;
+};
+}
+
+/// \brief Private data for SchemaValidator
+class sdf::SchemaValidatorPrivate
+{
+  /// \brief Validate a tree that is in the version of the validator.
+  /// \param[in] _root Root element of the tree.
+  /// \param[in] _version Value of the version attribute of the root, or
+  /// nullptr if it has none.
+  /// \param[in] _config Parser configuration.
+  /// \return The errors.
+  public: template <typename Tree>
+          Errors Validate(typename Tree::Handle _root, const char *_version,
+              const ParserConfig &_config) const;
+
+  /// \brief Convert a document of an older version to the version of the
+  /// validator, as the parser does, and validate it.
+  /// \param[in] _doc The document, which is converted in place.
+  /// \param[in] _config Parser configuration.
+  /// \return The errors.
+  public: Errors ValidateDocument(tinyxml2::XMLDocument &_doc,
+              const ParserConfig &_config) const;
+
+  /// \brief Spec version of the validator.
+  public: std::string version = SDF::Version();
+
+  /// \brief Compiled schema of the version, or nullptr if the library has
+  /// no spec for it.
+  public: std::shared_ptr<const Schema> schema;
+};
+
+/////////////////////////////////////////////////
+template <typename Tree>
+Errors SchemaValidatorPrivate::Validate(typename Tree::Handle _root,
+    const char *_version, const ParserConfig &_config) const
+{
+  SDF_TRACE_SCOPE("sdf::SchemaValidator::Validate");
+  Errors errors;
+
+  if (!this->schema)
+  {
+    errors.push_back({ErrorCode::ATTRIBUTE_INVALID,
+        "The library has no spec for SDFormat version [" + this->version +
+        "]."});
+    return errors;
+  }
+
+  const bool isSdf = std::strcmp(Tree::Name(_root), "sdf") == 0;
+  if (isSdf && _version && this->version != _version)
+  {
+    errors.push_back({ErrorCode::ATTRIBUTE_INVALID,
+        "The document version [" + std::string(_version) +
+        "] is not the version [" + this->version + "] of the validator."});
+    return errors;
+  }
+
+  Validation validation(*this->schema, _config, errors);
+  if (isSdf)
+  {
+    validation.Element<Tree>(0u, _root);
+    return errors;
+  }
+
+  // Fragments are one of the elements of <sdf>.
+  const SchemaNode &sdfNode = this->schema->nodes.front();
+  for (const SchemaChild &child : sdfNode.children)
+  {
+    if (child.name == Tree::Name(_root))
+    {
+      validation.Element<Tree>(child.node, _root);
+      return errors;
+    }
+  }
+
+  errors.push_back({ErrorCode::ELEMENT_INVALID,
+      "The root element <" + std::string(Tree::Name(_root)) +
+      "> is neither <sdf> nor one of its children in SDFormat " +
+      this->version + "."});
+  return errors;
+}
+
+/////////////////////////////////////////////////
+Errors SchemaValidatorPrivate::ValidateDocument(tinyxml2::XMLDocument &_doc,
+    const ParserConfig &_config) const
+{
+  tinyxml2::XMLElement *root = _doc.RootElement();
+  const char *docVersion = root->Attribute("version");
+  if (this->schema && docVersion &&
+      std::strcmp(root->Name(), "sdf") == 0 && this->version != docVersion)
+  {
+    // Only the versions of the spec can be converted, and only upwards.
+    const std::string from = docVersion;
+    if (compiledSchema(from) &&
+        ignition::math::SemanticVersion(from) <
+        ignition::math::SemanticVersion(this->version))
+    {
+      if (!Converter::Convert(&_doc, this->version, true))
+      {
+        return {{ErrorCode::ATTRIBUTE_INVALID,
+            "Unable to convert the document from version [" + from +
+            "] to version [" + this->version + "]."}};
+      }
+      docVersion = root->Attribute("version");
+    }
+  }
+
+  return this->Validate<XmlTree>(root, docVersion, _config);
+}
+
+/////////////////////////////////////////////////
+SchemaValidator::SchemaValidator()
+  : dataPtr(new SchemaValidatorPrivate)
+{
+  this->dataPtr->schema = compiledSchema(this->dataPtr->version);
+}
+
+/////////////////////////////////////////////////
+SchemaValidator::SchemaValidator(const std::string &_version)
+  : dataPtr(new SchemaValidatorPrivate)
+{
+  this->dataPtr->version = _version;
+  this->dataPtr->schema = compiledSchema(_version);
+}
+
+/////////////////////////////////////////////////
+SchemaValidator::SchemaValidator(const SchemaValidator &_validator)
+  : dataPtr(new SchemaValidatorPrivate(*_validator.dataPtr))
+{
+}
+
+/////////////////////////////////////////////////
+SchemaValidator::SchemaValidator(SchemaValidator &&_validator) noexcept
+  : dataPtr(std::exchange(_validator.dataPtr, nullptr))
+{
+}
+
+/////////////////////////////////////////////////
+SchemaValidator &SchemaValidator::operator=(
+    SchemaValidator &&_validator) noexcept
+{
+  std::swap(this->dataPtr, _validator.dataPtr);
+  return *this;
+}
+
+/////////////////////////////////////////////////
+SchemaValidator &SchemaValidator::operator=(
+    const SchemaValidator &_validator)
+{
+  return *this = SchemaValidator(_validator);
+}
+
+/////////////////////////////////////////////////
+SchemaValidator::~SchemaValidator()
+{
+  delete this->dataPtr;
+  this->dataPtr = nullptr;
+}
+
+/////////////////////////////////////////////////
+const std::string &SchemaValidator::Version() const
+{
+  return this->dataPtr->version;
+}
+
+/////////////////////////////////////////////////
+std::size_t SchemaValidator::ElementTypeCount(const std::string &_version)
+{
+  std::shared_ptr<const Schema> schema = compiledSchema(_version);
+  return schema ? schema->nodes.size() : 0u;
+}
+
+/////////////////////////////////////////////////
+Errors SchemaValidator::ValidateString(const std::string &_xml) const
+{
+  return this->ValidateString(_xml, ParserConfig());
+}
+
+/////////////////////////////////////////////////
+Errors SchemaValidator::ValidateString(const std::string &_xml,
+    const ParserConfig &_config) const
+{
+  tinyxml2::XMLDocument doc;
+  doc.Parse(_xml.data(), _xml.size());
+  if (doc.Error() || !doc.RootElement())
+  {
+    return {{ErrorCode::STRING_READ,
+        "Unable to parse the XML string: " +
+        std::string(doc.Error() ? doc.ErrorStr() : "no root element")}};
+  }
+
+  return this->dataPtr->ValidateDocument(doc, _config);
+}
+
+/////////////////////////////////////////////////
+Errors SchemaValidator::ValidateFile(const std::string &_path) const
+{
+  return this->ValidateFile(_path, ParserConfig());
+}
+
+/////////////////////////////////////////////////
+Errors SchemaValidator::ValidateFile(const std::string &_path,
+    const ParserConfig &_config) const
+{
+  tinyxml2::XMLDocument doc;
+  doc.LoadFile(_path.c_str());
+  if (doc.Error() || !doc.RootElement())
+  {
+    return {{ErrorCode::FILE_READ,
+        "Unable to read the XML file [" + _path + "]: " +
+        std::string(doc.Error() ? doc.ErrorStr() : "no root element")}};
+  }
+
+  return this->dataPtr->ValidateDocument(doc, _config);
+}
+
+/////////////////////////////////////////////////
+Errors SchemaValidator::Validate(const ElementPtr &_elem) const
+{
+  return this->Validate(_elem, ParserConfig());
+}
+
+/////////////////////////////////////////////////
+Errors SchemaValidator::Validate(const ElementPtr &_elem,
+    const ParserConfig &_config) const
+{
+  if (!_elem)
+  {
+    return {{ErrorCode::ELEMENT_MISSING, "The element to validate is null."}};
+  }
+
+  std::string version;
+  const bool hasVersion = _elem->HasAttribute("version") &&
+      _elem->GetAttribute("version")->GetSet();
+  if (hasVersion)
+    version = _elem->GetAttribute("version")->GetAsString();
+  return this->dataPtr->Validate<ElementTree>(_elem.get(),
+      hasVersion ? version.c_str() : nullptr, _config);
+}
@@ -0,0 +1,247 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "sdf/Element.hh"
+#include "sdf/Filesystem.hh"
+#include "sdf/ParserConfig.hh"
+#include "sdf/Root.hh"
+#include "sdf/SDFImpl.hh"
+#include "sdf/SchemaValidator.hh"
+#include "test_config.h"
+
+/////////////////////////////////////////////////
+/// \brief Check that the errors have one code each, in order.
+/// \param[in] _errors Errors to check.
+/// \param[in] _codes Expected codes.
+static void expectCodes(const sdf::Errors &_errors,
+    const std::vector<sdf::ErrorCode> &_codes)
+{
+  ASSERT_EQ(_codes.size(), _errors.size());
+  for (std::size_t i = 0; i < _codes.size(); ++i)
+  {
+    EXPECT_EQ(_codes[i], _errors[i].Code()) << _errors[i].Message();
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(SchemaValidator, Construction)
+{
+  sdf::SchemaValidator validator;
+  EXPECT_EQ(sdf::SDF::Version(), validator.Version());
+
+  sdf::SchemaValidator validator18("1.8");
+  EXPECT_EQ("1.8", validator18.Version());
+
+  sdf::SchemaValidator copy(validator18);
+  EXPECT_EQ("1.8", copy.Version());
+  sdf::SchemaValidator moved(std::move(copy));
+  EXPECT_EQ("1.8", moved.Version());
+  copy = validator;
+  EXPECT_EQ(sdf::SDF::Version(), copy.Version());
+
+  EXPECT_LT(100u, sdf::SchemaValidator::ElementTypeCount("1.8"));
+  EXPECT_EQ(0u, sdf::SchemaValidator::ElementTypeCount("0.1"));
+}
+
+/////////////////////////////////////////////////
+TEST(SchemaValidator, Valid)
+{
+  const std::string sdf = R"(<?xml version="1.0"?>
+  <sdf version="1.8" xmlns:custom="https://example.org">
+    <world name="default">
+      <gravity>0 0 -9.8</gravity>
+      <model name="m">
+        <pose relative_to="__model__">1 2 3 0 0 1.57</pose>
+        <static>true</static>
+        <link name="a">
+          <visual name="v">
+            <geometry><box><size>1 1 1</size></box></geometry>
+            <material><diffuse>1 0 0</diffuse></material>
+          </visual>
+          <custom:data><anything/></custom:data>
+        </link>
+        <link name="b"/>
+        <joint name="j" type="revolute">
+          <parent>a</parent>
+          <child>b</child>
+          <axis><xyz>0 0 1</xyz><limit><lower>-inf</lower></limit></axis>
+        </joint>
+        <joint name="ball" type="ball"/>
+        <plugin name="p" filename="p.so"><unknown a="1"/></plugin>
+      </model>
+    </world>
+  </sdf>)";
+
+  sdf::SchemaValidator validator;
+  sdf::Errors errors = validator.ValidateString(sdf);
+  EXPECT_TRUE(errors.empty()) << errors;
+  EXPECT_TRUE(sdf::SchemaValidator("1.8").ValidateString(sdf).empty());
+
+  // Bare fragments are validated as children of <sdf>.
+  EXPECT_TRUE(validator.ValidateString(
+      "<model name='m'><link name='l'/></model>").empty());
+
+  // Nested models have the type of <model>, and includes may have
+  // plugins.
+  EXPECT_TRUE(validator.ValidateString(R"(
+  <sdf version="1.8">
+    <model name="outer">
+      <model name="inner"><link name="l"/></model>
+      <include>
+        <uri>model://m</uri>
+        <plugin name="p" filename="p.so"/>
+      </include>
+    </model>
+  </sdf>)").empty());
+
+  const std::string path = sdf::filesystem::append(PROJECT_SOURCE_PATH,
+      "test", "integration", "model", "double_pendulum.sdf");
+  errors = validator.ValidateFile(path);
+  EXPECT_TRUE(errors.empty()) << errors;
+}
+
+/////////////////////////////////////////////////
+TEST(SchemaValidator, Invalid)
+{
+  const std::string sdf = R"(<?xml version="1.0"?>
+  <sdf version="1.8">
+    <world name="default">
+      <model name="m" weight="2">
+        <pose>1 2 3</pose>
+        <pose>0 0 0 0 0 0</pose>
+        <static>maybe</static>
+        <link name="l">
+          <bogus/>
+          <sensor name="c" type="camera">
+            <camera><horizontal_fov>0.01</horizontal_fov></camera>
+          </sensor>
+        </link>
+        <link/>
+        <joint name="j" type="fixed">
+          <parent>l</parent>
+        </joint>
+      </model>
+    </world>
+  </sdf>)";
+
+  sdf::Errors errors = sdf::SchemaValidator().ValidateString(sdf);
+  expectCodes(errors, {
+      sdf::ErrorCode::ATTRIBUTE_INVALID,
+      sdf::ErrorCode::ELEMENT_INVALID,
+      sdf::ErrorCode::ELEMENT_INVALID,
+      sdf::ErrorCode::ELEMENT_INVALID,
+      sdf::ErrorCode::ELEMENT_INVALID,
+      sdf::ErrorCode::ELEMENT_INVALID,
+      sdf::ErrorCode::ATTRIBUTE_MISSING,
+      sdf::ErrorCode::ELEMENT_MISSING});
+  EXPECT_EQ("/sdf/world/model (line 4): Attribute [weight] is not defined "
+      "for this element.", errors[0].Message());
+  EXPECT_EQ("/sdf/world/model/pose (line 5): Value [1 2 3] is not a valid "
+      "pose.", errors[1].Message());
+  EXPECT_NE(std::string::npos, errors[2].Message().find("at most once"));
+  EXPECT_NE(std::string::npos, errors[3].Message().find("[maybe]"));
+  EXPECT_NE(std::string::npos, errors[4].Message().find("<bogus>"));
+  EXPECT_NE(std::string::npos, errors[5].Message().find("out of the range"));
+  EXPECT_NE(std::string::npos, errors[7].Message().find("<child>"));
+
+  // The error budget of the configuration is used.
+  sdf::ParserConfig config;
+  config.SetMaxErrors(2u);
+  EXPECT_EQ(2u, sdf::SchemaValidator().ValidateString(sdf, config).size());
+
+  errors = sdf::SchemaValidator().ValidateString("<sdf version='1.8'>");
+  expectCodes(errors, {sdf::ErrorCode::STRING_READ});
+  errors = sdf::SchemaValidator().ValidateString("<bogus/>");
+  expectCodes(errors, {sdf::ErrorCode::ELEMENT_INVALID});
+  errors = sdf::SchemaValidator().ValidateFile("/no/such/file.sdf");
+  expectCodes(errors, {sdf::ErrorCode::FILE_READ});
+}
+
+/////////////////////////////////////////////////
+TEST(SchemaValidator, Version)
+{
+  // The relative_to attribute was added in 1.7.
+  const std::string sdf = R"(<?xml version="1.0"?>
+  <sdf version="1.6">
+    <model name="m">
+      <link name="l">
+        <pose frame="m">0 0 1 0 0 0</pose>
+      </link>
+      <link name="k">
+        <pose relative_to="l">0 0 1 0 0 0</pose>
+      </link>
+    </model>
+  </sdf>)";
+
+  // Older documents are converted to the version of the validator, where
+  // @frame is renamed to @relative_to.
+  sdf::Errors errors = sdf::SchemaValidator().ValidateString(sdf);
+  EXPECT_TRUE(errors.empty()) << errors;
+
+  errors = sdf::SchemaValidator("1.6").ValidateString(sdf);
+  expectCodes(errors, {sdf::ErrorCode::ATTRIBUTE_INVALID});
+  EXPECT_NE(std::string::npos, errors[0].Message().find("[relative_to]"));
+
+  // Newer and unknown versions can't be converted.
+  errors = sdf::SchemaValidator("1.5").ValidateString(sdf);
+  expectCodes(errors, {sdf::ErrorCode::ATTRIBUTE_INVALID});
+  EXPECT_NE(std::string::npos, errors[0].Message().find("[1.6]"));
+  errors = sdf::SchemaValidator().ValidateString(
+      "<sdf version='0.1'><model name='m'/></sdf>");
+  expectCodes(errors, {sdf::ErrorCode::ATTRIBUTE_INVALID});
+  errors = sdf::SchemaValidator("0.1").ValidateString(
+      "<model name='m'/>");
+  expectCodes(errors, {sdf::ErrorCode::ATTRIBUTE_INVALID});
+}
+
+/////////////////////////////////////////////////
+TEST(SchemaValidator, ElementTree)
+{
+  const std::string sdf = R"(<?xml version="1.0"?>
+  <sdf version="1.8">
+    <world name="default">
+      <model name="m">
+        <link name="l"/>
+      </model>
+    </world>
+  </sdf>)";
+
+  sdf::Root root;
+  ASSERT_TRUE(root.LoadSdfString(sdf).empty());
+  sdf::ElementPtr elem = root.Element();
+  ASSERT_NE(nullptr, elem);
+
+  // The elements added with their default, such as <physics>, are valid.
+  sdf::SchemaValidator validator;
+  sdf::Errors errors = validator.Validate(elem);
+  EXPECT_TRUE(errors.empty()) << errors;
+
+  sdf::ElementPtr model = elem->GetElement("world")->GetElement("model");
+  sdf::ElementPtr bogus(new sdf::Element);
+  bogus->SetName("bogus");
+  model->InsertElement(bogus);
+  errors = validator.Validate(model);
+  expectCodes(errors, {sdf::ErrorCode::ELEMENT_INVALID});
+  EXPECT_EQ("/model: Element <bogus> is not defined in SDFormat 1.8 as a "
+      "child of <model>.", errors[0].Message());
+
+  expectCodes(validator.Validate(nullptr), {sdf::ErrorCode::ELEMENT_MISSING});
+}
@@ -21,12 +21,14 @@
 #include <algorithm>
 #include <memory>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
 #include <ignition/math/Pose3.hh>
 #include <ignition/math/graph/Graph.hh>
 
+#include "sdf/Types.hh"
 #include "sdf/sdf_config.h"
 
 namespace sdf
@@ -138,6 +140,16 @@ class ScopedGraph
   /// \return A new child scope.
   public: ScopedGraph<T> ChildModelScope(const std::string &_name) const;
 
+  /// \brief Creates a scope anchored at an existing vertex, with the prefix
+  /// of the current scope. It restores the scope of a graph that was not
+  /// built by buildPoseRelativeToGraph or buildFrameAttachedToGraph, such as
+  /// a graph read from the load cache.
+  /// \param[in] _id Id of the scope vertex.
+  /// \param[in] _scopeTypeName Name of scope type (either __model__ or world)
+  /// \return A new scope.
+  public: ScopedGraph<T> VertexScope(const VertexId &_id,
+              const std::string &_scopeTypeName) const;
+
   /// \brief Checks if the scope points to a valid graph.
   /// \return True if the scope points to a valid graph.
   public: explicit operator bool() const;
@@ -150,6 +162,10 @@ class ScopedGraph
   /// FrameAttachedTo::map.
   public: const MapType &Map() const;
 
+  /// \brief Get the graph data structure this scope points to.
+  /// \return Reference to the PoseRelativeTo or FrameAttachedTo graph.
+  public: const T &GraphData() const;
+
   /// \brief Adds a scope vertex to the graph. This creates a new
   /// scope by making a copy of the current scope with a new prefix and scope
   /// type name. A new scope vertex is then added to the graph.
@@ -178,6 +194,14 @@ class ScopedGraph
   public: Edge &AddEdge(const ignition::math::graph::VertexId_P &_vertexPair,
               const EdgeType &_data);
 
+  /// \brief Removes a vertex, and the edges incident to it, from the graph.
+  /// \param[in] _id ID of the vertex to remove.
+  public: void RemoveVertex(const VertexId &_id);
+
+  /// \brief Removes an edge from the graph.
+  /// \param[in] _id ID of the edge to remove.
+  public: void RemoveEdge(const ignition::math::graph::EdgeId &_id);
+
   /// \brief Gets all the local names of the vertices in the current scope.
   /// \return A list of vertex names in the current scope.
   public: std::vector<std::string> VertexNames() const;
@@ -201,6 +225,16 @@ class ScopedGraph
   /// \param[in] _data The new data.
   public: void UpdateEdge(Edge &_edge, const EdgeType &_data);
 
+  /// \brief Replace the edges that point to a vertex with a single edge,
+  /// without marking the graph as modified, so that the data cached for
+  /// the graph is kept. The caller has to discard the cached data that
+  /// depends on the replaced edges.
+  /// \param[in] _vertexPair Pair of (tail, head) vertex IDs of the edge.
+  /// \param[in] _data Data of the edge.
+  public: void ReplaceIncomingEdges(
+      const ignition::math::graph::VertexId_P &_vertexPair,
+      const EdgeType &_data);
+
   /// \brief Count the number of vertices with a given local name in the scope.
   /// \param[in] _name Local name query
   /// \return Number of vertices that have the given local name in the scope.
@@ -247,6 +281,16 @@ class ScopedGraph
   public: std::pair<std::string, bool> FindAndRemovePrefix(
               const std::string &_name) const;
 
+  /// \brief Get the absolute name of a vertex for a lookup in the name map.
+  /// \param[in] _name Local name of the vertex.
+  /// \return The name with the prefix prepended. The returned reference is
+  /// only valid until the next call from the same thread.
+  private: const std::string &LookupName(const std::string &_name) const;
+
+  /// \brief Record a modification of the graph, so that the poses and
+  /// sink vertices cached for the graph are not reused.
+  private: void MarkModified();
+
   /// \brief Shared pointer to either a FrameAttachedToGraph or
   /// PoseRelativeToGraph.
   private: std::shared_ptr<T> graphPtr;
@@ -277,6 +321,19 @@ ScopedGraph<T> ScopedGraph<T>::ChildModelScope(const std::string &_name) const
   return newScopedGraph;
 }
 
+/////////////////////////////////////////////////
+template <typename T>
+ScopedGraph<T> ScopedGraph<T>::VertexScope(const VertexId &_id,
+    const std::string &_scopeTypeName) const
+{
+  auto newScopedGraph = *this;
+  newScopedGraph.dataPtr = std::make_shared<ScopedGraphData>();
+  newScopedGraph.dataPtr->prefix = this->dataPtr->prefix;
+  newScopedGraph.dataPtr->scopeVertexId = _id;
+  newScopedGraph.dataPtr->scopeContextName = _scopeTypeName;
+  return newScopedGraph;
+}
+
 /////////////////////////////////////////////////
 template <typename T>
 ScopedGraph<T>::operator bool() const
@@ -298,6 +355,20 @@ auto ScopedGraph<T>::Map() const -> const MapType &
   return this->graphPtr->map;
 }
 
+/////////////////////////////////////////////////
+template <typename T>
+const T &ScopedGraph<T>::GraphData() const
+{
+  return *this->graphPtr;
+}
+
+/////////////////////////////////////////////////
+template <typename T>
+void ScopedGraph<T>::MarkModified()
+{
+  ++this->graphPtr->version;
+}
+
 /////////////////////////////////////////////////
 template <typename T>
 ScopedGraph<T> ScopedGraph<T>::AddScopeVertex(const std::string &_prefix,
@@ -318,9 +389,10 @@ template <typename T>
 auto ScopedGraph<T>::AddVertex(
     const std::string &_name, const VertexType &_data) -> Vertex &
 {
-  const std::string newName = this->AddPrefix(_name);
+  std::string newName = this->AddPrefix(_name);
+  this->MarkModified();
   Vertex &vert = this->graphPtr->graph.AddVertex(newName, _data);
-  this->graphPtr->map[newName] = vert.Id();
+  this->graphPtr->map.insert_or_assign(std::move(newName), vert.Id());
   return vert;
 }
 
@@ -330,23 +402,61 @@ auto ScopedGraph<T>::AddEdge(
     const ignition::math::graph::VertexId_P &_vertexPair, const EdgeType &_data)
     -> Edge &
 {
+  this->MarkModified();
   Edge &edge = this->graphPtr->graph.AddEdge(_vertexPair, _data);
   return edge;
 }
 
+/////////////////////////////////////////////////
+template <typename T>
+void ScopedGraph<T>::RemoveVertex(const VertexId &_id)
+{
+  const Vertex &vert = this->Graph().VertexFromId(_id);
+  if (!vert.Valid())
+    return;
+
+  auto &map = this->graphPtr->map;
+  auto it = map.find(vert.Name());
+  if (it != map.end() && it->second == _id)
+    map.erase(it);
+  this->MarkModified();
+  this->graphPtr->graph.RemoveVertex(_id);
+}
+
+/////////////////////////////////////////////////
+template <typename T>
+void ScopedGraph<T>::RemoveEdge(const ignition::math::graph::EdgeId &_id)
+{
+  this->MarkModified();
+  this->graphPtr->graph.RemoveEdge(_id);
+}
+
 /////////////////////////////////////////////////
 template <typename T>
 std::vector<std::string> ScopedGraph<T>::VertexNames() const
 {
-  std::vector<std::string> out;
+  // The map is unordered, so the names are sorted by absolute name to keep
+  // the order, and the order of errors found while validating, stable.
+  std::vector<const std::string *> names;
   for (const auto &namePair : this->Map())
   {
-    const auto &idNamePair = this->FindAndRemovePrefix(namePair.first);
-    if (idNamePair.second)
+    if (this->FindAndRemovePrefix(namePair.first).second)
     {
-      out.push_back(idNamePair.first);
+      names.push_back(&namePair.first);
     }
   }
+  std::sort(names.begin(), names.end(),
+      [](const std::string *_a, const std::string *_b)
+      {
+        return *_a < *_b;
+      });
+
+  std::vector<std::string> out;
+  out.reserve(names.size());
+  for (const std::string *name : names)
+  {
+    out.push_back(this->FindAndRemovePrefix(*name).first);
+  }
   return out;
 }
 
@@ -373,10 +483,26 @@ void ScopedGraph<T>::UpdateEdge(Edge &_edge, const EdgeType &_data)
   auto tailVertexId = _edge.Tail();
   auto headVertexId = _edge.Head();
   auto &graph = this->graphPtr->graph;
+  this->MarkModified();
   graph.RemoveEdge(_edge.Id());
   _edge = graph.AddEdge({tailVertexId, headVertexId}, _data);
 }
 
+/////////////////////////////////////////////////
+template <typename T>
+void ScopedGraph<T>::ReplaceIncomingEdges(
+    const ignition::math::graph::VertexId_P &_vertexPair,
+    const EdgeType &_data)
+{
+  auto &graph = this->graphPtr->graph;
+  std::vector<ignition::math::graph::EdgeId> edges;
+  for (const auto &edgePair : graph.IncidentsTo(_vertexPair.second))
+    edges.push_back(edgePair.first);
+  for (const auto id : edges)
+    graph.RemoveEdge(id);
+  graph.AddEdge(_vertexPair, _data);
+}
+
 /////////////////////////////////////////////////
 template <typename T>
 const std::string &ScopedGraph<T>::ScopeContextName() const
@@ -395,7 +521,7 @@ void ScopedGraph<T>::SetScopeContextName(const std::string &_name)
 template <typename T>
 std::size_t ScopedGraph<T>::Count(const std::string &_name) const
 {
-  return this->graphPtr->map.count(this->AddPrefix(_name));
+  return this->graphPtr->map.count(this->LookupName(_name));
 }
 
 /////////////////////////////////////////////////
@@ -403,7 +529,7 @@ template <typename T>
 auto ScopedGraph<T>::VertexIdByName(const std::string &_name) const -> VertexId
 {
   auto &map = this->Map();
-  auto it = map.find(this->AddPrefix(_name));
+  auto it = map.find(this->LookupName(_name));
   if (it != map.end())
     return it->second;
   else
@@ -446,6 +572,25 @@ std::string ScopedGraph<T>::AddPrefix(const std::string &_name) const
   }
 }
 
+/////////////////////////////////////////////////
+template <typename T>
+const std::string &ScopedGraph<T>::LookupName(const std::string &_name) const
+{
+  if (this->dataPtr->prefix.empty())
+  {
+    return _name;
+  }
+
+  // Names are looked up far more often than vertices are added, so the
+  // absolute name is built in a buffer that keeps its capacity between
+  // lookups instead of in a new string.
+  thread_local std::string buffer;
+  buffer.assign(this->dataPtr->prefix);
+  buffer.append("::");
+  buffer.append(_name);
+  return buffer;
+}
+
 /////////////////////////////////////////////////
 template <typename T>
 std::pair<std::string, bool>
@@ -465,6 +610,25 @@ ScopedGraph<T>::FindAndRemovePrefix(const std::string &_name) const
   }
   return std::make_pair(_name, false);
 }
+
+/// \brief Graphs of one type built by Root::Load, listed in the same order
+/// as the worlds and the top-level models of the Root.
+/// \tparam T Either FrameAttachedTo or PoseRelativeTo graph
+template <typename T>
+struct RootGraphs
+{
+  /// \brief Graphs of the worlds.
+  std::vector<ScopedGraph<T>> worlds;
+
+  /// \brief Errors found while building each graph in worlds.
+  std::vector<Errors> worldBuildErrors;
+
+  /// \brief Graphs of the top-level models.
+  std::vector<ScopedGraph<T>> models;
+
+  /// \brief Errors found while building each graph in models.
+  std::vector<Errors> modelBuildErrors;
+};
 }
 }
 
@@ -0,0 +1,134 @@
+/*
+ * Copyright 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_SCOPED_NAME_INDEX_HH_
+#define SDF_SCOPED_NAME_INDEX_HH_
+
+#include <string>
+#include <unordered_map>
+
+#include "sdf/Frame.hh"
+#include "sdf/Joint.hh"
+#include "sdf/Link.hh"
+#include "sdf/Model.hh"
+#include "sdf/sdf_config.h"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief Flattened index of the entities of nested models by their
+  /// scoped name, such as "outer::inner::link".
+  ///
+  /// The index holds pointers into the DOM objects it was built from, so it
+  /// is not copied with its owner. Copies start out empty and have to be
+  /// rebuilt from the copied objects.
+  class ScopedNameIndex
+  {
+    /// \brief Constructor
+    public: ScopedNameIndex() = default;
+
+    /// \brief Copy constructor. The copy is empty.
+    /// \param[in] _index Index to copy.
+    public: ScopedNameIndex(const ScopedNameIndex &_index)
+    {
+      (void)_index;
+    }
+
+    /// \brief Copy assignment operator. Clears the index.
+    /// \param[in] _index Index to copy.
+    /// \return Reference to this.
+    public: ScopedNameIndex &operator=(const ScopedNameIndex &_index)
+    {
+      (void)_index;
+      this->Clear();
+      return *this;
+    }
+
+    /// \brief Remove all entries.
+    public: void Clear()
+    {
+      this->models.clear();
+      this->links.clear();
+      this->joints.clear();
+      this->frames.clear();
+    }
+
+    /// \brief Add a model and, recursively, all of its entities.
+    /// \param[in] _model Model to add.
+    /// \param[in] _scope Scope of the model, ending with "::", or empty.
+    public: void AddModel(const Model &_model, const std::string &_scope)
+    {
+      const std::string name = _scope + _model.Name();
+      this->models.emplace(name, &_model);
+      this->AddContent(_model, name + "::");
+    }
+
+    /// \brief Add the entities of a model, recursively, without the model
+    /// itself.
+    /// \param[in] _model Model whose entities are added.
+    /// \param[in] _scope Scope of the entities, ending with "::".
+    public: void AddContent(const Model &_model, const std::string &_scope)
+    {
+      for (uint64_t i = 0; i < _model.LinkCount(); ++i)
+      {
+        const Link *link = _model.LinkByIndex(i);
+        this->links.emplace(_scope + link->Name(), link);
+      }
+      for (uint64_t i = 0; i < _model.JointCount(); ++i)
+      {
+        const Joint *joint = _model.JointByIndex(i);
+        this->joints.emplace(_scope + joint->Name(), joint);
+      }
+      for (uint64_t i = 0; i < _model.FrameCount(); ++i)
+      {
+        const Frame *frame = _model.FrameByIndex(i);
+        this->frames.emplace(_scope + frame->Name(), frame);
+      }
+      for (uint64_t i = 0; i < _model.ModelCount(); ++i)
+        this->AddModel(*_model.ModelByIndex(i), _scope);
+    }
+
+    /// \brief Find an entry by scoped name.
+    /// \param[in] _map One of the maps of the index.
+    /// \param[in] _name Scoped name.
+    /// \return The entity, or nullptr if it is not in the index.
+    public: template <typename T>
+            static const T *Find(
+                const std::unordered_map<std::string, const T *> &_map,
+                const std::string &_name)
+    {
+      auto it = _map.find(_name);
+      return it == _map.end() ? nullptr : it->second;
+    }
+
+    /// \brief Models by scoped name.
+    public: std::unordered_map<std::string, const Model *> models;
+
+    /// \brief Links by scoped name.
+    public: std::unordered_map<std::string, const Link *> links;
+
+    /// \brief Joints by scoped name.
+    public: std::unordered_map<std::string, const Joint *> joints;
+
+    /// \brief Frames by scoped name.
+    public: std::unordered_map<std::string, const Frame *> frames;
+  };
+  }
+}
+#endif
@@ -130,17 +130,11 @@ Errors SemanticPose::Resolve(
     return errors;
   }
 
-  std::string relativeTo = this->dataPtr->relativeTo;
-  if (relativeTo.empty())
-  {
-    relativeTo = this->dataPtr->defaultResolveTo;
-  }
+  const std::string &relativeTo = this->dataPtr->relativeTo.empty() ?
+      this->dataPtr->defaultResolveTo : this->dataPtr->relativeTo;
 
-  std::string resolveTo = _resolveTo;
-  if (resolveTo.empty())
-  {
-    resolveTo = this->dataPtr->defaultResolveTo;
-  }
+  const std::string &resolveTo = _resolveTo.empty() ?
+      this->dataPtr->defaultResolveTo : _resolveTo;
 
   ignition::math::Pose3d pose;
   if (this->dataPtr->name.empty())
@@ -160,5 +154,41 @@ Errors SemanticPose::Resolve(
 
   return errors;
 }
+/////////////////////////////////////////////////
+Errors SemanticPose::Resolve(
+    ignition::math::Pose3d &_pose,
+    const PoseGraphSnapshot &_snapshot,
+    const std::string &_resolveTo) const
+{
+  const auto &graph = this->dataPtr->poseRelativeToGraph;
+  if (!graph)
+  {
+    return {Error(ErrorCode::POSE_RELATIVE_TO_GRAPH_ERROR,
+        "SemanticPose has invalid pointer to PoseRelativeToGraph.")};
+  }
+
+  const std::string &relativeTo = this->dataPtr->relativeTo.empty() ?
+      this->dataPtr->defaultResolveTo : this->dataPtr->relativeTo;
+
+  const std::string &resolveTo = _resolveTo.empty() ?
+      this->dataPtr->defaultResolveTo : _resolveTo;
+
+  ignition::math::Pose3d pose;
+  Errors errors = _snapshot.ResolveGraphFrames(pose, graph.GraphData(),
+      graph.AddPrefix(this->dataPtr->name.empty() ?
+          relativeTo : this->dataPtr->name),
+      graph.AddPrefix(resolveTo));
+  if (this->dataPtr->name.empty())
+  {
+    pose *= this->RawPose();
+  }
+
+  if (errors.empty())
+  {
+    _pose = pose;
+  }
+
+  return errors;
+}
 }  // inline namespace
 }  // namespace sdf
@@ -28,7 +28,10 @@
 #include "sdf/Lidar.hh"
 #include "sdf/Sensor.hh"
 #include "sdf/Types.hh"
+#include "ElementRetentionScope.hh"
 #include "FrameSemantics.hh"
+#include "LoadStatsScope.hh"
+#include "MemoryAccounting.hh"
 #include "ScopedGraph.hh"
 #include "Utils.hh"
 
@@ -256,9 +259,10 @@ bool Sensor::operator!=(const Sensor &_sensor) const
 /////////////////////////////////////////////////
 Errors Sensor::Load(ElementPtr _sdf)
 {
+  DomLoadTimer timer("Sensor");
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that sdf is a valid pointer
   if (!_sdf)
@@ -641,3 +645,10 @@ const Imu *Sensor::ImuSensor() const
 {
   return this->dataPtr->imu.get();
 }
+
+/////////////////////////////////////////////////
+template <>
+std::size_t sdf::domPrivateSize<Sensor>()
+{
+  return sizeof(SensorPrivate);
+}
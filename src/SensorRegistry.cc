@@ -0,0 +1,197 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "sdf/Link.hh"
+#include "sdf/Model.hh"
+#include "sdf/SensorRegistry.hh"
+
+#include "Tracing.hh"
+
+using namespace sdf;
+
+/// \brief Private data for SensorRegistry
+class sdf::SensorRegistryPrivate
+{
+  /// \brief Add the sensors of a model and of its nested models.
+  /// \param[in] _model The model.
+  /// \param[in] _scope Scope of the model, ending with "::", or empty.
+  /// \param[out] _sensors Sensors, in the order of the world.
+  public: void AddModel(const Model &_model, const std::string &_scope,
+              std::vector<SensorRegistryEntry> &_sensors);
+
+  /// \brief The sensors, type by type.
+  public: std::vector<SensorRegistryEntry> sensors;
+
+  /// \brief The links that have sensors.
+  public: std::vector<SensorRegistryLink> links;
+
+  /// \brief Offset in sensors of the sensors of each type, with one more
+  /// offset for the end of the last type.
+  public: std::vector<std::size_t> typeOffsets;
+
+  /// \brief Index in sensors of each sensor by scoped name.
+  public: std::unordered_map<std::string, std::size_t> sensorIndex;
+};
+
+/////////////////////////////////////////////////
+void SensorRegistryPrivate::AddModel(const Model &_model,
+    const std::string &_scope, std::vector<SensorRegistryEntry> &_sensors)
+{
+  const std::string scope = _scope + _model.Name() + "::";
+  for (const Link &link : _model.Links())
+  {
+    if (link.SensorCount() == 0u)
+      continue;
+
+    const std::size_t linkIndex = this->links.size();
+    this->links.push_back({scope + link.Name(), &link});
+    for (const Sensor &sensor : link.Sensors())
+    {
+      _sensors.push_back(
+          {this->links.back().name + "::" + sensor.Name(), &sensor,
+           linkIndex});
+    }
+  }
+
+  for (const Model &model : _model.Models())
+    this->AddModel(model, scope, _sensors);
+}
+
+/////////////////////////////////////////////////
+SensorRegistry::SensorRegistry()
+  : dataPtr(new SensorRegistryPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+SensorRegistry::SensorRegistry(const SensorRegistry &_registry)
+  : dataPtr(new SensorRegistryPrivate(*_registry.dataPtr))
+{
+}
+
+/////////////////////////////////////////////////
+SensorRegistry::SensorRegistry(SensorRegistry &&_registry) noexcept
+  : dataPtr(std::exchange(_registry.dataPtr, nullptr))
+{
+}
+
+/////////////////////////////////////////////////
+SensorRegistry &SensorRegistry::operator=(SensorRegistry &&_registry) noexcept
+{
+  std::swap(this->dataPtr, _registry.dataPtr);
+  return *this;
+}
+
+/////////////////////////////////////////////////
+SensorRegistry &SensorRegistry::operator=(const SensorRegistry &_registry)
+{
+  return *this = SensorRegistry(_registry);
+}
+
+/////////////////////////////////////////////////
+SensorRegistry::~SensorRegistry()
+{
+  delete this->dataPtr;
+  this->dataPtr = nullptr;
+}
+
+/////////////////////////////////////////////////
+void SensorRegistry::Build(Span<const Model> _models)
+{
+  SDF_TRACE_SCOPE("SensorRegistry::Build");
+  SensorRegistryPrivate &data = *this->dataPtr;
+  data.sensors.clear();
+  data.links.clear();
+  data.typeOffsets.clear();
+  data.sensorIndex.clear();
+
+  std::vector<SensorRegistryEntry> sensors;
+  for (const Model &model : _models)
+    data.AddModel(model, "", sensors);
+  if (sensors.empty())
+    return;
+
+  // Group the sensors by type with a counting sort, which keeps the order
+  // of the world within each type.
+  std::size_t typeCount = 0;
+  for (const SensorRegistryEntry &entry : sensors)
+  {
+    typeCount = std::max(typeCount,
+        static_cast<std::size_t>(entry.sensor->Type()) + 1u);
+  }
+  data.typeOffsets.assign(typeCount + 1u, 0u);
+  for (const SensorRegistryEntry &entry : sensors)
+    ++data.typeOffsets[static_cast<std::size_t>(entry.sensor->Type()) + 1u];
+  for (std::size_t i = 1; i < data.typeOffsets.size(); ++i)
+    data.typeOffsets[i] += data.typeOffsets[i - 1];
+
+  std::vector<std::size_t> next(data.typeOffsets.begin(),
+      data.typeOffsets.end() - 1);
+  data.sensors.resize(sensors.size());
+  for (SensorRegistryEntry &entry : sensors)
+  {
+    const std::size_t type = static_cast<std::size_t>(entry.sensor->Type());
+    data.sensors[next[type]++] = std::move(entry);
+  }
+
+  // The first sensor with a name keeps it, like the DOM lookups by name.
+  data.sensorIndex.reserve(data.sensors.size());
+  for (std::size_t i = 0; i < data.sensors.size(); ++i)
+    data.sensorIndex.emplace(data.sensors[i].name, i);
+}
+
+/////////////////////////////////////////////////
+Span<const SensorRegistryEntry> SensorRegistry::Sensors() const
+{
+  return Span<const SensorRegistryEntry>(this->dataPtr->sensors.data(),
+      this->dataPtr->sensors.size());
+}
+
+/////////////////////////////////////////////////
+Span<const SensorRegistryEntry> SensorRegistry::SensorsOfType(
+    SensorType _type) const
+{
+  const std::vector<std::size_t> &offsets = this->dataPtr->typeOffsets;
+  const std::size_t type = static_cast<std::size_t>(_type);
+  if (type + 1u >= offsets.size())
+    return Span<const SensorRegistryEntry>();
+  return Span<const SensorRegistryEntry>(
+      this->dataPtr->sensors.data() + offsets[type],
+      offsets[type + 1u] - offsets[type]);
+}
+
+/////////////////////////////////////////////////
+std::size_t SensorRegistry::SensorByScopedName(const std::string &_name) const
+{
+  auto iter = this->dataPtr->sensorIndex.find(_name);
+  return iter == this->dataPtr->sensorIndex.end() ? kInvalidIndex :
+      iter->second;
+}
+
+/////////////////////////////////////////////////
+Span<const SensorRegistryLink> SensorRegistry::Links() const
+{
+  return Span<const SensorRegistryLink>(this->dataPtr->links.data(),
+      this->dataPtr->links.size());
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <string>
+#include "sdf/Link.hh"
+#include "sdf/Model.hh"
+#include "sdf/Root.hh"
+#include "sdf/SensorRegistry.hh"
+#include "sdf/World.hh"
+
+/////////////////////////////////////////////////
+TEST(DOMSensorRegistry, Construction)
+{
+  sdf::SensorRegistry registry;
+  EXPECT_EQ(0u, registry.Sensors().Size());
+  EXPECT_EQ(0u, registry.Links().Size());
+  EXPECT_EQ(0u, registry.SensorsOfType(sdf::SensorType::CAMERA).Size());
+  EXPECT_EQ(sdf::SensorRegistry::kInvalidIndex,
+      registry.SensorByScopedName("m::l::s"));
+
+  sdf::World world;
+  EXPECT_EQ(0u, world.Sensors().Sensors().Size());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMSensorRegistry, World)
+{
+  const std::string sdfString = R"(
+  <sdf version="1.8">
+    <world name="default">
+      <model name="robot">
+        <link name="base">
+          <sensor name="imu" type="imu"/>
+          <sensor name="front" type="camera"/>
+          <sensor name="alt" type="altimeter"/>
+        </link>
+        <link name="plain"/>
+        <model name="head">
+          <link name="l">
+            <sensor name="eye" type="camera"/>
+          </link>
+        </model>
+        <link name="back">
+          <sensor name="rear" type="camera"/>
+        </link>
+      </model>
+      <model name="box">
+        <link name="l">
+          <sensor name="imu" type="imu"/>
+        </link>
+      </model>
+    </world>
+  </sdf>)";
+
+  sdf::Root root;
+  ASSERT_TRUE(root.LoadSdfString(sdfString).empty());
+  const sdf::World *world = root.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+  const sdf::SensorRegistry &registry = world->Sensors();
+
+  // Links with sensors, links of a model before its nested models.
+  auto links = registry.Links();
+  ASSERT_EQ(4u, links.Size());
+  EXPECT_EQ("robot::base", links[0].name);
+  EXPECT_EQ("robot::back", links[1].name);
+  EXPECT_EQ("robot::head::l", links[2].name);
+  EXPECT_EQ("box::l", links[3].name);
+  EXPECT_EQ(world->LinkByScopedName("robot::head::l"), links[2].link);
+
+  // Sensors grouped by type, in the order of the world.
+  EXPECT_EQ(6u, registry.Sensors().Size());
+  auto cameras = registry.SensorsOfType(sdf::SensorType::CAMERA);
+  ASSERT_EQ(3u, cameras.Size());
+  EXPECT_EQ("robot::base::front", cameras[0].name);
+  EXPECT_EQ(0u, cameras[0].link);
+  EXPECT_EQ("robot::back::rear", cameras[1].name);
+  EXPECT_EQ(1u, cameras[1].link);
+  EXPECT_EQ("robot::head::l::eye", cameras[2].name);
+  EXPECT_EQ(2u, cameras[2].link);
+  EXPECT_EQ(links[2].link->SensorByName("eye"), cameras[2].sensor);
+
+  auto imus = registry.SensorsOfType(sdf::SensorType::IMU);
+  ASSERT_EQ(2u, imus.Size());
+  EXPECT_EQ("robot::base::imu", imus[0].name);
+  EXPECT_EQ("box::l::imu", imus[1].name);
+  EXPECT_EQ(3u, imus[1].link);
+  EXPECT_EQ(1u, registry.SensorsOfType(sdf::SensorType::ALTIMETER).Size());
+  EXPECT_EQ(0u, registry.SensorsOfType(sdf::SensorType::LIDAR).Size());
+  EXPECT_EQ(0u,
+      registry.SensorsOfType(sdf::SensorType::THERMAL_CAMERA).Size());
+
+  const std::size_t eye = registry.SensorByScopedName("robot::head::l::eye");
+  ASSERT_NE(sdf::SensorRegistry::kInvalidIndex, eye);
+  EXPECT_EQ(cameras[2].sensor, registry.Sensors()[eye].sensor);
+  EXPECT_EQ(sdf::SensorRegistry::kInvalidIndex,
+      registry.SensorByScopedName("robot::head::eye"));
+
+  // A copy of the world has a registry of its own models.
+  sdf::World copy(*world);
+  auto copyCameras = copy.Sensors().SensorsOfType(sdf::SensorType::CAMERA);
+  ASSERT_EQ(3u, copyCameras.Size());
+  EXPECT_EQ("robot::head::l::eye", copyCameras[2].name);
+  EXPECT_EQ(copy.LinkByScopedName("robot::head::l")->SensorByName("eye"),
+      copyCameras[2].sensor);
+  EXPECT_NE(cameras[2].sensor, copyCameras[2].sensor);
+}
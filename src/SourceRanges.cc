@@ -0,0 +1,109 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "SourceRanges.hh"
+#include "XmlStreamReader.hh"
+
+using namespace sdf;
+
+/////////////////////////////////////////////////
+bool SourceRanges::Build(const char *_data, std::size_t _size,
+    const tinyxml2::XMLDocument &_doc, const TextRange &_origin)
+{
+  this->ranges.clear();
+
+  // The offsets of the tags only increase, so lines and columns are
+  // counted from one tag to the next.
+  const char *counted = _data;
+  unsigned int line = _origin.beginLine;
+  unsigned int column = _origin.beginColumn;
+  auto locate = [&](std::size_t _offset, std::size_t &_position,
+      unsigned int &_line, unsigned int &_column)
+  {
+    Advance(counted, _data + _offset, line, column);
+    counted = _data + _offset;
+    _position = _origin.begin + _offset;
+    _line = line;
+    _column = column;
+  };
+
+  // References to the elements of an unordered_map stay valid as it grows.
+  std::vector<std::pair<const tinyxml2::XMLElement *, TextRange *>> open;
+  const tinyxml2::XMLElement *next = _doc.FirstChildElement();
+  XmlStreamReader reader(_data, _size);
+  while (true)
+  {
+    const XmlStreamReader::Token token = reader.Next();
+    if (token == XmlStreamReader::Token::START)
+    {
+      if (!next || reader.Name() != next->Value())
+        break;
+      TextRange &range = this->ranges[next];
+      locate(reader.TagOffset(), range.begin, range.beginLine,
+          range.beginColumn);
+      open.emplace_back(next, &range);
+      next = next->FirstChildElement();
+    }
+    else if (token == XmlStreamReader::Token::END && !open.empty())
+    {
+      TextRange &range = *open.back().second;
+      locate(reader.Offset(), range.end, range.endLine, range.endColumn);
+      next = open.back().first->NextSiblingElement();
+      open.pop_back();
+    }
+    else
+    {
+      if (token == XmlStreamReader::Token::END_OF_DOCUMENT && open.empty())
+        return true;
+      break;
+    }
+  }
+
+  this->ranges.clear();
+  return false;
+}
+
+/////////////////////////////////////////////////
+const TextRange *SourceRanges::Find(const tinyxml2::XMLElement *_xml) const
+{
+  auto iter = this->ranges.find(_xml);
+  return iter == this->ranges.end() ? nullptr : &iter->second;
+}
+
+/////////////////////////////////////////////////
+void SourceRanges::Advance(const char *_begin, const char *_end,
+    unsigned int &_line, unsigned int &_column)
+{
+  const char *lineStart = nullptr;
+  for (const char *c = _begin; c < _end; ++c)
+  {
+    c = static_cast<const char *>(std::memchr(c, '\n', _end - c));
+    if (!c)
+      break;
+    ++_line;
+    lineStart = c + 1;
+  }
+
+  if (lineStart)
+    _column = 1u + static_cast<unsigned int>(_end - lineStart);
+  else
+    _column += static_cast<unsigned int>(_end - _begin);
+}
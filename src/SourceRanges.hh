@@ -0,0 +1,123 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_SOURCE_RANGES_HH_
+#define SDF_SOURCE_RANGES_HH_
+
+#include <tinyxml2.h>
+
+#include <cstddef>
+#include <unordered_map>
+
+#include "sdf/Element.hh"
+#include "sdf/Error.hh"
+#include "sdf/ParserConfig.hh"
+#include "sdf/TextRange.hh"
+#include "sdf/sdf_config.h"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief Ranges of the text of the elements of a tinyxml2 document,
+  /// which tinyxml2 doesn't keep. They are found by reading the text again
+  /// with an XmlStreamReader, whose tags come in the order of the elements
+  /// of the document. The parser sets them on the elements it reads, see
+  /// ParserConfig::SetRecordSourceRanges.
+  class SourceRanges
+  {
+    /// \brief Find the ranges of the elements of a document.
+    /// \param[in] _data Text the document was parsed from.
+    /// \param[in] _size Size of the text in bytes.
+    /// \param[in] _doc Document parsed from the text.
+    /// \param[in] _origin Position of the start of the text, in the
+    /// document it is part of: begin, beginLine and beginColumn are used.
+    /// \return False if the tags of the text don't match the elements of
+    /// the document, in which case no range is kept.
+    public: bool Build(const char *_data, std::size_t _size,
+                const tinyxml2::XMLDocument &_doc, const TextRange &_origin);
+
+    /// \brief Get the range of an element.
+    /// \param[in] _xml Element of the document.
+    /// \return The range, or nullptr if the element has none.
+    public: const TextRange *Find(const tinyxml2::XMLElement *_xml) const;
+
+    /// \brief Move a line and column forward over a range of text.
+    /// \param[in] _begin First character of the range.
+    /// \param[in] _end One past the last character of the range.
+    /// \param[in,out] _line Line of _begin, set to the line of _end.
+    /// \param[in,out] _column Column of _begin, set to the column of _end.
+    public: static void Advance(const char *_begin, const char *_end,
+                unsigned int &_line, unsigned int &_column);
+
+    /// \brief Read the text of an element as a child of another element,
+    /// the way readXml reads the children of an element, including an
+    /// <include>, and record the ranges of the elements read. This is
+    /// implemented by the parser, next to readXml.
+    /// \param[in] _data Text of the element.
+    /// \param[in] _size Size of the text in bytes.
+    /// \param[in] _origin Position of the start of the text in the
+    /// document, as for Build.
+    /// \param[in] _parent Element the text is a child of. It isn't modified.
+    /// \param[in] _config Parser configuration.
+    /// \param[out] _errors Errors found while reading.
+    /// \return The element, without a parent, or nullptr if the text isn't
+    /// one element that could be read.
+    public: static ElementPtr Read(const char *_data, std::size_t _size,
+                const TextRange &_origin, const ElementPtr &_parent,
+                const ParserConfig &_config, Errors &_errors);
+
+    /// \brief Range of each element.
+    private: std::unordered_map<const tinyxml2::XMLElement *, TextRange>
+                 ranges;
+  };
+
+  /// \brief Makes the parser set the ranges of a SourceRanges object on the
+  /// elements it reads on the current thread while this scope is alive. The
+  /// previous ranges are restored when the scope is destroyed.
+  class SourceRangeScope
+  {
+    /// \brief Constructor
+    /// \param[in] _ranges Ranges to set, or nullptr for none.
+    public: explicit SourceRangeScope(const SourceRanges *_ranges)
+      : previous(Current())
+    {
+      Current() = _ranges;
+    }
+
+    /// \brief Destructor
+    public: ~SourceRangeScope()
+    {
+      Current() = this->previous;
+    }
+
+    /// \brief Get the ranges of the current thread.
+    /// \return Reference to the ranges, which are nullptr when they are not
+    /// recorded.
+    public: static const SourceRanges *&Current()
+    {
+      static thread_local const SourceRanges *current = nullptr;
+      return current;
+    }
+
+    /// \brief Ranges that were current before this scope.
+    private: const SourceRanges *previous;
+  };
+  }
+}
+#endif
@@ -0,0 +1,149 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef SDF_SPECTABLES_HH_
+#define SDF_SPECTABLES_HH_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+#include "sdf/Types.hh"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \internal
+
+  /// Offset of a string that is not set, such as the ref of an element
+  /// that has none.
+  constexpr std::uint32_t kSpecNoString = 0xFFFFFFFF;
+
+  /// Index of the element of a child that is an include.
+  constexpr std::uint32_t kSpecNoElement = 0xFFFFFFFF;
+
+  /// Root element of a spec file, such as "root.sdf" of version "1.8".
+  struct SpecFile
+  {
+    std::uint32_t version;
+    std::uint32_t filename;
+    std::uint32_t root;
+  };
+
+  /// An <element> of a spec file. Strings are offsets in the string table,
+  /// and attributes and children are ranges of their tables.
+  struct SpecElement
+  {
+    std::uint32_t name;
+    std::uint32_t required;
+    std::uint32_t ref;
+    std::uint32_t type;
+    std::uint32_t defaultValue;
+    std::uint32_t minValue;
+    std::uint32_t maxValue;
+    std::uint32_t description;
+    bool valueRequired;
+    bool copyChildren;
+    std::uint32_t firstAttribute;
+    std::uint32_t attributeCount;
+    std::uint32_t firstChild;
+    std::uint32_t childCount;
+  };
+
+  /// An <attribute> of an element.
+  struct SpecAttribute
+  {
+    std::uint32_t name;
+    std::uint32_t type;
+    std::uint32_t defaultValue;
+    std::uint32_t description;
+    bool required;
+  };
+
+  /// A child <element> or <include> of an element. Includes have no element
+  /// index, but the name of the included file, the description that
+  /// overrides its own, if any, and the cardinality written on the include.
+  /// The parser uses the cardinality of the root element of the included
+  /// file instead, as initXml does.
+  struct SpecChild
+  {
+    std::uint32_t element;
+    std::uint32_t includeFilename;
+    std::uint32_t includeDescription;
+    std::uint32_t includeRequired;
+  };
+
+  /// The descriptions of all the supported spec files, generated from the
+  /// *.sdf files by sdf/specTables.rb. The files are sorted by version and
+  /// file name.
+  struct SpecTables
+  {
+    const char *strings;
+    const SpecFile *files;
+    std::size_t fileCount;
+    const SpecElement *elements;
+    const SpecAttribute *attributes;
+    const SpecChild *children;
+
+    /// Get a string of the string table.
+    /// \param[in] _offset Offset of the string.
+    /// \return The string, or an empty string if it is not set.
+    const char *String(std::uint32_t _offset) const
+    {
+      return _offset == kSpecNoString ? "" : this->strings + _offset;
+    }
+
+    /// Find the root element of a spec file.
+    /// \param[in] _version Spec version, such as "1.8".
+    /// \param[in] _filename Base name of the spec file, such as "root.sdf".
+    /// \return The root element, or nullptr if the tables don't have the
+    /// file.
+    const SpecElement *FindFile(const char *_version,
+        const char *_filename) const
+    {
+      const SpecFile *begin = this->files;
+      const SpecFile *end = begin + this->fileCount;
+      auto less = [this](const SpecFile &_file,
+          const std::pair<const char *, const char *> &_key)
+      {
+        const int cmp = std::strcmp(this->String(_file.version), _key.first);
+        return cmp < 0 ||
+            (cmp == 0 && std::strcmp(this->String(_file.filename),
+                                     _key.second) < 0);
+      };
+
+      const auto key = std::make_pair(_version, _filename);
+      const SpecFile *file = std::lower_bound(begin, end, key, less);
+      if (file == end ||
+          std::strcmp(_version, this->String(file->version)) != 0 ||
+          std::strcmp(_filename, this->String(file->filename)) != 0)
+      {
+        return nullptr;
+      }
+      return &this->elements[file->root];
+    }
+  };
+
+  const SpecTables &GetSpecTables();
+}
+}
+#endif
@@ -15,6 +15,8 @@
  *
 */
 #include "sdf/Sphere.hh"
+#include "ElementRetentionScope.hh"
+#include "LoadStatsScope.hh"
 
 using namespace sdf;
 
@@ -71,9 +73,10 @@ Sphere &Sphere::operator=(Sphere &&_sphere)
 /////////////////////////////////////////////////
 Errors Sphere::Load(ElementPtr _sdf)
 {
+  DomLoadTimer timer("Sphere");
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that sdf is a valid pointer
   if (!_sdf)
@@ -145,3 +148,18 @@ sdf::ElementPtr Sphere::Element() const
 {
   return this->dataPtr->sdf;
 }
+
+/////////////////////////////////////////////////
+ignition::math::AxisAlignedBox Sphere::AxisAlignedBox() const
+{
+  const double radius = this->Radius();
+  return ignition::math::AxisAlignedBox(
+      ignition::math::Vector3d(-radius, -radius, -radius),
+      ignition::math::Vector3d(radius, radius, radius));
+}
+
+/////////////////////////////////////////////////
+double Sphere::BoundingRadius() const
+{
+  return this->Radius();
+}
@@ -0,0 +1,691 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <locale.h>
+
+#include <tinyxml2.h>
+
+#include "sdf/StateReader.hh"
+
+#include "NumberParsing.hh"
+
+using namespace sdf;
+
+/// \brief Number of bytes read from the stream at a time.
+static constexpr std::size_t kReadBlockSize = 1u << 20;
+
+/// \brief Returned by the name accessors for an out of range index.
+static const std::string kEmptyString;
+
+/// \brief Private data for sdf::StateFrame
+class sdf::StateFramePrivate
+{
+  /// \brief Add a model, reusing the storage of an earlier frame.
+  /// \param[in] _name Scoped name of the model.
+  /// \param[in] _parent Index of the parent model.
+  /// \return Index of the model.
+  public: std::size_t AddModel(const std::string &_name, std::size_t _parent)
+  {
+    const std::size_t index = this->modelCount++;
+    if (index == this->modelNames.size())
+    {
+      this->modelNames.push_back(_name);
+      this->modelParents.push_back(_parent);
+      this->modelPoses.push_back(ignition::math::Pose3d::Zero);
+    }
+    else
+    {
+      this->modelNames[index].assign(_name);
+      this->modelParents[index] = _parent;
+      this->modelPoses[index] = ignition::math::Pose3d::Zero;
+    }
+    return index;
+  }
+
+  /// \brief Add a link, reusing the storage of an earlier frame.
+  /// \param[in] _name Scoped name of the link.
+  /// \param[in] _model Index of the model that contains the link.
+  /// \return Index of the link.
+  public: std::size_t AddLink(const std::string &_name, std::size_t _model)
+  {
+    const std::size_t index = this->linkCount++;
+    if (index == this->linkNames.size())
+    {
+      this->linkNames.push_back(_name);
+      this->linkModels.push_back(_model);
+      this->linkPoses.push_back(ignition::math::Pose3d::Zero);
+      this->linkVelocities.push_back(ignition::math::Pose3d::Zero);
+    }
+    else
+    {
+      this->linkNames[index].assign(_name);
+      this->linkModels[index] = _model;
+      this->linkPoses[index] = ignition::math::Pose3d::Zero;
+      this->linkVelocities[index] = ignition::math::Pose3d::Zero;
+    }
+    return index;
+  }
+
+  /// \brief Name of the world.
+  public: std::string worldName;
+
+  /// \brief Simulation time.
+  public: sdf::Time simTime;
+
+  /// \brief Wall time.
+  public: sdf::Time wallTime;
+
+  /// \brief Real time.
+  public: sdf::Time realTime;
+
+  /// \brief Number of iterations.
+  public: std::uint64_t iterations = 0u;
+
+  /// \brief Number of models in use. The arrays can be larger.
+  public: std::size_t modelCount = 0u;
+
+  /// \brief Scoped model names.
+  public: std::vector<std::string> modelNames;
+
+  /// \brief Index of the parent of each model.
+  public: std::vector<std::size_t> modelParents;
+
+  /// \brief Model poses.
+  public: std::vector<ignition::math::Pose3d> modelPoses;
+
+  /// \brief Number of links in use. The arrays can be larger.
+  public: std::size_t linkCount = 0u;
+
+  /// \brief Scoped link names.
+  public: std::vector<std::string> linkNames;
+
+  /// \brief Index of the model of each link.
+  public: std::vector<std::size_t> linkModels;
+
+  /// \brief Link poses.
+  public: std::vector<ignition::math::Pose3d> linkPoses;
+
+  /// \brief Link velocities.
+  public: std::vector<ignition::math::Pose3d> linkVelocities;
+};
+
+/// \brief Private data for sdf::StateReader
+class sdf::StateReaderPrivate
+{
+  /// \brief Read another block from the stream into the buffer.
+  public: void ReadBlock()
+  {
+    const std::size_t size = this->buffer.size();
+    this->buffer.resize(size + kReadBlockSize);
+    this->input->read(&this->buffer[size],
+        static_cast<std::streamsize>(kReadBlockSize));
+    const auto bytesRead = static_cast<std::size_t>(this->input->gcount());
+    this->buffer.resize(size + bytesRead);
+    if (!*this->input || bytesRead == 0u)
+      this->eof = true;
+  }
+
+  /// \brief Drop the buffered text before an offset.
+  /// \param[in] _offset First offset to keep.
+  public: void Discard(std::size_t _offset)
+  {
+    this->buffer.erase(0, _offset);
+    this->pos = 0u;
+  }
+
+  /// \brief Find the start tag of the next state in the buffer.
+  /// \param[out] _keep First offset that has to be kept if no state start
+  /// was found, because it could be a partial start tag.
+  /// \return Offset of the start tag, or std::string::npos.
+  public: std::size_t FindStart(std::size_t &_keep) const
+  {
+    static const char kTag[] = "<state";
+    const std::size_t tagSize = sizeof(kTag) - 1;
+
+    std::size_t p = this->buffer.find(kTag, this->pos);
+    while (p != std::string::npos)
+    {
+      if (p + tagSize == this->buffer.size())
+      {
+        _keep = p;
+        return std::string::npos;
+      }
+      const char next = this->buffer[p + tagSize];
+      if (next == '>' || next == '/' || IsClassicSpace(next))
+        return p;
+      p = this->buffer.find(kTag, p + 1);
+    }
+
+    _keep = this->buffer.size() > this->pos + tagSize ?
+      this->buffer.size() - tagSize : this->pos;
+    return std::string::npos;
+  }
+
+  /// \brief Find the end of the state that starts at an offset.
+  /// \param[in] _start Offset of the start tag.
+  /// \return Offset past the end tag, or std::string::npos if the state
+  /// is not complete in the buffer.
+  public: std::size_t FindEnd(std::size_t _start) const
+  {
+    const std::size_t gt = this->buffer.find('>', _start);
+    if (gt == std::string::npos)
+      return std::string::npos;
+    if (this->buffer[gt - 1] == '/')
+      return gt + 1;
+
+    static const char kEndTag[] = "</state";
+    std::size_t p = this->buffer.find(kEndTag, gt);
+    while (p != std::string::npos)
+    {
+      std::size_t c = p + sizeof(kEndTag) - 1;
+      while (c < this->buffer.size() && IsClassicSpace(this->buffer[c]))
+        ++c;
+      if (c == this->buffer.size())
+        return std::string::npos;
+      if (this->buffer[c] == '>')
+        return c + 1;
+      p = this->buffer.find(kEndTag, p + 1);
+    }
+    return std::string::npos;
+  }
+
+  /// \brief Stream that is read.
+  public: std::istream *input = nullptr;
+
+  /// \brief True once the stream has no more data.
+  public: bool eof = false;
+
+  /// \brief Text read from the stream that has not been consumed yet.
+  public: std::string buffer;
+
+  /// \brief Offset in the buffer where the search for the next state
+  /// starts.
+  public: std::size_t pos = 0u;
+
+  /// \brief Document reused to parse each state.
+  public: tinyxml2::XMLDocument doc;
+
+  /// \brief Number of states found.
+  public: std::uint64_t count = 0u;
+};
+
+/////////////////////////////////////////////////
+/// \brief Get the text of an element, or an empty string.
+/// \param[in] _elem The element.
+/// \return Text of the element.
+static const char *ElementText(const tinyxml2::XMLElement *_elem)
+{
+  const char *text = _elem->GetText();
+  return text ? text : "";
+}
+
+/////////////////////////////////////////////////
+/// \brief Read a pose, or a velocity written as a pose.
+/// \param[in] _elem Element to read.
+/// \param[in] _owner Scoped name of the model or link, for error messages.
+/// \param[out] _pose The value read.
+/// \param[out] _errors Errors encountered.
+static void ReadPose(const tinyxml2::XMLElement *_elem,
+    const std::string &_owner, ignition::math::Pose3d &_pose,
+    Errors &_errors)
+{
+  const char *text = ElementText(_elem);
+  double v[6];
+  if (ParseNumbers(text, text + std::strlen(text), v, 6) == 6)
+  {
+    _pose.Set(v[0], v[1], v[2], v[3], v[4], v[5]);
+  }
+  else
+  {
+    _errors.push_back({ErrorCode::ELEMENT_INVALID,
+        "Unable to read <" + std::string(_elem->Name()) + "> value [" +
+        text + "] of [" + _owner + "]."});
+  }
+}
+
+/////////////////////////////////////////////////
+/// \brief Read a time stamp of the form "seconds nanoseconds".
+/// \param[in] _elem Element to read.
+/// \param[out] _time The value read.
+/// \param[out] _errors Errors encountered.
+static void ReadTime(const tinyxml2::XMLElement *_elem, sdf::Time &_time,
+    Errors &_errors)
+{
+  const char *text = ElementText(_elem);
+  int32_t v[2];
+  if (ParseNumbers(text, text + std::strlen(text), v, 2) == 2)
+  {
+    _time.sec = v[0];
+    _time.nsec = v[1];
+  }
+  else
+  {
+    _errors.push_back({ErrorCode::ELEMENT_INVALID,
+        "Unable to read <" + std::string(_elem->Name()) + "> value [" +
+        text + "]."});
+  }
+}
+
+/////////////////////////////////////////////////
+/// \brief Get the name attribute of a model or link state.
+/// \param[in] _elem Element to read.
+/// \param[in] _scope Scoped name of the parent model, or empty.
+/// \param[out] _errors Errors encountered.
+/// \return Scoped name.
+static std::string ScopedName(const tinyxml2::XMLElement *_elem,
+    const std::string &_scope, Errors &_errors)
+{
+  const char *name = _elem->Attribute("name");
+  if (!name)
+  {
+    _errors.push_back({ErrorCode::ATTRIBUTE_MISSING,
+        "A <" + std::string(_elem->Name()) + "> state in [" + _scope +
+        "] is missing its name."});
+    name = "__default__";
+  }
+  return _scope.empty() ? name : _scope + "::" + name;
+}
+
+/////////////////////////////////////////////////
+/// \brief Read a model state and its links and nested models.
+/// \param[in] _elem The <model> element.
+/// \param[in] _scope Scoped name of the parent model, or empty.
+/// \param[in] _parent Index of the parent model.
+/// \param[out] _frame Frame to fill.
+/// \param[out] _errors Errors encountered.
+static void ReadModel(const tinyxml2::XMLElement *_elem,
+    const std::string &_scope, std::size_t _parent, StateFramePrivate &_frame,
+    Errors &_errors)
+{
+  const std::string name = ScopedName(_elem, _scope, _errors);
+  const std::size_t model = _frame.AddModel(name, _parent);
+
+  for (const tinyxml2::XMLElement *child = _elem->FirstChildElement();
+       child; child = child->NextSiblingElement())
+  {
+    const char *childName = child->Name();
+    if (std::strcmp(childName, "pose") == 0)
+    {
+      ReadPose(child, name, _frame.modelPoses[model], _errors);
+    }
+    else if (std::strcmp(childName, "link") == 0)
+    {
+      const std::size_t link =
+        _frame.AddLink(ScopedName(child, name, _errors), model);
+      for (const tinyxml2::XMLElement *linkChild = child->FirstChildElement();
+           linkChild; linkChild = linkChild->NextSiblingElement())
+      {
+        if (std::strcmp(linkChild->Name(), "pose") == 0)
+        {
+          ReadPose(linkChild, _frame.linkNames[link],
+              _frame.linkPoses[link], _errors);
+        }
+        else if (std::strcmp(linkChild->Name(), "velocity") == 0)
+        {
+          ReadPose(linkChild, _frame.linkNames[link],
+              _frame.linkVelocities[link], _errors);
+        }
+      }
+    }
+    else if (std::strcmp(childName, "model") == 0)
+    {
+      ReadModel(child, name, model, _frame, _errors);
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+StateFrame::StateFrame()
+  : dataPtr(new StateFramePrivate)
+{
+}
+
+/////////////////////////////////////////////////
+StateFrame::StateFrame(const StateFrame &_frame)
+  : dataPtr(new StateFramePrivate(*_frame.dataPtr))
+{
+}
+
+/////////////////////////////////////////////////
+StateFrame::StateFrame(StateFrame &&_frame) noexcept
+  : dataPtr(std::exchange(_frame.dataPtr, nullptr))
+{
+}
+
+/////////////////////////////////////////////////
+StateFrame &StateFrame::operator=(StateFrame &&_frame) noexcept
+{
+  std::swap(this->dataPtr, _frame.dataPtr);
+  return *this;
+}
+
+/////////////////////////////////////////////////
+StateFrame &StateFrame::operator=(const StateFrame &_frame)
+{
+  return *this = StateFrame(_frame);
+}
+
+/////////////////////////////////////////////////
+StateFrame::~StateFrame()
+{
+  delete this->dataPtr;
+  this->dataPtr = nullptr;
+}
+
+/////////////////////////////////////////////////
+void StateFrame::Clear()
+{
+  this->dataPtr->worldName.clear();
+  this->dataPtr->simTime = sdf::Time();
+  this->dataPtr->wallTime = sdf::Time();
+  this->dataPtr->realTime = sdf::Time();
+  this->dataPtr->iterations = 0u;
+  this->dataPtr->modelCount = 0u;
+  this->dataPtr->linkCount = 0u;
+}
+
+/////////////////////////////////////////////////
+const std::string &StateFrame::WorldName() const
+{
+  return this->dataPtr->worldName;
+}
+
+/////////////////////////////////////////////////
+void StateFrame::SetWorldName(const std::string &_name)
+{
+  this->dataPtr->worldName = _name;
+}
+
+/////////////////////////////////////////////////
+const sdf::Time &StateFrame::SimTime() const
+{
+  return this->dataPtr->simTime;
+}
+
+/////////////////////////////////////////////////
+void StateFrame::SetSimTime(const sdf::Time &_time)
+{
+  this->dataPtr->simTime = _time;
+}
+
+/////////////////////////////////////////////////
+const sdf::Time &StateFrame::WallTime() const
+{
+  return this->dataPtr->wallTime;
+}
+
+/////////////////////////////////////////////////
+void StateFrame::SetWallTime(const sdf::Time &_time)
+{
+  this->dataPtr->wallTime = _time;
+}
+
+/////////////////////////////////////////////////
+const sdf::Time &StateFrame::RealTime() const
+{
+  return this->dataPtr->realTime;
+}
+
+/////////////////////////////////////////////////
+void StateFrame::SetRealTime(const sdf::Time &_time)
+{
+  this->dataPtr->realTime = _time;
+}
+
+/////////////////////////////////////////////////
+std::uint64_t StateFrame::Iterations() const
+{
+  return this->dataPtr->iterations;
+}
+
+/////////////////////////////////////////////////
+void StateFrame::SetIterations(std::uint64_t _iterations)
+{
+  this->dataPtr->iterations = _iterations;
+}
+
+/////////////////////////////////////////////////
+std::size_t StateFrame::AddModel(const std::string &_name,
+    const ignition::math::Pose3d &_pose, std::size_t _parent)
+{
+  if (_parent == kInvalidIndex)
+  {
+    const std::size_t index = this->dataPtr->AddModel(_name, _parent);
+    this->dataPtr->modelPoses[index] = _pose;
+    return index;
+  }
+
+  if (_parent >= this->dataPtr->modelCount)
+    return kInvalidIndex;
+
+  const std::size_t index = this->dataPtr->AddModel(
+      this->dataPtr->modelNames[_parent] + "::" + _name, _parent);
+  this->dataPtr->modelPoses[index] = _pose;
+  return index;
+}
+
+/////////////////////////////////////////////////
+std::size_t StateFrame::AddLink(std::size_t _model, const std::string &_name,
+    const ignition::math::Pose3d &_pose,
+    const ignition::math::Pose3d &_velocity)
+{
+  if (_model >= this->dataPtr->modelCount)
+    return kInvalidIndex;
+
+  const std::size_t index = this->dataPtr->AddLink(
+      this->dataPtr->modelNames[_model] + "::" + _name, _model);
+  this->dataPtr->linkPoses[index] = _pose;
+  this->dataPtr->linkVelocities[index] = _velocity;
+  return index;
+}
+
+/////////////////////////////////////////////////
+std::size_t StateFrame::ModelCount() const
+{
+  return this->dataPtr->modelCount;
+}
+
+/////////////////////////////////////////////////
+const std::string &StateFrame::ModelName(std::size_t _index) const
+{
+  if (_index >= this->dataPtr->modelCount)
+    return kEmptyString;
+  return this->dataPtr->modelNames[_index];
+}
+
+/////////////////////////////////////////////////
+const ignition::math::Pose3d *StateFrame::ModelPoses() const
+{
+  return this->dataPtr->modelPoses.data();
+}
+
+/////////////////////////////////////////////////
+ignition::math::Pose3d *StateFrame::ModelPoses()
+{
+  return this->dataPtr->modelPoses.data();
+}
+
+/////////////////////////////////////////////////
+const std::size_t *StateFrame::ModelParents() const
+{
+  return this->dataPtr->modelParents.data();
+}
+
+/////////////////////////////////////////////////
+std::size_t StateFrame::LinkCount() const
+{
+  return this->dataPtr->linkCount;
+}
+
+/////////////////////////////////////////////////
+const std::string &StateFrame::LinkName(std::size_t _index) const
+{
+  if (_index >= this->dataPtr->linkCount)
+    return kEmptyString;
+  return this->dataPtr->linkNames[_index];
+}
+
+/////////////////////////////////////////////////
+const std::size_t *StateFrame::LinkModels() const
+{
+  return this->dataPtr->linkModels.data();
+}
+
+/////////////////////////////////////////////////
+const ignition::math::Pose3d *StateFrame::LinkPoses() const
+{
+  return this->dataPtr->linkPoses.data();
+}
+
+/////////////////////////////////////////////////
+ignition::math::Pose3d *StateFrame::LinkPoses()
+{
+  return this->dataPtr->linkPoses.data();
+}
+
+/////////////////////////////////////////////////
+const ignition::math::Pose3d *StateFrame::LinkVelocities() const
+{
+  return this->dataPtr->linkVelocities.data();
+}
+
+/////////////////////////////////////////////////
+ignition::math::Pose3d *StateFrame::LinkVelocities()
+{
+  return this->dataPtr->linkVelocities.data();
+}
+
+/////////////////////////////////////////////////
+StateReader::StateReader(std::istream &_input)
+  : dataPtr(new StateReaderPrivate)
+{
+  this->dataPtr->input = &_input;
+}
+
+/////////////////////////////////////////////////
+StateReader::~StateReader()
+{
+  delete this->dataPtr;
+  this->dataPtr = nullptr;
+}
+
+/////////////////////////////////////////////////
+bool StateReader::Next(StateFrame &_frame, Errors &_errors)
+{
+  StateReaderPrivate &d = *this->dataPtr;
+
+  // Find a complete state in the buffer, reading more of the stream as
+  // needed.
+  std::size_t start = std::string::npos;
+  std::size_t end = std::string::npos;
+  while (true)
+  {
+    std::size_t keep = 0u;
+    start = d.FindStart(keep);
+    if (start != std::string::npos)
+    {
+      end = d.FindEnd(start);
+      if (end != std::string::npos)
+        break;
+      keep = start;
+    }
+
+    if (d.eof)
+    {
+      if (start != std::string::npos)
+      {
+        ++d.count;
+        _errors.push_back({ErrorCode::STRING_READ,
+            "The last <state> element is not terminated."});
+      }
+      d.buffer.clear();
+      d.pos = 0u;
+      return false;
+    }
+
+    d.Discard(keep);
+    d.ReadBlock();
+  }
+
+  ++d.count;
+  d.pos = end;
+
+  // Under some locales strtod, which is used when std::from_chars is not
+  // available for floating point numbers, expects a comma as decimal
+  // separator. Force "C" as Param::ValueFromString does.
+  setlocale(LC_NUMERIC, "C");
+
+  d.doc.Parse(d.buffer.data() + start, end - start);
+  if (d.doc.Error())
+  {
+    _errors.push_back({ErrorCode::STRING_READ,
+        "Unable to parse <state> element: " + std::string(d.doc.ErrorStr())});
+    return false;
+  }
+
+  StateFramePrivate &frame = *_frame.dataPtr;
+  _frame.Clear();
+
+  const tinyxml2::XMLElement *state = d.doc.RootElement();
+  const char *worldName = state->Attribute("world_name");
+  frame.worldName.assign(worldName ? worldName : "__default__");
+
+  for (const tinyxml2::XMLElement *elem = state->FirstChildElement();
+       elem; elem = elem->NextSiblingElement())
+  {
+    const char *name = elem->Name();
+    if (std::strcmp(name, "model") == 0)
+    {
+      ReadModel(elem, "", StateFrame::kInvalidIndex, frame, _errors);
+    }
+    else if (std::strcmp(name, "sim_time") == 0)
+    {
+      ReadTime(elem, frame.simTime, _errors);
+    }
+    else if (std::strcmp(name, "wall_time") == 0)
+    {
+      ReadTime(elem, frame.wallTime, _errors);
+    }
+    else if (std::strcmp(name, "real_time") == 0)
+    {
+      ReadTime(elem, frame.realTime, _errors);
+    }
+    else if (std::strcmp(name, "iterations") == 0)
+    {
+      const char *text = ElementText(elem);
+      if (ParseNumbers(text, text + std::strlen(text), &frame.iterations, 1)
+          != 1)
+      {
+        _errors.push_back({ErrorCode::ELEMENT_INVALID,
+            "Unable to read <iterations> value [" + std::string(text) +
+            "]."});
+      }
+    }
+  }
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+std::uint64_t StateReader::Count() const
+{
+  return this->dataPtr->count;
+}
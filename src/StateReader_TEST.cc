@@ -0,0 +1,218 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <sstream>
+#include <string>
+
+#include <gtest/gtest.h>
+#include "sdf/StateReader.hh"
+
+/////////////////////////////////////////////////
+TEST(StateReader, Construction)
+{
+  sdf::StateFrame frame;
+  EXPECT_TRUE(frame.WorldName().empty());
+  EXPECT_EQ(0, frame.SimTime().sec);
+  EXPECT_EQ(0u, frame.Iterations());
+  EXPECT_EQ(0u, frame.ModelCount());
+  EXPECT_EQ(0u, frame.LinkCount());
+  EXPECT_TRUE(frame.ModelName(0).empty());
+  EXPECT_TRUE(frame.LinkName(0).empty());
+
+  std::istringstream input("");
+  sdf::StateReader reader(input);
+  sdf::Errors errors;
+  EXPECT_FALSE(reader.Next(frame, errors));
+  EXPECT_TRUE(errors.empty());
+  EXPECT_EQ(0u, reader.Count());
+}
+
+/////////////////////////////////////////////////
+TEST(StateReader, ReadStates)
+{
+  std::istringstream input(
+    "<sdf version='1.8'>"
+    "  <world name='default'>"
+    "    <state world_name='default'>"
+    "      <sim_time>1 500</sim_time>"
+    "      <wall_time>2 0</wall_time>"
+    "      <real_time>3 7</real_time>"
+    "      <iterations>42</iterations>"
+    "      <model name='robot'>"
+    "        <pose>1 2 3 0 0 0</pose>"
+    "        <link name='base'>"
+    "          <pose>1 2 3.5 0 0 0.5</pose>"
+    "          <velocity>0.1 0 0 0 0 0.2</velocity>"
+    "          <acceleration>0 0 0 0 0 0</acceleration>"
+    "        </link>"
+    "        <joint name='j'><angle axis='0'>0.3</angle></joint>"
+    "        <model name='arm'>"
+    "          <link name='tip'/>"
+    "        </model>"
+    "      </model>"
+    "      <light name='sun'><pose>0 0 10 0 0 0</pose></light>"
+    "    </state>"
+    "    <state world_name='default'>"
+    "      <sim_time>1 1000</sim_time>"
+    "      <iterations>43</iterations>"
+    "      <model name='box'><link name='link'/></model>"
+    "    </state>"
+    "  </world>"
+    "</sdf>");
+
+  sdf::StateReader reader(input);
+  sdf::StateFrame frame;
+  sdf::Errors errors;
+
+  ASSERT_TRUE(reader.Next(frame, errors));
+  EXPECT_TRUE(errors.empty());
+  EXPECT_EQ("default", frame.WorldName());
+  EXPECT_EQ(1, frame.SimTime().sec);
+  EXPECT_EQ(500, frame.SimTime().nsec);
+  EXPECT_EQ(2, frame.WallTime().sec);
+  EXPECT_EQ(3, frame.RealTime().sec);
+  EXPECT_EQ(7, frame.RealTime().nsec);
+  EXPECT_EQ(42u, frame.Iterations());
+
+  ASSERT_EQ(2u, frame.ModelCount());
+  EXPECT_EQ("robot", frame.ModelName(0));
+  EXPECT_EQ("robot::arm", frame.ModelName(1));
+  EXPECT_EQ(ignition::math::Pose3d(1, 2, 3, 0, 0, 0), frame.ModelPoses()[0]);
+  EXPECT_EQ(ignition::math::Pose3d::Zero, frame.ModelPoses()[1]);
+
+  ASSERT_EQ(2u, frame.LinkCount());
+  EXPECT_EQ("robot::base", frame.LinkName(0));
+  EXPECT_EQ("robot::arm::tip", frame.LinkName(1));
+  EXPECT_EQ(0u, frame.LinkModels()[0]);
+  EXPECT_EQ(1u, frame.LinkModels()[1]);
+  EXPECT_EQ(ignition::math::Pose3d(1, 2, 3.5, 0, 0, 0.5),
+            frame.LinkPoses()[0]);
+  EXPECT_EQ(ignition::math::Pose3d(0.1, 0, 0, 0, 0, 0.2),
+            frame.LinkVelocities()[0]);
+  EXPECT_EQ(ignition::math::Pose3d::Zero, frame.LinkPoses()[1]);
+  EXPECT_TRUE(frame.LinkName(2).empty());
+
+  // The same frame is refilled with a smaller state.
+  ASSERT_TRUE(reader.Next(frame, errors));
+  EXPECT_TRUE(errors.empty());
+  EXPECT_EQ(1000, frame.SimTime().nsec);
+  EXPECT_EQ(0, frame.WallTime().sec);
+  EXPECT_EQ(43u, frame.Iterations());
+  ASSERT_EQ(1u, frame.ModelCount());
+  EXPECT_EQ("box", frame.ModelName(0));
+  ASSERT_EQ(1u, frame.LinkCount());
+  EXPECT_EQ("box::link", frame.LinkName(0));
+  EXPECT_EQ(ignition::math::Pose3d::Zero, frame.LinkPoses()[0]);
+  EXPECT_TRUE(frame.ModelName(1).empty());
+
+  EXPECT_FALSE(reader.Next(frame, errors));
+  EXPECT_TRUE(errors.empty());
+  EXPECT_EQ(2u, reader.Count());
+
+  // Copies keep the content.
+  sdf::StateFrame copy(frame);
+  EXPECT_EQ("box::link", copy.LinkName(0));
+  sdf::StateFrame moved(std::move(copy));
+  EXPECT_EQ(1u, moved.LinkCount());
+}
+
+/////////////////////////////////////////////////
+TEST(StateReader, LargeLog)
+{
+  // Write enough states to span several read blocks, so that some states
+  // are split between blocks.
+  const int stateCount = 20000;
+  std::ostringstream log;
+  log << "<gazebo_log>";
+  for (int i = 0; i < stateCount; ++i)
+  {
+    log << "<chunk encoding='txt'><![CDATA[<sdf version='1.8'>"
+        << "<state world_name='default'>"
+        << "<sim_time>" << i << " 0</sim_time>"
+        << "<iterations>" << i << "</iterations>";
+    for (int m = 0; m < 5; ++m)
+    {
+      log << "<model name='model_" << m << "'>"
+          << "<pose>" << i << " " << m << " 0 0 0 0</pose>"
+          << "<link name='link'><pose>" << i << " " << m
+          << " 0.5 0 0 0</pose></link>"
+          << "</model>";
+    }
+    log << "</state></sdf>]]></chunk>";
+  }
+  log << "</gazebo_log>";
+  ASSERT_GT(log.str().size(), 3u * 1024u * 1024u);
+
+  std::istringstream input(log.str());
+  sdf::StateReader reader(input);
+  sdf::StateFrame frame;
+  sdf::Errors errors;
+  int count = 0;
+  while (reader.Next(frame, errors))
+  {
+    ASSERT_EQ(count, frame.SimTime().sec);
+    ASSERT_EQ(static_cast<uint64_t>(count), frame.Iterations());
+    ASSERT_EQ(5u, frame.LinkCount());
+    ASSERT_EQ(ignition::math::Pose3d(count, 4, 0.5, 0, 0, 0),
+              frame.LinkPoses()[4]);
+    ++count;
+  }
+  EXPECT_TRUE(errors.empty());
+  EXPECT_EQ(stateCount, count);
+  EXPECT_EQ(static_cast<uint64_t>(stateCount), reader.Count());
+}
+
+/////////////////////////////////////////////////
+TEST(StateReader, Errors)
+{
+  std::istringstream input(
+    "<state world_name='w'>"
+    "  <model name='m'><pose>1 2 three 0 0 0</pose></model>"
+    "  <model><link name='l'/></model>"
+    "</state>"
+    "<state world_name='w'><model name='a'></mode></state>"
+    "<state world_name='w'><iterations>7</iterations></state>"
+    "<state world_name='w'><iterations>8</iterations>");
+
+  sdf::StateReader reader(input);
+  sdf::StateFrame frame;
+  sdf::Errors errors;
+
+  // Values that can not be read are reported, and the state is still read.
+  ASSERT_TRUE(reader.Next(frame, errors));
+  ASSERT_EQ(2u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::ELEMENT_INVALID, errors[0].Code());
+  EXPECT_EQ(sdf::ErrorCode::ATTRIBUTE_MISSING, errors[1].Code());
+  EXPECT_EQ(ignition::math::Pose3d::Zero, frame.ModelPoses()[0]);
+  EXPECT_EQ("__default__::l", frame.LinkName(0));
+
+  // Malformed XML fails the state, and reading continues after it.
+  errors.clear();
+  EXPECT_FALSE(reader.Next(frame, errors));
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::STRING_READ, errors[0].Code());
+
+  errors.clear();
+  ASSERT_TRUE(reader.Next(frame, errors));
+  EXPECT_TRUE(errors.empty());
+  EXPECT_EQ(7u, frame.Iterations());
+
+  // The last state is not terminated.
+  EXPECT_FALSE(reader.Next(frame, errors));
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::STRING_READ, errors[0].Code());
+  EXPECT_EQ(4u, reader.Count());
+}
@@ -0,0 +1,414 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "sdf/StateWriter.hh"
+
+#include "NumberParsing.hh"
+
+using namespace sdf;
+
+/// \brief Private data for sdf::StateWriter
+class sdf::StateWriterPrivate
+{
+  /// \brief Match the entities of a frame with the entities written last.
+  /// \param[in] _count Number of entities in the frame.
+  /// \param[in] _name Function returning the name of an entity.
+  /// \param[in] _names Names of the entities written last. It is updated
+  /// with the names of the frame when they differ.
+  /// \param[out] _previous Index of each entity in _names, or
+  /// StateFrame::kInvalidIndex for a new entity.
+  /// \return True if the entities are the same as the ones written last,
+  /// in the same order.
+  public: template <typename NameFunc>
+          bool Match(std::size_t _count, NameFunc _name,
+                     std::vector<std::string> &_names,
+                     std::vector<std::size_t> &_previous)
+  {
+    _previous.resize(_count);
+
+    bool same = _count == _names.size();
+    for (std::size_t i = 0; same && i < _count; ++i)
+    {
+      same = _names[i] == _name(i);
+      _previous[i] = i;
+    }
+    if (same)
+      return true;
+
+    this->nameIndex.clear();
+    for (std::size_t i = 0; i < _names.size(); ++i)
+      this->nameIndex.emplace(_names[i], i);
+
+    for (std::size_t i = 0; i < _count; ++i)
+    {
+      auto it = this->nameIndex.find(_name(i));
+      _previous[i] = it == this->nameIndex.end() ?
+          StateFrame::kInvalidIndex : it->second;
+    }
+
+    _names.resize(_count);
+    for (std::size_t i = 0; i < _count; ++i)
+      _names[i].assign(_name(i));
+    return false;
+  }
+
+  /// \brief Check whether a pose differs from the last written value.
+  /// \param[in] _pose Current pose.
+  /// \param[in] _previous Index of the last written pose, or
+  /// StateFrame::kInvalidIndex.
+  /// \param[in] _poses Last written poses.
+  /// \return True if the pose has to be written.
+  public: bool Changed(const ignition::math::Pose3d &_pose,
+                       std::size_t _previous,
+                       const std::vector<ignition::math::Pose3d> &_poses) const
+  {
+    if (!this->hasPrevious || _previous == StateFrame::kInvalidIndex)
+      return true;
+
+    const ignition::math::Pose3d &last = _poses[_previous];
+    return !_pose.Pos().Equal(last.Pos(), this->tolerance) ||
+           !_pose.Rot().Equal(last.Rot(), this->tolerance);
+  }
+
+  /// \brief Append a number to the buffer.
+  /// \param[in] _value Value to append.
+  public: template <typename T>
+          void AppendNumber(T _value)
+  {
+    char chars[32];
+    char *end = NumberToChars(_value, chars, chars + sizeof(chars));
+    this->buffer.append(chars, end);
+  }
+
+  /// \brief Append a name to the buffer, escaping XML special characters.
+  /// \param[in] _name Name to append.
+  /// \param[in] _offset Offset of the first character to append, used to
+  /// skip the scope of the name.
+  public: void AppendName(const std::string &_name, std::size_t _offset)
+  {
+    if (_offset > _name.size())
+      _offset = 0;
+
+    for (std::size_t i = _offset; i < _name.size(); ++i)
+    {
+      switch (_name[i])
+      {
+        case '&': this->buffer.append("&amp;"); break;
+        case '<': this->buffer.append("&lt;"); break;
+        case '>': this->buffer.append("&gt;"); break;
+        case '\'': this->buffer.append("&apos;"); break;
+        case '"': this->buffer.append("&quot;"); break;
+        default: this->buffer.push_back(_name[i]); break;
+      }
+    }
+  }
+
+  /// \brief Append a <pose> element to the buffer.
+  /// \param[in] _pose Pose to append.
+  public: void AppendPose(const ignition::math::Pose3d &_pose)
+  {
+    const ignition::math::Vector3d rpy = _pose.Rot().Euler();
+    const double values[6] = {_pose.Pos().X(), _pose.Pos().Y(),
+        _pose.Pos().Z(), rpy.X(), rpy.Y(), rpy.Z()};
+
+    this->buffer.append("<pose>");
+    for (int i = 0; i < 6; ++i)
+    {
+      if (i > 0)
+        this->buffer.push_back(' ');
+      this->AppendNumber(values[i]);
+    }
+    this->buffer.append("</pose>");
+  }
+
+  /// \brief Append a time element to the buffer.
+  /// \param[in] _tag Name of the element.
+  /// \param[in] _time Time to append.
+  public: void AppendTime(const char *_tag, const sdf::Time &_time)
+  {
+    this->buffer.push_back('<');
+    this->buffer.append(_tag);
+    this->buffer.push_back('>');
+    this->AppendNumber(_time.sec);
+    this->buffer.push_back(' ');
+    this->AppendNumber(_time.nsec);
+    this->buffer.append("</");
+    this->buffer.append(_tag);
+    this->buffer.push_back('>');
+  }
+
+  /// \brief Sort entity indices by the index of their parent, so that the
+  /// entities of a parent are contiguous.
+  /// \param[in] _count Number of entities.
+  /// \param[in] _parents Parent of each entity, or StateFrame::kInvalidIndex
+  /// for entities sorted in the last group.
+  /// \param[in] _groupCount Number of parents.
+  /// \param[out] _start Offset of the entities of each parent in _sorted,
+  /// with _groupCount + 2 entries.
+  /// \param[out] _sorted Entity indices sorted by parent.
+  public: static void Group(std::size_t _count, const std::size_t *_parents,
+                            std::size_t _groupCount,
+                            std::vector<std::size_t> &_start,
+                            std::vector<std::size_t> &_sorted)
+  {
+    _start.assign(_groupCount + 2, 0);
+    _sorted.resize(_count);
+
+    auto group = [&](std::size_t _i)
+    {
+      return _parents[_i] < _groupCount ? _parents[_i] : _groupCount;
+    };
+
+    for (std::size_t i = 0; i < _count; ++i)
+      ++_start[group(i) + 1];
+    for (std::size_t g = 0; g <= _groupCount; ++g)
+      _start[g + 1] += _start[g];
+    for (std::size_t i = 0; i < _count; ++i)
+      _sorted[_start[group(i)]++] = i;
+
+    // Shift the offsets back to the start of each group.
+    for (std::size_t g = _groupCount + 1; g > 0; --g)
+      _start[g] = _start[g - 1];
+    _start[0] = 0;
+  }
+
+  /// \brief Stream to write to.
+  public: std::ostream *output = nullptr;
+
+  /// \brief Tolerance used to compare poses.
+  public: double tolerance = 0;
+
+  /// \brief Number of states written.
+  public: std::uint64_t count = 0;
+
+  /// \brief True once a state has been written since the last reset.
+  public: bool hasPrevious = false;
+
+  /// \brief Scoped names of the models of the last frame.
+  public: std::vector<std::string> modelNames;
+
+  /// \brief Last written pose of each model of the last frame.
+  public: std::vector<ignition::math::Pose3d> modelPoses;
+
+  /// \brief Scoped names of the links of the last frame.
+  public: std::vector<std::string> linkNames;
+
+  /// \brief Last written pose of each link of the last frame.
+  public: std::vector<ignition::math::Pose3d> linkPoses;
+
+  /// \brief Scratch storage for the previous index of each model and link.
+  public: std::vector<std::size_t> modelPrevious, linkPrevious;
+
+  /// \brief Scratch storage for the models and links to write.
+  public: std::vector<char> modelDirty, linkDirty;
+
+  /// \brief Scratch storage for the last written poses of the frame.
+  public: std::vector<ignition::math::Pose3d> nextPoses;
+
+  /// \brief Scratch storage for the nested models of each model.
+  public: std::vector<std::size_t> childStart, children;
+
+  /// \brief Scratch storage for the links of each model.
+  public: std::vector<std::size_t> linkStart, links;
+
+  /// \brief Scratch storage for the models being written, with the offset
+  /// of the next nested model to visit.
+  public: std::vector<std::pair<std::size_t, std::size_t>> stack;
+
+  /// \brief Index of the names written last, used when entities change.
+  public: std::unordered_map<std::string, std::size_t> nameIndex;
+
+  /// \brief Text of the state being written, reused between states.
+  public: std::string buffer;
+};
+
+/////////////////////////////////////////////////
+StateWriter::StateWriter(std::ostream &_output)
+  : dataPtr(new StateWriterPrivate)
+{
+  this->dataPtr->output = &_output;
+}
+
+/////////////////////////////////////////////////
+StateWriter::~StateWriter()
+{
+  delete this->dataPtr;
+  this->dataPtr = nullptr;
+}
+
+/////////////////////////////////////////////////
+void StateWriter::Write(const StateFrame &_frame)
+{
+  StateWriterPrivate &d = *this->dataPtr;
+  const std::size_t modelCount = _frame.ModelCount();
+  const std::size_t linkCount = _frame.LinkCount();
+  const std::size_t *modelParents = _frame.ModelParents();
+  const std::size_t *linkModels = _frame.LinkModels();
+  const ignition::math::Pose3d *modelPoses = _frame.ModelPoses();
+  const ignition::math::Pose3d *linkPoses = _frame.LinkPoses();
+
+  if (!d.hasPrevious)
+  {
+    d.modelNames.clear();
+    d.linkNames.clear();
+  }
+
+  d.Match(modelCount, [&](std::size_t _i) -> const std::string &
+      { return _frame.ModelName(_i); }, d.modelNames, d.modelPrevious);
+  d.Match(linkCount, [&](std::size_t _i) -> const std::string &
+      { return _frame.LinkName(_i); }, d.linkNames, d.linkPrevious);
+
+  // Find the links that changed, and the models that have to be written.
+  d.modelDirty.assign(modelCount, 0);
+  d.linkDirty.assign(linkCount, 0);
+  for (std::size_t i = 0; i < modelCount; ++i)
+  {
+    if (d.Changed(modelPoses[i], d.modelPrevious[i], d.modelPoses))
+      d.modelDirty[i] = 1;
+  }
+  for (std::size_t i = 0; i < linkCount; ++i)
+  {
+    if (d.Changed(linkPoses[i], d.linkPrevious[i], d.linkPoses))
+    {
+      d.linkDirty[i] = 1;
+      if (linkModels[i] < modelCount)
+        d.modelDirty[linkModels[i]] = 1;
+    }
+  }
+
+  // Nested models are added after their parent, so walking backwards
+  // marks every ancestor of a written model.
+  for (std::size_t i = modelCount; i > 0; --i)
+  {
+    const std::size_t parent = modelParents[i - 1];
+    if (d.modelDirty[i - 1] && parent < modelCount)
+      d.modelDirty[parent] = 1;
+  }
+
+  // Remember the last written pose of each entity of this frame.
+  d.nextPoses.resize(modelCount);
+  for (std::size_t i = 0; i < modelCount; ++i)
+  {
+    d.nextPoses[i] = d.modelDirty[i] ?
+        modelPoses[i] : d.modelPoses[d.modelPrevious[i]];
+  }
+  std::swap(d.nextPoses, d.modelPoses);
+
+  d.nextPoses.resize(linkCount);
+  for (std::size_t i = 0; i < linkCount; ++i)
+  {
+    d.nextPoses[i] = d.linkDirty[i] ?
+        linkPoses[i] : d.linkPoses[d.linkPrevious[i]];
+  }
+  std::swap(d.nextPoses, d.linkPoses);
+
+  // Write the state.
+  d.buffer.clear();
+  d.buffer.append("<state world_name='");
+  d.AppendName(_frame.WorldName(), 0);
+  d.buffer.append("'>");
+  d.AppendTime("sim_time", _frame.SimTime());
+  d.AppendTime("wall_time", _frame.WallTime());
+  d.AppendTime("real_time", _frame.RealTime());
+  d.buffer.append("<iterations>");
+  d.AppendNumber(_frame.Iterations());
+  d.buffer.append("</iterations>");
+
+  StateWriterPrivate::Group(modelCount, modelParents, modelCount,
+      d.childStart, d.children);
+  StateWriterPrivate::Group(linkCount, linkModels, modelCount,
+      d.linkStart, d.links);
+
+  // Top level models are in the last group of children.
+  d.stack.clear();
+  d.stack.emplace_back(modelCount, d.childStart[modelCount]);
+  while (!d.stack.empty())
+  {
+    const std::size_t model = d.stack.back().first;
+    std::size_t &next = d.stack.back().second;
+    const std::size_t end = d.childStart[model + 1];
+
+    while (next < end && !d.modelDirty[d.children[next]])
+      ++next;
+
+    if (next == end)
+    {
+      if (model < modelCount)
+        d.buffer.append("</model>");
+      d.stack.pop_back();
+      continue;
+    }
+
+    const std::size_t child = d.children[next++];
+    const std::size_t parent = modelParents[child];
+    d.buffer.append("<model name='");
+    d.AppendName(_frame.ModelName(child), parent < modelCount ?
+        _frame.ModelName(parent).size() + 2 : 0);
+    d.buffer.append("'>");
+    d.AppendPose(modelPoses[child]);
+
+    const std::size_t nameOffset = _frame.ModelName(child).size() + 2;
+    for (std::size_t i = d.linkStart[child]; i < d.linkStart[child + 1]; ++i)
+    {
+      const std::size_t link = d.links[i];
+      if (!d.linkDirty[link])
+        continue;
+      d.buffer.append("<link name='");
+      d.AppendName(_frame.LinkName(link), nameOffset);
+      d.buffer.append("'>");
+      d.AppendPose(linkPoses[link]);
+      d.buffer.append("</link>");
+    }
+
+    d.stack.emplace_back(child, d.childStart[child]);
+  }
+
+  d.buffer.append("</state>\n");
+  d.output->write(d.buffer.data(),
+      static_cast<std::streamsize>(d.buffer.size()));
+
+  d.hasPrevious = true;
+  ++d.count;
+}
+
+/////////////////////////////////////////////////
+void StateWriter::Reset()
+{
+  this->dataPtr->hasPrevious = false;
+}
+
+/////////////////////////////////////////////////
+void StateWriter::SetTolerance(double _tolerance)
+{
+  this->dataPtr->tolerance = _tolerance;
+}
+
+/////////////////////////////////////////////////
+double StateWriter::Tolerance() const
+{
+  return this->dataPtr->tolerance;
+}
+
+/////////////////////////////////////////////////
+std::uint64_t StateWriter::Count() const
+{
+  return this->dataPtr->count;
+}
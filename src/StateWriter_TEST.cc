@@ -0,0 +1,181 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <sstream>
+#include <string>
+
+#include <gtest/gtest.h>
+#include "sdf/StateReader.hh"
+#include "sdf/StateWriter.hh"
+
+/////////////////////////////////////////////////
+/// \brief Fill a frame with a robot that has a nested model.
+/// \param[out] _frame Frame to fill.
+/// \param[in] _x X position of the tip link.
+static void robotFrame(sdf::StateFrame &_frame, double _x)
+{
+  _frame.Clear();
+  _frame.SetWorldName("default");
+  _frame.SetSimTime(sdf::Time(1, 500));
+  _frame.SetIterations(42);
+
+  const std::size_t robot = _frame.AddModel("robot",
+      ignition::math::Pose3d(1, 2, 3, 0, 0, 0));
+  _frame.AddLink(robot, "base", ignition::math::Pose3d(1, 2, 3.5, 0, 0, 0.5));
+  const std::size_t arm = _frame.AddModel("arm",
+      ignition::math::Pose3d(0, 0, 1, 0, 0, 0), robot);
+  _frame.AddLink(arm, "tip", ignition::math::Pose3d(_x, 0, 0, 0, 0, 0));
+  const std::size_t box = _frame.AddModel("box",
+      ignition::math::Pose3d(5, 0, 0, 0, 0, 0));
+  _frame.AddLink(box, "link", ignition::math::Pose3d(5, 0, 0, 0, 0, 0));
+}
+
+/////////////////////////////////////////////////
+TEST(StateWriter, FillFrame)
+{
+  sdf::StateFrame frame;
+  robotFrame(frame, 0.25);
+
+  ASSERT_EQ(3u, frame.ModelCount());
+  EXPECT_EQ("robot::arm", frame.ModelName(1));
+  EXPECT_EQ(sdf::StateFrame::kInvalidIndex, frame.ModelParents()[0]);
+  EXPECT_EQ(0u, frame.ModelParents()[1]);
+  ASSERT_EQ(3u, frame.LinkCount());
+  EXPECT_EQ("robot::arm::tip", frame.LinkName(1));
+  EXPECT_EQ(1u, frame.LinkModels()[1]);
+
+  EXPECT_EQ(sdf::StateFrame::kInvalidIndex, frame.AddModel("bad",
+      ignition::math::Pose3d::Zero, 3));
+  EXPECT_EQ(sdf::StateFrame::kInvalidIndex, frame.AddLink(3, "bad",
+      ignition::math::Pose3d::Zero));
+  EXPECT_EQ(3u, frame.ModelCount());
+
+  frame.LinkPoses()[1].Pos().X(0.5);
+  EXPECT_DOUBLE_EQ(0.5, frame.LinkPoses()[1].Pos().X());
+}
+
+/////////////////////////////////////////////////
+TEST(StateWriter, Deltas)
+{
+  std::stringstream stream;
+  sdf::StateWriter writer(stream);
+  sdf::StateFrame frame;
+
+  // The first state is written in full, and reads back.
+  robotFrame(frame, 0.25);
+  writer.Write(frame);
+
+  // Only the nested model of the changed link is written, with its
+  // parent.
+  robotFrame(frame, 0.75);
+  frame.SetIterations(43);
+  writer.Write(frame);
+
+  // Nothing changed.
+  frame.SetIterations(44);
+  writer.Write(frame);
+  EXPECT_EQ(3u, writer.Count());
+
+  sdf::StateReader reader(stream);
+  sdf::StateFrame read;
+  sdf::Errors errors;
+
+  ASSERT_TRUE(reader.Next(read, errors));
+  EXPECT_TRUE(errors.empty());
+  EXPECT_EQ("default", read.WorldName());
+  EXPECT_EQ(1, read.SimTime().sec);
+  EXPECT_EQ(500, read.SimTime().nsec);
+  EXPECT_EQ(42u, read.Iterations());
+  ASSERT_EQ(3u, read.ModelCount());
+  EXPECT_EQ("robot::arm", read.ModelName(1));
+  EXPECT_EQ(0u, read.ModelParents()[1]);
+  ASSERT_EQ(3u, read.LinkCount());
+  for (std::size_t i = 0; i < 3; ++i)
+  {
+    EXPECT_EQ(frame.LinkName(i), read.LinkName(i));
+    EXPECT_EQ(frame.ModelName(i), read.ModelName(i));
+  }
+  EXPECT_EQ(ignition::math::Pose3d(1, 2, 3.5, 0, 0, 0.5),
+            read.LinkPoses()[0]);
+  EXPECT_EQ(ignition::math::Pose3d(0.25, 0, 0, 0, 0, 0), read.LinkPoses()[1]);
+
+  ASSERT_TRUE(reader.Next(read, errors));
+  EXPECT_TRUE(errors.empty());
+  EXPECT_EQ(43u, read.Iterations());
+  ASSERT_EQ(2u, read.ModelCount());
+  EXPECT_EQ("robot", read.ModelName(0));
+  EXPECT_EQ("robot::arm", read.ModelName(1));
+  ASSERT_EQ(1u, read.LinkCount());
+  EXPECT_EQ("robot::arm::tip", read.LinkName(0));
+  EXPECT_EQ(ignition::math::Pose3d(0.75, 0, 0, 0, 0, 0), read.LinkPoses()[0]);
+
+  ASSERT_TRUE(reader.Next(read, errors));
+  EXPECT_TRUE(errors.empty());
+  EXPECT_EQ(44u, read.Iterations());
+  EXPECT_EQ(0u, read.ModelCount());
+  EXPECT_EQ(0u, read.LinkCount());
+
+  EXPECT_FALSE(reader.Next(read, errors));
+  EXPECT_TRUE(errors.empty());
+}
+
+/////////////////////////////////////////////////
+TEST(StateWriter, ToleranceAndReset)
+{
+  std::stringstream stream;
+  sdf::StateWriter writer(stream);
+  EXPECT_DOUBLE_EQ(0.0, writer.Tolerance());
+  writer.SetTolerance(0.1);
+  EXPECT_DOUBLE_EQ(0.1, writer.Tolerance());
+
+  sdf::StateFrame frame;
+  robotFrame(frame, 0.25);
+  writer.Write(frame);
+
+  // Small changes are not written, and do not accumulate.
+  robotFrame(frame, 0.3);
+  writer.Write(frame);
+  robotFrame(frame, 0.4);
+  writer.Write(frame);
+
+  // A new model is written in full, and the state after a reset too.
+  const std::size_t model = frame.AddModel("new<&>",
+      ignition::math::Pose3d::Zero);
+  frame.AddLink(model, "link", ignition::math::Pose3d::Zero);
+  writer.Write(frame);
+  writer.Reset();
+  writer.Write(frame);
+
+  sdf::StateReader reader(stream);
+  sdf::StateFrame read;
+  sdf::Errors errors;
+
+  ASSERT_TRUE(reader.Next(read, errors));
+  EXPECT_EQ(3u, read.LinkCount());
+  ASSERT_TRUE(reader.Next(read, errors));
+  EXPECT_EQ(0u, read.LinkCount());
+  ASSERT_TRUE(reader.Next(read, errors));
+  ASSERT_EQ(1u, read.LinkCount());
+  EXPECT_EQ(ignition::math::Pose3d(0.4, 0, 0, 0, 0, 0), read.LinkPoses()[0]);
+  ASSERT_TRUE(reader.Next(read, errors));
+  ASSERT_EQ(1u, read.ModelCount());
+  EXPECT_EQ("new<&>", read.ModelName(0));
+  EXPECT_EQ("new<&>::link", read.LinkName(0));
+  ASSERT_TRUE(reader.Next(read, errors));
+  EXPECT_EQ(4u, read.LinkCount());
+  EXPECT_TRUE(errors.empty());
+  EXPECT_EQ(5u, writer.Count());
+}
@@ -20,6 +20,8 @@
 #include "sdf/Types.hh"
 #include "sdf/sdf_config.h"
 #include "sdf/system_util.hh"
+#include "ElementRetentionScope.hh"
+#include "LoadStatsScope.hh"
 
 using namespace sdf;
 
@@ -82,9 +84,10 @@ Contact &Contact::operator=(Contact &&_contact)
 /////////////////////////////////////////////////
 Errors Contact::Load(ElementPtr _sdf)
 {
+  DomLoadTimer timer("Contact");
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that sdf is a valid pointer
   if (!_sdf)
@@ -172,9 +175,10 @@ Surface &Surface::operator=(Surface &&_surface)
 /////////////////////////////////////////////////
 Errors Surface::Load(ElementPtr _sdf)
 {
+  DomLoadTimer timer("Surface");
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that sdf is a valid pointer
   if (!_sdf)
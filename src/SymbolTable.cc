@@ -0,0 +1,102 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "SymbolTable.hh"
+
+using namespace sdf;
+
+namespace
+{
+/// \brief Part of the table, with its own lock, so that threads that
+/// intern different strings rarely wait for each other.
+struct SymbolShard
+{
+  /// \brief Protects symbols. Most lookups find an existing symbol, so
+  /// they only take a shared lock.
+  std::shared_mutex mutex;
+
+  /// \brief Strings of the shard, keyed by a view of the owned string.
+  std::unordered_map<std::string_view, std::unique_ptr<const std::string>>
+      symbols;
+};
+
+/// \brief Number of shards, a power of two.
+constexpr std::size_t kShardCount = 16;
+
+/// \brief Get the shards of the process-wide table. The table is never
+/// destroyed, so that elements destroyed by other static objects at exit
+/// still have valid names.
+/// \return The shards.
+std::array<SymbolShard, kShardCount> &shards()
+{
+  static auto *table = new std::array<SymbolShard, kShardCount>();
+  return *table;
+}
+}
+
+/////////////////////////////////////////////////
+Symbol SymbolTable::Intern(std::string_view _str)
+{
+  const std::size_t hash = std::hash<std::string_view>()(_str);
+  SymbolShard &shard = shards()[(hash >> 8) & (kShardCount - 1)];
+
+  {
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    auto iter = shard.symbols.find(_str);
+    if (iter != shard.symbols.end())
+      return iter->second.get();
+  }
+
+  std::unique_lock<std::shared_mutex> lock(shard.mutex);
+  auto iter = shard.symbols.find(_str);
+  if (iter != shard.symbols.end())
+    return iter->second.get();
+
+  auto str = std::make_unique<const std::string>(_str);
+  Symbol symbol = str.get();
+  shard.symbols.emplace(std::string_view(*symbol), std::move(str));
+  return symbol;
+}
+
+/////////////////////////////////////////////////
+Symbol SymbolTable::Empty()
+{
+  static const Symbol empty = Intern(std::string_view());
+  return empty;
+}
+
+/////////////////////////////////////////////////
+std::size_t SymbolTable::Size()
+{
+  std::size_t size = 0;
+  for (SymbolShard &shard : shards())
+  {
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    size += shard.symbols.size();
+  }
+  return size;
+}
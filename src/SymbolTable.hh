@@ -0,0 +1,67 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_SYMBOL_TABLE_HH_
+#define SDF_SYMBOL_TABLE_HH_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include "sdf/sdf_config.h"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief An interned string: the address of the only copy of the string
+  /// in the SymbolTable, so that two symbols are equal if and only if
+  /// their addresses are.
+  using Symbol = const std::string *;
+
+  /// \brief Process-wide table of the identifiers used by elements and
+  /// params, such as element names, attribute keys and type names, so that
+  /// elements hold a pointer to one shared copy of each instead of a
+  /// string of their own.
+  ///
+  /// Since Element::GetName and Param::GetKey return the interned string,
+  /// the address of what they return is a Symbol, and comparing it with a
+  /// Symbol interned once, for example in a function-local static, is an
+  /// integer compare.
+  ///
+  /// Symbols are never removed, so they stay valid for the lifetime of the
+  /// process. The table can be used from several threads at the same time.
+  class SymbolTable
+  {
+    /// \brief Get the symbol of a string, adding it to the table the first
+    /// time it is seen.
+    /// \param[in] _str The string.
+    /// \return The symbol of _str.
+    public: static Symbol Intern(std::string_view _str);
+
+    /// \brief Get the symbol of the empty string.
+    /// \return The symbol of "".
+    public: static Symbol Empty();
+
+    /// \brief Get the number of symbols in the table.
+    /// \return Number of distinct strings interned so far.
+    public: static std::size_t Size();
+  };
+  }
+}
+#endif
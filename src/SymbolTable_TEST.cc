@@ -0,0 +1,73 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "SymbolTable.hh"
+
+/////////////////////////////////////////////////
+TEST(SymbolTable, Intern)
+{
+  const sdf::Symbol link = sdf::SymbolTable::Intern("link");
+  ASSERT_NE(nullptr, link);
+  EXPECT_EQ("link", *link);
+  EXPECT_EQ(link, sdf::SymbolTable::Intern(std::string("link")));
+  EXPECT_NE(link, sdf::SymbolTable::Intern("joint"));
+
+  const std::size_t size = sdf::SymbolTable::Size();
+  sdf::SymbolTable::Intern("link");
+  EXPECT_EQ(size, sdf::SymbolTable::Size());
+  sdf::SymbolTable::Intern("symbol_table_test");
+  EXPECT_EQ(size + 1, sdf::SymbolTable::Size());
+
+  EXPECT_TRUE(sdf::SymbolTable::Empty()->empty());
+  EXPECT_EQ(sdf::SymbolTable::Empty(), sdf::SymbolTable::Intern(""));
+
+  // Long strings keep their address too.
+  const std::string longName(100, 'x');
+  EXPECT_EQ(sdf::SymbolTable::Intern(longName),
+      sdf::SymbolTable::Intern(longName));
+}
+
+/////////////////////////////////////////////////
+TEST(SymbolTable, Threads)
+{
+  const unsigned int threadCount = 4;
+  const int nameCount = 1000;
+  std::vector<std::vector<sdf::Symbol>> symbols(threadCount);
+  std::vector<std::thread> threads;
+  for (unsigned int t = 0; t < threadCount; ++t)
+  {
+    threads.emplace_back([&symbols, t]()
+    {
+      for (int i = 0; i < nameCount; ++i)
+      {
+        symbols[t].push_back(
+            sdf::SymbolTable::Intern("thread_name_" + std::to_string(i)));
+      }
+    });
+  }
+  for (std::thread &thread : threads)
+    thread.join();
+
+  for (unsigned int t = 1; t < threadCount; ++t)
+    EXPECT_EQ(symbols[0], symbols[t]);
+  EXPECT_EQ("thread_name_7", *symbols[0][7]);
+}
@@ -0,0 +1,44 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "Tracing.hh"
+
+#if defined(SDFORMAT_TRACING_PERFETTO)
+
+#include <mutex>
+
+PERFETTO_TRACK_EVENT_STATIC_STORAGE_IN_NAMESPACE(sdf::tracing);
+
+namespace sdf
+{
+namespace tracing
+{
+//////////////////////////////////////////////////
+void RegisterCategories()
+{
+  static std::once_flag registered;
+  if (!perfetto::Tracing::IsInitialized())
+    return;
+  std::call_once(registered, []()
+  {
+    TrackEvent::Register();
+  });
+}
+}
+}
+
+#endif
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_TRACING_HH_
+#define SDF_TRACING_HH_
+
+#include <string>
+
+#include "sdf/sdf_config.h"
+
+/// \file Tracing.hh
+/// \brief Macros that mark the parser hot paths as named scopes of a
+/// profiler. The backend is chosen at compile time with the
+/// SDFORMAT_TRACING CMake option: with the default NONE the macros expand
+/// to nothing and their arguments aren't evaluated, with TRACY the scopes
+/// are Tracy zones, and with PERFETTO they are track events of the
+/// "sdformat" category, which are recorded once the application has
+/// initialized Perfetto.
+///
+/// SDF_TRACE_SCOPE(name) traces the rest of the enclosing block, where
+/// name is a string literal. SDF_TRACE_SCOPE_TEXT(name, text) does the
+/// same and annotates it with a string, such as a file or model name.
+/// Each block can hold one scope.
+
+#if defined(SDFORMAT_TRACING_TRACY)
+
+#include <tracy/Tracy.hpp>
+
+#define SDF_TRACE_SCOPE(_name) ZoneScopedN(_name)
+
+#define SDF_TRACE_SCOPE_TEXT(_name, _text) \
+  ZoneScopedN(_name); \
+  { \
+    const std::string &sdfTraceText = (_text); \
+    ZoneText(sdfTraceText.data(), sdfTraceText.size()); \
+  } \
+  static_cast<void>(0)
+
+#elif defined(SDFORMAT_TRACING_PERFETTO)
+
+#include <perfetto.h>
+
+PERFETTO_DEFINE_CATEGORIES_IN_NAMESPACE(sdf::tracing,
+    perfetto::Category("sdformat").SetDescription(
+        "Parsing and loading of SDFormat documents"));
+
+namespace sdf
+{
+  namespace tracing
+  {
+    /// \brief Register the track events of the library with Perfetto, the
+    /// first time it is called after the application has initialized it.
+    void RegisterCategories();
+  }
+}
+
+#define SDF_TRACE_SCOPE(_name) \
+  PERFETTO_USE_CATEGORIES_FROM_NAMESPACE_SCOPED(sdf::tracing); \
+  ::sdf::tracing::RegisterCategories(); \
+  TRACE_EVENT("sdformat", _name)
+
+#define SDF_TRACE_SCOPE_TEXT(_name, _text) \
+  PERFETTO_USE_CATEGORIES_FROM_NAMESPACE_SCOPED(sdf::tracing); \
+  ::sdf::tracing::RegisterCategories(); \
+  TRACE_EVENT("sdformat", _name, "detail", std::string(_text))
+
+#else
+
+#define SDF_TRACE_SCOPE(_name) static_cast<void>(0)
+
+#define SDF_TRACE_SCOPE_TEXT(_name, _text) static_cast<void>(0)
+
+#endif
+
+#endif
@@ -0,0 +1,75 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "sdf/Root.hh"
+#include "sdf/World.hh"
+#include "Tracing.hh"
+
+namespace
+{
+  /// \brief Number of times traceText has been called.
+  int textCalls = 0;
+
+  /// \brief Text of a traced scope, which counts its evaluations. It is
+  /// unused when tracing is disabled.
+  [[maybe_unused]] std::string traceText()
+  {
+    ++textCalls;
+    return "detail";
+  }
+
+  /// \brief A function with nested traced scopes.
+  int tracedSum(int _a, int _b)
+  {
+    SDF_TRACE_SCOPE("tracedSum");
+    {
+      SDF_TRACE_SCOPE_TEXT("tracedSum::inner", traceText());
+    }
+    return _a + _b;
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(Tracing, Scopes)
+{
+  textCalls = 0;
+  EXPECT_EQ(3, tracedSum(1, 2));
+
+#if defined(SDFORMAT_TRACING_TRACY) || defined(SDFORMAT_TRACING_PERFETTO)
+  // The text is evaluated once per scope.
+  EXPECT_EQ(1, textCalls);
+#else
+  // Without a backend the arguments are not evaluated.
+  EXPECT_EQ(0, textCalls);
+#endif
+}
+
+/////////////////////////////////////////////////
+TEST(Tracing, LoadTraced)
+{
+  sdf::Root root;
+  sdf::Errors errors = root.LoadSdfString(
+      "<sdf version='1.8'><world name='w'><model name='m'>"
+      "<link name='l'/></model></world></sdf>");
+  EXPECT_TRUE(errors.empty());
+  ASSERT_EQ(1u, root.WorldCount());
+  EXPECT_EQ(1u, root.WorldByIndex(0)->ModelCount());
+}
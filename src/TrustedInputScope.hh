@@ -0,0 +1,72 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_TRUSTED_INPUT_SCOPE_HH_
+#define SDF_TRUSTED_INPUT_SCOPE_HH_
+
+#include "sdf/ParserConfig.hh"
+#include "sdf/sdf_config.h"
+
+/// \ingroup sdf_parser
+/// \brief namespace for Simulation Description Format parser
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief Sets whether the DOM objects loaded on the current thread while
+  /// this scope is alive skip the checks that only validate their element,
+  /// as set by ParserConfig::SetTrustedInput. The previous setting is
+  /// restored when the scope is destroyed, so scopes can nest.
+  class TrustedInputScope
+  {
+    /// \brief Constructor
+    /// \param[in] _trusted True to skip the validation in this scope.
+    public: explicit TrustedInputScope(bool _trusted)
+      : previous(Trusted())
+    {
+      Trusted() = _trusted;
+    }
+
+    /// \brief Constructor that uses the setting of a ParserConfig.
+    /// \param[in] _config Parser configuration.
+    public: explicit TrustedInputScope(const ParserConfig &_config)
+      : TrustedInputScope(_config.TrustedInput())
+    {
+    }
+
+    /// \brief Destructor
+    public: ~TrustedInputScope()
+    {
+      Trusted() = this->previous;
+    }
+
+    /// \brief Get the setting of the current thread.
+    /// \return Reference to the setting, which is true when the input is
+    /// trusted.
+    public: static bool &Trusted()
+    {
+      static thread_local bool trusted = false;
+      return trusted;
+    }
+
+    /// \brief Setting that was current before this scope.
+    private: bool previous;
+  };
+  }
+}
+#endif
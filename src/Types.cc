@@ -17,6 +17,7 @@
 
 #include <locale>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "sdf/Types.hh"
@@ -30,39 +31,28 @@ std::vector<std::string> split(const std::string &_str,
                                const std::string &_splitter)
 {
   std::vector<std::string> ret;
-  size_t next = 0;
-  size_t current = next;
-
-  if (_splitter.empty())
-  {
-    // If the splitter is blank, just return the original
-    ret.push_back(_str);
-    return ret;
-  }
-
-  while (next != std::string::npos)
-  {
-    next = _str.find(_splitter, current);
-    ret.push_back(_str.substr(current, next - current));
-    current = next + _splitter.length();
-  }
-
+  for (std::string_view token : SplitRange(_str, _splitter))
+    ret.emplace_back(token);
   return ret;
 }
 
-//////////////////////////////////////////////////
-std::string trim(const char *_in)
+/////////////////////////////////////////////////
+std::vector<std::string_view> splitView(std::string_view _str,
+                                        std::string_view _splitter)
 {
-  return sdf::trim(std::string(_in));
+  std::vector<std::string_view> ret;
+  for (std::string_view token : SplitRange(_str, _splitter))
+    ret.push_back(token);
+  return ret;
 }
 
 //////////////////////////////////////////////////
-std::string trim(const std::string &_in)
+std::string_view trimView(std::string_view _in)
 {
   const size_t strBegin = _in.find_first_not_of(" \t\n");
-  if (strBegin == std::string::npos)
+  if (strBegin == std::string_view::npos)
   {
-    return "";
+    return std::string_view();
   }
 
   const size_t strRange = _in.find_last_not_of(" \t\n") - strBegin + 1;
@@ -70,12 +60,27 @@ std::string trim(const std::string &_in)
   return _in.substr(strBegin, strRange);
 }
 
+//////////////////////////////////////////////////
+std::string trim(const char *_in)
+{
+  return std::string(sdf::trimView(_in));
+}
+
+//////////////////////////////////////////////////
+std::string trim(const std::string &_in)
+{
+  return std::string(sdf::trimView(_in));
+}
+
 /////////////////////////////////////////////////
-std::string lowercase(const std::string &_in)
+std::string lowercase(std::string_view _in)
 {
-  std::string out = _in;
-  for (size_t i = 0; i < out.size(); ++i)
-    out[i] = std::tolower(out[i], std::locale());
+  std::string out(_in);
+  // Get the facet of the global locale once, instead of constructing a
+  // locale for every character.
+  const std::locale locale;
+  std::use_facet<std::ctype<char>>(locale).tolower(
+      &out[0], &out[0] + out.size());
   return out;
 }
 
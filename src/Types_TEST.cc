@@ -18,6 +18,7 @@
 #include <gtest/gtest.h>
 
 #include <string>
+#include <string_view>
 #include <sstream>
 #include <vector>
 
@@ -73,6 +74,70 @@ TEST(Types, split_no_matches)
   EXPECT_EQ(split[0], "hello/there");
 }
 
+/////////////////////////////////////////////////
+TEST(Types, split_view)
+{
+  const std::string str = "a b  c";
+  std::vector<std::string_view> split = sdf::splitView(str, " ");
+  ASSERT_EQ(split.size(), 4UL);
+  EXPECT_EQ(split[0], "a");
+  EXPECT_EQ(split[1], "b");
+  EXPECT_EQ(split[2], "");
+  EXPECT_EQ(split[3], "c");
+
+  // The tokens point into the string.
+  EXPECT_EQ(str.data(), split[0].data());
+
+  for (const std::string input : {"", "hello", "a::b::", "::"})
+  {
+    for (const std::string splitter : {"", ":", "::"})
+    {
+      std::vector<std::string> expected = sdf::split(input, splitter);
+      std::vector<std::string_view> actual = sdf::splitView(input, splitter);
+      ASSERT_EQ(expected.size(), actual.size());
+      for (size_t i = 0; i < expected.size(); ++i)
+        EXPECT_EQ(expected[i], actual[i]);
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(Types, split_range)
+{
+  std::vector<std::string_view> tokens;
+  for (std::string_view token : sdf::SplitRange("model::link::", "::"))
+    tokens.push_back(token);
+  ASSERT_EQ(tokens.size(), 3UL);
+  EXPECT_EQ(tokens[0], "model");
+  EXPECT_EQ(tokens[1], "link");
+  EXPECT_EQ(tokens[2], "");
+
+  sdf::SplitRange range("", " ");
+  EXPECT_NE(range.begin(), range.end());
+  EXPECT_EQ(*range.begin(), "");
+  EXPECT_EQ(++range.begin(), range.end());
+}
+
+/////////////////////////////////////////////////
+TEST(Types, trim_view)
+{
+  EXPECT_EQ(sdf::trimView("hello"), "hello");
+  EXPECT_EQ(sdf::trimView(" \thello there\n "), "hello there");
+  EXPECT_EQ(sdf::trimView("   "), "");
+  EXPECT_EQ(sdf::trimView(""), "");
+
+  const std::string str = "  xyz";
+  EXPECT_EQ(str.data() + 2, sdf::trimView(str).data());
+}
+
+/////////////////////////////////////////////////
+TEST(Types, lowercase)
+{
+  EXPECT_EQ(sdf::lowercase("TrUe"), "true");
+  EXPECT_EQ(sdf::lowercase(std::string_view("0X1F").substr(0, 2)), "0x");
+  EXPECT_EQ(sdf::lowercase(""), "");
+}
+
 /////////////////////////////////////////////////
 TEST(Types, trim_nothing)
 {
@@ -0,0 +1,133 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <utility>
+
+#include "UrdfCache.hh"
+#include "XmlUtils.hh"
+
+using namespace sdf;
+
+/////////////////////////////////////////////////
+/// \brief Copy the nodes of a document into another one.
+/// \param[in] _src Document to copy.
+/// \param[out] _dst Document the nodes are appended to.
+static void copyDocument(const tinyxml2::XMLDocument &_src,
+    tinyxml2::XMLDocument *_dst)
+{
+  for (const tinyxml2::XMLNode *node = _src.FirstChild(); node;
+       node = node->NextSibling())
+  {
+    tinyxml2::XMLNode *clone = DeepClone(_dst, node);
+    if (clone)
+      _dst->LinkEndChild(clone);
+  }
+}
+
+/////////////////////////////////////////////////
+UrdfCache &UrdfCache::Instance()
+{
+  static UrdfCache cache;
+  return cache;
+}
+
+/////////////////////////////////////////////////
+bool UrdfCache::Get(std::string_view _urdf, bool _enforceLimits,
+    tinyxml2::XMLDocument *_sdf)
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  Index &byText = this->index[_enforceLimits];
+  auto iter = byText.find(_urdf);
+  if (iter == byText.end())
+    return false;
+
+  // Move the entry to the front, and copy it while it can't be removed.
+  this->entries.splice(this->entries.begin(), this->entries, iter->second);
+  copyDocument(*iter->second->sdf, _sdf);
+  return true;
+}
+
+/////////////////////////////////////////////////
+void UrdfCache::Put(std::string_view _urdf, bool _enforceLimits,
+    const tinyxml2::XMLDocument &_sdf)
+{
+  // Copy the document before taking the lock.
+  auto sdf = std::make_unique<tinyxml2::XMLDocument>();
+  copyDocument(_sdf, sdf.get());
+
+  std::lock_guard<std::mutex> lock(this->mutex);
+  if (this->capacity == 0)
+    return;
+
+  Index &byText = this->index[_enforceLimits];
+  auto iter = byText.find(_urdf);
+  if (iter != byText.end())
+  {
+    iter->second->sdf = std::move(sdf);
+    this->entries.splice(this->entries.begin(), this->entries, iter->second);
+    return;
+  }
+
+  Entry &entry = this->entries.emplace_front();
+  entry.urdf = std::string(_urdf);
+  entry.enforceLimits = _enforceLimits;
+  entry.sdf = std::move(sdf);
+  byText.emplace(entry.urdf, this->entries.begin());
+  this->Trim();
+}
+
+/////////////////////////////////////////////////
+void UrdfCache::Clear()
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->index[0].clear();
+  this->index[1].clear();
+  this->entries.clear();
+}
+
+/////////////////////////////////////////////////
+void UrdfCache::SetCapacity(std::size_t _capacity)
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->capacity = _capacity;
+  this->Trim();
+}
+
+/////////////////////////////////////////////////
+std::size_t UrdfCache::Capacity() const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->capacity;
+}
+
+/////////////////////////////////////////////////
+std::size_t UrdfCache::Size() const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->entries.size();
+}
+
+/////////////////////////////////////////////////
+void UrdfCache::Trim()
+{
+  while (this->entries.size() > this->capacity)
+  {
+    const Entry &entry = this->entries.back();
+    this->index[entry.enforceLimits].erase(entry.urdf);
+    this->entries.pop_back();
+  }
+}
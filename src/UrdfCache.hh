@@ -0,0 +1,125 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_URDF_CACHE_HH_
+#define SDF_URDF_CACHE_HH_
+
+#include <tinyxml2.h>
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "sdf/sdf_config.h"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief Process-wide cache of URDF models converted to SDFormat.
+  ///
+  /// Processes that load the same robot description in many components
+  /// convert it once: entries are keyed by the text of the URDF model and
+  /// the conversion options, and hold the SDFormat document URDF2SDF made
+  /// of it, before it is read into elements, since the elements depend on
+  /// the ParserConfig of each read. Lookups hand out copies, so callers
+  /// are free to modify the result. The messages printed by a conversion
+  /// are not printed again on a hit.
+  class UrdfCache
+  {
+    /// \brief Get the process-wide cache.
+    /// \return The URDF cache.
+    public: static UrdfCache &Instance();
+
+    /// \brief Look up a converted model.
+    /// \param[in] _urdf Text of the URDF model.
+    /// \param[in] _enforceLimits Whether the conversion enforces the joint
+    /// limits.
+    /// \param[out] _sdf Document the converted model is copied into on a
+    /// hit. It should be empty.
+    /// \return True on a hit.
+    public: bool Get(std::string_view _urdf, bool _enforceLimits,
+                     tinyxml2::XMLDocument *_sdf);
+
+    /// \brief Store a converted model.
+    /// \param[in] _urdf Text of the URDF model.
+    /// \param[in] _enforceLimits Whether the conversion enforced the joint
+    /// limits.
+    /// \param[in] _sdf The converted model, which is copied.
+    public: void Put(std::string_view _urdf, bool _enforceLimits,
+                     const tinyxml2::XMLDocument &_sdf);
+
+    /// \brief Remove all entries.
+    public: void Clear();
+
+    /// \brief Set the maximum number of entries. The least recently used
+    /// entries are removed when the cache is full. A capacity of 0 disables
+    /// the cache.
+    /// \param[in] _capacity Maximum number of entries.
+    public: void SetCapacity(std::size_t _capacity);
+
+    /// \brief Get the maximum number of entries.
+    /// \return The capacity.
+    public: std::size_t Capacity() const;
+
+    /// \brief Get the number of entries.
+    /// \return The number of cached models.
+    public: std::size_t Size() const;
+
+    /// \brief A converted model.
+    private: struct Entry
+    {
+      /// \brief Text of the URDF model.
+      std::string urdf;
+
+      /// \brief Whether the conversion enforced the joint limits.
+      bool enforceLimits = true;
+
+      /// \brief The converted model.
+      std::unique_ptr<tinyxml2::XMLDocument> sdf;
+    };
+
+    /// \brief Position of each entry in the entries list, keyed by a view
+    /// of the text of its model.
+    private: using Index =
+        std::unordered_map<std::string_view, std::list<Entry>::iterator>;
+
+    /// \brief Remove least recently used entries until the size is within
+    /// capacity. The mutex must be held.
+    private: void Trim();
+
+    /// \brief Protects the members below.
+    private: mutable std::mutex mutex;
+
+    /// \brief Entries, most recently used first.
+    private: std::list<Entry> entries;
+
+    /// \brief Index of the entries, for each value of enforceLimits.
+    private: Index index[2];
+
+    /// \brief Maximum number of entries. Robot descriptions are large, and
+    /// processes load few distinct ones.
+    private: std::size_t capacity = 16;
+  };
+  }
+}
+#endif
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "UrdfCache.hh"
+
+/////////////////////////////////////////////////
+/// \brief Print a document.
+/// \param[in] _doc Document to print.
+/// \return The text of the document.
+static std::string print(const tinyxml2::XMLDocument &_doc)
+{
+  tinyxml2::XMLPrinter printer;
+  _doc.Print(&printer);
+  return printer.CStr();
+}
+
+/////////////////////////////////////////////////
+TEST(UrdfCache, GetPut)
+{
+  sdf::UrdfCache cache;
+  const std::string urdf = "<robot name='r'><link name='l'/></robot>";
+
+  tinyxml2::XMLDocument miss;
+  EXPECT_FALSE(cache.Get(urdf, true, &miss));
+  EXPECT_EQ(nullptr, miss.FirstChild());
+
+  tinyxml2::XMLDocument sdf;
+  sdf.Parse("<sdf version='1.7'><model name='r'/></sdf>");
+  cache.Put(urdf, true, sdf);
+  EXPECT_EQ(1u, cache.Size());
+
+  // Hits are copies of the stored document.
+  tinyxml2::XMLDocument hit;
+  ASSERT_TRUE(cache.Get(urdf, true, &hit));
+  EXPECT_EQ(print(sdf), print(hit));
+  hit.FirstChildElement("sdf")->SetAttribute("version", "1.8");
+  tinyxml2::XMLDocument again;
+  ASSERT_TRUE(cache.Get(urdf, true, &again));
+  EXPECT_EQ(print(sdf), print(again));
+
+  // The options of the conversion are part of the key.
+  tinyxml2::XMLDocument other;
+  EXPECT_FALSE(cache.Get(urdf, false, &other));
+  EXPECT_FALSE(cache.Get(urdf + " ", true, &other));
+
+  cache.Clear();
+  EXPECT_EQ(0u, cache.Size());
+  EXPECT_FALSE(cache.Get(urdf, true, &other));
+}
+
+/////////////////////////////////////////////////
+TEST(UrdfCache, Capacity)
+{
+  sdf::UrdfCache cache;
+  EXPECT_EQ(16u, cache.Capacity());
+  cache.SetCapacity(2u);
+
+  tinyxml2::XMLDocument sdf;
+  sdf.Parse("<sdf version='1.7'/>");
+  cache.Put("a", true, sdf);
+  cache.Put("b", true, sdf);
+
+  // Looking up a makes b the least recently used entry.
+  tinyxml2::XMLDocument doc;
+  EXPECT_TRUE(cache.Get("a", true, &doc));
+  cache.Put("c", true, sdf);
+  EXPECT_EQ(2u, cache.Size());
+  tinyxml2::XMLDocument a, b, c;
+  EXPECT_TRUE(cache.Get("a", true, &a));
+  EXPECT_FALSE(cache.Get("b", true, &b));
+  EXPECT_TRUE(cache.Get("c", true, &c));
+
+  // A capacity of 0 disables the cache.
+  cache.SetCapacity(0u);
+  EXPECT_EQ(0u, cache.Size());
+  cache.Put("a", true, sdf);
+  EXPECT_EQ(0u, cache.Size());
+}
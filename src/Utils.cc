@@ -14,8 +14,24 @@
  * limitations under the License.
  *
 */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
+#include "sdf/CancellationToken.hh"
+#include "DiagnosticScope.hh"
+#include "ElementArena.hh"
+#include "ElementReclaimer.hh"
+#include "ElementRetentionScope.hh"
+#include "ExecutorScope.hh"
+#include "LazyModelScope.hh"
+#include "LoadStatsScope.hh"
+#include "TrustedInputScope.hh"
 #include "Utils.hh"
 
 namespace sdf
@@ -80,5 +96,189 @@ bool isValidFrameReference(const std::string &_name)
 {
   return "__root__" != _name;
 }
+
+/////////////////////////////////////////////////
+bool errorBudgetReached(const Errors &_errors, const ParserConfig &_config)
+{
+  return _config.MaxErrors() != 0 && _errors.size() >= _config.MaxErrors();
+}
+
+/////////////////////////////////////////////////
+bool loadCancelled(const ParserConfig &_config)
+{
+  const CancellationToken *token = _config.Cancellation();
+  if (token && token->Cancelled())
+    return true;
+
+  // Loads without a deadline don't read the clock.
+  const auto deadline = _config.Deadline();
+  return deadline != std::chrono::steady_clock::time_point::max() &&
+      std::chrono::steady_clock::now() >= deadline;
+}
+
+/////////////////////////////////////////////////
+bool loadStopped(const Errors &_errors, const ParserConfig &_config)
+{
+  return errorBudgetReached(_errors, _config) || loadCancelled(_config);
+}
+
+/////////////////////////////////////////////////
+void reportCancellation(Errors &_errors, const ParserConfig &_config)
+{
+  if (!loadCancelled(_config))
+    return;
+
+  const auto reported = [](const Error &_error)
+  {
+    return _error.Code() == ErrorCode::LOAD_CANCELLED ||
+        _error.Code() == ErrorCode::LOAD_DEADLINE_EXCEEDED;
+  };
+  if (std::any_of(_errors.begin(), _errors.end(), reported))
+    return;
+
+  const CancellationToken *token = _config.Cancellation();
+  if (token && token->Cancelled())
+    _errors.push_back({ErrorCode::LOAD_CANCELLED, "The load was cancelled."});
+  else
+  {
+    _errors.push_back({ErrorCode::LOAD_DEADLINE_EXCEEDED,
+        "The load didn't finish before its deadline."});
+  }
+}
+
+/////////////////////////////////////////////////
+void truncateErrors(Errors &_errors, const ParserConfig &_config)
+{
+  if (errorBudgetReached(_errors, _config))
+    _errors.resize(_config.MaxErrors());
+  reportCancellation(_errors, _config);
+}
+
+/////////////////////////////////////////////////
+void parallelFor(std::size_t _count, unsigned int _threadCount,
+    const std::function<void(std::size_t)> &_func)
+{
+  if (_count == 0)
+    return;
+
+  std::shared_ptr<Executor> executor;
+  std::size_t threadCount = _threadCount;
+  if (threadCount != 1)
+  {
+    executor = ExecutorScope::Get();
+    if (threadCount == 0)
+      threadCount = executor->Concurrency() + 1u;
+  }
+  threadCount = std::min(threadCount, _count);
+
+  if (threadCount <= 1)
+  {
+    for (std::size_t i = 0; i < _count; ++i)
+      _func(i);
+    return;
+  }
+
+  // The tasks outlive the call when they start after the loop is over, so
+  // they share its state, and only use the function while it is running.
+  struct Loop
+  {
+    /// \brief Next unprocessed index. Threads pull the next index, which
+    /// balances sibling objects of very different sizes.
+    std::atomic<std::size_t> next{0};
+
+    /// \brief Protects running, finished and exception.
+    std::mutex mutex;
+
+    /// \brief Signals the calling thread that a task finished.
+    std::condition_variable idle;
+
+    /// \brief Number of tasks that are running.
+    std::size_t running = 0;
+
+    /// \brief True once the calling thread finished, after which the tasks
+    /// that start do nothing.
+    bool finished = false;
+
+    /// \brief First exception thrown by the function.
+    std::exception_ptr exception;
+  };
+  auto loop = std::make_shared<Loop>();
+
+  // Report load statistics from the workers to the caller's destination.
+  LoadStats *stats = LoadStatsScope::Current();
+
+  // Elements created by the workers come from the caller's arena.
+  std::shared_ptr<ElementArena> arena = ElementArenaScope::Current();
+
+  // DOM objects loaded by the workers keep their elements like the caller's.
+  const bool release = ElementRetentionScope::Release();
+
+  // Elements created by the workers are released like the caller's.
+  const bool background = ElementReclaimScope::Background();
+
+  // The workers validate the DOM objects they load like the caller.
+  const bool trusted = TrustedInputScope::Trusted();
+
+  // Models loaded by the workers defer their contents like the caller's.
+  const bool lazy = LazyModelScope::Lazy();
+
+  // Messages of the workers go to the caller's sink, and are deduplicated
+  // with the caller's.
+  LoadDiagnostics *diagnostics = DiagnosticScope::Current();
+
+  auto work = [_count, &_func](Loop &_loop)
+  {
+    try
+    {
+      for (std::size_t i = _loop.next++; i < _count; i = _loop.next++)
+        _func(i);
+    }
+    catch(...)
+    {
+      std::lock_guard<std::mutex> lock(_loop.mutex);
+      if (!_loop.exception)
+        _loop.exception = std::current_exception();
+      _loop.next = _count;
+    }
+  };
+
+  for (std::size_t w = 1; w < threadCount; ++w)
+  {
+    executor->Submit([=, &work]
+        {
+          {
+            std::lock_guard<std::mutex> lock(loop->mutex);
+            if (loop->finished)
+              return;
+            ++loop->running;
+          }
+
+          ExecutorScope executorScope(executor);
+          LoadStatsScope statsScope(stats);
+          ElementArenaScope arenaScope(arena);
+          ElementRetentionScope retentionScope(release);
+          ElementReclaimScope reclaimScope(background);
+          TrustedInputScope trustedScope(trusted);
+          LazyModelScope lazyScope(lazy);
+          DiagnosticScope diagnosticScope(diagnostics);
+          work(*loop);
+
+          std::lock_guard<std::mutex> lock(loop->mutex);
+          --loop->running;
+          loop->idle.notify_all();
+        });
+  }
+  work(*loop);
+
+  std::unique_lock<std::mutex> lock(loop->mutex);
+  loop->finished = true;
+  loop->idle.wait(lock, [&loop]
+      {
+        return loop->running == 0;
+      });
+
+  if (loop->exception)
+    std::rethrow_exception(loop->exception);
+}
 }
 }
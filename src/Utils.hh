@@ -18,10 +18,16 @@
 #define SDFORMAT_UTILS_HH
 
 #include <algorithm>
+#include <cstddef>
+#include <functional>
 #include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include "sdf/Error.hh"
 #include "sdf/Element.hh"
+#include "sdf/ParserConfig.hh"
 #include "sdf/Types.hh"
 
 namespace sdf
@@ -61,71 +67,239 @@ namespace sdf
   bool loadPose(sdf::ElementPtr _sdf, ignition::math::Pose3d &_pose,
                 std::string &_frame);
 
-  /// \brief Load all objects of a specific sdf element type. No error
-  /// is returned if an element is not present. This function assumes that
-  /// an element has a "name" attribute that must be unique.
+  /// \brief Map from the names of DOM objects to their index in the vector
+  /// that holds them.
+  using NameIndex = std::unordered_map<std::string, std::size_t>;
+
+  /// \brief Build the name index of a vector of DOM objects. If several
+  /// objects share a name, the first one is indexed, as a linear search
+  /// would find it.
+  /// \param[in] _objs Objects to index.
+  /// \param[out] _index Index of the objects by name.
+  template <typename Class>
+  void buildNameIndex(const std::vector<Class> &_objs, NameIndex &_index)
+  {
+    _index.clear();
+    _index.reserve(_objs.size());
+    for (std::size_t i = 0; i < _objs.size(); ++i)
+      _index.emplace(_objs[i].Name(), i);
+  }
+
+  /// \brief Find a DOM object by name using its name index.
+  /// \param[in] _objs Indexed objects.
+  /// \param[in] _index Index built by buildNameIndex for _objs.
+  /// \param[in] _name Name of the object.
+  /// \return Pointer to the object, or nullptr if there is no object with
+  /// that name.
+  template <typename Class>
+  const Class *findByName(const std::vector<Class> &_objs,
+      const NameIndex &_index, const std::string &_name)
+  {
+    auto it = _index.find(_name);
+    if (it == _index.end() || it->second >= _objs.size())
+      return nullptr;
+    return &_objs[it->second];
+  }
+
+  /// \brief Call a function once for every index in [0.._count), using up
+  /// to _threadCount threads. The calling thread takes part in the work,
+  /// and the other threads are tasks of the executor of the current
+  /// ExecutorScope, so nested calls share its threads. The calling thread
+  /// never waits for a task that didn't start, and does its share of the
+  /// work instead. If any invocation throws, the remaining indices are
+  /// skipped and the first exception is rethrown on the calling thread once
+  /// all threads have finished.
+  /// \param[in] _count Number of indices to process.
+  /// \param[in] _threadCount Maximum number of threads to use. A value of
+  /// 0 uses the calling thread and one task per thread of the executor, and
+  /// a value of 1 runs every invocation sequentially on the calling thread.
+  /// \param[in] _func Function to call with each index.
+  void parallelFor(std::size_t _count, unsigned int _threadCount,
+      const std::function<void(std::size_t)> &_func);
+
+  /// \brief Check whether a load has reached the maximum number of errors
+  /// of its configuration, after which it should stop traversing.
+  /// \param[in] _errors Errors of the load so far.
+  /// \param[in] _config Configuration of the load.
+  /// \return True if ParserConfig::MaxErrors is set and reached.
+  bool errorBudgetReached(const Errors &_errors, const ParserConfig &_config);
+
+  /// \brief Check whether a load was cancelled through the token of its
+  /// configuration, or is past the deadline of its configuration.
+  /// \param[in] _config Configuration of the load.
+  /// \return True if the load should stop.
+  bool loadCancelled(const ParserConfig &_config);
+
+  /// \brief Check whether a load should stop traversing, because it has
+  /// reached the maximum number of errors of its configuration or it was
+  /// cancelled.
+  /// \param[in] _errors Errors of the load so far.
+  /// \param[in] _config Configuration of the load.
+  /// \return True if errorBudgetReached or loadCancelled.
+  bool loadStopped(const Errors &_errors, const ParserConfig &_config);
+
+  /// \brief Add the error of a cancelled load, an ErrorCode::LOAD_CANCELLED
+  /// or ErrorCode::LOAD_DEADLINE_EXCEEDED error, unless the errors have one
+  /// already, e.g. from a nested load.
+  /// \param[in,out] _errors Errors of the load.
+  /// \param[in] _config Configuration of the load.
+  void reportCancellation(Errors &_errors, const ParserConfig &_config);
+
+  /// \brief Drop the errors past the maximum number of errors of a
+  /// configuration, at the end of a load, and add the error of a cancelled
+  /// load after them.
+  /// \param[in,out] _errors Errors of the load.
+  /// \param[in] _config Configuration of the load.
+  void truncateErrors(Errors &_errors, const ParserConfig &_config);
+
+  /// \brief Add an error unless the maximum number of errors has been
+  /// reached. The message is only formatted when the error is added, so
+  /// that errors past the maximum cost nothing.
+  /// \param[in,out] _errors Errors of the load.
+  /// \param[in] _config Configuration of the load.
+  /// \param[in] _code Code of the error.
+  /// \param[in] _message Function that returns the message of the error.
+  template <typename MessageFunc>
+  void addError(Errors &_errors, const ParserConfig &_config,
+      ErrorCode _code, MessageFunc &&_message)
+  {
+    if (!errorBudgetReached(_errors, _config))
+      _errors.emplace_back(_code, _message());
+  }
+
+  /// \brief Load all objects of a specific sdf element type, optionally
+  /// loading sibling elements concurrently. No error is returned if an
+  /// element is not present. This function assumes that an element has a
+  /// "name" attribute that must be unique.
+  ///
+  /// Each element is loaded into its own object, so Class::Load must only
+  /// read and modify the element subtree it is given. Duplicate name checks
+  /// and error merging happen afterwards in document order, so the result
+  /// does not depend on _threadCount.
   /// \param[in] _sdf The SDF element that contains zero or more elements.
   /// \param[in] _sdfName Name of the sdf element, such as "model".
   /// \param[out] _objs Elements that match _sdfName in _sdf are added to this
   /// vector, unless an error is encountered during load or a duplicate name
   /// exists.
+  /// \param[in] _threadCount Maximum number of threads used to load the
+  /// elements, see parallelFor.
   /// \return The vector of errors. An empty vector indicates no errors were
   /// experienced.
   template <typename Class>
   sdf::Errors loadUniqueRepeated(sdf::ElementPtr _sdf,
-      const std::string &_sdfName, std::vector<Class> &_objs)
+      const std::string &_sdfName, std::vector<Class> &_objs,
+      unsigned int _threadCount)
   {
-    Errors errors;
+    return loadUniqueRepeated<Class>(_sdf, _sdfName, _objs,
+        [_threadCount](const std::vector<sdf::ElementPtr> &_elems,
+                       std::vector<Class> &_loaded,
+                       std::vector<Errors> &_loadErrors)
+        {
+          parallelFor(_elems.size(), _threadCount, [&](std::size_t _index)
+          {
+            _loadErrors[_index] = _loaded[_index].Load(_elems[_index]);
+          });
+        });
+  }
 
-    std::vector<std::string> names;
+  /// \brief Load all objects of a specific sdf element type with a custom
+  /// load function, such as one that shares data between identical
+  /// elements. Duplicate names are checked as with the other overloads.
+  /// \param[in] _sdf The SDF element that contains zero or more elements.
+  /// \param[in] _sdfName Name of the sdf element, such as "model".
+  /// \param[out] _objs Elements that match _sdfName in _sdf are added to this
+  /// vector, unless an error is encountered during load or a duplicate name
+  /// exists.
+  /// \param[in] _load Function that loads every element into the object
+  /// with the same index, and sets the errors of that index. The objects
+  /// and errors are sized to the elements beforehand.
+  /// \return The vector of errors. An empty vector indicates no errors were
+  /// experienced.
+  template <typename Class>
+  sdf::Errors loadUniqueRepeated(sdf::ElementPtr _sdf,
+      const std::string &_sdfName, std::vector<Class> &_objs,
+      const std::function<void(const std::vector<sdf::ElementPtr> &,
+          std::vector<Class> &, std::vector<Errors> &)> &_load)
+  {
+    // Growing the vectors must move the objects instead of deep-copying
+    // their private data.
+    static_assert(std::is_nothrow_move_constructible<Class>::value,
+        "DOM classes must have a noexcept move constructor");
+
+    Errors errors;
 
     // Check that an element exists.
-    if (_sdf->HasElement(_sdfName))
+    if (!_sdf->HasElement(_sdfName))
     {
-      // Read all the elements.
-      sdf::ElementPtr elem = _sdf->GetElement(_sdfName);
-      while (elem)
-      {
-        Class obj;
+      // Do not add an error if the model tag is missing. This is an internal
+      // function that is called by class without checking if an element
+      // actually exists. This is a bit of safe code reduction.
+      return errors;
+    }
 
-        // Load the model and capture the errors.
-        Errors loadErrors = obj.Load(elem);
+    // Gather the elements up front so they can be loaded independently.
+    std::vector<sdf::ElementPtr> elems;
+    elems.reserve(_sdf->CountChildren(_sdfName));
+    for (sdf::ElementPtr elem = _sdf->GetElement(_sdfName); elem;
+         elem = elem->GetNextElement(_sdfName))
+    {
+      elems.push_back(elem);
+    }
 
-        // keep processing even if there are loadErrors
-        {
-          std::string name;
+    // Load the objects and capture the errors.
+    std::vector<Class> objs(elems.size());
+    std::vector<Errors> loadErrors(elems.size());
+    _load(elems, objs, loadErrors);
 
-          // Read the name for uniqueness checks. Don't report errors here.
-          // Errors are captured in obj.Load(elem) above.
-          sdf::loadName(elem, name);
+    // keep processing even if there are loadErrors
+    _objs.reserve(_objs.size() + objs.size());
+    std::unordered_set<std::string> names;
+    names.reserve(elems.size());
+    for (std::size_t i = 0; i < elems.size(); ++i)
+    {
+      std::string name;
 
-          // Check that the name does not exist.
-          if (std::find(names.begin(), names.end(), name) != names.end())
-          {
-            errors.push_back({ErrorCode::DUPLICATE_NAME,
-                _sdfName + " with name[" + name + "] already exists."});
-          }
-          else
-          {
-            // Add the object to the result if no errors have been encountered.
-            _objs.push_back(std::move(obj));
-            names.push_back(name);
-          }
+      // Read the name for uniqueness checks. Don't report errors here.
+      // Errors are captured in obj.Load(elem) above.
+      sdf::loadName(elems[i], name);
 
-          // Add the load errors to the master error list.
-          errors.insert(errors.end(), loadErrors.begin(), loadErrors.end());
-        }
-
-        elem = elem->GetNextElement(_sdfName);
+      // Check that the name does not exist.
+      if (names.count(name) > 0)
+      {
+        errors.push_back({ErrorCode::DUPLICATE_NAME,
+            _sdfName + " with name[" + name + "] already exists."});
+      }
+      else
+      {
+        // Add the object to the result if no errors have been encountered.
+        _objs.push_back(std::move(objs[i]));
+        names.insert(std::move(name));
       }
+
+      // Add the load errors to the master error list.
+      errors.insert(errors.end(), loadErrors[i].begin(), loadErrors[i].end());
     }
-    // Do not add an error if the model tag is missing. This is an internal
-    // function that is called by class without checking if an element actually
-    // exists. This is a bit of safe code reduction.
 
     return errors;
   }
 
+  /// \brief Load all objects of a specific sdf element type. No error
+  /// is returned if an element is not present. This function assumes that
+  /// an element has a "name" attribute that must be unique.
+  /// \param[in] _sdf The SDF element that contains zero or more elements.
+  /// \param[in] _sdfName Name of the sdf element, such as "model".
+  /// \param[out] _objs Elements that match _sdfName in _sdf are added to this
+  /// vector, unless an error is encountered during load or a duplicate name
+  /// exists.
+  /// \return The vector of errors. An empty vector indicates no errors were
+  /// experienced.
+  template <typename Class>
+  sdf::Errors loadUniqueRepeated(sdf::ElementPtr _sdf,
+      const std::string &_sdfName, std::vector<Class> &_objs)
+  {
+    return loadUniqueRepeated(_sdf, _sdfName, _objs, 1u);
+  }
+
   /// \brief Load all objects of a specific sdf element type. No error
   /// is returned if an element is not present.
   /// \param[in] _sdf The SDF element that contains zero or more elements.
@@ -139,16 +313,23 @@ namespace sdf
       std::vector<Class> &_objs,
       const std::function<void(Class &)> &_beforeLoadFunc = {})
   {
+    static_assert(std::is_nothrow_move_constructible<Class>::value,
+        "DOM classes must have a noexcept move constructor");
+
     Errors errors;
 
     // Check that an element exists.
     if (_sdf->HasElement(_sdfName))
     {
+      // Reserve exactly so that every object is loaded in place.
+      _objs.reserve(_objs.size() + _sdf->CountChildren(_sdfName));
+
       // Read all the elements.
       sdf::ElementPtr elem = _sdf->GetElement(_sdfName);
       while (elem)
       {
-        Class obj;
+        // Keep the object even if it has load errors.
+        Class &obj = _objs.emplace_back();
         if (_beforeLoadFunc)
         {
           _beforeLoadFunc(obj);
@@ -157,13 +338,8 @@ namespace sdf
         // Load the model and capture the errors.
         Errors loadErrors = obj.Load(elem);
 
-        {
-          // Add the load errors to the master error list.
-          errors.insert(errors.end(), loadErrors.begin(), loadErrors.end());
-
-          // but keep object anyway
-          _objs.push_back(std::move(obj));
-        }
+        // Add the load errors to the master error list.
+        errors.insert(errors.end(), loadErrors.begin(), loadErrors.end());
 
         elem = elem->GetNextElement(_sdfName);
       }
@@ -0,0 +1,560 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "sdf/Filesystem.hh"
+#include "sdf/VirtualFilesystem.hh"
+#include "MappedFile.hh"
+
+using namespace sdf;
+
+// An archive is a header, followed by the index of its files and then by
+// their content. All integers are little endian.
+//
+//   char[8]  magic, "SDFARCHV"
+//   uint32   format version, 1
+//   uint32   number of files
+//   for each file:
+//     uint32   length of the path
+//     uint64   offset of the content from the start of the archive
+//     uint64   size of the content
+//     char[]   path relative to the archived directory, with '/' separators
+
+/// \brief First bytes of an archive.
+static const char kArchiveMagic[8] = {'S', 'D', 'F', 'A', 'R', 'C', 'H', 'V'};
+
+/// \brief Version of the archive format.
+static const std::uint32_t kArchiveVersion = 1;
+
+/// \brief A file of the native filesystem, mapped into memory.
+class NativeFile : public VirtualFile
+{
+  // Documentation inherited.
+  public: const char *Data() const override
+  {
+    return this->file.Data();
+  }
+
+  // Documentation inherited.
+  public: std::size_t Size() const override
+  {
+    return this->file.Size();
+  }
+
+  /// \brief The mapped file.
+  public: MappedFile file;
+};
+
+/// \brief Files of the operating system.
+class NativeFilesystem : public VirtualFilesystem
+{
+  // Documentation inherited.
+  public: bool Exists(const std::string &_path) const override
+  {
+    return sdf::filesystem::exists(_path);
+  }
+
+  // Documentation inherited.
+  public: bool IsDirectory(const std::string &_path) const override
+  {
+    return sdf::filesystem::is_directory(_path);
+  }
+
+  // Documentation inherited.
+  public: bool Stat(const std::string &_path,
+                    VirtualFileStatus &_status) const override
+  {
+#ifdef _WIN32
+    struct _stat64 info;
+    if (::_stat64(_path.c_str(), &info) != 0)
+      return false;
+    _status.modified = static_cast<std::int64_t>(info.st_mtime);
+#else
+    struct stat info;
+    if (::stat(_path.c_str(), &info) != 0)
+      return false;
+#ifdef __APPLE__
+    _status.modified = static_cast<std::int64_t>(info.st_mtimespec.tv_sec) *
+        1000000000 + info.st_mtimespec.tv_nsec;
+#else
+    _status.modified = static_cast<std::int64_t>(info.st_mtim.tv_sec) *
+        1000000000 + info.st_mtim.tv_nsec;
+#endif
+#endif
+    _status.size = static_cast<std::int64_t>(info.st_size);
+    return true;
+  }
+
+  // Documentation inherited.
+  public: std::unique_ptr<VirtualFile> Open(
+              const std::string &_path) const override
+  {
+    auto file = std::make_unique<NativeFile>();
+    if (!file->file.Open(_path))
+      return nullptr;
+    return file;
+  }
+};
+
+/// \brief A file of an archive, which points into the mapped archive.
+class ArchiveFile : public VirtualFile
+{
+  /// \brief Constructor
+  /// \param[in] _data Content of the file.
+  /// \param[in] _size Size of the content.
+  public: ArchiveFile(const char *_data, std::size_t _size)
+    : data(_data), size(_size)
+  {
+  }
+
+  // Documentation inherited.
+  public: const char *Data() const override
+  {
+    return this->data;
+  }
+
+  // Documentation inherited.
+  public: std::size_t Size() const override
+  {
+    return this->size;
+  }
+
+  /// \brief Content of the file.
+  private: const char *data;
+
+  /// \brief Size of the content.
+  private: std::size_t size;
+};
+
+/// \brief Private data for ArchiveFilesystem.
+class sdf::ArchiveFilesystemPrivate
+{
+  /// \brief Get the path of a file relative to the mount point.
+  /// \param[in] _path Path of the file.
+  /// \param[out] _relative Set to the normalized relative path, which is
+  /// empty for the mount point itself.
+  /// \return False if _path is not under the mount point.
+  public: bool Relative(const std::string &_path,
+                        std::string &_relative) const;
+
+  /// \brief Content of a file of the archive.
+  public: struct Entry
+  {
+    /// \brief First byte of the content, in the mapping.
+    const char *data;
+
+    /// \brief Size of the content.
+    std::size_t size;
+  };
+
+  /// \brief The mapped archive.
+  public: MappedFile archive;
+
+  /// \brief Mount point, with '/' separators and no trailing separator.
+  /// Only paths that start with it are looked up in the archive.
+  public: std::string mountPoint;
+
+  /// \brief Modification time of the archive, which is reported for all
+  /// of its files.
+  public: std::int64_t modified = 0;
+
+  /// \brief Files by relative path.
+  public: std::unordered_map<std::string, Entry> files;
+
+  /// \brief Relative paths of the directories that contain files,
+  /// including the empty path of the mount point.
+  public: std::unordered_set<std::string> directories;
+};
+
+/////////////////////////////////////////////////
+/// \brief Split a path into its components, dropping empty components and
+/// "." and resolving "..".
+/// \param[in] _path Path with '/' or '\\' separators.
+/// \param[out] _parts Components of the path.
+/// \return False if ".." goes above the start of the path.
+static bool splitPath(const std::string &_path,
+    std::vector<std::string> &_parts)
+{
+  std::size_t start = 0;
+  while (start <= _path.size())
+  {
+    std::size_t end = _path.find_first_of("/\\", start);
+    if (end == std::string::npos)
+      end = _path.size();
+
+    const std::string part = _path.substr(start, end - start);
+    if (part == "..")
+    {
+      if (_parts.empty())
+        return false;
+      _parts.pop_back();
+    }
+    else if (!part.empty() && part != ".")
+    {
+      _parts.push_back(part);
+    }
+    start = end + 1;
+  }
+  return true;
+}
+
+/////////////////////////////////////////////////
+/// \brief Join path components with '/'.
+/// \param[in] _parts Components.
+/// \param[in] _count Number of components to join.
+/// \return The joined path.
+static std::string joinPath(const std::vector<std::string> &_parts,
+    std::size_t _count)
+{
+  std::string path;
+  for (std::size_t i = 0; i < _count; ++i)
+  {
+    if (i > 0)
+      path += '/';
+    path += _parts[i];
+  }
+  return path;
+}
+
+/////////////////////////////////////////////////
+bool ArchiveFilesystemPrivate::Relative(const std::string &_path,
+    std::string &_relative) const
+{
+  if (this->files.empty())
+    return false;
+
+  std::string path = _path;
+  for (char &c : path)
+  {
+    if (c == '\\')
+      c = '/';
+  }
+
+  if (path.compare(0, this->mountPoint.size(), this->mountPoint) != 0 ||
+      (path.size() > this->mountPoint.size() &&
+       path[this->mountPoint.size()] != '/'))
+  {
+    return false;
+  }
+
+  std::vector<std::string> parts;
+  if (!splitPath(path.substr(this->mountPoint.size()), parts))
+    return false;
+  _relative = joinPath(parts, parts.size());
+  return true;
+}
+
+/////////////////////////////////////////////////
+VirtualFile::~VirtualFile() = default;
+
+/////////////////////////////////////////////////
+VirtualFilesystem::~VirtualFilesystem() = default;
+
+/////////////////////////////////////////////////
+const VirtualFilesystem &VirtualFilesystem::Native()
+{
+  static const NativeFilesystem native;
+  return native;
+}
+
+/////////////////////////////////////////////////
+ArchiveFilesystem::ArchiveFilesystem()
+  : dataPtr(new ArchiveFilesystemPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+ArchiveFilesystem::~ArchiveFilesystem()
+{
+  delete this->dataPtr;
+  this->dataPtr = nullptr;
+}
+
+/////////////////////////////////////////////////
+/// \brief Read an integer of an archive.
+/// \param[in] _file Mapped archive.
+/// \param[in,out] _pos Position of the integer, moved past it.
+/// \param[out] _value Value read.
+/// \return False if the archive is too short.
+template<typename T>
+static bool readArchiveValue(const MappedFile &_file, std::size_t &_pos,
+    T &_value)
+{
+  if (_file.Size() < sizeof(T) || _pos > _file.Size() - sizeof(T))
+    return false;
+
+  unsigned char bytes[sizeof(T)];
+  std::memcpy(bytes, _file.Data() + _pos, sizeof(T));
+  std::uint64_t value = 0;
+  for (std::size_t i = sizeof(T); i > 0; --i)
+    value = (value << 8) | bytes[i - 1];
+  _value = static_cast<T>(value);
+  _pos += sizeof(T);
+  return true;
+}
+
+/////////////////////////////////////////////////
+/// \brief Append an integer to an archive.
+/// \param[in] _value Value to write.
+/// \param[in,out] _out String to append to.
+template<typename T>
+static void putArchiveValue(T _value, std::string &_out)
+{
+  for (std::size_t i = 0; i < sizeof(T); ++i)
+    _out += static_cast<char>((static_cast<std::uint64_t>(_value) >> (8 * i))
+        & 0xff);
+}
+
+/////////////////////////////////////////////////
+Errors ArchiveFilesystem::Load(const std::string &_archive,
+    const std::string &_mountPoint)
+{
+  Errors errors;
+  this->dataPtr->files.clear();
+  this->dataPtr->directories.clear();
+  this->dataPtr->archive.Close();
+
+  VirtualFileStatus status;
+  MappedFile &file = this->dataPtr->archive;
+  if (!VirtualFilesystem::Native().Stat(_archive, status) ||
+      !file.Open(_archive))
+  {
+    errors.push_back({ErrorCode::FILE_READ,
+        "Unable to read archive [" + _archive + "]."});
+    return errors;
+  }
+  this->dataPtr->modified = status.modified;
+
+  std::size_t pos = sizeof(kArchiveMagic);
+  std::uint32_t version = 0;
+  std::uint32_t count = 0;
+  if (file.Size() < sizeof(kArchiveMagic) ||
+      std::memcmp(file.Data(), kArchiveMagic, sizeof(kArchiveMagic)) != 0 ||
+      !readArchiveValue(file, pos, version) || version != kArchiveVersion ||
+      !readArchiveValue(file, pos, count))
+  {
+    errors.push_back({ErrorCode::FILE_READ,
+        "File [" + _archive + "] is not an SDFormat archive."});
+    file.Close();
+    return errors;
+  }
+
+  this->dataPtr->files.reserve(count);
+  std::vector<std::string> parts;
+  for (std::uint32_t i = 0; i < count; ++i)
+  {
+    std::uint32_t length = 0;
+    std::uint64_t offset = 0;
+    std::uint64_t size = 0;
+    if (!readArchiveValue(file, pos, length) ||
+        !readArchiveValue(file, pos, offset) ||
+        !readArchiveValue(file, pos, size) ||
+        length > file.Size() - pos ||
+        offset > file.Size() || size > file.Size() - offset)
+    {
+      errors.push_back({ErrorCode::FILE_READ,
+          "Archive [" + _archive + "] is truncated."});
+      this->dataPtr->files.clear();
+      this->dataPtr->directories.clear();
+      file.Close();
+      return errors;
+    }
+
+    std::string path(file.Data() + pos, length);
+    pos += length;
+
+    this->dataPtr->files[path] = ArchiveFilesystemPrivate::Entry{
+        file.Data() + offset, static_cast<std::size_t>(size)};
+
+    // Every parent of the file is a directory.
+    parts.clear();
+    splitPath(path, parts);
+    for (std::size_t n = 0; n < parts.size(); ++n)
+      this->dataPtr->directories.insert(joinPath(parts, n));
+  }
+
+  std::string mountPoint = _mountPoint;
+  for (char &c : mountPoint)
+  {
+    if (c == '\\')
+      c = '/';
+  }
+  // A mount point of "/" is stored as an empty string, which is a prefix
+  // of all absolute paths.
+  while (!mountPoint.empty() && mountPoint.back() == '/')
+    mountPoint.pop_back();
+  this->dataPtr->mountPoint = mountPoint;
+
+  return errors;
+}
+
+/////////////////////////////////////////////////
+Errors ArchiveFilesystem::Create(const std::string &_directory,
+    const std::string &_archive)
+{
+  Errors errors;
+  if (!sdf::filesystem::is_directory(_directory))
+  {
+    errors.push_back({ErrorCode::DIRECTORY_NONEXISTANT,
+        "Directory doesn't exist[" + _directory + "]"});
+    return errors;
+  }
+
+  // Collect the files, with paths relative to _directory.
+  std::vector<std::pair<std::string, std::string>> files;
+  std::vector<std::pair<std::string, std::string>> pending = {
+      {_directory, std::string()}};
+  while (!pending.empty())
+  {
+    const auto [directory, relative] = pending.back();
+    pending.pop_back();
+
+    sdf::filesystem::DirIter endIter;
+    for (sdf::filesystem::DirIter iter(directory); iter != endIter; ++iter)
+    {
+      const std::string path = *iter;
+      const std::string name = sdf::filesystem::basename(path);
+      const std::string child = relative.empty() ? name : relative + "/" + name;
+      if (sdf::filesystem::is_directory(path))
+        pending.emplace_back(path, child);
+      else
+        files.emplace_back(path, child);
+    }
+  }
+
+  // Directories are listed in no particular order, but archives of the same
+  // directory should be identical.
+  std::sort(files.begin(), files.end(),
+      [](const auto &_a, const auto &_b) { return _a.second < _b.second; });
+
+  std::string index(kArchiveMagic, sizeof(kArchiveMagic));
+  putArchiveValue(kArchiveVersion, index);
+  putArchiveValue(static_cast<std::uint32_t>(files.size()), index);
+
+  std::size_t indexSize = index.size();
+  for (const auto &file : files)
+    indexSize += 4 + 8 + 8 + file.second.size();
+
+  std::vector<MappedFile> contents(files.size());
+  std::uint64_t offset = indexSize;
+  for (std::size_t i = 0; i < files.size(); ++i)
+  {
+    if (!contents[i].Open(files[i].first))
+    {
+      errors.push_back({ErrorCode::FILE_READ,
+          "Unable to read file [" + files[i].first + "]."});
+      return errors;
+    }
+    putArchiveValue(static_cast<std::uint32_t>(files[i].second.size()),
+        index);
+    putArchiveValue(offset, index);
+    putArchiveValue(static_cast<std::uint64_t>(contents[i].Size()), index);
+    index += files[i].second;
+    offset += contents[i].Size();
+  }
+
+  std::ofstream out(_archive, std::ios::out | std::ios::binary);
+  if (!out)
+  {
+    errors.push_back({ErrorCode::FILE_READ,
+        "Unable to open file[" + _archive + "] for writing."});
+    return errors;
+  }
+  out.write(index.data(), static_cast<std::streamsize>(index.size()));
+  for (const MappedFile &content : contents)
+  {
+    out.write(content.Data(), static_cast<std::streamsize>(content.Size()));
+  }
+  out.close();
+  if (out.fail())
+  {
+    errors.push_back({ErrorCode::FILE_READ,
+        "Unable to write archive [" + _archive + "]."});
+  }
+  return errors;
+}
+
+/////////////////////////////////////////////////
+std::size_t ArchiveFilesystem::FileCount() const
+{
+  return this->dataPtr->files.size();
+}
+
+/////////////////////////////////////////////////
+bool ArchiveFilesystem::Exists(const std::string &_path) const
+{
+  std::string relative;
+  if (!this->dataPtr->Relative(_path, relative))
+    return VirtualFilesystem::Native().Exists(_path);
+
+  return this->dataPtr->files.count(relative) > 0 ||
+      this->dataPtr->directories.count(relative) > 0;
+}
+
+/////////////////////////////////////////////////
+bool ArchiveFilesystem::IsDirectory(const std::string &_path) const
+{
+  std::string relative;
+  if (!this->dataPtr->Relative(_path, relative))
+    return VirtualFilesystem::Native().IsDirectory(_path);
+
+  return this->dataPtr->directories.count(relative) > 0;
+}
+
+/////////////////////////////////////////////////
+bool ArchiveFilesystem::Stat(const std::string &_path,
+    VirtualFileStatus &_status) const
+{
+  std::string relative;
+  if (!this->dataPtr->Relative(_path, relative))
+    return VirtualFilesystem::Native().Stat(_path, _status);
+
+  auto iter = this->dataPtr->files.find(relative);
+  if (iter == this->dataPtr->files.end())
+    return false;
+
+  _status.size = static_cast<std::int64_t>(iter->second.size);
+  _status.modified = this->dataPtr->modified;
+  return true;
+}
+
+/////////////////////////////////////////////////
+std::unique_ptr<VirtualFile> ArchiveFilesystem::Open(
+    const std::string &_path) const
+{
+  std::string relative;
+  if (!this->dataPtr->Relative(_path, relative))
+    return VirtualFilesystem::Native().Open(_path);
+
+  auto iter = this->dataPtr->files.find(relative);
+  if (iter == this->dataPtr->files.end())
+    return nullptr;
+
+  return std::make_unique<ArchiveFile>(iter->second.data, iter->second.size);
+}
@@ -0,0 +1,173 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include "sdf/Filesystem.hh"
+#include "sdf/Model.hh"
+#include "sdf/ParserConfig.hh"
+#include "sdf/Root.hh"
+#include "sdf/VirtualFilesystem.hh"
+#include "sdf/World.hh"
+#include "test_config.h"
+
+/// \brief Directory the archive of the test models is mounted at. It does
+/// not exist on disk.
+static const char kMountPoint[] = "/sdformat_test_archive/models";
+
+/////////////////////////////////////////////////
+/// \brief Pack the test models into an archive.
+/// \return Path of the archive.
+static std::string createModelArchive()
+{
+  const std::string models = sdf::filesystem::append(PROJECT_SOURCE_PATH,
+      "test", "integration", "model");
+  const std::string archive = sdf::filesystem::append(PROJECT_BINARY_DIR,
+      "virtual_filesystem_models.sdfa");
+  EXPECT_TRUE(sdf::ArchiveFilesystem::Create(models, archive).empty());
+  return archive;
+}
+
+/////////////////////////////////////////////////
+TEST(VirtualFilesystem, Native)
+{
+  const sdf::VirtualFilesystem &native = sdf::VirtualFilesystem::Native();
+  const std::string config = sdf::filesystem::append(PROJECT_SOURCE_PATH,
+      "test", "integration", "model", "box", "model.config");
+
+  EXPECT_TRUE(native.Exists(config));
+  EXPECT_FALSE(native.IsDirectory(config));
+  EXPECT_TRUE(native.IsDirectory(PROJECT_SOURCE_PATH));
+  EXPECT_FALSE(native.Exists(config + ".missing"));
+
+  sdf::VirtualFileStatus status;
+  ASSERT_TRUE(native.Stat(config, status));
+  EXPECT_LT(0, status.size);
+
+  std::unique_ptr<sdf::VirtualFile> file = native.Open(config);
+  ASSERT_NE(nullptr, file);
+  EXPECT_EQ(static_cast<std::size_t>(status.size), file->Size());
+  EXPECT_NE(std::string::npos,
+      std::string(file->Data(), file->Size()).find("<name>Box</name>"));
+
+  EXPECT_EQ(nullptr, native.Open(config + ".missing"));
+}
+
+/////////////////////////////////////////////////
+TEST(VirtualFilesystem, Archive)
+{
+  sdf::ArchiveFilesystem archive;
+  EXPECT_EQ(0u, archive.FileCount());
+
+  const std::string path = createModelArchive();
+  ASSERT_TRUE(archive.Load(path, std::string(kMountPoint) + "/").empty());
+  EXPECT_LT(0u, archive.FileCount());
+
+  const std::string box = sdf::filesystem::append(kMountPoint, "box");
+  EXPECT_TRUE(archive.Exists(kMountPoint));
+  EXPECT_TRUE(archive.IsDirectory(kMountPoint));
+  EXPECT_TRUE(archive.IsDirectory(box));
+  EXPECT_TRUE(archive.Exists(box + "/model.config"));
+  EXPECT_TRUE(archive.Exists(box + "/./../box//model.config"));
+  EXPECT_FALSE(archive.IsDirectory(box + "/model.config"));
+  EXPECT_FALSE(archive.Exists(box + "/missing.sdf"));
+  EXPECT_FALSE(archive.Exists(std::string(kMountPoint) + "_other/box"));
+
+  sdf::VirtualFileStatus status;
+  ASSERT_TRUE(archive.Stat(box + "/model.sdf", status));
+  std::unique_ptr<sdf::VirtualFile> file = archive.Open(box + "/model.sdf");
+  ASSERT_NE(nullptr, file);
+  EXPECT_EQ(static_cast<std::size_t>(status.size), file->Size());
+  EXPECT_NE(std::string::npos,
+      std::string(file->Data(), file->Size()).find("<model name=\"box\">"));
+  EXPECT_EQ(nullptr, archive.Open(box + "/missing.sdf"));
+
+  // Paths outside of the mount point are native files.
+  EXPECT_TRUE(archive.IsDirectory(PROJECT_SOURCE_PATH));
+  EXPECT_FALSE(archive.Exists("/sdformat_test_archive/other"));
+}
+
+/////////////////////////////////////////////////
+TEST(VirtualFilesystem, ArchiveErrors)
+{
+  sdf::ArchiveFilesystem archive;
+  sdf::Errors errors = archive.Load(sdf::filesystem::append(
+      PROJECT_BINARY_DIR, "missing.sdfa"), kMountPoint);
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::FILE_READ, errors[0].Code());
+
+  const std::string notArchive = sdf::filesystem::append(PROJECT_BINARY_DIR,
+      "virtual_filesystem_not_archive.sdfa");
+  {
+    std::ofstream out(notArchive);
+    out << "<sdf version='1.8'/>";
+  }
+  errors = archive.Load(notArchive, kMountPoint);
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::FILE_READ, errors[0].Code());
+  EXPECT_EQ(0u, archive.FileCount());
+
+  errors = sdf::ArchiveFilesystem::Create(sdf::filesystem::append(
+      PROJECT_BINARY_DIR, "missing_directory"), notArchive);
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::DIRECTORY_NONEXISTANT, errors[0].Code());
+}
+
+/////////////////////////////////////////////////
+TEST(VirtualFilesystem, LoadFromArchive)
+{
+  auto archive = std::make_shared<sdf::ArchiveFilesystem>();
+  ASSERT_TRUE(archive->Load(createModelArchive(), kMountPoint).empty());
+
+  sdf::ParserConfig config;
+  config.SetFilesystem(archive);
+  EXPECT_EQ(archive, config.Filesystem());
+  config.AddURIPath("model://", kMountPoint);
+  ASSERT_EQ(1u, config.URIPathMap().count("model://"));
+
+  const std::string sdf = R"(
+  <sdf version="1.8">
+    <world name="default">
+      <include>
+        <uri>model://box</uri>
+      </include>
+    </world>
+  </sdf>)";
+
+  sdf::Root root;
+  EXPECT_TRUE(root.LoadSdfString(sdf, config).empty());
+  const sdf::World *world = root.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+  ASSERT_NE(nullptr, world->ModelByName("box"));
+  EXPECT_EQ(1u, world->ModelByName("box")->LinkCount());
+
+  // Top level files are found in the archive too.
+  sdf::Root modelRoot;
+  EXPECT_TRUE(modelRoot.Load(
+      sdf::filesystem::append(kMountPoint, "box"), config).empty());
+  ASSERT_NE(nullptr, modelRoot.ModelByIndex(0));
+  EXPECT_EQ("box", modelRoot.ModelByIndex(0)->Name());
+
+  // Without the archive, the paths don't exist.
+  sdf::ParserConfig nativeConfig;
+  nativeConfig.AddURIPath("model://", kMountPoint);
+  EXPECT_EQ(0u, nativeConfig.URIPathMap().count("model://"));
+}
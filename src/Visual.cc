@@ -21,7 +21,11 @@
 #include "sdf/Types.hh"
 #include "sdf/Visual.hh"
 #include "sdf/Geometry.hh"
+#include "ElementRetentionScope.hh"
 #include "FrameSemantics.hh"
+#include "LoadStatsScope.hh"
+#include "MaterialTable.hh"
+#include "MemoryAccounting.hh"
 #include "ScopedGraph.hh"
 #include "Utils.hh"
 
@@ -60,8 +64,12 @@ class sdf::VisualPrivate
   /// \brief The SDF element pointer used during load.
   public: sdf::ElementPtr sdf;
 
-  /// \brief Pointer to the visual's material properties.
-  public: std::unique_ptr<Material> material;
+  /// \brief Pointer to the visual's material properties. It is shared
+  /// with the material table of the world when materialIndex is valid.
+  public: std::shared_ptr<Material> material;
+
+  /// \brief Index of the material in the material table of the world.
+  public: uint64_t materialIndex = Visual::kInvalidMaterialIndex;
 
   /// \brief Name of xml parent object.
   public: std::string xmlParentName;
@@ -84,9 +92,13 @@ VisualPrivate::VisualPrivate(const VisualPrivate &_visualPrivate)
       sdf(_visualPrivate.sdf),
       visibilityFlags(_visualPrivate.visibilityFlags)
 {
+  // A copy of a visual has its own material, which keeps the index of the
+  // entry it is equal to. The copy of a world gives the visuals the
+  // entries of its own copy of the table, see Visual::UseMaterialCopy.
   if (_visualPrivate.material)
   {
-    this->material = std::make_unique<Material>(*(_visualPrivate.material));
+    this->material = std::make_shared<Material>(*(_visualPrivate.material));
+    this->materialIndex = _visualPrivate.materialIndex;
   }
 }
 
@@ -131,9 +143,10 @@ Visual &Visual::operator=(Visual &&_visual)
 /////////////////////////////////////////////////
 Errors Visual::Load(ElementPtr _sdf)
 {
+  DomLoadTimer timer("Visual");
   Errors errors;
 
-  this->dataPtr->sdf = _sdf;
+  this->dataPtr->sdf = retainedElement(_sdf);
 
   // Check that the provided SDF element is a <visual>
   // This is an error that cannot be recovered, so return an error.
@@ -191,9 +204,13 @@ Errors Visual::Load(ElementPtr _sdf)
         this->dataPtr->visibilityFlags).first;
   }
 
-  // Load the geometry
-  Errors geomErr = this->dataPtr->geom.Load(_sdf->GetElement("geometry"));
-  errors.insert(errors.end(), geomErr.begin(), geomErr.end());
+  // Load the geometry. The <geometry> is required, so the parser reports
+  // a missing one, and an empty geometry is kept.
+  if (_sdf->HasElement("geometry"))
+  {
+    Errors geomErr = this->dataPtr->geom.Load(_sdf->GetElement("geometry"));
+    errors.insert(errors.end(), geomErr.begin(), geomErr.end());
+  }
 
   return errors;
 }
@@ -308,7 +325,39 @@ sdf::Material *Visual::Material() const
 /////////////////////////////////////////////////
 void Visual::SetMaterial(const sdf::Material &_material)
 {
-  this->dataPtr->material.reset(new sdf::Material(_material));
+  this->dataPtr->material = std::make_shared<sdf::Material>(_material);
+  this->dataPtr->materialIndex = kInvalidMaterialIndex;
+}
+
+/////////////////////////////////////////////////
+uint64_t Visual::MaterialIndex() const
+{
+  return this->dataPtr->materialIndex;
+}
+
+/////////////////////////////////////////////////
+void Visual::ShareMaterial(MaterialTable &_table)
+{
+  if (this->dataPtr->material)
+    this->dataPtr->materialIndex = _table.Intern(this->dataPtr->material);
+}
+
+/////////////////////////////////////////////////
+void Visual::UseMaterialCopy(const MaterialTable &_table)
+{
+  if (this->dataPtr->materialIndex == kInvalidMaterialIndex)
+    return;
+  if (std::shared_ptr<sdf::Material> entry =
+      _table.Entry(this->dataPtr->materialIndex))
+  {
+    this->dataPtr->material = std::move(entry);
+  }
+}
+
+/////////////////////////////////////////////////
+void Visual::ShareMesh(MeshRegistry &_registry)
+{
+  this->dataPtr->geom.ShareMesh(_registry);
 }
 
 /////////////////////////////////////////////////
@@ -322,3 +371,10 @@ void Visual::SetVisibilityFlags(uint32_t _flags)
 {
   this->dataPtr->visibilityFlags = _flags;
 }
+
+/////////////////////////////////////////////////
+template <>
+std::size_t sdf::domPrivateSize<Visual>()
+{
+  return sizeof(VisualPrivate);
+}
@@ -14,20 +14,37 @@
  * limitations under the License.
  *
 */
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 #include <ignition/math/Vector3.hh>
 
 #include "sdf/Actor.hh"
+#include "sdf/ElementEdit.hh"
 #include "sdf/Frame.hh"
 #include "sdf/Light.hh"
 #include "sdf/Model.hh"
 #include "sdf/Physics.hh"
+#include "sdf/Population.hh"
+#include "sdf/StateReader.hh"
 #include "sdf/Types.hh"
 #include "sdf/World.hh"
+#include "DiagnosticScope.hh"
 #include "FrameSemantics.hh"
+#include "LazyModelScope.hh"
+#include "LoadStatsScope.hh"
+#include "MaterialTable.hh"
+#include "MemoryAccounting.hh"
+#include "ModelPreloader.hh"
 #include "ScopedGraph.hh"
+#include "ScopedNameIndex.hh"
+#include "Tracing.hh"
+#include "TrustedInputScope.hh"
 #include "Utils.hh"
 
 using namespace sdf;
@@ -82,6 +99,127 @@ class sdf::WorldPrivate
   /// \brief The physics profiles specified in this world.
   public: std::vector<Physics> physics;
 
+  /// \brief The populations specified in this world.
+  public: std::vector<Population> populations;
+
+  /// \brief Index of the models by name.
+  public: NameIndex modelIndex;
+
+  /// \brief Index of the frames by name.
+  public: NameIndex frameIndex;
+
+  /// \brief Index of the lights by name.
+  public: NameIndex lightIndex;
+
+  /// \brief Index of the actors by name.
+  public: NameIndex actorIndex;
+
+  /// \brief Index of the physics profiles by name.
+  public: NameIndex physicsIndex;
+
+  /// \brief Index of the populations by name.
+  public: NameIndex populationIndex;
+
+  /// \brief Index of the models, their entities and the frames of the
+  /// world by scoped name.
+  public: ScopedNameIndex scopedIndex;
+
+  /// \brief Rebuild the name indices and the scoped name index.
+  public: void BuildIndices()
+  {
+    buildNameIndex(this->models, this->modelIndex);
+    buildNameIndex(this->frames, this->frameIndex);
+    buildNameIndex(this->lights, this->lightIndex);
+    buildNameIndex(this->actors, this->actorIndex);
+    buildNameIndex(this->physics, this->physicsIndex);
+    buildNameIndex(this->populations, this->populationIndex);
+    this->BuildScopedIndex();
+  }
+
+  /// \brief The sensors of the models by type and scoped name. Like the
+  /// scoped index, it is rebuilt rather than copied.
+  public: SensorRegistry sensors;
+
+  /// \brief IDs of the entities of the world. Like the scoped index, it is
+  /// rebuilt rather than copied.
+  public: EntityTable entities;
+
+  /// \brief Whether the models load their contents on first access, in
+  /// which case the scoped name index, the sensor registry and the entity
+  /// table are built the first time they are used.
+  public: bool lazyModels = false;
+
+  /// \brief True once the scoped name index, the sensor registry and the
+  /// entity table are built.
+  public: std::atomic<bool> scopedIndexBuilt{false};
+
+  /// \brief Protects the build of the scoped name index of lazy models.
+  public: std::mutex scopedIndexMutex;
+
+  /// \brief Frame graphs of a world whose models are lazy, or null.
+  public: std::shared_ptr<DeferredGraphs> deferredGraphs;
+
+  /// \brief Build the deferred graphs of the world, if any.
+  /// \return This, for use in the copy constructor of World.
+  public: WorldPrivate &BuildDeferredGraphs()
+  {
+    if (this->deferredGraphs)
+      this->deferredGraphs->Build();
+    return *this;
+  }
+
+  /// \brief Rebuild the scoped name index, the sensor registry and the
+  /// entity table, or let EnsureScopedIndex build them if the models are
+  /// lazy.
+  public: void BuildScopedIndex()
+  {
+    if (this->lazyModels)
+    {
+      this->scopedIndexBuilt = false;
+      return;
+    }
+    this->IndexScopedNames();
+    this->scopedIndexBuilt = true;
+  }
+
+  /// \brief Build the scoped name index, the sensor registry and the
+  /// entity table of lazy models if they are not built. The contents of
+  /// the models are loaded first, without the lock, since loading them may
+  /// wait for the graphs that another thread is building.
+  public: void EnsureScopedIndex()
+  {
+    if (this->scopedIndexBuilt.load(std::memory_order_acquire))
+      return;
+
+    this->BuildDeferredGraphs();
+    for (const Model &model : this->models)
+    {
+      if (!model.ContentsLoaded())
+        model.LoadContents();
+    }
+
+    std::lock_guard<std::mutex> lock(this->scopedIndexMutex);
+    if (this->scopedIndexBuilt.load(std::memory_order_relaxed))
+      return;
+    this->IndexScopedNames();
+    this->scopedIndexBuilt.store(true, std::memory_order_release);
+  }
+
+  /// \brief Fill the scoped name index, the sensor registry and the entity
+  /// table.
+  public: void IndexScopedNames()
+  {
+    this->scopedIndex.Clear();
+    for (const auto &model : this->models)
+      this->scopedIndex.AddModel(model, "");
+    for (const auto &frame : this->frames)
+      this->scopedIndex.frames.emplace(frame.Name(), &frame);
+    this->sensors.Build({this->models.data(), this->models.size()});
+    this->entities.Build({this->models.data(), this->models.size()},
+        {this->frames.data(), this->frames.size()},
+        {this->lights.data(), this->lights.size()});
+  }
+
   /// \brief The SDF element pointer used during load.
   public: sdf::ElementPtr sdf;
 
@@ -96,6 +234,13 @@ class sdf::WorldPrivate
   /// \brief Scoped Pose Relative-To graph that points to a graph owned by this
   /// world.
   public: sdf::ScopedGraph<sdf::PoseRelativeToGraph> poseRelativeToGraph;
+
+  /// \brief Whether the visuals of the models share their materials
+  /// through materialTable.
+  public: bool shareMaterials = false;
+
+  /// \brief The distinct materials of the visuals of the models.
+  public: MaterialTable materialTable;
 };
 
 /////////////////////////////////////////////////
@@ -109,10 +254,19 @@ WorldPrivate::WorldPrivate(const WorldPrivate &_worldPrivate)
       models(_worldPrivate.models),
       name(_worldPrivate.name),
       physics(_worldPrivate.physics),
+      populations(_worldPrivate.populations),
+      modelIndex(_worldPrivate.modelIndex),
+      frameIndex(_worldPrivate.frameIndex),
+      lightIndex(_worldPrivate.lightIndex),
+      actorIndex(_worldPrivate.actorIndex),
+      physicsIndex(_worldPrivate.physicsIndex),
+      populationIndex(_worldPrivate.populationIndex),
       sdf(_worldPrivate.sdf),
       windLinearVelocity(_worldPrivate.windLinearVelocity),
       frameAttachedToGraph(_worldPrivate.frameAttachedToGraph),
-      poseRelativeToGraph(_worldPrivate.poseRelativeToGraph)
+      poseRelativeToGraph(_worldPrivate.poseRelativeToGraph),
+      shareMaterials(_worldPrivate.shareMaterials),
+      materialTable(_worldPrivate.materialTable)
 {
   if (_worldPrivate.atmosphere)
   {
@@ -129,11 +283,137 @@ WorldPrivate::WorldPrivate(const WorldPrivate &_worldPrivate)
   }
 }
 
+/////////////////////////////////////////////////
+/// \brief Check whether two elements have the same name, attributes, value
+/// and children, recursively.
+/// \param[in] _a First element.
+/// \param[in] _b Second element.
+/// \return True if the elements are identical.
+static bool sameElement(const Element &_a, const Element &_b)
+{
+  const Param_V &attributesA = _a.Attributes();
+  const Param_V &attributesB = _b.Attributes();
+  if (_a.GetName() != _b.GetName() ||
+      attributesA.size() != attributesB.size())
+  {
+    return false;
+  }
+
+  for (std::size_t i = 0; i < attributesA.size(); ++i)
+  {
+    const Param &a = *attributesA[i];
+    const Param &b = *attributesB[i];
+    if (a.GetKey() != b.GetKey() || a.GetAsString() != b.GetAsString())
+      return false;
+  }
+
+  const Param *a = _a.FindValue();
+  const Param *b = _b.FindValue();
+  if ((a == nullptr) != (b == nullptr) ||
+      (a && a->GetAsString() != b->GetAsString()))
+  {
+    return false;
+  }
+
+  const ElementChildren childrenA = _a.Children();
+  const ElementChildren childrenB = _b.Children();
+  auto childA = childrenA.begin();
+  auto childB = childrenB.begin();
+  for (; childA != childrenA.end() && childB != childrenB.end();
+       ++childA, ++childB)
+  {
+    if (!sameElement(*childA, *childB))
+      return false;
+  }
+  return childA == childrenA.end() && childB == childrenB.end();
+}
+
+/////////////////////////////////////////////////
+/// \brief Check whether two <model> elements have identical links, joints,
+/// frames and nested models, so that one can share the children of the
+/// other. The name, pose, plugins and other elements of the models
+/// themselves may differ.
+/// \param[in] _a First model element.
+/// \param[in] _b Second model element.
+/// \return True if the children of the models are identical.
+static bool sameModelChildren(const ElementPtr &_a, const ElementPtr &_b)
+{
+  // Old files rename colliding children while loading.
+  if (_a->OriginalVersion() != _b->OriginalVersion())
+    return false;
+
+  const ElementChildren childrenA = _a->Children();
+  const ElementChildren childrenB = _b->Children();
+  auto nextChild = [](ElementChildren::Iterator _iter,
+      const ElementChildren &_children)
+  {
+    for (; _iter != _children.end(); ++_iter)
+    {
+      const std::string &name = _iter->GetName();
+      if (name == "link" || name == "joint" || name == "frame" ||
+          name == "model")
+      {
+        break;
+      }
+    }
+    return _iter;
+  };
+
+  auto childA = nextChild(childrenA.begin(), childrenA);
+  auto childB = nextChild(childrenB.begin(), childrenB);
+  for (; childA != childrenA.end() && childB != childrenB.end();
+       childA = nextChild(++childA, childrenA),
+       childB = nextChild(++childB, childrenB))
+  {
+    if (!sameElement(*childA, *childB))
+      return false;
+  }
+  return childA == childrenA.end() && childB == childrenB.end();
+}
+
+/////////////////////////////////////////////////
+/// \brief Find the models of a world that can share the children of an
+/// earlier model, which are those included from the same file with
+/// identical children.
+/// \param[in] _world The <world> element.
+/// \param[in] _elems The <model> elements of the world.
+/// \return Index in _elems of the model whose children each model shares,
+/// which is its own index if it loads its own.
+static std::vector<std::size_t> modelTemplates(const ElementPtr &_world,
+    const std::vector<ElementPtr> &_elems)
+{
+  std::vector<std::size_t> templates(_elems.size());
+  std::unordered_map<std::string, std::vector<std::size_t>> byFile;
+  for (std::size_t i = 0; i < _elems.size(); ++i)
+  {
+    templates[i] = i;
+
+    // Models defined in the world itself are not shared.
+    const std::string &file = _elems[i]->FilePath();
+    if (file.empty() || file == _world->FilePath())
+      continue;
+
+    std::vector<std::size_t> &candidates = byFile[file];
+    for (std::size_t candidate : candidates)
+    {
+      if (sameModelChildren(_elems[candidate], _elems[i]))
+      {
+        templates[i] = candidate;
+        break;
+      }
+    }
+    if (templates[i] == i)
+      candidates.push_back(i);
+  }
+  return templates;
+}
+
 /////////////////////////////////////////////////
 World::World()
   : dataPtr(new WorldPrivate)
 {
   this->dataPtr->physics.emplace_back(Physics());
+  buildNameIndex(this->dataPtr->physics, this->dataPtr->physicsIndex);
 }
 
 /////////////////////////////////////////////////
@@ -145,8 +425,18 @@ World::~World()
 
 /////////////////////////////////////////////////
 World::World(const World &_world)
-  : dataPtr(new WorldPrivate(*_world.dataPtr))
+  : dataPtr(new WorldPrivate(_world.dataPtr->BuildDeferredGraphs()))
 {
+  // The scoped index points into the models and frames, which were copied.
+  this->dataPtr->BuildScopedIndex();
+
+  // The table has copies of the materials, which the copied visuals hold
+  // instead of those of the original world.
+  if (this->dataPtr->shareMaterials)
+  {
+    for (Model &model : this->dataPtr->models)
+      model.UseMaterialCopies(this->dataPtr->materialTable);
+  }
 }
 
 /////////////////////////////////////////////////
@@ -171,9 +461,22 @@ World &World::operator=(World &&_world)
 /////////////////////////////////////////////////
 Errors World::Load(sdf::ElementPtr _sdf)
 {
+  return this->Load(_sdf, ParserConfig());
+}
+
+/////////////////////////////////////////////////
+Errors World::Load(sdf::ElementPtr _sdf, const ParserConfig &_config)
+{
+  SDF_TRACE_SCOPE_TEXT("sdf::World::Load", _sdf->Get<std::string>("name"));
+  TrustedInputScope trustedScope(_config);
+  LoadStatsScope statsScope(_config);
+  DiagnosticScope diagnosticScope(_config);
+  DomLoadTimer timer("World");
   Errors errors;
 
   this->dataPtr->sdf = _sdf;
+  this->dataPtr->lazyModels = _config.LazyModels();
+  this->dataPtr->deferredGraphs.reset();
 
   // Check that the provided SDF element is a <world>
   // This is an error that cannot be recovered, so return an error.
@@ -193,7 +496,7 @@ Errors World::Load(sdf::ElementPtr _sdf)
   }
 
   // Check that the world's name is valid
-  if (isReservedName(this->dataPtr->name))
+  if (!TrustedInputScope::Trusted() && isReservedName(this->dataPtr->name))
   {
     errors.push_back({ErrorCode::RESERVED_NAME,
                      "The supplied world name [" + this->dataPtr->name +
@@ -236,7 +539,7 @@ Errors World::Load(sdf::ElementPtr _sdf)
     _sdf->Get<ignition::math::Vector3d>("magnetic_field",
         this->dataPtr->magneticField).first;
 
-  if (!_sdf->HasUniqueChildNames())
+  if (!TrustedInputScope::Trusted() && !_sdf->HasUniqueChildNames())
   {
     sdfwarn << "Non-unique names detected in XML children of world with name["
             << this->Name() << "].\n";
@@ -246,11 +549,83 @@ Errors World::Load(sdf::ElementPtr _sdf)
   // name collisions
   std::unordered_set<std::string> frameNames;
 
-  // Load all the models.
+  // Load all the models. Included models may share the children of an
+  // identical one, which is loaded first since it comes earlier.
+  const unsigned int threadCount = _config.LoadThreadCount();
+  LazyModelScope lazyScope(_config);
   Errors modelLoadErrors =
-      loadUniqueRepeated<Model>(_sdf, "model", this->dataPtr->models);
+      _config.ShareIncludedModels() && !_config.LazyModels() ?
+      loadUniqueRepeated<Model>(_sdf, "model", this->dataPtr->models,
+          [&_sdf, threadCount](const std::vector<ElementPtr> &_elems,
+              std::vector<Model> &_models, std::vector<Errors> &_errors)
+          {
+            const std::vector<std::size_t> templates =
+                modelTemplates(_sdf, _elems);
+            std::vector<std::size_t> loaded;
+            for (std::size_t i = 0; i < _elems.size(); ++i)
+            {
+              if (templates[i] == i)
+                loaded.push_back(i);
+            }
+            parallelFor(loaded.size(), threadCount, [&](std::size_t _index)
+            {
+              const std::size_t i = loaded[_index];
+              _errors[i] = _models[i].Load(_elems[i]);
+            });
+            for (std::size_t i = 0; i < _elems.size(); ++i)
+            {
+              if (templates[i] != i)
+              {
+                _errors[i] =
+                    _models[i].LoadInstance(_elems[i], _models[templates[i]]);
+              }
+            }
+          }) :
+      loadUniqueRepeated<Model>(_sdf, "model", this->dataPtr->models,
+          [threadCount](const std::vector<ElementPtr> &_elems,
+              std::vector<Model> &_models, std::vector<Errors> &_errors)
+          {
+            // Models that a pipelined load already loaded are taken as is.
+            ModelPreloader *preloader = ModelPreloadScope::Current();
+            std::vector<std::size_t> loaded;
+            for (std::size_t i = 0; i < _elems.size(); ++i)
+            {
+              if (!preloader || !preloader->Take(_elems[i], _models[i],
+                      _errors[i]))
+              {
+                loaded.push_back(i);
+              }
+            }
+            parallelFor(loaded.size(), threadCount, [&](std::size_t _index)
+            {
+              const std::size_t i = loaded[_index];
+              _errors[i] = _models[i].Load(_elems[i]);
+            });
+          });
   errors.insert(errors.end(), modelLoadErrors.begin(), modelLoadErrors.end());
 
+  // The template models of populations are loaded with their population.
+  LazyModelScope eagerScope(false);
+
+  // Visuals with equal materials share one entry of the table. Models that
+  // share their children share their visuals, which are then given the
+  // entry they already hold.
+  this->dataPtr->shareMaterials =
+      _config.ShareMaterials() && !_config.LazyModels();
+  if (this->dataPtr->shareMaterials)
+  {
+    for (Model &model : this->dataPtr->models)
+      model.ShareMaterials(this->dataPtr->materialTable);
+  }
+
+  // The models are most of a world, so the other children are left out
+  // once they have used up the error budget, or the load was cancelled.
+  if (loadStopped(errors, _config))
+  {
+    this->dataPtr->BuildIndices();
+    return errors;
+  }
+
   // Models are loaded first, and loadUniqueRepeated ensures there are no
   // duplicate names, so these names can be added to frameNames without
   // checking uniqueness.
@@ -271,14 +646,21 @@ Errors World::Load(sdf::ElementPtr _sdf)
 
   // Load all the actors.
   Errors actorLoadErrors = loadUniqueRepeated<Actor>(_sdf, "actor",
-      this->dataPtr->actors);
+      this->dataPtr->actors, _config.LoadThreadCount());
   errors.insert(errors.end(), actorLoadErrors.begin(), actorLoadErrors.end());
 
   // Load all the lights.
   Errors lightLoadErrors = loadUniqueRepeated<Light>(_sdf, "light",
-      this->dataPtr->lights);
+      this->dataPtr->lights, _config.LoadThreadCount());
   errors.insert(errors.end(), lightLoadErrors.begin(), lightLoadErrors.end());
 
+  // Load all the populations. Each loads its template model once, and its
+  // instances are not added to the frame graphs.
+  Errors populationLoadErrors = loadUniqueRepeated<Population>(_sdf,
+      "population", this->dataPtr->populations, _config.LoadThreadCount());
+  errors.insert(errors.end(), populationLoadErrors.begin(),
+      populationLoadErrors.end());
+
   // Load all the frames.
   Errors frameLoadErrors = loadUniqueRepeated<Frame>(_sdf, "frame",
       this->dataPtr->frames);
@@ -322,6 +704,9 @@ Errors World::Load(sdf::ElementPtr _sdf)
     errors.insert(errors.end(), sceneLoadErrors.begin(), sceneLoadErrors.end());
   }
 
+  // Index the names now that collisions have been renamed.
+  this->dataPtr->BuildIndices();
+
   return errors;
 }
 
@@ -399,30 +784,34 @@ const Model *World::ModelByIndex(const uint64_t _index) const
   return nullptr;
 }
 
+/////////////////////////////////////////////////
+Span<const Model> World::Models() const
+{
+  return {this->dataPtr->models.data(), this->dataPtr->models.size()};
+}
+
+/////////////////////////////////////////////////
+uint64_t World::MaterialCount() const
+{
+  return this->dataPtr->materialTable.Count();
+}
+
+/////////////////////////////////////////////////
+const Material *World::MaterialByIndex(const uint64_t _index) const
+{
+  return this->dataPtr->materialTable.ByIndex(_index);
+}
+
 /////////////////////////////////////////////////
 bool World::ModelNameExists(const std::string &_name) const
 {
-  for (auto const &m : this->dataPtr->models)
-  {
-    if (m.Name() == _name)
-    {
-      return true;
-    }
-  }
-  return false;
+  return this->dataPtr->modelIndex.count(_name) > 0;
 }
 
 /////////////////////////////////////////////////
 const Model *World::ModelByName(const std::string &_name) const
 {
-  for (auto const &m : this->dataPtr->models)
-  {
-    if (m.Name() == _name)
-    {
-      return &m;
-    }
-  }
-  return nullptr;
+  return findByName(this->dataPtr->models, this->dataPtr->modelIndex, _name);
 }
 
 /////////////////////////////////////////////////
@@ -467,6 +856,175 @@ sdf::ElementPtr World::Element() const
   return this->dataPtr->sdf;
 }
 
+/////////////////////////////////////////////////
+void World::ReleaseElement()
+{
+  this->dataPtr->sdf.reset();
+  for (Model &model : this->dataPtr->models)
+    model.ReleaseElement();
+}
+
+/////////////////////////////////////////////////
+void World::ShareMeshes(MeshRegistry &_registry)
+{
+  for (Model &model : this->dataPtr->models)
+    model.ShareMeshes(_registry);
+}
+
+/////////////////////////////////////////////////
+Errors World::ReplaceModel(const std::string &_name, ElementPtr _sdf)
+{
+  this->dataPtr->BuildDeferredGraphs();
+  Errors errors;
+  auto iter = this->dataPtr->modelIndex.find(_name);
+  if (iter == this->dataPtr->modelIndex.end())
+  {
+    errors.push_back({ErrorCode::ELEMENT_MISSING,
+        "World with name[" + this->Name() + "] has no model with name[" +
+        _name + "] to replace."});
+    return errors;
+  }
+  const std::size_t index = iter->second;
+
+  Model model;
+  errors = model.Load(_sdf);
+  if (!errors.empty())
+    return errors;
+
+  if (model.Name() != _name && (this->ModelNameExists(model.Name()) ||
+      this->FrameNameExists(model.Name())))
+  {
+    errors.push_back({ErrorCode::DUPLICATE_NAME,
+        "Model with name[" + model.Name() + "] replacing model with name[" +
+        _name + "] in world with name[" + this->Name() +
+        "] has the name of another model or frame."});
+    return errors;
+  }
+
+  // The new element takes the place of the old one, so that the world
+  // element is written out in the same order.
+  const ElementPtr oldSdf = this->dataPtr->models[index].Element();
+  if (this->dataPtr->sdf && oldSdf)
+  {
+    // The new element is added after the others if the old one is not a
+    // child of the world element.
+    ElementEdit edit(this->dataPtr->sdf);
+    edit.Replace(oldSdf, _sdf);
+    if (!edit.Commit().empty())
+    {
+      _sdf->SetParent(this->dataPtr->sdf);
+      this->dataPtr->sdf->InsertElement(_sdf);
+    }
+  }
+
+  // Entries of the table that are left unused by the old model are kept,
+  // so that the indices of the other visuals remain valid.
+  if (this->dataPtr->shareMaterials)
+    model.ShareMaterials(this->dataPtr->materialTable);
+
+  this->dataPtr->models[index] = std::move(model);
+  this->dataPtr->BuildIndices();
+
+  Model &newModel = this->dataPtr->models[index];
+  if (this->dataPtr->frameAttachedToGraph)
+  {
+    Errors graphErrors = replaceModelScope(
+        this->dataPtr->frameAttachedToGraph, _name, &newModel);
+    errors.insert(errors.end(), graphErrors.begin(), graphErrors.end());
+    newModel.SetFrameAttachedToGraph(this->dataPtr->frameAttachedToGraph);
+  }
+  if (this->dataPtr->poseRelativeToGraph)
+  {
+    Errors graphErrors = replaceModelScope(
+        this->dataPtr->poseRelativeToGraph, _name, &newModel);
+    errors.insert(errors.end(), graphErrors.begin(), graphErrors.end());
+    newModel.SetPoseRelativeToGraph(this->dataPtr->poseRelativeToGraph);
+  }
+  return errors;
+}
+
+/////////////////////////////////////////////////
+Errors World::Merge(Span<const Model> _models, Span<const Light> _lights,
+    Span<const Actor> _actors)
+{
+  this->dataPtr->BuildDeferredGraphs();
+  Errors errors;
+  this->dataPtr->models.reserve(
+      this->dataPtr->models.size() + _models.Size());
+  for (const Model &layerModel : _models)
+  {
+    const std::string name = layerModel.Name();
+    if (this->dataPtr->modelIndex.count(name) > 0 ||
+        this->dataPtr->frameIndex.count(name) > 0)
+    {
+      errors.push_back({ErrorCode::DUPLICATE_NAME,
+          "Model with name[" + name + "] can not be merged into world with "
+          "name[" + this->Name() + "], which has a model or frame with the "
+          "same name."});
+      continue;
+    }
+
+    this->dataPtr->modelIndex.emplace(name, this->dataPtr->models.size());
+    this->dataPtr->models.push_back(layerModel);
+    Model &model = this->dataPtr->models.back();
+    if (this->dataPtr->shareMaterials)
+      model.ShareMaterials(this->dataPtr->materialTable);
+
+    // The model brings its scope of the frame graphs of the other document
+    // with it, and is only validated against the frames of this world.
+    if (this->dataPtr->frameAttachedToGraph)
+    {
+      Errors graphErrors = insertModelScope(
+          this->dataPtr->frameAttachedToGraph, &model);
+      errors.insert(errors.end(), graphErrors.begin(), graphErrors.end());
+      model.SetFrameAttachedToGraph(this->dataPtr->frameAttachedToGraph);
+    }
+    if (this->dataPtr->poseRelativeToGraph)
+    {
+      Errors graphErrors = insertModelScope(
+          this->dataPtr->poseRelativeToGraph, &model);
+      errors.insert(errors.end(), graphErrors.begin(), graphErrors.end());
+      model.SetPoseRelativeToGraph(this->dataPtr->poseRelativeToGraph);
+    }
+  }
+
+  for (const Light &layerLight : _lights)
+  {
+    if (this->dataPtr->lightIndex.count(layerLight.Name()) > 0)
+    {
+      errors.push_back({ErrorCode::DUPLICATE_NAME,
+          "Light with name[" + layerLight.Name() + "] can not be merged into "
+          "world with name[" + this->Name() + "], which has a light with the "
+          "same name."});
+      continue;
+    }
+    this->dataPtr->lightIndex.emplace(layerLight.Name(),
+        this->dataPtr->lights.size());
+    this->dataPtr->lights.push_back(layerLight);
+    this->dataPtr->lights.back().SetXmlParentName("world");
+    this->dataPtr->lights.back().SetPoseRelativeToGraph(
+        this->dataPtr->poseRelativeToGraph);
+  }
+
+  for (const Actor &layerActor : _actors)
+  {
+    if (this->dataPtr->actorIndex.count(layerActor.Name()) > 0)
+    {
+      errors.push_back({ErrorCode::DUPLICATE_NAME,
+          "Actor with name[" + layerActor.Name() + "] can not be merged into "
+          "world with name[" + this->Name() + "], which has an actor with "
+          "the same name."});
+      continue;
+    }
+    this->dataPtr->actorIndex.emplace(layerActor.Name(),
+        this->dataPtr->actors.size());
+    this->dataPtr->actors.push_back(layerActor);
+  }
+
+  this->dataPtr->BuildIndices();
+  return errors;
+}
+
 /////////////////////////////////////////////////
 uint64_t World::FrameCount() const
 {
@@ -481,30 +1039,148 @@ const Frame *World::FrameByIndex(const uint64_t _index) const
   return nullptr;
 }
 
+/////////////////////////////////////////////////
+Span<const Frame> World::Frames() const
+{
+  return {this->dataPtr->frames.data(), this->dataPtr->frames.size()};
+}
+
 /////////////////////////////////////////////////
 bool World::FrameNameExists(const std::string &_name) const
 {
-  for (auto const &f : this->dataPtr->frames)
+  return this->dataPtr->frameIndex.count(_name) > 0;
+}
+
+/////////////////////////////////////////////////
+const Frame *World::FrameByName(const std::string &_name) const
+{
+  return findByName(this->dataPtr->frames, this->dataPtr->frameIndex, _name);
+}
+
+/////////////////////////////////////////////////
+const Model *World::ModelByScopedName(const std::string &_name) const
+{
+  this->dataPtr->EnsureScopedIndex();
+  return ScopedNameIndex::Find(this->dataPtr->scopedIndex.models, _name);
+}
+
+/////////////////////////////////////////////////
+const Link *World::LinkByScopedName(const std::string &_name) const
+{
+  this->dataPtr->EnsureScopedIndex();
+  return ScopedNameIndex::Find(this->dataPtr->scopedIndex.links, _name);
+}
+
+/////////////////////////////////////////////////
+const Joint *World::JointByScopedName(const std::string &_name) const
+{
+  this->dataPtr->EnsureScopedIndex();
+  return ScopedNameIndex::Find(this->dataPtr->scopedIndex.joints, _name);
+}
+
+/////////////////////////////////////////////////
+const Frame *World::FrameByScopedName(const std::string &_name) const
+{
+  this->dataPtr->EnsureScopedIndex();
+  return ScopedNameIndex::Find(this->dataPtr->scopedIndex.frames, _name);
+}
+
+/////////////////////////////////////////////////
+const SensorRegistry &World::Sensors() const
+{
+  this->dataPtr->EnsureScopedIndex();
+  return this->dataPtr->sensors;
+}
+
+/////////////////////////////////////////////////
+const EntityTable &World::Entities() const
+{
+  this->dataPtr->EnsureScopedIndex();
+  return this->dataPtr->entities;
+}
+
+/////////////////////////////////////////////////
+Errors World::ApplyState(const StateFrame &_state)
+{
+  this->dataPtr->BuildDeferredGraphs();
+  Errors errors;
+  if (!this->dataPtr->poseRelativeToGraph)
   {
-    if (f.Name() == _name)
-    {
-      return true;
-    }
+    errors.push_back({ErrorCode::POSE_RELATIVE_TO_GRAPH_ERROR,
+        "World with name[" + this->Name() + "] has no PoseRelativeToGraph. "
+        "It has to be loaded through sdf::Root to apply a state."});
+    return errors;
   }
-  return false;
+
+  errors = applyStatePoses(this->dataPtr->poseRelativeToGraph, _state);
+
+  const ignition::math::Pose3d *poses = _state.ModelPoses();
+  const std::size_t *parents = _state.ModelParents();
+  for (std::size_t m = 0; m < _state.ModelCount(); ++m)
+  {
+    if (parents[m] != StateFrame::kInvalidIndex)
+      continue;
+    auto it = this->dataPtr->modelIndex.find(_state.ModelName(m));
+    if (it == this->dataPtr->modelIndex.end())
+      continue;
+
+    Model &model = this->dataPtr->models[it->second];
+    model.SetRawPose(poses[m]);
+    model.SetPoseRelativeTo("");
+    model.SetPlacementFrameName("");
+    model.ResetPoseCaches();
+  }
+  return errors;
 }
 
 /////////////////////////////////////////////////
-const Frame *World::FrameByName(const std::string &_name) const
+Errors World::ResolvePoses(std::vector<ignition::math::Pose3d> &_poses,
+    std::vector<std::string> &_names) const
 {
-  for (auto const &f : this->dataPtr->frames)
+  this->dataPtr->BuildDeferredGraphs();
+  Errors errors;
+  _poses.clear();
+  _names.clear();
+
+  const auto &graph = this->dataPtr->poseRelativeToGraph;
+  ResolvedVertexPoses resolved;
+  errors = resolveAllPosesRelativeToRoot(resolved, graph);
+  if (!graph)
+    return errors;
+
+  auto appendVertex = [&](const std::string &_name)
   {
-    if (f.Name() == _name)
+    _names.push_back(_name);
+    auto it = resolved.find(graph.VertexIdByName(_name));
+    if (it == resolved.end())
     {
-      return &f;
+      errors.push_back({ErrorCode::POSE_RELATIVE_TO_GRAPH_ERROR,
+          "Unable to resolve pose of [" + _name + "], it is not connected "
+          "to the world frame in the PoseRelativeToGraph."});
+      _poses.push_back(ignition::math::Pose3d::Zero);
+      return;
     }
+    _poses.push_back(it->second);
+  };
+
+  for (const Model &model : this->dataPtr->models)
+  {
+    appendVertex(model.Name());
+    appendModelPoses(model, model.Name() + "::", graph, resolved, _poses,
+        _names, errors);
   }
-  return nullptr;
+
+  for (const Frame &frame : this->dataPtr->frames)
+    appendVertex(frame.Name());
+
+  return errors;
+}
+
+/////////////////////////////////////////////////
+PoseGraphSnapshot World::PoseSnapshot() const
+{
+  this->dataPtr->BuildDeferredGraphs();
+  return PoseGraphSnapshot(this->dataPtr->poseRelativeToGraph);
 }
 
 /////////////////////////////////////////////////
@@ -521,17 +1197,16 @@ const Light *World::LightByIndex(const uint64_t _index) const
   return nullptr;
 }
 
+/////////////////////////////////////////////////
+Span<const Light> World::Lights() const
+{
+  return {this->dataPtr->lights.data(), this->dataPtr->lights.size()};
+}
+
 /////////////////////////////////////////////////
 bool World::LightNameExists(const std::string &_name) const
 {
-  for (auto const &l : this->dataPtr->lights)
-  {
-    if (l.Name() == _name)
-    {
-      return true;
-    }
-  }
-  return false;
+  return this->dataPtr->lightIndex.count(_name) > 0;
 }
 
 /////////////////////////////////////////////////
@@ -548,17 +1223,42 @@ const Actor *World::ActorByIndex(const uint64_t _index) const
   return nullptr;
 }
 
+/////////////////////////////////////////////////
+Span<const Actor> World::Actors() const
+{
+  return {this->dataPtr->actors.data(), this->dataPtr->actors.size()};
+}
+
 /////////////////////////////////////////////////
 bool World::ActorNameExists(const std::string &_name) const
 {
-  for (auto const &a : this->dataPtr->actors)
-  {
-    if (a.Name() == _name)
-    {
-      return true;
-    }
-  }
-  return false;
+  return this->dataPtr->actorIndex.count(_name) > 0;
+}
+
+/////////////////////////////////////////////////
+uint64_t World::PopulationCount() const
+{
+  return this->dataPtr->populations.size();
+}
+
+/////////////////////////////////////////////////
+const Population *World::PopulationByIndex(const uint64_t _index) const
+{
+  if (_index < this->dataPtr->populations.size())
+    return &this->dataPtr->populations[_index];
+  return nullptr;
+}
+
+/////////////////////////////////////////////////
+Span<const Population> World::Populations() const
+{
+  return {this->dataPtr->populations.data(), this->dataPtr->populations.size()};
+}
+
+/////////////////////////////////////////////////
+bool World::PopulationNameExists(const std::string &_name) const
+{
+  return this->dataPtr->populationIndex.count(_name) > 0;
 }
 
 //////////////////////////////////////////////////
@@ -575,6 +1275,12 @@ const Physics *World::PhysicsByIndex(const uint64_t _index) const
   return nullptr;
 }
 
+/////////////////////////////////////////////////
+Span<const Physics> World::PhysicsProfiles() const
+{
+  return {this->dataPtr->physics.data(), this->dataPtr->physics.size()};
+}
+
 //////////////////////////////////////////////////
 const Physics *World::PhysicsDefault() const
 {
@@ -595,15 +1301,7 @@ const Physics *World::PhysicsDefault() const
 //////////////////////////////////////////////////
 bool World::PhysicsNameExists(const std::string &_name) const
 {
-  for (const Physics &physics : this->dataPtr->physics)
-  {
-    if (physics.Name() == _name)
-    {
-      return true;
-    }
-  }
-
-  return false;
+  return this->dataPtr->physicsIndex.count(_name) > 0;
 }
 
 /////////////////////////////////////////////////
@@ -626,6 +1324,14 @@ void World::SetPoseRelativeToGraph(sdf::ScopedGraph<PoseRelativeToGraph> _graph)
   }
 }
 
+/////////////////////////////////////////////////
+void World::SetDeferredGraphs(const std::shared_ptr<DeferredGraphs> &_graphs)
+{
+  this->dataPtr->deferredGraphs = _graphs;
+  for (auto &model : this->dataPtr->models)
+    model.SetDeferredGraphs(_graphs);
+}
+
 /////////////////////////////////////////////////
 void World::SetFrameAttachedToGraph(
     sdf::ScopedGraph<FrameAttachedToGraph> _graph)
@@ -641,3 +1347,10 @@ void World::SetFrameAttachedToGraph(
     model.SetFrameAttachedToGraph(this->dataPtr->frameAttachedToGraph);
   }
 }
+
+/////////////////////////////////////////////////
+template <>
+std::size_t sdf::domPrivateSize<World>()
+{
+  return sizeof(WorldPrivate);
+}
@@ -0,0 +1,575 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <ignition/math/AxisAlignedBox.hh>
+#include <ignition/math/Inertial.hh>
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Vector3.hh>
+
+#include "sdf/Box.hh"
+#include "sdf/Capsule.hh"
+#include "sdf/Collision.hh"
+#include "sdf/Cylinder.hh"
+#include "sdf/Error.hh"
+#include "sdf/Frame.hh"
+#include "sdf/Geometry.hh"
+#include "sdf/Heightmap.hh"
+#include "sdf/Joint.hh"
+#include "sdf/JointAxis.hh"
+#include "sdf/Link.hh"
+#include "sdf/Mesh.hh"
+#include "sdf/Model.hh"
+#include "sdf/Plane.hh"
+#include "sdf/Sphere.hh"
+#include "sdf/Visual.hh"
+#include "sdf/World.hh"
+#include "sdf/WorldExport.hh"
+
+using namespace sdf;
+
+class sdf::WorldExportPrivate
+{
+  /// \brief Remove all entities, keeping the storage.
+  public: void Clear()
+  {
+    this->types.clear();
+    this->parents.clear();
+    this->linkEntities.clear();
+    this->linkInertials.clear();
+    this->jointEntities.clear();
+    this->jointTypes.clear();
+    this->jointParentLinks.clear();
+    this->jointChildLinks.clear();
+    this->jointAxes.clear();
+    this->jointLower.clear();
+    this->jointUpper.clear();
+    this->jointEffort.clear();
+    this->jointVelocity.clear();
+    this->collisionEntities.clear();
+    this->collisionLinks.clear();
+    this->collisionShapes.clear();
+    this->collisionSizes.clear();
+    this->collisionBounds.clear();
+    this->visualEntities.clear();
+    this->visualBounds.clear();
+  }
+
+  /// \brief Add an entity.
+  /// \param[in] _type Type of the entity.
+  /// \param[in] _parent Entity index of its parent.
+  /// \return Entity index of the new entity.
+  public: std::size_t Add(ExportEntityType _type, std::size_t _parent)
+  {
+    this->types.push_back(_type);
+    this->parents.push_back(_parent);
+    return this->types.size() - 1;
+  }
+
+  /// \brief Add a model and its entities, in the order of
+  /// World::ResolvePoses.
+  /// \param[in] _model The model.
+  /// \param[in] _parent Entity index of the parent model, if any.
+  /// \param[in] _meshCalculator Function that gives the bounds of meshes.
+  /// \param[in,out] _errors Errors of the joint axes are appended to this.
+  public: void AddModel(const Model &_model, std::size_t _parent,
+              const Mesh::AxisAlignedBoxCalculator &_meshCalculator,
+              Errors &_errors);
+
+  /// \brief Scoped names of the entities.
+  public: std::vector<std::string> names;
+
+  /// \brief Types of the entities.
+  public: std::vector<ExportEntityType> types;
+
+  /// \brief Parents of the entities.
+  public: std::vector<std::size_t> parents;
+
+  /// \brief Poses of the entities.
+  public: std::vector<ignition::math::Pose3d> poses;
+
+  /// \brief Entity indices of the links.
+  public: std::vector<std::size_t> linkEntities;
+
+  /// \brief Inertials of the links.
+  public: std::vector<ignition::math::Inertiald> linkInertials;
+
+  /// \brief Entity indices of the joints.
+  public: std::vector<std::size_t> jointEntities;
+
+  /// \brief Types of the joints.
+  public: std::vector<JointType> jointTypes;
+
+  /// \brief Scoped names of the parent links of the joints, until they are
+  /// turned into link indices.
+  public: std::vector<std::string> jointParentNames;
+
+  /// \brief Scoped names of the child links of the joints.
+  public: std::vector<std::string> jointChildNames;
+
+  /// \brief Parent links of the joints.
+  public: std::vector<std::size_t> jointParentLinks;
+
+  /// \brief Child links of the joints.
+  public: std::vector<std::size_t> jointChildLinks;
+
+  /// \brief Axes of the joints in the world frame.
+  public: std::vector<ignition::math::Vector3d> jointAxes;
+
+  /// \brief Lower limits of the joint axes.
+  public: std::vector<double> jointLower;
+
+  /// \brief Upper limits of the joint axes.
+  public: std::vector<double> jointUpper;
+
+  /// \brief Effort limits of the joint axes.
+  public: std::vector<double> jointEffort;
+
+  /// \brief Velocity limits of the joint axes.
+  public: std::vector<double> jointVelocity;
+
+  /// \brief Entity indices of the collisions.
+  public: std::vector<std::size_t> collisionEntities;
+
+  /// \brief Links of the collisions.
+  public: std::vector<std::size_t> collisionLinks;
+
+  /// \brief Shape types of the collisions.
+  public: std::vector<GeometryType> collisionShapes;
+
+  /// \brief Shape dimensions of the collisions.
+  public: std::vector<ignition::math::Vector3d> collisionSizes;
+
+  /// \brief Bounds of the collisions in the world frame.
+  public: std::vector<ignition::math::AxisAlignedBox> collisionBounds;
+
+  /// \brief Entity indices of the visuals.
+  public: std::vector<std::size_t> visualEntities;
+
+  /// \brief Bounds of the visuals in the world frame.
+  public: std::vector<ignition::math::AxisAlignedBox> visualBounds;
+};
+
+/////////////////////////////////////////////////
+/// \brief Get the dimensions of a shape, as described by
+/// WorldExport::CollisionShapeSizes.
+/// \param[in] _geom The geometry.
+/// \return The dimensions.
+static ignition::math::Vector3d shapeSize(const Geometry &_geom)
+{
+  switch (_geom.Type())
+  {
+    case GeometryType::BOX:
+      return _geom.BoxShape()->Size();
+    case GeometryType::SPHERE:
+      return {_geom.SphereShape()->Radius(), 0, 0};
+    case GeometryType::CYLINDER:
+      return {_geom.CylinderShape()->Radius(),
+              _geom.CylinderShape()->Length(), 0};
+    case GeometryType::CAPSULE:
+      return {_geom.CapsuleShape()->Radius(),
+              _geom.CapsuleShape()->Length(), 0};
+    case GeometryType::PLANE:
+      return {_geom.PlaneShape()->Size().X(), _geom.PlaneShape()->Size().Y(),
+              0};
+    case GeometryType::MESH:
+      return _geom.MeshShape()->Scale();
+    case GeometryType::HEIGHTMAP:
+      return _geom.HeightmapShape()->Size();
+    case GeometryType::EMPTY:
+    default:
+      return ignition::math::Vector3d::Zero;
+  }
+}
+
+/////////////////////////////////////////////////
+/// \brief Get the bounds of a geometry relative to the world frame.
+/// \param[in] _geom The geometry, or nullptr.
+/// \param[in] _pose Pose of the geometry frame in the world frame.
+/// \param[in] _meshCalculator Function that gives the bounds of meshes.
+/// \return The box that contains the box of the geometry once it is moved
+/// by _pose, or an empty box if the geometry has no bounds.
+static ignition::math::AxisAlignedBox worldBounds(const Geometry *_geom,
+    const ignition::math::Pose3d &_pose,
+    const Mesh::AxisAlignedBoxCalculator &_meshCalculator)
+{
+  if (!_geom)
+    return ignition::math::AxisAlignedBox();
+  std::optional<ignition::math::AxisAlignedBox> box =
+      _geom->AxisAlignedBox(_meshCalculator);
+  if (!box)
+    return ignition::math::AxisAlignedBox();
+
+  // Each extent of the rotated box sums the rotated half sizes along it.
+  const ignition::math::Vector3d center =
+    _pose.Pos() + _pose.Rot().RotateVector(box->Center());
+  const ignition::math::Vector3d half = box->Size() * 0.5;
+  const ignition::math::Vector3d extent =
+    _pose.Rot().RotateVector(ignition::math::Vector3d::UnitX).Abs() *
+      half.X() +
+    _pose.Rot().RotateVector(ignition::math::Vector3d::UnitY).Abs() *
+      half.Y() +
+    _pose.Rot().RotateVector(ignition::math::Vector3d::UnitZ).Abs() *
+      half.Z();
+  return ignition::math::AxisAlignedBox(center - extent, center + extent);
+}
+
+/////////////////////////////////////////////////
+void WorldExportPrivate::AddModel(const Model &_model, std::size_t _parent,
+    const Mesh::AxisAlignedBoxCalculator &_meshCalculator, Errors &_errors)
+{
+  const std::size_t model = this->Add(ExportEntityType::MODEL, _parent);
+  const std::string scope = this->names[model] + "::";
+
+  for (uint64_t i = 0; i < _model.LinkCount(); ++i)
+  {
+    const Link *link = _model.LinkByIndex(i);
+    const std::size_t linkIndex = this->linkEntities.size();
+    this->linkEntities.push_back(this->Add(ExportEntityType::LINK, model));
+    this->linkInertials.push_back(link->Inertial());
+
+    for (uint64_t j = 0; j < link->VisualCount(); ++j)
+    {
+      const std::size_t entity =
+        this->Add(ExportEntityType::VISUAL, this->linkEntities.back());
+      this->visualEntities.push_back(entity);
+      this->visualBounds.push_back(worldBounds(
+          link->VisualByIndex(j)->Geom(), this->poses[entity],
+          _meshCalculator));
+    }
+
+    for (uint64_t j = 0; j < link->CollisionCount(); ++j)
+    {
+      const Geometry *geom = link->CollisionByIndex(j)->Geom();
+      this->collisionEntities.push_back(
+          this->Add(ExportEntityType::COLLISION, this->linkEntities.back()));
+      this->collisionLinks.push_back(linkIndex);
+      this->collisionShapes.push_back(
+          geom ? geom->Type() : GeometryType::EMPTY);
+      this->collisionSizes.push_back(
+          geom ? shapeSize(*geom) : ignition::math::Vector3d::Zero);
+      this->collisionBounds.push_back(worldBounds(geom,
+          this->poses[this->collisionEntities.back()], _meshCalculator));
+    }
+
+    for (uint64_t j = 0; j < link->SensorCount(); ++j)
+      this->Add(ExportEntityType::SENSOR, this->linkEntities.back());
+  }
+
+  for (uint64_t i = 0; i < _model.JointCount(); ++i)
+  {
+    const Joint *joint = _model.JointByIndex(i);
+    const std::size_t entity = this->Add(ExportEntityType::JOINT, model);
+    this->jointEntities.push_back(entity);
+    this->jointTypes.push_back(joint->Type());
+
+    // Links are matched by scoped name once all of them are listed, since
+    // the links of nested models come later.
+    this->jointParentNames.push_back(joint->ParentLinkName() == "world" ?
+        "" : scope + joint->ParentLinkName());
+    this->jointChildNames.push_back(scope + joint->ChildLinkName());
+
+    for (std::size_t a = 0; a < WorldExport::kAxesPerJoint; ++a)
+    {
+      const JointAxis *axis = joint->Axis(static_cast<unsigned int>(a));
+      if (!axis)
+      {
+        this->jointAxes.push_back(ignition::math::Vector3d::Zero);
+        this->jointLower.push_back(0);
+        this->jointUpper.push_back(0);
+        this->jointEffort.push_back(0);
+        this->jointVelocity.push_back(0);
+        continue;
+      }
+
+      // The axis is resolved in the joint frame, whose world pose is known.
+      ignition::math::Vector3d xyz = axis->Xyz();
+      Errors axisErrors = axis->ResolveXyz(xyz);
+      _errors.insert(_errors.end(), axisErrors.begin(), axisErrors.end());
+      this->jointAxes.push_back(this->poses[entity].Rot() * xyz);
+      this->jointLower.push_back(axis->Lower());
+      this->jointUpper.push_back(axis->Upper());
+      this->jointEffort.push_back(axis->Effort());
+      this->jointVelocity.push_back(axis->MaxVelocity());
+    }
+  }
+
+  for (uint64_t i = 0; i < _model.FrameCount(); ++i)
+    this->Add(ExportEntityType::FRAME, model);
+
+  for (uint64_t i = 0; i < _model.ModelCount(); ++i)
+    this->AddModel(*_model.ModelByIndex(i), model, _meshCalculator, _errors);
+}
+
+/////////////////////////////////////////////////
+WorldExport::WorldExport()
+  : dataPtr(new WorldExportPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+WorldExport::WorldExport(const WorldExport &_export)
+  : dataPtr(new WorldExportPrivate(*_export.dataPtr))
+{
+}
+
+/////////////////////////////////////////////////
+WorldExport::WorldExport(WorldExport &&_export) noexcept
+  : dataPtr(std::exchange(_export.dataPtr, nullptr))
+{
+}
+
+/////////////////////////////////////////////////
+WorldExport &WorldExport::operator=(WorldExport &&_export) noexcept
+{
+  std::swap(this->dataPtr, _export.dataPtr);
+  return *this;
+}
+
+/////////////////////////////////////////////////
+WorldExport &WorldExport::operator=(const WorldExport &_export)
+{
+  return *this = WorldExport(_export);
+}
+
+/////////////////////////////////////////////////
+WorldExport::~WorldExport()
+{
+  delete this->dataPtr;
+  this->dataPtr = nullptr;
+}
+
+/////////////////////////////////////////////////
+Errors WorldExport::Build(const World &_world,
+    const Mesh::AxisAlignedBoxCalculator &_meshCalculator)
+{
+  WorldExportPrivate &data = *this->dataPtr;
+  data.Clear();
+
+  Errors errors = _world.ResolvePoses(data.poses, data.names);
+
+  // Worlds that were not loaded through sdf::Root have no pose graph, and
+  // no names to match the entities with.
+  if (data.names.empty())
+  {
+    data.poses.clear();
+    return errors;
+  }
+
+  for (uint64_t i = 0; i < _world.ModelCount(); ++i)
+  {
+    data.AddModel(*_world.ModelByIndex(i), kInvalidIndex, _meshCalculator,
+        errors);
+  }
+
+  for (uint64_t i = 0; i < _world.FrameCount(); ++i)
+    data.Add(ExportEntityType::FRAME, kInvalidIndex);
+
+  // Turn the link names of the joints into link indices.
+  std::unordered_map<std::string, std::size_t> linkIndices;
+  linkIndices.reserve(data.linkEntities.size());
+  for (std::size_t i = 0; i < data.linkEntities.size(); ++i)
+    linkIndices.emplace(data.names[data.linkEntities[i]], i);
+
+  auto findLink = [&linkIndices](const std::string &_name)
+  {
+    auto iter = linkIndices.find(_name);
+    return iter == linkIndices.end() ? kInvalidIndex : iter->second;
+  };
+
+  data.jointParentLinks.resize(data.jointEntities.size());
+  data.jointChildLinks.resize(data.jointEntities.size());
+  for (std::size_t i = 0; i < data.jointEntities.size(); ++i)
+  {
+    data.jointParentLinks[i] = findLink(data.jointParentNames[i]);
+    data.jointChildLinks[i] = findLink(data.jointChildNames[i]);
+  }
+  data.jointParentNames.clear();
+  data.jointChildNames.clear();
+
+  return errors;
+}
+
+/////////////////////////////////////////////////
+std::size_t WorldExport::EntityCount() const
+{
+  return this->dataPtr->types.size();
+}
+
+/////////////////////////////////////////////////
+const ExportEntityType *WorldExport::EntityTypes() const
+{
+  return this->dataPtr->types.data();
+}
+
+/////////////////////////////////////////////////
+const std::size_t *WorldExport::EntityParents() const
+{
+  return this->dataPtr->parents.data();
+}
+
+/////////////////////////////////////////////////
+const ignition::math::Pose3d *WorldExport::EntityPoses() const
+{
+  return this->dataPtr->poses.data();
+}
+
+/////////////////////////////////////////////////
+const std::string &WorldExport::EntityName(std::size_t _index) const
+{
+  static const std::string kEmpty;
+  if (_index < this->dataPtr->names.size())
+    return this->dataPtr->names[_index];
+  return kEmpty;
+}
+
+/////////////////////////////////////////////////
+std::size_t WorldExport::LinkCount() const
+{
+  return this->dataPtr->linkEntities.size();
+}
+
+/////////////////////////////////////////////////
+const std::size_t *WorldExport::LinkEntities() const
+{
+  return this->dataPtr->linkEntities.data();
+}
+
+/////////////////////////////////////////////////
+const ignition::math::Inertiald *WorldExport::LinkInertials() const
+{
+  return this->dataPtr->linkInertials.data();
+}
+
+/////////////////////////////////////////////////
+std::size_t WorldExport::JointCount() const
+{
+  return this->dataPtr->jointEntities.size();
+}
+
+/////////////////////////////////////////////////
+const std::size_t *WorldExport::JointEntities() const
+{
+  return this->dataPtr->jointEntities.data();
+}
+
+/////////////////////////////////////////////////
+const JointType *WorldExport::JointTypes() const
+{
+  return this->dataPtr->jointTypes.data();
+}
+
+/////////////////////////////////////////////////
+const std::size_t *WorldExport::JointParentLinks() const
+{
+  return this->dataPtr->jointParentLinks.data();
+}
+
+/////////////////////////////////////////////////
+const std::size_t *WorldExport::JointChildLinks() const
+{
+  return this->dataPtr->jointChildLinks.data();
+}
+
+/////////////////////////////////////////////////
+const ignition::math::Vector3d *WorldExport::JointAxes() const
+{
+  return this->dataPtr->jointAxes.data();
+}
+
+/////////////////////////////////////////////////
+const double *WorldExport::JointLowerLimits() const
+{
+  return this->dataPtr->jointLower.data();
+}
+
+/////////////////////////////////////////////////
+const double *WorldExport::JointUpperLimits() const
+{
+  return this->dataPtr->jointUpper.data();
+}
+
+/////////////////////////////////////////////////
+const double *WorldExport::JointEffortLimits() const
+{
+  return this->dataPtr->jointEffort.data();
+}
+
+/////////////////////////////////////////////////
+const double *WorldExport::JointVelocityLimits() const
+{
+  return this->dataPtr->jointVelocity.data();
+}
+
+/////////////////////////////////////////////////
+std::size_t WorldExport::CollisionCount() const
+{
+  return this->dataPtr->collisionEntities.size();
+}
+
+/////////////////////////////////////////////////
+const std::size_t *WorldExport::CollisionEntities() const
+{
+  return this->dataPtr->collisionEntities.data();
+}
+
+/////////////////////////////////////////////////
+const std::size_t *WorldExport::CollisionLinks() const
+{
+  return this->dataPtr->collisionLinks.data();
+}
+
+/////////////////////////////////////////////////
+const GeometryType *WorldExport::CollisionShapes() const
+{
+  return this->dataPtr->collisionShapes.data();
+}
+
+/////////////////////////////////////////////////
+const ignition::math::Vector3d *WorldExport::CollisionShapeSizes() const
+{
+  return this->dataPtr->collisionSizes.data();
+}
+
+/////////////////////////////////////////////////
+const ignition::math::AxisAlignedBox *WorldExport::CollisionBounds() const
+{
+  return this->dataPtr->collisionBounds.data();
+}
+
+/////////////////////////////////////////////////
+std::size_t WorldExport::VisualCount() const
+{
+  return this->dataPtr->visualEntities.size();
+}
+
+/////////////////////////////////////////////////
+const std::size_t *WorldExport::VisualEntities() const
+{
+  return this->dataPtr->visualEntities.data();
+}
+
+/////////////////////////////////////////////////
+const ignition::math::AxisAlignedBox *WorldExport::VisualBounds() const
+{
+  return this->dataPtr->visualBounds.data();
+}
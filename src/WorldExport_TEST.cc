@@ -0,0 +1,237 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+#include <optional>
+#include <string>
+#include <ignition/math/AxisAlignedBox.hh>
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Vector3.hh>
+#include "sdf/Root.hh"
+#include "sdf/World.hh"
+#include "sdf/WorldExport.hh"
+
+/////////////////////////////////////////////////
+TEST(DOMWorldExport, Construction)
+{
+  sdf::WorldExport worldExport;
+  EXPECT_EQ(0u, worldExport.EntityCount());
+  EXPECT_EQ(0u, worldExport.LinkCount());
+  EXPECT_EQ(0u, worldExport.JointCount());
+  EXPECT_EQ(0u, worldExport.CollisionCount());
+  EXPECT_TRUE(worldExport.EntityName(0).empty());
+
+  // A world that was not loaded through a Root has no poses to export.
+  sdf::World world;
+  worldExport.Build(world);
+  EXPECT_EQ(0u, worldExport.EntityCount());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMWorldExport, Build)
+{
+  const std::string sdfString = R"(
+  <sdf version="1.8">
+    <world name="default">
+      <model name="arm">
+        <pose>1 0 0 0 0 0</pose>
+        <link name="base">
+          <inertial><mass>2</mass></inertial>
+          <collision name="box">
+            <geometry><box><size>1 2 3</size></box></geometry>
+          </collision>
+          <visual name="visual">
+            <geometry><sphere><radius>1</radius></sphere></geometry>
+          </visual>
+        </link>
+        <joint name="fix" type="fixed">
+          <parent>world</parent>
+          <child>base</child>
+        </joint>
+        <joint name="hinge" type="revolute">
+          <pose relative_to="base">0 0 1 0 0 1.5707963267948966</pose>
+          <parent>base</parent>
+          <child>hand::palm</child>
+          <axis>
+            <xyz>1 0 0</xyz>
+            <limit><lower>-1</lower><upper>2</upper><effort>3</effort></limit>
+          </axis>
+        </joint>
+        <frame name="tip" attached_to="base"/>
+        <model name="hand">
+          <pose>0 0 2 0 0 0</pose>
+          <link name="palm">
+            <collision name="cylinder">
+              <geometry>
+                <cylinder><radius>0.5</radius><length>4</length></cylinder>
+              </geometry>
+            </collision>
+          </link>
+        </model>
+      </model>
+      <frame name="marker"><pose>0 5 0 0 0 0</pose></frame>
+    </world>
+  </sdf>)";
+
+  sdf::Root root;
+  ASSERT_TRUE(root.LoadSdfString(sdfString).empty());
+  const sdf::World *world = root.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+
+  sdf::WorldExport worldExport;
+  EXPECT_TRUE(worldExport.Build(*world).empty());
+
+  // arm, base, visual, box, fix, hinge, tip, hand, palm, cylinder, marker
+  ASSERT_EQ(11u, worldExport.EntityCount());
+  const sdf::ExportEntityType *types = worldExport.EntityTypes();
+  const std::size_t *parents = worldExport.EntityParents();
+  const ignition::math::Pose3d *poses = worldExport.EntityPoses();
+
+  EXPECT_EQ(sdf::ExportEntityType::MODEL, types[0]);
+  EXPECT_EQ(sdf::WorldExport::kInvalidIndex, parents[0]);
+  EXPECT_EQ(ignition::math::Pose3d(1, 0, 0, 0, 0, 0), poses[0]);
+
+  EXPECT_EQ("arm::base", worldExport.EntityName(1));
+  EXPECT_EQ(sdf::ExportEntityType::LINK, types[1]);
+  EXPECT_EQ(0u, parents[1]);
+  EXPECT_EQ(sdf::ExportEntityType::VISUAL, types[2]);
+  EXPECT_EQ(1u, parents[2]);
+  EXPECT_EQ(sdf::ExportEntityType::COLLISION, types[3]);
+  EXPECT_EQ(1u, parents[3]);
+  EXPECT_EQ(sdf::ExportEntityType::JOINT, types[4]);
+  EXPECT_EQ(sdf::ExportEntityType::JOINT, types[5]);
+  EXPECT_EQ(sdf::ExportEntityType::FRAME, types[6]);
+  EXPECT_EQ("arm::hand", worldExport.EntityName(7));
+  EXPECT_EQ(sdf::ExportEntityType::MODEL, types[7]);
+  EXPECT_EQ(0u, parents[7]);
+  EXPECT_EQ(ignition::math::Pose3d(1, 0, 2, 0, 0, 0), poses[7]);
+  EXPECT_EQ("arm::hand::palm", worldExport.EntityName(8));
+  EXPECT_EQ(7u, parents[8]);
+  EXPECT_EQ("marker", worldExport.EntityName(10));
+  EXPECT_EQ(sdf::ExportEntityType::FRAME, types[10]);
+  EXPECT_EQ(sdf::WorldExport::kInvalidIndex, parents[10]);
+  EXPECT_EQ(ignition::math::Pose3d(0, 5, 0, 0, 0, 0), poses[10]);
+
+  // Links
+  ASSERT_EQ(2u, worldExport.LinkCount());
+  EXPECT_EQ(1u, worldExport.LinkEntities()[0]);
+  EXPECT_EQ(8u, worldExport.LinkEntities()[1]);
+  EXPECT_DOUBLE_EQ(2.0, worldExport.LinkInertials()[0].MassMatrix().Mass());
+
+  // Joints
+  ASSERT_EQ(2u, worldExport.JointCount());
+  EXPECT_EQ(sdf::JointType::FIXED, worldExport.JointTypes()[0]);
+  EXPECT_EQ(sdf::WorldExport::kInvalidIndex,
+      worldExport.JointParentLinks()[0]);
+  EXPECT_EQ(0u, worldExport.JointChildLinks()[0]);
+  EXPECT_EQ(sdf::JointType::REVOLUTE, worldExport.JointTypes()[1]);
+  EXPECT_EQ(0u, worldExport.JointParentLinks()[1]);
+  EXPECT_EQ(1u, worldExport.JointChildLinks()[1]);
+
+  // The hinge axis is rotated by the joint pose into the world frame.
+  const std::size_t hingeAxis = sdf::WorldExport::kAxesPerJoint;
+  EXPECT_EQ(ignition::math::Vector3d::UnitY,
+      worldExport.JointAxes()[hingeAxis]);
+  EXPECT_DOUBLE_EQ(-1.0, worldExport.JointLowerLimits()[hingeAxis]);
+  EXPECT_DOUBLE_EQ(2.0, worldExport.JointUpperLimits()[hingeAxis]);
+  EXPECT_DOUBLE_EQ(3.0, worldExport.JointEffortLimits()[hingeAxis]);
+  EXPECT_EQ(ignition::math::Vector3d::Zero,
+      worldExport.JointAxes()[hingeAxis + 1]);
+
+  // Collisions
+  ASSERT_EQ(2u, worldExport.CollisionCount());
+  EXPECT_EQ(3u, worldExport.CollisionEntities()[0]);
+  EXPECT_EQ(0u, worldExport.CollisionLinks()[0]);
+  EXPECT_EQ(sdf::GeometryType::BOX, worldExport.CollisionShapes()[0]);
+  EXPECT_EQ(ignition::math::Vector3d(1, 2, 3),
+      worldExport.CollisionShapeSizes()[0]);
+  EXPECT_EQ(1u, worldExport.CollisionLinks()[1]);
+  EXPECT_EQ(sdf::GeometryType::CYLINDER, worldExport.CollisionShapes()[1]);
+  EXPECT_EQ(ignition::math::Vector3d(0.5, 4, 0),
+      worldExport.CollisionShapeSizes()[1]);
+
+  // Bounds in the world frame
+  using ignition::math::AxisAlignedBox;
+  using ignition::math::Vector3d;
+  EXPECT_EQ(AxisAlignedBox(Vector3d(0.5, -1, -1.5), Vector3d(1.5, 1, 1.5)),
+      worldExport.CollisionBounds()[0]);
+  EXPECT_EQ(AxisAlignedBox(Vector3d(0.5, -0.5, 0), Vector3d(1.5, 0.5, 4)),
+      worldExport.CollisionBounds()[1]);
+  ASSERT_EQ(1u, worldExport.VisualCount());
+  EXPECT_EQ(2u, worldExport.VisualEntities()[0]);
+  EXPECT_EQ(AxisAlignedBox(Vector3d(0, -1, -1), Vector3d(2, 1, 1)),
+      worldExport.VisualBounds()[0]);
+
+  // Building again replaces the content.
+  EXPECT_TRUE(worldExport.Build(*world).empty());
+  EXPECT_EQ(11u, worldExport.EntityCount());
+  EXPECT_EQ(2u, worldExport.LinkCount());
+
+  sdf::WorldExport copy(worldExport);
+  EXPECT_EQ(11u, copy.EntityCount());
+  EXPECT_EQ("arm::hand::palm", copy.EntityName(8));
+}
+
+/////////////////////////////////////////////////
+TEST(DOMWorldExport, Bounds)
+{
+  const std::string sdfString = R"(
+  <sdf version="1.8">
+    <world name="default">
+      <model name="m">
+        <link name="l">
+          <pose>0 0 1 0 0 1.5707963267948966</pose>
+          <collision name="box">
+            <geometry><box><size>1 2 3</size></box></geometry>
+          </collision>
+          <visual name="mesh">
+            <geometry>
+              <mesh><uri>mesh.dae</uri><scale>2 2 2</scale></mesh>
+            </geometry>
+          </visual>
+        </link>
+      </model>
+    </world>
+  </sdf>)";
+
+  sdf::Root root;
+  ASSERT_TRUE(root.LoadSdfString(sdfString).empty());
+  const sdf::World *world = root.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+
+  using ignition::math::AxisAlignedBox;
+  using ignition::math::Vector3d;
+
+  // Meshes have no bounds without a calculator.
+  sdf::WorldExport worldExport;
+  EXPECT_TRUE(worldExport.Build(*world).empty());
+  ASSERT_EQ(1u, worldExport.CollisionCount());
+  ASSERT_EQ(1u, worldExport.VisualCount());
+  EXPECT_EQ(AxisAlignedBox(Vector3d(-1, -0.5, -0.5), Vector3d(1, 0.5, 2.5)),
+      worldExport.CollisionBounds()[0]);
+  EXPECT_EQ(AxisAlignedBox(), worldExport.VisualBounds()[0]);
+
+  auto calculator = [](const sdf::Mesh &)
+  {
+    return std::optional<AxisAlignedBox>(
+        AxisAlignedBox(Vector3d(0, 0, 0), Vector3d(1, 1, 1)));
+  };
+  EXPECT_TRUE(worldExport.Build(*world, calculator).empty());
+  ASSERT_EQ(1u, worldExport.VisualCount());
+  EXPECT_EQ(AxisAlignedBox(Vector3d(-2, 0, 1), Vector3d(0, 2, 3)),
+      worldExport.VisualBounds()[0]);
+}
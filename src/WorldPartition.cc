@@ -0,0 +1,515 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Vector3.hh>
+
+#include "sdf/Element.hh"
+#include "sdf/Frame.hh"
+#include "sdf/Model.hh"
+#include "sdf/SDFImpl.hh"
+#include "sdf/World.hh"
+#include "sdf/WorldPartition.hh"
+
+using namespace sdf;
+
+/// \brief Private data for WorldPartition
+class sdf::WorldPartitionPrivate
+{
+  /// \brief Remove the partition.
+  public: void Clear()
+  {
+    this->shardModels.clear();
+    this->modelShards.clear();
+    this->frameShards.clear();
+    this->modelTargets.clear();
+    this->frameTargets.clear();
+    this->dependencies.clear();
+    this->worldName.clear();
+    this->modelElements.clear();
+    this->frameElements.clear();
+    this->otherElements.clear();
+    this->modelPoses.clear();
+    this->framePoses.clear();
+  }
+
+  /// \brief Indices of the models of each shard.
+  public: std::vector<std::vector<std::size_t>> shardModels;
+
+  /// \brief Shard of each model.
+  public: std::vector<std::size_t> modelShards;
+
+  /// \brief Shard of each frame, or kAllShards.
+  public: std::vector<std::size_t> frameShards;
+
+  /// \brief Shard of the frame each model is posed relative to, or
+  /// kAllShards if that frame is in every shard.
+  public: std::vector<std::size_t> modelTargets;
+
+  /// \brief Shard of the frame each frame is posed relative to, or
+  /// kAllShards if that frame is in every shard.
+  public: std::vector<std::size_t> frameTargets;
+
+  /// \brief Poses relative to frames of other shards.
+  public: std::vector<ShardDependency> dependencies;
+
+  /// \brief Name of the world.
+  public: std::string worldName;
+
+  /// \brief Element of each model.
+  public: ElementPtr_V modelElements;
+
+  /// \brief Element of each frame.
+  public: ElementPtr_V frameElements;
+
+  /// \brief Children of the world that are neither models nor frames.
+  public: ElementPtr_V otherElements;
+
+  /// \brief Pose of each model relative to the world frame.
+  public: std::vector<ignition::math::Pose3d> modelPoses;
+
+  /// \brief Pose of each frame relative to the world frame.
+  public: std::vector<ignition::math::Pose3d> framePoses;
+};
+
+/////////////////////////////////////////////////
+WorldPartition::WorldPartition()
+  : dataPtr(new WorldPartitionPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+WorldPartition::WorldPartition(const WorldPartition &_partition)
+  : dataPtr(new WorldPartitionPrivate(*_partition.dataPtr))
+{
+}
+
+/////////////////////////////////////////////////
+WorldPartition::WorldPartition(WorldPartition &&_partition) noexcept
+  : dataPtr(std::exchange(_partition.dataPtr, nullptr))
+{
+}
+
+/////////////////////////////////////////////////
+WorldPartition &WorldPartition::operator=(
+    WorldPartition &&_partition) noexcept
+{
+  std::swap(this->dataPtr, _partition.dataPtr);
+  return *this;
+}
+
+/////////////////////////////////////////////////
+WorldPartition &WorldPartition::operator=(const WorldPartition &_partition)
+{
+  return *this = WorldPartition(_partition);
+}
+
+/////////////////////////////////////////////////
+WorldPartition::~WorldPartition()
+{
+  delete this->dataPtr;
+  this->dataPtr = nullptr;
+}
+
+/////////////////////////////////////////////////
+/// \brief Find the representative of a node of a disjoint set forest.
+/// \param[in,out] _parents Parent of each node, compressed along the path.
+/// \param[in] _node The node.
+/// \return The representative of the set of the node.
+static std::size_t findSet(std::vector<std::size_t> &_parents,
+    std::size_t _node)
+{
+  while (_parents[_node] != _node)
+  {
+    _parents[_node] = _parents[_parents[_node]];
+    _node = _parents[_node];
+  }
+  return _node;
+}
+
+/////////////////////////////////////////////////
+/// \brief Assign groups of models to shards by recursively halving the
+/// longest side of the box around their centers.
+/// \param[in,out] _groups Groups to assign, reordered in place.
+/// \param[in] _begin First group of the range to assign.
+/// \param[in] _end End of the range of groups to assign.
+/// \param[in] _firstShard First shard of the range of shards.
+/// \param[in] _shardCount Number of shards of the range.
+/// \param[in] _centers Center of each group.
+/// \param[in] _weights Number of models of each group.
+/// \param[out] _groupShards Shard of each group.
+static void splitSpatial(std::vector<std::size_t> &_groups,
+    std::size_t _begin, std::size_t _end, std::size_t _firstShard,
+    std::size_t _shardCount,
+    const std::vector<ignition::math::Vector3d> &_centers,
+    const std::vector<std::size_t> &_weights,
+    std::vector<std::size_t> &_groupShards)
+{
+  if (_shardCount == 1 || _end - _begin <= 1)
+  {
+    for (std::size_t i = _begin; i < _end; ++i)
+      _groupShards[_groups[i]] = _firstShard;
+    return;
+  }
+
+  ignition::math::Vector3d min = _centers[_groups[_begin]];
+  ignition::math::Vector3d max = min;
+  double total = 0;
+  for (std::size_t i = _begin; i < _end; ++i)
+  {
+    min.Min(_centers[_groups[i]]);
+    max.Max(_centers[_groups[i]]);
+    total += static_cast<double>(_weights[_groups[i]]);
+  }
+  const ignition::math::Vector3d size = max - min;
+  const int axis = size.X() >= size.Y() && size.X() >= size.Z() ? 0 :
+      (size.Y() >= size.Z() ? 1 : 2);
+
+  std::sort(_groups.begin() + _begin, _groups.begin() + _end,
+      [&](std::size_t _a, std::size_t _b)
+      {
+        const double a = _centers[_a][axis];
+        const double b = _centers[_b][axis];
+        return a < b || (a == b && _a < _b);
+      });
+
+  // The groups whose middle is before the share of the first half of the
+  // shards go to that half.
+  const std::size_t firstCount = _shardCount / 2;
+  const double share = total * static_cast<double>(firstCount) /
+      static_cast<double>(_shardCount);
+  std::size_t middle = _begin;
+  double sum = 0;
+  while (middle < _end &&
+      sum + 0.5 * static_cast<double>(_weights[_groups[middle]]) < share)
+  {
+    sum += static_cast<double>(_weights[_groups[middle]]);
+    ++middle;
+  }
+
+  splitSpatial(_groups, _begin, middle, _firstShard, firstCount, _centers,
+      _weights, _groupShards);
+  splitSpatial(_groups, middle, _end, _firstShard + firstCount,
+      _shardCount - firstCount, _centers, _weights, _groupShards);
+}
+
+/////////////////////////////////////////////////
+Errors WorldPartition::Build(const World &_world, std::size_t _shardCount,
+    PartitionStrategy _strategy)
+{
+  WorldPartitionPrivate &data = *this->dataPtr;
+  data.Clear();
+  const std::size_t shardCount = std::max<std::size_t>(_shardCount, 1u);
+  data.shardModels.resize(shardCount);
+  data.worldName = _world.Name();
+
+  Errors errors;
+  const std::size_t modelCount = _world.ModelCount();
+  const std::size_t frameCount = _world.FrameCount();
+  ElementPtr worldElem = _world.Element();
+  if (!worldElem)
+  {
+    errors.push_back({ErrorCode::ELEMENT_MISSING,
+        "The elements of world with name[" + _world.Name() +
+        "] were released, so its shards can't be written."});
+  }
+
+  // Nodes of the forest: the models, the frames, then the world frame.
+  const std::size_t worldNode = modelCount + frameCount;
+  const std::size_t noNode = worldNode + 1;
+  std::unordered_map<std::string, std::size_t> nodes;
+  for (std::size_t i = 0; i < modelCount; ++i)
+  {
+    const Model *model = _world.ModelByIndex(i);
+    nodes.emplace(model->Name(), i);
+    data.modelElements.push_back(model->Element());
+  }
+  for (std::size_t i = 0; i < frameCount; ++i)
+  {
+    const Frame *frame = _world.FrameByIndex(i);
+    nodes.emplace(frame->Name(), modelCount + i);
+    data.frameElements.push_back(frame->Element());
+  }
+
+  // Top level frames are named by the first part of a scoped name.
+  auto nodeOf = [&](const std::string &_name)
+  {
+    if (_name.empty() || _name == "world")
+      return worldNode;
+    auto it = nodes.find(_name.substr(0, _name.find("::")));
+    return it == nodes.end() ? noNode : it->second;
+  };
+  std::vector<std::size_t> relativeTo(worldNode);
+  for (std::size_t i = 0; i < modelCount; ++i)
+    relativeTo[i] = nodeOf(_world.ModelByIndex(i)->PoseRelativeTo());
+
+  // Frames are grouped with what they are attached to, and the groups of
+  // the world frame are written to every shard.
+  std::vector<std::size_t> parents(worldNode + 1);
+  for (std::size_t i = 0; i < parents.size(); ++i)
+    parents[i] = i;
+  for (std::size_t i = 0; i < frameCount; ++i)
+  {
+    const Frame *frame = _world.FrameByIndex(i);
+    const std::size_t attachedTo = nodeOf(frame->AttachedTo());
+    relativeTo[modelCount + i] = frame->PoseRelativeTo().empty() ?
+        attachedTo : nodeOf(frame->PoseRelativeTo());
+    if (attachedTo != noNode)
+    {
+      parents[findSet(parents, modelCount + i)] =
+          findSet(parents, attachedTo);
+    }
+  }
+  const std::size_t worldSet = findSet(parents, worldNode);
+  std::vector<bool> global(worldNode);
+  for (std::size_t i = 0; i < worldNode; ++i)
+    global[i] = findSet(parents, i) == worldSet;
+
+  if (_strategy == PartitionStrategy::CONNECTIVITY)
+  {
+    for (std::size_t i = 0; i < worldNode; ++i)
+    {
+      const std::size_t target = relativeTo[i];
+      if (!global[i] && target < worldNode && !global[target])
+        parents[findSet(parents, i)] = findSet(parents, target);
+    }
+  }
+
+  // World poses of the models and frames.
+  std::vector<ignition::math::Pose3d> poses;
+  std::vector<std::string> names;
+  Errors poseErrors = _world.ResolvePoses(poses, names);
+  errors.insert(errors.end(), poseErrors.begin(), poseErrors.end());
+  data.modelPoses.resize(modelCount);
+  data.framePoses.resize(frameCount);
+  for (std::size_t i = 0; i < names.size(); ++i)
+  {
+    if (names[i].find("::") != std::string::npos)
+      continue;
+    auto it = nodes.find(names[i]);
+    if (it == nodes.end())
+      continue;
+    if (it->second < modelCount)
+      data.modelPoses[it->second] = poses[i];
+    else
+      data.framePoses[it->second - modelCount] = poses[i];
+  }
+
+  // Groups of models and of the frames attached to them.
+  std::vector<std::size_t> nodeGroups(worldNode, kAllShards);
+  std::unordered_map<std::size_t, std::size_t> setGroups;
+  std::vector<ignition::math::Vector3d> centers;
+  std::vector<std::size_t> weights;
+  for (std::size_t i = 0; i < worldNode; ++i)
+  {
+    if (global[i])
+      continue;
+    auto inserted = setGroups.emplace(findSet(parents, i), centers.size());
+    if (inserted.second)
+    {
+      centers.emplace_back();
+      weights.push_back(0);
+    }
+    const std::size_t group = inserted.first->second;
+    nodeGroups[i] = group;
+    if (i < modelCount)
+    {
+      centers[group] += data.modelPoses[i].Pos();
+      ++weights[group];
+    }
+  }
+  for (std::size_t i = 0; i < centers.size(); ++i)
+  {
+    if (weights[i] > 0)
+      centers[i] /= static_cast<double>(weights[i]);
+  }
+
+  std::vector<std::size_t> groupShards(centers.size(), 0);
+  std::vector<std::size_t> groups(centers.size());
+  for (std::size_t i = 0; i < groups.size(); ++i)
+    groups[i] = i;
+  if (_strategy == PartitionStrategy::SPATIAL)
+  {
+    splitSpatial(groups, 0, groups.size(), 0, shardCount, centers, weights,
+        groupShards);
+  }
+  else
+  {
+    // The largest groups first, each to the shard with the fewest models.
+    std::stable_sort(groups.begin(), groups.end(),
+        [&](std::size_t _a, std::size_t _b)
+        {
+          return weights[_a] > weights[_b];
+        });
+    using Load = std::pair<std::size_t, std::size_t>;
+    std::priority_queue<Load, std::vector<Load>, std::greater<Load>> loads;
+    for (std::size_t i = 0; i < shardCount; ++i)
+      loads.push({0u, i});
+    for (std::size_t group : groups)
+    {
+      Load load = loads.top();
+      loads.pop();
+      groupShards[group] = load.second;
+      load.first += weights[group];
+      loads.push(load);
+    }
+  }
+
+  auto shardOf = [&](std::size_t _node)
+  {
+    return _node < worldNode && !global[_node] ?
+        groupShards[nodeGroups[_node]] : kAllShards;
+  };
+  data.modelShards.resize(modelCount);
+  data.modelTargets.resize(modelCount);
+  for (std::size_t i = 0; i < modelCount; ++i)
+  {
+    data.modelShards[i] = shardOf(i);
+    data.shardModels[data.modelShards[i]].push_back(i);
+    data.modelTargets[i] = shardOf(relativeTo[i]);
+    if (data.modelTargets[i] != kAllShards &&
+        data.modelTargets[i] != data.modelShards[i])
+    {
+      const Model *model = _world.ModelByIndex(i);
+      data.dependencies.push_back({model->Name(), data.modelShards[i],
+          model->PoseRelativeTo(), data.modelTargets[i]});
+    }
+  }
+  data.frameShards.resize(frameCount);
+  data.frameTargets.resize(frameCount);
+  for (std::size_t i = 0; i < frameCount; ++i)
+  {
+    data.frameShards[i] = shardOf(modelCount + i);
+    data.frameTargets[i] = shardOf(relativeTo[modelCount + i]);
+    if (data.frameTargets[i] != kAllShards &&
+        data.frameTargets[i] != data.frameShards[i])
+    {
+      const Frame *frame = _world.FrameByIndex(i);
+      data.dependencies.push_back({frame->Name(), data.frameShards[i],
+          frame->PoseRelativeTo(), data.frameTargets[i]});
+    }
+  }
+
+  if (worldElem)
+  {
+    for (ElementPtr child = worldElem->GetFirstElement(); child;
+         child = child->GetNextElement())
+    {
+      if (child->GetName() != "model" && child->GetName() != "frame")
+        data.otherElements.push_back(child);
+    }
+  }
+  return errors;
+}
+
+/////////////////////////////////////////////////
+std::size_t WorldPartition::ShardCount() const
+{
+  return this->dataPtr->shardModels.size();
+}
+
+/////////////////////////////////////////////////
+const std::vector<std::size_t> &WorldPartition::ShardModels(
+    std::size_t _shard) const
+{
+  static const std::vector<std::size_t> empty;
+  return _shard < this->dataPtr->shardModels.size() ?
+      this->dataPtr->shardModels[_shard] : empty;
+}
+
+/////////////////////////////////////////////////
+std::size_t WorldPartition::ModelShard(std::size_t _model) const
+{
+  return _model < this->dataPtr->modelShards.size() ?
+      this->dataPtr->modelShards[_model] : kAllShards;
+}
+
+/////////////////////////////////////////////////
+std::size_t WorldPartition::FrameShard(std::size_t _frame) const
+{
+  return _frame < this->dataPtr->frameShards.size() ?
+      this->dataPtr->frameShards[_frame] : kAllShards;
+}
+
+/////////////////////////////////////////////////
+const std::vector<ShardDependency> &WorldPartition::Dependencies() const
+{
+  return this->dataPtr->dependencies;
+}
+
+/////////////////////////////////////////////////
+bool WorldPartition::WriteShard(std::size_t _shard, std::ostream &_out,
+    bool _compact) const
+{
+  const WorldPartitionPrivate &data = *this->dataPtr;
+  if (_shard >= data.shardModels.size())
+    return false;
+
+  const char *newline = _compact ? "" : "\n";
+  const std::size_t indent = _compact ? 0 : 4;
+
+  // Poses relative to a frame of another shard are written relative to
+  // the world frame, on a copy of the element.
+  auto write = [&](const ElementPtr &_elem, std::size_t _target,
+      const ignition::math::Pose3d &_pose)
+  {
+    if (!_elem)
+      return;
+    if (_target == kAllShards || _target == _shard)
+    {
+      _elem->ToStream(_out, indent, _compact);
+      return;
+    }
+    ElementPtr copy = _elem->Clone();
+    ElementPtr pose = copy->GetElement("pose");
+    pose->Set(_pose);
+    pose->GetAttribute("relative_to")->SetFromString("world");
+    if (ParamPtr placementFrame = copy->GetAttribute("placement_frame"))
+      placementFrame->Reset();
+    copy->ToStream(_out, indent, _compact);
+  };
+
+  _out << "<?xml version='1.0'?>" << newline
+       << "<sdf version='" << SDF::Version() << "'>" << newline
+       << (_compact ? "" : "  ") << "<world name='" << data.worldName << "'>"
+       << newline;
+  for (const ElementPtr &elem : data.otherElements)
+    elem->ToStream(_out, indent, _compact);
+  for (std::size_t model : data.shardModels[_shard])
+  {
+    write(data.modelElements[model], data.modelTargets[model],
+        data.modelPoses[model]);
+  }
+  for (std::size_t i = 0; i < data.frameShards.size(); ++i)
+  {
+    if (data.frameShards[i] == kAllShards || data.frameShards[i] == _shard)
+      write(data.frameElements[i], data.frameTargets[i], data.framePoses[i]);
+  }
+  _out << (_compact ? "" : "  ") << "</world>" << newline
+       << "</sdf>" << newline;
+  return true;
+}
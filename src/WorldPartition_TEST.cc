@@ -0,0 +1,167 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <ignition/math/Pose3.hh>
+#include "sdf/Frame.hh"
+#include "sdf/Model.hh"
+#include "sdf/Root.hh"
+#include "sdf/World.hh"
+#include "sdf/WorldPartition.hh"
+
+/////////////////////////////////////////////////
+const std::string kWorld = R"(
+<sdf version="1.8">
+  <world name="default">
+    <light name="sun" type="directional"/>
+    <frame name="origin"/>
+    <model name="a">
+      <link name="l"/>
+    </model>
+    <model name="b">
+      <pose>1 0 0 0 0 0</pose>
+      <link name="l"/>
+    </model>
+    <model name="c">
+      <pose>10 0 0 0 0 0</pose>
+      <link name="l"/>
+    </model>
+    <model name="d">
+      <pose>11 0 0 0 0 0</pose>
+      <link name="l"/>
+    </model>
+    <model name="e">
+      <pose relative_to="a">20 0 0 0 0 0</pose>
+      <link name="l"/>
+    </model>
+    <frame name="beside_c" attached_to="c">
+      <pose>0 1 0 0 0 0</pose>
+    </frame>
+  </world>
+</sdf>)";
+
+/////////////////////////////////////////////////
+TEST(DOMWorldPartition, Construction)
+{
+  sdf::WorldPartition partition;
+  EXPECT_EQ(0u, partition.ShardCount());
+  EXPECT_TRUE(partition.ShardModels(0).empty());
+  EXPECT_EQ(sdf::WorldPartition::kAllShards, partition.ModelShard(0));
+  EXPECT_TRUE(partition.Dependencies().empty());
+
+  std::ostringstream stream;
+  EXPECT_FALSE(partition.WriteShard(0, stream));
+  EXPECT_TRUE(stream.str().empty());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMWorldPartition, Spatial)
+{
+  sdf::Root root;
+  ASSERT_TRUE(root.LoadSdfString(kWorld).empty());
+  const sdf::World *world = root.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+
+  sdf::WorldPartition partition;
+  EXPECT_TRUE(partition.Build(*world, 2).empty());
+  ASSERT_EQ(2u, partition.ShardCount());
+  EXPECT_EQ(std::vector<std::size_t>({0, 1}), partition.ShardModels(0));
+  EXPECT_EQ(std::vector<std::size_t>({2, 3, 4}), partition.ShardModels(1));
+
+  // The frame attached to the world is in every shard, and the other one
+  // follows its model.
+  EXPECT_EQ(sdf::WorldPartition::kAllShards, partition.FrameShard(0));
+  EXPECT_EQ(1u, partition.FrameShard(1));
+
+  ASSERT_EQ(1u, partition.Dependencies().size());
+  const sdf::ShardDependency &dependency = partition.Dependencies()[0];
+  EXPECT_EQ("e", dependency.entity);
+  EXPECT_EQ(1u, dependency.entityShard);
+  EXPECT_EQ("a", dependency.frame);
+  EXPECT_EQ(0u, dependency.frameShard);
+
+  // The shard loads on its own, with e posed relative to the world.
+  std::ostringstream stream;
+  EXPECT_TRUE(partition.WriteShard(1, stream));
+  sdf::Root shardRoot;
+  EXPECT_TRUE(shardRoot.LoadSdfString(stream.str()).empty())
+      << stream.str();
+  const sdf::World *shard = shardRoot.WorldByIndex(0);
+  ASSERT_NE(nullptr, shard);
+  EXPECT_EQ("default", shard->Name());
+  EXPECT_EQ(3u, shard->ModelCount());
+  EXPECT_FALSE(shard->ModelNameExists("a"));
+  EXPECT_EQ(2u, shard->FrameCount());
+  EXPECT_EQ(1u, shard->LightCount());
+
+  const sdf::Model *e = shard->ModelByName("e");
+  ASSERT_NE(nullptr, e);
+  EXPECT_EQ("world", e->PoseRelativeTo());
+  ignition::math::Pose3d pose;
+  EXPECT_TRUE(e->SemanticPose().Resolve(pose, "world").empty());
+  EXPECT_EQ(ignition::math::Pose3d(20, 0, 0, 0, 0, 0), pose);
+
+  // The loaded world is left as it was.
+  EXPECT_EQ("a", world->ModelByName("e")->Element()->GetElement("pose")
+      ->GetAttribute("relative_to")->GetAsString());
+
+  std::ostringstream compact;
+  EXPECT_TRUE(partition.WriteShard(0, compact, true));
+  EXPECT_EQ(std::string::npos, compact.str().find('\n'));
+  sdf::Root compactRoot;
+  EXPECT_TRUE(compactRoot.LoadSdfString(compact.str()).empty());
+  ASSERT_NE(nullptr, compactRoot.WorldByIndex(0));
+  EXPECT_EQ(2u, compactRoot.WorldByIndex(0)->ModelCount());
+  EXPECT_EQ(1u, compactRoot.WorldByIndex(0)->FrameCount());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMWorldPartition, Connectivity)
+{
+  sdf::Root root;
+  ASSERT_TRUE(root.LoadSdfString(kWorld).empty());
+  const sdf::World *world = root.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+
+  // e stays with a, and the groups are balanced by their number of models.
+  sdf::WorldPartition partition;
+  EXPECT_TRUE(partition.Build(*world, 2,
+      sdf::PartitionStrategy::CONNECTIVITY).empty());
+  ASSERT_EQ(2u, partition.ShardCount());
+  EXPECT_EQ(std::vector<std::size_t>({0, 3, 4}), partition.ShardModels(0));
+  EXPECT_EQ(std::vector<std::size_t>({1, 2}), partition.ShardModels(1));
+  EXPECT_EQ(1u, partition.FrameShard(1));
+  EXPECT_TRUE(partition.Dependencies().empty());
+
+  // More shards than groups leaves shards empty.
+  sdf::WorldPartition many(partition);
+  EXPECT_TRUE(many.Build(*world, 8,
+      sdf::PartitionStrategy::CONNECTIVITY).empty());
+  EXPECT_EQ(8u, many.ShardCount());
+  EXPECT_TRUE(many.ShardModels(7).empty());
+  EXPECT_EQ(2u, partition.ShardCount());
+
+  std::ostringstream stream;
+  EXPECT_TRUE(many.WriteShard(7, stream));
+  sdf::Root emptyRoot;
+  EXPECT_TRUE(emptyRoot.LoadSdfString(stream.str()).empty());
+  ASSERT_NE(nullptr, emptyRoot.WorldByIndex(0));
+  EXPECT_EQ(0u, emptyRoot.WorldByIndex(0)->ModelCount());
+}
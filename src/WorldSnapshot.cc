@@ -0,0 +1,766 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "sdf/WorldSnapshot.hh"
+#include "MappedFile.hh"
+
+using namespace sdf;
+
+namespace
+{
+  /// \brief First bytes of every world snapshot.
+  const char kMagic[8] = {'S', 'D', 'F', 'W', 'O', 'R', 'L', 'D'};
+
+  /// \brief Version of the world snapshot format. It must be incremented
+  /// whenever the layout of the header or of an array changes.
+  const std::uint32_t kFormatVersion = 1;
+
+  /// \brief Marker written in the byte order of the writer.
+  const std::uint32_t kByteOrder = 0x01020304;
+
+  /// \brief Alignment of the arrays, relative to the start of the snapshot.
+  const std::size_t kArrayAlignment = 64;
+
+  /// \brief Arrays of a snapshot, in the order they are laid out.
+  enum Section : std::size_t
+  {
+    kEntityTypes,
+    kEntityParents,
+    kEntityPoses,
+    kNameOffsets,
+    kNameChars,
+    kNameIndex,
+    kLinkEntities,
+    kLinkInertials,
+    kJointEntities,
+    kJointTypes,
+    kJointParentLinks,
+    kJointChildLinks,
+    kJointAxes,
+    kJointLowerLimits,
+    kJointUpperLimits,
+    kJointEffortLimits,
+    kJointVelocityLimits,
+    kCollisionEntities,
+    kCollisionLinks,
+    kCollisionShapes,
+    kCollisionShapeSizes,
+    kCollisionBounds,
+    kVisualEntities,
+    kVisualBounds,
+    kSectionCount
+  };
+
+  /// \brief Header at the start of every snapshot.
+  struct SnapshotHeader
+  {
+    /// \brief kMagic.
+    char magic[sizeof(kMagic)];
+
+    /// \brief kFormatVersion.
+    std::uint32_t formatVersion;
+
+    /// \brief kByteOrder.
+    std::uint32_t byteOrder;
+
+    /// \brief Size of the snapshot in bytes.
+    std::uint64_t size;
+
+    /// \brief Number of entities.
+    std::uint64_t entityCount;
+
+    /// \brief Number of links.
+    std::uint64_t linkCount;
+
+    /// \brief Number of joints.
+    std::uint64_t jointCount;
+
+    /// \brief Number of collisions.
+    std::uint64_t collisionCount;
+
+    /// \brief Number of visuals.
+    std::uint64_t visualCount;
+
+    /// \brief Number of bytes of the names, with their null terminators.
+    std::uint64_t nameBytes;
+
+    /// \brief Offset of each array from the start of the snapshot.
+    std::uint64_t offsets[kSectionCount];
+  };
+
+  static_assert(std::is_standard_layout_v<SnapshotHeader>,
+      "The snapshot header must have a fixed layout");
+  static_assert(sizeof(SnapshotPose) == 7 * sizeof(double),
+      "SnapshotPose must not be padded");
+  static_assert(sizeof(SnapshotInertial) == 14 * sizeof(double),
+      "SnapshotInertial must not be padded");
+  static_assert(sizeof(SnapshotBox) == 6 * sizeof(double),
+      "SnapshotBox must not be padded");
+
+  /////////////////////////////////////////////////
+  /// \brief Get the number of bytes of each array of a snapshot.
+  /// \param[in] _header Header with the counts of the snapshot.
+  /// \param[out] _bytes Number of bytes of each array.
+  void sectionBytes(const SnapshotHeader &_header,
+      std::uint64_t (&_bytes)[kSectionCount])
+  {
+    const std::uint64_t entities = _header.entityCount;
+    const std::uint64_t links = _header.linkCount;
+    const std::uint64_t joints = _header.jointCount;
+    const std::uint64_t axes = joints * WorldExport::kAxesPerJoint;
+    const std::uint64_t collisions = _header.collisionCount;
+    const std::uint64_t visuals = _header.visualCount;
+    const std::uint64_t index = sizeof(std::uint64_t);
+
+    _bytes[kEntityTypes] = entities * sizeof(ExportEntityType);
+    _bytes[kEntityParents] = entities * index;
+    _bytes[kEntityPoses] = entities * sizeof(SnapshotPose);
+    _bytes[kNameOffsets] = (entities + 1) * index;
+    _bytes[kNameChars] = _header.nameBytes;
+    _bytes[kNameIndex] = entities * index;
+    _bytes[kLinkEntities] = links * index;
+    _bytes[kLinkInertials] = links * sizeof(SnapshotInertial);
+    _bytes[kJointEntities] = joints * index;
+    _bytes[kJointTypes] = joints * sizeof(std::uint8_t);
+    _bytes[kJointParentLinks] = joints * index;
+    _bytes[kJointChildLinks] = joints * index;
+    _bytes[kJointAxes] = axes * sizeof(SnapshotVector3);
+    _bytes[kJointLowerLimits] = axes * sizeof(double);
+    _bytes[kJointUpperLimits] = axes * sizeof(double);
+    _bytes[kJointEffortLimits] = axes * sizeof(double);
+    _bytes[kJointVelocityLimits] = axes * sizeof(double);
+    _bytes[kCollisionEntities] = collisions * index;
+    _bytes[kCollisionLinks] = collisions * index;
+    _bytes[kCollisionShapes] = collisions * sizeof(std::uint8_t);
+    _bytes[kCollisionShapeSizes] = collisions * sizeof(SnapshotVector3);
+    _bytes[kCollisionBounds] = collisions * sizeof(SnapshotBox);
+    _bytes[kVisualEntities] = visuals * index;
+    _bytes[kVisualBounds] = visuals * sizeof(SnapshotBox);
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief Round a size up to kArrayAlignment.
+  /// \param[in] _size Size in bytes.
+  /// \return The aligned size.
+  std::uint64_t alignArray(std::uint64_t _size)
+  {
+    return (_size + kArrayAlignment - 1) / kArrayAlignment * kArrayAlignment;
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief Fill the counts and offsets of the header of a world.
+  /// \param[in] _export Exported world.
+  /// \param[out] _header Header to fill.
+  void layOut(const WorldExport &_export, SnapshotHeader &_header)
+  {
+    std::memset(&_header, 0, sizeof(_header));
+    std::memcpy(_header.magic, kMagic, sizeof(kMagic));
+    _header.formatVersion = kFormatVersion;
+    _header.byteOrder = kByteOrder;
+    _header.entityCount = _export.EntityCount();
+    _header.linkCount = _export.LinkCount();
+    _header.jointCount = _export.JointCount();
+    _header.collisionCount = _export.CollisionCount();
+    _header.visualCount = _export.VisualCount();
+    for (std::size_t i = 0; i < _export.EntityCount(); ++i)
+      _header.nameBytes += _export.EntityName(i).size() + 1;
+
+    std::uint64_t bytes[kSectionCount];
+    sectionBytes(_header, bytes);
+    std::uint64_t end = sizeof(SnapshotHeader);
+    for (std::size_t s = 0; s < kSectionCount; ++s)
+    {
+      _header.offsets[s] = alignArray(end);
+      end = _header.offsets[s] + bytes[s];
+    }
+    _header.size = end;
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief Convert an index of a WorldExport.
+  /// \param[in] _index Index, or WorldExport::kInvalidIndex.
+  /// \return The index, or WorldSnapshot::kInvalidIndex.
+  std::uint64_t toIndex(std::size_t _index)
+  {
+    return _index == WorldExport::kInvalidIndex ?
+        WorldSnapshot::kInvalidIndex : static_cast<std::uint64_t>(_index);
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief Convert a vector.
+  /// \param[in] _v Vector.
+  /// \return The stored vector.
+  SnapshotVector3 toVector(const ignition::math::Vector3d &_v)
+  {
+    return {_v.X(), _v.Y(), _v.Z()};
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief Convert a pose.
+  /// \param[in] _pose Pose.
+  /// \return The stored pose.
+  SnapshotPose toPose(const ignition::math::Pose3d &_pose)
+  {
+    return {toVector(_pose.Pos()), _pose.Rot().W(), _pose.Rot().X(),
+        _pose.Rot().Y(), _pose.Rot().Z()};
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief Convert a box.
+  /// \param[in] _box Box.
+  /// \return The stored box.
+  SnapshotBox toBox(const ignition::math::AxisAlignedBox &_box)
+  {
+    return {toVector(_box.Min()), toVector(_box.Max())};
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief Convert an inertial.
+  /// \param[in] _inertial Inertial.
+  /// \return The stored inertial.
+  SnapshotInertial toInertial(const ignition::math::Inertiald &_inertial)
+  {
+    const ignition::math::MassMatrix3d &m = _inertial.MassMatrix();
+    const ignition::math::Vector3d diagonal = m.DiagonalMoments();
+    const ignition::math::Vector3d offDiagonal = m.OffDiagonalMoments();
+    return {m.Mass(), toPose(_inertial.Pose()),
+        {diagonal.X(), diagonal.Y(), diagonal.Z(),
+         offDiagonal.X(), offDiagonal.Y(), offDiagonal.Z()}};
+  }
+
+  /// \brief Writer of the arrays of a snapshot.
+  class ArrayWriter
+  {
+    /// \brief Constructor.
+    /// \param[out] _base Start of the snapshot.
+    /// \param[in] _header Header of the snapshot.
+    public: ArrayWriter(unsigned char *_base, const SnapshotHeader &_header)
+      : base(_base), header(_header)
+    {
+    }
+
+    /// \brief Write a value of an array.
+    /// \param[in] _section Array.
+    /// \param[in] _index Index of the value in the array.
+    /// \param[in] _value The value.
+    public: template<typename T>
+    void Put(Section _section, std::size_t _index, const T &_value)
+    {
+      static_assert(std::is_trivially_copyable_v<T>,
+          "Snapshot values must be trivially copyable");
+      std::memcpy(this->base + this->header.offsets[_section] +
+          _index * sizeof(T), &_value, sizeof(T));
+    }
+
+    /// \brief Start of the snapshot.
+    public: unsigned char *base;
+
+    /// \brief Header of the snapshot.
+    public: const SnapshotHeader &header;
+  };
+}
+
+/// \brief Private data for WorldSnapshot.
+class sdf::WorldSnapshotPrivate
+{
+  /// \brief View a snapshot, after checking its header and its name table.
+  /// \param[in] _data Start of the snapshot.
+  /// \param[in] _size Size of the memory.
+  /// \return Errors, in which case the view is left empty.
+  public: Errors View(const void *_data, std::size_t _size);
+
+  /// \brief Get an array of the snapshot.
+  /// \param[in] _section Array.
+  /// \return Pointer to the array, or nullptr if the view is empty.
+  public: template<typename T>
+  const T *Array(Section _section) const
+  {
+    if (!this->header)
+      return nullptr;
+    return reinterpret_cast<const T *>(
+        this->data + this->header->offsets[_section]);
+  }
+
+  /// \brief Mapped file of the snapshot, when it was opened from a file.
+  public: MappedFile file;
+
+  /// \brief Start of the snapshot.
+  public: const unsigned char *data = nullptr;
+
+  /// \brief Header of the snapshot, or nullptr if the view is empty.
+  public: const SnapshotHeader *header = nullptr;
+};
+
+/////////////////////////////////////////////////
+Errors WorldSnapshotPrivate::View(const void *_data, std::size_t _size)
+{
+  this->data = nullptr;
+  this->header = nullptr;
+
+  if (!_data || _size < sizeof(SnapshotHeader) ||
+      std::memcmp(_data, kMagic, sizeof(kMagic)) != 0)
+  {
+    return {{ErrorCode::FILE_READ,
+        "Data is not an SDFormat world snapshot."}};
+  }
+  if (reinterpret_cast<std::uintptr_t>(_data) % alignof(std::uint64_t) != 0)
+  {
+    return {{ErrorCode::FILE_READ,
+        "World snapshot is not aligned to 8 bytes."}};
+  }
+
+  const auto *head = static_cast<const SnapshotHeader *>(_data);
+  if (head->formatVersion != kFormatVersion)
+  {
+    return {{ErrorCode::FILE_READ,
+        "World snapshot format version [" +
+        std::to_string(head->formatVersion) +
+        "] is not supported, expected version [" +
+        std::to_string(kFormatVersion) + "]."}};
+  }
+  if (head->byteOrder != kByteOrder)
+  {
+    return {{ErrorCode::FILE_READ,
+        "World snapshot was written with a different byte order."}};
+  }
+  if (head->size > _size)
+  {
+    return {{ErrorCode::FILE_READ, "World snapshot is truncated."}};
+  }
+
+  // Every count is bounded by the size, so the array sizes don't overflow.
+  const Errors layoutErrors = {{ErrorCode::FILE_READ,
+      "World snapshot has an invalid layout."}};
+  if (head->entityCount > head->size || head->linkCount > head->size ||
+      head->jointCount > head->size || head->collisionCount > head->size ||
+      head->visualCount > head->size || head->nameBytes > head->size)
+  {
+    return layoutErrors;
+  }
+  std::uint64_t bytes[kSectionCount];
+  sectionBytes(*head, bytes);
+  for (std::size_t s = 0; s < kSectionCount; ++s)
+  {
+    const std::uint64_t offset = head->offsets[s];
+    if (offset < sizeof(SnapshotHeader) || offset % kArrayAlignment != 0 ||
+        offset > head->size || bytes[s] > head->size - offset)
+    {
+      return layoutErrors;
+    }
+  }
+
+  // Names are read in place, so their bounds are checked once here.
+  const auto *base = static_cast<const unsigned char *>(_data);
+  const auto *offsets = reinterpret_cast<const std::uint64_t *>(
+      base + head->offsets[kNameOffsets]);
+  const auto *chars = reinterpret_cast<const char *>(
+      base + head->offsets[kNameChars]);
+  bool namesValid = offsets[0] == 0 &&
+      offsets[head->entityCount] == head->nameBytes;
+  for (std::uint64_t i = 0; namesValid && i < head->entityCount; ++i)
+  {
+    namesValid = offsets[i] < offsets[i + 1] &&
+        offsets[i + 1] <= head->nameBytes && chars[offsets[i + 1] - 1] == '\0';
+  }
+  if (!namesValid)
+  {
+    return {{ErrorCode::FILE_READ,
+        "World snapshot has an invalid name table."}};
+  }
+
+  this->data = base;
+  this->header = head;
+  return {};
+}
+
+/////////////////////////////////////////////////
+WorldSnapshot::WorldSnapshot()
+  : dataPtr(new WorldSnapshotPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+WorldSnapshot::WorldSnapshot(WorldSnapshot &&_snapshot) noexcept
+  : dataPtr(std::exchange(_snapshot.dataPtr, nullptr))
+{
+}
+
+/////////////////////////////////////////////////
+WorldSnapshot &WorldSnapshot::operator=(WorldSnapshot &&_snapshot) noexcept
+{
+  std::swap(this->dataPtr, _snapshot.dataPtr);
+  return *this;
+}
+
+/////////////////////////////////////////////////
+WorldSnapshot::~WorldSnapshot()
+{
+  delete this->dataPtr;
+  this->dataPtr = nullptr;
+}
+
+/////////////////////////////////////////////////
+std::size_t WorldSnapshot::WriteSize(const WorldExport &_export)
+{
+  SnapshotHeader header;
+  layOut(_export, header);
+  return header.size;
+}
+
+/////////////////////////////////////////////////
+Errors WorldSnapshot::Write(const WorldExport &_export, void *_buffer,
+    std::size_t _size)
+{
+  SnapshotHeader header;
+  layOut(_export, header);
+  if (!_buffer || _size < header.size)
+  {
+    return {{ErrorCode::FILE_READ, "World snapshot needs [" +
+        std::to_string(header.size) + "] bytes, but the buffer has [" +
+        std::to_string(_size) + "]."}};
+  }
+
+  // The padding between the arrays is zeroed, so that equal worlds give
+  // equal snapshots.
+  auto *base = static_cast<unsigned char *>(_buffer);
+  std::memset(base, 0, header.size);
+  std::memcpy(base, &header, sizeof(header));
+  ArrayWriter out(base, header);
+
+  const std::size_t entityCount = _export.EntityCount();
+  std::uint64_t nameOffset = 0;
+  for (std::size_t i = 0; i < entityCount; ++i)
+  {
+    out.Put(kEntityTypes, i, _export.EntityTypes()[i]);
+    out.Put(kEntityParents, i, toIndex(_export.EntityParents()[i]));
+    out.Put(kEntityPoses, i, toPose(_export.EntityPoses()[i]));
+    out.Put(kNameOffsets, i, nameOffset);
+    const std::string &name = _export.EntityName(i);
+    std::memcpy(base + header.offsets[kNameChars] + nameOffset,
+        name.c_str(), name.size() + 1);
+    nameOffset += name.size() + 1;
+  }
+  out.Put(kNameOffsets, entityCount, nameOffset);
+
+  std::vector<std::uint64_t> order(entityCount);
+  std::iota(order.begin(), order.end(), 0u);
+  std::sort(order.begin(), order.end(),
+      [&_export](std::uint64_t _a, std::uint64_t _b)
+      {
+        return _export.EntityName(_a) < _export.EntityName(_b);
+      });
+  for (std::size_t i = 0; i < entityCount; ++i)
+    out.Put(kNameIndex, i, order[i]);
+
+  for (std::size_t i = 0; i < _export.LinkCount(); ++i)
+  {
+    out.Put(kLinkEntities, i, toIndex(_export.LinkEntities()[i]));
+    out.Put(kLinkInertials, i, toInertial(_export.LinkInertials()[i]));
+  }
+
+  for (std::size_t i = 0; i < _export.JointCount(); ++i)
+  {
+    out.Put(kJointEntities, i, toIndex(_export.JointEntities()[i]));
+    out.Put(kJointTypes, i,
+        static_cast<std::uint8_t>(_export.JointTypes()[i]));
+    out.Put(kJointParentLinks, i, toIndex(_export.JointParentLinks()[i]));
+    out.Put(kJointChildLinks, i, toIndex(_export.JointChildLinks()[i]));
+  }
+  for (std::size_t i = 0;
+       i < _export.JointCount() * WorldExport::kAxesPerJoint; ++i)
+  {
+    out.Put(kJointAxes, i, toVector(_export.JointAxes()[i]));
+    out.Put(kJointLowerLimits, i, _export.JointLowerLimits()[i]);
+    out.Put(kJointUpperLimits, i, _export.JointUpperLimits()[i]);
+    out.Put(kJointEffortLimits, i, _export.JointEffortLimits()[i]);
+    out.Put(kJointVelocityLimits, i, _export.JointVelocityLimits()[i]);
+  }
+
+  for (std::size_t i = 0; i < _export.CollisionCount(); ++i)
+  {
+    out.Put(kCollisionEntities, i, toIndex(_export.CollisionEntities()[i]));
+    out.Put(kCollisionLinks, i, toIndex(_export.CollisionLinks()[i]));
+    out.Put(kCollisionShapes, i,
+        static_cast<std::uint8_t>(_export.CollisionShapes()[i]));
+    out.Put(kCollisionShapeSizes, i,
+        toVector(_export.CollisionShapeSizes()[i]));
+    out.Put(kCollisionBounds, i, toBox(_export.CollisionBounds()[i]));
+  }
+
+  for (std::size_t i = 0; i < _export.VisualCount(); ++i)
+  {
+    out.Put(kVisualEntities, i, toIndex(_export.VisualEntities()[i]));
+    out.Put(kVisualBounds, i, toBox(_export.VisualBounds()[i]));
+  }
+  return {};
+}
+
+/////////////////////////////////////////////////
+Errors WorldSnapshot::Write(const WorldExport &_export,
+    const std::string &_filename)
+{
+  std::vector<unsigned char> buffer(WriteSize(_export));
+  Errors errors = Write(_export, buffer.data(), buffer.size());
+  if (!errors.empty())
+    return errors;
+
+  std::ofstream out(_filename, std::ios::out | std::ios::binary);
+  if (!out)
+  {
+    errors.push_back({ErrorCode::FILE_READ,
+        "Unable to open file[" + _filename + "] for writing."});
+    return errors;
+  }
+  out.write(reinterpret_cast<const char *>(buffer.data()),
+      static_cast<std::streamsize>(buffer.size()));
+  out.close();
+  if (out.fail())
+  {
+    errors.push_back({ErrorCode::FILE_READ,
+        "Unable to write world snapshot [" + _filename + "]."});
+  }
+  return errors;
+}
+
+/////////////////////////////////////////////////
+Errors WorldSnapshot::Open(const void *_data, std::size_t _size)
+{
+  this->dataPtr->file.Close();
+  return this->dataPtr->View(_data, _size);
+}
+
+/////////////////////////////////////////////////
+Errors WorldSnapshot::Open(const std::string &_filename)
+{
+  this->dataPtr->file.Close();
+  if (!this->dataPtr->file.Open(_filename))
+  {
+    this->dataPtr->View(nullptr, 0);
+    return {{ErrorCode::FILE_READ,
+        "Unable to read world snapshot [" + _filename + "]."}};
+  }
+  Errors errors = this->dataPtr->View(this->dataPtr->file.Data(),
+      this->dataPtr->file.Size());
+  if (!errors.empty())
+    this->dataPtr->file.Close();
+  return errors;
+}
+
+/////////////////////////////////////////////////
+const void *WorldSnapshot::Data() const
+{
+  return this->dataPtr->data;
+}
+
+/////////////////////////////////////////////////
+std::size_t WorldSnapshot::Size() const
+{
+  return this->dataPtr->header ? this->dataPtr->header->size : 0u;
+}
+
+/////////////////////////////////////////////////
+std::size_t WorldSnapshot::EntityCount() const
+{
+  return this->dataPtr->header ? this->dataPtr->header->entityCount : 0u;
+}
+
+/////////////////////////////////////////////////
+const ExportEntityType *WorldSnapshot::EntityTypes() const
+{
+  return this->dataPtr->Array<ExportEntityType>(kEntityTypes);
+}
+
+/////////////////////////////////////////////////
+const std::uint64_t *WorldSnapshot::EntityParents() const
+{
+  return this->dataPtr->Array<std::uint64_t>(kEntityParents);
+}
+
+/////////////////////////////////////////////////
+const SnapshotPose *WorldSnapshot::EntityPoses() const
+{
+  return this->dataPtr->Array<SnapshotPose>(kEntityPoses);
+}
+
+/////////////////////////////////////////////////
+std::string_view WorldSnapshot::EntityName(std::size_t _index) const
+{
+  if (_index >= this->EntityCount())
+    return {};
+  const std::uint64_t *offsets =
+      this->dataPtr->Array<std::uint64_t>(kNameOffsets);
+  return std::string_view(
+      this->dataPtr->Array<char>(kNameChars) + offsets[_index],
+      offsets[_index + 1] - offsets[_index] - 1);
+}
+
+/////////////////////////////////////////////////
+std::uint64_t WorldSnapshot::EntityByName(std::string_view _name) const
+{
+  const std::uint64_t *index = this->dataPtr->Array<std::uint64_t>(kNameIndex);
+  if (!index)
+    return kInvalidIndex;
+  const std::uint64_t *end = index + this->EntityCount();
+  const std::uint64_t *found = std::lower_bound(index, end, _name,
+      [this](std::uint64_t _entity, std::string_view _key)
+      {
+        return this->EntityName(_entity) < _key;
+      });
+  if (found == end || this->EntityName(*found) != _name)
+    return kInvalidIndex;
+  return *found;
+}
+
+/////////////////////////////////////////////////
+std::size_t WorldSnapshot::LinkCount() const
+{
+  return this->dataPtr->header ? this->dataPtr->header->linkCount : 0u;
+}
+
+/////////////////////////////////////////////////
+const std::uint64_t *WorldSnapshot::LinkEntities() const
+{
+  return this->dataPtr->Array<std::uint64_t>(kLinkEntities);
+}
+
+/////////////////////////////////////////////////
+const SnapshotInertial *WorldSnapshot::LinkInertials() const
+{
+  return this->dataPtr->Array<SnapshotInertial>(kLinkInertials);
+}
+
+/////////////////////////////////////////////////
+std::size_t WorldSnapshot::JointCount() const
+{
+  return this->dataPtr->header ? this->dataPtr->header->jointCount : 0u;
+}
+
+/////////////////////////////////////////////////
+const std::uint64_t *WorldSnapshot::JointEntities() const
+{
+  return this->dataPtr->Array<std::uint64_t>(kJointEntities);
+}
+
+/////////////////////////////////////////////////
+const std::uint8_t *WorldSnapshot::JointTypes() const
+{
+  return this->dataPtr->Array<std::uint8_t>(kJointTypes);
+}
+
+/////////////////////////////////////////////////
+const std::uint64_t *WorldSnapshot::JointParentLinks() const
+{
+  return this->dataPtr->Array<std::uint64_t>(kJointParentLinks);
+}
+
+/////////////////////////////////////////////////
+const std::uint64_t *WorldSnapshot::JointChildLinks() const
+{
+  return this->dataPtr->Array<std::uint64_t>(kJointChildLinks);
+}
+
+/////////////////////////////////////////////////
+const SnapshotVector3 *WorldSnapshot::JointAxes() const
+{
+  return this->dataPtr->Array<SnapshotVector3>(kJointAxes);
+}
+
+/////////////////////////////////////////////////
+const double *WorldSnapshot::JointLowerLimits() const
+{
+  return this->dataPtr->Array<double>(kJointLowerLimits);
+}
+
+/////////////////////////////////////////////////
+const double *WorldSnapshot::JointUpperLimits() const
+{
+  return this->dataPtr->Array<double>(kJointUpperLimits);
+}
+
+/////////////////////////////////////////////////
+const double *WorldSnapshot::JointEffortLimits() const
+{
+  return this->dataPtr->Array<double>(kJointEffortLimits);
+}
+
+/////////////////////////////////////////////////
+const double *WorldSnapshot::JointVelocityLimits() const
+{
+  return this->dataPtr->Array<double>(kJointVelocityLimits);
+}
+
+/////////////////////////////////////////////////
+std::size_t WorldSnapshot::CollisionCount() const
+{
+  return this->dataPtr->header ? this->dataPtr->header->collisionCount : 0u;
+}
+
+/////////////////////////////////////////////////
+const std::uint64_t *WorldSnapshot::CollisionEntities() const
+{
+  return this->dataPtr->Array<std::uint64_t>(kCollisionEntities);
+}
+
+/////////////////////////////////////////////////
+const std::uint64_t *WorldSnapshot::CollisionLinks() const
+{
+  return this->dataPtr->Array<std::uint64_t>(kCollisionLinks);
+}
+
+/////////////////////////////////////////////////
+const std::uint8_t *WorldSnapshot::CollisionShapes() const
+{
+  return this->dataPtr->Array<std::uint8_t>(kCollisionShapes);
+}
+
+/////////////////////////////////////////////////
+const SnapshotVector3 *WorldSnapshot::CollisionShapeSizes() const
+{
+  return this->dataPtr->Array<SnapshotVector3>(kCollisionShapeSizes);
+}
+
+/////////////////////////////////////////////////
+const SnapshotBox *WorldSnapshot::CollisionBounds() const
+{
+  return this->dataPtr->Array<SnapshotBox>(kCollisionBounds);
+}
+
+/////////////////////////////////////////////////
+std::size_t WorldSnapshot::VisualCount() const
+{
+  return this->dataPtr->header ? this->dataPtr->header->visualCount : 0u;
+}
+
+/////////////////////////////////////////////////
+const std::uint64_t *WorldSnapshot::VisualEntities() const
+{
+  return this->dataPtr->Array<std::uint64_t>(kVisualEntities);
+}
+
+/////////////////////////////////////////////////
+const SnapshotBox *WorldSnapshot::VisualBounds() const
+{
+  return this->dataPtr->Array<SnapshotBox>(kVisualBounds);
+}
@@ -0,0 +1,262 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "sdf/Filesystem.hh"
+#include "sdf/Joint.hh"
+#include "sdf/Root.hh"
+#include "sdf/World.hh"
+#include "sdf/WorldExport.hh"
+#include "sdf/WorldSnapshot.hh"
+
+/////////////////////////////////////////////////
+/// \brief Load a small world and export it.
+/// \param[out] _root Root to load the world into.
+/// \param[out] _export Export of the world.
+static void exportWorld(sdf::Root &_root, sdf::WorldExport &_export)
+{
+  const std::string sdfString = R"(
+  <sdf version="1.8">
+    <world name="default">
+      <model name="arm">
+        <pose>1 0 0 0 0 0</pose>
+        <link name="base">
+          <inertial>
+            <mass>2</mass>
+            <inertia><ixx>1</ixx><iyy>2</iyy><izz>2.5</izz><ixy>0.01</ixy>
+              <ixz>0.02</ixz><iyz>0.03</iyz></inertia>
+          </inertial>
+          <collision name="box">
+            <geometry><box><size>1 2 3</size></box></geometry>
+          </collision>
+          <visual name="visual">
+            <geometry><sphere><radius>1</radius></sphere></geometry>
+          </visual>
+        </link>
+        <link name="tool"/>
+        <joint name="hinge" type="revolute">
+          <parent>base</parent>
+          <child>tool</child>
+          <axis>
+            <xyz>0 0 1</xyz>
+            <limit><lower>-1</lower><upper>2</upper><effort>3</effort></limit>
+          </axis>
+        </joint>
+      </model>
+      <frame name="marker"><pose>0 5 0 0 0 0</pose></frame>
+    </world>
+  </sdf>)";
+  ASSERT_TRUE(_root.LoadSdfString(sdfString).empty());
+  ASSERT_TRUE(_export.Build(*_root.WorldByIndex(0)).empty());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMWorldSnapshot, Construction)
+{
+  sdf::WorldSnapshot snapshot;
+  EXPECT_EQ(nullptr, snapshot.Data());
+  EXPECT_EQ(0u, snapshot.Size());
+  EXPECT_EQ(0u, snapshot.EntityCount());
+  EXPECT_EQ(nullptr, snapshot.EntityTypes());
+  EXPECT_EQ(nullptr, snapshot.EntityPoses());
+  EXPECT_TRUE(snapshot.EntityName(0).empty());
+  EXPECT_EQ(sdf::WorldSnapshot::kInvalidIndex, snapshot.EntityByName("a"));
+  EXPECT_EQ(0u, snapshot.LinkCount());
+  EXPECT_EQ(0u, snapshot.JointCount());
+  EXPECT_EQ(0u, snapshot.CollisionCount());
+  EXPECT_EQ(0u, snapshot.VisualCount());
+
+  // An empty world still has a valid snapshot.
+  sdf::WorldExport worldExport;
+  std::vector<std::uint64_t> buffer(
+      sdf::WorldSnapshot::WriteSize(worldExport) / sizeof(std::uint64_t) + 1);
+  EXPECT_TRUE(sdf::WorldSnapshot::Write(worldExport, buffer.data(),
+      buffer.size() * sizeof(std::uint64_t)).empty());
+  EXPECT_TRUE(snapshot.Open(buffer.data(),
+      buffer.size() * sizeof(std::uint64_t)).empty());
+  EXPECT_EQ(buffer.data(), snapshot.Data());
+  EXPECT_EQ(0u, snapshot.EntityCount());
+
+  sdf::WorldSnapshot moved(std::move(snapshot));
+  EXPECT_EQ(buffer.data(), moved.Data());
+  sdf::WorldSnapshot moveAssigned;
+  moveAssigned = std::move(moved);
+  EXPECT_EQ(buffer.data(), moveAssigned.Data());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMWorldSnapshot, Memory)
+{
+  sdf::Root root;
+  sdf::WorldExport worldExport;
+  exportWorld(root, worldExport);
+
+  const std::size_t size = sdf::WorldSnapshot::WriteSize(worldExport);
+  std::vector<std::uint64_t> buffer(size / sizeof(std::uint64_t) + 1);
+  sdf::Errors errors = sdf::WorldSnapshot::Write(worldExport, buffer.data(),
+      size - 1);
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::FILE_READ, errors[0].Code());
+  ASSERT_TRUE(sdf::WorldSnapshot::Write(worldExport, buffer.data(),
+      size).empty());
+
+  // The snapshot has no pointers, so a copy at another address reads the
+  // same.
+  std::vector<std::uint64_t> copy(buffer);
+  sdf::WorldSnapshot snapshot;
+  ASSERT_TRUE(snapshot.Open(copy.data(), size).empty());
+  EXPECT_EQ(size, snapshot.Size());
+
+  // arm, base, visual, box, tool, hinge, marker
+  ASSERT_EQ(worldExport.EntityCount(), snapshot.EntityCount());
+  ASSERT_EQ(7u, snapshot.EntityCount());
+  for (std::size_t i = 0; i < snapshot.EntityCount(); ++i)
+  {
+    EXPECT_EQ(worldExport.EntityName(i), snapshot.EntityName(i));
+    EXPECT_EQ(worldExport.EntityTypes()[i], snapshot.EntityTypes()[i]);
+    EXPECT_EQ(i, snapshot.EntityByName(worldExport.EntityName(i)));
+    const ignition::math::Pose3d &pose = worldExport.EntityPoses()[i];
+    const sdf::SnapshotPose &stored = snapshot.EntityPoses()[i];
+    EXPECT_DOUBLE_EQ(pose.Pos().X(), stored.position.x);
+    EXPECT_DOUBLE_EQ(pose.Pos().Y(), stored.position.y);
+    EXPECT_DOUBLE_EQ(pose.Rot().W(), stored.qw);
+  }
+  EXPECT_EQ(sdf::WorldSnapshot::kInvalidIndex, snapshot.EntityParents()[0]);
+  EXPECT_EQ(0u, snapshot.EntityParents()[1]);
+  EXPECT_EQ(sdf::WorldSnapshot::kInvalidIndex, snapshot.EntityParents()[6]);
+  EXPECT_EQ("arm::base::visual", snapshot.EntityName(2));
+  EXPECT_EQ(sdf::WorldSnapshot::kInvalidIndex,
+      snapshot.EntityByName("arm::missing"));
+  EXPECT_DOUBLE_EQ(5.0, snapshot.EntityPoses()[6].position.y);
+
+  ASSERT_EQ(2u, snapshot.LinkCount());
+  EXPECT_EQ(1u, snapshot.LinkEntities()[0]);
+  EXPECT_DOUBLE_EQ(2.0, snapshot.LinkInertials()[0].mass);
+  EXPECT_DOUBLE_EQ(2.5, snapshot.LinkInertials()[0].inertia[2]);
+  EXPECT_DOUBLE_EQ(0.03, snapshot.LinkInertials()[0].inertia[5]);
+
+  ASSERT_EQ(1u, snapshot.JointCount());
+  EXPECT_EQ(5u, snapshot.JointEntities()[0]);
+  EXPECT_EQ(sdf::JointType::REVOLUTE,
+      static_cast<sdf::JointType>(snapshot.JointTypes()[0]));
+  EXPECT_EQ(0u, snapshot.JointParentLinks()[0]);
+  EXPECT_EQ(1u, snapshot.JointChildLinks()[0]);
+  EXPECT_DOUBLE_EQ(1.0, snapshot.JointAxes()[0].z);
+  EXPECT_DOUBLE_EQ(-1.0, snapshot.JointLowerLimits()[0]);
+  EXPECT_DOUBLE_EQ(2.0, snapshot.JointUpperLimits()[0]);
+  EXPECT_DOUBLE_EQ(3.0, snapshot.JointEffortLimits()[0]);
+  EXPECT_DOUBLE_EQ(worldExport.JointVelocityLimits()[0],
+      snapshot.JointVelocityLimits()[0]);
+
+  ASSERT_EQ(1u, snapshot.CollisionCount());
+  EXPECT_EQ(3u, snapshot.CollisionEntities()[0]);
+  EXPECT_EQ(0u, snapshot.CollisionLinks()[0]);
+  EXPECT_EQ(sdf::GeometryType::BOX,
+      static_cast<sdf::GeometryType>(snapshot.CollisionShapes()[0]));
+  EXPECT_DOUBLE_EQ(3.0, snapshot.CollisionShapeSizes()[0].z);
+  EXPECT_DOUBLE_EQ(0.5, snapshot.CollisionBounds()[0].min.x);
+  EXPECT_DOUBLE_EQ(1.5, snapshot.CollisionBounds()[0].max.x);
+
+  ASSERT_EQ(1u, snapshot.VisualCount());
+  EXPECT_EQ(2u, snapshot.VisualEntities()[0]);
+  EXPECT_DOUBLE_EQ(2.0, snapshot.VisualBounds()[0].max.x);
+
+  // Equal worlds give equal snapshots.
+  std::vector<std::uint64_t> again(buffer.size(), 1u);
+  ASSERT_TRUE(sdf::WorldSnapshot::Write(worldExport, again.data(),
+      size).empty());
+  EXPECT_EQ(0, std::memcmp(buffer.data(), again.data(), size));
+}
+
+/////////////////////////////////////////////////
+TEST(DOMWorldSnapshot, InvalidData)
+{
+  sdf::Root root;
+  sdf::WorldExport worldExport;
+  exportWorld(root, worldExport);
+  const std::size_t size = sdf::WorldSnapshot::WriteSize(worldExport);
+  std::vector<std::uint64_t> buffer(size / sizeof(std::uint64_t) + 1);
+  ASSERT_TRUE(sdf::WorldSnapshot::Write(worldExport, buffer.data(),
+      size).empty());
+  auto *bytes = reinterpret_cast<unsigned char *>(buffer.data());
+
+  sdf::WorldSnapshot snapshot;
+  sdf::Errors errors = snapshot.Open(nullptr, 0);
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::FILE_READ, errors[0].Code());
+
+  // Truncated
+  errors = snapshot.Open(buffer.data(), size - 1);
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_NE(std::string::npos, errors[0].Message().find("truncated"));
+  EXPECT_EQ(0u, snapshot.EntityCount());
+
+  // Misaligned
+  std::vector<std::uint64_t> shifted(buffer.size() + 1);
+  std::memcpy(reinterpret_cast<unsigned char *>(shifted.data()) + 1, bytes,
+      size);
+  errors = snapshot.Open(
+      reinterpret_cast<unsigned char *>(shifted.data()) + 1, size);
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_NE(std::string::npos, errors[0].Message().find("aligned"));
+
+  // Other format version
+  bytes[8] ^= 0xff;
+  errors = snapshot.Open(buffer.data(), size);
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_NE(std::string::npos, errors[0].Message().find("version"));
+  bytes[8] ^= 0xff;
+  EXPECT_TRUE(snapshot.Open(buffer.data(), size).empty());
+
+  // Not a snapshot
+  bytes[0] = 'X';
+  errors = snapshot.Open(buffer.data(), size);
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_NE(std::string::npos, errors[0].Message().find("not an SDFormat"));
+  EXPECT_EQ(nullptr, snapshot.Data());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMWorldSnapshot, File)
+{
+  sdf::Root root;
+  sdf::WorldExport worldExport;
+  exportWorld(root, worldExport);
+
+  const std::string path = sdf::filesystem::append(
+      sdf::filesystem::current_path(), "world_snapshot_test.bin");
+  ASSERT_TRUE(sdf::WorldSnapshot::Write(worldExport, path).empty());
+
+  sdf::WorldSnapshot snapshot;
+  ASSERT_TRUE(snapshot.Open(path).empty());
+  EXPECT_EQ(sdf::WorldSnapshot::WriteSize(worldExport), snapshot.Size());
+  ASSERT_EQ(7u, snapshot.EntityCount());
+  EXPECT_EQ(5u, snapshot.EntityByName("arm::hinge"));
+  EXPECT_EQ("marker", snapshot.EntityName(6));
+
+  sdf::Errors errors = snapshot.Open(path + ".missing");
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::FILE_READ, errors[0].Code());
+  EXPECT_EQ(0u, snapshot.EntityCount());
+
+  EXPECT_EQ(0, std::remove(path.c_str()));
+}
@@ -0,0 +1,772 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <ignition/math/AxisAlignedBox.hh>
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Vector3.hh>
+
+#include "sdf/Collision.hh"
+#include "sdf/Geometry.hh"
+#include "sdf/Light.hh"
+#include "sdf/Link.hh"
+#include "sdf/Visual.hh"
+#include "sdf/World.hh"
+#include "sdf/WorldExport.hh"
+#include "sdf/WorldSpatialIndex.hh"
+#include "Utils.hh"
+
+using namespace sdf;
+
+/// \brief Largest number of entities in a leaf of the hierarchy.
+static const std::size_t kLeafSize = 4;
+
+/// \brief A box as its corners, empty when a minimum is above a maximum.
+struct SpatialExtent
+{
+  /// \brief Minimum corner.
+  double min[3] = {std::numeric_limits<double>::infinity(),
+                   std::numeric_limits<double>::infinity(),
+                   std::numeric_limits<double>::infinity()};
+
+  /// \brief Maximum corner.
+  double max[3] = {-std::numeric_limits<double>::infinity(),
+                   -std::numeric_limits<double>::infinity(),
+                   -std::numeric_limits<double>::infinity()};
+
+  /// \brief Check whether the box contains no point.
+  /// \return True if the box is empty.
+  bool Empty() const
+  {
+    return this->min[0] > this->max[0];
+  }
+
+  /// \brief Grow the box to contain another one.
+  /// \param[in] _other The other box.
+  void Merge(const SpatialExtent &_other)
+  {
+    for (int i = 0; i < 3; ++i)
+    {
+      this->min[i] = std::min(this->min[i], _other.min[i]);
+      this->max[i] = std::max(this->max[i], _other.max[i]);
+    }
+  }
+
+  /// \brief Check whether the box overlaps another one. Touching boxes
+  /// overlap.
+  /// \param[in] _other The other box.
+  /// \return True if the boxes overlap.
+  bool Overlaps(const SpatialExtent &_other) const
+  {
+    for (int i = 0; i < 3; ++i)
+    {
+      if (this->min[i] > _other.max[i] || this->max[i] < _other.min[i])
+        return false;
+    }
+    return true;
+  }
+
+  /// \brief Set the box from its center and half sizes.
+  /// \param[in] _center Center of the box.
+  /// \param[in] _half Half sizes of the box.
+  void Set(const ignition::math::Vector3d &_center,
+           const ignition::math::Vector3d &_half)
+  {
+    for (int i = 0; i < 3; ++i)
+    {
+      this->min[i] = _center[i] - _half[i];
+      this->max[i] = _center[i] + _half[i];
+    }
+  }
+
+  /// \brief Get the center of the box.
+  /// \return The center.
+  ignition::math::Vector3d Center() const
+  {
+    return {(this->min[0] + this->max[0]) * 0.5,
+            (this->min[1] + this->max[1]) * 0.5,
+            (this->min[2] + this->max[2]) * 0.5};
+  }
+
+  /// \brief Get the half sizes of the box.
+  /// \return The half sizes.
+  ignition::math::Vector3d Half() const
+  {
+    return {(this->max[0] - this->min[0]) * 0.5,
+            (this->max[1] - this->min[1]) * 0.5,
+            (this->max[2] - this->min[2]) * 0.5};
+  }
+};
+
+/// \brief A node of the bounding volume hierarchy.
+struct SpatialNode
+{
+  /// \brief Bounds of the entities below the node.
+  SpatialExtent extent;
+
+  /// \brief Parent node, or kInvalidIndex for the root.
+  std::size_t parent = WorldSpatialIndex::kInvalidIndex;
+
+  /// \brief Child nodes of an inner node. The left child follows its
+  /// parent, so that children always come after their parents.
+  std::size_t left = WorldSpatialIndex::kInvalidIndex;
+
+  /// \brief Right child node of an inner node.
+  std::size_t right = WorldSpatialIndex::kInvalidIndex;
+
+  /// \brief First entry of a leaf in the entity order.
+  std::size_t first = 0;
+
+  /// \brief Number of entities of a leaf, zero for inner nodes.
+  std::size_t count = 0;
+};
+
+/////////////////////////////////////////////////
+/// \brief Move a box by a pose.
+/// \param[in] _center Center of the box.
+/// \param[in] _half Half sizes of the box.
+/// \param[in] _rotates False if the box bounds a sphere, whose half sizes
+/// don't change when it rotates.
+/// \param[in] _pose The pose.
+/// \return The box that contains the moved box.
+static SpatialExtent moveExtent(const ignition::math::Vector3d &_center,
+    const ignition::math::Vector3d &_half, bool _rotates,
+    const ignition::math::Pose3d &_pose)
+{
+  SpatialExtent result;
+  if (!_rotates)
+  {
+    result.Set(_pose.Pos() + _pose.Rot().RotateVector(_center), _half);
+    return result;
+  }
+
+  // Each half size of the moved box sums the rotated half sizes along it.
+  const ignition::math::Vector3d half =
+    _pose.Rot().RotateVector(ignition::math::Vector3d::UnitX).Abs() *
+      _half.X() +
+    _pose.Rot().RotateVector(ignition::math::Vector3d::UnitY).Abs() *
+      _half.Y() +
+    _pose.Rot().RotateVector(ignition::math::Vector3d::UnitZ).Abs() *
+      _half.Z();
+  result.Set(_pose.Pos() + _pose.Rot().RotateVector(_center), half);
+  return result;
+}
+
+class sdf::WorldSpatialIndexPrivate
+{
+  /// \brief Remove all entities, keeping the storage.
+  public: void Clear()
+  {
+    this->types.clear();
+    this->parents.clear();
+    this->names.clear();
+    this->nameIndex.clear();
+    this->bounds.clear();
+    this->extents.clear();
+    this->ends.clear();
+    this->localPoses.clear();
+    this->localCenters.clear();
+    this->localHalves.clear();
+    this->rotates.clear();
+    this->nodes.clear();
+    this->order.clear();
+    this->leaves.clear();
+    this->unbounded.clear();
+  }
+
+  /// \brief Add an entity.
+  /// \param[in] _type Type of the entity.
+  /// \param[in] _parent Entity index of its parent.
+  /// \param[in] _name Scoped name of the entity.
+  /// \param[in] _localPose Pose of the entity relative to its top level
+  /// model, which is identity for top level models, or to the world frame
+  /// for lights of the world.
+  /// \return Entity index of the new entity.
+  public: std::size_t Add(SpatialEntityType _type, std::size_t _parent,
+              const std::string &_name,
+              const ignition::math::Pose3d &_localPose)
+  {
+    const std::size_t index = this->types.size();
+    this->types.push_back(_type);
+    this->parents.push_back(_parent);
+    this->names.push_back(_name);
+    this->nameIndex.emplace(_name, index);
+    this->bounds.emplace_back();
+    this->extents.emplace_back();
+    this->ends.push_back(index + 1);
+    this->localPoses.push_back(_localPose);
+    this->localCenters.push_back(ignition::math::Vector3d::Zero);
+    this->localHalves.push_back(ignition::math::Vector3d::Zero);
+    this->rotates.push_back(true);
+    return index;
+  }
+
+  /// \brief Set the bounds of an entity.
+  /// \param[in] _entity Index of the entity.
+  /// \param[in] _extent The bounds.
+  public: void SetExtent(std::size_t _entity, const SpatialExtent &_extent)
+  {
+    this->extents[_entity] = _extent;
+    this->bounds[_entity] = ignition::math::AxisAlignedBox(
+        ignition::math::Vector3d(_extent.min[0], _extent.min[1],
+                                 _extent.min[2]),
+        ignition::math::Vector3d(_extent.max[0], _extent.max[1],
+                                 _extent.max[2]));
+  }
+
+  /// \brief Bound the models in a range of entities by their links and
+  /// nested models, or by their origin if they have none.
+  /// \param[in] _begin First entity of the range.
+  /// \param[in] _end Entity after the range.
+  /// \param[in] _poses World poses of the entities, or nullptr if the
+  /// range is a single top level model at _rootPose.
+  /// \param[in] _rootPose Pose of the top level model of the range in the
+  /// world frame, used when _poses is nullptr.
+  public: void BoundModels(std::size_t _begin, std::size_t _end,
+              const std::vector<ignition::math::Pose3d> *_poses,
+              const ignition::math::Pose3d &_rootPose);
+
+  /// \brief Build the hierarchy over the bounded entities.
+  public: void BuildTree();
+
+  /// \brief Build a node over entries of the entity order.
+  /// \param[in] _first First entry.
+  /// \param[in] _count Number of entries.
+  /// \param[in] _parent Parent node.
+  /// \return Index of the node.
+  public: std::size_t BuildNode(std::size_t _first, std::size_t _count,
+              std::size_t _parent);
+
+  /// \brief Types of the entities.
+  public: std::vector<SpatialEntityType> types;
+
+  /// \brief Parents of the entities.
+  public: std::vector<std::size_t> parents;
+
+  /// \brief Scoped names of the entities.
+  public: std::vector<std::string> names;
+
+  /// \brief Index of the entities by scoped name.
+  public: NameIndex nameIndex;
+
+  /// \brief Bounds of the entities in the world frame.
+  public: std::vector<ignition::math::AxisAlignedBox> bounds;
+
+  /// \brief The same bounds as corners.
+  public: std::vector<SpatialExtent> extents;
+
+  /// \brief Entity after the entities that belong to each entity, so that
+  /// a top level model owns the range up to its end.
+  public: std::vector<std::size_t> ends;
+
+  /// \brief Pose of each entity relative to its top level model, or to the
+  /// world frame for lights of the world.
+  public: std::vector<ignition::math::Pose3d> localPoses;
+
+  /// \brief Center of the bounds of links and lights in the frame of their
+  /// top level model.
+  public: std::vector<ignition::math::Vector3d> localCenters;
+
+  /// \brief Half sizes of the bounds of links and lights in the frame of
+  /// their top level model.
+  public: std::vector<ignition::math::Vector3d> localHalves;
+
+  /// \brief False for entities bounded by a sphere, whose bounds don't
+  /// grow when they rotate.
+  public: std::vector<bool> rotates;
+
+  /// \brief Nodes of the hierarchy, parents first.
+  public: std::vector<SpatialNode> nodes;
+
+  /// \brief Bounded entities, in the order of the leaves.
+  public: std::vector<std::size_t> order;
+
+  /// \brief Leaf of each entity, or kInvalidIndex for unbounded entities.
+  public: std::vector<std::size_t> leaves;
+
+  /// \brief Unbounded entities, which every query returns.
+  public: std::vector<std::size_t> unbounded;
+};
+
+/////////////////////////////////////////////////
+void WorldSpatialIndexPrivate::BoundModels(std::size_t _begin,
+    std::size_t _end, const std::vector<ignition::math::Pose3d> *_poses,
+    const ignition::math::Pose3d &_rootPose)
+{
+  for (std::size_t e = _begin; e < _end; ++e)
+  {
+    if (this->types[e] == SpatialEntityType::MODEL)
+      this->extents[e] = SpatialExtent();
+  }
+
+  // Children come after their parents, so they are merged first.
+  for (std::size_t e = _end; e-- > _begin;)
+  {
+    if (this->types[e] == SpatialEntityType::MODEL)
+    {
+      SpatialExtent extent = this->extents[e];
+      if (extent.Empty())
+      {
+        const ignition::math::Pose3d pose = _poses ? (*_poses)[e] :
+          _rootPose * this->localPoses[e];
+        extent.Set(pose.Pos(), ignition::math::Vector3d::Zero);
+      }
+      this->SetExtent(e, extent);
+    }
+    const std::size_t parent = this->parents[e];
+    if (this->types[e] != SpatialEntityType::LIGHT && parent >= _begin &&
+        parent < _end)
+    {
+      this->extents[parent].Merge(this->extents[e]);
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+void WorldSpatialIndexPrivate::BuildTree()
+{
+  this->nodes.clear();
+  this->order.clear();
+  this->leaves.assign(this->types.size(), WorldSpatialIndex::kInvalidIndex);
+  for (std::size_t e = 0; e < this->types.size(); ++e)
+  {
+    const SpatialExtent &extent = this->extents[e];
+    const bool infinite = std::isinf(extent.min[0]) ||
+      std::isinf(extent.max[0]);
+    if (infinite)
+      this->unbounded.push_back(e);
+    else
+      this->order.push_back(e);
+  }
+  if (!this->order.empty())
+  {
+    this->nodes.reserve(2 * this->order.size() / kLeafSize + 1);
+    this->BuildNode(0, this->order.size(), WorldSpatialIndex::kInvalidIndex);
+  }
+}
+
+/////////////////////////////////////////////////
+std::size_t WorldSpatialIndexPrivate::BuildNode(std::size_t _first,
+    std::size_t _count, std::size_t _parent)
+{
+  const std::size_t index = this->nodes.size();
+  this->nodes.emplace_back();
+  this->nodes[index].parent = _parent;
+
+  SpatialExtent extent;
+  SpatialExtent centers;
+  for (std::size_t i = _first; i < _first + _count; ++i)
+  {
+    const SpatialExtent &entity = this->extents[this->order[i]];
+    extent.Merge(entity);
+    SpatialExtent center;
+    center.Set(entity.Center(), ignition::math::Vector3d::Zero);
+    centers.Merge(center);
+  }
+  this->nodes[index].extent = extent;
+
+  if (_count <= kLeafSize)
+  {
+    this->nodes[index].first = _first;
+    this->nodes[index].count = _count;
+    for (std::size_t i = _first; i < _first + _count; ++i)
+      this->leaves[this->order[i]] = index;
+    return index;
+  }
+
+  // Split at the median center along the longest side of the centers.
+  const ignition::math::Vector3d spread = centers.Half();
+  int axis = 0;
+  if (spread[1] > spread[axis])
+    axis = 1;
+  if (spread[2] > spread[axis])
+    axis = 2;
+  const std::size_t half = _count / 2;
+  auto begin = this->order.begin() + static_cast<std::ptrdiff_t>(_first);
+  std::nth_element(begin, begin + static_cast<std::ptrdiff_t>(half),
+      begin + static_cast<std::ptrdiff_t>(_count),
+      [this, axis](std::size_t _a, std::size_t _b)
+      {
+        const SpatialExtent &a = this->extents[_a];
+        const SpatialExtent &b = this->extents[_b];
+        return a.min[axis] + a.max[axis] < b.min[axis] + b.max[axis];
+      });
+
+  const std::size_t left = this->BuildNode(_first, half, index);
+  const std::size_t right = this->BuildNode(_first + half, _count - half,
+      index);
+  this->nodes[index].left = left;
+  this->nodes[index].right = right;
+  return index;
+}
+
+/////////////////////////////////////////////////
+WorldSpatialIndex::WorldSpatialIndex()
+  : dataPtr(new WorldSpatialIndexPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+WorldSpatialIndex::WorldSpatialIndex(const WorldSpatialIndex &_index)
+  : dataPtr(new WorldSpatialIndexPrivate(*_index.dataPtr))
+{
+}
+
+/////////////////////////////////////////////////
+WorldSpatialIndex::WorldSpatialIndex(WorldSpatialIndex &&_index) noexcept
+  : dataPtr(std::exchange(_index.dataPtr, nullptr))
+{
+}
+
+/////////////////////////////////////////////////
+WorldSpatialIndex &WorldSpatialIndex::operator=(
+    WorldSpatialIndex &&_index) noexcept
+{
+  std::swap(this->dataPtr, _index.dataPtr);
+  return *this;
+}
+
+/////////////////////////////////////////////////
+WorldSpatialIndex &WorldSpatialIndex::operator=(
+    const WorldSpatialIndex &_index)
+{
+  return *this = WorldSpatialIndex(_index);
+}
+
+/////////////////////////////////////////////////
+WorldSpatialIndex::~WorldSpatialIndex()
+{
+  delete this->dataPtr;
+  this->dataPtr = nullptr;
+}
+
+/////////////////////////////////////////////////
+/// \brief Get the bounds of a light.
+/// \param[in] _light The light.
+/// \param[out] _radius Attenuation range of a point or spot light.
+/// \return False for directional lights, which are unbounded.
+static bool lightRadius(const Light &_light, double &_radius)
+{
+  if (_light.Type() == LightType::DIRECTIONAL)
+    return false;
+  _radius = std::max(_light.AttenuationRange(), 0.0);
+  return true;
+}
+
+/////////////////////////////////////////////////
+Errors WorldSpatialIndex::Build(const World &_world,
+    const Mesh::AxisAlignedBoxCalculator &_meshCalculator)
+{
+  using ignition::math::Pose3d;
+  using ignition::math::Vector3d;
+  WorldSpatialIndexPrivate &data = *this->dataPtr;
+  data.Clear();
+
+  WorldExport worldExport;
+  Errors errors = worldExport.Build(_world);
+  const std::size_t count = worldExport.EntityCount();
+  const ExportEntityType *types = worldExport.EntityTypes();
+  const std::size_t *parents = worldExport.EntityParents();
+  const Pose3d *poses = worldExport.EntityPoses();
+
+  // World poses of the entities, and the entity of each export entity.
+  std::vector<Pose3d> worldPoses;
+  std::vector<std::size_t> entities(count, kInvalidIndex);
+  std::vector<std::size_t> roots;
+
+  auto addLight = [&](const Light &_light, std::size_t _parent,
+      const std::string &_scope, std::size_t _root,
+      const Pose3d &_parentPose)
+  {
+    Pose3d pose;
+    Errors lightErrors = _light.SemanticPose().Resolve(pose);
+    errors.insert(errors.end(), lightErrors.begin(), lightErrors.end());
+    pose = _parentPose * pose;
+
+    const Pose3d localPose = _root == kInvalidIndex ? pose :
+      worldPoses[_root].Inverse() * pose;
+    const std::size_t entity = data.Add(SpatialEntityType::LIGHT, _parent,
+        _scope + _light.Name(), localPose);
+    worldPoses.push_back(pose);
+    roots.push_back(_root);
+
+    double radius = 0;
+    SpatialExtent extent;
+    if (lightRadius(_light, radius))
+    {
+      data.localCenters[entity] = localPose.Pos();
+      data.localHalves[entity] = Vector3d(radius, radius, radius);
+      data.rotates[entity] = false;
+      extent.Set(pose.Pos(), data.localHalves[entity]);
+    }
+    else
+    {
+      extent.Set(Vector3d::Zero, Vector3d(
+          std::numeric_limits<double>::infinity(),
+          std::numeric_limits<double>::infinity(),
+          std::numeric_limits<double>::infinity()));
+    }
+    data.SetExtent(entity, extent);
+  };
+
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    if (types[i] != ExportEntityType::MODEL &&
+        types[i] != ExportEntityType::LINK)
+    {
+      continue;
+    }
+
+    const std::size_t parent =
+      parents[i] == WorldExport::kInvalidIndex ? kInvalidIndex :
+      entities[parents[i]];
+    const std::size_t root = parent == kInvalidIndex ?
+      data.types.size() : roots[parent];
+    const Pose3d localPose = parent == kInvalidIndex ? Pose3d::Zero :
+      worldPoses[root].Inverse() * poses[i];
+    const std::string &name = worldExport.EntityName(i);
+
+    if (types[i] == ExportEntityType::MODEL)
+    {
+      entities[i] = data.Add(SpatialEntityType::MODEL, parent, name,
+          localPose);
+      worldPoses.push_back(poses[i]);
+      roots.push_back(root);
+      continue;
+    }
+
+    const std::size_t entity = data.Add(SpatialEntityType::LINK, parent,
+        name, localPose);
+    entities[i] = entity;
+    worldPoses.push_back(poses[i]);
+    roots.push_back(root);
+
+    // The visuals and then the collisions of a link follow it.
+    const Link *link = _world.LinkByScopedName(name);
+    if (!link)
+      continue;
+    const Pose3d rootInverse = worldPoses[root].Inverse();
+    SpatialExtent extent;
+    SpatialExtent local;
+    auto addGeometry = [&](const Geometry *_geom, std::size_t _entity)
+    {
+      if (!_geom || _entity >= count)
+        return;
+      std::optional<ignition::math::AxisAlignedBox> box =
+        _geom->AxisAlignedBox(_meshCalculator);
+      if (!box)
+        return;
+      const Vector3d center = box->Center();
+      const Vector3d half = box->Size() * 0.5;
+      extent.Merge(moveExtent(center, half, true, poses[_entity]));
+      local.Merge(moveExtent(center, half, true,
+          rootInverse * poses[_entity]));
+    };
+    for (uint64_t j = 0; j < link->VisualCount(); ++j)
+      addGeometry(link->VisualByIndex(j)->Geom(), i + 1 + j);
+    for (uint64_t j = 0; j < link->CollisionCount(); ++j)
+    {
+      addGeometry(link->CollisionByIndex(j)->Geom(),
+          i + 1 + link->VisualCount() + j);
+    }
+    if (extent.Empty())
+    {
+      extent.Set(poses[i].Pos(), Vector3d::Zero);
+      local.Set(localPose.Pos(), Vector3d::Zero);
+    }
+    data.localCenters[entity] = local.Center();
+    data.localHalves[entity] = local.Half();
+    data.SetExtent(entity, extent);
+
+    for (uint64_t j = 0; j < link->LightCount(); ++j)
+      addLight(*link->LightByIndex(j), entity, name + "::", root, poses[i]);
+  }
+
+  // Every entity after a model up to the next entity that is not below it
+  // belongs to it.
+  for (std::size_t e = data.types.size(); e-- > 0;)
+  {
+    const std::size_t parent = data.parents[e];
+    if (parent != kInvalidIndex)
+      data.ends[parent] = std::max(data.ends[parent], data.ends[e]);
+  }
+  data.BoundModels(0, data.types.size(), &worldPoses, Pose3d::Zero);
+
+  for (uint64_t i = 0; i < _world.LightCount(); ++i)
+  {
+    addLight(*_world.LightByIndex(i), kInvalidIndex, "", kInvalidIndex,
+        Pose3d::Zero);
+  }
+
+  data.BuildTree();
+  return errors;
+}
+
+/////////////////////////////////////////////////
+std::size_t WorldSpatialIndex::EntityCount() const
+{
+  return this->dataPtr->types.size();
+}
+
+/////////////////////////////////////////////////
+const SpatialEntityType *WorldSpatialIndex::EntityTypes() const
+{
+  return this->dataPtr->types.data();
+}
+
+/////////////////////////////////////////////////
+const std::size_t *WorldSpatialIndex::EntityParents() const
+{
+  return this->dataPtr->parents.data();
+}
+
+/////////////////////////////////////////////////
+const ignition::math::AxisAlignedBox *WorldSpatialIndex::EntityBounds() const
+{
+  return this->dataPtr->bounds.data();
+}
+
+/////////////////////////////////////////////////
+const std::string &WorldSpatialIndex::EntityName(std::size_t _index) const
+{
+  static const std::string kEmpty;
+  if (_index < this->dataPtr->names.size())
+    return this->dataPtr->names[_index];
+  return kEmpty;
+}
+
+/////////////////////////////////////////////////
+std::size_t WorldSpatialIndex::EntityByName(const std::string &_name) const
+{
+  auto it = this->dataPtr->nameIndex.find(_name);
+  return it == this->dataPtr->nameIndex.end() ? kInvalidIndex : it->second;
+}
+
+/////////////////////////////////////////////////
+void WorldSpatialIndex::Query(const ignition::math::AxisAlignedBox &_region,
+    std::vector<std::size_t> &_entities) const
+{
+  const WorldSpatialIndexPrivate &data = *this->dataPtr;
+  _entities.clear();
+
+  SpatialExtent region;
+  for (int i = 0; i < 3; ++i)
+  {
+    region.min[i] = _region.Min()[i];
+    region.max[i] = _region.Max()[i];
+  }
+
+  if (!data.nodes.empty() && !region.Empty())
+  {
+    std::vector<std::size_t> stack{0};
+    while (!stack.empty())
+    {
+      const SpatialNode &node = data.nodes[stack.back()];
+      stack.pop_back();
+      if (!node.extent.Overlaps(region))
+        continue;
+      if (node.count == 0)
+      {
+        stack.push_back(node.right);
+        stack.push_back(node.left);
+        continue;
+      }
+      for (std::size_t i = node.first; i < node.first + node.count; ++i)
+      {
+        const std::size_t entity = data.order[i];
+        if (data.extents[entity].Overlaps(region))
+          _entities.push_back(entity);
+      }
+    }
+  }
+
+  _entities.insert(_entities.end(), data.unbounded.begin(),
+      data.unbounded.end());
+  std::sort(_entities.begin(), _entities.end());
+}
+
+/////////////////////////////////////////////////
+void WorldSpatialIndex::Query(const ignition::math::AxisAlignedBox &_region,
+    SpatialEntityType _type, std::vector<std::size_t> &_entities) const
+{
+  this->Query(_region, _entities);
+  const std::vector<SpatialEntityType> &types = this->dataPtr->types;
+  _entities.erase(std::remove_if(_entities.begin(), _entities.end(),
+      [&types, _type](std::size_t _entity)
+      {
+        return types[_entity] != _type;
+      }), _entities.end());
+}
+
+/////////////////////////////////////////////////
+bool WorldSpatialIndex::UpdateModelPose(std::size_t _model,
+    const ignition::math::Pose3d &_pose)
+{
+  WorldSpatialIndexPrivate &data = *this->dataPtr;
+  if (_model >= data.types.size() ||
+      data.types[_model] != SpatialEntityType::MODEL ||
+      data.parents[_model] != kInvalidIndex)
+  {
+    return false;
+  }
+
+  const std::size_t end = data.ends[_model];
+  for (std::size_t e = _model + 1; e < end; ++e)
+  {
+    if (data.types[e] == SpatialEntityType::MODEL)
+      continue;
+    data.SetExtent(e, moveExtent(data.localCenters[e], data.localHalves[e],
+        data.rotates[e], _pose));
+  }
+  data.BoundModels(_model, end, nullptr, _pose);
+
+  // Refit the leaves of the moved entities and their ancestors. Children
+  // come after their parents, so a reverse sweep refits them first.
+  std::vector<bool> dirty(data.nodes.size(), false);
+  for (std::size_t e = _model; e < end; ++e)
+  {
+    for (std::size_t node = data.leaves[e];
+         node != kInvalidIndex && !dirty[node]; node = data.nodes[node].parent)
+    {
+      dirty[node] = true;
+    }
+  }
+  for (std::size_t n = data.nodes.size(); n-- > 0;)
+  {
+    if (!dirty[n])
+      continue;
+    SpatialNode &node = data.nodes[n];
+    node.extent = SpatialExtent();
+    if (node.count == 0)
+    {
+      node.extent.Merge(data.nodes[node.left].extent);
+      node.extent.Merge(data.nodes[node.right].extent);
+      continue;
+    }
+    for (std::size_t i = node.first; i < node.first + node.count; ++i)
+      node.extent.Merge(data.extents[data.order[i]]);
+  }
+  return true;
+}
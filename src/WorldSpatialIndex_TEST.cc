@@ -0,0 +1,171 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include <ignition/math/AxisAlignedBox.hh>
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Vector3.hh>
+#include "sdf/Root.hh"
+#include "sdf/World.hh"
+#include "sdf/WorldSpatialIndex.hh"
+
+using ignition::math::AxisAlignedBox;
+using ignition::math::Vector3d;
+
+/////////////////////////////////////////////////
+TEST(DOMWorldSpatialIndex, Construction)
+{
+  sdf::WorldSpatialIndex index;
+  EXPECT_EQ(0u, index.EntityCount());
+  EXPECT_TRUE(index.EntityName(0).empty());
+  EXPECT_EQ(sdf::WorldSpatialIndex::kInvalidIndex, index.EntityByName("a"));
+  EXPECT_FALSE(index.UpdateModelPose(0, ignition::math::Pose3d::Zero));
+
+  std::vector<std::size_t> entities{1};
+  index.Query(AxisAlignedBox(Vector3d(-1, -1, -1), Vector3d(1, 1, 1)),
+      entities);
+  EXPECT_TRUE(entities.empty());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMWorldSpatialIndex, Query)
+{
+  const std::string sdfString = R"(
+  <sdf version="1.8">
+    <world name="default">
+      <model name="a">
+        <link name="l">
+          <collision name="c">
+            <geometry><box><size>1 1 1</size></box></geometry>
+          </collision>
+        </link>
+      </model>
+      <model name="b">
+        <pose>10 0 0 0 0 0</pose>
+        <link name="l">
+          <visual name="v">
+            <geometry><box><size>2 2 2</size></box></geometry>
+          </visual>
+          <light name="lamp" type="point">
+            <attenuation><range>1</range></attenuation>
+          </light>
+        </link>
+      </model>
+      <light name="lamp" type="point">
+        <pose>0 5 0 0 0 0</pose>
+        <attenuation><range>1</range></attenuation>
+      </light>
+      <light name="sun" type="directional"/>
+    </world>
+  </sdf>)";
+
+  sdf::Root root;
+  ASSERT_TRUE(root.LoadSdfString(sdfString).empty());
+  const sdf::World *world = root.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+
+  sdf::WorldSpatialIndex index;
+  EXPECT_TRUE(index.Build(*world).empty());
+
+  // a, a::l, b, b::l, b::l::lamp, lamp, sun
+  ASSERT_EQ(7u, index.EntityCount());
+  const sdf::SpatialEntityType *types = index.EntityTypes();
+  const std::size_t *parents = index.EntityParents();
+  EXPECT_EQ(sdf::SpatialEntityType::MODEL, types[0]);
+  EXPECT_EQ(sdf::WorldSpatialIndex::kInvalidIndex, parents[0]);
+  EXPECT_EQ(sdf::SpatialEntityType::LINK, types[1]);
+  EXPECT_EQ(0u, parents[1]);
+  EXPECT_EQ(sdf::SpatialEntityType::LIGHT, types[4]);
+  EXPECT_EQ(3u, parents[4]);
+  EXPECT_EQ(4u, index.EntityByName("b::l::lamp"));
+  EXPECT_EQ(5u, index.EntityByName("lamp"));
+  EXPECT_EQ("sun", index.EntityName(6));
+
+  const AxisAlignedBox *bounds = index.EntityBounds();
+  EXPECT_EQ(AxisAlignedBox(Vector3d(-0.5, -0.5, -0.5), Vector3d(0.5, 0.5, 0.5)),
+      bounds[0]);
+  EXPECT_EQ(AxisAlignedBox(Vector3d(9, -1, -1), Vector3d(11, 1, 1)),
+      bounds[2]);
+  EXPECT_EQ(AxisAlignedBox(Vector3d(-1, 4, -1), Vector3d(1, 6, 1)),
+      bounds[5]);
+
+  // Directional lights are in every result.
+  std::vector<std::size_t> entities;
+  const AxisAlignedBox origin(Vector3d(-1, -1, -1), Vector3d(1, 1, 1));
+  index.Query(origin, entities);
+  EXPECT_EQ(std::vector<std::size_t>({0, 1, 6}), entities);
+
+  index.Query(AxisAlignedBox(Vector3d(9, -1, -1), Vector3d(11, 1, 1)),
+      sdf::SpatialEntityType::MODEL, entities);
+  EXPECT_EQ(std::vector<std::size_t>({2}), entities);
+
+  index.Query(AxisAlignedBox(Vector3d(0, 4.5, 0), Vector3d(0, 4.5, 0)),
+      sdf::SpatialEntityType::LIGHT, entities);
+  EXPECT_EQ(std::vector<std::size_t>({5, 6}), entities);
+
+  // Moving a model moves its links and their lights.
+  EXPECT_FALSE(index.UpdateModelPose(1, ignition::math::Pose3d::Zero));
+  EXPECT_TRUE(index.UpdateModelPose(2, ignition::math::Pose3d::Zero));
+  EXPECT_EQ(origin, bounds[2]);
+  EXPECT_EQ(origin, bounds[4]);
+  index.Query(origin, entities);
+  EXPECT_EQ(std::vector<std::size_t>({0, 1, 2, 3, 4, 6}), entities);
+  index.Query(AxisAlignedBox(Vector3d(9, -1, -1), Vector3d(11, 1, 1)),
+      entities);
+  EXPECT_EQ(std::vector<std::size_t>({6}), entities);
+
+  sdf::WorldSpatialIndex copy(index);
+  copy.Query(origin, sdf::SpatialEntityType::MODEL, entities);
+  EXPECT_EQ(std::vector<std::size_t>({0, 2}), entities);
+}
+
+/////////////////////////////////////////////////
+TEST(DOMWorldSpatialIndex, ManyModels)
+{
+  std::string sdfString = "<sdf version='1.8'><world name='default'>";
+  for (int i = 0; i < 50; ++i)
+  {
+    sdfString += "<model name='m" + std::to_string(i) + "'>"
+      "<pose>" + std::to_string(i * 2) + " 0 0 0 0 0</pose>"
+      "<link name='l'/></model>";
+  }
+  sdfString += "</world></sdf>";
+
+  sdf::Root root;
+  ASSERT_TRUE(root.LoadSdfString(sdfString).empty());
+  sdf::WorldSpatialIndex index;
+  EXPECT_TRUE(index.Build(*root.WorldByIndex(0)).empty());
+  ASSERT_EQ(100u, index.EntityCount());
+
+  // Links without geometry are bounded by their origin.
+  std::vector<std::size_t> entities;
+  index.Query(AxisAlignedBox(Vector3d(19, -1, -1), Vector3d(23, 1, 1)),
+      sdf::SpatialEntityType::MODEL, entities);
+  EXPECT_EQ(std::vector<std::size_t>({20, 22}), entities);
+
+  // Move the first model to the end of the row.
+  EXPECT_TRUE(index.UpdateModelPose(0,
+      ignition::math::Pose3d(100, 0, 0, 0, 0, 0)));
+  index.Query(AxisAlignedBox(Vector3d(99, -1, -1), Vector3d(101, 1, 1)),
+      entities);
+  EXPECT_EQ(std::vector<std::size_t>({0, 1}), entities);
+  index.Query(AxisAlignedBox(Vector3d(-1, -1, -1), Vector3d(1, 1, 1)),
+      entities);
+  EXPECT_TRUE(entities.empty());
+}
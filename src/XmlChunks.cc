@@ -0,0 +1,365 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+#include "sdf/SDFImpl.hh"
+#include "Utils.hh"
+#include "XmlChunks.hh"
+
+using namespace sdf;
+
+/// \brief Size from which a run takes no more elements, in bytes, unless
+/// the document is large enough for larger runs.
+static constexpr std::size_t kRunSize = 64 * 1024;
+
+/// \brief Smallest run worth parsing on its own, in bytes.
+static constexpr std::size_t kMinRunSize = 16 * 1024;
+
+/// \brief Number of runs per thread, so that threads that finish early
+/// take more runs while another parses a large one.
+static constexpr std::size_t kRunsPerThread = 4;
+
+namespace
+{
+  /// \brief Consecutive top level entities of a world, in the text.
+  struct Run
+  {
+    /// \brief Offset of the '<' of the first element.
+    std::size_t begin;
+
+    /// \brief Offset just past the end of the last element.
+    std::size_t end;
+
+    /// \brief Index of the world among the <world> children of <sdf>.
+    std::size_t world;
+
+    /// \brief Index of the first element among the child elements of its
+    /// world, in the text.
+    std::size_t child;
+
+    /// \brief Number of elements.
+    std::size_t count;
+
+    /// \brief Name of the first element.
+    std::string name;
+  };
+}
+
+/////////////////////////////////////////////////
+/// \brief Check whether a range of text is white space, as tinyxml2 sees
+/// it between elements.
+/// \param[in] _begin First character.
+/// \param[in] _end One past the last character.
+/// \return True if there are only spaces, tabs and line breaks.
+static bool isWhiteSpace(const char *_begin, const char *_end)
+{
+  return std::all_of(_begin, _end, [](char _c)
+      {
+        return _c == ' ' || _c == '\t' || _c == '\n' || _c == '\r';
+      });
+}
+
+/////////////////////////////////////////////////
+/// \brief Find the end of a markup.
+/// \param[in] _begin Position just past the start of the markup.
+/// \param[in] _end End of the text.
+/// \param[in] _terminator Text that ends the markup.
+/// \return The position just past the terminator, or nullptr if the markup
+/// is not terminated.
+static const char *skipPast(const char *_begin, const char *_end,
+    std::string_view _terminator)
+{
+  const std::string_view text(_begin, _end - _begin);
+  const std::size_t pos = text.find(_terminator);
+  return pos == std::string_view::npos ?
+      nullptr : _begin + pos + _terminator.size();
+}
+
+/////////////////////////////////////////////////
+/// \brief Scan the tags of a document for the <model>, <include> and
+/// <light> children of the worlds of its <sdf> root, and group them in
+/// runs. Only tags, comments, CDATA sections, processing instructions and
+/// quoted attribute values are told apart, which is all it takes to find
+/// where elements begin and end.
+/// \param[in] _data Text of the document.
+/// \param[in] _size Size of the text in bytes.
+/// \param[in] _runSize Size from which a run takes no more elements.
+/// \param[out] _runs Runs found, in document order.
+/// \return False if the text isn't an SDFormat document whose tags could
+/// be scanned.
+static bool scanRuns(const char *_data, std::size_t _size,
+    std::size_t _runSize, std::vector<Run> &_runs)
+{
+  const char *p = _data;
+  const char *const end = _data + _size;
+  std::size_t depth = 0;
+  std::size_t roots = 0;
+  bool inWorld = false;
+  bool inEntity = false;
+  std::size_t worldCount = 0;
+  std::size_t childCount = 0;
+  while ((p = static_cast<const char *>(std::memchr(p, '<', end - p))))
+  {
+    const std::size_t tagOffset = p - _data;
+    const std::string_view rest(p, end - p);
+    if (rest.compare(0, 4, "<!--") == 0)
+      p = skipPast(p + 4, end, "-->");
+    else if (rest.compare(0, 9, "<![CDATA[") == 0)
+      p = skipPast(p + 9, end, "]]>");
+    else if (rest.compare(0, 2, "<?") == 0)
+      p = skipPast(p + 2, end, "?>");
+    else if (rest.compare(0, 2, "<!") == 0)
+      p = skipPast(p + 2, end, ">");
+    else if (rest.compare(0, 2, "</") == 0)
+    {
+      p = skipPast(p + 2, end, ">");
+      if (!p || depth == 0)
+        return false;
+      --depth;
+      if (depth == 2 && inEntity)
+      {
+        _runs.back().end = p - _data;
+        inEntity = false;
+      }
+      else if (depth == 1)
+      {
+        inWorld = false;
+      }
+      continue;
+    }
+    else
+    {
+      // A start tag, whose attribute values may contain '>'.
+      const char *q = p + 1;
+      while (q < end && !std::strchr(" \t\r\n/>", *q))
+        ++q;
+      const std::string_view name(p + 1, q - p - 1);
+      char quote = '\0';
+      for (; q < end; ++q)
+      {
+        if (quote != '\0')
+        {
+          if (*q == quote)
+            quote = '\0';
+        }
+        else if (*q == '"' || *q == '\'')
+        {
+          quote = *q;
+        }
+        else if (*q == '>')
+        {
+          break;
+        }
+      }
+      if (name.empty() || q == end)
+        return false;
+      const bool empty = *(q - 1) == '/';
+      p = q + 1;
+
+      if (depth == 0 && (roots++ != 0 || name != "sdf"))
+        return false;
+
+      if (depth == 1 && name == "world")
+      {
+        inWorld = !empty;
+        ++worldCount;
+        childCount = 0;
+      }
+      else if (depth == 2 && inWorld)
+      {
+        const std::size_t child = childCount++;
+        if (name == "model" || name == "include" || name == "light")
+        {
+          // Entities separated by white space only join the last run,
+          // unless it is large enough already.
+          Run *last = _runs.empty() ? nullptr : &_runs.back();
+          if (last && last->world == worldCount - 1 &&
+              last->child + last->count == child &&
+              last->end - last->begin < _runSize &&
+              isWhiteSpace(_data + last->end, _data + tagOffset))
+          {
+            ++last->count;
+          }
+          else
+          {
+            _runs.push_back({tagOffset, 0, worldCount - 1, child, 1,
+                std::string(name)});
+          }
+          _runs.back().end = p - _data;
+          inEntity = !empty;
+        }
+      }
+
+      if (!empty)
+        ++depth;
+      continue;
+    }
+
+    if (!p)
+      return false;
+  }
+  return depth == 0 && roots == 1;
+}
+
+/////////////////////////////////////////////////
+bool XmlChunks::Parse(const char *_data, std::size_t _size, bool _convert,
+    unsigned int _threadCount)
+{
+  const std::size_t threads = _threadCount == 0 ?
+      std::thread::hardware_concurrency() : _threadCount;
+  if (threads < 2 || _size < 2 * kRunSize)
+    return false;
+
+  std::vector<Run> found;
+  const std::size_t runSize =
+      std::max(kRunSize, _size / (threads * kRunsPerThread));
+  if (!scanRuns(_data, _size, runSize, found))
+    return false;
+
+  // Small runs are left in the document.
+  found.erase(std::remove_if(found.begin(), found.end(), [](const Run &_run)
+      {
+        return _run.end - _run.begin < kMinRunSize;
+      }), found.end());
+  if (found.size() < 2)
+    return false;
+
+  // The text outside the runs, with a placeholder and the line breaks of
+  // each run.
+  std::string text;
+  std::size_t offset = 0;
+  for (const Run &run : found)
+  {
+    text.append(_data + offset, run.begin - offset);
+    text += '<';
+    text += run.name;
+    text += "/>";
+    text.append(std::count(_data + run.begin, _data + run.end, '\n'), '\n');
+    offset = run.end;
+  }
+  text.append(_data + offset, _size - offset);
+
+  this->document.Parse(text.data(), text.size());
+  if (this->document.Error())
+    return false;
+
+  tinyxml2::XMLElement *sdfXml = this->document.FirstChildElement("sdf");
+  const char *version = sdfXml ? sdfXml->Attribute("version") : nullptr;
+  if (!version || (_convert && SDF::Version() != version))
+    return false;
+
+  this->runs.resize(found.size());
+  std::atomic<bool> failed{false};
+  parallelFor(found.size(), _threadCount, [&](std::size_t _index)
+      {
+        auto doc = std::make_unique<tinyxml2::XMLDocument>();
+        doc->Parse(_data + found[_index].begin,
+            found[_index].end - found[_index].begin);
+        if (doc->Error())
+          failed = true;
+        this->runs[_index] = std::move(doc);
+      });
+  if (failed)
+    return false;
+
+  // Each placeholder stands for the elements of its run, so the child
+  // elements that follow it are counted from the end of its run.
+  std::size_t runIndex = 0;
+  std::size_t world = 0;
+  for (tinyxml2::XMLElement *worldXml = sdfXml->FirstChildElement("world");
+       worldXml && runIndex < found.size();
+       worldXml = worldXml->NextSiblingElement("world"), ++world)
+  {
+    std::size_t child = 0;
+    for (tinyxml2::XMLElement *elem = worldXml->FirstChildElement();
+         elem && runIndex < found.size(); elem = elem->NextSiblingElement())
+    {
+      const Run &run = found[runIndex];
+      if (run.world == world && run.child == child)
+      {
+        if (run.name != elem->Name() || !elem->NoChildren() ||
+            elem->FirstAttribute())
+        {
+          return false;
+        }
+        tinyxml2::XMLDocument *runDoc = this->runs[runIndex].get();
+        this->placeholders[elem] = runDoc;
+        this->runPlaceholders[runDoc] = elem;
+        child += run.count;
+        ++runIndex;
+      }
+      else
+      {
+        ++child;
+      }
+    }
+  }
+  return runIndex == found.size();
+}
+
+/////////////////////////////////////////////////
+tinyxml2::XMLDocument &XmlChunks::Document()
+{
+  return this->document;
+}
+
+/////////////////////////////////////////////////
+const tinyxml2::XMLElement *XmlChunks::Enter(
+    const tinyxml2::XMLElement *_xml) const
+{
+  if (!_xml || !_xml->NoChildren())
+    return _xml;
+
+  auto iter = this->placeholders.find(_xml);
+  return iter == this->placeholders.end() ?
+      _xml : iter->second->FirstChildElement();
+}
+
+/////////////////////////////////////////////////
+tinyxml2::XMLElement *XmlChunks::Enter(tinyxml2::XMLElement *_xml) const
+{
+  return const_cast<tinyxml2::XMLElement *>(
+      this->Enter(static_cast<const tinyxml2::XMLElement *>(_xml)));
+}
+
+/////////////////////////////////////////////////
+const tinyxml2::XMLElement *XmlChunks::Next(
+    const tinyxml2::XMLElement *_xml) const
+{
+  const tinyxml2::XMLElement *next = _xml->NextSiblingElement();
+  if (!next && _xml->Parent() == _xml->GetDocument())
+  {
+    auto iter = this->runPlaceholders.find(_xml->GetDocument());
+    if (iter != this->runPlaceholders.end())
+      next = iter->second->NextSiblingElement();
+  }
+  return this->Enter(next);
+}
+
+/////////////////////////////////////////////////
+tinyxml2::XMLElement *XmlChunks::Next(tinyxml2::XMLElement *_xml) const
+{
+  return const_cast<tinyxml2::XMLElement *>(
+      this->Next(static_cast<const tinyxml2::XMLElement *>(_xml)));
+}
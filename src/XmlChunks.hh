@@ -0,0 +1,138 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_XML_CHUNKS_HH_
+#define SDF_XML_CHUNKS_HH_
+
+#include <tinyxml2.h>
+
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "sdf/sdf_config.h"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief A document parsed in parts by several threads, see
+  /// ParserConfig::SetChunkedXmlParse.
+  ///
+  /// The text is first scanned for the <model>, <include> and <light>
+  /// children of the worlds of the <sdf> root. Runs of consecutive such
+  /// elements, separated by white space only, are parsed concurrently into
+  /// documents of their own. The rest of the text is parsed into Document(),
+  /// with an empty element named like the first element of a run in place
+  /// of each run, and the lines of the run kept, so that the elements of
+  /// the document are on the lines they are on in the text. The elements of
+  /// the runs are numbered from the first line of their run.
+  ///
+  /// Enter and Next walk the children of an element with the elements of
+  /// the runs in place of their placeholder, which the parser does through
+  /// XmlChunkScope.
+  class XmlChunks
+  {
+    /// \brief Parse a document in parts.
+    /// \param[in] _data Text of the document.
+    /// \param[in] _size Size of the text in bytes.
+    /// \param[in] _convert True if documents of older versions are to be
+    /// converted, in which case they are not parsed in parts, since the
+    /// converter only sees Document().
+    /// \param[in] _threadCount Maximum number of threads, see parallelFor.
+    /// \return True if the document was parsed in parts. False if it should
+    /// be parsed as a whole instead: it's small, isn't an SDFormat
+    /// document, must be converted, or has a syntax error, which a parse of
+    /// the whole document reports as usual.
+    public: bool Parse(const char *_data, std::size_t _size, bool _convert,
+                unsigned int _threadCount);
+
+    /// \brief Get the document of the text outside the runs.
+    /// \return The document.
+    public: tinyxml2::XMLDocument &Document();
+
+    /// \brief Get the element that a child element stands for.
+    /// \param[in] _xml Child element, or nullptr.
+    /// \return The first element of a run if _xml is its placeholder, or
+    /// _xml otherwise.
+    public: tinyxml2::XMLElement *Enter(tinyxml2::XMLElement *_xml) const;
+
+    /// \copydoc Enter(tinyxml2::XMLElement *) const
+    public: const tinyxml2::XMLElement *Enter(
+                const tinyxml2::XMLElement *_xml) const;
+
+    /// \brief Get the next sibling element of an element, with the runs in
+    /// place of their placeholder.
+    /// \param[in] _xml Element of Document() or of a run.
+    /// \return The next element, or nullptr if _xml is the last one.
+    public: tinyxml2::XMLElement *Next(tinyxml2::XMLElement *_xml) const;
+
+    /// \copydoc Next(tinyxml2::XMLElement *) const
+    public: const tinyxml2::XMLElement *Next(
+                const tinyxml2::XMLElement *_xml) const;
+
+    /// \brief Document of the text outside the runs.
+    private: tinyxml2::XMLDocument document;
+
+    /// \brief Documents of the runs, in document order.
+    private: std::vector<std::unique_ptr<tinyxml2::XMLDocument>> runs;
+
+    /// \brief Run of each placeholder of document.
+    private: std::unordered_map<const tinyxml2::XMLElement *,
+                 tinyxml2::XMLDocument *> placeholders;
+
+    /// \brief Placeholder of each run.
+    private: std::unordered_map<const tinyxml2::XMLDocument *,
+                 const tinyxml2::XMLElement *> runPlaceholders;
+  };
+
+  /// \brief Makes the parser read the children of elements through an
+  /// XmlChunks object on the current thread while this scope is alive. The
+  /// previous object is restored when the scope is destroyed.
+  class XmlChunkScope
+  {
+    /// \brief Constructor
+    /// \param[in] _chunks Document parsed in parts, or nullptr for none.
+    public: explicit XmlChunkScope(const XmlChunks *_chunks)
+      : previous(Current())
+    {
+      Current() = _chunks;
+    }
+
+    /// \brief Destructor
+    public: ~XmlChunkScope()
+    {
+      Current() = this->previous;
+    }
+
+    /// \brief Get the document parsed in parts of the current thread.
+    /// \return Reference to the document, which is nullptr when documents
+    /// are parsed as a whole.
+    public: static const XmlChunks *&Current()
+    {
+      static thread_local const XmlChunks *current = nullptr;
+      return current;
+    }
+
+    /// \brief Document that was current before this scope.
+    private: const XmlChunks *previous;
+  };
+  }
+}
+#endif
@@ -0,0 +1,133 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <tinyxml2.h>
+
+#include <string>
+#include <vector>
+
+#include "XmlChunks.hh"
+
+/////////////////////////////////////////////////
+/// \brief Make a world with many models, a light and an unknown element
+/// between runs of them.
+/// \param[in] _version Version of the document.
+/// \return Text of the document.
+static std::string manyModels(const std::string &_version)
+{
+  std::string text = "<?xml version='1.0'?>\n<sdf version='" + _version +
+      "'>\n  <world name='w'>\n    <gravity>0 0 -9.8</gravity>\n";
+  for (int i = 0; i < 3000; ++i)
+  {
+    if (i == 1500)
+      text += "    <!-- middle -->\n    <custom a='>'/>\n";
+    text += "    <model name='m" + std::to_string(i) + "'>\n"
+        "      <pose>" + std::to_string(i) + " 0 0 0 0 0</pose>\n"
+        "      <link name='l'><![CDATA[<not a tag>]]></link>\n"
+        "    </model>\n";
+  }
+  text += "    <light name='lamp' type='point'/>\n  </world>\n</sdf>\n";
+  return text;
+}
+
+/////////////////////////////////////////////////
+/// \brief Get the name of an element followed by its name attribute.
+/// \param[in] _xml Element.
+/// \return Such as "modelm1".
+static std::string nameOf(const tinyxml2::XMLElement *_xml)
+{
+  const char *name = _xml->Attribute("name");
+  return _xml->Name() + std::string(name ? name : "");
+}
+
+/////////////////////////////////////////////////
+TEST(XmlChunks, Parse)
+{
+  const std::string text = manyModels("1.8");
+  tinyxml2::XMLDocument whole;
+  ASSERT_EQ(tinyxml2::XML_SUCCESS, whole.Parse(text.data(), text.size()));
+  std::vector<std::string> expected;
+  std::vector<int> lines;
+  for (const tinyxml2::XMLElement *child = whole.FirstChildElement("sdf")
+           ->FirstChildElement("world")->FirstChildElement();
+       child; child = child->NextSiblingElement())
+  {
+    expected.push_back(nameOf(child));
+    lines.push_back(child->GetLineNum());
+  }
+  ASSERT_EQ(3003u, expected.size());
+
+  sdf::XmlChunks chunks;
+  ASSERT_TRUE(chunks.Parse(text.data(), text.size(), true, 4));
+
+  // The runs stand in for their placeholders, and the elements outside
+  // them keep their lines.
+  const tinyxml2::XMLElement *world =
+      chunks.Document().FirstChildElement("sdf")->FirstChildElement("world");
+  std::vector<std::string> children;
+  std::size_t outside = 0;
+  for (const tinyxml2::XMLElement *child =
+           chunks.Enter(world->FirstChildElement());
+       child; child = chunks.Next(child))
+  {
+    if (child->GetDocument() == &chunks.Document())
+    {
+      EXPECT_EQ(lines[children.size()], child->GetLineNum());
+      ++outside;
+    }
+    children.push_back(nameOf(child));
+  }
+  EXPECT_EQ(expected, children);
+  EXPECT_LT(outside, 100u);
+
+  // Elements outside the worlds are not placeholders.
+  EXPECT_EQ(world, chunks.Enter(world));
+  EXPECT_EQ(nullptr, chunks.Next(chunks.Document().FirstChildElement("sdf")));
+}
+
+/////////////////////////////////////////////////
+TEST(XmlChunks, ParseAsAWhole)
+{
+  const std::string text = manyModels("1.8");
+
+  // A single thread, or a small document.
+  sdf::XmlChunks chunks;
+  EXPECT_FALSE(chunks.Parse(text.data(), text.size(), true, 1));
+  const std::string small =
+      "<sdf version='1.8'><world name='w'><model name='m'/></world></sdf>";
+  EXPECT_FALSE(sdf::XmlChunks().Parse(small.data(), small.size(), true, 4));
+
+  // A document to convert, unless it is read as it is.
+  const std::string old = manyModels("1.6");
+  EXPECT_FALSE(sdf::XmlChunks().Parse(old.data(), old.size(), true, 4));
+  EXPECT_TRUE(sdf::XmlChunks().Parse(old.data(), old.size(), false, 4));
+
+  // Syntax errors in a run or outside the runs.
+  std::string broken = text;
+  broken.replace(broken.find("</model>", text.size() / 4), 8, "</modle>");
+  EXPECT_FALSE(sdf::XmlChunks().Parse(broken.data(), broken.size(), true, 4));
+  broken = text;
+  broken.replace(broken.find("<gravity>"), 9, "<gravity");
+  EXPECT_FALSE(sdf::XmlChunks().Parse(broken.data(), broken.size(), true, 4));
+
+  // Documents that aren't SDFormat.
+  std::string robot = text;
+  robot.replace(robot.find("<sdf"), 4, "<robot");
+  robot.replace(robot.rfind("</sdf>"), 6, "</robot>");
+  EXPECT_FALSE(sdf::XmlChunks().Parse(robot.data(), robot.size(), true, 4));
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_XML_DOCUMENT_SCOPE_HH_
+#define SDF_XML_DOCUMENT_SCOPE_HH_
+
+#include <tinyxml2.h>
+
+#include <utility>
+
+#include "sdf/sdf_config.h"
+
+/// \ingroup sdf_parser
+/// \brief namespace for Simulation Description Format parser
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief Makes the next string read on the current thread while this
+  /// scope is alive parse into a document that the caller keeps, so that
+  /// the memory pools of the document are reused between reads. Only the
+  /// outermost read takes the document, and the previous one is restored
+  /// when the scope is destroyed, so scopes can nest.
+  class XmlDocumentScope
+  {
+    /// \brief Constructor
+    /// \param[in] _doc Document to parse into, or nullptr for none.
+    public: explicit XmlDocumentScope(tinyxml2::XMLDocument *_doc)
+      : previous(std::exchange(Current(), _doc))
+    {
+    }
+
+    /// \brief Destructor
+    public: ~XmlDocumentScope()
+    {
+      Current() = this->previous;
+    }
+
+    /// \brief Take the document of the current thread, so that the reads
+    /// nested in the one that parses into it use documents of their own.
+    /// \return The document, or nullptr if there is none.
+    public: static tinyxml2::XMLDocument *Take()
+    {
+      return std::exchange(Current(), nullptr);
+    }
+
+    /// \brief Get the document of the current thread.
+    /// \return Reference to the document, which is nullptr when reads use
+    /// documents of their own.
+    private: static tinyxml2::XMLDocument *&Current()
+    {
+      static thread_local tinyxml2::XMLDocument *current = nullptr;
+      return current;
+    }
+
+    /// \brief Document that was current before this scope.
+    private: tinyxml2::XMLDocument *previous;
+  };
+  }
+}
+#endif
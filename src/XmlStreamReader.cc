@@ -0,0 +1,500 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "XmlStreamReader.hh"
+
+using namespace sdf;
+
+/////////////////////////////////////////////////
+/// \brief Check whether a character is XML white space.
+/// \param[in] _c Character to check.
+/// \return True for a space, tab, line feed or carriage return.
+static bool isSpace(char _c)
+{
+  return _c == ' ' || _c == '\t' || _c == '\n' || _c == '\r';
+}
+
+/////////////////////////////////////////////////
+/// \brief Find a string in a range of characters.
+/// \param[in] _begin First character of the range.
+/// \param[in] _end One past the last character of the range.
+/// \param[in] _str Null terminated string to find.
+/// \return Pointer to the first occurrence, or nullptr.
+static const char *findString(const char *_begin, const char *_end,
+    const char *_str)
+{
+  const char *strEnd = _str + std::strlen(_str);
+  const char *found = std::search(_begin, _end, _str, strEnd);
+  return found == _end ? nullptr : found;
+}
+
+/////////////////////////////////////////////////
+/// \brief Append a code point to a string, encoded as UTF-8.
+/// \param[in] _code Code point.
+/// \param[out] _out String to append to.
+static void appendUtf8(unsigned long _code, std::string &_out)
+{
+  if (_code < 0x80)
+  {
+    _out += static_cast<char>(_code);
+  }
+  else if (_code < 0x800)
+  {
+    _out += static_cast<char>(0xC0 | (_code >> 6));
+    _out += static_cast<char>(0x80 | (_code & 0x3F));
+  }
+  else if (_code < 0x10000)
+  {
+    _out += static_cast<char>(0xE0 | (_code >> 12));
+    _out += static_cast<char>(0x80 | ((_code >> 6) & 0x3F));
+    _out += static_cast<char>(0x80 | (_code & 0x3F));
+  }
+  else
+  {
+    _out += static_cast<char>(0xF0 | (_code >> 18));
+    _out += static_cast<char>(0x80 | ((_code >> 12) & 0x3F));
+    _out += static_cast<char>(0x80 | ((_code >> 6) & 0x3F));
+    _out += static_cast<char>(0x80 | (_code & 0x3F));
+  }
+}
+
+/////////////////////////////////////////////////
+XmlStreamReader::XmlStreamReader(const char *_data, std::size_t _size)
+  : pos(_data), end(_data + _size), begin(_data), tag(_data)
+{
+}
+
+/////////////////////////////////////////////////
+XmlStreamReader::Token XmlStreamReader::Next()
+{
+  if (this->stopped)
+    return this->stopToken;
+
+  this->textAllowed = false;
+  if (this->pendingEnd)
+  {
+    this->pendingEnd = false;
+    this->name = std::move(this->open.back());
+    this->open.pop_back();
+    if (this->open.empty())
+      this->stopped = true;
+    return Token::END;
+  }
+
+  while (true)
+  {
+    // Text outside of the text of a start tag is not reported.
+    const char *markup = static_cast<const char *>(
+        std::memchr(this->pos, '<', this->end - this->pos));
+    if (!markup)
+    {
+      this->pos = this->end;
+      if (!this->open.empty())
+        return this->Fail("Element <" + this->open.back() + "> is not closed");
+      this->stopped = true;
+      return Token::END_OF_DOCUMENT;
+    }
+
+    this->pos = markup + 1;
+    if (this->pos == this->end)
+      return this->Fail("Unexpected end of document");
+
+    if (*this->pos == '/')
+    {
+      this->tag = markup;
+      ++this->pos;
+      return this->ReadEndTag();
+    }
+
+    if (*this->pos == '!' || *this->pos == '?')
+    {
+      if (!this->SkipMarkup())
+        return this->Fail("Unterminated markup");
+      continue;
+    }
+
+    this->tag = markup;
+    return this->ReadStartTag();
+  }
+}
+
+/////////////////////////////////////////////////
+bool XmlStreamReader::ReadText(std::string &_text)
+{
+  _text.clear();
+  if (!this->textAllowed)
+    return false;
+  this->textAllowed = false;
+
+  const char *markup = static_cast<const char *>(
+      std::memchr(this->pos, '<', this->end - this->pos));
+  const char *textEnd = markup ? markup : this->end;
+  const bool blank = std::all_of(this->pos, textEnd, isSpace);
+  if (!blank)
+  {
+    AppendDecoded(this->pos, textEnd, _text);
+    this->pos = textEnd;
+    return true;
+  }
+  this->pos = textEnd;
+
+  // White space is dropped, so a CDATA section that follows it is the
+  // text of the element.
+  static const char cdataStart[] = "<![CDATA[";
+  const std::size_t cdataLength = sizeof(cdataStart) - 1;
+  if (static_cast<std::size_t>(this->end - this->pos) > cdataLength &&
+      std::memcmp(this->pos, cdataStart, cdataLength) == 0)
+  {
+    const char *content = this->pos + cdataLength;
+    const char *close = findString(content, this->end, "]]>");
+    if (close)
+    {
+      _text.assign(content, close);
+      this->pos = close + 3;
+      return true;
+    }
+  }
+  return false;
+}
+
+/////////////////////////////////////////////////
+bool XmlStreamReader::SkipElement()
+{
+  const std::size_t depth = this->open.size();
+  while (true)
+  {
+    const Token token = this->Next();
+    if (token == Token::MALFORMED)
+      return false;
+    if (token != Token::START && this->open.size() < depth)
+      return true;
+  }
+}
+
+/////////////////////////////////////////////////
+tinyxml2::XMLElement *XmlStreamReader::ReadElement(
+    tinyxml2::XMLDocument &_doc)
+{
+  std::string text;
+  auto newElement = [&]()
+  {
+    tinyxml2::XMLElement *elem = _doc.NewElement(this->name.c_str());
+    for (const auto &attribute : this->attributes)
+      elem->SetAttribute(attribute.first.c_str(), attribute.second.c_str());
+    if (this->ReadText(text))
+      elem->InsertEndChild(_doc.NewText(text.c_str()));
+    return elem;
+  };
+
+  tinyxml2::XMLElement *root = newElement();
+  std::vector<tinyxml2::XMLElement *> stack{root};
+  while (true)
+  {
+    const Token token = this->Next();
+    if (token == Token::START)
+    {
+      tinyxml2::XMLElement *elem = newElement();
+      stack.back()->InsertEndChild(elem);
+      stack.push_back(elem);
+    }
+    else if (token == Token::END)
+    {
+      stack.pop_back();
+      if (stack.empty())
+        return root;
+    }
+    else
+    {
+      _doc.DeleteNode(root);
+      return nullptr;
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+const std::string &XmlStreamReader::Name() const
+{
+  return this->name;
+}
+
+/////////////////////////////////////////////////
+const std::vector<std::pair<std::string, std::string>> &
+XmlStreamReader::Attributes() const
+{
+  return this->attributes;
+}
+
+/////////////////////////////////////////////////
+const char *XmlStreamReader::Attribute(const std::string &_name) const
+{
+  for (const auto &attribute : this->attributes)
+  {
+    if (attribute.first == _name)
+      return attribute.second.c_str();
+  }
+  return nullptr;
+}
+
+/////////////////////////////////////////////////
+std::size_t XmlStreamReader::Depth() const
+{
+  return this->open.size();
+}
+
+/////////////////////////////////////////////////
+std::size_t XmlStreamReader::TagOffset() const
+{
+  return static_cast<std::size_t>(this->tag - this->begin);
+}
+
+/////////////////////////////////////////////////
+std::size_t XmlStreamReader::Offset() const
+{
+  return static_cast<std::size_t>(this->pos - this->begin);
+}
+
+/////////////////////////////////////////////////
+const std::string &XmlStreamReader::Error() const
+{
+  return this->error;
+}
+
+/////////////////////////////////////////////////
+XmlStreamReader::Token XmlStreamReader::Fail(const std::string &_message)
+{
+  const long line = 1 + std::count(this->begin, this->pos, '\n');
+  this->error = _message + " at line " + std::to_string(line);
+  this->stopped = true;
+  this->stopToken = Token::MALFORMED;
+  return Token::MALFORMED;
+}
+
+/////////////////////////////////////////////////
+bool XmlStreamReader::SkipMarkup()
+{
+  const char *close = nullptr;
+  if (*this->pos == '?')
+  {
+    close = findString(this->pos, this->end, "?>");
+    if (close)
+      close += 2;
+  }
+  else if (findString(this->pos, std::min(this->pos + 3, this->end), "!--"))
+  {
+    close = findString(this->pos + 3, this->end, "-->");
+    if (close)
+      close += 3;
+  }
+  else if (findString(this->pos, std::min(this->pos + 8, this->end),
+               "![CDATA["))
+  {
+    close = findString(this->pos + 8, this->end, "]]>");
+    if (close)
+      close += 3;
+  }
+  else
+  {
+    // A document type declaration, which may have an internal subset in
+    // square brackets.
+    int brackets = 0;
+    for (const char *c = this->pos; c < this->end; ++c)
+    {
+      if (*c == '[')
+        ++brackets;
+      else if (*c == ']')
+        --brackets;
+      else if (*c == '>' && brackets <= 0)
+      {
+        close = c + 1;
+        break;
+      }
+    }
+  }
+
+  if (!close)
+    return false;
+  this->pos = close;
+  return true;
+}
+
+/////////////////////////////////////////////////
+XmlStreamReader::Token XmlStreamReader::ReadStartTag()
+{
+  this->attributes.clear();
+  if (!this->ReadName(this->name))
+    return this->Fail("Malformed start tag");
+
+  while (true)
+  {
+    while (this->pos < this->end && isSpace(*this->pos))
+      ++this->pos;
+    if (this->pos == this->end)
+      return this->Fail("Unterminated start tag <" + this->name + ">");
+
+    if (*this->pos == '>')
+    {
+      ++this->pos;
+      this->open.push_back(this->name);
+      this->textAllowed = true;
+      return Token::START;
+    }
+
+    if (*this->pos == '/')
+    {
+      if (this->pos + 1 == this->end || this->pos[1] != '>')
+        return this->Fail("Malformed start tag <" + this->name + ">");
+      this->pos += 2;
+      this->open.push_back(this->name);
+      this->pendingEnd = true;
+      return Token::START;
+    }
+
+    std::string attributeName;
+    if (!this->ReadName(attributeName))
+      return this->Fail("Malformed attribute in element <" + this->name + ">");
+    while (this->pos < this->end && isSpace(*this->pos))
+      ++this->pos;
+    if (this->pos == this->end || *this->pos != '=')
+    {
+      return this->Fail("Attribute [" + attributeName + "] of element <" +
+          this->name + "> has no value");
+    }
+    ++this->pos;
+    while (this->pos < this->end && isSpace(*this->pos))
+      ++this->pos;
+    if (this->pos == this->end || (*this->pos != '"' && *this->pos != '\''))
+    {
+      return this->Fail("Value of attribute [" + attributeName +
+          "] of element <" + this->name + "> is not quoted");
+    }
+
+    const char quote = *this->pos++;
+    const char *close = static_cast<const char *>(
+        std::memchr(this->pos, quote, this->end - this->pos));
+    if (!close)
+      return this->Fail("Unterminated attribute [" + attributeName + "]");
+
+    std::string value;
+    AppendDecoded(this->pos, close, value);
+    this->pos = close + 1;
+    this->attributes.emplace_back(std::move(attributeName), std::move(value));
+  }
+}
+
+/////////////////////////////////////////////////
+XmlStreamReader::Token XmlStreamReader::ReadEndTag()
+{
+  if (!this->ReadName(this->name))
+    return this->Fail("Malformed end tag");
+  while (this->pos < this->end && isSpace(*this->pos))
+    ++this->pos;
+  if (this->pos == this->end || *this->pos != '>')
+    return this->Fail("Malformed end tag </" + this->name + ">");
+  ++this->pos;
+
+  if (this->open.empty() || this->open.back() != this->name)
+    return this->Fail("Mismatched end tag </" + this->name + ">");
+  this->open.pop_back();
+  if (this->open.empty())
+    this->stopped = true;
+  return Token::END;
+}
+
+/////////////////////////////////////////////////
+bool XmlStreamReader::ReadName(std::string &_name)
+{
+  const char *start = this->pos;
+  while (this->pos < this->end && !isSpace(*this->pos) &&
+         *this->pos != '/' && *this->pos != '>' && *this->pos != '=')
+  {
+    ++this->pos;
+  }
+  _name.assign(start, this->pos);
+  return !_name.empty();
+}
+
+/////////////////////////////////////////////////
+void XmlStreamReader::AppendDecoded(const char *_begin, const char *_end,
+    std::string &_out)
+{
+  const char *run = _begin;
+  for (const char *c = _begin; c < _end; ++c)
+  {
+    if (*c != '&' && *c != '\r')
+      continue;
+
+    _out.append(run, c);
+    run = c + 1;
+
+    // Line endings are normalized to line feeds.
+    if (*c == '\r')
+    {
+      _out += '\n';
+      if (c + 1 < _end && c[1] == '\n')
+        run = ++c + 1;
+      continue;
+    }
+
+    // Unknown or unterminated entities are kept as they are.
+    const char *semicolon = static_cast<const char *>(
+        std::memchr(c, ';', std::min<std::ptrdiff_t>(_end - c, 12)));
+    if (!semicolon)
+    {
+      _out += '&';
+      continue;
+    }
+
+    const std::string entity(c + 1, semicolon);
+    if (entity == "lt")
+      _out += '<';
+    else if (entity == "gt")
+      _out += '>';
+    else if (entity == "amp")
+      _out += '&';
+    else if (entity == "quot")
+      _out += '"';
+    else if (entity == "apos")
+      _out += '\'';
+    else if (entity.size() > 1 && entity[0] == '#')
+    {
+      const bool hex = entity[1] == 'x';
+      const std::string digits = entity.substr(hex ? 2 : 1);
+      char *digitsEnd = nullptr;
+      const unsigned long code =
+          std::strtoul(digits.c_str(), &digitsEnd, hex ? 16 : 10);
+      if (digits.empty() || *digitsEnd != '\0')
+      {
+        _out += '&';
+        continue;
+      }
+      appendUtf8(code, _out);
+    }
+    else
+    {
+      _out += '&';
+      continue;
+    }
+    c = semicolon;
+    run = c + 1;
+  }
+  _out.append(run, _end);
+}
@@ -0,0 +1,196 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_XML_STREAM_READER_HH_
+#define SDF_XML_STREAM_READER_HH_
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <tinyxml2.h>
+
+#include "sdf/sdf_config.h"
+
+namespace sdf
+{
+  // Inline bracket to help doxygen filtering.
+  inline namespace SDF_VERSION_NAMESPACE {
+  //
+
+  /// \brief Pull tokenizer of an XML document held in memory, such as a
+  /// MappedFile, which reports elements one tag at a time instead of
+  /// building a DOM of the whole document.
+  ///
+  /// The XML declaration, processing instructions, comments and document
+  /// type declarations are skipped. Entities in attribute values and text
+  /// are expanded, as tinyxml2 does. Only the text that directly follows a
+  /// start tag is reported, through ReadText, which is what
+  /// tinyxml2::XMLElement::GetText returns.
+  class XmlStreamReader
+  {
+    /// \brief Kind of token returned by Next.
+    public: enum class Token
+    {
+      /// \brief A start tag. Name and Attributes describe it.
+      START,
+
+      /// \brief The end of the element of the last open start tag,
+      /// including that of an empty element tag such as <a/>.
+      END,
+
+      /// \brief All elements are closed, or there is no root element.
+      END_OF_DOCUMENT,
+
+      /// \brief The XML is malformed. Error describes why.
+      MALFORMED
+    };
+
+    /// \brief Constructor
+    /// \param[in] _data Content of the document. It must outlive the reader.
+    /// \param[in] _size Size of the content in bytes.
+    public: XmlStreamReader(const char *_data, std::size_t _size);
+
+    /// \brief Read the next tag.
+    /// \return Kind of the tag read. Once the root element is closed, or on
+    /// an error, the same token is returned again.
+    public: Token Next();
+
+    /// \brief Read the text that directly follows the last start tag, if
+    /// any. Text that is only white space is not reported, and nor is text
+    /// after a comment or a child element.
+    /// \param[out] _text Set to the text, with entities expanded.
+    /// \return True if there was text.
+    public: bool ReadText(std::string &_text);
+
+    /// \brief Skip the element of the last start tag, up to and including
+    /// its end tag.
+    /// \return False on an error.
+    public: bool SkipElement();
+
+    /// \brief Read the element of the last start tag, with all its
+    /// descendants and up to and including its end tag, into a tinyxml2
+    /// element.
+    /// \param[in,out] _doc Document the new nodes are created in.
+    /// \return The new element, which is not yet part of _doc, or nullptr
+    /// on an error. It must be inserted in the document or deleted with
+    /// tinyxml2::XMLDocument::DeleteNode.
+    public: tinyxml2::XMLElement *ReadElement(tinyxml2::XMLDocument &_doc);
+
+    /// \brief Get the name of the element of the last START or END token.
+    /// \return Element name.
+    public: const std::string &Name() const;
+
+    /// \brief Get the attributes of the last start tag, in document order.
+    /// \return Pairs of attribute names and values.
+    public: const std::vector<std::pair<std::string, std::string>> &
+            Attributes() const;
+
+    /// \brief Get the value of an attribute of the last start tag.
+    /// \param[in] _name Name of the attribute.
+    /// \return Value of the attribute, or nullptr if it is not set.
+    public: const char *Attribute(const std::string &_name) const;
+
+    /// \brief Get the number of elements that are open.
+    /// \return Depth of the last start tag, 1 for the root element.
+    public: std::size_t Depth() const;
+
+    /// \brief Get the offset of the '<' that starts the last start tag or
+    /// end tag, from the start of the content.
+    /// \return Offset in bytes.
+    public: std::size_t TagOffset() const;
+
+    /// \brief Get the offset of the current position, which is just past
+    /// the last tag after Next, or past the text after ReadText.
+    /// \return Offset in bytes from the start of the content.
+    public: std::size_t Offset() const;
+
+    /// \brief Get the description of the error after a MALFORMED token.
+    /// \return Error message, with the line it was found on.
+    public: const std::string &Error() const;
+
+    /// \brief Set the error and stop reading.
+    /// \param[in] _message Description of the error.
+    /// \return Token::MALFORMED.
+    private: Token Fail(const std::string &_message);
+
+    /// \brief Skip a comment, processing instruction, CDATA section or
+    /// document type declaration at the current position.
+    /// \return False if the markup is not terminated.
+    private: bool SkipMarkup();
+
+    /// \brief Read a start tag at the current position, after its '<'.
+    /// \return START, or MALFORMED.
+    private: Token ReadStartTag();
+
+    /// \brief Read an end tag at the current position, after its "</".
+    /// \return END, or MALFORMED.
+    private: Token ReadEndTag();
+
+    /// \brief Read a name at the current position.
+    /// \param[out] _name Set to the name.
+    /// \return False if there is no name.
+    private: bool ReadName(std::string &_name);
+
+    /// \brief Append a range of characters to a string, expanding entities.
+    /// \param[in] _begin First character.
+    /// \param[in] _end One past the last character.
+    /// \param[out] _out String to append to.
+    private: static void AppendDecoded(const char *_begin, const char *_end,
+                                       std::string &_out);
+
+    /// \brief Current position.
+    private: const char *pos;
+
+    /// \brief End of the content.
+    private: const char *end;
+
+    /// \brief Start of the content, to compute line numbers.
+    private: const char *begin;
+
+    /// \brief The '<' of the last start or end tag.
+    private: const char *tag;
+
+    /// \brief Names of the open elements.
+    private: std::vector<std::string> open;
+
+    /// \brief Name of the last start or end tag.
+    private: std::string name;
+
+    /// \brief Attributes of the last start tag.
+    private: std::vector<std::pair<std::string, std::string>> attributes;
+
+    /// \brief True if the last start tag was an empty element tag, whose
+    /// END token is still to be returned.
+    private: bool pendingEnd = false;
+
+    /// \brief True right after a start tag, while its text can still be
+    /// read.
+    private: bool textAllowed = false;
+
+    /// \brief True once the document is finished or an error was found.
+    private: bool stopped = false;
+
+    /// \brief Token returned again once stopped.
+    private: Token stopToken = Token::END_OF_DOCUMENT;
+
+    /// \brief Error message.
+    private: std::string error;
+  };
+  }
+}
+#endif
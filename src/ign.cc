@@ -15,28 +15,56 @@
  *
 */
 
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
 #include <cstring>
 #include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
 #include <string.h>
 
 #include "sdf/sdf_config.h"
 #include "sdf/Filesystem.hh"
+#include "sdf/LoadStats.hh"
+#include "sdf/ParserConfig.hh"
 #include "sdf/Root.hh"
+#include "sdf/SchemaValidator.hh"
 #include "sdf/parser.hh"
 #include "sdf/system_util.hh"
 
-#include "FrameSemantics.hh"
-#include "ScopedGraph.hh"
+#include "LoadStatsScope.hh"
+#include "Utils.hh"
 #include "ign.hh"
 
 //////////////////////////////////////////////////
-// cppcheck-suppress unusedFunction
-extern "C" SDFORMAT_VISIBLE int cmdCheck(const char *_path)
+/// \brief Check a file. The file is parsed once by Root::Load, and the
+/// checks reuse its element tree and frame graphs.
+/// \param[in] _path Path to the file to validate.
+/// \param[in] _time True to print the time spent in each phase.
+/// \param[in] _profile True to also print the calls and time of the Load
+/// function of each DOM class.
+/// \return Zero on success, negative one otherwise.
+static int checkFile(const char *_path, bool _time, bool _profile = false)
 {
+  if (!sdf::filesystem::exists(_path))
+  {
+    std::cerr << "Error: File [" << _path << "] does not exist.\n";
+    return -1;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  sdf::LoadStats stats;
+  sdf::ParserConfig config;
+  if (_time)
+    config.SetStats(&stats);
+  stats.SetDomProfiling(_profile);
+
   int result = 0;
 
   sdf::Root root;
-  sdf::Errors errors = root.Load(_path);
+  sdf::Errors errors = root.Load(_path, config);
   if (!errors.empty())
   {
     for (auto &error : errors)
@@ -46,56 +74,246 @@ extern "C" SDFORMAT_VISIBLE int cmdCheck(const char *_path)
     return -1;
   }
 
-  if (!sdf::checkCanonicalLinkNames(&root))
+  const auto checkStart = std::chrono::steady_clock::now();
+  {
+    sdf::LoadStatsScope statsScope(config);
+    std::vector<std::string> failed;
+    if (!sdf::checkRoot(&root, 0, failed))
+    {
+      result = -1;
+    }
+  }
+  const auto end = std::chrono::steady_clock::now();
+
+  if (result == 0)
+  {
+    std::cout << "Valid.\n";
+  }
+
+  if (_time)
   {
-    result = -1;
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+    std::cout << stats
+              << "checks: " << Milliseconds(end - checkStart).count()
+              << " ms\n"
+              << "total: " << Milliseconds(end - start).count() << " ms\n";
   }
+  return result;
+}
+
+//////////////////////////////////////////////////
+// cppcheck-suppress unusedFunction
+extern "C" SDFORMAT_VISIBLE int cmdCheck(const char *_path)
+{
+  return checkFile(_path, false);
+}
+
+//////////////////////////////////////////////////
+// cppcheck-suppress unusedFunction
+extern "C" SDFORMAT_VISIBLE int cmdCheckTimed(const char *_path)
+{
+  return checkFile(_path, true);
+}
+
+//////////////////////////////////////////////////
+// cppcheck-suppress unusedFunction
+extern "C" SDFORMAT_VISIBLE int cmdCheckProfiled(const char *_path)
+{
+  return checkFile(_path, true, true);
+}
 
-  if (!sdf::checkJointParentChildLinkNames(&root))
+//////////////////////////////////////////////////
+// cppcheck-suppress unusedFunction
+extern "C" SDFORMAT_VISIBLE int cmdCheckSchema(const char *_path)
+{
+  if (!sdf::filesystem::exists(_path))
   {
-    result = -1;
+    std::cerr << "Error: File [" << _path << "] does not exist.\n";
+    return -1;
   }
 
-  if (!sdf::checkFrameAttachedToGraph(&root))
+  // The schema is checked first, since its errors carry the line of each
+  // element.
+  const sdf::Errors errors = sdf::SchemaValidator().ValidateFile(_path);
+  if (!errors.empty())
   {
-    result = -1;
+    for (auto &error : errors)
+    {
+      std::cerr << "Error: " << error.Message() << std::endl;
+    }
+    return -1;
   }
+  return checkFile(_path, false);
+}
 
-  if (!sdf::checkPoseRelativeToGraph(&root))
+//////////////////////////////////////////////////
+/// \brief Quote a string as a JSON string literal.
+/// \param[in] _str String to quote.
+/// \return The quoted string.
+static std::string jsonString(const std::string &_str)
+{
+  std::string result = "\"";
+  for (const char c : _str)
   {
-    result = -1;
+    switch (c)
+    {
+      case '"': result += "\\\""; break;
+      case '\\': result += "\\\\"; break;
+      case '\n': result += "\\n"; break;
+      case '\r': result += "\\r"; break;
+      case '\t': result += "\\t"; break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20)
+        {
+          char escaped[8];
+          std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+          result += escaped;
+        }
+        else
+        {
+          result += c;
+        }
+    }
   }
+  return result + "\"";
+}
 
-  if (!sdf::recursiveSiblingUniqueNames(root.Element()))
+//////////////////////////////////////////////////
+/// \brief Check if a file should be checked when found in a directory.
+/// \param[in] _path Path of the file.
+/// \return True for .sdf, .world and .urdf files.
+static bool isBatchFile(const std::string &_path)
+{
+  for (const char *extension : {".sdf", ".world", ".urdf"})
   {
-    result = -1;
+    const std::size_t length = std::strlen(extension);
+    if (_path.size() > length &&
+        _path.compare(_path.size() - length, length, extension) == 0)
+    {
+      return true;
+    }
   }
+  return false;
+}
 
-  if (!sdf::filesystem::exists(_path))
+//////////////////////////////////////////////////
+/// \brief Add the files to check in a directory and its subdirectories.
+/// \param[in] _dir The directory.
+/// \param[in,out] _files Files are appended to this vector.
+static void findBatchFiles(const std::string &_dir,
+    std::vector<std::string> &_files)
+{
+  sdf::filesystem::DirIter endIter;
+  for (sdf::filesystem::DirIter dirIter(_dir); dirIter != endIter; ++dirIter)
   {
-    std::cerr << "Error: File [" << _path << "] does not exist.\n";
-    return -1;
+    const std::string path = *dirIter;
+    if (sdf::filesystem::is_directory(path))
+      findBatchFiles(path, _files);
+    else if (isBatchFile(path))
+      _files.push_back(path);
   }
+}
 
-  sdf::SDFPtr sdf(new sdf::SDF());
+//////////////////////////////////////////////////
+// cppcheck-suppress unusedFunction
+extern "C" SDFORMAT_VISIBLE int cmdCheckBatch(const char *_paths,
+    int _threadCount)
+{
+  using Milliseconds = std::chrono::duration<double, std::milli>;
+  const auto start = std::chrono::steady_clock::now();
+
+  std::vector<std::string> files;
+  std::istringstream paths(_paths);
+  for (std::string path; std::getline(paths, path);)
+  {
+    if (path.empty())
+      continue;
 
+    if (sdf::filesystem::is_directory(path))
+    {
+      std::vector<std::string> found;
+      findBatchFiles(path, found);
+      std::sort(found.begin(), found.end());
+      files.insert(files.end(), found.begin(), found.end());
+    }
+    else
+    {
+      files.push_back(path);
+    }
+  }
+
+  // Parse the spec once, so that the threads share its description.
+  sdf::SDFPtr sdf(new sdf::SDF());
   if (!sdf::init(sdf))
   {
     std::cerr << "Error: SDF schema initialization failed.\n";
     return -1;
   }
 
-  if (!sdf::readFile(_path, sdf))
+  /// \brief Outcome of checking one file.
+  struct Result
   {
-    std::cerr << "Error: SDF parsing the xml failed.\n";
-    return -1;
-  }
+    std::vector<std::string> errors;
+    double milliseconds = 0;
+  };
+
+  std::vector<Result> results(files.size());
+  sdf::parallelFor(files.size(),
+      static_cast<unsigned int>(std::max(_threadCount, 0)),
+      [&](std::size_t _index)
+  {
+    const auto fileStart = std::chrono::steady_clock::now();
+    Result &result = results[_index];
 
-  if (result == 0)
+    sdf::Root root;
+    if (!sdf::filesystem::exists(files[_index]))
+    {
+      result.errors.push_back(
+          "File [" + files[_index] + "] does not exist.");
+    }
+    else
+    {
+      for (const auto &error : root.Load(files[_index]))
+        result.errors.push_back(error.Message());
+    }
+
+    if (result.errors.empty())
+    {
+      std::vector<std::string> failed;
+      sdf::checkRoot(&root, 1, failed);
+      for (const auto &check : failed)
+        result.errors.push_back(check + " failed");
+    }
+
+    result.milliseconds =
+        Milliseconds(std::chrono::steady_clock::now() - fileStart).count();
+  });
+
+  std::size_t invalid = 0;
+  for (std::size_t i = 0; i < files.size(); ++i)
   {
-    std::cout << "Valid.\n";
+    const Result &result = results[i];
+    invalid += result.errors.empty() ? 0 : 1;
+
+    std::cout << "{\"file\": " << jsonString(files[i])
+              << ", \"valid\": " << (result.errors.empty() ? "true" : "false")
+              << ", \"milliseconds\": " << result.milliseconds
+              << ", \"errors\": [";
+    for (std::size_t e = 0; e < result.errors.size(); ++e)
+    {
+      std::cout << (e > 0 ? ", " : "") << jsonString(result.errors[e]);
+    }
+    std::cout << "]}\n";
   }
-  return result;
+
+  std::cout << "{\"files\": " << files.size()
+            << ", \"valid\": " << files.size() - invalid
+            << ", \"invalid\": " << invalid
+            << ", \"milliseconds\": "
+            << Milliseconds(std::chrono::steady_clock::now() - start).count()
+            << "}\n";
+
+  return invalid == 0 ? 0 : -1;
 }
 
 //////////////////////////////////////////////////
@@ -163,8 +381,8 @@ extern "C" SDFORMAT_VISIBLE int cmdPrint(const char *_path)
 
 //////////////////////////////////////////////////
 // cppcheck-suppress unusedFunction
-extern "C" SDFORMAT_VISIBLE int cmdGraph(
-    const char *_graphType, const char *_path)
+extern "C" SDFORMAT_VISIBLE int cmdGraphScoped(const char *_graphType,
+    const char *_path, const char *_model, int _depth)
 {
   if (!sdf::filesystem::exists(_path))
   {
@@ -172,6 +390,16 @@ extern "C" SDFORMAT_VISIBLE int cmdGraph(
     return -1;
   }
 
+  const bool pose = std::strcmp(_graphType, "pose") == 0;
+  if (!pose && std::strcmp(_graphType, "frame") != 0)
+  {
+    std::cerr << R"(Only "pose" and "frame" graph types are supported)"
+              << std::endl;
+    return 0;
+  }
+
+  // The graphs built by Root::Load are written as they are, rather than
+  // being built again.
   sdf::Root root;
   sdf::Errors errors = root.Load(_path);
   if (!errors.empty())
@@ -179,49 +407,27 @@ extern "C" SDFORMAT_VISIBLE int cmdGraph(
     std::cerr << errors << std::endl;
   }
 
-  if (std::strcmp(_graphType, "pose") == 0)
-  {
-    auto ownedGraph = std::make_shared<sdf::PoseRelativeToGraph>();
-    sdf::ScopedGraph<sdf::PoseRelativeToGraph> graph(ownedGraph);
-    if (root.WorldCount() > 0)
-    {
-      errors = sdf::buildPoseRelativeToGraph(graph, root.WorldByIndex(0));
-    }
-    else if (root.ModelCount() > 0)
-    {
-      errors = sdf::buildPoseRelativeToGraph(graph, root.ModelByIndex(0));
-    }
-
-    if (!errors.empty())
-    {
-      std::cerr << errors << std::endl;
-    }
-    std::cout << graph.Graph() << std::endl;
-  }
-  else if (std::strcmp(_graphType, "frame") == 0)
-  {
-    auto ownedGraph = std::make_shared<sdf::FrameAttachedToGraph>();
-    sdf::ScopedGraph<sdf::FrameAttachedToGraph> graph(ownedGraph);
-    if (root.WorldCount() > 0)
-    {
-      errors = sdf::buildFrameAttachedToGraph(graph, root.WorldByIndex(0));
-    }
-    else if (root.ModelCount() > 0)
-    {
-      errors = sdf::buildFrameAttachedToGraph(graph, root.ModelByIndex(0));
-    }
-
-    if (!errors.empty())
-    {
-      std::cerr << errors << std::endl;
-    }
-    std::cout << graph.Graph() << std::endl;
-  }
-  else
+  const std::string model = _model ? _model : "";
+  const bool written = pose ?
+      sdf::writePoseRelativeToGraph(&root, std::cout, model, _depth) :
+      sdf::writeFrameAttachedToGraph(&root, std::cout, model, _depth);
+  std::cout.flush();
+  if (!written)
   {
-    std::cerr << R"(Only "pose" and "frame" graph types are supported)"
-              << std::endl;
+    if (model.empty())
+      std::cerr << "Error: File [" << _path << "] has no graph.\n";
+    else
+      std::cerr << "Error: Model [" << model << "] is not in the graph.\n";
+    return -1;
   }
 
   return 0;
 }
+
+//////////////////////////////////////////////////
+// cppcheck-suppress unusedFunction
+extern "C" SDFORMAT_VISIBLE int cmdGraph(
+    const char *_graphType, const char *_path)
+{
+  return cmdGraphScoped(_graphType, _path, "", -1);
+}
@@ -32,6 +32,28 @@ inline namespace SDF_VERSION_NAMESPACE {
 /// \return Zero on success, negative one otherwise.
 extern "C" SDFORMAT_VISIBLE int cmdCheck(const char *_path);
 
+/// \brief External hook to execute 'ign sdf -k --time' from the command
+/// line. Like cmdCheck, and prints the time spent in each LoadPhase, in
+/// the checks and in total.
+/// \param[in] _path Path to the file to validate.
+/// \return Zero on success, negative one otherwise.
+extern "C" SDFORMAT_VISIBLE int cmdCheckTimed(const char *_path);
+
+/// \brief External hook to execute 'ign sdf --check-batch' from the command
+/// line. Runs the checks of cmdCheck on many files in parallel, and prints
+/// one JSON object per line for each file, with its path, validity, check
+/// time in milliseconds and errors, followed by a summary object with the
+/// number of files, valid files, invalid files and the total time. The
+/// details of failed checks are printed to stderr.
+/// \param[in] _paths Newline separated paths of files to validate, or of
+/// directories that are searched recursively for .sdf, .world and .urdf
+/// files.
+/// \param[in] _threadCount Maximum number of threads, or 0 to use one
+/// thread per hardware thread.
+/// \return Zero if all files are valid, negative one otherwise.
+extern "C" SDFORMAT_VISIBLE int cmdCheckBatch(const char *_paths,
+    int _threadCount);
+
 /// \brief External hook to read the library version.
 /// \return C-string representing the version. Ex.: 0.1.2
 extern "C" SDFORMAT_VISIBLE char *ignitionVersion();
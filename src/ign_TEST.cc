@@ -809,6 +809,87 @@ TEST(check, SDF)
   }
 }
 
+/////////////////////////////////////////////////
+TEST(check, Time)
+{
+  std::string path = PROJECT_SOURCE_PATH;
+  path += "/test/sdf/box_plane_low_friction_test.world";
+
+  std::string output =
+    custom_exec_str(g_ignCommand + " sdf -k " + path + " --time" +
+        g_sdfVersion);
+  EXPECT_EQ(0u, output.find("Valid.\n")) << output;
+  EXPECT_NE(output.find("xml_parse: "), std::string::npos) << output;
+  EXPECT_NE(output.find("dom_load: "), std::string::npos) << output;
+  EXPECT_NE(output.find("\nchecks: "), std::string::npos) << output;
+  EXPECT_NE(output.find("\ntotal: "), std::string::npos) << output;
+}
+
+/////////////////////////////////////////////////
+TEST(check, Profile)
+{
+  std::string path = PROJECT_SOURCE_PATH;
+  path += "/test/sdf/box_plane_low_friction_test.world";
+
+  std::string output =
+    custom_exec_str(g_ignCommand + " sdf -k " + path + " --profile" +
+        g_sdfVersion);
+  EXPECT_EQ(0u, output.find("Valid.\n")) << output;
+  EXPECT_NE(output.find("dom_load: "), std::string::npos) << output;
+  EXPECT_NE(output.find("\ndom World: "), std::string::npos) << output;
+  EXPECT_NE(output.find("\ndom Link: "), std::string::npos) << output;
+  EXPECT_NE(output.find(" ms self, "), std::string::npos) << output;
+}
+
+/////////////////////////////////////////////////
+TEST(check, Schema)
+{
+  std::string path = PROJECT_SOURCE_PATH;
+  path += "/test/sdf/box_plane_low_friction_test.world";
+
+  std::string output =
+    custom_exec_str(g_ignCommand + " sdf -k " + path + " --schema" +
+        g_sdfVersion);
+  EXPECT_EQ(0u, output.find("Valid.\n")) << output;
+
+  // The parser only warns about the <environment_map> of the specular
+  // workflow, which is not in the spec.
+  path = PROJECT_SOURCE_PATH;
+  path += "/test/sdf/material_pbr.sdf";
+  output = custom_exec_str(g_ignCommand + " sdf -k " + path + " --schema" +
+      g_sdfVersion);
+  EXPECT_NE(output.find("Error: /sdf/model/link/visual/material/pbr/"
+      "specular (line "), std::string::npos) << output;
+  EXPECT_NE(output.find("Element <environment_map> is not defined"),
+      std::string::npos) << output;
+}
+
+/////////////////////////////////////////////////
+TEST(check, Batch)
+{
+  std::string pathBase = PROJECT_SOURCE_PATH;
+  pathBase += "/test/sdf";
+  const std::string good = pathBase + "/box_plane_low_friction_test.world";
+  const std::string bad = pathBase + "/box_bad_test.world";
+
+  std::string output =
+    custom_exec_str(g_ignCommand + " sdf --check-batch -j 2 " + good + " " +
+        bad + g_sdfVersion);
+
+  // Files are reported in the order they were given.
+  const std::size_t goodPos = output.find(
+      "{\"file\": \"" + good + "\", \"valid\": true");
+  const std::size_t badPos = output.find(
+      "{\"file\": \"" + bad + "\", \"valid\": false");
+  ASSERT_NE(std::string::npos, goodPos) << output;
+  ASSERT_NE(std::string::npos, badPos) << output;
+  EXPECT_LT(goodPos, badPos);
+  EXPECT_NE(output.find("Required attribute", badPos), std::string::npos)
+    << output;
+  EXPECT_NE(output.find("{\"files\": 2, \"valid\": 1, \"invalid\": 1"),
+            std::string::npos) << output;
+}
+
 /////////////////////////////////////////////////
 TEST(check_shapes_sdf, SDF)
 {
@@ -951,6 +1032,40 @@ TEST(GraphCmd, WorldPoseRelativeTo)
   EXPECT_EQ(sdf::trim(expected.str()), sdf::trim(output));
 }
 
+/////////////////////////////////////////////////
+TEST(GraphCmd, WorldPoseRelativeToScoped)
+{
+  const std::string path = std::string(PROJECT_SOURCE_PATH) +
+    "/test/sdf/world_relative_to_nested_reference.sdf";
+
+  const std::string output = custom_exec_str(g_ignCommand +
+      " sdf -g pose --graph-model M1 --graph-depth 1 " + path +
+      g_sdfVersion);
+
+  std::stringstream expected;
+  expected << "digraph {\n"
+    << "  2 [label=\"M1 (2)\"];\n"
+    << "  3 [label=\"M1::__model__ (3)\"];\n"
+    << "  4 [label=\"M1::L1 (4)\"];\n"
+    << "  5 [label=\"M1::L2 (5)\"];\n"
+    << "  6 [label=\"M1::J1 (6)\"];\n"
+    << "  7 [label=\"M1::F1 (7)\"];\n"
+    << "  8 [label=\"M1::CM1 (8)\"];\n"
+    << "  2 -> 3 [label=0];\n"
+    << "  3 -> 4 [label=1];\n"
+    << "  3 -> 5 [label=1];\n"
+    << "  5 -> 6 [label=1];\n"
+    << "  5 -> 7 [label=1];\n"
+    << "  3 -> 8 [label=1];\n"
+    << "}";
+  EXPECT_EQ(sdf::trim(expected.str()), sdf::trim(output));
+
+  const std::string missing = custom_exec_str(g_ignCommand +
+      " sdf -g pose --graph-model M2 " + path + g_sdfVersion);
+  EXPECT_NE(std::string::npos, missing.find("is not in the graph"))
+    << missing;
+}
+
 /////////////////////////////////////////////////
 TEST(GraphCmd, ModelPoseRelativeTo)
 {
@@ -15,12 +15,25 @@
  *
  */
 
+#include <algorithm>
 #include <iostream>
+#include <istream>
+#include <iterator>
+#include <limits>
 #include <cstdlib>
+#include <cstring>
+#include <future>
 #include <map>
+#include <mutex>
+#include <optional>
 #include <set>
+#include <sstream>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
+#include <ignition/math/Pose3.hh>
 #include <ignition/math/SemanticVersion.hh>
 
 #include "sdf/Console.hh"
@@ -32,20 +45,118 @@
 #include "sdf/Param.hh"
 #include "sdf/Root.hh"
 #include "sdf/SDFImpl.hh"
+#include "sdf/VirtualFilesystem.hh"
 #include "sdf/World.hh"
 #include "sdf/parser.hh"
 #include "sdf/sdf_config.h"
 
+#include "BinarySnapshot.hh"
+#include "Compression.hh"
 #include "Converter.hh"
+#include "DiagnosticScope.hh"
+#include "ElementArena.hh"
+#include "ElementReclaimer.hh"
+#include "EmbeddedSdf.hh"
+#include "ExecutorScope.hh"
+#include "FindFileSettings.hh"
 #include "FrameSemantics.hh"
+#include "IncludeCache.hh"
+#include "IncludeRecords.hh"
+#include "IncrementalRead.hh"
+#include "LazyChildren.hh"
+#include "LazyDescriptions.hh"
+#include "LoadCache.hh"
+#include "LoadStatsScope.hh"
+#include "MappedFile.hh"
+#include "ModelPreloader.hh"
+#include "RegionExclusions.hh"
 #include "ScopedGraph.hh"
+#include "SourceRanges.hh"
+#include "SpecTables.hh"
+#include "SymbolTable.hh"
+#include "Tracing.hh"
 #include "Utils.hh"
+#include "XmlDocumentScope.hh"
+#include "XmlChunks.hh"
+#include "XmlStreamReader.hh"
 #include "parser_private.hh"
 #include "parser_urdf.hh"
 
 namespace sdf
 {
 inline namespace SDF_VERSION_NAMESPACE {
+/// \brief Files read by the include currently being read on this thread,
+/// or nullptr if no include is being read. Nested includes add their files
+/// here so the include cache can check all of them.
+static thread_local std::vector<IncludeCache::FileStamp> *g_includeFiles =
+    nullptr;
+
+/// \brief Symbols of the element names that readXml checks, so that the
+/// checks compare addresses instead of strings.
+static const Symbol kJointSymbol = SymbolTable::Intern("joint");
+static const Symbol kModelSymbol = SymbolTable::Intern("model");
+static const Symbol kWorldSymbol = SymbolTable::Intern("world");
+
+//////////////////////////////////////////////////
+/// \brief Check the name of an element.
+/// \param[in] _elem The element.
+/// \param[in] _name Symbol of the name.
+/// \return True if _elem is named _name.
+static bool hasName(const ElementPtr &_elem, Symbol _name)
+{
+  return &_elem->GetName() == _name;
+}
+
+/// \brief Sets the files that includes read on this thread are added to,
+/// for as long as it is in scope.
+class IncludeFilesScope
+{
+  /// \brief Constructor.
+  /// \param[in] _files Vector to add the files to, or nullptr to keep the
+  /// current one.
+  public: explicit IncludeFilesScope(
+              std::vector<IncludeCache::FileStamp> *_files)
+    : parent(g_includeFiles)
+  {
+    if (_files)
+      g_includeFiles = _files;
+  }
+
+  /// \brief Destructor. Restores the previous files.
+  public: ~IncludeFilesScope()
+  {
+    g_includeFiles = this->parent;
+  }
+
+  /// \brief Files of the enclosing scope.
+  private: std::vector<IncludeCache::FileStamp> *parent;
+};
+
+/// \brief Adds the error of a cancelled load to the errors of a read when
+/// the read returns, whichever way it returns.
+class CancellationReport
+{
+  /// \brief Constructor.
+  /// \param[in] _config Configuration of the read.
+  /// \param[in,out] _errors Errors of the read.
+  public: CancellationReport(const ParserConfig &_config, Errors &_errors)
+    : config(_config), errors(_errors)
+  {
+  }
+
+  /// \brief Destructor. Adds the error if the read was cancelled.
+  public: ~CancellationReport()
+  {
+    reportCancellation(this->errors, this->config);
+  }
+
+  /// \brief Configuration of the read.
+  private: const ParserConfig &config;
+
+  /// \brief Errors of the read.
+  private: Errors &errors;
+};
+
 //////////////////////////////////////////////////
 /// \brief Internal helper for readFile, which populates the SDF values
 /// from a file
@@ -56,37 +167,233 @@ inline namespace SDF_VERSION_NAMESPACE {
 /// \param[in] _filename Name of the SDF file
 /// \param[in] _sdf Pointer to an SDF object.
 /// \param[in] _convert Convert to the latest version if true.
+/// \param[in] _config Parser configuration.
 /// \param[out] _errors Parsing errors will be appended to this variable.
 /// \return True if successful.
 bool readFileInternal(
     const std::string &_filename,
     SDFPtr _sdf,
     const bool _convert,
+    const ParserConfig &_config,
     Errors &_errors);
 
-/// \brief Internal helper for readString, which populates the SDF values
-/// from a string
+/// \brief Internal helper for readString and readBuffer, which populates
+/// the SDF values from a buffer
 ///
-/// This populates the sdf pointer from a string. If the string is from a URDF
+/// This populates the sdf pointer from a buffer. If the buffer holds a URDF
 /// file it is converted to SDF first. Conversion to the latest
 /// SDF version is controlled by a function parameter.
-/// \param[in] _xmlString XML string to be parsed.
+/// \param[in] _data XML to be parsed. It does not need to be terminated.
+/// \param[in] _size Size of the XML in bytes.
 /// \param[in] _sdf Pointer to an SDF object.
 /// \param[in] _convert Convert to the latest version if true.
+/// \param[in] _config Parser configuration.
 /// \param[out] _errors Parsing errors will be appended to this variable.
 /// \return True if successful.
 bool readStringInternal(
-    const std::string &_xmlString,
+    const char *_data,
+    std::size_t _size,
     SDFPtr _sdf,
     const bool _convert,
+    const ParserConfig &_config,
     Errors &_errors);
 
+//////////////////////////////////////////////////
+/// \brief Get the file path of the model file of a model directory, from
+/// its model.config.
+/// \param[in] _modelDirPath Path of the model directory.
+/// \param[in] _filesystem Filesystem the model directory is in.
+/// \return Path of the model file, or an empty string on an error.
+static std::string getModelFilePath(const std::string &_modelDirPath,
+    const VirtualFilesystem &_filesystem);
+
+//////////////////////////////////////////////////
+/// \brief Start fetching the URIs of the includes of a document with the
+/// asynchronous find callback of a configuration, if it has one.
+/// \param[in] _xml Root element of the document.
+/// \param[in] _config Parser configuration.
+static void prefetchIncludes(const tinyxml2::XMLElement *_xml,
+    const ParserConfig &_config);
+
+//////////////////////////////////////////////////
+/// \brief Start fetching the URIs of the includes of a document that is
+/// read as a stream, with the asynchronous find callback of a
+/// configuration, if it has one.
+/// \param[in] _data Content of the document.
+/// \param[in] _size Size of the document in bytes.
+/// \param[in] _config Parser configuration.
+static void prefetchIncludes(const char *_data, std::size_t _size,
+    const ParserConfig &_config);
+
+//////////////////////////////////////////////////
+/// \brief Read the child elements of an XML element into an Element whose
+/// attributes and value have already been read, and add the required
+/// child elements that are missing.
+/// \param[in] _xml Pointer to the TinyXML element.
+/// \param[in,out] _sdf Element to add the children to.
+/// \param[in] _config Parser configuration.
+/// \param[out] _errors Captures errors found during parsing.
+/// \return True on success, false on error.
+static bool readXmlChildren(tinyxml2::XMLElement *_xml, ElementPtr _sdf,
+    const ParserConfig &_config, Errors &_errors);
+
+//////////////////////////////////////////////////
+/// \brief Outcome of reading a document with readStream.
+enum class StreamReadResult
+{
+  /// \brief The document was read.
+  SUCCESS,
+
+  /// \brief Reading the document failed.
+  FAILURE,
+
+  /// \brief The document must be read through the tinyxml2 DOM, because
+  /// it is not SDFormat, must be converted, or its start is malformed.
+  /// Nothing was read.
+  UNSUPPORTED
+};
+
+//////////////////////////////////////////////////
+/// \brief Read an SDFormat document with XmlStreamReader, creating its
+/// elements as the XML is tokenized instead of from a tinyxml2 DOM. This is
+/// the equivalent of readDoc when ParserConfig::StreamingRead is enabled.
+/// \param[in] _data Content of the document.
+/// \param[in] _size Size of the content.
+/// \param[in,out] _sdf SDF to read into. Its elements may be partially
+/// read on failure.
+/// \param[in] _source Source of the document, "data-string" for a string,
+/// or the name of the file.
+/// \param[in] _convert True if the document is to be converted to the
+/// latest version.
+/// \param[in] _config Parser configuration.
+/// \param[out] _errors Captures errors found during parsing.
+/// \return Whether the document was read, failed, or must be read through
+/// the DOM.
+static StreamReadResult readStream(const char *_data, std::size_t _size,
+    SDFPtr _sdf, const std::string &_source, bool _convert,
+    const ParserConfig &_config, Errors &_errors);
+
+//////////////////////////////////////////////////
+/// \brief Check whether elements with a name are left out of documents.
+/// \param[in] _config Parser configuration.
+/// \param[in] _name Element name.
+/// \return True if the element is in ParserConfig::SkippedElements.
+static bool isSkipped(const ParserConfig &_config, const std::string &_name)
+{
+  const std::set<std::string> &skipped = _config.SkippedElements();
+  return !skipped.empty() && skipped.count(_name) != 0;
+}
+
+//////////////////////////////////////////////////
+/// \brief Check whether a child of a <world> element is a model that is
+/// left out by ParserConfig::RegionFilter.
+/// \param[in] _xml The child element.
+/// \param[in] _config Parser configuration.
+/// \param[out] _name Name of the model, or an empty string for an
+/// <include> without a <name>.
+/// \param[out] _pose Pose of the model relative to the world frame.
+/// \return True if _xml is a <model> or <include> outside the region.
+static bool isOutOfRegion(const tinyxml2::XMLElement *_xml,
+    const ParserConfig &_config, std::string &_name,
+    ignition::math::Pose3d &_pose)
+{
+  const ParserConfig::RegionFilterCallback &filter = _config.RegionFilter();
+  if (!filter)
+    return false;
+
+  const bool isInclude = std::strcmp(_xml->Value(), "include") == 0;
+  if (!isInclude && std::strcmp(_xml->Value(), "model") != 0)
+    return false;
+
+  _pose = ignition::math::Pose3d::Zero;
+  if (const tinyxml2::XMLElement *poseXml = _xml->FirstChildElement("pose"))
+  {
+    // The world pose of models placed relative to another frame is only
+    // known once the frame graphs are built, so they are always read.
+    const char *relativeTo = poseXml->Attribute("relative_to");
+    if (relativeTo && relativeTo[0] != '\0' &&
+        std::strcmp(relativeTo, "world") != 0)
+    {
+      return false;
+    }
+    if (poseXml->GetText())
+    {
+      std::istringstream stream(poseXml->GetText());
+      stream >> _pose;
+    }
+  }
+
+  _name.clear();
+  if (isInclude)
+  {
+    const tinyxml2::XMLElement *nameXml = _xml->FirstChildElement("name");
+    if (nameXml && nameXml->GetText())
+      _name = nameXml->GetText();
+  }
+  else if (const char *name = _xml->Attribute("name"))
+  {
+    _name = name;
+  }
+  return !filter(_name, _pose);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check whether an XML element contains an <include> element at
+/// any depth.
+/// \param[in] _xml Pointer to the TinyXML element.
+/// \return True if there is an <include> element below _xml.
+static bool hasInclude(const tinyxml2::XMLElement *_xml)
+{
+  for (const tinyxml2::XMLElement *child = _xml->FirstChildElement(); child;
+       child = child->NextSiblingElement())
+  {
+    if (std::strcmp(child->Value(), "include") == 0 || hasInclude(child))
+      return true;
+  }
+  return false;
+}
+
+//////////////////////////////////////////////////
+/// \brief Parse an XML file. The file is memory-mapped where possible and
+/// parsed from the mapping, instead of being read into a buffer first.
+/// \param[in] _filename Name of the file.
+/// \param[out] _xmlDoc Document to parse into.
+/// \param[in] _filesystem Filesystem to read the file from.
+/// \param[out] _source If not null, set to the file that was parsed, or
+/// to null if the file could not be opened.
+/// \return tinyxml2::XML_SUCCESS on success, or the parse error.
+static tinyxml2::XMLError loadXmlFile(const std::string &_filename,
+    tinyxml2::XMLDocument &_xmlDoc, const VirtualFilesystem &_filesystem,
+    std::unique_ptr<VirtualFile> *_source = nullptr)
+{
+  std::unique_ptr<VirtualFile> file = _filesystem.Open(_filename);
+  if (!file)
+  {
+    // Let tinyxml2 report why the file can not be read.
+    return _xmlDoc.LoadFile(_filename.c_str());
+  }
+
+  std::string error;
+  file = decompressFile(std::move(file), error);
+  if (!file)
+  {
+    sdferr << "Unable to decompress file [" << _filename << "]: "
+           << error << "\n";
+    return tinyxml2::XML_ERROR_FILE_READ_ERROR;
+  }
+  const tinyxml2::XMLError result = _xmlDoc.Parse(file->Data(), file->Size());
+  if (_source)
+    *_source = std::move(file);
+  return result;
+}
+
 //////////////////////////////////////////////////
 template <typename TPtr>
 static inline bool _initFile(const std::string &_filename, TPtr _sdf)
 {
   tinyxml2::XMLDocument xmlDoc;
-  if (tinyxml2::XML_SUCCESS != xmlDoc.LoadFile(_filename.c_str()))
+  if (tinyxml2::XML_SUCCESS !=
+      loadXmlFile(_filename, xmlDoc, VirtualFilesystem::Native()))
   {
     sdferr << "Unable to load file["
            << _filename << "]: " << xmlDoc.ErrorStr() << "\n";
@@ -96,9 +403,261 @@ static inline bool _initFile(const std::string &_filename, TPtr _sdf)
   return initDoc(&xmlDoc, _sdf);
 }
 
+//////////////////////////////////////////////////
+/// \brief Find the root element of a spec file in the generated tables.
+/// \param[in] _tables Generated spec tables.
+/// \param[in] _version Spec version, such as "1.8".
+/// \param[in] _filename Base name of the spec file, such as "root.sdf".
+/// \return The root element, or nullptr if the tables don't have the file.
+static const SpecElement *findSpecFile(const SpecTables &_tables,
+    const std::string &_version, const std::string &_filename)
+{
+  return _tables.FindFile(_version.c_str(), _filename.c_str());
+}
+
+//////////////////////////////////////////////////
+/// \brief Initialize an element from the generated spec tables. This
+/// builds the same description as initXml does from the spec file, except
+/// that the child descriptions are only created when they are first
+/// needed, see LazyDescriptions.
+/// \param[in] _tables Generated spec tables.
+/// \param[in] _spec Element of the tables.
+/// \param[in] _sdf Element to initialize.
+/// \param[in] _version Spec version of the tables, such as "1.8".
+static void initSpecElement(const SpecTables &_tables,
+    const SpecElement &_spec, ElementPtr _sdf, const std::string &_version)
+{
+  if (_spec.ref != kSpecNoString)
+  {
+    _sdf->SetReferenceSDF(_tables.String(_spec.ref));
+  }
+  _sdf->SetName(_tables.String(_spec.name));
+  _sdf->SetRequired(_tables.String(_spec.required));
+
+  if (_spec.type != kSpecNoString)
+  {
+    _sdf->AddValue(_tables.String(_spec.type),
+        _tables.String(_spec.defaultValue), _spec.valueRequired,
+        _tables.String(_spec.minValue), _tables.String(_spec.maxValue),
+        _tables.String(_spec.description));
+  }
+
+  for (std::uint32_t i = 0; i < _spec.attributeCount; ++i)
+  {
+    const SpecAttribute &attr = _tables.attributes[_spec.firstAttribute + i];
+    _sdf->AddAttribute(_tables.String(attr.name), _tables.String(attr.type),
+        _tables.String(attr.defaultValue), attr.required,
+        _tables.String(attr.description));
+  }
+
+  if (_spec.description != kSpecNoString)
+  {
+    _sdf->SetDescription(_tables.String(_spec.description));
+  }
+
+  if (_spec.copyChildren)
+  {
+    _sdf->SetCopyChildren(true);
+  }
+
+  if (_spec.childCount > 0)
+  {
+    LazyDescriptions::Defer(_sdf, _spec, _version);
+  }
+}
+
+//////////////////////////////////////////////////
+void LazyDescriptions::Defer(const ElementPtr &_elem,
+    const SpecElement &_spec, const std::string &_version)
+{
+  auto lazy = std::make_shared<LazyDescriptions>();
+  lazy->spec = &_spec;
+  lazy->version = _version;
+
+  // The element may still share the empty description data of new
+  // elements.
+  auto &data = _elem->dataPtr->descriptionData;
+  data = std::make_shared<ElementDescriptionData>(*data);
+  data->lazyDescriptions = std::move(lazy);
+}
+
+//////////////////////////////////////////////////
+/// \brief Get the description tree of an embedded spec file, building it
+/// from the generated spec tables only the first time it is requested.
+/// Trees are cached process-wide, keyed by spec version and file name, so
+/// that repeated calls to init and initFile don't have to rebuild them.
+/// \param[in] _filename Base name of the spec file, such as "root.sdf".
+/// \param[in] _version Spec version, such as "1.8".
+/// \return The cached description, or nullptr if _filename is not an
+/// embedded spec file. The returned element is shared and must not be
+/// modified; callers should copy it into their own element.
+static ElementPtr cachedEmbeddedDescription(const std::string &_filename,
+    const std::string &_version)
+{
+  static std::mutex cacheMutex;
+  static std::map<std::pair<std::string, std::string>, ElementPtr> cache;
+
+  const auto key = std::make_pair(_version, _filename);
+  {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto iter = cache.find(key);
+    if (iter != cache.end())
+    {
+      return iter->second;
+    }
+  }
+
+  // Build outside of the lock, since spec files include each other and
+  // their descriptions are requested from this cache recursively. The
+  // cache outlives the current load, so its arena is not used.
+  ElementArenaScope heapScope(nullptr);
+  ElementPtr description(new Element);
+  const SpecTables &tables = GetSpecTables();
+  const SpecElement *spec = findSpecFile(tables, key.first, _filename);
+  if (spec)
+  {
+    initSpecElement(tables, *spec, description, key.first);
+  }
+  else
+  {
+    // Fall back to the XML for files the tables were not generated for.
+    const std::string_view xmldata =
+      FindEmbeddedSdf(_version + "/" + _filename);
+    if (xmldata.empty())
+    {
+      return ElementPtr();
+    }
+
+    tinyxml2::XMLDocument xmlDoc;
+    xmlDoc.Parse(xmldata.data(), xmldata.size());
+    if (!initDoc(&xmlDoc, description))
+    {
+      return ElementPtr();
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(cacheMutex);
+  return cache.emplace(key, description).first->second;
+}
+
+//////////////////////////////////////////////////
+/// \brief Copy a cached description tree into an element, keeping the file
+/// path and original version that may already be set on the element.
+/// \param[in] _description Cached description to copy from.
+/// \param[in] _sdf Element to initialize.
+static void copyDescription(const ElementPtr &_description, ElementPtr _sdf)
+{
+  const std::string path = _sdf->FilePath();
+  const std::string originalVersion = _sdf->OriginalVersion();
+  _sdf->Copy(_description);
+  _sdf->SetFilePath(path);
+  _sdf->SetOriginalVersion(originalVersion);
+}
+
+//////////////////////////////////////////////////
+ElementPtr_V LazyDescriptions::Create() const
+{
+  const SpecTables &tables = GetSpecTables();
+  ElementPtr_V elements;
+  elements.reserve(this->spec->childCount);
+  for (std::uint32_t i = 0; i < this->spec->childCount; ++i)
+  {
+    const SpecChild &child = tables.children[this->spec->firstChild + i];
+    ElementPtr element(new Element);
+    if (child.element != kSpecNoElement)
+    {
+      initSpecElement(tables, tables.elements[child.element], element,
+          this->version);
+    }
+    else
+    {
+      // Included files are taken from the version the parent was created
+      // for, which SDF::Version may no longer be.
+      const std::string filename = tables.String(child.includeFilename);
+      ElementPtr description =
+          cachedEmbeddedDescription(filename, this->version);
+      if (description)
+        copyDescription(description, element);
+      else
+        initFile(filename, element);
+
+      // override description for include elements
+      if (child.includeDescription != kSpecNoString)
+      {
+        element->SetDescription(tables.String(child.includeDescription));
+      }
+    }
+    elements.push_back(std::move(element));
+  }
+  return elements;
+}
+
+//////////////////////////////////////////////////
+std::size_t LazyDescriptions::Expand(const ElementPtr &_elem)
+{
+  // Copies of a description share its description data, and deferred
+  // children are shared even by copies that were modified, so they
+  // identify the part of the spec that an element describes.
+  std::set<const void *> visited;
+  std::vector<ElementPtr> stack = {_elem};
+  while (!stack.empty())
+  {
+    ElementPtr elem = stack.back();
+    stack.pop_back();
+
+    const ElementDescriptionData &data = *elem->dataPtr->descriptionData;
+    const void *key = data.lazyDescriptions ?
+      static_cast<const void *>(data.lazyDescriptions.get()) : &data;
+    if (!visited.insert(key).second)
+      continue;
+
+    for (std::size_t i = 0; i < elem->GetElementDescriptionCount(); ++i)
+    {
+      stack.push_back(elem->GetElementDescription(
+          static_cast<unsigned int>(i)));
+    }
+  }
+  return visited.size();
+}
+
+//////////////////////////////////////////////////
+bool Warmup(const std::string &_version)
+{
+  const std::string version = _version.empty() ? SDF::Version() : _version;
+
+  Console::Instance();
+  GetEmbeddedSdf();
+  GetSpecTables();
+  Converter::Preload();
+
+  ElementPtr description = cachedEmbeddedDescription("root.sdf", version);
+  if (!description)
+  {
+    sdferr << "Unable to find the spec of SDF version " << version << "\n";
+    return false;
+  }
+  LazyDescriptions::Expand(description);
+  return true;
+}
+
+//////////////////////////////////////////////////
+std::future<bool> WarmupAsync(const std::string &_version)
+{
+  const std::string version = _version.empty() ? SDF::Version() : _version;
+  return std::async(std::launch::async, Warmup, version);
+}
+
 //////////////////////////////////////////////////
 bool init(SDFPtr _sdf)
 {
+  ElementPtr description =
+    cachedEmbeddedDescription("root.sdf", SDF::Version());
+  if (description)
+  {
+    copyDescription(description, _sdf->Root());
+    return true;
+  }
+
   std::string xmldata = SDF::EmbeddedSpec("root.sdf", false);
   tinyxml2::XMLDocument xmlDoc;
   xmlDoc.Parse(xmldata.c_str());
@@ -108,12 +667,12 @@ bool init(SDFPtr _sdf)
 //////////////////////////////////////////////////
 bool initFile(const std::string &_filename, SDFPtr _sdf)
 {
-  std::string xmldata = SDF::EmbeddedSpec(_filename, true);
-  if (!xmldata.empty())
+  ElementPtr description =
+    cachedEmbeddedDescription(_filename, SDF::Version());
+  if (description)
   {
-    tinyxml2::XMLDocument xmlDoc;
-    xmlDoc.Parse(xmldata.c_str());
-    return initDoc(&xmlDoc, _sdf);
+    copyDescription(description, _sdf->Root());
+    return true;
   }
   return _initFile(sdf::findFile(_filename), _sdf);
 }
@@ -121,12 +680,12 @@ bool initFile(const std::string &_filename, SDFPtr _sdf)
 //////////////////////////////////////////////////
 bool initFile(const std::string &_filename, ElementPtr _sdf)
 {
-  std::string xmldata = SDF::EmbeddedSpec(_filename, true);
-  if (!xmldata.empty())
+  ElementPtr description =
+    cachedEmbeddedDescription(_filename, SDF::Version());
+  if (description)
   {
-    tinyxml2::XMLDocument xmlDoc;
-    xmlDoc.Parse(xmldata.c_str());
-    return initDoc(&xmlDoc, _sdf);
+    copyDescription(description, _sdf);
+    return true;
   }
   return _initFile(sdf::findFile(_filename), _sdf);
 }
@@ -273,8 +832,7 @@ bool initXml(tinyxml2::XMLElement *_xml, ElementPtr _sdf)
       sdferr << "Attribute is missing a required string\n";
       return false;
     }
-    std::string requiredStr = sdf::trim(requiredString);
-    bool required = requiredStr == "1" ? true : false;
+    bool required = sdf::trimView(requiredString) == "1";
     std::string description;
 
     if (descriptionChild && descriptionChild->GetText())
@@ -336,13 +894,20 @@ bool initXml(tinyxml2::XMLElement *_xml, ElementPtr _sdf)
 
 //////////////////////////////////////////////////
 SDFPtr readFile(const std::string &_filename, Errors &_errors)
+{
+  return readFile(_filename, ParserConfig(), _errors);
+}
+
+//////////////////////////////////////////////////
+SDFPtr readFile(const std::string &_filename, const ParserConfig &_config,
+    Errors &_errors)
 {
   // Create and initialize the data structure that will hold the parsed SDF data
   sdf::SDFPtr sdfParsed(new sdf::SDF());
   sdf::init(sdfParsed);
 
   // Read an SDF file, and store the result in sdfParsed.
-  if (!sdf::readFile(_filename, sdfParsed, _errors))
+  if (!sdf::readFile(_filename, _config, sdfParsed, _errors))
   {
     return SDFPtr();
   }
@@ -379,22 +944,88 @@ bool readFile(const std::string &_filename, SDFPtr _sdf)
 //////////////////////////////////////////////////
 bool readFile(const std::string &_filename, SDFPtr _sdf, Errors &_errors)
 {
-  return readFileInternal(_filename, _sdf, true, _errors);
+  return readFile(_filename, ParserConfig(), _sdf, _errors);
+}
+
+//////////////////////////////////////////////////
+bool readFile(const std::string &_filename, const ParserConfig &_config,
+    SDFPtr _sdf, Errors &_errors)
+{
+  return readFileInternal(_filename, _sdf, true, _config, _errors);
+}
+
+//////////////////////////////////////////////////
+bool readBinaryFile(const std::string &_filename, SDFPtr _sdf,
+    Errors &_errors)
+{
+  std::string filename = sdf::findFile(_filename, true, true);
+  MappedFile file;
+  if (filename.empty() || !file.Open(filename))
+  {
+    _errors.push_back({ErrorCode::FILE_READ,
+        "Unable to read binary snapshot [" + _filename + "]."});
+    return false;
+  }
+
+  return readBinaryBuffer(file.Data(), file.Size(), _sdf, _errors);
+}
+
+//////////////////////////////////////////////////
+bool readBinaryBuffer(const char *_data, std::size_t _size, SDFPtr _sdf,
+    Errors &_errors)
+{
+  return BinarySnapshot::Read(_data, _size, _sdf, _errors);
 }
 
 //////////////////////////////////////////////////
 bool readFileWithoutConversion(
     const std::string &_filename, SDFPtr _sdf, Errors &_errors)
 {
-  return readFileInternal(_filename, _sdf, false, _errors);
+  return readFileInternal(_filename, _sdf, false, ParserConfig(), _errors);
+}
+
+//////////////////////////////////////////////////
+/// \brief Parse a document in parts if the configuration asks for it, see
+/// ParserConfig::SetChunkedXmlParse.
+/// \param[in] _data Text of the document.
+/// \param[in] _size Size of the text in bytes.
+/// \param[in] _convert True if documents of older versions are converted.
+/// \param[in] _config Parser configuration.
+/// \param[out] _chunks Set to the parts if the document was parsed in parts.
+/// \return True if the document was parsed in parts.
+static bool parseChunks(const char *_data, std::size_t _size, bool _convert,
+    const ParserConfig &_config, std::optional<XmlChunks> &_chunks)
+{
+  // The range of an element would be that of its run, and the text of a
+  // world read lazily would have the placeholders of the runs.
+  if (!_config.ChunkedXmlParse() || _config.RecordSourceRanges() ||
+      _config.LazyElements().count("world") != 0)
+  {
+    return false;
+  }
+
+  LoadPhaseTimer timer(LoadPhase::XML_PARSE);
+  if (!_chunks.emplace().Parse(_data, _size, _convert,
+          _config.LoadThreadCount()))
+  {
+    _chunks.reset();
+  }
+  return _chunks.has_value();
 }
 
 //////////////////////////////////////////////////
 bool readFileInternal(const std::string &_filename, SDFPtr _sdf,
-      const bool _convert, Errors &_errors)
+      const bool _convert, const ParserConfig &_config, Errors &_errors)
 {
+  SDF_TRACE_SCOPE_TEXT("sdf::readFile", _filename);
+  CancellationReport cancellationReport(_config, _errors);
+  LoadStatsScope statsScope(_config);
+  DiagnosticScope diagnosticScope(_config);
+  ElementArenaScope arenaScope(_config);
+  ElementReclaimScope reclaimScope(_config);
+  ExecutorScope executorScope(_config);
   tinyxml2::XMLDocument xmlDoc;
-  std::string filename = sdf::findFile(_filename, true, true);
+  std::string filename = sdf::findFile(_filename, true, true, _config);
 
   if (filename.empty())
   {
@@ -402,18 +1033,105 @@ bool readFileInternal(const std::string &_filename, SDFPtr _sdf,
     return false;
   }
 
-  if (filesystem::is_directory(filename))
+  const VirtualFilesystem &fs = FindFileSettings::FilesystemOf(_config);
+  if (fs.IsDirectory(filename))
   {
-    filename = getModelFilePath(filename);
+    filename = getModelFilePath(filename, fs);
   }
 
-  if (!filesystem::exists(filename))
+  if (!fs.Exists(filename))
   {
     sdferr << "File [" << filename << "] doesn't exist.\n";
     return false;
   }
 
-  auto error_code = xmlDoc.LoadFile(filename.c_str());
+  // Only top level files use the on-disk cache. Included files are read
+  // through the include cache, and are part of the top level entry. Files
+  // whose includes are recorded or whose worlds are filtered by region are
+  // parsed, since the cache keeps neither the includes nor the filter.
+  LoadCache loadCache(g_includeFiles || _config.Filesystem() ||
+      IncludeRecordScope::Records() || _config.RegionFilter() ?
+      std::string() : LoadCache::Directory(_config), filename, _convert,
+      _config.SkippedElements(), _config.TrustedInput());
+  // sdf::Root records the entry of the file it reads, to store it with the
+  // graphs of the document once they are built.
+  LoadCacheRecord *cacheRecord =
+      loadCache.Valid() ? LoadCacheScope::Record() : nullptr;
+  if (loadCache.Load(_sdf, cacheRecord ? &cacheRecord->graphs : nullptr))
+  {
+    return true;
+  }
+
+  std::vector<IncludeCache::FileStamp> includedFiles;
+  IncludeFilesScope includeFilesScope(
+      loadCache.Valid() ? &includedFiles : nullptr);
+  const std::size_t errorCount = _errors.size();
+  auto storeInCache = [&]()
+  {
+    // Documents that were read with errors are parsed again each time, so
+    // that the errors keep being reported.
+    if (!loadCache.Valid() || _errors.size() != errorCount)
+      return;
+    if (cacheRecord)
+    {
+      cacheRecord->cache.emplace(loadCache);
+      cacheRecord->files = std::move(includedFiles);
+    }
+    else
+    {
+      loadCache.Store(*_sdf, includedFiles);
+    }
+  };
+
+  if (_config.StreamingRead())
+  {
+    // A file that can't be decompressed is reported by loadXmlFile below.
+    std::string error;
+    std::unique_ptr<VirtualFile> file = decompressFile(fs.Open(filename),
+        error);
+    if (file)
+    {
+      const StreamReadResult result = readStream(file->Data(), file->Size(),
+          _sdf, filename, _convert, _config, _errors);
+      if (result == StreamReadResult::SUCCESS)
+        storeInCache();
+      if (result != StreamReadResult::UNSUPPORTED)
+        return result == StreamReadResult::SUCCESS;
+    }
+  }
+
+  // A document that isn't parsed in parts, such as a URDF file, is parsed
+  // again as a whole below.
+  if (_config.ChunkedXmlParse())
+  {
+    std::string error;
+    std::unique_ptr<VirtualFile> file = decompressFile(fs.Open(filename),
+        error);
+    std::optional<XmlChunks> chunks;
+    if (file && parseChunks(file->Data(), file->Size(), _convert, _config,
+            chunks))
+    {
+      file.reset();
+      XmlChunkScope chunkScope(&*chunks);
+      if (!readDoc(&chunks->Document(), _sdf, filename, _convert, _config,
+              _errors))
+      {
+        return false;
+      }
+      storeInCache();
+      return true;
+    }
+  }
+
+  // The text of a URDF file is kept for urdfdom, which only parses strings.
+  tinyxml2::XMLError error_code;
+  std::unique_ptr<VirtualFile> source;
+  {
+    LoadPhaseTimer timer(LoadPhase::XML_PARSE);
+    error_code = loadXmlFile(filename, xmlDoc, fs, &source);
+  }
+  if (!URDF2SDF::IsURDF(xmlDoc))
+    source.reset();
   if (error_code)
   {
     sdferr << "Error parsing XML in file [" << filename << "]: "
@@ -422,18 +1140,45 @@ bool readFileInternal(const std::string &_filename, SDFPtr _sdf,
   }
 
   // Suppress deprecation for sdf::URDF2SDF
-  if (readDoc(&xmlDoc, _sdf, filename, _convert, _errors))
+  if (readDoc(&xmlDoc, _sdf, filename, _convert, _config, _errors))
   {
+    storeInCache();
     return true;
   }
-  else if (URDF2SDF::IsURDF(filename))
+
+  // A URDF model has a <robot> root. Convert the document that is already
+  // in memory instead of loading and checking the file again, and let an
+  // output without <sdf> stand for a model urdfdom rejected. urdfdom reads
+  // the text of the file, so that the document isn't printed for it.
+  if (URDF2SDF::IsURDF(xmlDoc))
   {
-    URDF2SDF u2g;
     tinyxml2::XMLDocument doc;
-    u2g.InitModelFile(filename, &doc);
-    if (sdf::readDoc(&doc, _sdf, "urdf file", _convert, _errors))
+    {
+      LoadPhaseTimer timer(LoadPhase::URDF_CONVERSION);
+      URDF2SDF u2g;
+      u2g.SetThreadCount(_config.LoadThreadCount());
+      if (source)
+      {
+        u2g.InitModel(std::string(source->Data(), source->Size()), xmlDoc,
+            &doc, true);
+      }
+      else
+      {
+        u2g.InitModelDoc(&xmlDoc, &doc);
+      }
+    }
+    if (!doc.FirstChildElement("sdf"))
+    {
+      return false;
+    }
+
+    // The urdf document is no longer needed while the sdf one is read.
+    xmlDoc.Clear();
+    source.reset();
+    if (sdf::readDoc(&doc, _sdf, "urdf file", _convert, _config, _errors))
     {
       sdfdbg << "parse from urdf file [" << _filename << "].\n";
+      storeInCache();
       return true;
     }
     else
@@ -462,38 +1207,202 @@ bool readString(const std::string &_xmlString, SDFPtr _sdf)
 //////////////////////////////////////////////////
 bool readString(const std::string &_xmlString, SDFPtr _sdf, Errors &_errors)
 {
-  return readStringInternal(_xmlString, _sdf, true, _errors);
+  return readString(_xmlString, ParserConfig(), _sdf, _errors);
 }
 
 //////////////////////////////////////////////////
-bool readStringWithoutConversion(
-    const std::string &_filename, SDFPtr _sdf, Errors &_errors)
+bool readString(const std::string &_xmlString, const ParserConfig &_config,
+    SDFPtr _sdf, Errors &_errors)
 {
-  return readStringInternal(_filename, _sdf, false, _errors);
+  return readStringInternal(_xmlString.data(), _xmlString.size(), _sdf, true,
+      _config, _errors);
 }
 
 //////////////////////////////////////////////////
-bool readStringInternal(const std::string &_xmlString, SDFPtr _sdf,
-    const bool _convert, Errors &_errors)
+bool readBuffer(const char *_data, std::size_t _size,
+    const ParserConfig &_config, SDFPtr _sdf, Errors &_errors)
 {
-  tinyxml2::XMLDocument xmlDoc;
-  xmlDoc.Parse(_xmlString.c_str());
-  if (xmlDoc.Error())
+  return readStringInternal(_data, _size, _sdf, true, _config, _errors);
+}
+
+//////////////////////////////////////////////////
+bool readBuffer(std::string_view _xml, const ParserConfig &_config,
+    SDFPtr _sdf, Errors &_errors)
+{
+  return readStringInternal(_xml.data(), _xml.size(), _sdf, true, _config,
+      _errors);
+}
+
+//////////////////////////////////////////////////
+bool readStream(std::istream &_in, const ParserConfig &_config,
+    SDFPtr _sdf, Errors &_errors)
+{
+  // The XML parser needs the whole document in one buffer, so the stream is
+  // read directly into it.
+  std::string xml((std::istreambuf_iterator<char>(_in)),
+      std::istreambuf_iterator<char>());
+  if (_in.bad())
+  {
+    sdferr << "Error reading XML from the input stream.\n";
+    return false;
+  }
+  return readStringInternal(xml.data(), xml.size(), _sdf, true, _config,
+      _errors);
+}
+
+//////////////////////////////////////////////////
+bool readFragment(const char *_data, std::size_t _size,
+    const ParserConfig &_config, SDFPtr _sdf, Errors &_errors)
+{
+  SDF_TRACE_SCOPE("sdf::readFragment");
+  CancellationReport cancellationReport(_config, _errors);
+  LoadStatsScope statsScope(_config);
+  DiagnosticScope diagnosticScope(_config);
+  ElementArenaScope arenaScope(_config);
+  ElementReclaimScope reclaimScope(_config);
+  ExecutorScope executorScope(_config);
+
+  tinyxml2::XMLDocument *reusedDoc = XmlDocumentScope::Take();
+  std::optional<tinyxml2::XMLDocument> ownDoc;
+  tinyxml2::XMLDocument &xmlDoc = reusedDoc ? *reusedDoc : ownDoc.emplace();
+  {
+    LoadPhaseTimer timer(LoadPhase::XML_PARSE);
+    xmlDoc.Parse(_data, _size);
+  }
+  if (xmlDoc.Error())
+  {
+    sdferr << "Error parsing XML from string: " << xmlDoc.ErrorStr() << '\n';
+    return false;
+  }
+
+  tinyxml2::XMLElement *elemXml = xmlDoc.FirstChildElement();
+  const std::string name = elemXml ? elemXml->Value() : "";
+  if (name != "model" && name != "actor" && name != "light")
+  {
+    addError(_errors, _config, ErrorCode::ELEMENT_INVALID, [&]
+        {
+          return "A fragment must hold a <model>, <actor> or <light> "
+              "element, not <" + name + ">.";
+        });
+    return false;
+  }
+
+  // The fragment is already at the current version, as if it were in an
+  // <sdf> element with that version.
+  ElementPtr root = _sdf->Root();
+  root->GetAttribute("version")->Set(SDF::Version());
+  if (_sdf->OriginalVersion().empty())
+    _sdf->SetOriginalVersion(SDF::Version());
+
+  ElementPtr elem = root->AddElement(name);
+  prefetchIncludes(elemXml, _config);
+  if (!readXml(elemXml, elem, _config, _errors))
+  {
+    addError(_errors, _config, ErrorCode::ELEMENT_INVALID, [&]
+        {
+          return "Unable to parse sdf element[" + name + "]";
+        });
+    return false;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool readStringWithoutConversion(
+    const std::string &_filename, SDFPtr _sdf, Errors &_errors)
+{
+  return readStringInternal(_filename.data(), _filename.size(), _sdf, false,
+      ParserConfig(), _errors);
+}
+
+//////////////////////////////////////////////////
+bool readStringInternal(const char *_data, std::size_t _size, SDFPtr _sdf,
+    const bool _convert, const ParserConfig &_config, Errors &_errors)
+{
+  SDF_TRACE_SCOPE("sdf::readString");
+  CancellationReport cancellationReport(_config, _errors);
+  // Compressed documents are decompressed into a buffer that the rest of
+  // the function reads instead.
+  if (detectCompression(_data, _size) != CompressionFormat::NONE)
+  {
+    std::string xml;
+    std::string error;
+    if (!decompress(_data, _size, xml, error))
+    {
+      sdferr << "Unable to decompress XML string: " << error << '\n';
+      return false;
+    }
+    return readStringInternal(xml.data(), xml.size(), _sdf, _convert,
+        _config, _errors);
+  }
+
+  LoadStatsScope statsScope(_config);
+  DiagnosticScope diagnosticScope(_config);
+  ElementArenaScope arenaScope(_config);
+  ElementReclaimScope reclaimScope(_config);
+  ExecutorScope executorScope(_config);
+  if (_config.StreamingRead() && !_config.RecordSourceRanges())
+  {
+    const StreamReadResult result = readStream(_data, _size, _sdf,
+        "data-string", _convert, _config, _errors);
+    if (result != StreamReadResult::UNSUPPORTED)
+      return result == StreamReadResult::SUCCESS;
+  }
+
+  // A ParserContext keeps the document, and its memory pools, between
+  // reads.
+  tinyxml2::XMLDocument *reusedDoc = XmlDocumentScope::Take();
+  std::optional<tinyxml2::XMLDocument> ownDoc;
+  std::optional<XmlChunks> chunks;
+  const bool chunked = parseChunks(_data, _size, _convert, _config, chunks);
+  tinyxml2::XMLDocument &xmlDoc = chunked ? chunks->Document() :
+      reusedDoc ? *reusedDoc : ownDoc.emplace();
+  if (!chunked)
+  {
+    LoadPhaseTimer timer(LoadPhase::XML_PARSE);
+    xmlDoc.Parse(_data, _size);
+  }
+  XmlChunkScope chunkScope(chunked ? &*chunks : nullptr);
+  if (xmlDoc.Error())
   {
     sdferr << "Error parsing XML from string: " << xmlDoc.ErrorStr() << '\n';
     return false;
   }
-  if (readDoc(&xmlDoc, _sdf, "data-string", _convert, _errors))
+
+  // Ranges are only recorded when the document is read as it is, since a
+  // converted document no longer matches the text.
+  std::optional<SourceRanges> ranges;
+  const tinyxml2::XMLElement *sdfXml = xmlDoc.FirstChildElement("sdf");
+  if (_config.RecordSourceRanges() && sdfXml && sdfXml->Attribute("version")
+      && (!_convert || SDF::Version() == sdfXml->Attribute("version")))
+  {
+    TextRange origin;
+    origin.beginLine = 1;
+    origin.beginColumn = 1;
+    if (!ranges.emplace().Build(_data, _size, xmlDoc, origin))
+      ranges.reset();
+  }
+  SourceRangeScope rangeScope(ranges ? &*ranges : nullptr);
+
+  if (readDoc(&xmlDoc, _sdf, "data-string", _convert, _config, _errors))
   {
     return true;
   }
-  else
+  else if (URDF2SDF::IsURDF(xmlDoc))
   {
-    URDF2SDF u2g;
     tinyxml2::XMLDocument doc;
-    u2g.InitModelString(_xmlString, &doc);
+    {
+      LoadPhaseTimer timer(LoadPhase::URDF_CONVERSION);
+      URDF2SDF u2g;
+      u2g.SetThreadCount(_config.LoadThreadCount());
+      // The string was parsed above; reuse that document for the extensions.
+      // urdfdom needs its own copy of the model as a string.
+      u2g.InitModel(std::string(_data, _size), xmlDoc, &doc, true);
+    }
+    xmlDoc.Clear();
 
-    if (sdf::readDoc(&doc, _sdf, "urdf string", _convert, _errors))
+    if (sdf::readDoc(&doc, _sdf, "urdf string", _convert, _config,
+                     _errors))
     {
       sdfdbg << "Parsing from urdf.\n";
       return true;
@@ -531,7 +1440,7 @@ bool readString(const std::string &_xmlString, ElementPtr _sdf, Errors &_errors)
     sdferr << "Error parsing XML from string: " << xmlDoc.ErrorStr() << '\n';
     return false;
   }
-  if (readDoc(&xmlDoc, _sdf, "data-string", true, _errors))
+  if (readDoc(&xmlDoc, _sdf, "data-string", true, ParserConfig(), _errors))
   {
     return true;
   }
@@ -544,8 +1453,20 @@ bool readString(const std::string &_xmlString, ElementPtr _sdf, Errors &_errors)
 }
 
 //////////////////////////////////////////////////
-bool readDoc(tinyxml2::XMLDocument *_xmlDoc, SDFPtr _sdf,
-    const std::string &_source, bool _convert, Errors &_errors)
+/// \brief Check the <sdf> element of a document, record its version and
+/// convert it to the current version, before its elements are read into
+/// an SDF object.
+/// \param[in] _xmlDoc The document.
+/// \param[in,out] _sdf SDF object to read into.
+/// \param[in] _source Name of the file, or "data-string".
+/// \param[in] _convert Convert to the latest version if true.
+/// \param[in] _config Parser configuration.
+/// \param[out] _elemXml The XML element of the root element of _sdf, or
+/// nullptr if the document has none.
+/// \return False if the document can't be read.
+static bool beginReadDoc(tinyxml2::XMLDocument *_xmlDoc,
+    const SDFPtr &_sdf, const std::string &_source, bool _convert,
+    const ParserConfig &_config, tinyxml2::XMLElement *&_elemXml)
 {
   if (!_xmlDoc)
   {
@@ -586,18 +1507,19 @@ bool readDoc(tinyxml2::XMLDocument *_xmlDoc, SDFPtr _sdf,
     if (_convert
         && strcmp(sdfNode->Attribute("version"), SDF::Version().c_str()) != 0)
     {
+      if (loadCancelled(_config))
+        return false;
       sdfdbg << "Converting a deprecated source[" << _source << "].\n";
-      Converter::Convert(_xmlDoc, SDF::Version());
+      Converter::Convert(_xmlDoc, SDF::Version(), false, true,
+          _config.LoadThreadCount());
+      if (loadCancelled(_config))
+        return false;
     }
 
     // parse new sdf xml
-    auto *elemXml = _xmlDoc->FirstChildElement(_sdf->Root()->GetName().c_str());
-    if (!readXml(elemXml, _sdf->Root(), _errors))
-    {
-      _errors.push_back({ErrorCode::ELEMENT_INVALID,
-          "Error reading element <" + _sdf->Root()->GetName() + ">"});
-      return false;
-    }
+    _elemXml = _xmlDoc->FirstChildElement(_sdf->Root()->GetName().c_str());
+    prefetchIncludes(_elemXml, _config);
+    return true;
   }
   else
   {
@@ -612,14 +1534,35 @@ bool readDoc(tinyxml2::XMLDocument *_xmlDoc, SDFPtr _sdf,
     }
     return false;
   }
+}
+
+//////////////////////////////////////////////////
+bool readDoc(tinyxml2::XMLDocument *_xmlDoc, SDFPtr _sdf,
+    const std::string &_source, bool _convert, const ParserConfig &_config,
+    Errors &_errors)
+{
+  SDF_TRACE_SCOPE_TEXT("sdf::readDoc", _source);
+  tinyxml2::XMLElement *elemXml = nullptr;
+  if (!beginReadDoc(_xmlDoc, _sdf, _source, _convert, _config, elemXml))
+    return false;
 
+  if (!readXml(elemXml, _sdf->Root(), _config, _errors))
+  {
+    addError(_errors, _config, ErrorCode::ELEMENT_INVALID, [&]
+        {
+          return "Error reading element <" + _sdf->Root()->GetName() + ">";
+        });
+    return false;
+  }
   return true;
 }
 
 //////////////////////////////////////////////////
 bool readDoc(tinyxml2::XMLDocument *_xmlDoc, ElementPtr _sdf,
-             const std::string &_source, bool _convert, Errors &_errors)
+             const std::string &_source, bool _convert,
+             const ParserConfig &_config, Errors &_errors)
 {
+  SDF_TRACE_SCOPE_TEXT("sdf::readDoc", _source);
   if (!_xmlDoc)
   {
     sdfwarn << "Could not parse the xml\n";
@@ -648,8 +1591,13 @@ bool readDoc(tinyxml2::XMLDocument *_xmlDoc, ElementPtr _sdf,
     if (_convert
         && strcmp(sdfNode->Attribute("version"), SDF::Version().c_str()) != 0)
     {
+      if (loadCancelled(_config))
+        return false;
       sdfwarn << "Converting a deprecated SDF source[" << _source << "].\n";
-      Converter::Convert(_xmlDoc, SDF::Version());
+      Converter::Convert(_xmlDoc, SDF::Version(), false, true,
+          _config.LoadThreadCount());
+      if (loadCancelled(_config))
+        return false;
     }
 
     tinyxml2::XMLElement *elemXml = sdfNode;
@@ -660,10 +1608,13 @@ bool readDoc(tinyxml2::XMLDocument *_xmlDoc, ElementPtr _sdf,
     }
 
     // parse new sdf xml
-    if (!readXml(elemXml, _sdf, _errors))
+    prefetchIncludes(elemXml, _config);
+    if (!readXml(elemXml, _sdf, _config, _errors))
     {
-      _errors.push_back({ErrorCode::ELEMENT_INVALID,
-          "Unable to parse sdf element["+ _sdf->GetName() + "]"});
+      addError(_errors, _config, ErrorCode::ELEMENT_INVALID, [&]
+          {
+            return "Unable to parse sdf element[" + _sdf->GetName() + "]";
+          });
       return false;
     }
   }
@@ -748,17 +1699,30 @@ std::string getBestSupportedModelVersion(tinyxml2::XMLElement *_modelXML,
 
 //////////////////////////////////////////////////
 std::string getModelFilePath(const std::string &_modelDirPath)
+{
+  return getModelFilePath(_modelDirPath, VirtualFilesystem::Native());
+}
+
+//////////////////////////////////////////////////
+/// \brief Read the model.config of a model directory to find its model
+/// file, without looking in the include cache.
+/// \param[in] _modelDirPath Path of the model directory.
+/// \param[in] _filesystem Filesystem the model directory is in.
+/// \param[out] _config Stamp of the model.config, taken before it is read.
+/// \return Path of the model file, or an empty string on an error.
+static std::string readModelFilePath(const std::string &_modelDirPath,
+    const VirtualFilesystem &_filesystem, IncludeCache::FileStamp &_config)
 {
   std::string configFilePath;
 
   /// \todo This hardcoded bit is very Gazebo centric. It should
   /// be abstracted away, possibly through a plugin to SDF.
   configFilePath = sdf::filesystem::append(_modelDirPath, "model.config");
-  if (!sdf::filesystem::exists(configFilePath))
+  if (!_filesystem.Exists(configFilePath))
   {
     // We didn't find model.config, look for manifest.xml instead
     configFilePath = sdf::filesystem::append(_modelDirPath, "manifest.xml");
-    if (!sdf::filesystem::exists(configFilePath))
+    if (!_filesystem.Exists(configFilePath))
     {
       // We didn't find manifest.xml either, output an error and get out.
       sdferr << "Could not find model.config or manifest.xml for the model\n";
@@ -773,8 +1737,12 @@ std::string getModelFilePath(const std::string &_modelDirPath)
     }
   }
 
+  if (!IncludeCache::Stamp(_filesystem, configFilePath, _config))
+    _config = IncludeCache::FileStamp();
+
   tinyxml2::XMLDocument configFileDoc;
-  if (tinyxml2::XML_SUCCESS != configFileDoc.LoadFile(configFilePath.c_str()))
+  if (tinyxml2::XML_SUCCESS !=
+      loadXmlFile(configFilePath, configFileDoc, _filesystem))
   {
     sdferr << "Error parsing XML in file ["
            << configFilePath << "]: "
@@ -800,391 +1768,1713 @@ std::string getModelFilePath(const std::string &_modelDirPath)
 }
 
 //////////////////////////////////////////////////
-bool readXml(tinyxml2::XMLElement *_xml, ElementPtr _sdf, Errors &_errors)
+static std::string getModelFilePath(const std::string &_modelDirPath,
+    const VirtualFilesystem &_filesystem)
+{
+  // The model file of a directory only changes with its model.config, so
+  // it is resolved once and shared by every include of the model.
+  IncludeCache &cache = IncludeCache::Instance();
+  std::string modelFilePath;
+  if (cache.GetModelFile(_filesystem, _modelDirPath, modelFilePath))
+    return modelFilePath;
+
+  IncludeCache::FileStamp config;
+  modelFilePath = readModelFilePath(_modelDirPath, _filesystem, config);
+  if (!modelFilePath.empty() && !config.filename.empty())
+    cache.PutModelFile(_filesystem, _modelDirPath, config, modelFilePath);
+  return modelFilePath;
+}
+
+//////////////////////////////////////////////////
+/// \brief Get the fetch of an include URI, starting it if needed.
+/// \param[in,out] _settings Settings with an asynchronous find callback.
+/// \param[in] _uri URI of the include.
+/// \param[in] _config Parser configuration of _settings.
+/// \param[out] _path Set to the path of _uri if it is found locally.
+/// \return The fetch of _uri, or an invalid future if it was found locally.
+static std::shared_future<std::string> fetchInclude(
+    FindFileSettings &_settings, const std::string &_uri,
+    const ParserConfig &_config, std::string &_path)
 {
-  // Check if the element pointer is deprecated.
-  if (_sdf->GetRequired() == "-1")
   {
-    sdfwarn << "SDF Element[" + _sdf->GetName() + "] is deprecated\n";
+    std::lock_guard<std::mutex> lock(_settings.fetchesMutex);
+    auto iter = _settings.fetches.find(_uri);
+    if (iter != _settings.fetches.end())
+      return iter->second;
   }
 
-  if (!_xml)
+  // Files found with the URI paths or the local search aren't fetched.
+  _path = sdf::findFile(_uri, true, false, _config);
+  if (!_path.empty())
+    return std::shared_future<std::string>();
+
+  // The callback is called under the lock, so that each URI is only
+  // fetched once. It only starts the fetch.
+  std::lock_guard<std::mutex> lock(_settings.fetchesMutex);
+  auto iter = _settings.fetches.find(_uri);
+  if (iter != _settings.fetches.end())
+    return iter->second;
+
+  std::shared_future<std::string> fetch;
+  try
   {
-    if (_sdf->GetRequired() == "1" || _sdf->GetRequired() =="+")
-    {
-      _errors.push_back({ErrorCode::ELEMENT_MISSING,
-          "SDF Element<" + _sdf->GetName() + "> is missing"});
-      return false;
-    }
-    else
-    {
-      return true;
-    }
+    fetch = _settings.asyncFindCallback(_uri).share();
+  }
+  catch (...)
+  {
+    std::promise<std::string> failed;
+    failed.set_exception(std::current_exception());
+    fetch = failed.get_future().share();
   }
 
-  if (_xml->GetText() != nullptr && _sdf->GetValue())
+  if (!fetch.valid())
   {
-    if (!_sdf->GetValue()->SetFromString(_xml->GetText()))
-      return false;
+    std::promise<std::string> notFound;
+    notFound.set_value(std::string());
+    fetch = notFound.get_future().share();
   }
+  _settings.fetches.emplace(_uri, fetch);
+  return fetch;
+}
 
-  // check for nested sdf
-  std::string refSDFStr = _sdf->ReferenceSDF();
-  if (!refSDFStr.empty())
+//////////////////////////////////////////////////
+/// \brief Find the model directory of an include URI, waiting for its fetch
+/// when the configuration has an asynchronous find callback.
+/// \param[in] _uri URI of the include.
+/// \param[in] _config Parser configuration.
+/// \param[out] _errors Captures the error of a failed fetch.
+/// \return Path of the model, or an empty string if it is not found.
+static std::string findIncludeFile(const std::string &_uri,
+    const ParserConfig &_config, Errors &_errors)
+{
+  std::shared_ptr<FindFileSettings> settings = FindFileSettings::Of(_config);
+  if (!settings || !settings->asyncFindCallback)
+    return sdf::findFile(_uri, true, true, _config);
+
+  std::string path;
+  std::shared_future<std::string> fetch =
+    fetchInclude(*settings, _uri, _config, path);
+  if (!fetch.valid())
+    return path;
+
+  try
   {
-    ElementPtr refSDF;
-    refSDF.reset(new Element);
-    std::string refFilename = refSDFStr + ".sdf";
-    initFile(refFilename, refSDF);
-    _sdf->RemoveFromParent();
-    _sdf->Copy(refSDF);
+    path = fetch.get();
+  }
+  catch (const std::exception &_e)
+  {
+    _errors.push_back({ErrorCode::URI_LOOKUP,
+        "Fetching uri[" + _uri + "] failed: " + _e.what()});
+    path.clear();
+  }
+  catch (...)
+  {
+    _errors.push_back({ErrorCode::URI_LOOKUP,
+        "Fetching uri[" + _uri + "] failed"});
+    path.clear();
+  }
+
+  // A failed fetch is tried again by the next include of the URI.
+  if (path.empty())
+  {
+    std::lock_guard<std::mutex> lock(settings->fetchesMutex);
+    settings->fetches.erase(_uri);
   }
+  return path;
+}
 
-  // A list of parent element-attributes pairs where a frame name is referenced
-  // in the attribute. This is used to check if the reference is invalid.
-  std::set<std::pair<std::string, std::string>> frameReferenceAttributes {
-      // //frame/[@attached_to]
-      {"frame", "attached_to"},
-      // //pose/[@relative_to]
-      {"pose", "relative_to"},
-      // //model/[@placement_frame]
-      {"model", "placement_frame"},
-      // //model/[@canonical_link]
-      {"model", "canonical_link"},
-      // //sensor/imu/orientation_reference_frame/custom_rpy/[@parent_frame]
-      {"custom_rpy", "parent_frame"}};
+//////////////////////////////////////////////////
+/// \brief Get the first child element of an XML element, which is the
+/// first element of a run of a document parsed in parts if the child is its
+/// placeholder, see XmlChunks.
+/// \param[in] _xml XML element.
+/// \return The first child element, or nullptr if there is none.
+template <typename T>
+static T *firstChildXml(T *_xml)
+{
+  const XmlChunks *chunks = XmlChunkScope::Current();
+  T *child = _xml->FirstChildElement();
+  return chunks ? chunks->Enter(child) : child;
+}
 
-  const tinyxml2::XMLAttribute *attribute = _xml->FirstAttribute();
+//////////////////////////////////////////////////
+/// \brief Get the next sibling element of an XML element, through the runs
+/// of a document parsed in parts, see XmlChunks.
+/// \param[in] _xml XML element.
+/// \return The next sibling element, or nullptr if there is none.
+template <typename T>
+static T *nextSiblingXml(T *_xml)
+{
+  const XmlChunks *chunks = XmlChunkScope::Current();
+  return chunks ? chunks->Next(_xml) : _xml->NextSiblingElement();
+}
 
-  unsigned int i = 0;
+//////////////////////////////////////////////////
+static void prefetchIncludes(const tinyxml2::XMLElement *_xml,
+    const ParserConfig &_config)
+{
+  std::shared_ptr<FindFileSettings> settings = FindFileSettings::Of(_config);
+  if (!_xml || !settings || !settings->asyncFindCallback)
+    return;
+
+  std::string name;
+  ignition::math::Pose3d pose;
+  std::vector<const tinyxml2::XMLElement *> stack = {_xml};
+  while (!stack.empty())
+  {
+    const tinyxml2::XMLElement *xml = stack.back();
+    stack.pop_back();
+    const bool isWorld = std::strcmp(xml->Value(), "world") == 0;
+    for (const tinyxml2::XMLElement *child = firstChildXml(xml); child;
+         child = nextSiblingXml(child))
+    {
+      if (isWorld && isOutOfRegion(child, _config, name, pose))
+        continue;
 
-  // Iterate over all the attributes defined in the give XML element
-  while (attribute)
+      if (std::strcmp(child->Value(), "include") == 0)
+      {
+        const tinyxml2::XMLElement *uri = child->FirstChildElement("uri");
+        std::string path;
+        if (uri && uri->GetText())
+          fetchInclude(*settings, uri->GetText(), _config, path);
+      }
+      else if (!isSkipped(_config, child->Value()))
+      {
+        stack.push_back(child);
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+static void prefetchIncludes(const char *_data, std::size_t _size,
+    const ParserConfig &_config)
+{
+  std::shared_ptr<FindFileSettings> settings = FindFileSettings::Of(_config);
+  if (!settings || !settings->asyncFindCallback)
+    return;
+
+  // The document is scanned ahead of the reader, and only the includes are
+  // built as XML.
+  XmlStreamReader reader(_data, _size);
+  tinyxml2::XMLDocument scratch;
+  while (true)
   {
-    // Avoid printing a warning message for missing attributes if a namespaced
-    // attribute is found
-    if (std::strchr(attribute->Name(), ':') != NULL)
+    const XmlStreamReader::Token token = reader.Next();
+    if (token == XmlStreamReader::Token::END_OF_DOCUMENT ||
+        token == XmlStreamReader::Token::MALFORMED)
     {
-      _sdf->AddAttribute(attribute->Name(), "string", "", 1, "");
-      _sdf->GetAttribute(attribute->Name())->SetFromString(
-          attribute->Value());
-      attribute = attribute->Next();
-      continue;
+      break;
     }
-    // Find the matching attribute in SDF
-    for (i = 0; i < _sdf->GetAttributeCount(); ++i)
+    if (token != XmlStreamReader::Token::START)
+      continue;
+
+    if (reader.Name() == "include")
     {
-      ParamPtr p = _sdf->GetAttribute(i);
-      if (p->GetKey() == attribute->Name())
-      {
-        if (frameReferenceAttributes.count(
-                std::make_pair(_sdf->GetName(), attribute->Name())) != 0)
-        {
-          if (!isValidFrameReference(attribute->Value()))
-          {
-            _errors.push_back({ErrorCode::ATTRIBUTE_INVALID,
-                "'" + std::string(attribute->Value()) +
-                    "' is reserved; it cannot be used as a value of "
-                    "attribute [" +
-                    p->GetKey() + "]"});
-            }
-        }
-        // Set the value of the SDF attribute
-        if (!p->SetFromString(attribute->Value()))
-        {
-          _errors.push_back({ErrorCode::ATTRIBUTE_INVALID,
-              "Unable to read attribute[" + p->GetKey() + "]"});
-          return false;
-        }
+      tinyxml2::XMLElement *include = reader.ReadElement(scratch);
+      if (!include)
         break;
-      }
+      const tinyxml2::XMLElement *uri = include->FirstChildElement("uri");
+      std::string path;
+      if (uri && uri->GetText())
+        fetchInclude(*settings, uri->GetText(), _config, path);
+      scratch.DeleteNode(include);
     }
-
-    if (i == _sdf->GetAttributeCount())
+    else if (isSkipped(_config, reader.Name()) && !reader.SkipElement())
     {
-      sdfwarn << "XML Attribute[" << attribute->Name()
-              << "] in element[" << _xml->Value()
-              << "] not defined in SDF, ignoring.\n";
+      break;
     }
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief The outcome of resolving and reading the file referenced by an
+/// <include> element, before it is merged into its parent element.
+struct IncludeResult
+{
+  /// \brief What readXml does with the include once its errors have been
+  /// reported.
+  enum Action
+  {
+    /// \brief Merge the included element into the parent.
+    INSERT,
+
+    /// \brief Ignore this include and carry on with the next element.
+    SKIP,
+
+    /// \brief Stop reading the parent element.
+    FAIL
+  };
+
+  /// \brief Action to take.
+  Action action = SKIP;
+
+  /// \brief Errors found while resolving the include.
+  Errors errors;
 
-    attribute = attribute->Next();
+  /// \brief The included SDF, set when action is INSERT.
+  SDFPtr sdf;
+
+  /// \brief Stamps of the included file and of the files it includes.
+  std::vector<IncludeCache::FileStamp> files;
+};
+
+//////////////////////////////////////////////////
+/// \brief Find and read the file referenced by an <include> element. This
+/// does not modify the including document, so it is safe to call for
+/// several includes at once.
+/// \param[in] _includeXml The <include> element.
+/// \param[in] _config Parser configuration used to read the included file.
+/// \param[out] _result The include's action, errors and parsed SDF.
+static void resolveInclude(tinyxml2::XMLElement *_includeXml,
+    const ParserConfig &_config, IncludeResult &_result)
+{
+  SDF_TRACE_SCOPE("sdf::resolveInclude");
+  LoadPhaseTimer timer(LoadPhase::INCLUDE);
+  std::string filename;
+
+  // A cancelled load stops reading the parent instead of reading the
+  // included file.
+  if (loadCancelled(_config))
+  {
+    _result.action = IncludeResult::FAIL;
+    return;
   }
 
-  // Check that all required attributes have been set
-  for (i = 0; i < _sdf->GetAttributeCount(); ++i)
+  if (_includeXml->FirstChildElement("uri"))
   {
-    ParamPtr p = _sdf->GetAttribute(i);
-    if (p->GetRequired() && !p->GetSet())
+    std::string uri = _includeXml->FirstChildElement("uri")->GetText();
+    std::string modelPath = findIncludeFile(uri, _config, _result.errors);
+
+    // Test the model path
+    if (modelPath.empty())
     {
-      _errors.push_back({ErrorCode::ATTRIBUTE_MISSING,
-          "Required attribute[" + p->GetKey() + "] in element[" + _xml->Value()
-          + "] is not specified in SDF."});
-      return false;
+      _result.errors.push_back({ErrorCode::URI_LOOKUP,
+          "Unable to find uri[" + uri + "]"});
+
+      size_t modelFound = uri.find("model://");
+      if (modelFound != 0u)
+      {
+        _result.errors.push_back({ErrorCode::URI_INVALID,
+            "Invalid uri[" + uri + "]. Should be model://" + uri});
+      }
+      _result.action = IncludeResult::SKIP;
+      return;
+    }
+    else
+    {
+      if (!FindFileSettings::FilesystemOf(_config).IsDirectory(modelPath))
+      {
+        _result.errors.push_back({ErrorCode::DIRECTORY_NONEXISTANT,
+            "Directory doesn't exist[" + modelPath + "]"});
+        _result.action = IncludeResult::SKIP;
+        return;
+      }
     }
-  }
 
-  if (_sdf->GetCopyChildren())
-  {
-    copyChildren(_sdf, _xml, false);
+    // Get the config.xml filename
+    filename = getModelFilePath(modelPath,
+        FindFileSettings::FilesystemOf(_config));
   }
   else
   {
-    std::string filename;
+    _result.errors.push_back({ErrorCode::ATTRIBUTE_MISSING,
+        "<include> element missing 'uri' attribute"});
+    _result.action = IncludeResult::SKIP;
+    return;
+  }
 
-    // Iterate over all the child elements
-    tinyxml2::XMLElement *elemXml = nullptr;
-    for (elemXml = _xml->FirstChildElement(); elemXml;
-         elemXml = elemXml->NextSiblingElement())
+  // Files read with skipped elements are cached apart from complete ones,
+  // trusted files apart from validated ones, and files whose includes are
+  // found with the URI paths or callback of the configuration apart from
+  // the others.
+  std::string cacheVersion = SDF::Version();
+  for (const std::string &name : _config.SkippedElements())
+    cacheVersion += " -" + name;
+  if (_config.TrustedInput())
+    cacheVersion += " trusted";
+  if (auto settings = FindFileSettings::Of(_config))
+    cacheVersion += " #" + std::to_string(settings->id);
+
+  IncludeCache &cache = IncludeCache::Instance();
+  const VirtualFilesystem &fs = FindFileSettings::FilesystemOf(_config);
+  SDFPtr includeSDF = cache.Get(filename, cacheVersion, fs, _result.files);
+  if (!includeSDF)
+  {
+    IncludeCache::FileStamp stamp;
+    const bool cacheable = IncludeCache::Stamp(fs, filename, stamp);
+    _result.files.push_back(stamp);
+
+    // The root description is cached by init, so this only copies it.
+    includeSDF.reset(new SDF);
+    init(includeSDF);
+
+    // Errors within the included file are printed rather than returned.
+    Errors fileErrors;
+    std::vector<IncludeCache::FileStamp> *parentFiles = g_includeFiles;
+    g_includeFiles = &_result.files;
+    bool fileRead = readFile(filename, _config, includeSDF, fileErrors);
+    g_includeFiles = parentFiles;
+    for (auto const &e : fileErrors)
+      std::cerr << e << std::endl;
+
+    if (!fileRead)
     {
-      if (std::string("include") == elemXml->Value())
-      {
-        std::string modelPath;
+      _result.errors.push_back({ErrorCode::FILE_READ,
+          "Unable to read file[" + filename + "]"});
+      _result.action = IncludeResult::FAIL;
+      return;
+    }
 
-        if (elemXml->FirstChildElement("uri"))
-        {
-          std::string uri = elemXml->FirstChildElement("uri")->GetText();
-          modelPath = sdf::findFile(uri, true, true);
+    if (cacheable)
+      cache.Put(filename, cacheVersion, includeSDF, _result.files);
+  }
 
-          // Test the model path
-          if (modelPath.empty())
-          {
-            _errors.push_back({ErrorCode::URI_LOOKUP,
-                "Unable to find uri[" + uri + "]"});
+  _result.sdf = includeSDF;
+  _result.action = IncludeResult::INSERT;
+}
 
-            size_t modelFound = uri.find("model://");
-            if (modelFound != 0u)
-            {
-              _errors.push_back({ErrorCode::URI_INVALID,
-                  "Invalid uri[" + uri + "]. Should be model://" + uri});
-            }
-            continue;
-          }
-          else
-          {
-            if (!sdf::filesystem::is_directory(modelPath))
-            {
-              _errors.push_back({ErrorCode::DIRECTORY_NONEXISTANT,
-                  "Directory doesn't exist[" + modelPath + "]"});
-              continue;
-            }
-          }
+//////////////////////////////////////////////////
+/// \brief Check whether an attribute references a frame by name, so that
+/// readXml can check that the reference is valid.
+/// \param[in] _element Name of the element of the attribute.
+/// \param[in] _attribute Name of the attribute.
+/// \return True if the attribute is a frame reference.
+static bool isFrameReferenceAttribute(const std::string &_element,
+    const char *_attribute)
+{
+  // Parent element-attribute pairs where a frame name is referenced in the
+  // attribute.
+  static const std::pair<std::string_view, std::string_view> kAttributes[] =
+  {
+    // //frame/[@attached_to]
+    {"frame", "attached_to"},
+    // //pose/[@relative_to]
+    {"pose", "relative_to"},
+    // //model/[@placement_frame]
+    {"model", "placement_frame"},
+    // //model/[@canonical_link]
+    {"model", "canonical_link"},
+    // //sensor/imu/orientation_reference_frame/custom_rpy/[@parent_frame]
+    {"custom_rpy", "parent_frame"}
+  };
 
-          // Get the config.xml filename
-          filename = getModelFilePath(modelPath);
-        }
-        else
-        {
-          _errors.push_back({ErrorCode::ATTRIBUTE_MISSING,
-              "<include> element missing 'uri' attribute"});
-          continue;
-        }
+  for (const auto &pair : kAttributes)
+  {
+    if (pair.first == _element && pair.second == _attribute)
+      return true;
+  }
+  return false;
+}
 
-        // NOTE: sdf::init is an expensive call. For performance reason,
-        // a new sdf pointer is created here by cloning a fresh sdf template
-        // pointer instead of calling init every iteration.
-        // SDFPtr includeSDF(new SDF);
-        // init(includeSDF);
-        static SDFPtr includeSDFTemplate;
-        if (!includeSDFTemplate)
-        {
-          includeSDFTemplate.reset(new SDF);
-          init(includeSDFTemplate);
-        }
-        SDFPtr includeSDF(new SDF);
-        includeSDF->Root(includeSDFTemplate->Root()->Clone());
+//////////////////////////////////////////////////
+/// \brief Outcome of reading one element from XML without its children.
+enum class ReadXmlStep
+{
+  /// \brief Reading the element failed.
+  FAILED,
 
-        if (!readFile(filename, includeSDF))
-        {
-          _errors.push_back({ErrorCode::FILE_READ,
-              "Unable to read file[" + filename + "]"});
-          return false;
-        }
+  /// \brief The element is complete, or its children are deferred or
+  /// copied.
+  DONE,
 
-        sdf::ElementPtr topLevelElem;
-        bool isModel{false};
-        bool isActor{false};
-        if (includeSDF->Root()->HasElement("model"))
-        {
-          topLevelElem = includeSDF->Root()->GetElement("model");
-          isModel = true;
-        }
-        else if (includeSDF->Root()->HasElement("actor"))
-        {
-          topLevelElem = includeSDF->Root()->GetElement("actor");
-          isActor = true;
-        }
-        else if (includeSDF->Root()->HasElement("light"))
-        {
-          topLevelElem = includeSDF->Root()->GetElement("light");
-        }
-        else
-        {
-          _errors.push_back({ErrorCode::ELEMENT_MISSING,
-              "Failed to find top level <model> / <actor> / <light> for "
-              "<include>\n"});
-          continue;
-        }
+  /// \brief The child elements remain to be read.
+  CHILDREN
+};
 
-        if (elemXml->FirstChildElement("name"))
-        {
-          topLevelElem->GetAttribute("name")->SetFromString(
-                elemXml->FirstChildElement("name")->GetText());
-        }
+//////////////////////////////////////////////////
+/// \brief An element whose children are being read by readXmlChildren.
+/// These are kept on an explicit stack instead of the call stack, so that
+/// deeply nested documents can be read on threads with small stacks.
+struct ReadXmlFrame
+{
+  /// \brief Constructor
+  /// \param[in] _xml XML element being read.
+  /// \param[in] _sdf Element the children are added to.
+  ReadXmlFrame(tinyxml2::XMLElement *_xml, ElementPtr _sdf)
+    : xml(_xml), sdf(std::move(_sdf))
+  {
+  }
 
-        tinyxml2::XMLElement *poseElemXml = elemXml->FirstChildElement("pose");
-        if (poseElemXml)
-        {
-          sdf::ElementPtr poseElem = topLevelElem->GetElement("pose");
+  /// \brief XML element being read.
+  tinyxml2::XMLElement *xml;
 
-          if (poseElemXml->GetText())
-          {
-            poseElem->GetValue()->SetFromString(poseElemXml->GetText());
-          }
-          else
-          {
-            poseElem->GetValue()->Reset();
-          }
+  /// \brief Element the children are added to.
+  ElementPtr sdf;
 
-          const char *relativeTo = poseElemXml->Attribute("relative_to");
-          if (relativeTo)
-          {
-            poseElem->GetAttribute("relative_to")->SetFromString(relativeTo);
-          }
-          else
-          {
-            poseElem->GetAttribute("relative_to")->Reset();
-          }
-        }
+  /// \brief Next XML child to read, or nullptr once all have been read.
+  tinyxml2::XMLElement *next = nullptr;
 
-        if (isModel && elemXml->FirstChildElement("static"))
+  /// \brief Includes of the children, resolved up front.
+  std::vector<IncludeResult> includes;
+
+  /// \brief Index of the next include to take from includes.
+  std::size_t includeIndex = 0;
+};
+
+//////////////////////////////////////////////////
+/// \brief Read the value of an element from the text of its XML, and copy
+/// its reference SDF into it if it has one.
+/// \param[in] _text Text of the XML element, or nullptr if it has none.
+/// \param[in,out] _sdf Element to read into.
+/// \return False if the value is invalid.
+static bool readXmlValue(const char *_text, const ElementPtr &_sdf)
+{
+  if (_text != nullptr && _sdf->GetValue())
+  {
+    if (!_sdf->GetValue()->SetFromString(_text))
+      return false;
+  }
+
+  // check for nested sdf
+  std::string refSDFStr = _sdf->ReferenceSDF();
+  if (!refSDFStr.empty())
+  {
+    ElementPtr refSDF;
+    refSDF.reset(new Element);
+    std::string refFilename = refSDFStr + ".sdf";
+    initFile(refFilename, refSDF);
+    _sdf->RemoveFromParent();
+    _sdf->Copy(refSDF);
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Read an attribute of an XML element into an element.
+/// \param[in,out] _sdf Element to read into.
+/// \param[in] _xmlName Name of the XML element.
+/// \param[in] _name Name of the attribute.
+/// \param[in] _value Value of the attribute.
+/// \param[in] _config Parser configuration.
+/// \param[out] _errors Captures errors found during parsing.
+/// \return False if the value of the attribute is invalid.
+static bool readXmlAttribute(const ElementPtr &_sdf, const char *_xmlName,
+    const char *_name, const char *_value, const ParserConfig &_config,
+    Errors &_errors)
+{
+  // Avoid printing a warning message for missing attributes if a namespaced
+  // attribute is found
+  if (std::strchr(_name, ':') != NULL)
+  {
+    _sdf->AddAttribute(_name, "string", "", 1, "");
+    _sdf->GetAttribute(_name)->SetFromString(_value);
+    return true;
+  }
+
+  // Find the matching attribute in SDF
+  ParamPtr p = _sdf->GetAttribute(_name);
+  if (p)
+  {
+    if (!_config.TrustedInput() &&
+        isFrameReferenceAttribute(_sdf->GetName(), _name))
+    {
+      if (!isValidFrameReference(_value))
+      {
+        addError(_errors, _config, ErrorCode::ATTRIBUTE_INVALID, [&]
+            {
+              return "'" + std::string(_value) +
+                  "' is reserved; it cannot be used as a value of "
+                  "attribute [" + p->GetKey() + "]";
+            });
+      }
+    }
+    // Set the value of the SDF attribute
+    if (!p->SetFromString(_value))
+    {
+      addError(_errors, _config, ErrorCode::ATTRIBUTE_INVALID, [&]
+          {
+            return "Unable to read attribute[" + p->GetKey() + "]";
+          });
+      return false;
+    }
+  }
+  else
+  {
+    sdfwarn << "XML Attribute[" << _name
+            << "] in element[" << _xmlName
+            << "] not defined in SDF, ignoring.\n";
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that all the required attributes of an element are set.
+/// \param[in] _sdf Element to check.
+/// \param[in] _xmlName Name of the XML element.
+/// \param[in] _config Parser configuration.
+/// \param[out] _errors Captures errors found during parsing.
+/// \return False if a required attribute is missing.
+static bool checkXmlAttributes(const ElementPtr &_sdf, const char *_xmlName,
+    const ParserConfig &_config, Errors &_errors)
+{
+  if (_config.TrustedInput())
+    return true;
+
+  for (unsigned int i = 0; i < _sdf->GetAttributeCount(); ++i)
+  {
+    ParamPtr p = _sdf->GetAttribute(i);
+    if (p->GetRequired() && !p->GetSet())
+    {
+      addError(_errors, _config, ErrorCode::ATTRIBUTE_MISSING, [&]
+          {
+            return "Required attribute[" + p->GetKey() + "] in element[" +
+                _xmlName + "] is not specified in SDF.";
+          });
+      return false;
+    }
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Read the value and attributes of an element from XML, without
+/// its children.
+/// \param[in] _xml Pointer to the TinyXML element, or nullptr if the
+/// element is absent.
+/// \param[in,out] _sdf Element to read into.
+/// \param[in] _config Parser configuration.
+/// \param[out] _errors Captures errors found during parsing.
+/// \return Whether the element failed, is done, or has children to read.
+static ReadXmlStep readXmlElement(tinyxml2::XMLElement *_xml,
+    ElementPtr _sdf, const ParserConfig &_config, Errors &_errors)
+{
+  // Check if the element pointer is deprecated.
+  if (_sdf->GetRequired() == "-1")
+  {
+    sdfwarn << "SDF Element[" + _sdf->GetName() + "] is deprecated\n";
+  }
+
+  if (!_xml)
+  {
+    if (_sdf->GetRequired() == "1" || _sdf->GetRequired() =="+")
+    {
+      addError(_errors, _config, ErrorCode::ELEMENT_MISSING, [&]
+          {
+            return "SDF Element<" + _sdf->GetName() + "> is missing";
+          });
+      return ReadXmlStep::FAILED;
+    }
+    else
+    {
+      return ReadXmlStep::DONE;
+    }
+  }
+
+  if (const SourceRanges *ranges = SourceRangeScope::Current())
+  {
+    if (const TextRange *range = ranges->Find(_xml))
+      _sdf->SetSourceRange(*range);
+  }
+
+  if (!readXmlValue(_xml->GetText(), _sdf))
+    return ReadXmlStep::FAILED;
+
+  // Iterate over all the attributes defined in the give XML element
+  for (const tinyxml2::XMLAttribute *attribute = _xml->FirstAttribute();
+       attribute; attribute = attribute->Next())
+  {
+    if (!readXmlAttribute(_sdf, _xml->Value(), attribute->Name(),
+            attribute->Value(), _config, _errors))
+    {
+      return ReadXmlStep::FAILED;
+    }
+  }
+
+  // Check that all required attributes have been set
+  if (!checkXmlAttributes(_sdf, _xml->Value(), _config, _errors))
+    return ReadXmlStep::FAILED;
+
+  // Defer the children of the configured elements until they are accessed.
+  // Elements that include files are read now, so that the included files
+  // are known to the include and load caches.
+  if (_xml->FirstChildElement() &&
+      (_config.LazyElements().count(_sdf->GetName()) != 0 ||
+       (_config.LazyCopyChildren() && _sdf->GetCopyChildren())) &&
+      !hasInclude(_xml))
+  {
+    tinyxml2::XMLPrinter printer(nullptr, true);
+    _xml->Accept(&printer);
+    LazyChildren::Defer(_sdf, printer.CStr(), _config);
+    return ReadXmlStep::DONE;
+  }
+
+  return ReadXmlStep::CHILDREN;
+}
+
+//////////////////////////////////////////////////
+bool readXml(tinyxml2::XMLElement *_xml, ElementPtr _sdf,
+    const ParserConfig &_config, Errors &_errors)
+{
+  SDF_TRACE_SCOPE_TEXT("sdf::readXml", _sdf->GetName());
+  LoadPhaseTimer timer(LoadPhase::READ_XML);
+
+  // Stop traversing once the error budget of the load is used up.
+  if (loadStopped(_errors, _config))
+    return false;
+
+  const ReadXmlStep step = readXmlElement(_xml, _sdf, _config, _errors);
+  if (step != ReadXmlStep::CHILDREN)
+    return step == ReadXmlStep::DONE;
+
+  return readXmlChildren(_xml, _sdf, _config, _errors);
+}
+
+//////////////////////////////////////////////////
+/// \brief Prepare reading the children of a frame of readXmlChildren.
+/// \param[in,out] _frame Frame to prepare.
+/// \param[in] _config Parser configuration.
+/// \return False if the children were copied as they are, and there is
+/// nothing left to read.
+static bool beginReadXmlChildren(ReadXmlFrame &_frame,
+    const ParserConfig &_config)
+{
+  if (_frame.sdf->GetCopyChildren())
+  {
+    copyChildren(_frame.sdf, _frame.xml, false);
+    return false;
+  }
+
+  // Resolve and read the included files up front when more than one
+  // thread is allowed, so that only merging them into the element is
+  // sequential.
+  // The includes outside the region of the load are not read, and
+  // readXmlChild leaves them out before it takes a result.
+  std::vector<tinyxml2::XMLElement *> includesXml;
+  if (_config.LoadThreadCount() != 1)
+  {
+    const bool isWorld = hasName(_frame.sdf, kWorldSymbol);
+    std::string name;
+    ignition::math::Pose3d pose;
+    for (tinyxml2::XMLElement *child = firstChildXml(_frame.xml); child;
+         child = nextSiblingXml(child))
+    {
+      if (std::strcmp(child->Value(), "include") == 0 &&
+          (!isWorld || !isOutOfRegion(child, _config, name, pose)))
+      {
+        includesXml.push_back(child);
+      }
+    }
+  }
+  if (includesXml.size() > 1)
+  {
+    // The includes of included files are resolved by tasks of the same
+    // executor, so that the threads that finish their includes early help
+    // with the larger ones.
+    _frame.includes.resize(includesXml.size());
+    parallelFor(includesXml.size(), _config.LoadThreadCount(),
+        [&](std::size_t _index)
         {
-          topLevelElem->GetElement("static")->GetValue()->SetFromString(
-                elemXml->FirstChildElement("static")->GetText());
-        }
+          resolveInclude(includesXml[_index], _config,
+              _frame.includes[_index]);
+        });
+  }
+
+  _frame.next = firstChildXml(_frame.xml);
+  return true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Add a child element that was read completely to its parent, and
+/// hand it to the pipelined loader of the current Root::Load if it is a
+/// model of a world. \sa ModelPreloader
+/// \param[in] _parent Parent element.
+/// \param[in] _child Child element.
+static void insertRead(const ElementPtr &_parent, const ElementPtr &_child)
+{
+  _parent->InsertElement(_child);
+  ModelPreloader *preloader = ModelPreloadScope::Current();
+  if (preloader && hasName(_child, kModelSymbol) &&
+      hasName(_parent, kWorldSymbol))
+  {
+    preloader->Submit(_child);
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Read one XML child of a frame of readXmlChildren.
+/// \param[in,out] _frame Frame of the parent element.
+/// \param[in] _xml XML child to read.
+/// \param[in] _config Parser configuration.
+/// \param[out] _errors Captures errors found during parsing.
+/// \param[out] _element Set to the new element when its children remain to
+/// be read. It is added to the parent once they have been.
+/// \return Whether reading the child failed, is done, or continues with
+/// its children.
+static ReadXmlStep readXmlChild(ReadXmlFrame &_frame,
+    tinyxml2::XMLElement *_xml, const ParserConfig &_config, Errors &_errors,
+    ElementPtr &_element)
+{
+  // Models outside the region of the load are left out, and recorded so
+  // that Root::Load can report the references to them.
+  if (_config.RegionFilter() && hasName(_frame.sdf, kWorldSymbol))
+  {
+    RegionExclusion exclusion;
+    if (isOutOfRegion(_xml, _config, exclusion.name, exclusion.pose))
+    {
+      if (RegionExclusionScope::Exclusions())
+      {
+        exclusion.world = _frame.sdf.get();
+        RegionExclusionScope::Exclusions()->push_back(std::move(exclusion));
+      }
+      return ReadXmlStep::DONE;
+    }
+  }
+
+  if (std::string("include") == _xml->Value())
+  {
+    IncludeResult include;
+    if (_frame.includeIndex < _frame.includes.size())
+      include = std::move(_frame.includes[_frame.includeIndex++]);
+    else
+      resolveInclude(_xml, _config, include);
+
+    _errors.insert(_errors.end(), include.errors.begin(),
+        include.errors.end());
+    if (include.action == IncludeResult::SKIP)
+      return ReadXmlStep::DONE;
+    if (include.action == IncludeResult::FAIL)
+      return ReadXmlStep::FAILED;
+
+    // Let an enclosing include know which files this one came from.
+    if (g_includeFiles)
+    {
+      g_includeFiles->insert(g_includeFiles->end(),
+          include.files.begin(), include.files.end());
+    }
+
+    SDFPtr includeSDF = include.sdf;
 
-        if (isModel && elemXml->FirstChildElement("placement_frame"))
+    sdf::ElementPtr topLevelElem;
+    bool isModel{false};
+    bool isActor{false};
+    if (includeSDF->Root()->HasElement("model"))
+    {
+      topLevelElem = includeSDF->Root()->GetElement("model");
+      isModel = true;
+    }
+    else if (includeSDF->Root()->HasElement("actor"))
+    {
+      topLevelElem = includeSDF->Root()->GetElement("actor");
+      isActor = true;
+    }
+    else if (includeSDF->Root()->HasElement("light"))
+    {
+      topLevelElem = includeSDF->Root()->GetElement("light");
+    }
+    else
+    {
+      addError(_errors, _config, ErrorCode::ELEMENT_MISSING, []
+          {
+            return "Failed to find top level <model> / <actor> / "
+                "<light> for <include>\n";
+          });
+      return ReadXmlStep::DONE;
+    }
+
+    if (_xml->FirstChildElement("name"))
+    {
+      topLevelElem->GetAttribute("name")->SetFromString(
+            _xml->FirstChildElement("name")->GetText());
+    }
+
+    tinyxml2::XMLElement *poseElemXml = _xml->FirstChildElement("pose");
+    if (poseElemXml)
+    {
+      sdf::ElementPtr poseElem = topLevelElem->GetElement("pose");
+
+      if (poseElemXml->GetText())
+      {
+        poseElem->GetValue()->SetFromString(poseElemXml->GetText());
+      }
+      else
+      {
+        poseElem->GetValue()->Reset();
+      }
+
+      const char *relativeTo = poseElemXml->Attribute("relative_to");
+      if (relativeTo)
+      {
+        poseElem->GetAttribute("relative_to")->SetFromString(relativeTo);
+      }
+      else
+      {
+        poseElem->GetAttribute("relative_to")->Reset();
+      }
+    }
+
+    if (isModel && _xml->FirstChildElement("static"))
+    {
+      topLevelElem->GetElement("static")->GetValue()->SetFromString(
+            _xml->FirstChildElement("static")->GetText());
+    }
+
+    if (isModel && _xml->FirstChildElement("placement_frame"))
+    {
+      if (nullptr == _xml->FirstChildElement("pose"))
+      {
+        addError(_errors, _config,
+            ErrorCode::MODEL_PLACEMENT_FRAME_INVALID, []
+            {
+              return "<pose> is required when specifying the "
+                  "placement_frame element";
+            });
+        return ReadXmlStep::FAILED;
+      }
+
+      const std::string placementFrameVal =
+          _xml->FirstChildElement("placement_frame")->GetText();
+
+      if (!_config.TrustedInput() &&
+          !isValidFrameReference(placementFrameVal))
+      {
+        addError(_errors, _config, ErrorCode::RESERVED_NAME, [&]
+            {
+              return "'" + placementFrameVal +
+                  "' is reserved; it cannot be used as a value of "
+                  "element [placement_frame]";
+            });
+      }
+      topLevelElem->GetAttribute("placement_frame")
+          ->SetFromString(placementFrameVal);
+    }
+
+    if (isModel || isActor)
+    {
+      for (auto *childElemXml = _xml->FirstChildElement();
+           childElemXml; childElemXml = childElemXml->NextSiblingElement())
+      {
+        if (std::string("plugin") == childElemXml->Value() &&
+            !isSkipped(_config, "plugin"))
         {
-          if (nullptr == elemXml->FirstChildElement("pose"))
+          sdf::ElementPtr pluginElem;
+          pluginElem = topLevelElem->AddElement("plugin");
+
+          if (!readXml(childElemXml, pluginElem, _config, _errors))
           {
-            _errors.push_back({ErrorCode::MODEL_PLACEMENT_FRAME_INVALID,
-                "<pose> is required when specifying the placement_frame "
-                "element"});
-            return false;
+            addError(_errors, _config, ErrorCode::ELEMENT_INVALID, []
+                {
+                  return "Error reading plugin element";
+                });
+            return ReadXmlStep::FAILED;
           }
+        }
+      }
+    }
+
+    // The included element takes the range of the <include> that
+    // replaces it in the text of the document.
+    if (const SourceRanges *ranges = SourceRangeScope::Current())
+    {
+      if (const TextRange *range = ranges->Find(_xml))
+        includeSDF->Root()->GetFirstElement()->SetSourceRange(*range);
+    }
+    includeSDF->Root()->GetFirstElement()->SetParent(_frame.sdf);
+    insertRead(_frame.sdf, includeSDF->Root()->GetFirstElement());
+
+    // Models included in worlds are recorded for Root::ReloadIncludes.
+    if (isModel && IncludeRecordScope::Records() &&
+        hasName(_frame.sdf, kWorldSymbol))
+    {
+      tinyxml2::XMLPrinter printer(nullptr, true);
+      _xml->Accept(&printer);
+      IncludeRecordScope::Records()->push_back(
+          {topLevelElem, printer.CStr(), std::move(include.files)});
+    }
+    // TODO: This was used to store the included filename so that when
+    // a world is saved, the included model's SDF is not stored in the
+    // world file. This highlights the need to make model inclusion
+    // a core feature of SDF, and not a hack that that parser handles
+    // includeSDF->Root()->GetFirstElement()->SetInclude(
+    // _xml->Attribute("filename"));
+
+    return ReadXmlStep::DONE;
+  }
+
+  if (isSkipped(_config, _xml->Value()))
+    return ReadXmlStep::DONE;
+
+  // Find the matching element in SDF
+  ElementPtr elemDesc = _frame.sdf->GetElementDescription(_xml->Value());
+  if (!elemDesc)
+  {
+    sdfdbg << "XML Element[" << _xml->Value()
+           << "], child of element[" << _frame.xml->Value()
+           << "], not defined in SDF. Copying[" << _xml->Value() << "] "
+           << "as children of [" << _frame.xml->Value() << "].\n";
+    return ReadXmlStep::DONE;
+  }
 
-          const std::string placementFrameVal =
-              elemXml->FirstChildElement("placement_frame")->GetText();
+  _element = elemDesc->Instantiate();
+  _element->SetParent(_frame.sdf);
 
-          if (!isValidFrameReference(placementFrameVal))
+  // Each element read is counted, as a call to readXml is.
+  LoadPhaseTimer timer(LoadPhase::READ_XML);
+  const ReadXmlStep step = readXmlElement(_xml, _element, _config, _errors);
+  if (step == ReadXmlStep::FAILED)
+  {
+    addError(_errors, _config, ErrorCode::ELEMENT_INVALID, [&]
+        {
+          return std::string("Error reading element <") + _xml->Value() + ">";
+        });
+  }
+  else if (step == ReadXmlStep::DONE)
+  {
+    insertRead(_frame.sdf, _element);
+  }
+  return step;
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that all the required child elements of an element are
+/// set, and add the missing ones that have a default.
+/// \param[in,out] _sdf Element to check.
+/// \param[in] _config Parser configuration.
+/// \param[out] _errors Captures errors found during parsing.
+/// \return False if a required element is missing.
+static bool checkXmlElements(const ElementPtr &_sdf,
+    const ParserConfig &_config, Errors &_errors)
+{
+  for (unsigned int descCounter = 0;
+       descCounter != _sdf->GetElementDescriptionCount(); ++descCounter)
+  {
+    ElementPtr elemDesc = _sdf->GetElementDescription(descCounter);
+
+    if ((elemDesc->GetRequired() == "1" || elemDesc->GetRequired() == "+") &&
+        !isSkipped(_config, elemDesc->GetName()))
+    {
+      if (!_sdf->HasElement(elemDesc->GetName()))
+      {
+        if (hasName(_sdf, kJointSymbol) &&
+            _sdf->Get<std::string>("type") != "ball")
+        {
+          addError(_errors, _config, ErrorCode::ELEMENT_MISSING, [&]
+              {
+                return "XML Missing required element[" +
+                    elemDesc->GetName() + "], child of element[" +
+                    _sdf->GetName() + "]";
+              });
+          return false;
+        }
+        else
+        {
+          // Add default element
+          _sdf->AddElement(elemDesc->GetName());
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Finish a frame of readXmlChildren once all its XML children have
+/// been read.
+/// \param[in,out] _frame Frame to finish.
+/// \param[in] _config Parser configuration.
+/// \param[out] _errors Captures errors found during parsing.
+/// \return True on success, false on error.
+static bool endReadXmlChildren(ReadXmlFrame &_frame,
+    const ParserConfig &_config, Errors &_errors)
+{
+  // Copy unknown elements after the known ones so it only happens one time
+  copyChildren(_frame.sdf, _frame.xml, true);
+
+  // Check that all required elements have been set
+  if (!checkXmlElements(_frame.sdf, _config, _errors))
+    return false;
+
+  // Check the names of the children while they are at hand. The result is
+  // kept by the element for the DOM load and the validation functions.
+  if (!_config.TrustedInput())
+    _frame.sdf->HasUniqueChildNames();
+  return true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Reading of the children of an element, depth first with an
+/// explicit stack of the elements whose children are being read. A child
+/// is added to its parent once its own children have been read, as with a
+/// recursive traversal. Reading can stop after a number of elements and
+/// resume later, for IncrementalRead.
+class XmlChildrenRead
+{
+  /// \brief Constructor
+  /// \param[in] _xml XML element whose children are read.
+  /// \param[in] _sdf Element the children are added to.
+  /// \param[in] _config Parser configuration.
+  public: XmlChildrenRead(tinyxml2::XMLElement *_xml, ElementPtr _sdf,
+      const ParserConfig &_config)
+  {
+    this->stack.emplace_back(_xml, std::move(_sdf));
+    if (!beginReadXmlChildren(this->stack.back(), _config))
+      this->stack.clear();
+  }
+
+  /// \brief Read more children.
+  /// \param[in] _limit Maximum number of XML elements to read.
+  /// \param[in] _config Parser configuration.
+  /// \param[out] _errors Captures errors found during parsing.
+  /// \return True once all the children are read, or reading failed.
+  public: bool Step(std::size_t _limit, const ParserConfig &_config,
+      Errors &_errors)
+  {
+    for (std::size_t read = 0; !this->stack.empty();)
+    {
+      ReadXmlFrame &frame = this->stack.back();
+      if (frame.next)
+      {
+        if (read == _limit)
+          return false;
+
+        if (loadStopped(_errors, _config))
+          break;
+
+        tinyxml2::XMLElement *childXml = frame.next;
+        frame.next = nextSiblingXml(childXml);
+
+        ElementPtr child;
+        ++read;
+        ++this->count;
+        const ReadXmlStep step =
+            readXmlChild(frame, childXml, _config, _errors, child);
+        if (step == ReadXmlStep::FAILED)
+          break;
+
+        if (step == ReadXmlStep::CHILDREN)
+        {
+          // This invalidates frame.
+          this->stack.emplace_back(childXml, child);
+          if (!beginReadXmlChildren(this->stack.back(), _config))
           {
-            _errors.push_back({ErrorCode::RESERVED_NAME,
-                "'" + placementFrameVal +
-                    "' is reserved; it cannot be used as a value of "
-                    "element [placement_frame]"});
+            this->stack.pop_back();
+            insertRead(this->stack.back().sdf, child);
           }
-          topLevelElem->GetAttribute("placement_frame")
-              ->SetFromString(placementFrameVal);
         }
+        continue;
+      }
 
-        if (isModel || isActor)
-        {
-          for (auto *childElemXml = elemXml->FirstChildElement();
-               childElemXml; childElemXml = childElemXml->NextSiblingElement())
+      if (!endReadXmlChildren(frame, _config, _errors))
+        break;
+
+      if (this->stack.size() == 1)
+      {
+        this->stack.clear();
+        return true;
+      }
+
+      ElementPtr done = std::move(frame.sdf);
+      this->stack.pop_back();
+      insertRead(this->stack.back().sdf, done);
+    }
+
+    if (this->stack.empty())
+      return true;
+
+    // Each enclosing element fails in turn, from the innermost one out.
+    while (this->stack.size() > 1)
+    {
+      tinyxml2::XMLElement *failedXml = this->stack.back().xml;
+      this->stack.pop_back();
+      addError(_errors, _config, ErrorCode::ELEMENT_INVALID, [&]
           {
-            if (std::string("plugin") == childElemXml->Value())
+            return std::string("Error reading element <") +
+                failedXml->Value() + ">";
+          });
+    }
+    this->stack.clear();
+    this->failed = true;
+    return true;
+  }
+
+  /// \brief Get whether reading failed.
+  /// \return True if reading an element failed.
+  public: bool Failed() const
+  {
+    return this->failed;
+  }
+
+  /// \brief Get the number of XML elements read.
+  /// \return Number of elements read by the steps so far.
+  public: std::size_t Count() const
+  {
+    return this->count;
+  }
+
+  /// \brief The elements whose children are being read, from the outermost
+  /// one in.
+  private: std::vector<ReadXmlFrame> stack;
+
+  /// \brief Number of XML elements read.
+  private: std::size_t count = 0;
+
+  /// \brief True if reading failed.
+  private: bool failed = false;
+};
+
+//////////////////////////////////////////////////
+static bool readXmlChildren(tinyxml2::XMLElement *_xml, ElementPtr _sdf,
+    const ParserConfig &_config, Errors &_errors)
+{
+  XmlChildrenRead read(_xml, std::move(_sdf), _config);
+  read.Step(std::numeric_limits<std::size_t>::max(), _config, _errors);
+  return !read.Failed();
+}
+
+//////////////////////////////////////////////////
+class IncrementalReadPrivate
+{
+  /// \brief Constructor
+  /// \param[in] _filename Name of the file to read.
+  /// \param[in] _config Parser configuration.
+  public: IncrementalReadPrivate(const std::string &_filename,
+      const ParserConfig &_config)
+    : filename(_filename), config(_config)
+  {
+  }
+
+  /// \brief Parse the file, and read the element at its root.
+  /// \param[out] _errors Captures errors found during parsing.
+  /// \return True if the file is read, false if its children remain to be
+  /// read or reading it failed, in which case sdf is null.
+  public: bool Begin(Errors &_errors)
+  {
+    this->sdf.reset(new SDF());
+    init(this->sdf);
+
+    std::string path = sdf::findFile(this->filename, true, true,
+        this->config);
+    if (path.empty())
+    {
+      sdferr << "Error finding file [" << this->filename << "].\n";
+      this->sdf.reset();
+      return false;
+    }
+
+    const VirtualFilesystem &fs = FindFileSettings::FilesystemOf(this->config);
+    if (fs.IsDirectory(path))
+    {
+      path = getModelFilePath(path, fs);
+    }
+
+    if (!fs.Exists(path))
+    {
+      sdferr << "File [" << path << "] doesn't exist.\n";
+      this->sdf.reset();
+      return false;
+    }
+
+    // The other ways of reading a file don't keep the XML of the elements
+    // that remain to be read, so these files are read at once.
+    tinyxml2::XMLError errorCode = tinyxml2::XML_SUCCESS;
+    if (!this->config.StreamingRead() && !this->config.ChunkedXmlParse())
+    {
+      LoadPhaseTimer timer(LoadPhase::XML_PARSE);
+      errorCode = loadXmlFile(path, this->xmlDoc, fs);
+    }
+    if (this->config.StreamingRead() || this->config.ChunkedXmlParse() ||
+        URDF2SDF::IsURDF(this->xmlDoc))
+    {
+      this->xmlDoc.Clear();
+      if (!readFileInternal(path, this->sdf, true, this->config, _errors))
+        this->sdf.reset();
+      return true;
+    }
+    if (errorCode)
+    {
+      sdferr << "Error parsing XML in file [" << path << "]: "
+             << this->xmlDoc.ErrorStr() << '\n';
+      this->sdf.reset();
+      return false;
+    }
+
+    tinyxml2::XMLElement *elemXml = nullptr;
+    if (!beginReadDoc(&this->xmlDoc, this->sdf, path, true, this->config,
+            elemXml) || loadStopped(_errors, this->config))
+    {
+      this->sdf.reset();
+      return false;
+    }
+
+    // The root element is read like readXml does.
+    LoadPhaseTimer timer(LoadPhase::READ_XML);
+    ++this->elementCount;
+    const ReadXmlStep step =
+        readXmlElement(elemXml, this->sdf->Root(), this->config, _errors);
+    if (step == ReadXmlStep::CHILDREN)
+    {
+      this->children.emplace(elemXml, this->sdf->Root(), this->config);
+      return false;
+    }
+    if (step == ReadXmlStep::FAILED)
+      this->Fail(_errors);
+    return true;
+  }
+
+  /// \brief Report that the element at the root of the file failed.
+  /// \param[out] _errors Captures errors found during parsing.
+  public: void Fail(Errors &_errors)
+  {
+    addError(_errors, this->config, ErrorCode::ELEMENT_INVALID, [&]
+        {
+          return "Error reading element <" + this->sdf->Root()->GetName() +
+              ">";
+        });
+    this->sdf.reset();
+  }
+
+  /// \brief Name of the file to read.
+  public: std::string filename;
+
+  /// \brief Parser configuration.
+  public: const ParserConfig &config;
+
+  /// \brief The document.
+  public: SDFPtr sdf;
+
+  /// \brief The XML of the document, while its elements are read.
+  public: tinyxml2::XMLDocument xmlDoc;
+
+  /// \brief Reading of the children of the root element, once it is read.
+  public: std::optional<XmlChildrenRead> children;
+
+  /// \brief Arena of the elements of the document, if the configuration
+  /// uses one, kept between the steps.
+  public: std::shared_ptr<ElementArena> arena;
+
+  /// \brief Number of XML elements read before the children of the root
+  /// element, or by all the steps once the file is read.
+  public: std::size_t elementCount = 0;
+
+  /// \brief True once Begin was called.
+  public: bool started = false;
+
+  /// \brief True once the file is read, or reading it failed.
+  public: bool done = false;
+};
+
+//////////////////////////////////////////////////
+IncrementalRead::IncrementalRead(const std::string &_filename,
+    const ParserConfig &_config)
+  : dataPtr(std::make_unique<IncrementalReadPrivate>(_filename, _config))
+{
+}
+
+//////////////////////////////////////////////////
+IncrementalRead::~IncrementalRead() = default;
+
+//////////////////////////////////////////////////
+bool IncrementalRead::Step(std::size_t _elements, Errors &_errors)
+{
+  IncrementalReadPrivate &data = *this->dataPtr;
+  if (data.done)
+    return true;
+
+  SDF_TRACE_SCOPE_TEXT("sdf::IncrementalRead::Step", data.filename);
+  const ParserConfig &config = data.config;
+  LoadStatsScope statsScope(config);
+  DiagnosticScope diagnosticScope(config);
+  ElementReclaimScope reclaimScope(config);
+  ExecutorScope executorScope(config);
+
+  // The first step makes the arena of the document, if the configuration
+  // uses one, and the next steps allocate from it.
+  if (!data.started)
+  {
+    ElementArenaScope configScope(config);
+    data.arena = ElementArenaScope::Current();
+  }
+  ElementArenaScope arenaScope(data.arena);
+
+  if (!data.started)
+  {
+    data.started = true;
+    data.done = data.Begin(_errors) || !data.sdf;
+  }
+  else
+  {
+    LoadPhaseTimer timer(LoadPhase::READ_XML);
+    if (data.children->Step(_elements, config, _errors))
+    {
+      if (data.children->Failed())
+        data.Fail(_errors);
+      data.done = true;
+    }
+  }
+
+  if (data.done)
+  {
+    data.elementCount = this->ElementCount();
+    data.children.reset();
+    data.xmlDoc.Clear();
+    reportCancellation(_errors, config);
+  }
+  return data.done;
+}
+
+//////////////////////////////////////////////////
+std::size_t IncrementalRead::ElementCount() const
+{
+  return this->dataPtr->elementCount +
+      (this->dataPtr->children ? this->dataPtr->children->Count() : 0u);
+}
+
+//////////////////////////////////////////////////
+SDFPtr IncrementalRead::Document() const
+{
+  return this->dataPtr->done ? this->dataPtr->sdf : SDFPtr();
+}
+
+//////////////////////////////////////////////////
+/// \brief An element whose children are being read by readStream.
+struct StreamFrame
+{
+  /// \brief Constructor
+  /// \param[in] _sdf Element the children are added to.
+  /// \param[in] _name Name of the XML element.
+  StreamFrame(ElementPtr _sdf, std::string _name)
+    : sdf(std::move(_sdf)), name(std::move(_name))
+  {
+  }
+
+  /// \brief Element the children are added to.
+  ElementPtr sdf;
+
+  /// \brief Name of the XML element.
+  std::string name;
+
+  /// \brief Children that are not in the specification, which are copied
+  /// once all the other children have been read, or nullptr if there are
+  /// none.
+  tinyxml2::XMLElement *unknown = nullptr;
+};
+
+//////////////////////////////////////////////////
+/// \brief Read the value and attributes of the element of the last start
+/// tag of a stream, as readXmlElement does.
+/// \param[in,out] _reader Reader positioned after the start tag.
+/// \param[in,out] _sdf Element to read into.
+/// \param[in] _config Parser configuration.
+/// \param[out] _errors Captures errors found during parsing.
+/// \return True on success, false on error.
+static bool readStreamElement(XmlStreamReader &_reader,
+    const ElementPtr &_sdf, const ParserConfig &_config, Errors &_errors)
+{
+  if (_sdf->GetRequired() == "-1")
+  {
+    sdfwarn << "SDF Element[" + _sdf->GetName() + "] is deprecated\n";
+  }
+
+  std::string text;
+  const bool hasText = _reader.ReadText(text);
+  if (!readXmlValue(hasText ? text.c_str() : nullptr, _sdf))
+    return false;
+
+  const char *xmlName = _reader.Name().c_str();
+  for (const auto &attribute : _reader.Attributes())
+  {
+    if (!readXmlAttribute(_sdf, xmlName, attribute.first.c_str(),
+            attribute.second.c_str(), _config, _errors))
+    {
+      return false;
+    }
+  }
+  return checkXmlAttributes(_sdf, xmlName, _config, _errors);
+}
+
+//////////////////////////////////////////////////
+/// \brief Read the child element of the last start tag of a stream.
+/// \param[in,out] _reader Reader positioned after the start tag.
+/// \param[in,out] _frame Frame of the parent element.
+/// \param[in,out] _scratch Document of the subtrees that are read as XML.
+/// \param[in] _config Parser configuration.
+/// \param[out] _errors Captures errors found during parsing.
+/// \param[out] _element Set to the new element when its children remain to
+/// be read from the stream. It is added to the parent once they have been.
+/// \return Whether reading the child failed, is done, or continues with
+/// its children.
+static ReadXmlStep readStreamChild(XmlStreamReader &_reader,
+    StreamFrame &_frame, tinyxml2::XMLDocument &_scratch,
+    const ParserConfig &_config, Errors &_errors, ElementPtr &_element)
+{
+  const std::string name = _reader.Name();
+  const bool isInclude = name == "include";
+  if (!isInclude && isSkipped(_config, name))
+    return _reader.SkipElement() ? ReadXmlStep::DONE : ReadXmlStep::FAILED;
+
+  ElementPtr elemDesc;
+  if (!isInclude)
+    elemDesc = _frame.sdf->GetElementDescription(name);
+
+  // Includes, elements that are not in the specification, and elements
+  // whose children are copied or deferred are handled as XML. Only their
+  // own subtree is built as tinyxml2 nodes, and read as readXml does. So
+  // are the models of worlds that are filtered by region, whose pose may
+  // come after their other children.
+  if (!elemDesc || elemDesc->GetCopyChildren() ||
+      _config.LazyElements().count(name) != 0 ||
+      (_config.RegionFilter() && name == "model" && _frame.name == "world"))
+  {
+    tinyxml2::XMLElement *xml = _reader.ReadElement(_scratch);
+    if (!xml)
+      return ReadXmlStep::FAILED;
+
+    if (!isInclude && !elemDesc)
+    {
+      if (!_frame.unknown)
+        _frame.unknown = _scratch.NewElement(_frame.name.c_str());
+      _frame.unknown->InsertEndChild(xml);
+      return ReadXmlStep::DONE;
+    }
+
+    tinyxml2::XMLElement *parentXml =
+        _scratch.NewElement(_frame.name.c_str());
+    parentXml->InsertEndChild(xml);
+    ReadXmlFrame frame(parentXml, _frame.sdf);
+    ElementPtr child;
+    ReadXmlStep step = readXmlChild(frame, xml, _config, _errors, child);
+    if (step == ReadXmlStep::CHILDREN)
+    {
+      if (readXmlChildren(xml, child, _config, _errors))
+      {
+        insertRead(_frame.sdf, child);
+        step = ReadXmlStep::DONE;
+      }
+      else
+      {
+        addError(_errors, _config, ErrorCode::ELEMENT_INVALID, [&]
             {
-              sdf::ElementPtr pluginElem;
-              pluginElem = topLevelElem->AddElement("plugin");
+              return "Error reading element <" + name + ">";
+            });
+        step = ReadXmlStep::FAILED;
+      }
+    }
+    _scratch.DeleteNode(parentXml);
+    return step;
+  }
+
+  _element = elemDesc->Instantiate();
+  _element->SetParent(_frame.sdf);
+
+  // Each element read is counted, as a call to readXml is.
+  LoadPhaseTimer timer(LoadPhase::READ_XML);
+  if (!readStreamElement(_reader, _element, _config, _errors))
+  {
+    addError(_errors, _config, ErrorCode::ELEMENT_INVALID, [&]
+        {
+          return "Error reading element <" + name + ">";
+        });
+    return ReadXmlStep::FAILED;
+  }
+  return ReadXmlStep::CHILDREN;
+}
+
+//////////////////////////////////////////////////
+static StreamReadResult readStream(const char *_data, std::size_t _size,
+    SDFPtr _sdf, const std::string &_source, bool _convert,
+    const ParserConfig &_config, Errors &_errors)
+{
+  XmlStreamReader reader(_data, _size);
+  if (reader.Next() != XmlStreamReader::Token::START ||
+      reader.Name() != "sdf")
+  {
+    return StreamReadResult::UNSUPPORTED;
+  }
+
+  const char *version = reader.Attribute("version");
+  if (!version || (_convert && SDF::Version() != version))
+    return StreamReadResult::UNSUPPORTED;
+
+  if (nullptr == _sdf || nullptr == _sdf->Root() ||
+      _sdf->Root()->GetName() != reader.Name())
+  {
+    return StreamReadResult::UNSUPPORTED;
+  }
+
+  if (_source != "data-string")
+  {
+    _sdf->SetFilePath(_source);
+  }
+  if (_sdf->OriginalVersion().empty())
+  {
+    _sdf->SetOriginalVersion(version);
+  }
+  if (_sdf->Root()->OriginalVersion().empty())
+  {
+    _sdf->Root()->SetOriginalVersion(version);
+  }
 
-              if (!readXml(childElemXml, pluginElem, _errors))
-              {
-                _errors.push_back({ErrorCode::ELEMENT_INVALID,
-                                   "Error reading plugin element"});
-                return false;
-              }
-            }
-          }
-        }
+  prefetchIncludes(_data, _size, _config);
 
-        includeSDF->Root()->GetFirstElement()->SetParent(_sdf);
-        _sdf->InsertElement(includeSDF->Root()->GetFirstElement());
-        // TODO: This was used to store the included filename so that when
-        // a world is saved, the included model's SDF is not stored in the
-        // world file. This highlights the need to make model inclusion
-        // a core feature of SDF, and not a hack that that parser handles
-        // includeSDF->Root()->GetFirstElement()->SetInclude(
-        // elemXml->Attribute("filename"));
+  LoadPhaseTimer timer(LoadPhase::READ_XML);
 
-        continue;
-      }
+  // The subtrees that are read as XML are built in this document, and
+  // deleted as soon as they have been read.
+  tinyxml2::XMLDocument scratch;
 
-      // Find the matching element in SDF
-      unsigned int descCounter = 0;
-      for (descCounter = 0;
-           descCounter != _sdf->GetElementDescriptionCount(); ++descCounter)
+  // Depth first traversal as in readXmlChildren, driven by the tags of the
+  // stream instead of the children of a DOM.
+  std::vector<StreamFrame> stack;
+  stack.emplace_back(_sdf->Root(), reader.Name());
+  bool success = !loadStopped(_errors, _config) &&
+      readStreamElement(reader, _sdf->Root(), _config, _errors);
+  while (success)
+  {
+    const XmlStreamReader::Token token = reader.Next();
+    if (token == XmlStreamReader::Token::START)
+    {
+      if (loadStopped(_errors, _config))
       {
-        ElementPtr elemDesc = _sdf->GetElementDescription(descCounter);
-        if (elemDesc->GetName() == elemXml->Value())
-        {
-          ElementPtr element = elemDesc->Clone();
-          element->SetParent(_sdf);
-          if (readXml(elemXml, element, _errors))
-          {
-            _sdf->InsertElement(element);
-          }
-          else
-          {
-            _errors.push_back({ErrorCode::ELEMENT_INVALID,
-                std::string("Error reading element <") +
-                elemXml->Value() + ">"});
-            return false;
-          }
-          break;
-        }
+        success = false;
+        break;
       }
 
-      if (descCounter == _sdf->GetElementDescriptionCount())
-      {
-        sdfdbg << "XML Element[" << elemXml->Value()
-               << "], child of element[" << _xml->Value()
-               << "], not defined in SDF. Copying[" << elemXml->Value() << "] "
-               << "as children of [" << _xml->Value() << "].\n";
-        continue;
-      }
+      ElementPtr child;
+      const ReadXmlStep step = readStreamChild(reader, stack.back(), scratch,
+          _config, _errors, child);
+      if (step == ReadXmlStep::FAILED)
+        success = false;
+      else if (step == ReadXmlStep::CHILDREN)
+        stack.emplace_back(child, reader.Name());
+      continue;
     }
 
-    // Copy unknown elements outside the loop so it only happens one time
-    copyChildren(_sdf, _xml, true);
+    if (token != XmlStreamReader::Token::END)
+    {
+      success = false;
+      break;
+    }
 
-    // Check that all required elements have been set
-    for (unsigned int descCounter = 0;
-         descCounter != _sdf->GetElementDescriptionCount(); ++descCounter)
+    StreamFrame &frame = stack.back();
+    if (frame.unknown)
+    {
+      copyChildren(frame.sdf, frame.unknown, true);
+      scratch.DeleteNode(frame.unknown);
+      frame.unknown = nullptr;
+    }
+    if (!checkXmlElements(frame.sdf, _config, _errors))
     {
-      ElementPtr elemDesc = _sdf->GetElementDescription(descCounter);
+      success = false;
+      break;
+    }
+    if (!_config.TrustedInput())
+      frame.sdf->HasUniqueChildNames();
 
-      if (elemDesc->GetRequired() == "1" || elemDesc->GetRequired() == "+")
-      {
-        if (!_sdf->HasElement(elemDesc->GetName()))
+    if (stack.size() == 1)
+      break;
+
+    ElementPtr done = std::move(frame.sdf);
+    stack.pop_back();
+    insertRead(stack.back().sdf, done);
+  }
+
+  if (!reader.Error().empty())
+  {
+    const std::string source = _source == "data-string" ? "from string" :
+        "in file [" + _source + "]";
+    sdferr << "Error parsing XML " << source << ": " << reader.Error() << '\n';
+    return StreamReadResult::FAILURE;
+  }
+
+  if (success)
+    return StreamReadResult::SUCCESS;
+
+  // Each enclosing element fails in turn, from the innermost one out, as
+  // readXmlChildren and readDoc report them.
+  while (!stack.empty())
+  {
+    const std::string failedName = std::move(stack.back().name);
+    stack.pop_back();
+    addError(_errors, _config, ErrorCode::ELEMENT_INVALID, [&]
         {
-          if (_sdf->GetName() == "joint" &&
-              _sdf->Get<std::string>("type") != "ball")
-          {
-            _errors.push_back({ErrorCode::ELEMENT_MISSING,
-                "XML Missing required element[" + elemDesc->GetName() +
-                "], child of element[" + _sdf->GetName() + "]"});
-            return false;
-          }
-          else
-          {
-            // Add default element
-            _sdf->AddElement(elemDesc->GetName());
-          }
-        }
-      }
-    }
+          return "Error reading element <" + failedName + ">";
+        });
   }
+  return StreamReadResult::FAILURE;
+}
 
-  return true;
+//////////////////////////////////////////////////
+void LazyChildren::Defer(const ElementPtr &_elem, std::string _xml,
+    const ParserConfig &_config)
+{
+  auto lazy = std::make_shared<LazyChildren>();
+  lazy->xml = std::move(_xml);
+  lazy->config = _config;
+  // The statistics object and the cancellation token are only guaranteed
+  // to live during the load, and the children are read after it, so they
+  // aren't subject to its deadline either.
+  lazy->config.SetStats(nullptr);
+  lazy->config.SetCancellation(nullptr);
+  lazy->config.SetDeadline(std::chrono::steady_clock::time_point::max());
+  _elem->dataPtr->lazyChildren = std::move(lazy);
+}
+
+//////////////////////////////////////////////////
+void LazyChildren::Read(const ElementPtr &_elem)
+{
+  // Release the children first, so that the accessors used while reading
+  // them do not try to read them again.
+  std::shared_ptr<const LazyChildren> lazy =
+      std::move(_elem->dataPtr->lazyChildren);
+
+  tinyxml2::XMLDocument xmlDoc;
+  Errors errors;
+  if (xmlDoc.Parse(lazy->xml.c_str(), lazy->xml.size()) !=
+      tinyxml2::XML_SUCCESS || !xmlDoc.RootElement())
+  {
+    errors.push_back({ErrorCode::STRING_READ,
+        "Unable to parse the deferred children of element[" +
+        _elem->GetName() + "]: " + xmlDoc.ErrorStr()});
+  }
+  else
+  {
+    readXmlChildren(xmlDoc.RootElement(), _elem, lazy->config, errors);
+  }
+
+  for (const auto &e : errors)
+    sdferr << e << "\n";
+}
+
+//////////////////////////////////////////////////
+ElementPtr SourceRanges::Read(const char *_data, std::size_t _size,
+    const TextRange &_origin, const ElementPtr &_parent,
+    const ParserConfig &_config, Errors &_errors)
+{
+  tinyxml2::XMLDocument xmlDoc;
+  if (xmlDoc.Parse(_data, _size) != tinyxml2::XML_SUCCESS)
+  {
+    _errors.push_back({ErrorCode::STRING_READ,
+        std::string("Error parsing XML from string: ") + xmlDoc.ErrorStr()});
+    return nullptr;
+  }
+  tinyxml2::XMLElement *xml = xmlDoc.RootElement();
+  if (!xml || xml->NextSiblingElement())
+    return nullptr;
+
+  SourceRanges ranges;
+  ranges.Build(_data, _size, xmlDoc, _origin);
+  SourceRangeScope rangeScope(&ranges);
+
+  // The element is read into an empty copy of its parent, which the
+  // reading of an <include> needs to know where the included element goes.
+  ElementPtr parent = _parent->Instantiate();
+  ReadXmlFrame frame(xmlDoc.NewElement(_parent->GetName().c_str()), parent);
+  ElementPtr child;
+  const ReadXmlStep step = readXmlChild(frame, xml, _config, _errors, child);
+  if (step == ReadXmlStep::FAILED)
+    return nullptr;
+  if (step == ReadXmlStep::CHILDREN)
+  {
+    if (!readXmlChildren(xml, child, _config, _errors))
+      return nullptr;
+    insertRead(parent, child);
+  }
+
+  ElementPtr elem = parent->GetFirstElement();
+  if (elem)
+    parent->RemoveChild(elem);
+  return elem;
 }
 
 /////////////////////////////////////////////////
@@ -1224,7 +3514,7 @@ void copyChildren(ElementPtr _sdf,
     }
     else
     {
-      ElementPtr element(new Element);
+      ElementPtr element = makeArenaShared<Element>();
       element->SetParent(_sdf);
       element->SetName(elem_name);
       if (elemXml->GetText() != nullptr)
@@ -1246,6 +3536,30 @@ void copyChildren(ElementPtr _sdf,
   }
 }
 
+/////////////////////////////////////////////////
+void clearIncludeCache()
+{
+  IncludeCache::Instance().Clear();
+}
+
+/////////////////////////////////////////////////
+void setIncludeCacheCapacity(std::size_t _capacity)
+{
+  IncludeCache::Instance().SetCapacity(_capacity);
+}
+
+/////////////////////////////////////////////////
+std::size_t includeCacheCapacity()
+{
+  return IncludeCache::Instance().Capacity();
+}
+
+/////////////////////////////////////////////////
+std::size_t includeCacheSize()
+{
+  return IncludeCache::Instance().Size();
+}
+
 /////////////////////////////////////////////////
 bool convertFile(const std::string &_filename, const std::string &_version,
                  SDFPtr _sdf)
@@ -1265,7 +3579,8 @@ bool convertFile(const std::string &_filename, const std::string &_version,
   }
 
   tinyxml2::XMLDocument xmlDoc;
-  if (!xmlDoc.LoadFile(filename.c_str()))
+  if (tinyxml2::XML_SUCCESS ==
+      loadXmlFile(filename, xmlDoc, VirtualFilesystem::Native()))
   {
     // read initial sdf version
     std::string originalVersion;
@@ -1282,7 +3597,8 @@ bool convertFile(const std::string &_filename, const std::string &_version,
     if (sdf::Converter::Convert(&xmlDoc, _version, true))
     {
       Errors errors;
-      bool result = sdf::readDoc(&xmlDoc, _sdf, filename, false, errors);
+      bool result = sdf::readDoc(&xmlDoc, _sdf, filename, false,
+                                 ParserConfig(), errors);
 
       // Output errors
       for (auto const &e : errors)
@@ -1329,7 +3645,8 @@ bool convertString(const std::string &_sdfString, const std::string &_version,
     if (sdf::Converter::Convert(&xmlDoc, _version, true))
     {
       Errors errors;
-      bool result = sdf::readDoc(&xmlDoc, _sdf, "data-string", false, errors);
+      bool result = sdf::readDoc(&xmlDoc, _sdf, "data-string", false,
+                                 ParserConfig(), errors);
 
       // Output errors
       for (auto const &e : errors)
@@ -1346,51 +3663,188 @@ bool convertString(const std::string &_sdfString, const std::string &_version,
   return false;
 }
 
-//////////////////////////////////////////////////
-bool checkCanonicalLinkNames(const sdf::Root *_root)
+/////////////////////////////////////////////////
+/// \brief Build the XML of an element tree, with the attributes and values
+/// Element::ToString would write.
+/// \param[in] _elem Root of the element tree.
+/// \param[in] _doc Document that owns the XML elements.
+/// \return The XML element of _elem, not linked to the document.
+static tinyxml2::XMLElement *elementToXml(const ElementPtr &_elem,
+    tinyxml2::XMLDocument &_doc)
 {
-  if (!_root)
+  auto build = [&_doc](const ElementPtr &_e)
   {
-    std::cerr << "Error: invalid sdf::Root pointer, unable to "
-              << "check canonical link names."
-              << std::endl;
+    tinyxml2::XMLElement *xml = _doc.NewElement(_e->GetName().c_str());
+    for (std::size_t i = 0; i < _e->GetAttributeCount(); ++i)
+    {
+      ParamPtr attribute = _e->GetAttribute(static_cast<unsigned int>(i));
+      if (attribute->GetSet() || attribute->GetRequired())
+      {
+        xml->SetAttribute(attribute->GetKey().c_str(),
+            attribute->GetAsString().c_str());
+      }
+    }
+    if (_e->GetValue() && !_e->GetFirstElement())
+    {
+      const std::string value = _e->GetValue()->GetAsString();
+      if (!value.empty())
+        xml->InsertEndChild(_doc.NewText(value.c_str()));
+    }
+    return xml;
+  };
+
+  // An explicit stack, as deep trees can be converted on small stacks.
+  tinyxml2::XMLElement *root = build(_elem);
+  std::vector<std::pair<ElementPtr, tinyxml2::XMLElement *>> stack = {
+      {_elem, root}};
+  while (!stack.empty())
+  {
+    const auto [elem, xml] = stack.back();
+    stack.pop_back();
+    for (ElementPtr child = elem->GetFirstElement(); child;
+         child = child->GetNextElement())
+    {
+      tinyxml2::XMLElement *childXml = build(child);
+      xml->InsertEndChild(childXml);
+      stack.emplace_back(child, childXml);
+    }
+  }
+  return root;
+}
+
+/////////////////////////////////////////////////
+bool convertElement(ElementPtr _elem, const ParserConfig &_config,
+                    Errors &_errors)
+{
+  if (!_elem)
+  {
+    _errors.push_back({ErrorCode::ELEMENT_INVALID,
+        "Unable to convert a null element."});
     return false;
   }
 
-  bool result = true;
+  std::string version;
+  for (ElementPtr elem = _elem; elem && version.empty();
+       elem = elem->GetParent())
+  {
+    version = elem->OriginalVersion();
+  }
+  if (version.empty())
+  {
+    _errors.push_back({ErrorCode::ELEMENT_INVALID,
+        "Element[" + _elem->GetName() + "] has no original version to "
+        "convert from."});
+    return false;
+  }
+  if (version == SDF::Version())
+    return true;
 
-  auto checkModelCanonicalLinkName = [](
-      const sdf::Model *_model) -> bool
+  // The element is placed in an <sdf> element of its version, unless it is
+  // one.
+  tinyxml2::XMLDocument xmlDoc;
+  tinyxml2::XMLElement *xml = elementToXml(_elem, xmlDoc);
+  tinyxml2::XMLElement *sdfXml = xml;
+  if (_elem->GetName() != "sdf")
   {
-    bool modelResult = true;
-    std::string canonicalLink = _model->CanonicalLinkName();
-    if (!canonicalLink.empty() && !_model->LinkNameExists(canonicalLink))
-    {
-      std::cerr << "Error: canonical_link with name[" << canonicalLink
-                << "] not found in model with name[" << _model->Name()
-                << "]."
-                << std::endl;
-      modelResult = false;
-    }
-    return modelResult;
-  };
+    sdfXml = xmlDoc.NewElement("sdf");
+    sdfXml->InsertEndChild(xml);
+  }
+  sdfXml->SetAttribute("version", version.c_str());
+  xmlDoc.InsertEndChild(sdfXml);
 
-  for (uint64_t m = 0; m < _root->ModelCount(); ++m)
+  if (!Converter::Convert(&xmlDoc, SDF::Version(), true, true,
+        _config.LoadThreadCount()))
   {
-    auto model = _root->ModelByIndex(m);
-    result = checkModelCanonicalLinkName(model) && result;
+    _errors.push_back({ErrorCode::ELEMENT_INVALID,
+        "Unable to convert element[" + _elem->GetName() + "] from version " +
+        version + " to " + SDF::Version() + "."});
+    return false;
+  }
+
+  if (_elem->GetName() != "sdf")
+    xml = sdfXml->FirstChildElement(_elem->GetName().c_str());
+  if (!xml)
+  {
+    _errors.push_back({ErrorCode::ELEMENT_MISSING,
+        "Element[" + _elem->GetName() + "] was removed by the conversion "
+        "from version " + version + "."});
+    return false;
   }
 
+  // The element is read again from the converted XML, as if it had been
+  // read from it in the first place.
+  for (std::size_t i = 0; i < _elem->GetAttributeCount(); ++i)
+    _elem->GetAttribute(static_cast<unsigned int>(i))->Reset();
+  if (_elem->GetValue())
+    _elem->GetValue()->Reset();
+  _elem->ClearElements();
+
+  return readXml(xml, _elem, _config, _errors);
+}
+
+/////////////////////////////////////////////////
+bool convertElement(ElementPtr _elem, Errors &_errors)
+{
+  return convertElement(_elem, ParserConfig(), _errors);
+}
+
+//////////////////////////////////////////////////
+/// \brief Get the models checked by the checks of the DOM of a root: its
+/// model, and the models of its worlds, in document order.
+/// \param[in] _root sdf Root object to check.
+/// \return The models.
+static std::vector<const sdf::Model *> checkedModels(const sdf::Root *_root)
+{
+  std::vector<const sdf::Model *> models;
+  for (uint64_t m = 0; m < _root->ModelCount(); ++m)
+    models.push_back(_root->ModelByIndex(m));
+
   for (uint64_t w = 0; w < _root->WorldCount(); ++w)
   {
     auto world = _root->WorldByIndex(w);
     for (uint64_t m = 0; m < world->ModelCount(); ++m)
-    {
-      auto model = world->ModelByIndex(m);
-      result = checkModelCanonicalLinkName(model) && result;
-    }
+      models.push_back(world->ModelByIndex(m));
+  }
+  return models;
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the canonical_link attribute of a model, see
+/// checkCanonicalLinkNames.
+/// \param[in] _model Model to check.
+/// \param[out] _out Stream the errors are printed to.
+/// \return True if the canonical_link attribute is valid.
+static bool checkModelCanonicalLinkName(const sdf::Model *_model,
+    std::ostream &_out)
+{
+  bool modelResult = true;
+  std::string canonicalLink = _model->CanonicalLinkName();
+  if (!canonicalLink.empty() && !_model->LinkNameExists(canonicalLink))
+  {
+    _out << "Error: canonical_link with name[" << canonicalLink
+         << "] not found in model with name[" << _model->Name()
+         << "]."
+         << std::endl;
+    modelResult = false;
+  }
+  return modelResult;
+}
+
+//////////////////////////////////////////////////
+bool checkCanonicalLinkNames(const sdf::Root *_root)
+{
+  if (!_root)
+  {
+    std::cerr << "Error: invalid sdf::Root pointer, unable to "
+              << "check canonical link names."
+              << std::endl;
+    return false;
   }
 
+  bool result = true;
+  for (const sdf::Model *model : checkedModels(_root))
+    result = checkModelCanonicalLinkName(model, std::cerr) && result;
+
   return result;
 }
 
@@ -1524,64 +3978,252 @@ bool checkFrameAttachedToNames(const sdf::Root *_root)
     result = checkWorldFrameAttachedToNames(world) && result;
     for (uint64_t m = 0; m < world->ModelCount(); ++m)
     {
-      auto model = world->ModelByIndex(m);
-      result = checkModelFrameAttachedToNames(model) && result;
+      auto model = world->ModelByIndex(m);
+      result = checkModelFrameAttachedToNames(model) && result;
+    }
+  }
+
+  return result;
+}
+
+//////////////////////////////////////////////////
+bool recursiveSameTypeUniqueNames(sdf::ElementPtr _elem)
+{
+  if (!shouldValidateElement(_elem))
+    return true;
+
+  // Names that are unique among all children, which is kept from the read
+  // of the element, are unique for each type.
+  bool result = true;
+  std::set<std::string> typeNames;
+  if (!_elem->HasUniqueChildNames())
+    typeNames = _elem->GetElementTypeNames();
+  for (const std::string &typeName : typeNames)
+  {
+    if (!_elem->HasUniqueChildNames(typeName))
+    {
+      std::cerr << "Error: Non-unique names detected in type "
+                << typeName << " in\n"
+                << _elem->ToString("")
+                << std::endl;
+      result = false;
+    }
+  }
+
+  sdf::ElementPtr child = _elem->GetFirstElement();
+  while (child)
+  {
+    result = recursiveSameTypeUniqueNames(child) && result;
+    child = child->GetNextElement();
+  }
+
+  return result;
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that all sibling elements have unique names, see
+/// recursiveSiblingUniqueNames.
+/// \param[in] _elem sdf Element to check recursively.
+/// \param[out] _out Stream the errors are printed to.
+/// \return True if the names of the siblings are unique.
+static bool recursiveSiblingUniqueNames(const sdf::ElementPtr &_elem,
+    std::ostream &_out)
+{
+  if (!shouldValidateElement(_elem))
+    return true;
+
+  bool result = _elem->HasUniqueChildNames();
+  if (!result)
+  {
+    _out << "Error: Non-unique names detected in "
+         << _elem->ToString("")
+         << std::endl;
+    result = false;
+  }
+
+  sdf::ElementPtr child = _elem->GetFirstElement();
+  while (child)
+  {
+    result = recursiveSiblingUniqueNames(child, _out) && result;
+    child = child->GetNextElement();
+  }
+
+  return result;
+}
+
+//////////////////////////////////////////////////
+bool recursiveSiblingUniqueNames(sdf::ElementPtr _elem)
+{
+  return recursiveSiblingUniqueNames(_elem, std::cerr);
+}
+
+//////////////////////////////////////////////////
+/// \brief A model or world whose graph is checked, with the graph built
+/// for it by Root::Load if there is one.
+/// \tparam T Either FrameAttachedToGraph or PoseRelativeToGraph.
+template <typename T>
+struct GraphScope
+{
+  /// \brief The model, or nullptr for a world.
+  const sdf::Model *model = nullptr;
+
+  /// \brief The world, or nullptr for a model.
+  const sdf::World *world = nullptr;
+
+  /// \brief Graph built by Root::Load, or nullptr to build one.
+  const sdf::ScopedGraph<T> *graph = nullptr;
+
+  /// \brief Errors of building the graph, if it was built by Root::Load.
+  const Errors *buildErrors = nullptr;
+};
+
+//////////////////////////////////////////////////
+/// \brief Get the models and worlds of a root whose graphs are checked,
+/// in document order.
+/// \param[in] _root sdf Root object to check.
+/// \param[in] _graphs Graphs built by Root::Load. Graphs are only built for
+/// models and worlds that have none.
+/// \tparam T Either FrameAttachedToGraph or PoseRelativeToGraph.
+/// \return The scopes.
+template <typename T>
+static std::vector<GraphScope<T>> graphScopes(const sdf::Root *_root,
+    const sdf::RootGraphs<T> &_graphs)
+{
+  std::vector<GraphScope<T>> scopes;
+  for (uint64_t m = 0; m < _root->ModelCount(); ++m)
+  {
+    GraphScope<T> &scope = scopes.emplace_back();
+    scope.model = _root->ModelByIndex(m);
+    if (m < _graphs.models.size())
+    {
+      scope.graph = &_graphs.models[m];
+      scope.buildErrors = &_graphs.modelBuildErrors[m];
+    }
+  }
+
+  for (uint64_t w = 0; w < _root->WorldCount(); ++w)
+  {
+    auto world = _root->WorldByIndex(w);
+    GraphScope<T> &scope = scopes.emplace_back();
+    scope.world = world;
+    if (w < _graphs.worlds.size())
+    {
+      // The graph of a world contains the graphs of its models, and is
+      // validated as a whole.
+      scope.graph = &_graphs.worlds[w];
+      scope.buildErrors = &_graphs.worldBuildErrors[w];
+      continue;
+    }
+
+    for (uint64_t m = 0; m < world->ModelCount(); ++m)
+    {
+      scopes.emplace_back().model = world->ModelByIndex(m);
     }
   }
-
-  return result;
+  return scopes;
 }
 
 //////////////////////////////////////////////////
-bool recursiveSameTypeUniqueNames(sdf::ElementPtr _elem)
+/// \brief Validate the graph of a model or world.
+/// \param[in] _scope The model or world.
+/// \param[out] _out Stream the errors are printed to.
+/// \tparam T Either FrameAttachedToGraph or PoseRelativeToGraph.
+/// \return True if the graph is valid.
+template <typename T>
+static bool checkGraph(const GraphScope<T> &_scope, std::ostream &_out)
 {
-  if (!shouldValidateElement(_elem))
-    return true;
-
   bool result = true;
-  auto typeNames = _elem->GetElementTypeNames();
-  for (const std::string &typeName : typeNames)
+  Errors errors;
+  sdf::ScopedGraph<T> graph;
+  if (_scope.graph)
   {
-    if (!_elem->HasUniqueChildNames(typeName))
+    graph = *_scope.graph;
+    errors = *_scope.buildErrors;
+  }
+  else
+  {
+    graph = sdf::ScopedGraph<T>(std::make_shared<T>());
+    if constexpr (std::is_same_v<T, sdf::FrameAttachedToGraph>)
     {
-      std::cerr << "Error: Non-unique names detected in type "
-                << typeName << " in\n"
-                << _elem->ToString("")
-                << std::endl;
-      result = false;
+      if (_scope.model)
+        errors = sdf::buildFrameAttachedToGraph(graph, _scope.model);
+      else
+        errors = sdf::buildFrameAttachedToGraph(graph, _scope.world);
+    }
+    else
+    {
+      if (_scope.model)
+        errors = sdf::buildPoseRelativeToGraph(graph, _scope.model);
+      else
+        errors = sdf::buildPoseRelativeToGraph(graph, _scope.world);
     }
   }
 
-  sdf::ElementPtr child = _elem->GetFirstElement();
-  while (child)
+  if (!errors.empty())
   {
-    result = recursiveSameTypeUniqueNames(child) && result;
-    child = child->GetNextElement();
+    for (auto &error : errors)
+    {
+      _out << "Error: " << error.Message() << std::endl;
+    }
+    result = false;
+  }
+
+  std::string validateName;
+  if constexpr (std::is_same_v<T, sdf::FrameAttachedToGraph>)
+  {
+    validateName = "validateFrameAttachedToGraph";
+    errors = sdf::validateFrameAttachedToGraph(graph);
+  }
+  else
+  {
+    validateName = "validatePoseRelativeToGraph";
+    errors = sdf::validatePoseRelativeToGraph(graph);
   }
 
+  if (!errors.empty())
+  {
+    for (auto &error : errors)
+    {
+      _out << "Error in " << validateName << ": "
+           << error.Message()
+           << std::endl;
+    }
+    result = false;
+  }
   return result;
 }
 
 //////////////////////////////////////////////////
-bool recursiveSiblingUniqueNames(sdf::ElementPtr _elem)
+/// \brief Validate the graph of each model and world of a root, and print
+/// the errors found to std::cerr.
+/// \param[in] _root sdf Root object to check.
+/// \param[in] _graphs Graphs built by Root::Load. They are validated
+/// instead of building the graphs again. Graphs are only built for models
+/// and worlds that have none.
+/// \param[in] _threadCount Maximum number of threads used to check the
+/// graphs, see parallelFor. The errors are printed in document order
+/// whatever the number of threads.
+/// \tparam T Either FrameAttachedToGraph or PoseRelativeToGraph.
+/// \return True if all graphs are valid.
+template <typename T>
+static bool checkGraphs(const sdf::Root *_root,
+    const sdf::RootGraphs<T> &_graphs, unsigned int _threadCount)
 {
-  if (!shouldValidateElement(_elem))
-    return true;
-
-  bool result = _elem->HasUniqueChildNames();
-  if (!result)
+  const std::vector<GraphScope<T>> scopes = graphScopes(_root, _graphs);
+  std::vector<std::string> messages(scopes.size());
+  std::vector<char> results(scopes.size(), true);
+  parallelFor(scopes.size(), _threadCount, [&](std::size_t _index)
   {
-    std::cerr << "Error: Non-unique names detected in "
-              << _elem->ToString("")
-              << std::endl;
-    result = false;
-  }
+    std::ostringstream stream;
+    results[_index] = checkGraph(scopes[_index], stream);
+    messages[_index] = stream.str();
+  });
 
-  sdf::ElementPtr child = _elem->GetFirstElement();
-  while (child)
+  bool result = true;
+  for (std::size_t i = 0; i < scopes.size(); ++i)
   {
-    result = recursiveSiblingUniqueNames(child) && result;
-    child = child->GetNextElement();
+    std::cerr << messages[i];
+    result = results[i] && result;
   }
 
   return result;
@@ -1590,291 +4232,349 @@ bool recursiveSiblingUniqueNames(sdf::ElementPtr _elem)
 //////////////////////////////////////////////////
 bool checkFrameAttachedToGraph(const sdf::Root *_root)
 {
-  bool result = true;
+  return checkFrameAttachedToGraph(_root, 1);
+}
 
-  auto checkModelFrameAttachedToGraph = [](
-      const sdf::Model *_model) -> bool
+//////////////////////////////////////////////////
+bool checkFrameAttachedToGraph(const sdf::Root *_root,
+    unsigned int _threadCount)
+{
+  return checkGraphs(_root, _root->FrameAttachedToGraphs(), _threadCount);
+}
+
+//////////////////////////////////////////////////
+bool checkPoseRelativeToGraph(const sdf::Root *_root)
+{
+  return checkPoseRelativeToGraph(_root, 1);
+}
+
+//////////////////////////////////////////////////
+bool checkPoseRelativeToGraph(const sdf::Root *_root,
+    unsigned int _threadCount)
+{
+  return checkGraphs(_root, _root->PoseRelativeToGraphs(), _threadCount);
+}
+
+//////////////////////////////////////////////////
+/// \brief Write the graph of the first world of a root, or of its first
+/// model, in DOT format.
+/// \param[in] _graphs Graphs built by Root::Load.
+/// \param[out] _out Stream to write to.
+/// \param[in] _scope Name of the model whose scope is written, or empty.
+/// \param[in] _depth Maximum depth of the vertices below _scope, or
+/// negative.
+/// \tparam T Either FrameAttachedToGraph or PoseRelativeToGraph.
+/// \return False if there is no graph, or _scope is not in it.
+template <typename T>
+static bool writeGraph(const sdf::RootGraphs<T> &_graphs, std::ostream &_out,
+    const std::string &_scope, int _depth)
+{
+  const sdf::ScopedGraph<T> *scopedGraph = nullptr;
+  if (!_graphs.worlds.empty())
+    scopedGraph = &_graphs.worlds.front();
+  else if (!_graphs.models.empty())
+    scopedGraph = &_graphs.models.front();
+  if (!scopedGraph || !*scopedGraph)
+    return false;
+
+  const T &data = scopedGraph->GraphData();
+  if (!_scope.empty() && data.map.count(_scope) == 0)
+    return false;
+
+  // Ids increase as vertices and edges are added, and every vertex that
+  // remains in the graph is in the name map, except older vertices of
+  // duplicate names, so the ids are bounded without listing the graph.
+  std::size_t vertexBound = 0;
+  std::size_t edgeBound = 0;
+  for (const auto &entry : data.map)
   {
-    bool modelResult = true;
-    auto ownedGraph = std::make_shared<sdf::FrameAttachedToGraph>();
-    sdf::ScopedGraph<sdf::FrameAttachedToGraph> graph(ownedGraph);
-    auto errors = sdf::buildFrameAttachedToGraph(graph, _model);
-    if (!errors.empty())
-    {
-      for (auto &error : errors)
-      {
-        std::cerr << "Error: " << error.Message() << std::endl;
-      }
-      modelResult = false;
-    }
-    errors = sdf::validateFrameAttachedToGraph(graph);
-    if (!errors.empty())
-    {
-      for (auto &error : errors)
-      {
-        std::cerr << "Error in validateFrameAttachedToGraph: "
-                  << error.Message()
-                  << std::endl;
-      }
-      modelResult = false;
-    }
-    return modelResult;
-  };
+    vertexBound = std::max<std::size_t>(vertexBound, entry.second + 1);
+    for (const auto &edge : data.graph.IncidentsFrom(entry.second))
+      edgeBound = std::max<std::size_t>(edgeBound, edge.first + 1);
+    for (const auto &edge : data.graph.IncidentsTo(entry.second))
+      edgeBound = std::max<std::size_t>(edgeBound, edge.first + 1);
+  }
 
-  auto checkWorldFrameAttachedToGraph = [](
-      const sdf::World *_world) -> bool
+  // Whether a vertex is the scope model or in its scope, within the depth.
+  auto selected = [&_scope, _depth](const std::string &_name)
   {
-    bool worldResult = true;
-    auto ownedGraph = std::make_shared<sdf::FrameAttachedToGraph>();
-    sdf::ScopedGraph<sdf::FrameAttachedToGraph> graph(ownedGraph);
-    auto errors = sdf::buildFrameAttachedToGraph(graph, _world);
-    if (!errors.empty())
+    std::size_t begin = 0;
+    if (!_scope.empty())
     {
-      for (auto &error : errors)
+      if (_name == _scope)
+        return true;
+      if (_name.size() <= _scope.size() + 2 ||
+          _name.compare(0, _scope.size(), _scope) != 0 ||
+          _name.compare(_scope.size(), 2, "::") != 0)
       {
-        std::cerr << "Error: " << error.Message() << std::endl;
+        return false;
       }
-      worldResult = false;
+      begin = _scope.size() + 2;
     }
-    errors = sdf::validateFrameAttachedToGraph(graph);
-    if (!errors.empty())
+
+    int depth = 0;
+    for (auto pos = _name.find("::", begin);
+         _depth >= 0 && pos != std::string::npos;
+         pos = _name.find("::", pos + 2))
     {
-      for (auto &error : errors)
-      {
-        std::cerr << "Error in validateFrameAttachedToGraph: "
-                  << error.Message()
-                  << std::endl;
-      }
-      worldResult = false;
+      if (++depth > _depth)
+        return false;
     }
-    return worldResult;
+    return true;
   };
 
-  for (uint64_t m = 0; m < _root->ModelCount(); ++m)
+  // Lines end with '\n' rather than std::endl, which would flush the stream
+  // for every line.
+  std::vector<bool> written(vertexBound, false);
+  _out << "digraph {\n";
+  for (ignition::math::graph::VertexId id = 0; id < vertexBound; ++id)
   {
-    auto model = _root->ModelByIndex(m);
-    result = checkModelFrameAttachedToGraph(model) && result;
+    const auto &vertex = data.graph.VertexFromId(id);
+    if (!vertex.Valid() || !selected(vertex.Name()))
+      continue;
+    written[id] = true;
+    _out << "  " << id << " [label=\"" << vertex.Name() << " (" << id
+         << ")\"];\n";
   }
 
-  for (uint64_t w = 0; w < _root->WorldCount(); ++w)
+  for (ignition::math::graph::EdgeId id = 0; id < edgeBound; ++id)
   {
-    auto world = _root->WorldByIndex(w);
-    result = checkWorldFrameAttachedToGraph(world) && result;
-    for (uint64_t m = 0; m < world->ModelCount(); ++m)
+    const auto &edge = data.graph.EdgeFromId(id);
+    if (edge.Id() == ignition::math::graph::kNullId ||
+        edge.Tail() >= vertexBound || edge.Head() >= vertexBound ||
+        !written[edge.Tail()] || !written[edge.Head()])
     {
-      auto model = world->ModelByIndex(m);
-      result = checkModelFrameAttachedToGraph(model) && result;
+      continue;
     }
+    _out << "  " << edge.Tail() << " -> " << edge.Head() << " [label="
+         << edge.Weight() << "];\n";
   }
+  _out << "}\n";
+  return true;
+}
 
-  return result;
+//////////////////////////////////////////////////
+bool writeFrameAttachedToGraph(const sdf::Root *_root, std::ostream &_out,
+    const std::string &_scope, int _depth)
+{
+  return writeGraph(_root->FrameAttachedToGraphs(), _out, _scope, _depth);
 }
 
 //////////////////////////////////////////////////
-bool checkPoseRelativeToGraph(const sdf::Root *_root)
+bool writePoseRelativeToGraph(const sdf::Root *_root, std::ostream &_out,
+    const std::string &_scope, int _depth)
 {
-  bool result = true;
+  return writeGraph(_root->PoseRelativeToGraphs(), _out, _scope, _depth);
+}
 
-  auto checkModelPoseRelativeToGraph = [](
-      const sdf::Model *_model) -> bool
+//////////////////////////////////////////////////
+/// \brief Check the parent and child frames of the joints of a model, see
+/// checkJointParentChildLinkNames.
+/// \param[in] _model Model to check.
+/// \param[out] _out Stream the errors are printed to.
+/// \return True if the joints of the model are valid.
+static bool checkModelJointParentChildNames(const sdf::Model *_model,
+    std::ostream &_out)
+{
+  bool modelResult = true;
+  for (uint64_t j = 0; j < _model->JointCount(); ++j)
   {
-    bool modelResult = true;
-    auto ownedGraph = std::make_shared<sdf::PoseRelativeToGraph>();
-    sdf::ScopedGraph<PoseRelativeToGraph> graph(ownedGraph);
-    auto errors = sdf::buildPoseRelativeToGraph(graph, _model);
-    if (!errors.empty())
+    auto joint = _model->JointByIndex(j);
+
+    const std::string &parentName = joint->ParentLinkName();
+    if (parentName != "world" && !_model->LinkNameExists(parentName) &&
+        !_model->JointNameExists(parentName) &&
+        !_model->FrameNameExists(parentName))
     {
-      for (auto &error : errors)
-      {
-        std::cerr << "Error: " << error.Message() << std::endl;
-      }
+      _out << "Error: parent frame with name[" << parentName
+           << "] specified by joint with name[" << joint->Name()
+           << "] not found in model with name[" << _model->Name()
+           << "]."
+           << std::endl;
       modelResult = false;
     }
-    errors = sdf::validatePoseRelativeToGraph(graph);
-    if (!errors.empty())
+
+    const std::string &childName = joint->ChildLinkName();
+    if (childName == "world")
     {
-      for (auto &error : errors)
-      {
-        std::cerr << "Error in validatePoseRelativeToGraph: "
-                  << error.Message()
-                  << std::endl;
-      }
+      _out << "Error: invalid child name[world"
+           << "] specified by joint with name[" << joint->Name()
+           << "] in model with name[" << _model->Name()
+           << "]."
+           << std::endl;
       modelResult = false;
     }
-    return modelResult;
-  };
 
-  auto checkWorldPoseRelativeToGraph = [](
-      const sdf::World *_world) -> bool
-  {
-    bool worldResult = true;
-    auto ownedGraph = std::make_shared<sdf::PoseRelativeToGraph>();
-    sdf::ScopedGraph<PoseRelativeToGraph> graph(ownedGraph);
-    auto errors = sdf::buildPoseRelativeToGraph(graph, _world);
+    if (!_model->LinkNameExists(childName) &&
+        !_model->JointNameExists(childName) &&
+        !_model->FrameNameExists(childName) &&
+        !_model->ModelNameExists(childName))
+    {
+      _out << "Error: child frame with name[" << childName
+           << "] specified by joint with name[" << joint->Name()
+           << "] not found in model with name[" << _model->Name()
+           << "]."
+           << std::endl;
+      modelResult = false;
+    }
+
+    if (childName == joint->Name())
+    {
+      _out << "Error: joint with name[" << joint->Name()
+           << "] in model with name[" << _model->Name()
+           << "] must not specify its own name as the child frame."
+           << std::endl;
+      modelResult = false;
+    }
+
+    if (parentName == joint->Name())
+    {
+      _out << "Error: joint with name[" << joint->Name()
+           << "] in model with name[" << _model->Name()
+           << "] must not specify its own name as the parent frame."
+           << std::endl;
+      modelResult = false;
+    }
+
+    // Check that parent and child frames resolve to different links
+    std::string resolvedChildName;
+    std::string resolvedParentName;
+    auto errors = joint->ResolveChildLink(resolvedChildName);
     if (!errors.empty())
     {
-      for (auto &error : errors)
+      _out << "Error when attempting to resolve child link name:"
+           << std::endl;
+      for (auto error : errors)
       {
-        std::cerr << "Error: " << error.Message() << std::endl;
+        _out << error.Message() << std::endl;
       }
-      worldResult = false;
+      modelResult = false;
     }
-    errors = sdf::validatePoseRelativeToGraph(graph);
+    errors = joint->ResolveParentLink(resolvedParentName);
     if (!errors.empty())
     {
-      for (auto &error : errors)
+      _out << "Error when attempting to resolve parent link name:"
+           << std::endl;
+      for (auto error : errors)
       {
-        std::cerr << "Error in validatePoseRelativeToGraph: "
-                  << error.Message()
-                  << std::endl;
+        _out << error.Message() << std::endl;
       }
-      worldResult = false;
+      modelResult = false;
     }
-    return worldResult;
-  };
-
-  for (uint64_t m = 0; m < _root->ModelCount(); ++m)
-  {
-    auto model = _root->ModelByIndex(m);
-    result = checkModelPoseRelativeToGraph(model) && result;
-  }
-
-  for (uint64_t w = 0; w < _root->WorldCount(); ++w)
-  {
-    auto world = _root->WorldByIndex(w);
-    result = checkWorldPoseRelativeToGraph(world) && result;
-    for (uint64_t m = 0; m < world->ModelCount(); ++m)
+    if (resolvedChildName == resolvedParentName)
     {
-      auto model = world->ModelByIndex(m);
-      result = checkModelPoseRelativeToGraph(model) && result;
+      _out << "Error: joint with name[" << joint->Name()
+           << "] in model with name[" << _model->Name()
+           << "] specified parent frame [" << parentName
+           << "] and child frame [" << childName
+           << "] that both resolve to [" << resolvedChildName
+           << "], but they should resolve to different values."
+           << std::endl;
+      modelResult = false;
     }
   }
-
-  return result;
+  return modelResult;
 }
 
 //////////////////////////////////////////////////
 bool checkJointParentChildLinkNames(const sdf::Root *_root)
 {
   bool result = true;
+  for (const sdf::Model *model : checkedModels(_root))
+    result = checkModelJointParentChildNames(model, std::cerr) && result;
 
-  auto checkModelJointParentChildNames = [](
-      const sdf::Model *_model) -> bool
-  {
-    bool modelResult = true;
-    for (uint64_t j = 0; j < _model->JointCount(); ++j)
-    {
-      auto joint = _model->JointByIndex(j);
-
-      const std::string &parentName = joint->ParentLinkName();
-      if (parentName != "world" && !_model->LinkNameExists(parentName) &&
-          !_model->JointNameExists(parentName) &&
-          !_model->FrameNameExists(parentName))
-      {
-        std::cerr << "Error: parent frame with name[" << parentName
-                  << "] specified by joint with name[" << joint->Name()
-                  << "] not found in model with name[" << _model->Name()
-                  << "]."
-                  << std::endl;
-        modelResult = false;
-      }
-
-      const std::string &childName = joint->ChildLinkName();
-      if (childName == "world")
-      {
-        std::cerr << "Error: invalid child name[world"
-                  << "] specified by joint with name[" << joint->Name()
-                  << "] in model with name[" << _model->Name()
-                  << "]."
-                  << std::endl;
-        modelResult = false;
-      }
-
-      if (!_model->LinkNameExists(childName) &&
-          !_model->JointNameExists(childName) &&
-          !_model->FrameNameExists(childName) &&
-          !_model->ModelNameExists(childName))
-      {
-        std::cerr << "Error: child frame with name[" << childName
-                  << "] specified by joint with name[" << joint->Name()
-                  << "] not found in model with name[" << _model->Name()
-                  << "]."
-                  << std::endl;
-        modelResult = false;
-      }
+  return result;
+}
 
-      if (childName == joint->Name())
-      {
-        std::cerr << "Error: joint with name[" << joint->Name()
-                  << "] in model with name[" << _model->Name()
-                  << "] must not specify its own name as the child frame."
-                  << std::endl;
-        modelResult = false;
-      }
+//////////////////////////////////////////////////
+bool checkRoot(const sdf::Root *_root, unsigned int _threadCount,
+    std::vector<std::string> &_failed)
+{
+  if (!_root)
+  {
+    std::cerr << "Error: invalid sdf::Root pointer, unable to "
+              << "check the root."
+              << std::endl;
+    _failed.push_back("checkRoot");
+    return false;
+  }
 
-      if (parentName == joint->Name())
-      {
-        std::cerr << "Error: joint with name[" << joint->Name()
-                  << "] in model with name[" << _model->Name()
-                  << "] must not specify its own name as the parent frame."
-                  << std::endl;
-        modelResult = false;
-      }
+  // The checks, in the order their errors are printed.
+  enum Check {CANONICAL, JOINTS, FRAME_GRAPH, POSE_GRAPH, NAMES, CHECKS};
+  const char *const checkNames[CHECKS] = {
+    "checkCanonicalLinkNames", "checkJointParentChildLinkNames",
+    "checkFrameAttachedToGraph", "checkPoseRelativeToGraph",
+    "recursiveSiblingUniqueNames"};
+
+  // The work items are the models, followed by the graph scopes, which
+  // check both graphs of a model or world, and the element tree. The
+  // scopes of both graphs are the same, since Root::Load builds them
+  // together.
+  const std::vector<const sdf::Model *> models = checkedModels(_root);
+  const auto frameScopes = graphScopes(_root, _root->FrameAttachedToGraphs());
+  const auto poseScopes = graphScopes(_root, _root->PoseRelativeToGraphs());
+  const std::size_t scopeCount =
+      std::min(frameScopes.size(), poseScopes.size());
+  const std::size_t itemCount = models.size() + scopeCount + 1;
+  const sdf::ElementPtr elem = _root->Element();
+
+  // The errors of each check for each item, which are printed in order.
+  std::vector<std::string> messages(itemCount * CHECKS);
+  std::vector<char> results(itemCount * CHECKS, true);
+  parallelFor(itemCount, _threadCount, [&](std::size_t _index)
+  {
+    auto check = [&](Check _check, auto _func)
+    {
+      std::ostringstream stream;
+      results[_index * CHECKS + _check] = _func(stream);
+      messages[_index * CHECKS + _check] = stream.str();
+    };
 
-      // Check that parent and child frames resolve to different links
-      std::string resolvedChildName;
-      std::string resolvedParentName;
-      auto errors = joint->ResolveChildLink(resolvedChildName);
-      if (!errors.empty())
-      {
-        std::cerr << "Error when attempting to resolve child link name:"
-                  << std::endl;
-        for (auto error : errors)
-        {
-          std::cerr << error.Message() << std::endl;
-        }
-        modelResult = false;
-      }
-      errors = joint->ResolveParentLink(resolvedParentName);
-      if (!errors.empty())
-      {
-        std::cerr << "Error when attempting to resolve parent link name:"
-                  << std::endl;
-        for (auto error : errors)
-        {
-          std::cerr << error.Message() << std::endl;
-        }
-        modelResult = false;
-      }
-      if (resolvedChildName == resolvedParentName)
-      {
-        std::cerr << "Error: joint with name[" << joint->Name()
-                  << "] in model with name[" << _model->Name()
-                  << "] specified parent frame [" << parentName
-                  << "] and child frame [" << childName
-                  << "] that both resolve to [" << resolvedChildName
-                  << "], but they should resolve to different values."
-                  << std::endl;
-        modelResult = false;
-      }
+    if (_index < models.size())
+    {
+      const sdf::Model *model = models[_index];
+      check(CANONICAL, [model](std::ostream &_out)
+          {
+            return checkModelCanonicalLinkName(model, _out);
+          });
+      check(JOINTS, [model](std::ostream &_out)
+          {
+            return checkModelJointParentChildNames(model, _out);
+          });
     }
-    return modelResult;
-  };
-
-  for (uint64_t m = 0; m < _root->ModelCount(); ++m)
-  {
-    auto model = _root->ModelByIndex(m);
-    result = checkModelJointParentChildNames(model) && result;
-  }
+    else if (_index < models.size() + scopeCount)
+    {
+      const std::size_t scope = _index - models.size();
+      check(FRAME_GRAPH, [&](std::ostream &_out)
+          {
+            return checkGraph(frameScopes[scope], _out);
+          });
+      check(POSE_GRAPH, [&](std::ostream &_out)
+          {
+            return checkGraph(poseScopes[scope], _out);
+          });
+    }
+    else if (elem)
+    {
+      check(NAMES, [&elem](std::ostream &_out)
+          {
+            return recursiveSiblingUniqueNames(elem, _out);
+          });
+    }
+  });
 
-  for (uint64_t w = 0; w < _root->WorldCount(); ++w)
+  bool result = true;
+  for (int c = 0; c < CHECKS; ++c)
   {
-    auto world = _root->WorldByIndex(w);
-    for (uint64_t m = 0; m < world->ModelCount(); ++m)
+    bool checkResult = true;
+    for (std::size_t i = 0; i < itemCount; ++i)
     {
-      auto model = world->ModelByIndex(m);
-      result = checkModelJointParentChildNames(model) && result;
+      std::cerr << messages[i * CHECKS + c];
+      checkResult = results[i * CHECKS + c] && checkResult;
     }
+    if (!checkResult)
+      _failed.push_back(checkNames[c]);
+    result = checkResult && result;
   }
 
   return result;
@@ -15,10 +15,23 @@
  *
  */
 
+#include <fstream>
+#include <future>
+#include <memory_resource>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
 #include <gtest/gtest.h>
 #include "sdf/parser.hh"
 #include "sdf/Element.hh"
 #include "sdf/Filesystem.hh"
+#include "sdf/LoadStats.hh"
+#include "sdf/ParserConfig.hh"
+#include "sdf/Root.hh"
 #include "test_config.h"
 
 /////////////////////////////////////////////////
@@ -60,6 +73,274 @@ sdf::SDFPtr InitSDF()
   return sdf;
 }
 
+/////////////////////////////////////////////////
+TEST(Parser, InitCachedDescription)
+{
+  sdf::SDFPtr sdf1 = InitSDF();
+  sdf::SDFPtr sdf2 = InitSDF();
+  ASSERT_NE(nullptr, sdf1->Root());
+  ASSERT_NE(nullptr, sdf2->Root());
+
+  // Both roots are separate elements that share the immutable child
+  // descriptions of the spec.
+  EXPECT_NE(sdf1->Root(), sdf2->Root());
+  EXPECT_EQ("sdf", sdf1->Root()->GetName());
+  EXPECT_EQ(sdf1->Root()->GetName(), sdf2->Root()->GetName());
+  EXPECT_EQ(sdf1->Root()->GetAttributeCount(),
+            sdf2->Root()->GetAttributeCount());
+  ASSERT_EQ(sdf1->Root()->GetElementDescriptionCount(),
+            sdf2->Root()->GetElementDescriptionCount());
+  EXPECT_EQ(sdf1->Root()->GetElementDescription("model"),
+            sdf2->Root()->GetElementDescription("model"));
+
+  // Modifying one description must not affect later initializations.
+  const size_t descCount = sdf1->Root()->GetElementDescriptionCount();
+  sdf::ElementPtr extra(new sdf::Element);
+  extra->SetName("extra");
+  sdf1->Root()->AddElementDescription(extra);
+  sdf1->Root()->GetAttribute("version")->Set<std::string>("0.1");
+
+  sdf::SDFPtr sdf3 = InitSDF();
+  EXPECT_EQ(descCount, sdf3->Root()->GetElementDescriptionCount());
+  EXPECT_FALSE(sdf3->Root()->HasElementDescription("extra"));
+  EXPECT_FALSE(sdf3->Root()->GetAttribute("version")->GetSet());
+
+  // initFile shares the same cache for embedded spec files.
+  sdf::ElementPtr model(new sdf::Element);
+  EXPECT_TRUE(sdf::initFile("model.sdf", model));
+  EXPECT_EQ("model", model->GetName());
+  EXPECT_TRUE(model->HasElementDescription("link"));
+}
+
+/////////////////////////////////////////////////
+/// Check that two description trees are the same.
+void ExpectSameDescription(sdf::ElementPtr _expected, sdf::ElementPtr _actual)
+{
+  ASSERT_NE(nullptr, _expected);
+  ASSERT_NE(nullptr, _actual);
+  EXPECT_EQ(_expected->GetName(), _actual->GetName());
+  EXPECT_EQ(_expected->GetRequired(), _actual->GetRequired());
+  EXPECT_EQ(_expected->ReferenceSDF(), _actual->ReferenceSDF());
+  EXPECT_EQ(_expected->GetDescription(), _actual->GetDescription());
+  EXPECT_EQ(_expected->GetCopyChildren(), _actual->GetCopyChildren());
+
+  auto expectSameParam = [](sdf::ParamPtr _a, sdf::ParamPtr _b)
+  {
+    ASSERT_EQ(nullptr == _a, nullptr == _b);
+    if (!_a)
+      return;
+    EXPECT_EQ(_a->GetKey(), _b->GetKey());
+    EXPECT_EQ(_a->GetTypeName(), _b->GetTypeName());
+    EXPECT_EQ(_a->GetDefaultAsString(), _b->GetDefaultAsString());
+    EXPECT_EQ(_a->GetMinValueAsString(), _b->GetMinValueAsString());
+    EXPECT_EQ(_a->GetMaxValueAsString(), _b->GetMaxValueAsString());
+    EXPECT_EQ(_a->GetRequired(), _b->GetRequired());
+    EXPECT_EQ(_a->GetDescription(), _b->GetDescription());
+  };
+  expectSameParam(_expected->GetValue(), _actual->GetValue());
+
+  ASSERT_EQ(_expected->GetAttributeCount(), _actual->GetAttributeCount());
+  for (unsigned int i = 0; i < _expected->GetAttributeCount(); ++i)
+    expectSameParam(_expected->GetAttribute(i), _actual->GetAttribute(i));
+
+  ASSERT_EQ(_expected->GetElementDescriptionCount(),
+            _actual->GetElementDescriptionCount());
+  for (unsigned int i = 0; i < _expected->GetElementDescriptionCount(); ++i)
+  {
+    ExpectSameDescription(_expected->GetElementDescription(i),
+                          _actual->GetElementDescription(i));
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(Parser, InitDescriptionsKeepVersion)
+{
+  // The included spec files of deferred children are those of the
+  // version the description was created for, not that of SDF::Version
+  // when the children are first looked up.
+  const std::string version = sdf::SDF::Version();
+  sdf::SDF::Version("1.6");
+  sdf::ElementPtr root(new sdf::Element);
+  ASSERT_TRUE(sdf::initFile("root.sdf", root));
+  sdf::SDF::Version("1.8");
+
+  sdf::ElementPtr model = root->GetElementDescription("model");
+  ASSERT_NE(nullptr, model);
+  EXPECT_FALSE(model->HasAttribute("canonical_link"));
+  ASSERT_NE(nullptr, model->GetElementDescription("link"));
+
+  sdf::ElementPtr newRoot(new sdf::Element);
+  ASSERT_TRUE(sdf::initFile("root.sdf", newRoot));
+  sdf::SDF::Version(version);
+  ASSERT_NE(nullptr, newRoot->GetElementDescription("model"));
+  EXPECT_TRUE(
+      newRoot->GetElementDescription("model")->HasAttribute("canonical_link"));
+}
+
+/////////////////////////////////////////////////
+TEST(Parser, InitSpecTables)
+{
+  const std::string version = sdf::SDF::Version();
+  for (const std::string specVersion :
+       {"1.2", "1.3", "1.4", "1.5", "1.6", "1.7", "1.8"})
+  {
+    sdf::SDF::Version(specVersion);
+    const std::string specPath = sdf::filesystem::append(
+        PROJECT_SOURCE_PATH, "sdf", specVersion);
+
+    sdf::filesystem::DirIter endIter;
+    for (sdf::filesystem::DirIter dirIter(specPath); dirIter != endIter;
+         ++dirIter)
+    {
+      const std::string filename = sdf::filesystem::basename(*dirIter);
+      if (filename.size() < 4 ||
+          filename.compare(filename.size() - 4, 4, ".sdf") != 0)
+      {
+        continue;
+      }
+      SCOPED_TRACE(specVersion + "/" + filename);
+
+      // The XML of the spec file and the generated tables must describe
+      // the same elements.
+      sdf::SDFPtr fromXml(new sdf::SDF());
+      ASSERT_TRUE(sdf::initString(sdf::SDF::EmbeddedSpec(filename, false),
+                                  fromXml));
+
+      sdf::ElementPtr fromTables(new sdf::Element);
+      ASSERT_TRUE(sdf::initFile(filename, fromTables));
+      ExpectSameDescription(fromXml->Root(), fromTables);
+    }
+  }
+  sdf::SDF::Version(version);
+}
+
+/////////////////////////////////////////////////
+/// Count the descriptions of a tree, following included spec files.
+std::size_t CountDescriptions(const sdf::ElementPtr &_desc, int _depth)
+{
+  std::size_t count = 1;
+  if (_depth > 0)
+  {
+    for (std::size_t i = 0; i < _desc->GetElementDescriptionCount(); ++i)
+    {
+      count += CountDescriptions(
+          _desc->GetElementDescription(static_cast<unsigned int>(i)),
+          _depth - 1);
+    }
+  }
+  return count;
+}
+
+/////////////////////////////////////////////////
+TEST(Parser, InitDescriptionsOnDemand)
+{
+  // The child descriptions of the spec tables are created when they are
+  // first looked up, which threads may do at the same time.
+  const std::string version = sdf::SDF::Version();
+  sdf::SDF::Version("1.5");
+  std::vector<std::size_t> counts(8);
+  std::vector<std::thread> threads;
+  for (std::size_t i = 0; i < counts.size(); ++i)
+  {
+    threads.emplace_back([&counts, i]()
+    {
+      sdf::ElementPtr world(new sdf::Element);
+      if (sdf::initFile("world.sdf", world))
+        counts[i] = CountDescriptions(world, 6);
+    });
+  }
+  for (std::thread &thread : threads)
+    thread.join();
+  sdf::SDF::Version(version);
+
+  EXPECT_LT(100u, counts[0]);
+  for (std::size_t count : counts)
+    EXPECT_EQ(counts[0], count);
+
+  // Descriptions looked up by readString are complete.
+  sdf::SDFPtr sdf = InitSDF();
+  sdf::Errors errors;
+  EXPECT_TRUE(sdf::readString(
+      "<sdf version='1.8'><model name='m'><link name='l'>"
+      "<sensor name='s' type='camera'><camera><image><width>64</width>"
+      "</image></camera></sensor></link></model></sdf>", sdf, errors));
+  EXPECT_TRUE(errors.empty());
+  sdf::ElementPtr camera = sdf->Root()->GetElement("model")->
+      GetElement("link")->GetElement("sensor")->GetElement("camera");
+  ASSERT_NE(nullptr, camera);
+  EXPECT_EQ(64, camera->GetElement("image")->Get<int>("width"));
+  EXPECT_TRUE(camera->HasElementDescription("clip"));
+}
+
+/////////////////////////////////////////////////
+TEST(Parser, ReadBufferAndStream)
+{
+  const std::string buffer =
+    "<sdf version='1.6'><model name='m'><link name='l'/></model></sdf>"
+    "<not_parsed/>";
+  const std::size_t size = buffer.find("<not_parsed/>");
+
+  sdf::SDFPtr sdf = InitSDF();
+  sdf::Errors errors;
+  EXPECT_TRUE(sdf::readBuffer(buffer.data(), size, sdf::ParserConfig(), sdf,
+      errors));
+  EXPECT_TRUE(errors.empty());
+  EXPECT_EQ("1.6", sdf->OriginalVersion());
+  EXPECT_TRUE(sdf->Root()->HasElement("model"));
+
+  sdf = InitSDF();
+  EXPECT_TRUE(sdf::readBuffer(std::string_view(buffer).substr(0, size),
+      sdf::ParserConfig(), sdf, errors));
+  EXPECT_TRUE(errors.empty());
+  EXPECT_TRUE(sdf->Root()->HasElement("model"));
+
+  // The streaming reader uses the same buffer.
+  sdf::ParserConfig config;
+  config.SetStreamingRead(true);
+  sdf = InitSDF();
+  EXPECT_TRUE(sdf::readBuffer(buffer.data(), size, config, sdf, errors));
+  EXPECT_TRUE(errors.empty());
+  EXPECT_TRUE(sdf->Root()->HasElement("model"));
+
+  std::istringstream stream(buffer.substr(0, size));
+  sdf = InitSDF();
+  EXPECT_TRUE(sdf::readStream(stream, sdf::ParserConfig(), sdf, errors));
+  EXPECT_TRUE(errors.empty());
+  EXPECT_EQ("m",
+      sdf->Root()->GetElement("model")->Get<std::string>("name"));
+
+  std::istringstream empty;
+  sdf = InitSDF();
+  EXPECT_FALSE(sdf::readStream(empty, sdf::ParserConfig(), sdf, errors));
+}
+
+/////////////////////////////////////////////////
+TEST(Parser, Warmup)
+{
+  EXPECT_TRUE(sdf::Warmup());
+  EXPECT_TRUE(sdf::Warmup("1.6"));
+
+  // Warming up again, or in the background while documents are read, is
+  // allowed.
+  std::future<bool> warmup = sdf::WarmupAsync();
+  sdf::SDFPtr sdf = InitSDF();
+  sdf::Errors errors;
+  EXPECT_TRUE(sdf::readString(
+      "<sdf version='1.6'><model name='m'><link name='l'/></model></sdf>",
+      sdf, errors));
+  EXPECT_TRUE(errors.empty());
+  EXPECT_TRUE(warmup.get());
+
+  // The descriptions are usable after being expanded.
+  sdf::ElementPtr camera = sdf->Root()->GetElementDescription("model")->
+      GetElementDescription("link")->GetElementDescription("sensor")->
+      GetElementDescription("camera");
+  ASSERT_NE(nullptr, camera);
+  EXPECT_TRUE(camera->HasElementDescription("clip"));
+
+  EXPECT_FALSE(sdf::Warmup("0.1"));
+}
+
 /////////////////////////////////////////////////
 TEST(Parser, ReusedSDFVersion)
 {
@@ -421,6 +702,1121 @@ TEST_F(ValueConstraintsFixture, ElementMinMaxValues)
   }
 }
 
+/////////////////////////////////////////////////
+TEST(Parser, ReadStringElementArena)
+{
+  std::ostringstream stream;
+  stream << "<sdf version='1.8'><world name='default'>";
+  for (int i = 0; i < 50; ++i)
+  {
+    stream << "<model name='model_" << i << "'>"
+           << "<pose>" << i << " 0 0 0 0 0</pose>"
+           << "<link name='link'><inertial><mass>2</mass></inertial></link>"
+           << "</model>";
+  }
+  stream << "</world></sdf>";
+
+  sdf::SDFPtr heapSdf(new sdf::SDF());
+  ASSERT_TRUE(sdf::init(heapSdf));
+  sdf::Errors errors;
+  ASSERT_TRUE(sdf::readString(stream.str(), sdf::ParserConfig(), heapSdf,
+                              errors));
+  EXPECT_TRUE(errors.empty());
+
+  sdf::SDFPtr arenaSdf(new sdf::SDF());
+  ASSERT_TRUE(sdf::init(arenaSdf));
+  {
+    sdf::ParserConfig config;
+    EXPECT_FALSE(config.UseElementArena());
+    config.SetUseElementArena(true);
+    EXPECT_TRUE(config.UseElementArena());
+    ASSERT_TRUE(sdf::readString(stream.str(), config, arenaSdf, errors));
+    EXPECT_TRUE(errors.empty());
+  }
+
+  // The document outlives the configuration it was loaded with, and
+  // matches the document loaded from the heap.
+  EXPECT_EQ(heapSdf->Root()->ToString(""), arenaSdf->Root()->ToString(""));
+
+  // Elements can still be modified and cloned after loading.
+  sdf::ElementPtr world = arenaSdf->Root()->GetElement("world");
+  ASSERT_NE(nullptr, world);
+  sdf::ElementPtr model = world->GetElement("model");
+  ASSERT_NE(nullptr, model);
+  sdf::ElementPtr clone = model->Clone();
+  world->RemoveChild(model);
+  model.reset();
+  EXPECT_EQ("model_0", clone->Get<std::string>("name"));
+  EXPECT_EQ("model_1", world->GetElement("model")->Get<std::string>("name"));
+
+  // Parts of the document stay valid after the document is destroyed.
+  arenaSdf.reset();
+  world.reset();
+  EXPECT_EQ(2.0, clone->GetElement("link")->GetElement("inertial")
+                     ->Get<double>("mass"));
+}
+
+/////////////////////////////////////////////////
+/// \brief Memory resource that counts the bytes it hands out.
+class CountingResource : public std::pmr::memory_resource
+{
+  /// \brief Bytes allocated and not freed yet.
+  public: std::size_t bytes = 0;
+
+  /// \brief Number of allocations.
+  public: std::size_t allocations = 0;
+
+  private: void *do_allocate(std::size_t _bytes,
+                             std::size_t _alignment) override
+  {
+    this->bytes += _bytes;
+    ++this->allocations;
+    return std::pmr::new_delete_resource()->allocate(_bytes, _alignment);
+  }
+
+  private: void do_deallocate(void *_p, std::size_t _bytes,
+                              std::size_t _alignment) override
+  {
+    this->bytes -= _bytes;
+    std::pmr::new_delete_resource()->deallocate(_p, _bytes, _alignment);
+  }
+
+  private: bool do_is_equal(
+      const std::pmr::memory_resource &_other) const noexcept override
+  {
+    return this == &_other;
+  }
+};
+
+/////////////////////////////////////////////////
+TEST(Parser, ReadStringMemoryResource)
+{
+  const std::string sdfString =
+    "<sdf version='1.8'><world name='default'>"
+    "<model name='m'><link name='l'><inertial><mass>2</mass></inertial>"
+    "</link></model></world></sdf>";
+
+  CountingResource resource;
+  sdf::SDFPtr sdf(new sdf::SDF());
+  ASSERT_TRUE(sdf::init(sdf));
+  {
+    sdf::ParserConfig config;
+    config.SetMemoryResource(&resource);
+    sdf::Errors errors;
+    ASSERT_TRUE(sdf::readString(sdfString, config, sdf, errors));
+    EXPECT_TRUE(errors.empty());
+  }
+  EXPECT_LT(0u, resource.allocations);
+  EXPECT_LT(0u, resource.bytes);
+
+  sdf::ElementPtr mass = sdf->Root()->GetElement("world")
+      ->GetElement("model")->GetElement("link")->GetElement("inertial")
+      ->GetElement("mass");
+  EXPECT_DOUBLE_EQ(2.0, mass->Get<double>());
+
+  // The memory goes back to the resource with the last element.
+  sdf.reset();
+  EXPECT_LT(0u, resource.bytes);
+  mass.reset();
+  EXPECT_EQ(0u, resource.bytes);
+}
+
+/////////////////////////////////////////////////
+/// \brief Write a world that includes a model into a directory.
+/// \param[in] _dir Directory to create.
+/// \return Path of the world file.
+static std::string writeIncludingWorld(const std::string &_dir)
+{
+  const std::string modelDir = sdf::filesystem::append(_dir, "box");
+  sdf::filesystem::create_directory(_dir);
+  sdf::filesystem::create_directory(modelDir);
+
+  std::ofstream(sdf::filesystem::append(modelDir, "model.config"))
+      << "<model><name>box</name><sdf version='1.8'>model.sdf</sdf></model>";
+  std::ofstream(sdf::filesystem::append(modelDir, "model.sdf"))
+      << "<sdf version='1.8'><model name='box'><link name='l'>"
+      << "<inertial><mass>2</mass></inertial></link></model></sdf>";
+  const std::string worldFile = sdf::filesystem::append(_dir, "world.sdf");
+  std::ofstream(worldFile)
+      << "<sdf version='1.8'><world name='default'>"
+      << "<include><uri>" << modelDir << "</uri></include>"
+      << "</world></sdf>";
+  return worldFile;
+}
+
+/////////////////////////////////////////////////
+/// \brief Read a file and write it back.
+/// \param[in] _filename File to read.
+/// \param[in] _config Parser configuration.
+/// \return The string of the document, or an empty string on errors.
+static std::string readFileToString(const std::string &_filename,
+    const sdf::ParserConfig &_config)
+{
+  sdf::SDFPtr sdf(new sdf::SDF());
+  sdf::init(sdf);
+  sdf::Errors errors;
+  if (!sdf::readFile(_filename, _config, sdf, errors) || !errors.empty())
+    return "";
+  return sdf->Root()->ToString("");
+}
+
+/////////////////////////////////////////////////
+TEST(Parser, ReadFileArenaReleased)
+{
+  const std::string worldFile = writeIncludingWorld(
+      sdf::filesystem::append(PROJECT_BINARY_DIR, "parser_arena_released"));
+  const std::string expected =
+      readFileToString(worldFile, sdf::ParserConfig());
+  ASSERT_FALSE(expected.empty());
+
+  // The included model cached by the first load, and the descriptions it
+  // created, don't use its arena, which goes away with the document.
+  sdf::clearIncludeCache();
+  sdf::ParserConfig config;
+  config.SetUseElementArena(true);
+  EXPECT_EQ(expected, readFileToString(worldFile, config));
+  EXPECT_EQ(expected, readFileToString(worldFile, config));
+  EXPECT_EQ(expected, readFileToString(worldFile, sdf::ParserConfig()));
+  sdf::clearIncludeCache();
+}
+
+/////////////////////////////////////////////////
+TEST(Parser, ReadFileMemoryResourceReleased)
+{
+  const std::string worldFile = writeIncludingWorld(sdf::filesystem::append(
+      PROJECT_BINARY_DIR, "parser_memory_resource_released"));
+  const std::string expected =
+      readFileToString(worldFile, sdf::ParserConfig());
+  ASSERT_FALSE(expected.empty());
+
+  // Nothing that outlives the document takes memory from the resource, so
+  // it can be destroyed with the document.
+  sdf::clearIncludeCache();
+  {
+    CountingResource resource;
+    sdf::ParserConfig config;
+    config.SetMemoryResource(&resource);
+    EXPECT_EQ(expected, readFileToString(worldFile, config));
+    EXPECT_LT(0u, resource.allocations);
+    EXPECT_EQ(0u, resource.bytes);
+  }
+
+  CountingResource resource;
+  sdf::ParserConfig config;
+  config.SetMemoryResource(&resource);
+  EXPECT_EQ(expected, readFileToString(worldFile, config));
+  EXPECT_EQ(expected, readFileToString(worldFile, sdf::ParserConfig()));
+  EXPECT_EQ(0u, resource.bytes);
+  sdf::clearIncludeCache();
+}
+
+/////////////////////////////////////////////////
+TEST(Parser, ReadBinaryFile)
+{
+  const std::string sdfString =
+    "<sdf version='1.8'>"
+    "  <world name='default'>"
+    "    <gravity>0 0 -9.5</gravity>"
+    "    <scene><ambient>0.1 0.2 0.3 1</ambient></scene>"
+    "    <model name='box'>"
+    "      <static>true</static>"
+    "      <pose>1 2 3 0.1 0.2 0.3</pose>"
+    "      <link name='link'>"
+    "        <inertial><mass>2.5</mass></inertial>"
+    "        <visual name='visual'>"
+    "          <geometry><box><size>1 2 3</size></box></geometry>"
+    "        </visual>"
+    "      </link>"
+    "      <plugin name='p' filename='libp.so'>"
+    "        <custom attr='x'>value<nested>1</nested></custom>"
+    "      </plugin>"
+    "    </model>"
+    "  </world>"
+    "</sdf>";
+
+  sdf::SDFPtr sdf(new sdf::SDF());
+  ASSERT_TRUE(sdf::init(sdf));
+  sdf::Errors errors;
+  ASSERT_TRUE(sdf::readString(sdfString, sdf, errors));
+  EXPECT_TRUE(errors.empty());
+
+  const std::string filename = sdf::filesystem::append(
+      PROJECT_BINARY_DIR, "parser_read_binary_file.sdfb");
+  ASSERT_TRUE(sdf->WriteBinary(filename, errors));
+  EXPECT_TRUE(errors.empty());
+
+  sdf::SDFPtr snapshot(new sdf::SDF());
+  ASSERT_TRUE(sdf::init(snapshot));
+  ASSERT_TRUE(sdf::readBinaryFile(filename, snapshot, errors));
+  EXPECT_TRUE(errors.empty());
+  EXPECT_EQ(sdf->ToString(), snapshot->ToString());
+  EXPECT_EQ(sdf->OriginalVersion(), snapshot->OriginalVersion());
+
+  // Values are read natively, and keep their set state.
+  sdf::ElementPtr model =
+      snapshot->Root()->GetElement("world")->GetElement("model");
+  EXPECT_EQ(ignition::math::Pose3d(1, 2, 3, 0.1, 0.2, 0.3),
+            model->Get<ignition::math::Pose3d>("pose"));
+  EXPECT_TRUE(model->Get<bool>("static"));
+  EXPECT_TRUE(model->GetAttribute("name")->GetSet());
+  EXPECT_TRUE(model->GetElement("link")->GetAttribute(
+      "name")->GetRequired());
+  sdf::ElementPtr custom =
+      model->GetElement("plugin")->GetElement("custom");
+  EXPECT_EQ("x", custom->GetAttribute("attr")->GetAsString());
+  EXPECT_EQ("value", custom->GetValue()->GetAsString());
+
+  // The read document can be extended like a parsed document.
+  sdf::ElementPtr link = model->AddElement("link");
+  ASSERT_NE(nullptr, link);
+  EXPECT_TRUE(link->HasElementDescription("visual"));
+
+  // A snapshot of a different specification version is rejected.
+  const std::string mismatchFilename = sdf::filesystem::append(
+      PROJECT_BINARY_DIR, "parser_read_binary_file_mismatch.sdfb");
+  const std::string version = sdf::SDF::Version();
+  sdf::SDF::Version("1.0");
+  EXPECT_TRUE(sdf->WriteBinary(mismatchFilename, errors));
+  sdf::SDF::Version(version);
+  EXPECT_TRUE(errors.empty());
+
+  sdf::SDFPtr mismatch(new sdf::SDF());
+  ASSERT_TRUE(sdf::init(mismatch));
+  EXPECT_FALSE(sdf::readBinaryFile(mismatchFilename, mismatch, errors));
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::FILE_READ, errors[0].Code());
+  EXPECT_NE(std::string::npos, errors[0].Message().find("version [1.0]"));
+
+  // Files that are not snapshots are rejected.
+  errors.clear();
+  const std::string sdfFilename = sdf::filesystem::append(
+      PROJECT_SOURCE_PATH, "test", "sdf", "box_plane_low_friction_test.world");
+  EXPECT_FALSE(sdf::readBinaryFile(sdfFilename, mismatch, errors));
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::FILE_READ, errors[0].Code());
+
+  errors.clear();
+  EXPECT_FALSE(sdf::readBinaryFile("missing.sdfb", mismatch, errors));
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::FILE_READ, errors[0].Code());
+}
+
+/////////////////////////////////////////////////
+TEST(Parser, ReadFileLoadCache)
+{
+  const std::string dir = sdf::filesystem::append(
+      PROJECT_BINARY_DIR, "parser_load_cache");
+  const std::string modelDir = sdf::filesystem::append(dir, "box");
+  const std::string cacheDir = sdf::filesystem::append(dir, "cache");
+  sdf::filesystem::create_directory(dir);
+  sdf::filesystem::create_directory(modelDir);
+
+  auto writeFile = [](const std::string &_filename,
+                      const std::string &_content)
+  {
+    std::ofstream out(_filename);
+    out << _content;
+  };
+  auto writeModel = [&](const std::string &_pose)
+  {
+    writeFile(sdf::filesystem::append(modelDir, "model.sdf"),
+        "<sdf version='1.8'><model name='box'><pose>" + _pose + "</pose>"
+        "<link name='link'/></model></sdf>");
+  };
+  writeFile(sdf::filesystem::append(modelDir, "model.config"),
+      "<model><name>box</name><sdf version='1.8'>model.sdf</sdf></model>");
+  writeModel("1 2 3 0 0 0");
+
+  const std::string worldFile = sdf::filesystem::append(dir, "world.sdf");
+  writeFile(worldFile,
+      "<sdf version='1.6'><world name='default'>"
+      "<include><uri>" + modelDir + "</uri></include>"
+      "</world></sdf>");
+
+  sdf::LoadStats stats;
+  sdf::ParserConfig config;
+  config.SetLoadCachePath(cacheDir);
+  config.SetStats(&stats);
+
+  auto load = [&](sdf::SDFPtr &_sdf)
+  {
+    stats.Reset();
+    _sdf.reset(new sdf::SDF());
+    sdf::init(_sdf);
+    sdf::Errors errors;
+    EXPECT_TRUE(sdf::readFile(worldFile, config, _sdf, errors));
+    EXPECT_TRUE(errors.empty());
+  };
+
+  // The first read parses the files and fills the cache.
+  sdf::SDFPtr parsed;
+  load(parsed);
+  EXPECT_LT(0u, stats.Count(sdf::LoadPhase::XML_PARSE));
+  EXPECT_TRUE(sdf::filesystem::is_directory(cacheDir));
+
+  // The second read comes from the cache.
+  sdf::SDFPtr cached;
+  load(cached);
+  EXPECT_EQ(0u, stats.Count(sdf::LoadPhase::XML_PARSE));
+  EXPECT_EQ(parsed->ToString(), cached->ToString());
+  EXPECT_EQ("1.6", cached->OriginalVersion());
+
+  // Changing an included file invalidates the entry.
+  sdf::clearIncludeCache();
+  writeModel("4 5 6 0 0 0");
+  sdf::SDFPtr changed;
+  load(changed);
+  EXPECT_LT(0u, stats.Count(sdf::LoadPhase::XML_PARSE));
+  EXPECT_EQ(ignition::math::Pose3d(4, 5, 6, 0, 0, 0),
+      changed->Root()->GetElement("world")->GetElement("model")
+          ->Get<ignition::math::Pose3d>("pose"));
+
+  sdf::SDFPtr recached;
+  load(recached);
+  EXPECT_EQ(0u, stats.Count(sdf::LoadPhase::XML_PARSE));
+  EXPECT_EQ(changed->ToString(), recached->ToString());
+
+  // Without a cache directory the file is always parsed.
+  config.SetLoadCachePath("");
+  sdf::SDFPtr uncached;
+  load(uncached);
+  EXPECT_LT(0u, stats.Count(sdf::LoadPhase::XML_PARSE));
+}
+
+/////////////////////////////////////////////////
+TEST(Parser, ReadFileLoadCacheIncludeChanged)
+{
+  const std::string dir = sdf::filesystem::append(
+      PROJECT_BINARY_DIR, "parser_load_cache_include_changed");
+  const std::string boxDir = sdf::filesystem::append(dir, "box");
+  const std::string ballDir = sdf::filesystem::append(dir, "ball");
+  const std::string cacheDir = sdf::filesystem::append(dir, "cache");
+  sdf::filesystem::create_directory(dir);
+  sdf::filesystem::create_directory(boxDir);
+  sdf::filesystem::create_directory(ballDir);
+
+  auto writeFile = [](const std::string &_filename,
+                      const std::string &_content)
+  {
+    std::ofstream out(_filename);
+    out << _content;
+  };
+  auto writeModel = [&](const std::string &_modelDir,
+                        const std::string &_name, const std::string &_pose)
+  {
+    writeFile(sdf::filesystem::append(_modelDir, "model.config"),
+        "<model><name>" + _name + "</name>"
+        "<sdf version='1.8'>model.sdf</sdf></model>");
+    writeFile(sdf::filesystem::append(_modelDir, "model.sdf"),
+        "<sdf version='1.8'><model name='" + _name + "'><pose>" + _pose +
+        "</pose><link name='link'/></model></sdf>");
+  };
+  writeModel(boxDir, "box", "1 2 3 0 0 0");
+  writeModel(ballDir, "ball", "0 0 1 0 0 0");
+
+  const std::string worldFile = sdf::filesystem::append(dir, "world.sdf");
+  writeFile(worldFile,
+      "<sdf version='1.8'><world name='default'>"
+      "<include><uri>" + boxDir + "</uri></include>"
+      "<include><uri>model://parser_load_cache_ball</uri></include>"
+      "</world></sdf>");
+
+  // The box is edited after it was read, while the ball is looked up.
+  sdf::ParserConfig config;
+  config.SetLoadCachePath(cacheDir);
+  config.SetFindCallback([&](const std::string &_uri) -> std::string
+  {
+    if (_uri.find("parser_load_cache_ball") == std::string::npos)
+      return "";
+    writeModel(boxDir, "box", "10 20 30 0 0 0");
+    return ballDir;
+  });
+
+  auto boxPose = [&]()
+  {
+    sdf::SDFPtr sdf(new sdf::SDF());
+    sdf::init(sdf);
+    sdf::Errors errors;
+    EXPECT_TRUE(sdf::readFile(worldFile, config, sdf, errors));
+    EXPECT_TRUE(errors.empty());
+    return sdf->Root()->GetElement("world")->GetElement("model")
+        ->Get<ignition::math::Pose3d>("pose");
+  };
+
+  // The first read parsed the old box, which is not cached as the new one.
+  sdf::clearIncludeCache();
+  EXPECT_EQ(ignition::math::Pose3d(1, 2, 3, 0, 0, 0), boxPose());
+  sdf::clearIncludeCache();
+  EXPECT_EQ(ignition::math::Pose3d(10, 20, 30, 0, 0, 0), boxPose());
+  sdf::clearIncludeCache();
+}
+
+/////////////////////////////////////////////////
+TEST(Parser, ReadFileTrustedCaches)
+{
+  const std::string dir = sdf::filesystem::append(
+      PROJECT_BINARY_DIR, "parser_trusted_caches");
+  const std::string modelDir = sdf::filesystem::append(dir, "box");
+  const std::string cacheDir = sdf::filesystem::append(dir, "cache");
+  sdf::filesystem::create_directory(dir);
+  sdf::filesystem::create_directory(modelDir);
+
+  auto writeFile = [](const std::string &_filename,
+                      const std::string &_content)
+  {
+    std::ofstream out(_filename);
+    out << _content;
+  };
+
+  // Both files have a link without the required name.
+  writeFile(sdf::filesystem::append(modelDir, "model.config"),
+      "<model><name>box</name><sdf version='1.8'>model.sdf</sdf></model>");
+  writeFile(sdf::filesystem::append(modelDir, "model.sdf"),
+      "<sdf version='1.8'><model name='box'><link/></model></sdf>");
+  const std::string worldFile = sdf::filesystem::append(dir, "world.sdf");
+  writeFile(worldFile,
+      "<sdf version='1.8'><world name='default'>"
+      "<include><uri>" + modelDir + "</uri></include>"
+      "</world></sdf>");
+  const std::string modelFile = sdf::filesystem::append(dir, "model.sdf");
+  writeFile(modelFile,
+      "<sdf version='1.8'><model name='m'><link/></model></sdf>");
+
+  auto read = [](const std::string &_filename,
+                 const sdf::ParserConfig &_config)
+  {
+    sdf::SDFPtr sdf(new sdf::SDF());
+    sdf::init(sdf);
+    sdf::Errors errors;
+    sdf::readFile(_filename, _config, sdf, errors);
+    return errors;
+  };
+
+  sdf::ParserConfig trusted;
+  trusted.SetTrustedInput(true);
+  sdf::ParserConfig validated;
+
+  // An include first read as trusted is validated when read again.
+  sdf::clearIncludeCache();
+  EXPECT_TRUE(read(worldFile, trusted).empty());
+  EXPECT_FALSE(read(worldFile, validated).empty());
+  EXPECT_TRUE(read(worldFile, trusted).empty());
+
+  // So is a file stored in the load cache by a trusted read.
+  trusted.SetLoadCachePath(cacheDir);
+  validated.SetLoadCachePath(cacheDir);
+  EXPECT_TRUE(read(modelFile, trusted).empty());
+  EXPECT_TRUE(read(modelFile, trusted).empty());
+  EXPECT_FALSE(read(modelFile, validated).empty());
+  sdf::clearIncludeCache();
+}
+
+/////////////////////////////////////////////////
+TEST(Parser, ReservedFrameReferences)
+{
+  auto read = [](const std::string &_model, const sdf::ParserConfig &_config)
+  {
+    sdf::SDFPtr sdf = InitSDF();
+    sdf::Errors errors;
+    sdf::readString("<sdf version='1.8'>" + _model + "</sdf>", _config,
+        sdf, errors);
+    return errors;
+  };
+  auto reserved = [](const sdf::Errors &_errors, const std::string &_key)
+  {
+    const std::string message = "'__root__' is reserved; it cannot be used "
+        "as a value of attribute [" + _key + "]";
+    for (const auto &error : _errors)
+    {
+      if (error.Code() == sdf::ErrorCode::ATTRIBUTE_INVALID &&
+          error.Message() == message)
+      {
+        return true;
+      }
+    }
+    return false;
+  };
+
+  const sdf::ParserConfig validated;
+  sdf::ParserConfig trusted;
+  trusted.SetTrustedInput(true);
+
+  const std::vector<std::pair<std::string, std::string>> models =
+  {
+    {"attached_to",
+     "<model name='m'><link name='l'/>"
+     "<frame name='f' attached_to='__root__'/></model>"},
+    {"relative_to",
+     "<model name='m'><link name='l'>"
+     "<pose relative_to='__root__'>0 0 0 0 0 0</pose></link></model>"},
+    {"placement_frame",
+     "<model name='m' placement_frame='__root__'><link name='l'/></model>"},
+    {"canonical_link",
+     "<model name='m' canonical_link='__root__'><link name='l'/></model>"},
+    {"parent_frame",
+     "<model name='m'><link name='l'><sensor name='s' type='imu'><imu>"
+     "<orientation_reference_frame>"
+     "<custom_rpy parent_frame='__root__'>0 0 0</custom_rpy>"
+     "</orientation_reference_frame></imu></sensor></link></model>"},
+  };
+  for (const auto &[key, model] : models)
+  {
+    EXPECT_TRUE(reserved(read(model, validated), key)) << key;
+    EXPECT_FALSE(reserved(read(model, trusted), key)) << key;
+  }
+
+  // Attributes that do not name a frame are not checked.
+  EXPECT_FALSE(reserved(read(
+      "<model name='m'><link name='l'/>"
+      "<plugin name='__root__' filename='__root__'/></model>", validated),
+      "name"));
+}
+
+/////////////////////////////////////////////////
+TEST(Parser, ReadUrdf)
+{
+  const std::string urdf =
+    "<robot name='arm'>"
+    "  <link name='base'>"
+    "    <inertial><mass value='1'/>"
+    "      <inertia ixx='1' ixy='0' ixz='0' iyy='1' iyz='0' izz='1'/>"
+    "    </inertial>"
+    "  </link>"
+    "  <link name='forearm'>"
+    "    <inertial><mass value='2'/>"
+    "      <inertia ixx='1' ixy='0' ixz='0' iyy='1' iyz='0' izz='1'/>"
+    "    </inertial>"
+    "  </link>"
+    "  <joint name='elbow' type='revolute'>"
+    "    <parent link='base'/><child link='forearm'/>"
+    "    <limit lower='-1' upper='1' effort='1' velocity='1'/>"
+    "  </joint>"
+    "</robot>";
+
+  const std::string dir =
+      sdf::filesystem::append(PROJECT_BINARY_DIR, "parser_read_urdf");
+  sdf::filesystem::create_directory(dir);
+  auto write = [&dir](const std::string &_name, const std::string &_xml)
+  {
+    const std::string filename = sdf::filesystem::append(dir, _name);
+    std::ofstream(filename) << _xml;
+    return filename;
+  };
+  auto readStr = [](const std::string &_xml, sdf::SDFPtr &_sdf)
+  {
+    _sdf = InitSDF();
+    sdf::Errors errors;
+    return sdf::readString(_xml, _sdf, errors);
+  };
+  auto readFile = [](const std::string &_filename, sdf::SDFPtr &_sdf)
+  {
+    _sdf = InitSDF();
+    sdf::Errors errors;
+    return sdf::readFile(_filename, _sdf, errors);
+  };
+
+  // A string and a file convert to the same model.
+  sdf::SDFPtr fromString;
+  ASSERT_TRUE(readStr(urdf, fromString));
+  sdf::ElementPtr model = fromString->Root()->GetElement("model");
+  EXPECT_EQ("arm", model->Get<std::string>("name"));
+  sdf::ElementPtr link = model->GetElement("link");
+  EXPECT_EQ("base", link->Get<std::string>("name"));
+  link = link->GetNextElement("link");
+  ASSERT_NE(nullptr, link);
+  EXPECT_EQ("forearm", link->Get<std::string>("name"));
+  EXPECT_DOUBLE_EQ(2.0, link->GetElement("inertial")->Get<double>("mass"));
+  EXPECT_EQ(nullptr, link->GetNextElement("link"));
+  EXPECT_EQ("elbow", model->GetElement("joint")->Get<std::string>("name"));
+
+  sdf::SDFPtr fromFile;
+  ASSERT_TRUE(readFile(write("arm.urdf", urdf), fromFile));
+  EXPECT_EQ(fromString->Root()->ToString(""),
+      fromFile->Root()->ToString(""));
+
+  // A robot that urdfdom rejects, and a document that is neither SDFormat
+  // nor URDF, fail to read.
+  const std::string empty = "<robot name='empty'/>";
+  sdf::SDFPtr failed;
+  EXPECT_FALSE(readStr(empty, failed));
+  EXPECT_FALSE(readFile(write("empty.urdf", empty), failed));
+
+  const std::string other = "<scene name='arm'><link name='base'/></scene>";
+  EXPECT_FALSE(readStr(other, failed));
+  EXPECT_FALSE(readFile(write("other.xml", other), failed));
+}
+
+/////////////////////////////////////////////////
+TEST(Parser, ReadStringLazyElements)
+{
+  const std::string sdfString =
+    "<sdf version='1.8'>"
+    "  <model name='robot'>"
+    "    <link name='link'>"
+    "      <sensor name='camera' type='camera'>"
+    "        <update_rate>30</update_rate>"
+    "        <camera><image><width>640</width></image></camera>"
+    "      </sensor>"
+    "    </link>"
+    "    <plugin name='controller' filename='libcontroller.so'>"
+    "      <gain>2.5</gain>"
+    "      <joints><joint>a</joint><joint>b</joint></joints>"
+    "    </plugin>"
+    "  </model>"
+    "</sdf>";
+
+  sdf::LoadStats stats;
+  sdf::ParserConfig config;
+  config.SetStats(&stats);
+
+  sdf::SDFPtr eager(new sdf::SDF());
+  ASSERT_TRUE(sdf::init(eager));
+  sdf::Errors errors;
+  ASSERT_TRUE(sdf::readString(sdfString, config, eager, errors));
+  EXPECT_TRUE(errors.empty());
+  const uint64_t eagerReads = stats.Count(sdf::LoadPhase::READ_XML);
+
+  stats.Reset();
+  config.SetLazyElements({"plugin", "sensor"});
+  sdf::SDFPtr lazy(new sdf::SDF());
+  ASSERT_TRUE(sdf::init(lazy));
+  ASSERT_TRUE(sdf::readString(sdfString, config, lazy, errors));
+  EXPECT_TRUE(errors.empty());
+  EXPECT_LT(stats.Count(sdf::LoadPhase::READ_XML), eagerReads);
+
+  // Attributes of deferred elements are read with the document.
+  sdf::ElementPtr model = lazy->Root()->GetElement("model");
+  sdf::ElementPtr sensor = model->GetElement("link")->GetElement("sensor");
+  EXPECT_EQ("camera", sensor->Get<std::string>("name"));
+  sdf::ElementPtr plugin = model->GetElement("plugin");
+  EXPECT_EQ("libcontroller.so", plugin->Get<std::string>("filename"));
+
+  // Clones of deferred elements read their own children.
+  sdf::ElementPtr sensorClone = sensor->Clone();
+  EXPECT_DOUBLE_EQ(30.0, sensorClone->Get<double>("update_rate"));
+
+  // Children are read on first access.
+  EXPECT_DOUBLE_EQ(30.0, sensor->Get<double>("update_rate"));
+  EXPECT_EQ(640, sensor->GetElement("camera")->GetElement("image")
+                     ->Get<int>("width"));
+  sdf::ElementPtr joint = plugin->GetElement("joints")->GetFirstElement();
+  ASSERT_NE(nullptr, joint);
+  EXPECT_EQ("a", joint->GetValue()->GetAsString());
+  ASSERT_NE(nullptr, joint->GetNextElement("joint"));
+
+  // Once read, the documents are the same.
+  EXPECT_EQ(eager->ToString(), lazy->ToString());
+
+  // Serializing reads the children that were not accessed yet.
+  sdf::SDFPtr unread(new sdf::SDF());
+  ASSERT_TRUE(sdf::init(unread));
+  ASSERT_TRUE(sdf::readString(sdfString, config, unread, errors));
+  EXPECT_EQ(eager->ToString(), unread->ToString());
+}
+
+/////////////////////////////////////////////////
+TEST(Parser, ReadStringLazyCopyChildren)
+{
+  std::string sdfString =
+    "<sdf version='1.8'>"
+    "  <model name='robot'>"
+    "    <link name='link'/>"
+    "    <plugin name='controller' filename='libcontroller.so'>"
+    "      <gains>";
+  for (int i = 0; i < 100; ++i)
+  {
+    sdfString += "<gain joint='j" + std::to_string(i) + "'>" +
+        std::to_string(i * 0.5) + "</gain>";
+  }
+  sdfString +=
+    "      </gains>"
+    "    </plugin>"
+    "  </model>"
+    "</sdf>";
+
+  sdf::LoadStats stats;
+  sdf::ParserConfig config;
+  config.SetStats(&stats);
+
+  sdf::SDFPtr eager(new sdf::SDF());
+  ASSERT_TRUE(sdf::init(eager));
+  sdf::Errors errors;
+  ASSERT_TRUE(sdf::readString(sdfString, config, eager, errors));
+  EXPECT_TRUE(errors.empty());
+
+  // Copied children are kept as XML until they are accessed.
+  config.SetLazyCopyChildren(true);
+  sdf::SDFPtr lazy(new sdf::SDF());
+  ASSERT_TRUE(sdf::init(lazy));
+  ASSERT_TRUE(sdf::readString(sdfString, config, lazy, errors));
+  EXPECT_TRUE(errors.empty());
+
+  sdf::ElementPtr plugin = lazy->Root()->GetElement("model")
+      ->GetElement("plugin");
+  ASSERT_NE(nullptr, plugin);
+  EXPECT_TRUE(plugin->GetCopyChildren());
+  EXPECT_EQ("controller", plugin->Get<std::string>("name"));
+
+  sdf::ElementPtr gain = plugin->GetElement("gains")->GetFirstElement();
+  ASSERT_NE(nullptr, gain);
+  EXPECT_EQ("j0", gain->GetAttribute("joint")->GetAsString());
+  EXPECT_EQ(eager->ToString(), lazy->ToString());
+}
+
+/////////////////////////////////////////////////
+TEST(Parser, ReadStringDeepNesting)
+{
+  const int depth = 100;
+  auto nestedModels = [depth](const std::string &_innermost)
+  {
+    std::string result = "<sdf version='1.8'>";
+    for (int i = 0; i < depth; ++i)
+      result += "<model name='m" + std::to_string(i) + "'>";
+    result += _innermost;
+    for (int i = 0; i < depth; ++i)
+      result += "</model>";
+    return result + "</sdf>";
+  };
+
+  sdf::SDFPtr sdfParsed(new sdf::SDF());
+  ASSERT_TRUE(sdf::init(sdfParsed));
+  sdf::Errors errors;
+  ASSERT_TRUE(sdf::readString(nestedModels("<link name='l'/>"), sdfParsed,
+      errors));
+  EXPECT_TRUE(errors.empty());
+
+  sdf::ElementPtr model = sdfParsed->Root()->GetElement("model");
+  for (int i = 1; i < depth; ++i)
+  {
+    ASSERT_TRUE(model->HasElement("model")) << i;
+    model = model->GetElement("model");
+  }
+  EXPECT_EQ("m99", model->Get<std::string>("name"));
+  EXPECT_TRUE(model->HasElement("link"));
+
+  // An error at the bottom fails every enclosing element.
+  sdf::SDFPtr invalid(new sdf::SDF());
+  ASSERT_TRUE(sdf::init(invalid));
+  errors.clear();
+  EXPECT_FALSE(sdf::readString(nestedModels(
+      "<joint name='j' type='fixed'><parent>l</parent></joint>"), invalid,
+      errors));
+  ASSERT_FALSE(errors.empty());
+  EXPECT_EQ(sdf::ErrorCode::ELEMENT_MISSING, errors[0].Code());
+  int modelErrors = 0;
+  for (const auto &error : errors)
+  {
+    if (error.Message() == "Error reading element <model>")
+      ++modelErrors;
+  }
+  EXPECT_EQ(depth, modelErrors);
+}
+
+/////////////////////////////////////////////////
+TEST(Parser, ReadStringStreaming)
+{
+  const std::string sdfString = R"(<?xml version="1.0"?>
+<!-- The streaming reader creates the same elements as the DOM -->
+<sdf version="1.8">
+  <world name="default">
+    <gravity>0 0 -9.8</gravity>
+    <model name="a&amp;b" custom:attribute="value">
+      <static>true</static>
+      <link name="link">
+        <pose>1 2 3 0 0 0</pose>
+        <visual name="visual">
+          <geometry>
+            <box><size><![CDATA[1 2 3]]></size></box>
+          </geometry>
+        </visual>
+      </link>
+      <custom:element flag="1"><child>text</child></custom:element>
+      <plugin name="plugin" filename="libplugin.so">
+        <config><value>1</value></config>
+      </plugin>
+      <frame name="frame" attached_to="link"/>
+    </model>
+  </world>
+</sdf>)";
+
+  auto read = [](const std::string &_string, const sdf::ParserConfig &_config,
+                 sdf::Errors &_errors)
+  {
+    sdf::SDFPtr sdfParsed(new sdf::SDF());
+    sdf::init(sdfParsed);
+    if (!sdf::readString(_string, _config, sdfParsed, _errors))
+      return sdf::SDFPtr();
+    return sdfParsed;
+  };
+
+  sdf::ParserConfig streaming;
+  streaming.SetStreamingRead(true);
+
+  sdf::Errors errors;
+  sdf::SDFPtr dom = read(sdfString, sdf::ParserConfig(), errors);
+  sdf::SDFPtr streamed = read(sdfString, streaming, errors);
+  ASSERT_NE(nullptr, dom);
+  ASSERT_NE(nullptr, streamed);
+  EXPECT_TRUE(errors.empty());
+  EXPECT_EQ(dom->Root()->ToString(""), streamed->Root()->ToString(""));
+  EXPECT_EQ("1.8", streamed->OriginalVersion());
+
+  // Lazily read elements are deferred in the same way.
+  sdf::ParserConfig lazy;
+  lazy.SetLazyElements({"link"});
+  dom = read(sdfString, lazy, errors);
+  lazy.SetStreamingRead(true);
+  streamed = read(sdfString, lazy, errors);
+  ASSERT_NE(nullptr, dom);
+  ASSERT_NE(nullptr, streamed);
+  EXPECT_EQ(dom->Root()->ToString(""), streamed->Root()->ToString(""));
+
+  // Documents of an older version are converted through the DOM.
+  const std::string oldString =
+      "<sdf version='1.6'><model name='m'><link name='l'/></model></sdf>";
+  dom = read(oldString, sdf::ParserConfig(), errors);
+  streamed = read(oldString, streaming, errors);
+  ASSERT_NE(nullptr, dom);
+  ASSERT_NE(nullptr, streamed);
+  EXPECT_TRUE(errors.empty());
+  EXPECT_EQ(dom->Root()->ToString(""), streamed->Root()->ToString(""));
+  EXPECT_EQ("1.6", streamed->OriginalVersion());
+
+  // Errors are the same as those of the DOM.
+  const std::string invalidString =
+      "<sdf version='1.8'><model name='m'><link/></model></sdf>";
+  sdf::Errors domErrors;
+  EXPECT_EQ(nullptr, read(invalidString, sdf::ParserConfig(), domErrors));
+  sdf::Errors streamedErrors;
+  EXPECT_EQ(nullptr, read(invalidString, streaming, streamedErrors));
+  ASSERT_EQ(domErrors.size(), streamedErrors.size());
+  for (std::size_t i = 0; i < domErrors.size(); ++i)
+  {
+    EXPECT_EQ(domErrors[i].Code(), streamedErrors[i].Code());
+    EXPECT_EQ(domErrors[i].Message(), streamedErrors[i].Message());
+  }
+
+  // Malformed XML fails.
+  EXPECT_EQ(nullptr, read("<sdf version='1.8'><model name='m'></sdf>",
+      streaming, errors));
+}
+
+/////////////////////////////////////////////////
+TEST(Parser, ReadChunked)
+{
+  const std::string dir = sdf::filesystem::append(
+      PROJECT_BINARY_DIR, "parser_chunked");
+  const std::string modelDir = sdf::filesystem::append(dir, "box");
+  sdf::filesystem::create_directory(dir);
+  sdf::filesystem::create_directory(modelDir);
+  auto writeFile = [](const std::string &_filename,
+                      const std::string &_content)
+  {
+    std::ofstream out(_filename);
+    out << _content;
+  };
+  writeFile(sdf::filesystem::append(modelDir, "model.sdf"),
+      "<sdf version='1.8'><model name='box'><link name='link'/></model>"
+      "</sdf>");
+  writeFile(sdf::filesystem::append(modelDir, "model.config"),
+      "<model><name>box</name><sdf version='1.8'>model.sdf</sdf></model>");
+
+  // Includes, a missing file and an invalid value among many models, with
+  // elements that aren't parsed in parts between them.
+  std::string sdfString =
+      "<sdf version='1.8'>\n<world name='default'>\n"
+      "<gravity>0 0 -9.8</gravity>\n";
+  for (int i = 0; i < 3000; ++i)
+  {
+    const std::string index = std::to_string(i);
+    if (i % 500 == 0)
+    {
+      sdfString += "<include><uri>" + modelDir + "</uri><name>box" + index +
+          "</name><pose>0 " + index + " 0 0 0 0</pose></include>\n";
+    }
+    if (i == 1000)
+      sdfString += "<physics name='fast' type='ode'/>\n";
+    if (i == 2000)
+      sdfString += "<include><uri>model://missing</uri></include>\n";
+    sdfString += "<model name='m" + index + "'>\n"
+        "  <pose>" + index + " 0 0 0 0 0</pose>\n"
+        "  <static>" + (i == 2500 ? "maybe" : "true") + "</static>\n"
+        "  <link name='l'/>\n"
+        "</model>\n";
+  }
+  sdfString += "<light name='lamp' type='point'/>\n</world>\n</sdf>\n";
+  const std::string worldFile = sdf::filesystem::append(dir, "world.sdf");
+  writeFile(worldFile, sdfString);
+
+  auto read = [](const std::string &_input, bool _file,
+                 const sdf::ParserConfig &_config, sdf::Errors &_errors)
+  {
+    sdf::SDFPtr sdfParsed(new sdf::SDF());
+    sdf::init(sdfParsed);
+    if (_file)
+      sdf::readFile(_input, _config, sdfParsed, _errors);
+    else
+      sdf::readString(_input, _config, sdfParsed, _errors);
+    return sdfParsed->Root()->ToString("");
+  };
+  auto expectSameErrors = [](const sdf::Errors &_expected,
+                             const sdf::Errors &_errors)
+  {
+    ASSERT_EQ(_expected.size(), _errors.size());
+    for (std::size_t i = 0; i < _expected.size(); ++i)
+    {
+      EXPECT_EQ(_expected[i].Code(), _errors[i].Code());
+      EXPECT_EQ(_expected[i].Message(), _errors[i].Message());
+    }
+  };
+
+  sdf::ParserConfig serial;
+  serial.SetLoadThreadCount(4);
+  sdf::ParserConfig chunked = serial;
+  chunked.SetChunkedXmlParse(true);
+
+  sdf::Errors serialErrors;
+  const std::string expected = read(sdfString, false, serial, serialErrors);
+  EXPECT_NE(std::string::npos, expected.find("box2500"));
+  EXPECT_NE(std::string::npos, expected.find("m2999"));
+  EXPECT_FALSE(serialErrors.empty());
+
+  sdf::Errors errors;
+  EXPECT_EQ(expected, read(sdfString, false, chunked, errors));
+  expectSameErrors(serialErrors, errors);
+
+  serialErrors.clear();
+  errors.clear();
+  EXPECT_EQ(read(worldFile, true, serial, serialErrors),
+      read(worldFile, true, chunked, errors));
+  expectSameErrors(serialErrors, errors);
+
+  // Syntax errors are those of the whole document.
+  std::string broken = sdfString;
+  broken.replace(broken.find("</model>", sdfString.size() / 2), 8, "</mod>");
+  serialErrors.clear();
+  errors.clear();
+  read(broken, false, serial, serialErrors);
+  read(broken, false, chunked, errors);
+  expectSameErrors(serialErrors, errors);
+}
+
+/////////////////////////////////////////////////
+TEST(Parser, ConvertElement)
+{
+  const std::string sdfString = R"(
+<sdf version="1.4">
+  <model name="model">
+    <link name="parent"/>
+    <link name="child"/>
+    <joint name="joint" type="revolute">
+      <parent>parent</parent>
+      <child>child</child>
+      <axis><xyz>0 0 1</xyz></axis>
+    </joint>
+  </model>
+</sdf>)";
+
+  sdf::SDFPtr converted(new sdf::SDF());
+  sdf::init(converted);
+  sdf::Errors errors;
+  ASSERT_TRUE(sdf::readString(sdfString, converted, errors));
+  EXPECT_TRUE(errors.empty());
+
+  // The whole tree, from its original version.
+  sdf::SDFPtr unconverted(new sdf::SDF());
+  sdf::init(unconverted);
+  ASSERT_TRUE(sdf::readStringWithoutConversion(sdfString, unconverted,
+      errors));
+  EXPECT_EQ("1.4", unconverted->Root()->OriginalVersion());
+  sdf::ElementPtr xyz = unconverted->Root()->GetElement("model")
+      ->GetElement("joint")->GetElement("axis")->GetElement("xyz");
+  EXPECT_FALSE(xyz->GetAttributeSet("expressed_in"));
+
+  EXPECT_TRUE(sdf::convertElement(unconverted->Root(), errors));
+  EXPECT_TRUE(errors.empty());
+  EXPECT_EQ(converted->Root()->ToString(""),
+      unconverted->Root()->ToString(""));
+  xyz = unconverted->Root()->GetElement("model")->GetElement("joint")
+      ->GetElement("axis")->GetElement("xyz");
+  EXPECT_EQ("__model__", xyz->GetAttribute("expressed_in")->GetAsString());
+
+  // Only a model, which takes the version of the root.
+  unconverted.reset(new sdf::SDF());
+  sdf::init(unconverted);
+  ASSERT_TRUE(sdf::readStringWithoutConversion(sdfString, unconverted,
+      errors));
+  sdf::ElementPtr model = unconverted->Root()->GetElement("model");
+  EXPECT_TRUE(sdf::convertElement(model, errors));
+  EXPECT_TRUE(errors.empty());
+  EXPECT_EQ(converted->Root()->GetElement("model")->ToString(""),
+      model->ToString(""));
+  EXPECT_EQ(unconverted->Root(), model->GetParent());
+
+  // An element of the latest version is left as is.
+  EXPECT_TRUE(sdf::convertElement(converted->Root(), errors));
+  EXPECT_TRUE(errors.empty());
+
+  // Without a version to convert from.
+  sdf::ElementPtr orphan = model->Clone();
+  orphan->SetParent(nullptr);
+  orphan->SetOriginalVersion("");
+  EXPECT_FALSE(sdf::convertElement(orphan, errors));
+  EXPECT_EQ(1u, errors.size());
+}
+
+/////////////////////////////////////////////////
+TEST(Parser, WriteGraphs)
+{
+  const std::string sdfString = R"(
+<sdf version="1.8">
+  <world name="default">
+    <model name="M">
+      <link name="L"/>
+      <model name="N">
+        <link name="L"/>
+      </model>
+    </model>
+    <frame name="F" attached_to="M"/>
+  </world>
+</sdf>)";
+
+  sdf::Root root;
+  ASSERT_TRUE(root.LoadSdfString(sdfString).empty());
+
+  std::ostringstream all;
+  EXPECT_TRUE(sdf::writePoseRelativeToGraph(&root, all));
+  const std::string graph = all.str();
+  EXPECT_EQ(0u, graph.find("digraph {\n"));
+  EXPECT_EQ(graph.size() - 2, graph.find("}\n"));
+  EXPECT_NE(std::string::npos, graph.find("[label=\"world ("));
+  EXPECT_NE(std::string::npos, graph.find("[label=\"M::N::L ("));
+  EXPECT_NE(std::string::npos, graph.find("[label=\"F ("));
+
+  // Only the frames of the world scope.
+  std::ostringstream top;
+  EXPECT_TRUE(sdf::writeFrameAttachedToGraph(&root, top, "", 0));
+  EXPECT_NE(std::string::npos, top.str().find("[label=\"M ("));
+  EXPECT_NE(std::string::npos, top.str().find("[label=\"F ("));
+  EXPECT_EQ(std::string::npos, top.str().find("M::"));
+
+  // Only the scope of M, without the frames of N.
+  std::ostringstream scoped;
+  EXPECT_TRUE(sdf::writePoseRelativeToGraph(&root, scoped, "M", 1));
+  EXPECT_NE(std::string::npos, scoped.str().find("[label=\"M ("));
+  EXPECT_NE(std::string::npos, scoped.str().find("[label=\"M::L ("));
+  EXPECT_NE(std::string::npos, scoped.str().find("[label=\"M::N ("));
+  EXPECT_EQ(std::string::npos, scoped.str().find("M::N::"));
+  EXPECT_EQ(std::string::npos, scoped.str().find("world"));
+  EXPECT_NE(std::string::npos, scoped.str().find(" -> "));
+
+  std::ostringstream none;
+  EXPECT_FALSE(sdf::writePoseRelativeToGraph(&root, none, "X"));
+  const sdf::Root empty;
+  EXPECT_FALSE(sdf::writeFrameAttachedToGraph(&empty, none));
+  EXPECT_TRUE(none.str().empty());
+}
+
 /////////////////////////////////////////////////
 /// Main
 int main(int argc, char **argv)
@@ -21,6 +21,7 @@
 
 #include <string>
 
+#include "sdf/ParserConfig.hh"
 #include "sdf/SDFImpl.hh"
 #include "sdf/sdf_config.h"
 #include "sdf/system_util.hh"
@@ -69,11 +70,12 @@ namespace sdf
   /// \brief Populate the SDF values from a TinyXML document
   static bool readDoc(tinyxml2::XMLDocument *_xmlDoc, SDFPtr _sdf,
                       const std::string &_source, bool _convert,
-                      Errors &_errors);
+                      const ParserConfig &_config, Errors &_errors);
 
   /// \brief Populate the SDF values from a TinyXML document
   static bool readDoc(tinyxml2::XMLDocument *_xmlDoc, ElementPtr _sdf,
-      const std::string &_source, bool _convert, Errors &_errors);
+      const std::string &_source, bool _convert, const ParserConfig &_config,
+      Errors &_errors);
 
   /// \brief Populate an SDF Element from the XML input. The XML input here is
   /// an actual SDFormat file or string, not the description of the SDFormat
@@ -81,10 +83,12 @@ namespace sdf
   /// \remark For internal use only. Do not use this function.
   /// \param[in] _xml Pointer to the TinyXML element
   /// \param[in,out] _sdf SDF pointer to parse data into.
+  /// \param[in] _config Parser configuration.
   /// \param[out] _errors Captures errors found during parsing.
   /// \return True on success, false on error.
   static bool readXml(tinyxml2::XMLElement *_xml,
                       ElementPtr _sdf,
+                      const ParserConfig &_config,
                       Errors &_errors);
 
   /// \brief Copy child XML elements into the _sdf element.
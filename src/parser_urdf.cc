@@ -16,12 +16,14 @@
  */
 
 #include <algorithm>
+#include <cctype>
 #include <fstream>
 #include <map>
 #include <memory>
 #include <set>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -33,8 +35,12 @@
 
 #include "sdf/sdf.hh"
 
+#include "LoadStatsScope.hh"
+#include "NumberParsing.hh"
 #include "XmlUtils.hh"
 #include "SDFExtension.hh"
+#include "UrdfCache.hh"
+#include "Utils.hh"
 #include "parser_urdf.hh"
 
 using namespace sdf;
@@ -49,17 +55,76 @@ typedef std::shared_ptr<SDFExtension> SDFExtensionPtr;
 typedef std::map<std::string, std::vector<SDFExtensionPtr> >
   StringSDFExtensionPtrMap;
 
-/// create SDF geometry block based on URDF
-StringSDFExtensionPtrMap g_extensions;
-bool g_reduceFixedJoints;
-bool g_enforceLimits;
-std::string g_collisionExt = "_collision";
-std::string g_visualExt = "_visual";
-std::string g_lumpPrefix = "_fixed_joint_lump__";
-urdf::Pose g_initialRobotPose;
-bool g_initialRobotPoseValid = false;
-std::set<std::string> g_fixedJointsTransformedInRevoluteJoints;
-std::set<std::string> g_fixedJointsTransformedInFixedJoints;
+/// \brief An extension blob that refers to a link by name, and which
+/// ReduceSDFExtensionFrameReplace() updates when that link is reduced.
+struct SDFExtensionBlobRef
+{
+  /// \brief Extension that owns the blob.
+  SDFExtensionPtr ext;
+
+  /// \brief Index of the blob in ext->blobs.
+  size_t blob;
+};
+typedef std::map<std::string, std::vector<SDFExtensionBlobRef> >
+  StringSDFExtensionBlobRefMap;
+
+/// \brief Conversion state of a URDF2SDF instance
+class URDF2SDFPrivate
+{
+  /// create SDF geometry block based on URDF
+  public: StringSDFExtensionPtrMap extensions;
+
+  /// extension blobs keyed by the link names they refer to, built before
+  /// fixed joint reduction
+  public: StringSDFExtensionBlobRefMap extensionFrameRefs;
+
+  public: bool reduceFixedJoints = true;
+
+  public: bool enforceLimits = true;
+
+  public: urdf::Pose initialRobotPose;
+
+  public: bool initialRobotPoseValid = false;
+
+  public: std::set<std::string> fixedJointsTransformedInRevoluteJoints;
+
+  public: std::set<std::string> fixedJointsTransformedInFixedJoints;
+
+  /// \brief Maximum number of threads used to create the top level
+  /// branches of the kinematic tree, see parallelFor.
+  public: unsigned int threadCount = 1u;
+};
+
+/// \brief State of the conversion running on this thread. The free
+/// functions below read and update it, so that conversions with different
+/// URDF2SDF instances can run in parallel.
+thread_local URDF2SDFPrivate *g_state = nullptr;
+
+/// \brief Sets g_state for the lifetime of the object, and restores the
+/// previous state afterwards.
+class URDF2SDFStateScope
+{
+  /// \brief Constructor
+  /// \param[in] _state State of the conversion that is starting.
+  public: explicit URDF2SDFStateScope(URDF2SDFPrivate *_state)
+    : previous(g_state)
+  {
+    g_state = _state;
+  }
+
+  /// \brief Destructor
+  public: ~URDF2SDFStateScope()
+  {
+    g_state = this->previous;
+  }
+
+  /// \brief State that was current before this scope.
+  private: URDF2SDFPrivate *previous;
+};
+
+const std::string g_collisionExt = "_collision";
+const std::string g_visualExt = "_visual";
+const std::string g_lumpPrefix = "_fixed_joint_lump__";
 const int g_outputDecimalPrecision = 16;
 
 
@@ -77,6 +142,9 @@ void InsertSDFExtensionCollision(tinyxml2::XMLElement *_elem,
 /// insert extensions into model
 void InsertSDFExtensionRobot(tinyxml2::XMLElement *_elem);
 
+/// copy an extension element into an empty document to store it as a blob
+void CopyBlob(const tinyxml2::XMLElement *_src, tinyxml2::XMLDocument *_doc);
+
 /// insert extensions into visuals
 void InsertSDFExtensionVisual(tinyxml2::XMLElement *_elem,
                               const std::string &_linkName);
@@ -108,17 +176,27 @@ void ReduceSDFExtensionProjectorTransformReduction(
 ///   when doing fixed joint reduction
 void ReduceSDFExtensionsTransform(SDFExtensionPtr _ge);
 
-/// reduce fixed joints:  lump joints to parent link
-void ReduceJointsToParent(urdf::LinkSharedPtr _link);
+/// reduce fixed joints:  move the joints of the children of a reduced link
+///   to the link that keeps it
+void ReduceJointsToLink(urdf::LinkSharedPtr _link,
+                        urdf::LinkSharedPtr _keptLink,
+                        const ignition::math::Pose3d &_pose);
 
-/// reduce fixed joints:  lump collisions to parent link
-void ReduceCollisionsToParent(urdf::LinkSharedPtr _link);
+/// reduce fixed joints:  lump the collisions of a reduced link to the link
+///   that keeps it
+void ReduceCollisionsToLink(urdf::LinkSharedPtr _link,
+                            urdf::LinkSharedPtr _keptLink,
+                            const ignition::math::Pose3d &_pose);
 
-/// reduce fixed joints:  lump visuals to parent link
-void ReduceVisualsToParent(urdf::LinkSharedPtr _link);
+/// reduce fixed joints:  lump the visuals of a reduced link to the link
+///   that keeps it
+void ReduceVisualsToLink(urdf::LinkSharedPtr _link,
+                         urdf::LinkSharedPtr _keptLink,
+                         const ignition::math::Pose3d &_pose);
 
-/// reduce fixed joints:  lump inertial to parent link
-void ReduceInertialToParent(urdf::LinkSharedPtr /*_link*/);
+/// reduce fixed joints:  lump the inertials of every link that is reduced
+///   into _link, directly or through other reduced links, in one pass
+void ReduceInertialsToLink(urdf::LinkSharedPtr _link);
 
 /// create SDF Collision block based on URDF
 void CreateCollision(tinyxml2::XMLElement* _elem,
@@ -158,6 +236,18 @@ void AddTransform(tinyxml2::XMLElement *_elem,
 void CreateSDF(tinyxml2::XMLElement *_root, urdf::LinkConstSharedPtr _link,
                const ignition::math::Pose3d &_transform);
 
+/// create the SDF link and joint of a URDF link, without its children
+/// \return False if the link is not modeled, in which case its children
+/// are not either
+bool CreateSDFLink(tinyxml2::XMLElement *_root,
+                   urdf::LinkConstSharedPtr _link,
+                   const ignition::math::Pose3d &_transform);
+
+/// create SDF from the subtrees of URDF links, possibly in parallel
+void CreateSDFBranches(tinyxml2::XMLElement *_root,
+                       const std::vector<urdf::LinkSharedPtr> &_links,
+                       const ignition::math::Pose3d &_transform);
+
 /// create SDF Link block based on URDF
 void CreateLink(tinyxml2::XMLElement *_root, urdf::LinkConstSharedPtr _link,
                 ignition::math::Pose3d &_currentTransform);
@@ -209,8 +299,21 @@ void ReduceSDFExtensionToParent(urdf::LinkSharedPtr _link);
 /// reduced fixed joints:  apply appropriate frame updates
 ///   in urdf extensions when doing fixed joint reduction
 void ReduceSDFExtensionFrameReplace(SDFExtensionPtr _ge,
+    std::vector<XMLDocumentPtr>::iterator _blobIt,
     urdf::LinkSharedPtr _link);
 
+/// \brief Get the link names an extension blob refers to in the elements
+/// that the Reduce*FrameReplace functions update.
+/// \param[in] _blob extension blob to inspect.
+/// \return Referenced link names, possibly with duplicates.
+std::vector<std::string> SDFExtensionFrameRefs(
+    const XMLDocumentPtr &_blob);
+
+/// \brief Index the link names referenced by all extension blobs into
+/// g_state->extensionFrameRefs, so a fixed joint reduction only visits the
+/// blobs that refer to the reduced link.
+void IndexSDFExtensionFrameRefs();
+
 /// get value from <key value="..."/> pair and return it as string
 std::string GetKeyValueAsString(tinyxml2::XMLElement* _elem);
 
@@ -256,45 +359,125 @@ ignition::math::Pose3d CopyPose(urdf::Pose _pose);
 ///   math::Pose
 urdf::Pose CopyPose(ignition::math::Pose3d _pose);
 
+/////////////////////////////////////////////////
+/// \brief Skip a stream past the next occurrence of a terminator.
+/// \param[in,out] _in Stream to read.
+/// \param[in] _terminator Text to look for.
+/// \return False if the stream ended first.
+static bool skipPast(std::istream &_in, std::string_view _terminator)
+{
+  std::size_t matched = 0;
+  char c;
+  while (matched < _terminator.size() && _in.get(c))
+  {
+    if (c == _terminator[matched])
+      ++matched;
+    else
+      matched = (c == _terminator[0]) ? 1 : 0;
+  }
+  return matched == _terminator.size();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 bool URDF2SDF::IsURDF(const std::string &_filename)
 {
-  tinyxml2::XMLDocument xmlDoc;
+  std::ifstream in(_filename, std::ios::binary);
 
-  if (tinyxml2::XML_SUCCESS == xmlDoc.LoadFile(_filename.c_str()))
+  // Skip a byte order mark, then the prolog: the declaration, processing
+  // instructions, comments and the document type, up to the root element.
+  if (in.peek() == 0xEF)
+    in.ignore(3);
+  char c;
+  while (in.get(c))
   {
-    tinyxml2::XMLPrinter printer;
-    xmlDoc.Print(&printer);
-    std::string urdfStr = printer.CStr();
-    urdf::ModelInterfaceSharedPtr robotModel = urdf::parseURDF(urdfStr);
-    return robotModel != nullptr;
+    if (std::isspace(static_cast<unsigned char>(c)))
+      continue;
+    if (c != '<' || !in.get(c))
+      return false;
+
+    if (c == '?')
+    {
+      if (!skipPast(in, "?>"))
+        return false;
+    }
+    else if (c == '!' && in.peek() == '-')
+    {
+      if (!skipPast(in, "-->"))
+        return false;
+    }
+    else if (c == '!')
+    {
+      // A document type, which may have an internal subset in brackets.
+      while (in.get(c) && c != '>')
+      {
+        if (c == '[' && !skipPast(in, "]"))
+          return false;
+      }
+      if (!in)
+        return false;
+    }
+    else
+    {
+      std::string name(1, c);
+      while (in.get(c) && !std::isspace(static_cast<unsigned char>(c)) &&
+             c != '>' && c != '/')
+      {
+        name += c;
+      }
+      return name == "robot";
+    }
   }
 
   return false;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+bool URDF2SDF::IsURDF(const tinyxml2::XMLDocument &_xmlDoc)
+{
+  const tinyxml2::XMLElement *root = _xmlDoc.RootElement();
+  return root != nullptr && std::string_view(root->Name()) == "robot";
+}
+
 /////////////////////////////////////////////////
 urdf::Vector3 ParseVector3(const std::string &_str, double _scale)
 {
-  std::vector<std::string> pieces = sdf::split(_str, " ");
+  // Parse plain numbers separated by spaces without allocating. Other white
+  // space would not separate values below, so leave it to the slow path.
+  bool onlySpaces = true;
+  for (const char c : _str)
+  {
+    if (c != ' ' && IsClassicSpace(c))
+    {
+      onlySpaces = false;
+      break;
+    }
+  }
+  double xyz[3];
+  if (onlySpaces && ParseNumbers(_str, xyz, 3) == 3)
+  {
+    return urdf::Vector3(_scale * xyz[0], _scale * xyz[1], _scale * xyz[2]);
+  }
+
   std::vector<double> vals;
 
-  for (unsigned int i = 0; i < pieces.size(); ++i)
+  unsigned int i = 0;
+  for (std::string_view piece : sdf::SplitRange(_str, " "))
   {
-    if (pieces[i] != "")
+    if (!piece.empty())
     {
       try
       {
-        vals.push_back(_scale * std::stod(pieces[i]));
+        vals.push_back(_scale * std::stod(std::string(piece)));
       }
       catch(std::invalid_argument &)
       {
         sdferr << "xml key [" << _str
-               << "][" << i << "] value [" << pieces[i]
+               << "][" << i << "] value [" << piece
                << "] is not a valid double from a 3-tuple\n";
         return urdf::Vector3(0, 0, 0);
       }
     }
+    ++i;
   }
 
   if (vals.size() == 3)
@@ -333,6 +516,18 @@ urdf::Vector3 ParseVector3(tinyxml2::XMLNode *_key, double _scale)
 /// \return a string
 std::string Vector32Str(const urdf::Vector3 _vector)
 {
+  const double xyz[3] = {_vector.x, _vector.y, _vector.z};
+  std::string str;
+  bool formatted = true;
+  for (unsigned int i = 0; formatted && i < 3; ++i)
+  {
+    if (i > 0)
+      str += ' ';
+    formatted = AppendStreamNumber(str, xyz[i]);
+  }
+  if (formatted)
+    return str;
+
   std::stringstream ss;
   ss << _vector.x;
   ss << " ";
@@ -346,9 +541,9 @@ std::string Vector32Str(const urdf::Vector3 _vector)
 /// \brief Check and add collision to parent link
 /// \param[in] _parentLink destination for _collision
 /// \param[in] _name urdfdom 0.3+: urdf collision group name with lumped
-///            collision info (see ReduceCollisionsToParent).
+///            collision info (see ReduceCollisionsToLink).
 ///            urdfdom 0.2: collision name with lumped
-///            collision info (see ReduceCollisionsToParent).
+///            collision info (see ReduceCollisionsToLink).
 /// \param[in] _collision move this collision to _parentLink
 void ReduceCollisionToParent(urdf::LinkSharedPtr _parentLink,
                              const std::string &_name,
@@ -379,9 +574,9 @@ void ReduceCollisionToParent(urdf::LinkSharedPtr _parentLink,
 /// \brief Check and add visual to parent link
 /// \param[in] _parentLink destination for _visual
 /// \param[in] _name urdfdom 0.3+: urdf visual group name with lumped
-///            visual info (see ReduceVisualsToParent).
+///            visual info (see ReduceVisualsToLink).
 ///            urdfdom 0.2: visual name with lumped
-///            visual info (see ReduceVisualsToParent).
+///            visual info (see ReduceVisualsToLink).
 /// \param[in] _visual move this visual to _parentLink
 void ReduceVisualToParent(urdf::LinkSharedPtr _parentLink,
                           const std::string &_name,
@@ -411,339 +606,114 @@ void ReduceVisualToParent(urdf::LinkSharedPtr _parentLink,
 ////////////////////////////////////////////////////////////////////////////////
 /// reduce fixed joints by lumping inertial, visual and
 // collision elements of the child link into the parent link
-void ReduceFixedJoints(tinyxml2::XMLElement *_root, urdf::LinkSharedPtr _link)
+void ReduceFixedJoints(tinyxml2::XMLElement */*_root*/,
+                       urdf::LinkSharedPtr _link)
 {
-  // if child is attached to self by fixed _link first go up the tree,
-  //   check it's children recursively
-  for (unsigned int i = 0 ; i < _link->child_links.size() ; ++i)
+  // a link is reduced into its parent, but skip first joint if it's the world
+  auto shouldBeReduced = [](const urdf::LinkSharedPtr &_l)
   {
-    if (FixedJointShouldBeReduced(_link->child_links[i]->parent_joint))
-    {
-      ReduceFixedJoints(_root, _link->child_links[i]);
-    }
-  }
+    return _l->getParent() && _l->getParent()->name != "world" &&
+      _l->parent_joint && FixedJointShouldBeReduced(_l->parent_joint);
+  };
 
-  // reduce this _link's stuff up the tree to parent but skip first joint
-  //   if it's the world
-  if (_link->getParent() && _link->getParent()->name != "world" &&
-      _link->parent_joint && FixedJointShouldBeReduced(_link->parent_joint) )
+  // the links connected by reduced fixed joints are lumped into the link
+  //   at the top of their fixed subtree. Find that kept link for every
+  //   reduced link at once, with the pose of the reduced link in the kept
+  //   link frame, so that each element is transformed only once, however
+  //   long the chain of fixed joints above it.
+  struct ReducedLink
   {
-    sdfdbg << "Fixed Joint Reduction: extension lumping from ["
-           << _link->name << "] to [" << _link->getParent()->name << "]\n";
-
-    // lump sdf extensions to parent, (give them new reference _link names)
-    ReduceSDFExtensionToParent(_link);
-
-    // reduce _link elements to parent
-    ReduceInertialToParent(_link);
-    ReduceVisualsToParent(_link);
-    ReduceCollisionsToParent(_link);
-    ReduceJointsToParent(_link);
-  }
-
-  // continue down the tree for non-fixed joints
-  for (unsigned int i = 0 ; i < _link->child_links.size() ; ++i)
+    urdf::LinkSharedPtr link;
+    urdf::LinkSharedPtr keptLink;
+    ignition::math::Pose3d pose;
+  };
+  std::vector<ReducedLink> reduced;
+  std::vector<ReducedLink> stack;
+  stack.push_back({_link, nullptr, ignition::math::Pose3d::Zero});
+  while (!stack.empty())
   {
-    if (!FixedJointShouldBeReduced(_link->child_links[i]->parent_joint))
+    ReducedLink current = stack.back();
+    stack.pop_back();
+
+    urdf::LinkSharedPtr keptLink = current.keptLink;
+    ignition::math::Pose3d pose = current.pose;
+    if (keptLink)
     {
-      ReduceFixedJoints(_root, _link->child_links[i]);
+      reduced.push_back(current);
+    }
+    else
+    {
+      // a link that is kept takes the inertials of its whole fixed subtree
+      ReduceInertialsToLink(current.link);
+      keptLink = current.link;
+      pose = ignition::math::Pose3d::Zero;
     }
-  }
-}
-
-// ODE dMatrix
-typedef double dMatrix3[4*3];
-typedef double dVector3[4];
-#define _R(i, j) R[(i)*4+(j)]
-#define _I(i, j) I[(i)*4+(j)]
-#define dRecip(x) ((1.0f/(x)))
-
-struct dMass;
-void dMassSetZero(dMass *m);
-void dMassSetParameters(dMass *m, double themass,
-                        double cgx, double cgy, double cgz,
-                        double I11, double I22, double I33,
-                        double I12, double I13, double I23);
-
-struct dMass
-{
-  double mass;
-  dVector3 c;
-  dMatrix3 I;
-
-  dMass()
-  {
-    dMassSetZero(this);
-  }
 
-  void setZero()
-  {
-    dMassSetZero(this);
+    // visit the children in order, so that the kept links list the lumped
+    //   elements depth first, like the chains are in the urdf
+    const std::vector<urdf::LinkSharedPtr> &children =
+      current.link->child_links;
+    for (auto child = children.rbegin(); child != children.rend(); ++child)
+    {
+      if (shouldBeReduced(*child))
+      {
+        stack.push_back({*child, keptLink, TransformToParentFrame(
+            CopyPose((*child)->parent_joint->parent_to_joint_origin_transform),
+            pose)});
+      }
+      else
+      {
+        stack.push_back({*child, nullptr, ignition::math::Pose3d::Zero});
+      }
+    }
   }
 
-  void setParameters(double themass, double cgx, double cgy, double cgz,
-                     double I11, double I22, double I33,
-                     double I12, double I13, double I23)
+  // reduce link elements to the kept link
+  for (const ReducedLink &r : reduced)
   {
-    dMassSetParameters(this,
-                       themass,
-                       cgx,
-                       cgy,
-                       cgz,
-                       I11,
-                       I22,
-                       I33,
-                       I12,
-                       I13,
-                       I23);
+    sdfdbg << "Fixed Joint Reduction: lumping from ["
+           << r.link->name << "] to [" << r.keptLink->name << "]\n";
+    ReduceVisualsToLink(r.link, r.keptLink, r.pose);
+    ReduceCollisionsToLink(r.link, r.keptLink, r.pose);
+    ReduceJointsToLink(r.link, r.keptLink, r.pose);
   }
-};
 
-void dSetZero(double *a, int n)
-{
-  // dAASSERT (a && n >= 0);
-  double *acurr = a;
-  int ncurr = n;
-  while (ncurr > 0)
+  // the extensions are reduced one joint at a time, since the offsets and
+  //   names that their references get depend on the reduction transform of
+  //   each joint. Reduce the links below before the links above them, and
+  //   the children of a link in order, like a recursive walk would.
+  std::vector<urdf::LinkSharedPtr> linkStack;
+  std::vector<urdf::LinkSharedPtr> bottomUp;
+  linkStack.push_back(_link);
+  while (!linkStack.empty())
   {
-    *(acurr++) = 0;
-    --ncurr;
-  }
-}
-
-void dMassSetZero(dMass *m)
-{
-  // dAASSERT (m);
-  m->mass = 0.0;
-  dSetZero(m->c, sizeof(m->c) / sizeof(m->c[0]));
-  dSetZero(m->I, sizeof(m->I) / sizeof(m->I[0]));
-}
-
-void dMassSetParameters(dMass *m, double themass,
-                        double cgx, double cgy, double cgz,
-                        double I11, double I22, double I33,
-                        double I12, double I13, double I23)
-{
-  // dAASSERT (m);
-  dMassSetZero(m);
-  m->mass = themass;
-  m->c[0] = cgx;
-  m->c[1] = cgy;
-  m->c[2] = cgz;
-  m->_I(0, 0) = I11;
-  m->_I(1, 1) = I22;
-  m->_I(2, 2) = I33;
-  m->_I(0, 1) = I12;
-  m->_I(0, 2) = I13;
-  m->_I(1, 2) = I23;
-  m->_I(1, 0) = I12;
-  m->_I(2, 0) = I13;
-  m->_I(2, 1) = I23;
-  // dMassCheck (m);
-}
-
-void dRFromEulerAngles(dMatrix3 R, double phi, double theta, double psi)
-{
-  double sphi, cphi, stheta, ctheta, spsi, cpsi;
-  // dAASSERT (R);
-  sphi = sin(phi);
-  cphi = cos(phi);
-  stheta = sin(theta);
-  ctheta = cos(theta);
-  spsi = sin(psi);
-  cpsi = cos(psi);
-  _R(0, 0) = cpsi*ctheta;
-  _R(0, 1) = spsi*ctheta;
-  _R(0, 2) =-stheta;
-  _R(0, 3) = 0.0;
-  _R(1, 0) = cpsi*stheta*sphi - spsi*cphi;
-  _R(1, 1) = spsi*stheta*sphi + cpsi*cphi;
-  _R(1, 2) = ctheta*sphi;
-  _R(1, 3) = 0.0;
-  _R(2, 0) = cpsi*stheta*cphi + spsi*sphi;
-  _R(2, 1) = spsi*stheta*cphi - cpsi*sphi;
-  _R(2, 2) = ctheta*cphi;
-  _R(2, 3) = 0.0;
-}
-
-double _dCalcVectorDot3(const double *a, const double *b, unsigned step_a,
-                        unsigned step_b)
-{
-  return a[0] * b[0] + a[step_a] * b[step_b] + a[2 * step_a] * b[2 * step_b];
-}
-
-double dCalcVectorDot3(const double *a, const double *b)
-{
-  return _dCalcVectorDot3(a, b, 1, 1);
-}
-
-double dCalcVectorDot3_41(const double *a, const double *b)
-{
-  return _dCalcVectorDot3(a, b, 4, 1);
-}
-
-void dMultiply0_331(double *res, const double *a, const double *b)
-{
-  double res_0, res_1, res_2;
-  res_0 = dCalcVectorDot3(a, b);
-  res_1 = dCalcVectorDot3(a + 4, b);
-  res_2 = dCalcVectorDot3(a + 8, b);
-  res[0] = res_0;
-  res[1] = res_1;
-  res[2] = res_2;
-}
-
-void dMultiply1_331(double *res, const double *a, const double *b)
-{
-  double res_0, res_1, res_2;
-  res_0 = dCalcVectorDot3_41(a, b);
-  res_1 = dCalcVectorDot3_41(a + 1, b);
-  res_2 = dCalcVectorDot3_41(a + 2, b);
-  res[0] = res_0;
-  res[1] = res_1;
-  res[2] = res_2;
-}
-
-void dMultiply0_133(double *res, const double *a, const double *b)
-{
-  dMultiply1_331(res, b, a);
-}
-
-void dMultiply0_333(double *res, const double *a, const double *b)
-{
-  dMultiply0_133(res + 0, a + 0, b);
-  dMultiply0_133(res + 4, a + 4, b);
-  dMultiply0_133(res + 8, a + 8, b);
-}
-
-void dMultiply2_333(double *res, const double *a, const double *b)
-{
-  dMultiply0_331(res + 0, b, a + 0);
-  dMultiply0_331(res + 4, b, a + 4);
-  dMultiply0_331(res + 8, b, a + 8);
-}
-
-void dMassRotate(dMass *m, const dMatrix3 R)
-{
-  // if the body is rotated by `R' relative to its point of reference,
-  // the new inertia about the point of reference is:
-  //
-  //   R * I * R'
-  //
-  // where I is the old inertia.
-
-  dMatrix3 t1;
-  double t2[3];
-
-  // dAASSERT (m);
-
-  // rotate inertia matrix
-  dMultiply2_333(t1, m->I, R);
-  dMultiply0_333(m->I, R, t1);
-
-  // ensure perfect symmetry
-  m->_I(1, 0) = m->_I(0, 1);
-  m->_I(2, 0) = m->_I(0, 2);
-  m->_I(2, 1) = m->_I(1, 2);
-
-  // rotate center of mass
-  dMultiply0_331(t2, R, m->c);
-  m->c[0] = t2[0];
-  m->c[1] = t2[1];
-  m->c[2] = t2[2];
-}
-
-void dSetCrossMatrixPlus(double *res, const double *a, unsigned skip)
-{
-  const double a_0 = a[0], a_1 = a[1], a_2 = a[2];
-  res[1] = -a_2;
-  res[2] = +a_1;
-  res[skip+0] = +a_2;
-  res[skip+2] = -a_0;
-  res[2*skip+0] = -a_1;
-  res[2*skip+1] = +a_0;
-}
-
-void dMassTranslate(dMass *m, double x, double y, double z)
-{
-  // if the body is translated by `a' relative to its point of reference,
-  // the new inertia about the point of reference is:
-  //
-  //   I + mass*(crossmat(c)^2 - crossmat(c+a)^2)
-  //
-  // where c is the existing center of mass and I is the old inertia.
-
-  int i, j;
-  dMatrix3 ahat, chat, t1, t2;
-  double a[3];
-
-  // dAASSERT (m);
-
-  // adjust inertia matrix
-  dSetZero(chat, 12);
-  dSetCrossMatrixPlus(chat, m->c, 4);
-  a[0] = x + m->c[0];
-  a[1] = y + m->c[1];
-  a[2] = z + m->c[2];
-  dSetZero(ahat, 12);
-  dSetCrossMatrixPlus(ahat, a, 4);
-  dMultiply0_333(t1, ahat, ahat);
-  dMultiply0_333(t2, chat, chat);
-  for (i = 0; i < 3; i++)
-  {
-    for (j = 0; j < 3; j++)
+    urdf::LinkSharedPtr link = linkStack.back();
+    linkStack.pop_back();
+    if (shouldBeReduced(link))
     {
-      m->_I(i, j) += m->mass * (t2[i*4+j]-t1[i*4+j]);
+      bottomUp.push_back(link);
+    }
+    for (const urdf::LinkSharedPtr &child : link->child_links)
+    {
+      linkStack.push_back(child);
     }
   }
-
-  // ensure perfect symmetry
-  m->_I(1, 0) = m->_I(0, 1);
-  m->_I(2, 0) = m->_I(0, 2);
-  m->_I(2, 1) = m->_I(1, 2);
-
-  // adjust center of mass
-  m->c[0] += x;
-  m->c[1] += y;
-  m->c[2] += z;
-}
-
-void dMassAdd(dMass *a, const dMass *b)
-{
-  int i;
-  double denom = dRecip(a->mass + b->mass);
-  for (i = 0; i < 3; i++)
-  {
-    a->c[i] = (a->c[i]*a->mass + b->c[i]*b->mass)*denom;
-  }
-  a->mass += b->mass;
-  for (i = 0; i < 12; i++)
+  for (auto link = bottomUp.rbegin(); link != bottomUp.rend(); ++link)
   {
-    a->I[i] += b->I[i];
-  }
-}
+    sdfdbg << "Fixed Joint Reduction: extension lumping from ["
+           << (*link)->name << "] to [" << (*link)->getParent()->name
+           << "]\n";
 
-/////////////////////////////////////////////////
-/// print mass for link for debugging
-void PrintMass(const std::string &_linkName, const dMass &_mass)
-{
-  sdfdbg << "LINK NAME: [" << _linkName << "] from dMass\n";
-  sdfdbg << "     MASS: [" << _mass.mass << "]\n";
-  sdfdbg << "       CG: [" << _mass.c[0] << ", " << _mass.c[1] << ", "
-         << _mass.c[2] << "]\n";
-  sdfdbg << "        I: [" << _mass.I[0] << ", " << _mass.I[1] << ", "
-         << _mass.I[2] << "]\n";
-  sdfdbg << "           [" << _mass.I[4] << ", " << _mass.I[5] << ", "
-         << _mass.I[6] << "]\n";
-  sdfdbg << "           [" << _mass.I[8] << ", " << _mass.I[9] << ", "
-         << _mass.I[10] << "]\n";
+    // lump sdf extensions to parent, (give them new reference link names)
+    ReduceSDFExtensionToParent(*link);
+  }
 }
 
 /////////////////////////////////////////////////
 /// print mass for link for debugging
 void PrintMass(const urdf::LinkSharedPtr _link)
 {
-  sdfdbg << "LINK NAME: [" << _link->name << "] from dMass\n";
+  sdfdbg << "LINK NAME: [" << _link->name << "] inertial\n";
   sdfdbg << "     MASS: [" << _link->inertial->mass << "]\n";
   sdfdbg << "       CG: [" << _link->inertial->origin.position.x << ", "
          << _link->inertial->origin.position.y << ", "
@@ -760,165 +730,111 @@ void PrintMass(const urdf::LinkSharedPtr _link)
 }
 
 /////////////////////////////////////////////////
-/// reduce fixed joints:  lump inertial to parent link
-void ReduceInertialToParent(urdf::LinkSharedPtr _link)
-{
-  // now lump all contents of this _link to parent
-  if (_link->inertial)
-  {
-    dMatrix3 R;
-    double phi, theta, psi;
-
-    // get parent mass (in parent link cg frame)
-    dMass parentMass;
-
-    if (!_link->getParent()->inertial)
-    {
-      _link->getParent()->inertial.reset(new urdf::Inertial);
-    }
-
-    dMassSetParameters(&parentMass, _link->getParent()->inertial->mass,
-                       0, 0, 0,
-                       _link->getParent()->inertial->ixx,
-                       _link->getParent()->inertial->iyy,
-                       _link->getParent()->inertial->izz,
-                       _link->getParent()->inertial->ixy,
-                       _link->getParent()->inertial->ixz,
-                       _link->getParent()->inertial->iyz);
-
-    // transform parent inertia to parent link origin
-    _link->getParent()->inertial->origin.rotation.getRPY(phi, theta, psi);
-    dRFromEulerAngles(R, -phi,      0,    0);
-    dMassRotate(&parentMass, R);
-    dRFromEulerAngles(R,    0, -theta,    0);
-    dMassRotate(&parentMass, R);
-    dRFromEulerAngles(R,    0,      0, -psi);
-    dMassRotate(&parentMass, R);
-
-    // un-translate link mass from cg(inertial frame) into link frame
-    dMassTranslate(&parentMass,
-                   _link->getParent()->inertial->origin.position.x,
-                   _link->getParent()->inertial->origin.position.y,
-                   _link->getParent()->inertial->origin.position.z);
-
-    PrintMass("parent: " + _link->getParent()->name, parentMass);
-    // PrintMass(_link->getParent());
-
-    //////////////////////////////////////////////
-    //                                          //
-    // create a_link mass (in _link's cg frame) //
-    //                                          //
-    //////////////////////////////////////////////
-    dMass linkMass;
-    dMassSetParameters(&linkMass, _link->inertial->mass,
-                       0, 0, 0,
-                       _link->inertial->ixx,
-                       _link->inertial->iyy,
-                       _link->inertial->izz,
-                       _link->inertial->ixy,
-                       _link->inertial->ixz,
-                       _link->inertial->iyz);
-
-    PrintMass("link : " + _link->name, linkMass);
-
-    ////////////////////////////////////////////
-    //                                        //
-    // from cg (inertial frame) to link frame //
-    //                                        //
-    ////////////////////////////////////////////
-
-    // Un-rotate _link mass from cg(inertial frame) into link frame
-    _link->inertial->origin.rotation.getRPY(phi, theta, psi);
-    dRFromEulerAngles(R, -phi,      0,    0);
-    dMassRotate(&linkMass, R);
-    dRFromEulerAngles(R,    0, -theta,    0);
-    dMassRotate(&linkMass, R);
-    dRFromEulerAngles(R,    0,      0, -psi);
-    dMassRotate(&linkMass, R);
-
-    // un-translate link mass from cg(inertial frame) into link frame
-    dMassTranslate(&linkMass,
-                   _link->inertial->origin.position.x,
-                   _link->inertial->origin.position.y,
-                   _link->inertial->origin.position.z);
-
-    ////////////////////////////////////////////
-    //                                        //
-    // from link frame to parent link frame   //
-    //                                        //
-    ////////////////////////////////////////////
-
-    // un-rotate _link mass into parent link frame
-    _link->parent_joint->parent_to_joint_origin_transform.rotation.getRPY(
-        phi, theta, psi);
-    dRFromEulerAngles(R, -phi,      0,    0);
-    dMassRotate(&linkMass, R);
-    dRFromEulerAngles(R,    0, -theta,    0);
-    dMassRotate(&linkMass, R);
-    dRFromEulerAngles(R,    0,      0, -psi);
-    dMassRotate(&linkMass, R);
-
-    // un-translate _link mass into parent link frame
-    dMassTranslate(&linkMass,
-        _link->parent_joint->parent_to_joint_origin_transform.position.x,
-        _link->parent_joint->parent_to_joint_origin_transform.position.y,
-        _link->parent_joint->parent_to_joint_origin_transform.position.z);
-
-    PrintMass("link in parent link: " + _link->name, linkMass);
+/// get the inertial of a urdf link as ignition inertial in the link frame
+ignition::math::Inertiald CopyInertial(const urdf::Inertial &_inertial)
+{
+  return ignition::math::Inertiald(
+      ignition::math::MassMatrix3d(_inertial.mass,
+        ignition::math::Vector3d(_inertial.ixx, _inertial.iyy, _inertial.izz),
+        ignition::math::Vector3d(_inertial.ixy, _inertial.ixz,
+                                 _inertial.iyz)),
+      CopyPose(_inertial.origin));
+}
 
-    //
-    // now linkMass is in the parent frame, add linkMass to parentMass
-    // new parentMass should be combined inertia,
-    // centered at parent link inertial frame.
-    //
+/////////////////////////////////////////////////
+/// reduce fixed joints:  lump inertials to the link that keeps them
+void ReduceInertialsToLink(urdf::LinkSharedPtr _link)
+{
+  if (_link->name == "world")
+  {
+    return;
+  }
 
-    dMassAdd(&parentMass, &linkMass);
+  // walk the links reduced into _link, with their link frame in _link frame
+  std::vector<std::pair<urdf::LinkSharedPtr, ignition::math::Pose3d>> stack;
+  auto pushReducedChildren = [&stack](urdf::LinkSharedPtr _parent,
+                                      const ignition::math::Pose3d &_pose)
+  {
+    for (const urdf::LinkSharedPtr &child : _parent->child_links)
+    {
+      if (child->parent_joint && FixedJointShouldBeReduced(child->parent_joint))
+      {
+        stack.push_back(std::make_pair(child, TransformToParentFrame(
+            CopyPose(child->parent_joint->parent_to_joint_origin_transform),
+            _pose)));
+      }
+    }
+  };
+  pushReducedChildren(_link, ignition::math::Pose3d::Zero);
 
-    PrintMass("combined: " + _link->getParent()->name, parentMass);
+  // sum up the link inertials, moved to the _link frame
+  ignition::math::Inertiald lumped;
+  bool found = false;
+  while (!stack.empty())
+  {
+    urdf::LinkSharedPtr link = stack.back().first;
+    ignition::math::Pose3d linkPose = stack.back().second;
+    stack.pop_back();
 
-    //
-    // Set new combined inertia in parent link frame into parent link urdf
-    //
+    if (link->inertial)
+    {
+      ignition::math::Inertiald inertial = CopyInertial(*link->inertial);
+      inertial.SetPose(TransformToParentFrame(inertial.Pose(), linkPose));
+      PrintMass(link);
+      lumped += inertial;
+      found = true;
+    }
+    pushReducedChildren(link, linkPose);
+  }
 
-    // save combined mass
-    _link->getParent()->inertial->mass = parentMass.mass;
+  if (!found)
+  {
+    return;
+  }
 
-    // save CoG location
-    _link->getParent()->inertial->origin.position.x  = parentMass.c[0];
-    _link->getParent()->inertial->origin.position.y  = parentMass.c[1];
-    _link->getParent()->inertial->origin.position.z  = parentMass.c[2];
+  if (!_link->inertial)
+  {
+    _link->inertial.reset(new urdf::Inertial);
+  }
 
-    // get MOI at new CoG location
-    dMassTranslate(&parentMass,
-                   -_link->getParent()->inertial->origin.position.x,
-                   -_link->getParent()->inertial->origin.position.y,
-                   -_link->getParent()->inertial->origin.position.z);
+  // combine with the inertial of _link, and express the moments in the frame
+  // of its existing inertial origin, whose rotation is kept
+  ignition::math::Inertiald combined = CopyInertial(*_link->inertial);
+  combined += lumped;
+  combined.SetInertialRotation(CopyPose(_link->inertial->origin).Rot());
 
-    // rotate MOI at new CoG location
-    _link->getParent()->inertial->origin.rotation.getRPY(phi, theta, psi);
-    dRFromEulerAngles(R, phi, theta, psi);
-    dMassRotate(&parentMass, R);
+  // save combined mass and CoG location
+  _link->inertial->mass = combined.MassMatrix().Mass();
+  _link->inertial->origin.position.x = combined.Pose().Pos().X();
+  _link->inertial->origin.position.y = combined.Pose().Pos().Y();
+  _link->inertial->origin.position.z = combined.Pose().Pos().Z();
 
-    // save new combined MOI
-    _link->getParent()->inertial->ixx  = parentMass.I[0+4*0];
-    _link->getParent()->inertial->iyy  = parentMass.I[1+4*1];
-    _link->getParent()->inertial->izz  = parentMass.I[2+4*2];
-    _link->getParent()->inertial->ixy  = parentMass.I[0+4*1];
-    _link->getParent()->inertial->ixz  = parentMass.I[0+4*2];
-    _link->getParent()->inertial->iyz  = parentMass.I[1+4*2];
+  // save new combined MOI
+  const ignition::math::Vector3d diag = combined.MassMatrix().DiagonalMoments();
+  const ignition::math::Vector3d offDiag =
+    combined.MassMatrix().OffDiagonalMoments();
+  _link->inertial->ixx = diag.X();
+  _link->inertial->iyy = diag.Y();
+  _link->inertial->izz = diag.Z();
+  _link->inertial->ixy = offDiag.X();
+  _link->inertial->ixz = offDiag.Y();
+  _link->inertial->iyz = offDiag.Z();
 
-    // final urdf inertia check
-    PrintMass(_link->getParent());
-  }
+  // final urdf inertia check
+  PrintMass(_link);
 }
 
 /////////////////////////////////////////////////
-/// \brief reduce fixed joints:  lump visuals to parent link
+/// \brief reduce fixed joints:  lump visuals to the kept link
 /// \param[in] _link take all visuals from _link and lump/move them
-///            to the parent link (_link->getParentLink()).
-void ReduceVisualsToParent(urdf::LinkSharedPtr _link)
-{
-  // lump all visuals of _link to _link->getParent().
+///            to _keptLink.
+/// \param[in] _keptLink link that _link is lumped into.
+/// \param[in] _pose pose of _link in the frame of _keptLink.
+void ReduceVisualsToLink(urdf::LinkSharedPtr _link,
+                         urdf::LinkSharedPtr _keptLink,
+                         const ignition::math::Pose3d &_pose)
+{
+  // lump all visuals of _link to _keptLink.
   // modify visual name (urdf 0.3.x) or
   //        visual group name (urdf 0.2.x)
   // to indicate that it was lumped (fixed joint reduced)
@@ -941,7 +857,7 @@ void ReduceVisualsToParent(urdf::LinkSharedPtr _link)
       newVisualName = (*visualIt)->name;
       sdfdbg << "re-lumping visual [" << (*visualIt)->name
              << "] for link [" << _link->name
-             << "] to parent [" << _link->getParent()->name
+             << "] to link [" << _keptLink->name
              << "] with name [" << newVisualName << "]\n";
     }
     else
@@ -956,29 +872,31 @@ void ReduceVisualsToParent(urdf::LinkSharedPtr _link)
       }
       sdfdbg << "lumping visual [" << (*visualIt)->name
              << "] for link [" << _link->name
-             << "] to parent [" << _link->getParent()->name
+             << "] to link [" << _keptLink->name
              << "] with name [" << newVisualName << "]\n";
     }
 
     // transform visual origin from _link frame to
-    // parent link frame before adding to parent
-    (*visualIt)->origin = TransformToParentFrame(
-        (*visualIt)->origin,
-        _link->parent_joint->parent_to_joint_origin_transform);
+    // kept link frame before adding to kept link
+    (*visualIt)->origin = TransformToParentFrame((*visualIt)->origin,
+        CopyPose(_pose));
 
-    // add the modified visual to parent
-    ReduceVisualToParent(_link->getParent(), newVisualName,
-                         *visualIt);
+    // add the modified visual to kept link
+    ReduceVisualToParent(_keptLink, newVisualName, *visualIt);
   }
 }
 
 /////////////////////////////////////////////////
-/// \brief reduce fixed joints:  lump collisions to parent link
+/// \brief reduce fixed joints:  lump collisions to the kept link
 /// \param[in] _link take all collisions from _link and lump/move them
-///            to the parent link (_link->getParentLink()).
-void ReduceCollisionsToParent(urdf::LinkSharedPtr _link)
-{
-  // lump all collisions of _link to _link->getParent().
+///            to _keptLink.
+/// \param[in] _keptLink link that _link is lumped into.
+/// \param[in] _pose pose of _link in the frame of _keptLink.
+void ReduceCollisionsToLink(urdf::LinkSharedPtr _link,
+                            urdf::LinkSharedPtr _keptLink,
+                            const ignition::math::Pose3d &_pose)
+{
+  // lump all collisions of _link to _keptLink.
   // modify collision name (urdf 0.3.x) or
   //        collision group name (urdf 0.2.x)
   // to indicate that it was lumped (fixed joint reduced)
@@ -1000,7 +918,7 @@ void ReduceCollisionsToParent(urdf::LinkSharedPtr _link)
       newCollisionName = (*collisionIt)->name;
       sdfdbg << "re-lumping collision [" << (*collisionIt)->name
              << "] for link [" << _link->name
-             << "] to parent [" << _link->getParent()->name
+             << "] to link [" << _keptLink->name
              << "] with name [" << newCollisionName << "]\n";
     }
     else
@@ -1015,52 +933,42 @@ void ReduceCollisionsToParent(urdf::LinkSharedPtr _link)
       }
       sdfdbg << "lumping collision [" << (*collisionIt)->name
              << "] for link [" << _link->name
-             << "] to parent [" << _link->getParent()->name
+             << "] to link [" << _keptLink->name
              << "] with name [" << newCollisionName << "]\n";
     }
     // transform collision origin from _link frame to
-    // parent link frame before adding to parent
-    (*collisionIt)->origin = TransformToParentFrame(
-        (*collisionIt)->origin,
-        _link->parent_joint->parent_to_joint_origin_transform);
+    // kept link frame before adding to kept link
+    (*collisionIt)->origin = TransformToParentFrame((*collisionIt)->origin,
+        CopyPose(_pose));
 
-    // add the modified collision to parent
-    ReduceCollisionToParent(_link->getParent(), newCollisionName,
-                            *collisionIt);
+    // add the modified collision to kept link
+    ReduceCollisionToParent(_keptLink, newCollisionName, *collisionIt);
   }
 }
 
 /////////////////////////////////////////////////
-/// reduce fixed joints:  lump joints to parent link
-void ReduceJointsToParent(urdf::LinkSharedPtr _link)
-{
-  // set child link's parentJoint's parent link to
-  // a parent link up stream that does not have a fixed parentJoint
+/// reduce fixed joints:  move the joints of the children of a reduced link
+///   to the link that keeps it
+void ReduceJointsToLink(urdf::LinkSharedPtr _link,
+                        urdf::LinkSharedPtr _keptLink,
+                        const ignition::math::Pose3d &_pose)
+{
+  // set child link's parentJoint's parent link to the kept link up stream,
+  // which does not have a fixed parentJoint
   for (unsigned int i = 0 ; i < _link->child_links.size() ; ++i)
   {
     urdf::JointSharedPtr parentJoint = _link->child_links[i]->parent_joint;
     if (!FixedJointShouldBeReduced(parentJoint))
     {
-      // go down the tree until we hit a parent joint that is not fixed
-      urdf::LinkSharedPtr newParentLink = _link;
-      ignition::math::Pose3d jointAnchorTransform;
-      while (newParentLink->parent_joint &&
-             newParentLink->getParent()->name != "world" &&
-             FixedJointShouldBeReduced(newParentLink->parent_joint) )
-      {
-        jointAnchorTransform = jointAnchorTransform * jointAnchorTransform;
-        parentJoint->parent_to_joint_origin_transform =
+      // move the joint origin to the kept link frame
+      parentJoint->parent_to_joint_origin_transform = CopyPose(
           TransformToParentFrame(
-              parentJoint->parent_to_joint_origin_transform,
-              newParentLink->parent_joint->parent_to_joint_origin_transform);
-        newParentLink = newParentLink->getParent();
-      }
+            CopyPose(parentJoint->parent_to_joint_origin_transform), _pose));
+
       // now set the _link->child_links[i]->parent_joint's parent link to
-      // the newParentLink
-      _link->child_links[i]->setParent(newParentLink);
-      parentJoint->parent_link_name = newParentLink->name;
-      // and set the _link->child_links[i]->parent_joint's
-      // parent_to_joint_origin_transform as the aggregated anchor transform?
+      // the kept link
+      _link->child_links[i]->setParent(_keptLink);
+      parentJoint->parent_link_name = _keptLink->name;
     }
   }
 }
@@ -1079,17 +987,8 @@ std::string lowerStr(const std::string &_str)
 
 ////////////////////////////////////////////////////////////////////////////////
 URDF2SDF::URDF2SDF()
+  : dataPtr(new URDF2SDFPrivate)
 {
-  // default options
-  g_enforceLimits = true;
-  g_reduceFixedJoints = true;
-  g_extensions.clear();
-  g_collisionExt = "_collision";
-  g_visualExt = "_visual";
-  g_lumpPrefix = "_fixed_joint_lump__";
-  g_initialRobotPoseValid = false;
-  g_fixedJointsTransformedInRevoluteJoints.clear();
-  g_fixedJointsTransformedInFixedJoints.clear();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1102,6 +1001,21 @@ URDF2SDF::~URDF2SDF()
 ////////////////////////////////////////////////////////////////////////////////
 std::string Values2str(unsigned int _count, const double *_values)
 {
+  std::string str;
+  str.reserve(_count * 8);
+  bool formatted = true;
+  for (unsigned int i = 0; formatted && i < _count; ++i)
+  {
+    if (i > 0)
+      str += ' ';
+    if (std::fpclassify(_values[i]) == FP_ZERO)
+      str += '0';
+    else
+      formatted = AppendStreamNumber(str, _values[i], g_outputDecimalPrecision);
+  }
+  if (formatted)
+    return str;
+
   std::stringstream ss;
   ss.precision(g_outputDecimalPrecision);
   for (unsigned int i = 0 ; i < _count ; ++i)
@@ -1121,16 +1035,16 @@ std::string Values2str(unsigned int _count, const double *_values)
 /////////////////////////////////////////////////
 std::string Values2str(unsigned int _count, const int *_values)
 {
-  std::stringstream ss;
+  std::string str;
   for (unsigned int i = 0 ; i < _count ; ++i)
   {
     if (i > 0)
     {
-      ss << " ";
+      str += ' ';
     }
-    ss << _values[i];
+    AppendStreamNumber(str, _values[i]);
   }
-  return ss.str();
+  return str;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1209,11 +1123,11 @@ void ParseRobotOrigin(tinyxml2::XMLDocument &_urdfXml)
     const char *xyzstr = originXml->Attribute("xyz");
     if (xyzstr == nullptr)
     {
-      g_initialRobotPose.position = urdf::Vector3(0, 0, 0);
+      g_state->initialRobotPose.position = urdf::Vector3(0, 0, 0);
     }
     else
     {
-      g_initialRobotPose.position = ParseVector3(std::string(xyzstr));
+      g_state->initialRobotPose.position = ParseVector3(std::string(xyzstr));
     }
     const char *rpystr = originXml->Attribute("rpy");
     urdf::Vector3 rpy;
@@ -1225,22 +1139,22 @@ void ParseRobotOrigin(tinyxml2::XMLDocument &_urdfXml)
     {
       rpy = ParseVector3(std::string(rpystr));
     }
-    g_initialRobotPose.rotation.setFromRPY(rpy.x, rpy.y, rpy.z);
-    g_initialRobotPoseValid = true;
+    g_state->initialRobotPose.rotation.setFromRPY(rpy.x, rpy.y, rpy.z);
+    g_state->initialRobotPoseValid = true;
   }
 }
 
 /////////////////////////////////////////////////
 void InsertRobotOrigin(tinyxml2::XMLElement *_elem)
 {
-  if (g_initialRobotPoseValid)
+  if (g_state->initialRobotPoseValid)
   {
     // set transform
     double pose[6];
-    pose[0] = g_initialRobotPose.position.x;
-    pose[1] = g_initialRobotPose.position.y;
-    pose[2] = g_initialRobotPose.position.z;
-    g_initialRobotPose.rotation.getRPY(pose[3], pose[4], pose[5]);
+    pose[0] = g_state->initialRobotPose.position.x;
+    pose[1] = g_state->initialRobotPose.position.y;
+    pose[2] = g_state->initialRobotPose.position.z;
+    g_state->initialRobotPose.rotation.getRPY(pose[3], pose[4], pose[5]);
     AddKeyValue(_elem, "pose", Values2str(6, pose));
   }
 }
@@ -1251,7 +1165,7 @@ void URDF2SDF::ParseSDFExtension(tinyxml2::XMLDocument &_urdfXml)
   tinyxml2::XMLElement* robotXml = _urdfXml.FirstChildElement("robot");
 
   // Get all SDF extension elements, put everything in
-  //   g_extensions map, containing a key string
+  //   g_state->extensions map, containing a key string
   //   (link/joint name) and values
   for (tinyxml2::XMLElement* sdfXml = robotXml->FirstChildElement("gazebo");
        sdfXml; sdfXml = sdfXml->NextSiblingElement("gazebo"))
@@ -1269,11 +1183,11 @@ void URDF2SDF::ParseSDFExtension(tinyxml2::XMLDocument &_urdfXml)
       refStr = std::string(ref);
     }
 
-    if (g_extensions.find(refStr) == g_extensions.end())
+    if (g_state->extensions.find(refStr) == g_state->extensions.end())
     {
       // create extension map for reference
       std::vector<SDFExtensionPtr> ge;
-      g_extensions.insert(std::make_pair(refStr, ge));
+      g_state->extensions.insert(std::make_pair(refStr, ge));
     }
 
     // create and insert a new SDFExtension into the map
@@ -1322,11 +1236,8 @@ void URDF2SDF::ParseSDFExtension(tinyxml2::XMLDocument &_urdfXml)
         for (tinyxml2::XMLElement* e = childElem->FirstChildElement(); e;
              e = e->NextSiblingElement())
         {
-          tinyxml2::XMLPrinter printer;
-          e->Accept(&printer);
-
           XMLDocumentPtr xmlDocBlob(new tinyxml2::XMLDocument);
-          xmlDocBlob->Parse(printer.CStr());
+          CopyBlob(e, xmlDocBlob.get());
 
           // save all unknown stuff in a vector of blobs
           if (strcmp(childElem->Name(), "collision") == 0)
@@ -1508,7 +1419,7 @@ void URDF2SDF::ParseSDFExtension(tinyxml2::XMLDocument &_urdfXml)
         if (lowerStr(valueStr) == "true" || lowerStr(valueStr) == "yes" ||
             valueStr == "1")
         {
-          g_fixedJointsTransformedInRevoluteJoints.insert(refStr);
+          g_state->fixedJointsTransformedInRevoluteJoints.insert(refStr);
         }
       }
       else if (strcmp(childElem->Name(), "preserveFixedJoint") == 0)
@@ -1518,18 +1429,16 @@ void URDF2SDF::ParseSDFExtension(tinyxml2::XMLDocument &_urdfXml)
         if (lowerStr(valueStr) == "true" || lowerStr(valueStr) == "yes" ||
             valueStr == "1")
         {
-          g_fixedJointsTransformedInFixedJoints.insert(refStr);
+          g_state->fixedJointsTransformedInFixedJoints.insert(refStr);
         }
       }
       else
       {
         // a place to store converted doc
         XMLDocumentPtr xmlNewDoc(new tinyxml2::XMLDocument);
-        tinyxml2::XMLPrinter printer;
-        childElem->Accept(&printer);
-        xmlNewDoc->Parse(printer.CStr());
+        CopyBlob(childElem, xmlNewDoc.get());
 
-        sdfdbg << "extension [" << printer.CStr() <<
+        sdfdbg << "extension [" << childElem->Name() <<
           "] not converted from URDF, probably already in SDF format.\n";
 
         // save all unknown stuff in a vector of blobs
@@ -1538,23 +1447,38 @@ void URDF2SDF::ParseSDFExtension(tinyxml2::XMLDocument &_urdfXml)
     }
 
     // insert into my map
-    (g_extensions.find(refStr))->second.push_back(sdf);
+    (g_state->extensions.find(refStr))->second.push_back(sdf);
   }
 
   // Handle fixed joints for which both disableFixedJointLumping
   // and preserveFixedJoint options are present
   for (auto& fixedJointConvertedToFixed:
-             g_fixedJointsTransformedInFixedJoints)
+             g_state->fixedJointsTransformedInFixedJoints)
   {
     // If both options are present, the model creator is aware of the
     // existence of the preserveFixedJoint option and the
     // disableFixedJointLumping option is there only for backward compatibility
     // For this reason, if both options are present then the preserveFixedJoint
     // option has the precedence
-    g_fixedJointsTransformedInRevoluteJoints.erase(fixedJointConvertedToFixed);
+    g_state->fixedJointsTransformedInRevoluteJoints.erase(
+        fixedJointConvertedToFixed);
   }
 }
 
+void CopyBlob(const tinyxml2::XMLElement *_src, tinyxml2::XMLDocument *_doc)
+{
+  tinyxml2::XMLNode *clone = DeepClone(_doc, _src);
+  if (clone == nullptr)
+  {
+    sdferr << "Unable to deep copy blob\n";
+  }
+  else
+  {
+    _doc->LinkEndChild(clone);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
 void CopyBlob(tinyxml2::XMLElement *_src, tinyxml2::XMLElement *_blob_parent)
 {
   if (_blob_parent == nullptr)
@@ -1584,13 +1508,13 @@ void InsertSDFExtensionCollision(tinyxml2::XMLElement *_elem,
   //   - urdf collision name -> sdf collision name conversion
   //   - fixed joint reduction / lumping
   for (StringSDFExtensionPtrMap::iterator
-      sdfIt = g_extensions.begin();
-      sdfIt != g_extensions.end(); ++sdfIt)
+      sdfIt = g_state->extensions.begin();
+      sdfIt != g_state->extensions.end(); ++sdfIt)
   {
     if (sdfIt->first == _linkName)
     {
       // std::cerr << "============================\n";
-      // std::cerr << "working on g_extensions for link ["
+      // std::cerr << "working on g_state->extensions for link ["
       //           << sdfIt->first << "]\n";
       // if _elem already has a surface element, use it
       tinyxml2::XMLNode *surface = _elem->FirstChildElement("surface");
@@ -1894,13 +1818,13 @@ void InsertSDFExtensionVisual(tinyxml2::XMLElement *_elem,
   //   - urdf visual name -> sdf visual name conversion
   //   - fixed joint reduction / lumping
   for (StringSDFExtensionPtrMap::iterator
-      sdfIt = g_extensions.begin();
-      sdfIt != g_extensions.end(); ++sdfIt)
+      sdfIt = g_state->extensions.begin();
+      sdfIt != g_state->extensions.end(); ++sdfIt)
   {
     if (sdfIt->first == _linkName)
     {
       // std::cerr << "============================\n";
-      // std::cerr << "working on g_extensions for link ["
+      // std::cerr << "working on g_state->extensions for link ["
       //           << sdfIt->first << "]\n";
       // if _elem already has a material element, use it
       tinyxml2::XMLElement *material = _elem->FirstChildElement("material");
@@ -2083,8 +2007,8 @@ void InsertSDFExtensionLink(tinyxml2::XMLElement *_elem,
                             const std::string &_linkName)
 {
   for (StringSDFExtensionPtrMap::iterator
-       sdfIt = g_extensions.begin();
-       sdfIt != g_extensions.end(); ++sdfIt)
+       sdfIt = g_state->extensions.begin();
+       sdfIt != g_state->extensions.end(); ++sdfIt)
   {
     if (sdfIt->first == _linkName)
     {
@@ -2138,8 +2062,8 @@ void InsertSDFExtensionJoint(tinyxml2::XMLElement *_elem,
 {
   auto* doc = _elem->GetDocument();
   for (StringSDFExtensionPtrMap::iterator
-      sdfIt = g_extensions.begin();
-      sdfIt != g_extensions.end(); ++sdfIt)
+      sdfIt = g_state->extensions.begin();
+      sdfIt != g_state->extensions.end(); ++sdfIt)
   {
     if (sdfIt->first == _jointName)
     {
@@ -2283,8 +2207,8 @@ void InsertSDFExtensionJoint(tinyxml2::XMLElement *_elem,
 void InsertSDFExtensionRobot(tinyxml2::XMLElement *_elem)
 {
   for (StringSDFExtensionPtrMap::iterator
-      sdfIt = g_extensions.begin();
-      sdfIt != g_extensions.end(); ++sdfIt)
+      sdfIt = g_state->extensions.begin();
+      sdfIt != g_state->extensions.end(); ++sdfIt)
   {
     if (sdfIt->first.empty())
     {
@@ -2502,8 +2426,8 @@ void ReduceSDFExtensionToParent(urdf::LinkSharedPtr _link)
 
   // update extension map with references to linkName
   // this->ListSDFExtensions();
-  StringSDFExtensionPtrMap::iterator ext = g_extensions.find(linkName);
-  if (ext != g_extensions.end())
+  StringSDFExtensionPtrMap::iterator ext = g_state->extensions.find(linkName);
+  if (ext != g_state->extensions.end())
   {
     sdfdbg << "  REDUCE EXTENSION: moving reference from ["
            << linkName << "] to [" << _link->getParent()->name << "]\n";
@@ -2523,14 +2447,14 @@ void ReduceSDFExtensionToParent(urdf::LinkSharedPtr _link)
     // find pointer to the existing extension with the new _link reference
     std::string parentLinkName = _link->getParent()->name;
     StringSDFExtensionPtrMap::iterator parentExt =
-      g_extensions.find(parentLinkName);
+      g_state->extensions.find(parentLinkName);
 
     // if none exist, create new extension with parentLinkName
-    if (parentExt == g_extensions.end())
+    if (parentExt == g_state->extensions.end())
     {
       std::vector<SDFExtensionPtr> ge;
-      g_extensions.insert(std::make_pair(parentLinkName, ge));
-      parentExt = g_extensions.find(parentLinkName);
+      g_state->extensions.insert(std::make_pair(parentLinkName, ge));
+      parentExt = g_state->extensions.find(parentLinkName);
     }
 
     // move sdf extensions from _link into the parent _link's extensions
@@ -2544,15 +2468,42 @@ void ReduceSDFExtensionToParent(urdf::LinkSharedPtr _link)
 
   // for extensions with empty reference, search and replace
   // _link name patterns within the plugin with new _link name
-  // and assign the proper reduction transform for the _link name pattern
-  for (StringSDFExtensionPtrMap::iterator sdfIt = g_extensions.begin();
-       sdfIt != g_extensions.end(); ++sdfIt)
+  // and assign the proper reduction transform for the _link name pattern.
+  // Only the blobs that refer to _link are visited.
+  StringSDFExtensionBlobRefMap::iterator refs =
+    g_state->extensionFrameRefs.find(linkName);
+  if (refs != g_state->extensionFrameRefs.end())
   {
-    // update reduction transform (for contacts, rays, cameras for now).
-    for (std::vector<SDFExtensionPtr>::iterator ge = sdfIt->second.begin();
-         ge != sdfIt->second.end(); ++ge)
+    // _link is reduced only once, so its references are not needed again
+    std::vector<SDFExtensionBlobRef> blobRefs;
+    blobRefs.swap(refs->second);
+    g_state->extensionFrameRefs.erase(refs);
+
+    std::string parentLinkName = _link->getParent()->name;
+    for (const SDFExtensionBlobRef &ref : blobRefs)
     {
-      ReduceSDFExtensionFrameReplace(*ge, _link);
+      // update reduction transform (for contacts, rays, cameras for now).
+      auto blobIt = ref.ext->blobs.begin() + ref.blob;
+      ReduceSDFExtensionFrameReplace(ref.ext, blobIt, _link);
+
+      // the references to _link now name the parent link
+      std::vector<std::string> names = SDFExtensionFrameRefs(*blobIt);
+      if (std::find(names.begin(), names.end(), parentLinkName) ==
+          names.end())
+      {
+        continue;
+      }
+      std::vector<SDFExtensionBlobRef> &parentRefs =
+        g_state->extensionFrameRefs[parentLinkName];
+      auto known = std::find_if(parentRefs.begin(), parentRefs.end(),
+          [&ref](const SDFExtensionBlobRef &_r)
+          {
+            return _r.ext == ref.ext && _r.blob == ref.blob;
+          });
+      if (known == parentRefs.end())
+      {
+        parentRefs.push_back(ref);
+      }
     }
   }
 
@@ -2561,11 +2512,15 @@ void ReduceSDFExtensionToParent(urdf::LinkSharedPtr _link)
 
 ////////////////////////////////////////////////////////////////////////////////
 void ReduceSDFExtensionFrameReplace(SDFExtensionPtr _ge,
-                                    urdf::LinkSharedPtr _link)
+    std::vector<XMLDocumentPtr>::iterator _blobIt,
+    urdf::LinkSharedPtr _link)
 {
   std::string linkName = _link->name;
   std::string parentLinkName = _link->getParent()->name;
 
+  // The blob is shared by the copies of _ge, which keep their names.
+  SDFExtension::MutableBlob(*_blobIt);
+
   // HACK: need to do this more generally, but we also need to replace
   //       all instances of _link name with new link name
   //       e.g. contact sensor refers to
@@ -2574,25 +2529,125 @@ void ReduceSDFExtensionFrameReplace(SDFExtensionPtr _ge,
   //         <collision>base_footprint_collision</collision>
   sdfdbg << "  STRING REPLACE: instances of _link name ["
         << linkName << "] with [" << parentLinkName << "]\n";
-  for (auto blobIt = _ge->blobs.begin();
-         blobIt != _ge->blobs.end(); ++blobIt)
+  if (sdf::Console::Enabled(4))
   {
+    // Printing the blob is as costly as copying it, so it is only done for
+    // the debug log.
     tinyxml2::XMLPrinter debugStreamIn;
-    (*blobIt)->Print(&debugStreamIn);
+    (*_blobIt)->Print(&debugStreamIn);
     sdfdbg << "        INITIAL STRING link ["
            << linkName << "]-->[" << parentLinkName << "]: ["
            << debugStreamIn.CStr() << "]\n";
+  }
+
+  ReduceSDFExtensionContactSensorFrameReplace(_blobIt, _link);
+  ReduceSDFExtensionPluginFrameReplace(_blobIt, _link,
+                                       "plugin", "bodyName",
+                                       _ge->reductionTransform);
+  ReduceSDFExtensionPluginFrameReplace(_blobIt, _link,
+                                       "plugin", "frameName",
+                                       _ge->reductionTransform);
+  ReduceSDFExtensionProjectorFrameReplace(_blobIt, _link);
+  ReduceSDFExtensionGripperFrameReplace(_blobIt, _link);
+  ReduceSDFExtensionJointFrameReplace(_blobIt, _link);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::vector<std::string> SDFExtensionFrameRefs(const XMLDocumentPtr &_blob)
+{
+  std::vector<std::string> names;
+  tinyxml2::XMLElement *root = _blob->FirstChildElement();
+  if (!root)
+  {
+    return names;
+  }
+
+  // The lookups mirror the Reduce*FrameReplace functions, which search the
+  // children of the blob document rather than of its root element.
+  auto addKey = [&](tinyxml2::XMLNode *_node, const char *_name)
+  {
+    tinyxml2::XMLElement *elem = _node ? _node->FirstChildElement(_name)
+                                       : nullptr;
+    if (elem)
+    {
+      names.push_back(GetKeyValueAsString(elem));
+    }
+  };
+
+  const std::string rootName = root->Name();
+  if (rootName == "sensor")
+  {
+    // <collision>linkName_collision</collision>
+    tinyxml2::XMLElement *contact = _blob->FirstChildElement("contact");
+    tinyxml2::XMLElement *collision =
+      contact ? contact->FirstChildElement("collision") : nullptr;
+    if (collision)
+    {
+      std::string collisionName = GetKeyValueAsString(collision);
+      if (collisionName.size() >= g_collisionExt.size() &&
+          collisionName.compare(collisionName.size() - g_collisionExt.size(),
+                                g_collisionExt.size(), g_collisionExt) == 0)
+      {
+        names.push_back(collisionName.substr(
+              0, collisionName.size() - g_collisionExt.size()));
+      }
+    }
+  }
+  else if (rootName == "plugin")
+  {
+    addKey(_blob.get(), "bodyName");
+    addKey(_blob.get(), "frameName");
+  }
+  else if (rootName == "gripper")
+  {
+    addKey(_blob.get(), "gripper_link");
+    addKey(_blob.get(), "palm_link");
+  }
+  else if (rootName == "joint")
+  {
+    addKey(_blob.get(), "parent");
+    addKey(_blob.get(), "child");
+  }
 
-    ReduceSDFExtensionContactSensorFrameReplace(blobIt, _link);
-    ReduceSDFExtensionPluginFrameReplace(blobIt, _link,
-                                         "plugin", "bodyName",
-                                         _ge->reductionTransform);
-    ReduceSDFExtensionPluginFrameReplace(blobIt, _link,
-                                         "plugin", "frameName",
-                                         _ge->reductionTransform);
-    ReduceSDFExtensionProjectorFrameReplace(blobIt, _link);
-    ReduceSDFExtensionGripperFrameReplace(blobIt, _link);
-    ReduceSDFExtensionJointFrameReplace(blobIt, _link);
+  // <projector>linkName/projectorName</projector>, for any blob
+  tinyxml2::XMLElement *projector = _blob->FirstChildElement("projector");
+  if (projector)
+  {
+    std::string projectorName = GetKeyValueAsString(projector);
+    size_t pos = projectorName.find("/");
+    if (pos == std::string::npos)
+    {
+      sdferr << "no slash in projector reference tag [" << projectorName
+             << "], expecting linkName/projector_name.\n";
+    }
+    else
+    {
+      names.push_back(projectorName.substr(0, pos));
+    }
+  }
+
+  return names;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void IndexSDFExtensionFrameRefs()
+{
+  g_state->extensionFrameRefs.clear();
+  for (auto &ext : g_state->extensions)
+  {
+    for (const SDFExtensionPtr &ge : ext.second)
+    {
+      for (size_t i = 0; i < ge->blobs.size(); ++i)
+      {
+        std::vector<std::string> names = SDFExtensionFrameRefs(ge->blobs[i]);
+        std::sort(names.begin(), names.end());
+        names.erase(std::unique(names.begin(), names.end()), names.end());
+        for (const std::string &name : names)
+        {
+          g_state->extensionFrameRefs[name].push_back({ge, i});
+        }
+      }
+    }
   }
 }
 
@@ -2602,6 +2657,8 @@ void ReduceSDFExtensionsTransform(SDFExtensionPtr _ge)
   for (auto blobIt = _ge->blobs.begin();
          blobIt != _ge->blobs.end(); ++blobIt)
   {
+    SDFExtension::MutableBlob(*blobIt);
+
     /// @todo make sure we are not missing any additional transform reductions
     ReduceSDFExtensionSensorTransformReduction(blobIt,
                                                _ge->reductionTransform);
@@ -2614,8 +2671,8 @@ void ReduceSDFExtensionsTransform(SDFExtensionPtr _ge)
 void URDF2SDF::ListSDFExtensions()
 {
   for (StringSDFExtensionPtrMap::iterator
-      sdfIt = g_extensions.begin();
-      sdfIt != g_extensions.end(); ++sdfIt)
+      sdfIt = this->dataPtr->extensions.begin();
+      sdfIt != this->dataPtr->extensions.end(); ++sdfIt)
   {
     int extCount = 0;
     for (std::vector<SDFExtensionPtr>::iterator ge = sdfIt->second.begin();
@@ -2642,8 +2699,8 @@ void URDF2SDF::ListSDFExtensions()
 void URDF2SDF::ListSDFExtensions(const std::string &_reference)
 {
   for (StringSDFExtensionPtrMap::iterator
-      sdfIt = g_extensions.begin();
-      sdfIt != g_extensions.end(); ++sdfIt)
+      sdfIt = this->dataPtr->extensions.begin();
+      sdfIt != this->dataPtr->extensions.end(); ++sdfIt)
   {
     if (sdfIt->first == _reference)
     {
@@ -2668,6 +2725,21 @@ void URDF2SDF::ListSDFExtensions(const std::string &_reference)
 void CreateSDF(tinyxml2::XMLElement *_root,
                urdf::LinkConstSharedPtr _link,
                const ignition::math::Pose3d &_transform)
+{
+  if (!CreateSDFLink(_root, _link, _transform))
+    return;
+
+  // recurse into children
+  for (unsigned int i = 0 ; i < _link->child_links.size() ; ++i)
+  {
+    CreateSDF(_root, _link->child_links[i], _transform);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool CreateSDFLink(tinyxml2::XMLElement *_root,
+                   urdf::LinkConstSharedPtr _link,
+                   const ignition::math::Pose3d &_transform)
 {
   ignition::math::Pose3d _currentTransform = _transform;
 
@@ -2703,22 +2775,54 @@ void CreateSDF(tinyxml2::XMLElement *_root,
 
     sdfdbg << "urdf2sdf: link[" << _link->name
            << "] has no inertia, not modeled in sdf\n";
-    return;
+    return false;
   }
 
   // create <body:...> block for non fixed joint attached bodies
   if ((_link->getParent() && _link->getParent()->name == "world") ||
-      !g_reduceFixedJoints ||
+      !g_state->reduceFixedJoints ||
       (!_link->parent_joint ||
        !FixedJointShouldBeReduced(_link->parent_joint)))
   {
     CreateLink(_root, _link, _currentTransform);
   }
+  return true;
+}
 
-  // recurse into children
-  for (unsigned int i = 0 ; i < _link->child_links.size() ; ++i)
+////////////////////////////////////////////////////////////////////////////////
+void CreateSDFBranches(tinyxml2::XMLElement *_root,
+                       const std::vector<urdf::LinkSharedPtr> &_links,
+                       const ignition::math::Pose3d &_transform)
+{
+  if (g_state->threadCount == 1u || _links.size() < 2u)
   {
-    CreateSDF(_root, _link->child_links[i], _currentTransform);
+    for (const urdf::LinkSharedPtr &link : _links)
+      CreateSDF(_root, link, _transform);
+    return;
+  }
+
+  // The branches only read the conversion state and append to their
+  // parent, so each one is created in its own document and the results
+  // are appended in the order of the sequential conversion.
+  std::vector<tinyxml2::XMLDocument> fragments(_links.size());
+  URDF2SDFPrivate *state = g_state;
+  parallelFor(_links.size(), state->threadCount, [&](std::size_t _index)
+  {
+    URDF2SDFStateScope stateScope(state);
+    tinyxml2::XMLDocument &fragment = fragments[_index];
+    tinyxml2::XMLElement *branch = fragment.NewElement("model");
+    fragment.LinkEndChild(branch);
+    CreateSDF(branch, _links[_index], _transform);
+  });
+
+  tinyxml2::XMLDocument *doc = _root->GetDocument();
+  for (const tinyxml2::XMLDocument &fragment : fragments)
+  {
+    for (const tinyxml2::XMLNode *node = fragment.FirstChild()->FirstChild();
+         node; node = node->NextSibling())
+    {
+      _root->LinkEndChild(DeepClone(doc, node));
+    }
   }
 }
 
@@ -2971,8 +3075,9 @@ void CreateJoint(tinyxml2::XMLElement *_root,
   if (jtype == "fixed")
   {
     fixedJointConvertedToRevoluteJoint =
-      (g_fixedJointsTransformedInRevoluteJoints.find(_link->parent_joint->name)
-       != g_fixedJointsTransformedInRevoluteJoints.end());
+      (g_state->fixedJointsTransformedInRevoluteJoints.find(
+          _link->parent_joint->name)
+       != g_state->fixedJointsTransformedInRevoluteJoints.end());
   }
 
   // skip if joint type is fixed and it is lumped
@@ -2980,7 +3085,7 @@ void CreateJoint(tinyxml2::XMLElement *_root,
   //   because there's no lumping there
   if (_link->getParent() && _link->getParent()->name != "world"
       && FixedJointShouldBeReduced(_link->parent_joint)
-      && g_reduceFixedJoints)
+      && g_state->reduceFixedJoints)
   {
     return;
   }
@@ -3038,7 +3143,7 @@ void CreateJoint(tinyxml2::XMLElement *_root,
                     Values2str(1, &_link->parent_joint->dynamics->friction));
       }
 
-      if (g_enforceLimits && _link->parent_joint->limits)
+      if (g_state->enforceLimits && _link->parent_joint->limits)
       {
         if (jtype == "slider")
         {
@@ -3204,15 +3309,53 @@ void CreateVisual(tinyxml2::XMLElement *_elem, urdf::LinkConstSharedPtr _link,
   _elem->LinkEndChild(sdfVisual);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+void URDF2SDF::SetThreadCount(unsigned int _count)
+{
+  this->dataPtr->threadCount = _count;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 void URDF2SDF::InitModelString(const std::string &_urdfStr,
                                tinyxml2::XMLDocument* _sdfXmlOut,
                                bool _enforceLimits)
 {
-  g_enforceLimits = _enforceLimits;
+  // parse sdf extension
+  tinyxml2::XMLDocument urdfXml;
+  if (urdfXml.Parse(_urdfStr.c_str()))
+  {
+    // urdfdom fails on the same input, and reports the problem first.
+    if (!urdf::parseURDF(_urdfStr))
+    {
+      sdferr << "Unable to call parseURDF on robot model\n";
+      return;
+    }
+    sdferr << "Unable to parse URDF string: " << urdfXml.ErrorStr() << "\n";
+    return;
+  }
+
+  this->InitModel(_urdfStr, urdfXml, _sdfXmlOut, _enforceLimits);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void URDF2SDF::InitModel(const std::string &_urdfStr,
+                         const tinyxml2::XMLDocument &_urdfXml,
+                         tinyxml2::XMLDocument *_sdfXmlOut,
+                         bool _enforceLimits)
+{
+  // Components of a process often load the same robot description.
+  if (UrdfCache::Instance().Get(_urdfStr, _enforceLimits, _sdfXmlOut))
+    return;
+
+  URDF2SDFStateScope stateScope(this->dataPtr.get());
+  g_state->enforceLimits = _enforceLimits;
 
   // Create a RobotModel from string
-  urdf::ModelInterfaceSharedPtr robotModel = urdf::parseURDF(_urdfStr);
+  urdf::ModelInterfaceSharedPtr robotModel;
+  {
+    LoadPhaseTimer timer(LoadPhase::URDF_PARSE);
+    robotModel = urdf::parseURDF(_urdfStr);
+  }
 
   if (!robotModel)
   {
@@ -3230,16 +3373,13 @@ void URDF2SDF::InitModelString(const std::string &_urdfStr,
   // while sdf defines all links relative to model frame
   ignition::math::Pose3d transform;
 
-  // parse sdf extension
-  tinyxml2::XMLDocument urdfXml;
-  if (urdfXml.Parse(_urdfStr.c_str()))
-  {
-    sdferr << "Unable to parse URDF string: " << urdfXml.ErrorStr() << "\n";
-    return;
-  }
-  g_extensions.clear();
-  g_fixedJointsTransformedInFixedJoints.clear();
-  g_fixedJointsTransformedInRevoluteJoints.clear();
+  // parse sdf extension. The document is only read, but the extension
+  // helpers take non-const elements.
+  tinyxml2::XMLDocument &urdfXml =
+      const_cast<tinyxml2::XMLDocument &>(_urdfXml);
+  g_state->extensions.clear();
+  g_state->fixedJointsTransformedInFixedJoints.clear();
+  g_state->fixedJointsTransformedInRevoluteJoints.clear();
   this->ParseSDFExtension(urdfXml);
 
   // Parse robot pose
@@ -3260,25 +3400,24 @@ void URDF2SDF::InitModelString(const std::string &_urdfStr,
     // parent link recursively
     // using the disabledFixedJointLumping or preserveFixedJoint options
     // is possible to disable fixed joint lumping only for selected joints
-    if (g_reduceFixedJoints)
+    if (g_state->reduceFixedJoints)
     {
+      LoadPhaseTimer timer(LoadPhase::URDF_REDUCE_FIXED_JOINTS);
+      IndexSDFExtensionFrameRefs();
       ReduceFixedJoints(robot, urdf::const_pointer_cast<urdf::Link>(rootLink));
+      g_state->extensionFrameRefs.clear();
     }
 
+    LoadPhaseTimer createTimer(LoadPhase::URDF_CREATE_SDF);
     if (rootLink->name == "world")
     {
       // convert all children link
-      for (std::vector<urdf::LinkSharedPtr>::const_iterator
-          child = rootLink->child_links.begin();
-          child != rootLink->child_links.end(); ++child)
-      {
-        CreateSDF(robot, (*child), transform);
-      }
+      CreateSDFBranches(robot, rootLink->child_links, transform);
     }
-    else
+    else if (CreateSDFLink(robot, rootLink, transform))
     {
       // convert, starting from root link
-      CreateSDF(robot, rootLink, transform);
+      CreateSDFBranches(robot, rootLink->child_links, transform);
     }
 
     // insert the extensions without reference into <robot> root level
@@ -3308,16 +3447,18 @@ void URDF2SDF::InitModelString(const std::string &_urdfStr,
   }
 
   _sdfXmlOut->LinkEndChild(sdf);
+  UrdfCache::Instance().Put(_urdfStr, _enforceLimits, *_sdfXmlOut);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 void URDF2SDF::InitModelDoc(const tinyxml2::XMLDocument *_xmlDoc,
                             tinyxml2::XMLDocument *_sdfXmlDoc)
 {
+  // urdfdom only parses strings, but the extensions are read from the
+  // given document rather than from a parsed copy of the string.
   tinyxml2::XMLPrinter printer;
   _xmlDoc->Print(&printer);
-  std::string urdfStr = printer.CStr();
-  InitModelString(urdfStr, _sdfXmlDoc);
+  this->InitModel(printer.CStr(), *_xmlDoc, _sdfXmlDoc, true);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -3343,10 +3484,11 @@ bool FixedJointShouldBeReduced(urdf::JointSharedPtr _jnt)
     // the disabledFixedJointLumping or preserveFixedJoint
     // joint options are not set
     return (_jnt->type == urdf::Joint::FIXED &&
-              (g_fixedJointsTransformedInRevoluteJoints.find(_jnt->name) ==
-                 g_fixedJointsTransformedInRevoluteJoints.end()) &&
-              (g_fixedJointsTransformedInFixedJoints.find(_jnt->name) ==
-                 g_fixedJointsTransformedInFixedJoints.end()));
+              (g_state->fixedJointsTransformedInRevoluteJoints.find(
+                  _jnt->name) ==
+                 g_state->fixedJointsTransformedInRevoluteJoints.end()) &&
+              (g_state->fixedJointsTransformedInFixedJoints.find(_jnt->name) ==
+                 g_state->fixedJointsTransformedInFixedJoints.end()));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
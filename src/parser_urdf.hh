@@ -20,6 +20,7 @@
 #include <tinyxml2.h>
 #include <sdf/sdf_config.h>
 
+#include <memory>
 #include <string>
 
 #include "sdf/Console.hh"
@@ -32,6 +33,9 @@ namespace sdf
   inline namespace SDF_VERSION_NAMESPACE {
   //
 
+  // Forward declare private data class
+  class URDF2SDFPrivate;
+
   /// \brief URDF to SDF converter
   ///
   /// This is now deprecated for external usage and will be removed in the next
@@ -66,11 +70,40 @@ namespace sdf
                                  tinyxml2::XMLDocument *_sdfXmlDoc,
                                  bool _enforceLimits = true);
 
-    /// \brief Return true if the filename is a URDF model.
+    /// \brief convert a urdf model to sdf xml document.
+    /// \param[in] _urdfStr a string containing model urdf, for urdfdom.
+    /// \param[in] _urdfXml the same model as a parsed xml document, which is
+    /// used to read the extensions.
+    /// \param[inout] _sdfXmlOut document to populate with the sdf model.
+    /// \param[in] _enforceLimits option to enforce joint limits
+    /// \remarks Callers that already hold both the urdf string and its
+    /// parsed document use this to avoid parsing the model again.
+    public: void InitModel(const std::string &_urdfStr,
+                            const tinyxml2::XMLDocument &_urdfXml,
+                            tinyxml2::XMLDocument *_sdfXmlOut,
+                            bool _enforceLimits);
+
+    /// \brief Set the maximum number of threads used to create the top
+    /// level branches of the kinematic tree, i.e. the subtrees of the
+    /// children of the root link, once fixed joints are reduced. The
+    /// output document does not depend on it.
+    /// \param[in] _count Number of threads, where 0 means one thread per
+    /// hardware thread and 1, the default, converts on the calling thread.
+    public: void SetThreadCount(unsigned int _count);
+
+    /// \brief Return true if the filename is a URDF model. Only the start
+    /// of the file is read, up to its root element, which must be <robot>.
+    /// Whether urdfdom accepts the model is known once it is converted.
     /// \param[in] _filename File to check.
     /// \return True if _filename is a URDF model.
     public: static bool IsURDF(const std::string &_filename);
 
+    /// \brief Return true if a parsed document is a URDF model, that is if
+    /// its root element is <robot>.
+    /// \param[in] _xmlDoc Document to check.
+    /// \return True if _xmlDoc is a URDF model.
+    public: static bool IsURDF(const tinyxml2::XMLDocument &_xmlDoc);
+
     /// list extensions for debugging
     public: void ListSDFExtensions();
 
@@ -80,6 +113,10 @@ namespace sdf
     /// things that do not belong in urdf but should be mapped into sdf
     /// @todo: do this using sdf definitions, not hard coded stuff
     private: void ParseSDFExtension(tinyxml2::XMLDocument &_urdfXml);
+
+    /// \brief Conversion state. Each instance converts independently, so
+    /// separate instances can be used from different threads at once.
+    private: std::unique_ptr<URDF2SDFPrivate> dataPtr;
   };
   }
 }
@@ -17,9 +17,17 @@
 
 #include <gtest/gtest.h>
 
+#include <cstdio>
+#include <fstream>
 #include <list>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "sdf/sdf.hh"
+#include "SDFExtension.hh"
+#include "UrdfCache.hh"
 #include "parser_urdf.hh"
 
 /////////////////////////////////////////////////
@@ -75,6 +83,40 @@ TEST(URDFParser, InitModelDoc_BasicModel_NoThrow)
   );    // NOLINT(whitespace/parens)
 }
 
+/////////////////////////////////////////////////
+TEST(URDFParser, IsURDF)
+{
+  tinyxml2::XMLDocument doc;
+  doc.Parse(getMinimalUrdfTxt().c_str());
+  EXPECT_TRUE(sdf::URDF2SDF::IsURDF(doc));
+  doc.Parse("<sdf version='1.8'/>");
+  EXPECT_FALSE(sdf::URDF2SDF::IsURDF(doc));
+  EXPECT_FALSE(sdf::URDF2SDF::IsURDF(tinyxml2::XMLDocument()));
+
+  // Files are recognized by their root element, after the prolog.
+  const std::string path = sdf::filesystem::append(
+      sdf::filesystem::current_path(), "is_urdf_test.urdf");
+  auto isURDF = [&path](const std::string &_text)
+  {
+    {
+      std::ofstream output(path, std::ios::binary);
+      output << _text;
+    }
+    return sdf::URDF2SDF::IsURDF(path);
+  };
+  EXPECT_TRUE(isURDF(getMinimalUrdfTxt()));
+  EXPECT_TRUE(isURDF("\xEF\xBB\xBF<?xml version='1.0'?>\n"
+      "<!-- <sdf> -->\n<!DOCTYPE robot [<!ENTITY a 'b'>]>\n"
+      "<robot name='r'>"));
+  EXPECT_TRUE(isURDF("<robot/>"));
+  EXPECT_FALSE(isURDF("<robots name='r'/>"));
+  EXPECT_FALSE(isURDF("<?xml version='1.0'?><sdf version='1.8'/>"));
+  EXPECT_FALSE(isURDF("<!-- <robot>"));
+  EXPECT_FALSE(isURDF("robot"));
+  EXPECT_EQ(0, std::remove(path.c_str()));
+  EXPECT_FALSE(sdf::URDF2SDF::IsURDF(path));
+}
+
 /////////////////////////////////////////////////
 TEST(URDFParser, ParseResults_BasicModel_ParseEqualToModel)
 {
@@ -852,6 +894,469 @@ TEST(URDFParser, OutputPrecision)
   EXPECT_EQ("0", poseValues[5]);
 }
 
+/////////////////////////////////////////////////
+TEST(URDFParser, OutputNumberFormat)
+{
+  std::string str = R"(
+    <robot name='test_robot'>
+      <link name='link1'>
+          <inertial>
+            <mass value="2.5e-5" />
+            <origin xyz="-0.5 1234567890123456789 0" />
+            <inertia ixx="0.1" ixy="0" ixz="0" iyy="0.01" iyz="0" izz="1" />
+          </inertial>
+          <visual>
+            <geometry>
+              <mesh filename="mesh.dae" scale="0.1234567 2 -3" />
+            </geometry>
+          </visual>
+        </link>
+    </robot>)";
+
+  sdf::URDF2SDF parser;
+  tinyxml2::XMLDocument sdfResult;
+  parser.InitModelString(str, &sdfResult);
+
+  auto root = sdfResult.RootElement();
+  ASSERT_NE(nullptr, root);
+  auto link = root->FirstChildElement("model")->FirstChildElement("link");
+  ASSERT_NE(nullptr, link);
+  auto inertial = link->FirstChildElement("inertial");
+  ASSERT_NE(nullptr, inertial);
+
+  // Poses and inertial values are written with 16 significant digits, the
+  // way a stream with that precision writes them.
+  EXPECT_STREQ("-0.5 1.234567890123457e+18 0 0 0 0",
+      inertial->FirstChildElement("pose")->GetText());
+  EXPECT_STREQ("2.5e-05", inertial->FirstChildElement("mass")->GetText());
+  EXPECT_STREQ("0.1", inertial->FirstChildElement("inertia")
+      ->FirstChildElement("ixx")->GetText());
+
+  // Mesh scales are written with the default stream precision.
+  auto mesh = link->FirstChildElement("visual")
+      ->FirstChildElement("geometry")->FirstChildElement("mesh");
+  ASSERT_NE(nullptr, mesh);
+  EXPECT_STREQ("0.123457 2 -3", mesh->FirstChildElement("scale")->GetText());
+}
+
+/////////////////////////////////////////////////
+TEST(URDFParser, FixedJointReductionChainUpdatesExtensionFrames)
+{
+  // A projector extension refers to the last link of a chain of fixed
+  // joints. Each reduction must carry the reference one link up, until it
+  // names the link that the whole chain is lumped into.
+  std::ostringstream stream;
+  stream << "<robot name='test_robot'>";
+  for (int i = 1; i <= 3; ++i)
+  {
+    stream << "  <link name='link" << i << "'>"
+           << "    <inertial>"
+           << "      <mass value='1.0'/>"
+           << "      <inertia ixx='1.0' ixy='0.0' ixz='0.0'"
+           << "               iyy='1.0' iyz='0.0' izz='1.0'/>"
+           << "    </inertial>"
+           << "  </link>";
+  }
+  stream << "  <joint name='joint1_2' type='fixed'>"
+         << "    <parent link='link1' />"
+         << "    <child  link='link2' />"
+         << "  </joint>"
+         << "  <joint name='joint2_3' type='fixed'>"
+         << "    <parent link='link2' />"
+         << "    <child  link='link3' />"
+         << "  </joint>"
+         << "  <gazebo>"
+         << "    <projector>link3/my_projector</projector>"
+         << "  </gazebo>"
+         << "</robot>";
+
+  tinyxml2::XMLDocument sdfResult;
+  sdfResult.Parse(convertUrdfStrToSdfStr(stream.str()).c_str());
+
+  tinyxml2::XMLElement *sdf = sdfResult.FirstChildElement("sdf");
+  ASSERT_NE(nullptr, sdf);
+  tinyxml2::XMLElement *model = sdf->FirstChildElement("model");
+  ASSERT_NE(nullptr, model);
+  EXPECT_EQ(nullptr, model->FirstChildElement("joint"));
+  tinyxml2::XMLElement *projector = model->FirstChildElement("projector");
+  ASSERT_NE(nullptr, projector);
+  ASSERT_NE(nullptr, projector->GetText());
+  EXPECT_EQ("link1/my_projector", std::string(projector->GetText()));
+}
+
+/////////////////////////////////////////////////
+TEST(URDFParser, FixedJointReductionTreeInertial)
+{
+  // link0 keeps a branching tree of fixed joints: link1 at +y with link2
+  // above it, and link3 at -y. All links are unit point-like masses.
+  auto link = [](const std::string &_name)
+  {
+    return "  <link name='" + _name + "'>"
+      "    <inertial>"
+      "      <mass value='1.0'/>"
+      "      <inertia ixx='1.0' ixy='0.0' ixz='0.0'"
+      "               iyy='1.0' iyz='0.0' izz='1.0'/>"
+      "    </inertial>"
+      "  </link>";
+  };
+  auto joint = [](const std::string &_parent, const std::string &_child,
+                  const std::string &_xyz)
+  {
+    return "  <joint name='" + _parent + "_" + _child + "' type='fixed'>"
+      "    <parent link='" + _parent + "' />"
+      "    <child  link='" + _child + "' />"
+      "    <origin xyz='" + _xyz + "' rpy='0 0 0' />"
+      "  </joint>";
+  };
+  std::string urdf = "<robot name='test_robot'>" +
+    link("link0") + link("link1") + link("link2") + link("link3") +
+    joint("link0", "link1", "0 1 0") +
+    joint("link1", "link2", "0 0 1") +
+    joint("link0", "link3", "0 -1 0") +
+    "</robot>";
+
+  sdf::SDF sdfResult;
+  convertUrdfStrToSdf(urdf, sdfResult);
+  sdf::ElementPtr elem = sdfResult.Root();
+  ASSERT_NE(nullptr, elem);
+  elem = elem->GetElement("model");
+  ASSERT_NE(nullptr, elem);
+  EXPECT_FALSE(elem->HasElement("joint"));
+  sdf::ElementPtr linkElem = elem->GetElement("link");
+  ASSERT_NE(nullptr, linkElem);
+  EXPECT_EQ("link0", linkElem->Get<std::string>("name"));
+  EXPECT_EQ(nullptr, linkElem->GetNextElement("link"));
+
+  sdf::ElementPtr inertial = linkElem->GetElement("inertial");
+  const double tol = 1e-9;
+  EXPECT_NEAR(4.0, inertial->Get<double>("mass"), tol);
+  ignition::math::Pose3d pose = inertial->Get<ignition::math::Pose3d>("pose");
+  EXPECT_NEAR(0.0, pose.Pos().X(), tol);
+  EXPECT_NEAR(0.25, pose.Pos().Y(), tol);
+  EXPECT_NEAR(0.25, pose.Pos().Z(), tol);
+
+  // parallel axis theorem about the combined center of mass
+  sdf::ElementPtr inertia = inertial->GetElement("inertia");
+  EXPECT_NEAR(7.5, inertia->Get<double>("ixx"), tol);
+  EXPECT_NEAR(4.75, inertia->Get<double>("iyy"), tol);
+  EXPECT_NEAR(6.75, inertia->Get<double>("izz"), tol);
+  EXPECT_NEAR(0.0, inertia->Get<double>("ixy"), tol);
+  EXPECT_NEAR(0.0, inertia->Get<double>("ixz"), tol);
+  EXPECT_NEAR(-0.75, inertia->Get<double>("iyz"), tol);
+}
+
+/////////////////////////////////////////////////
+TEST(URDFParser, FixedJointReductionChainPoses)
+{
+  // link1, link2 and link3 are a chain of fixed joints with a turn at
+  // link2, and link4 hangs from link3 with a revolute joint. Each element
+  // of the chain ends up in link1 at the pose of its link in link1.
+  auto link = [](const std::string &_name)
+  {
+    return "  <link name='" + _name + "'>"
+      "    <inertial>"
+      "      <mass value='1.0'/>"
+      "      <inertia ixx='1.0' ixy='0.0' ixz='0.0'"
+      "               iyy='1.0' iyz='0.0' izz='1.0'/>"
+      "    </inertial>"
+      "    <visual><geometry><box size='1 1 1'/></geometry></visual>"
+      "    <collision><geometry><box size='1 1 1'/></geometry></collision>"
+      "  </link>";
+  };
+  auto joint = [](const std::string &_type, const std::string &_parent,
+                  const std::string &_child, const std::string &_origin)
+  {
+    return "  <joint name='" + _parent + "_" + _child + "' type='" + _type +
+      "'>"
+      "    <parent link='" + _parent + "' />"
+      "    <child  link='" + _child + "' />"
+      "    <origin " + _origin + " />"
+      "    <axis xyz='0 0 1' />"
+      "    <limit lower='-1' upper='1' effort='1' velocity='1' />"
+      "  </joint>";
+  };
+  std::string urdf = "<robot name='test_robot'>" +
+    link("link1") + link("link2") + link("link3") + link("link4") +
+    joint("fixed", "link1", "link2", "xyz='1 0 0' rpy='0 0 1.5707963267949'") +
+    joint("fixed", "link2", "link3", "xyz='1 0 0' rpy='0 0 0'") +
+    joint("revolute", "link3", "link4", "xyz='0 0 1' rpy='0 0 0'") +
+    "</robot>";
+
+  sdf::SDF sdfResult;
+  convertUrdfStrToSdf(urdf, sdfResult);
+  sdf::ElementPtr model = sdfResult.Root();
+  ASSERT_NE(nullptr, model);
+  model = model->GetElement("model");
+  ASSERT_NE(nullptr, model);
+
+  sdf::ElementPtr link1 = model->GetElement("link");
+  ASSERT_NE(nullptr, link1);
+  EXPECT_EQ("link1", link1->Get<std::string>("name"));
+  sdf::ElementPtr link4 = link1->GetNextElement("link");
+  ASSERT_NE(nullptr, link4);
+  EXPECT_EQ("link4", link4->Get<std::string>("name"));
+  EXPECT_EQ(nullptr, link4->GetNextElement("link"));
+
+  const double tol = 1e-9;
+  const std::vector<ignition::math::Pose3d> expected = {
+    ignition::math::Pose3d::Zero,
+    ignition::math::Pose3d(1, 0, 0, 0, 0, IGN_PI_2),
+    ignition::math::Pose3d(1, 1, 0, 0, 0, IGN_PI_2),
+  };
+  for (const char *type : {"visual", "collision"})
+  {
+    sdf::ElementPtr elem = link1->GetElement(type);
+    for (const ignition::math::Pose3d &pose : expected)
+    {
+      ASSERT_NE(nullptr, elem) << type;
+      ignition::math::Pose3d actual =
+        elem->Get<ignition::math::Pose3d>("pose");
+      EXPECT_NEAR(0.0, (actual.Pos() - pose.Pos()).Length(), tol) << type;
+      EXPECT_NEAR(pose.Rot().Yaw(), actual.Rot().Yaw(), tol) << type;
+      elem = elem->GetNextElement(type);
+    }
+    EXPECT_EQ(nullptr, elem) << type;
+  }
+
+  // the revolute joint moved to link1, at the pose of link4 in link1
+  sdf::ElementPtr joint4 = model->GetElement("joint");
+  ASSERT_NE(nullptr, joint4);
+  EXPECT_EQ("link3_link4", joint4->Get<std::string>("name"));
+  EXPECT_EQ("link1", joint4->Get<std::string>("parent"));
+  sdf::ElementPtr jointPose = joint4->GetElement("pose");
+  EXPECT_EQ("link1", jointPose->Get<std::string>("relative_to"));
+  ignition::math::Pose3d pose = jointPose->Get<ignition::math::Pose3d>();
+  EXPECT_NEAR(0.0,
+      (pose.Pos() - ignition::math::Vector3d(1, 1, 1)).Length(), tol);
+  EXPECT_NEAR(IGN_PI_2, pose.Rot().Yaw(), tol);
+}
+
+/////////////////////////////////////////////////
+TEST(URDFParser, FixedJointReductionChainPluginOffsets)
+{
+  // A plugin of link3 names link3 as its body and has no offsets. The
+  // chain link1, link2, link3 of fixed joints is reduced one joint at a
+  // time, so the offsets are first set from the reduction transform of
+  // joint2_3 and then moved through joint1_2.
+  std::ostringstream stream;
+  stream << "<robot name='test_robot'>";
+  for (int i = 1; i <= 3; ++i)
+  {
+    stream << "  <link name='link" << i << "'>"
+           << "    <inertial>"
+           << "      <mass value='1.0'/>"
+           << "      <inertia ixx='1.0' ixy='0.0' ixz='0.0'"
+           << "               iyy='1.0' iyz='0.0' izz='1.0'/>"
+           << "    </inertial>"
+           << "  </link>";
+  }
+  stream << "  <joint name='joint1_2' type='fixed'>"
+         << "    <parent link='link1' />"
+         << "    <child  link='link2' />"
+         << "    <origin xyz='1 0 0' rpy='0 0 1.5707963267949' />"
+         << "  </joint>"
+         << "  <joint name='joint2_3' type='fixed'>"
+         << "    <parent link='link2' />"
+         << "    <child  link='link3' />"
+         << "    <origin xyz='1 0 0' rpy='0 0 0' />"
+         << "  </joint>"
+         << "  <gazebo reference='link3'>"
+         << "    <plugin name='p' filename='libp.so'>"
+         << "      <bodyName>link3</bodyName>"
+         << "    </plugin>"
+         << "  </gazebo>"
+         << "</robot>";
+
+  tinyxml2::XMLDocument sdfResult;
+  sdfResult.Parse(convertUrdfStrToSdfStr(stream.str()).c_str());
+
+  tinyxml2::XMLElement *sdf = sdfResult.FirstChildElement("sdf");
+  ASSERT_NE(nullptr, sdf);
+  tinyxml2::XMLElement *model = sdf->FirstChildElement("model");
+  ASSERT_NE(nullptr, model);
+  tinyxml2::XMLElement *link = model->FirstChildElement("link");
+  ASSERT_NE(nullptr, link);
+  EXPECT_STREQ("link1", link->Attribute("name"));
+  tinyxml2::XMLElement *plugin = link->FirstChildElement("plugin");
+  ASSERT_NE(nullptr, plugin);
+
+  auto values = [plugin](const char *_name)
+  {
+    tinyxml2::XMLElement *elem = plugin->FirstChildElement(_name);
+    ignition::math::Vector3d v(99, 99, 99);
+    if (elem && elem->GetText())
+    {
+      std::istringstream(elem->GetText()) >> v;
+    }
+    return v;
+  };
+  tinyxml2::XMLElement *bodyName = plugin->FirstChildElement("bodyName");
+  ASSERT_NE(nullptr, bodyName);
+  EXPECT_STREQ("link1", bodyName->GetText());
+
+  // the offsets are printed with the default stream precision
+  const double tol = 1e-4;
+  EXPECT_NEAR(0.0,
+      (values("xyzOffset") - ignition::math::Vector3d(-1, 0, 0)).Length(),
+      tol);
+  EXPECT_NEAR(0.0,
+      (values("rpyOffset") - ignition::math::Vector3d(0, 0, -IGN_PI_2))
+        .Length(), tol);
+}
+
+/////////////////////////////////////////////////
+TEST(URDFParser, ConcurrentConversions)
+{
+  // Robots that differ in size and in their fixed joint reduction options,
+  // so that state leaking between conversions would change the output.
+  auto chain = [](int _links, bool _lump)
+  {
+    std::ostringstream stream;
+    stream << "<robot name='chain" << _links << "'>";
+    for (int i = 0; i < _links; ++i)
+    {
+      stream << "  <link name='link" << i << "'>"
+             << "    <inertial>"
+             << "      <mass value='1.0'/>"
+             << "      <inertia ixx='1.0' ixy='0.0' ixz='0.0'"
+             << "               iyy='1.0' iyz='0.0' izz='1.0'/>"
+             << "    </inertial>"
+             << "  </link>";
+      if (i > 0)
+      {
+        stream << "  <joint name='joint" << i << "' type='fixed'>"
+               << "    <parent link='link" << i - 1 << "' />"
+               << "    <child  link='link" << i << "' />"
+               << "    <origin xyz='0 0 0.1' rpy='0 0 0' />"
+               << "  </joint>";
+        if (!_lump)
+        {
+          stream << "  <gazebo reference='joint" << i << "'>"
+                 << "    <disableFixedJointLumping>true"
+                 << "</disableFixedJointLumping>"
+                 << "  </gazebo>";
+        }
+      }
+    }
+    stream << "</robot>";
+    return stream.str();
+  };
+
+  std::vector<std::string> urdfs;
+  std::vector<std::string> expected;
+  for (int i = 0; i < 4; ++i)
+  {
+    urdfs.push_back(chain(5 + i * 5, i % 2 == 0));
+    expected.push_back(convertUrdfStrToSdfStr(urdfs.back()));
+    ASSERT_FALSE(expected.back().empty());
+  }
+
+  std::vector<std::string> results[4];
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i)
+  {
+    threads.emplace_back([&, i]()
+    {
+      for (int j = 0; j < 10; ++j)
+      {
+        results[i].push_back(convertUrdfStrToSdfStr(urdfs[i]));
+      }
+    });
+  }
+  for (auto &thread : threads)
+  {
+    thread.join();
+  }
+
+  for (int i = 0; i < 4; ++i)
+  {
+    ASSERT_EQ(10u, results[i].size());
+    for (const std::string &result : results[i])
+    {
+      EXPECT_EQ(expected[i], result);
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(URDFParser, SharedExtensionBlobs)
+{
+  sdf::SDFExtension ext;
+  auto blob = std::make_shared<tinyxml2::XMLDocument>();
+  blob->Parse("<plugin name='p'><bodyName>link1</bodyName></plugin>");
+  ext.blobs.push_back(blob);
+
+  // Copies share the blobs.
+  sdf::SDFExtension copy(ext);
+  ASSERT_EQ(1u, copy.blobs.size());
+  EXPECT_EQ(blob, copy.blobs[0]);
+
+  // Modifying a shared blob copies it first.
+  tinyxml2::XMLDocument *doc = sdf::SDFExtension::MutableBlob(copy.blobs[0]);
+  EXPECT_NE(blob.get(), doc);
+  doc->FirstChildElement("plugin")->FirstChildElement("bodyName")->SetText(
+      "link0");
+  EXPECT_STREQ("link1", blob->FirstChildElement("plugin")->FirstChildElement(
+      "bodyName")->GetText());
+  EXPECT_STREQ("plugin", doc->FirstChildElement()->Name());
+
+  // A blob that is not shared is modified in place.
+  blob.reset();
+  EXPECT_EQ(ext.blobs[0].get(), sdf::SDFExtension::MutableBlob(ext.blobs[0]));
+}
+
+/////////////////////////////////////////////////
+TEST(URDFParser, ParallelBranches)
+{
+  // A torso with four arms, each a chain of links with a fixed joint to
+  // reduce and extensions for its links and joints.
+  std::string str = "<robot name='test_robot'>"
+      "<link name='torso'><inertial><mass value='10'/>"
+      "<inertia ixx='1' ixy='0' ixz='0' iyy='1' iyz='0' izz='1'/>"
+      "</inertial></link>";
+  for (int arm = 0; arm < 4; ++arm)
+  {
+    std::string parent = "torso";
+    for (int i = 0; i < 3; ++i)
+    {
+      const std::string name =
+          "arm" + std::to_string(arm) + "_" + std::to_string(i);
+      const std::string type = i == 1 ? "fixed" : "revolute";
+      str += "<link name='" + name + "'><inertial><mass value='1'/>"
+          "<origin xyz='0.1 0 0'/>"
+          "<inertia ixx='0.1' ixy='0' ixz='0' iyy='0.1' iyz='0' izz='0.1'/>"
+          "</inertial><collision><geometry><box size='1 1 1'/></geometry>"
+          "</collision></link>"
+          "<joint name='" + name + "_joint' type='" + type + "'>"
+          "<parent link='" + parent + "'/><child link='" + name + "'/>"
+          "<origin xyz='0 " + std::to_string(arm) + " 0.5'/>"
+          "<axis xyz='0 0 1'/>"
+          "<limit lower='-1' upper='1' effort='1' velocity='1'/></joint>"
+          "<gazebo reference='" + name + "'><mu1>0.5</mu1></gazebo>";
+      parent = name;
+    }
+  }
+  str += "</robot>";
+
+  auto convert = [&str](unsigned int _threadCount)
+  {
+    sdf::UrdfCache::Instance().Clear();
+    sdf::URDF2SDF parser;
+    parser.SetThreadCount(_threadCount);
+    tinyxml2::XMLDocument sdfResult;
+    parser.InitModelString(str, &sdfResult);
+    tinyxml2::XMLPrinter printer;
+    sdfResult.Print(&printer);
+    return std::string(printer.CStr());
+  };
+
+  const std::string sequential = convert(1u);
+  EXPECT_NE(std::string::npos, sequential.find("arm3_2_joint"));
+  EXPECT_EQ(std::string::npos, sequential.find("arm3_1_joint"));
+  EXPECT_EQ(sequential, convert(4u));
+  EXPECT_EQ(sequential, convert(0u));
+}
+
 /////////////////////////////////////////////////
 /// Main
 int main(int argc, char **argv)
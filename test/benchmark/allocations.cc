@@ -0,0 +1,91 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#include <benchmark/benchmark.h>
+
+#include "sdf/Root.hh"
+#include "sdf/SDFImpl.hh"
+#include "sdf/parser.hh"
+
+#include "benchmark_utils.hh"
+
+/// \brief Number of calls to the global operator new of this executable.
+static std::atomic<std::size_t> g_allocations{0};
+
+/////////////////////////////////////////////////
+void *operator new(std::size_t _size)
+{
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void *ptr = std::malloc(_size ? _size : 1))
+    return ptr;
+  throw std::bad_alloc();
+}
+
+/////////////////////////////////////////////////
+void operator delete(void *_ptr) noexcept
+{
+  std::free(_ptr);
+}
+
+/////////////////////////////////////////////////
+void operator delete(void *_ptr, std::size_t) noexcept
+{
+  std::free(_ptr);
+}
+
+/////////////////////////////////////////////////
+/// \brief Build the DOM of a synthetic world from an element tree that has
+/// already been read, and report the allocations per loaded link. Copies
+/// of DOM objects while they are stored in their containers would show up
+/// as extra allocations.
+static void BM_RootLoadAllocations(benchmark::State &_state)
+{
+  const int modelCount = static_cast<int>(_state.range(0));
+  sdf::SDFPtr sdfParsed(new sdf::SDF());
+  sdf::init(sdfParsed);
+  sdf::Errors errors;
+  if (!sdf::readString(syntheticWorld(modelCount), sdfParsed, errors))
+  {
+    _state.SkipWithError("sdf::readString failed");
+    return;
+  }
+
+  std::size_t allocations = 0;
+  for (auto _ : _state)
+  {
+    const std::size_t start = g_allocations.load(std::memory_order_relaxed);
+    {
+      sdf::Root root;
+      if (!root.Load(sdfParsed).empty())
+        _state.SkipWithError("sdf::Root::Load failed");
+    }
+    allocations += g_allocations.load(std::memory_order_relaxed) - start;
+  }
+
+  // Every synthetic model has two links.
+  const double links = 2.0 * modelCount;
+  _state.counters["allocs_per_link"] = benchmark::Counter(
+      static_cast<double>(allocations) / links,
+      benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_RootLoadAllocations)->Arg(10)->Arg(100)->Arg(1000)
+  ->Unit(benchmark::kMillisecond);
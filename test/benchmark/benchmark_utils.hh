@@ -0,0 +1,363 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef SDF_BENCHMARK_UTILS_HH_
+#define SDF_BENCHMARK_UTILS_HH_
+
+#include <cstddef>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "sdf/Filesystem.hh"
+#include "test_config.h"
+
+/// \brief Generate a world with a number of identical models. Each model
+/// has two links connected by a revolute joint, and every link has a
+/// visual and a collision.
+/// \param[in] _modelCount Number of models in the world.
+/// \param[in] _version SDFormat version of the document.
+/// \param[in] _frames True to add explicit frames and relative_to poses.
+/// These require SDFormat 1.7 or newer.
+/// \return The world as an SDFormat string.
+inline std::string syntheticWorld(int _modelCount,
+    const std::string &_version = SDF_PROTOCOL_VERSION, bool _frames = true)
+{
+  std::ostringstream stream;
+  stream << "<?xml version='1.0'?>\n"
+         << "<sdf version='" << _version << "'>\n"
+         << "<world name='default'>\n";
+
+  for (int i = 0; i < _modelCount; ++i)
+  {
+    stream << "<model name='model_" << i << "'>\n"
+           << "  <pose>" << i << " 0 0 0 0 0</pose>\n";
+
+    for (const char *link : {"base", "arm"})
+    {
+      stream << "  <link name='" << link << "'>\n"
+             << "    <pose>0 0 1 0 0 0</pose>\n"
+             << "    <inertial><mass>1.0</mass></inertial>\n"
+             << "    <visual name='visual'>\n"
+             << "      <geometry><box><size>1 1 1</size></box></geometry>\n"
+             << "    </visual>\n"
+             << "    <collision name='collision'>\n"
+             << "      <geometry><box><size>1 1 1</size></box></geometry>\n"
+             << "    </collision>\n"
+             << "  </link>\n";
+    }
+
+    stream << "  <joint name='joint' type='revolute'>\n"
+           << "    <parent>base</parent>\n"
+           << "    <child>arm</child>\n"
+           << "    <axis><xyz>0 0 1</xyz></axis>\n"
+           << "  </joint>\n";
+
+    if (_frames)
+    {
+      stream << "  <frame name='tip' attached_to='arm'>\n"
+             << "    <pose relative_to='arm'>0 0 0.5 0 0 0</pose>\n"
+             << "  </frame>\n"
+             << "  <frame name='sensor_mount' attached_to='tip'>\n"
+             << "    <pose relative_to='tip'>0.1 0 0 0 0 0</pose>\n"
+             << "  </frame>\n";
+    }
+
+    stream << "</model>\n";
+  }
+
+  stream << "</world>\n"
+         << "</sdf>\n";
+  return stream.str();
+}
+
+/// \brief Parameters of a synthetic world generated by syntheticCorpus.
+/// Each parameter scales one dimension of the input, so that benchmarks
+/// can measure how every phase of loading scales with it.
+struct SyntheticWorldOptions
+{
+  /// \brief Number of models in the world, not counting included ones.
+  int modelCount = 10;
+
+  /// \brief Number of levels of nested models in every model. Nested
+  /// models require SDFormat 1.5 or newer.
+  int nestingDepth = 0;
+
+  /// \brief Number of links in every model and nested model. The links
+  /// are connected by a chain of revolute joints.
+  int linksPerModel = 2;
+
+  /// \brief Number of times a shared model is included in the world.
+  int includeFanOut = 0;
+
+  /// \brief Length of a chain of frames in every model, each attached to
+  /// the previous one. Frames require SDFormat 1.7 or newer.
+  int frameChainLength = 0;
+
+  /// \brief Percentage of the frames of the chain whose pose has an
+  /// explicit relative_to attribute. The others leave it out, which makes
+  /// their pose relative to the frame they are attached to, so the graphs
+  /// are the same and only the way the poses are written changes.
+  int relativeToPercent = 100;
+
+  /// \brief Size in bytes of the text of a plugin in every model, or 0 for
+  /// no plugin.
+  std::size_t pluginPayloadSize = 0;
+
+  /// \brief SDFormat version of the documents.
+  std::string version = SDF_PROTOCOL_VERSION;
+};
+
+/// \brief Generate the content of a synthetic model, without the <model>
+/// tags of the model itself.
+/// \param[in] _options Parameters of the model.
+/// \param[in] _depth Number of levels of nested models to generate.
+/// \return The content of the model as an SDFormat string.
+inline std::string syntheticModelContent(
+    const SyntheticWorldOptions &_options, int _depth)
+{
+  std::ostringstream stream;
+  for (int i = 0; i < _options.linksPerModel; ++i)
+  {
+    stream << "<link name='link_" << i << "'>\n"
+           << "  <pose>0 0 " << i << " 0 0 0</pose>\n"
+           << "  <inertial><mass>1.0</mass></inertial>\n"
+           << "  <visual name='visual'>\n"
+           << "    <geometry><box><size>1 1 1</size></box></geometry>\n"
+           << "  </visual>\n"
+           << "  <collision name='collision'>\n"
+           << "    <geometry><box><size>1 1 1</size></box></geometry>\n"
+           << "  </collision>\n"
+           << "</link>\n";
+    if (i > 0)
+    {
+      stream << "<joint name='joint_" << i << "' type='revolute'>\n"
+             << "  <parent>link_" << i - 1 << "</parent>\n"
+             << "  <child>link_" << i << "</child>\n"
+             << "  <axis><xyz>0 0 1</xyz></axis>\n"
+             << "</joint>\n";
+    }
+  }
+
+  for (int i = 0; i < _options.frameChainLength; ++i)
+  {
+    const std::string attachedTo = i == 0 ?
+        "link_0" : "frame_" + std::to_string(i - 1);
+    // Spread the explicit poses evenly along the chain.
+    const bool explicitPose = (i + 1) * _options.relativeToPercent / 100 >
+        i * _options.relativeToPercent / 100;
+    stream << "<frame name='frame_" << i << "' attached_to='" << attachedTo
+           << "'>\n";
+    if (explicitPose)
+    {
+      stream << "  <pose relative_to='" << attachedTo
+             << "'>0.1 0 0 0 0 0</pose>\n";
+    }
+    else
+    {
+      stream << "  <pose>0.1 0 0 0 0 0</pose>\n";
+    }
+    stream << "</frame>\n";
+  }
+
+  if (_options.pluginPayloadSize > 0)
+  {
+    stream << "<plugin name='payload' filename='payload'>\n"
+           << "  <data>" << std::string(_options.pluginPayloadSize, 'x')
+           << "</data>\n"
+           << "</plugin>\n";
+  }
+
+  if (_depth > 0)
+  {
+    stream << "<model name='nested'>\n"
+           << "  <pose>1 0 0 0 0 0</pose>\n"
+           << syntheticModelContent(_options, _depth - 1)
+           << "</model>\n";
+  }
+
+  return stream.str();
+}
+
+/// \brief Generate a world with the dimensions of a SyntheticWorldOptions.
+/// \param[in] _options Parameters of the world.
+/// \param[in] _includeUri URI of the model to include
+/// SyntheticWorldOptions::includeFanOut times, such as the path returned by
+/// writeSyntheticModel. Nothing is included if it is empty.
+/// \return The world as an SDFormat string.
+inline std::string syntheticWorld(const SyntheticWorldOptions &_options,
+    const std::string &_includeUri = "")
+{
+  std::ostringstream stream;
+  stream << "<?xml version='1.0'?>\n"
+         << "<sdf version='" << _options.version << "'>\n"
+         << "<world name='default'>\n";
+
+  const std::string content =
+      syntheticModelContent(_options, _options.nestingDepth);
+  for (int i = 0; i < _options.modelCount; ++i)
+  {
+    stream << "<model name='model_" << i << "'>\n"
+           << "  <pose>" << i << " 0 0 0 0 0</pose>\n"
+           << content
+           << "</model>\n";
+  }
+
+  if (!_includeUri.empty())
+  {
+    for (int i = 0; i < _options.includeFanOut; ++i)
+    {
+      stream << "<include>\n"
+             << "  <uri>" << _includeUri << "</uri>\n"
+             << "  <name>included_" << i << "</name>\n"
+             << "  <pose>" << i << " 1 0 0 0 0</pose>\n"
+             << "</include>\n";
+    }
+  }
+
+  stream << "</world>\n"
+         << "</sdf>\n";
+  return stream.str();
+}
+
+/// \brief Generate a URDF robot made of a chain of links.
+/// \param[in] _linkCount Number of links in the chain.
+/// \param[in] _fixed True to connect the links with fixed joints, which
+/// are reduced during conversion, false to use revolute joints.
+/// \return The robot as a URDF string.
+inline std::string syntheticUrdfChain(int _linkCount, bool _fixed)
+{
+  std::ostringstream stream;
+  stream << "<?xml version='1.0'?>\n"
+         << "<robot name='chain'>\n";
+
+  for (int i = 0; i < _linkCount; ++i)
+  {
+    stream << "<link name='link_" << i << "'>\n"
+           << "  <inertial>\n"
+           << "    <origin xyz='0 0 0.5' rpy='0 0 0'/>\n"
+           << "    <mass value='1'/>\n"
+           << "    <inertia ixx='0.1' ixy='0' ixz='0' iyy='0.1' iyz='0'"
+           << " izz='0.1'/>\n"
+           << "  </inertial>\n"
+           << "  <visual>\n"
+           << "    <geometry><box size='0.1 0.1 1'/></geometry>\n"
+           << "  </visual>\n"
+           << "  <collision>\n"
+           << "    <geometry><box size='0.1 0.1 1'/></geometry>\n"
+           << "  </collision>\n"
+           << "</link>\n";
+
+    if (i > 0)
+    {
+      stream << "<joint name='joint_" << i << "' type='"
+             << (_fixed ? "fixed" : "revolute") << "'>\n"
+             << "  <parent link='link_" << i - 1 << "'/>\n"
+             << "  <child link='link_" << i << "'/>\n"
+             << "  <origin xyz='0 0 1' rpy='0 0 0'/>\n";
+      if (!_fixed)
+      {
+        stream << "  <axis xyz='0 1 0'/>\n"
+               << "  <limit lower='-1' upper='1' effort='10' velocity='1'/>\n";
+      }
+      stream << "</joint>\n";
+    }
+  }
+
+  stream << "</robot>\n";
+  return stream.str();
+}
+
+/// \brief Write a string to a file in the benchmark output directory.
+/// \param[in] _name File name.
+/// \param[in] _content Content of the file.
+/// \return Full path to the file, or an empty string on failure.
+inline std::string writeBenchmarkFile(const std::string &_name,
+    const std::string &_content)
+{
+  const std::string dir =
+      sdf::filesystem::append(PROJECT_BINARY_DIR, "benchmark_files");
+  if (!sdf::filesystem::exists(dir) && !sdf::filesystem::create_directory(dir))
+    return "";
+
+  const std::string path = sdf::filesystem::append(dir, _name);
+  std::ofstream file(path);
+  file << _content;
+  return file ? path : "";
+}
+
+/// \brief Write a synthetic model directory, with a model.config and a
+/// model.sdf, to the benchmark output directory, so that it can be
+/// included by a world.
+/// \param[in] _name Name of the model and of its directory.
+/// \param[in] _options Parameters of the model. The model count and include
+/// fan-out are not used.
+/// \return Full path to the model directory, or an empty string on
+/// failure.
+inline std::string writeSyntheticModel(const std::string &_name,
+    const SyntheticWorldOptions &_options)
+{
+  const std::string dir =
+      sdf::filesystem::append(PROJECT_BINARY_DIR, "benchmark_files");
+  const std::string modelDir = sdf::filesystem::append(dir, _name);
+  if ((!sdf::filesystem::exists(dir) &&
+       !sdf::filesystem::create_directory(dir)) ||
+      (!sdf::filesystem::exists(modelDir) &&
+       !sdf::filesystem::create_directory(modelDir)))
+  {
+    return "";
+  }
+
+  std::ofstream config(sdf::filesystem::append(modelDir, "model.config"));
+  config << "<?xml version='1.0'?>\n"
+         << "<model>\n"
+         << "  <name>" << _name << "</name>\n"
+         << "  <version>1.0</version>\n"
+         << "  <sdf version='" << _options.version
+         << "'>model.sdf</sdf>\n"
+         << "</model>\n";
+
+  std::ofstream model(sdf::filesystem::append(modelDir, "model.sdf"));
+  model << "<?xml version='1.0'?>\n"
+        << "<sdf version='" << _options.version << "'>\n"
+        << "<model name='" << _name << "'>\n"
+        << syntheticModelContent(_options, _options.nestingDepth)
+        << "</model>\n"
+        << "</sdf>\n";
+
+  return config && model ? modelDir : "";
+}
+
+/// \brief Write a synthetic world, and the model it includes if any, to the
+/// benchmark output directory.
+/// \param[in] _name Base name of the files, without extension.
+/// \param[in] _options Parameters of the world.
+/// \return Full path to the world file, or an empty string on failure.
+inline std::string syntheticCorpus(const std::string &_name,
+    const SyntheticWorldOptions &_options)
+{
+  std::string includeUri;
+  if (_options.includeFanOut > 0)
+  {
+    includeUri = writeSyntheticModel(_name + "_model", _options);
+    if (includeUri.empty())
+      return "";
+  }
+  return writeBenchmarkFile(_name + ".sdf",
+      syntheticWorld(_options, includeUri));
+}
+
+#endif
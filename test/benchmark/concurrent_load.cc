@@ -0,0 +1,71 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <cstdint>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "sdf/ParserConfig.hh"
+#include "sdf/Root.hh"
+
+#include "benchmark_utils.hh"
+
+/////////////////////////////////////////////////
+/// \brief Load distinct worlds from every thread at once, to measure how
+/// the throughput of loading scales with threads that share the spec
+/// descriptions, the include cache, the find file state and the console.
+/// Every world includes the same model from disk, and has a comment of its
+/// own so that no two documents are the same. Items per second is the
+/// number of worlds loaded by all the threads.
+///
+/// Built with SDFORMAT_THREAD_SANITIZER, this also checks the shared state
+/// for races, like INTEGRATION_concurrent_load.
+static void BM_ConcurrentLoad(benchmark::State &_state)
+{
+  // Written by the first thread to get here, and read by the others.
+  static const std::string modelDir =
+      writeSyntheticModel("concurrent_model", SyntheticWorldOptions());
+  if (modelDir.empty())
+  {
+    _state.SkipWithError("Failed to write the included model");
+    return;
+  }
+
+  SyntheticWorldOptions options;
+  options.modelCount = 10;
+  options.includeFanOut = 2;
+  const std::string world = syntheticWorld(options, modelDir);
+  const std::string tag =
+      "<!-- thread " + std::to_string(_state.thread_index()) + " load ";
+
+  sdf::ParserConfig config;
+  int64_t loads = 0;
+  for (auto _ : _state)
+  {
+    sdf::Root root;
+    if (!root.LoadSdfString(
+          world + tag + std::to_string(loads++) + " -->\n", config).empty())
+    {
+      _state.SkipWithError("sdf::Root::LoadSdfString failed");
+      break;
+    }
+  }
+  _state.SetItemsProcessed(loads);
+}
+BENCHMARK(BM_ConcurrentLoad)->ThreadRange(1, 64)->UseRealTime()
+  ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,61 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "sdf/SDFImpl.hh"
+#include "sdf/parser.hh"
+
+#include "benchmark_utils.hh"
+
+/////////////////////////////////////////////////
+/// \brief Convert a synthetic SDFormat 1.4 world to the latest version,
+/// which runs every conversion step from 1.4 to 1.8, and read the result.
+static void BM_ConvertString(benchmark::State &_state)
+{
+  const std::string world =
+      syntheticWorld(static_cast<int>(_state.range(0)), "1.4", false);
+  for (auto _ : _state)
+  {
+    sdf::SDFPtr sdfParsed(new sdf::SDF());
+    sdf::init(sdfParsed);
+    if (!sdf::convertString(world, SDF_PROTOCOL_VERSION, sdfParsed))
+      _state.SkipWithError("sdf::convertString failed");
+  }
+}
+BENCHMARK(BM_ConvertString)->Arg(10)->Arg(100)->Arg(1000)
+  ->Unit(benchmark::kMillisecond);
+
+/////////////////////////////////////////////////
+/// \brief Read the same world written in the latest version, as a baseline
+/// for BM_ConvertString. The difference is the cost of the conversion.
+static void BM_ConvertStringBaseline(benchmark::State &_state)
+{
+  const std::string world = syntheticWorld(
+      static_cast<int>(_state.range(0)), SDF_PROTOCOL_VERSION, false);
+  for (auto _ : _state)
+  {
+    sdf::SDFPtr sdfParsed(new sdf::SDF());
+    sdf::init(sdfParsed);
+    if (!sdf::readString(world, sdfParsed))
+      _state.SkipWithError("sdf::readString failed");
+  }
+}
+BENCHMARK(BM_ConvertStringBaseline)->Arg(10)->Arg(100)->Arg(1000)
+  ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,362 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "sdf/Root.hh"
+#include "sdf/World.hh"
+
+#include "FrameSemantics.hh"
+#include "ScopedGraph.hh"
+#include "benchmark_utils.hh"
+
+/////////////////////////////////////////////////
+/// \brief Build and validate the frame attached-to graph of a world.
+static void BM_FrameAttachedToGraph(benchmark::State &_state)
+{
+  sdf::Root root;
+  if (!root.LoadSdfString(
+        syntheticWorld(static_cast<int>(_state.range(0)))).empty())
+  {
+    _state.SkipWithError("sdf::Root::LoadSdfString failed");
+    return;
+  }
+  const sdf::World *world = root.WorldByIndex(0);
+
+  for (auto _ : _state)
+  {
+    auto ownedGraph = std::make_shared<sdf::FrameAttachedToGraph>();
+    sdf::ScopedGraph<sdf::FrameAttachedToGraph> graph(ownedGraph);
+    if (!sdf::buildFrameAttachedToGraph(graph, world).empty() ||
+        !sdf::validateFrameAttachedToGraph(graph).empty())
+    {
+      _state.SkipWithError("Invalid frame attached-to graph");
+    }
+  }
+}
+BENCHMARK(BM_FrameAttachedToGraph)->Arg(10)->Arg(100)->Arg(1000)
+  ->Unit(benchmark::kMillisecond);
+
+/////////////////////////////////////////////////
+/// \brief Build and validate the pose relative-to graph of a world.
+static void BM_PoseRelativeToGraph(benchmark::State &_state)
+{
+  sdf::Root root;
+  if (!root.LoadSdfString(
+        syntheticWorld(static_cast<int>(_state.range(0)))).empty())
+  {
+    _state.SkipWithError("sdf::Root::LoadSdfString failed");
+    return;
+  }
+  const sdf::World *world = root.WorldByIndex(0);
+
+  for (auto _ : _state)
+  {
+    auto ownedGraph = std::make_shared<sdf::PoseRelativeToGraph>();
+    sdf::ScopedGraph<sdf::PoseRelativeToGraph> graph(ownedGraph);
+    if (!sdf::buildPoseRelativeToGraph(graph, world).empty() ||
+        !sdf::validatePoseRelativeToGraph(graph).empty())
+    {
+      _state.SkipWithError("Invalid pose relative-to graph");
+    }
+  }
+}
+BENCHMARK(BM_PoseRelativeToGraph)->Arg(10)->Arg(100)->Arg(1000)
+  ->Unit(benchmark::kMillisecond);
+
+/////////////////////////////////////////////////
+/// \brief Load the world of the graph benchmarks below, whose arguments
+/// are the number of models, the nesting depth of the models, the length
+/// of the chain of frames in every model and nested model, and the
+/// percentage of those frames with an explicit relative_to, see
+/// SyntheticWorldOptions.
+/// \param[in,out] _state Benchmark state.
+/// \param[out] _root Root to load.
+/// \return The world, or nullptr if it failed to load.
+static const sdf::World *loadGraphWorld(benchmark::State &_state,
+    sdf::Root &_root)
+{
+  SyntheticWorldOptions options;
+  options.modelCount = static_cast<int>(_state.range(0));
+  options.nestingDepth = static_cast<int>(_state.range(1));
+  options.linksPerModel = 1;
+  options.frameChainLength = static_cast<int>(_state.range(2));
+  options.relativeToPercent = static_cast<int>(_state.range(3));
+  if (!_root.LoadSdfString(syntheticWorld(options)).empty())
+  {
+    _state.SkipWithError("sdf::Root::LoadSdfString failed");
+    return nullptr;
+  }
+  return _root.WorldByIndex(0);
+}
+
+/////////////////////////////////////////////////
+/// \brief Get the scoped names of the last frame of the chain of every
+/// model and nested model, which are the vertices with the longest paths.
+/// \param[in] _state Benchmark state with the arguments of loadGraphWorld.
+/// \return The names of the vertices, relative to the world scope.
+static std::vector<std::string> chainEnds(const benchmark::State &_state)
+{
+  const int chain = static_cast<int>(_state.range(2));
+  const std::string end =
+      chain > 0 ? "frame_" + std::to_string(chain - 1) : "link_0";
+
+  std::vector<std::string> names;
+  for (int i = 0; i < _state.range(0); ++i)
+  {
+    std::string scope = "model_" + std::to_string(i);
+    for (int depth = 0; depth <= _state.range(1); ++depth)
+    {
+      names.push_back(scope + "::" + end);
+      scope += "::nested";
+    }
+  }
+  return names;
+}
+
+/////////////////////////////////////////////////
+/// \brief Report the size of a graph as counters.
+/// \param[in,out] _state Benchmark state.
+/// \param[in] _graph Graph.
+template <typename T>
+static void countVertices(benchmark::State &_state,
+    const sdf::ScopedGraph<T> &_graph)
+{
+  _state.counters["vertices"] =
+      static_cast<double>(_graph.Graph().Vertices().size());
+  _state.counters["edges"] =
+      static_cast<double>(_graph.Graph().Edges().size());
+}
+
+/// \brief Models, nesting depth, frame chain length and percentage of
+/// explicit relative_to of the graph benchmarks. Each group varies one of
+/// them.
+static void graphArguments(benchmark::internal::Benchmark *_benchmark)
+{
+  _benchmark->ArgNames({"models", "depth", "chain", "relative_to%"});
+  for (int models : {10, 100, 1000})
+    _benchmark->Args({models, 0, 8, 100});
+  for (int depth : {1, 4, 16})
+    _benchmark->Args({100, depth, 8, 100});
+  for (int chain : {0, 32, 128})
+    _benchmark->Args({100, 0, chain, 100});
+  for (int percent : {0, 50})
+    _benchmark->Args({100, 0, 8, percent});
+  _benchmark->Unit(benchmark::kMicrosecond);
+}
+
+/////////////////////////////////////////////////
+/// \brief Build the frame attached-to graph of a world, without validating
+/// it.
+static void BM_BuildFrameAttachedToGraph(benchmark::State &_state)
+{
+  sdf::Root root;
+  const sdf::World *world = loadGraphWorld(_state, root);
+  if (!world)
+    return;
+
+  for (auto _ : _state)
+  {
+    auto ownedGraph = std::make_shared<sdf::FrameAttachedToGraph>();
+    sdf::ScopedGraph<sdf::FrameAttachedToGraph> graph(ownedGraph);
+    if (!sdf::buildFrameAttachedToGraph(graph, world).empty())
+      _state.SkipWithError("buildFrameAttachedToGraph failed");
+    benchmark::DoNotOptimize(ownedGraph);
+  }
+}
+BENCHMARK(BM_BuildFrameAttachedToGraph)->Apply(graphArguments);
+
+/////////////////////////////////////////////////
+/// \brief Validate the frame attached-to graph of a world.
+static void BM_ValidateFrameAttachedToGraph(benchmark::State &_state)
+{
+  sdf::Root root;
+  const sdf::World *world = loadGraphWorld(_state, root);
+  if (!world)
+    return;
+
+  auto ownedGraph = std::make_shared<sdf::FrameAttachedToGraph>();
+  sdf::ScopedGraph<sdf::FrameAttachedToGraph> graph(ownedGraph);
+  if (!sdf::buildFrameAttachedToGraph(graph, world).empty())
+  {
+    _state.SkipWithError("buildFrameAttachedToGraph failed");
+    return;
+  }
+  countVertices(_state, graph);
+
+  for (auto _ : _state)
+  {
+    if (!sdf::validateFrameAttachedToGraph(graph).empty())
+      _state.SkipWithError("validateFrameAttachedToGraph failed");
+  }
+}
+BENCHMARK(BM_ValidateFrameAttachedToGraph)->Apply(graphArguments);
+
+/////////////////////////////////////////////////
+/// \brief Build the pose relative-to graph of a world, without validating
+/// it.
+static void BM_BuildPoseRelativeToGraph(benchmark::State &_state)
+{
+  sdf::Root root;
+  const sdf::World *world = loadGraphWorld(_state, root);
+  if (!world)
+    return;
+
+  for (auto _ : _state)
+  {
+    auto ownedGraph = std::make_shared<sdf::PoseRelativeToGraph>();
+    sdf::ScopedGraph<sdf::PoseRelativeToGraph> graph(ownedGraph);
+    if (!sdf::buildPoseRelativeToGraph(graph, world).empty())
+      _state.SkipWithError("buildPoseRelativeToGraph failed");
+    benchmark::DoNotOptimize(ownedGraph);
+  }
+}
+BENCHMARK(BM_BuildPoseRelativeToGraph)->Apply(graphArguments);
+
+/////////////////////////////////////////////////
+/// \brief Validate the pose relative-to graph of a world.
+static void BM_ValidatePoseRelativeToGraph(benchmark::State &_state)
+{
+  sdf::Root root;
+  const sdf::World *world = loadGraphWorld(_state, root);
+  if (!world)
+    return;
+
+  auto ownedGraph = std::make_shared<sdf::PoseRelativeToGraph>();
+  sdf::ScopedGraph<sdf::PoseRelativeToGraph> graph(ownedGraph);
+  if (!sdf::buildPoseRelativeToGraph(graph, world).empty())
+  {
+    _state.SkipWithError("buildPoseRelativeToGraph failed");
+    return;
+  }
+  countVertices(_state, graph);
+
+  for (auto _ : _state)
+  {
+    if (!sdf::validatePoseRelativeToGraph(graph).empty())
+      _state.SkipWithError("validatePoseRelativeToGraph failed");
+  }
+}
+BENCHMARK(BM_ValidatePoseRelativeToGraph)->Apply(graphArguments);
+
+/////////////////////////////////////////////////
+/// \brief Resolve the body of the end of every chain of frames. The sinks
+/// found are cached in the graph, so unless _cold is set the graph is only
+/// built once and the cached sinks are measured. With _cold, a new graph is
+/// built, untimed, for every iteration.
+static void BM_ResolveFrameAttachedToBody(benchmark::State &_state,
+    bool _cold)
+{
+  sdf::Root root;
+  const sdf::World *world = loadGraphWorld(_state, root);
+  if (!world)
+    return;
+  const std::vector<std::string> names = chainEnds(_state);
+
+  auto build = [world](sdf::ScopedGraph<sdf::FrameAttachedToGraph> &_graph)
+  {
+    _graph = sdf::ScopedGraph<sdf::FrameAttachedToGraph>(
+        std::make_shared<sdf::FrameAttachedToGraph>());
+    return sdf::buildFrameAttachedToGraph(_graph, world).empty();
+  };
+
+  sdf::ScopedGraph<sdf::FrameAttachedToGraph> graph;
+  if (!build(graph))
+  {
+    _state.SkipWithError("buildFrameAttachedToGraph failed");
+    return;
+  }
+
+  std::string body;
+  for (auto _ : _state)
+  {
+    if (_cold)
+    {
+      _state.PauseTiming();
+      build(graph);
+      _state.ResumeTiming();
+    }
+    for (const std::string &name : names)
+    {
+      if (!sdf::resolveFrameAttachedToBody(body, graph, name).empty())
+        _state.SkipWithError("resolveFrameAttachedToBody failed");
+    }
+  }
+  _state.SetItemsProcessed(
+      _state.iterations() * static_cast<int64_t>(names.size()));
+}
+BENCHMARK_CAPTURE(BM_ResolveFrameAttachedToBody, warm, false)
+  ->Apply(graphArguments);
+BENCHMARK_CAPTURE(BM_ResolveFrameAttachedToBody, cold, true)
+  ->Apply(graphArguments);
+
+/////////////////////////////////////////////////
+/// \brief Resolve the pose of the end of every chain of frames relative to
+/// its top level model. Resolved poses are cached in the graph, so as for
+/// BM_ResolveFrameAttachedToBody, _cold builds a new graph, untimed, for
+/// every iteration.
+static void BM_ResolvePose(benchmark::State &_state, bool _cold)
+{
+  sdf::Root root;
+  const sdf::World *world = loadGraphWorld(_state, root);
+  if (!world)
+    return;
+  const std::vector<std::string> names = chainEnds(_state);
+  std::vector<std::string> models;
+  for (const std::string &name : names)
+    models.push_back(name.substr(0, name.find("::")));
+
+  auto build = [world](sdf::ScopedGraph<sdf::PoseRelativeToGraph> &_graph)
+  {
+    _graph = sdf::ScopedGraph<sdf::PoseRelativeToGraph>(
+        std::make_shared<sdf::PoseRelativeToGraph>());
+    return sdf::buildPoseRelativeToGraph(_graph, world).empty();
+  };
+
+  sdf::ScopedGraph<sdf::PoseRelativeToGraph> graph;
+  if (!build(graph))
+  {
+    _state.SkipWithError("buildPoseRelativeToGraph failed");
+    return;
+  }
+
+  ignition::math::Pose3d pose;
+  for (auto _ : _state)
+  {
+    if (_cold)
+    {
+      _state.PauseTiming();
+      build(graph);
+      _state.ResumeTiming();
+    }
+    for (std::size_t i = 0; i < names.size(); ++i)
+    {
+      if (!sdf::resolvePose(pose, graph, names[i], models[i]).empty())
+        _state.SkipWithError("resolvePose failed");
+    }
+  }
+  _state.SetItemsProcessed(
+      _state.iterations() * static_cast<int64_t>(names.size()));
+}
+BENCHMARK_CAPTURE(BM_ResolvePose, warm, false)->Apply(graphArguments);
+BENCHMARK_CAPTURE(BM_ResolvePose, cold, true)->Apply(graphArguments);
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "benchmark_utils.hh"
+
+/////////////////////////////////////////////////
+/// \brief Print the usage of the tool.
+/// \param[in] _program Name of the executable.
+static void usage(const char *_program)
+{
+  std::cerr << "Usage: " << _program << " NAME [options]\n"
+            << "Write the synthetic world NAME.sdf, and the model it "
+            << "includes if any, to " << PROJECT_BINARY_DIR
+            << "/benchmark_files.\n\n"
+            << "Options:\n"
+            << "  --models N    Number of models (default 10)\n"
+            << "  --depth N     Levels of nested models (default 0)\n"
+            << "  --links N     Links per model (default 2)\n"
+            << "  --includes N  Includes of a shared model (default 0)\n"
+            << "  --frames N    Length of frame chains (default 0)\n"
+            << "  --payload N   Plugin payload size in bytes (default 0)\n"
+            << "  --version V   SDFormat version (default "
+            << SDF_PROTOCOL_VERSION << ")\n";
+}
+
+/////////////////////////////////////////////////
+int main(int _argc, char **_argv)
+{
+  if (_argc < 2 || _argc % 2 != 0)
+  {
+    usage(_argv[0]);
+    return 1;
+  }
+
+  SyntheticWorldOptions options;
+  for (int i = 2; i + 1 < _argc; i += 2)
+  {
+    const std::string option = _argv[i];
+    const char *value = _argv[i + 1];
+    if (option == "--models")
+      options.modelCount = std::atoi(value);
+    else if (option == "--depth")
+      options.nestingDepth = std::atoi(value);
+    else if (option == "--links")
+      options.linksPerModel = std::atoi(value);
+    else if (option == "--includes")
+      options.includeFanOut = std::atoi(value);
+    else if (option == "--frames")
+      options.frameChainLength = std::atoi(value);
+    else if (option == "--payload")
+      options.pluginPayloadSize = std::strtoul(value, nullptr, 10);
+    else if (option == "--version")
+      options.version = value;
+    else
+    {
+      std::cerr << "Unknown option [" << option << "]\n";
+      usage(_argv[0]);
+      return 1;
+    }
+  }
+
+  const std::string path = syntheticCorpus(_argv[1], options);
+  if (path.empty())
+  {
+    std::cerr << "Failed to write the corpus\n";
+    return 1;
+  }
+  std::cout << path << "\n";
+  return 0;
+}
@@ -0,0 +1,268 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "sdf/Param.hh"
+#include "sdf/ParserConfig.hh"
+#include "sdf/ParserContext.hh"
+#include "sdf/Root.hh"
+#include "sdf/SDFImpl.hh"
+#include "sdf/parser.hh"
+
+#include "benchmark_utils.hh"
+
+/////////////////////////////////////////////////
+/// \brief Path to a synthetic world file with the given number of models.
+/// \param[in] _modelCount Number of models.
+/// \return Path to the file.
+static std::string worldFile(int _modelCount)
+{
+  return writeBenchmarkFile(
+      "world_" + std::to_string(_modelCount) + ".sdf",
+      syntheticWorld(_modelCount));
+}
+
+/////////////////////////////////////////////////
+/// \brief Initialize the SDF description from the embedded spec files.
+static void BM_Init(benchmark::State &_state)
+{
+  for (auto _ : _state)
+  {
+    sdf::SDFPtr sdfParsed(new sdf::SDF());
+    if (!sdf::init(sdfParsed))
+      _state.SkipWithError("sdf::init failed");
+  }
+}
+BENCHMARK(BM_Init)->Unit(benchmark::kMicrosecond);
+
+/////////////////////////////////////////////////
+/// \brief Read a synthetic world into an element tree.
+static void BM_ReadFile(benchmark::State &_state)
+{
+  const std::string filename = worldFile(static_cast<int>(_state.range(0)));
+  for (auto _ : _state)
+  {
+    sdf::SDFPtr sdfParsed(new sdf::SDF());
+    sdf::init(sdfParsed);
+    sdf::Errors errors;
+    if (!sdf::readFile(filename, sdfParsed, errors))
+      _state.SkipWithError("sdf::readFile failed");
+  }
+}
+BENCHMARK(BM_ReadFile)->Arg(10)->Arg(100)->Arg(1000)->Arg(10000)
+  ->Unit(benchmark::kMillisecond);
+
+/////////////////////////////////////////////////
+/// \brief Read a synthetic world into an element tree, parsing it as a
+/// whole or, with an argument of 1, in parts by all the threads.
+static void BM_ReadFileChunked(benchmark::State &_state)
+{
+  const std::string filename = worldFile(10000);
+  sdf::ParserConfig config;
+  config.SetLoadThreadCount(0);
+  config.SetChunkedXmlParse(_state.range(0) != 0);
+  for (auto _ : _state)
+  {
+    sdf::SDFPtr sdfParsed(new sdf::SDF());
+    sdf::init(sdfParsed);
+    sdf::Errors errors;
+    if (!sdf::readFile(filename, config, sdfParsed, errors))
+      _state.SkipWithError("sdf::readFile failed");
+  }
+}
+BENCHMARK(BM_ReadFileChunked)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond)
+  ->UseRealTime();
+
+/////////////////////////////////////////////////
+/// \brief Read a synthetic world and build its DOM.
+static void BM_RootLoad(benchmark::State &_state)
+{
+  const std::string filename = worldFile(static_cast<int>(_state.range(0)));
+  for (auto _ : _state)
+  {
+    sdf::Root root;
+    if (!root.Load(filename).empty())
+      _state.SkipWithError("sdf::Root::Load failed");
+  }
+}
+BENCHMARK(BM_RootLoad)->Arg(10)->Arg(100)->Arg(1000)->Arg(10000)
+  ->Unit(benchmark::kMillisecond);
+
+/////////////////////////////////////////////////
+/// \brief Build the DOM from an element tree that has already been read.
+static void BM_RootLoadElement(benchmark::State &_state)
+{
+  const std::string filename = worldFile(static_cast<int>(_state.range(0)));
+  sdf::SDFPtr sdfParsed(new sdf::SDF());
+  sdf::init(sdfParsed);
+  sdf::Errors errors;
+  if (!sdf::readFile(filename, sdfParsed, errors))
+  {
+    _state.SkipWithError("sdf::readFile failed");
+    return;
+  }
+
+  for (auto _ : _state)
+  {
+    sdf::Root root;
+    if (!root.Load(sdfParsed).empty())
+      _state.SkipWithError("sdf::Root::Load failed");
+  }
+}
+BENCHMARK(BM_RootLoadElement)->Arg(10)->Arg(100)->Arg(1000)->Arg(10000)
+  ->Unit(benchmark::kMillisecond);
+
+/////////////////////////////////////////////////
+/// \brief Load 10000 small models in a row, like a spawn service, with
+/// Root::LoadSdfString when the argument is 0 and with one ParserContext
+/// when it is 1.
+static void BM_SmallModelLoads(benchmark::State &_state)
+{
+  const SyntheticWorldOptions options;
+  const std::string sdf =
+      "<sdf version='" + options.version + "'><model name='spawned'>" +
+      syntheticModelContent(options, 0) + "</model></sdf>";
+  const bool useContext = _state.range(0) != 0;
+
+  sdf::ParserConfig config;
+  config.SetReleaseElements(true);
+  sdf::ParserContext context(config);
+  for (auto _ : _state)
+  {
+    for (int i = 0; i < 10000; ++i)
+    {
+      sdf::Root root;
+      const sdf::Errors errors = useContext ?
+          context.LoadSdfString(sdf, root) : root.LoadSdfString(sdf, config);
+      if (!errors.empty())
+      {
+        _state.SkipWithError("loading a small model failed");
+        return;
+      }
+    }
+  }
+  _state.SetItemsProcessed(_state.iterations() * 10000);
+}
+BENCHMARK(BM_SmallModelLoads)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+/////////////////////////////////////////////////
+/// \brief Serialize an element tree back to a string.
+static void BM_ElementToString(benchmark::State &_state)
+{
+  const std::string filename = worldFile(static_cast<int>(_state.range(0)));
+  sdf::SDFPtr sdfParsed(new sdf::SDF());
+  sdf::init(sdfParsed);
+  sdf::Errors errors;
+  if (!sdf::readFile(filename, sdfParsed, errors))
+  {
+    _state.SkipWithError("sdf::readFile failed");
+    return;
+  }
+
+  for (auto _ : _state)
+  {
+    benchmark::DoNotOptimize(sdfParsed->Root()->ToString(""));
+  }
+}
+BENCHMARK(BM_ElementToString)->Arg(10)->Arg(100)->Arg(1000)->Arg(10000)
+  ->Unit(benchmark::kMillisecond);
+
+/////////////////////////////////////////////////
+/// \brief Write an element tree to a file with SDF::Write.
+static void BM_SDFWrite(benchmark::State &_state)
+{
+  const int modelCount = static_cast<int>(_state.range(0));
+  const std::string filename = worldFile(modelCount);
+  sdf::SDFPtr sdfParsed(new sdf::SDF());
+  sdf::init(sdfParsed);
+  sdf::Errors errors;
+  if (!sdf::readFile(filename, sdfParsed, errors))
+  {
+    _state.SkipWithError("sdf::readFile failed");
+    return;
+  }
+
+  const std::string output = writeBenchmarkFile(
+      "write_" + std::to_string(modelCount) + ".sdf", "");
+  if (output.empty())
+  {
+    _state.SkipWithError("Unable to create the output file");
+    return;
+  }
+
+  for (auto _ : _state)
+  {
+    sdfParsed->Write(output);
+  }
+}
+BENCHMARK(BM_SDFWrite)->Arg(1000)->Arg(10000)
+  ->Unit(benchmark::kMillisecond);
+
+/////////////////////////////////////////////////
+/// \brief Format pose and double parameters as strings.
+static void BM_ParamGetAsString(benchmark::State &_state)
+{
+  sdf::Param pose("pose", "pose", "1.5 -2 0.25 0.1 -0.2 3", false);
+  sdf::Param scalar("mass", "double", "0.333333", false);
+  for (auto _ : _state)
+  {
+    benchmark::DoNotOptimize(pose.GetAsString());
+    benchmark::DoNotOptimize(scalar.GetAsString());
+  }
+}
+BENCHMARK(BM_ParamGetAsString);
+
+/////////////////////////////////////////////////
+/// \brief Read parameters as another numeric type than the one they hold.
+static void BM_ParamCrossTypeGet(benchmark::State &_state)
+{
+  sdf::Param count("count", "int", "3", false);
+  sdf::Param mass("mass", "double", "0.333333", false);
+  for (auto _ : _state)
+  {
+    double countValue = 0;
+    float massValue = 0;
+    count.Get<double>(countValue);
+    mass.Get<float>(massValue);
+    benchmark::DoNotOptimize(countValue);
+    benchmark::DoNotOptimize(massValue);
+  }
+}
+BENCHMARK(BM_ParamCrossTypeGet);
+
+/////////////////////////////////////////////////
+/// \brief Read values the way DOM loaders do, through keys that name an
+/// attribute, a child element or a missing child with a description.
+static void BM_ElementGet(benchmark::State &_state)
+{
+  sdf::SDFPtr sdfParsed(new sdf::SDF());
+  sdf::init(sdfParsed);
+  sdf::readString(syntheticWorld(1), sdfParsed);
+  sdf::ElementPtr link = sdfParsed->Root()->GetElement("world")
+      ->GetElement("model")->GetElement("link");
+  for (auto _ : _state)
+  {
+    benchmark::DoNotOptimize(link->Get<std::string>("name"));
+    benchmark::DoNotOptimize(link->Get<ignition::math::Pose3d>("pose"));
+    benchmark::DoNotOptimize(link->Get<bool>("gravity", true));
+    benchmark::DoNotOptimize(link->Get<bool>("kinematic", false));
+  }
+}
+BENCHMARK(BM_ElementGet);
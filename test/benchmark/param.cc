@@ -0,0 +1,213 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <any>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <benchmark/benchmark.h>
+#include <ignition/math/Color.hh>
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Quaternion.hh>
+#include <ignition/math/Vector3.hh>
+
+#include "sdf/Param.hh"
+#include "sdf/Types.hh"
+
+/// \brief Type name and value of a parameter of each ParamVariant
+/// alternative that the SDFormat description uses.
+struct ParamCase
+{
+  /// \brief Type name of the parameter.
+  const char *type;
+
+  /// \brief Value of the parameter.
+  const char *value;
+};
+
+/// \brief The cases of the benchmarks, selected by their argument.
+static const ParamCase kParamCases[] =
+{
+  {"bool", "true"},
+  {"int", "12345"},
+  {"double", "0.123456789"},
+  {"string", "ground_plane"},
+  {"vector3", "1.5 -2.25 3.125"},
+  {"pose", "1.5 -2.25 3.125 0.1 0.2 0.3"},
+  {"color", "0.1 0.2 0.3 1"},
+  {"quaternion", "0.1 0.2 0.3"},
+  {"time", "12 500000000"},
+};
+
+/// \brief Number of cases.
+static const int kParamCaseCount =
+    static_cast<int>(sizeof(kParamCases) / sizeof(kParamCases[0]));
+
+/////////////////////////////////////////////////
+/// \brief Make the parameter of the case given by the argument of a
+/// benchmark, and label the benchmark with its type.
+/// \param[in,out] _state State of the benchmark.
+/// \return The parameter, set to the value of the case.
+static sdf::Param paramCase(benchmark::State &_state)
+{
+  const ParamCase &selected = kParamCases[_state.range(0)];
+  _state.SetLabel(selected.type);
+  sdf::Param param("key", selected.type, "", false);
+  if (!param.SetFromString(selected.value))
+    _state.SkipWithError("Param::SetFromString failed");
+  return param;
+}
+
+/////////////////////////////////////////////////
+/// \brief Parse the value of a parameter of each type.
+static void BM_ParamSetFromString(benchmark::State &_state)
+{
+  sdf::Param param = paramCase(_state);
+  const std::string value = kParamCases[_state.range(0)].value;
+  for (auto _ : _state)
+    benchmark::DoNotOptimize(param.SetFromString(value));
+}
+BENCHMARK(BM_ParamSetFromString)->DenseRange(0, kParamCaseCount - 1);
+
+/////////////////////////////////////////////////
+/// \brief Format the value of a parameter of each type.
+static void BM_ParamGetAsString(benchmark::State &_state)
+{
+  const sdf::Param param = paramCase(_state);
+  for (auto _ : _state)
+    benchmark::DoNotOptimize(param.GetAsString());
+}
+BENCHMARK(BM_ParamGetAsString)->DenseRange(0, kParamCaseCount - 1);
+
+/////////////////////////////////////////////////
+/// \brief Clone a parameter of each type.
+static void BM_ParamClone(benchmark::State &_state)
+{
+  const sdf::Param param = paramCase(_state);
+  for (auto _ : _state)
+    benchmark::DoNotOptimize(param.Clone());
+}
+BENCHMARK(BM_ParamClone)->DenseRange(0, kParamCaseCount - 1);
+
+/////////////////////////////////////////////////
+/// \brief Copy a parameter of each type over one with an update function,
+/// which the copy assignment keeps.
+static void BM_ParamCopyAssign(benchmark::State &_state)
+{
+  const sdf::Param param = paramCase(_state);
+  sdf::Param target = param;
+  target.SetUpdateFunc([]() { return std::any(); });
+  for (auto _ : _state)
+  {
+    target = param;
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_ParamCopyAssign)->DenseRange(0, kParamCaseCount - 1);
+
+/////////////////////////////////////////////////
+/// \brief Parse a "double_array" parameter. The argument is the number of
+/// numbers of the list.
+static void BM_ParamSetFromStringDoubleArray(benchmark::State &_state)
+{
+  std::string value;
+  for (int64_t i = 0; i < _state.range(0); ++i)
+    value += std::to_string(0.001 * static_cast<double>(i)) + " ";
+
+  sdf::Param param("key", "double_array", "", false);
+  for (auto _ : _state)
+  {
+    benchmark::DoNotOptimize(param.SetFromString(value));
+    benchmark::DoNotOptimize(param.NumericArray().Data());
+  }
+  _state.SetBytesProcessed(_state.iterations() *
+      static_cast<int64_t>(value.size()));
+}
+BENCHMARK(BM_ParamSetFromStringDoubleArray)->Arg(16)->Arg(1024)
+  ->Arg(65536);
+
+/////////////////////////////////////////////////
+/// \brief Read the value of a parameter with Param::Get, as a type that can
+/// be its own or another one.
+/// \param[in,out] _state State of the benchmark.
+/// \param[in] _type Type name of the parameter.
+/// \param[in] _value Value of the parameter.
+template<typename T>
+static void BM_ParamGet(benchmark::State &_state, const char *_type,
+    const char *_value)
+{
+  sdf::Param param("key", _type, "", false);
+  if (!param.SetFromString(_value))
+  {
+    _state.SkipWithError("Param::SetFromString failed");
+    return;
+  }
+
+  T value;
+  for (auto _ : _state)
+  {
+    benchmark::DoNotOptimize(param.Get(value));
+    benchmark::DoNotOptimize(value);
+  }
+}
+
+/////////////////////////////////////////////////
+/// \brief Register a BM_ParamGet benchmark.
+/// \param[in] _name Name of the case.
+/// \param[in] _type Type name of the parameter.
+/// \param[in] _value Value of the parameter.
+template<typename T>
+static void registerParamGet(const std::string &_name, const char *_type,
+    const char *_value)
+{
+  benchmark::RegisterBenchmark(("BM_ParamGet/" + _name).c_str(),
+      BM_ParamGet<T>, _type, _value);
+}
+
+/// \brief Registration of the BM_ParamGet benchmarks, which
+/// BENCHMARK_CAPTURE can't name after a template.
+static const bool kParamGetRegistered = []()
+{
+  // Each type read as itself.
+  registerParamGet<bool>("bool", "bool", "true");
+  registerParamGet<int>("int", "int", "12345");
+  registerParamGet<double>("double", "double", "0.123456789");
+  registerParamGet<std::string>("string", "string", "ground_plane");
+  registerParamGet<ignition::math::Vector3d>("vector3", "vector3",
+      "1.5 -2.25 3.125");
+  registerParamGet<ignition::math::Pose3d>("pose", "pose",
+      "1.5 -2.25 3.125 0.1 0.2 0.3");
+  registerParamGet<ignition::math::Color>("color", "color",
+      "0.1 0.2 0.3 1");
+  registerParamGet<ignition::math::Quaterniond>("quaternion", "quaternion",
+      "0.1 0.2 0.3");
+  registerParamGet<sdf::Time>("time", "time", "12 500000000");
+
+  // Reads as another type, as the DOM classes and the users of
+  // Element::Get do.
+  registerParamGet<double>("int_as_double", "int", "12345");
+  registerParamGet<float>("double_as_float", "double", "0.123456789");
+  registerParamGet<unsigned int>("int_as_unsigned_int", "int", "12345");
+  registerParamGet<int>("string_as_int", "string", "12345");
+  registerParamGet<bool>("string_as_bool", "string", "true");
+  registerParamGet<std::string>("double_as_string", "double",
+      "0.123456789");
+  registerParamGet<std::string>("pose_as_string", "pose",
+      "1.5 -2.25 3.125 0.1 0.2 0.3");
+  return true;
+}();
@@ -0,0 +1,148 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <chrono>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "sdf/LoadStats.hh"
+#include "sdf/ParserConfig.hh"
+#include "sdf/Root.hh"
+
+#include "benchmark_utils.hh"
+
+/////////////////////////////////////////////////
+/// \brief Load a synthetic corpus with Root::Load, and report the time
+/// spent in each phase of loading per iteration, so that the scaling of
+/// every phase with a dimension of the input can be plotted.
+/// \param[in,out] _state Benchmark state.
+/// \param[in] _name Base name of the corpus files.
+/// \param[in] _options Parameters of the corpus.
+static void loadCorpus(benchmark::State &_state, const std::string &_name,
+    const SyntheticWorldOptions &_options)
+{
+  const std::string filename = syntheticCorpus(
+      _name + "_" + std::to_string(_state.range(0)), _options);
+  if (filename.empty())
+  {
+    _state.SkipWithError("Failed to write the corpus");
+    return;
+  }
+
+  sdf::LoadStats stats;
+  sdf::ParserConfig config;
+  config.SetStats(&stats);
+  for (auto _ : _state)
+  {
+    sdf::Root root;
+    if (!root.Load(filename, config).empty())
+      _state.SkipWithError("sdf::Root::Load failed");
+  }
+
+  for (sdf::LoadPhase phase : {sdf::LoadPhase::XML_PARSE,
+       sdf::LoadPhase::CONVERSION, sdf::LoadPhase::INCLUDE,
+       sdf::LoadPhase::READ_XML, sdf::LoadPhase::DOM_LOAD,
+       sdf::LoadPhase::FRAME_GRAPH_BUILD})
+  {
+    _state.counters[sdf::LoadStats::PhaseName(phase) + "_ms"] =
+        benchmark::Counter(
+          std::chrono::duration<double, std::milli>(
+            stats.Duration(phase)).count(),
+          benchmark::Counter::kAvgIterations);
+  }
+}
+
+/////////////////////////////////////////////////
+/// \brief Scale the number of models of a world.
+static void BM_ScaleModelCount(benchmark::State &_state)
+{
+  SyntheticWorldOptions options;
+  options.modelCount = static_cast<int>(_state.range(0));
+  loadCorpus(_state, "scale_models", options);
+}
+BENCHMARK(BM_ScaleModelCount)->RangeMultiplier(10)->Range(1, 1000)
+  ->Unit(benchmark::kMillisecond);
+
+/////////////////////////////////////////////////
+/// \brief Scale the nesting depth of the models of a world.
+static void BM_ScaleNestingDepth(benchmark::State &_state)
+{
+  SyntheticWorldOptions options;
+  options.nestingDepth = static_cast<int>(_state.range(0));
+  loadCorpus(_state, "scale_nesting", options);
+}
+BENCHMARK(BM_ScaleNestingDepth)->RangeMultiplier(4)->Range(1, 64)
+  ->Unit(benchmark::kMillisecond);
+
+/////////////////////////////////////////////////
+/// \brief Scale the number of links of the models of a world.
+static void BM_ScaleLinksPerModel(benchmark::State &_state)
+{
+  SyntheticWorldOptions options;
+  options.linksPerModel = static_cast<int>(_state.range(0));
+  loadCorpus(_state, "scale_links", options);
+}
+BENCHMARK(BM_ScaleLinksPerModel)->RangeMultiplier(10)->Range(1, 1000)
+  ->Unit(benchmark::kMillisecond);
+
+/////////////////////////////////////////////////
+/// \brief Scale the number of includes of the same model in a world.
+static void BM_ScaleIncludeFanOut(benchmark::State &_state)
+{
+  SyntheticWorldOptions options;
+  options.modelCount = 0;
+  options.includeFanOut = static_cast<int>(_state.range(0));
+  loadCorpus(_state, "scale_includes", options);
+}
+BENCHMARK(BM_ScaleIncludeFanOut)->RangeMultiplier(10)->Range(1, 1000)
+  ->Unit(benchmark::kMillisecond);
+
+/////////////////////////////////////////////////
+/// \brief Scale the length of the frame chains of the models of a world.
+static void BM_ScaleFrameChain(benchmark::State &_state)
+{
+  SyntheticWorldOptions options;
+  options.frameChainLength = static_cast<int>(_state.range(0));
+  loadCorpus(_state, "scale_frames", options);
+}
+BENCHMARK(BM_ScaleFrameChain)->RangeMultiplier(10)->Range(1, 1000)
+  ->Unit(benchmark::kMillisecond);
+
+/////////////////////////////////////////////////
+/// \brief Scale the size of a plugin in every model of a world.
+static void BM_ScalePluginPayload(benchmark::State &_state)
+{
+  SyntheticWorldOptions options;
+  options.pluginPayloadSize = static_cast<std::size_t>(_state.range(0));
+  loadCorpus(_state, "scale_plugins", options);
+}
+BENCHMARK(BM_ScalePluginPayload)->RangeMultiplier(16)->Range(16, 1 << 20)
+  ->Unit(benchmark::kMillisecond);
+
+/////////////////////////////////////////////////
+/// \brief Scale the number of models of a world that has to be converted
+/// from SDFormat 1.6, which has no frames.
+static void BM_ScaleConversion(benchmark::State &_state)
+{
+  SyntheticWorldOptions options;
+  options.modelCount = static_cast<int>(_state.range(0));
+  options.version = "1.6";
+  loadCorpus(_state, "scale_conversion", options);
+}
+BENCHMARK(BM_ScaleConversion)->RangeMultiplier(10)->Range(1, 1000)
+  ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,185 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "sdf/SDFImpl.hh"
+#include "sdf/StateReader.hh"
+#include "sdf/StateWriter.hh"
+#include "sdf/parser.hh"
+
+/////////////////////////////////////////////////
+/// \brief Build the text of one world state.
+/// \param[in] _iteration Iteration of the state.
+/// \param[in] _modelCount Number of models, each with one link.
+/// \return <state> element text.
+static std::string stateText(int _iteration, int _modelCount)
+{
+  std::ostringstream stream;
+  stream << "<state world_name='default'>"
+         << "<sim_time>" << _iteration / 1000 << " "
+         << (_iteration % 1000) * 1000000 << "</sim_time>"
+         << "<iterations>" << _iteration << "</iterations>";
+  for (int m = 0; m < _modelCount; ++m)
+  {
+    stream << "<model name='model_" << m << "'>"
+           << "<pose>" << m << " 0.25 0.5 0 0 0.1</pose>"
+           << "<link name='link'>"
+           << "<pose>" << m << " 0.25 0.5 0 0 0.1</pose>"
+           << "<velocity>0.1 0 0 0 0 0.01</velocity>"
+           << "</link></model>";
+  }
+  stream << "</state>";
+  return stream.str();
+}
+
+/////////////////////////////////////////////////
+/// \brief Read a log of 100 states with StateReader. The argument is the
+/// number of models per state.
+static void BM_StateReader(benchmark::State &_state)
+{
+  const int modelCount = static_cast<int>(_state.range(0));
+  std::string log;
+  for (int i = 0; i < 100; ++i)
+    log += stateText(i, modelCount);
+
+  sdf::StateFrame frame;
+  sdf::Errors errors;
+  for (auto _ : _state)
+  {
+    std::istringstream input(log);
+    sdf::StateReader reader(input);
+    while (reader.Next(frame, errors))
+      benchmark::DoNotOptimize(frame.LinkPoses());
+  }
+  _state.SetBytesProcessed(_state.iterations() *
+      static_cast<int64_t>(log.size()));
+}
+BENCHMARK(BM_StateReader)->Arg(10)->Arg(100)->Arg(1000)
+  ->Unit(benchmark::kMillisecond);
+
+/////////////////////////////////////////////////
+/// \brief Baseline for BM_StateReader: read each state of the same log as
+/// a world with sdf::readString.
+static void BM_StateReadString(benchmark::State &_state)
+{
+  const int modelCount = static_cast<int>(_state.range(0));
+  std::vector<std::string> states;
+  int64_t bytes = 0;
+  for (int i = 0; i < 100; ++i)
+  {
+    states.push_back("<sdf version='1.8'><world name='default'>" +
+        stateText(i, modelCount) + "</world></sdf>");
+    bytes += static_cast<int64_t>(states.back().size());
+  }
+
+  for (auto _ : _state)
+  {
+    for (const std::string &state : states)
+    {
+      sdf::SDFPtr sdfParsed(new sdf::SDF());
+      sdf::init(sdfParsed);
+      if (!sdf::readString(state, sdfParsed))
+        _state.SkipWithError("sdf::readString failed");
+    }
+  }
+  _state.SetBytesProcessed(_state.iterations() * bytes);
+}
+BENCHMARK(BM_StateReadString)->Arg(10)->Arg(100)->Arg(1000)
+  ->Unit(benchmark::kMillisecond);
+
+/////////////////////////////////////////////////
+/// \brief Fill a frame with models that each have one link.
+/// \param[out] _frame Frame to fill.
+/// \param[in] _modelCount Number of models.
+static void fillFrame(sdf::StateFrame &_frame, int _modelCount)
+{
+  _frame.Clear();
+  _frame.SetWorldName("default");
+  for (int m = 0; m < _modelCount; ++m)
+  {
+    const ignition::math::Pose3d pose(m, 0.25, 0.5, 0, 0, 0.1);
+    const std::size_t model =
+        _frame.AddModel("model_" + std::to_string(m), pose);
+    _frame.AddLink(model, "link", pose);
+  }
+}
+
+/////////////////////////////////////////////////
+/// \brief Write 100 states with StateWriter, moving one model in ten in
+/// each state. The argument is the number of models per state.
+static void BM_StateWriter(benchmark::State &_state)
+{
+  const int modelCount = static_cast<int>(_state.range(0));
+  sdf::StateFrame frame;
+  fillFrame(frame, modelCount);
+
+  std::ostringstream output;
+  for (auto _ : _state)
+  {
+    output.str("");
+    sdf::StateWriter writer(output);
+    for (int i = 0; i < 100; ++i)
+    {
+      frame.SetIterations(static_cast<std::uint64_t>(i));
+      for (int m = i % 10; m < modelCount; m += 10)
+        frame.LinkPoses()[m].Pos().Z(0.01 * i);
+      writer.Write(frame);
+    }
+    benchmark::DoNotOptimize(output.tellp());
+  }
+}
+BENCHMARK(BM_StateWriter)->Arg(10)->Arg(100)->Arg(1000)
+  ->Unit(benchmark::kMillisecond);
+
+/////////////////////////////////////////////////
+/// \brief Baseline for BM_StateWriter: build and print the full <state>
+/// element of each state with sdf::Element, as a recorder without
+/// StateWriter would.
+static void BM_StateElementToString(benchmark::State &_state)
+{
+  const int modelCount = static_cast<int>(_state.range(0));
+  sdf::SDFPtr sdfParsed(new sdf::SDF());
+  sdf::init(sdfParsed);
+  if (!sdf::readString(
+        "<sdf version='1.8'><world name='default'>" +
+        stateText(0, modelCount) + "</world></sdf>", sdfParsed))
+  {
+    _state.SkipWithError("sdf::readString failed");
+    return;
+  }
+  sdf::ElementPtr state =
+      sdfParsed->Root()->GetElement("world")->GetElement("state");
+
+  std::ostringstream output;
+  for (auto _ : _state)
+  {
+    output.str("");
+    for (int i = 0; i < 100; ++i)
+    {
+      state->GetElement("iterations")->Set(static_cast<uint64_t>(i));
+      output << state->ToString("");
+    }
+    benchmark::DoNotOptimize(output.tellp());
+  }
+}
+BENCHMARK(BM_StateElementToString)->Arg(10)->Arg(100)->Arg(1000)
+  ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,134 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <sstream>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "sdf/Filesystem.hh"
+#include "sdf/SDFImpl.hh"
+#include "sdf/parser.hh"
+
+#include "benchmark_utils.hh"
+
+/////////////////////////////////////////////////
+/// \brief Convert the Atlas URDF used by the performance tests.
+static void BM_UrdfAtlas(benchmark::State &_state)
+{
+  const std::string filename =
+      sdf::filesystem::append(PROJECT_SOURCE_PATH, "test", "performance",
+                              "parser_urdf_atlas.urdf");
+  for (auto _ : _state)
+  {
+    sdf::SDFPtr sdfParsed(new sdf::SDF());
+    sdf::init(sdfParsed);
+    sdf::Errors errors;
+    if (!sdf::readFile(filename, sdfParsed, errors))
+      _state.SkipWithError("sdf::readFile failed");
+  }
+}
+BENCHMARK(BM_UrdfAtlas)->Unit(benchmark::kMillisecond);
+
+/////////////////////////////////////////////////
+/// \brief Convert a URDF chain of links. The second argument selects fixed
+/// joints, which are reduced into their parent link, or revolute joints.
+static void BM_UrdfChain(benchmark::State &_state)
+{
+  const std::string urdf = syntheticUrdfChain(
+      static_cast<int>(_state.range(0)), _state.range(1) != 0);
+  for (auto _ : _state)
+  {
+    sdf::SDFPtr sdfParsed(new sdf::SDF());
+    sdf::init(sdfParsed);
+    if (!sdf::readString(urdf, sdfParsed))
+      _state.SkipWithError("sdf::readString failed");
+  }
+}
+BENCHMARK(BM_UrdfChain)->ArgsProduct({{10, 100, 1000}, {0, 1}})
+  ->Unit(benchmark::kMillisecond);
+
+/////////////////////////////////////////////////
+/// \brief Build a URDF whose links only carry inertials and form a binary
+/// tree of fixed joints, so that the whole tree is lumped into its root.
+/// \param[in] _depth Depth of the tree.
+/// \return URDF string with 2^_depth - 1 links.
+static std::string fixedUrdfTree(int _depth)
+{
+  std::ostringstream stream;
+  stream << "<?xml version='1.0'?>\n"
+         << "<robot name='tree'>\n";
+  const int linkCount = (1 << _depth) - 1;
+  for (int i = 0; i < linkCount; ++i)
+  {
+    stream << "<link name='link_" << i << "'>\n"
+           << "  <inertial>\n"
+           << "    <origin xyz='0.1 0 0.2' rpy='0 0.3 0'/>\n"
+           << "    <mass value='1'/>\n"
+           << "    <inertia ixx='0.1' ixy='0' ixz='0' iyy='0.2' iyz='0'"
+           << " izz='0.3'/>\n"
+           << "  </inertial>\n"
+           << "</link>\n";
+    if (i > 0)
+    {
+      stream << "<joint name='joint_" << i << "' type='fixed'>\n"
+             << "  <parent link='link_" << (i - 1) / 2 << "'/>\n"
+             << "  <child link='link_" << i << "'/>\n"
+             << "  <origin xyz='0 " << (i % 2 ? 0.5 : -0.5)
+             << " 1' rpy='0.1 0 0.2'/>\n"
+             << "</joint>\n";
+    }
+  }
+  stream << "</robot>\n";
+  return stream.str();
+}
+
+/////////////////////////////////////////////////
+/// \brief Lump the inertials of a fixed joint tree into its root link.
+static void BM_UrdfFixedTreeInertials(benchmark::State &_state)
+{
+  const std::string urdf = fixedUrdfTree(static_cast<int>(_state.range(0)));
+  for (auto _ : _state)
+  {
+    sdf::SDFPtr sdfParsed(new sdf::SDF());
+    sdf::init(sdfParsed);
+    if (!sdf::readString(urdf, sdfParsed))
+      _state.SkipWithError("sdf::readString failed");
+  }
+}
+BENCHMARK(BM_UrdfFixedTreeInertials)->Arg(4)->Arg(8)->Arg(11)
+  ->Unit(benchmark::kMillisecond);
+
+/////////////////////////////////////////////////
+/// \brief Convert independent URDF chains from several threads at once.
+/// Each thread uses its own converter, so the time per conversion should
+/// stay flat as threads are added.
+static void BM_UrdfChainThreaded(benchmark::State &_state)
+{
+  const std::string urdf =
+      syntheticUrdfChain(static_cast<int>(_state.range(0)), true);
+  for (auto _ : _state)
+  {
+    sdf::SDFPtr sdfParsed(new sdf::SDF());
+    sdf::init(sdfParsed);
+    if (!sdf::readString(urdf, sdfParsed))
+      _state.SkipWithError("sdf::readString failed");
+  }
+  _state.SetItemsProcessed(_state.iterations());
+}
+BENCHMARK(BM_UrdfChainThreaded)->Arg(100)->ThreadRange(1, 8)->UseRealTime()
+  ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,149 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "sdf/Filesystem.hh"
+#include "sdf/Model.hh"
+#include "sdf/ParserConfig.hh"
+#include "sdf/Root.hh"
+#include "sdf/SDFImpl.hh"
+#include "sdf/World.hh"
+#include "test_config.h"
+
+// Loads run from many threads at once, each with distinct documents, so
+// that a build with SDFORMAT_THREAD_SANITIZER reports races on the state
+// they share: the spec descriptions, the include cache, the find file
+// callbacks, the converter and the console.
+
+const auto g_modelsPath = sdf::filesystem::append(PROJECT_SOURCE_PATH,
+    "test", "integration", "model");
+
+/////////////////////////////////////////////////
+/// \brief A world of an old version, so that it is converted, that
+/// includes the box model, which is even older.
+/// \param[in] _name Name of the world.
+/// \return The world as an SDFormat string.
+static std::string includingWorld(const std::string &_name)
+{
+  return "<sdf version='1.6'>"
+      "<world name='" + _name + "'>"
+      "  <include>"
+      "    <uri>model://box</uri>"
+      "    <name>box_" + _name + "</name>"
+      "  </include>"
+      "  <model name='" + _name + "'>"
+      "    <link name='base'/>"
+      "    <link name='arm'><pose>0 0 1 0 0 0</pose></link>"
+      "    <joint name='j' type='revolute'>"
+      "      <parent>base</parent><child>arm</child>"
+      "      <axis><xyz>0 0 1</xyz></axis>"
+      "    </joint>"
+      "  </model>"
+      "</world></sdf>";
+}
+
+/////////////////////////////////////////////////
+/// \brief A URDF robot, which is converted with parser_urdf.
+/// \param[in] _name Name of the robot.
+/// \return The robot as a URDF string.
+static std::string urdfRobot(const std::string &_name)
+{
+  return "<robot name='" + _name + "'>"
+      "  <link name='base'>"
+      "    <inertial><mass value='1'/>"
+      "      <inertia ixx='1' ixy='0' ixz='0' iyy='1' iyz='0' izz='1'/>"
+      "    </inertial>"
+      "  </link>"
+      "  <link name='arm'>"
+      "    <inertial><mass value='1'/>"
+      "      <inertia ixx='1' ixy='0' ixz='0' iyy='1' iyz='0' izz='1'/>"
+      "    </inertial>"
+      "  </link>"
+      "  <joint name='j' type='continuous'>"
+      "    <parent link='base'/><child link='arm'/>"
+      "  </joint>"
+      "</robot>";
+}
+
+/////////////////////////////////////////////////
+TEST(ConcurrentLoad, DistinctDocuments)
+{
+  const unsigned int threadCount =
+      std::min(16u, std::max(4u, std::thread::hardware_concurrency()));
+  const int loadsPerThread = 8;
+
+  // The global callback is set before the threads start, and read by all
+  // of them, while their configs each have their own search path.
+  sdf::setFindCallback([](const std::string &_file)
+      {
+        return sdf::filesystem::append(g_modelsPath, _file);
+      });
+
+  std::atomic<int> failures{0};
+  std::vector<std::thread> threads;
+  for (unsigned int t = 0; t < threadCount; ++t)
+  {
+    threads.emplace_back([t, &failures]()
+    {
+      sdf::ParserConfig config;
+      config.AddURIPath("model://", g_modelsPath);
+      for (int i = 0; i < loadsPerThread; ++i)
+      {
+        const std::string name =
+            "w" + std::to_string(t) + "_" + std::to_string(i);
+
+        sdf::Root world;
+        const sdf::Errors errors =
+            world.LoadSdfString(includingWorld(name), config);
+        const sdf::World *dom = world.WorldByIndex(0);
+        if (!errors.empty() || !dom || dom->Name() != name ||
+            dom->ModelCount() != 2u || !dom->ModelNameExists("box_" + name) ||
+            dom->ModelByName(name)->JointCount() != 1u)
+        {
+          ++failures;
+        }
+
+        sdf::Root robot;
+        const sdf::Errors urdfErrors =
+            robot.LoadSdfString(urdfRobot(name), config);
+        const sdf::Model *model = robot.ModelByIndex(0);
+        if (!urdfErrors.empty() || !model || model->Name() != name ||
+            model->LinkCount() != 2u)
+        {
+          ++failures;
+        }
+
+        if (sdf::findFile("box/model.sdf", false, true).empty() ||
+            sdf::findFile("model://box/model.sdf", false, false,
+                          config).empty())
+        {
+          ++failures;
+        }
+      }
+    });
+  }
+  for (std::thread &thread : threads)
+    thread.join();
+
+  EXPECT_EQ(0, failures.load());
+}
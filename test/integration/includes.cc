@@ -15,21 +15,29 @@
  *
  */
 
+#include <fstream>
+#include <future>
 #include <iostream>
+#include <mutex>
+#include <stdexcept>
 #include <string>
+#include <vector>
 #include <gtest/gtest.h>
 
 #include "sdf/Actor.hh"
 #include "sdf/Collision.hh"
 #include "sdf/Filesystem.hh"
+#include "sdf/Frame.hh"
 #include "sdf/Geometry.hh"
 #include "sdf/Light.hh"
 #include "sdf/Link.hh"
 #include "sdf/Mesh.hh"
 #include "sdf/Model.hh"
+#include "sdf/ParserConfig.hh"
 #include "sdf/parser.hh"
 #include "sdf/Root.hh"
 #include "sdf/SDFImpl.hh"
+#include "sdf/SemanticPose.hh"
 #include "sdf/Visual.hh"
 #include "sdf/World.hh"
 #include "test_config.h"
@@ -318,3 +326,505 @@ TEST(IncludesTest, Includes_15_convert)
   EXPECT_EQ("1.6", modelElem->OriginalVersion());
   EXPECT_EQ("1.6", linkElem->OriginalVersion());
 }
+
+//////////////////////////////////////////////////
+TEST(IncludesTest, ParallelIncludes)
+{
+  sdf::setFindCallback(findFileCb);
+
+  const auto worldFile =
+    sdf::filesystem::append(g_testPath, "sdf", "includes.sdf");
+
+  sdf::Root sequentialRoot;
+  sdf::Errors sequentialErrors = sequentialRoot.Load(worldFile);
+  EXPECT_TRUE(sequentialErrors.empty());
+
+  sdf::ParserConfig config;
+  config.SetLoadThreadCount(4u);
+
+  sdf::Root parallelRoot;
+  sdf::Errors parallelErrors = parallelRoot.Load(worldFile, config);
+  EXPECT_TRUE(parallelErrors.empty());
+
+  // Includes are merged in document order, so both documents are the same.
+  ASSERT_NE(nullptr, sequentialRoot.Element());
+  ASSERT_NE(nullptr, parallelRoot.Element());
+  EXPECT_EQ(sequentialRoot.Element()->ToString(""),
+            parallelRoot.Element()->ToString(""));
+
+  const sdf::World *world = parallelRoot.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+  EXPECT_EQ(2u, world->ActorCount());
+  EXPECT_TRUE(world->ActorNameExists("override_actor_name"));
+  EXPECT_TRUE(world->ModelNameExists("override_model_name"));
+}
+
+//////////////////////////////////////////////////
+/// \brief Write a model directory containing a single box link.
+/// \param[in] _dir Model directory, created if needed.
+/// \param[in] _linkName Name of the link in the model.
+void writeCacheTestModel(const std::string &_dir, const std::string &_linkName)
+{
+  sdf::filesystem::create_directory(_dir);
+
+  std::ofstream config(sdf::filesystem::append(_dir, "model.config"));
+  config << "<?xml version='1.0'?>"
+         << "<model><name>cache</name>"
+         << "<sdf version='1.8'>model.sdf</sdf></model>";
+  config.close();
+
+  std::ofstream model(sdf::filesystem::append(_dir, "model.sdf"));
+  model << "<?xml version='1.0'?>"
+        << "<sdf version='1.8'><model name='cache'>"
+        << "<link name='" << _linkName << "'/>"
+        << "</model></sdf>";
+  model.close();
+}
+
+//////////////////////////////////////////////////
+TEST(IncludesTest, IncludeCache)
+{
+  // Changing the find callback empties the cache.
+  sdf::setFindCallback(findFileCb);
+  EXPECT_EQ(0u, sdf::includeCacheSize());
+  EXPECT_EQ(256u, sdf::includeCacheCapacity());
+
+  const auto worldFile =
+    sdf::filesystem::append(g_testPath, "sdf", "includes.sdf");
+
+  sdf::Root root1;
+  EXPECT_TRUE(root1.Load(worldFile).empty());
+  const std::size_t cacheSize = sdf::includeCacheSize();
+  EXPECT_LT(0u, cacheSize);
+
+  // The second load is served from the cache and gives the same document.
+  sdf::Root root2;
+  EXPECT_TRUE(root2.Load(worldFile).empty());
+  EXPECT_EQ(cacheSize, sdf::includeCacheSize());
+  ASSERT_NE(nullptr, root1.Element());
+  ASSERT_NE(nullptr, root2.Element());
+  EXPECT_EQ(root1.Element()->ToString(""), root2.Element()->ToString(""));
+
+  // Loads get their own copies of the cached elements.
+  const sdf::World *world1 = root1.WorldByIndex(0);
+  ASSERT_NE(nullptr, world1);
+  ASSERT_NE(nullptr, world1->ModelByIndex(0));
+  world1->ModelByIndex(0)->Element()->GetAttribute("name")->Set(
+      std::string("changed"));
+
+  sdf::Root root3;
+  EXPECT_TRUE(root3.Load(worldFile).empty());
+  EXPECT_EQ(root2.Element()->ToString(""), root3.Element()->ToString(""));
+
+  // Bound and disable the cache.
+  sdf::setIncludeCacheCapacity(1u);
+  EXPECT_EQ(1u, sdf::includeCacheSize());
+  sdf::setIncludeCacheCapacity(0u);
+  EXPECT_EQ(0u, sdf::includeCacheSize());
+
+  sdf::Root root4;
+  EXPECT_TRUE(root4.Load(worldFile).empty());
+  EXPECT_EQ(0u, sdf::includeCacheSize());
+
+  sdf::setIncludeCacheCapacity(256u);
+  EXPECT_TRUE(root4.Load(worldFile).empty());
+  EXPECT_LT(0u, sdf::includeCacheSize());
+  sdf::clearIncludeCache();
+  EXPECT_EQ(0u, sdf::includeCacheSize());
+}
+
+//////////////////////////////////////////////////
+TEST(IncludesTest, IncludeCacheModifiedFile)
+{
+  const auto modelsDir =
+    sdf::filesystem::append(PROJECT_BINARY_DIR, "include_cache_models");
+  sdf::filesystem::create_directory(modelsDir);
+  const auto modelDir = sdf::filesystem::append(modelsDir, "cache");
+  writeCacheTestModel(modelDir, "link");
+
+  sdf::setFindCallback([modelsDir](const std::string &_file)
+      {
+        return sdf::filesystem::append(modelsDir, _file);
+      });
+
+  const std::string worldString =
+    "<?xml version='1.0'?>"
+    "<sdf version='1.8'><world name='default'>"
+    "  <include><uri>cache</uri><name>first</name></include>"
+    "  <include><uri>cache</uri><name>second</name></include>"
+    "</world></sdf>";
+
+  sdf::Root root1;
+  EXPECT_TRUE(root1.LoadSdfString(worldString).empty());
+  EXPECT_EQ(1u, sdf::includeCacheSize());
+  const sdf::World *world1 = root1.WorldByIndex(0);
+  ASSERT_NE(nullptr, world1);
+  ASSERT_EQ(2u, world1->ModelCount());
+  EXPECT_TRUE(world1->ModelByIndex(1)->LinkNameExists("link"));
+
+  // A file with a different size is read again.
+  writeCacheTestModel(modelDir, "renamed_link");
+
+  sdf::Root root2;
+  EXPECT_TRUE(root2.LoadSdfString(worldString).empty());
+  const sdf::World *world2 = root2.WorldByIndex(0);
+  ASSERT_NE(nullptr, world2);
+  ASSERT_EQ(2u, world2->ModelCount());
+  EXPECT_TRUE(world2->ModelByIndex(0)->LinkNameExists("renamed_link"));
+  EXPECT_TRUE(world2->ModelByIndex(1)->LinkNameExists("renamed_link"));
+
+  sdf::setFindCallback(findFileCb);
+}
+
+//////////////////////////////////////////////////
+TEST(IncludesTest, IncludeCacheModelConfig)
+{
+  const auto modelsDir =
+    sdf::filesystem::append(PROJECT_BINARY_DIR, "include_cache_config");
+  sdf::filesystem::create_directory(modelsDir);
+  const auto modelDir = sdf::filesystem::append(modelsDir, "cache");
+  writeCacheTestModel(modelDir, "link");
+
+  std::ofstream other(sdf::filesystem::append(modelDir, "other.sdf"));
+  other << "<?xml version='1.0'?>"
+        << "<sdf version='1.8'><model name='cache'>"
+        << "<link name='other_link'/>"
+        << "</model></sdf>";
+  other.close();
+
+  sdf::setFindCallback([modelsDir](const std::string &_file)
+      {
+        return sdf::filesystem::append(modelsDir, _file);
+      });
+
+  const std::string worldString =
+    "<?xml version='1.0'?>"
+    "<sdf version='1.8'><world name='default'>"
+    "  <include><uri>cache</uri></include>"
+    "</world></sdf>";
+
+  sdf::Root root1;
+  EXPECT_TRUE(root1.LoadSdfString(worldString).empty());
+  ASSERT_NE(nullptr, root1.WorldByIndex(0));
+  ASSERT_EQ(1u, root1.WorldByIndex(0)->ModelCount());
+  EXPECT_TRUE(root1.WorldByIndex(0)->ModelByIndex(0)->LinkNameExists("link"));
+
+  // Pointing the model.config at another file is seen by the next load.
+  std::ofstream config(sdf::filesystem::append(modelDir, "model.config"));
+  config << "<?xml version='1.0'?>"
+         << "<model><name>cache</name>"
+         << "<sdf version='1.8'>other.sdf</sdf></model>";
+  config.close();
+
+  sdf::Root root2;
+  EXPECT_TRUE(root2.LoadSdfString(worldString).empty());
+  ASSERT_NE(nullptr, root2.WorldByIndex(0));
+  ASSERT_EQ(1u, root2.WorldByIndex(0)->ModelCount());
+  EXPECT_TRUE(
+      root2.WorldByIndex(0)->ModelByIndex(0)->LinkNameExists("other_link"));
+
+  sdf::setFindCallback(findFileCb);
+}
+
+//////////////////////////////////////////////////
+TEST(IncludesTest, AsyncFindCallback)
+{
+  const std::string scheme = "remote://";
+  const std::string modelDir =
+    sdf::filesystem::append(g_testPath, "integration", "model");
+
+  std::mutex mutex;
+  std::vector<std::string> fetched;
+  sdf::ParserConfig config;
+  config.SetAsyncFindCallback(
+      [&](const std::string &_uri)
+      {
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          fetched.push_back(_uri);
+        }
+        return std::async(std::launch::async, [=]()
+            {
+              const std::string name = _uri.substr(scheme.size());
+              if (name == "throws")
+                throw std::runtime_error("server error");
+              if (name == "missing")
+                return std::string();
+              return sdf::filesystem::append(modelDir, name);
+            });
+      });
+  EXPECT_TRUE(static_cast<bool>(config.AsyncFindCallback()));
+
+  const std::string worldString =
+    "<?xml version='1.0'?>"
+    "<sdf version='1.8'><world name='default'>"
+    "  <include><uri>remote://box</uri><name>box1</name></include>"
+    "  <model name='inline'><link name='link'/></model>"
+    "  <include><uri>remote://box</uri><name>box2</name></include>"
+    "  <include><uri>remote://test_model</uri></include>"
+    "  <include><uri>remote://missing</uri></include>"
+    "  <include><uri>remote://throws</uri></include>"
+    "</world></sdf>";
+
+  sdf::Root root;
+  sdf::Errors errors = root.LoadSdfString(worldString, config);
+  const sdf::World *world = root.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+  EXPECT_TRUE(world->ModelNameExists("box1"));
+  EXPECT_TRUE(world->ModelNameExists("box2"));
+  EXPECT_TRUE(world->ModelNameExists("inline"));
+  EXPECT_EQ(4u, world->ModelCount());
+
+  // Each URI is fetched once, and the failed fetches are reported.
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    EXPECT_EQ(4u, fetched.size());
+  }
+  bool missingReported = false;
+  bool throwReported = false;
+  for (const sdf::Error &error : errors)
+  {
+    if (error.Code() != sdf::ErrorCode::URI_LOOKUP)
+      continue;
+    missingReported = missingReported ||
+      error.Message().find("remote://missing") != std::string::npos;
+    throwReported = throwReported ||
+      error.Message().find("server error") != std::string::npos;
+  }
+  EXPECT_TRUE(missingReported);
+  EXPECT_TRUE(throwReported);
+
+  // Later loads reuse the fetched paths, and try the failed fetches again.
+  sdf::Root root2;
+  root2.LoadSdfString(worldString, config);
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    EXPECT_EQ(6u, fetched.size());
+  }
+
+  // Streaming reads fetch the includes ahead too.
+  sdf::ParserConfig streaming(config);
+  streaming.SetStreamingRead(true);
+  sdf::Root root3;
+  root3.LoadSdfString(worldString, streaming);
+  ASSERT_NE(nullptr, root3.WorldByIndex(0));
+  EXPECT_EQ(4u, root3.WorldByIndex(0)->ModelCount());
+}
+
+//////////////////////////////////////////////////
+TEST(IncludesTest, ShareIncludedModels)
+{
+  sdf::setFindCallback(findFileCb);
+
+  const std::string worldString =
+    "<?xml version='1.0'?>"
+    "<sdf version='1.8'><world name='default'>"
+    "  <include><uri>box</uri><name>box1</name></include>"
+    "  <include>"
+    "    <uri>box</uri><name>box2</name><pose>1 2 3 0 0 0</pose>"
+    "    <static>true</static>"
+    "  </include>"
+    "  <include>"
+    "    <uri>box</uri><name>box3</name>"
+    "    <plugin name='p' filename='libp.so'/>"
+    "  </include>"
+    "  <model name='inline'><link name='link'/></model>"
+    "</world></sdf>";
+
+  sdf::ParserConfig config;
+  config.SetShareIncludedModels(true);
+
+  sdf::Root root;
+  EXPECT_TRUE(root.LoadSdfString(worldString, config).empty());
+  const sdf::World *world = root.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+  ASSERT_EQ(4u, world->ModelCount());
+
+  const sdf::Model *box1 = world->ModelByIndex(0);
+  const sdf::Model *box2 = world->ModelByIndex(1);
+  const sdf::Model *box3 = world->ModelByIndex(2);
+  const sdf::Model *inlineModel = world->ModelByIndex(3);
+
+  // The included boxes share their link, but keep their own properties.
+  ASSERT_EQ(1u, box1->LinkCount());
+  EXPECT_EQ(box1->LinkByIndex(0), box2->LinkByIndex(0));
+  EXPECT_EQ(box1->LinkByIndex(0), box3->LinkByIndex(0));
+  EXPECT_NE(box1->LinkByIndex(0), inlineModel->LinkByIndex(0));
+  EXPECT_EQ(box1->LinkByIndex(0), box2->LinkByName("link"));
+  EXPECT_EQ(box1->LinkByIndex(0), box2->CanonicalLink());
+
+  EXPECT_EQ("box2", box2->Name());
+  EXPECT_FALSE(box1->Static());
+  EXPECT_TRUE(box2->Static());
+  EXPECT_EQ(ignition::math::Pose3d(0, 0, 0.5, 0, 0, 0), box1->RawPose());
+  EXPECT_EQ(ignition::math::Pose3d(1, 2, 3, 0, 0, 0), box2->RawPose());
+  EXPECT_TRUE(box3->Element()->HasElement("plugin"));
+
+  // Poses resolve for each model, and for the shared link.
+  ignition::math::Pose3d pose;
+  EXPECT_TRUE(box2->SemanticPose().Resolve(pose, "world").empty());
+  EXPECT_EQ(ignition::math::Pose3d(1, 2, 3, 0, 0, 0), pose);
+  EXPECT_TRUE(world->LinkByScopedName("box2::link")->SemanticPose()
+      .Resolve(pose).empty());
+  EXPECT_EQ(ignition::math::Pose3d::Zero, pose);
+
+  std::vector<ignition::math::Pose3d> poses;
+  std::vector<std::string> names;
+  EXPECT_TRUE(box2->ResolvePoses(poses, names).empty());
+  ASSERT_FALSE(names.empty());
+  EXPECT_EQ("link", names[0]);
+
+  // Copies of a world have their own models.
+  sdf::World copy(*world);
+  EXPECT_NE(copy.ModelByIndex(0)->LinkByIndex(0),
+            copy.ModelByIndex(1)->LinkByIndex(0));
+  EXPECT_TRUE(copy.ModelByIndex(1)->LinkNameExists("link"));
+
+  // Without the option every model loads its own link.
+  sdf::Root unshared;
+  EXPECT_TRUE(unshared.LoadSdfString(worldString).empty());
+  world = unshared.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+  EXPECT_NE(world->ModelByIndex(0)->LinkByIndex(0),
+            world->ModelByIndex(1)->LinkByIndex(0));
+}
+
+//////////////////////////////////////////////////
+TEST(IncludesTest, StreamingRead)
+{
+  sdf::setFindCallback(findFileCb);
+
+  const std::string worldString =
+    "<?xml version='1.0'?>"
+    "<sdf version='1.8'><world name='default'>"
+    "  <include><uri>box</uri><name>box1</name></include>"
+    "  <include>"
+    "    <uri>test_model</uri><name>model</name>"
+    "    <pose>1 2 3 0 0 0</pose>"
+    "    <plugin name='p' filename='libp.so'><value>1</value></plugin>"
+    "  </include>"
+    "  <model name='inline'><link name='link'/></model>"
+    "</world></sdf>";
+
+  sdf::Root domRoot;
+  EXPECT_TRUE(domRoot.LoadSdfString(worldString).empty());
+
+  sdf::ParserConfig config;
+  config.SetStreamingRead(true);
+  sdf::Root streamedRoot;
+  EXPECT_TRUE(streamedRoot.LoadSdfString(worldString, config).empty());
+
+  // Includes are read as XML, and give the same document as the DOM.
+  ASSERT_NE(nullptr, domRoot.Element());
+  ASSERT_NE(nullptr, streamedRoot.Element());
+  EXPECT_EQ(domRoot.Element()->ToString(""),
+            streamedRoot.Element()->ToString(""));
+
+  const sdf::World *world = streamedRoot.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+  EXPECT_EQ(3u, world->ModelCount());
+  EXPECT_TRUE(world->ModelNameExists("box1"));
+  ASSERT_TRUE(world->ModelNameExists("model"));
+  EXPECT_EQ(ignition::math::Pose3d(1, 2, 3, 0, 0, 0),
+      world->ModelByName("model")->RawPose());
+  EXPECT_TRUE(world->ModelByName("model")->Element()->HasElement("plugin"));
+}
+
+//////////////////////////////////////////////////
+TEST(IncludesTest, ReloadIncludes)
+{
+  const auto modelsDir =
+    sdf::filesystem::append(PROJECT_BINARY_DIR, "reload_include_models");
+  sdf::filesystem::create_directory(modelsDir);
+  const auto modelDir = sdf::filesystem::append(modelsDir, "cache");
+  writeCacheTestModel(modelDir, "link");
+
+  sdf::setFindCallback([modelsDir](const std::string &_file)
+      {
+        return sdf::filesystem::append(modelsDir, _file);
+      });
+
+  const std::string worldString =
+    "<?xml version='1.0'?>"
+    "<sdf version='1.8'><world name='default'>"
+    "  <include><uri>cache</uri><name>first</name></include>"
+    "  <model name='inline'><link name='link'/></model>"
+    "  <include>"
+    "    <uri>cache</uri><name>second</name><pose>0 2 0 0 0 0</pose>"
+    "  </include>"
+    "  <frame name='F' attached_to='second'>"
+    "    <pose relative_to='second'>1 0 0 0 0 0</pose>"
+    "  </frame>"
+    "</world></sdf>";
+
+  // Includes that were not recorded can't be reloaded.
+  sdf::Root untracked;
+  EXPECT_TRUE(untracked.LoadSdfString(worldString).empty());
+  EXPECT_TRUE(untracked.IncludedFiles().empty());
+  sdf::Errors errors = untracked.ReloadIncludes(sdf::ParserConfig());
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::ELEMENT_MISSING, errors[0].Code());
+
+  sdf::ParserConfig config;
+  config.SetTrackIncludes(true);
+  sdf::Root root;
+  EXPECT_TRUE(root.LoadSdfString(worldString, config).empty());
+  const std::vector<std::string> files = root.IncludedFiles();
+  ASSERT_EQ(1u, files.size());
+  EXPECT_EQ(sdf::filesystem::append(modelDir, "model.sdf"), files[0]);
+
+  // Nothing changed, so nothing is reloaded.
+  EXPECT_TRUE(root.ReloadIncludes(config).empty());
+
+  const sdf::World *world = root.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+  const sdf::Model *inlineModel = world->ModelByName("inline");
+  ASSERT_NE(nullptr, inlineModel);
+  const sdf::ElementPtr inlineElem = inlineModel->Element();
+
+  // Both included models are replaced, in place, with the new link.
+  writeCacheTestModel(modelDir, "renamed_link");
+  errors = root.ReloadIncludes({files[0]}, config);
+  EXPECT_TRUE(errors.empty()) << errors;
+
+  ASSERT_EQ(3u, world->ModelCount());
+  EXPECT_EQ("first", world->ModelByIndex(0)->Name());
+  EXPECT_EQ("inline", world->ModelByIndex(1)->Name());
+  EXPECT_EQ("second", world->ModelByIndex(2)->Name());
+  EXPECT_TRUE(world->ModelByName("first")->LinkNameExists("renamed_link"));
+  EXPECT_TRUE(world->ModelByName("second")->LinkNameExists("renamed_link"));
+  EXPECT_FALSE(world->ModelByName("second")->LinkNameExists("link"));
+  EXPECT_EQ(inlineElem, world->ModelByName("inline")->Element());
+
+  sdf::ElementPtr worldElem = world->Element();
+  ASSERT_NE(nullptr, worldElem);
+  EXPECT_EQ(world->ModelByName("second")->Element(),
+      worldElem->GetElement("model")->GetNextElement("model")
+          ->GetNextElement("model"));
+
+  // The frame of the world follows the new version of the model.
+  const sdf::Frame *frame = world->FrameByName("F");
+  ASSERT_NE(nullptr, frame);
+  std::string body;
+  EXPECT_TRUE(frame->ResolveAttachedToBody(body).empty());
+  EXPECT_EQ("second::renamed_link", body);
+  ignition::math::Pose3d pose;
+  EXPECT_TRUE(frame->SemanticPose().Resolve(pose).empty());
+  EXPECT_EQ(ignition::math::Pose3d(1, 2, 0, 0, 0, 0), pose);
+
+  const sdf::Model *second = world->ModelByName("second");
+  ASSERT_NE(nullptr, second);
+  ASSERT_NE(nullptr, second->LinkByName("renamed_link"));
+  EXPECT_TRUE(second->LinkByName("renamed_link")->SemanticPose().Resolve(
+      pose).empty());
+  EXPECT_EQ(ignition::math::Pose3d(0, 2, 0, 0, 0, 0), pose);
+
+  // Changes are also found by checking the files.
+  writeCacheTestModel(modelDir, "last_link");
+  errors = root.ReloadIncludes(config);
+  EXPECT_TRUE(errors.empty()) << errors;
+  EXPECT_TRUE(world->ModelByName("first")->LinkNameExists("last_link"));
+  EXPECT_TRUE(world->ModelByName("second")->LinkNameExists("last_link"));
+
+  sdf::setFindCallback(findFileCb);
+}
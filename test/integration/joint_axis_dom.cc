@@ -221,6 +221,21 @@ TEST(DOMJointAxis, XyzExpressedIn)
   EXPECT_TRUE(joint2axis->ResolveXyz(vec3).empty());
   EXPECT_EQ(Vector3(-1, 0, 0), vec3);
 
+  // Resolved frames are cached, and follow changes of the axis.
+  sdf::JointAxis axisCopy(*joint2axis);
+  EXPECT_TRUE(axisCopy.ResolveXyz(vec3, "C2").empty());
+  EXPECT_EQ(Vector3(-1, 0, 0), vec3);
+  EXPECT_TRUE(axisCopy.SetXyz(Vector3(1, 0, 0)).empty());
+  EXPECT_TRUE(axisCopy.ResolveXyz(vec3, "C2").empty());
+  EXPECT_EQ(Vector3(0, 0, 1), vec3);
+  axisCopy.SetXyzExpressedIn("C2");
+  EXPECT_TRUE(axisCopy.ResolveXyz(vec3, "C2").empty());
+  EXPECT_EQ(Vector3(1, 0, 0), vec3);
+  axisCopy.SetXyzExpressedIn("missing");
+  EXPECT_FALSE(axisCopy.ResolveXyz(vec3, "C2").empty());
+  EXPECT_TRUE(joint2axis->ResolveXyz(vec3, "C2").empty());
+  EXPECT_EQ(Vector3(-1, 0, 0), vec3);
+
   EXPECT_EQ(0u, model->FrameCount());
   EXPECT_EQ(nullptr, model->FrameByIndex(0));
 }
@@ -15,7 +15,9 @@
  *
  */
 
+#include <sstream>
 #include <string>
+#include <vector>
 #include <gtest/gtest.h>
 
 #include <ignition/math/Pose3.hh>
@@ -23,6 +25,7 @@
 #include "sdf/Error.hh"
 #include "sdf/Filesystem.hh"
 #include "sdf/Frame.hh"
+#include "sdf/Joint.hh"
 #include "sdf/Link.hh"
 #include "sdf/Model.hh"
 #include "sdf/Root.hh"
@@ -577,3 +580,281 @@ TEST(DOMRoot, LoadInvalidNestedModelWithoutLinks)
   // errors[5]
   // errors[6]
 }
+
+/////////////////////////////////////////////////
+TEST(DOMRoot, LookupByNameInLargeModel)
+{
+  std::ostringstream stream;
+  stream << "<sdf version='1.8'><model name='robot'>"
+         << "<model name='arm'><link name='tip'/>"
+         << "<frame name='tool' attached_to='tip'/></model>";
+  for (int i = 0; i < 200; ++i)
+  {
+    stream << "<link name='link_" << i << "'/>";
+    if (i > 0)
+    {
+      stream << "<joint name='joint_" << i << "' type='fixed'>"
+             << "<parent>link_" << i - 1 << "</parent>"
+             << "<child>link_" << i << "</child></joint>";
+    }
+  }
+  stream << "<frame name='frame_0' attached_to='link_0'/>"
+         << "</model></sdf>";
+
+  sdf::Root root;
+  sdf::Errors errors = root.LoadSdfString(stream.str());
+  EXPECT_TRUE(errors.empty()) << errors;
+
+  const sdf::Model *model = root.ModelByIndex(0);
+  ASSERT_NE(nullptr, model);
+  ASSERT_EQ(200u, model->LinkCount());
+  for (uint64_t i = 0; i < model->LinkCount(); ++i)
+  {
+    const sdf::Link *link = model->LinkByIndex(i);
+    EXPECT_EQ(link, model->LinkByName(link->Name()));
+  }
+  for (uint64_t i = 0; i < model->JointCount(); ++i)
+  {
+    const sdf::Joint *joint = model->JointByIndex(i);
+    EXPECT_EQ(joint, model->JointByName(joint->Name()));
+  }
+  EXPECT_TRUE(model->LinkNameExists("link_199"));
+  EXPECT_FALSE(model->LinkNameExists("link_200"));
+  EXPECT_TRUE(model->JointNameExists("joint_199"));
+  EXPECT_FALSE(model->JointNameExists("joint_0"));
+  EXPECT_TRUE(model->FrameNameExists("frame_0"));
+  EXPECT_TRUE(model->ModelNameExists("arm"));
+  EXPECT_TRUE(model->LinkNameExists("arm::tip"));
+  EXPECT_TRUE(model->FrameNameExists("arm::tool"));
+  EXPECT_FALSE(model->LinkNameExists("arm::link_0"));
+
+  // Copies look up their own objects.
+  sdf::Model copy(*model);
+  EXPECT_EQ(copy.LinkByIndex(10), copy.LinkByName("link_10"));
+  EXPECT_EQ(copy.ModelByIndex(0), copy.ModelByName("arm"));
+}
+
+/////////////////////////////////////////////////
+TEST(DOMRoot, CanonicalLinkOfDeeplyNestedModel)
+{
+  const int depth = 100;
+  std::ostringstream stream;
+  stream << "<sdf version='1.8'>";
+  for (int i = 0; i < depth; ++i)
+    stream << "<model name='model_" << i << "'>";
+  stream << "<link name='base'/><link name='tip'/>";
+  for (int i = 0; i < depth; ++i)
+    stream << "</model>";
+  stream << "</sdf>";
+
+  sdf::Root root;
+  sdf::Errors errors = root.LoadSdfString(stream.str());
+  EXPECT_TRUE(errors.empty()) << errors;
+
+  // The implicit canonical link is the first link of the deepest model.
+  const sdf::Model *model = root.ModelByIndex(0);
+  ASSERT_NE(nullptr, model);
+  std::string expectedName = "base";
+  const sdf::Model *deepest = model;
+  for (int i = 1; i < depth; ++i)
+  {
+    deepest = deepest->ModelByIndex(0);
+    ASSERT_NE(nullptr, deepest);
+  }
+  for (int i = depth - 1; i > 0; --i)
+    expectedName = "model_" + std::to_string(i) + "::" + expectedName;
+
+  for (int i = 0; i < 2; ++i)
+  {
+    auto linkAndName = model->CanonicalLinkAndRelativeName();
+    EXPECT_EQ(deepest->LinkByIndex(0), linkAndName.first);
+    EXPECT_EQ(expectedName, linkAndName.second);
+  }
+
+  // Copies resolve to their own links.
+  sdf::Model copy(*model);
+  const sdf::Model *copyDeepest = &copy;
+  for (int i = 1; i < depth; ++i)
+    copyDeepest = copyDeepest->ModelByIndex(0);
+  EXPECT_EQ(copyDeepest->LinkByIndex(0), copy.CanonicalLink());
+  EXPECT_NE(model->CanonicalLink(), copy.CanonicalLink());
+
+  // Setting the canonical link name resolves it again.
+  const std::string tipName =
+      expectedName.substr(0, expectedName.size() - 4) + "tip";
+  copy.SetCanonicalLinkName(tipName);
+  EXPECT_EQ(copyDeepest->LinkByIndex(1), copy.CanonicalLink());
+  EXPECT_EQ(tipName, copy.CanonicalLinkAndRelativeName().second);
+}
+
+/////////////////////////////////////////////////
+TEST(DOMRoot, KinematicTopology)
+{
+  const std::size_t none = sdf::KinematicTopology::kInvalidIndex;
+  const std::string robot =
+    "<sdf version='1.8'><model name='robot'>"
+    "  <model name='arm'><link name='tip'/></model>"
+    "  <link name='base'/><link name='l1'/><link name='l2'/><link name='l3'/>"
+    "  <joint name='j0' type='fixed'>"
+    "    <parent>world</parent><child>base</child></joint>"
+    "  <joint name='j1' type='fixed'>"
+    "    <parent>base</parent><child>l1</child></joint>"
+    "  <joint name='j2' type='fixed'>"
+    "    <parent>base</parent><child>l2</child></joint>"
+    "  <joint name='j3' type='fixed'>"
+    "    <parent>l1</parent><child>l3</child></joint>"
+    "  <joint name='j4' type='fixed'>"
+    "    <parent>l3</parent><child>arm::tip</child></joint>"
+    "</model></sdf>";
+
+  sdf::Root root;
+  sdf::Errors errors = root.LoadSdfString(robot);
+  EXPECT_TRUE(errors.empty()) << errors;
+  const sdf::Model *model = root.ModelByIndex(0);
+  ASSERT_NE(nullptr, model);
+
+  const sdf::KinematicTopology &topology = model->Topology();
+  using Indices = std::vector<std::size_t>;
+  EXPECT_EQ(Indices({none, 0, 0, 1, 3}), topology.jointParentLink);
+  EXPECT_EQ(Indices({0, 1, 2, 3, none}), topology.jointChildLink);
+  EXPECT_EQ(Indices({0, 1, 2, 3}), topology.parentJoint);
+  EXPECT_EQ(Indices({none, 0, 0, 1}), topology.parentLink);
+  EXPECT_EQ(Indices({0, 2, 3, 3, 3}), topology.childOffsets);
+  EXPECT_EQ(Indices({1, 2, 3}), topology.childJoints);
+  EXPECT_EQ(Indices({0, 1, 3, 2}), topology.order);
+  EXPECT_EQ(Indices({0}), topology.rootLinks);
+  EXPECT_TRUE(topology.loopJoints.empty());
+
+  sdf::Model copy(*model);
+  EXPECT_EQ(topology.order, copy.Topology().order);
+
+  // Joints that give a link a second parent, or go around a loop, or
+  // connect a link to itself are left out of the tree.
+  const std::string loops =
+    "<sdf version='1.8'><model name='loops'>"
+    "  <link name='a'/><link name='b'/><link name='c'/><link name='d'/>"
+    "  <joint name='ab' type='fixed'><parent>a</parent><child>b</child>"
+    "  </joint>"
+    "  <joint name='ba' type='fixed'><parent>b</parent><child>a</child>"
+    "  </joint>"
+    "  <joint name='cd' type='fixed'><parent>c</parent><child>d</child>"
+    "  </joint>"
+    "  <joint name='ad' type='fixed'><parent>a</parent><child>d</child>"
+    "  </joint>"
+    "  <joint name='cc' type='fixed'><parent>c</parent><child>c</child>"
+    "  </joint>"
+    "</model></sdf>";
+  sdf::Root loopRoot;
+  loopRoot.LoadSdfString(loops);
+  ASSERT_NE(nullptr, loopRoot.ModelByIndex(0));
+  const sdf::KinematicTopology &loopTopology =
+    loopRoot.ModelByIndex(0)->Topology();
+  EXPECT_EQ(Indices({1, 3, 4}), loopTopology.loopJoints);
+  EXPECT_EQ(Indices({none, 0, none, 2}), loopTopology.parentLink);
+  EXPECT_EQ(Indices({none, 0, none, 2}), loopTopology.parentJoint);
+  EXPECT_EQ(Indices({0, 2}), loopTopology.rootLinks);
+  EXPECT_EQ(Indices({0, 1, 2, 3}), loopTopology.order);
+}
+
+/////////////////////////////////////////////////
+TEST(DOMRoot, ForwardKinematics)
+{
+  const std::string arm =
+    "<sdf version='1.8'><model name='arm'>"
+    "  <link name='base'/>"
+    "  <link name='l1'><pose>1 0 0 0 0 0</pose></link>"
+    "  <link name='l2'><pose>2 0 0 0 0 0</pose></link>"
+    "  <joint name='j1' type='revolute'>"
+    "    <pose>-1 0 0 0 0 0</pose>"
+    "    <parent>base</parent><child>l1</child>"
+    "    <axis><xyz>0 0 1</xyz></axis>"
+    "  </joint>"
+    "  <joint name='j2' type='prismatic'>"
+    "    <parent>l1</parent><child>l2</child>"
+    "    <axis><xyz>1 0 0</xyz></axis>"
+    "  </joint>"
+    "</model></sdf>";
+
+  sdf::Root root;
+  sdf::Errors errors = root.LoadSdfString(arm);
+  EXPECT_TRUE(errors.empty()) << errors;
+  const sdf::Model *model = root.ModelByIndex(0);
+  ASSERT_NE(nullptr, model);
+
+  // Positions of j1 then of j2, for two configurations.
+  const std::vector<double> positions = {0, IGN_PI_2, 0, 0.5};
+  std::vector<ignition::math::Pose3d> poses;
+  errors = model->ForwardKinematics(positions, 2, poses);
+  EXPECT_TRUE(errors.empty()) << errors;
+  ASSERT_EQ(6u, poses.size());
+
+  using ignition::math::Pose3d;
+  EXPECT_EQ(Pose3d::Zero, poses[0]);
+  EXPECT_EQ(Pose3d::Zero, poses[1]);
+  EXPECT_EQ(Pose3d(1, 0, 0, 0, 0, 0), poses[2]);
+  EXPECT_EQ(Pose3d(0, 1, 0, 0, 0, IGN_PI_2), poses[3]);
+  EXPECT_EQ(Pose3d(2, 0, 0, 0, 0, 0), poses[4]);
+  EXPECT_EQ(Pose3d(0, 2.5, 0, 0, 0, IGN_PI_2), poses[5]);
+
+  // The cached joint frames give the same result.
+  std::vector<Pose3d> again;
+  EXPECT_TRUE(model->ForwardKinematics(positions, 2, again).empty());
+  EXPECT_EQ(poses, again);
+
+  errors = model->ForwardKinematics({0, 1, 2}, 2, poses);
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::ELEMENT_INVALID, errors[0].Code());
+  EXPECT_TRUE(poses.empty());
+}
+
+/////////////////////////////////////////////////
+TEST(DOMRoot, CompositeInertial)
+{
+  const std::string inertial =
+    "  <inertial><mass>%</mass><inertia>"
+    "    <ixx>1</ixx><iyy>1</iyy><izz>1</izz>"
+    "  </inertia></inertial>";
+  auto withMass = [&inertial](const std::string &_mass)
+  {
+    std::string result = inertial;
+    return result.replace(result.find('%'), 1, _mass);
+  };
+  const std::string sdf =
+    "<sdf version='1.8'><model name='m'>"
+    "  <link name='a'>" + withMass("1") + "</link>"
+    "  <link name='b'><pose>2 0 0 0 0 0</pose>" + withMass("3") + "</link>"
+    "  <model name='n'><pose>0 4 0 0 0 0</pose>"
+    "    <link name='c'>" + withMass("4") + "</link>"
+    "  </model>"
+    "</model></sdf>";
+
+  sdf::Root root;
+  sdf::Errors errors = root.LoadSdfString(sdf);
+  EXPECT_TRUE(errors.empty()) << errors;
+  const sdf::Model *model = root.ModelByIndex(0);
+  ASSERT_NE(nullptr, model);
+
+  using ignition::math::Pose3d;
+  using ignition::math::Vector3d;
+  ignition::math::Inertiald total;
+  errors = model->CompositeInertial(total, "", false);
+  EXPECT_TRUE(errors.empty()) << errors;
+  EXPECT_DOUBLE_EQ(4.0, total.MassMatrix().Mass());
+  EXPECT_EQ(Pose3d(1.5, 0, 0, 0, 0, 0), total.Pose());
+  EXPECT_EQ(Vector3d(3, 6, 6), total.MassMatrix().DiagonalMoments());
+
+  EXPECT_TRUE(model->CompositeInertial(total, "b", false).empty());
+  EXPECT_EQ(Pose3d(-0.5, 0, 0, 0, 0, 0), total.Pose());
+
+  EXPECT_TRUE(model->CompositeInertial(total).empty());
+  EXPECT_DOUBLE_EQ(8.0, total.MassMatrix().Mass());
+  EXPECT_EQ(Pose3d(0.75, 2, 0, 0, 0, 0), total.Pose());
+
+  EXPECT_TRUE(model->CompositeInertial(total, "n::c").empty());
+  EXPECT_EQ(Pose3d(0.75, -2, 0, 0, 0, 0), total.Pose());
+
+  errors = model->CompositeInertial(total, "missing");
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::POSE_RELATIVE_TO_INVALID, errors[0].Code());
+  EXPECT_EQ(Pose3d(0.75, 2, 0, 0, 0, 0), total.Pose());
+}
@@ -17,13 +17,22 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
 #include <gtest/gtest.h>
 
 #include "sdf/SDFImpl.hh"
 #include "sdf/parser.hh"
 #include "sdf/Frame.hh"
+#include "sdf/Collision.hh"
+#include "sdf/Joint.hh"
+#include "sdf/Link.hh"
+#include "sdf/Material.hh"
 #include "sdf/Model.hh"
+#include "sdf/ParserConfig.hh"
+#include "sdf/Pbr.hh"
 #include "sdf/Root.hh"
+#include "sdf/StateReader.hh"
+#include "sdf/Visual.hh"
 #include "sdf/World.hh"
 #include "sdf/Filesystem.hh"
 #include "test_config.h"
@@ -220,3 +229,461 @@ TEST(DOMWorld, LoadModelFrameSameName)
       SemanticPose().Resolve(pose, "ground").empty());
   EXPECT_EQ(Pose(0, -2, 3, 0, 0, 0), pose);
 }
+
+//////////////////////////////////////////////////
+TEST(DOMWorld, ScopedNameLookup)
+{
+  const std::string sdfString =
+    "<sdf version='1.8'>"
+    "  <world name='default'>"
+    "    <frame name='world_frame'/>"
+    "    <model name='outer'>"
+    "      <link name='base'/>"
+    "      <model name='inner'>"
+    "        <link name='tip'/>"
+    "        <link name='tool'/>"
+    "        <joint name='wrist' type='fixed'>"
+    "          <parent>tip</parent>"
+    "          <child>tool</child>"
+    "        </joint>"
+    "        <frame name='tcp' attached_to='tool'/>"
+    "      </model>"
+    "    </model>"
+    "  </world>"
+    "</sdf>";
+
+  sdf::Root root;
+  sdf::Errors errors = root.LoadSdfString(sdfString);
+  EXPECT_TRUE(errors.empty()) << errors;
+
+  const sdf::World *world = root.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+  const sdf::Model *outer = world->ModelByName("outer");
+  ASSERT_NE(nullptr, outer);
+  const sdf::Model *inner = outer->ModelByName("inner");
+  ASSERT_NE(nullptr, inner);
+
+  EXPECT_EQ(outer, world->ModelByScopedName("outer"));
+  EXPECT_EQ(inner, world->ModelByScopedName("outer::inner"));
+  EXPECT_EQ(outer->LinkByName("base"), world->LinkByScopedName("outer::base"));
+  EXPECT_EQ(inner->LinkByName("tip"),
+            world->LinkByScopedName("outer::inner::tip"));
+  EXPECT_EQ(inner->JointByName("wrist"),
+            world->JointByScopedName("outer::inner::wrist"));
+  EXPECT_EQ(inner->FrameByName("tcp"),
+            world->FrameByScopedName("outer::inner::tcp"));
+  EXPECT_EQ(world->FrameByName("world_frame"),
+            world->FrameByScopedName("world_frame"));
+  EXPECT_EQ(nullptr, world->LinkByScopedName("inner::tip"));
+  EXPECT_EQ(nullptr, world->LinkByScopedName("outer::inner"));
+  EXPECT_EQ(nullptr, world->ModelByScopedName("outer::inner::tip"));
+
+  // Scoped lookups through a model use the same index.
+  EXPECT_EQ(inner->LinkByName("tool"), outer->LinkByName("inner::tool"));
+  EXPECT_EQ(inner->FrameByName("tcp"), outer->FrameByName("inner::tcp"));
+
+  // Copies resolve names to their own entities.
+  sdf::World copy(*world);
+  const sdf::Model *copyInner =
+      copy.ModelByName("outer")->ModelByName("inner");
+  ASSERT_NE(nullptr, copyInner);
+  EXPECT_NE(inner, copyInner);
+  EXPECT_EQ(copyInner, copy.ModelByScopedName("outer::inner"));
+  EXPECT_EQ(copyInner->LinkByName("tip"),
+            copy.LinkByScopedName("outer::inner::tip"));
+  EXPECT_EQ(copyInner->LinkByName("tip"),
+            copy.ModelByName("outer")->LinkByName("inner::tip"));
+}
+
+//////////////////////////////////////////////////
+TEST(DOMWorld, ResolvePoses)
+{
+  const std::string sdfString =
+    "<sdf version='1.8'>"
+    "  <world name='default'>"
+    "    <frame name='world_frame'><pose>0 0 1 0 0 0</pose></frame>"
+    "    <model name='outer'>"
+    "      <pose relative_to='world_frame'>1 0 0 0 0 1.5707963267948966</pose>"
+    "      <link name='base'>"
+    "        <pose>0 1 0 0 0 0</pose>"
+    "        <visual name='v'>"
+    "          <pose relative_to='tcp'>0 0 0.5 0 0 0</pose>"
+    "          <geometry><box><size>1 1 1</size></box></geometry>"
+    "        </visual>"
+    "        <collision name='c'>"
+    "          <pose>0 0 0.25 0 0 0</pose>"
+    "          <geometry><box><size>1 1 1</size></box></geometry>"
+    "        </collision>"
+    "      </link>"
+    "      <frame name='tcp' attached_to='base'>"
+    "        <pose relative_to='base'>0 0 2 0 0 0</pose>"
+    "      </frame>"
+    "      <model name='inner'>"
+    "        <pose relative_to='tcp'>0 0 1 0 0 0</pose>"
+    "        <link name='tip'><pose>1 0 0 0 0 0</pose></link>"
+    "        <link name='tool'/>"
+    "        <joint name='wrist' type='fixed'>"
+    "          <pose>0 0 0.1 0 0 0</pose>"
+    "          <parent>tip</parent>"
+    "          <child>tool</child>"
+    "        </joint>"
+    "      </model>"
+    "    </model>"
+    "  </world>"
+    "</sdf>";
+
+  sdf::Root root;
+  sdf::Errors errors = root.LoadSdfString(sdfString);
+  EXPECT_TRUE(errors.empty()) << errors;
+  const sdf::World *world = root.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+
+  std::vector<ignition::math::Pose3d> poses;
+  std::vector<std::string> names;
+  errors = world->ResolvePoses(poses, names);
+  EXPECT_TRUE(errors.empty()) << errors;
+
+  const std::vector<std::string> expectedNames = {
+    "outer", "outer::base", "outer::base::v", "outer::base::c",
+    "outer::tcp", "outer::inner", "outer::inner::tip", "outer::inner::tool",
+    "outer::inner::wrist", "world_frame"};
+  EXPECT_EQ(expectedNames, names);
+  ASSERT_EQ(names.size(), poses.size());
+
+  // Each pose matches the one resolved through SemanticPose.
+  const sdf::Model *outer = world->ModelByName("outer");
+  ASSERT_NE(nullptr, outer);
+  const sdf::Link *base = outer->LinkByName("base");
+  ASSERT_NE(nullptr, base);
+  const sdf::Model *inner = outer->ModelByName("inner");
+  ASSERT_NE(nullptr, inner);
+
+  auto resolved = [](const sdf::SemanticPose &_pose)
+  {
+    ignition::math::Pose3d pose;
+    EXPECT_TRUE(_pose.Resolve(pose, "world").empty());
+    return pose;
+  };
+  ignition::math::Pose3d outerPose;
+  EXPECT_TRUE(outer->SemanticPose().Resolve(outerPose).empty());
+  EXPECT_EQ(outerPose, poses[0]);
+  EXPECT_EQ(ignition::math::Pose3d(1, 0, 1, 0, 0, IGN_PI_2), outerPose);
+
+  std::vector<ignition::math::Pose3d> modelPoses;
+  std::vector<std::string> modelNames;
+  errors = outer->ResolvePoses(modelPoses, modelNames);
+  EXPECT_TRUE(errors.empty()) << errors;
+  ASSERT_EQ(8u, modelNames.size());
+  EXPECT_EQ("base::v", modelNames[1]);
+  EXPECT_EQ("inner::wrist", modelNames[7]);
+
+  ignition::math::Pose3d pose;
+  EXPECT_TRUE(base->SemanticPose().Resolve(pose).empty());
+  EXPECT_EQ(pose, modelPoses[0]);
+  EXPECT_EQ(outerPose * pose, poses[1]);
+  EXPECT_TRUE(base->VisualByIndex(0)->SemanticPose().Resolve(pose).empty());
+  EXPECT_EQ(pose, modelPoses[1]);
+  EXPECT_EQ(ignition::math::Pose3d(0, 1, 2.5, 0, 0, 0), pose);
+  EXPECT_TRUE(
+      base->CollisionByIndex(0)->SemanticPose().Resolve(pose).empty());
+  EXPECT_EQ(pose, modelPoses[2]);
+  EXPECT_TRUE(inner->SemanticPose().Resolve(pose).empty());
+  EXPECT_EQ(pose, modelPoses[4]);
+  EXPECT_EQ(ignition::math::Pose3d(0, 1, 3, 0, 0, 0), pose);
+  EXPECT_TRUE(inner->JointByName("wrist")->SemanticPose().Resolve(
+      pose, "__model__").empty());
+  EXPECT_EQ(modelPoses[4] * pose, modelPoses[7]);
+  EXPECT_EQ(outerPose * modelPoses[7], poses[8]);
+  EXPECT_EQ(resolved(world->FrameByName("world_frame")->SemanticPose()),
+            poses[9]);
+
+  // Models that are not loaded from a world have no graph.
+  sdf::Model model;
+  errors = model.ResolvePoses(modelPoses, modelNames);
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::POSE_RELATIVE_TO_GRAPH_ERROR, errors[0].Code());
+  EXPECT_TRUE(modelPoses.empty());
+}
+
+//////////////////////////////////////////////////
+TEST(DOMWorld, ApplyState)
+{
+  const std::string sdfString =
+    "<sdf version='1.8'>"
+    "  <world name='default'>"
+    "    <frame name='world_frame'><pose>0 0 1 0 0 0</pose></frame>"
+    "    <frame name='follow'>"
+    "      <pose relative_to='outer'>0 0 1 0 0 0</pose>"
+    "    </frame>"
+    "    <model name='outer'>"
+    "      <pose relative_to='world_frame'>1 0 0 0 0 1.5707963267948966</pose>"
+    "      <link name='base'>"
+    "        <pose>0 1 0 0 0 0</pose>"
+    "        <visual name='v'>"
+    "          <pose relative_to='tcp'>0 0 0.5 0 0 0</pose>"
+    "          <geometry><box><size>1 1 1</size></box></geometry>"
+    "        </visual>"
+    "      </link>"
+    "      <frame name='tcp' attached_to='base'>"
+    "        <pose relative_to='base'>0 0 2 0 0 0</pose>"
+    "      </frame>"
+    "      <model name='inner'>"
+    "        <pose relative_to='tcp'>0 0 1 0 0 0</pose>"
+    "        <link name='tip'><pose>1 0 0 0 0 0</pose></link>"
+    "        <link name='tool'/>"
+    "      </model>"
+    "    </model>"
+    "    <model name='other'>"
+    "      <pose>0 5 0 0 0 0</pose>"
+    "      <link name='l'/>"
+    "    </model>"
+    "  </world>"
+    "</sdf>";
+
+  sdf::Root root;
+  sdf::Errors errors = root.LoadSdfString(sdfString);
+  EXPECT_TRUE(errors.empty()) << errors;
+  const sdf::World *world = root.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+  const sdf::Model *outer = world->ModelByName("outer");
+  ASSERT_NE(nullptr, outer);
+  const sdf::Model *inner = outer->ModelByName("inner");
+  ASSERT_NE(nullptr, inner);
+  const sdf::Link *base = outer->LinkByName("base");
+  ASSERT_NE(nullptr, base);
+  const sdf::Frame *follow = world->FrameByName("follow");
+  ASSERT_NE(nullptr, follow);
+
+  // Resolve poses before the state is applied, so that they are cached.
+  ignition::math::Pose3d pose;
+  EXPECT_TRUE(follow->SemanticPose().Resolve(pose).empty());
+  EXPECT_EQ(ignition::math::Pose3d(1, 0, 2, 0, 0, IGN_PI_2), pose);
+  EXPECT_TRUE(
+      world->ModelByName("other")->SemanticPose().Resolve(pose).empty());
+  EXPECT_EQ(ignition::math::Pose3d(0, 5, 0, 0, 0, 0), pose);
+
+  sdf::StateFrame state;
+  state.SetWorldName("default");
+  const std::size_t outerState =
+      state.AddModel("outer", ignition::math::Pose3d(5, 0, 0, 0, 0, 0));
+  state.AddLink(outerState, "base", ignition::math::Pose3d(5, 1, 0, 0, 0, 0));
+  const std::size_t innerState = state.AddModel("inner",
+      ignition::math::Pose3d(5, 0, 3, 0, 0, 0), outerState);
+  state.AddLink(innerState, "tip", ignition::math::Pose3d(6, 0, 3, 0, 0, 0));
+
+  errors = root.ApplyState(state);
+  EXPECT_TRUE(errors.empty()) << errors;
+
+  EXPECT_EQ(ignition::math::Pose3d(5, 0, 0, 0, 0, 0), outer->RawPose());
+  EXPECT_TRUE(outer->PoseRelativeTo().empty());
+  EXPECT_TRUE(outer->SemanticPose().Resolve(pose).empty());
+  EXPECT_EQ(ignition::math::Pose3d(5, 0, 0, 0, 0, 0), pose);
+  EXPECT_TRUE(base->SemanticPose().Resolve(pose).empty());
+  EXPECT_EQ(ignition::math::Pose3d(0, 1, 0, 0, 0, 0), pose);
+  EXPECT_TRUE(base->VisualByIndex(0)->SemanticPose().Resolve(pose).empty());
+  EXPECT_EQ(ignition::math::Pose3d(0, 1, 2.5, 0, 0, 0), pose);
+  EXPECT_TRUE(inner->SemanticPose().Resolve(pose).empty());
+  EXPECT_EQ(ignition::math::Pose3d(0, 0, 3, 0, 0, 0), pose);
+  EXPECT_TRUE(inner->LinkByName("tip")->SemanticPose().Resolve(pose).empty());
+  EXPECT_EQ(ignition::math::Pose3d(1, 0, 0, 0, 0, 0), pose);
+  EXPECT_TRUE(
+      inner->LinkByName("tool")->SemanticPose().Resolve(pose).empty());
+  EXPECT_EQ(ignition::math::Pose3d::Zero, pose);
+
+  // Frames resolved through a moved model move with it, and the others
+  // keep their pose.
+  EXPECT_TRUE(follow->SemanticPose().Resolve(pose).empty());
+  EXPECT_EQ(ignition::math::Pose3d(5, 0, 1, 0, 0, 0), pose);
+  EXPECT_TRUE(
+      world->ModelByName("other")->SemanticPose().Resolve(pose).empty());
+  EXPECT_EQ(ignition::math::Pose3d(0, 5, 0, 0, 0, 0), pose);
+
+  std::vector<ignition::math::Pose3d> poses;
+  std::vector<std::string> names;
+  errors = world->ResolvePoses(poses, names);
+  EXPECT_TRUE(errors.empty()) << errors;
+  ASSERT_FALSE(names.empty());
+  EXPECT_EQ("outer", names[0]);
+  EXPECT_EQ(ignition::math::Pose3d(5, 0, 0, 0, 0, 0), poses[0]);
+
+  // Entities that are not in the world are reported and skipped.
+  sdf::StateFrame missing;
+  const std::size_t model =
+      missing.AddModel("missing", ignition::math::Pose3d::Zero);
+  missing.AddLink(model, "link", ignition::math::Pose3d::Zero);
+  missing.AddModel("other", ignition::math::Pose3d(0, 6, 0, 0, 0, 0));
+  errors = root.ApplyState(missing);
+  ASSERT_EQ(2u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::ELEMENT_MISSING, errors[0].Code());
+  EXPECT_EQ(sdf::ErrorCode::ELEMENT_MISSING, errors[1].Code());
+  EXPECT_TRUE(
+      world->ModelByName("other")->SemanticPose().Resolve(pose).empty());
+  EXPECT_EQ(ignition::math::Pose3d(0, 6, 0, 0, 0, 0), pose);
+
+  missing.SetWorldName("nowhere");
+  errors = root.ApplyState(missing);
+  ASSERT_EQ(1u, errors.size());
+  EXPECT_EQ(sdf::ErrorCode::ELEMENT_MISSING, errors[0].Code());
+}
+
+//////////////////////////////////////////////////
+TEST(DOMWorld, ShareMaterials)
+{
+  const std::string red =
+    "<material><diffuse>1 0 0 1</diffuse></material>";
+  const std::string metal =
+    "<material><diffuse>1 1 1 1</diffuse><pbr><metal>"
+    "  <albedo_map>albedo.png</albedo_map><roughness>0.5</roughness>"
+    "</metal></pbr></material>";
+  auto visual = [](const std::string &_name, const std::string &_material)
+  {
+    return "<visual name='" + _name + "'>"
+      "<geometry><box><size>1 1 1</size></box></geometry>" + _material +
+      "</visual>";
+  };
+
+  std::string sdfString = "<sdf version='1.8'><world name='default'>";
+  for (int i = 0; i < 3; ++i)
+  {
+    sdfString += "<model name='m" + std::to_string(i) + "'><link name='l'>" +
+      visual("red", red) + visual("metal", metal) + visual("plain", "") +
+      "</link><model name='nested'><link name='l'>" + visual("red", red) +
+      "</link></model></model>";
+  }
+  sdfString += "<model name='rough'><link name='l'>" +
+    visual("metal", std::string(metal).replace(metal.find("0.5"), 3, "0.6")) +
+    "</link></model></world></sdf>";
+
+  // Without the option, each visual has its own material.
+  sdf::Root root;
+  sdf::Errors errors = root.LoadSdfString(sdfString);
+  EXPECT_TRUE(errors.empty()) << errors;
+  const sdf::World *world = root.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+  EXPECT_EQ(0u, world->MaterialCount());
+  EXPECT_EQ(nullptr, world->MaterialByIndex(0));
+  const sdf::Visual *visual0 =
+    world->ModelByIndex(0)->LinkByIndex(0)->VisualByIndex(0);
+  ASSERT_NE(nullptr, visual0->Material());
+  EXPECT_EQ(sdf::Visual::kInvalidMaterialIndex, visual0->MaterialIndex());
+
+  sdf::ParserConfig config;
+  config.SetShareMaterials(true);
+  sdf::Root sharedRoot;
+  errors = sharedRoot.LoadSdfString(sdfString, config);
+  EXPECT_TRUE(errors.empty()) << errors;
+  world = sharedRoot.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+
+  // red, metal, and metal with another roughness.
+  ASSERT_EQ(3u, world->MaterialCount());
+  EXPECT_EQ(nullptr, world->MaterialByIndex(3));
+  const sdf::Material *redMaterial = world->MaterialByIndex(0);
+  ASSERT_NE(nullptr, redMaterial);
+  EXPECT_EQ(ignition::math::Color(1, 0, 0, 1), redMaterial->Diffuse());
+  const sdf::Material *metalMaterial = world->MaterialByIndex(1);
+  ASSERT_NE(nullptr, metalMaterial);
+  ASSERT_NE(nullptr, metalMaterial->PbrMaterial());
+  const sdf::PbrWorkflow *workflow =
+    metalMaterial->PbrMaterial()->Workflow(sdf::PbrWorkflowType::METAL);
+  ASSERT_NE(nullptr, workflow);
+  EXPECT_EQ("albedo.png", workflow->AlbedoMap());
+  EXPECT_DOUBLE_EQ(0.5, workflow->Roughness());
+
+  for (uint64_t m = 0; m < 3; ++m)
+  {
+    const sdf::Model *model = world->ModelByIndex(m);
+    ASSERT_NE(nullptr, model);
+    const sdf::Link *link = model->LinkByIndex(0);
+    EXPECT_EQ(0u, link->VisualByName("red")->MaterialIndex());
+    EXPECT_EQ(redMaterial, link->VisualByName("red")->Material());
+    EXPECT_EQ(1u, link->VisualByName("metal")->MaterialIndex());
+    EXPECT_EQ(metalMaterial, link->VisualByName("metal")->Material());
+    EXPECT_EQ(nullptr, link->VisualByName("plain")->Material());
+    EXPECT_EQ(sdf::Visual::kInvalidMaterialIndex,
+        link->VisualByName("plain")->MaterialIndex());
+    EXPECT_EQ(0u, model->ModelByIndex(0)->LinkByIndex(0)->VisualByIndex(0)
+        ->MaterialIndex());
+  }
+  const sdf::Visual *rough =
+    world->ModelByName("rough")->LinkByIndex(0)->VisualByIndex(0);
+  EXPECT_EQ(2u, rough->MaterialIndex());
+
+  // A copy of a visual has its own material, which keeps the index of its
+  // entry, and setting a material takes a visual out of the table.
+  sdf::Visual copy;
+  copy = *world->ModelByIndex(1)->LinkByIndex(0)->VisualByName("red");
+  EXPECT_EQ(0u, copy.MaterialIndex());
+  ASSERT_NE(nullptr, copy.Material());
+  EXPECT_NE(redMaterial, copy.Material());
+  EXPECT_EQ(redMaterial->Diffuse(), copy.Material()->Diffuse());
+  copy.Material()->SetDiffuse(ignition::math::Color(0, 0, 1, 1));
+  EXPECT_EQ(ignition::math::Color(1, 0, 0, 1), redMaterial->Diffuse());
+  copy.SetMaterial(*redMaterial);
+  EXPECT_EQ(sdf::Visual::kInvalidMaterialIndex, copy.MaterialIndex());
+  EXPECT_NE(redMaterial, copy.Material());
+
+  // The visuals of a copy of the world share the entries of its own table.
+  sdf::World worldCopy(*world);
+  EXPECT_EQ(3u, worldCopy.MaterialCount());
+  const sdf::Material *copiedRed = worldCopy.MaterialByIndex(0);
+  ASSERT_NE(nullptr, copiedRed);
+  EXPECT_NE(redMaterial, copiedRed);
+  for (uint64_t m = 0; m < 3; ++m)
+  {
+    const sdf::Link *link = worldCopy.ModelByIndex(m)->LinkByIndex(0);
+    EXPECT_EQ(0u, link->VisualByName("red")->MaterialIndex());
+    EXPECT_EQ(copiedRed, link->VisualByName("red")->Material());
+    EXPECT_EQ(worldCopy.MaterialByIndex(1),
+        link->VisualByName("metal")->Material());
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(DOMWorld, ShareMaterialsCopy)
+{
+  const std::string sdfString =
+    "<sdf version='1.8'><world name='default'>"
+    "<model name='m'><link name='l'>"
+    "<visual name='a'><geometry><box><size>1 1 1</size></box></geometry>"
+    "<material><diffuse>1 0 0 1</diffuse></material></visual>"
+    "<visual name='b'><geometry><box><size>1 1 1</size></box></geometry>"
+    "<material><diffuse>1 0 0 1</diffuse></material></visual>"
+    "</link></model></world></sdf>";
+
+  sdf::ParserConfig config;
+  config.SetShareMaterials(true);
+  sdf::Root root;
+  sdf::Errors errors = root.LoadSdfString(sdfString, config);
+  EXPECT_TRUE(errors.empty()) << errors;
+  const sdf::World *world = root.WorldByIndex(0);
+  ASSERT_NE(nullptr, world);
+  ASSERT_EQ(1u, world->MaterialCount());
+
+  // Changing a material through a copy of the world changes the visuals
+  // of the copy that share it, and leaves the original world alone.
+  sdf::World worldCopy(*world);
+  const sdf::Link *copiedLink = worldCopy.ModelByIndex(0)->LinkByIndex(0);
+  copiedLink->VisualByName("a")->Material()->SetDiffuse(
+      ignition::math::Color(0, 1, 0, 1));
+  EXPECT_EQ(ignition::math::Color(0, 1, 0, 1),
+      copiedLink->VisualByName("b")->Material()->Diffuse());
+  EXPECT_EQ(ignition::math::Color(0, 1, 0, 1),
+      worldCopy.MaterialByIndex(0)->Diffuse());
+
+  const sdf::Link *link = world->ModelByIndex(0)->LinkByIndex(0);
+  EXPECT_EQ(ignition::math::Color(1, 0, 0, 1),
+      link->VisualByName("a")->Material()->Diffuse());
+  EXPECT_EQ(ignition::math::Color(1, 0, 0, 1),
+      link->VisualByName("b")->Material()->Diffuse());
+  EXPECT_EQ(ignition::math::Color(1, 0, 0, 1),
+      world->MaterialByIndex(0)->Diffuse());
+
+  // So does a world assigned from another one.
+  sdf::World assigned;
+  assigned = *world;
+  assigned.ModelByIndex(0)->LinkByIndex(0)->VisualByName("b")->Material()
+      ->SetDiffuse(ignition::math::Color(0, 0, 1, 1));
+  EXPECT_EQ(ignition::math::Color(1, 0, 0, 1),
+      world->MaterialByIndex(0)->Diffuse());
+}
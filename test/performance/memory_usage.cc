@@ -0,0 +1,264 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "sdf/sdf.hh"
+
+#include "test_config.h"
+
+// The thresholds below are budgets per element of the tree that is read,
+// with a lot of headroom over the measured values so that they don't
+// depend on the standard library or allocator. They are meant to catch
+// regressions that change how memory scales, such as copying a
+// description tree or a whole document for every element.
+
+/// \brief Allocations budget per element for sdf::readFile.
+static const double kReadAllocationsPerElement = 200;
+
+/// \brief Peak live bytes budget per element for sdf::readFile.
+static const double kReadPeakBytesPerElement = 64 * 1024;
+
+/// \brief Allocations budget per element for sdf::Root::Load.
+static const double kLoadAllocationsPerElement = 200;
+
+/// \brief Peak live bytes budget per element for sdf::Root::Load.
+static const double kLoadPeakBytesPerElement = 64 * 1024;
+
+/// \brief Allocations budget per element for sdf::Element::Clone.
+static const double kCloneAllocationsPerElement = 32;
+
+/// \brief Peak live bytes budget per element for sdf::Element::Clone.
+static const double kClonePeakBytesPerElement = 16 * 1024;
+
+/// \brief Allocations budget for sdf::init once the description is cached.
+static const std::size_t kInitAllocations = 100;
+
+/// \brief Peak live bytes budget for sdf::init once the description is
+/// cached.
+static const std::size_t kInitPeakBytes = 32 * 1024;
+
+/// \brief Header stored in front of every allocation, to know the size of
+/// a block when it is freed. It keeps the alignment of malloc.
+struct alignas(std::max_align_t) AllocationHeader
+{
+  /// \brief Size requested by the caller.
+  std::size_t size;
+};
+
+/// \brief Number of calls to the global operator new of this executable.
+static std::atomic<std::size_t> g_allocations{0};
+
+/// \brief Total number of bytes requested from operator new.
+static std::atomic<std::size_t> g_bytes{0};
+
+/// \brief Number of bytes currently allocated.
+static std::atomic<std::size_t> g_liveBytes{0};
+
+/// \brief Highest value of g_liveBytes since the last reset.
+static std::atomic<std::size_t> g_peakBytes{0};
+
+/////////////////////////////////////////////////
+void *operator new(std::size_t _size)
+{
+  void *block = std::malloc(sizeof(AllocationHeader) + _size);
+  if (!block)
+    throw std::bad_alloc();
+
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  g_bytes.fetch_add(_size, std::memory_order_relaxed);
+  const std::size_t live =
+    g_liveBytes.fetch_add(_size, std::memory_order_relaxed) + _size;
+  std::size_t peak = g_peakBytes.load(std::memory_order_relaxed);
+  while (live > peak &&
+         !g_peakBytes.compare_exchange_weak(peak, live,
+                                            std::memory_order_relaxed))
+  {
+  }
+
+  AllocationHeader *header = static_cast<AllocationHeader *>(block);
+  header->size = _size;
+  return header + 1;
+}
+
+/////////////////////////////////////////////////
+void operator delete(void *_ptr) noexcept
+{
+  if (!_ptr)
+    return;
+
+  AllocationHeader *header = static_cast<AllocationHeader *>(_ptr) - 1;
+  g_liveBytes.fetch_sub(header->size, std::memory_order_relaxed);
+  std::free(header);
+}
+
+/////////////////////////////////////////////////
+void operator delete(void *_ptr, std::size_t) noexcept
+{
+  operator delete(_ptr);
+}
+
+/// \brief Memory used by an operation.
+struct MemoryUsage
+{
+  /// \brief Number of allocations.
+  std::size_t allocations = 0;
+
+  /// \brief Total number of bytes allocated.
+  std::size_t bytes = 0;
+
+  /// \brief Highest number of bytes that were live at the same time,
+  /// above those that were already live when the operation started.
+  std::size_t peakBytes = 0;
+};
+
+/////////////////////////////////////////////////
+/// \brief Measure the memory used by a function.
+/// \param[in] _func Function to measure.
+/// \return Memory used while _func ran.
+template<typename F>
+MemoryUsage measure(F &&_func)
+{
+  const std::size_t startAllocations = g_allocations.load();
+  const std::size_t startBytes = g_bytes.load();
+  const std::size_t startLive = g_liveBytes.load();
+  g_peakBytes.store(startLive);
+
+  _func();
+
+  MemoryUsage usage;
+  usage.allocations = g_allocations.load() - startAllocations;
+  usage.bytes = g_bytes.load() - startBytes;
+  usage.peakBytes = g_peakBytes.load() - startLive;
+  return usage;
+}
+
+/////////////////////////////////////////////////
+/// \brief Print the memory used by an operation, and record it in the test
+/// results.
+/// \param[in] _name Name of the operation.
+/// \param[in] _usage Memory used.
+void report(const std::string &_name, const MemoryUsage &_usage)
+{
+  std::cout << _name << ": " << _usage.allocations << " allocations, "
+            << _usage.bytes << " bytes, " << _usage.peakBytes
+            << " peak live bytes\n";
+  ::testing::Test::RecordProperty(_name + "_allocations",
+      std::to_string(_usage.allocations));
+  ::testing::Test::RecordProperty(_name + "_bytes",
+      std::to_string(_usage.bytes));
+  ::testing::Test::RecordProperty(_name + "_peak_bytes",
+      std::to_string(_usage.peakBytes));
+}
+
+/////////////////////////////////////////////////
+/// \brief Count the elements of a tree.
+/// \param[in] _elem Root of the tree.
+/// \return Number of elements, including _elem.
+std::size_t countElements(const sdf::ElementPtr &_elem)
+{
+  std::size_t count = 0;
+  std::vector<sdf::ElementPtr> stack = {_elem};
+  while (!stack.empty())
+  {
+    sdf::ElementPtr elem = stack.back();
+    stack.pop_back();
+    ++count;
+    for (sdf::ElementPtr child = elem->GetFirstElement(); child;
+         child = child->GetNextElement())
+    {
+      stack.push_back(child);
+    }
+  }
+  return count;
+}
+
+/////////////////////////////////////////////////
+TEST(MemoryUsage, Init)
+{
+  {
+    sdf::SDFPtr sdfParsed(new sdf::SDF());
+    report("init_first", measure([&]() { sdf::init(sdfParsed); }));
+  }
+
+  // Later calls copy the cached description.
+  sdf::SDFPtr sdfParsed(new sdf::SDF());
+  const MemoryUsage usage = measure([&]() { sdf::init(sdfParsed); });
+  report("init", usage);
+  EXPECT_LE(usage.allocations, kInitAllocations);
+  EXPECT_LE(usage.peakBytes, kInitPeakBytes);
+}
+
+/////////////////////////////////////////////////
+TEST(MemoryUsage, Corpus)
+{
+  const std::string models[] =
+  {
+    "double_pendulum.sdf",
+    "pr2.sdf",
+    "turtlebot.sdf",
+  };
+
+  for (const std::string &model : models)
+  {
+    const std::string path = sdf::filesystem::append(PROJECT_SOURCE_PATH,
+        "test", "integration", "model", model);
+    const std::string name = model.substr(0, model.find('.'));
+
+    sdf::SDFPtr sdfParsed;
+    const MemoryUsage read = measure([&]()
+    {
+      sdfParsed = sdf::readFile(path);
+    });
+    ASSERT_NE(nullptr, sdfParsed) << path;
+    const double elements =
+      static_cast<double>(countElements(sdfParsed->Root()));
+    std::cout << model << ": " << elements << " elements\n";
+    report(name + "_read_file", read);
+    EXPECT_LE(read.allocations, kReadAllocationsPerElement * elements);
+    EXPECT_LE(read.peakBytes, kReadPeakBytesPerElement * elements);
+
+    const MemoryUsage load = measure([&]()
+    {
+      // Only the memory matters here, not whether the old models are
+      // valid in the current spec.
+      sdf::Root root;
+      root.Load(sdfParsed);
+    });
+    report(name + "_root_load", load);
+    EXPECT_LE(load.allocations, kLoadAllocationsPerElement * elements);
+    EXPECT_LE(load.peakBytes, kLoadPeakBytesPerElement * elements);
+
+    sdf::ElementPtr clone;
+    const MemoryUsage cloned = measure([&]()
+    {
+      clone = sdfParsed->Root()->Clone();
+    });
+    ASSERT_NE(nullptr, clone);
+    report(name + "_clone", cloned);
+    EXPECT_LE(cloned.allocations, kCloneAllocationsPerElement * elements);
+    EXPECT_LE(cloned.peakBytes, kClonePeakBytesPerElement * elements);
+  }
+}
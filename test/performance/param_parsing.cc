@@ -0,0 +1,70 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+#include "sdf/Param.hh"
+
+/////////////////////////////////////////////////
+/// \brief Time repeated calls to Param::SetFromString.
+/// \param[in] _type Type of the parameter.
+/// \param[in] _value String to parse.
+/// \param[in] _runs Number of times to parse _value.
+/// \return Elapsed time in milliseconds.
+double timeSetFromString(const std::string &_type, const std::string &_value,
+    int _runs)
+{
+  sdf::Param param("key", _type, "", false);
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < _runs; ++i)
+  {
+    EXPECT_TRUE(param.SetFromString(_value));
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+/////////////////////////////////////////////////
+/// \brief Compare plain values, which are parsed by the fast path, with
+/// equivalent values with a leading '+', which are parsed by the stream
+/// based fallback.
+TEST(ParamParsing, FastPathVsStream)
+{
+  const int runs = 100000;
+  const std::pair<std::string, std::string> values[] =
+  {
+    {"double", "0.123456789"},
+    {"int", "12345"},
+    {"vector3", "1.5 -2.25 3.125"},
+    {"pose", "1.5 -2.25 3.125 0.1 0.2 0.3"},
+    {"quaternion", "0.1 0.2 0.3"},
+    {"color", "0.1 0.2 0.3 1"},
+  };
+
+  for (const auto &[type, value] : values)
+  {
+    const double fast = timeSetFromString(type, value, runs);
+    const double stream = timeSetFromString(type, "+" + value, runs);
+    std::cout << type << ": fast path " << fast << " ms, stream "
+              << stream << " ms for " << runs << " runs\n";
+  }
+}
@@ -15,22 +15,241 @@
  *
  */
 
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
 #include <string>
 
 #include <gtest/gtest.h>
 
+#include "sdf/LoadStats.hh"
+#include "sdf/ParserConfig.hh"
 #include "sdf/sdf.hh"
 
 #include "test_config.h"
 
+/////////////////////////////////////////////////
+/// \brief Get the milliseconds spent in a phase.
+/// \param[in] _stats Collected statistics.
+/// \param[in] _phase The phase.
+/// \return Duration of the phase in milliseconds.
+double phaseMs(const sdf::LoadStats &_stats, sdf::LoadPhase _phase)
+{
+  return std::chrono::duration<double, std::milli>(
+      _stats.Duration(_phase)).count();
+}
+
+/////////////////////////////////////////////////
+/// \brief Convert URDF descriptions with readString and print the time of
+/// each conversion phase per run, and of reading the converted document.
+/// \param[in] _label Label of the output line.
+/// \param[in] _urdf Function that gives the description of a run. Give a
+/// different robot name to each run to measure conversions rather than
+/// hits of the URDF conversion cache.
+/// \param[in] _runs Number of runs.
+void timeConversionPhases(const std::string &_label,
+    const std::function<std::string(int)> &_urdf, int _runs)
+{
+  sdf::LoadStats stats;
+  sdf::ParserConfig config;
+  config.SetStats(&stats);
+
+  for (int i = 0; i < _runs; ++i)
+  {
+    const std::string urdf = _urdf(i);
+    sdf::SDFPtr sdf(new sdf::SDF());
+    sdf::init(sdf);
+    sdf::Errors errors;
+    EXPECT_TRUE(sdf::readString(urdf, config, sdf, errors));
+    EXPECT_TRUE(errors.empty());
+  }
+
+  std::cout << _label << ": parseURDF "
+            << phaseMs(stats, sdf::LoadPhase::URDF_PARSE) / _runs
+            << " ms, ReduceFixedJoints "
+            << phaseMs(stats, sdf::LoadPhase::URDF_REDUCE_FIXED_JOINTS) / _runs
+            << " ms, CreateSDF "
+            << phaseMs(stats, sdf::LoadPhase::URDF_CREATE_SDF) / _runs
+            << " ms, conversion "
+            << phaseMs(stats, sdf::LoadPhase::URDF_CONVERSION) / _runs
+            << " ms, readDoc "
+            << phaseMs(stats, sdf::LoadPhase::READ_XML) / _runs
+            << " ms per run\n";
+}
+
+/////////////////////////////////////////////////
+/// \brief Get the URDF text of a link with an inertial.
+/// \param[in] _name Name of the link.
+/// \param[in] _body Extra elements of the link.
+/// \return URDF text of the link.
+std::string urdfLink(const std::string &_name, const std::string &_body = "")
+{
+  return "<link name='" + _name + "'><inertial><mass value='1'/>"
+      "<origin xyz='0.1 0 0' rpy='0 0 0'/>"
+      "<inertia ixx='0.1' ixy='0' ixz='0' iyy='0.1' iyz='0' izz='0.1'/>"
+      "</inertial>" + _body + "</link>";
+}
+
+/////////////////////////////////////////////////
+/// \brief Get the URDF text of a joint.
+/// \param[in] _type Type of the joint.
+/// \param[in] _parent Name of the parent link.
+/// \param[in] _child Name of the child link.
+/// \return URDF text of the joint.
+std::string urdfJoint(const std::string &_type, const std::string &_parent,
+    const std::string &_child)
+{
+  std::string joint = "<joint name='" + _parent + "_" + _child +
+      "' type='" + _type + "'><parent link='" + _parent + "'/>"
+      "<child link='" + _child + "'/>"
+      "<origin xyz='0 0 0.1' rpy='0 0 0.01'/>";
+  if (_type == "revolute")
+  {
+    joint += "<axis xyz='0 0 1'/>"
+        "<limit lower='-1' upper='1' effort='10' velocity='1'/>";
+  }
+  return joint + "</joint>";
+}
+
 TEST(URDFParser, AtlasURDF_5runs_performance)
 {
   const std::string
     URDF_TEST_FILE = sdf::filesystem::append(PROJECT_SOURCE_PATH, "test",
                                              "performance",
                                              "parser_urdf_atlas.urdf");
-  for (int i = 0; i < 5; i++)
+  const int runs = 5;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < runs; i++)
   {
     sdf::SDFPtr root = sdf::readFile(URDF_TEST_FILE);
+    EXPECT_NE(nullptr, root);
   }
+  auto end = std::chrono::steady_clock::now();
+  std::cout << "Atlas URDF: "
+            << std::chrono::duration<double, std::milli>(end - start).count() /
+               runs
+            << " ms per readFile\n";
+}
+
+/////////////////////////////////////////////////
+/// \brief Lump chains of links connected by fixed joints.
+TEST(URDFParser, FixedJointChain_performance)
+{
+  for (const int length : {10, 100, 1000, 10000})
+  {
+    std::string links = urdfLink("link0");
+    for (int i = 1; i <= length; ++i)
+    {
+      const std::string name = "link" + std::to_string(i);
+      links += urdfLink(name) +
+          urdfJoint("fixed", "link" + std::to_string(i - 1), name);
+    }
+
+    const int runs = length >= 1000 ? 1 : 10;
+    timeConversionPhases(std::to_string(length) + " fixed joints",
+        [&links](int _run)
+        {
+          return "<robot name='chain" + std::to_string(_run) + "'>" +
+              links + "</robot>";
+        }, runs);
+  }
+}
+
+/////////////////////////////////////////////////
+/// \brief Convert a robot with many <gazebo> extensions for its links,
+/// joints and the robot, including extensions of lumped links.
+TEST(URDFParser, GazeboExtensions_performance)
+{
+  const int linkCount = 200;
+  std::string body = urdfLink("link0");
+  for (int i = 1; i <= linkCount; ++i)
+  {
+    const std::string parent = "link" + std::to_string(i - 1);
+    const std::string name = "link" + std::to_string(i);
+    const std::string lumped = "lumped" + std::to_string(i);
+    body += urdfLink(name) + urdfJoint("revolute", parent, name) +
+        urdfLink(lumped) + urdfJoint("fixed", name, lumped);
+
+    for (const std::string &link : {name, lumped})
+    {
+      body += "<gazebo reference='" + link + "'>"
+          "<mu1>0.5</mu1><mu2>0.5</mu2><kp>1e6</kp><kd>1</kd>"
+          "<selfCollide>true</selfCollide><material>Gazebo/Grey</material>"
+          "<sensor name='" + link + "_imu' type='imu'>"
+          "<update_rate>100</update_rate><pose>0 0 0.1 0 0 0</pose>"
+          "</sensor></gazebo>";
+    }
+    body += "<gazebo reference='" + parent + "_" + name + "'>"
+        "<provideFeedback>true</provideFeedback>"
+        "<implicitSpringDamper>true</implicitSpringDamper></gazebo>";
+  }
+  body += "<gazebo><static>false</static></gazebo>";
+
+  timeConversionPhases(std::to_string(linkCount) + " links with extensions",
+      [&body](int _run)
+      {
+        return "<robot name='gazebo" + std::to_string(_run) + "'>" +
+            body + "</robot>";
+      }, 10);
+}
+
+/////////////////////////////////////////////////
+/// \brief Convert a robot whose links use many meshes as collisions.
+TEST(URDFParser, MeshCollisions_performance)
+{
+  const int linkCount = 200;
+  const int meshCount = 10;
+  std::string body = urdfLink("link0");
+  for (int i = 1; i <= linkCount; ++i)
+  {
+    std::string geometries;
+    for (int j = 0; j < meshCount; ++j)
+    {
+      const std::string mesh = "<origin xyz='0 0 " + std::to_string(j) +
+          "' rpy='0 0 0'/><geometry><mesh filename='package://robot/mesh" +
+          std::to_string(j) + ".dae' scale='0.001 0.001 0.001'/>"
+          "</geometry>";
+      geometries += "<collision name='c" + std::to_string(j) + "'>" + mesh +
+          "</collision><visual name='v" + std::to_string(j) + "'>" + mesh +
+          "</visual>";
+    }
+    const std::string name = "link" + std::to_string(i);
+    body += urdfLink(name, geometries) +
+        urdfJoint("revolute", "link" + std::to_string(i - 1), name);
+  }
+
+  timeConversionPhases(std::to_string(linkCount * meshCount) +
+      " mesh collisions",
+      [&body](int _run)
+      {
+        return "<robot name='meshes" + std::to_string(_run) + "'>" +
+            body + "</robot>";
+      }, 10);
+}
+
+/////////////////////////////////////////////////
+/// \brief Read the same robot description many times, like components of
+/// a process that each load the robot, so that all but the first run can
+/// use the URDF conversion cache.
+TEST(URDFParser, RepeatedReadString_performance)
+{
+  const std::string filename = sdf::filesystem::append(PROJECT_SOURCE_PATH,
+      "test", "performance", "parser_urdf_atlas.urdf");
+  std::ifstream file(filename);
+  ASSERT_TRUE(file.is_open());
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  // Give the robot a name no other test uses, so that the first run
+  // converts it.
+  std::string urdf = buffer.str();
+  const std::size_t robotName = urdf.find("<robot name=\"");
+  ASSERT_NE(std::string::npos, robotName);
+  urdf.insert(robotName + 13, "repeated_");
+
+  timeConversionPhases("Atlas URDF, first readString",
+      [&urdf](int) { return urdf; }, 1);
+  timeConversionPhases("Atlas URDF, repeated readString",
+      [&urdf](int) { return urdf; }, 20);
 }
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <ignition/math/Pose3.hh>
+
+#include "sdf/Link.hh"
+#include "sdf/Model.hh"
+#include "sdf/Root.hh"
+#include "sdf/SemanticPose.hh"
+
+/////////////////////////////////////////////////
+/// \brief Time the resolution of the poses of random pairs of links of a
+/// model whose links form a random tree of relative_to frames.
+TEST(PoseResolution, RandomFramePairs)
+{
+  const std::size_t linkCount = 200;
+  const std::size_t runs = 1000000;
+
+  std::mt19937 random(5);
+  std::string sdfString = "<sdf version='1.8'><model name='tree'>";
+  for (std::size_t i = 0; i < linkCount; ++i)
+  {
+    sdfString += "<link name='link" + std::to_string(i) + "'><pose";
+    if (i > 0)
+    {
+      std::uniform_int_distribution<std::size_t> parent(0, i - 1);
+      sdfString += " relative_to='link" + std::to_string(parent(random)) +
+          "'";
+    }
+    sdfString += ">0.1 0.2 0.3 0.01 0.02 0.03</pose></link>";
+  }
+  sdfString += "</model></sdf>";
+
+  sdf::Root root;
+  ASSERT_TRUE(root.LoadSdfString(sdfString).empty());
+  const sdf::Model *model = root.ModelByIndex(0);
+  ASSERT_NE(nullptr, model);
+  ASSERT_EQ(linkCount, model->LinkCount());
+
+  std::vector<std::string> names;
+  std::vector<sdf::SemanticPose> poses;
+  for (std::size_t i = 0; i < linkCount; ++i)
+  {
+    names.push_back(model->LinkByIndex(i)->Name());
+    poses.push_back(model->LinkByIndex(i)->SemanticPose());
+  }
+
+  // Resolving a pair agrees with resolving both links in the model frame.
+  ignition::math::Pose3d pose;
+  ignition::math::Pose3d poseA;
+  ignition::math::Pose3d poseB;
+  ASSERT_TRUE(poses[linkCount - 1].Resolve(pose, names[linkCount / 2])
+      .empty());
+  ASSERT_TRUE(poses[linkCount - 1].Resolve(poseA).empty());
+  ASSERT_TRUE(poses[linkCount / 2].Resolve(poseB).empty());
+  EXPECT_EQ(poseB.Inverse() * poseA, pose);
+
+  std::uniform_int_distribution<std::size_t> link(0, linkCount - 1);
+  std::vector<std::size_t> pairs(2 * runs);
+  for (auto &index : pairs)
+    index = link(random);
+
+  auto start = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < runs; ++i)
+  {
+    EXPECT_TRUE(poses[pairs[2 * i]].Resolve(pose, names[pairs[2 * i + 1]])
+        .empty());
+  }
+  auto end = std::chrono::steady_clock::now();
+  const double ms =
+      std::chrono::duration<double, std::milli>(end - start).count();
+  std::cout << runs << " frame pair resolutions between " << linkCount
+            << " links: " << ms << " ms, " << ms * 1e6 / runs
+            << " ns per resolution\n";
+}